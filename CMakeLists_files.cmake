@@ -27,19 +27,42 @@
 # find opm -name '*.c*' -printf '\t%p\n' | sort
 #list (APPEND MAIN_SOURCE_FILES)
 
+# the explicit template instantiations, cf. opm/material/common/ExplicitInstantiations.hpp
+if (OPM_MATERIAL_EXPLICIT_INSTANTIATIONS)
+  list (APPEND MAIN_SOURCE_FILES
+	opm/material/fluidmatrixinteractions/EclMaterialLawManager.cpp
+	opm/material/fluidsystems/BlackOilFluidSystem.cpp
+	opm/material/fluidsystems/blackoilpvt/BlackOilPvt.cpp
+	)
+endif ()
+
+# the C interface, cf. opm/material/capi/BlackOilCApi.h
+if (OPM_MATERIAL_C_API)
+  list (APPEND MAIN_SOURCE_FILES
+	opm/material/capi/BlackOilCApi.cpp
+	)
+endif ()
+
 # originally generated with the command:
 # find tests -name '*.cpp' -a ! -wholename '*/not-unit/*' -printf '\t%p\n' | sort
 list (APPEND TEST_SOURCE_FILES
 	tests/test_fluidmatrixinteractions.cpp
 	tests/test_pengrobinson.cpp
 	tests/test_localad.cpp
+	tests/test_localadexpressions.cpp
+	tests/test_sparselocalad.cpp
+	tests/test_dynamiclocalad.cpp
 	tests/test_ncpflash.cpp
 	tests/test_spline.cpp
 	tests/test_tabulation.cpp
+	tests/test_1dtables.cpp
 	tests/test_2dtables.cpp
 	tests/test_components.cpp
 	tests/test_fluidsystems.cpp
 	tests/test_immiscibleflash.cpp
+	tests/test_instrumentation.cpp
+	tests/test_eclmateriallawmanager.cpp
+	tests/test_heatconduction.cpp
 	)
 
 # originally generated with the command:
@@ -50,6 +73,13 @@ list (APPEND TEST_DATA_FILES
 # originally generated with the command:
 # find tutorials examples -name '*.c*' -printf '\t%p\n' | sort
 list (APPEND EXAMPLE_SOURCE_FILES
+	examples/benchmark_blackoilpvt.cpp
+	examples/benchmark_components.cpp
+	examples/benchmark_eclmaterial.cpp
+	examples/benchmark_flashcorpus.cpp
+	examples/benchmark_localad.cpp
+	examples/benchmark_ncpflash.cpp
+	examples/proxy_blackoil.cpp
 	)
 
 # programs listed here will not only be compiled, but also marked for
@@ -63,3 +93,6 @@ list (APPEND PUBLIC_HEADER_FILES ${TMP})
 
 file(GLOB_RECURSE TMP RELATIVE "${CMAKE_SOURCE_DIR}" "opm/*.inc")
 list (APPEND PUBLIC_HEADER_FILES ${TMP})
+
+file(GLOB_RECURSE TMP RELATIVE "${CMAKE_SOURCE_DIR}" "opm/material/capi/*.h")
+list (APPEND PUBLIC_HEADER_FILES ${TMP})
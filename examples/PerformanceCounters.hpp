@@ -0,0 +1,298 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::PerformanceCounters
+ */
+#ifndef OPM_PERFORMANCE_COUNTERS_HPP
+#define OPM_PERFORMANCE_COUNTERS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#if defined __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define OPM_HAVE_PERF_EVENTS 1
+#endif
+
+namespace Opm {
+/*!
+ * \brief Hardware performance counters for the benchmark programs.
+ *
+ * Besides the time, the benchmarks can report the number of cycles, instructions,
+ * cache misses, branch misses and TLB misses per evaluation. This shows whether a
+ * kernel is limited by the memory hierarchy, by branches or by computation. The
+ * counters are read using the perf_event_open() system call of Linux; on other
+ * systems, or if the kernel does not allow to use them (cf.
+ * /proc/sys/kernel/perf_event_paranoid), they are reported as not available.
+ *
+ * Only events which occur in user space in the calling thread are counted. If the
+ * hardware cannot count all events at once, the kernel multiplexes them and the
+ * counts are extrapolated.
+ *
+ * \code
+ * Opm::PerformanceCounters counters;
+ * counters.enable();
+ * counters.reset();
+ * counters.start();
+ * // ... evaluate something numEvals times ...
+ * counters.stop();
+ * counters.printPerEvaluation(std::cout, numEvals);
+ * \endcode
+ */
+class PerformanceCounters
+{
+public:
+    enum Event {
+        Cycles,
+        Instructions,
+        L1DataMisses,
+        // on most processors, these are the misses of the L2 cache
+        LastLevelCacheReferences,
+        LastLevelCacheMisses,
+        BranchMisses,
+        DataTlbMisses,
+        numEvents
+    };
+
+    PerformanceCounters()
+        : enabled_(false)
+    {
+        for (int eventIdx = 0; eventIdx < numEvents; ++eventIdx)
+            fd_[eventIdx] = -1;
+        reset();
+    }
+
+    ~PerformanceCounters()
+    {
+#if OPM_HAVE_PERF_EVENTS
+        for (int eventIdx = 0; eventIdx < numEvents; ++eventIdx)
+            if (fd_[eventIdx] >= 0)
+                ::close(fd_[eventIdx]);
+#endif
+    }
+
+    /*!
+     * \brief Open the counters.
+     *
+     * Unless this is called, all other methods do nothing.
+     *
+     * \return true if at least one of the counters is available
+     */
+    bool enable()
+    {
+        enabled_ = true;
+#if OPM_HAVE_PERF_EVENTS
+        for (int eventIdx = 0; eventIdx < numEvents; ++eventIdx) {
+            if (fd_[eventIdx] >= 0)
+                continue;
+
+            struct perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            setEvent_(attr, static_cast<Event>(eventIdx));
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fd_[eventIdx] = static_cast<int>(::syscall(__NR_perf_event_open, &attr,
+                                                       /*pid=*/0, /*cpu=*/-1,
+                                                       /*groupFd=*/-1, /*flags=*/0));
+        }
+#endif
+
+        for (int eventIdx = 0; eventIdx < numEvents; ++eventIdx)
+            if (available(static_cast<Event>(eventIdx)))
+                return true;
+        return false;
+    }
+
+    /*!
+     * \brief Returns true if enable() has been called.
+     */
+    bool enabled() const
+    { return enabled_; }
+
+    /*!
+     * \brief Returns true if an event can be counted.
+     */
+    bool available(Event event) const
+    { return fd_[event] >= 0; }
+
+    /*!
+     * \brief Set the accumulated counts to zero.
+     */
+    void reset()
+    {
+        for (int eventIdx = 0; eventIdx < numEvents; ++eventIdx)
+            count_[eventIdx] = 0.0;
+    }
+
+    /*!
+     * \brief Start counting.
+     */
+    void start()
+    {
+#if OPM_HAVE_PERF_EVENTS
+        for (int eventIdx = 0; eventIdx < numEvents; ++eventIdx) {
+            if (fd_[eventIdx] < 0)
+                continue;
+            read_(eventIdx, startValue_[eventIdx]);
+            ::ioctl(fd_[eventIdx], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    /*!
+     * \brief Stop counting and add the events since start() to the accumulated counts.
+     */
+    void stop()
+    {
+#if OPM_HAVE_PERF_EVENTS
+        for (int eventIdx = 0; eventIdx < numEvents; ++eventIdx) {
+            if (fd_[eventIdx] < 0)
+                continue;
+            ::ioctl(fd_[eventIdx], PERF_EVENT_IOC_DISABLE, 0);
+
+            uint64_t value[3];
+            read_(eventIdx, value);
+            double counted = double(value[0] - startValue_[eventIdx][0]);
+            double timeEnabled = double(value[1] - startValue_[eventIdx][1]);
+            double timeRunning = double(value[2] - startValue_[eventIdx][2]);
+            if (timeRunning > 0)
+                count_[eventIdx] += counted*timeEnabled/timeRunning;
+        }
+#endif
+    }
+
+    /*!
+     * \brief Returns the accumulated number of events.
+     */
+    double count(Event event) const
+    { return count_[event]; }
+
+    /*!
+     * \brief Returns a short name for an event.
+     */
+    static const char* name(Event event)
+    {
+        static const char* names[numEvents] = {
+            "cycles", "instr", "L1D miss", "LLC ref", "LLC miss", "br miss", "dTLB miss"
+        };
+        return names[event];
+    }
+
+    /*!
+     * \brief Print the accumulated counts divided by the number of evaluations.
+     *
+     * \param os The stream to which the counts are written
+     * \param numEvals The number of evaluations
+     * \param prefix The string which is printed at the start of the line
+     *
+     * Nothing is printed unless enable() has been called.
+     */
+    void printPerEvaluation(std::ostream& os,
+                            double numEvals,
+                            const char* prefix = "    per evaluation:") const
+    {
+        if (!enabled_)
+            return;
+
+        os << prefix;
+        for (int eventIdx = 0; eventIdx < numEvents; ++eventIdx) {
+            Event event = static_cast<Event>(eventIdx);
+            os << "  " << name(event) << ": ";
+            if (available(event))
+                os << std::fixed << std::setprecision(2) << count_[eventIdx]/numEvals;
+            else
+                os << "n/a";
+        }
+        if (available(Cycles) && available(Instructions) && count_[Cycles] > 0)
+            os << "  IPC: " << std::fixed << std::setprecision(2)
+               << count_[Instructions]/count_[Cycles];
+        os << "\n";
+        os.unsetf(std::ios::floatfield);
+    }
+
+private:
+#if OPM_HAVE_PERF_EVENTS
+    static void setEvent_(struct perf_event_attr& attr, Event event)
+    {
+        // the generic cache events are encoded as cache | (operation << 8) | (result << 16)
+        const uint64_t readMiss =
+            (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+        switch (event) {
+        case Cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case Instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case L1DataMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | readMiss;
+            break;
+        case LastLevelCacheReferences:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_REFERENCES;
+            break;
+        case LastLevelCacheMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case BranchMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case DataTlbMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | readMiss;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void read_(int eventIdx, uint64_t* value) const
+    {
+        if (::read(fd_[eventIdx], value, 3*sizeof(uint64_t)) != static_cast<ssize_t>(3*sizeof(uint64_t)))
+            value[0] = value[1] = value[2] = 0;
+    }
+
+    uint64_t startValue_[numEvents][3];
+#endif
+
+    bool enabled_;
+    int fd_[numEvents];
+    double count_[numEvents];
+};
+
+} // namespace Opm
+
+#endif
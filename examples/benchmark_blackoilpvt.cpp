@@ -0,0 +1,383 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Measures the throughput of the PVT relations of the black-oil fluid system.
+ *
+ * The densities, viscosities, saturated oil formation volume factors, gas
+ * dissolution factors and oil saturation pressures are evaluated for randomized
+ * pressures and dissolution factors. This is done for live oil with wet gas and for
+ * dead oil with dry gas, using plain scalars as well as function evaluations of the
+ * localized automatic differentiation framework. For each quantity the time per
+ * evaluation and the number of evaluations per second are reported.
+ *
+ * If --perf-counters is given, the hardware performance counters per evaluation are
+ * reported as well, cf. Opm::PerformanceCounters.
+ *
+ * Usage: benchmark_blackoilpvt [--samples=N] [--repetitions=N] [--perf-counters]
+ */
+#include "config.h"
+
+#include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/LiveOilPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/DeadOilPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/WetGasPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/DryGasPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/ConstantCompressibilityWaterPvt.hpp>
+#include <opm/material/fluidstates/CompositionalFluidState.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/Tabulated1DFunction.hpp>
+
+#include "PerformanceCounters.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+class BenchmarkAdTag;
+
+static Opm::PerformanceCounters perfCounters;
+
+typedef double Scalar;
+typedef Opm::LocalAd::Evaluation<Scalar, BenchmarkAdTag, /*numVars=*/2> Evaluation;
+typedef Opm::FluidSystems::BlackOil<Scalar, Evaluation> FluidSystem;
+typedef std::vector<std::pair<Scalar, Scalar> > SamplingPoints;
+
+typedef std::chrono::steady_clock Clock;
+
+static const int waterPhaseIdx = FluidSystem::waterPhaseIdx;
+static const int oilPhaseIdx = FluidSystem::oilPhaseIdx;
+static const int gasPhaseIdx = FluidSystem::gasPhaseIdx;
+static const int oilCompIdx = FluidSystem::oilCompIdx;
+static const int gasCompIdx = FluidSystem::gasCompIdx;
+
+static const Scalar rhoRefOil = 859.5;
+static const Scalar rhoRefWater = 1033.0;
+static const Scalar rhoRefGas = 0.854;
+static const Scalar temperature = 273.15 + 80.0;
+
+// the pressures used to sample the PVT tables [Pa]
+static std::vector<Scalar> tablePressures()
+{
+    std::vector<Scalar> p;
+    for (int i = 0; i <= 25; ++i)
+        p.push_back((1.0 + 20.0*i)*1e5);
+    return p;
+}
+
+static void initWaterPvt()
+{
+    auto waterPvt = std::make_shared<Opm::ConstantCompressibilityWaterPvt<Scalar, Evaluation> >();
+    waterPvt->setNumRegions(1);
+    waterPvt->setReferencePressure(/*regionIdx=*/0, 1e5);
+    waterPvt->setReferenceFormationVolumeFactor(/*regionIdx=*/0, 1.02);
+    waterPvt->setCompressibility(/*regionIdx=*/0, 4.5e-10);
+    waterPvt->setViscosity(/*regionIdx=*/0, 0.5e-3);
+    waterPvt->initEnd();
+    FluidSystem::setWaterPvt(waterPvt);
+}
+
+// live oil and wet gas
+static void initLiveOilWetGas()
+{
+    FluidSystem::initBegin(/*numPvtRegions=*/1);
+    FluidSystem::setEnableDissolvedGas(true);
+    FluidSystem::setEnableVaporizedOil(true);
+    FluidSystem::setReferenceDensities(rhoRefOil, rhoRefWater, rhoRefGas, /*regionIdx=*/0);
+
+    SamplingPoints Rs, Bo, muo, Rv, Bg, mug;
+    for (Scalar p : tablePressures()) {
+        Scalar pBar = p/1e5;
+        Rs.push_back(std::make_pair(p, 0.6*pBar));
+        Bo.push_back(std::make_pair(p, 1.0 + 0.002*pBar));
+        muo.push_back(std::make_pair(p, 1e-3*(1.5 - 0.002*pBar)));
+        Rv.push_back(std::make_pair(p, 2e-6*pBar));
+        Bg.push_back(std::make_pair(p, 1.0/pBar));
+        mug.push_back(std::make_pair(p, 1.2e-5 + 2e-8*pBar));
+    }
+
+    auto oilPvt = std::make_shared<Opm::LiveOilPvt<Scalar, Evaluation> >();
+    oilPvt->setNumRegions(1);
+    oilPvt->setSaturatedOilGasDissolutionFactor(/*regionIdx=*/0, Rs);
+    oilPvt->setSaturatedOilFormationVolumeFactor(/*regionIdx=*/0, Bo);
+    oilPvt->setSaturatedOilViscosity(/*regionIdx=*/0, muo);
+    oilPvt->initEnd();
+    FluidSystem::setOilPvt(oilPvt);
+
+    auto gasPvt = std::make_shared<Opm::WetGasPvt<Scalar, Evaluation> >();
+    gasPvt->setNumRegions(1);
+    gasPvt->setSaturatedGasOilVaporizationFactor(/*regionIdx=*/0, Rv);
+    gasPvt->setSaturatedGasFormationVolumeFactor(/*regionIdx=*/0, Bg);
+    gasPvt->setSaturatedGasViscosity(/*regionIdx=*/0, mug);
+    gasPvt->initEnd();
+    FluidSystem::setGasPvt(gasPvt);
+
+    initWaterPvt();
+    FluidSystem::initEnd();
+}
+
+// dead oil and dry gas
+static void initDeadOilDryGas()
+{
+    FluidSystem::initBegin(/*numPvtRegions=*/1);
+    FluidSystem::setEnableDissolvedGas(false);
+    FluidSystem::setEnableVaporizedOil(false);
+    FluidSystem::setReferenceDensities(rhoRefOil, rhoRefWater, rhoRefGas, /*regionIdx=*/0);
+
+    std::vector<Scalar> p = tablePressures();
+    std::vector<Scalar> invBo, muo, mug;
+    SamplingPoints Bg;
+    for (Scalar pValue : p) {
+        Scalar pBar = pValue/1e5;
+        invBo.push_back(1.0/(1.2 - 1e-4*pBar));
+        muo.push_back(1e-3*(1.0 + 5e-4*pBar));
+        Bg.push_back(std::make_pair(pValue, 1.0/pBar));
+        mug.push_back(1.2e-5 + 2e-8*pBar);
+    }
+
+    auto oilPvt = std::make_shared<Opm::DeadOilPvt<Scalar, Evaluation> >();
+    oilPvt->setNumRegions(1);
+    oilPvt->setInverseOilFormationVolumeFactor(/*regionIdx=*/0, Opm::Tabulated1DFunction<Scalar>(p, invBo));
+    oilPvt->setOilViscosity(/*regionIdx=*/0, Opm::Tabulated1DFunction<Scalar>(p, muo));
+    oilPvt->initEnd();
+    FluidSystem::setOilPvt(oilPvt);
+
+    auto gasPvt = std::make_shared<Opm::DryGasPvt<Scalar, Evaluation> >();
+    gasPvt->setNumRegions(1);
+    gasPvt->setGasFormationVolumeFactor(/*regionIdx=*/0, Bg);
+    gasPvt->setGasViscosity(/*regionIdx=*/0, Opm::Tabulated1DFunction<Scalar>(p, mug));
+    gasPvt->initEnd();
+    FluidSystem::setGasPvt(gasPvt);
+
+    initWaterPvt();
+    FluidSystem::initEnd();
+}
+
+// the randomized input values for one type of evaluation
+template <class LhsEval>
+struct Samples
+{
+    typedef Opm::CompositionalFluidState<LhsEval, FluidSystem, /*storeEnthalpy=*/false> FluidState;
+
+    std::vector<LhsEval> T;
+    std::vector<LhsEval> p;
+    std::vector<LhsEval> XoG;
+    std::vector<FluidState> fluidStates;
+};
+
+template <class LhsEval>
+static LhsEval createValue(Scalar value, int varIdx);
+
+template <>
+Scalar createValue<Scalar>(Scalar value, int /*varIdx*/)
+{ return value; }
+
+template <>
+Evaluation createValue<Evaluation>(Scalar value, int varIdx)
+{
+    if (varIdx < 0)
+        return Evaluation::createConstant(value);
+    return Evaluation::createVariable(value, varIdx);
+}
+
+template <class LhsEval>
+static void createSamples(Samples<LhsEval>& samples, size_t numSamples)
+{
+    // always use the same seed so that the runs are comparable
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<Scalar> pressureDist(50e5, 400e5);
+    std::uniform_real_distribution<Scalar> unitDist(0.0, 1.0);
+
+    samples.T.resize(numSamples);
+    samples.p.resize(numSamples);
+    samples.XoG.resize(numSamples);
+    samples.fluidStates.resize(numSamples);
+    for (size_t i = 0; i < numSamples; ++i) {
+        Scalar p = pressureDist(rng);
+
+        // the dissolved gas and the vaporized oil are below their saturated values
+        Scalar RsSat = FluidSystem::gasDissolutionFactor(temperature, p, /*regionIdx=*/0);
+        Scalar RvSat = FluidSystem::oilVaporizationFactor(temperature, p, /*regionIdx=*/0);
+        Scalar Rs = RsSat*unitDist(rng);
+        Scalar Rv = RvSat*unitDist(rng);
+        Scalar XoG = Rs*rhoRefGas/(rhoRefOil + Rs*rhoRefGas);
+        Scalar XgO = Rv*rhoRefOil/(rhoRefGas + Rv*rhoRefOil);
+
+        samples.T[i] = createValue<LhsEval>(temperature, /*varIdx=*/-1);
+        samples.p[i] = createValue<LhsEval>(p, /*varIdx=*/0);
+        samples.XoG[i] = createValue<LhsEval>(XoG, /*varIdx=*/1);
+
+        auto& fs = samples.fluidStates[i];
+        fs.setTemperature(samples.T[i]);
+        for (int phaseIdx = 0; phaseIdx < FluidSystem::numPhases; ++phaseIdx)
+            fs.setPressure(phaseIdx, samples.p[i]);
+
+        fs.setMoleFraction(oilPhaseIdx, oilCompIdx, 1.0);
+        fs.setMoleFraction(gasPhaseIdx, gasCompIdx, 1.0);
+        fs.setMoleFraction(waterPhaseIdx, FluidSystem::waterCompIdx, 1.0);
+
+        // set the composition of the hydrocarbon phases via the mass fractions
+        Scalar MO = FluidSystem::molarMass(oilCompIdx);
+        Scalar MG = FluidSystem::molarMass(gasCompIdx);
+        Scalar xoG = XoG/MG/(XoG/MG + (1 - XoG)/MO);
+        Scalar xgO = XgO/MO/(XgO/MO + (1 - XgO)/MG);
+        fs.setMoleFraction(oilPhaseIdx, gasCompIdx, createValue<LhsEval>(xoG, /*varIdx=*/1));
+        fs.setMoleFraction(oilPhaseIdx, oilCompIdx, createValue<LhsEval>(1 - xoG, /*varIdx=*/1));
+        fs.setMoleFraction(gasPhaseIdx, oilCompIdx, createValue<LhsEval>(xgO, /*varIdx=*/1));
+        fs.setMoleFraction(gasPhaseIdx, gasCompIdx, createValue<LhsEval>(1 - xgO, /*varIdx=*/1));
+    }
+}
+
+template <class LhsEval, class Functor>
+static void measure(const std::string& configName,
+                    const char* typeName,
+                    const char* quantityName,
+                    size_t numSamples,
+                    int repetitions,
+                    const Functor& functor)
+{
+    typedef Opm::MathToolbox<LhsEval> Toolbox;
+
+    // the sum of the results is printed so that the compiler cannot optimize the
+    // evaluations away
+    Scalar checksum = 0.0;
+    perfCounters.reset();
+    perfCounters.start();
+    auto start = Clock::now();
+    for (int repIdx = 0; repIdx < repetitions; ++repIdx)
+        for (size_t i = 0; i < numSamples; ++i)
+            checksum += Toolbox::value(functor(i));
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    perfCounters.stop();
+
+    double numEvals = double(numSamples)*repetitions;
+    std::cout << std::left
+              << std::setw(18) << configName
+              << std::setw(12) << typeName
+              << std::setw(36) << quantityName
+              << std::right
+              << std::setw(12) << std::fixed << std::setprecision(1) << seconds/numEvals*1e9
+              << std::setw(16) << std::scientific << std::setprecision(3) << numEvals/seconds
+              << "   (checksum: " << checksum << ")\n";
+    std::cout.unsetf(std::ios::floatfield);
+    perfCounters.printPerEvaluation(std::cout, numEvals);
+}
+
+template <class LhsEval>
+static void runBenchmarks(const std::string& configName,
+                          const char* typeName,
+                          size_t numSamples,
+                          int repetitions)
+{
+    Samples<LhsEval> samples;
+    createSamples(samples, numSamples);
+
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+    ParameterCache paramCache;
+    const auto& s = samples;
+
+    measure<LhsEval>(configName, typeName, "density (oil)", numSamples, repetitions,
+                     [&](size_t i) -> LhsEval
+                     { return FluidSystem::density(s.fluidStates[i], paramCache, oilPhaseIdx); });
+    measure<LhsEval>(configName, typeName, "density (gas)", numSamples, repetitions,
+                     [&](size_t i) -> LhsEval
+                     { return FluidSystem::density(s.fluidStates[i], paramCache, gasPhaseIdx); });
+    measure<LhsEval>(configName, typeName, "viscosity (oil)", numSamples, repetitions,
+                     [&](size_t i) -> LhsEval
+                     { return FluidSystem::viscosity(s.fluidStates[i], paramCache, oilPhaseIdx); });
+    measure<LhsEval>(configName, typeName, "viscosity (gas)", numSamples, repetitions,
+                     [&](size_t i) -> LhsEval
+                     { return FluidSystem::viscosity(s.fluidStates[i], paramCache, gasPhaseIdx); });
+    measure<LhsEval>(configName, typeName, "saturatedOilFormationVolumeFactor", numSamples, repetitions,
+                     [&](size_t i) -> LhsEval
+                     { return FluidSystem::saturatedOilFormationVolumeFactor(s.T[i], s.p[i], /*regionIdx=*/0); });
+    measure<LhsEval>(configName, typeName, "gasDissolutionFactor", numSamples, repetitions,
+                     [&](size_t i) -> LhsEval
+                     { return FluidSystem::gasDissolutionFactor(s.T[i], s.p[i], /*regionIdx=*/0); });
+    measure<LhsEval>(configName, typeName, "oilSaturationPressure", numSamples, repetitions,
+                     [&](size_t i) -> LhsEval
+                     { return FluidSystem::oilSaturationPressure(s.T[i], s.XoG[i], /*regionIdx=*/0); });
+}
+
+static bool parseOption(const char* arg, const char* name, std::string& value)
+{
+    size_t len = std::strlen(name);
+    if (std::strncmp(arg, name, len) != 0 || arg[len] != '=')
+        return false;
+    value = arg + len + 1;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    size_t numSamples = 100000;
+    int repetitions = 10;
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        std::string value;
+        if (parseOption(argv[argIdx], "--samples", value))
+            numSamples = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--repetitions", value))
+            repetitions = std::atoi(value.c_str());
+        else if (std::strcmp(argv[argIdx], "--perf-counters") == 0) {
+            if (!perfCounters.enable())
+                std::cerr << "Warning: The hardware performance counters are not available\n";
+        }
+        else {
+            std::cerr << "Unknown option '" << argv[argIdx] << "'\n"
+                      << "Usage: " << argv[0] << " [--samples=N] [--repetitions=N] [--perf-counters]\n";
+            return 1;
+        }
+    }
+
+    if (numSamples < 1 || repetitions < 1) {
+        std::cerr << "The number of samples and the number of repetitions must be positive\n";
+        return 1;
+    }
+
+    std::cout << numSamples << " samples, " << repetitions << " repetitions\n"
+              << std::left
+              << std::setw(18) << "configuration"
+              << std::setw(12) << "type"
+              << std::setw(36) << "quantity"
+              << std::right
+              << std::setw(12) << "ns/eval"
+              << std::setw(16) << "evals/s" << "\n";
+
+    initLiveOilWetGas();
+    runBenchmarks<Scalar>("LiveOil/WetGas", "Scalar", numSamples, repetitions);
+    runBenchmarks<Evaluation>("LiveOil/WetGas", "Evaluation", numSamples, repetitions);
+
+    initDeadOilDryGas();
+    runBenchmarks<Scalar>("DeadOil/DryGas", "Scalar", numSamples, repetitions);
+    runBenchmarks<Evaluation>("DeadOil/DryGas", "Evaluation", numSamples, repetitions);
+
+    return 0;
+}
@@ -0,0 +1,421 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Compares the speed and the accuracy of the implementations of water and CO2.
+ *
+ * For water, the raw IAPWS formulation (Opm::H2O) serves as the reference. It is
+ * compared to Opm::TabulatedComponent using tables of several resolutions (with
+ * bilinear and bicubic interpolation as well as single precision storage) and to
+ * Opm::SimpleH2O. The vapor pressure, densities, enthalpies and viscosities of both
+ * phases are evaluated for randomized temperatures and pressures: The liquid
+ * properties are evaluated above the vapor pressure, the gas properties below it.
+ *
+ * For CO2, the equation of state of Span and Wagner (Opm::SpanWagnerCO2) serves as
+ * the reference for the density and the enthalpy. It is compared to Opm::CO2 using the
+ * compiled-in tables of co2tables.inc, using Opm::GeneratedCO2Tables of several
+ * resolutions and to Opm::SimpleCO2.
+ *
+ * For each model and property, the number of evaluations per second and the maximum
+ * and root mean square of the relative error are reported. Since enthalpies are only
+ * defined up to a constant, they are shifted to match the reference at the first
+ * sample and their errors are relative to the range of the reference enthalpies.
+ *
+ * If --perf-counters is given, the hardware performance counters per evaluation are
+ * reported as well, cf. Opm::PerformanceCounters.
+ *
+ * Usage: benchmark_components [--samples=N] [--repetitions=N] [--perf-counters]
+ */
+#include "config.h"
+
+#include <opm/material/components/H2O.hpp>
+#include <opm/material/components/SimpleH2O.hpp>
+#include <opm/material/components/TabulatedComponent.hpp>
+#include <opm/material/components/CO2.hpp>
+#include <opm/material/components/SimpleCO2.hpp>
+#include <opm/material/components/SpanWagnerCO2.hpp>
+#include <opm/material/components/GeneratedCO2Tables.hpp>
+#include <opm/material/common/UniformTabulated2DFunction.hpp>
+
+#include "PerformanceCounters.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Opm {
+namespace BenchmarkComponents {
+#include <opm/material/components/co2tables.inc>
+}}
+
+typedef double Scalar;
+typedef std::chrono::steady_clock Clock;
+
+static Opm::PerformanceCounters perfCounters;
+
+typedef Opm::H2O<Scalar> H2O;
+typedef Opm::CO2<Scalar, Opm::BenchmarkComponents::CO2Tables> CO2;
+typedef Opm::GeneratedCO2Tables<Scalar> GeneratedCO2Tables;
+typedef Opm::CO2<Scalar, GeneratedCO2Tables> GeneratedCO2;
+
+// the envelopes of temperatures and pressures
+static const Scalar h2oTempMin = 280.0;
+static const Scalar h2oTempMax = 500.0;
+static const Scalar h2oPressMin = 1e2;
+static const Scalar h2oPressMax = 40e6;
+
+static const Scalar co2TempMin = 290.0;
+static const Scalar co2TempMax = 380.0;
+static const Scalar co2PressMin = 1e6;
+static const Scalar co2PressMax = 40e6;
+
+// the Span-Wagner equation of state with the interface of a component
+struct SpanWagnerComponent
+{
+    typedef Opm::SpanWagnerCO2<Scalar> SpanWagner;
+
+    static Scalar gasDensity(Scalar temperature, Scalar pressure)
+    { return SpanWagner::density(temperature, pressure); }
+
+    static Scalar gasEnthalpy(Scalar temperature, Scalar pressure)
+    { return SpanWagner::enthalpy(temperature, SpanWagner::density(temperature, pressure)); }
+};
+
+// the quantities which are compared. gas properties are evaluated at the gas samples,
+// all others at the liquid samples.
+struct VaporPressure
+{
+    enum { index = 0, isGas = 0, isEnthalpy = 0 };
+    static const char* name() { return "vapor pressure"; }
+    template <class Component>
+    static Scalar eval(Scalar T, Scalar) { return Component::vaporPressure(T); }
+};
+
+struct LiquidDensity
+{
+    enum { index = 1, isGas = 0, isEnthalpy = 0 };
+    static const char* name() { return "liquid density"; }
+    template <class Component>
+    static Scalar eval(Scalar T, Scalar p) { return Component::liquidDensity(T, p); }
+};
+
+struct GasDensity
+{
+    enum { index = 2, isGas = 1, isEnthalpy = 0 };
+    static const char* name() { return "gas density"; }
+    template <class Component>
+    static Scalar eval(Scalar T, Scalar p) { return Component::gasDensity(T, p); }
+};
+
+struct LiquidEnthalpy
+{
+    enum { index = 3, isGas = 0, isEnthalpy = 1 };
+    static const char* name() { return "liquid enthalpy"; }
+    template <class Component>
+    static Scalar eval(Scalar T, Scalar p) { return Component::liquidEnthalpy(T, p); }
+};
+
+struct GasEnthalpy
+{
+    enum { index = 4, isGas = 1, isEnthalpy = 1 };
+    static const char* name() { return "gas enthalpy"; }
+    template <class Component>
+    static Scalar eval(Scalar T, Scalar p) { return Component::gasEnthalpy(T, p); }
+};
+
+struct LiquidViscosity
+{
+    enum { index = 5, isGas = 0, isEnthalpy = 0 };
+    static const char* name() { return "liquid viscosity"; }
+    template <class Component>
+    static Scalar eval(Scalar T, Scalar p) { return Component::liquidViscosity(T, p); }
+};
+
+struct GasViscosity
+{
+    enum { index = 6, isGas = 1, isEnthalpy = 0 };
+    static const char* name() { return "gas viscosity"; }
+    template <class Component>
+    static Scalar eval(Scalar T, Scalar p) { return Component::gasViscosity(T, p); }
+};
+
+static const int numProperties = 7;
+
+struct Samples
+{
+    std::vector<Scalar> temperatures;
+    std::vector<Scalar> pressures;
+};
+
+// the samples for both phases and the values of the reference model
+struct Benchmark
+{
+    Samples liquidSamples;
+    Samples gasSamples;
+    std::vector<Scalar> referenceValues[numProperties];
+    int repetitions;
+};
+
+// water: liquid samples above the vapor pressure, gas samples below it
+static void createH2OSamples(Benchmark& benchmark, size_t numSamples)
+{
+    // always use the same seed so that the runs are comparable
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<Scalar> tempDist(h2oTempMin, h2oTempMax);
+    std::uniform_real_distribution<Scalar> unitDist(0.0, 1.0);
+
+    for (size_t i = 0; i < numSamples; ++i) {
+        Scalar T = tempDist(rng);
+        Scalar pSat = H2O::vaporPressure(T);
+        benchmark.liquidSamples.temperatures.push_back(T);
+        benchmark.liquidSamples.pressures.push_back(1.05*pSat + unitDist(rng)*(h2oPressMax - 1.05*pSat));
+
+        T = tempDist(rng);
+        pSat = H2O::vaporPressure(T);
+        benchmark.gasSamples.temperatures.push_back(T);
+        benchmark.gasSamples.pressures.push_back(pSat*(0.2 + 0.75*unitDist(rng)));
+    }
+}
+
+// CO2: all samples are considered to be "gas"
+static void createCO2Samples(Benchmark& benchmark, size_t numSamples)
+{
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<Scalar> tempDist(co2TempMin, co2TempMax);
+    std::uniform_real_distribution<Scalar> pressDist(co2PressMin, co2PressMax);
+
+    for (size_t i = 0; i < numSamples; ++i) {
+        benchmark.gasSamples.temperatures.push_back(tempDist(rng));
+        benchmark.gasSamples.pressures.push_back(pressDist(rng));
+    }
+}
+
+template <class Property, class Component>
+static void measure(Benchmark& benchmark,
+                    const std::string& modelName,
+                    const std::string& resolution)
+{
+    const Samples& samples = Property::isGas ? benchmark.gasSamples : benchmark.liquidSamples;
+    size_t numSamples = samples.temperatures.size();
+    std::vector<Scalar> values(numSamples);
+
+    // the sum of the results is printed so that the compiler cannot optimize the
+    // evaluations away
+    Scalar checksum = 0.0;
+    perfCounters.reset();
+    perfCounters.start();
+    auto start = Clock::now();
+    for (int repIdx = 0; repIdx < benchmark.repetitions; ++repIdx) {
+        for (size_t i = 0; i < numSamples; ++i) {
+            values[i] = Property::template eval<Component>(samples.temperatures[i], samples.pressures[i]);
+            checksum += values[i];
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    perfCounters.stop();
+
+    // the first model which is measured is the reference
+    std::vector<Scalar>& refValues = benchmark.referenceValues[Property::index];
+    if (refValues.empty())
+        refValues = values;
+
+    Scalar shift = 0.0;
+    Scalar scale = 0.0;
+    if (Property::isEnthalpy) {
+        shift = refValues[0] - values[0];
+        auto range = std::minmax_element(refValues.begin(), refValues.end());
+        scale = *range.second - *range.first;
+    }
+
+    Scalar maxError = 0.0;
+    Scalar sumSquaredErrors = 0.0;
+    for (size_t i = 0; i < numSamples; ++i) {
+        Scalar error = std::abs(values[i] + shift - refValues[i]);
+        error /= Property::isEnthalpy ? scale : std::abs(refValues[i]);
+        maxError = std::max(maxError, error);
+        sumSquaredErrors += error*error;
+    }
+
+    double numEvals = double(numSamples)*benchmark.repetitions;
+    std::cout << std::left
+              << std::setw(24) << modelName
+              << std::setw(12) << resolution
+              << std::setw(20) << Property::name()
+              << std::right
+              << std::setw(14) << std::scientific << std::setprecision(3) << numEvals/seconds
+              << std::setw(14) << maxError
+              << std::setw(14) << std::sqrt(sumSquaredErrors/numSamples)
+              << "   (checksum: " << checksum << ")\n";
+    std::cout.unsetf(std::ios::floatfield);
+    perfCounters.printPerEvaluation(std::cout, numEvals);
+}
+
+template <class Component>
+static void measureH2O(Benchmark& benchmark,
+                       const std::string& modelName,
+                       const std::string& resolution)
+{
+    measure<VaporPressure, Component>(benchmark, modelName, resolution);
+    measure<LiquidDensity, Component>(benchmark, modelName, resolution);
+    measure<GasDensity, Component>(benchmark, modelName, resolution);
+    measure<LiquidEnthalpy, Component>(benchmark, modelName, resolution);
+    measure<GasEnthalpy, Component>(benchmark, modelName, resolution);
+    measure<LiquidViscosity, Component>(benchmark, modelName, resolution);
+    measure<GasViscosity, Component>(benchmark, modelName, resolution);
+}
+
+template <class Component>
+static void measureCO2(Benchmark& benchmark,
+                       const std::string& modelName,
+                       const std::string& resolution)
+{
+    measure<GasDensity, Component>(benchmark, modelName, resolution);
+    measure<GasEnthalpy, Component>(benchmark, modelName, resolution);
+}
+
+static std::string resolutionName(int nTemp, int nPress)
+{
+    std::ostringstream oss;
+    oss << nTemp << "x" << nPress;
+    return oss.str();
+}
+
+static void printHeader()
+{
+    std::cout << std::left
+              << std::setw(24) << "model"
+              << std::setw(12) << "resolution"
+              << std::setw(20) << "property"
+              << std::right
+              << std::setw(14) << "evals/s"
+              << std::setw(14) << "max rel err"
+              << std::setw(14) << "RMS rel err" << "\n";
+}
+
+static void runH2OBenchmarks(size_t numSamples, int repetitions)
+{
+    typedef Opm::TabulatedComponent<Scalar, H2O> TabulatedH2O;
+    typedef Opm::TabulatedComponent<Scalar, H2O, /*useVaporPressure=*/true, float> FloatTabulatedH2O;
+
+    Benchmark benchmark;
+    benchmark.repetitions = repetitions;
+    createH2OSamples(benchmark, numSamples);
+
+    std::cout << "water, T = [" << h2oTempMin << ", " << h2oTempMax << "] K, "
+              << "p = [" << h2oPressMin << ", " << h2oPressMax << "] Pa\n";
+    printHeader();
+
+    measureH2O<H2O>(benchmark, "H2O (IAPWS)", "-");
+
+    static const int resolutions[] = { 25, 50, 100, 200, 400 };
+    for (int n : resolutions) {
+        std::string resolution = resolutionName(n, n);
+
+        TabulatedH2O::init(h2oTempMin, h2oTempMax, n, h2oPressMin, h2oPressMax, n);
+        measureH2O<TabulatedH2O>(benchmark, "tabulated, bilinear", resolution);
+
+        TabulatedH2O::init(h2oTempMin, h2oTempMax, n, h2oPressMin, h2oPressMax, n,
+                           /*lazy=*/false, /*bicubic=*/true);
+        measureH2O<TabulatedH2O>(benchmark, "tabulated, bicubic", resolution);
+
+        FloatTabulatedH2O::init(h2oTempMin, h2oTempMax, n, h2oPressMin, h2oPressMax, n);
+        measureH2O<FloatTabulatedH2O>(benchmark, "tabulated, float", resolution);
+    }
+
+    measureH2O<Opm::SimpleH2O<Scalar> >(benchmark, "SimpleH2O", "-");
+}
+
+static void runCO2Benchmarks(size_t numSamples, int repetitions)
+{
+    typedef Opm::BenchmarkComponents::TabulatedDensityTraits DensityTraits;
+
+    Benchmark benchmark;
+    benchmark.repetitions = repetitions;
+    createCO2Samples(benchmark, numSamples);
+
+    std::cout << "CO2, T = [" << co2TempMin << ", " << co2TempMax << "] K, "
+              << "p = [" << co2PressMin << ", " << co2PressMax << "] Pa\n";
+    printHeader();
+
+    measureCO2<SpanWagnerComponent>(benchmark, "Span-Wagner", "-");
+    measureCO2<CO2>(benchmark, "CO2, co2tables.inc",
+                    resolutionName(DensityTraits::numX, DensityTraits::numY));
+
+    static const int resolutions[][2] = { { 25, 50 }, { 50, 100 }, { 100, 200 }, { 200, 400 } };
+    for (const auto& n : resolutions) {
+        GeneratedCO2Tables::init(co2TempMin, co2TempMax, n[0], co2PressMin, co2PressMax, n[1]);
+        measureCO2<GeneratedCO2>(benchmark, "CO2, generated tables", resolutionName(n[0], n[1]));
+    }
+
+    measureCO2<Opm::SimpleCO2<Scalar> >(benchmark, "SimpleCO2", "-");
+}
+
+static bool parseOption(const char* arg, const char* name, std::string& value)
+{
+    size_t len = std::strlen(name);
+    if (std::strncmp(arg, name, len) != 0 || arg[len] != '=')
+        return false;
+    value = arg + len + 1;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    size_t numSamples = 20000;
+    int repetitions = 3;
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        std::string value;
+        if (parseOption(argv[argIdx], "--samples", value))
+            numSamples = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--repetitions", value))
+            repetitions = std::atoi(value.c_str());
+        else if (std::strcmp(argv[argIdx], "--perf-counters") == 0) {
+            if (!perfCounters.enable())
+                std::cerr << "Warning: The hardware performance counters are not available\n";
+        }
+        else {
+            std::cerr << "Unknown option '" << argv[argIdx] << "'\n"
+                      << "Usage: " << argv[0] << " [--samples=N] [--repetitions=N] [--perf-counters]\n";
+            return 1;
+        }
+    }
+
+    if (numSamples < 1 || repetitions < 1) {
+        std::cerr << "The number of samples and the number of repetitions must be positive\n";
+        return 1;
+    }
+
+    std::cout << numSamples << " samples per phase, " << repetitions << " repetitions\n\n";
+    runH2OBenchmarks(numSamples, repetitions);
+    std::cout << "\n";
+    runCO2Benchmarks(numSamples, repetitions);
+
+    return 0;
+}
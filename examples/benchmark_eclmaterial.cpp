@@ -0,0 +1,506 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Measures the throughput of the saturation functions which are created by
+ *        the EclMaterialLawManager.
+ *
+ * For each configuration (two-phase, default, Stone1 and Stone2 three-phase
+ * approaches, each with and without end-point scaling and hysteresis) a synthetic
+ * ECL deck for a Cartesian grid is created and the number of cells per second is
+ * reported for the evaluation of the relative permeabilities and capillary pressures
+ * (element by element and using the bulk interface of the manager) and for the update of the hysteresis parameters.
+ *
+ * Usage: benchmark_eclmaterial [--nx=N] [--ny=N] [--nz=N] [--repetitions=N]
+ *                              [--compact-storage] [--precomputed-curves]
+ *                              [--table-resolution=N] [--perf-counters]
+ *                              [--memory-report] [--mapped-storage=PREFIX]
+ *
+ * By default, a grid of 100x100x100 cells is used. If --perf-counters is given, the
+ * hardware performance counters per cell are reported for the evaluation of the
+ * relative permeabilities and capillary pressures, cf. Opm::PerformanceCounters.
+ *
+ * If --memory-report is given, nothing is timed. Instead, the manager is created for
+ * grids with 1, 2, 4, ... up to nz layers and the memory per cell is reported for each
+ * component of the parameters (cf. EclMaterialLawManager::memoryUsage()). Since the
+ * scaled end points differ between the layers, this shows how sharing them behaves
+ * for growing grids.
+ *
+ * If --mapped-storage is given, the parameters of the elements are stored in memory
+ * mapped files whose names start with PREFIX, cf.
+ * EclMaterialLawManager::setEnableMappedStorage().
+ */
+#include "config.h"
+
+#if HAVE_OPM_PARSER
+#include <opm/material/fluidmatrixinteractions/EclMaterialLawManager.hpp>
+#include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
+#include <opm/material/fluidstates/SimpleModularFluidState.hpp>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Parser/ParseMode.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+#endif
+
+#include "PerformanceCounters.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if HAVE_OPM_PARSER
+typedef double Scalar;
+typedef Opm::ThreePhaseMaterialTraits<Scalar,
+                                      /*wettingPhaseIdx=*/0,
+                                      /*nonWettingPhaseIdx=*/1,
+                                      /*gasPhaseIdx=*/2> MaterialTraits;
+typedef Opm::EclMaterialLawManager<MaterialTraits> MaterialLawManager;
+typedef MaterialLawManager::MaterialLaw MaterialLaw;
+
+// a fluid state which only stores the saturations
+typedef Opm::SimpleModularFluidState<Scalar,
+                                     /*numPhases=*/3,
+                                     /*numComponents=*/0,
+                                     /*FluidSystem=*/void,
+                                     /*storePressure=*/false,
+                                     /*storeTemperature=*/false,
+                                     /*storeComposition=*/false,
+                                     /*storeFugacity=*/false,
+                                     /*storeSaturation=*/true,
+                                     /*storeDensity=*/false,
+                                     /*storeViscosity=*/false,
+                                     /*storeEnthalpy=*/false> FluidState;
+
+typedef std::chrono::steady_clock Clock;
+
+static Opm::PerformanceCounters perfCounters;
+
+enum { waterPhaseIdx = MaterialTraits::wettingPhaseIdx };
+enum { oilPhaseIdx = MaterialTraits::nonWettingPhaseIdx };
+enum { gasPhaseIdx = MaterialTraits::gasPhaseIdx };
+
+struct BenchmarkOptions
+{
+    int nx = 100;
+    int ny = 100;
+    int nz = 100;
+    int repetitions = 5;
+    bool compactStorage = false;
+    bool precomputedCurves = false;
+    unsigned tableResolution = 0;
+    bool memoryReport = false;
+    bool mappedStorage = false;
+    std::string mappedStoragePrefix;
+};
+
+struct Configuration
+{
+    const char* name;
+    bool twoPhase;
+    const char* threePhaseKeyword; // empty for the default approach
+    bool endPointScaling;
+    bool hysteresis;
+};
+
+static double secondsSince(Clock::time_point start)
+{ return std::chrono::duration<double>(Clock::now() - start).count(); }
+
+// write a grid property which is constant within each layer but varies between them
+static void writeLayeredProperty(std::ostream& os,
+                                 const char* keyword,
+                                 const BenchmarkOptions& opts,
+                                 Scalar minValue,
+                                 Scalar maxValue)
+{
+    os << keyword << "\n";
+    for (int k = 0; k < opts.nz; ++k) {
+        Scalar alpha = (opts.nz > 1) ? Scalar(k)/(opts.nz - 1) : 0.0;
+        os << "  " << opts.nx*opts.ny << "*" << minValue + alpha*(maxValue - minValue) << "\n";
+    }
+    os << "/\n\n";
+}
+
+static std::string createDeckString(const Configuration& config, const BenchmarkOptions& opts)
+{
+    int numCells = opts.nx*opts.ny*opts.nz;
+
+    std::ostringstream os;
+    os << "RUNSPEC\n\n"
+       << "DIMENS\n  " << opts.nx << " " << opts.ny << " " << opts.nz << " /\n\n"
+       << "OIL\n\nWATER\n\n";
+    if (!config.twoPhase)
+        os << "GAS\n\n";
+    os << "TABDIMS\n  2 /\n\n";
+    if (config.endPointScaling)
+        os << "ENDSCALE\n  /\n\n";
+    if (config.hysteresis)
+        os << "SATOPTS\n  'HYSTER' /\n\n";
+
+    os << "GRID\n\n"
+       << "DX\n  " << numCells << "*10 /\n"
+       << "DY\n  " << numCells << "*10 /\n"
+       << "DZ\n  " << numCells << "*1 /\n"
+       << "TOPS\n  " << opts.nx*opts.ny << "*1000 /\n"
+       << "PORO\n  " << numCells << "*0.2 /\n\n";
+
+    os << "PROPS\n\n";
+    if (std::strlen(config.threePhaseKeyword) > 0)
+        os << config.threePhaseKeyword << "\n\n";
+    if (config.hysteresis)
+        os << "EHYSTR\n  0.1 0 /\n\n";
+
+    // the first table is used for drainage, the second one for imbibition
+    os << "SWOF\n"
+       << "  0.10 0.000 1.000 2.0\n"
+       << "  0.20 0.002 0.810 1.2\n"
+       << "  0.30 0.010 0.600 0.8\n"
+       << "  0.40 0.030 0.420 0.5\n"
+       << "  0.50 0.070 0.270 0.3\n"
+       << "  0.60 0.120 0.150 0.2\n"
+       << "  0.70 0.200 0.060 0.1\n"
+       << "  0.80 0.300 0.010 0.05\n"
+       << "  0.90 0.420 0.000 0.0\n"
+       << "  1.00 0.550 0.000 0.0 /\n"
+       << "  0.10 0.000 1.000 1.5\n"
+       << "  0.25 0.004 0.700 0.8\n"
+       << "  0.40 0.025 0.430 0.4\n"
+       << "  0.55 0.080 0.210 0.2\n"
+       << "  0.70 0.170 0.070 0.1\n"
+       << "  0.85 0.300 0.000 0.0\n"
+       << "  1.00 0.480 0.000 0.0 /\n\n";
+    if (!config.twoPhase)
+        os << "SGOF\n"
+           << "  0.00 0.000 1.000 0.0\n"
+           << "  0.05 0.000 0.860 0.01\n"
+           << "  0.15 0.020 0.600 0.03\n"
+           << "  0.30 0.100 0.300 0.07\n"
+           << "  0.45 0.250 0.110 0.12\n"
+           << "  0.60 0.450 0.020 0.18\n"
+           << "  0.75 0.700 0.000 0.25\n"
+           << "  0.90 1.000 0.000 0.35 /\n"
+           << "  0.00 0.000 1.000 0.0\n"
+           << "  0.10 0.010 0.750 0.02\n"
+           << "  0.25 0.060 0.400 0.05\n"
+           << "  0.40 0.180 0.160 0.09\n"
+           << "  0.60 0.420 0.020 0.16\n"
+           << "  0.90 0.900 0.000 0.30 /\n\n";
+
+    if (config.endPointScaling) {
+        writeLayeredProperty(os, "SWL", opts, 0.10, 0.18);
+        writeLayeredProperty(os, "SWCR", opts, 0.15, 0.25);
+        writeLayeredProperty(os, "SOWCR", opts, 0.10, 0.20);
+        if (!config.twoPhase) {
+            writeLayeredProperty(os, "SGCR", opts, 0.03, 0.08);
+            writeLayeredProperty(os, "SOGCR", opts, 0.10, 0.20);
+        }
+    }
+
+    os << "REGIONS\n\n"
+       << "SATNUM\n  " << numCells << "*1 /\n";
+    if (config.hysteresis)
+        os << "IMBNUM\n  " << numCells << "*2 /\n";
+    os << "\n";
+
+    return os.str();
+}
+
+// deterministic pseudo-random saturations which cover the whole range of the tables
+static void createFluidStates(std::vector<FluidState>& fluidStates,
+                              const Configuration& config,
+                              Scalar shift)
+{
+    for (size_t elemIdx = 0; elemIdx < fluidStates.size(); ++elemIdx) {
+        Scalar alpha = std::abs(std::sin(0.37*elemIdx + shift));
+        Scalar beta = std::abs(std::cos(0.11*elemIdx + shift));
+
+        Scalar Sw = 0.1 + 0.8*alpha;
+        Scalar Sg = config.twoPhase ? 0.0 : (1 - Sw)*0.8*beta;
+
+        auto& fs = fluidStates[elemIdx];
+        fs.setSaturation(waterPhaseIdx, Sw);
+        fs.setSaturation(gasPhaseIdx, Sg);
+        fs.setSaturation(oilPhaseIdx, 1 - Sw - Sg);
+    }
+}
+
+static void runConfiguration(const Configuration& config, const BenchmarkOptions& opts)
+{
+    Opm::ParserPtr parser(new Opm::Parser);
+    Opm::ParseMode parseMode;
+    Opm::DeckConstPtr deck = parser->parseString(createDeckString(config, opts), parseMode);
+    Opm::EclipseStateConstPtr eclState(new Opm::EclipseState(deck, parseMode));
+
+    unsigned numElems = opts.nx*opts.ny*opts.nz;
+    std::vector<int> compressedToCartesianElemIdx(numElems);
+    for (unsigned elemIdx = 0; elemIdx < numElems; ++elemIdx)
+        compressedToCartesianElemIdx[elemIdx] = elemIdx;
+
+    MaterialLawManager materialLawManager;
+    materialLawManager.setEnableCompactStorage(opts.compactStorage);
+    materialLawManager.setEnableMappedStorage(opts.mappedStorage, opts.mappedStoragePrefix);
+    materialLawManager.setEnablePrecomputedCurves(opts.precomputedCurves);
+    materialLawManager.setSaturationTableResolution(opts.tableResolution);
+
+    auto start = Clock::now();
+    materialLawManager.initFromDeck(deck, eclState, compressedToCartesianElemIdx);
+    double initTime = secondsSince(start);
+
+    std::vector<FluidState> fluidStates(numElems);
+    createFluidStates(fluidStates, config, /*shift=*/0.0);
+
+    // evaluation of the relative permeabilities and capillary pressures. the sum of
+    // the results is printed to make sure that the compiler does not optimize the
+    // loop away.
+    Scalar checksum = 0.0;
+    perfCounters.reset();
+    perfCounters.start();
+    start = Clock::now();
+    for (int repIdx = 0; repIdx < opts.repetitions; ++repIdx) {
+        for (unsigned elemIdx = 0; elemIdx < numElems; ++elemIdx) {
+            Scalar kr[3] = { 0.0, 0.0, 0.0 };
+            Scalar pc[3] = { 0.0, 0.0, 0.0 };
+            const auto& params = materialLawManager.materialLawParams(elemIdx);
+            MaterialLaw::relativePermeabilities(kr, params, fluidStates[elemIdx]);
+            MaterialLaw::capillaryPressures(pc, params, fluidStates[elemIdx]);
+            checksum += kr[0] + kr[1] + kr[2] + pc[gasPhaseIdx] - pc[waterPhaseIdx];
+        }
+    }
+    double evalTime = secondsSince(start);
+    perfCounters.stop();
+    double numEvaluations = double(numElems)*opts.repetitions;
+    std::ostringstream evalCounters;
+    perfCounters.printPerEvaluation(evalCounters, numEvaluations, "    kr+pc, per cell:");
+
+    // the same quantities using the bulk interface of the manager. both checksums
+    // should agree.
+    std::vector<Scalar> Sw(numElems), Sg(numElems);
+    for (unsigned elemIdx = 0; elemIdx < numElems; ++elemIdx) {
+        Sw[elemIdx] = fluidStates[elemIdx].saturation(waterPhaseIdx);
+        Sg[elemIdx] = fluidStates[elemIdx].saturation(gasPhaseIdx);
+    }
+    std::vector<Scalar> krw(numElems), kro(numElems), krg(numElems), pcow(numElems), pcgo(numElems);
+    Scalar bulkChecksum = 0.0;
+    perfCounters.reset();
+    perfCounters.start();
+    start = Clock::now();
+    for (int repIdx = 0; repIdx < opts.repetitions; ++repIdx) {
+        materialLawManager.saturationFunctionsBatch(MaterialLawManager::AllSaturationFunctions,
+                                                    Sw.data(), Sg.data(),
+                                                    krw.data(), kro.data(), krg.data(),
+                                                    pcow.data(), pcgo.data());
+        for (unsigned elemIdx = 0; elemIdx < numElems; ++elemIdx)
+            bulkChecksum += krw[elemIdx] + kro[elemIdx] + krg[elemIdx] + pcow[elemIdx] + pcgo[elemIdx];
+    }
+    double bulkEvalTime = secondsSince(start);
+    perfCounters.stop();
+
+    // update of the hysteresis parameters. the saturations are changed for each
+    // repetition, so that the reversal points actually move.
+    double hysteresisTime = 0.0;
+    if (materialLawManager.enableHysteresis()) {
+        for (int repIdx = 0; repIdx < opts.repetitions; ++repIdx) {
+            createFluidStates(fluidStates, config, /*shift=*/0.1*(repIdx + 1));
+            start = Clock::now();
+            materialLawManager.updateHysteresis(fluidStates);
+            hysteresisTime += secondsSince(start);
+        }
+    }
+
+    std::cout << std::left << std::setw(24) << config.name << std::right
+              << std::setw(12) << std::setprecision(3) << initTime
+              << std::setw(16) << std::setprecision(4) << numEvaluations/evalTime
+              << std::setw(16) << numEvaluations/bulkEvalTime;
+    if (materialLawManager.enableHysteresis())
+        std::cout << std::setw(16) << numEvaluations/hysteresisTime;
+    else
+        std::cout << std::setw(16) << "-";
+    std::cout << "   (checksums: " << checksum << ", " << bulkChecksum << ")\n";
+    std::cout << evalCounters.str();
+    perfCounters.printPerEvaluation(std::cout, numEvaluations, "    bulk, per cell:");
+}
+
+// print the memory per cell used by the manager of a configuration for grids with an
+// increasing number of layers
+static void runMemoryReport(const Configuration& config, const BenchmarkOptions& opts)
+{
+    for (int nz = 1; ; nz = std::min(2*nz, opts.nz)) {
+        BenchmarkOptions gridOpts = opts;
+        gridOpts.nz = nz;
+
+        Opm::ParserPtr parser(new Opm::Parser);
+        Opm::ParseMode parseMode;
+        Opm::DeckConstPtr deck = parser->parseString(createDeckString(config, gridOpts), parseMode);
+        Opm::EclipseStateConstPtr eclState(new Opm::EclipseState(deck, parseMode));
+
+        unsigned numElems = opts.nx*opts.ny*nz;
+        std::vector<int> compressedToCartesianElemIdx(numElems);
+        for (unsigned elemIdx = 0; elemIdx < numElems; ++elemIdx)
+            compressedToCartesianElemIdx[elemIdx] = elemIdx;
+
+        MaterialLawManager materialLawManager;
+        materialLawManager.setEnableCompactStorage(opts.compactStorage);
+        materialLawManager.setEnableMappedStorage(opts.mappedStorage, opts.mappedStoragePrefix);
+        materialLawManager.setEnablePrecomputedCurves(opts.precomputedCurves);
+        materialLawManager.setSaturationTableResolution(opts.tableResolution);
+        materialLawManager.initFromDeck(deck, eclState, compressedToCartesianElemIdx);
+
+        const auto usage = materialLawManager.memoryUsage();
+        double n = numElems;
+        std::cout << std::left << std::setw(24) << config.name << std::right
+                  << std::setw(12) << numElems
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(10) << usage.params/n
+                  << std::setw(10) << usage.scalingPoints/n
+                  << std::setw(10) << usage.scalingInfo/n
+                  << std::setw(10) << usage.hysteresisState/n
+                  << std::setw(10) << usage.overhead/n
+                  << std::setw(10) << usage.other/n
+                  << std::setw(10) << usage.total()/n << "\n";
+        std::cout.unsetf(std::ios::floatfield);
+
+        if (nz == opts.nz)
+            break;
+    }
+}
+
+static bool parseOption(const char* arg, const char* name, std::string& value)
+{
+    size_t len = std::strlen(name);
+    if (std::strncmp(arg, name, len) != 0)
+        return false;
+    if (arg[len] == '=')
+        value = arg + len + 1;
+    else if (arg[len] == '\0')
+        value.clear();
+    else
+        return false;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions opts;
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        std::string value;
+        if (parseOption(argv[argIdx], "--nx", value))
+            opts.nx = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--ny", value))
+            opts.ny = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--nz", value))
+            opts.nz = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--repetitions", value))
+            opts.repetitions = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--compact-storage", value))
+            opts.compactStorage = true;
+        else if (parseOption(argv[argIdx], "--precomputed-curves", value))
+            opts.precomputedCurves = true;
+        else if (parseOption(argv[argIdx], "--table-resolution", value))
+            opts.tableResolution = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--perf-counters", value)) {
+            if (!perfCounters.enable())
+                std::cerr << "Warning: The hardware performance counters are not available\n";
+        }
+        else if (parseOption(argv[argIdx], "--memory-report", value))
+            opts.memoryReport = true;
+        else if (parseOption(argv[argIdx], "--mapped-storage", value)) {
+            opts.mappedStorage = true;
+            opts.mappedStoragePrefix = value;
+        }
+        else {
+            std::cerr << "Unknown option '" << argv[argIdx] << "'\n"
+                      << "Usage: " << argv[0] << " [--nx=N] [--ny=N] [--nz=N] [--repetitions=N]"
+                      << " [--compact-storage] [--precomputed-curves] [--table-resolution=N]"
+                      << " [--perf-counters] [--memory-report] [--mapped-storage=PREFIX]\n";
+            return 1;
+        }
+    }
+
+    if (opts.nx < 1 || opts.ny < 1 || opts.nz < 1 || opts.repetitions < 1) {
+        std::cerr << "The grid dimensions and the number of repetitions must be positive\n";
+        return 1;
+    }
+
+    static const Configuration configurations[] = {
+        // name, twoPhase, threePhaseKeyword, endPointScaling, hysteresis
+        { "twophase", true, "", false, false },
+        { "twophase+eps", true, "", true, false },
+        { "twophase+hyst", true, "", false, true },
+        { "twophase+eps+hyst", true, "", true, true },
+        { "default", false, "", false, false },
+        { "default+eps", false, "", true, false },
+        { "default+hyst", false, "", false, true },
+        { "default+eps+hyst", false, "", true, true },
+        { "stone1", false, "STONE1", false, false },
+        { "stone1+eps", false, "STONE1", true, false },
+        { "stone1+hyst", false, "STONE1", false, true },
+        { "stone1+eps+hyst", false, "STONE1", true, true },
+        { "stone2", false, "STONE2", false, false },
+        { "stone2+eps", false, "STONE2", true, false },
+        { "stone2+hyst", false, "STONE2", false, true },
+        { "stone2+eps+hyst", false, "STONE2", true, true },
+    };
+
+    if (opts.memoryReport) {
+        std::cout << "memory per cell [bytes], " << opts.nx << "x" << opts.ny
+                  << "xN grids, compact storage: " << (opts.compactStorage ? "yes" : "no") << "\n"
+                  << std::left << std::setw(24) << "configuration" << std::right
+                  << std::setw(12) << "cells"
+                  << std::setw(10) << "params"
+                  << std::setw(10) << "points"
+                  << std::setw(10) << "info"
+                  << std::setw(10) << "hyst"
+                  << std::setw(10) << "overhead"
+                  << std::setw(10) << "other"
+                  << std::setw(10) << "total" << "\n";
+        for (const auto& config : configurations)
+            runMemoryReport(config, opts);
+        return 0;
+    }
+
+    std::cout << "grid: " << opts.nx << "x" << opts.ny << "x" << opts.nz
+              << " cells, " << opts.repetitions << " repetitions\n"
+              << std::left << std::setw(24) << "configuration" << std::right
+              << std::setw(12) << "init [s]"
+              << std::setw(16) << "kr+pc [cells/s]"
+              << std::setw(16) << "bulk [cells/s]"
+              << std::setw(16) << "hyst [cells/s]" << "\n";
+
+    for (const auto& config : configurations)
+        runConfiguration(config, opts);
+
+    return 0;
+}
+#else
+int main()
+{
+    std::cout << "This benchmark requires the opm-parser module\n";
+    return 0;
+}
+#endif
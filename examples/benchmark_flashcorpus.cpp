@@ -0,0 +1,361 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Replays a corpus of difficult flash calculations for the SPE-5 fluid system.
+ *
+ * The corpus is either read from a file which was written by
+ * Opm::ConstraintSolverCorpus::save() (e.g., by a simulator which attached a corpus to
+ * the flash solvers), or it is generated by flashing randomized mixtures of the SPE-5
+ * reservoir oil and the injection gas from scratch. Contrary to benchmark_ncpflash,
+ * the generated mixtures cover the whole range of compositions and pressures, i.e.,
+ * they include mixtures close to their critical point and at the boundaries of the
+ * two-phase region, and only the calls of Opm::NcpFlash and
+ * Opm::CompositionFromFugacities which fail or which need many iterations are kept.
+ *
+ * Each record is replayed several times. For each solver, the number of records, the
+ * number of failed replays, the average and maximum number of iterations, the time
+ * per call and the number of records for which the replay does not reproduce the
+ * recorded number of iterations are reported, followed by the slowest records. The
+ * material law of the flash calculations is assumed to exhibit no capillary pressure.
+ *
+ * Usage: benchmark_flashcorpus [--corpus=FILE] [--capture=FILE] [--samples=N]
+ *                              [--min-iterations=N] [--repetitions=N]
+ */
+#include "config.h"
+
+#include <opm/material/constraintsolvers/ComputeFromReferencePhase.hpp>
+#include <opm/material/constraintsolvers/CompositionFromFugacities.hpp>
+#include <opm/material/constraintsolvers/ConstraintSolverCorpus.hpp>
+#include <opm/material/constraintsolvers/NcpFlash.hpp>
+#include <opm/material/fluidstates/CompositionalFluidState.hpp>
+#include <opm/material/fluidsystems/Spe5FluidSystem.hpp>
+#include <opm/material/fluidmatrixinteractions/LinearMaterial.hpp>
+#include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
+
+#include <dune/common/fvector.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef double Scalar;
+typedef std::chrono::steady_clock Clock;
+
+typedef Opm::FluidSystems::Spe5<Scalar> FluidSystem;
+
+enum {
+    numPhases = FluidSystem::numPhases,
+    numComponents = FluidSystem::numComponents,
+
+    waterPhaseIdx = FluidSystem::waterPhaseIdx,
+    gasPhaseIdx = FluidSystem::gasPhaseIdx,
+    oilPhaseIdx = FluidSystem::oilPhaseIdx,
+
+    C1Idx = FluidSystem::C1Idx,
+    C3Idx = FluidSystem::C3Idx,
+    C6Idx = FluidSystem::C6Idx,
+    C10Idx = FluidSystem::C10Idx,
+    C15Idx = FluidSystem::C15Idx,
+    C20Idx = FluidSystem::C20Idx
+};
+
+typedef Dune::FieldVector<Scalar, numComponents> ComponentVector;
+typedef Opm::CompositionalFluidState<Scalar, FluidSystem> FluidState;
+
+typedef Opm::ThreePhaseMaterialTraits<Scalar, waterPhaseIdx, oilPhaseIdx, gasPhaseIdx> MaterialTraits;
+typedef Opm::LinearMaterial<MaterialTraits> MaterialLaw;
+typedef MaterialLaw::Params MaterialLawParams;
+
+typedef Opm::NcpFlash<Scalar, FluidSystem> Flash;
+typedef Opm::CompositionFromFugacities<Scalar, FluidSystem> CompositionSolver;
+typedef Flash::SolverStatus SolverStatus;
+
+static const Scalar temperature = 273.15 + 20.0;
+
+// the capillary pressures are zero
+static MaterialLawParams createMaterialParams()
+{
+    MaterialLawParams matParams;
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        matParams.setPcMinSat(phaseIdx, 0.0);
+        matParams.setPcMaxSat(phaseIdx, 0.0);
+    }
+    matParams.finalize();
+    return matParams;
+}
+
+// flash randomized mixtures from scratch with the corpus attached to the solvers.
+// the initial guess is a single oil phase of the overall composition whose other
+// phases are determined by the equality of the fugacities. this calls
+// CompositionFromFugacities, so its difficult calls are recorded as well.
+static void captureCorpus(Opm::ConstraintSolverCorpus& corpus, size_t numSamples)
+{
+    typedef Opm::ComputeFromReferencePhase<Scalar, FluidSystem> CFRP;
+
+    // SPE-5 reservoir oil and injection gas
+    ComponentVector oil(0.0);
+    oil[C1Idx] = 0.50;
+    oil[C3Idx] = 0.03;
+    oil[C6Idx] = 0.07;
+    oil[C10Idx] = 0.20;
+    oil[C15Idx] = 0.15;
+    oil[C20Idx] = 0.05;
+
+    ComponentVector gas(0.0);
+    gas[C1Idx] = 0.77;
+    gas[C3Idx] = 0.20;
+    gas[C6Idx] = 0.03;
+
+    // always use the same seed so that the runs are comparable
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<Scalar> gasFractionDist(0.0, 1.0);
+    std::uniform_real_distribution<Scalar> pressureDist(30e5, 300e5);
+
+    MaterialLawParams matParams = createMaterialParams();
+
+    Flash::setCorpus(&corpus);
+    CompositionSolver::setCorpus(&corpus);
+    for (size_t sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx) {
+        Scalar gasFraction = gasFractionDist(rng);
+        Scalar pressure = pressureDist(rng);
+
+        FluidState fluidState;
+        fluidState.setTemperature(temperature);
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            fluidState.setPressure(phaseIdx, pressure);
+            fluidState.setSaturation(phaseIdx, (phaseIdx == oilPhaseIdx) ? 1.0 : 0.0);
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                fluidState.setMoleFraction(phaseIdx, compIdx,
+                                           (1 - gasFraction)*oil[compIdx] + gasFraction*gas[compIdx]);
+        }
+
+        FluidSystem::ParameterCache paramCache;
+        try {
+            CFRP::solve(fluidState,
+                        paramCache,
+                        /*refPhaseIdx=*/oilPhaseIdx,
+                        /*setViscosity=*/false,
+                        /*setEnthalpy=*/false);
+        }
+        catch (const Opm::NumericalIssue&) {
+            // the failure has been recorded
+            continue;
+        }
+
+        ComponentVector globalMolarities;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            globalMolarities[compIdx] = fluidState.molarity(oilPhaseIdx, compIdx);
+
+        Flash::trySolve<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities);
+    }
+    Flash::setCorpus(nullptr);
+    CompositionSolver::setCorpus(nullptr);
+}
+
+// the outcome of the replays of a corpus for a single solver
+struct SolverResult
+{
+    SolverResult()
+        : numRecords(0)
+        , numFailed(0)
+        , numChanged(0)
+        , numCalls(0)
+        , totalIterations(0)
+        , maxIterations(0)
+        , seconds(0.0)
+    {}
+
+    size_t numRecords;
+    size_t numFailed;
+    size_t numChanged;
+    size_t numCalls;
+    size_t totalIterations;
+    int maxIterations;
+    double seconds;
+};
+
+static void replayCorpus(const Opm::ConstraintSolverCorpus& corpus, int repetitions)
+{
+    const std::vector<Opm::ConstraintSolverCorpus::Record>& records = corpus.records();
+    MaterialLawParams matParams = createMaterialParams();
+
+    SolverResult flashResult;
+    SolverResult compositionResult;
+    size_t numSkipped = 0;
+    std::vector<double> recordSeconds(records.size(), 0.0);
+    for (size_t recIdx = 0; recIdx < records.size(); ++recIdx) {
+        const Opm::ConstraintSolverCorpus::Record& rec = records[recIdx];
+
+        SolverResult* result;
+        if (rec.solver == Flash::corpusName())
+            result = &flashResult;
+        else if (rec.solver == CompositionSolver::corpusName())
+            result = &compositionResult;
+        else {
+            ++ numSkipped;
+            continue;
+        }
+
+        SolverStatus status;
+        auto start = Clock::now();
+        for (int repIdx = 0; repIdx < repetitions; ++repIdx) {
+            FluidState fluidState;
+            if (result == &flashResult)
+                status = Flash::replay<MaterialLaw>(fluidState, rec, matParams);
+            else
+                status = CompositionSolver::replay(fluidState, rec);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        recordSeconds[recIdx] = seconds/repetitions;
+
+        ++ result->numRecords;
+        result->numCalls += repetitions;
+        result->seconds += seconds;
+        result->totalIterations += status.iterations;
+        result->maxIterations = std::max(result->maxIterations, status.iterations);
+        if (!status.converged())
+            ++ result->numFailed;
+        if (status.iterations != rec.iterations || status.result != rec.result)
+            ++ result->numChanged;
+    }
+
+    std::cout << std::left
+              << std::setw(28) << "solver"
+              << std::right
+              << std::setw(10) << "records"
+              << std::setw(10) << "failed"
+              << std::setw(12) << "avg. iter"
+              << std::setw(12) << "max. iter"
+              << std::setw(12) << "us/call"
+              << std::setw(10) << "changed" << "\n";
+    const SolverResult* results[2] = { &flashResult, &compositionResult };
+    const char* names[2] = { Flash::corpusName(), CompositionSolver::corpusName() };
+    for (int solverIdx = 0; solverIdx < 2; ++solverIdx) {
+        const SolverResult& r = *results[solverIdx];
+        if (r.numRecords == 0)
+            continue;
+        std::cout << std::left
+                  << std::setw(28) << names[solverIdx]
+                  << std::right
+                  << std::setw(10) << r.numRecords
+                  << std::setw(10) << r.numFailed
+                  << std::setw(12) << std::fixed << std::setprecision(2)
+                  << double(r.totalIterations)/r.numRecords
+                  << std::setw(12) << r.maxIterations
+                  << std::setw(12) << r.seconds/r.numCalls*1e6
+                  << std::setw(10) << r.numChanged << "\n";
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    if (numSkipped > 0)
+        std::cout << numSkipped << " records of other solvers were skipped\n";
+
+    // the slowest records
+    std::vector<size_t> order(records.size());
+    for (size_t recIdx = 0; recIdx < records.size(); ++recIdx)
+        order[recIdx] = recIdx;
+    size_t numSlowest = std::min<size_t>(5, records.size());
+    std::partial_sort(order.begin(), order.begin() + numSlowest, order.end(),
+                      [&](size_t a, size_t b) { return recordSeconds[a] > recordSeconds[b]; });
+    std::cout << "\nslowest records:\n";
+    for (size_t i = 0; i < numSlowest; ++i) {
+        const Opm::ConstraintSolverCorpus::Record& rec = records[order[i]];
+        std::cout << "  #" << std::left << std::setw(8) << order[i]
+                  << std::setw(28) << rec.solver
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << recordSeconds[order[i]]*1e6 << " us, "
+                  << rec.iterations << " recorded iterations\n";
+        std::cout.unsetf(std::ios::floatfield);
+    }
+}
+
+static bool parseOption(const char* arg, const char* name, std::string& value)
+{
+    size_t len = std::strlen(name);
+    if (std::strncmp(arg, name, len) != 0 || arg[len] != '=')
+        return false;
+    value = arg + len + 1;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    std::string corpusFileName;
+    std::string captureFileName;
+    size_t numSamples = 2000;
+    int minIterations = 10;
+    int repetitions = 5;
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        std::string value;
+        if (parseOption(argv[argIdx], "--corpus", value))
+            corpusFileName = value;
+        else if (parseOption(argv[argIdx], "--capture", value))
+            captureFileName = value;
+        else if (parseOption(argv[argIdx], "--samples", value))
+            numSamples = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--min-iterations", value))
+            minIterations = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--repetitions", value))
+            repetitions = std::atoi(value.c_str());
+        else {
+            std::cerr << "Unknown option '" << argv[argIdx] << "'\n"
+                      << "Usage: " << argv[0] << " [--corpus=FILE] [--capture=FILE] [--samples=N]"
+                      << " [--min-iterations=N] [--repetitions=N]\n";
+            return 1;
+        }
+    }
+
+    if (repetitions < 1) {
+        std::cerr << "The number of repetitions must be positive\n";
+        return 1;
+    }
+
+    FluidSystem::init(/*minTemperature=*/temperature - 1,
+                      /*maxTemperature=*/temperature + 1,
+                      /*minPressure=*/1.0e4,
+                      /*maxPressure=*/40.0e6);
+
+    Opm::ConstraintSolverCorpus corpus(minIterations);
+    if (!corpusFileName.empty()) {
+        corpus.load(corpusFileName);
+        std::cout << corpus.size() << " records read from '" << corpusFileName << "', ";
+    }
+    else {
+        captureCorpus(corpus, numSamples);
+        std::cout << corpus.size() << " records captured from " << numSamples
+                  << " SPE-5 mixtures, ";
+    }
+    std::cout << repetitions << " repetitions\n";
+
+    if (!captureFileName.empty())
+        corpus.save(captureFileName);
+
+    replayCorpus(corpus, repetitions);
+
+    return 0;
+}
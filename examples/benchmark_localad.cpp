@@ -0,0 +1,354 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Measures the speed of the operators and math functions of the localized
+ *        automatic differentiation framework.
+ *
+ * The operators +, *, / and the functions exp, log, pow (with a scalar exponent),
+ * sqrt, min and max are timed for function evaluations with 1 to 16 derivatives. Each
+ * of them is measured in two ways:
+ *
+ * - single: The operation is applied to one pair of evaluations at a time and the
+ *   result is forced to memory before the next one is computed. This corresponds to
+ *   code which processes a single element at a time, e.g., the evaluation of the
+ *   constitutive relations of a cell.
+ * - batched: The operation is applied to arrays of evaluations in a loop, which the
+ *   compiler is free to interleave or to vectorize.
+ *
+ * For each variant, the time per operation and the number of floating point operations
+ * per second are reported. The latter counts the operations which the rules of
+ * differentiation require for the value and the derivatives (e.g., 3*numVars + 1 for
+ * a product); the computation of the value by a function of the C library counts as
+ * a single operation.
+ *
+ * Compiling this program with OPM_LOCAL_AD_DISABLE_SIMD or
+ * OPM_LOCAL_AD_EXPRESSION_TEMPLATES defined allows to compare the respective variants
+ * of the framework.
+ *
+ * If --perf-counters is given, the hardware performance counters per operation are
+ * reported as well, cf. Opm::PerformanceCounters.
+ *
+ * Usage: benchmark_localad [--vars=N] [--batch-size=N] [--min-time=SECONDS]
+ *                          [--perf-counters]
+ */
+#include "config.h"
+
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+
+#include "PerformanceCounters.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+typedef double Scalar;
+typedef std::chrono::steady_clock Clock;
+
+class BenchmarkAdTag;
+
+// the counters of the last run of timePerOperation() and its number of operations
+static Opm::PerformanceCounters perfCounters;
+static size_t perfCountersNumOps = 0;
+
+// makes the compiler assume that the memory pointed to is read and written, so that
+// neither the computation of the data nor the stores can be optimized away
+#if defined __GNUC__
+static inline void escape(const void* p)
+{ asm volatile("" : : "g"(p) : "memory"); }
+#else
+static void escapeNoop_(const void*)
+{}
+static void (*volatile escapeFn_)(const void*) = &escapeNoop_;
+static inline void escape(const void* p)
+{ escapeFn_(p); }
+#endif
+
+// the operations which are measured. flops() returns the number of floating point
+// operations for the value and the derivatives of the result.
+struct Add
+{
+    static const char* name() { return "+"; }
+    static double flops(int numVars) { return numVars + 1; }
+    template <class Eval>
+    static Eval apply(const Eval& a, const Eval& b) { return a + b; }
+};
+
+struct Multiply
+{
+    static const char* name() { return "*"; }
+    static double flops(int numVars) { return 3*numVars + 1; }
+    template <class Eval>
+    static Eval apply(const Eval& a, const Eval& b) { return a * b; }
+};
+
+struct Divide
+{
+    static const char* name() { return "/"; }
+    static double flops(int numVars) { return 3*numVars + 4; }
+    template <class Eval>
+    static Eval apply(const Eval& a, const Eval& b) { return a / b; }
+};
+
+struct Exp
+{
+    static const char* name() { return "exp"; }
+    static double flops(int numVars) { return numVars + 1; }
+    template <class Eval>
+    static Eval apply(const Eval& a, const Eval&) { return Opm::LocalAd::exp(a); }
+};
+
+struct Log
+{
+    static const char* name() { return "log"; }
+    static double flops(int numVars) { return numVars + 2; }
+    template <class Eval>
+    static Eval apply(const Eval& a, const Eval&) { return Opm::LocalAd::log(a); }
+};
+
+struct Pow
+{
+    static const char* name() { return "pow"; }
+    static double flops(int numVars) { return numVars + 3; }
+    template <class Eval>
+    static Eval apply(const Eval& a, const Eval&) { return Opm::LocalAd::pow(a, Scalar(2.5)); }
+};
+
+struct Sqrt
+{
+    static const char* name() { return "sqrt"; }
+    static double flops(int numVars) { return numVars + 2; }
+    template <class Eval>
+    static Eval apply(const Eval& a, const Eval&) { return Opm::LocalAd::sqrt(a); }
+};
+
+struct Min
+{
+    static const char* name() { return "min"; }
+    static double flops(int) { return 1; }
+    template <class Eval>
+    static Eval apply(const Eval& a, const Eval& b) { return Opm::LocalAd::min(a, b); }
+};
+
+struct Max
+{
+    static const char* name() { return "max"; }
+    static double flops(int) { return 1; }
+    template <class Eval>
+    static Eval apply(const Eval& a, const Eval& b) { return Opm::LocalAd::max(a, b); }
+};
+
+struct Options
+{
+    Options()
+        : numVars(0)
+        , batchSize(1024)
+        , minTime(0.05)
+    {}
+
+    int numVars; // 0: all
+    size_t batchSize;
+    double minTime;
+};
+
+// randomized positive operands, so that all functions are defined for them
+template <class Eval>
+static std::vector<Eval> createOperands(size_t n, std::mt19937& rng)
+{
+    std::uniform_real_distribution<Scalar> valueDist(0.5, 1.5);
+    std::uniform_real_distribution<Scalar> derivDist(-1.0, 1.0);
+
+    std::vector<Eval> result(n);
+    for (size_t i = 0; i < n; ++i) {
+        result[i].value = valueDist(rng);
+        for (int varIdx = 0; varIdx < Eval::size; ++varIdx)
+            result[i].derivatives[varIdx] = derivDist(rng);
+    }
+    return result;
+}
+
+// call a functor which performs at least a given number of operations and returns the
+// number of operations which it actually did. the number is increased until this takes
+// at least the minimum time. returns the time per operation [s].
+template <class Functor>
+static double timePerOperation(const Options& options, const Functor& functor)
+{
+    for (size_t numOps = 1024; ; numOps *= 2) {
+        perfCounters.reset();
+        perfCounters.start();
+        auto start = Clock::now();
+        size_t numDone = functor(numOps);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        perfCounters.stop();
+        if (seconds >= options.minTime) {
+            perfCountersNumOps = numDone;
+            return seconds/numDone;
+        }
+    }
+}
+
+template <class Op, class Eval>
+static void measure(const Options& options,
+                    const std::vector<Eval>& a,
+                    const std::vector<Eval>& b,
+                    std::vector<Eval>& results)
+{
+    size_t batchSize = a.size();
+
+    // the operand pairs are cycled through, so that the values of the operands are not
+    // known to the compiler
+    double singleSeconds = timePerOperation(options, [&](size_t numOps) -> size_t {
+            Eval result;
+            for (size_t opIdx = 0; opIdx < numOps; ++opIdx) {
+                size_t i = opIdx & 7;
+                result = Op::apply(a[i], b[i]);
+                escape(&result);
+            }
+            return numOps;
+        });
+    std::ostringstream singleCounters;
+    perfCounters.printPerEvaluation(singleCounters, perfCountersNumOps, "    single, per operation:");
+
+    double batchedSeconds = timePerOperation(options, [&](size_t numOps) -> size_t {
+            size_t numBatches = (numOps + batchSize - 1)/batchSize;
+            for (size_t batchIdx = 0; batchIdx < numBatches; ++batchIdx) {
+                for (size_t i = 0; i < batchSize; ++i)
+                    results[i] = Op::apply(a[i], b[i]);
+                escape(results.data());
+            }
+            return numBatches*batchSize;
+        });
+
+    double flops = Op::flops(Eval::size);
+    std::cout << std::setw(8) << Eval::size
+              << std::setw(8) << Op::name()
+              << std::fixed << std::setprecision(2)
+              << std::setw(14) << singleSeconds*1e9
+              << std::setw(14) << flops/singleSeconds*1e-9
+              << std::setw(14) << batchedSeconds*1e9
+              << std::setw(14) << flops/batchedSeconds*1e-9 << "\n";
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << singleCounters.str();
+    perfCounters.printPerEvaluation(std::cout, perfCountersNumOps, "    batched, per operation:");
+}
+
+template <int numVars>
+static void runBenchmarks(const Options& options)
+{
+    typedef Opm::LocalAd::Evaluation<Scalar, BenchmarkAdTag, numVars> Eval;
+
+    // always use the same seed so that the runs are comparable
+    std::mt19937 rng(12345);
+    std::vector<Eval> a = createOperands<Eval>(options.batchSize, rng);
+    std::vector<Eval> b = createOperands<Eval>(options.batchSize, rng);
+    std::vector<Eval> results(options.batchSize);
+
+    measure<Add>(options, a, b, results);
+    measure<Multiply>(options, a, b, results);
+    measure<Divide>(options, a, b, results);
+    measure<Exp>(options, a, b, results);
+    measure<Log>(options, a, b, results);
+    measure<Pow>(options, a, b, results);
+    measure<Sqrt>(options, a, b, results);
+    measure<Min>(options, a, b, results);
+    measure<Max>(options, a, b, results);
+}
+
+// run the benchmarks for all numbers of derivatives up to numVars
+template <int numVars>
+struct RunAll
+{
+    static void run(const Options& options)
+    {
+        RunAll<numVars - 1>::run(options);
+        if (options.numVars == 0 || options.numVars == numVars)
+            runBenchmarks<numVars>(options);
+    }
+};
+
+template <>
+struct RunAll<0>
+{
+    static void run(const Options&)
+    {}
+};
+
+static const int maxVars = 16;
+
+static bool parseOption(const char* arg, const char* name, std::string& value)
+{
+    size_t len = std::strlen(name);
+    if (std::strncmp(arg, name, len) != 0 || arg[len] != '=')
+        return false;
+    value = arg + len + 1;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        std::string value;
+        if (parseOption(argv[argIdx], "--vars", value))
+            options.numVars = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--batch-size", value))
+            options.batchSize = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--min-time", value))
+            options.minTime = std::atof(value.c_str());
+        else if (std::strcmp(argv[argIdx], "--perf-counters") == 0) {
+            if (!perfCounters.enable())
+                std::cerr << "Warning: The hardware performance counters are not available\n";
+        }
+        else {
+            std::cerr << "Unknown option '" << argv[argIdx] << "'\n"
+                      << "Usage: " << argv[0]
+                      << " [--vars=N] [--batch-size=N] [--min-time=SECONDS] [--perf-counters]\n";
+            return 1;
+        }
+    }
+
+    if (options.numVars < 0 || options.numVars > maxVars) {
+        std::cerr << "The number of derivatives must be between 1 and " << maxVars << "\n";
+        return 1;
+    }
+    if (options.batchSize < 8 || options.minTime <= 0.0) {
+        std::cerr << "The batch size must be at least 8 and the minimum time must be positive\n";
+        return 1;
+    }
+
+    std::cout << std::setw(8) << "numVars"
+              << std::setw(8) << "op"
+              << std::setw(14) << "single ns/op"
+              << std::setw(14) << "GFlop/s"
+              << std::setw(14) << "batch ns/op"
+              << std::setw(14) << "GFlop/s" << "\n";
+    RunAll<maxVars>::run(options);
+
+    return 0;
+}
@@ -0,0 +1,614 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Measures the throughput of the NCP flash solver for the SPE-5 fluid system.
+ *
+ * A batch of randomized mixtures of the SPE-5 reservoir oil and the injection gas at
+ * randomized pressures is flashed. The flashes are done from scratch, starting from
+ * the solution for slightly perturbed total molarities (which corresponds to the
+ * situation between two time steps of a simulator), using the batched flash and
+ * using the parallel flash (which only uses multiple threads if the benchmark is
+ * compiled with OpenMP). The flashes from scratch are also done using the line
+ * search of the NCP flash. For each variant the number of flashes per second is
+ * reported, and the average and maximum number of Newton iterations of the flashes
+ * from scratch are reported for both globalization strategies.
+ *
+ * For the flashes from scratch, the average number of Newton iterations per flash
+ * and the fractions of the time which are spent in the equation of state (i.e., the
+ * parameter cache updates, densities and fugacity coefficients), in the solution of
+ * the linear systems and in the remaining parts of the Newton method (mainly the
+ * evaluation of the defect) are also reported. Note that the time measurements
+ * themselves slightly inflate the time spent in the equation of state.
+ *
+ * If --perf-counters is given, the hardware performance counters per flash are
+ * reported for each variant, cf. Opm::PerformanceCounters. For the parallel variant,
+ * only the events of the main thread are counted.
+ *
+ * Usage: benchmark_ncpflash [--samples=N] [--repetitions=N] [--perf-counters]
+ */
+#include "config.h"
+
+#include <opm/material/constraintsolvers/ComputeFromReferencePhase.hpp>
+#include <opm/material/constraintsolvers/NcpFlash.hpp>
+#include <opm/material/fluidstates/CompositionalFluidState.hpp>
+#include <opm/material/fluidsystems/Spe5FluidSystem.hpp>
+#include <opm/material/fluidmatrixinteractions/LinearMaterial.hpp>
+#include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/fmatrix.hh>
+
+#include "PerformanceCounters.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef double Scalar;
+typedef std::chrono::steady_clock Clock;
+
+static Opm::PerformanceCounters perfCounters;
+
+// accumulates the time spent in the equation of state
+static double eosSeconds = 0.0;
+
+// measures the time between its construction and its destruction
+class EosTimer
+{
+public:
+    EosTimer()
+        : start_(Clock::now())
+    {}
+
+    ~EosTimer()
+    { eosSeconds += std::chrono::duration<double>(Clock::now() - start_).count(); }
+
+private:
+    Clock::time_point start_;
+};
+
+// the SPE-5 fluid system with a parameter cache and fluid system methods which
+// record the time spent in the equation of state
+class TimedSpe5FluidSystem : public Opm::FluidSystems::Spe5<Scalar>
+{
+    typedef Opm::FluidSystems::Spe5<Scalar> ParentType;
+
+public:
+    class ParameterCache : public ParentType::ParameterCache
+    {
+        typedef Opm::FluidSystems::Spe5<Scalar>::ParameterCache ParentCache;
+
+    public:
+        template <class FluidState>
+        void updateAll(const FluidState &fluidState, int exceptQuantities = ParentCache::None)
+        { EosTimer timer; ParentCache::updateAll(fluidState, exceptQuantities); }
+
+        template <class FluidState>
+        void updateAllPressures(const FluidState &fluidState)
+        { EosTimer timer; ParentCache::updateAllPressures(fluidState); }
+
+        template <class FluidState>
+        void updatePhase(const FluidState &fluidState, int phaseIdx, int exceptQuantities = ParentCache::None)
+        { EosTimer timer; ParentCache::updatePhase(fluidState, phaseIdx, exceptQuantities); }
+
+        template <class FluidState>
+        void updateSingleMoleFraction(const FluidState &fluidState, int phaseIdx, int compIdx)
+        { EosTimer timer; ParentCache::updateSingleMoleFraction(fluidState, phaseIdx, compIdx); }
+    };
+
+    template <class FluidState>
+    static Scalar density(const FluidState &fluidState,
+                          const ParameterCache &paramCache,
+                          int phaseIdx)
+    { EosTimer timer; return ParentType::density(fluidState, paramCache, phaseIdx); }
+
+    template <class FluidState>
+    static Scalar fugacityCoefficient(const FluidState &fluidState,
+                                      const ParameterCache &paramCache,
+                                      int phaseIdx,
+                                      int compIdx)
+    { EosTimer timer; return ParentType::fugacityCoefficient(fluidState, paramCache, phaseIdx, compIdx); }
+
+    template <class FluidState>
+    static void fugacityCoefficients(const FluidState &fluidState,
+                                     const ParameterCache &paramCache,
+                                     int phaseIdx,
+                                     Scalar *fugCoeffs)
+    { EosTimer timer; ParentType::fugacityCoefficients(fluidState, paramCache, phaseIdx, fugCoeffs); }
+};
+
+typedef Opm::FluidSystems::Spe5<Scalar> FluidSystem;
+
+enum {
+    numPhases = FluidSystem::numPhases,
+    numComponents = FluidSystem::numComponents,
+
+    waterPhaseIdx = FluidSystem::waterPhaseIdx,
+    gasPhaseIdx = FluidSystem::gasPhaseIdx,
+    oilPhaseIdx = FluidSystem::oilPhaseIdx,
+
+    C1Idx = FluidSystem::C1Idx,
+    C3Idx = FluidSystem::C3Idx,
+    C6Idx = FluidSystem::C6Idx,
+    C10Idx = FluidSystem::C10Idx,
+    C15Idx = FluidSystem::C15Idx,
+    C20Idx = FluidSystem::C20Idx
+};
+
+typedef Dune::FieldVector<Scalar, numComponents> ComponentVector;
+typedef Opm::CompositionalFluidState<Scalar, FluidSystem> FluidState;
+
+typedef Opm::ThreePhaseMaterialTraits<Scalar, waterPhaseIdx, oilPhaseIdx, gasPhaseIdx> MaterialTraits;
+typedef Opm::LinearMaterial<MaterialTraits> MaterialLaw;
+typedef MaterialLaw::Params MaterialLawParams;
+
+static const Scalar temperature = 273.15 + 20.0;
+
+// the NCP flash with a Newton method which records the number of iterations and the
+// time spent for the solution of the linear systems.
+class InstrumentedFlash : public Opm::NcpFlash<Scalar, TimedSpe5FluidSystem>
+{
+
+public:
+    typedef TimedSpe5FluidSystem::ParameterCache ParameterCache;
+
+    // returns the number of Newton iterations or -1 if the flash failed. this
+    // mirrors ParentType::solve()
+    static int solve(FluidState &fluidState,
+                     ParameterCache &paramCache,
+                     const MaterialLawParams &matParams,
+                     const ComponentVector &globalMolarities,
+                     double &linearSolveSeconds)
+    {
+        Workspace_<FluidState>& ws = workspace_<FluidState>();
+
+        completeFluidState_<MaterialLaw>(fluidState, paramCache, matParams);
+
+        const int nMax = 50;
+        for (int nIdx = 0; nIdx < nMax; ++nIdx) {
+            linearize_<MaterialLaw>(ws, fluidState, paramCache, matParams, globalMolarities);
+
+            auto start = Clock::now();
+            if (!ws.lu.factorize(ws.J, singularLimit_()))
+                return -1;
+            ws.lu.solve(ws.deltaX, ws.b);
+            linearSolveSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+            Scalar relError = update_<MaterialLaw>(fluidState, paramCache, matParams, ws.deltaX);
+            if (relError < 1e-9)
+                return nIdx + 1;
+        }
+
+        return -1;
+    }
+};
+
+// the randomized input of the flash calculations
+struct Samples
+{
+    std::vector<ComponentVector> globalMolarities;
+
+    // the overall composition and the pressure at which the mixture was created.
+    // they serve as initial guess for the flashes from scratch
+    std::vector<ComponentVector> compositions;
+    std::vector<Scalar> pressures;
+
+    // the total molarities of a neighboring state, e.g. of the previous time step
+    std::vector<ComponentVector> prevGlobalMolarities;
+};
+
+// calculate the total molarities of a single liquid-like phase of a given composition
+static ComponentVector totalMolarities(const ComponentVector &z, Scalar pressure)
+{
+    FluidState fs;
+    fs.setTemperature(temperature);
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        fs.setPressure(phaseIdx, pressure);
+        fs.setSaturation(phaseIdx, 0.0);
+    }
+    fs.setSaturation(oilPhaseIdx, 1.0);
+    for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+        fs.setMoleFraction(oilPhaseIdx, compIdx, z[compIdx]);
+
+    FluidSystem::ParameterCache paramCache;
+    paramCache.updatePhase(fs, oilPhaseIdx);
+    fs.setDensity(oilPhaseIdx, FluidSystem::density(fs, paramCache, oilPhaseIdx));
+
+    ComponentVector result;
+    for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+        result[compIdx] = fs.molarity(oilPhaseIdx, compIdx);
+    return result;
+}
+
+// the initial guess for the flashes from scratch: the mixture is assumed to form a
+// single oil phase at the pressure at which it was created. The compositions of the
+// other phases are determined by the condition that the fugacities of all phases are
+// equal.
+template <class TheFluidSystem, class FluidState, class ParameterCache>
+static void guessInitial(FluidState &fluidState,
+                         ParameterCache &paramCache,
+                         const ComponentVector &z,
+                         Scalar pressure)
+{
+    typedef Opm::ComputeFromReferencePhase<Scalar, TheFluidSystem> CFRP;
+
+    fluidState.setTemperature(temperature);
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        fluidState.setPressure(phaseIdx, pressure);
+        fluidState.setSaturation(phaseIdx, (phaseIdx == oilPhaseIdx) ? 1.0 : 0.0);
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            fluidState.setMoleFraction(phaseIdx, compIdx, z[compIdx]);
+    }
+
+    CFRP::solve(fluidState,
+                paramCache,
+                /*refPhaseIdx=*/oilPhaseIdx,
+                /*setViscosity=*/false,
+                /*setEnthalpy=*/false);
+}
+
+// the capillary pressures are zero
+static MaterialLawParams createMaterialParams()
+{
+    MaterialLawParams matParams;
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        matParams.setPcMinSat(phaseIdx, 0.0);
+        matParams.setPcMaxSat(phaseIdx, 0.0);
+    }
+    matParams.finalize();
+    return matParams;
+}
+
+// returns true if a flash from scratch succeeds
+static bool isFlashable(const ComponentVector &z,
+                        Scalar pressure,
+                        const ComponentVector &globalMolarities)
+{
+    typedef Opm::NcpFlash<Scalar, FluidSystem> Flash;
+
+    static const MaterialLawParams matParams = createMaterialParams();
+    FluidState fluidState;
+    FluidSystem::ParameterCache paramCache;
+    try {
+        guessInitial<FluidSystem>(fluidState, paramCache, z, pressure);
+        Flash::solve<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities);
+    }
+    catch (const Opm::NumericalIssue&) {
+        return false;
+    }
+    return true;
+}
+
+// create randomized mixtures. mixtures which can not be flashed from scratch (e.g.,
+// because they are too close to their critical point) are rejected, so that all
+// variants of the benchmark process the same workload.
+static size_t createSamples(Samples &samples, size_t numSamples)
+{
+    // SPE-5 reservoir oil and injection gas
+    ComponentVector oil(0.0);
+    oil[C1Idx] = 0.50;
+    oil[C3Idx] = 0.03;
+    oil[C6Idx] = 0.07;
+    oil[C10Idx] = 0.20;
+    oil[C15Idx] = 0.15;
+    oil[C20Idx] = 0.05;
+
+    ComponentVector gas(0.0);
+    gas[C1Idx] = 0.77;
+    gas[C3Idx] = 0.20;
+    gas[C6Idx] = 0.03;
+
+    // always use the same seed so that the runs are comparable
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<Scalar> gasFractionDist(0.0, 0.5);
+    std::uniform_real_distribution<Scalar> pressureDist(50e5, 150e5);
+    std::uniform_real_distribution<Scalar> perturbationDist(-1e-3, 1e-3);
+
+    size_t numRejected = 0;
+    while (samples.globalMolarities.size() < numSamples) {
+        Scalar gasFraction = gasFractionDist(rng);
+        ComponentVector z;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            z[compIdx] = (1 - gasFraction)*oil[compIdx] + gasFraction*gas[compIdx];
+
+        Scalar pressure = pressureDist(rng);
+        ComponentVector molarities = totalMolarities(z, pressure);
+
+        ComponentVector prevMolarities(molarities);
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            prevMolarities[compIdx] *= 1 + perturbationDist(rng);
+
+        if (!isFlashable(z, pressure, molarities) || !isFlashable(z, pressure, prevMolarities)) {
+            ++ numRejected;
+            continue;
+        }
+
+        samples.globalMolarities.push_back(molarities);
+        samples.prevGlobalMolarities.push_back(prevMolarities);
+        samples.compositions.push_back(z);
+        samples.pressures.push_back(pressure);
+    }
+
+    return numRejected;
+}
+
+static void printResult(const char* variantName,
+                        size_t numFlashes,
+                        size_t numFailed,
+                        double seconds)
+{
+    std::cout << std::left
+              << std::setw(24) << variantName
+              << std::right
+              << std::setw(12) << std::fixed << std::setprecision(2) << seconds/numFlashes*1e6
+              << std::setw(16) << std::scientific << std::setprecision(3) << numFlashes/seconds
+              << std::setw(10) << numFailed << "\n";
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+template <class Functor>
+static void measure(const char* variantName,
+                    const Samples &samples,
+                    int repetitions,
+                    const Functor &functor)
+{
+    size_t numSamples = samples.globalMolarities.size();
+    size_t numFailed = 0;
+    perfCounters.reset();
+    perfCounters.start();
+    auto start = Clock::now();
+    for (int repIdx = 0; repIdx < repetitions; ++repIdx)
+        numFailed += functor();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    perfCounters.stop();
+
+    printResult(variantName, numSamples*repetitions, numFailed, seconds);
+    perfCounters.printPerEvaluation(std::cout, double(numSamples)*repetitions);
+}
+
+static void runBenchmarks(const Samples &samples, int repetitions)
+{
+    typedef Opm::NcpFlash<Scalar, FluidSystem> Flash;
+    typedef FluidSystem::ParameterCache ParameterCache;
+
+    size_t numSamples = samples.globalMolarities.size();
+
+    MaterialLawParams matParams = createMaterialParams();
+
+    std::vector<FluidState> fluidStates(numSamples);
+    std::vector<ParameterCache> paramCaches(numSamples);
+
+    // the solutions for the perturbed total molarities are the initial guesses for the
+    // warm started flashes. they are computed up front. (createSamples() made sure
+    // that these flashes succeed.)
+    std::vector<FluidState> prevFluidStates(numSamples);
+    for (size_t i = 0; i < numSamples; ++i) {
+        guessInitial<FluidSystem>(prevFluidStates[i], paramCaches[i],
+                                  samples.compositions[i], samples.pressures[i]);
+        Flash::solve<MaterialLaw>(prevFluidStates[i], paramCaches[i], matParams,
+                                  samples.prevGlobalMolarities[i]);
+    }
+
+    std::cout << std::left
+              << std::setw(24) << "variant"
+              << std::right
+              << std::setw(12) << "us/flash"
+              << std::setw(16) << "flashes/s"
+              << std::setw(10) << "failed" << "\n";
+
+    measure("from scratch", samples, repetitions, [&]() -> size_t {
+            size_t numFailed = 0;
+            for (size_t i = 0; i < numSamples; ++i) {
+                try {
+                    guessInitial<FluidSystem>(fluidStates[i], paramCaches[i],
+                                              samples.compositions[i], samples.pressures[i]);
+                    Flash::solve<MaterialLaw>(fluidStates[i], paramCaches[i], matParams,
+                                              samples.globalMolarities[i]);
+                }
+                catch (const Opm::NumericalIssue&) {
+                    ++ numFailed;
+                }
+            }
+            return numFailed;
+        });
+
+    Flash::setGlobalization(Flash::LineSearch);
+    measure("line search", samples, repetitions, [&]() -> size_t {
+            size_t numFailed = 0;
+            for (size_t i = 0; i < numSamples; ++i) {
+                try {
+                    guessInitial<FluidSystem>(fluidStates[i], paramCaches[i],
+                                              samples.compositions[i], samples.pressures[i]);
+                    Flash::solve<MaterialLaw>(fluidStates[i], paramCaches[i], matParams,
+                                              samples.globalMolarities[i]);
+                }
+                catch (const Opm::NumericalIssue&) {
+                    ++ numFailed;
+                }
+            }
+            return numFailed;
+        });
+    Flash::setGlobalization(Flash::ClampedUpdate);
+
+    measure("warm start", samples, repetitions, [&]() -> size_t {
+            size_t numFailed = 0;
+            for (size_t i = 0; i < numSamples; ++i) {
+                try {
+                    fluidStates[i].setTemperature(temperature);
+                    Flash::guessFromPrevious(fluidStates[i], paramCaches[i], prevFluidStates[i]);
+                    Flash::solve<MaterialLaw>(fluidStates[i], paramCaches[i], matParams,
+                                              samples.globalMolarities[i]);
+                }
+                catch (const Opm::NumericalIssue&) {
+                    ++ numFailed;
+                }
+            }
+            return numFailed;
+        });
+
+    std::vector<const MaterialLawParams*> matParamsPtrs(numSamples, &matParams);
+    measure("batched", samples, repetitions, [&]() -> size_t {
+            for (size_t i = 0; i < numSamples; ++i)
+                guessInitial<FluidSystem>(fluidStates[i], paramCaches[i],
+                                          samples.compositions[i], samples.pressures[i]);
+            try {
+                Flash::solveBatch<MaterialLaw>(fluidStates.data(), paramCaches.data(), matParamsPtrs.data(),
+                                               samples.globalMolarities.data(), numSamples);
+            }
+            catch (const Opm::NumericalIssue&) {
+                // the batched flash does not tell which fluid states failed
+                return numSamples;
+            }
+            return 0;
+        });
+
+    std::vector<Flash::SolverStatus> statuses(numSamples);
+    measure("parallel", samples, repetitions, [&]() -> size_t {
+            for (size_t i = 0; i < numSamples; ++i)
+                guessInitial<FluidSystem>(fluidStates[i], paramCaches[i],
+                                          samples.compositions[i], samples.pressures[i]);
+            const Flash::SolverStatistics& statistics =
+                Flash::trySolveParallel<MaterialLaw>(fluidStates.data(), paramCaches.data(),
+                                                     matParamsPtrs.data(),
+                                                     samples.globalMolarities.data(),
+                                                     statuses.data(), numSamples);
+            return statistics.numFailed();
+        });
+
+    // the Newton iterations of the flashes from scratch for both globalization
+    // strategies
+    Flash::SolverStatistics iterationStatistics[2];
+    for (int strategyIdx = 0; strategyIdx < 2; ++strategyIdx) {
+        Flash::setGlobalization((strategyIdx == 0) ? Flash::ClampedUpdate : Flash::LineSearch);
+        for (size_t i = 0; i < numSamples; ++i) {
+            guessInitial<FluidSystem>(fluidStates[i], paramCaches[i],
+                                      samples.compositions[i], samples.pressures[i]);
+            try {
+                iterationStatistics[strategyIdx].add(
+                    Flash::trySolve<MaterialLaw>(fluidStates[i], paramCaches[i], matParams,
+                                                 samples.globalMolarities[i]));
+            }
+            catch (const Opm::NumericalIssue&) {
+                iterationStatistics[strategyIdx].add(Flash::SolverStatus());
+            }
+        }
+    }
+    Flash::setGlobalization(Flash::ClampedUpdate);
+
+    std::cout << "\nNewton iterations of the flashes from scratch (average, maximum):\n";
+    for (int strategyIdx = 0; strategyIdx < 2; ++strategyIdx) {
+        const Flash::SolverStatistics& statistics = iterationStatistics[strategyIdx];
+        std::cout << "  " << std::left << std::setw(34)
+                  << ((strategyIdx == 0) ? "clamped updates:" : "line search:")
+                  << std::right
+                  << double(statistics.totalIterations)/numSamples << ", "
+                  << statistics.maxIterations << "\n";
+    }
+
+    // the time split of the flashes from scratch
+    typedef InstrumentedFlash::ParameterCache TimedParameterCache;
+    std::vector<TimedParameterCache> timedParamCaches(numSamples);
+    double linearSolveSeconds = 0.0;
+    size_t numIterations = 0;
+    size_t numConverged = 0;
+    eosSeconds = 0.0;
+    auto start = Clock::now();
+    for (int repIdx = 0; repIdx < repetitions; ++repIdx) {
+        for (size_t i = 0; i < numSamples; ++i) {
+            guessInitial<TimedSpe5FluidSystem>(fluidStates[i], timedParamCaches[i],
+                                               samples.compositions[i], samples.pressures[i]);
+            int n = InstrumentedFlash::solve(fluidStates[i], timedParamCaches[i], matParams,
+                                             samples.globalMolarities[i], linearSolveSeconds);
+            if (n > 0) {
+                numIterations += n;
+                ++ numConverged;
+            }
+        }
+    }
+    double totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    double otherSeconds = totalSeconds - eosSeconds - linearSolveSeconds;
+
+    std::cout << "\nflashes from scratch:\n"
+              << "  Newton iterations per flash:        "
+              << (numConverged > 0 ? double(numIterations)/numConverged : 0.0) << "\n"
+              << std::fixed << std::setprecision(1)
+              << "  equation of state:                  " << 100*eosSeconds/totalSeconds << " %\n"
+              << "  linear solver:                      " << 100*linearSolveSeconds/totalSeconds << " %\n"
+              << "  defect evaluation and bookkeeping:  " << 100*otherSeconds/totalSeconds << " %\n";
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+static bool parseOption(const char* arg, const char* name, std::string& value)
+{
+    size_t len = std::strlen(name);
+    if (std::strncmp(arg, name, len) != 0 || arg[len] != '=')
+        return false;
+    value = arg + len + 1;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    size_t numSamples = 1000;
+    int repetitions = 5;
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        std::string value;
+        if (parseOption(argv[argIdx], "--samples", value))
+            numSamples = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--repetitions", value))
+            repetitions = std::atoi(value.c_str());
+        else if (std::strcmp(argv[argIdx], "--perf-counters") == 0) {
+            if (!perfCounters.enable())
+                std::cerr << "Warning: The hardware performance counters are not available\n";
+        }
+        else {
+            std::cerr << "Unknown option '" << argv[argIdx] << "'\n"
+                      << "Usage: " << argv[0] << " [--samples=N] [--repetitions=N] [--perf-counters]\n";
+            return 1;
+        }
+    }
+
+    if (numSamples < 1 || repetitions < 1) {
+        std::cerr << "The number of samples and the number of repetitions must be positive\n";
+        return 1;
+    }
+
+    FluidSystem::init(/*minTemperature=*/temperature - 1,
+                      /*maxTemperature=*/temperature + 1,
+                      /*minPressure=*/1.0e4,
+                      /*maxPressure=*/40.0e6);
+
+    Samples samples;
+    size_t numRejected = createSamples(samples, numSamples);
+
+    std::cout << numSamples << " SPE-5 mixtures (" << numRejected << " rejected), "
+              << repetitions << " repetitions\n";
+    runBenchmarks(samples, repetitions);
+
+    return 0;
+}
@@ -0,0 +1,776 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief A proxy application which emulates the evaluation of the constitutive
+ *        relations by a black-oil simulator.
+ *
+ * The black-oil fluid system and the EclMaterialLawManager are set up using an ECL
+ * deck, which is either read from a file or created for a Cartesian grid. Then, a
+ * number of time steps which consist of a fixed number of Newton iterations are
+ * emulated: In each iteration, the primary variables of all cells (oil pressure,
+ * water and gas saturations) are perturbed and the following stages are evaluated
+ * using function evaluations of the localized automatic differentiation framework:
+ *
+ * - update: The primary variables and the saturations of the fluid states are set.
+ * - kr: The relative permeabilities of all phases.
+ * - pc: The capillary pressures of all phases.
+ * - pvt: The phase pressures, the saturated gas dissolution and oil vaporization
+ *   factors and the formation volume factors, viscosities and densities of all phases.
+ *
+ * After each time step, the hysteresis parameters of all cells are updated. For each
+ * stage and number of threads, the number of cells per second is reported, as well as
+ * the memory used by the material law parameters and by the per-cell quantities. The
+ * speedup is given relative to the first number of threads.
+ *
+ * The stages are parallelized using OpenMP. The list of thread counts given by
+ * --threads is processed in order, so that the scalability can be determined by a
+ * single run, e.g., using --threads=1,2,4,8,16,32,64,128. If --perf-counters is given,
+ * the hardware performance counters per cell are reported for each stage, cf.
+ * Opm::PerformanceCounters. Since they only cover the calling thread, they should be
+ * used with a single thread.
+ *
+ * If a deck file is specified, it must contain the PVTO or PVDO, PVTG or PVDG, PVTW
+ * and DENSITY keywords and the saturation functions. The synthetic deck uses live
+ * oil, wet gas, end-point scaling and hysteresis.
+ *
+ * Usage: proxy_blackoil [--deck=FILE] [--nx=N] [--ny=N] [--nz=N] [--timesteps=N]
+ *                       [--iterations=N] [--threads=N[,N...]] [--compact-storage]
+ *                       [--perf-counters]
+ *
+ * By default, a grid of 50x50x50 cells, 5 time steps with 4 Newton iterations each
+ * and the maximum number of threads are used.
+ */
+#include "config.h"
+
+#if HAVE_OPM_PARSER
+#include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/LiveOilPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/DeadOilPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/WetGasPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/DryGasPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/ConstantCompressibilityWaterPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/BlackOilPhaseProperties.hpp>
+#include <opm/material/fluidmatrixinteractions/EclMaterialLawManager.hpp>
+#include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
+#include <opm/material/fluidstates/SimpleModularFluidState.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Parser/ParseMode.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+#endif
+
+#include "PerformanceCounters.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if HAVE_OPM_PARSER
+class ProxyAdTag;
+
+typedef double Scalar;
+
+// the primary variables: oil pressure, water saturation and gas saturation
+enum { pressureIdx = 0, waterSaturationIdx = 1, gasSaturationIdx = 2, numPrimaryVars = 3 };
+
+typedef Opm::LocalAd::Evaluation<Scalar, ProxyAdTag, numPrimaryVars> Evaluation;
+typedef Opm::FluidSystems::BlackOil<Scalar, Evaluation> FluidSystem;
+
+enum { numPhases = FluidSystem::numPhases };
+enum { waterPhaseIdx = FluidSystem::waterPhaseIdx };
+enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+typedef Opm::ThreePhaseMaterialTraits<Scalar,
+                                      /*wettingPhaseIdx=*/waterPhaseIdx,
+                                      /*nonWettingPhaseIdx=*/oilPhaseIdx,
+                                      /*gasPhaseIdx=*/gasPhaseIdx> MaterialTraits;
+typedef Opm::EclMaterialLawManager<MaterialTraits> MaterialLawManager;
+
+// a fluid state which only stores the saturations. this is all what the saturation
+// functions need.
+typedef Opm::SimpleModularFluidState<Evaluation,
+                                     /*numPhases=*/numPhases,
+                                     /*numComponents=*/0,
+                                     /*FluidSystem=*/void,
+                                     /*storePressure=*/false,
+                                     /*storeTemperature=*/false,
+                                     /*storeComposition=*/false,
+                                     /*storeFugacity=*/false,
+                                     /*storeSaturation=*/true,
+                                     /*storeDensity=*/false,
+                                     /*storeViscosity=*/false,
+                                     /*storeEnthalpy=*/false> FluidState;
+
+typedef std::chrono::steady_clock Clock;
+
+static const Scalar temperature = 273.15 + 80.0;
+
+enum Stage { UpdateStage, KrStage, PcStage, PvtStage, HysteresisStage, numStages };
+
+static const char* stageName(int stageIdx)
+{
+    static const char* names[numStages] = { "update", "kr", "pc", "pvt", "hyst" };
+    return names[stageIdx];
+}
+
+static Opm::PerformanceCounters perfCounters[numStages];
+
+struct ProxyOptions
+{
+    std::string deckFileName;
+    int nx = 50;
+    int ny = 50;
+    int nz = 50;
+    int timeSteps = 5;
+    int iterations = 4;
+    std::vector<int> threads;
+    bool compactStorage = false;
+};
+
+// the per-cell quantities which are calculated by the stages
+struct CellState
+{
+    Scalar primaryVars[numPrimaryVars];
+    int pvtRegionIdx;
+};
+
+struct SaturationFunctionResults
+{
+    Evaluation kr[numPhases];
+    Evaluation pc[numPhases];
+};
+
+struct PvtResults
+{
+    Evaluation Rs;
+    Evaluation Rv;
+    Opm::BlackOilPhaseProperties<Evaluation> phase[numPhases];
+};
+
+static double secondsSince(Clock::time_point start)
+{ return std::chrono::duration<double>(Clock::now() - start).count(); }
+
+// returns a memory statistic of the process from /proc/self/status [MiB] or a
+// negative value if it is not available
+static double processMemory(const char* key)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    size_t keyLen = std::strlen(key);
+    while (std::getline(status, line)) {
+        if (line.compare(0, keyLen, key) == 0 && line.size() > keyLen && line[keyLen] == ':')
+            return std::atof(line.c_str() + keyLen + 1)/1024.0; // the value is given in kB
+    }
+    return -1.0;
+}
+
+static void printMemory(const char* what, double mebiBytes)
+{
+    std::cout << "  " << std::left << std::setw(36) << what << std::right;
+    if (mebiBytes < 0)
+        std::cout << std::setw(12) << "n/a" << "\n";
+    else
+        std::cout << std::setw(12) << std::fixed << std::setprecision(1) << mebiBytes << " MiB\n";
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+// write a grid property which is constant within each layer but varies between them
+static void writeLayeredProperty(std::ostream& os,
+                                 const char* keyword,
+                                 const ProxyOptions& opts,
+                                 Scalar minValue,
+                                 Scalar maxValue)
+{
+    os << keyword << "\n";
+    for (int k = 0; k < opts.nz; ++k) {
+        Scalar alpha = (opts.nz > 1) ? Scalar(k)/(opts.nz - 1) : 0.0;
+        os << "  " << opts.nx*opts.ny << "*" << minValue + alpha*(maxValue - minValue) << "\n";
+    }
+    os << "/\n\n";
+}
+
+// a three-phase deck with live oil, wet gas, end-point scaling and hysteresis for a
+// Cartesian grid. the first saturation table is used for drainage, the second one for
+// imbibition. the PVT tables use metric units.
+static std::string createDeckString(const ProxyOptions& opts)
+{
+    int numCells = opts.nx*opts.ny*opts.nz;
+
+    std::ostringstream os;
+    os << "RUNSPEC\n\n"
+       << "DIMENS\n  " << opts.nx << " " << opts.ny << " " << opts.nz << " /\n\n"
+       << "OIL\n\nWATER\n\nGAS\n\nDISGAS\n\nVAPOIL\n\n"
+       << "TABDIMS\n  2 1 /\n\n"
+       << "ENDSCALE\n  /\n\n"
+       << "SATOPTS\n  'HYSTER' /\n\n";
+
+    os << "GRID\n\n"
+       << "DX\n  " << numCells << "*10 /\n"
+       << "DY\n  " << numCells << "*10 /\n"
+       << "DZ\n  " << numCells << "*1 /\n"
+       << "TOPS\n  " << opts.nx*opts.ny << "*1000 /\n"
+       << "PORO\n  " << numCells << "*0.2 /\n\n";
+
+    os << "PROPS\n\n"
+       << "EHYSTR\n  0.1 0 /\n\n"
+       << "DENSITY\n  859.5 1033.0 0.854 /\n\n"
+       << "PVTW\n  1.0 1.02 4.5e-5 0.5 0.0 /\n\n";
+
+    // each record of PVTO contains the saturated and an undersaturated state of oil
+    // for a given gas dissolution factor
+    os << "PVTO\n";
+    for (int i = 0; i < 15; ++i) {
+        Scalar pBar = 20.0 + 30.0*i;
+        Scalar Rs = 0.6*pBar;
+        Scalar Bo = 1.0 + 0.002*pBar;
+        Scalar muo = 1.5 - 0.002*pBar;
+        os << "  " << Rs << " " << pBar << " " << Bo << " " << muo << "\n"
+           << "     " << pBar + 100.0 << " " << 0.98*Bo << " " << 1.1*muo << " /\n";
+    }
+    os << "/\n\n";
+
+    // each record of PVTG contains the saturated and the dry state of gas for a given
+    // pressure
+    os << "PVTG\n";
+    for (int i = 0; i < 15; ++i) {
+        Scalar pBar = 20.0 + 30.0*i;
+        Scalar Rv = 2e-6*pBar;
+        Scalar Bg = 1.0/pBar;
+        Scalar mug = 0.012 + 2e-5*pBar;
+        os << "  " << pBar << " " << Rv << " " << Bg << " " << mug << "\n"
+           << "     0.0 " << 1.02*Bg << " " << 0.98*mug << " /\n";
+    }
+    os << "/\n\n";
+
+    os << "SWOF\n"
+       << "  0.10 0.000 1.000 2.0\n"
+       << "  0.20 0.002 0.810 1.2\n"
+       << "  0.30 0.010 0.600 0.8\n"
+       << "  0.40 0.030 0.420 0.5\n"
+       << "  0.50 0.070 0.270 0.3\n"
+       << "  0.60 0.120 0.150 0.2\n"
+       << "  0.70 0.200 0.060 0.1\n"
+       << "  0.80 0.300 0.010 0.05\n"
+       << "  0.90 0.420 0.000 0.0\n"
+       << "  1.00 0.550 0.000 0.0 /\n"
+       << "  0.10 0.000 1.000 1.5\n"
+       << "  0.25 0.004 0.700 0.8\n"
+       << "  0.40 0.025 0.430 0.4\n"
+       << "  0.55 0.080 0.210 0.2\n"
+       << "  0.70 0.170 0.070 0.1\n"
+       << "  0.85 0.300 0.000 0.0\n"
+       << "  1.00 0.480 0.000 0.0 /\n\n"
+       << "SGOF\n"
+       << "  0.00 0.000 1.000 0.0\n"
+       << "  0.05 0.000 0.860 0.01\n"
+       << "  0.15 0.020 0.600 0.03\n"
+       << "  0.30 0.100 0.300 0.07\n"
+       << "  0.45 0.250 0.110 0.12\n"
+       << "  0.60 0.450 0.020 0.18\n"
+       << "  0.75 0.700 0.000 0.25\n"
+       << "  0.90 1.000 0.000 0.35 /\n"
+       << "  0.00 0.000 1.000 0.0\n"
+       << "  0.10 0.010 0.750 0.02\n"
+       << "  0.25 0.060 0.400 0.05\n"
+       << "  0.40 0.180 0.160 0.09\n"
+       << "  0.60 0.420 0.020 0.16\n"
+       << "  0.90 0.900 0.000 0.30 /\n\n";
+
+    writeLayeredProperty(os, "SWL", opts, 0.10, 0.18);
+    writeLayeredProperty(os, "SWCR", opts, 0.15, 0.25);
+    writeLayeredProperty(os, "SOWCR", opts, 0.10, 0.20);
+    writeLayeredProperty(os, "SGCR", opts, 0.03, 0.08);
+    writeLayeredProperty(os, "SOGCR", opts, 0.10, 0.20);
+
+    os << "REGIONS\n\n"
+       << "SATNUM\n  " << numCells << "*1 /\n"
+       << "IMBNUM\n  " << numCells << "*2 /\n\n";
+
+    return os.str();
+}
+
+static void initFluidSystem(Opm::DeckConstPtr deck, Opm::EclipseStateConstPtr eclState)
+{
+    int numPvtRegions = deck->getKeyword("TABDIMS")->getRecord(0)->getItem("NTPVT")->getInt(0);
+    auto tables = eclState->getTableManager();
+
+    FluidSystem::initBegin(numPvtRegions);
+    FluidSystem::setEnableDissolvedGas(deck->hasKeyword("DISGAS"));
+    FluidSystem::setEnableVaporizedOil(deck->hasKeyword("VAPOIL"));
+
+    Opm::DeckKeywordConstPtr densityKeyword = deck->getKeyword("DENSITY");
+    for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx) {
+        auto densityRecord = densityKeyword->getRecord(regionIdx);
+        FluidSystem::setReferenceDensities(densityRecord->getItem("OIL")->getSIDouble(0),
+                                           densityRecord->getItem("WATER")->getSIDouble(0),
+                                           densityRecord->getItem("GAS")->getSIDouble(0),
+                                           regionIdx);
+    }
+
+    if (deck->hasKeyword("PVTO")) {
+        auto oilPvt = std::make_shared<Opm::LiveOilPvt<Scalar, Evaluation> >();
+        oilPvt->setNumRegions(numPvtRegions);
+        for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx)
+            oilPvt->setPvtoTable(regionIdx, tables->getPvtoTables()[regionIdx]);
+        oilPvt->initEnd();
+        FluidSystem::setOilPvt(oilPvt);
+    }
+    else {
+        auto oilPvt = std::make_shared<Opm::DeadOilPvt<Scalar, Evaluation> >();
+        oilPvt->setNumRegions(numPvtRegions);
+        for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx)
+            oilPvt->setPvdoTable(regionIdx, tables->getPvdoTables()[regionIdx]);
+        oilPvt->initEnd();
+        FluidSystem::setOilPvt(oilPvt);
+    }
+
+    if (deck->hasKeyword("PVTG")) {
+        auto gasPvt = std::make_shared<Opm::WetGasPvt<Scalar, Evaluation> >();
+        gasPvt->setNumRegions(numPvtRegions);
+        for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx)
+            gasPvt->setPvtgTable(regionIdx, tables->getPvtgTables()[regionIdx]);
+        gasPvt->initEnd();
+        FluidSystem::setGasPvt(gasPvt);
+    }
+    else {
+        auto gasPvt = std::make_shared<Opm::DryGasPvt<Scalar, Evaluation> >();
+        gasPvt->setNumRegions(numPvtRegions);
+        for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx)
+            gasPvt->setPvdgTable(regionIdx, tables->getPvdgTables()[regionIdx]);
+        gasPvt->initEnd();
+        FluidSystem::setGasPvt(gasPvt);
+    }
+
+    auto waterPvt = std::make_shared<Opm::ConstantCompressibilityWaterPvt<Scalar, Evaluation> >();
+    waterPvt->setNumRegions(numPvtRegions);
+    for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx)
+        waterPvt->setPvtw(regionIdx, deck->getKeyword("PVTW"));
+    waterPvt->initEnd();
+    FluidSystem::setWaterPvt(waterPvt);
+
+    FluidSystem::initEnd();
+}
+
+// the values of the primary variables of a cell at the beginning of a time step.
+// they are deterministic, vary smoothly between the time steps and cover the whole
+// range of the tables.
+static void initialPrimaryVariables(Scalar* primaryVars, unsigned elemIdx, int timeStepIdx)
+{
+    Scalar shift = 0.1*timeStepIdx;
+    Scalar alpha = std::abs(std::sin(0.37*elemIdx + shift));
+    Scalar beta = std::abs(std::cos(0.11*elemIdx + shift));
+    Scalar gamma = std::abs(std::sin(0.05*elemIdx + 0.5*shift));
+
+    Scalar Sw = 0.1 + 0.8*alpha;
+    primaryVars[pressureIdx] = 100e5 + 200e5*gamma;
+    primaryVars[waterSaturationIdx] = Sw;
+    primaryVars[gasSaturationIdx] = (1 - Sw)*0.8*beta;
+}
+
+// emulate a Newton update: the changes of the primary variables decrease with each
+// iteration
+static void updatePrimaryVariables(Scalar* primaryVars, unsigned elemIdx, int iterIdx)
+{
+    Scalar damping = std::pow(0.5, iterIdx);
+    Scalar delta = damping*std::sin(0.73*elemIdx + 1.3*iterIdx);
+
+    Scalar& p = primaryVars[pressureIdx];
+    Scalar& Sw = primaryVars[waterSaturationIdx];
+    Scalar& Sg = primaryVars[gasSaturationIdx];
+
+    p = std::max(10e5, p + 5e5*delta);
+    Sw = std::min(1.0, std::max(0.0, Sw + 0.02*delta));
+    Sg = std::min(1.0 - Sw, std::max(0.0, Sg - 0.01*delta));
+}
+
+#ifdef _OPENMP
+#define OPM_PROXY_PARALLEL_FOR _Pragma("omp parallel for schedule(static)")
+#else
+#define OPM_PROXY_PARALLEL_FOR
+#endif
+
+class Proxy
+{
+public:
+    Proxy(MaterialLawManager& materialLawManager, const std::vector<int>& pvtRegionIdx)
+        : materialLawManager_(materialLawManager)
+        , numElems_(static_cast<int>(pvtRegionIdx.size()))
+        , cellStates_(numElems_)
+        , oilPressures_(numElems_)
+        , fluidStates_(numElems_)
+        , satFuncResults_(numElems_)
+        , pvtResults_(numElems_)
+    {
+        for (int elemIdx = 0; elemIdx < numElems_; ++elemIdx)
+            cellStates_[elemIdx].pvtRegionIdx = pvtRegionIdx[elemIdx];
+    }
+
+    /*!
+     * \brief Returns the memory used by the per-cell quantities [bytes].
+     */
+    size_t cellDataSize() const
+    {
+        return numElems_*(sizeof(CellState) + sizeof(Evaluation) + sizeof(FluidState)
+                          + sizeof(SaturationFunctionResults) + sizeof(PvtResults));
+    }
+
+    /*!
+     * \brief Emulate a number of time steps and add the time spent in each stage to
+     *        stageTime.
+     */
+    void run(int numTimeSteps, int numIterations, double* stageTime)
+    {
+        for (int timeStepIdx = 0; timeStepIdx < numTimeSteps; ++timeStepIdx) {
+            for (int elemIdx = 0; elemIdx < numElems_; ++elemIdx)
+                initialPrimaryVariables(cellStates_[elemIdx].primaryVars, elemIdx, timeStepIdx);
+
+            for (int iterIdx = 0; iterIdx < numIterations; ++iterIdx) {
+                runStage_(UpdateStage, stageTime, [&](int elemIdx) { update_(elemIdx, iterIdx); });
+                runStage_(KrStage, stageTime, [&](int elemIdx) { relativePermeabilities_(elemIdx); });
+                runStage_(PcStage, stageTime, [&](int elemIdx) { capillaryPressures_(elemIdx); });
+                runStage_(PvtStage, stageTime, [&](int elemIdx) { pvt_(elemIdx); });
+            }
+
+            // the hysteresis parameters are updated once the time step is accepted.
+            // the manager parallelizes this itself.
+            perfCounters[HysteresisStage].start();
+            auto start = Clock::now();
+            materialLawManager_.updateHysteresis(fluidStates_);
+            stageTime[HysteresisStage] += secondsSince(start);
+            perfCounters[HysteresisStage].stop();
+        }
+    }
+
+    /*!
+     * \brief Returns the sum of all quantities which were calculated in the last
+     *        iteration.
+     *
+     * This is printed to make sure that the compiler does not optimize the stages
+     * away and to verify that the results do not depend on the number of threads.
+     */
+    Scalar checksum() const
+    {
+        Scalar result = 0.0;
+        for (int elemIdx = 0; elemIdx < numElems_; ++elemIdx) {
+            const auto& satFunc = satFuncResults_[elemIdx];
+            const auto& pvt = pvtResults_[elemIdx];
+            result += pvt.Rs.value + 1e3*pvt.Rv.value;
+            for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                result += satFunc.kr[phaseIdx].value + satFunc.pc[phaseIdx].value*1e-5;
+                result += pvt.phase[phaseIdx].invB.value + pvt.phase[phaseIdx].mu.value*1e3
+                    + pvt.phase[phaseIdx].density.value*1e-3;
+                for (int varIdx = 0; varIdx < numPrimaryVars; ++varIdx)
+                    result += satFunc.kr[phaseIdx].derivatives[varIdx]
+                        + pvt.phase[phaseIdx].density.derivatives[varIdx]*1e-3;
+            }
+        }
+        return result;
+    }
+
+private:
+    template <class Functor>
+    void runStage_(int stageIdx, double* stageTime, const Functor& functor)
+    {
+        int numElems = numElems_;
+        perfCounters[stageIdx].start();
+        auto start = Clock::now();
+        OPM_PROXY_PARALLEL_FOR
+        for (int elemIdx = 0; elemIdx < numElems; ++elemIdx)
+            functor(elemIdx);
+        stageTime[stageIdx] += secondsSince(start);
+        perfCounters[stageIdx].stop();
+    }
+
+    void update_(int elemIdx, int iterIdx)
+    {
+        Scalar* primaryVars = cellStates_[elemIdx].primaryVars;
+        updatePrimaryVariables(primaryVars, elemIdx, iterIdx);
+
+        Evaluation Sw = Evaluation::createVariable(primaryVars[waterSaturationIdx], waterSaturationIdx);
+        Evaluation Sg = Evaluation::createVariable(primaryVars[gasSaturationIdx], gasSaturationIdx);
+        oilPressures_[elemIdx] = Evaluation::createVariable(primaryVars[pressureIdx], pressureIdx);
+
+        auto& fs = fluidStates_[elemIdx];
+        fs.setSaturation(waterPhaseIdx, Sw);
+        fs.setSaturation(gasPhaseIdx, Sg);
+        fs.setSaturation(oilPhaseIdx, 1.0 - Sw - Sg);
+    }
+
+    void relativePermeabilities_(int elemIdx)
+    { materialLawManager_.relativePermeabilities(satFuncResults_[elemIdx].kr, fluidStates_[elemIdx], elemIdx); }
+
+    void capillaryPressures_(int elemIdx)
+    { materialLawManager_.capillaryPressures(satFuncResults_[elemIdx].pc, fluidStates_[elemIdx], elemIdx); }
+
+    void pvt_(int elemIdx)
+    {
+        int regionIdx = cellStates_[elemIdx].pvtRegionIdx;
+        const Evaluation* pc = satFuncResults_[elemIdx].pc;
+        const Evaluation& po = oilPressures_[elemIdx];
+        auto& result = pvtResults_[elemIdx];
+
+        Evaluation T = Evaluation::createConstant(temperature);
+        Evaluation pw = po + (pc[waterPhaseIdx] - pc[oilPhaseIdx]);
+        Evaluation pg = po + (pc[gasPhaseIdx] - pc[oilPhaseIdx]);
+
+        // the hydrocarbon phases are assumed saturated
+        Evaluation XoG = FluidSystem::saturatedOilGasMassFraction(T, po, regionIdx);
+        Evaluation XgO = FluidSystem::saturatedGasOilMassFraction(T, pg, regionIdx);
+        result.Rs = FluidSystem::gasDissolutionFactor(T, po, regionIdx);
+        result.Rv = FluidSystem::oilVaporizationFactor(T, pg, regionIdx);
+
+        result.phase[oilPhaseIdx] = FluidSystem::oilProperties(T, po, XoG, regionIdx);
+        result.phase[gasPhaseIdx] = FluidSystem::gasProperties(T, pg, XgO, regionIdx);
+        result.phase[waterPhaseIdx] = FluidSystem::waterProperties(T, pw, regionIdx);
+    }
+
+    MaterialLawManager& materialLawManager_;
+    int numElems_;
+
+    std::vector<CellState> cellStates_;
+    std::vector<Evaluation> oilPressures_;
+    std::vector<FluidState> fluidStates_;
+    std::vector<SaturationFunctionResults> satFuncResults_;
+    std::vector<PvtResults> pvtResults_;
+};
+
+static int runProxy(const ProxyOptions& opts)
+{
+    Opm::ParserPtr parser(new Opm::Parser);
+    Opm::ParseMode parseMode;
+    auto start = Clock::now();
+    Opm::DeckConstPtr deck;
+    if (opts.deckFileName.empty())
+        deck = parser->parseString(createDeckString(opts), parseMode);
+    else
+        deck = parser->parseFile(opts.deckFileName, parseMode);
+    Opm::EclipseStateConstPtr eclState(new Opm::EclipseState(deck, parseMode));
+    double parseTime = secondsSince(start);
+
+    // the active cells are the elements of the proxy
+    auto grid = eclState->getEclipseGrid();
+    std::vector<int> compressedToCartesianElemIdx;
+    for (size_t cartElemIdx = 0; cartElemIdx < grid->getCartesianSize(); ++cartElemIdx)
+        if (grid->cellActive(cartElemIdx))
+            compressedToCartesianElemIdx.push_back(static_cast<int>(cartElemIdx));
+    size_t numElems = compressedToCartesianElemIdx.size();
+
+    std::vector<int> pvtRegionIdx(numElems, 0);
+    if (eclState->hasIntGridProperty("PVTNUM")) {
+        const auto& pvtnumData = eclState->getIntGridProperty("PVTNUM")->getData();
+        for (size_t elemIdx = 0; elemIdx < numElems; ++elemIdx)
+            pvtRegionIdx[elemIdx] = pvtnumData[compressedToCartesianElemIdx[elemIdx]] - 1;
+    }
+
+    start = Clock::now();
+    initFluidSystem(deck, eclState);
+    double pvtInitTime = secondsSince(start);
+
+    MaterialLawManager materialLawManager;
+    materialLawManager.setEnableCompactStorage(opts.compactStorage);
+    double rssBefore = processMemory("VmRSS");
+    start = Clock::now();
+    materialLawManager.initFromDeck(deck, eclState, compressedToCartesianElemIdx);
+    double materialInitTime = secondsSince(start);
+    double rssAfter = processMemory("VmRSS");
+
+    Proxy proxy(materialLawManager, pvtRegionIdx);
+
+    std::cout << "cells: " << numElems << ", " << opts.timeSteps << " time steps with "
+              << opts.iterations << " Newton iterations each\n"
+              << "initialization [s]: parsing " << std::setprecision(3) << parseTime
+              << ", PVT " << pvtInitTime
+              << ", saturation functions " << materialInitTime << "\n"
+              << "memory:\n";
+    printMemory("saturation function parameters",
+                (rssBefore < 0 || rssAfter < 0) ? -1.0 : rssAfter - rssBefore);
+    printMemory("hysteresis state",
+                materialLawManager.hysteresisStateSize()*sizeof(Scalar)/(1024.0*1024.0));
+    printMemory("per-cell quantities", proxy.cellDataSize()/(1024.0*1024.0));
+
+    std::cout << std::setw(8) << "threads";
+    for (int stageIdx = 0; stageIdx < numStages; ++stageIdx)
+        std::cout << std::setw(12) << stageName(stageIdx);
+    std::cout << std::setw(12) << "total" << std::setw(10) << "speedup"
+              << "   [cells/s]\n";
+
+    // all stages except the hysteresis are evaluated for each Newton iteration
+    double numIterationEvals = double(numElems)*opts.timeSteps*opts.iterations;
+    double numTimeStepEvals = double(numElems)*opts.timeSteps;
+    double firstTotalTime = 0.0;
+    for (int numThreads : opts.threads) {
+#ifdef _OPENMP
+        omp_set_num_threads(numThreads);
+#endif
+
+        // the hysteresis parameters are restored, so that all thread counts do the
+        // same work
+        std::vector<Scalar> hysteresisState(materialLawManager.hysteresisStateSize());
+        materialLawManager.saveHysteresisState(hysteresisState.data());
+
+        for (auto& counters : perfCounters)
+            counters.reset();
+        double stageTime[numStages] = { 0.0 };
+        proxy.run(opts.timeSteps, opts.iterations, stageTime);
+
+        materialLawManager.restoreHysteresisState(hysteresisState.data());
+
+        double totalTime = 0.0;
+        for (int stageIdx = 0; stageIdx < numStages; ++stageIdx)
+            totalTime += stageTime[stageIdx];
+        if (firstTotalTime == 0.0)
+            firstTotalTime = totalTime;
+
+        std::cout << std::setw(8) << numThreads << std::setprecision(4);
+        for (int stageIdx = 0; stageIdx < numStages; ++stageIdx) {
+            double numEvals = (stageIdx == HysteresisStage) ? numTimeStepEvals : numIterationEvals;
+            std::cout << std::setw(12) << numEvals/stageTime[stageIdx];
+        }
+        std::cout << std::setw(12) << numIterationEvals/totalTime
+                  << std::setw(10) << std::setprecision(3) << firstTotalTime/totalTime
+                  << "   (checksum: " << std::setprecision(10) << proxy.checksum() << ")\n";
+
+        for (int stageIdx = 0; stageIdx < numStages; ++stageIdx) {
+            double numEvals = (stageIdx == HysteresisStage) ? numTimeStepEvals : numIterationEvals;
+            std::string prefix = std::string("    ") + stageName(stageIdx) + ", per cell:";
+            perfCounters[stageIdx].printPerEvaluation(std::cout, numEvals, prefix.c_str());
+        }
+    }
+
+    printMemory("peak resident memory", processMemory("VmHWM"));
+
+    return 0;
+}
+
+static bool parseOption(const char* arg, const char* name, std::string& value)
+{
+    size_t len = std::strlen(name);
+    if (std::strncmp(arg, name, len) != 0)
+        return false;
+    if (arg[len] == '=')
+        value = arg + len + 1;
+    else if (arg[len] == '\0')
+        value.clear();
+    else
+        return false;
+    return true;
+}
+
+static std::vector<int> parseThreadCounts(const std::string& value)
+{
+    std::vector<int> result;
+    std::istringstream is(value);
+    std::string token;
+    while (std::getline(is, token, ','))
+        result.push_back(std::atoi(token.c_str()));
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    ProxyOptions opts;
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        std::string value;
+        if (parseOption(argv[argIdx], "--deck", value))
+            opts.deckFileName = value;
+        else if (parseOption(argv[argIdx], "--nx", value))
+            opts.nx = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--ny", value))
+            opts.ny = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--nz", value))
+            opts.nz = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--timesteps", value))
+            opts.timeSteps = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--iterations", value))
+            opts.iterations = std::atoi(value.c_str());
+        else if (parseOption(argv[argIdx], "--threads", value))
+            opts.threads = parseThreadCounts(value);
+        else if (parseOption(argv[argIdx], "--compact-storage", value))
+            opts.compactStorage = true;
+        else if (parseOption(argv[argIdx], "--perf-counters", value)) {
+            bool available = false;
+            for (auto& counters : perfCounters)
+                available = counters.enable() || available;
+            if (!available)
+                std::cerr << "Warning: The hardware performance counters are not available\n";
+        }
+        else {
+            std::cerr << "Unknown option '" << argv[argIdx] << "'\n"
+                      << "Usage: " << argv[0] << " [--deck=FILE] [--nx=N] [--ny=N] [--nz=N]"
+                      << " [--timesteps=N] [--iterations=N] [--threads=N[,N...]]"
+                      << " [--compact-storage] [--perf-counters]\n";
+            return 1;
+        }
+    }
+
+    if (opts.threads.empty()) {
+#ifdef _OPENMP
+        opts.threads.push_back(omp_get_max_threads());
+#else
+        opts.threads.push_back(1);
+#endif
+    }
+
+    if (opts.nx < 1 || opts.ny < 1 || opts.nz < 1 || opts.timeSteps < 1 || opts.iterations < 1) {
+        std::cerr << "The grid dimensions and the numbers of time steps and iterations must be positive\n";
+        return 1;
+    }
+    for (int& numThreads : opts.threads) {
+        if (numThreads < 1) {
+            std::cerr << "The number of threads must be positive\n";
+            return 1;
+        }
+#ifndef _OPENMP
+        if (numThreads > 1) {
+            std::cerr << "Warning: This program was compiled without OpenMP, using a single thread\n";
+            numThreads = 1;
+        }
+#endif
+    }
+
+    return runProxy(opts);
+}
+#else
+int main()
+{
+    std::cout << "This proxy application requires the opm-parser module\n";
+    return 0;
+}
+#endif
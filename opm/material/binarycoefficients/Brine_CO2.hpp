@@ -30,6 +30,9 @@
 #include <opm/material/components/H2O.hpp>
 #include <opm/material/components/CO2.hpp>
 #include <opm/material/IdealGas.hpp>
+#include <opm/material/common/UniformTabulated2DFunction.hpp>
+
+#include <algorithm>
 
 namespace Opm {
 namespace BinaryCoeff {
@@ -80,6 +83,60 @@ public:
         return Toolbox::createConstant(2e-9);
     }
 
+    /*!
+     * \brief Tabulate the mutual solubilities of brine and CO2 for a given salinity.
+     *
+     * After this method has been called, calculateMoleFractions() interpolates the
+     * equilibrium quantities bi-linearly if it is called for the same salinity and
+     * the temperature and pressure are within the tabulated range. Otherwise, they
+     * are calculated from scratch. The derivatives of function evaluations are the
+     * ones of the interpolation.
+     *
+     * Since the correlations need the CO2 density, the range is limited to the one
+     * of the CO2 tables. Calling this method for an empty range disables the tables.
+     *
+     * \param tempMin The minimum temperature of the tables [K]
+     * \param tempMax The maximum temperature of the tables [K]
+     * \param nTemp The number of sampling points on the temperature axis
+     * \param pressMin The minimum pressure of the tables [Pa]
+     * \param pressMax The maximum pressure of the tables [Pa]
+     * \param nPress The number of sampling points on the pressure axis
+     * \param salinity the salinity [kg NaCl / kg solution]
+     */
+    static void tabulateMoleFractions(Scalar tempMin, Scalar tempMax, int nTemp,
+                                      Scalar pressMin, Scalar pressMax, int nPress,
+                                      Scalar salinity)
+    {
+        tempMin = std::max(tempMin, CO2Tables::tabulatedDensity.xMin());
+        tempMax = std::min(tempMax, CO2Tables::tabulatedDensity.xMax());
+        pressMin = std::max(pressMin, CO2Tables::tabulatedDensity.yMin());
+        pressMax = std::min(pressMax, CO2Tables::tabulatedDensity.yMax());
+
+        // disable the tables while they are filled
+        tabulatedSalinity_ = -1.0;
+        if (tempMin >= tempMax || pressMin >= pressMax || nTemp < 2 || nPress < 2)
+            return;
+
+        tabulatedA_.resize(tempMin, tempMax, nTemp, pressMin, pressMax, nPress);
+        tabulatedXlCO2_.resize(tempMin, tempMax, nTemp, pressMin, pressMax, nPress);
+
+#ifdef _OPENMP
+        #pragma omp parallel for
+#endif
+        for (int i = 0; i < nTemp; ++i) {
+            Scalar T = tabulatedA_.iToX(i);
+            for (int j = 0; j < nPress; ++j) {
+                Scalar pg = tabulatedA_.jToY(j);
+                // A is roughly inversely proportional to the pressure, so pg*A is
+                // much better suited for the linear interpolation
+                tabulatedA_.setSamplePoint(i, j, pg*computeA_(T, pg));
+                tabulatedXlCO2_.setSamplePoint(i, j, equilibriumXlCO2_(T, pg, salinity));
+            }
+        }
+
+        tabulatedSalinity_ = salinity;
+    }
+
     /*!
      * \brief Returns the _mol_ (!) fraction of CO2 in the liquid
      *        phase and the mol_ (!) fraction of H2O in the gas phase
@@ -105,7 +162,14 @@ public:
                                        Evaluation& xlCO2,
                                        Evaluation& ygH2O)
     {
-        Evaluation A = computeA_(temperature, pg);
+        bool useTables =
+            salinity == tabulatedSalinity_
+            && tabulatedA_.applies(temperature, pg);
+
+        Evaluation A =
+            useTables
+            ? tabulatedA_.eval(temperature, pg)/pg
+            : computeA_(temperature, pg);
 
         /* salinity: conversion from mass fraction to mol fraction */
         Scalar x_NaCl = salinityToMolFrac_(salinity);
@@ -113,11 +177,10 @@ public:
         // if both phases are present the mole fractions in each phase can be calculate
         // with the mutual solubility function
         if (knownPhaseIdx < 0) {
-            Scalar molalityNaCl = moleFracToMolality_(x_NaCl); // molality of NaCl //CHANGED
-            Evaluation m0_CO2 = molalityCO2inPureWater_(temperature, pg); // molality of CO2 in pure water
-            Evaluation gammaStar = activityCoefficient_(temperature, pg, molalityNaCl);// activity coefficient of CO2 in brine
-            Evaluation m_CO2 = m0_CO2 / gammaStar; // molality of CO2 in brine
-            xlCO2 = m_CO2 / (molalityNaCl + 55.508 + m_CO2); // mole fraction of CO2 in brine
+            xlCO2 =
+                useTables
+                ? tabulatedXlCO2_.eval(temperature, pg)
+                : equilibriumXlCO2_(temperature, pg, salinity); // mole fraction of CO2 in brine
             ygH2O = A * (1 - xlCO2 - x_NaCl); // mole fraction of water in the gas phase
         }
 
@@ -214,6 +277,26 @@ public:
     }
 
 private:
+    /*!
+     * \brief Returns the mole fraction of CO2 in brine if both phases are present
+     *
+     * \param temperature the temperature [K]
+     * \param pg the gas phase pressure [Pa]
+     * \param salinity the salinity [kg NaCl / kg solution]
+     */
+    template <class Evaluation>
+    static Evaluation equilibriumXlCO2_(const Evaluation& temperature,
+                                        const Evaluation& pg,
+                                        Scalar salinity)
+    {
+        Scalar x_NaCl = salinityToMolFrac_(salinity);
+        Scalar molalityNaCl = moleFracToMolality_(x_NaCl); // molality of NaCl
+        const Evaluation& m0_CO2 = molalityCO2inPureWater_(temperature, pg); // molality of CO2 in pure water
+        const Evaluation& gammaStar = activityCoefficient_(temperature, pg, molalityNaCl);// activity coefficient of CO2 in brine
+        const Evaluation& m_CO2 = m0_CO2 / gammaStar; // molality of CO2 in brine
+        return m_CO2 / (molalityNaCl + 55.508 + m_CO2);
+    }
+
     /*!
      * \brief Returns the molality of NaCl (mol NaCl / kg water) for a given mole fraction
      *
@@ -403,8 +486,18 @@ private:
         return Toolbox::pow(10.0, logk0_H2O);
     }
 
+    static Opm::UniformTabulated2DFunction<Scalar> tabulatedA_;
+    static Opm::UniformTabulated2DFunction<Scalar> tabulatedXlCO2_;
+    static Scalar tabulatedSalinity_;
 };
 
+template <class Scalar, class CO2Tables, bool verbose>
+Opm::UniformTabulated2DFunction<Scalar> Brine_CO2<Scalar, CO2Tables, verbose>::tabulatedA_;
+template <class Scalar, class CO2Tables, bool verbose>
+Opm::UniformTabulated2DFunction<Scalar> Brine_CO2<Scalar, CO2Tables, verbose>::tabulatedXlCO2_;
+template <class Scalar, class CO2Tables, bool verbose>
+Scalar Brine_CO2<Scalar, CO2Tables, verbose>::tabulatedSalinity_ = -1.0;
+
 } // namespace BinaryCoeff
 } // namespace Opm
 
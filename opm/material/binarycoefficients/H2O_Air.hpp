@@ -27,6 +27,7 @@
 #ifndef OPM_BINARY_COEFF_H2O_AIR_HPP
 #define OPM_BINARY_COEFF_H2O_AIR_HPP
 
+#include <opm/material/binarycoefficients/TemperatureTable.hpp>
 #include <opm/material/common/MathToolbox.hpp>
 
 #include <cmath>
@@ -41,6 +42,24 @@ namespace BinaryCoeff {
 class H2O_Air
 {
 public:
+    /*!
+     * \brief Tabulate the temperature dependent part of the gas diffusion coefficient.
+     *
+     * Afterwards, gasDiffCoeff() interpolates the product of the diffusion coefficient
+     * and the pressure for temperatures within the given range. (The Henry coefficient
+     * is not tabulated because its relation is as cheap as the interpolation.) Calling
+     * this method for an empty range disables the table.
+     *
+     * \param tempMin The minimum temperature of the table \f$\mathrm{[K]}\f$
+     * \param tempMax The maximum temperature of the table \f$\mathrm{[K]}\f$
+     * \param nTemp The number of sampling points on the temperature axis
+     */
+    static void tabulate(double tempMin, double tempMax, unsigned nTemp)
+    {
+        gasDiffCoeffTable_().tabulate(tempMin, tempMax, nTemp,
+                                      [](double T) { return gasDiffCoeffRelation_(T, 1.0); });
+    }
+
     /*!
      * \brief Henry coefficent \f$\mathrm{[N/m^2]}\f$  for air in liquid water.
      *
@@ -73,14 +92,11 @@ public:
     template <class Evaluation>
     static Evaluation gasDiffCoeff(const Evaluation& temperature, const Evaluation& pressure)
     {
-        typedef Opm::MathToolbox<Evaluation> Toolbox;
-
-        double Theta=1.8;
-        double Daw=2.13e-5;  /* reference value */
-        double pg0=1.e5;     /* reference pressure */
-        double T0=273.15;    /* reference temperature */
-
-        return Daw*(pg0/pressure)*Toolbox::pow((temperature/T0),Theta);
+        // the coefficient is inversely proportional to the pressure
+        const auto& table = gasDiffCoeffTable_();
+        if (table.applies(temperature))
+            return table.eval(temperature)/pressure;
+        return gasDiffCoeffRelation_(temperature, pressure);
     }
 
     /*!
@@ -110,6 +126,26 @@ public:
         const double Dexp = 2.01e-9; // [m^2/s]
         return Dexp/Texp*temperature;
     }
+
+private:
+    template <class Evaluation>
+    static Evaluation gasDiffCoeffRelation_(const Evaluation& temperature, const Evaluation& pressure)
+    {
+        typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+        double Theta=1.8;
+        double Daw=2.13e-5;  /* reference value */
+        double pg0=1.e5;     /* reference pressure */
+        double T0=273.15;    /* reference temperature */
+
+        return Daw*(pg0/pressure)*Toolbox::pow((temperature/T0),Theta);
+    }
+
+    static TemperatureTable<double>& gasDiffCoeffTable_()
+    {
+        static TemperatureTable<double> table;
+        return table;
+    }
 };
 
 } // namespace BinaryCoeff
@@ -28,6 +28,7 @@
 
 #include <opm/material/binarycoefficients/HenryIapws.hpp>
 #include <opm/material/binarycoefficients/FullerMethod.hpp>
+#include <opm/material/binarycoefficients/TemperatureTable.hpp>
 
 #include <opm/material/components/H2O.hpp>
 #include <opm/material/components/SimpleCO2.hpp>
@@ -42,6 +43,27 @@ namespace BinaryCoeff {
 class H2O_CO2
 {
 public:
+    /*!
+     * \brief Tabulate the temperature dependent coefficients for a given scalar type.
+     *
+     * Afterwards, henry() and gasDiffCoeff() interpolate the Henry coefficient and the
+     * product of the gas diffusion coefficient and the pressure for temperatures within
+     * the given range. Calling this method for an empty range disables the tables.
+     *
+     * \param tempMin The minimum temperature of the tables [K]
+     * \param tempMax The maximum temperature of the tables [K]
+     * \param nTemp The number of sampling points on the temperature axis
+     */
+    template <class Scalar>
+    static void tabulate(Scalar tempMin, Scalar tempMax, unsigned nTemp)
+    {
+        henryTable_<Scalar>().tabulate(tempMin, tempMax, nTemp,
+                                       [](Scalar T) { return henryRelation_<Scalar>(T); });
+        gasDiffCoeffTable_<Scalar>().tabulate(tempMin, tempMax, nTemp,
+                                              [](Scalar T)
+                                              { return gasDiffCoeffRelation_<Scalar>(T, Scalar(1.0)); });
+    }
+
     /*!
      * \brief Henry coefficent \f$[N/m^2]\f$  for molecular CO2 in liquid water.
      *
@@ -55,12 +77,10 @@ public:
     template <class Scalar, class Evaluation = Scalar>
     static Evaluation henry(const Evaluation& temperature)
     {
-        const Scalar E = 1672.9376;
-        const Scalar F = 28.1751;
-        const Scalar G = -112.4619;
-        const Scalar H = 85.3807;
-
-        return henryIAPWS(E, F, G, H, temperature);
+        const auto& table = henryTable_<Scalar>();
+        if (table.applies(temperature))
+            return table.eval(temperature);
+        return henryRelation_<Scalar>(temperature);
     }
 
     /*!
@@ -70,6 +90,35 @@ public:
      */
     template <class Scalar, class Evaluation = Scalar>
     static Evaluation gasDiffCoeff(const Evaluation& temperature, const Evaluation& pressure)
+    {
+        // the coefficient is inversely proportional to the pressure
+        const auto& table = gasDiffCoeffTable_<Scalar>();
+        if (table.applies(temperature))
+            return table.eval(temperature)/pressure;
+        return gasDiffCoeffRelation_<Scalar>(temperature, pressure);
+    }
+
+    /*!
+     * \brief Diffusion coefficent [m^2/s] for molecular CO2 in liquid water.
+     */
+    template <class Scalar, class Evaluation = Scalar>
+    static Evaluation liquidDiffCoeff(const Evaluation& temperature, const Evaluation& pressure)
+    { OPM_THROW(std::runtime_error, "Not implemented: Binary liquid diffusion coefficients of CO2 and CH4"); }
+
+private:
+    template <class Scalar, class Evaluation = Scalar>
+    static Evaluation henryRelation_(const Evaluation& temperature)
+    {
+        const Scalar E = 1672.9376;
+        const Scalar F = 28.1751;
+        const Scalar G = -112.4619;
+        const Scalar H = 85.3807;
+
+        return henryIAPWS(E, F, G, H, temperature);
+    }
+
+    template <class Scalar, class Evaluation = Scalar>
+    static Evaluation gasDiffCoeffRelation_(const Evaluation& temperature, const Evaluation& pressure)
     {
         typedef Opm::H2O<Scalar> H2O;
         typedef Opm::SimpleCO2<Scalar> CO2;
@@ -82,12 +131,19 @@ public:
         return fullerMethod(M, SigmaNu, temperature, pressure);
     }
 
-    /*!
-     * \brief Diffusion coefficent [m^2/s] for molecular CO2 in liquid water.
-     */
-    template <class Scalar, class Evaluation = Scalar>
-    static Evaluation liquidDiffCoeff(const Evaluation& temperature, const Evaluation& pressure)
-    { OPM_THROW(std::runtime_error, "Not implemented: Binary liquid diffusion coefficients of CO2 and CH4"); }
+    template <class Scalar>
+    static TemperatureTable<Scalar>& henryTable_()
+    {
+        static TemperatureTable<Scalar> table;
+        return table;
+    }
+
+    template <class Scalar>
+    static TemperatureTable<Scalar>& gasDiffCoeffTable_()
+    {
+        static TemperatureTable<Scalar> table;
+        return table;
+    }
 };
 
 } // namespace BinaryCoeff
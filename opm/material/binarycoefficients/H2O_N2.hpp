@@ -29,6 +29,7 @@
 
 #include "HenryIapws.hpp"
 #include "FullerMethod.hpp"
+#include "TemperatureTable.hpp"
 
 #include <opm/material/components/N2.hpp>
 #include <opm/material/components/H2O.hpp>
@@ -43,6 +44,25 @@ namespace BinaryCoeff {
 class H2O_N2
 {
 public:
+    /*!
+     * \brief Tabulate the temperature dependent coefficients.
+     *
+     * Afterwards, henry() and gasDiffCoeff() interpolate the Henry coefficient and the
+     * product of the gas diffusion coefficient and the pressure for temperatures within
+     * the given range. Calling this method for an empty range disables the tables.
+     *
+     * \param tempMin The minimum temperature of the tables \f$\mathrm{[K]}\f$
+     * \param tempMax The maximum temperature of the tables \f$\mathrm{[K]}\f$
+     * \param nTemp The number of sampling points on the temperature axis
+     */
+    static void tabulate(double tempMin, double tempMax, unsigned nTemp)
+    {
+        henryTable_().tabulate(tempMin, tempMax, nTemp,
+                               [](double T) { return henryRelation_(T); });
+        gasDiffCoeffTable_().tabulate(tempMin, tempMax, nTemp,
+                                      [](double T) { return gasDiffCoeffRelation_(T, 1.0); });
+    }
+
     /*!
      * \brief Henry coefficent \f$\mathrm{[N/m^2]}\f$  for molecular nitrogen in liquid water.
      *
@@ -51,12 +71,10 @@ public:
     template <class Evaluation>
     static Evaluation henry(const Evaluation& temperature)
     {
-        const double E = 2388.8777;
-        const double F = -14.9593;
-        const double G = 42.0179;
-        const double H = -29.4396;
-
-        return henryIAPWS(E, F, G, H, temperature);
+        const auto& table = henryTable_();
+        if (table.applies(temperature))
+            return table.eval(temperature);
+        return henryRelation_(temperature);
     }
 
     /*!
@@ -69,15 +87,11 @@ public:
     template <class Evaluation>
     static Evaluation gasDiffCoeff(const Evaluation& temperature, const Evaluation& pressure)
     {
-        typedef Opm::H2O<double> H2O;
-        typedef Opm::N2<double> N2;
-
-        // atomic diffusion volumes
-        const double SigmaNu[2] = { 13.1 /* H2O */,  18.5 /* N2 */ };
-        // molar masses [g/mol]
-        const double M[2] = { H2O::molarMass()*1e3, N2::molarMass()*1e3 };
-
-        return fullerMethod(M, SigmaNu, temperature, pressure);
+        // the coefficient is inversely proportional to the pressure
+        const auto& table = gasDiffCoeffTable_();
+        if (table.applies(temperature))
+            return table.eval(temperature)/pressure;
+        return gasDiffCoeffRelation_(temperature, pressure);
     }
 
     /*!
@@ -106,6 +120,44 @@ public:
 
         return Dexp * temperature/Texp;
     }
+
+private:
+    template <class Evaluation>
+    static Evaluation henryRelation_(const Evaluation& temperature)
+    {
+        const double E = 2388.8777;
+        const double F = -14.9593;
+        const double G = 42.0179;
+        const double H = -29.4396;
+
+        return henryIAPWS(E, F, G, H, temperature);
+    }
+
+    template <class Evaluation>
+    static Evaluation gasDiffCoeffRelation_(const Evaluation& temperature, const Evaluation& pressure)
+    {
+        typedef Opm::H2O<double> H2O;
+        typedef Opm::N2<double> N2;
+
+        // atomic diffusion volumes
+        const double SigmaNu[2] = { 13.1 /* H2O */,  18.5 /* N2 */ };
+        // molar masses [g/mol]
+        const double M[2] = { H2O::molarMass()*1e3, N2::molarMass()*1e3 };
+
+        return fullerMethod(M, SigmaNu, temperature, pressure);
+    }
+
+    static TemperatureTable<double>& henryTable_()
+    {
+        static TemperatureTable<double> table;
+        return table;
+    }
+
+    static TemperatureTable<double>& gasDiffCoeffTable_()
+    {
+        static TemperatureTable<double> table;
+        return table;
+    }
 };
 
 } // namespace BinaryCoeff
@@ -48,7 +48,7 @@ inline Evaluation henryIAPWS(Scalar E,
                              const Evaluation& temperature)
 {
     typedef Opm::MathToolbox<Evaluation> Toolbox;
-    typedef Opm::H2O<Evaluation> H2O;
+    typedef Opm::H2O<Scalar> H2O;
 
     Evaluation Tr = temperature/H2O::criticalTemperature();
     Evaluation tau = 1 - Tr;
@@ -0,0 +1,86 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::BinaryCoeff::TemperatureTable
+ */
+#ifndef OPM_BINARY_COEFF_TEMPERATURE_TABLE_HPP
+#define OPM_BINARY_COEFF_TEMPERATURE_TABLE_HPP
+
+#include <opm/material/common/UniformMonotoneTable.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+
+namespace Opm {
+namespace BinaryCoeff {
+
+/*!
+ * \ingroup Binarycoefficients
+ * \brief A table for binary coefficients which only depend on temperature.
+ *
+ * Henry coefficients and the products of gas diffusion coefficients and pressure are
+ * smooth functions of temperature which are quite expensive to evaluate. The binary
+ * coefficient classes can thus optionally tabulate them for a temperature range; for
+ * temperatures outside of this range, the original relations are used.
+ */
+template <class Scalar>
+class TemperatureTable : public UniformMonotoneTable<Scalar>
+{
+    typedef UniformMonotoneTable<Scalar> ParentType;
+
+public:
+    /*!
+     * \brief Tabulate a function of temperature.
+     *
+     * Calling this method for an empty range or for less than two sampling points
+     * disables the table.
+     */
+    template <class Functor>
+    void tabulate(Scalar tempMin, Scalar tempMax, unsigned nTemp, const Functor& fn)
+    {
+        if (!(tempMin < tempMax) || nTemp < 2) {
+            static_cast<ParentType&>(*this) = ParentType();
+            return;
+        }
+
+        ParentType::init(tempMin, tempMax, nTemp, fn);
+    }
+
+    /*!
+     * \brief Returns true if the table has been initialized and a temperature is within
+     *        its range.
+     */
+    template <class Evaluation>
+    bool applies(const Evaluation& temperature) const
+    {
+        typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+        if (!ParentType::isInitialized())
+            return false;
+
+        Scalar T = Toolbox::value(temperature);
+        return ParentType::xMin() <= T && T <= ParentType::xMax();
+    }
+};
+
+} // namespace BinaryCoeff
+} // namespace Opm
+
+#endif
@@ -0,0 +1,527 @@
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief The implementation of the C interface, cf. BlackOilCApi.h.
+ *
+ * This file is only compiled if the OPM_MATERIAL_C_API option of the build system is
+ * enabled.
+ */
+#include "config.h"
+
+#if HAVE_OPM_PARSER
+#include <opm/material/capi/BlackOilCApi.h>
+
+#include <opm/material/common/ExplicitInstantiations.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/LiveOilPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/DeadOilPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/WetGasPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/DryGasPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/ConstantCompressibilityWaterPvt.hpp>
+#include <opm/material/fluidmatrixinteractions/EclMaterialLawManager.hpp>
+#include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
+#include <opm/material/fluidstates/SimpleModularFluidState.hpp>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Parser/ParseMode.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+
+#include <exception>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+// the derivatives are taken with regard to two variables: the pressure and the
+// dissolution factor for the PVT relations and the water and the gas saturations for
+// the saturation functions. using the evaluation type of the explicit instantiations
+// avoids instantiating the fluid system again if the library provides it.
+typedef Opm::ExplicitInstantiations::Evaluation2 Evaluation;
+typedef Opm::FluidSystems::BlackOilInstance<double, Evaluation> FluidSystem;
+typedef Opm::ThreePhaseMaterialTraits<double,
+                                      /*wettingPhaseIdx=*/FluidSystem::waterPhaseIdx,
+                                      /*nonWettingPhaseIdx=*/FluidSystem::oilPhaseIdx,
+                                      /*gasPhaseIdx=*/FluidSystem::gasPhaseIdx> MaterialTraits;
+typedef Opm::EclMaterialLawManager<MaterialTraits> MaterialLawManager;
+
+static_assert(FluidSystem::waterPhaseIdx == OPM_WATER_PHASE
+              && FluidSystem::oilPhaseIdx == OPM_OIL_PHASE
+              && FluidSystem::gasPhaseIdx == OPM_GAS_PHASE,
+              "The phase indices of the C interface must be the ones of the fluid system");
+
+enum { pressureVarIdx = 0, dissolutionVarIdx = 1 };
+enum { waterSaturationVarIdx = 0, gasSaturationVarIdx = 1 };
+} // anonymous namespace
+
+struct OpmBlackOilModel
+{
+    FluidSystem fluidSystem;
+    MaterialLawManager materialLawManager;
+
+    // the PVT region of each cell
+    std::vector<int> pvtRegionIdx;
+};
+
+namespace {
+// the message of the last unsuccessful call. exceptions must not propagate to the
+// callers, which are not necessarily written in C++.
+thread_local std::string lastError_;
+
+int fail_(int status, const std::string& message)
+{
+    lastError_ = message;
+    return status;
+}
+
+double valueAt_(const OpmConstDoubleArray& array, size_t i)
+{ return array.data[static_cast<ptrdiff_t>(i)*array.stride]; }
+
+bool isRequested_(const OpmDoubleArray& array)
+{ return array.data != nullptr; }
+
+bool isValidOutput_(const OpmDoubleArray& array)
+{ return !isRequested_(array) || array.stride != 0; }
+
+bool isContiguous_(const OpmDoubleArray& array)
+{ return array.stride == 1; }
+
+double derivative_(double /* value */, int /* varIdx */)
+{ return 0.0; }
+
+double derivative_(const Evaluation& value, int varIdx)
+{ return value.derivatives[varIdx]; }
+
+// write a quantity and its derivatives into the arrays which have been requested
+template <class Eval>
+void store_(const Eval& quantity,
+            size_t i,
+            const OpmDoubleArray& value,
+            const OpmDoubleArray& derivative0,
+            const OpmDoubleArray& derivative1)
+{
+    ptrdiff_t idx = static_cast<ptrdiff_t>(i);
+    if (isRequested_(value))
+        value.data[idx*value.stride] = Opm::MathToolbox<Eval>::value(quantity);
+    if (isRequested_(derivative0))
+        derivative0.data[idx*derivative0.stride] = derivative_(quantity, 0);
+    if (isRequested_(derivative1))
+        derivative1.data[idx*derivative1.stride] = derivative_(quantity, 1);
+}
+
+bool derivativesRequested_(const OpmPhasePropertiesArrays& out)
+{
+    return
+        isRequested_(out.dInvB_dp) || isRequested_(out.dMu_dp) || isRequested_(out.dDensity_dp)
+        || isRequested_(out.dInvB_dR) || isRequested_(out.dMu_dR) || isRequested_(out.dDensity_dR);
+}
+
+bool derivativesRequested_(const OpmSaturationFunctionArrays& out)
+{
+    return
+        isRequested_(out.dkrw_dSw) || isRequested_(out.dkrw_dSg)
+        || isRequested_(out.dkro_dSw) || isRequested_(out.dkro_dSg)
+        || isRequested_(out.dkrg_dSw) || isRequested_(out.dkrg_dSg)
+        || isRequested_(out.dpcow_dSw) || isRequested_(out.dpcow_dSg)
+        || isRequested_(out.dpcgo_dSw) || isRequested_(out.dpcgo_dSg);
+}
+
+// the PVT objects do not use the reference densities of the default fluid system, so
+// they need to be told about them
+template <class Pvt>
+void initPvtRegions_(Pvt& pvt,
+                     const std::vector<double>& rhoOil,
+                     const std::vector<double>& rhoWater,
+                     const std::vector<double>& rhoGas)
+{
+    int numPvtRegions = static_cast<int>(rhoOil.size());
+    pvt.setNumRegions(numPvtRegions);
+    for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx)
+        pvt.setReferenceDensities(rhoOil[regionIdx], rhoWater[regionIdx], rhoGas[regionIdx], regionIdx);
+}
+
+void initFluidSystem_(OpmBlackOilModel& model,
+                      Opm::DeckConstPtr deck,
+                      Opm::EclipseStateConstPtr eclState)
+{
+    int numPvtRegions = deck->getKeyword("TABDIMS")->getRecord(0)->getItem("NTPVT")->getInt(0);
+    auto tables = eclState->getTableManager();
+    FluidSystem& fluidSystem = model.fluidSystem;
+
+    fluidSystem.initBegin(numPvtRegions);
+    fluidSystem.setEnableDissolvedGas(deck->hasKeyword("DISGAS"));
+    fluidSystem.setEnableVaporizedOil(deck->hasKeyword("VAPOIL"));
+
+    std::vector<double> rhoOil(numPvtRegions), rhoWater(numPvtRegions), rhoGas(numPvtRegions);
+    Opm::DeckKeywordConstPtr densityKeyword = deck->getKeyword("DENSITY");
+    for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx) {
+        auto densityRecord = densityKeyword->getRecord(regionIdx);
+        rhoOil[regionIdx] = densityRecord->getItem("OIL")->getSIDouble(0);
+        rhoWater[regionIdx] = densityRecord->getItem("WATER")->getSIDouble(0);
+        rhoGas[regionIdx] = densityRecord->getItem("GAS")->getSIDouble(0);
+        fluidSystem.setReferenceDensities(rhoOil[regionIdx], rhoWater[regionIdx], rhoGas[regionIdx], regionIdx);
+    }
+
+    if (deck->hasKeyword("PVTO")) {
+        auto oilPvt = std::make_shared<Opm::LiveOilPvt<double, Evaluation> >();
+        initPvtRegions_(*oilPvt, rhoOil, rhoWater, rhoGas);
+        for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx)
+            oilPvt->setPvtoTable(regionIdx, tables->getPvtoTables()[regionIdx]);
+        oilPvt->initEnd();
+        fluidSystem.setOilPvt(oilPvt);
+    }
+    else {
+        auto oilPvt = std::make_shared<Opm::DeadOilPvt<double, Evaluation> >();
+        initPvtRegions_(*oilPvt, rhoOil, rhoWater, rhoGas);
+        for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx)
+            oilPvt->setPvdoTable(regionIdx, tables->getPvdoTables()[regionIdx]);
+        oilPvt->initEnd();
+        fluidSystem.setOilPvt(oilPvt);
+    }
+
+    if (deck->hasKeyword("PVTG")) {
+        auto gasPvt = std::make_shared<Opm::WetGasPvt<double, Evaluation> >();
+        initPvtRegions_(*gasPvt, rhoOil, rhoWater, rhoGas);
+        for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx)
+            gasPvt->setPvtgTable(regionIdx, tables->getPvtgTables()[regionIdx]);
+        gasPvt->initEnd();
+        fluidSystem.setGasPvt(gasPvt);
+    }
+    else {
+        auto gasPvt = std::make_shared<Opm::DryGasPvt<double, Evaluation> >();
+        initPvtRegions_(*gasPvt, rhoOil, rhoWater, rhoGas);
+        for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx)
+            gasPvt->setPvdgTable(regionIdx, tables->getPvdgTables()[regionIdx]);
+        gasPvt->initEnd();
+        fluidSystem.setGasPvt(gasPvt);
+    }
+
+    auto waterPvt = std::make_shared<Opm::ConstantCompressibilityWaterPvt<double, Evaluation> >();
+    initPvtRegions_(*waterPvt, rhoOil, rhoWater, rhoGas);
+    for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx)
+        waterPvt->setPvtw(regionIdx, deck->getKeyword("PVTW"));
+    waterPvt->initEnd();
+    fluidSystem.setWaterPvt(waterPvt);
+
+    fluidSystem.initEnd();
+}
+
+template <class Eval>
+void phaseProperties_(const OpmBlackOilModel& model,
+                      int phase,
+                      size_t firstCell,
+                      size_t numCells,
+                      const OpmConstDoubleArray& temperature,
+                      const OpmConstDoubleArray& pressure,
+                      const OpmConstDoubleArray& dissolution,
+                      const OpmPhasePropertiesArrays& out)
+{
+    typedef Opm::MathToolbox<Eval> Toolbox;
+
+    const FluidSystem& fluidSystem = model.fluidSystem;
+    for (size_t i = 0; i < numCells; ++i) {
+        int regionIdx = model.pvtRegionIdx[firstCell + i];
+        const Eval& T = Toolbox::createConstant(valueAt_(temperature, i));
+        const Eval& p = Toolbox::createVariable(valueAt_(pressure, i), pressureVarIdx);
+
+        Opm::BlackOilPhaseProperties<Eval> props;
+        if (phase == OPM_WATER_PHASE)
+            props = fluidSystem.waterProperties(T, p, regionIdx);
+        else {
+            // the fluid system expects the mass fraction of the dissolved component
+            // instead of the dissolution factor
+            const Eval& R = Toolbox::createVariable(valueAt_(dissolution, i), dissolutionVarIdx);
+            double rhoo = fluidSystem.referenceDensity(FluidSystem::oilPhaseIdx, regionIdx);
+            double rhog = fluidSystem.referenceDensity(FluidSystem::gasPhaseIdx, regionIdx);
+            if (phase == OPM_OIL_PHASE)
+                props = fluidSystem.oilProperties(T, p, Eval(R*rhog/(rhoo + R*rhog)), regionIdx);
+            else
+                props = fluidSystem.gasProperties(T, p, Eval(R*rhoo/(rhog + R*rhoo)), regionIdx);
+        }
+
+        store_(props.invB, i, out.invB, out.dInvB_dp, out.dInvB_dR);
+        store_(props.mu, i, out.mu, out.dMu_dp, out.dMu_dR);
+        store_(props.density, i, out.density, out.dDensity_dp, out.dDensity_dR);
+    }
+}
+
+template <class Eval>
+void saturationFunctions_(const OpmBlackOilModel& model,
+                          size_t firstCell,
+                          size_t numCells,
+                          const OpmConstDoubleArray& Sw,
+                          const OpmConstDoubleArray& Sg,
+                          const OpmSaturationFunctionArrays& out)
+{
+    typedef Opm::MathToolbox<Eval> Toolbox;
+    typedef Opm::SimpleModularFluidState<Eval,
+                                         /*numPhases=*/3,
+                                         /*numComponents=*/0,
+                                         /*FluidSystem=*/void, /* -> don't care */
+                                         /*storePressure=*/false,
+                                         /*storeTemperature=*/false,
+                                         /*storeComposition=*/false,
+                                         /*storeFugacity=*/false,
+                                         /*storeSaturation=*/true,
+                                         /*storeDensity=*/false,
+                                         /*storeViscosity=*/false,
+                                         /*storeEnthalpy=*/false> FluidState;
+
+    enum { waterPhaseIdx = FluidSystem::waterPhaseIdx };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+    bool krRequested =
+        isRequested_(out.krw) || isRequested_(out.kro) || isRequested_(out.krg)
+        || isRequested_(out.dkrw_dSw) || isRequested_(out.dkrw_dSg)
+        || isRequested_(out.dkro_dSw) || isRequested_(out.dkro_dSg)
+        || isRequested_(out.dkrg_dSw) || isRequested_(out.dkrg_dSg);
+    bool pcRequested =
+        isRequested_(out.pcow) || isRequested_(out.pcgo)
+        || isRequested_(out.dpcow_dSw) || isRequested_(out.dpcow_dSg)
+        || isRequested_(out.dpcgo_dSw) || isRequested_(out.dpcgo_dSg);
+
+    const MaterialLawManager& manager = model.materialLawManager;
+    FluidState fluidState;
+    for (size_t i = 0; i < numCells; ++i) {
+        unsigned elemIdx = static_cast<unsigned>(firstCell + i);
+        const Eval& sw = Toolbox::createVariable(valueAt_(Sw, i), waterSaturationVarIdx);
+        const Eval& sg = Toolbox::createVariable(valueAt_(Sg, i), gasSaturationVarIdx);
+        fluidState.setSaturation(waterPhaseIdx, sw);
+        fluidState.setSaturation(gasPhaseIdx, sg);
+        fluidState.setSaturation(oilPhaseIdx, Eval(1.0 - sw - sg));
+
+        if (krRequested) {
+            Eval kr[3];
+            manager.relativePermeabilities(kr, fluidState, elemIdx);
+            store_(kr[waterPhaseIdx], i, out.krw, out.dkrw_dSw, out.dkrw_dSg);
+            store_(kr[oilPhaseIdx], i, out.kro, out.dkro_dSw, out.dkro_dSg);
+            store_(kr[gasPhaseIdx], i, out.krg, out.dkrg_dSw, out.dkrg_dSg);
+        }
+
+        if (pcRequested) {
+            Eval pc[3];
+            manager.capillaryPressures(pc, fluidState, elemIdx);
+            store_(Eval(pc[oilPhaseIdx] - pc[waterPhaseIdx]), i, out.pcow, out.dpcow_dSw, out.dpcow_dSg);
+            store_(Eval(pc[gasPhaseIdx] - pc[oilPhaseIdx]), i, out.pcgo, out.dpcgo_dSw, out.dpcgo_dSg);
+        }
+    }
+}
+
+int checkRange_(const OpmBlackOilModel* model, size_t firstCell, size_t numCells)
+{
+    if (!model)
+        return fail_(OPM_STATUS_INVALID_ARGUMENT, "The model must not be NULL");
+
+    size_t modelCells = model->pvtRegionIdx.size();
+    if (firstCell > modelCells || numCells > modelCells - firstCell)
+        return fail_(OPM_STATUS_INVALID_ARGUMENT,
+                     "The range of cells [" + std::to_string(firstCell) + ", "
+                     + std::to_string(firstCell + numCells) + ") exceeds the "
+                     + std::to_string(modelCells) + " cells of the model");
+
+    return OPM_STATUS_SUCCESS;
+}
+} // anonymous namespace
+
+extern "C" {
+
+OpmBlackOilModel* opm_black_oil_create_from_deck(const char* deckFileName)
+{
+    if (!deckFileName) {
+        fail_(OPM_STATUS_INVALID_ARGUMENT, "The name of the deck file must not be NULL");
+        return nullptr;
+    }
+
+    try {
+        Opm::ParserPtr parser(new Opm::Parser);
+        Opm::ParseMode parseMode;
+        Opm::DeckConstPtr deck = parser->parseFile(deckFileName, parseMode);
+        Opm::EclipseStateConstPtr eclState(new Opm::EclipseState(deck, parseMode));
+
+        // the cells of the model are the active cells of the grid
+        auto grid = eclState->getEclipseGrid();
+        std::vector<int> compressedToCartesianElemIdx;
+        for (size_t cartElemIdx = 0; cartElemIdx < grid->getCartesianSize(); ++cartElemIdx)
+            if (grid->cellActive(cartElemIdx))
+                compressedToCartesianElemIdx.push_back(static_cast<int>(cartElemIdx));
+        size_t numCells = compressedToCartesianElemIdx.size();
+
+        std::unique_ptr<OpmBlackOilModel> model(new OpmBlackOilModel);
+        model->pvtRegionIdx.assign(numCells, 0);
+        if (eclState->hasIntGridProperty("PVTNUM")) {
+            const auto& pvtnumData = eclState->getIntGridProperty("PVTNUM")->getData();
+            for (size_t cellIdx = 0; cellIdx < numCells; ++cellIdx)
+                model->pvtRegionIdx[cellIdx] = pvtnumData[compressedToCartesianElemIdx[cellIdx]] - 1;
+        }
+
+        initFluidSystem_(*model, deck, eclState);
+        model->materialLawManager.initFromDeck(deck, eclState, compressedToCartesianElemIdx);
+
+        return model.release();
+    }
+    catch (const std::exception& e) {
+        fail_(OPM_STATUS_ERROR, std::string("Could not create the model: ") + e.what());
+    }
+    catch (...) {
+        fail_(OPM_STATUS_ERROR, "Could not create the model");
+    }
+    return nullptr;
+}
+
+void opm_black_oil_destroy(OpmBlackOilModel* model)
+{ delete model; }
+
+const char* opm_black_oil_last_error(void)
+{ return lastError_.c_str(); }
+
+size_t opm_black_oil_num_cells(const OpmBlackOilModel* model)
+{ return model ? model->pvtRegionIdx.size() : 0; }
+
+int opm_black_oil_phase_properties(const OpmBlackOilModel* model,
+                                   int phase,
+                                   size_t firstCell,
+                                   size_t numCells,
+                                   OpmConstDoubleArray temperature,
+                                   OpmConstDoubleArray pressure,
+                                   OpmConstDoubleArray dissolution,
+                                   const OpmPhasePropertiesArrays* out)
+{
+    int status = checkRange_(model, firstCell, numCells);
+    if (status != OPM_STATUS_SUCCESS)
+        return status;
+    if (phase != OPM_WATER_PHASE && phase != OPM_OIL_PHASE && phase != OPM_GAS_PHASE)
+        return fail_(OPM_STATUS_INVALID_ARGUMENT, "Invalid phase index " + std::to_string(phase));
+    if (!out)
+        return fail_(OPM_STATUS_INVALID_ARGUMENT, "The output arrays must not be NULL");
+    if (numCells == 0)
+        return OPM_STATUS_SUCCESS;
+    if (!temperature.data || !pressure.data || (phase != OPM_WATER_PHASE && !dissolution.data))
+        return fail_(OPM_STATUS_INVALID_ARGUMENT, "The input arrays must not be NULL");
+
+    const OpmDoubleArray* outputs[] = {
+        &out->invB, &out->mu, &out->density,
+        &out->dInvB_dp, &out->dMu_dp, &out->dDensity_dp,
+        &out->dInvB_dR, &out->dMu_dR, &out->dDensity_dR
+    };
+    for (const OpmDoubleArray* output : outputs)
+        if (!isValidOutput_(*output))
+            return fail_(OPM_STATUS_INVALID_ARGUMENT, "The stride of an output array must not be zero");
+
+    try {
+        if (derivativesRequested_(*out))
+            phaseProperties_<Evaluation>(*model, phase, firstCell, numCells,
+                                         temperature, pressure, dissolution, *out);
+        else
+            phaseProperties_<double>(*model, phase, firstCell, numCells,
+                                     temperature, pressure, dissolution, *out);
+    }
+    catch (const std::exception& e) {
+        return fail_(OPM_STATUS_ERROR, e.what());
+    }
+    catch (...) {
+        return fail_(OPM_STATUS_ERROR, "Unknown error while evaluating the PVT relations");
+    }
+
+    return OPM_STATUS_SUCCESS;
+}
+
+int opm_black_oil_saturation_functions(const OpmBlackOilModel* model,
+                                       size_t firstCell,
+                                       size_t numCells,
+                                       OpmConstDoubleArray Sw,
+                                       OpmConstDoubleArray Sg,
+                                       const OpmSaturationFunctionArrays* out)
+{
+    int status = checkRange_(model, firstCell, numCells);
+    if (status != OPM_STATUS_SUCCESS)
+        return status;
+    if (!out)
+        return fail_(OPM_STATUS_INVALID_ARGUMENT, "The output arrays must not be NULL");
+    if (numCells == 0)
+        return OPM_STATUS_SUCCESS;
+    if (!Sw.data || !Sg.data)
+        return fail_(OPM_STATUS_INVALID_ARGUMENT, "The input arrays must not be NULL");
+
+    const OpmDoubleArray* outputs[] = {
+        &out->krw, &out->kro, &out->krg, &out->pcow, &out->pcgo,
+        &out->dkrw_dSw, &out->dkrw_dSg, &out->dkro_dSw, &out->dkro_dSg,
+        &out->dkrg_dSw, &out->dkrg_dSg, &out->dpcow_dSw, &out->dpcow_dSg,
+        &out->dpcgo_dSw, &out->dpcgo_dSg
+    };
+    for (const OpmDoubleArray* output : outputs)
+        if (!isValidOutput_(*output))
+            return fail_(OPM_STATUS_INVALID_ARGUMENT, "The stride of an output array must not be zero");
+
+    try {
+        if (derivativesRequested_(*out)) {
+            saturationFunctions_<Evaluation>(*model, firstCell, numCells, Sw, Sg, *out);
+            return OPM_STATUS_SUCCESS;
+        }
+
+        // the batched method of the material law manager indexes the arrays by the
+        // element index and writes all quantities of a group. it can thus be used
+        // directly if the arrays start at the first cell, if they are contiguous and if
+        // either all or none of the quantities of each group are requested.
+        bool allKr = isRequested_(out->krw) && isRequested_(out->kro) && isRequested_(out->krg);
+        bool noKr = !isRequested_(out->krw) && !isRequested_(out->kro) && !isRequested_(out->krg);
+        bool allPc = isRequested_(out->pcow) && isRequested_(out->pcgo);
+        bool noPc = !isRequested_(out->pcow) && !isRequested_(out->pcgo);
+        bool contiguous =
+            Sw.stride == 1 && Sg.stride == 1
+            && (noKr || (isContiguous_(out->krw) && isContiguous_(out->kro) && isContiguous_(out->krg)))
+            && (noPc || (isContiguous_(out->pcow) && isContiguous_(out->pcgo)));
+
+        if (firstCell == 0 && contiguous && (allKr || noKr) && (allPc || noPc)) {
+            unsigned quantities = 0;
+            if (allKr)
+                quantities |= MaterialLawManager::RelativePermeabilities;
+            if (allPc)
+                quantities |= MaterialLawManager::CapillaryPressures;
+
+            const MaterialLawManager& manager = model->materialLawManager;
+            if (numCells == model->pvtRegionIdx.size())
+                manager.saturationFunctionsBatch(quantities, Sw.data, Sg.data,
+                                                 out->krw.data, out->kro.data, out->krg.data,
+                                                 out->pcow.data, out->pcgo.data);
+            else
+                manager.saturationFunctionsBatch(quantities, 0, static_cast<unsigned>(numCells),
+                                                 Sw.data, Sg.data,
+                                                 out->krw.data, out->kro.data, out->krg.data,
+                                                 out->pcow.data, out->pcgo.data);
+        }
+        else
+            saturationFunctions_<double>(*model, firstCell, numCells, Sw, Sg, *out);
+    }
+    catch (const std::exception& e) {
+        return fail_(OPM_STATUS_ERROR, e.what());
+    }
+    catch (...) {
+        return fail_(OPM_STATUS_ERROR, "Unknown error while evaluating the saturation functions");
+    }
+
+    return OPM_STATUS_SUCCESS;
+}
+
+} // extern "C"
+#endif // HAVE_OPM_PARSER
@@ -0,0 +1,245 @@
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief A C interface for the batched evaluation of the black-oil PVT relations and
+ *        of the ECL saturation functions.
+ *
+ * This interface is intended for programs which cannot use the C++ classes directly,
+ * e.g., Python code via ctypes or cffi and Fortran code via ISO_C_BINDING. It is part
+ * of the opm-material library if the OPM_MATERIAL_C_API option of the build system is
+ * enabled, which requires opm-parser.
+ *
+ * A model consists of a black-oil fluid system (cf. Opm::FluidSystems::BlackOilInstance)
+ * and an ECL material law manager (cf. Opm::EclMaterialLawManager) for the active
+ * cells of a deck. All functions which evaluate quantities process a contiguous range
+ * of cells per call. The arrays are owned by the caller and are accessed in place
+ * through strided views, so NumPy arrays and sections of Fortran arrays can be passed
+ * without converting them first:
+ *
+ * \code
+ * double krw[numCells], kro[numCells], krg[numCells];
+ * OpmSaturationFunctionArrays out;
+ * memset(&out, 0, sizeof(out));
+ * out.krw.data = krw; out.krw.stride = 1;
+ * out.kro.data = kro; out.kro.stride = 1;
+ * out.krg.data = krg; out.krg.stride = 1;
+ * opm_black_oil_saturation_functions(model, 0, numCells, Sw, Sg, &out);
+ * \endcode
+ *
+ * The functions which evaluate quantities do not modify the model, so they can be
+ * called concurrently by multiple threads, e.g., for disjoint ranges of cells.
+ */
+#ifndef OPM_MATERIAL_BLACK_OIL_C_API_H
+#define OPM_MATERIAL_BLACK_OIL_C_API_H
+
+#include <stddef.h>
+
+#if defined(__GNUC__)
+#define OPM_MATERIAL_C_EXPORT __attribute__((visibility("default")))
+#else
+#define OPM_MATERIAL_C_EXPORT
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \brief The return values of the functions of the C interface.
+ *
+ * If a function does not succeed, opm_black_oil_last_error() returns a description
+ * of the problem.
+ */
+enum OpmStatus {
+    OPM_STATUS_SUCCESS = 0,
+    OPM_STATUS_INVALID_ARGUMENT = 1,
+    OPM_STATUS_ERROR = 2
+};
+
+/*!
+ * \brief The phase indices of the C interface.
+ */
+enum OpmBlackOilPhase {
+    OPM_WATER_PHASE = 0,
+    OPM_OIL_PHASE = 1,
+    OPM_GAS_PHASE = 2
+};
+
+/*!
+ * \brief A read-only view of a caller-owned array.
+ *
+ * The value of the i-th cell of a range is data[i*stride], i.e., the stride is given
+ * in units of doubles, not in bytes. A stride of zero uses the same value for all
+ * cells.
+ */
+typedef struct OpmConstDoubleArray {
+    const double* data;
+    ptrdiff_t stride;
+} OpmConstDoubleArray;
+
+/*!
+ * \brief A view of a caller-owned array which receives results.
+ *
+ * The result for the i-th cell of a range is written to data[i*stride]. If data is
+ * NULL, the quantity is not written. The stride must not be zero.
+ */
+typedef struct OpmDoubleArray {
+    double* data;
+    ptrdiff_t stride;
+} OpmDoubleArray;
+
+/*!
+ * \brief The arrays which receive the PVT properties of a phase.
+ *
+ * The derivatives are the partial derivatives with regard to the pressure and to the
+ * dissolution factor which is passed to opm_black_oil_phase_properties(), i.e., the
+ * gas dissolution factor Rs for oil and the oil vaporization factor Rv for gas. Only
+ * the members whose data pointer is not NULL are written, so objects of this type
+ * should be zero-initialized.
+ */
+typedef struct OpmPhasePropertiesArrays {
+    OpmDoubleArray invB;
+    OpmDoubleArray mu;
+    OpmDoubleArray density;
+
+    OpmDoubleArray dInvB_dp;
+    OpmDoubleArray dMu_dp;
+    OpmDoubleArray dDensity_dp;
+
+    OpmDoubleArray dInvB_dR;
+    OpmDoubleArray dMu_dR;
+    OpmDoubleArray dDensity_dR;
+} OpmPhasePropertiesArrays;
+
+/*!
+ * \brief The arrays which receive the saturation functions.
+ *
+ * The capillary pressures are the differences pcow = po - pw and pcgo = pg - po. The
+ * derivatives are the partial derivatives with regard to the water and the gas
+ * saturations, the oil saturation being 1 - Sw - Sg. Only the members whose data
+ * pointer is not NULL are written, so objects of this type should be
+ * zero-initialized.
+ */
+typedef struct OpmSaturationFunctionArrays {
+    OpmDoubleArray krw;
+    OpmDoubleArray kro;
+    OpmDoubleArray krg;
+    OpmDoubleArray pcow;
+    OpmDoubleArray pcgo;
+
+    OpmDoubleArray dkrw_dSw;
+    OpmDoubleArray dkrw_dSg;
+    OpmDoubleArray dkro_dSw;
+    OpmDoubleArray dkro_dSg;
+    OpmDoubleArray dkrg_dSw;
+    OpmDoubleArray dkrg_dSg;
+    OpmDoubleArray dpcow_dSw;
+    OpmDoubleArray dpcow_dSg;
+    OpmDoubleArray dpcgo_dSw;
+    OpmDoubleArray dpcgo_dSg;
+} OpmSaturationFunctionArrays;
+
+/*!
+ * \brief The opaque type of a model.
+ */
+typedef struct OpmBlackOilModel OpmBlackOilModel;
+
+/*!
+ * \brief Create a model for the active cells of an ECL deck.
+ *
+ * The cells are numbered like the active cells of the grid. The PVT region of each
+ * cell is given by the PVTNUM keyword.
+ *
+ * \return The new model or NULL if the deck could not be read.
+ */
+OPM_MATERIAL_C_EXPORT
+OpmBlackOilModel* opm_black_oil_create_from_deck(const char* deckFileName);
+
+/*!
+ * \brief Release a model which was created by opm_black_oil_create_from_deck(). NULL
+ *        is ignored.
+ */
+OPM_MATERIAL_C_EXPORT
+void opm_black_oil_destroy(OpmBlackOilModel* model);
+
+/*!
+ * \brief Returns a description of the problem which was encountered by the last
+ *        unsuccessful call of the calling thread.
+ */
+OPM_MATERIAL_C_EXPORT
+const char* opm_black_oil_last_error(void);
+
+/*!
+ * \brief Returns the number of cells of a model.
+ */
+OPM_MATERIAL_C_EXPORT
+size_t opm_black_oil_num_cells(const OpmBlackOilModel* model);
+
+/*!
+ * \brief Evaluate the PVT relations of a phase for the cells [firstCell, firstCell +
+ *        numCells).
+ *
+ * \param phase One of the OpmBlackOilPhase values
+ * \param temperature The temperatures [K]
+ * \param pressure The pressures of the phase [Pa]
+ * \param dissolution The gas dissolution factors Rs for oil and the oil vaporization
+ *                    factors Rv for gas. This is ignored for water.
+ * \param out The arrays which receive the results
+ *
+ * \return One of the OpmStatus values
+ */
+OPM_MATERIAL_C_EXPORT
+int opm_black_oil_phase_properties(const OpmBlackOilModel* model,
+                                   int phase,
+                                   size_t firstCell,
+                                   size_t numCells,
+                                   OpmConstDoubleArray temperature,
+                                   OpmConstDoubleArray pressure,
+                                   OpmConstDoubleArray dissolution,
+                                   const OpmPhasePropertiesArrays* out);
+
+/*!
+ * \brief Evaluate the saturation functions for the cells [firstCell, firstCell +
+ *        numCells).
+ *
+ * If no derivatives are requested, the arrays are contiguous and the range starts at
+ * the first cell of the model, the batched version of the material law manager is
+ * used.
+ *
+ * \param Sw The water saturations
+ * \param Sg The gas saturations
+ * \param out The arrays which receive the results
+ *
+ * \return One of the OpmStatus values
+ */
+OPM_MATERIAL_C_EXPORT
+int opm_black_oil_saturation_functions(const OpmBlackOilModel* model,
+                                       size_t firstCell,
+                                       size_t numCells,
+                                       OpmConstDoubleArray Sw,
+                                       OpmConstDoubleArray Sg,
+                                       const OpmSaturationFunctionArrays* out);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
@@ -0,0 +1,123 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::AsyncInitializer
+ */
+#ifndef OPM_ASYNC_INITIALIZER_HPP
+#define OPM_ASYNC_INITIALIZER_HPP
+
+#include <exception>
+#include <future>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Runs the initialization of tables in background threads.
+ *
+ * Generating the tables of, e.g., TabulatedComponent, PengRobinson or the PVT classes
+ * can take a considerable amount of time. Since the tables do not depend on each other,
+ * they can be generated while the main thread does something else, e.g., reads the
+ * deck or sets up the grid:
+ *
+ * \code
+ * Opm::AsyncInitializer initializer;
+ * initializer.add(H2O_Tabulated::initAsync(273.15, 623.15, 100, 1e4, 40e6, 200));
+ * initializer.launch([&]() { oilPvt.initEnd(); });
+ * // ... do something else ...
+ * initializer.wait(); // the tables can be used from here on
+ * \endcode
+ *
+ * The tables must not be accessed before wait() has returned, and two tasks must not
+ * initialize the same tables, e.g., BrineCO2FluidSystem::initAsync() and
+ * TabulatedComponent<Scalar, H2O>::initAsync().
+ */
+class AsyncInitializer
+{
+public:
+    AsyncInitializer()
+    {}
+
+    /*!
+     * \brief Waits until all tasks have finished.
+     *
+     * Exceptions of the tasks are ignored if wait() has not been called.
+     */
+    ~AsyncInitializer()
+    {
+        for (size_t taskIdx = 0; taskIdx < tasks_.size(); ++taskIdx)
+            if (tasks_[taskIdx].valid())
+                tasks_[taskIdx].wait();
+    }
+
+    /*!
+     * \brief Run a function object in a new thread.
+     */
+    template <class Fn>
+    void launch(Fn fn)
+    { tasks_.push_back(std::async(std::launch::async, fn)); }
+
+    /*!
+     * \brief Add a task which has already been started, e.g., by one of the
+     *        initAsync() methods.
+     */
+    void add(std::future<void>&& task)
+    { tasks_.push_back(std::move(task)); }
+
+    /*!
+     * \brief Returns the number of tasks which have been launched since wait() has
+     *        been called for the last time.
+     */
+    size_t numTasks() const
+    { return tasks_.size(); }
+
+    /*!
+     * \brief Wait until all tasks have finished.
+     *
+     * If a task threw an exception, the first one of them is re-thrown after all tasks
+     * have finished.
+     */
+    void wait()
+    {
+        std::exception_ptr exception;
+        for (size_t taskIdx = 0; taskIdx < tasks_.size(); ++taskIdx) {
+            try {
+                tasks_[taskIdx].get();
+            }
+            catch (...) {
+                if (!exception)
+                    exception = std::current_exception();
+            }
+        }
+        tasks_.clear();
+
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+
+private:
+    std::vector<std::future<void> > tasks_;
+};
+
+} // namespace Opm
+
+#endif
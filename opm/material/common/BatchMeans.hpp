@@ -0,0 +1,245 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Computes the averages of Means.hpp for arrays of value pairs.
+ *
+ * The flux terms of a discretization need to average quantities like permeabilities,
+ * mobilities or heat conductivities of the two degrees of freedom adjacent to each
+ * face. The functions of this file do this for whole arrays of faces: The first and
+ * the second values of the faces are passed as separate arrays, i.e., in structure of
+ * arrays layout.
+ *
+ * For plain scalars, the loops do not contain branches (the zero-guards of the
+ * geometric and the harmonic means are expressed as masks), so the compiler can
+ * vectorize them. Note that this requires -fno-math-errno for the square root of the
+ * geometric mean. For arrays of LocalAd::Evaluation objects, the values and the
+ * partial derivatives of the means w.r.t. both arguments are first computed by the same
+ * kernels for a block of faces. The derivatives are then propagated using the SIMD
+ * kernels of LocalAd::DerivativeKernels. If the zero-guard applies to a face, the
+ * result is zero and so are all of its derivatives.
+ *
+ * The results are identical to calling the respective function of Means.hpp for each
+ * face, up to rounding. The result array may be identical to either of the input
+ * arrays.
+ */
+#ifndef OPM_BATCH_MEANS_HPP
+#define OPM_BATCH_MEANS_HPP
+
+#include <opm/material/common/Means.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace Opm {
+namespace BatchMeansDetail {
+// the kernels for a single face. they compute the mean of x and y as well as its
+// partial derivatives w.r.t. x and y.
+struct ArithmeticMean
+{
+    static const bool vectorizable = true;
+
+    template <class Scalar>
+    static Scalar value(Scalar x, Scalar y)
+    { return (x + y)/2; }
+
+    template <class Scalar>
+    static Scalar valueAndDerivatives(Scalar x, Scalar y, Scalar& dx, Scalar& dy)
+    {
+        dx = 0.5;
+        dy = 0.5;
+        return (x + y)/2;
+    }
+};
+
+// the zero-guards are expressed by multiplying with a factor which is exactly 1 or
+// 0. unlike a conditional expression, this does not prevent the compiler from
+// vectorizing the loops if the division might trap. the denominators of the masked
+// out faces are set to 1, which avoids producing NaNs.
+struct GeometricMean
+{
+    // std::sqrt() is not vectorized unless errno does not need to be set
+    static const bool vectorizable = false;
+
+    template <class Scalar>
+    static Scalar value(Scalar x, Scalar y)
+    {
+        Scalar mask = static_cast<Scalar>(x*y > 0);
+        return mask*std::sqrt(x*x + y*y);
+    }
+
+    template <class Scalar>
+    static Scalar valueAndDerivatives(Scalar x, Scalar y, Scalar& dx, Scalar& dy)
+    {
+        Scalar mask = static_cast<Scalar>(x*y > 0);
+        Scalar r = std::sqrt(x*x + y*y);
+        Scalar rInv = mask/(mask*r + (1 - mask));
+        dx = x*rInv;
+        dy = y*rInv;
+        return mask*r;
+    }
+};
+
+struct HarmonicMean
+{
+    static const bool vectorizable = true;
+
+    template <class Scalar>
+    static Scalar value(Scalar x, Scalar y)
+    {
+        Scalar mask = static_cast<Scalar>(x*y > 0);
+        return mask*2*x*y/(mask*(x + y) + (1 - mask));
+    }
+
+    template <class Scalar>
+    static Scalar valueAndDerivatives(Scalar x, Scalar y, Scalar& dx, Scalar& dy)
+    {
+        // d/dx (2xy/(x + y)) = 2y^2/(x + y)^2 and vice versa
+        Scalar mask = static_cast<Scalar>(x*y > 0);
+        Scalar sumInv = mask/(mask*(x + y) + (1 - mask));
+        Scalar tmp = 2*sumInv*sumInv;
+        dx = tmp*y*y;
+        dy = tmp*x*x;
+        return 2*x*y*sumInv;
+    }
+};
+
+// the number of faces for which the values and the partial derivatives are computed
+// before the derivatives are propagated
+static const size_t blockSize = 64;
+
+template <class Mean, class Scalar>
+void apply(const Scalar* x, const Scalar* y, Scalar* result, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        result[i] = Mean::value(x[i], y[i]);
+}
+
+// computes the means for blocks of faces: the values and the partial derivatives of a
+// block are computed by a vectorizable loop before the derivatives are propagated
+template <class Mean, class Scalar, class VarSetTag, int numVars, class DerivativeScalar>
+void applyBlocked(const LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivativeScalar>* x,
+                  const LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivativeScalar>* y,
+                  LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivativeScalar>* result,
+                  size_t n)
+{
+    typedef LocalAd::DerivativeKernels<DerivativeScalar, numVars> Kernels;
+
+    // the values are copied to contiguous arrays, so that the loop which computes the
+    // means and their partial derivatives can be vectorized
+    Scalar xValue[blockSize];
+    Scalar yValue[blockSize];
+    Scalar value[blockSize];
+    Scalar dx[blockSize];
+    Scalar dy[blockSize];
+    for (size_t blockBegin = 0; blockBegin < n; blockBegin += blockSize) {
+        size_t m = std::min(blockSize, n - blockBegin);
+        const auto* xBlock = x + blockBegin;
+        const auto* yBlock = y + blockBegin;
+        auto* resultBlock = result + blockBegin;
+
+        for (size_t i = 0; i < m; ++i) {
+            xValue[i] = xBlock[i].value;
+            yValue[i] = yBlock[i].value;
+        }
+
+        for (size_t i = 0; i < m; ++i)
+            value[i] = Mean::valueAndDerivatives(xValue[i], yValue[i], dx[i], dy[i]);
+
+        for (size_t i = 0; i < m; ++i) {
+            resultBlock[i].value = value[i];
+            Kernels::linearCombination(resultBlock[i].derivatives.data(),
+                                       static_cast<DerivativeScalar>(dx[i]),
+                                       xBlock[i].derivatives.data(),
+                                       static_cast<DerivativeScalar>(dy[i]),
+                                       yBlock[i].derivatives.data());
+        }
+    }
+}
+
+// computes the means if the kernel cannot be vectorized: in this case, the extra
+// passes over the faces which are required by applyBlocked() do not pay off.
+template <class Mean, class Scalar, class VarSetTag, int numVars, class DerivativeScalar>
+void applyFused(const LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivativeScalar>* x,
+                const LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivativeScalar>* y,
+                LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivativeScalar>* result,
+                size_t n)
+{
+    typedef LocalAd::DerivativeKernels<DerivativeScalar, numVars> Kernels;
+
+    for (size_t i = 0; i < n; ++i) {
+        Scalar dx, dy;
+        Scalar value = Mean::valueAndDerivatives(x[i].value, y[i].value, dx, dy);
+        Kernels::linearCombination(result[i].derivatives.data(),
+                                   static_cast<DerivativeScalar>(dx),
+                                   x[i].derivatives.data(),
+                                   static_cast<DerivativeScalar>(dy),
+                                   y[i].derivatives.data());
+        result[i].value = value;
+    }
+}
+
+template <class Mean, class Scalar, class VarSetTag, int numVars, class DerivativeScalar>
+void apply(const LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivativeScalar>* x,
+           const LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivativeScalar>* y,
+           LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivativeScalar>* result,
+           size_t n)
+{
+    if (Mean::vectorizable)
+        applyBlocked<Mean>(x, y, result, n);
+    else
+        applyFused<Mean>(x, y, result, n);
+}
+} // namespace BatchMeansDetail
+
+/*!
+ * \brief Computes the arithmetic averages of n pairs of values.
+ *
+ * This is equivalent to result[i] = arithmeticMean(x[i], y[i]) for each i < n.
+ */
+template <class Evaluation>
+inline void arithmeticMeans(const Evaluation* x, const Evaluation* y, Evaluation* result, size_t n)
+{ BatchMeansDetail::apply<BatchMeansDetail::ArithmeticMean>(x, y, result, n); }
+
+/*!
+ * \brief Computes the geometric averages of n pairs of values.
+ *
+ * This is equivalent to result[i] = geometricMean(x[i], y[i]) for each i < n.
+ */
+template <class Evaluation>
+inline void geometricMeans(const Evaluation* x, const Evaluation* y, Evaluation* result, size_t n)
+{ BatchMeansDetail::apply<BatchMeansDetail::GeometricMean>(x, y, result, n); }
+
+/*!
+ * \brief Computes the harmonic averages of n pairs of values.
+ *
+ * This is equivalent to result[i] = harmonicMean(x[i], y[i]) for each i < n.
+ */
+template <class Evaluation>
+inline void harmonicMeans(const Evaluation* x, const Evaluation* y, Evaluation* result, size_t n)
+{ BatchMeansDetail::apply<BatchMeansDetail::HarmonicMean>(x, y, result, n); }
+
+} // namespace Opm
+
+#endif
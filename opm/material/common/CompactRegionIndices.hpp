@@ -0,0 +1,155 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::CompactRegionIndices
+ */
+#ifndef OPM_COMPACT_REGION_INDICES_HPP
+#define OPM_COMPACT_REGION_INDICES_HPP
+
+#include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/ErrorMacros.hpp>
+
+#include <cassert>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Determines which regions of a deck are used by the local cells and numbers
+ *        these regions consecutively.
+ *
+ * In parallel runs, each process usually only owns the cells of a few of the regions
+ * defined by keywords like SATNUM or PVTNUM. If the tables are only created for the
+ * regions which are actually used, the memory required by each process and the time
+ * to set them up do not grow with the total number of regions.
+ *
+ * The regions of the deck are numbered from 0 to numRegions() - 1, the used ones
+ * additionally from 0 to numUsedRegions() - 1 in ascending order. An object which stores
+ * the tables of numUsedRegions() regions, e.g. a PVT object, can then be set up by
+ * reading the table of regionIndex(compactIdx) for the compact index compactIdx, and
+ * the region indices of the cells can be converted using compact().
+ */
+class CompactRegionIndices
+{
+public:
+    CompactRegionIndices()
+    {}
+
+    /*!
+     * \brief Determine the used regions from the region index of each cell.
+     *
+     * The region indices must be in the range [0, numRegions).
+     */
+    void setRegionIndices(const std::vector<int>& cellRegionIdx, int numRegions)
+    {
+        compactIdx_.assign(numRegions, -1);
+        regionIdx_.clear();
+        addRegionIndices(cellRegionIdx);
+    }
+
+    /*!
+     * \brief Mark the regions of some additional cells as used.
+     *
+     * This is useful if the tables of a region are accessed via several keywords,
+     * e.g., SATNUM and IMBNUM. The compact indices of the regions may change.
+     */
+    void addRegionIndices(const std::vector<int>& cellRegionIdx)
+    {
+        int numRegions = this->numRegions();
+        for (size_t cellIdx = 0; cellIdx < cellRegionIdx.size(); ++cellIdx) {
+            int regionIdx = cellRegionIdx[cellIdx];
+            if (regionIdx < 0 || regionIdx >= numRegions)
+                OPM_THROW(std::runtime_error,
+                          "Invalid region index " << regionIdx << " for cell " << cellIdx);
+            compactIdx_[regionIdx] = 0;
+        }
+
+        // number the used regions in ascending order
+        regionIdx_.clear();
+        for (int regionIdx = 0; regionIdx < numRegions; ++regionIdx) {
+            if (compactIdx_[regionIdx] < 0)
+                continue;
+            compactIdx_[regionIdx] = static_cast<int>(regionIdx_.size());
+            regionIdx_.push_back(regionIdx);
+        }
+    }
+
+    /*!
+     * \brief Returns the total number of regions.
+     */
+    int numRegions() const
+    { return static_cast<int>(compactIdx_.size()); }
+
+    /*!
+     * \brief Returns the number of regions which are used by at least one cell.
+     */
+    int numUsedRegions() const
+    { return static_cast<int>(regionIdx_.size()); }
+
+    /*!
+     * \brief Returns true iff a region is used by at least one cell.
+     */
+    bool isUsed(int regionIdx) const
+    { return compactIndex(regionIdx) >= 0; }
+
+    /*!
+     * \brief Returns the compact index of a region or -1 if it is not used.
+     */
+    int compactIndex(int regionIdx) const
+    {
+        assert(0 <= regionIdx && regionIdx < numRegions());
+        return compactIdx_[regionIdx];
+    }
+
+    /*!
+     * \brief Returns the index of the region for a compact index.
+     */
+    int regionIndex(int compactIdx) const
+    {
+        assert(0 <= compactIdx && compactIdx < numUsedRegions());
+        return regionIdx_[compactIdx];
+    }
+
+    /*!
+     * \brief Convert the region indices of the cells to compact ones.
+     *
+     * All regions must be used.
+     */
+    void compact(std::vector<int>& cellRegionIdx) const
+    {
+        for (size_t cellIdx = 0; cellIdx < cellRegionIdx.size(); ++cellIdx) {
+            int regionIdx = cellRegionIdx[cellIdx];
+            int compactIdx = (0 <= regionIdx && regionIdx < numRegions()) ? compactIdx_[regionIdx] : -1;
+            if (compactIdx < 0)
+                OPM_THROW(std::runtime_error,
+                          "Region " << regionIdx << " of cell " << cellIdx
+                          << " is not used");
+            cellRegionIdx[cellIdx] = compactIdx;
+        }
+    }
+
+private:
+    std::vector<int> compactIdx_;
+    std::vector<int> regionIdx_;
+};
+} // namespace Opm
+
+#endif
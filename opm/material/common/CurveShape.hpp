@@ -0,0 +1,105 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::CurveShape
+ */
+#ifndef OPM_CURVE_SHAPE_HPP
+#define OPM_CURVE_SHAPE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+namespace Opm {
+/*!
+ * \brief The shapes of tabulated curves which can be evaluated in closed form.
+ *
+ * Many ECL decks contain tables which do not need to be interpolated at all, e.g.,
+ * capillary pressure columns which are zero everywhere, viscosities which do not depend
+ * on pressure or straight relative permeability lines. The tabulated functions classify
+ * their sampling points once when they are set (cf. classifyCurve()) and evaluate such
+ * curves without searching for a segment.
+ */
+enum CurveShape {
+    //! The sampling points do not exhibit any special structure
+    GeneralCurve,
+
+    //! All sampling points are located on a single straight line
+    LinearCurve,
+
+    //! All sampling points exhibit the same value
+    ConstantCurve,
+
+    //! All sampling points exhibit a value of zero
+    ZeroCurve
+};
+
+/*!
+ * \brief Classify the sampling points of a piecewise linear curve.
+ *
+ * A curve is only considered to be constant or zero if all values are exactly equal. It
+ * is considered to be linear if the abscissas are strictly ascending and no value
+ * deviates from the straight line through the first and the last sampling point by more
+ * than 1e-10 times the largest magnitude of the values.
+ *
+ * \param xValues The abscissas of the sampling points
+ * \param yValues The values of the sampling points
+ */
+template <class XContainer, class YContainer>
+CurveShape classifyCurve(const XContainer& xValues, const YContainer& yValues)
+{
+    typedef typename std::decay<decltype(yValues[0])>::type Scalar;
+
+    size_t n = yValues.size();
+    if (n == 0 || xValues.size() != n)
+        return GeneralCurve;
+
+    if (std::all_of(yValues.begin(), yValues.end(),
+                    [&yValues](const Scalar& y) { return y == yValues[0]; }))
+        return (yValues[0] == 0) ? ZeroCurve : ConstantCurve;
+
+    if (n < 2 || !(xValues[0] < xValues[n - 1]))
+        return GeneralCurve;
+
+    Scalar yMagnitude = 0.0;
+    for (size_t i = 0; i < n; ++i)
+        yMagnitude = std::max<Scalar>(yMagnitude, std::abs(yValues[i]));
+
+    Scalar x0 = xValues[0];
+    Scalar y0 = yValues[0];
+    Scalar m = (yValues[n - 1] - y0)/(xValues[n - 1] - x0);
+    for (size_t i = 1; i < n; ++i) {
+        if (!(xValues[i - 1] < xValues[i]))
+            return GeneralCurve;
+
+        Scalar delta = yValues[i] - (y0 + m*(xValues[i] - x0));
+        if (!(std::abs(delta) <= 1e-10*yMagnitude))
+            return GeneralCurve;
+    }
+
+    return LinearCurve;
+}
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,77 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief The evaluation types for which the opm-material library provides explicit
+ *        template instantiations.
+ *
+ * If the build system option OPM_MATERIAL_EXPLICIT_INSTANTIATIONS is enabled, the
+ * library contains the black-oil fluid system, the black-oil PVT classes and the ECL
+ * material law manager for Scalar=double and for the evaluation types defined in this
+ * file, and the OPM_MATERIAL_EXTERN_TEMPLATES macro of config.h is set to 1. The
+ * headers of these classes then declare the instantiations as 'extern template', so
+ * that the translation units which use them do not need to instantiate the
+ * non-template methods, the vtables and the static data members themselves.
+ *
+ * This only has an effect for code which uses exactly these types, i.e., the
+ * evaluations need to be defined using the tag of this file:
+ *
+ * \code
+ * typedef Opm::ExplicitInstantiations::Evaluation3 Evaluation;
+ * typedef Opm::FluidSystems::BlackOil<double, Evaluation> FluidSystem;
+ * \endcode
+ *
+ * Member templates, e.g., the methods which take a fluid state, are still
+ * instantiated by each translation unit which calls them.
+ */
+#ifndef OPM_EXPLICIT_INSTANTIATIONS_HPP
+#define OPM_EXPLICIT_INSTANTIATIONS_HPP
+
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+
+namespace Opm {
+namespace ExplicitInstantiations {
+//! The tag of the variable set of the explicitly instantiated evaluations
+class EvaluationTag;
+
+typedef Opm::LocalAd::Evaluation<double, EvaluationTag, 1> Evaluation1;
+typedef Opm::LocalAd::Evaluation<double, EvaluationTag, 2> Evaluation2;
+typedef Opm::LocalAd::Evaluation<double, EvaluationTag, 3> Evaluation3;
+typedef Opm::LocalAd::Evaluation<double, EvaluationTag, 4> Evaluation4;
+}} // namespace Opm, ExplicitInstantiations
+
+/*!
+ * \brief Expand MACRO(KEYWORD, Evaluation) for all explicitly instantiated evaluation
+ *        types.
+ *
+ * KEYWORD is 'template' for the explicit instantiation definitions of the library and
+ * 'extern template' for the declarations in the headers.
+ */
+#define OPM_MATERIAL_FOR_EACH_EVALUATION(MACRO, KEYWORD)                \
+    MACRO(KEYWORD, double)                                              \
+    MACRO(KEYWORD, ::Opm::ExplicitInstantiations::Evaluation1)          \
+    MACRO(KEYWORD, ::Opm::ExplicitInstantiations::Evaluation2)          \
+    MACRO(KEYWORD, ::Opm::ExplicitInstantiations::Evaluation3)          \
+    MACRO(KEYWORD, ::Opm::ExplicitInstantiations::Evaluation4)
+
+#endif
@@ -0,0 +1,160 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::FlatTableBroadcast
+ */
+#ifndef OPM_FLAT_TABLE_BROADCAST_HPP
+#define OPM_FLAT_TABLE_BROADCAST_HPP
+
+#include <opm/material/common/FlatTables.hpp>
+
+#if HAVE_MPI
+#include <mpi.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Distributes flat tables which were built by a single process to all processes
+ *        of an MPI communicator.
+ *
+ * Instead of letting each process read the deck and build the tables itself, one
+ * process, the root, adds them to a FlatTableBuffer and broadcast() sends the buffer and
+ * the handles of its tables to all others. Since the handles refer to the tables by
+ * offsets, the other processes evaluate the tables directly in the received buffer,
+ * i.e., nothing needs to be rebuilt after the transfer.
+ *
+ * \code
+ * Opm::FlatTableBuffer<Scalar> buffer;
+ * Handles handles;
+ * if (rank == 0) {
+ *     handles.oil = oilPvt.flatRegion(0, buffer);
+ *     handles.gas = gasPvt.flatRegion(0, buffer);
+ * }
+ * Opm::FlatTableBroadcast<Scalar> tables;
+ * tables.broadcast(buffer, handles, MPI_COMM_WORLD);
+ * auto view = tables.view();
+ * \endcode
+ *
+ * \tparam Scalar The type used for scalar values
+ */
+template <class Scalar>
+class FlatTableBroadcast
+{
+public:
+    FlatTableBroadcast()
+        : data_(0)
+        , size_(0)
+    {}
+
+    /*!
+     * \brief Send the tables of the root process to all processes of a communicator.
+     *
+     * This must be called by all processes of the communicator. On the root process,
+     * the buffer contains the tables and the handles refer to them; the view of this
+     * object then refers to the buffer, so it must not be modified or destroyed as long
+     * as the view is used. On all other processes, the buffer is not accessed and the
+     * handles are overwritten by the ones of the root process.
+     *
+     * \param buffer The tables
+     * \param handles An object which contains the handles of the tables, e.g., a
+     *                structure of FlatTable1D objects. It must be a POD type.
+     * \param comm The MPI communicator
+     * \param rootRank The rank of the process which built the tables
+     */
+    template <class Handles>
+    void broadcast(const FlatTableBuffer<Scalar>& buffer,
+                   Handles& handles,
+                   MPI_Comm comm,
+                   int rootRank = 0)
+    {
+        static_assert(std::is_pod<Handles>::value,
+                      "The handles of flat tables can only be broadcast if they are POD");
+
+        int rank;
+        MPI_Comm_rank(comm, &rank);
+
+        // size of the tables, size of the handles, size of a scalar. the last two
+        // only guard against processes which were compiled differently.
+        unsigned long long header[3] = { buffer.size(), sizeof(Handles), sizeof(Scalar) };
+        MPI_Bcast(header, 3, MPI_UNSIGNED_LONG_LONG, rootRank, comm);
+        int typesMatch = (header[1] == sizeof(Handles) && header[2] == sizeof(Scalar));
+        MPI_Allreduce(MPI_IN_PLACE, &typesMatch, 1, MPI_INT, MPI_LAND, comm);
+        if (!typesMatch)
+            OPM_THROW(std::runtime_error,
+                      "The flat tables of the root process use different types");
+
+        MPI_Bcast(&handles, static_cast<int>(sizeof(Handles)), MPI_BYTE, rootRank, comm);
+
+        size_ = static_cast<size_t>(header[0]);
+        if (rank == rootRank)
+            data_ = buffer.data();
+        else {
+            storage_.resize((size_ + sizeof(StorageUnit) - 1)/sizeof(StorageUnit));
+            data_ = storage_.data();
+        }
+
+        // the tables may be larger than what a single message can hold
+        unsigned char* bytes = static_cast<unsigned char*>(const_cast<void*>(data_));
+        for (size_t offset = 0; offset < size_; offset += INT_MAX) {
+            int n = static_cast<int>(std::min<size_t>(size_ - offset, INT_MAX));
+            MPI_Bcast(bytes + offset, n, MPI_BYTE, rootRank, comm);
+        }
+    }
+
+    /*!
+     * \brief Returns a view on the received tables.
+     */
+    FlatTableView<Scalar> view() const
+    { return FlatTableView<Scalar>(data_); }
+
+    /*!
+     * \brief Returns the address of the tables.
+     */
+    const void* data() const
+    { return data_; }
+
+    /*!
+     * \brief Returns the size of the tables [bytes].
+     */
+    size_t size() const
+    { return size_; }
+
+private:
+    // the same type as the one used by FlatTableBuffer, so the received tables are
+    // aligned in the same way
+    typedef typename std::conditional<(sizeof(Scalar) > sizeof(int)), Scalar, int>::type StorageUnit;
+
+    std::vector<StorageUnit> storage_;
+    const void* data_;
+    size_t size_;
+};
+
+} // namespace Opm
+
+#endif // HAVE_MPI
+
+#endif
@@ -0,0 +1,533 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::FlatTableBuffer
+ */
+#ifndef OPM_FLAT_TABLES_HPP
+#define OPM_FLAT_TABLES_HPP
+
+#include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/HostDevice.hpp>
+#include <opm/material/common/TableFile.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Refers to an array of scalars which is stored in a FlatTableBuffer.
+ */
+struct FlatArray
+{
+    //! The position of the first entry within the buffer [bytes]
+    size_t offset;
+
+    //! The number of entries
+    size_t size;
+};
+
+/*!
+ * \brief Refers to a piecewise linear function which is stored in a FlatTableBuffer.
+ *
+ * Like all handles of flat tables, this is a plain value type which does not contain
+ * any pointers, so it stays valid if the buffer is copied to a different address space,
+ * e.g., to the memory of an accelerator, or if the buffer is written to a file and
+ * mapped into memory later.
+ */
+struct FlatTable1D
+{
+    //! The position of the abscissa values within the buffer [bytes]. The ordinate
+    //! values are stored after them.
+    size_t offset;
+
+    //! The number of sampling points
+    int numSamples;
+};
+
+/*!
+ * \brief Refers to a copy of an Opm::UniformTabulated2DFunction which is stored in a
+ *        FlatTableBuffer.
+ */
+struct FlatUniformTable2D
+{
+    //! The position of the ranges (xMin, xMax, yMin, yMax) within the buffer
+    //! [bytes]. The values of the sampling points are stored after them.
+    size_t offset;
+
+    int numX;
+    int numY;
+};
+
+/*!
+ * \brief Refers to a copy of an Opm::UniformXTabulated2DFunction which is stored in a
+ *        FlatTableBuffer.
+ */
+struct FlatUniformXTable2D
+{
+    //! The position of the x coordinates of the columns within the buffer [bytes]
+    size_t xOffset;
+
+    //! The position of the numX + 1 indices of the first sampling point of each
+    //! column within the buffer [bytes]
+    size_t columnOffset;
+
+    //! The position of the y coordinates of the sampling points within the buffer
+    //! [bytes]. The values of the sampling points are stored after them.
+    size_t yOffset;
+
+    //! The total number of sampling points of all columns
+    int numSamples;
+
+    int numX;
+};
+
+/*!
+ * \brief Provides read-only access to the tables of a FlatTableBuffer.
+ *
+ * A view only consists of the address of the buffer. It can thus be created for the
+ * original buffer, for a copy of it in the memory of an accelerator or for a file
+ * which is mapped into memory, and it can be passed to kernels by value.
+ *
+ * The address of the buffer must be aligned to a multiple of the size of Scalar.
+ */
+template <class Scalar>
+class FlatTableView
+{
+public:
+    OPM_HOST_DEVICE explicit FlatTableView(const void* data = 0)
+        : data_(static_cast<const unsigned char*>(data))
+    {}
+
+    /*!
+     * \brief Returns the address of the buffer.
+     */
+    OPM_HOST_DEVICE const void* data() const
+    { return data_; }
+
+    /*!
+     * \brief Returns the entries of an array.
+     */
+    OPM_HOST_DEVICE const Scalar* array(const FlatArray& a) const
+    { return at_<Scalar>(a.offset); }
+
+    /*!
+     * \brief Evaluate a piecewise linear function and its derivative.
+     *
+     * \param table The function which ought to be evaluated
+     * \param x The position on the abscissa
+     * \param extrapolate If true, the function is extended beyond its range by straight
+     *                    lines, else the values at the ends of the range are kept
+     *                    constant.
+     * \param dydx Receives the derivative of the function at x
+     */
+    OPM_HOST_DEVICE Scalar eval(const FlatTable1D& table, Scalar x, bool extrapolate, Scalar& dydx) const
+    {
+        const Scalar* xValues = at_<Scalar>(table.offset);
+        const Scalar* yValues = xValues + table.numSamples;
+        int lastIdx = table.numSamples - 1;
+
+        if (!extrapolate) {
+            if (x <= xValues[0]) {
+                dydx = 0.0;
+                return yValues[0];
+            }
+            if (x >= xValues[lastIdx]) {
+                dydx = 0.0;
+                return yValues[lastIdx];
+            }
+        }
+
+        // positions beyond the range use the outermost segments
+        int segIdx = findSegment_(xValues, table.numSamples, x);
+        Scalar x0 = xValues[segIdx];
+        Scalar y0 = yValues[segIdx];
+        dydx = (yValues[segIdx + 1] - y0)/(xValues[segIdx + 1] - x0);
+        return y0 + dydx*(x - x0);
+    }
+
+    /*!
+     * \brief Evaluate a piecewise linear function.
+     *
+     * \copydetails eval(const FlatTable1D&, Scalar, bool, Scalar&) const
+     */
+    OPM_HOST_DEVICE Scalar eval(const FlatTable1D& table, Scalar x, bool extrapolate) const
+    {
+        Scalar dydx;
+        return eval(table, x, extrapolate, dydx);
+    }
+
+    /*!
+     * \brief Evaluate a copy of a UniformTabulated2DFunction.
+     *
+     * The result is the same as the one of UniformTabulated2DFunction::eval(), except
+     * that positions outside of the tabulated range are never an error.
+     */
+    OPM_HOST_DEVICE Scalar eval(const FlatUniformTable2D& table, Scalar x, Scalar y) const
+    {
+        const Scalar* range = at_<Scalar>(table.offset);
+        const Scalar* samples = range + 4;
+
+        Scalar alpha = (x - range[0])/(range[1] - range[0])*(table.numX - 1);
+        Scalar beta = (y - range[2])/(range[3] - range[2])*(table.numY - 1);
+
+        int i = clamp_(static_cast<int>(alpha), 0, table.numX - 2);
+        int j = clamp_(static_cast<int>(beta), 0, table.numY - 2);
+        alpha -= i;
+        beta -= j;
+
+        const Scalar* row1 = samples + j*table.numX;
+        const Scalar* row2 = row1 + table.numX;
+        Scalar s1 = row1[i]*(1 - alpha) + row1[i + 1]*alpha;
+        Scalar s2 = row2[i]*(1 - alpha) + row2[i + 1]*alpha;
+        return s1*(1 - beta) + s2*beta;
+    }
+
+    /*!
+     * \brief Evaluate a copy of a UniformXTabulated2DFunction.
+     *
+     * The result is the same as the one of UniformXTabulated2DFunction::eval() with
+     * extrapolation enabled.
+     */
+    OPM_HOST_DEVICE Scalar eval(const FlatUniformXTable2D& table, Scalar x, Scalar y) const
+    {
+        const Scalar* xPos = at_<Scalar>(table.xOffset);
+        const int* columns = at_<int>(table.columnOffset);
+        const Scalar* yPos = at_<Scalar>(table.yOffset);
+        const Scalar* values = yPos + table.numSamples;
+
+        int i = findSegment_(xPos, table.numX, x);
+        Scalar alpha = (x - xPos[i])/(xPos[i + 1] - xPos[i]);
+
+        Scalar s1 = evalColumn_(yPos + columns[i], values + columns[i],
+                                columns[i + 1] - columns[i], y);
+        Scalar s2 = evalColumn_(yPos + columns[i + 1], values + columns[i + 1],
+                                columns[i + 2] - columns[i + 1], y);
+        return s1*(1 - alpha) + s2*alpha;
+    }
+
+private:
+    template <class T>
+    OPM_HOST_DEVICE const T* at_(size_t offset) const
+    { return reinterpret_cast<const T*>(data_ + offset); }
+
+    OPM_HOST_DEVICE static int clamp_(int value, int lowerIdx, int upperIdx)
+    { return value < lowerIdx ? lowerIdx : (value > upperIdx ? upperIdx : value); }
+
+    // returns the index of the segment which contains x. positions outside of the
+    // range are assigned to the outermost segments.
+    OPM_HOST_DEVICE static int findSegment_(const Scalar* xValues, int numSamples, Scalar x)
+    {
+        int lowerIdx = 0;
+        int upperIdx = numSamples - 1;
+        while (lowerIdx + 1 < upperIdx) {
+            int pivotIdx = (lowerIdx + upperIdx)/2;
+            if (x < xValues[pivotIdx])
+                upperIdx = pivotIdx;
+            else
+                lowerIdx = pivotIdx;
+        }
+        return lowerIdx;
+    }
+
+    OPM_HOST_DEVICE static Scalar evalColumn_(const Scalar* yPos, const Scalar* values, int n, Scalar y)
+    {
+        int j = findSegment_(yPos, n, y);
+        Scalar beta = (y - yPos[j])/(yPos[j + 1] - yPos[j]);
+        return values[j]*(1 - beta) + values[j + 1]*beta;
+    }
+
+    const unsigned char* data_;
+};
+
+/*!
+ * \brief Stores copies of tabulated functions in a single contiguous, relocatable
+ *        buffer.
+ *
+ * The tables are added on the host. The handles which are returned for them refer to
+ * the tables by byte offsets into the buffer instead of pointers, so the buffer can be
+ * copied verbatim to any other memory (e.g., using cudaMemcpy()), written to a file
+ * using save() and later be mapped into memory using FlatTableSnapshot. In all cases,
+ * the tables are evaluated in-place using a FlatTableView.
+ *
+ * The following table classes are supported: Tabulated1DFunction, the curves of
+ * PiecewiseLinearTwoPhaseMaterialParams, UniformTabulated2DFunction,
+ * UniformXTabulated2DFunction and plain arrays, e.g., the ones of TabulatedComponent.
+ *
+ * \tparam Scalar The type used for scalar values
+ */
+template <class Scalar>
+class FlatTableBuffer
+{
+public:
+    FlatTableBuffer()
+        : size_(0)
+    {}
+
+    /*!
+     * \brief Add a plain array of scalars.
+     */
+    template <class T>
+    FlatArray addArray(const T* values, size_t n)
+    {
+        FlatArray result;
+        result.offset = append_<Scalar>(values, n);
+        result.size = n;
+        return result;
+    }
+
+    /*!
+     * \brief Add a piecewise linear function which is given by the abscissas and
+     *        ordinates of its sampling points.
+     *
+     * The abscissas must be strictly ascending.
+     */
+    template <class XContainer, class YContainer>
+    FlatTable1D addTable(const XContainer& x, const YContainer& y)
+    {
+        if (x.size() != y.size() || x.size() < 2)
+            OPM_THROW(std::invalid_argument,
+                      "A flat table requires at least two sampling points");
+        for (size_t i = 1; i < x.size(); ++i)
+            if (!(x[i - 1] < x[i]))
+                OPM_THROW(std::invalid_argument,
+                          "The abscissas of a flat table must be strictly ascending");
+
+        FlatTable1D table;
+        table.numSamples = static_cast<int>(x.size());
+        table.offset = append_<Scalar>(x.data(), x.size());
+        append_<Scalar>(y.data(), y.size());
+        return table;
+    }
+
+    /*!
+     * \brief Add a copy of a tabulated function.
+     *
+     * The function object must provide the numSamples(), xAt() and valueAt() methods,
+     * e.g., Opm::Tabulated1DFunction.
+     */
+    template <class TabulatedFunction>
+    FlatTable1D addFunction(const TabulatedFunction& fn)
+    {
+        std::vector<Scalar> x(fn.numSamples());
+        std::vector<Scalar> y(fn.numSamples());
+        for (int i = 0; i < fn.numSamples(); ++i) {
+            x[i] = fn.xAt(i);
+            y[i] = fn.valueAt(i);
+        }
+        return addTable(x, y);
+    }
+
+    /*!
+     * \brief Add a copy of an Opm::UniformTabulated2DFunction.
+     */
+    template <class UniformTable>
+    FlatUniformTable2D addUniformTable2D(const UniformTable& fn)
+    {
+        FlatUniformTable2D table;
+        table.numX = fn.numX();
+        table.numY = fn.numY();
+
+        std::vector<Scalar> values;
+        values.reserve(4 + table.numX*table.numY);
+        values.push_back(fn.xMin());
+        values.push_back(fn.xMax());
+        values.push_back(fn.yMin());
+        values.push_back(fn.yMax());
+        for (int j = 0; j < table.numY; ++j)
+            for (int i = 0; i < table.numX; ++i)
+                values.push_back(fn.getSamplePoint(i, j));
+
+        table.offset = append_<Scalar>(values.data(), values.size());
+        return table;
+    }
+
+    /*!
+     * \brief Add a copy of a finalized Opm::UniformXTabulated2DFunction.
+     */
+    template <class UniformXTable>
+    FlatUniformXTable2D addUniformXTable2D(const UniformXTable& fn)
+    {
+        FlatUniformXTable2D table;
+        table.numX = fn.numX();
+
+        std::vector<Scalar> xPos(table.numX);
+        std::vector<int> columns(table.numX + 1);
+        std::vector<Scalar> yValues;
+        std::vector<Scalar> values;
+        for (int i = 0; i < table.numX; ++i) {
+            xPos[i] = fn.xAt(i);
+            columns[i] = static_cast<int>(yValues.size());
+            for (int j = 0; j < fn.numY(i); ++j) {
+                yValues.push_back(fn.yAt(i, j));
+                values.push_back(fn.valueAt(i, j));
+            }
+        }
+        columns[table.numX] = static_cast<int>(yValues.size());
+        table.numSamples = columns[table.numX];
+
+        table.xOffset = append_<Scalar>(xPos.data(), xPos.size());
+        table.columnOffset = append_<int>(columns.data(), columns.size());
+        table.yOffset = append_<Scalar>(yValues.data(), yValues.size());
+        append_<Scalar>(values.data(), values.size());
+        return table;
+    }
+
+    /*!
+     * \brief Returns a view on the tables of the buffer.
+     *
+     * The view becomes invalid if tables are added to the buffer.
+     */
+    FlatTableView<Scalar> view() const
+    { return FlatTableView<Scalar>(data()); }
+
+    /*!
+     * \brief Returns the address of the buffer.
+     */
+    const void* data() const
+    { return storage_.data(); }
+
+    /*!
+     * \brief Returns the size of the buffer [bytes].
+     */
+    size_t size() const
+    { return size_; }
+
+    /*!
+     * \brief Write the buffer and the handles of its tables to a file.
+     *
+     * \param fileName The name of the file
+     * \param key The string which identifies the contents of the file
+     * \param handles An object which contains the handles of the tables, e.g., a
+     *                structure of FlatTable1D objects. It must be a POD type.
+     */
+    template <class Handles>
+    void save(const std::string& fileName, const std::string& key, const Handles& handles) const
+    {
+        static_assert(std::is_pod<Handles>::value,
+                      "The handles of flat tables can only be saved if they are POD");
+
+        std::vector<const void*> arrays = { data(), &handles };
+        std::vector<size_t> sizes = { size(), sizeof(Handles) };
+        TableFile::write(fileName, key + " (flat tables, sizeof(Scalar)=" + std::to_string(sizeof(Scalar)) + ")",
+                         arrays, sizes);
+    }
+
+private:
+    // append an array to the buffer and return its offset. arrays are aligned to
+    // multiples of the alignment of their type.
+    template <class T, class U>
+    size_t append_(const U* values, size_t n)
+    {
+        size_t offset = (size_ + alignof(T) - 1)/alignof(T)*alignof(T);
+        size_ = offset + n*sizeof(T);
+
+        // the storage uses the largest of the stored types, so the buffer itself is
+        // aligned for all of them
+        storage_.resize((size_ + sizeof(StorageUnit) - 1)/sizeof(StorageUnit));
+        unsigned char* dest = reinterpret_cast<unsigned char*>(storage_.data()) + offset;
+        for (size_t i = 0; i < n; ++i) {
+            T value = static_cast<T>(values[i]);
+            std::memcpy(dest + i*sizeof(T), &value, sizeof(T));
+        }
+        return offset;
+    }
+
+    typedef typename std::conditional<(sizeof(Scalar) > sizeof(int)), Scalar, int>::type StorageUnit;
+
+    std::vector<StorageUnit> storage_;
+    size_t size_;
+};
+
+/*!
+ * \brief Provides access to flat tables which were written to a file by
+ *        FlatTableBuffer::save().
+ *
+ * On POSIX systems, the file is mapped into memory, i.e., the tables are evaluated
+ * directly on the pages of the file and all processes of a node share a single copy of
+ * them. (See Opm::TableFile.)
+ */
+template <class Scalar>
+class FlatTableSnapshot
+{
+public:
+    /*!
+     * \brief Open a file which was written by FlatTableBuffer::save().
+     *
+     * \return false if the file does not exist or if it was written using a different
+     *         key, scalar type or type of handles. In this case, the snapshot is invalid.
+     */
+    template <class Handles>
+    bool open(const std::string& fileName, const std::string& key, Handles& handles)
+    {
+        static_assert(std::is_pod<Handles>::value,
+                      "The handles of flat tables can only be loaded if they are POD");
+
+        if (!file_.open(fileName, key + " (flat tables, sizeof(Scalar)=" + std::to_string(sizeof(Scalar)) + ")",
+                        /*map=*/true)
+            || file_.numArrays() != 2
+            || file_.arraySize(1) != sizeof(Handles))
+        {
+            file_.close();
+            return false;
+        }
+
+        std::memcpy(&handles, file_.array(1), sizeof(Handles));
+        return true;
+    }
+
+    /*!
+     * \brief Returns true iff a file has been opened successfully.
+     */
+    bool isValid() const
+    { return file_.numArrays() == 2; }
+
+    /*!
+     * \brief Returns a view on the tables of the file.
+     *
+     * The view is valid as long as the snapshot object exists.
+     */
+    FlatTableView<Scalar> view() const
+    { return FlatTableView<Scalar>(file_.array(0)); }
+
+    /*!
+     * \brief Returns the address of the tables.
+     */
+    const void* data() const
+    { return file_.array(0); }
+
+    /*!
+     * \brief Returns the size of the tables [bytes].
+     */
+    size_t size() const
+    { return file_.arraySize(0); }
+
+private:
+    TableFile file_;
+};
+
+} // namespace Opm
+
+#endif
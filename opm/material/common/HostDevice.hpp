@@ -0,0 +1,40 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Provides the OPM_HOST_DEVICE macro for functions which can be called from
+ *        host code as well as from accelerator kernels.
+ */
+#ifndef OPM_HOST_DEVICE_HPP
+#define OPM_HOST_DEVICE_HPP
+
+// functions which are marked with this macro can be called from host code as well as
+// from kernels which are compiled by CUDA or HIP
+#if defined __CUDACC__ || defined __HIPCC__
+#define OPM_HOST_DEVICE __host__ __device__
+#define OPM_HAVE_DEVICE_COMPILER 1
+#else
+#define OPM_HOST_DEVICE
+#define OPM_HAVE_DEVICE_COMPILER 0
+#endif
+
+#endif
@@ -0,0 +1,256 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::HugePages
+ */
+#ifndef OPM_HUGE_PAGE_ALLOCATOR_HPP
+#define OPM_HUGE_PAGE_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <new>
+
+#if defined __unix__ || defined __APPLE__
+#include <sys/mman.h>
+#define OPM_HUGE_PAGES_HAVE_MMAP 1
+#endif
+
+namespace Opm {
+/*!
+ * \brief Specifies whether large tables ought to be stored on huge pages.
+ */
+enum HugePagePolicy {
+    //! Use the normal heap
+    NoHugePages,
+
+    //! Align the tables to huge pages and ask the kernel to back them by transparent
+    //! huge pages (madvise(MADV_HUGEPAGE) on Linux)
+    TransparentHugePages,
+
+    //! Use explicitly reserved huge pages (MAP_HUGETLB on Linux). If none are
+    //! available, transparent huge pages are used.
+    ExplicitHugePages
+};
+
+/*!
+ * \brief Allocates the memory of large tables on huge pages.
+ *
+ * Many tables, e.g., the ones of TabulatedComponent and GeneratedCO2Tables or the
+ * compactly stored parameters of EclMaterialLawManager, span thousands of 4 KiB
+ * pages. Since they are accessed at random positions, this causes many TLB misses.
+ * If they are stored on 2 MiB pages instead, a few TLB entries cover all of them.
+ *
+ * The policy is global and applies to all allocations which are made after it has been
+ * set; memory which was allocated before is still released correctly. Allocations
+ * which are smaller than minimumSize() always use the normal heap because they would
+ * waste most of a huge page. Huge pages are only supported on POSIX systems; on other
+ * platforms, the normal heap is always used.
+ */
+class HugePages
+{
+public:
+    //! The size of a huge page [bytes]
+    static constexpr size_t pageSize = 2*1024*1024;
+
+    /*!
+     * \brief Set the policy for subsequent allocations.
+     */
+    static void setPolicy(HugePagePolicy policy)
+    { state_().policy = policy; }
+
+    /*!
+     * \brief Returns the policy for subsequent allocations.
+     */
+    static HugePagePolicy policy()
+    { return state_().policy; }
+
+    /*!
+     * \brief Set the size below which the normal heap is used [bytes].
+     *
+     * The default is a quarter of a huge page.
+     */
+    static void setMinimumSize(size_t numBytes)
+    { state_().minimumSize = numBytes; }
+
+    /*!
+     * \brief Returns the size below which the normal heap is used [bytes].
+     */
+    static size_t minimumSize()
+    { return state_().minimumSize; }
+
+    /*!
+     * \brief Allocate a block of memory according to the current policy.
+     *
+     * The memory is aligned to at least alignof(std::max_align_t).
+     */
+    static void* allocate(size_t numBytes)
+    {
+#if OPM_HUGE_PAGES_HAVE_MMAP
+        State& state = state_();
+        HugePagePolicy policy = state.policy;
+        if (policy != NoHugePages && numBytes >= state.minimumSize) {
+            size_t mappedBytes = (numBytes + pageSize - 1)/pageSize*pageSize;
+            void* p = 0;
+#ifdef MAP_HUGETLB
+            if (policy == ExplicitHugePages) {
+                p = ::mmap(0, mappedBytes, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (p == MAP_FAILED)
+                    p = 0;
+            }
+#endif
+            if (!p)
+                p = mapAligned_(mappedBytes);
+
+            if (p) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.mappings[p] = mappedBytes;
+                return p;
+            }
+        }
+#endif
+
+        return ::operator new(numBytes);
+    }
+
+    /*!
+     * \brief Release a block of memory which was allocated by allocate().
+     */
+    static void deallocate(void* p)
+    {
+        if (!p)
+            return;
+
+#if OPM_HUGE_PAGES_HAVE_MMAP
+        State& state = state_();
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            auto it = state.mappings.find(p);
+            if (it != state.mappings.end()) {
+                ::munmap(p, it->second);
+                state.mappings.erase(it);
+                return;
+            }
+        }
+#endif
+
+        ::operator delete(p);
+    }
+
+private:
+    struct State
+    {
+        State()
+            : policy(NoHugePages)
+            , minimumSize(pageSize/4)
+        {}
+
+        HugePagePolicy policy;
+        size_t minimumSize;
+
+        // the blocks which were mapped and their sizes. allocations of tables are rare,
+        // so a map protected by a mutex is sufficient.
+        std::mutex mutex;
+        std::map<void*, size_t> mappings;
+    };
+
+    // the state is never destroyed because static tables may still be released
+    // after it when the program exits
+    static State& state_()
+    {
+        static State* state = new State;
+        return *state;
+    }
+
+#if OPM_HUGE_PAGES_HAVE_MMAP
+    // map anonymous memory which is aligned to a huge page. the kernel can only back
+    // aligned ranges by transparent huge pages.
+    static void* mapAligned_(size_t mappedBytes)
+    {
+        size_t reservedBytes = mappedBytes + pageSize;
+        void* reserved = ::mmap(0, reservedBytes, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (reserved == MAP_FAILED)
+            return 0;
+
+        // release the parts before and after the aligned range
+        uintptr_t begin = reinterpret_cast<uintptr_t>(reserved);
+        uintptr_t alignedBegin = (begin + pageSize - 1)/pageSize*pageSize;
+        if (alignedBegin > begin)
+            ::munmap(reserved, alignedBegin - begin);
+        size_t tailBytes = reservedBytes - (alignedBegin - begin) - mappedBytes;
+        if (tailBytes > 0)
+            ::munmap(reinterpret_cast<void*>(alignedBegin + mappedBytes), tailBytes);
+
+        void* p = reinterpret_cast<void*>(alignedBegin);
+#ifdef MADV_HUGEPAGE
+        ::madvise(p, mappedBytes, MADV_HUGEPAGE);
+#endif
+        return p;
+    }
+#endif
+};
+
+/*!
+ * \brief A standard conforming allocator which uses HugePages.
+ *
+ * This can be used as the allocator of the table classes, e.g.,
+ * UniformTabulated2DFunction or Tabulated1DFunction.
+ */
+template <class T>
+class HugePageAllocator
+{
+public:
+    typedef T value_type;
+
+    HugePageAllocator()
+    {}
+
+    template <class U>
+    HugePageAllocator(const HugePageAllocator<U>&)
+    {}
+
+    T* allocate(size_t n)
+    {
+        if (n > std::numeric_limits<size_t>::max()/sizeof(T))
+            throw std::bad_alloc();
+        return static_cast<T*>(HugePages::allocate(n*sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t)
+    { HugePages::deallocate(p); }
+
+    template <class U>
+    bool operator==(const HugePageAllocator<U>&) const
+    { return true; }
+
+    template <class U>
+    bool operator!=(const HugePageAllocator<U>&) const
+    { return false; }
+};
+
+} // namespace Opm
+
+#endif
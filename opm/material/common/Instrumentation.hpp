@@ -0,0 +1,401 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \brief Optional counters and timers for the entry points of the library.
+ *
+ * If the preprocessor macro OPM_MATERIAL_INSTRUMENTATION is defined to a non-zero
+ * value before this file is included, each scope which is marked by
+ * OPM_INSTRUMENT_SCOPE(name) counts how often it is entered and accumulates the
+ * number of clock ticks which are spent inside it. The counters are kept per
+ * thread, so updating them does not require any synchronization. The results of
+ * all threads can be retrieved using Opm::Instrumentation::collect() or printed
+ * using Opm::Instrumentation::report().
+ *
+ * Events which are not worth timing, e.g., whether a table lookup was within the
+ * range of the table, can be counted using OPM_INSTRUMENT_EVENT(name). For these, the
+ * number of ticks is always zero.
+ *
+ * If instrumentation is disabled (which is the default), OPM_INSTRUMENT_SCOPE()
+ * and OPM_INSTRUMENT_EVENT() expand to nothing and the report functions do not
+ * return any entries, i.e., the instrumentation does not cost anything.
+ *
+ * Usage:
+ * \code
+ * #define OPM_MATERIAL_INSTRUMENTATION 1
+ * #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
+ *
+ * // ... run the simulation ...
+ * Opm::Instrumentation::report(std::cout);
+ * \endcode
+ *
+ * Note that the times are inclusive, i.e., the time which is spent in an
+ * instrumented scope also contains the time of all instrumented scopes which are
+ * entered from it. If available, the time stamp counter of the CPU is used as the
+ * clock, else the ticks are nanoseconds.
+ */
+#ifndef OPM_INSTRUMENTATION_HPP
+#define OPM_INSTRUMENTATION_HPP
+
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if OPM_MATERIAL_INSTRUMENTATION
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace Opm {
+namespace Instrumentation {
+
+/*!
+ * \brief The accumulated statistics of all scopes with the same name.
+ */
+struct Entry
+{
+    std::string name;
+    unsigned long long numCalls;
+    unsigned long long numTicks;
+};
+
+#if OPM_MATERIAL_INSTRUMENTATION
+/*!
+ * \brief Returns the current value of the clock which is used to time the scopes.
+ */
+inline unsigned long long ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    typedef std::chrono::steady_clock Clock;
+    return static_cast<unsigned long long>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+#endif
+}
+
+/*!
+ * \brief The counters of a single instrumented scope for a single thread.
+ *
+ * The counters are only modified by the thread which owns them, but they may be read
+ * by other threads while a report is generated. They are thus atomic, but they are
+ * not incremented using read-modify-write operations.
+ */
+struct Counter
+{
+    Counter()
+        : numCalls(0)
+        , numTicks(0)
+    {}
+
+    void addEvent()
+    { numCalls.store(numCalls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+    void add(unsigned long long deltaTicks)
+    {
+        numCalls.store(numCalls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        numTicks.store(numTicks.load(std::memory_order_relaxed) + deltaTicks, std::memory_order_relaxed);
+    }
+
+    std::atomic<unsigned long long> numCalls;
+    std::atomic<unsigned long long> numTicks;
+};
+
+class ThreadCounters;
+
+/*!
+ * \brief The global list of instrumented scopes and threads.
+ */
+class Registry
+{
+public:
+    //! The maximum number of instrumented scopes. Scopes beyond this are not counted.
+    static const unsigned maxSites = 1024;
+
+    static Registry& instance()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    /*!
+     * \brief Register an instrumented scope and return its index.
+     *
+     * This is called once for each scope, i.e., the name is not looked up when the
+     * scope is entered.
+     */
+    unsigned registerSite(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        siteNames_.push_back(name);
+        return static_cast<unsigned>(siteNames_.size() - 1);
+    }
+
+    void attach(ThreadCounters* tc)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_.push_back(tc);
+    }
+
+    inline void detach(ThreadCounters* tc);
+
+    inline std::vector<Entry> collect();
+
+    inline void reset();
+
+private:
+    Registry()
+    {}
+
+    std::mutex mutex_;
+    std::vector<std::string> siteNames_;
+    std::vector<ThreadCounters*> threads_;
+
+    // the counters of the threads which have already finished
+    std::array<unsigned long long, maxSites> retiredCalls_ {{}};
+    std::array<unsigned long long, maxSites> retiredTicks_ {{}};
+};
+
+/*!
+ * \brief The counters of all instrumented scopes for the current thread.
+ */
+class ThreadCounters
+{
+public:
+    static ThreadCounters& local()
+    {
+        static thread_local ThreadCounters counters;
+        return counters;
+    }
+
+    Counter* counter(unsigned siteIdx)
+    {
+        if (siteIdx >= Registry::maxSites)
+            return 0;
+        return &counters_[siteIdx];
+    }
+
+    const Counter& operator[](unsigned siteIdx) const
+    { return counters_[siteIdx]; }
+
+    Counter& operator[](unsigned siteIdx)
+    { return counters_[siteIdx]; }
+
+private:
+    ThreadCounters()
+    { Registry::instance().attach(this); }
+
+    ~ThreadCounters()
+    { Registry::instance().detach(this); }
+
+    std::array<Counter, Registry::maxSites> counters_;
+};
+
+void Registry::detach(ThreadCounters* tc)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (unsigned siteIdx = 0; siteIdx < maxSites; ++siteIdx) {
+        retiredCalls_[siteIdx] += (*tc)[siteIdx].numCalls.load(std::memory_order_relaxed);
+        retiredTicks_[siteIdx] += (*tc)[siteIdx].numTicks.load(std::memory_order_relaxed);
+    }
+    threads_.erase(std::remove(threads_.begin(), threads_.end(), tc), threads_.end());
+}
+
+std::vector<Entry> Registry::collect()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // scopes of the same name (e.g., the instantiations of a template) are merged
+    std::map<std::string, Entry> entries;
+    unsigned numSites = std::min<unsigned>(static_cast<unsigned>(siteNames_.size()), maxSites);
+    for (unsigned siteIdx = 0; siteIdx < numSites; ++siteIdx) {
+        unsigned long long numCalls = retiredCalls_[siteIdx];
+        unsigned long long numTicks = retiredTicks_[siteIdx];
+        for (ThreadCounters* tc : threads_) {
+            numCalls += (*tc)[siteIdx].numCalls.load(std::memory_order_relaxed);
+            numTicks += (*tc)[siteIdx].numTicks.load(std::memory_order_relaxed);
+        }
+
+        Entry& e = entries[siteNames_[siteIdx]];
+        e.name = siteNames_[siteIdx];
+        e.numCalls += numCalls;
+        e.numTicks += numTicks;
+    }
+
+    std::vector<Entry> result;
+    for (const auto& e : entries)
+        if (e.second.numCalls > 0)
+            result.push_back(e.second);
+    return result;
+}
+
+void Registry::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    retiredCalls_.fill(0);
+    retiredTicks_.fill(0);
+    for (ThreadCounters* tc : threads_) {
+        for (unsigned siteIdx = 0; siteIdx < maxSites; ++siteIdx) {
+            (*tc)[siteIdx].numCalls.store(0, std::memory_order_relaxed);
+            (*tc)[siteIdx].numTicks.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+/*!
+ * \brief Updates the counters of a scope when the scope is left.
+ */
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(unsigned siteIdx)
+        : counter_(ThreadCounters::local().counter(siteIdx))
+        , startTicks_(ticks())
+    {}
+
+    ~ScopedTimer()
+    {
+        if (counter_)
+            counter_->add(ticks() - startTicks_);
+    }
+
+private:
+    ScopedTimer(const ScopedTimer&);
+    ScopedTimer& operator=(const ScopedTimer&);
+
+    Counter* counter_;
+    unsigned long long startTicks_;
+};
+
+/*!
+ * \brief Count an event for the current thread.
+ */
+inline void countEvent(unsigned siteIdx)
+{
+    Counter* counter = ThreadCounters::local().counter(siteIdx);
+    if (counter)
+        counter->addEvent();
+}
+
+/*!
+ * \brief Returns the statistics of all instrumented scopes which have been entered
+ *        at least once, sorted by their names.
+ */
+inline std::vector<Entry> collect()
+{ return Registry::instance().collect(); }
+
+/*!
+ * \brief Set all counters to zero.
+ */
+inline void reset()
+{ Registry::instance().reset(); }
+
+#define OPM_INSTRUMENT_CONCAT_IMPL_(a, b) a ## b
+#define OPM_INSTRUMENT_CONCAT_(a, b) OPM_INSTRUMENT_CONCAT_IMPL_(a, b)
+
+/*!
+ * \brief Count the calls of the enclosing scope and the ticks spent in it.
+ *
+ * \param name A string which identifies the scope in the report. It is only
+ *             evaluated when the scope is entered for the first time.
+ */
+#define OPM_INSTRUMENT_SCOPE(name)                                      \
+    static const unsigned OPM_INSTRUMENT_CONCAT_(opmInstrumentSite_, __LINE__) = \
+        ::Opm::Instrumentation::Registry::instance().registerSite(name); \
+    ::Opm::Instrumentation::ScopedTimer OPM_INSTRUMENT_CONCAT_(opmInstrumentTimer_, __LINE__)( \
+        OPM_INSTRUMENT_CONCAT_(opmInstrumentSite_, __LINE__))
+
+/*!
+ * \brief Count how often a statement is reached without timing it.
+ *
+ * \param name A string which identifies the event in the report. It is only
+ *             evaluated when the event occurs for the first time.
+ */
+#define OPM_INSTRUMENT_EVENT(name)                                      \
+    do {                                                                \
+        static const unsigned opmInstrumentEventSite_ =                 \
+            ::Opm::Instrumentation::Registry::instance().registerSite(name); \
+        ::Opm::Instrumentation::countEvent(opmInstrumentEventSite_);    \
+    } while (false)
+
+#else // !OPM_MATERIAL_INSTRUMENTATION
+
+inline std::vector<Entry> collect()
+{ return std::vector<Entry>(); }
+
+inline void reset()
+{ }
+
+#define OPM_INSTRUMENT_SCOPE(name) static_cast<void>(0)
+#define OPM_INSTRUMENT_EVENT(name) static_cast<void>(0)
+
+#endif // OPM_MATERIAL_INSTRUMENTATION
+
+/*!
+ * \brief Returns true if the library has been compiled with instrumentation.
+ */
+inline bool enabled()
+{
+#if OPM_MATERIAL_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*!
+ * \brief Print the statistics of all instrumented scopes.
+ */
+inline void report(std::ostream& os)
+{
+    if (!enabled()) {
+        os << "Instrumentation is disabled. Define OPM_MATERIAL_INSTRUMENTATION=1 to enable it.\n";
+        return;
+    }
+
+    const std::vector<Entry>& entries = collect();
+    for (const auto& e : entries) {
+        os << e.name << ": " << e.numCalls << " calls";
+        if (e.numTicks == 0) {
+            // an event or a scope which is too short to be measured
+            os << "\n";
+            continue;
+        }
+
+        os << ", " << e.numTicks << " ticks";
+        if (e.numCalls > 0)
+            os << " (" << static_cast<double>(e.numTicks)/e.numCalls << " ticks/call)";
+        os << "\n";
+    }
+}
+
+} // namespace Instrumentation
+} // namespace Opm
+
+#endif
@@ -0,0 +1,124 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::InterpolationWeights
+ */
+#ifndef OPM_INTERPOLATION_WEIGHTS_HPP
+#define OPM_INTERPOLATION_WEIGHTS_HPP
+
+#include <array>
+#include <cassert>
+
+namespace Opm {
+/*!
+ * \brief The weights of the sampling points of a tabulated function which contribute
+ *        to its value at a given position.
+ *
+ * The piecewise linear tables are linear in the values of their sampling points,
+ * i.e., the value at any position is \f$f = \sum_k w_k f_k\f$ where the \f$f_k\f$
+ * are the values of the sampling points of the segment (or the cell of a
+ * two-dimensional table) which contains the position and the \f$w_k\f$ only depend
+ * on the position. The weights are thus the partial derivatives of the value with
+ * regard to the values of the sampling points, which is what gradient-based history
+ * matching needs. Objects of this class are filled by the evalWeights() methods of
+ * the tables, e.g., Tabulated1DFunction::evalWeights().
+ *
+ * Each contributing sampling point is identified by two indices: For
+ * one-dimensional tables, xIdx() is the index of the sampling point and yIdx() is
+ * always zero. For two-dimensional tables which consist of columns, e.g.,
+ * UniformXTabulated2DFunction, xIdx() is the index of the column and yIdx() is the
+ * index of the sampling point within it.
+ *
+ * \tparam maxNodes The maximum number of contributing sampling points, i.e., 2 for
+ *                  one-dimensional and 4 for two-dimensional tables
+ */
+template <class Scalar, int maxNodes>
+class InterpolationWeights
+{
+public:
+    InterpolationWeights()
+        : numNodes_(0)
+    {}
+
+    /*!
+     * \brief Remove all sampling points.
+     */
+    void clear()
+    { numNodes_ = 0; }
+
+    /*!
+     * \brief Add a contributing sampling point.
+     */
+    void add(int xIdx, int yIdx, Scalar weight)
+    {
+        assert(numNodes_ < maxNodes);
+        xIdx_[numNodes_] = xIdx;
+        yIdx_[numNodes_] = yIdx;
+        weight_[numNodes_] = weight;
+        ++ numNodes_;
+    }
+
+    /*!
+     * \brief Multiply all weights by a factor.
+     *
+     * This can be used to apply the chain rule if the tabulated quantity is a
+     * function of the quantity of interest.
+     */
+    void scale(Scalar factor)
+    {
+        for (int k = 0; k < numNodes_; ++k)
+            weight_[k] *= factor;
+    }
+
+    /*!
+     * \brief Returns the number of contributing sampling points.
+     */
+    int size() const
+    { return numNodes_; }
+
+    /*!
+     * \brief Returns the first index of the k-th contributing sampling point.
+     */
+    int xIdx(int k) const
+    { assert(0 <= k && k < numNodes_); return xIdx_[k]; }
+
+    /*!
+     * \brief Returns the second index of the k-th contributing sampling point.
+     */
+    int yIdx(int k) const
+    { assert(0 <= k && k < numNodes_); return yIdx_[k]; }
+
+    /*!
+     * \brief Returns the weight of the k-th contributing sampling point.
+     */
+    Scalar weight(int k) const
+    { assert(0 <= k && k < numNodes_); return weight_[k]; }
+
+private:
+    int numNodes_;
+    std::array<int, maxNodes> xIdx_;
+    std::array<int, maxNodes> yIdx_;
+    std::array<Scalar, maxNodes> weight_;
+};
+} // namespace Opm
+
+#endif
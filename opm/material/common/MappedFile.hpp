@@ -0,0 +1,167 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::MappedFile
+ */
+#ifndef OPM_MAPPED_FILE_HPP
+#define OPM_MAPPED_FILE_HPP
+
+#include <opm/material/common/ErrorMacros.hpp>
+
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#if defined __unix__ || defined __APPLE__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define OPM_MAPPED_FILE_HAVE_MMAP 1
+#endif
+
+namespace Opm {
+/*!
+ * \brief A writable block of memory which is backed by a file instead of the swap
+ *        space.
+ *
+ * This is intended for large arrays which do not need to stay in physical memory all
+ * the time: The operating system can write their pages to the file and drop them if
+ * memory becomes scarce, and read them back when they are accessed again. The file is
+ * created (or truncated) by create() and removed when the memory is released.
+ *
+ * Memory mapped files are only supported on POSIX systems; on other platforms,
+ * create() throws.
+ */
+class MappedFile
+{
+public:
+    MappedFile()
+        : data_(0)
+        , size_(0)
+    {}
+
+    ~MappedFile()
+    { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /*!
+     * \brief Returns true iff memory mapped files are supported on this platform.
+     */
+    static bool isSupported()
+    {
+#if OPM_MAPPED_FILE_HAVE_MMAP
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /*!
+     * \brief Create a file of a given size and map it into memory.
+     *
+     * The memory is zero-initialized and aligned to a page. An exception is thrown if
+     * the file cannot be created or mapped.
+     *
+     * \param fileName The name of the file
+     * \param numBytes The size of the file [bytes]
+     */
+    void create(const std::string& fileName, size_t numBytes)
+    {
+        close();
+
+#if OPM_MAPPED_FILE_HAVE_MMAP
+        int fd = ::open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0)
+            OPM_THROW(std::runtime_error, "Could not create the file '" << fileName << "'");
+
+        // an empty mapping is not possible, so at least one byte is mapped
+        size_t mappedSize = (numBytes > 0) ? numBytes : 1;
+        void* p = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(mappedSize)) == 0)
+            p = ::mmap(0, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if (p == MAP_FAILED) {
+            std::remove(fileName.c_str());
+            OPM_THROW(std::runtime_error,
+                      "Could not map " << numBytes << " bytes of the file '" << fileName << "'");
+        }
+
+        data_ = p;
+        size_ = mappedSize;
+        fileName_ = fileName;
+#else
+        OPM_THROW(std::runtime_error,
+                  "Memory mapped files are not supported on this platform (file '"
+                  << fileName << "')");
+#endif
+    }
+
+    /*!
+     * \brief Unmap the memory and remove the file.
+     *
+     * All pointers which were returned by data() become invalid.
+     */
+    void close()
+    {
+#if OPM_MAPPED_FILE_HAVE_MMAP
+        if (data_) {
+            ::munmap(data_, size_);
+            std::remove(fileName_.c_str());
+        }
+#endif
+        data_ = 0;
+        size_ = 0;
+        fileName_.clear();
+    }
+
+    /*!
+     * \brief Returns the mapped memory.
+     */
+    void* data() const
+    { return data_; }
+
+    /*!
+     * \brief Returns the size of the mapped memory [bytes].
+     */
+    size_t size() const
+    { return size_; }
+
+    /*!
+     * \brief Returns the name of the file which backs the memory.
+     */
+    const std::string& fileName() const
+    { return fileName_; }
+
+private:
+    void* data_;
+    size_t size_;
+    std::string fileName_;
+};
+} // namespace Opm
+
+#endif
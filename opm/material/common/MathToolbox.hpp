@@ -45,22 +45,65 @@ struct ToLhsEvalHelper;
 
 template <class LhsEval, class RhsEval>
 struct ToLhsEvalHelper<LhsEval, RhsEval, true, true> {
+    typedef LhsEval ResultType;
+
     static LhsEval exec(const RhsEval& eval)
     { return eval; }
 };
 
 template <class LhsEval, class RhsEval>
 struct ToLhsEvalHelper<LhsEval, RhsEval, true, false> {
+    typedef LhsEval ResultType;
+
     static LhsEval exec(const RhsEval& eval)
     { return eval.value; }
 };
 
 template <class LhsEval, class RhsEval>
 struct ToLhsEvalHelper<LhsEval, RhsEval, false, false> {
+    typedef LhsEval ResultType;
+
     static LhsEval exec(const RhsEval& eval)
     { return eval; }
 };
 
+// if no conversion is required, evaluations are passed through by reference. this
+// avoids copying all derivatives for each call of toLhs().
+template <class Eval>
+struct ToLhsEvalHelper<Eval, Eval, false, false> {
+    typedef const Eval& ResultType;
+
+    static const Eval& exec(const Eval& eval)
+    { return eval; }
+};
+
+/*!
+ * \brief Raise a value to an integer power using multiplications only.
+ *
+ * The power is computed by repeated squaring, i.e., this requires about 2*log2(exp)
+ * multiplications and is much cheaper than calling std::pow() for the exponents which
+ * occur in practice. If the exponent is negative, the reciprocal of the result is
+ * returned.
+ */
+template <class Scalar>
+Scalar integerPow(Scalar base, int exp)
+{
+    unsigned n = (exp < 0) ? -exp : exp;
+
+    Scalar result = 1.0;
+    while (n > 0) {
+        if (n & 1)
+            result *= base;
+        n >>= 1;
+        if (n > 0)
+            base *= base;
+    }
+
+    if (exp < 0)
+        return 1.0/result;
+    return result;
+}
+
 /*
  * \brief A traits class which provides basic mathematical functions for arbitrary scalar
  *        floating point values.
@@ -202,6 +245,15 @@ public:
     //! Exponentiation to an arbitrary base
     static Scalar pow(Scalar base, Scalar exp)
     { return std::pow(base, exp); }
+
+    //! Exponentiation to an integer power
+    //!
+    //! This is a template so that only exponents which are integers already are
+    //! considered, i.e., floating point exponents never get truncated.
+    template <class IntType>
+    static typename std::enable_if<std::is_integral<IntType>::value, Scalar>::type
+    pow(Scalar base, IntType exp)
+    { return integerPow(base, static_cast<int>(exp)); }
 };
 
 } // namespace Opm
@@ -28,6 +28,8 @@
 #ifndef OPM_MEANS_HH
 #define OPM_MEANS_HH
 
+#include <opm/material/common/MathToolbox.hpp>
+
 #include <cmath>
 
 namespace Opm {
@@ -57,7 +59,7 @@ inline Scalar geometricMean(Scalar x, Scalar y)
     if (x*y <= 0.0)
         return 0.0;
 
-    return std::sqrt(x*x + y*y);
+    return Opm::MathToolbox<Scalar>::sqrt(x*x + y*y);
 }
 
 /*!
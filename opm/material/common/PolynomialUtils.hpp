@@ -25,7 +25,9 @@
 #ifndef OPM_POLYNOMIAL_UTILS_HH
 #define OPM_POLYNOMIAL_UTILS_HH
 
+#include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <algorithm>
 
 #include <opm/material/common/MathToolbox.hpp>
@@ -313,6 +315,132 @@ int invertCubicPolynomial(SolContainer *sol,
 
     return 3;
 }
+
+/*!
+ * \ingroup Math
+ * \brief Invert a batch of cubic polynomials analytically
+ *
+ * The polynomials are defined as
+ * \f[ p_i(x) = a_i\; x^3 + b_i\;x^2 + c_i\;x + d_i \f]
+ * where \f$a_i\f$ must not be zero.
+ *
+ * In contrast to invertCubicPolynomial(), the polynomials are first classified by
+ * the sign of their discriminant and the roots are then calculated in separate
+ * loops for the polynomials with one and with three real roots. These loops do not
+ * contain any data dependent branches, which allows the compiler to vectorize them.
+ * Each root is polished by one Newton iteration.
+ *
+ * For each polynomial, three roots are written to the "sol" argument in ascending
+ * order, i.e., sol[3*i] is the smallest and sol[3*i + 2] the largest root of the
+ * i-th polynomial. If a polynomial has only one real root (or a multiple one), all
+ * three entries are set to it. The number of distinct real roots, i.e., 1 or 3, is
+ * written to numSol.
+ *
+ * \param sol Array of size 3*n into which the roots are written
+ * \param numSol Array of size n into which the number of real roots are written
+ * \param a The coefficients for the cubic terms
+ * \param b The coefficients for the quadratic terms
+ * \param c The coefficients for the linear terms
+ * \param d The coefficients for the constant terms
+ * \param n The number of polynomials
+ */
+template <class Scalar>
+void invertCubicPolynomialBatch(Scalar *sol,
+                                int *numSol,
+                                const Scalar *a,
+                                const Scalar *b,
+                                const Scalar *c,
+                                const Scalar *d,
+                                size_t n)
+{
+    // the polynomials are processed in chunks. this limits the amount of
+    // temporary space required
+    static const size_t chunkSize = 64;
+
+    Scalar bn[chunkSize];
+    Scalar p[chunkSize];
+    Scalar q[chunkSize];
+    Scalar wDisc[chunkSize];
+    unsigned oneRootIdx[chunkSize];
+    unsigned threeRootsIdx[chunkSize];
+
+    for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += chunkSize) {
+        const size_t m = std::min(chunkSize, n - chunkBegin);
+        const Scalar *ac = a + chunkBegin;
+        const Scalar *bc = b + chunkBegin;
+        const Scalar *cc = c + chunkBegin;
+        const Scalar *dc = d + chunkBegin;
+        Scalar *solc = sol + 3*chunkBegin;
+        int *numSolc = numSol + chunkBegin;
+
+        // normalize the polynomials and get rid of the quadratic term by
+        // subsituting x = t - b/3. this yields t^3 + p*t + q = 0
+        for (size_t i = 0; i < m; ++i) {
+            Scalar bi = bc[i]/ac[i];
+            Scalar ci = cc[i]/ac[i];
+            Scalar di = dc[i]/ac[i];
+
+            bn[i] = bi;
+            p[i] = ci - bi*bi/3;
+            q[i] = di + (2*bi*bi*bi - 9*bi*ci)/27;
+            wDisc[i] = q[i]*q[i]/4 + p[i]*p[i]*p[i]/27;
+        }
+
+        // classify the polynomials
+        size_t numOneRoot = 0;
+        size_t numThreeRoots = 0;
+        for (size_t i = 0; i < m; ++i) {
+            if (wDisc[i] >= 0)
+                oneRootIdx[numOneRoot++] = static_cast<unsigned>(i);
+            else
+                threeRootsIdx[numThreeRoots++] = static_cast<unsigned>(i);
+        }
+
+        // a single real root: Cardano's formula. the sign of the square root is
+        // chosen such that no cancellation occurs. u is only zero if p and q are
+        // zero, i.e., for the triple root t = 0.
+        for (size_t k = 0; k < numOneRoot; ++k) {
+            unsigned i = oneRootIdx[k];
+            Scalar sqrtDisc = std::sqrt(wDisc[i]);
+            Scalar u = std::cbrt(-q[i]/2 - std::copysign(sqrtDisc, q[i]));
+            Scalar t = (u != 0.0) ? u - p[i]/(3*u) : 0.0;
+            Scalar x = t - bn[i]/3;
+
+            solc[3*i + 0] = x;
+            solc[3*i + 1] = x;
+            solc[3*i + 2] = x;
+            numSolc[i] = 1;
+        }
+
+        // three real roots: trigonometric method. p is negative in this case.
+        for (size_t k = 0; k < numThreeRoots; ++k) {
+            unsigned i = threeRootsIdx[k];
+            Scalar r = 2*std::sqrt(-p[i]/3);
+            Scalar cosArg = 3*q[i]/(p[i]*r);
+            cosArg = std::max<Scalar>(-1.0, std::min<Scalar>(1.0, cosArg));
+            Scalar theta = std::acos(cosArg)/3;
+
+            solc[3*i + 0] = r*std::cos(theta + 2*M_PI/3) - bn[i]/3;
+            solc[3*i + 1] = r*std::cos(theta - 2*M_PI/3) - bn[i]/3;
+            solc[3*i + 2] = r*std::cos(theta) - bn[i]/3;
+            numSolc[i] = 3;
+        }
+
+        // polish all roots using one Newton iteration and keep the result if it
+        // reduced the residual
+        for (size_t i = 0; i < m; ++i) {
+            Scalar ai = ac[i], bi = bc[i], ci = cc[i], di = dc[i];
+            for (int j = 0; j < 3; ++j) {
+                Scalar x = solc[3*i + j];
+                Scalar fOld = di + x*(ci + x*(bi + x*ai));
+                Scalar fPrime = ci + x*(2*bi + x*3*ai);
+                Scalar xNew = (fPrime != 0.0) ? x - fOld/fPrime : x;
+                Scalar fNew = di + xNew*(ci + xNew*(bi + xNew*ai));
+                solc[3*i + j] = (std::abs(fNew) < std::abs(fOld)) ? xNew : x;
+            }
+        }
+    }
+}
 }
 
 #endif
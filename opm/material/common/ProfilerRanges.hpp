@@ -0,0 +1,239 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \brief Optional named ranges for external profilers like NVIDIA Nsight and Intel
+ *        VTune.
+ *
+ * Most of the library consists of templates, so without further hints its functions
+ * show up in the timelines of profilers under their mangled names or not at all if
+ * they have been inlined. If the preprocessor macro OPM_MATERIAL_NVTX_RANGES or
+ * OPM_MATERIAL_ITT_RANGES is defined to a non-zero value before this file is
+ * included, each scope which is marked by OPM_PROFILER_RANGE(name) is reported to
+ * the profiler as a range of the given name using the NVIDIA tools extension (NVTX)
+ * respectively as a task of the Intel instrumentation and tracing technology API
+ * (ITT). Both can be enabled at the same time. The program then needs to be linked
+ * against the respective library, i.e., libnvToolsExt (not required for NVTX 3,
+ * which is header-only) or libittnotify.
+ *
+ * Consecutive phases of a longer computation which share their local variables, and
+ * thus cannot be put into separate scopes, can be marked using a PhaseRanges object:
+ * \code
+ * Opm::ProfilerRanges::PhaseRanges phases("MyClass::init reading");
+ * // ... read ...
+ * phases.next("MyClass::init tabulating");
+ * // ... tabulate ...
+ * \endcode
+ *
+ * If neither of the macros is defined (which is the default), OPM_PROFILER_RANGE()
+ * expands to nothing and the methods of PhaseRanges are empty, i.e., the annotations
+ * do not cost anything. In contrast to the counters of Instrumentation.hpp the
+ * ranges are not evaluated by the library itself.
+ */
+#ifndef OPM_PROFILER_RANGES_HPP
+#define OPM_PROFILER_RANGES_HPP
+
+#if OPM_MATERIAL_NVTX_RANGES || OPM_MATERIAL_ITT_RANGES
+#define OPM_MATERIAL_PROFILER_RANGES 1
+#else
+#define OPM_MATERIAL_PROFILER_RANGES 0
+#endif
+
+#if OPM_MATERIAL_NVTX_RANGES
+#if defined(__has_include)
+#if __has_include(<nvtx3/nvToolsExt.h>)
+#include <nvtx3/nvToolsExt.h>
+#else
+#include <nvToolsExt.h>
+#endif
+#else
+#include <nvToolsExt.h>
+#endif
+#endif
+
+#if OPM_MATERIAL_ITT_RANGES
+#include <ittnotify.h>
+#endif
+
+#if OPM_MATERIAL_PROFILER_RANGES
+#include <string>
+#endif
+
+namespace Opm {
+namespace ProfilerRanges {
+
+/*!
+ * \brief Returns true if the library has been compiled with profiler ranges.
+ */
+inline bool enabled()
+{ return OPM_MATERIAL_PROFILER_RANGES != 0; }
+
+#if OPM_MATERIAL_PROFILER_RANGES
+#if OPM_MATERIAL_ITT_RANGES
+/*!
+ * \brief Returns the ITT domain to which the tasks of the library belong.
+ */
+inline __itt_domain* ittDomain()
+{
+    static __itt_domain* const domain = __itt_domain_create("opm-material");
+    return domain;
+}
+#endif
+
+/*!
+ * \brief The name of a range in the representations which are required by the
+ *        profiler APIs.
+ *
+ * Creating a site may be relatively expensive, so OPM_PROFILER_RANGE() creates it
+ * only once for each scope.
+ */
+class Site
+{
+public:
+    explicit Site(const std::string& name)
+        : name_(name)
+#if OPM_MATERIAL_ITT_RANGES
+        , ittHandle_(__itt_string_handle_create(name.c_str()))
+#endif
+    {}
+
+    const char* name() const
+    { return name_.c_str(); }
+
+#if OPM_MATERIAL_ITT_RANGES
+    __itt_string_handle* ittHandle() const
+    { return ittHandle_; }
+#endif
+
+private:
+    std::string name_;
+#if OPM_MATERIAL_ITT_RANGES
+    __itt_string_handle* ittHandle_;
+#endif
+};
+
+/*!
+ * \brief Open a range for the current thread.
+ */
+inline void push(const Site& site)
+{
+#if OPM_MATERIAL_NVTX_RANGES
+    nvtxRangePushA(site.name());
+#endif
+#if OPM_MATERIAL_ITT_RANGES
+    __itt_task_begin(ittDomain(), __itt_null, __itt_null, site.ittHandle());
+#endif
+}
+
+/*!
+ * \brief Close the range of the current thread which was opened last.
+ */
+inline void pop()
+{
+#if OPM_MATERIAL_NVTX_RANGES
+    nvtxRangePop();
+#endif
+#if OPM_MATERIAL_ITT_RANGES
+    __itt_task_end(ittDomain());
+#endif
+}
+
+/*!
+ * \brief Opens a range when it is created and closes it when it is destroyed.
+ */
+class ScopedRange
+{
+public:
+    explicit ScopedRange(const Site& site)
+    { push(site); }
+
+    ~ScopedRange()
+    { pop(); }
+
+private:
+    ScopedRange(const ScopedRange&);
+    ScopedRange& operator=(const ScopedRange&);
+};
+
+/*!
+ * \brief A sequence of ranges of which exactly one is open at any time.
+ *
+ * The last range is closed when the object is destroyed, i.e., also if an exception
+ * is thrown.
+ */
+class PhaseRanges
+{
+public:
+    explicit PhaseRanges(const char* firstPhase)
+    { push(Site(firstPhase)); }
+
+    ~PhaseRanges()
+    { pop(); }
+
+    /*!
+     * \brief Close the range of the current phase and open the one of the next.
+     */
+    void next(const char* phase)
+    {
+        pop();
+        push(Site(phase));
+    }
+
+private:
+    PhaseRanges(const PhaseRanges&);
+    PhaseRanges& operator=(const PhaseRanges&);
+};
+
+#define OPM_PROFILER_RANGE_CONCAT_IMPL_(a, b) a ## b
+#define OPM_PROFILER_RANGE_CONCAT_(a, b) OPM_PROFILER_RANGE_CONCAT_IMPL_(a, b)
+
+/*!
+ * \brief Report the enclosing scope to the profiler as a range of a given name.
+ *
+ * \param name A string which identifies the range. It is only evaluated when the
+ *             scope is entered for the first time, so it may be composed at run
+ *             time, e.g., from the name of a component.
+ */
+#define OPM_PROFILER_RANGE(name)                                        \
+    static const ::Opm::ProfilerRanges::Site OPM_PROFILER_RANGE_CONCAT_(opmProfilerSite_, __LINE__)(name); \
+    ::Opm::ProfilerRanges::ScopedRange OPM_PROFILER_RANGE_CONCAT_(opmProfilerRange_, __LINE__)( \
+        OPM_PROFILER_RANGE_CONCAT_(opmProfilerSite_, __LINE__))
+
+#else // !OPM_MATERIAL_PROFILER_RANGES
+
+class PhaseRanges
+{
+public:
+    explicit PhaseRanges(const char* /* firstPhase */)
+    {}
+
+    void next(const char* /* phase */)
+    {}
+};
+
+#define OPM_PROFILER_RANGE(name) static_cast<void>(0)
+
+#endif // OPM_MATERIAL_PROFILER_RANGES
+
+} // namespace ProfilerRanges
+} // namespace Opm
+
+#endif
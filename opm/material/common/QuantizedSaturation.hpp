@@ -0,0 +1,110 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::QuantizedSaturation
+ */
+#ifndef OPM_QUANTIZED_SATURATION_HPP
+#define OPM_QUANTIZED_SATURATION_HPP
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+namespace Opm {
+/*!
+ * \brief Stores a saturation-like quantity as a fixed point number.
+ *
+ * The value is stored as a signed integer which is multiplied by a power of two, so
+ * decoding it only takes a single multiplication. The representable range is
+ * [-4, 4), which covers saturations, saturation differences and the sentinel values
+ * that are used by the hysteresis laws. Values outside of this range are clamped. The
+ * resolution is \f$2^{3 - b}\f$ for an integer type of \f$b\f$ bits, i.e., about
+ * \f$1.2\cdot 10^{-4}\f$ for 16 bit integers and \f$1.9\cdot 10^{-9}\f$ for 32 bit
+ * integers. If a value is stored using the constructor, the error is at most half the
+ * resolution.
+ *
+ * Objects of this class convert implicitly from and to Scalar, so they can be used as
+ * a drop-in replacement for the Scalar attributes of parameter objects.
+ *
+ * \tparam Scalar The floating point type of the decoded values
+ * \tparam IntT The signed integer type which stores the value, e.g., int16_t or int32_t
+ */
+template <class Scalar, class IntT>
+class QuantizedSaturation
+{
+    static_assert(std::is_integral<IntT>::value && std::is_signed<IntT>::value,
+                  "Quantized saturations must be stored using signed integers");
+
+public:
+    QuantizedSaturation()
+        : value_(0)
+    {}
+
+    /*!
+     * \brief Store the representable value which is closest to a given one.
+     */
+    QuantizedSaturation(Scalar value)
+        : value_(encode_(std::floor(value/resolution() + 0.5)))
+    {}
+
+    /*!
+     * \brief Store the largest representable value which is not larger than a given one.
+     *
+     * This is useful for the minimum of a sequence of values: If the same value is seen
+     * again, it is not smaller than the stored one.
+     */
+    static QuantizedSaturation roundDown(Scalar value)
+    {
+        QuantizedSaturation result;
+        result.value_ = encode_(std::floor(value/resolution()));
+        return result;
+    }
+
+    /*!
+     * \brief Returns the difference between two adjacent representable values.
+     */
+    static Scalar resolution()
+    { return Scalar(1.0)/Scalar(1LL << (std::numeric_limits<IntT>::digits - 2)); }
+
+    /*!
+     * \brief Returns the decoded value.
+     */
+    operator Scalar() const
+    { return value_*resolution(); }
+
+private:
+    static IntT encode_(Scalar numSteps)
+    {
+        const Scalar minSteps = std::numeric_limits<IntT>::min();
+        const Scalar maxSteps = std::numeric_limits<IntT>::max();
+        if (!(numSteps > minSteps))
+            return std::numeric_limits<IntT>::min();
+        if (numSteps > maxSteps)
+            return std::numeric_limits<IntT>::max();
+        return static_cast<IntT>(numSteps);
+    }
+
+    IntT value_;
+};
+} // namespace Opm
+
+#endif
@@ -0,0 +1,98 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::SegmentHint
+ */
+#ifndef OPM_SEGMENT_HINT_HPP
+#define OPM_SEGMENT_HINT_HPP
+
+namespace Opm {
+/*!
+ * \brief Caches the index of the segment of a tabulated function which was used for
+ *        the last evaluation.
+ *
+ * Objects of this class can be passed to the eval() methods of the tabulated functions
+ * which accept it. These methods first check whether the position is located within
+ * the cached segment and only search for the correct segment if it is not. Since
+ * the position of a given degree of freedom usually does not change much between
+ * two evaluations, this makes the segment lookup practically free.
+ *
+ * A default constructed hint is invalid, i.e., the first evaluation which uses it
+ * always performs a full search.
+ */
+class SegmentHint
+{
+public:
+    SegmentHint()
+        : segmentIdx(-1)
+    {}
+
+    /*!
+     * \brief Invalidate the hint.
+     *
+     * This needs to be called if the hint is going to be used for a different table.
+     */
+    void reset()
+    { segmentIdx = -1; }
+
+    /*!
+     * \brief Returns true if the hint contains a segment index.
+     */
+    bool isValid() const
+    { return segmentIdx >= 0; }
+
+    //! The index of the segment which was used for the last evaluation
+    int segmentIdx;
+};
+
+/*!
+ * \brief Caches the segments of a two-dimensional tabulated function which were used
+ *        for the last evaluation.
+ *
+ * This contains the index of the interval on the x axis and the index of the segments
+ * on the two columns adjacent to it.
+ */
+class SegmentHint2D
+{
+public:
+    /*!
+     * \brief Invalidate the hint.
+     */
+    void reset()
+    {
+        xSegment.reset();
+        ySegment1.reset();
+        ySegment2.reset();
+    }
+
+    //! The index of the interval on the x axis
+    SegmentHint xSegment;
+
+    //! The index of the segment on the column to the left of the position
+    SegmentHint ySegment1;
+
+    //! The index of the segment on the column to the right of the position
+    SegmentHint ySegment2;
+};
+} // namespace Opm
+
+#endif
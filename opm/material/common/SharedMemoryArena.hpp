@@ -0,0 +1,431 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::SharedMemoryArena
+ */
+#ifndef OPM_SHARED_MEMORY_ARENA_HPP
+#define OPM_SHARED_MEMORY_ARENA_HPP
+
+#include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/Exceptions.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined __unix__ || defined __APPLE__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define OPM_SHARED_MEMORY_ARENA_HAVE_SHM 1
+#endif
+
+namespace Opm {
+/*!
+ * \brief A memory segment which is shared by all processes of a machine.
+ *
+ * This is intended to avoid duplicating bit-identical tables in each MPI rank of a
+ * node: One process creates the arena and constructs the tables inside it using
+ * SharedMemoryAllocator. It then publishes the root object, i.e., the object from which
+ * all tables can be reached. The other processes attach to the arena and access the
+ * root object read-only.
+ *
+ * Since the objects stored in the arena contain absolute pointers, the attaching
+ * processes need to map the segment at the same address as the creating process. If
+ * this is not possible, attach() fails and the caller has to compute the tables
+ * privately. Objects which live in the arena must never be modified or destroyed by the
+ * attaching processes.
+ *
+ * Shared memory segments are only supported on POSIX systems. On other platforms,
+ * create() and attach() always fail.
+ */
+class SharedMemoryArena
+{
+    struct Header
+    {
+        char magic[8];
+        uint64_t size;
+        uint64_t used;
+        void* baseAddress;
+        void* root;
+        std::atomic<uint32_t> ready;
+    };
+
+public:
+    /*!
+     * \brief Sets the arena from which SharedMemoryAllocator allocates during its life
+     *        time.
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(SharedMemoryArena& arena)
+            : previous_(current_())
+        { current_() = &arena; }
+
+        ~Scope()
+        { current_() = previous_; }
+
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        SharedMemoryArena* previous_;
+    };
+
+    SharedMemoryArena()
+        : header_(0)
+        , isCreator_(false)
+    {}
+
+    ~SharedMemoryArena()
+    { detach(); }
+
+    SharedMemoryArena(const SharedMemoryArena&) = delete;
+    SharedMemoryArena& operator=(const SharedMemoryArena&) = delete;
+
+    /*!
+     * \brief Create a new shared memory segment.
+     *
+     * \param name The name of the segment. On POSIX systems, this must start with a
+     *             slash and not contain any other slashes.
+     * \param size The size of the segment in bytes
+     *
+     * \return false if the segment could not be created, e.g., because a segment of
+     *         the same name already exists.
+     */
+    bool create(const std::string& name, size_t size)
+    {
+        detach();
+
+#if OPM_SHARED_MEMORY_ARENA_HAVE_SHM
+        size = alignedSize_(sizeof(Header)) + size;
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+            return false;
+
+        void* addr = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(size)) == 0)
+            addr = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if (addr == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            return false;
+        }
+
+        header_ = static_cast<Header*>(addr);
+        std::memcpy(header_->magic, "OPMARENA", sizeof(header_->magic));
+        header_->size = size;
+        header_->used = alignedSize_(sizeof(Header));
+        header_->baseAddress = addr;
+        header_->root = 0;
+        new (&header_->ready) std::atomic<uint32_t>(0);
+
+        name_ = name;
+        isCreator_ = true;
+        mappedArenas_().push_back(this);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /*!
+     * \brief Attach to a shared memory segment which was created by another process.
+     *
+     * \param name The name of the segment.
+     *
+     * \return false if the segment does not exist, has not been published yet or
+     *         cannot be mapped at the address used by the creating process.
+     */
+    bool attach(const std::string& name)
+    {
+        detach();
+
+#if OPM_SHARED_MEMORY_ARENA_HAVE_SHM
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+
+        // read the header to find out where and how large the segment is
+        Header* header = 0;
+        struct stat fileStat;
+        if (::fstat(fd, &fileStat) == 0 && static_cast<size_t>(fileStat.st_size) >= sizeof(Header)) {
+            void* addr = ::mmap(0, sizeof(Header), PROT_READ, MAP_SHARED, fd, 0);
+            if (addr != MAP_FAILED)
+                header = static_cast<Header*>(addr);
+        }
+
+        if (!header || std::memcmp(header->magic, "OPMARENA", sizeof(header->magic)) != 0
+            || header->ready.load(std::memory_order_acquire) == 0)
+        {
+            if (header)
+                ::munmap(header, sizeof(Header));
+            ::close(fd);
+            return false;
+        }
+
+        void* baseAddress = header->baseAddress;
+        size_t size = static_cast<size_t>(header->size);
+        ::munmap(header, sizeof(Header));
+
+        // map the segment at the address of the creating process. the address is only
+        // a hint, so we need to check whether the kernel honored it.
+        void* addr = ::mmap(baseAddress, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED)
+            return false;
+        if (addr != baseAddress) {
+            ::munmap(addr, size);
+            return false;
+        }
+
+        header_ = static_cast<Header*>(addr);
+        name_ = name;
+        isCreator_ = false;
+        mappedArenas_().push_back(this);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /*!
+     * \brief Unmap the segment.
+     *
+     * The segment itself continues to exist until remove() is called.
+     */
+    void detach()
+    {
+#if OPM_SHARED_MEMORY_ARENA_HAVE_SHM
+        if (header_) {
+            std::vector<const SharedMemoryArena*>& arenas = mappedArenas_();
+            arenas.erase(std::remove(arenas.begin(), arenas.end(), this), arenas.end());
+            ::munmap(header_, static_cast<size_t>(header_->size));
+        }
+#endif
+        header_ = 0;
+        isCreator_ = false;
+        name_.clear();
+    }
+
+    /*!
+     * \brief Remove a shared memory segment.
+     *
+     * Processes which are attached to the segment can continue to use it.
+     */
+    static void remove(const std::string& name)
+    {
+#if OPM_SHARED_MEMORY_ARENA_HAVE_SHM
+        ::shm_unlink(name.c_str());
+#endif
+    }
+
+    /*!
+     * \brief Returns true iff the arena was created by this process.
+     */
+    bool isCreator() const
+    { return isCreator_; }
+
+    /*!
+     * \brief Returns true iff a segment is mapped.
+     */
+    bool isValid() const
+    { return header_ != 0; }
+
+    /*!
+     * \brief Returns true iff a pointer points into the arena.
+     */
+    bool contains(const void* p) const
+    {
+        if (!header_)
+            return false;
+
+        const char* begin = reinterpret_cast<const char*>(header_);
+        const char* ptr = static_cast<const char*>(p);
+        return begin <= ptr && ptr < begin + header_->size;
+    }
+
+    /*!
+     * \brief Allocate memory from the arena.
+     *
+     * This is only possible for the process which created the arena and before the
+     * root object has been published. Memory is never given back to the arena.
+     */
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+    {
+        if (!isCreator_ || header_->ready.load(std::memory_order_relaxed))
+            OPM_THROW(std::logic_error, "Only the creator of a shared memory arena can allocate from it");
+
+        size_t offset = (static_cast<size_t>(header_->used) + alignment - 1)/alignment*alignment;
+        if (offset + size > header_->size)
+            throw std::bad_alloc();
+
+        header_->used = offset + size;
+        return reinterpret_cast<char*>(header_) + offset;
+    }
+
+    /*!
+     * \brief Construct an object inside the arena.
+     */
+    template <class T, class... Args>
+    T* construct(Args&&... args)
+    {
+        Scope scope(*this);
+        void* p = allocate(sizeof(T), alignof(T));
+        return new (p) T(std::forward<Args>(args)...);
+    }
+
+    /*!
+     * \brief Make the arena available to other processes.
+     *
+     * After this method was called, no more memory can be allocated.
+     *
+     * \param root The object from which the attaching processes reach all data in the
+     *             arena.
+     */
+    template <class T>
+    void publish(const T* root)
+    {
+        assert(isCreator_ && contains(root));
+        header_->root = const_cast<T*>(root);
+        header_->ready.store(1, std::memory_order_release);
+    }
+
+    /*!
+     * \brief Return the published root object of the arena.
+     */
+    template <class T>
+    const T* root() const
+    { return header_ ? static_cast<const T*>(header_->root) : 0; }
+
+    /*!
+     * \brief Return the number of bytes which are currently used.
+     */
+    size_t bytesUsed() const
+    { return header_ ? static_cast<size_t>(header_->used) : 0; }
+
+    /*!
+     * \brief The arena from which SharedMemoryAllocator currently allocates.
+     *
+     * If no Scope object exists, this is a null pointer.
+     */
+    static SharedMemoryArena* current()
+    { return current_(); }
+
+    /*!
+     * \brief Returns true iff a pointer points into any arena which is mapped by the
+     *        current process.
+     */
+    static bool isInAnyArena(const void* p)
+    {
+        const std::vector<const SharedMemoryArena*>& arenas = mappedArenas_();
+        for (size_t i = 0; i < arenas.size(); ++i)
+            if (arenas[i]->contains(p))
+                return true;
+        return false;
+    }
+
+private:
+    static size_t alignedSize_(size_t size)
+    { return (size + 63)/64*64; }
+
+    static SharedMemoryArena*& current_()
+    {
+        static SharedMemoryArena* arena = 0;
+        return arena;
+    }
+
+    static std::vector<const SharedMemoryArena*>& mappedArenas_()
+    {
+        static std::vector<const SharedMemoryArena*> arenas;
+        return arenas;
+    }
+
+    Header* header_;
+    bool isCreator_;
+    std::string name_;
+};
+
+/*!
+ * \brief A standard conforming allocator which allocates from the current
+ *        SharedMemoryArena.
+ *
+ * The allocator is stateless, so it has the same representation in all processes. If
+ * no arena is active (cf. SharedMemoryArena::Scope), it falls back to the heap. Memory
+ * which is located in a mapped arena is never freed. This allows to use the table classes
+ * (e.g., Tabulated1DFunction) inside shared memory segments.
+ */
+template <class T>
+class SharedMemoryAllocator
+{
+public:
+    typedef T value_type;
+
+    SharedMemoryAllocator()
+    {}
+
+    template <class U>
+    SharedMemoryAllocator(const SharedMemoryAllocator<U>&)
+    {}
+
+    T* allocate(size_t n)
+    {
+        if (n > std::numeric_limits<size_t>::max()/sizeof(T))
+            throw std::bad_alloc();
+
+        SharedMemoryArena* arena = SharedMemoryArena::current();
+        if (arena)
+            return static_cast<T*>(arena->allocate(n*sizeof(T), alignof(T)));
+        return static_cast<T*>(::operator new(n*sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t)
+    {
+        if (SharedMemoryArena::isInAnyArena(p))
+            return;
+        ::operator delete(p);
+    }
+
+    template <class U>
+    bool operator==(const SharedMemoryAllocator<U>&) const
+    { return true; }
+
+    template <class U>
+    bool operator!=(const SharedMemoryAllocator<U>&) const
+    { return false; }
+};
+
+} // namespace Opm
+
+#endif
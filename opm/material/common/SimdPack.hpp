@@ -0,0 +1,239 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Support for using packs of SIMD lanes as the scalar type of the material
+ *        framework.
+ *
+ * Instead of computing the quantities of a single degree of freedom, a pack type like
+ * std::experimental::native_simd<double> allows to compute them for several degrees of
+ * freedom at once: Each lane of the pack represents the value of a different degree of
+ * freedom. Packs can be used as scalars on their own or as the scalar type of the
+ * LocalAd::Evaluation class.
+ *
+ * The pack types of std::experimental are only available if the code is compiled in
+ * C++17 mode or newer and the standard library ships the <experimental/simd>
+ * header. In this case, the OPM_MATERIAL_HAVE_SIMD_PACK macro is set to 1. For all other
+ * configurations, only the traits for plain scalars are defined.
+ */
+#ifndef OPM_MATERIAL_SIMD_PACK_HPP
+#define OPM_MATERIAL_SIMD_PACK_HPP
+
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <algorithm>
+
+#if __cplusplus >= 201703L && defined __has_include
+#if __has_include(<experimental/simd>)
+#include <experimental/simd>
+#define OPM_MATERIAL_HAVE_SIMD_PACK 1
+#endif
+#endif
+
+namespace Opm {
+/*!
+ * \brief Provides information about whether a scalar type is a pack of SIMD lanes.
+ *
+ * For plain scalars, the pack consists of a single lane.
+ */
+template <class Scalar>
+struct SimdPackTraits
+{
+    static const bool isPack = false;
+    static const int width = 1;
+};
+
+/*!
+ * \brief Selects between two values depending on the result of a comparison.
+ *
+ * For plain scalars, the condition is a bool and either of the two values is chosen.
+ * For packs of SIMD lanes, the condition is a mask and the selection is done lane by
+ * lane. This allows code which needs to branch on the values of its arguments, e.g.,
+ * min() and max() of function evaluations, to be written without actual branches.
+ */
+template <class Condition>
+struct ConditionalSelect
+{
+    //! Returns ifTrue if the condition is met, else ifFalse
+    template <class Scalar>
+    static Scalar exec(const Condition& cond, const Scalar& ifTrue, const Scalar& ifFalse)
+    { return cond ? ifTrue : ifFalse; }
+
+    //! Copies the n entries of ifTrue or ifFalse to dest
+    template <class Scalar>
+    static void copy(const Condition& cond,
+                     Scalar* dest,
+                     const Scalar* ifTrue,
+                     const Scalar* ifFalse,
+                     int n)
+    {
+        const Scalar* src = cond ? ifTrue : ifFalse;
+        std::copy(src, src + n, dest);
+    }
+};
+
+/*!
+ * \brief Returns true if a condition is met for all lanes.
+ *
+ * This is mainly intended for assertions on the arguments of functions which may be
+ * called with SIMD packs.
+ */
+inline bool allTrue(bool cond)
+{ return cond; }
+
+#if OPM_MATERIAL_HAVE_SIMD_PACK
+template <class T, class Abi>
+bool allTrue(const std::experimental::simd_mask<T, Abi>& cond)
+{ return std::experimental::all_of(cond); }
+
+template <class T, class Abi>
+struct SimdPackTraits<std::experimental::simd<T, Abi> >
+{
+    static const bool isPack = true;
+    static const int width = std::experimental::simd_size<T, Abi>::value;
+};
+
+template <class T, class Abi>
+struct ConditionalSelect<std::experimental::simd_mask<T, Abi> >
+{
+    typedef std::experimental::simd_mask<T, Abi> Mask;
+    typedef std::experimental::simd<T, Abi> Pack;
+
+    static Pack exec(const Mask& cond, const Pack& ifTrue, const Pack& ifFalse)
+    {
+        Pack result = ifFalse;
+        std::experimental::where(cond, result) = ifTrue;
+        return result;
+    }
+
+    static void copy(const Mask& cond,
+                     Pack* dest,
+                     const Pack* ifTrue,
+                     const Pack* ifFalse,
+                     int n)
+    {
+        for (int i = 0; i < n; ++i)
+            dest[i] = exec(cond, ifTrue[i], ifFalse[i]);
+    }
+};
+
+// the value of an evaluation which uses packs as scalars is a pack, but the
+// "true,false" helper only applies to floating point left hand sides.
+template <class T, class Abi, class RhsEval>
+struct ToLhsEvalHelper<std::experimental::simd<T, Abi>, RhsEval, false, false>
+{
+    typedef std::experimental::simd<T, Abi> ResultType;
+
+    static ResultType exec(const RhsEval& eval)
+    { return eval.value; }
+};
+
+template <class T, class Abi>
+struct ToLhsEvalHelper<std::experimental::simd<T, Abi>, std::experimental::simd<T, Abi>, false, false>
+{
+    typedef const std::experimental::simd<T, Abi>& ResultType;
+
+    static ResultType exec(const std::experimental::simd<T, Abi>& eval)
+    { return eval; }
+};
+
+/*!
+ * \brief The math toolbox for packs of SIMD lanes.
+ *
+ * Like for plain scalars, no derivatives are considered, i.e., all functions are
+ * applied to each lane independently.
+ */
+template <class T, class Abi>
+struct MathToolbox<std::experimental::simd<T, Abi>, false>
+{
+    typedef std::experimental::simd<T, Abi> Scalar;
+    typedef std::experimental::simd<T, Abi> Evaluation;
+
+    static Scalar value(const Evaluation& eval)
+    { return eval; }
+
+    static Scalar createConstant(Scalar value)
+    { return value; }
+
+    static Scalar createVariable(Scalar value, int /* varIdx */)
+    { return value; }
+
+    template <class LhsEval>
+    static typename ToLhsEvalHelper<LhsEval, Evaluation>::ResultType toLhs(const Evaluation& eval)
+    { return ToLhsEvalHelper<LhsEval, Evaluation>::exec(eval); }
+
+    static Scalar passThroughOrCreateConstant(Scalar value)
+    { return value; }
+
+    // arithmetic functions
+    static Scalar max(const Scalar& arg1, const Scalar& arg2)
+    { return std::experimental::max(arg1, arg2); }
+
+    static Scalar min(const Scalar& arg1, const Scalar& arg2)
+    { return std::experimental::min(arg1, arg2); }
+
+    static Scalar abs(const Scalar& arg)
+    { return std::experimental::abs(arg); }
+
+    static Scalar tan(const Scalar& arg)
+    { return std::experimental::tan(arg); }
+
+    static Scalar atan(const Scalar& arg)
+    { return std::experimental::atan(arg); }
+
+    static Scalar atan2(const Scalar& arg1, const Scalar& arg2)
+    { return std::experimental::atan2(arg1, arg2); }
+
+    static Scalar sin(const Scalar& arg)
+    { return std::experimental::sin(arg); }
+
+    static Scalar asin(const Scalar& arg)
+    { return std::experimental::asin(arg); }
+
+    static Scalar cos(const Scalar& arg)
+    { return std::experimental::cos(arg); }
+
+    static Scalar acos(const Scalar& arg)
+    { return std::experimental::acos(arg); }
+
+    static Scalar sqrt(const Scalar& arg)
+    { return std::experimental::sqrt(arg); }
+
+    static Scalar exp(const Scalar& arg)
+    { return std::experimental::exp(arg); }
+
+    static Scalar log(const Scalar& arg)
+    { return std::experimental::log(arg); }
+
+    static Scalar pow(const Scalar& base, const Scalar& exp)
+    { return std::experimental::pow(base, exp); }
+
+    template <class IntType>
+    static typename std::enable_if<std::is_integral<IntType>::value, Scalar>::type
+    pow(const Scalar& base, IntType exp)
+    { return integerPow(base, static_cast<int>(exp)); }
+};
+#endif // OPM_MATERIAL_HAVE_SIMD_PACK
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,175 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::SmallLuDecomposition
+ */
+#ifndef OPM_SMALL_LU_DECOMPOSITION_HPP
+#define OPM_SMALL_LU_DECOMPOSITION_HPP
+
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <dune/common/fmatrix.hh>
+
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+namespace Opm {
+
+/*!
+ * \brief LU decomposition with partial pivoting of a small dense matrix whose size
+ *        is known at compile time.
+ *
+ * The loop over the elimination steps as well as the loops of the forward and the
+ * backward substitution are unrolled using templates, so the compiler generates
+ * straight-line code for each matrix size. The factorization is always done on the
+ * values of the matrix entries, i.e., if the matrix is made of function evaluations,
+ * their derivatives are ignored. The right hand sides can be function evaluations,
+ * though: For the Newton methods of the constraint solvers this yields the same
+ * derivatives of the solution once the iteration is converged, but it avoids to
+ * carry the derivatives through the elimination.
+ *
+ * \tparam Scalar The type used for scalar values
+ * \tparam n The number of rows and columns of the matrix
+ */
+template <class Scalar, int n>
+class SmallLuDecomposition
+{
+    template <int k>
+    using Step_ = std::integral_constant<int, k>;
+
+public:
+    /*!
+     * \brief Compute the decomposition of a matrix.
+     *
+     * \param A The matrix. Only the values of its entries are used.
+     * \param singularLimit The minimum absolute value of a pivot element
+     *
+     * \return false if the matrix is singular. In this case the decomposition must
+     *         not be used for solving.
+     */
+    template <class Evaluation>
+    bool factorize(const Dune::FieldMatrix<Evaluation, n, n>& A, Scalar singularLimit)
+    {
+        typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+        for (int i = 0; i < n; ++i) {
+            perm_[i] = i;
+            for (int j = 0; j < n; ++j)
+                lu_[i][j] = Toolbox::value(A[i][j]);
+        }
+
+        return eliminate_(Step_<0>(), singularLimit);
+    }
+
+    /*!
+     * \brief Solve the system for a right hand side using the decomposition.
+     *
+     * \param x The vector which receives the solution. It must not be the same
+     *          object as b.
+     * \param b The right hand side
+     */
+    template <class XVector, class BVector>
+    void solve(XVector& x, const BVector& b) const
+    {
+        forward_(Step_<0>(), x, b);
+        backward_(Step_<n - 1>(), x);
+    }
+
+private:
+    // elimination step k: find the pivot of column k, swap it into the k-th row and
+    // eliminate the entries of column k below it. the multipliers are stored in the
+    // lower triangle.
+    template <int k>
+    bool eliminate_(Step_<k>, Scalar singularLimit)
+    {
+        int pivotIdx = k;
+        Scalar pivotAbs = std::abs(lu_[k][k]);
+        for (int i = k + 1; i < n; ++i) {
+            Scalar tmp = std::abs(lu_[i][k]);
+            if (tmp > pivotAbs) {
+                pivotAbs = tmp;
+                pivotIdx = i;
+            }
+        }
+
+        if (!(pivotAbs > singularLimit))
+            return false;
+
+        if (pivotIdx != k) {
+            for (int j = 0; j < n; ++j)
+                std::swap(lu_[k][j], lu_[pivotIdx][j]);
+            std::swap(perm_[k], perm_[pivotIdx]);
+        }
+
+        invDiag_[k] = 1.0/lu_[k][k];
+        for (int i = k + 1; i < n; ++i) {
+            const Scalar factor = lu_[i][k]*invDiag_[k];
+            lu_[i][k] = factor;
+            for (int j = k + 1; j < n; ++j)
+                lu_[i][j] -= factor*lu_[k][j];
+        }
+
+        return eliminate_(Step_<k + 1>(), singularLimit);
+    }
+
+    bool eliminate_(Step_<n>, Scalar)
+    { return true; }
+
+    // forward substitution for row i, i.e., L*y = P*b. y is stored in x.
+    template <int i, class XVector, class BVector>
+    void forward_(Step_<i>, XVector& x, const BVector& b) const
+    {
+        x[i] = b[perm_[i]];
+        for (int j = 0; j < i; ++j)
+            x[i] -= lu_[i][j]*x[j];
+
+        forward_(Step_<i + 1>(), x, b);
+    }
+
+    template <class XVector, class BVector>
+    void forward_(Step_<n>, XVector&, const BVector&) const
+    {}
+
+    // backward substitution for row i, i.e., U*x = y
+    template <int i, class XVector>
+    void backward_(Step_<i>, XVector& x) const
+    {
+        for (int j = i + 1; j < n; ++j)
+            x[i] -= lu_[i][j]*x[j];
+        x[i] *= invDiag_[i];
+
+        backward_(Step_<i - 1>(), x);
+    }
+
+    template <class XVector>
+    void backward_(Step_<-1>, XVector&) const
+    {}
+
+    Scalar lu_[n][n];
+    Scalar invDiag_[n];
+    int perm_[n];
+};
+
+} // namespace Opm
+
+#endif
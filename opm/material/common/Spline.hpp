@@ -28,7 +28,11 @@
 #include <opm/material/common/TridiagonalMatrix.hpp>
 #include <opm/material/common/PolynomialUtils.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/TableHash.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
 #include <ostream>
 #include <vector>
 #include <tuple>
@@ -256,6 +260,28 @@ public:
     int numSamples() const
     { return xPos_.size(); }
 
+    /*!
+     * \brief Returns true iff two splines use the same sampling points and
+     *        coefficients.
+     */
+    bool operator==(const Spline& other) const
+    {
+        return
+            xPos_ == other.xPos_
+            && yPos_ == other.yPos_
+            && slopeVec_ == other.slopeVec_
+            && coeffs_ == other.coeffs_;
+    }
+
+    bool operator!=(const Spline& other) const
+    { return !operator==(other); }
+
+    /*!
+     * \brief Returns a hash value of the sampling points, cf. Opm::TableRegistry.
+     */
+    size_t contentHash() const
+    { return hashValues(hashValues(0, xPos_), yPos_); }
+
     /*!
      * \brief Set the sampling points and the boundary slopes of the
      *        spline with two sampling points.
@@ -300,6 +326,7 @@ public:
         M.solve(moments, d);
 
         this->setSlopesFromMoments_(slopeVec_, moments);
+        updateCoefficients_();
     }
 
 
@@ -538,6 +565,108 @@ public:
             this->makeMonotonicSpline_(slopeVec_);
         else
             OPM_THROW(std::runtime_error, "Spline type " << splineType << " not supported at this place");
+
+        updateCoefficients_();
+    }
+
+    /*!
+     * \brief Set the sampling points of a family of splines which share the same
+     *        positions on the abscissa.
+     *
+     * This is equivalent to calling setXYArrays() for each spline, but the linear
+     * system of equations for natural and periodic splines only depends on the
+     * positions and is thus decomposed only once. It is then solved for the
+     * right hand sides of all splines at the same time, see
+     * TridiagonalFactorization::solveBatch(). If OpenMP is enabled, the remaining
+     * per-spline work is done in parallel.
+     *
+     * \param splines The array of splines which ought to be set
+     * \param numSplines The number of splines
+     * \param nSamples The number of sampling points of each spline (must be > 1)
+     * \param x The positions of the sampling points on the abscissa. These must be
+     *          sorted, either in ascending or in descending order.
+     * \param y The values of the sampling points. The value of the i-th sampling
+     *          point of the k-th spline is located at y[k*nSamples + i].
+     * \param splineType The type of all splines
+     */
+    static void setXYArraysBatch(Spline *splines,
+                                 int numSplines,
+                                 int nSamples,
+                                 const Scalar *x,
+                                 const Scalar *y,
+                                 SplineType splineType = Natural)
+    {
+        assert(nSamples > 1);
+        if (splineType != Natural && splineType != Periodic && splineType != Monotonic)
+            OPM_THROW(std::runtime_error, "Spline type " << splineType << " not supported at this place");
+        if (numSplines == 0)
+            return;
+
+#ifdef _OPENMP
+        #pragma omp parallel for
+#endif
+        for (int k = 0; k < numSplines; ++k) {
+            Spline &sp = splines[k];
+            sp.setNumSamples_(nSamples);
+            for (int i = 0; i < nSamples; ++i) {
+                sp.xPos_[i] = x[i];
+                sp.yPos_[i] = y[k*nSamples + i];
+            }
+            if (sp.xPos_[0] > sp.xPos_[nSamples - 1])
+                sp.reverseSamplingPoints_();
+
+            if (splineType == Monotonic) {
+                sp.makeMonotonicSpline_(sp.slopeVec_);
+                sp.updateCoefficients_();
+            }
+        }
+
+        if (splineType == Monotonic)
+            return;
+
+        // set up the right hand sides of all splines. they are stored in row-major
+        // order, i.e., the entries of all splines for a given row are contiguous
+        size_t numRows = (splineType == Periodic)?(nSamples - 1):nSamples;
+        TridiagonalFactorization<Scalar> factorization;
+        std::vector<Scalar> rhs(numRows*numSplines);
+        {
+            Matrix M(numRows);
+            Vector d(numRows);
+            for (int k = 0; k < numSplines; ++k) {
+                if (splineType == Periodic)
+                    splines[k].makePeriodicSystem_(M, d);
+                else
+                    splines[k].makeNaturalSystem_(M, d);
+
+                if (k == 0)
+                    factorization.factorize(M);
+                for (size_t i = 0; i < numRows; ++i)
+                    rhs[i*numSplines + k] = d[i];
+            }
+        }
+
+        // solve for the moments of all splines
+        factorization.solveBatch(rhs.data(), rhs.data(), numSplines);
+
+#ifdef _OPENMP
+        #pragma omp parallel for
+#endif
+        for (int k = 0; k < numSplines; ++k) {
+            Vector moments(nSamples);
+            if (splineType == Periodic) {
+                for (int i = 0; i < nSamples - 1; ++i)
+                    moments[i + 1] = rhs[i*numSplines + k];
+                moments[0] = moments[nSamples - 1];
+            }
+            else {
+                for (int i = 0; i < nSamples; ++i)
+                    moments[i] = rhs[i*numSplines + k];
+            }
+
+            Spline &sp = splines[k];
+            sp.setSlopesFromMoments_(sp.slopeVec_, moments);
+            sp.updateCoefficients_();
+        }
     }
 
     /*!
@@ -577,6 +706,8 @@ public:
             this->makeMonotonicSpline_(slopeVec_);
         else
             OPM_THROW(std::runtime_error, "Spline type " << splineType << " not supported at this place");
+
+        updateCoefficients_();
     }
 
     /*!
@@ -620,6 +751,8 @@ public:
             this->makeMonotonicSpline_(slopeVec_);
         else
             OPM_THROW(std::runtime_error, "Spline type " << splineType << " not supported at this place");
+
+        updateCoefficients_();
     }
 
     /*!
@@ -663,6 +796,8 @@ public:
             this->makeMonotonicSpline_(slopeVec_);
         else
             OPM_THROW(std::runtime_error, "Spline type " << splineType << " not supported at this place");
+
+        updateCoefficients_();
     }
 
     /*!
@@ -706,6 +841,8 @@ public:
             this->makeMonotonicSpline_(slopeVec_);
         else
             OPM_THROW(std::runtime_error, "Spline type " << splineType << " not supported at this place");
+
+        updateCoefficients_();
     }
 
     /*!
@@ -859,6 +996,42 @@ public:
         return eval_(x, segmentIdx_(x.value));
     }
 
+    /*!
+     * \brief Evaluate the spline for a batch of positions.
+     *
+     * This is equivalent to calling eval() for each entry of the x array, but the
+     * segment search is skipped if a position is located in the same segment as the
+     * previous one. If the positions are sorted or clustered, this makes the
+     * evaluation little more than a Horner scheme per entry.
+     *
+     * \param x The array of positions on the abscissa where the spline ought to be
+     *          evaluated
+     * \param y The array in which the results are stored. It must be able to hold at
+     *          least n entries.
+     * \param n The number of positions which ought to be evaluated
+     * \param extrapolate If this parameter is set to true, the spline
+     *                    will be extended beyond its range by
+     *                    straight lines, if false calling extrapolate
+     *                    for \f$ x \not [x_{min}, x_{max}]\f$ will
+     *                    cause a failed assertation.
+     */
+    void evalBatch(const Scalar* x, Scalar* y, size_t n, bool extrapolate=false) const
+    {
+        int segIdx = 0;
+        for (size_t i = 0; i < n; ++i) {
+            Scalar xi = x[i];
+            if (extrapolate && (xi < xMin() || xi > xMax())) {
+                y[i] = eval(xi, /*extrapolate=*/true);
+                continue;
+            }
+            assert(applies(xi));
+
+            if (!(x_(segIdx) <= xi && xi <= x_(segIdx + 1)))
+                segIdx = segmentIdx_(xi);
+            y[i] = eval_(xi, segIdx);
+        }
+    }
+
     /*!
      * \brief Evaluate the spline's derivative at a given position.
      *
@@ -1140,10 +1313,12 @@ protected:
         this->makeFullSystem_(M, d, m0, m1);
 
         // solve for the moments (-> second derivatives)
-        M.solve(moments, d);
+        solveForMoments_(moments, M, d, Full);
 
         // convert the moments to slopes at the sample points
         this->setSlopesFromMoments_(slopeVec_, moments);
+
+        updateCoefficients_();
     }
 
     /*!
@@ -1161,7 +1336,7 @@ protected:
         this->makeNaturalSystem_(M, d);
 
         // solve for the moments (-> second derivatives)
-        M.solve(moments, d);
+        solveForMoments_(moments, M, d, Natural);
 
         // convert the moments to slopes at the sample points
         this->setSlopesFromMoments_(slopeVec_, moments);
@@ -1185,7 +1360,7 @@ protected:
         this->makePeriodicSystem_(M, d);
 
         // solve for the moments (-> second derivatives)
-        M.solve(moments, d);
+        solveForMoments_(moments, M, d, Periodic);
 
         moments.resize(numSamples());
         for (int i = numSamples() - 2; i >= 0; --i)
@@ -1465,6 +1640,25 @@ protected:
         }
     }
 
+    /*!
+     * \brief Solve the linear system of equations for the moments.
+     *
+     * The matrix only depends on the positions of the sampling points and the type of
+     * the spline. If the spline is set up repeatedly for the same positions, e.g.,
+     * because only the values change, the LU decomposition of the previous call is
+     * thus reused.
+     */
+    void solveForMoments_(Vector &moments, const Matrix &M, const Vector &d, SplineType splineType)
+    {
+        if (factorizedX_.empty() || factorizedSplineType_ != splineType || factorizedX_ != xPos_) {
+            factorization_.factorize(M);
+            factorizedX_ = xPos_;
+            factorizedSplineType_ = splineType;
+        }
+
+        factorization_.solve(moments, d);
+    }
+
     /*!
      * \brief Convert the moments at the sample points to slopes.
      *
@@ -1525,19 +1719,38 @@ protected:
     }
 
 
+    // calculate the coefficients of the polynomials of all segments in the
+    // power basis w.r.t. the left sampling point of the segment from the values
+    // and slopes at the sampling points, i.e.
+    //
+    // s(x) = ((c3*t + c2)*t + c1)*t + c0 with t = x - x_i
+    //
+    // this avoids re-evaluating the Hermite basis functions at each evaluation
+    void updateCoefficients_()
+    {
+        int n = numSamples();
+        coeffs_.resize(4*std::max(n - 1, 0));
+        for (int i = 0; i < n - 1; ++i) {
+            Scalar h = h_(i + 1);
+            Scalar secant = (y_(i + 1) - y_(i))/h;
+            Scalar m0 = slope_(i);
+            Scalar m1 = slope_(i + 1);
+
+            Scalar *c = &coeffs_[4*i];
+            c[0] = y_(i);
+            c[1] = m0;
+            c[2] = (3*secant - 2*m0 - m1)/h;
+            c[3] = (m0 + m1 - 2*secant)/(h*h);
+        }
+    }
+
     // evaluate the spline at a given the position and given the
     // segment index
     Scalar eval_(Scalar x, int i) const
     {
-        // See http://en.wikipedia.org/wiki/Cubic_Hermite_spline
-        Scalar delta = h_(i + 1);
-        Scalar t = (x - x_(i))/delta;
-
-        return
-            h00_(t) * y_(i)
-            + h10_(t) * slope_(i)*delta
-            + h01_(t) * y_(i + 1)
-            + h11_(t) * slope_(i + 1)*delta;
+        const Scalar *c = &coeffs_[4*i];
+        Scalar t = x - x_(i);
+        return ((c[3]*t + c[2])*t + c[1])*t + c[0];
     }
 
     // evaluate the spline at a given the position and given the
@@ -1545,18 +1758,13 @@ protected:
     template <class Evaluation>
     Evaluation eval_(const Evaluation& x, int i) const
     {
-        // See http://en.wikipedia.org/wiki/Cubic_Hermite_spline
-        Scalar delta = h_(i + 1);
-        Scalar t = (x.value - x_(i))/delta;
+        const Scalar *c = &coeffs_[4*i];
+        Scalar t = x.value - x_(i);
 
         Evaluation result;
-        result.value =
-            h00_(t) * y_(i)
-            + h10_(t) * slope_(i)*delta
-            + h01_(t) * y_(i + 1)
-            + h11_(t) * slope_(i + 1)*delta;
+        result.value = ((c[3]*t + c[2])*t + c[1])*t + c[0];
 
-        Scalar df_dg = evalDerivative_(x.value, i);
+        Scalar df_dg = (3*c[3]*t + 2*c[2])*t + c[1];
         for (unsigned varIdx = 0; varIdx < result.derivatives.size(); ++ varIdx)
             result.derivatives[varIdx] = df_dg*x.derivatives[varIdx];
 
@@ -1567,104 +1775,24 @@ protected:
     // and the segment index
     Scalar evalDerivative_(Scalar x, int i) const
     {
-        // See http://en.wikipedia.org/wiki/Cubic_Hermite_spline
-        Scalar delta = h_(i + 1);
-        Scalar t = (x - x_(i))/delta;
-        Scalar alpha = 1 / delta;
-
-        return
-            alpha *
-            (h00_prime_(t) * y_(i)
-             + h10_prime_(t) * slope_(i)*delta
-             + h01_prime_(t) * y_(i + 1)
-             + h11_prime_(t) * slope_(i + 1)*delta);
+        const Scalar *c = &coeffs_[4*i];
+        Scalar t = x - x_(i);
+        return (3*c[3]*t + 2*c[2])*t + c[1];
     }
 
     // evaluate the second derivative of a spline given the actual
     // position and the segment index
     Scalar evalDerivative2_(Scalar x, int i) const
     {
-        // See http://en.wikipedia.org/wiki/Cubic_Hermite_spline
-        Scalar delta = h_(i + 1);
-        Scalar t = (x - x_(i))/delta;
-        Scalar alpha = 1 / delta;
-
-        return
-            alpha*alpha
-            *(h00_prime2_(t) * y_(i)
-              + h10_prime2_(t) * slope_(i)*delta
-              + h01_prime2_(t) * y_(i + 1)
-              + h11_prime2_(t) * slope_(i + 1)*delta);
+        const Scalar *c = &coeffs_[4*i];
+        Scalar t = x - x_(i);
+        return 6*c[3]*t + 2*c[2];
     }
 
     // evaluate the third derivative of a spline given the actual
     // position and the segment index
-    Scalar evalDerivative3_(Scalar x, int i) const
-    {
-        // See http://en.wikipedia.org/wiki/Cubic_Hermite_spline
-        Scalar delta = h_(i + 1);
-        Scalar t = (x - x_(i))/delta;
-        Scalar alpha = 1 / delta;
-
-        return
-            alpha*alpha*alpha
-            *(h00_prime3_(t)*y_(i)
-              + h10_prime3_(t)*slope_(i)*delta
-              + h01_prime3_(t)*y_(i + 1)
-              + h11_prime3_(t)*slope_(i + 1)*delta);
-    }
-
-    // hermite basis functions
-    Scalar h00_(Scalar t) const
-    { return (2*t - 3)*t*t + 1; }
-
-    Scalar h10_(Scalar t) const
-    { return ((t - 2)*t + 1)*t; }
-
-    Scalar h01_(Scalar t) const
-    { return (-2*t + 3)*t*t; }
-
-    Scalar h11_(Scalar t) const
-    { return (t - 1)*t*t; }
-
-    // first derivative of the hermite basis functions
-    Scalar h00_prime_(Scalar t) const
-    { return (3*2*t - 2*3)*t; }
-
-    Scalar h10_prime_(Scalar t) const
-    { return (3*t - 2*2)*t + 1; }
-
-    Scalar h01_prime_(Scalar t) const
-    { return (-3*2*t + 2*3)*t; }
-
-    Scalar h11_prime_(Scalar t) const
-    { return (3*t - 2)*t; }
-
-    // second derivative of the hermite basis functions
-    Scalar h00_prime2_(Scalar t) const
-    { return 2*3*2*t - 2*3; }
-
-    Scalar h10_prime2_(Scalar t) const
-    { return 2*3*t - 2*2; }
-
-    Scalar h01_prime2_(Scalar t) const
-    { return -2*3*2*t + 2*3; }
-
-    Scalar h11_prime2_(Scalar t) const
-    { return 2*3*t - 2; }
-
-    // third derivative of the hermite basis functions
-    Scalar h00_prime3_(Scalar /*t*/) const
-    { return 2*3*2; }
-
-    Scalar h10_prime3_(Scalar /*t*/) const
-    { return 2*3; }
-
-    Scalar h01_prime3_(Scalar /*t*/) const
-    { return -2*3*2; }
-
-    Scalar h11_prime3_(Scalar /*t*/) const
-    { return 2*3; }
+    Scalar evalDerivative3_(Scalar /* x */, int i) const
+    { return 6*coeffs_[4*i + 3]; }
 
     // returns the monotonicality of an interval of a spline segment
     //
@@ -1676,10 +1804,13 @@ protected:
     // -1: spline is monotonously decreasing in the specified interval
     int monotonic_(int i, Scalar x0, Scalar x1, int &r) const
     {
-        // coefficients of derivative in monomial basis
-        Scalar a = 3*a_(i);
-        Scalar b = 2*b_(i);
-        Scalar c = c_(i);
+        // coefficients of derivative in monomial basis. to avoid cancellation, these
+        // are w.r.t. the left sampling point of the segment
+        Scalar a = 3*coeffs_[4*i + 3];
+        Scalar b = 2*coeffs_[4*i + 2];
+        Scalar c = coeffs_[4*i + 1];
+        x0 -= x_(i);
+        x1 -= x_(i);
 
         if (std::abs(a) < 1e-20 && std::abs(b) < 1e-20 && std::abs(c) < 1e-20)
             return 3; // constant in interval, r stays unchanged!
@@ -1838,6 +1969,14 @@ protected:
     Vector xPos_;
     Vector yPos_;
     Vector slopeVec_;
+
+    // the coefficients of the segment polynomials, see updateCoefficients_()
+    Vector coeffs_;
+
+    // the LU decomposition for the most recent sampling points, see solveForMoments_()
+    Opm::TridiagonalFactorization<Scalar> factorization_;
+    Vector factorizedX_;
+    SplineType factorizedSplineType_;
 };
 }
 
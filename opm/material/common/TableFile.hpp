@@ -0,0 +1,380 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::TableFile
+ */
+#ifndef OPM_TABLE_FILE_HPP
+#define OPM_TABLE_FILE_HPP
+
+#include <opm/material/common/ErrorMacros.hpp>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#if defined __unix__ || defined __APPLE__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define OPM_TABLE_FILE_HAVE_MMAP 1
+#endif
+
+namespace Opm {
+/*!
+ * \brief A versioned and checksummed binary file which stores a set of arrays.
+ *
+ * The file is identified by a key which the user must choose such that it uniquely
+ * describes the data, e.g., by concatenating the name of the tabulated quantity with
+ * the ranges and resolutions of the table. When a file is opened, the key, the format
+ * version, the byte order and the checksum are verified. If any of these do not match,
+ * the file is treated as if it did not exist.
+ *
+ * The arrays are stored contiguously and each of them starts at an offset which is a
+ * multiple of 64 bytes. This means that the file can be mapped into memory and used
+ * in-place. On POSIX systems, this is done if requested, which allows all processes on
+ * a node to share a single physical copy of the data.
+ *
+ * Files are written to a uniquely named temporary file which is atomically renamed,
+ * so readers never see partially written files and concurrent writers of the same
+ * file do not interfere.
+ */
+class TableFile
+{
+    enum { formatVersion = 1 };
+    enum { alignment = 64 };
+    static const uint32_t byteOrderMark = 0x01020304;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrderMark;
+        uint64_t keySize;
+        uint64_t numArrays;
+        uint64_t checksum;
+    };
+
+public:
+    TableFile()
+        : mappedData_(0)
+        , mappedSize_(0)
+    {}
+
+    ~TableFile()
+    { close(); }
+
+    TableFile(const TableFile&) = delete;
+    TableFile& operator=(const TableFile&) = delete;
+
+    /*!
+     * \brief Write a set of arrays to a file.
+     *
+     * An exception is thrown if the file cannot be written.
+     *
+     * \param fileName The name of the file
+     * \param key The string which identifies the contents of the file
+     * \param arrays Pointers to the data of the arrays
+     * \param sizes The sizes of the arrays in bytes
+     */
+    static void write(const std::string& fileName,
+                      const std::string& key,
+                      const std::vector<const void*>& arrays,
+                      const std::vector<size_t>& sizes)
+    {
+        if (arrays.size() != sizes.size())
+            OPM_THROW(std::logic_error, "The number of arrays and array sizes must be the same");
+
+        // assemble everything which follows the header
+        std::vector<uint64_t> offsets(arrays.size());
+        size_t pos = alignedSize_(sizeof(Header) + key.size() + 2*sizeof(uint64_t)*arrays.size());
+        for (size_t i = 0; i < arrays.size(); ++i) {
+            offsets[i] = pos;
+            pos = alignedSize_(pos + sizes[i]);
+        }
+
+        std::vector<char> buffer(pos, 0);
+        char* dest = buffer.data() + sizeof(Header);
+        std::memcpy(dest, key.data(), key.size());
+        dest += key.size();
+        for (size_t i = 0; i < arrays.size(); ++i) {
+            uint64_t entry[2] = { offsets[i], sizes[i] };
+            std::memcpy(dest, entry, sizeof(entry));
+            dest += sizeof(entry);
+
+            std::memcpy(buffer.data() + offsets[i], arrays[i], sizes[i]);
+        }
+
+        Header header;
+        std::memcpy(header.magic, "OPMTABLE", sizeof(header.magic));
+        header.version = formatVersion;
+        header.byteOrderMark = byteOrderMark;
+        header.keySize = key.size();
+        header.numArrays = arrays.size();
+        header.checksum = checksum_(buffer.data() + sizeof(Header), buffer.size() - sizeof(Header));
+        std::memcpy(buffer.data(), &header, sizeof(header));
+
+        // the temporary file gets a unique name in the directory of the target file.
+        // this makes sure that concurrent writers of the same file, e.g., the
+        // processes of a parallel run, do not clobber each other's temporary files and
+        // that the file can be renamed atomically.
+        std::string tmpFileName = writeTemporaryFile_(fileName, buffer);
+        if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+            std::remove(tmpFileName.c_str());
+            OPM_THROW(std::runtime_error, "Could not rename '" << tmpFileName << "' to '" << fileName << "'");
+        }
+    }
+
+    /*!
+     * \brief Open a table file.
+     *
+     * \param fileName The name of the file
+     * \param key The string which is expected to identify the contents of the file
+     * \param map If true, map the file into memory instead of reading it. This is only
+     *            possible on POSIX systems; on others the file is always read.
+     *
+     * \return false if the file does not exist, is corrupted or was written using a
+     *         different key, true otherwise.
+     */
+    bool open(const std::string& fileName, const std::string& key, bool map = false)
+    {
+        close();
+
+        const char* data = 0;
+        size_t size = 0;
+#if OPM_TABLE_FILE_HAVE_MMAP
+        if (map) {
+            int fd = ::open(fileName.c_str(), O_RDONLY);
+            if (fd < 0)
+                return false;
+
+            struct stat fileStat;
+            if (::fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+                void* p = ::mmap(0, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+                if (p != MAP_FAILED) {
+                    mappedData_ = p;
+                    mappedSize_ = static_cast<size_t>(fileStat.st_size);
+                }
+            }
+            ::close(fd);
+
+            if (!mappedData_)
+                return false;
+            data = static_cast<const char*>(mappedData_);
+            size = mappedSize_;
+        }
+#endif
+        if (!data) {
+            std::ifstream is(fileName.c_str(), std::ios::binary);
+            if (!is)
+                return false;
+            is.seekg(0, std::ios::end);
+            std::streamoff fileSize = is.tellg();
+            if (fileSize <= 0)
+                return false;
+            is.seekg(0, std::ios::beg);
+
+            // use a buffer of 64 bit integers so that the arrays are properly aligned
+            buffer_.resize((static_cast<size_t>(fileSize) + sizeof(uint64_t) - 1)/sizeof(uint64_t));
+            is.read(reinterpret_cast<char*>(buffer_.data()), fileSize);
+            if (!is) {
+                close();
+                return false;
+            }
+            data = reinterpret_cast<const char*>(buffer_.data());
+            size = static_cast<size_t>(fileSize);
+        }
+
+        if (!verify_(data, size, key)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    /*!
+     * \brief Release the contents of the file.
+     *
+     * All pointers which were returned by array() become invalid.
+     */
+    void close()
+    {
+#if OPM_TABLE_FILE_HAVE_MMAP
+        if (mappedData_)
+            ::munmap(mappedData_, mappedSize_);
+#endif
+        mappedData_ = 0;
+        mappedSize_ = 0;
+        buffer_.clear();
+        arrays_.clear();
+        sizes_.clear();
+    }
+
+    /*!
+     * \brief Returns true iff the data of the file is mapped into memory.
+     */
+    bool isMapped() const
+    { return mappedData_ != 0; }
+
+    /*!
+     * \brief Return the number of arrays stored in the file.
+     */
+    size_t numArrays() const
+    { return arrays_.size(); }
+
+    /*!
+     * \brief Return the size of an array in bytes.
+     */
+    size_t arraySize(size_t arrayIdx) const
+    { return sizes_[arrayIdx]; }
+
+    /*!
+     * \brief Return a pointer to the data of an array.
+     *
+     * The pointer stays valid until the object is closed or destroyed.
+     */
+    const void* array(size_t arrayIdx) const
+    { return arrays_[arrayIdx]; }
+
+private:
+    bool verify_(const char* data, size_t size, const std::string& key)
+    {
+        if (size < sizeof(Header))
+            return false;
+
+        Header header;
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, "OPMTABLE", sizeof(header.magic)) != 0
+            || header.version != formatVersion
+            || header.byteOrderMark != byteOrderMark
+            || header.keySize != key.size())
+            return false;
+
+        size_t dirEnd = sizeof(Header) + key.size() + 2*sizeof(uint64_t)*header.numArrays;
+        if (header.numArrays > size || dirEnd > size)
+            return false;
+        if (std::memcmp(data + sizeof(Header), key.data(), key.size()) != 0)
+            return false;
+        if (checksum_(data + sizeof(Header), size - sizeof(Header)) != header.checksum)
+            return false;
+
+        const char* dir = data + sizeof(Header) + key.size();
+        for (uint64_t i = 0; i < header.numArrays; ++i) {
+            uint64_t entry[2];
+            std::memcpy(entry, dir + i*sizeof(entry), sizeof(entry));
+            if (entry[0] > size || entry[1] > size - entry[0]) {
+                arrays_.clear();
+                sizes_.clear();
+                return false;
+            }
+            arrays_.push_back(data + entry[0]);
+            sizes_.push_back(static_cast<size_t>(entry[1]));
+        }
+
+        return true;
+    }
+
+    static size_t alignedSize_(size_t size)
+    { return (size + alignment - 1)/alignment*alignment; }
+
+    // write the contents of a file to a new temporary file next to it and return the
+    // name of the temporary file
+    static std::string writeTemporaryFile_(const std::string& fileName,
+                                           const std::vector<char>& buffer)
+    {
+#if OPM_TABLE_FILE_HAVE_MMAP
+        std::vector<char> tmpFileName(fileName.begin(), fileName.end());
+        const char suffix[] = ".tmpXXXXXX";
+        tmpFileName.insert(tmpFileName.end(), suffix, suffix + sizeof(suffix));
+        int fd = ::mkstemp(tmpFileName.data());
+        if (fd < 0)
+            OPM_THROW(std::runtime_error,
+                      "Could not create a temporary file for table file '" << fileName << "'");
+
+        // mkstemp() only grants access to the owner, but the file is intended to be
+        // shared
+        bool ok = ::fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) == 0;
+        const char* data = buffer.data();
+        size_t remaining = buffer.size();
+        while (ok && remaining > 0) {
+            ssize_t n = ::write(fd, data, remaining);
+            if (n < 0)
+                ok = false;
+            else {
+                data += n;
+                remaining -= static_cast<size_t>(n);
+            }
+        }
+        ok = (::close(fd) == 0) && ok;
+        if (!ok) {
+            ::unlink(tmpFileName.data());
+            OPM_THROW(std::runtime_error, "Could not write table file '" << tmpFileName.data() << "'");
+        }
+        return tmpFileName.data();
+#else
+        // without mkstemp(), a random suffix makes collisions unlikely
+        std::random_device randomDevice;
+        std::ostringstream oss;
+        oss << fileName << ".tmp" << std::hex << randomDevice() << randomDevice();
+        std::string tmpFileName = oss.str();
+        {
+            std::ofstream os(tmpFileName.c_str(), std::ios::binary | std::ios::trunc);
+            os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            if (!os) {
+                os.close();
+                std::remove(tmpFileName.c_str());
+                OPM_THROW(std::runtime_error, "Could not write table file '" << tmpFileName << "'");
+            }
+        }
+        return tmpFileName;
+#endif
+    }
+
+    // 64 bit FNV-1a hash
+    static uint64_t checksum_(const char* data, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    void* mappedData_;
+    size_t mappedSize_;
+    std::vector<uint64_t> buffer_;
+    std::vector<const void*> arrays_;
+    std::vector<size_t> sizes_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,60 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Helper functions to compute hash values of the contents of tables.
+ *
+ * The tables which can be deduplicated by Opm::TableRegistry provide a contentHash()
+ * method which combines the hash values of their sampling points using these
+ * functions.
+ */
+#ifndef OPM_TABLE_HASH_HPP
+#define OPM_TABLE_HASH_HPP
+
+#include <cstddef>
+#include <functional>
+
+namespace Opm {
+/*!
+ * \brief Combines a hash value with the hash value of an additional object.
+ *
+ * This uses the same mixing function as boost::hash_combine().
+ */
+template <class T>
+inline size_t hashCombine(size_t seed, const T& value)
+{ return seed ^ (std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2)); }
+
+/*!
+ * \brief Combines a hash value with the hash values of all entries of a container as
+ *        well as its size.
+ */
+template <class Container>
+inline size_t hashValues(size_t seed, const Container& values)
+{
+    seed = hashCombine(seed, values.size());
+    for (const auto& value : values)
+        seed = hashCombine(seed, value);
+    return seed;
+}
+} // namespace Opm
+
+#endif
@@ -0,0 +1,163 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::TableRegistry
+ */
+#ifndef OPM_TABLE_REGISTRY_HPP
+#define OPM_TABLE_REGISTRY_HPP
+
+#include <opm/material/common/TableHash.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace Opm {
+/*!
+ * \brief A process-wide registry which makes sure that identical tables are only
+ *        stored once.
+ *
+ * If many realizations of an ensemble are simulated by the same process, most of their
+ * PVT and saturation function tables are usually identical. Each realization passes
+ * its tables to intern() after they have been fully initialized. If the registry
+ * already contains an identical table, that table is returned and the caller's copy
+ * can be discarded; otherwise the caller's table is registered and returned.
+ *
+ * Since the tables handed out by the registry may be shared by several realizations,
+ * they must not be modified any more. The registry only keeps weak references, i.e.,
+ * a table is released as soon as the last realization which uses it is destroyed.
+ * intern() may be called concurrently by multiple threads.
+ *
+ * The Table class must be comparable using operator== and provide a contentHash()
+ * method which returns the same value for all tables which compare equal, cf.
+ * TableHash.hpp.
+ *
+ * \code
+ * auto oilPvt = std::make_shared<Opm::LiveOilPvt<Scalar> >();
+ * oilPvt->setNumRegions(numPvtRegions);
+ * for (int regionIdx = 0; regionIdx < numPvtRegions; ++regionIdx)
+ *     oilPvt->setPvtoTable(regionIdx, pvtoTables[regionIdx]);
+ * oilPvt->initEnd();
+ *
+ * auto& registry = Opm::TableRegistry<Opm::LiveOilPvt<Scalar> >::instance();
+ * fluidSystem.setOilPvt(registry.intern(oilPvt));
+ * \endcode
+ */
+template <class Table>
+class TableRegistry
+{
+public:
+    /*!
+     * \brief Returns the registry of the process.
+     */
+    static TableRegistry& instance()
+    {
+        static TableRegistry registry;
+        return registry;
+    }
+
+    /*!
+     * \brief Returns the registered table which is identical to the argument.
+     *
+     * If no such table exists, the argument itself gets registered and is returned.
+     */
+    std::shared_ptr<const Table> intern(const std::shared_ptr<const Table>& table)
+    {
+        if (!table)
+            return table;
+
+        size_t hash = table->contentHash();
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto existing = find_(hash, *table);
+        if (existing)
+            return existing;
+
+        tables_.insert(std::make_pair(hash, std::weak_ptr<const Table>(table)));
+        return table;
+    }
+
+    /*!
+     * \brief Returns the registered table which is identical to the argument.
+     *
+     * If no such table exists, a copy of the argument is registered and returned.
+     */
+    std::shared_ptr<const Table> internCopy(const Table& table)
+    {
+        size_t hash = table.contentHash();
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto existing = find_(hash, table);
+        if (existing)
+            return existing;
+
+        std::shared_ptr<const Table> result = std::make_shared<Table>(table);
+        tables_.insert(std::make_pair(hash, std::weak_ptr<const Table>(result)));
+        return result;
+    }
+
+    /*!
+     * \brief Returns the number of distinct tables which are currently in use.
+     */
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t result = 0;
+        for (const auto& entry : tables_)
+            if (!entry.second.expired())
+                ++result;
+        return result;
+    }
+
+private:
+    TableRegistry()
+    {}
+
+    TableRegistry(const TableRegistry&) = delete;
+    TableRegistry& operator=(const TableRegistry&) = delete;
+
+    // returns the live table with a given hash value which is equal to the argument,
+    // or a null pointer. the entries of released tables are removed on the way.
+    std::shared_ptr<const Table> find_(size_t hash, const Table& table)
+    {
+        auto range = tables_.equal_range(hash);
+        for (auto it = range.first; it != range.second;) {
+            std::shared_ptr<const Table> candidate = it->second.lock();
+            if (!candidate) {
+                it = tables_.erase(it);
+                continue;
+            }
+
+            if (candidate.get() == &table || *candidate == table)
+                return candidate;
+            ++it;
+        }
+
+        return nullptr;
+    }
+
+    mutable std::mutex mutex_;
+    std::unordered_multimap<size_t, std::weak_ptr<const Table> > tables_;
+};
+} // namespace Opm
+
+#endif
@@ -0,0 +1,176 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Resamples tables with irregularly spaced sampling points onto uniform grids.
+ *
+ * For the lookups in a UniformXTabulated2DFunction, the segments on the y-axis need to
+ * be searched in the two columns which enclose the position, and the columns generally
+ * have different lengths. If the function is resampled onto a UniformTabulated2DFunction,
+ * the cell which contains a position is determined by index arithmetic and the sampling
+ * points of all cells are stored in a regular array. The price is that the resampled
+ * function only approximates the original one, so resampleUniformly() returns a bound of
+ * the error which it introduces. Uniformly tabulated functions can also be resampled
+ * onto coarser uniform grids.
+ */
+#ifndef OPM_TABLE_RESAMPLING_HPP
+#define OPM_TABLE_RESAMPLING_HPP
+
+#include <opm/material/common/UniformTabulated2DFunction.hpp>
+#include <opm/material/common/UniformXTabulated2DFunction.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Opm {
+
+/*!
+ * \brief Resample a function which is tabulated on an irregular grid onto a uniform one.
+ *
+ * The uniform grid exhibits numX times numY sampling points and covers the range of
+ * the x-axis of the original function and the union of the ranges of its columns on the
+ * y-axis. Outside of the ranges of the columns, the original function is extrapolated.
+ *
+ * The returned error is the largest deviation of the resampled function from the
+ * original one at the original sampling points and at the centers of the cells of the
+ * uniform grid, relative to the largest magnitude of the original values. If the
+ * original function does not exhibit at least two columns and a non-empty range on the
+ * y-axis, it cannot be resampled: The resampled function is then left empty, i.e., its
+ * numX() is zero, and the returned error is zero.
+ *
+ * \param dest The resampled function
+ * \param src The original function
+ * \param numX The number of sampling points of the uniform grid on the x-axis
+ * \param numY The number of sampling points of the uniform grid on the y-axis
+ */
+template <class Scalar, class Allocator, class StorageScalar>
+Scalar resampleUniformly(UniformTabulated2DFunction<Scalar, Allocator, StorageScalar>& dest,
+                         const UniformXTabulated2DFunction<Scalar>& src,
+                         int numX,
+                         int numY)
+{
+    dest = UniformTabulated2DFunction<Scalar, Allocator, StorageScalar>();
+    if (src.numX() < 2 || numX < 2 || numY < 2)
+        return 0.0;
+
+    Scalar yMin = src.yMin(0);
+    Scalar yMax = src.yMax(0);
+    Scalar scale = 0.0;
+    for (int i = 0; i < src.numX(); ++i) {
+        yMin = std::min(yMin, src.yMin(i));
+        yMax = std::max(yMax, src.yMax(i));
+        for (int j = 0; j < src.numY(i); ++j)
+            scale = std::max<Scalar>(scale, std::abs(src.valueAt(i, j)));
+    }
+    if (!(yMin < yMax))
+        return 0.0;
+
+    dest.resize(src.xMin(), src.xMax(), numX, yMin, yMax, numY);
+    for (int i = 0; i < numX; ++i)
+        for (int j = 0; j < numY; ++j)
+            dest.setSamplePoint(i, j, src.eval(dest.iToX(i), dest.jToY(j), /*extrapolate=*/true));
+
+    if (!(scale > 0))
+        return 0.0;
+
+    // the original function exhibits its kinks at its sampling points, whereas the
+    // deviation of a smooth one is largest close to the centers of the uniform cells
+    Scalar maxError = 0.0;
+    for (int i = 0; i < src.numX(); ++i) {
+        for (int j = 0; j < src.numY(i); ++j) {
+            Scalar delta = dest.eval(src.xAt(i), src.yAt(i, j)) - src.valueAt(i, j);
+            maxError = std::max(maxError, std::abs(delta));
+        }
+    }
+    for (int i = 0; i + 1 < numX; ++i) {
+        Scalar x = (dest.iToX(i) + dest.iToX(i + 1))/2;
+        for (int j = 0; j + 1 < numY; ++j) {
+            Scalar y = (dest.jToY(j) + dest.jToY(j + 1))/2;
+            Scalar delta = dest.eval(x, y) - src.eval(x, y, /*extrapolate=*/true);
+            maxError = std::max(maxError, std::abs(delta));
+        }
+    }
+
+    return maxError/scale;
+}
+
+/*!
+ * \brief Resample a function which is tabulated on a uniform grid onto another uniform
+ *        grid which covers the same range.
+ *
+ * This is usually used to derive a coarse version of a finely sampled function, e.g.,
+ * to obtain a small table which stays in the cache while the accuracy of its values is
+ * not critical. The sampling points of the resampled function are given by the
+ * interpolation of the original one.
+ *
+ * The returned error is the largest deviation of the resampled function from the
+ * original one at the sampling points of the latter, relative to the largest magnitude
+ * of the original values. If one of the functions does not exhibit at least two
+ * sampling points per direction, the resampled function is left empty and the returned
+ * error is zero.
+ *
+ * \param dest The resampled function
+ * \param src The original function
+ * \param numX The number of sampling points of the resampled function on the x-axis
+ * \param numY The number of sampling points of the resampled function on the y-axis
+ */
+template <class Scalar, class Allocator, class StorageScalar,
+          class SrcAllocator, class SrcStorageScalar>
+Scalar resampleUniformly(UniformTabulated2DFunction<Scalar, Allocator, StorageScalar>& dest,
+                         const UniformTabulated2DFunction<Scalar, SrcAllocator, SrcStorageScalar>& src,
+                         int numX,
+                         int numY)
+{
+    dest = UniformTabulated2DFunction<Scalar, Allocator, StorageScalar>();
+    if (src.numX() < 2 || src.numY() < 2 || numX < 2 || numY < 2)
+        return 0.0;
+
+    dest.resize(src.xMin(), src.xMax(), numX, src.yMin(), src.yMax(), numY);
+    for (int i = 0; i < numX; ++i) {
+        // rounding must not move the positions out of the range of the original function
+        Scalar x = std::min(src.xMax(), dest.iToX(i));
+        for (int j = 0; j < numY; ++j) {
+            Scalar y = std::min(src.yMax(), dest.jToY(j));
+            dest.setSamplePoint(i, j, src.eval(x, y));
+        }
+    }
+
+    Scalar scale = 0.0;
+    Scalar maxError = 0.0;
+    for (int i = 0; i < src.numX(); ++i) {
+        Scalar x = std::min(dest.xMax(), src.iToX(i));
+        for (int j = 0; j < src.numY(); ++j) {
+            Scalar y = std::min(dest.yMax(), src.jToY(j));
+            Scalar value = src.getSamplePoint(i, j);
+            scale = std::max<Scalar>(scale, std::abs(value));
+            maxError = std::max<Scalar>(maxError, std::abs(dest.eval(x, y) - value));
+        }
+    }
+
+    if (!(scale > 0))
+        return 0.0;
+    return maxError/scale;
+}
+
+} // namespace Opm
+
+#endif
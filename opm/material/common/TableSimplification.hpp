@@ -0,0 +1,181 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Removes redundant sampling points from piecewise linear tables.
+ *
+ * Tables of ECL decks are often sampled much more finely than necessary, i.e., many
+ * sampling points are located (almost) on the straight line through their
+ * neighbours. simplifyTable() removes such points using the Douglas-Peucker algorithm:
+ * A segment of the simplified table is split at the sampling point which deviates most
+ * from it until no point deviates by more than a given tolerance.
+ *
+ * The simplified tables are subsets of the original ones and the first and the last
+ * sampling points are always kept, so monotonic columns stay monotonic and the range of
+ * the tables does not change. Points at which a column leaves or reaches zero are also
+ * kept because they usually represent critical saturations.
+ */
+#ifndef OPM_TABLE_SIMPLIFICATION_HPP
+#define OPM_TABLE_SIMPLIFICATION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+namespace TableSimplificationDetail {
+// returns the largest deviation of the sampling points between two others from the
+// straight line through them, relative to the scale of each column, and the index of
+// the sampling point for which it is attained
+template <class Scalar>
+std::pair<Scalar, size_t> maxDeviation(const std::vector<Scalar>& x,
+                                       const std::vector<std::vector<Scalar> >& columns,
+                                       const std::vector<Scalar>& scales,
+                                       size_t first,
+                                       size_t last)
+{
+    std::pair<Scalar, size_t> result(0.0, first);
+    for (size_t colIdx = 0; colIdx < columns.size(); ++colIdx) {
+        if (!(scales[colIdx] > 0))
+            continue;
+
+        const auto& y = columns[colIdx];
+        Scalar slope = (y[last] - y[first])/(x[last] - x[first]);
+        for (size_t i = first + 1; i < last; ++i) {
+            Scalar delta = std::abs(y[i] - (y[first] + (x[i] - x[first])*slope))/scales[colIdx];
+            if (delta > result.first) {
+                result.first = delta;
+                result.second = i;
+            }
+        }
+    }
+    return result;
+}
+} // namespace TableSimplificationDetail
+
+/*!
+ * \brief Remove the sampling points of a table which are not required to represent all
+ *        its columns within a given tolerance.
+ *
+ * All columns share the sampling points given by x, which must be strictly
+ * ascending. If they are not, the table is left alone. A sampling point is removed if
+ * the value of no column deviates from the simplified table by more than tolerance
+ * times the largest magnitude of the values of the column.
+ *
+ * \param x The sampling points. They are replaced by the ones of the simplified table.
+ * \param columns The columns of the table. They are replaced by the ones of the
+ *                simplified table.
+ * \param tolerance The maximum deviation relative to the scale of each column
+ */
+template <class Scalar>
+void simplifyTable(std::vector<Scalar>& x,
+                   std::vector<std::vector<Scalar> >& columns,
+                   Scalar tolerance)
+{
+    size_t n = x.size();
+    if (n < 3 || !(tolerance > 0))
+        return;
+
+    for (size_t i = 1; i < n; ++i)
+        if (!(x[i - 1] < x[i]))
+            return;
+
+    std::vector<Scalar> scales(columns.size(), 0.0);
+    for (size_t colIdx = 0; colIdx < columns.size(); ++colIdx) {
+        const auto& y = columns[colIdx];
+        if (y.size() != n)
+            return;
+        for (size_t i = 0; i < n; ++i)
+            scales[colIdx] = std::max<Scalar>(scales[colIdx], std::abs(y[i]));
+    }
+
+    // the end points and the points where a column leaves or reaches zero are
+    // mandatory
+    std::vector<bool> keep(n, false);
+    keep.front() = keep.back() = true;
+    for (const auto& y : columns)
+        for (size_t i = 1; i + 1 < n; ++i)
+            if (y[i] == 0 && (y[i - 1] != 0 || y[i + 1] != 0))
+                keep[i] = true;
+
+    // split the segments between the mandatory points until all points are within the
+    // tolerance
+    std::vector<std::pair<size_t, size_t> > segments;
+    for (size_t first = 0, last = 1; last < n; ++last) {
+        if (keep[last]) {
+            segments.push_back(std::make_pair(first, last));
+            first = last;
+        }
+    }
+
+    while (!segments.empty()) {
+        auto segment = segments.back();
+        segments.pop_back();
+        if (segment.second - segment.first < 2)
+            continue;
+
+        const auto& deviation =
+            TableSimplificationDetail::maxDeviation(x, columns, scales, segment.first, segment.second);
+        if (deviation.first <= tolerance)
+            continue;
+
+        keep[deviation.second] = true;
+        segments.push_back(std::make_pair(segment.first, deviation.second));
+        segments.push_back(std::make_pair(deviation.second, segment.second));
+    }
+
+    size_t numKept = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!keep[i])
+            continue;
+
+        x[numKept] = x[i];
+        for (auto& y : columns)
+            y[numKept] = y[i];
+        ++numKept;
+    }
+
+    x.resize(numKept);
+    for (auto& y : columns)
+        y.resize(numKept);
+}
+
+/*!
+ * \brief Remove the sampling points of a single curve which are not required to
+ *        represent it within a given tolerance.
+ *
+ * This is the same as the variant for tables with several columns.
+ */
+template <class Scalar>
+void simplifyTable(std::vector<Scalar>& x, std::vector<Scalar>& y, Scalar tolerance)
+{
+    std::vector<std::vector<Scalar> > columns(1);
+    columns[0].swap(y);
+    simplifyTable(x, columns, tolerance);
+    columns[0].swap(y);
+}
+
+} // namespace Opm
+
+#endif
@@ -25,23 +25,68 @@
 #ifndef OPM_TABULATED_1D_FUNCTION_HPP
 #define OPM_TABULATED_1D_FUNCTION_HPP
 
+#include <opm/material/common/CurveShape.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
 #include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/SegmentHint.hpp>
+#include <opm/material/common/SimdPack.hpp>
+#include <opm/material/common/Instrumentation.hpp>
+#include <opm/material/common/InterpolationWeights.hpp>
+#include <opm/material/common/TableHash.hpp>
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iostream>
+#include <memory>
 #include <tuple>
 #include <vector>
 
 namespace Opm {
+#if OPM_MATERIAL_HAVE_SIMD_PACK
+namespace LocalAd {
+template <class ScalarT, class VarSetTag, int numVars, class DerivativeScalarT>
+class Evaluation;
+}
+#endif
+
+/*!
+ * \brief The schemes which can be used to interpolate between the sampling points of
+ *        an Opm::Tabulated1DFunction.
+ */
+enum TabulatedInterpolation {
+    //! Straight lines between the sampling points. The derivative of the function
+    //! jumps at each sampling point.
+    LinearInterpolation,
+
+    //! Piecewise cubic Hermite polynomials whose slopes at the sampling points are
+    //! chosen such that the function is continuously differentiable and that it
+    //! does not overshoot, i.e., it is monotonic wherever the sampling points are
+    //! (Fritsch and Carlson, 1980).
+    MonotoneCubicInterpolation
+};
+
 /*!
  * \brief Implements a linearly interpolated scalar function that depends on one
  *        variable.
+ *
+ * Instead of linear interpolation, monotone cubic interpolation can be selected using
+ * setInterpolationMode(). Note that the copies of the function which are created by
+ * Opm::FlatTableBuffer always use linear interpolation.
+ *
+ * \tparam Scalar The type used for scalar values
+ * \tparam Allocator The allocator used for the sampling points. This can be used to
+ *                   place the tables into shared memory (cf. SharedMemoryAllocator).
+ * \tparam StorageScalar The type used to store the sampling points. If this is float,
+ *                       the memory footprint of the table is halved while the
+ *                       interpolation is still done using Scalar.
  */
-template <class Scalar>
+template <class Scalar, class Allocator = std::allocator<Scalar>, class StorageScalar = Scalar>
 class Tabulated1DFunction
 {
+    typedef std::vector<StorageScalar, typename std::allocator_traits<Allocator>::template rebind_alloc<StorageScalar>> ScalarVector;
+    typedef std::vector<int, typename std::allocator_traits<Allocator>::template rebind_alloc<int> > IntVector;
+
 public:
     /*!
      * \brief Default constructor for a piecewise linear function.
@@ -49,6 +94,9 @@ public:
      * To specfiy the acutal curve, use one of the set() methods.
      */
     Tabulated1DFunction()
+        : invBucketWidth_(0.0)
+        , shape_(GeneralCurve)
+        , interpolationMode_(LinearInterpolation)
     {}
 
     /*!
@@ -63,6 +111,7 @@ public:
                         const ScalarArrayX &x,
                         const ScalarArrayY &y,
                         bool sortInputs = false)
+        : interpolationMode_(LinearInterpolation)
     { this->setXYArrays(nSamples, x, y, sortInputs); }
 
     /*!
@@ -77,6 +126,7 @@ public:
     Tabulated1DFunction(const ScalarContainer &x,
                         const ScalarContainer &y,
                         bool sortInputs = false)
+        : interpolationMode_(LinearInterpolation)
     { this->setXYContainers(x, y, sortInputs); }
 
     /*!
@@ -88,6 +138,7 @@ public:
     template <class PointContainer>
     Tabulated1DFunction(const PointContainer &points,
                         bool sortInputs = false)
+        : interpolationMode_(LinearInterpolation)
     { this->setContainerOfTuples(points, sortInputs); }
 
     /*!
@@ -113,6 +164,9 @@ public:
             sortInput_();
         else if (xValues_[0] > xValues_[numSamples() - 1])
             reverseSamplingPoints_();
+
+        updateSegmentIndex_();
+        updateSlopes_();
     }
 
     /*!
@@ -136,6 +190,9 @@ public:
             sortInput_();
         else if (xValues_[0] > xValues_[numSamples() - 1])
             reverseSamplingPoints_();
+
+        updateSegmentIndex_();
+        updateSlopes_();
     }
 
     /*!
@@ -160,6 +217,9 @@ public:
             sortInput_();
         else if (xValues_[0] > xValues_[numSamples() - 1])
             reverseSamplingPoints_();
+
+        updateSegmentIndex_();
+        updateSlopes_();
     }
 
     /*!
@@ -196,14 +256,90 @@ public:
             sortInput_();
         else if (xValues_[0] > xValues_[numSamples() - 1])
             reverseSamplingPoints_();
+
+        updateSegmentIndex_();
+        updateSlopes_();
     }
 
+    /*!
+     * \brief Replace the y values of the sampling points while keeping their x values.
+     *
+     * The values must be given in the order of the stored sampling points, i.e., the
+     * i-th entry is the new value at xAt(i). This is intended for codes which modify
+     * the same table over and over again, e.g., history matching loops: Only the
+     * shape of the curve is determined anew, the index of the segments is only
+     * rebuilt if the curve changes from or to a general one because it does not
+     * depend on the y values.
+     */
+    template <class ScalarContainerY>
+    void updateValues(const ScalarContainerY& y)
+    {
+        if (static_cast<int>(y.size()) != numSamples())
+            OPM_THROW(std::invalid_argument,
+                      "Cannot update the " << numSamples() << " values of a tabulated "
+                      "function using " << y.size() << " values");
+
+        std::copy(y.begin(), y.end(), yValues_.begin());
+
+        CurveShape oldShape = shape_;
+        shape_ = classifyCurve(xValues_, yValues_);
+        if ((oldShape == GeneralCurve) != (shape_ == GeneralCurve))
+            updateSegmentIndex_();
+        updateSlopes_();
+    }
+
+    /*!
+     * \brief Select the scheme which is used to interpolate between the sampling
+     *        points.
+     *
+     * For monotone cubic interpolation, the slopes of the function at the sampling
+     * points are computed at this point and whenever the sampling points are
+     * modified. Beyond the range of the function, it is extrapolated by the tangent
+     * at the first or the last sampling point. If all sampling points are located on
+     * a straight line, both schemes are identical, so the function is then always
+     * evaluated like a linear one.
+     */
+    void setInterpolationMode(TabulatedInterpolation mode)
+    {
+        interpolationMode_ = mode;
+        if (!xValues_.empty())
+            updateSlopes_();
+    }
+
+    /*!
+     * \brief Returns the scheme which is used to interpolate between the sampling
+     *        points.
+     */
+    TabulatedInterpolation interpolationMode() const
+    { return interpolationMode_; }
+
     /*!
      * \brief Returns the number of sampling points.
      */
     int numSamples() const
     { return xValues_.size(); }
 
+    /*!
+     * \brief Returns true iff two functions use the same sampling points and the same
+     *        interpolation scheme.
+     */
+    bool operator==(const Tabulated1DFunction& other) const
+    {
+        return
+            xValues_ == other.xValues_
+            && yValues_ == other.yValues_
+            && interpolationMode_ == other.interpolationMode_;
+    }
+
+    bool operator!=(const Tabulated1DFunction& other) const
+    { return !operator==(other); }
+
+    /*!
+     * \brief Returns a hash value of the sampling points, cf. Opm::TableRegistry.
+     */
+    size_t contentHash() const
+    { return hashValues(hashValues(0, xValues_), yValues_); }
+
     /*!
      * \brief Return the x value of the leftmost sampling point.
      */
@@ -228,6 +364,17 @@ public:
     Scalar valueAt(int i) const
     { return yValues_[i]; }
 
+    /*!
+     * \brief Returns the shape of the function.
+     *
+     * If the sampling points are located on a single straight line (which includes
+     * constant and zero functions, cf. classifyCurve()), no segment needs to be
+     * searched for evaluating the function. All evaluations then use the first
+     * segment, which is also the one stored in segment hints.
+     */
+    CurveShape shape() const
+    { return shape_; }
+
     /*!
      * \brief Return true iff the given x is in range [x1, xn].
      */
@@ -245,23 +392,19 @@ public:
      */
     Scalar eval(Scalar x, bool extrapolate=false) const
     {
+        OPM_INSTRUMENT_SCOPE("Tabulated1DFunction::eval");
+        countLookup_(x);
         int segIdx;
         if (extrapolate && x < xValues_.front())
             segIdx = 0;
         else if (extrapolate && x > xValues_.back())
-            segIdx = numSamples() - 2;
+            segIdx = lastSegmentIdx_();
         else {
             assert(xValues_.front() <= x && x <= xValues_.back());
             segIdx = findSegmentIndex_(x);
         }
 
-        Scalar x0 = xValues_[segIdx];
-        Scalar x1 = xValues_[segIdx + 1];
-
-        Scalar y0 = yValues_[segIdx];
-        Scalar y1 = yValues_[segIdx + 1];
-
-        return y0 + (y1 - y0)*(x - x0)/(x1 - x0);
+        return evalSegment_(x, segIdx);
     }
 
     /*!
@@ -276,31 +419,287 @@ public:
     template <class Evaluation>
     Evaluation eval(const Evaluation& x, bool extrapolate=false) const
     {
+        OPM_INSTRUMENT_SCOPE("Tabulated1DFunction::eval");
+        countLookup_(x.value);
         int segIdx;
         if (extrapolate && x.value < xValues_.front())
             segIdx = 0;
         else if (extrapolate && x.value > xValues_.back())
-            segIdx = numSamples() - 2;
+            segIdx = lastSegmentIdx_();
         else {
             assert(xValues_.front() <= x.value && x.value <= xValues_.back());
             segIdx = findSegmentIndex_(x.value);
         }
 
-        Scalar x0 = xValues_[segIdx];
-        Scalar x1 = xValues_[segIdx + 1];
+        return evalSegment_(x, segIdx);
+    }
 
-        Scalar y0 = yValues_[segIdx];
-        Scalar y1 = yValues_[segIdx + 1];
+    /*!
+     * \brief Evaluate the function at a given position using a segment hint.
+     *
+     * The segment which is stored in the hint is checked first. Only if the position
+     * is not located within it, the segment is searched. In any case, the hint is
+     * updated to the segment which was used.
+     *
+     * \param x The value on the abscissa where the function ought to be evaluated
+     * \param hint The cached segment index of the previous evaluation
+     * \param extrapolate If this parameter is set to true, the function will be extended
+     *                    beyond its range by straight lines, if false calling
+     *                    extrapolate for \f$ x \not [x_{min}, x_{max}]\f$ will cause a
+     *                    failed assertation.
+     */
+    Scalar eval(Scalar x, SegmentHint& hint, bool extrapolate=false) const
+    {
+        OPM_INSTRUMENT_SCOPE("Tabulated1DFunction::eval");
+        countLookup_(x);
+        return evalSegment_(x, findSegmentIndex_(x, hint, extrapolate));
+    }
 
-        Scalar m = (y1 - y0)/(x1 - x0);
+    /*!
+     * \brief Evaluate the function at a given position using a segment hint.
+     *
+     * \copydetails eval(Scalar, SegmentHint&, bool) const
+     */
+    template <class Evaluation>
+    Evaluation eval(const Evaluation& x, SegmentHint& hint, bool extrapolate=false) const
+    {
+        OPM_INSTRUMENT_SCOPE("Tabulated1DFunction::eval");
+        countLookup_(x.value);
+        return evalSegment_(x, findSegmentIndex_(x.value, hint, extrapolate));
+    }
 
-        Evaluation result;
+#if OPM_MATERIAL_HAVE_SIMD_PACK
+    /*!
+     * \brief Evaluate the function for each lane of a SIMD pack.
+     *
+     * The segment is searched for each lane individually. The sampling points of these
+     * segments are then gathered into packs, so that the interpolation is done for all
+     * lanes at once.
+     *
+     * \copydetails eval(Scalar, bool) const
+     */
+    template <class T, class Abi>
+    std::experimental::simd<T, Abi> eval(const std::experimental::simd<T, Abi>& x,
+                                         bool extrapolate=false) const
+    {
+        OPM_INSTRUMENT_SCOPE("Tabulated1DFunction::eval");
+        typedef std::experimental::simd<T, Abi> Pack;
+
+        int segIdx[Pack::size()];
+        findPackSegmentIndices_(x, segIdx, extrapolate);
+
+        Pack x0, m, y0;
+        gatherSegments_(x, segIdx, x0, m, y0);
+        return y0 + m*(x - x0);
+    }
+
+    /*!
+     * \brief Evaluate the function for each lane of a function evaluation which uses
+     *        SIMD packs as scalars.
+     *
+     * \copydetails eval(Scalar, bool) const
+     */
+    template <class T, class Abi, class VarSetTag, int numVars, class DerivScalar>
+    LocalAd::Evaluation<std::experimental::simd<T, Abi>, VarSetTag, numVars, DerivScalar>
+    eval(const LocalAd::Evaluation<std::experimental::simd<T, Abi>, VarSetTag, numVars, DerivScalar>& x,
+         bool extrapolate=false) const
+    {
+        OPM_INSTRUMENT_SCOPE("Tabulated1DFunction::eval");
+        typedef std::experimental::simd<T, Abi> Pack;
+
+        int segIdx[Pack::size()];
+        findPackSegmentIndices_(x.value, segIdx, extrapolate);
+
+        Pack x0, m, y0;
+        gatherSegments_(x.value, segIdx, x0, m, y0);
+
+        LocalAd::Evaluation<Pack, VarSetTag, numVars, DerivScalar> result;
         result.value = y0 + m*(x.value - x0);
         for (unsigned varIdx = 0; varIdx < result.derivatives.size(); ++varIdx)
             result.derivatives[varIdx] = m*x.derivatives[varIdx];
 
         return result;
     }
+#endif // OPM_MATERIAL_HAVE_SIMD_PACK
+
+    /*!
+     * \brief Evaluate the function for a batch of positions.
+     *
+     * This is equivalent to calling eval() for each entry of the x array, but the
+     * segment search is amortized over the batch: If the position of an entry is
+     * located in the same segment as the previous one, no search is necessary
+     * at all. If the positions are sorted or clustered (which is usually the case
+     * if the batch corresponds to neighboring cells), the search thus becomes
+     * practically free and the interpolation loop can be vectorized by the
+     * compiler.
+     *
+     * \param x The array of positions on the abscissa where the function ought to be
+     *          evaluated
+     * \param y The array in which the results are stored. It must be able to hold at
+     *          least n entries.
+     * \param n The number of positions which ought to be evaluated
+     * \param extrapolate If this parameter is set to true, the function will be extended
+     *                    beyond its range by straight lines, if false calling
+     *                    extrapolate for \f$ x \not [x_{min}, x_{max}]\f$ will cause a
+     *                    failed assertation.
+     */
+    void evalBatch(const Scalar* x, Scalar* y, size_t n, bool extrapolate=false) const
+    {
+        OPM_INSTRUMENT_SCOPE("Tabulated1DFunction::evalBatch");
+        int segIdx[batchChunkSize_];
+        for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += batchChunkSize_) {
+            size_t chunkSize = std::min<size_t>(batchChunkSize_, n - chunkBegin);
+            const Scalar* xChunk = x + chunkBegin;
+            Scalar* yChunk = y + chunkBegin;
+
+            findSegmentIndices_(xChunk, segIdx, chunkSize, extrapolate);
+            for (size_t i = 0; i < chunkSize; ++i)
+                countLookup_(xChunk[i]);
+
+            if (useSlopes_()) {
+                Scalar dydx;
+                for (size_t i = 0; i < chunkSize; ++i)
+                    yChunk[i] = evalCubicSegment_(xChunk[i], segIdx[i], dydx);
+                continue;
+            }
+
+            for (size_t i = 0; i < chunkSize; ++i) {
+                int j = segIdx[i];
+                Scalar x0 = xValues_[j];
+                Scalar x1 = xValues_[j + 1];
+
+                Scalar y0 = yValues_[j];
+                Scalar y1 = yValues_[j + 1];
+
+                // use the same floating point operations as evalSegment_()
+                Scalar m = (y1 - y0)/(x1 - x0);
+                yChunk[i] = y0 + m*(xChunk[i] - x0);
+            }
+        }
+    }
+
+    /*!
+     * \brief Evaluate the function and its derivatives for a batch of positions which
+     *        are given in structure-of-arrays layout.
+     *
+     * I.e., instead of using an array of Evaluation objects, the values of the
+     * positions are passed as a contiguous array and the derivatives w.r.t. each
+     * primary variable are passed as a separate contiguous array. This allows the
+     * inner loops to run over the batch index and thus to be vectorized.
+     *
+     * \param xValue The array of the values of the positions where the function
+     *               ought to be evaluated
+     * \param xDerivatives An array of numDerivatives pointers to the arrays which
+     *                     contain the derivatives of the positions
+     * \param yValue The array in which the resulting function values are stored
+     * \param yDerivatives An array of numDerivatives pointers to the arrays in which
+     *                     the derivatives of the results are stored
+     * \param numDerivatives The number of derivatives of each position
+     * \param n The number of positions which ought to be evaluated
+     * \param extrapolate If this parameter is set to true, the function will be extended
+     *                    beyond its range by straight lines, if false calling
+     *                    extrapolate for \f$ x \not [x_{min}, x_{max}]\f$ will cause a
+     *                    failed assertation.
+     */
+    void evalBatch(const Scalar* xValue,
+                   const Scalar* const* xDerivatives,
+                   Scalar* yValue,
+                   Scalar* const* yDerivatives,
+                   size_t numDerivatives,
+                   size_t n,
+                   bool extrapolate=false) const
+    {
+        OPM_INSTRUMENT_SCOPE("Tabulated1DFunction::evalBatch");
+        int segIdx[batchChunkSize_];
+        Scalar slope[batchChunkSize_];
+        for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += batchChunkSize_) {
+            size_t chunkSize = std::min<size_t>(batchChunkSize_, n - chunkBegin);
+            const Scalar* xChunk = xValue + chunkBegin;
+            Scalar* yChunk = yValue + chunkBegin;
+
+            findSegmentIndices_(xChunk, segIdx, chunkSize, extrapolate);
+            for (size_t i = 0; i < chunkSize; ++i)
+                countLookup_(xChunk[i]);
+
+            if (useSlopes_()) {
+                for (size_t i = 0; i < chunkSize; ++i)
+                    yChunk[i] = evalCubicSegment_(xChunk[i], segIdx[i], slope[i]);
+            }
+            else {
+                for (size_t i = 0; i < chunkSize; ++i) {
+                    int j = segIdx[i];
+                    Scalar x0 = xValues_[j];
+                    Scalar x1 = xValues_[j + 1];
+
+                    Scalar y0 = yValues_[j];
+                    Scalar y1 = yValues_[j + 1];
+
+                    slope[i] = (y1 - y0)/(x1 - x0);
+                    yChunk[i] = y0 + slope[i]*(xChunk[i] - x0);
+                }
+            }
+
+            for (size_t varIdx = 0; varIdx < numDerivatives; ++varIdx) {
+                const Scalar* dxChunk = xDerivatives[varIdx] + chunkBegin;
+                Scalar* dyChunk = yDerivatives[varIdx] + chunkBegin;
+                for (size_t i = 0; i < chunkSize; ++i)
+                    dyChunk[i] = slope[i]*dxChunk[i];
+            }
+        }
+    }
+
+    /*!
+     * \brief Evaluate the function and determine the weights of the sampling points
+     *        which contribute to its value.
+     *
+     * The value is the weighted sum of the values of the two sampling points of the
+     * segment which contains the position, so the weights are the partial derivatives
+     * of the value with regard to the values of these sampling points (cf.
+     * Opm::InterpolationWeights). Beyond the range of the function, the outermost
+     * segment is extrapolated, i.e., the weights are then not within [0, 1]. This is
+     * only available for linear interpolation because for monotone cubic
+     * interpolation, the slopes at the sampling points depend on the values of their
+     * neighbors in a non-linear way.
+     *
+     * \param x The value on the abscissa where the function ought to be evaluated
+     * \param weights Receives the indices and the weights of the two contributing
+     *                sampling points
+     * \param extrapolate If this parameter is set to true, the function will be extended
+     *                    beyond its range by straight lines, if false calling
+     *                    extrapolate for \f$ x \not [x_{min}, x_{max}]\f$ will cause a
+     *                    failed assertation.
+     */
+    Scalar evalWeights(Scalar x, InterpolationWeights<Scalar, 2>& weights, bool extrapolate=false) const
+    {
+        if (interpolationMode_ != LinearInterpolation)
+            OPM_THROW(std::logic_error,
+                      "Interpolation weights are only available for linear interpolation");
+        assert(extrapolate || (xValues_.front() <= x && x <= xValues_.back()));
+        static_cast<void>(extrapolate);
+
+        // if all sampling points are on a straight line, eval() uses any segment. the
+        // weights must refer to the segment which actually contains the position,
+        // though, because modifying a sampling point makes the curve a general one.
+        int segIdx;
+        if (shape_ == GeneralCurve)
+            segIdx = findSegmentIndex_(x);
+        else if (x <= xValues_[1])
+            segIdx = 0;
+        else if (x >= xValues_[numSamples() - 2])
+            segIdx = numSamples() - 2;
+        else
+            segIdx = bisectSegmentIndex_(x, 1, numSamples() - 2);
+
+        Scalar x0 = xValues_[segIdx];
+        Scalar x1 = xValues_[segIdx + 1];
+        Scalar t = (x - x0)/(x1 - x0);
+
+        weights.clear();
+        weights.add(segIdx, 0, 1 - t);
+        weights.add(segIdx + 1, 0, t);
+
+        return evalSegment_(x, segIdx);
+    }
 
     /*!
      * \brief Evaluate the spline's derivative at a given position.
@@ -317,14 +716,25 @@ public:
     {
         int segIdx = findSegmentIndex_(x);
 
-        return evalDerivative(x, segIdx);
+        return evalDerivative_(x, segIdx);
     }
 
+    /*!
+     * \brief Evaluate the function's derivative at a given position using a segment
+     *        hint.
+     *
+     * If the hint was just used by eval() for the same position, no search is
+     * necessary at all.
+     *
+     * \copydetails eval(Scalar, SegmentHint&, bool) const
+     */
+    Scalar evalDerivative(Scalar x, SegmentHint& hint, bool extrapolate=false) const
+    { return evalDerivative_(x, findSegmentIndex_(x, hint, extrapolate)); }
+
     /*!
      * \brief Evaluate the function's second derivative at a given position.
      *
-     * Since this class represents a piecewise linear function, this method will always
-     * return 0.
+     * For linear interpolation, this method will always return 0.
      *
      * \param x The value on the abscissa where the function's
      *          derivative ought to be evaluated
@@ -337,14 +747,20 @@ public:
     Scalar evalSecondDerivative(Scalar x, bool extrapolate=false) const
     {
         assert(extrapolate || applies(x));
-        return 0.0;
+        if (!useSlopes_())
+            return 0.0;
+
+        int segIdx = findSegmentIndex_(x);
+        Scalar c2, c3;
+        if (!cubicCoefficients_(x, segIdx, c2, c3))
+            return 0.0;
+        return 2*c2 + 6*c3*(x - xValues_[segIdx]);
     }
 
     /*!
      * \brief Evaluate the function's third derivative at a given position.
      *
-     * Since this class represents a piecewise linear function, this method will always
-     * return 0.
+     * For linear interpolation, this method will always return 0.
      *
      * \param x The value on the abscissa where the function's
      *          derivative ought to be evaluated
@@ -357,7 +773,14 @@ public:
     Scalar evalThirdDerivative(Scalar x, bool extrapolate=false) const
     {
         assert(extrapolate || applies(x));
-        return 0.0;
+        if (!useSlopes_())
+            return 0.0;
+
+        int segIdx = findSegmentIndex_(x);
+        Scalar c2, c3;
+        if (!cubicCoefficients_(x, segIdx, c2, c3))
+            return 0.0;
+        return 6*c3;
     }
 
     /*!
@@ -490,30 +913,256 @@ private:
         // we need at least two sampling points!
         assert(xValues_.size() >= 2);
 
+        // if all sampling points are on a straight line, any segment can be used
+        if (shape_ != GeneralCurve)
+            return 0;
+
         if (x <= xValues_[1])
             return 0;
         else if (x >= xValues_[xValues_.size() - 2])
             return xValues_.size() - 2;
-        else {
+        else if (segmentIndex_.empty())
             // bisection
-            int segmentIdx = 1;
-            int upperIdx = xValues_.size() - 2;
-            while (segmentIdx + 1 < upperIdx) {
-                int pivotIdx = (segmentIdx + upperIdx) / 2;
-                if (x < xValues_[pivotIdx])
-                    upperIdx = pivotIdx;
-                else
-                    segmentIdx = pivotIdx;
+            return bisectSegmentIndex_(x, 1, xValues_.size() - 2);
+        else {
+            // use the segment index to get a lower and an upper bound for the segment
+            // which contains x. due to rounding errors, the bucket which is computed
+            // here might be off by one, so the bounds are corrected if necessary.
+            int numBuckets = segmentIndex_.size() - 1;
+            Scalar t = (x - xValues_.front())*invBucketWidth_;
+            int bucketIdx = (t < numBuckets) ? static_cast<int>(t) : numBuckets - 1;
+
+            int lowerIdx = segmentIndex_[bucketIdx];
+            int upperIdx = segmentIndex_[bucketIdx + 1];
+            while (lowerIdx > 1 && x < xValues_[lowerIdx])
+                -- lowerIdx;
+            while (upperIdx < static_cast<int>(xValues_.size()) - 2 && x >= xValues_[upperIdx + 1])
+                ++ upperIdx;
+
+            return bisectSegmentIndex_(x, std::max(lowerIdx, 1), std::max(upperIdx, 1) + 1);
+        }
+    }
+
+    // returns the index of the segment which is used beyond the largest sampling point.
+    // if all sampling points are located on a straight line, all positions are
+    // evaluated using the first segment, so that the results are consistent.
+    int lastSegmentIdx_() const
+    { return (shape_ != GeneralCurve) ? 0 : numSamples() - 2; }
+
+    // record whether a position is within the range of the function or whether it
+    // needs to be extrapolated. since the counters are static, the statistics are
+    // accumulated over all tables instead of being kept for each table. if
+    // instrumentation is disabled, this does nothing.
+    void countLookup_(Scalar x) const
+    {
+#if OPM_MATERIAL_INSTRUMENTATION
+        if (xValues_.front() <= x && x <= xValues_.back())
+            OPM_INSTRUMENT_EVENT("Tabulated1DFunction::eval in range");
+        else
+            OPM_INSTRUMENT_EVENT("Tabulated1DFunction::eval extrapolated");
+#else
+        static_cast<void>(x);
+#endif
+    }
+
+    // same as findSegmentIndex_(x), but the segment index which is stored in the
+    // hint is checked first
+    int findSegmentIndex_(Scalar x, SegmentHint& hint, bool extrapolate) const
+    {
+        assert(extrapolate || (xValues_.front() <= x && x <= xValues_.back()));
+
+        if (shape_ != GeneralCurve)
+            return hint.segmentIdx = 0;
+
+        int segIdx = hint.segmentIdx;
+        int lastSegIdx = numSamples() - 2;
+        if (0 <= segIdx && segIdx <= lastSegIdx
+            && (segIdx == 0 || xValues_[segIdx] <= x)
+            && (segIdx == lastSegIdx || x <= xValues_[segIdx + 1]))
+            return segIdx;
+
+        hint.segmentIdx = findSegmentIndex_(x);
+        return hint.segmentIdx;
+    }
+
+    // returns the index of the segment which contains x. the segment index is searched
+    // in the range [lowerIdx, upperIdx). if x is located exactly on a sampling point,
+    // the segment to the right of it is returned (as long as it is in the range).
+    int bisectSegmentIndex_(Scalar x, int lowerIdx, int upperIdx) const
+    {
+        int segmentIdx = lowerIdx;
+        while (segmentIdx + 1 < upperIdx) {
+            int pivotIdx = (segmentIdx + upperIdx) / 2;
+            if (x < xValues_[pivotIdx])
+                upperIdx = pivotIdx;
+            else
+                segmentIdx = pivotIdx;
+        }
+
+        assert(xValues_[segmentIdx] <= x);
+        assert(x <= xValues_[segmentIdx + 1]);
+        return segmentIdx;
+    }
+
+    // (re-)build the acceleration structure for the segment search.
+    //
+    // if the sampling points are located on a straight line, the function can be
+    // evaluated using any segment, so no search structure is built at all. else,
+    // the range of the function is divided into a number of uniform buckets and for
+    // each bucket boundary, the index of the segment which contains it is stored. the
+    // segment of a given position can then be found by looking at the segments
+    // between the two boundaries of the bucket which contains it. since the number of
+    // buckets is larger than the number of segments, this range usually consists of
+    // only one or two segments even if the sampling points are not uniform.
+    void updateSegmentIndex_()
+    {
+        shape_ = classifyCurve(xValues_, yValues_);
+        segmentIndex_.clear();
+        invBucketWidth_ = 0.0;
+
+        int n = numSamples();
+        if (shape_ != GeneralCurve)
+            // no segment needs to be searched
+            return;
+        if (n < minSamplesForSegmentIndex_ || !(xValues_.front() < xValues_.back()))
+            // for small tables, plain bisection is as fast as using the index
+            return;
+
+        int numBuckets = 2*(n - 1);
+        Scalar xMin = xValues_.front();
+        Scalar bucketWidth = (xValues_.back() - xMin)/numBuckets;
+        invBucketWidth_ = 1.0/bucketWidth;
+
+        segmentIndex_.resize(numBuckets + 1);
+        int segIdx = 0;
+        for (int bucketIdx = 0; bucketIdx <= numBuckets; ++bucketIdx) {
+            Scalar xBoundary = xMin + bucketIdx*bucketWidth;
+            while (segIdx < n - 2 && xValues_[segIdx + 1] <= xBoundary)
+                ++ segIdx;
+            segmentIndex_[bucketIdx] = segIdx;
+        }
+    }
+
+    // the number of entries of a batch which are processed at once. this limits the
+    // amount of temporary space required on the stack.
+    enum { batchChunkSize_ = 64 };
+
+    // the minimum number of sampling points for which the segment index is used
+    enum { minSamplesForSegmentIndex_ = 16 };
+
+    // determine the segment indices for an array of positions. the search is started
+    // at the segment of the previous entry, i.e., if consecutive positions are
+    // located in the same segment, no bisection is required.
+    void findSegmentIndices_(const Scalar* x, int* segIdx, size_t n, bool extrapolate) const
+    {
+        const int lastSegIdx = lastSegmentIdx_();
+        int curSegIdx = 0;
+        for (size_t i = 0; i < n; ++i) {
+            Scalar xi = x[i];
+            if (extrapolate && xi < xValues_.front())
+                curSegIdx = 0;
+            else if (extrapolate && xi > xValues_.back())
+                curSegIdx = lastSegIdx;
+            else {
+                assert(xValues_.front() <= xi && xi <= xValues_.back());
+                if (!(xValues_[curSegIdx] <= xi && xi <= xValues_[curSegIdx + 1]))
+                    curSegIdx = findSegmentIndex_(xi);
+            }
+            segIdx[i] = curSegIdx;
+        }
+    }
+
+#if OPM_MATERIAL_HAVE_SIMD_PACK
+    // determine the segment index of each lane of a SIMD pack
+    template <class Pack>
+    void findPackSegmentIndices_(const Pack& x, int* segIdx, bool extrapolate) const
+    {
+        Scalar xLanes[Pack::size()];
+        for (unsigned laneIdx = 0; laneIdx < Pack::size(); ++laneIdx) {
+            xLanes[laneIdx] = x[laneIdx];
+            countLookup_(xLanes[laneIdx]);
+        }
+        findSegmentIndices_(xLanes, segIdx, Pack::size(), extrapolate);
+    }
+
+    // gather the left sampling point, the slope and the value at the left sampling
+    // point of the segment of each lane into packs. for cubic interpolation, the
+    // tangent of the function at the position of the lane is gathered instead.
+    template <class Pack>
+    void gatherSegments_(const Pack& x, const int* segIdx, Pack& x0, Pack& m, Pack& y0) const
+    {
+        for (unsigned laneIdx = 0; laneIdx < Pack::size(); ++laneIdx) {
+            int i = segIdx[laneIdx];
+            if (useSlopes_()) {
+                Scalar xLane = x[laneIdx];
+                Scalar dydx;
+                x0[laneIdx] = xLane;
+                y0[laneIdx] = evalCubicSegment_(xLane, i, dydx);
+                m[laneIdx] = dydx;
+                continue;
             }
 
-            assert(xValues_[segmentIdx] <= x);
-            assert(x <= xValues_[segmentIdx + 1]);
-            return segmentIdx;
+            Scalar xLeft = xValues_[i];
+            Scalar yLeft = yValues_[i];
+            x0[laneIdx] = xLeft;
+            y0[laneIdx] = yLeft;
+            m[laneIdx] = (yValues_[i + 1] - yLeft)/(xValues_[i + 1] - xLeft);
+        }
+    }
+#endif // OPM_MATERIAL_HAVE_SIMD_PACK
+
+    Scalar evalSegment_(Scalar x, int segIdx) const
+    {
+        if (useSlopes_()) {
+            Scalar dydx;
+            return evalCubicSegment_(x, segIdx, dydx);
         }
+
+        Scalar x0 = xValues_[segIdx];
+        Scalar x1 = xValues_[segIdx + 1];
+
+        Scalar y0 = yValues_[segIdx];
+        Scalar y1 = yValues_[segIdx + 1];
+
+        // this must use exactly the same floating point operations as the value of
+        // the Evaluation variant below. Otherwise, value-only evaluations do not
+        // reproduce the values of evaluations which consider derivatives.
+        Scalar m = (y1 - y0)/(x1 - x0);
+        return y0 + m*(x - x0);
+    }
+
+    template <class Evaluation>
+    Evaluation evalSegment_(const Evaluation& x, int segIdx) const
+    {
+        Evaluation result;
+        Scalar m;
+        if (useSlopes_())
+            result.value = evalCubicSegment_(x.value, segIdx, m);
+        else {
+            Scalar x0 = xValues_[segIdx];
+            Scalar x1 = xValues_[segIdx + 1];
+
+            Scalar y0 = yValues_[segIdx];
+            Scalar y1 = yValues_[segIdx + 1];
+
+            m = (y1 - y0)/(x1 - x0);
+            result.value = y0 + m*(x.value - x0);
+        }
+
+        for (unsigned varIdx = 0; varIdx < result.derivatives.size(); ++varIdx)
+            result.derivatives[varIdx] = m*x.derivatives[varIdx];
+
+        return result;
     }
 
     Scalar evalDerivative_(Scalar x, int segIdx) const
     {
+        if (useSlopes_()) {
+            Scalar dydx;
+            evalCubicSegment_(x, segIdx, dydx);
+            return dydx;
+        }
+
         Scalar x0 = xValues_[segIdx];
         Scalar x1 = xValues_[segIdx + 1];
 
@@ -523,6 +1172,112 @@ private:
         return (y1 - y0)/(x1 - x0);
     }
 
+    // returns true iff the slopes at the sampling points are used for the evaluation,
+    // i.e., if the function is interpolated using cubic polynomials
+    bool useSlopes_() const
+    { return !slopes_.empty(); }
+
+    // computes the coefficients of the quadratic and the cubic terms of a segment
+    // polynomial. returns false if the position is located beyond the range of the
+    // function, where it is extrapolated linearly.
+    bool cubicCoefficients_(Scalar x, int segIdx, Scalar& c2, Scalar& c3) const
+    {
+        Scalar x0 = xValues_[segIdx];
+        Scalar x1 = xValues_[segIdx + 1];
+        if (x < x0 || x > x1)
+            return false;
+
+        Scalar h = x1 - x0;
+        Scalar delta = (yValues_[segIdx + 1] - yValues_[segIdx])/h;
+        Scalar d0 = slopes_[segIdx];
+        Scalar d1 = slopes_[segIdx + 1];
+        c2 = (3*delta - 2*d0 - d1)/h;
+        c3 = (d0 + d1 - 2*delta)/(h*h);
+        return true;
+    }
+
+    // evaluate the cubic Hermite polynomial of a segment and its derivative. beyond the
+    // range of the function, the tangent at the first or at the last sampling point is
+    // used, so that the function stays continuously differentiable. the value and the
+    // derivative are computed by the same operations regardless of whether the
+    // derivative is required, so that all variants of eval() yield the same values.
+    Scalar evalCubicSegment_(Scalar x, int segIdx, Scalar& dydx) const
+    {
+        Scalar x0 = xValues_[segIdx];
+        Scalar x1 = xValues_[segIdx + 1];
+        Scalar y0 = yValues_[segIdx];
+        Scalar d0 = slopes_[segIdx];
+        if (x < x0) {
+            dydx = d0;
+            return y0 + d0*(x - x0);
+        }
+        if (x > x1) {
+            dydx = slopes_[segIdx + 1];
+            return yValues_[segIdx + 1] + dydx*(x - x1);
+        }
+
+        Scalar c2, c3;
+        cubicCoefficients_(x, segIdx, c2, c3);
+        Scalar dx = x - x0;
+        dydx = d0 + dx*(2*c2 + 3*c3*dx);
+        return y0 + dx*(d0 + dx*(c2 + dx*c3));
+    }
+
+    // compute the slopes of the function at the sampling points which are required for
+    // monotone cubic interpolation. these are zero at local extrema and a weighted
+    // harmonic mean of the slopes of the adjacent segments elsewhere. at the first and
+    // the last sampling point, a three-point formula is used which is limited such that
+    // the function does not overshoot (Fritsch and Butland, 1984; Moler, 2004).
+    void updateSlopes_()
+    {
+        slopes_.clear();
+        int n = numSamples();
+        if (interpolationMode_ != MonotoneCubicInterpolation || shape_ != GeneralCurve)
+            return;
+
+        slopes_.resize(n);
+        if (n == 2) {
+            slopes_[0] = slopes_[1] = (yValues_[1] - yValues_[0])/(xValues_[1] - xValues_[0]);
+            return;
+        }
+
+        for (int i = 1; i < n - 1; ++i) {
+            Scalar hLeft = xValues_[i] - xValues_[i - 1];
+            Scalar hRight = xValues_[i + 1] - xValues_[i];
+            Scalar deltaLeft = (yValues_[i] - yValues_[i - 1])/hLeft;
+            Scalar deltaRight = (yValues_[i + 1] - yValues_[i])/hRight;
+            if (deltaLeft*deltaRight <= 0.0) {
+                slopes_[i] = 0.0;
+                continue;
+            }
+
+            Scalar wLeft = 2*hRight + hLeft;
+            Scalar wRight = hRight + 2*hLeft;
+            slopes_[i] = (wLeft + wRight)/(wLeft/deltaLeft + wRight/deltaRight);
+        }
+
+        slopes_[0] = endpointSlope_(xValues_[1] - xValues_[0],
+                                    xValues_[2] - xValues_[1],
+                                    (yValues_[1] - yValues_[0])/(xValues_[1] - xValues_[0]),
+                                    (yValues_[2] - yValues_[1])/(xValues_[2] - xValues_[1]));
+        slopes_[n - 1] = endpointSlope_(xValues_[n - 1] - xValues_[n - 2],
+                                        xValues_[n - 2] - xValues_[n - 3],
+                                        (yValues_[n - 1] - yValues_[n - 2])/(xValues_[n - 1] - xValues_[n - 2]),
+                                        (yValues_[n - 2] - yValues_[n - 3])/(xValues_[n - 2] - xValues_[n - 3]));
+    }
+
+    // the shape-preserving three-point estimate of the slope at an end of the function.
+    // h0 and delta0 refer to the segment at the end, h1 and delta1 to its neighbor.
+    static Scalar endpointSlope_(Scalar h0, Scalar h1, Scalar delta0, Scalar delta1)
+    {
+        Scalar d = ((2*h0 + h1)*delta0 - h0*delta1)/(h0 + h1);
+        if (d*delta0 <= 0.0)
+            return 0.0;
+        if (delta0*delta1 <= 0.0 && std::abs(d) > std::abs(3*delta0))
+            return 3*delta0;
+        return d;
+    }
+
     // returns the monotonicity of a segment
     //
     // The return value have the following meaning:
@@ -558,14 +1313,14 @@ private:
      */
     struct ComparatorX_
     {
-        ComparatorX_(const std::vector<Scalar> &x)
+        ComparatorX_(const ScalarVector &x)
             : x_(x)
         {};
 
         bool operator ()(int idxA, int idxB) const
         { return x_.at(idxA) < x_.at(idxB); }
 
-        const std::vector<Scalar> &x_;
+        const ScalarVector &x_;
     };
 
     /*!
@@ -586,7 +1341,7 @@ private:
         std::sort(idxVector.begin(), idxVector.end(), cmp);
 
         // reorder the sample points
-        std::vector<Scalar> tmpX(n), tmpY(n);
+        ScalarVector tmpX(n), tmpY(n);
         for (size_t i = 0; i < idxVector.size(); ++ i) {
             tmpX[i] = xValues_[idxVector[i]];
             tmpY[i] = yValues_[idxVector[i]];
@@ -618,8 +1373,22 @@ private:
         yValues_.resize(nSamples);
     }
 
-    std::vector<Scalar> xValues_;
-    std::vector<Scalar> yValues_;
+    ScalarVector xValues_;
+    ScalarVector yValues_;
+
+    // acceleration structure for findSegmentIndex_(): the index of the segment for
+    // each boundary of a set of uniform buckets.
+    IntVector segmentIndex_;
+    Scalar invBucketWidth_;
+
+    // the shape of the function, set by updateSegmentIndex_()
+    CurveShape shape_;
+
+    // the scheme used for interpolating between the sampling points and the slopes at
+    // the sampling points which are required for cubic interpolation. if the function
+    // is interpolated linearly, no slopes are stored.
+    TabulatedInterpolation interpolationMode_;
+    ScalarVector slopes_;
 };
 } // namespace Opm
 
@@ -34,6 +34,9 @@
 
 namespace Opm {
 
+template <class Scalar>
+class TridiagonalFactorization;
+
 /*!
  * \brief Provides a tridiagonal matrix that also supports non-zero
  *        entries in the upper right and lower left
@@ -47,6 +50,8 @@ namespace Opm {
 template <class Scalar>
 class TridiagonalMatrix
 {
+    friend class TridiagonalFactorization<Scalar>;
+
     struct TridiagRow_ {
         TridiagRow_(TridiagonalMatrix &m, size_t rowIdx)
             : matrix_(m)
@@ -706,16 +711,13 @@ public:
      * \brief Calculate the solution for a linear system of equations
      *
      * i.e., calculate x, so that it solves Ax = b, where A is a
-     * tridiagonal matrix.
+     * tridiagonal matrix. This decomposes the matrix each time it is
+     * called, use TridiagonalFactorization to solve for multiple right
+     * hand sides.
      */
     template <class XVector, class BVector>
     void solve(XVector &x, const BVector &b) const
-    {
-        if (size() > 2 && diag_[2][0] != 0)
-            solveWithUpperRight_(x, b);
-        else
-            solveWithoutUpperRight_(x, b);
-    }
+    { TridiagonalFactorization<Scalar>(*this).solve(x, b); }
 
     /*!
      * \brief Print the matrix to a given output stream.
@@ -758,85 +760,183 @@ public:
     }
 
 private:
-    template <class XVector, class BVector>
-    void solveWithUpperRight_(XVector &x, const BVector &b) const
-    {
-        size_t n = size();
-
-        std::vector<Scalar> lowerDiag(diag_[0]), mainDiag(diag_[1]), upperDiag(diag_[2]), lastColumn(n);
-        std::vector<Scalar> bStar(n);
-        std::copy(b.begin(), b.end(), bStar.begin());
+    mutable std::vector<Scalar> diag_[3];
+};
 
-        lastColumn[0] = upperDiag[0];
+/*!
+ * \brief The LU decomposition of a TridiagonalMatrix.
+ *
+ * In contrast to TridiagonalMatrix::solve(), the matrix is only decomposed once
+ * and the decomposition can then be used to solve for an arbitrary number of
+ * right hand sides, e.g., if a spline is fitted repeatedly for the same sampling
+ * points but different values. The entries on the lower left and upper right are
+ * considered, i.e., periodic systems are supported.
+ *
+ * No pivoting is done, so the matrix should be diagonally dominant. This is the
+ * case for the systems which result from splines.
+ */
+template <class Scalar>
+class TridiagonalFactorization
+{
+public:
+    TridiagonalFactorization()
+    { }
 
-        // forward elimination
-        for (size_t i = 1; i < n; ++i) {
-            Scalar alpha = lowerDiag[i - 1]/mainDiag[i - 1];
+    explicit TridiagonalFactorization(const TridiagonalMatrix<Scalar> &M)
+    { factorize(M); }
 
-            lowerDiag[i - 1] -= alpha * mainDiag[i - 1];
-            mainDiag[i] -= alpha * upperDiag[i];
+    /*!
+     * \brief Return the number of rows/columns of the decomposed matrix.
+     */
+    size_t size() const
+    { return u_.size(); }
 
-            bStar[i] -= alpha * bStar[i - 1];
-        };
+    /*!
+     * \brief Decompose a matrix.
+     */
+    void factorize(const TridiagonalMatrix<Scalar> &M)
+    {
+        const std::vector<Scalar> *diag = M.diag_;
+        size_t n = M.size();
+
+        u_.resize(n);
+        l_.resize(n);
+        lastRow_.resize(n);
+        lastColumn_.resize(n);
+        upperDiag_.resize(n);
+        if (n == 0)
+            return;
 
-        // deal with the last row if the entry on the lower left is not zero
-        if (lowerDiag[n - 1] != 0.0 && size() > 2) {
-            Scalar lastRow = lowerDiag[n - 1];
-            for (size_t i = 0; i < n - 1; ++i) {
-                Scalar alpha = lastRow/mainDiag[i];
-                lastRow = - alpha*upperDiag[i + 1];
-                bStar[n - 1] -= alpha * bStar[i];
-            }
+        u_[0] = diag[1][0];
+        if (n == 1)
+            return;
 
-            mainDiag[n-1] += lastRow;
+        // the entries on the lower left and the upper right only exist for more than
+        // two rows
+        Scalar lowerLeft = (n > 2)?diag[0][n - 1]:Scalar(0.0);
+        Scalar upperRight = (n > 2)?diag[2][0]:Scalar(0.0);
+
+        // the upper diagonal of U is the one of the matrix. the last column of U
+        // also holds its entry in row n - 2
+        for (size_t i = 0; i + 2 < n; ++i)
+            upperDiag_[i] = diag[2][i + 1];
+
+        // eliminate the lower diagonal from row 1 to n - 2. this produces fill-in in
+        // the last column if the upper right entry is non-zero
+        lastColumn_[0] = upperRight;
+        for (size_t i = 1; i + 1 < n; ++i) {
+            l_[i - 1] = diag[0][i - 1]/u_[i - 1];
+            u_[i] = diag[1][i] - l_[i - 1]*upperDiag_[i - 1];
+            lastColumn_[i] = -l_[i - 1]*lastColumn_[i - 1];
         }
-
-        // backward elimination
-        x[n - 1] = bStar[n - 1]/mainDiag[n-1];
-        for (int i = n - 2; i >= 0; --i) {
-            x[i] = (bStar[i] - x[i + 1]*upperDiag[i+1] - x[n-1]*lastColumn[i])/mainDiag[i];
+        lastColumn_[n - 2] += diag[2][n - 1];
+
+        // eliminate the last row, which exhibits fill-in if the lower left entry is
+        // non-zero
+        Scalar r = lowerLeft;
+        Scalar uLast = diag[1][n - 1];
+        for (size_t j = 0; j + 1 < n; ++j) {
+            if (j + 2 == n)
+                r += diag[0][n - 2];
+            lastRow_[j] = r/u_[j];
+            uLast -= lastRow_[j]*lastColumn_[j];
+            r = -lastRow_[j]*upperDiag_[j];
         }
+        u_[n - 1] = uLast;
     }
 
+    /*!
+     * \brief Calculate the solution for a right hand side.
+     *
+     * I.e., calculate x, so that it solves Ax = b, where A is the decomposed
+     * matrix. x and b may be the same object.
+     */
     template <class XVector, class BVector>
-    void solveWithoutUpperRight_(XVector &x, const BVector &b) const
+    void solve(XVector &x, const BVector &b) const
     {
         size_t n = size();
+        if (n == 0)
+            return;
 
-        std::vector<Scalar> lowerDiag(diag_[0]), mainDiag(diag_[1]), upperDiag(diag_[2]);
-        std::vector<Scalar> bStar(n);
-        std::copy(b.begin(), b.end(), bStar.begin());
-
-        // forward elimination
-        for (size_t i = 1; i < n; ++i) {
-            Scalar alpha = lowerDiag[i - 1]/mainDiag[i - 1];
-
-            lowerDiag[i - 1] -= alpha * mainDiag[i - 1];
-            mainDiag[i] -= alpha * upperDiag[i];
+        // forward substitution
+        Scalar yLast = b[n - 1];
+        x[0] = b[0];
+        for (size_t i = 1; i + 1 < n; ++i)
+            x[i] = b[i] - l_[i - 1]*x[i - 1];
+        for (size_t j = 0; j + 1 < n; ++j)
+            yLast -= lastRow_[j]*x[j];
+
+        // backward substitution
+        x[n - 1] = yLast/u_[n - 1];
+        if (n == 1)
+            return;
+        x[n - 2] = (x[n - 2] - lastColumn_[n - 2]*x[n - 1])/u_[n - 2];
+        for (int i = static_cast<int>(n) - 3; i >= 0; --i)
+            x[i] = (x[i] - upperDiag_[i]*x[i + 1] - lastColumn_[i]*x[n - 1])/u_[i];
+    }
 
-            bStar[i] -= alpha * bStar[i - 1];
-        };
+    /*!
+     * \brief Calculate the solutions for multiple right hand sides.
+     *
+     * The right hand sides and the solutions are stored in row-major order, i.e., the
+     * entry of the k-th vector in row i is located at index i*numRhs + k. This way,
+     * the innermost loops run over the right hand sides and can be vectorized. X and
+     * B may point to the same memory.
+     *
+     * \param X The array for the solutions. It must hold size()*numRhs entries.
+     * \param B The array of the right hand sides
+     * \param numRhs The number of right hand sides
+     */
+    void solveBatch(Scalar *X, const Scalar *B, size_t numRhs) const
+    {
+        size_t n = size();
+        if (n == 0)
+            return;
 
-        // deal with the last row if the entry on the lower left is not zero
-        if (lowerDiag[n - 1] != 0.0 && size() > 2) {
-            Scalar lastRow = lowerDiag[n - 1];
-            for (size_t i = 0; i < n - 1; ++i) {
-                Scalar alpha = lastRow/mainDiag[i];
-                lastRow = - alpha*upperDiag[i + 1];
-                bStar[n - 1] -= alpha * bStar[i];
-            }
+        std::vector<Scalar> yLast(B + (n - 1)*numRhs, B + n*numRhs);
 
-            mainDiag[n-1] += lastRow;
+        // forward substitution
+        for (size_t k = 0; k < numRhs; ++k)
+            X[k] = B[k];
+        for (size_t i = 1; i + 1 < n; ++i) {
+            const Scalar alpha = l_[i - 1];
+            for (size_t k = 0; k < numRhs; ++k)
+                X[i*numRhs + k] = B[i*numRhs + k] - alpha*X[(i - 1)*numRhs + k];
+        }
+        for (size_t j = 0; j + 1 < n; ++j) {
+            const Scalar alpha = lastRow_[j];
+            for (size_t k = 0; k < numRhs; ++k)
+                yLast[k] -= alpha*X[j*numRhs + k];
         }
 
-        // backward elimination
-        x[n - 1] = bStar[n - 1]/mainDiag[n-1];
-        for (int i = n - 2; i >= 0; --i) {
-            x[i] = (bStar[i] - x[i + 1]*upperDiag[i+1])/mainDiag[i];
+        // backward substitution
+        Scalar *xLast = X + (n - 1)*numRhs;
+        for (size_t k = 0; k < numRhs; ++k)
+            xLast[k] = yLast[k]/u_[n - 1];
+        if (n == 1)
+            return;
+        for (int i = static_cast<int>(n) - 2; i >= 0; --i) {
+            Scalar *xi = X + i*numRhs;
+            const Scalar *xNext = xi + numRhs;
+            const Scalar upper = (i + 2 == static_cast<int>(n))?Scalar(0.0):upperDiag_[i];
+            const Scalar last = lastColumn_[i];
+            const Scalar uInv = 1.0/u_[i];
+            for (size_t k = 0; k < numRhs; ++k)
+                xi[k] = (xi[k] - upper*xNext[k] - last*xLast[k])*uInv;
         }
     }
 
-    mutable std::vector<Scalar> diag_[3];
+private:
+    // the diagonal of U
+    std::vector<Scalar> u_;
+    // the lower diagonal of L, except for the last row
+    std::vector<Scalar> l_;
+    // the last row of L
+    std::vector<Scalar> lastRow_;
+    // the last column of U, except for its diagonal entry
+    std::vector<Scalar> lastColumn_;
+    // the upper diagonal of U, except for its entry in the last column
+    std::vector<Scalar> upperDiag_;
 };
 
 } // namespace Opm
@@ -0,0 +1,336 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::UniformMonotoneTable
+ */
+#ifndef OPM_UNIFORM_MONOTONE_TABLE_HPP
+#define OPM_UNIFORM_MONOTONE_TABLE_HPP
+
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/Exceptions.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief A piecewise cubic function of one variable which is sampled on a uniform
+ *        grid and preserves the monotonicity of the sampled values.
+ *
+ * The function is tabulated by calling init() with a functor. Unless the derivative
+ * of the function is passed as well, the slopes at the sampling points are estimated
+ * from the sampled values. In either case, they are limited using the criterion of
+ * Fritsch and Carlson (1980), so the interpolant is monotonic wherever the sampled
+ * values are. This also makes the table usable for curves which exhibit infinite
+ * derivatives at the end points, like many relative permeability laws.
+ *
+ * Since the grid is uniform, the segment of a position is determined by a single
+ * multiplication, i.e., evaluating the table does not involve any search and the
+ * batched version of eval() can be vectorized by the compiler.
+ *
+ * The accuracy of the table is estimated by init() by comparing the interpolant
+ * with the functor at three points within each segment. For functions which are
+ * smooth, this error decreases with the third power of the segment length if the
+ * slopes are estimated and with the fourth power if the derivative is given.
+ *
+ * \tparam Scalar The type used for scalar values
+ */
+template <class Scalar>
+class UniformMonotoneTable
+{
+public:
+    UniformMonotoneTable()
+        : xMin_(0.0)
+        , xMax_(0.0)
+        , h_(0.0)
+        , hInv_(0.0)
+        , yMin_(0.0)
+        , yMax_(0.0)
+        , slopeMin_(0.0)
+        , slopeMax_(0.0)
+        , maxError_(0.0)
+    {}
+
+    /*!
+     * \brief Tabulate a function on a uniform grid.
+     *
+     * \param xMin The lower end of the tabulated range
+     * \param xMax The upper end of the tabulated range
+     * \param numSamples The number of sampling points (must be >= 2)
+     * \param fn The function which ought to be tabulated. It must be callable with a
+     *           Scalar argument and return a Scalar.
+     */
+    template <class Functor>
+    void init(Scalar xMin, Scalar xMax, unsigned numSamples, const Functor& fn)
+    { init_(xMin, xMax, numSamples, fn, static_cast<const Functor*>(nullptr)); }
+
+    /*!
+     * \brief Tabulate a function on a uniform grid using its known derivative.
+     *
+     * The slopes at the sampling points are taken from the derivative instead of
+     * being estimated from the sampled values. They are still limited where this is
+     * required to preserve monotonicity, but for smooth functions this usually does
+     * not happen and the error of the table then decreases with the fourth power of
+     * the segment length.
+     *
+     * \param xMin The lower end of the tabulated range
+     * \param xMax The upper end of the tabulated range
+     * \param numSamples The number of sampling points (must be >= 2)
+     * \param fn The function which ought to be tabulated. It must be callable with a
+     *           Scalar argument and return a Scalar.
+     * \param derivFn The derivative of the function. It must be callable with a
+     *                Scalar argument and return a Scalar.
+     */
+    template <class Functor, class DerivFunctor>
+    void init(Scalar xMin, Scalar xMax, unsigned numSamples,
+              const Functor& fn, const DerivFunctor& derivFn)
+    { init_(xMin, xMax, numSamples, fn, &derivFn); }
+
+    /*!
+     * \brief Specify the slopes of the straight lines which are used to extrapolate
+     *        the function beyond the tabulated range.
+     *
+     * By default, the estimated slopes at the end points are used. This method must
+     * be called after init().
+     */
+    void setExtrapolationSlopes(Scalar slopeMin, Scalar slopeMax)
+    {
+        slopeMin_ = slopeMin;
+        slopeMax_ = slopeMax;
+    }
+
+    /*!
+     * \brief Returns true if the function has been tabulated.
+     */
+    bool isInitialized() const
+    { return !coeffs_.empty(); }
+
+    /*!
+     * \brief Returns the number of sampling points.
+     */
+    unsigned numSamples() const
+    { return static_cast<unsigned>(coeffs_.size()/4 + 1); }
+
+    /*!
+     * \brief Returns the lower end of the tabulated range.
+     */
+    Scalar xMin() const
+    { return xMin_; }
+
+    /*!
+     * \brief Returns the upper end of the tabulated range.
+     */
+    Scalar xMax() const
+    { return xMax_; }
+
+    /*!
+     * \brief Returns the estimated maximum deviation of the interpolant from the
+     *        tabulated function within the tabulated range.
+     */
+    Scalar maxError() const
+    { return maxError_; }
+
+    /*!
+     * \brief Evaluate the tabulated function.
+     *
+     * \param x The position where the function ought to be evaluated
+     * \param extrapolate If true, the function is continued beyond the tabulated range
+     *                    by straight lines using the slopes at the end points. If
+     *                    false, it is continued by the constant values at the end
+     *                    points.
+     */
+    template <class Evaluation>
+    Evaluation eval(const Evaluation& x, bool extrapolate = false) const
+    {
+        typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+        assert(isInitialized());
+
+        Scalar xv = Toolbox::value(x);
+        if (xv < xMin_) {
+            if (extrapolate)
+                return yMin_ + slopeMin_*(x - xMin_);
+            return Toolbox::createConstant(yMin_);
+        }
+        else if (xv > xMax_) {
+            if (extrapolate)
+                return yMax_ + slopeMax_*(x - xMax_);
+            return Toolbox::createConstant(yMax_);
+        }
+
+        // the polynomial is evaluated for the value only, the derivatives are
+        // then given by the chain rule. this is considerably cheaper than evaluating
+        // it for function evaluations.
+        int segIdx = segmentIndex_(xv);
+        const Scalar* c = &coeffs_[4*segIdx];
+        Scalar t = xv - xValue_(segIdx);
+        Scalar y = c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+        Scalar dydx = c[1] + t*(2*c[2] + t*3*c[3]);
+        return y + dydx*(x - xv);
+    }
+
+    /*!
+     * \brief Evaluate the tabulated function for a batch of positions.
+     *
+     * The positions are clamped to the tabulated range, i.e., the values at the end
+     * points are used for positions outside of it.
+     *
+     * \param x The array of positions where the function ought to be evaluated
+     * \param y The array in which the results are stored. It must be able to hold at
+     *          least n entries.
+     * \param n The number of positions which ought to be evaluated
+     */
+    void evalBatch(const Scalar* x, Scalar* y, size_t n) const
+    {
+        assert(isInitialized());
+
+        const Scalar* coeffs = coeffs_.data();
+        for (size_t i = 0; i < n; ++i) {
+            Scalar xc = std::min(std::max(x[i], xMin_), xMax_);
+            int segIdx = segmentIndex_(xc);
+            const Scalar* c = coeffs + 4*segIdx;
+            Scalar t = xc - xValue_(segIdx);
+            y[i] = c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+        }
+    }
+
+private:
+    template <class Functor, class DerivFunctor>
+    void init_(Scalar xMin, Scalar xMax, unsigned numSamples,
+               const Functor& fn, const DerivFunctor* derivFn)
+    {
+        if (numSamples < 2)
+            OPM_THROW(std::invalid_argument,
+                      "A uniform table needs at least two sampling points");
+        if (!(xMin < xMax))
+            OPM_THROW(std::invalid_argument,
+                      "The range of a uniform table must not be empty");
+
+        xMin_ = xMin;
+        xMax_ = xMax;
+        h_ = (xMax - xMin)/(numSamples - 1);
+        hInv_ = 1.0/h_;
+
+        int n = static_cast<int>(numSamples);
+        std::vector<Scalar> y(n);
+        std::vector<Scalar> m(n);
+        std::vector<Scalar> delta(n - 1);
+        for (int i = 0; i < n; ++i)
+            y[i] = fn(xValue_(i));
+        for (int i = 0; i < n - 1; ++i)
+            delta[i] = (y[i + 1] - y[i])*hInv_;
+
+        // the initial estimate of the slopes
+        if (derivFn) {
+            for (int i = 0; i < n; ++i)
+                m[i] = (*derivFn)(xValue_(i));
+        }
+        else {
+            m[0] = delta[0];
+            m[n - 1] = delta[n - 2];
+            for (int i = 1; i < n - 1; ++i) {
+                if (delta[i - 1]*delta[i] <= 0.0)
+                    m[i] = 0.0;
+                else
+                    m[i] = (delta[i - 1] + delta[i])/2;
+            }
+        }
+
+        // limit the slopes so that the interpolant is monotonic in each segment
+        for (int i = 0; i < n - 1; ++i) {
+            if (delta[i] == 0.0) {
+                m[i] = 0.0;
+                m[i + 1] = 0.0;
+                continue;
+            }
+
+            // given slopes may point into the wrong direction
+            if (m[i]*delta[i] < 0.0)
+                m[i] = 0.0;
+            if (m[i + 1]*delta[i] < 0.0)
+                m[i + 1] = 0.0;
+
+            Scalar a = m[i]/delta[i];
+            Scalar b = m[i + 1]/delta[i];
+            Scalar r2 = a*a + b*b;
+            if (r2 > 9.0) {
+                Scalar tau = 3.0/std::sqrt(r2);
+                m[i] = tau*a*delta[i];
+                m[i + 1] = tau*b*delta[i];
+            }
+        }
+
+        // convert the values and slopes into the polynomial coefficients of each
+        // segment w.r.t. the distance from its left end
+        coeffs_.resize(4*(n - 1));
+        for (int i = 0; i < n - 1; ++i) {
+            Scalar* c = &coeffs_[4*i];
+            c[0] = y[i];
+            c[1] = m[i];
+            c[2] = (3*delta[i] - 2*m[i] - m[i + 1])*hInv_;
+            c[3] = (m[i] + m[i + 1] - 2*delta[i])*hInv_*hInv_;
+        }
+        yMin_ = y[0];
+        yMax_ = y[n - 1];
+        slopeMin_ = m[0];
+        slopeMax_ = m[n - 1];
+
+        // estimate the deviation of the interpolant from the tabulated function
+        maxError_ = 0.0;
+        for (int i = 0; i < n - 1; ++i) {
+            for (int k = 1; k < 4; ++k) {
+                Scalar x = xValue_(i) + k*h_/4;
+                maxError_ = std::max(maxError_, std::abs(eval(x) - fn(x)));
+            }
+        }
+    }
+
+    Scalar xValue_(int i) const
+    { return xMin_ + i*h_; }
+
+    int segmentIndex_(Scalar x) const
+    {
+        assert(xMin_ <= x && x <= xMax_);
+        int numSegments = static_cast<int>(coeffs_.size()/4);
+        return std::min(static_cast<int>((x - xMin_)*hInv_), numSegments - 1);
+    }
+
+    Scalar xMin_;
+    Scalar xMax_;
+    Scalar h_;
+    Scalar hInv_;
+
+    Scalar yMin_;
+    Scalar yMax_;
+    Scalar slopeMin_;
+    Scalar slopeMax_;
+
+    Scalar maxError_;
+
+    std::vector<Scalar> coeffs_;
+};
+} // namespace Opm
+
+#endif
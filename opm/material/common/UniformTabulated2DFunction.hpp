@@ -29,8 +29,11 @@
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/Instrumentation.hpp>
 
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 #include <assert.h>
@@ -43,12 +46,29 @@ namespace Opm {
  *
  * This class can be used when the sampling points are calculated at
  * run time.
+ *
+ * \tparam Scalar The type used for scalar values
+ * \tparam Allocator The allocator used for the sampling points. This can be used to
+ *                   place the tables into shared memory (cf. SharedMemoryAllocator).
+ * \tparam StorageScalar The type used to store the values of the sampling points. If
+ *                       this is float, the memory footprint of the table is halved
+ *                       while the interpolation is still done using Scalar.
+ *
+ * The batched evaluation methods issue software prefetches for the sampling points
+ * which they are going to access if the compiler supports them. This can be disabled
+ * by defining the OPM_MATERIAL_DISABLE_PREFETCH macro.
  */
-template <class Scalar>
+template <class Scalar, class Allocator = std::allocator<Scalar>, class StorageScalar = Scalar>
 class UniformTabulated2DFunction
 {
 public:
     UniformTabulated2DFunction()
+        : m_(0)
+        , n_(0)
+        , xMin_(0.0)
+        , xMax_(0.0)
+        , yMin_(0.0)
+        , yMax_(0.0)
     { }
 
      /*!
@@ -179,18 +199,11 @@ public:
     template <class Evaluation>
     Evaluation eval(const Evaluation& x, const Evaluation& y) const
     {
+        OPM_INSTRUMENT_SCOPE("UniformTabulated2DFunction::eval");
         typedef MathToolbox<Evaluation> Toolbox;
 
 #ifndef NDEBUG
-        if (!applies(x,y))
-        {
-            OPM_THROW(NumericalIssue,
-                       "Attempt to get tabulated value for ("
-                       << x << ", " << y
-                       << ") on a table of extend "
-                       << xMin() << " to " << xMax() << " times "
-                       << yMin() << " to " << yMax());
-        };
+        checkApplies_(x, y);
 #endif
 
         Evaluation alpha = xToI(x);
@@ -208,6 +221,121 @@ public:
         return s1*(1.0 - beta) + s2*beta;
     }
 
+    /*!
+     * \brief Evaluate the function for a batch of positions.
+     *
+     * This is equivalent to calling eval() for each pair of entries of the x and y
+     * arrays, but the batch is processed in chunks: First, the cell indices and the
+     * interpolation weights of all entries of a chunk are computed in a loop which the
+     * compiler can vectorize, and the sampling points of the cells are prefetched. Then
+     * the sampling points are gathered and interpolated. Since the memory accesses of
+     * the entries do not depend on each other, their latencies overlap.
+     *
+     * \param x The array of the positions on the x-axis
+     * \param y The array of the positions on the y-axis
+     * \param result The array in which the results are stored. It must be able to hold
+     *               at least n entries.
+     * \param n The number of positions which ought to be evaluated
+     */
+    void evalBatch(const Scalar* x, const Scalar* y, Scalar* result, size_t n) const
+    {
+        OPM_INSTRUMENT_SCOPE("UniformTabulated2DFunction::evalBatch");
+        int cellIdx[batchChunkSize_];
+        Scalar alpha[batchChunkSize_];
+        Scalar beta[batchChunkSize_];
+        for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += batchChunkSize_) {
+            size_t chunkSize = std::min<size_t>(batchChunkSize_, n - chunkBegin);
+
+            findCells_(x + chunkBegin, y + chunkBegin, cellIdx, alpha, beta, chunkSize);
+
+            Scalar* resultChunk = result + chunkBegin;
+            for (size_t k = 0; k < chunkSize; ++k) {
+                const StorageScalar* cell = samples_.data() + cellIdx[k];
+                Scalar s00 = cell[0];
+                Scalar s10 = cell[1];
+                Scalar s01 = cell[m_];
+                Scalar s11 = cell[m_ + 1];
+
+                // use the same floating point operations as eval()
+                Scalar s1 = s00*(1.0 - alpha[k]) + s10*alpha[k];
+                Scalar s2 = s01*(1.0 - alpha[k]) + s11*alpha[k];
+                resultChunk[k] = s1*(1.0 - beta[k]) + s2*beta[k];
+            }
+        }
+    }
+
+    /*!
+     * \brief Evaluate the function and its derivatives for a batch of positions which
+     *        are given in structure-of-arrays layout.
+     *
+     * I.e., instead of using arrays of Evaluation objects, the values of the positions
+     * are passed as contiguous arrays and the derivatives w.r.t. each primary variable
+     * are passed as separate contiguous arrays. This allows the inner loops to run over
+     * the batch index and thus to be vectorized. Besides this, the batch is processed
+     * like by evalBatch(const Scalar*, const Scalar*, Scalar*, size_t).
+     *
+     * \param xValue The array of the values of the positions on the x-axis
+     * \param xDerivatives An array of numDerivatives pointers to the arrays which
+     *                     contain the derivatives of the positions on the x-axis
+     * \param yValue The array of the values of the positions on the y-axis
+     * \param yDerivatives An array of numDerivatives pointers to the arrays which
+     *                     contain the derivatives of the positions on the y-axis
+     * \param resultValue The array in which the resulting function values are stored
+     * \param resultDerivatives An array of numDerivatives pointers to the arrays in
+     *                          which the derivatives of the results are stored
+     * \param numDerivatives The number of derivatives of each position
+     * \param n The number of positions which ought to be evaluated
+     */
+    void evalBatch(const Scalar* xValue,
+                   const Scalar* const* xDerivatives,
+                   const Scalar* yValue,
+                   const Scalar* const* yDerivatives,
+                   Scalar* resultValue,
+                   Scalar* const* resultDerivatives,
+                   size_t numDerivatives,
+                   size_t n) const
+    {
+        OPM_INSTRUMENT_SCOPE("UniformTabulated2DFunction::evalBatch");
+        int cellIdx[batchChunkSize_];
+        Scalar alpha[batchChunkSize_];
+        Scalar beta[batchChunkSize_];
+        Scalar dResult_dx[batchChunkSize_];
+        Scalar dResult_dy[batchChunkSize_];
+
+        // the derivatives of the interval indices w.r.t. the positions
+        Scalar dAlpha_dx = (numX() - 1)/(xMax() - xMin());
+        Scalar dBeta_dy = (numY() - 1)/(yMax() - yMin());
+        for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += batchChunkSize_) {
+            size_t chunkSize = std::min<size_t>(batchChunkSize_, n - chunkBegin);
+
+            findCells_(xValue + chunkBegin, yValue + chunkBegin, cellIdx, alpha, beta, chunkSize);
+
+            Scalar* resultChunk = resultValue + chunkBegin;
+            for (size_t k = 0; k < chunkSize; ++k) {
+                const StorageScalar* cell = samples_.data() + cellIdx[k];
+                Scalar s00 = cell[0];
+                Scalar s10 = cell[1];
+                Scalar s01 = cell[m_];
+                Scalar s11 = cell[m_ + 1];
+
+                Scalar s1 = s00*(1.0 - alpha[k]) + s10*alpha[k];
+                Scalar s2 = s01*(1.0 - alpha[k]) + s11*alpha[k];
+                resultChunk[k] = s1*(1.0 - beta[k]) + s2*beta[k];
+
+                dResult_dx[k] = ((s10 - s00)*(1.0 - beta[k]) + (s11 - s01)*beta[k])*dAlpha_dx;
+                dResult_dy[k] = (s2 - s1)*dBeta_dy;
+            }
+
+            for (size_t varIdx = 0; varIdx < numDerivatives; ++varIdx) {
+                const Scalar* dxChunk = xDerivatives[varIdx] + chunkBegin;
+                const Scalar* dyChunk = yDerivatives[varIdx] + chunkBegin;
+                Scalar* dResultChunk = resultDerivatives[varIdx] + chunkBegin;
+                for (size_t k = 0; k < chunkSize; ++k)
+                    dResultChunk[k] = dResult_dx[k]*dxChunk[k] + dResult_dy[k]*dyChunk[k];
+            }
+        }
+    }
+
     /*!
      * \brief Get the value of the sample point which is at the
      *         intersection of the \f$i\f$-th interval of the x-Axis
@@ -231,14 +359,72 @@ public:
         assert(0 <= i && i < m_);
         assert(0 <= j && j < n_);
 
-        samples_[j*m_ + i] = value;
+        samples_[j*m_ + i] = static_cast<StorageScalar>(value);
     }
 
 private:
+    template <class Evaluation>
+    void checkApplies_(const Evaluation& x, const Evaluation& y) const
+    {
+        if (!applies(x,y))
+        {
+            OPM_THROW(NumericalIssue,
+                       "Attempt to get tabulated value for ("
+                       << x << ", " << y
+                       << ") on a table of extend "
+                       << xMin() << " to " << xMax() << " times "
+                       << yMin() << " to " << yMax());
+        };
+    }
+
+    // determine the index of the lower left sampling point of the cell and the
+    // position within the cell for an array of positions. the sampling points of the
+    // cells are prefetched, so that they are hopefully available once they are needed.
+    void findCells_(const Scalar* x,
+                    const Scalar* y,
+                    int* cellIdx,
+                    Scalar* alpha,
+                    Scalar* beta,
+                    size_t n) const
+    {
+#ifndef NDEBUG
+        for (size_t k = 0; k < n; ++k)
+            checkApplies_(x[k], y[k]);
+#endif
+
+        // clamping the interval indices before converting them to integers yields the
+        // same indices as eval() without any branches
+        Scalar maxI = numX() - 2;
+        Scalar maxJ = numY() - 2;
+        for (size_t k = 0; k < n; ++k) {
+            Scalar a = xToI(x[k]);
+            Scalar b = yToJ(y[k]);
+
+            int i = static_cast<int>(std::max(Scalar(0.0), std::min(maxI, a)));
+            int j = static_cast<int>(std::max(Scalar(0.0), std::min(maxJ, b)));
+
+            alpha[k] = a - i;
+            beta[k] = b - j;
+            cellIdx[k] = j*m_ + i;
+        }
+
+#if defined __GNUC__ && !defined OPM_MATERIAL_DISABLE_PREFETCH
+        for (size_t k = 0; k < n; ++k) {
+            const StorageScalar* cell = samples_.data() + cellIdx[k];
+            __builtin_prefetch(cell);
+            __builtin_prefetch(cell + m_);
+        }
+#endif
+    }
+
+    // the number of entries of a batch which are processed at once. this limits the
+    // amount of temporary space required on the stack.
+    enum { batchChunkSize_ = 64 };
+
     // the vector which contains the values of the sample points
     // f(x_i, y_j). don't use this directly, use getSamplePoint(i,j)
     // instead!
-    std::vector<Scalar> samples_;
+    std::vector<StorageScalar, typename std::allocator_traits<Allocator>::template rebind_alloc<StorageScalar>> samples_;
 
     // the number of sample points in x direction
     int m_;
@@ -0,0 +1,287 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::UniformTabulated2DMultiFunction
+ */
+#ifndef OPM_UNIFORM_TABULATED_2D_MULTI_FUNCTION_HPP
+#define OPM_UNIFORM_TABULATED_2D_MULTI_FUNCTION_HPP
+
+#include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Implements several scalar functions that depend on two variables and which are
+ *        sampled on the same uniform X-Y grid.
+ *
+ * The values of all functions at a sampling point are stored contiguously. Compared to
+ * using one UniformTabulated2DFunction per quantity, the cell and the interpolation
+ * weights of a position are thus only determined once if several quantities are
+ * required, and the values of the four sampling points of a cell are found in four
+ * contiguous blocks of memory instead of being scattered over all tables.
+ *
+ * \tparam Scalar The type used for scalar values
+ * \tparam numValues The number of functions which are tabulated
+ * \tparam Allocator The allocator used for the sampling points
+ */
+template <class Scalar, int numValues, class Allocator = std::allocator<Scalar> >
+class UniformTabulated2DMultiFunction
+{
+    static_assert(numValues > 0, "At least one function must be tabulated");
+
+public:
+    UniformTabulated2DMultiFunction()
+        : m_(0)
+        , n_(0)
+        , xMin_(0.0)
+        , xMax_(0.0)
+        , yMin_(0.0)
+        , yMax_(0.0)
+    { }
+
+    /*!
+     * \brief Resize the tabulation to a new range.
+     */
+    void resize(Scalar xMin, Scalar xMax, int m,
+                Scalar yMin, Scalar yMax, int n)
+    {
+        samples_.resize(m*n*numValues);
+
+        m_ = m;
+        n_ = n;
+
+        xMin_ = xMin;
+        xMax_ = xMax;
+
+        yMin_ = yMin;
+        yMax_ = yMax;
+    }
+
+    /*!
+     * \brief Returns the number of functions which are tabulated.
+     */
+    static int numFunctions()
+    { return numValues; }
+
+    /*!
+     * \brief Returns the minimum of the X coordinate of the sampling points.
+     */
+    Scalar xMin() const
+    { return xMin_; }
+
+    /*!
+     * \brief Returns the maximum of the X coordinate of the sampling points.
+     */
+    Scalar xMax() const
+    { return xMax_; }
+
+    /*!
+     * \brief Returns the minimum of the Y coordinate of the sampling points.
+     */
+    Scalar yMin() const
+    { return yMin_; }
+
+    /*!
+     * \brief Returns the maximum of the Y coordinate of the sampling points.
+     */
+    Scalar yMax() const
+    { return yMax_; }
+
+    /*!
+     * \brief Returns the number of sampling points in X direction.
+     */
+    int numX() const
+    { return m_; }
+
+    /*!
+     * \brief Returns the number of sampling points in Y direction.
+     */
+    int numY() const
+    { return n_; }
+
+    /*!
+     * \brief Return the position on the x-axis of the i-th interval.
+     */
+    Scalar iToX(int i) const
+    {
+        assert(0 <= i && i < numX());
+
+        return xMin() + i*(xMax() - xMin())/(numX() - 1);
+    }
+
+    /*!
+     * \brief Return the position on the y-axis of the j-th interval.
+     */
+    Scalar jToY(int j) const
+    {
+        assert(0 <= j && j < numY());
+
+        return yMin() + j*(yMax() - yMin())/(numY() - 1);
+    }
+
+    /*!
+     * \brief Returns true iff a coordinate lies in the tabulated range
+     */
+    template <class Evaluation>
+    bool applies(const Evaluation& x, const Evaluation& y) const
+    {
+        return
+            xMin() <= x && x <= xMax() &&
+            yMin() <= y && y <= yMax();
+    }
+
+    /*!
+     * \brief Evaluate all functions at a given (x,y) position.
+     *
+     * If this method is called for a value outside of the tabulated range, a
+     * \c Opm::NumericalIssue exception is thrown if the code is compiled in debug mode.
+     *
+     * \param x The position on the x-axis
+     * \param y The position on the y-axis
+     * \param values The array in which the values of the functions are stored. It must
+     *               be able to hold numValues entries.
+     */
+    template <class Evaluation>
+    void eval(const Evaluation& x, const Evaluation& y, Evaluation* values) const
+    {
+        const Scalar* s00;
+        Evaluation alpha, beta;
+        findCell_(x, y, s00, alpha, beta);
+
+        const Scalar* s10 = s00 + numValues;
+        const Scalar* s01 = s00 + m_*numValues;
+        const Scalar* s11 = s01 + numValues;
+
+        // bi-linear interpolation
+        const Evaluation& w00 = (1.0 - alpha)*(1.0 - beta);
+        const Evaluation& w10 = alpha*(1.0 - beta);
+        const Evaluation& w01 = (1.0 - alpha)*beta;
+        const Evaluation& w11 = alpha*beta;
+        for (int valueIdx = 0; valueIdx < numValues; ++valueIdx)
+            values[valueIdx] =
+                w00*s00[valueIdx] + w10*s10[valueIdx]
+                + w01*s01[valueIdx] + w11*s11[valueIdx];
+    }
+
+    /*!
+     * \brief Evaluate a single function at a given (x,y) position.
+     *
+     * \param x The position on the x-axis
+     * \param y The position on the y-axis
+     * \param valueIdx The index of the function
+     */
+    template <class Evaluation>
+    Evaluation eval(const Evaluation& x, const Evaluation& y, int valueIdx) const
+    {
+        assert(0 <= valueIdx && valueIdx < numValues);
+
+        const Scalar* s00;
+        Evaluation alpha, beta;
+        findCell_(x, y, s00, alpha, beta);
+
+        const Scalar* s01 = s00 + m_*numValues;
+        const Evaluation& v0 = s00[valueIdx]*(1.0 - alpha) + s00[numValues + valueIdx]*alpha;
+        const Evaluation& v1 = s01[valueIdx]*(1.0 - alpha) + s01[numValues + valueIdx]*alpha;
+        return v0*(1.0 - beta) + v1*beta;
+    }
+
+    /*!
+     * \brief Get the value of a function at the sample point which is at the
+     *        intersection of the \f$i\f$-th interval of the x-Axis and the \f$j\f$-th of
+     *        the y-Axis.
+     */
+    Scalar getSamplePoint(int i, int j, int valueIdx) const
+    {
+        assert(0 <= i && i < m_);
+        assert(0 <= j && j < n_);
+        assert(0 <= valueIdx && valueIdx < numValues);
+
+        return samples_[(j*m_ + i)*numValues + valueIdx];
+    }
+
+    /*!
+     * \brief Set the value of a function at the sample point which is at the
+     *        intersection of the \f$i\f$-th interval of the x-Axis and the \f$j\f$-th of
+     *        the y-Axis.
+     */
+    void setSamplePoint(int i, int j, int valueIdx, Scalar value)
+    {
+        assert(0 <= i && i < m_);
+        assert(0 <= j && j < n_);
+        assert(0 <= valueIdx && valueIdx < numValues);
+
+        samples_[(j*m_ + i)*numValues + valueIdx] = value;
+    }
+
+private:
+    // determine the values of the lower left sampling point of the cell which contains
+    // a position and the position within the cell
+    template <class Evaluation>
+    void findCell_(const Evaluation& x,
+                   const Evaluation& y,
+                   const Scalar*& s00,
+                   Evaluation& alpha,
+                   Evaluation& beta) const
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+#ifndef NDEBUG
+        if (!applies(x, y))
+            OPM_THROW(NumericalIssue,
+                      "Attempt to get tabulated value for ("
+                      << x << ", " << y
+                      << ") on a table of extend "
+                      << xMin() << " to " << xMax() << " times "
+                      << yMin() << " to " << yMax());
+#endif
+
+        alpha = (x - xMin())/(xMax() - xMin())*(numX() - 1);
+        beta = (y - yMin())/(yMax() - yMin())*(numY() - 1);
+
+        int i = std::max(0, std::min<int>(numX() - 2, Toolbox::value(alpha)));
+        int j = std::max(0, std::min<int>(numY() - 2, Toolbox::value(beta)));
+
+        alpha -= i;
+        beta -= j;
+        s00 = samples_.data() + (j*m_ + i)*numValues;
+    }
+
+    std::vector<Scalar, Allocator> samples_;
+    int m_;
+    int n_;
+    Scalar xMin_;
+    Scalar xMax_;
+    Scalar yMin_;
+    Scalar yMax_;
+};
+
+} // namespace Opm
+
+#endif
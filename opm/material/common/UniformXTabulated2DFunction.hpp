@@ -29,8 +29,14 @@
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/SegmentHint.hpp>
+#include <opm/material/common/Instrumentation.hpp>
+#include <opm/material/common/InterpolationWeights.hpp>
+#include <opm/material/common/TableHash.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <limits>
 #include <tuple>
@@ -46,11 +52,26 @@ namespace Opm {
  * "Uniform on the X-axis" means that all Y sampling points must be located along a line
  * for this value. This class can be used when the sampling points are calculated at run
  * time.
+ *
+ * Once all sampling points have been specified, finalize() should be called. This
+ * converts the table to a compact layout where the Y coordinates and the values of all
+ * columns are stored in two contiguous arrays, which speeds up the lookups
+ * considerably. After this, no sampling points can be added anymore.
+ *
+ * The Allocator template parameter can be used to place the compact layout into shared
+ * memory (cf. SharedMemoryAllocator). The storage used while the table is built always
+ * lives on the heap.
+ *
+ * The StorageScalar template parameter specifies the type used for the positions and
+ * the values of the compact layout. If it is float, the memory footprint of the table
+ * is halved while the interpolation is still done using Scalar.
  */
-template <class Scalar>
+template <class Scalar, class Allocator = std::allocator<Scalar>, class StorageScalar = Scalar>
 class UniformXTabulated2DFunction
 {
     typedef std::tuple</*x=*/Scalar, /*y=*/Scalar, /*value=*/Scalar> SamplePoint;
+    typedef std::vector<StorageScalar, typename std::allocator_traits<Allocator>::template rebind_alloc<StorageScalar>> ScalarVector;
+    typedef std::vector<int, typename std::allocator_traits<Allocator>::template rebind_alloc<int> > IntVector;
 
 public:
     UniformXTabulated2DFunction()
@@ -78,13 +99,21 @@ public:
      * \brief Returns the value of the Y coordinate of a sampling point.
      */
     Scalar yAt(int i, int j) const
-    { return std::get<1>(samples_[i][j]); }
+    {
+        if (isFinalized())
+            return yPos_[colOffsets_[i] + j];
+        return std::get<1>(samples_[i][j]);
+    }
 
     /*!
      * \brief Returns the value of a sampling point.
      */
     Scalar valueAt(int i, int j) const
-    { return std::get<2>(samples_[i][j]); }
+    {
+        if (isFinalized())
+            return values_[colOffsets_[i] + j];
+        return std::get<2>(samples_[i][j]);
+    }
 
     /*!
      * \brief Returns the number of sampling points in X direction.
@@ -96,19 +125,25 @@ public:
      * \brief Returns the minimum of the Y coordinate of the sampling points for a given column.
      */
     Scalar yMin(int i) const
-    { return std::get<1>(samples_.at(i).front()); }
+    { return yAt(i, 0); }
 
     /*!
      * \brief Returns the maximum of the Y coordinate of the sampling points for a given column.
      */
     Scalar yMax(int i) const
-    { return std::get<1>(samples_.at(i).back()); }
+    { return yAt(i, numY(i) - 1); }
 
     /*!
      * \brief Returns the number of sampling points in Y direction a given column.
      */
     int numY(int i) const
-    { return samples_.at(i).size(); }
+    {
+        assert(0 <= i && i < numX());
+
+        if (isFinalized())
+            return colOffsets_[i + 1] - colOffsets_[i];
+        return samples_[i].size();
+    }
 
     /*!
      * \brief Return the position on the x-axis of the i-th interval.
@@ -126,9 +161,9 @@ public:
     Scalar jToY(int i, int j) const
     {
         assert(0 <= i && i < numX());
-        assert(0 <= j && size_t(j) < samples_[i].size());
+        assert(0 <= j && j < numY(i));
 
-        return std::get<1>(samples_.at(i).at(j));
+        return yAt(i, j);
     }
 
     /*!
@@ -143,29 +178,7 @@ public:
     {
         assert(extrapolate || (xMin() <= x && x <= xMax()));
 
-        // we need at least two sampling points!
-        assert(xPos_.size() >= 2);
-
-        int segmentIdx;
-        if (x <= xPos_[1])
-            segmentIdx = 0;
-        else if (x >= xPos_[xPos_.size() - 2])
-            segmentIdx = xPos_.size() - 2;
-        else {
-            // bisection
-            segmentIdx = 1;
-            int upperIdx = xPos_.size() - 2;
-            while (segmentIdx + 1 < upperIdx) {
-                int pivotIdx = (segmentIdx + upperIdx) / 2;
-                if (x < xPos_[pivotIdx])
-                    upperIdx = pivotIdx;
-                else
-                    segmentIdx = pivotIdx;
-            }
-
-            assert(xPos_[segmentIdx] <= x);
-            assert(x <= xPos_[segmentIdx + 1]);
-        }
+        int segmentIdx = xSegmentIndex_(x);
 
         Scalar x1 = xPos_[segmentIdx];
         Scalar x2 = xPos_[segmentIdx + 1];
@@ -183,30 +196,16 @@ public:
     Scalar yToJ(int i, Scalar y, bool extrapolate = false) const
     {
         assert(0 <= i && i < numX());
-        const auto &colSamplePoints = samples_.at(i);
 
         assert(extrapolate || (yMin(i) <= y && y <= yMax(i)));
 
-        Scalar y1;
-        Scalar y2;
-
-        // interval halving
-        int lowerIdx = 0;
-        int upperIdx = int(colSamplePoints.size()) - 1;
-        int pivotIdx = (lowerIdx + upperIdx) / 2;
-        while (lowerIdx + 1 < upperIdx) {
-            if (y < std::get<1>(colSamplePoints[pivotIdx]))
-                upperIdx = pivotIdx;
-            else
-                lowerIdx = pivotIdx;
-            pivotIdx = (lowerIdx + upperIdx) / 2;
-        }
+        int lowerIdx = ySegmentIndex_(i, y);
 
-        y1 = std::get<1>(colSamplePoints[lowerIdx]);
-        y2 = std::get<1>(colSamplePoints[lowerIdx + 1]);
+        Scalar y1 = yAt(i, lowerIdx);
+        Scalar y2 = yAt(i, lowerIdx + 1);
 
         assert(y1 <= y || (extrapolate && lowerIdx == 0));
-        assert(y <= y2 || (extrapolate && lowerIdx == int(colSamplePoints.size()) - 2));
+        assert(y <= y2 || (extrapolate && lowerIdx == numY(i) - 2));
 
         return lowerIdx + (y - y1)/(y2 - y1);
     }
@@ -220,17 +219,15 @@ public:
             return false;
 
         Scalar i = xToI(x, /*extrapolate=*/false);
-        const auto &col1SamplePoints = samples_.at(int(i));
-        const auto &col2SamplePoints = samples_.at(int(i));
         Scalar alpha = i - int(i);
 
         Scalar yMin =
-                alpha*std::get<1>(col1SamplePoints.front()) +
-                (1 - alpha)*std::get<1>(col2SamplePoints.front());
+                alpha*this->yMin(int(i)) +
+                (1 - alpha)*this->yMin(int(i));
 
         Scalar yMax =
-                alpha*std::get<1>(col1SamplePoints.back()) +
-                (1 - alpha)*std::get<1>(col2SamplePoints.back());
+                alpha*this->yMax(int(i)) +
+                (1 - alpha)*this->yMax(int(i));
 
         return yMin <= y && y <= yMax;
     }
@@ -243,6 +240,8 @@ public:
      */
     Scalar eval(Scalar x, Scalar y, bool extrapolate = true) const
     {
+        OPM_INSTRUMENT_SCOPE("UniformXTabulated2DFunction::eval");
+        countLookup_(x, y);
 #ifndef NDEBUG
         if (!extrapolate && !applies(x,y))
         {
@@ -281,6 +280,8 @@ public:
     template <class Evaluation>
     Evaluation eval(const Evaluation& x, const Evaluation& y, bool extrapolate=false) const
     {
+        OPM_INSTRUMENT_SCOPE("UniformXTabulated2DFunction::eval");
+        countLookup_(x.value, y.value);
 #ifndef NDEBUG
         if (!extrapolate && !applies(x.value, y.value)) {
             OPM_THROW(NumericalIssue,
@@ -334,6 +335,161 @@ public:
         return result;
     }
 
+    /*!
+     * \brief Evaluate the function at a given (x,y) position using a segment hint.
+     *
+     * The segments which are stored in the hint are checked first and only if the
+     * position is not located within them, they are searched. In any case, the hint
+     * is updated to the segments which were used. The result is the same as the one
+     * of eval(x, y, extrapolate).
+     */
+    Scalar eval(Scalar x, Scalar y, SegmentHint2D& hint, bool extrapolate = true) const
+    {
+        OPM_INSTRUMENT_SCOPE("UniformXTabulated2DFunction::eval");
+        countLookup_(x, y);
+#ifndef NDEBUG
+        if (!extrapolate && !applies(x,y))
+        {
+            OPM_THROW(NumericalIssue,
+                       "Attempt to get tabulated value for ("
+                       << x << ", " << y
+                       << ") on table");
+        };
+#endif
+
+        int i = xSegmentIndex_(x, hint.xSegment);
+        int j1 = ySegmentIndex_(i, y, hint.ySegment1);
+        int j2 = ySegmentIndex_(i + 1, y, hint.ySegment2);
+
+        Scalar alpha = (x - xAt(i))/(xAt(i + 1) - xAt(i));
+        Scalar beta1 = (y - yAt(i, j1))/(yAt(i, j1 + 1) - yAt(i, j1));
+        Scalar beta2 = (y - yAt(i + 1, j2))/(yAt(i + 1, j2 + 1) - yAt(i + 1, j2));
+
+        // bi-linear interpolation
+        Scalar s1 = valueAt(i, j1)*(1.0 - beta1) + valueAt(i, j1 + 1)*beta1;
+        Scalar s2 = valueAt(i + 1, j2)*(1.0 - beta2) + valueAt(i + 1, j2 + 1)*beta2;
+        return s1*(1.0 - alpha) + s2*alpha;
+    }
+
+    /*!
+     * \brief Evaluate the function at a given (x,y) position using a segment hint.
+     *
+     * \copydetails eval(Scalar, Scalar, SegmentHint2D&, bool) const
+     */
+    template <class Evaluation>
+    Evaluation eval(const Evaluation& x, const Evaluation& y, SegmentHint2D& hint, bool extrapolate=false) const
+    {
+        OPM_INSTRUMENT_SCOPE("UniformXTabulated2DFunction::eval");
+        countLookup_(x.value, y.value);
+#ifndef NDEBUG
+        if (!extrapolate && !applies(x.value, y.value)) {
+            OPM_THROW(NumericalIssue,
+                      "Attempt to get undefined table value (" << x << ", " << y << ")");
+        };
+#endif
+
+        int i = xSegmentIndex_(x.value, hint.xSegment);
+        int j1 = ySegmentIndex_(i, y.value, hint.ySegment1);
+        int j2 = ySegmentIndex_(i + 1, y.value, hint.ySegment2);
+
+        Scalar dx = xAt(i + 1) - xAt(i);
+        Scalar dy1 = yAt(i, j1 + 1) - yAt(i, j1);
+        Scalar dy2 = yAt(i + 1, j2 + 1) - yAt(i + 1, j2);
+
+        Evaluation alpha = (x - xAt(i))/dx;
+        Evaluation beta1 = (y - yAt(i, j1))/dy1;
+        Evaluation beta2 = (y - yAt(i + 1, j2))/dy2;
+
+        // bi-linear interpolation
+        Evaluation s1, s2;
+        s1 = valueAt(i, j1)*(1.0 - beta1) + valueAt(i, j1 + 1)*beta1;
+        s2 = valueAt(i + 1, j2)*(1.0 - beta2) + valueAt(i + 1, j2 + 1)*beta2;
+
+        Evaluation result;
+        result = s1*(1.0 - alpha) + s2*alpha;
+        Valgrind::CheckDefined(result);
+
+        return result;
+    }
+
+    /*!
+     * \brief Evaluate the function and determine the weights of the sampling points
+     *        which contribute to its value.
+     *
+     * The value is the weighted sum of the values of the two sampling points of each
+     * of the two columns which enclose the position, so the weights are the partial
+     * derivatives of the value with regard to the values of these four sampling
+     * points (cf. Opm::InterpolationWeights). The indices of a sampling point are the
+     * index of its column and its index within the column. The value is the same as
+     * the one of eval(x, y, hint, extrapolate).
+     *
+     * \param weights Receives the indices and the weights of the contributing sampling
+     *                points
+     */
+    Scalar evalWeights(Scalar x, Scalar y, InterpolationWeights<Scalar, 4>& weights, bool extrapolate = true) const
+    {
+#ifndef NDEBUG
+        if (!extrapolate && !applies(x,y))
+        {
+            OPM_THROW(NumericalIssue,
+                       "Attempt to get tabulated value for ("
+                       << x << ", " << y
+                       << ") on table");
+        };
+#else
+        static_cast<void>(extrapolate);
+#endif
+
+        int i = xSegmentIndex_(x);
+        int j1 = ySegmentIndex_(i, y);
+        int j2 = ySegmentIndex_(i + 1, y);
+
+        Scalar alpha = (x - xAt(i))/(xAt(i + 1) - xAt(i));
+        Scalar beta1 = (y - yAt(i, j1))/(yAt(i, j1 + 1) - yAt(i, j1));
+        Scalar beta2 = (y - yAt(i + 1, j2))/(yAt(i + 1, j2 + 1) - yAt(i + 1, j2));
+
+        weights.clear();
+        weights.add(i, j1, (1.0 - alpha)*(1.0 - beta1));
+        weights.add(i, j1 + 1, (1.0 - alpha)*beta1);
+        weights.add(i + 1, j2, alpha*(1.0 - beta2));
+        weights.add(i + 1, j2 + 1, alpha*beta2);
+
+        // use the same floating point operations as eval()
+        Scalar s1 = valueAt(i, j1)*(1.0 - beta1) + valueAt(i, j1 + 1)*beta1;
+        Scalar s2 = valueAt(i + 1, j2)*(1.0 - beta2) + valueAt(i + 1, j2 + 1)*beta2;
+        return s1*(1.0 - alpha) + s2*alpha;
+    }
+
+    /*!
+     * \brief Reserve the memory for a given number of vertical lines.
+     *
+     * This avoids reallocations if the number of lines is known in advance.
+     */
+    void reserveXPos(size_t numX)
+    {
+        if (isFinalized())
+            OPM_THROW(std::logic_error,
+                      "Sampling points cannot be added to a finalized table");
+
+        xPos_.reserve(numX);
+        samples_.reserve(numX);
+    }
+
+    /*!
+     * \brief Reserve the memory for a given number of sampling points on the i-th
+     *        vertical line.
+     */
+    void reserveSamplePoints(int i, size_t numY)
+    {
+        assert(0 <= i && i < numX());
+
+        if (isFinalized())
+            OPM_THROW(std::logic_error,
+                      "Sampling points cannot be added to a finalized table");
+
+        samples_[i].reserve(numY);
+    }
+
     /*!
      * \brief Set the x-position of a vertical line.
      *
@@ -341,6 +497,10 @@ public:
      */
     size_t appendXPos(Scalar nextX)
     {
+        if (isFinalized())
+            OPM_THROW(std::logic_error,
+                      "Sampling points cannot be added to a finalized table");
+
         if (xPos_.empty() || xPos_.back() < nextX) {
             xPos_.push_back(nextX);
             samples_.resize(xPos_.size());
@@ -366,6 +526,10 @@ public:
     {
         assert(0 <= i && i < numX());
 
+        if (isFinalized())
+            OPM_THROW(std::logic_error,
+                      "Sampling points cannot be added to a finalized table");
+
         Scalar x = iToX(i);
         if (samples_[i].empty() || std::get<1>(samples_[i].back()) < y) {
             samples_[i].push_back(SamplePoint(x, y, value));
@@ -382,6 +546,117 @@ public:
                   "ascending or descending.");
     }
 
+    /*!
+     * \brief Append a complete vertical line to the table.
+     *
+     * The Y coordinates of the sampling points may be given in any order. In contrast
+     * to adding them one by one using appendSamplePoint(), the points are sorted once
+     * and the line is built in a single pass, i.e., this is also fast for descending Y
+     * coordinates. The X position of the line must be larger or smaller than the ones
+     * of all lines which are already present.
+     *
+     * Returns the i index of the line.
+     */
+    template <class YVector, class ValueVector>
+    size_t appendColumn(Scalar x, const YVector& y, const ValueVector& values)
+    {
+        size_t n = y.size();
+        if (values.size() != n)
+            OPM_THROW(std::invalid_argument,
+                      "The number of Y positions and values of a column must be identical");
+
+        std::vector<size_t> order(n);
+        for (size_t j = 0; j < n; ++j)
+            order[j] = j;
+        sortPermutation_(y, order);
+
+        for (size_t j = 1; j < n; ++j)
+            if (!(y[order[j - 1]] < y[order[j]]))
+                OPM_THROW(std::invalid_argument,
+                          "The Y positions of a column must be unique");
+
+        size_t i = appendXPos(x);
+        auto& column = samples_[i];
+        column.reserve(n);
+        for (size_t j = 0; j < n; ++j)
+            column.push_back(SamplePoint(x, y[order[j]], values[order[j]]));
+
+        return i;
+    }
+
+    /*!
+     * \brief Specify all vertical lines of the table at once.
+     *
+     * The i-th line is located at x[i] and its sampling points are given by y[i] and
+     * values[i]. Neither the lines nor the sampling points of a line need to be
+     * sorted. The table must be empty when this method is called and it must still be
+     * finalized afterwards. The time required is proportional to N*log(N) where N is
+     * the number of sampling points.
+     */
+    template <class XVector, class YVectorVector, class ValueVectorVector>
+    void setColumns(const XVector& x, const YVectorVector& y, const ValueVectorVector& values)
+    {
+        if (!xPos_.empty() || isFinalized())
+            OPM_THROW(std::logic_error,
+                      "The columns can only be specified for empty tables");
+
+        size_t m = x.size();
+        if (y.size() != m || values.size() != m)
+            OPM_THROW(std::invalid_argument,
+                      "The number of X positions, Y position columns and value columns "
+                      "must be identical");
+
+        std::vector<size_t> order(m);
+        for (size_t i = 0; i < m; ++i)
+            order[i] = i;
+        sortPermutation_(x, order);
+
+        reserveXPos(m);
+        for (size_t i = 0; i < m; ++i) {
+            size_t colIdx = order[i];
+            if (i > 0 && !(xPos_.back() < x[colIdx]))
+                OPM_THROW(std::invalid_argument,
+                          "The X positions of the columns must be unique");
+            appendColumn(x[colIdx], y[colIdx], values[colIdx]);
+        }
+    }
+
+    /*!
+     * \brief Convert the table to the compact layout which is used for the lookups.
+     *
+     * This must be called after all sampling points have been specified. Calling it
+     * more than once is a no-op.
+     */
+    void finalize()
+    {
+        if (isFinalized())
+            return;
+
+        int m = numX();
+        colOffsets_.resize(m + 1);
+        colOffsets_[0] = 0;
+        for (int i = 0; i < m; ++i)
+            colOffsets_[i + 1] = colOffsets_[i] + samples_[i].size();
+
+        yPos_.resize(colOffsets_[m]);
+        values_.resize(colOffsets_[m]);
+        for (int i = 0; i < m; ++i) {
+            for (size_t j = 0; j < samples_[i].size(); ++j) {
+                yPos_[colOffsets_[i] + j] = std::get<1>(samples_[i][j]);
+                values_[colOffsets_[i] + j] = std::get<2>(samples_[i][j]);
+            }
+        }
+
+        // the sample points are not required anymore
+        std::vector<std::vector<SamplePoint> >().swap(samples_);
+    }
+
+    /*!
+     * \brief Returns true if finalize() has already been called.
+     */
+    bool isFinalized() const
+    { return !colOffsets_.empty(); }
+
     /*!
      * \brief Print the table for debugging purposes.
      *
@@ -415,14 +690,163 @@ public:
         }
     }
 
+    /*!
+     * \brief Returns true iff two functions use the same sampling points.
+     */
+    bool operator==(const UniformXTabulated2DFunction& other) const
+    {
+        return
+            xPos_ == other.xPos_
+            && colOffsets_ == other.colOffsets_
+            && yPos_ == other.yPos_
+            && values_ == other.values_
+            && samples_ == other.samples_;
+    }
+
+    bool operator!=(const UniformXTabulated2DFunction& other) const
+    { return !operator==(other); }
+
+    /*!
+     * \brief Returns a hash value of the sampling points of a finalized function, cf.
+     *        Opm::TableRegistry.
+     */
+    size_t contentHash() const
+    {
+        size_t seed = hashValues(0, xPos_);
+        seed = hashValues(seed, colOffsets_);
+        seed = hashValues(seed, yPos_);
+        return hashValues(seed, values_);
+    }
+
 private:
+    // sort the permutation of the indices of a container so that the referenced
+    // positions are ascending. most tables are specified either in ascending or in
+    // descending order, so these cases do not require an actual sort.
+    template <class Vector>
+    static void sortPermutation_(const Vector& pos, std::vector<size_t>& order)
+    {
+        size_t n = order.size();
+        bool ascending = true;
+        bool descending = true;
+        for (size_t j = 1; j < n; ++j) {
+            ascending = ascending && pos[j - 1] < pos[j];
+            descending = descending && pos[j] < pos[j - 1];
+        }
+
+        if (ascending)
+            return;
+        else if (descending)
+            std::reverse(order.begin(), order.end());
+        else
+            std::stable_sort(order.begin(), order.end(),
+                             [&pos](size_t a, size_t b)
+                             { return pos[a] < pos[b]; });
+    }
+
+    // record whether a position is within the tabulated range or whether it needs to
+    // be extrapolated. the statistics are accumulated over all tables. if
+    // instrumentation is disabled, this does nothing.
+    void countLookup_(Scalar x, Scalar y) const
+    {
+#if OPM_MATERIAL_INSTRUMENTATION
+        if (applies(x, y))
+            OPM_INSTRUMENT_EVENT("UniformXTabulated2DFunction::eval in range");
+        else
+            OPM_INSTRUMENT_EVENT("UniformXTabulated2DFunction::eval extrapolated");
+#else
+        static_cast<void>(x);
+        static_cast<void>(y);
+#endif
+    }
+
+    // returns the index of the interval on the x axis which contains x
+    int xSegmentIndex_(Scalar x) const
+    {
+        // we need at least two sampling points!
+        assert(xPos_.size() >= 2);
+
+        if (x <= xPos_[1])
+            return 0;
+        else if (x >= xPos_[xPos_.size() - 2])
+            return xPos_.size() - 2;
+
+        // bisection
+        int segmentIdx = 1;
+        int upperIdx = xPos_.size() - 2;
+        while (segmentIdx + 1 < upperIdx) {
+            int pivotIdx = (segmentIdx + upperIdx) / 2;
+            if (x < xPos_[pivotIdx])
+                upperIdx = pivotIdx;
+            else
+                segmentIdx = pivotIdx;
+        }
+
+        assert(xPos_[segmentIdx] <= x);
+        assert(x <= xPos_[segmentIdx + 1]);
+
+        return segmentIdx;
+    }
+
+    // same as xSegmentIndex_(x), but the interval stored in the hint is checked first
+    int xSegmentIndex_(Scalar x, SegmentHint& hint) const
+    {
+        int segIdx = hint.segmentIdx;
+        int lastSegIdx = numX() - 2;
+        if (0 <= segIdx && segIdx <= lastSegIdx
+            && (segIdx == 0 || xPos_[segIdx] <= x)
+            && (segIdx == lastSegIdx || x <= xPos_[segIdx + 1]))
+            return segIdx;
+
+        hint.segmentIdx = xSegmentIndex_(x);
+        return hint.segmentIdx;
+    }
+
+    // returns the index of the segment of the i-th column which contains y
+    int ySegmentIndex_(int i, Scalar y) const
+    {
+        // interval halving
+        int lowerIdx = 0;
+        int upperIdx = numY(i) - 1;
+        int pivotIdx = (lowerIdx + upperIdx) / 2;
+        while (lowerIdx + 1 < upperIdx) {
+            if (y < yAt(i, pivotIdx))
+                upperIdx = pivotIdx;
+            else
+                lowerIdx = pivotIdx;
+            pivotIdx = (lowerIdx + upperIdx) / 2;
+        }
+
+        return lowerIdx;
+    }
+
+    // same as ySegmentIndex_(i, y), but the segment stored in the hint is checked first
+    int ySegmentIndex_(int i, Scalar y, SegmentHint& hint) const
+    {
+        int segIdx = hint.segmentIdx;
+        int lastSegIdx = numY(i) - 2;
+        if (0 <= segIdx && segIdx <= lastSegIdx
+            && (segIdx == 0 || yAt(i, segIdx) <= y)
+            && (segIdx == lastSegIdx || y <= yAt(i, segIdx + 1)))
+            return segIdx;
+
+        hint.segmentIdx = ySegmentIndex_(i, y);
+        return hint.segmentIdx;
+    }
+
     // the vector which contains the values of the sample points
-    // f(x_i, y_j). don't use this directly, use getSamplePoint(i,j)
-    // instead!
+    // f(x_i, y_j) while the table is built. don't use this directly, use yAt(i, j)
+    // and valueAt(i, j) instead!
     std::vector<std::vector<SamplePoint> > samples_;
 
     // the position of each vertical line on the x-axis
-    std::vector<Scalar> xPos_;
+    ScalarVector xPos_;
+
+    // the compact layout created by finalize(): the Y coordinates and the values of
+    // the sample points of the i-th column are stored in the range [colOffsets_[i],
+    // colOffsets_[i + 1]) of the yPos_ and values_ arrays.
+    IntVector colOffsets_;
+    ScalarVector yPos_;
+    ScalarVector values_;
 };
 } // namespace Opm
 
@@ -27,8 +27,12 @@
 #define OPM_BRINE_HPP
 
 #include <opm/material/components/Component.hpp>
+#include <opm/material/components/ComponentPhaseProperties.hpp>
 #include <opm/material/common/MathToolbox.hpp>
 
+#include <limits>
+#include <type_traits>
+
 namespace Opm {
 
 /*!
@@ -36,6 +40,16 @@ namespace Opm {
  *
  * \brief A class for the brine fluid properties.
  *
+ * The properties of brine are those of water plus corrections which only depend on
+ * the salinity, the temperature and the pressure. If all liquid properties are
+ * required, liquidProperties() should be used, because it evaluates the relations of
+ * water only once. Since the corrections are cheap, a tabulated variant for arbitrary
+ * salinities is obtained by using a tabulated water component, i.e.,
+ * Brine<Scalar, TabulatedComponent<Scalar, H2O<Scalar> > >: In contrast to tabulating
+ * the brine component itself, its tables do not need to be recalculated if the
+ * salinity changes, and the salinity may also be passed to liquidProperties()
+ * explicitly.
+ *
  * \tparam Scalar The type used for scalar values
  * \tparam H2O Static polymorphism: the Brine class can access all properties of the H2O class
  */
@@ -46,12 +60,29 @@ public:
     //! The mass fraction of salt assumed to be in the brine.
     static Scalar salinity;
 
+    //! The phase properties of brine are available if the ones of water are.
+    static const bool hasPhaseProperties = H2O::hasPhaseProperties;
+
     /*!
      * \copydoc Component::name
      */
     static const char *name()
     { return "Brine"; }
 
+    /*!
+     * \copydoc Component::isValidGasState
+     */
+    template <class Evaluation>
+    static bool isValidGasState(const Evaluation& temperature, const Evaluation& pressure)
+    { return H2O::isValidGasState(temperature, pressure); }
+
+    /*!
+     * \copydoc Component::isValidLiquidState
+     */
+    template <class Evaluation>
+    static bool isValidLiquidState(const Evaluation& temperature, const Evaluation& pressure)
+    { return H2O::isValidLiquidState(temperature, pressure); }
+
     /*!
      * \copydoc H2O::gasIsIdeal
      */
@@ -134,58 +165,9 @@ public:
     static Evaluation liquidEnthalpy(const Evaluation& temperature,
                                      const Evaluation& pressure)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
-
-        // Numerical coefficents from Palliser and McKibbin
-        static const Scalar f[] = {
-            2.63500e-1, 7.48368e-6, 1.44611e-6, -3.80860e-10
-        };
-
-        // Numerical coefficents from Michaelides for the enthalpy of brine
-        static const Scalar a[4][3] = {
-            { -9633.6, -4080.0, +286.49 },
-            { +166.58, +68.577, -4.6856 },
-            { -0.90963, -0.36524, +0.249667e-1 },
-            { +0.17965e-2, +0.71924e-3, -0.4900e-4 }
-        };
-
-        Evaluation theta = temperature - 273.15;
-
-        Scalar S = salinity;
-        Scalar S_lSAT =
-            f[0]
-            + f[1]*Toolbox::value(theta)
-            + f[2]*std::pow(Toolbox::value(theta), 2)
-            + f[3]*std::pow(Toolbox::value(theta), 3);
-
-        // Regularization
-        if (S > S_lSAT)
-            S = S_lSAT;
-
-        Evaluation hw = H2O::liquidEnthalpy(temperature, pressure)/1e3; // [kJ/kg]
-
-        // From Daubert and Danner
-        Evaluation h_NaCl =
-            (3.6710e4*temperature
-             + (6.2770e1/2)*temperature*temperature
-             - (6.6670e-2/3)*temperature*temperature*temperature
-             + (2.8000e-5/4)*std::pow(temperature,4))/58.44e3
-            - 2.045698e+02; // [kJ/kg]
-
-        Scalar m = S/(1-S)/58.44e-3;
-
-        Evaluation d_h = 0;
-        for (int i = 0; i<=3; ++i) {
-            for (int j = 0; j <= 2; ++j) {
-                d_h += a[i][j] * std::pow(theta, i) * std::pow(m, j);
-            }
-        }
-
-        Evaluation delta_h = 4.184/(1e3 + (58.44 * m))*d_h;
-
-        // Enthalpy of brine
-        Evaluation h_ls = (1-S)*hw + S*h_NaCl + S*delta_h; // [kJ/kg]
-        return h_ls*1e3; // convert to [J/kg]
+        return liquidEnthalpyFromWater_(temperature,
+                                        H2O::liquidEnthalpy(temperature, pressure),
+                                        salinity);
     }
 
 
@@ -196,7 +178,9 @@ public:
     static Evaluation liquidHeatCapacity(const Evaluation& temperature,
                                          const Evaluation& pressure)
     {
-        Scalar eps = temperature*1e-8;
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        Scalar eps = Toolbox::value(temperature)*1e-8;
         return (liquidEnthalpy(temperature + eps, pressure) - liquidEnthalpy(temperature, pressure))/eps;
     }
 
@@ -249,24 +233,10 @@ public:
     template <class Evaluation>
     static Evaluation liquidDensity(const Evaluation& temperature, const Evaluation& pressure)
     {
-        Evaluation tempC = temperature - 273.15;
-        Evaluation pMPa = pressure/1.0E6;
-
-        const Evaluation rhow = H2O::liquidDensity(temperature, pressure);
-        return
-            rhow +
-            1000*salinity*(
-                0.668 +
-                0.44*salinity +
-                1.0E-6*(
-                    300*pMPa -
-                    2400*pMPa*salinity +
-                    tempC*(
-                        80.0 -
-                        3*tempC -
-                        3300*salinity -
-                        13*pMPa +
-                        47*pMPa*salinity)));
+        return liquidDensityFromWater_(temperature,
+                                       pressure,
+                                       H2O::liquidDensity(temperature, pressure),
+                                       salinity);
     }
 
     /*!
@@ -326,7 +296,170 @@ public:
      *   "Equations of State for basin geofluids"
      */
     template <class Evaluation>
-    static Evaluation liquidViscosity(const Evaluation& temperature, const Evaluation& pressure)
+    static Evaluation liquidViscosity(const Evaluation& temperature, const Evaluation& /* pressure */)
+    { return liquidViscosity_(temperature, salinity); }
+
+    /*!
+     * \brief The density, specific enthalpy, isobaric heat capacity and viscosity of
+     *        brine with the default salinity.
+     *
+     * \copydetails liquidProperties(const Evaluation&, const Evaluation&, Scalar)
+     */
+    template <class Evaluation>
+    static ComponentPhaseProperties<Evaluation> liquidProperties(const Evaluation& temperature,
+                                                                 const Evaluation& pressure)
+    { return liquidProperties(temperature, pressure, salinity); }
+
+    /*!
+     * \brief The density, specific enthalpy, isobaric heat capacity and viscosity of
+     *        brine with a given salinity.
+     *
+     * This yields the same results as liquidDensity(), liquidEnthalpy(),
+     * liquidHeatCapacity() and liquidViscosity() (the heat capacity within the
+     * accuracy of its finite difference), but the water component is only evaluated
+     * once. If the water component sets hasPhaseProperties, this is done by its
+     * liquidThermodynamicProperties() method. Brine does not provide a thermal
+     * conductivity, so this quantity is NaN.
+     *
+     * \param temperature Absolute temperature of the fluid in \f$\mathrm{[K]}\f$
+     * \param pressure Phase pressure in \f$\mathrm{[Pa]}\f$
+     * \param brineSalinity The mass fraction of salt in the brine
+     */
+    template <class Evaluation>
+    static ComponentPhaseProperties<Evaluation> liquidProperties(const Evaluation& temperature,
+                                                                 const Evaluation& pressure,
+                                                                 Scalar brineSalinity)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        // the heat capacity is the finite difference of the enthalpy which is used
+        // by liquidHeatCapacity(). the one of water is derived from the heat capacity
+        // of water instead of evaluating water at a second temperature
+        Scalar eps = Toolbox::value(temperature)*1e-8;
+        const ComponentPhaseProperties<Evaluation>& water =
+            waterLiquidProperties_(temperature, pressure, eps,
+                                   std::integral_constant<bool, H2O::hasPhaseProperties>());
+
+        ComponentPhaseProperties<Evaluation> result;
+        result.density = liquidDensityFromWater_(temperature, pressure, water.density, brineSalinity);
+        result.enthalpy = liquidEnthalpyFromWater_(temperature, water.enthalpy, brineSalinity);
+        const Evaluation& hPlus =
+            liquidEnthalpyFromWater_(temperature + eps,
+                                     water.enthalpy + eps*water.heatCapacity,
+                                     brineSalinity);
+        result.heatCapacity = (hPlus - result.enthalpy)/eps;
+        result.viscosity = liquidViscosity_(temperature, brineSalinity);
+        result.thermalConductivity = Toolbox::createConstant(std::numeric_limits<Scalar>::quiet_NaN());
+        return result;
+    }
+
+    /*!
+     * \brief The density, specific enthalpy, isobaric heat capacity, viscosity and
+     *        thermal conductivity of steam.
+     *
+     * This is only available if the water component provides gasProperties().
+     *
+     * \param temperature Absolute temperature of the fluid in \f$\mathrm{[K]}\f$
+     * \param pressure Phase pressure in \f$\mathrm{[Pa]}\f$
+     */
+    template <class Evaluation>
+    static ComponentPhaseProperties<Evaluation> gasProperties(const Evaluation& temperature,
+                                                              const Evaluation& pressure)
+    { return H2O::gasProperties(temperature, pressure); }
+
+private:
+    // the specific enthalpy of brine [J/kg] given the one of pure water [J/kg] at the
+    // same temperature and pressure
+    template <class Evaluation>
+    static Evaluation liquidEnthalpyFromWater_(const Evaluation& temperature,
+                                               const Evaluation& waterEnthalpy,
+                                               Scalar brineSalinity)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        // Numerical coefficents from Palliser and McKibbin
+        static const Scalar f[] = {
+            2.63500e-1, 7.48368e-6, 1.44611e-6, -3.80860e-10
+        };
+
+        // Numerical coefficents from Michaelides for the enthalpy of brine
+        static const Scalar a[4][3] = {
+            { -9633.6, -4080.0, +286.49 },
+            { +166.58, +68.577, -4.6856 },
+            { -0.90963, -0.36524, +0.249667e-1 },
+            { +0.17965e-2, +0.71924e-3, -0.4900e-4 }
+        };
+
+        Evaluation theta = temperature - 273.15;
+
+        Scalar S = brineSalinity;
+        Scalar S_lSAT =
+            f[0]
+            + f[1]*Toolbox::value(theta)
+            + f[2]*std::pow(Toolbox::value(theta), 2)
+            + f[3]*std::pow(Toolbox::value(theta), 3);
+
+        // Regularization
+        if (S > S_lSAT)
+            S = S_lSAT;
+
+        const Evaluation& hw = waterEnthalpy/1e3; // [kJ/kg]
+
+        // From Daubert and Danner
+        Evaluation h_NaCl =
+            (3.6710e4*temperature
+             + (6.2770e1/2)*temperature*temperature
+             - (6.6670e-2/3)*temperature*temperature*temperature
+             + (2.8000e-5/4)*Toolbox::pow(temperature, 4))/58.44e3
+            - 2.045698e+02; // [kJ/kg]
+
+        Scalar m = S/(1-S)/58.44e-3;
+
+        Evaluation d_h = 0;
+        for (int i = 0; i<=3; ++i) {
+            for (int j = 0; j <= 2; ++j) {
+                d_h += a[i][j] * Toolbox::pow(theta, i) * std::pow(m, j);
+            }
+        }
+
+        Evaluation delta_h = 4.184/(1e3 + (58.44 * m))*d_h;
+
+        // Enthalpy of brine
+        Evaluation h_ls = (1-S)*hw + S*h_NaCl + S*delta_h; // [kJ/kg]
+        return h_ls*1e3; // convert to [J/kg]
+    }
+
+    // the density of brine [kg/m^3] given the one of pure water [kg/m^3] at the same
+    // temperature and pressure
+    template <class Evaluation>
+    static Evaluation liquidDensityFromWater_(const Evaluation& temperature,
+                                              const Evaluation& pressure,
+                                              const Evaluation& waterDensity,
+                                              Scalar brineSalinity)
+    {
+        Evaluation tempC = temperature - 273.15;
+        Evaluation pMPa = pressure/1.0E6;
+
+        const Evaluation& rhow = waterDensity;
+        return
+            rhow +
+            1000*brineSalinity*(
+                0.668 +
+                0.44*brineSalinity +
+                1.0E-6*(
+                    300*pMPa -
+                    2400*pMPa*brineSalinity +
+                    tempC*(
+                        80.0 -
+                        3*tempC -
+                        3300*brineSalinity -
+                        13*pMPa +
+                        47*pMPa*brineSalinity)));
+    }
+
+    // the viscosity of brine [Pa s], which does not depend on the pressure
+    template <class Evaluation>
+    static Evaluation liquidViscosity_(const Evaluation& temperature, Scalar brineSalinity)
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
@@ -334,11 +467,36 @@ public:
         if(temperature <= 275.) // regularization
             T_C = Toolbox::createConstant(275.0);
 
-        Evaluation A = (0.42*std::pow((std::pow(salinity, 0.8)-0.17), 2) + 0.045)*Toolbox::pow(T_C, 0.8);
-        Evaluation mu_brine = 0.1 + 0.333*salinity + (1.65+91.9*salinity*salinity*salinity)*Toolbox::exp(-A);
+        Evaluation A = (0.42*std::pow((std::pow(brineSalinity, 0.8)-0.17), 2) + 0.045)*Toolbox::pow(T_C, 0.8);
+        Evaluation mu_brine = 0.1 + 0.333*brineSalinity + (1.65+91.9*brineSalinity*brineSalinity*brineSalinity)*Toolbox::exp(-A);
 
         return mu_brine/1000.0; // convert to [Pa s] (todo: check if correct cP->Pa s is times 10...)
     }
+
+    // the density, enthalpy and heat capacity of liquid water if the water component
+    // computes them at once. the transport properties of water are not required.
+    template <class Evaluation>
+    static ComponentPhaseProperties<Evaluation> waterLiquidProperties_(const Evaluation& temperature,
+                                                                       const Evaluation& pressure,
+                                                                       Scalar /* eps */,
+                                                                       std::true_type)
+    { return H2O::liquidThermodynamicProperties(temperature, pressure); }
+
+    // the density, enthalpy and heat capacity of liquid water for the other water
+    // components. the heat capacity is the finite difference of the enthalpy, like
+    // the one of brine.
+    template <class Evaluation>
+    static ComponentPhaseProperties<Evaluation> waterLiquidProperties_(const Evaluation& temperature,
+                                                                       const Evaluation& pressure,
+                                                                       Scalar eps,
+                                                                       std::false_type)
+    {
+        ComponentPhaseProperties<Evaluation> result;
+        result.density = H2O::liquidDensity(temperature, pressure);
+        result.enthalpy = H2O::liquidEnthalpy(temperature, pressure);
+        result.heatCapacity = (H2O::liquidEnthalpy(temperature + eps, pressure) - result.enthalpy)/eps;
+        return result;
+    }
 };
 
 /*!
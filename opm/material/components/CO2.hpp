@@ -32,9 +32,13 @@
 #include <opm/material/IdealGas.hpp>
 #include <opm/material/components/Component.hpp>
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/UniformTabulated2DMultiFunction.hpp>
+#include <opm/material/components/ComponentPhaseProperties.hpp>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <limits>
 
 namespace Opm {
 
@@ -47,14 +51,126 @@ namespace Opm {
  * fluidsystem \c FluidSystems::BrineCO2. If thermodynamic precision
  * is not a top priority, the much simpler component \c Opm::SimpleCO2 can be
  * used instead
+ *
+ * The tables are provided by the CO2Tables class. Either the compiled-in ones of
+ * co2tables.inc can be used or tables for a user specified range and resolution
+ * which are calculated at runtime, see Opm::GeneratedCO2Tables.
+ *
+ * The viscosity and the heat capacity are not part of these tables. They can be
+ * tabulated on the same grid using tabulateTransportProperties(), which is done by the
+ * Brine-CO2 fluid system. Otherwise, they are calculated from the tabulated density and
+ * enthalpy. If several properties are required for the same state, gasProperties()
+ * should be used.
  */
 template <class Scalar, class CO2Tables>
 class CO2 : public Component<Scalar, CO2<Scalar, CO2Tables> >
 {
     static const Scalar R;
-    static bool warningPrinted;
+
+    // the quantities which are stored for each sampling point of the interleaved
+    // tables, cf. tabulateTransportProperties()
+    enum { densityIdx_, enthalpyIdx_, heatCapacityIdx_, viscosityIdx_, numTabulatedQuantities_ };
+    typedef Opm::UniformTabulated2DMultiFunction<Scalar, numTabulatedQuantities_> TabulatedFunctions;
 
 public:
+    /*!
+     * \brief Tabulate the viscosity and the isobaric heat capacity on the grid of the
+     *        density and enthalpy tables.
+     *
+     * Afterwards, gasViscosity() and gasHeatCapacity() are table lookups like
+     * gasDensity() and gasEnthalpy(), and their derivatives are the ones of the
+     * interpolation. The viscosity is determined from the tabulated density at each
+     * sampling point, while the heat capacity is given by the finite differences of the
+     * tabulated enthalpy between the neighboring sampling temperatures. All four
+     * quantities are stored interleaved, so gasProperties() and gasInternalEnergy()
+     * obtain them using a single lookup.
+     *
+     * If the grid of the CO2 tables is changed afterwards, e.g., because they are
+     * re-initialized with a different resolution, the transport properties are
+     * calculated without tables until this method is called again. It must not be called
+     * while other threads evaluate the properties of CO2.
+     */
+    static void tabulateTransportProperties()
+    {
+        const auto& density = CO2Tables::tabulatedDensity;
+        const auto& enthalpy = CO2Tables::tabulatedEnthalpy;
+        int numX = density.numX();
+        int numY = density.numY();
+        if (numX < 2 || numY < 2
+            || enthalpy.numX() != numX || enthalpy.numY() != numY)
+            OPM_THROW(std::logic_error,
+                      "The density and enthalpy tables of CO2 must be initialized on the "
+                      "same grid before the transport properties can be tabulated");
+
+        auto& tables = tabulatedProperties_;
+        tables.resize(density.xMin(), density.xMax(), numX,
+                      density.yMin(), density.yMax(), numY);
+
+        Scalar dT = (density.xMax() - density.xMin())/(numX - 1);
+        for (int i = 0; i < numX; ++i) {
+            Scalar T = density.iToX(i);
+            int iMinus = std::max(i - 1, 0);
+            int iPlus = std::min(i + 1, numX - 1);
+            for (int j = 0; j < numY; ++j) {
+                Scalar rho = density.getSamplePoint(i, j);
+                Scalar dh = enthalpy.getSamplePoint(iPlus, j) - enthalpy.getSamplePoint(iMinus, j);
+                tables.setSamplePoint(i, j, densityIdx_, rho);
+                tables.setSamplePoint(i, j, enthalpyIdx_, enthalpy.getSamplePoint(i, j));
+                tables.setSamplePoint(i, j, heatCapacityIdx_, dh/((iPlus - iMinus)*dT));
+                tables.setSamplePoint(i, j, viscosityIdx_, viscosity_(T, rho));
+            }
+        }
+    }
+
+    /*!
+     * \brief Returns true iff the viscosity and the heat capacity are looked up in
+     *        tables, cf. tabulateTransportProperties().
+     */
+    static bool transportPropertiesTabulated()
+    {
+        const auto& density = CO2Tables::tabulatedDensity;
+        const auto& tables = tabulatedProperties_;
+        return
+            tables.numX() > 0
+            && tables.numX() == density.numX()
+            && tables.numY() == density.numY()
+            && tables.xMin() == density.xMin()
+            && tables.xMax() == density.xMax()
+            && tables.yMin() == density.yMin()
+            && tables.yMax() == density.yMax();
+    }
+
+    /*!
+     * \brief The density, enthalpy, heat capacity and viscosity of CO2 at a given
+     *        temperature and pressure.
+     *
+     * If the transport properties are tabulated, all quantities are obtained from a
+     * single lookup in the interleaved tables. The thermal conductivity is not
+     * provided and is set to NaN.
+     */
+    template <class Evaluation>
+    static ComponentPhaseProperties<Evaluation> gasProperties(const Evaluation& temperature,
+                                                              const Evaluation& pressure)
+    {
+        ComponentPhaseProperties<Evaluation> result;
+        result.thermalConductivity = std::numeric_limits<Scalar>::quiet_NaN();
+        if (transportPropertiesTabulated()) {
+            Evaluation values[numTabulatedQuantities_];
+            tabulatedProperties_.eval(temperature, pressure, values);
+            result.density = values[densityIdx_];
+            result.enthalpy = values[enthalpyIdx_];
+            result.heatCapacity = values[heatCapacityIdx_];
+            result.viscosity = values[viscosityIdx_];
+            return result;
+        }
+
+        result.density = gasDensity(temperature, pressure);
+        result.enthalpy = gasEnthalpy(temperature, pressure);
+        result.heatCapacity = gasHeatCapacity(temperature, pressure);
+        result.viscosity = viscosity_(temperature, result.density);
+        return result;
+    }
+
     /*!
      * \brief A human readable name for the CO2.
      */
@@ -170,6 +286,19 @@ public:
         return CO2Tables::tabulatedEnthalpy.eval(temperature, pressure);
     }
 
+    /*!
+     * \brief Specific enthalpy of gaseous CO2 [J/kg] for a batch of temperatures and
+     *        pressures.
+     *
+     * This is equivalent to calling gasEnthalpy() for each entry, but the table
+     * lookups of the batch are interleaved, cf. UniformTabulated2DFunction::evalBatch().
+     */
+    static void gasEnthalpyBatch(const Scalar* temperature,
+                                 const Scalar* pressure,
+                                 Scalar* enthalpy,
+                                 size_t n)
+    { CO2Tables::tabulatedEnthalpy.evalBatch(temperature, pressure, enthalpy, n); }
+
     /*!
      * \brief Specific internal energy of CO2 [J/kg].
      */
@@ -177,6 +306,12 @@ public:
     static Evaluation gasInternalEnergy(const Evaluation& temperature,
                                         const Evaluation& pressure)
     {
+        if (transportPropertiesTabulated()) {
+            Evaluation values[numTabulatedQuantities_];
+            tabulatedProperties_.eval(temperature, pressure, values);
+            return values[enthalpyIdx_] - pressure/values[densityIdx_];
+        }
+
         const Evaluation& h = gasEnthalpy(temperature, pressure);
         const Evaluation& rho = gasDensity(temperature, pressure);
 
@@ -192,6 +327,18 @@ public:
         return CO2Tables::tabulatedDensity.eval(temperature, pressure);
     }
 
+    /*!
+     * \brief The density of CO2 [kg/m^3] for a batch of temperatures and pressures.
+     *
+     * This is equivalent to calling gasDensity() for each entry, but the table lookups
+     * of the batch are interleaved, cf. UniformTabulated2DFunction::evalBatch().
+     */
+    static void gasDensityBatch(const Scalar* temperature,
+                                const Scalar* pressure,
+                                Scalar* density,
+                                size_t n)
+    { CO2Tables::tabulatedDensity.evalBatch(temperature, pressure, density, n); }
+
     /*!
      * \brief The dynamic viscosity [Pa s] of CO2.
      *
@@ -199,7 +346,45 @@ public:
      *                        - Fenhour etl al., 1998
      */
     template <class Evaluation>
-    static Evaluation gasViscosity(Evaluation temperature, const Evaluation& pressure)
+    static Evaluation gasViscosity(const Evaluation& temperature, const Evaluation& pressure)
+    {
+        if (transportPropertiesTabulated())
+            return tabulatedProperties_.eval(temperature, pressure, viscosityIdx_);
+
+        return viscosity_(temperature, gasDensity(temperature, pressure));
+    }
+
+    /*!
+     * \brief Specific isobaric heat capacity of the component [J/kg]
+     *        as a liquid.
+     *
+     * This function uses the fact that heat capacity is the partial
+     * derivative of enthalpy function with respect to temperature.
+     *
+     * \param temperature Temperature of component \f$\mathrm{[K]}\f$
+     * \param pressure Pressure of component \f$\mathrm{[Pa]}\f$
+     */
+    template <class Evaluation>
+    static Evaluation gasHeatCapacity(const Evaluation& temperature, const Evaluation& pressure)
+    {
+        if (transportPropertiesTabulated())
+            return tabulatedProperties_.eval(temperature, pressure, heatCapacityIdx_);
+
+        Scalar eps = 1e-6;
+
+        // use central differences here because one-sided methods do
+        // not come with a performance improvement. (central ones are
+        // more accurate, though...)
+        const Evaluation& h1 = gasEnthalpy(temperature - eps, pressure);
+        const Evaluation& h2 = gasEnthalpy(temperature + eps, pressure);
+
+        return (h2 - h1) / (2*eps) ;
+    }
+
+private:
+    // the viscosity [Pa s] for a given temperature and density
+    template <class Evaluation>
+    static Evaluation viscosity_(Evaluation temperature, const Evaluation& rho)
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
@@ -227,49 +412,25 @@ public:
 
         Evaluation mu0 = 1.00697*Toolbox::sqrt(temperature) / SigmaStar;
 
-        const Evaluation& rho = gasDensity(temperature, pressure); // CO2 mass density [kg/m^3]
-
         // dmu : excess viscosity at elevated density
         Evaluation dmu =
             d11*rho
             + d21*rho*rho
-            + d64*Toolbox::pow(rho, 6.0)/(TStar*TStar*TStar)
-            + d81*Toolbox::pow(rho, 8.0)
-            + d82*Toolbox::pow(rho, 8.0)/TStar;
+            + d64*Toolbox::pow(rho, 6)/(TStar*TStar*TStar)
+            + d81*Toolbox::pow(rho, 8)
+            + d82*Toolbox::pow(rho, 8)/TStar;
 
         return (mu0 + dmu)/1.0e6; // conversion to [Pa s]
     }
 
-    /*!
-     * \brief Specific isobaric heat capacity of the component [J/kg]
-     *        as a liquid.
-     *
-     * This function uses the fact that heat capacity is the partial
-     * derivative of enthalpy function with respect to temperature.
-     *
-     * \param temperature Temperature of component \f$\mathrm{[K]}\f$
-     * \param pressure Pressure of component \f$\mathrm{[Pa]}\f$
-     */
-    template <class Evaluation>
-    static Evaluation gasHeatCapacity(const Evaluation& temperature, const Evaluation& pressure)
-    {
-        Scalar eps = 1e-6;
-
-        // use central differences here because one-sided methods do
-        // not come with a performance improvement. (central ones are
-        // more accurate, though...)
-        const Evaluation& h1 = gasEnthalpy(temperature - eps, pressure);
-        const Evaluation& h2 = gasEnthalpy(temperature + eps, pressure);
-
-        return (h2 - h1) / (2*eps) ;
-    }
+    static TabulatedFunctions tabulatedProperties_;
 };
 
 template <class Scalar, class CO2Tables>
-bool CO2<Scalar, CO2Tables>::warningPrinted = false;
+const Scalar CO2<Scalar, CO2Tables>::R = Constants<Scalar>::R;
 
 template <class Scalar, class CO2Tables>
-const Scalar CO2<Scalar, CO2Tables>::R = Constants<Scalar>::R;
+typename CO2<Scalar, CO2Tables>::TabulatedFunctions CO2<Scalar, CO2Tables>::tabulatedProperties_;
 
 } // namespace Opm
 
@@ -46,6 +46,15 @@ public:
 
     static const bool isTabulated = false;
 
+    /*!
+     * \brief Specifies whether the component provides the liquidProperties() and
+     *        gasProperties() methods.
+     *
+     * These return all quantities of a phase which are usually tabulated at once, see
+     * Opm::ComponentPhaseProperties.
+     */
+    static const bool hasPhaseProperties = false;
+
     /*!
      * \brief A default routine for initialization, not needed for components and must not be called.
      *
@@ -62,6 +71,29 @@ public:
                      Scalar /* pressMin */, Scalar /* pressMax */, unsigned /* nPress */)
     { }
 
+    /*!
+     * \brief Returns true if the properties of the gas phase can be calculated for a
+     *        given temperature and pressure.
+     *
+     * Outside of this range, the methods for the gas phase may throw an exception.
+     * Unlike the latter, this method is cheap and never throws, so it is used to skip
+     * such states when the component is tabulated. By default, all states are
+     * considered to be valid.
+     */
+    template <class Evaluation>
+    static bool isValidGasState(const Evaluation& /* temperature */, const Evaluation& /* pressure */)
+    { return true; }
+
+    /*!
+     * \brief Returns true if the properties of the liquid phase can be calculated for a
+     *        given temperature and pressure.
+     *
+     * \copydetails isValidGasState
+     */
+    template <class Evaluation>
+    static bool isValidLiquidState(const Evaluation& /* temperature */, const Evaluation& /* pressure */)
+    { return true; }
+
     /*!
      * \brief Returns true iff the gas phase is assumed to be compressible
      */
@@ -146,6 +178,26 @@ public:
     static Evaluation liquidDensity(const Evaluation& /* temperature */, const Evaluation& /* pressure */)
     { OPM_THROW(std::runtime_error, "Not implemented: Component::liquidDensity()"); }
 
+    /*!
+     * \brief The pressure \f$\mathrm{[Pa]}\f$ of the gaseous component at a given density in \f$\mathrm{[kg/m^3]}\f$ and temperature in \f$\mathrm{[K]}\f$.
+     *
+     * \param temperature temperature of component in \f$\mathrm{[K]}\f$
+     * \param density density of component in \f$\mathrm{[kg/m^3]}\f$
+     */
+    template <class Evaluation>
+    static Evaluation gasPressure(const Evaluation& /* temperature */, Scalar /* density */)
+    { OPM_THROW(std::runtime_error, "Not implemented: Component::gasPressure()"); }
+
+    /*!
+     * \brief The pressure \f$\mathrm{[Pa]}\f$ of the liquid component at a given density in \f$\mathrm{[kg/m^3]}\f$ and temperature in \f$\mathrm{[K]}\f$.
+     *
+     * \param temperature temperature of component in \f$\mathrm{[K]}\f$
+     * \param density density of component in \f$\mathrm{[kg/m^3]}\f$
+     */
+    template <class Evaluation>
+    static Evaluation liquidPressure(const Evaluation& /* temperature */, Scalar /* density */)
+    { OPM_THROW(std::runtime_error, "Not implemented: Component::liquidPressure()"); }
+
     /*!
      * \brief Specific enthalpy \f$\mathrm{[J/kg]}\f$ of the pure component in gas.
      *
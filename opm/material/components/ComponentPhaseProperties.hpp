@@ -0,0 +1,60 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::ComponentPhaseProperties
+ */
+#ifndef OPM_COMPONENT_PHASE_PROPERTIES_HPP
+#define OPM_COMPONENT_PHASE_PROPERTIES_HPP
+
+namespace Opm {
+/*!
+ * \ingroup Components
+ *
+ * \brief The properties of a pure component in its liquid or gas phase at a given
+ *        temperature and pressure.
+ *
+ * Objects of this class are returned by the liquidProperties() and gasProperties()
+ * methods of the components which set hasPhaseProperties. For these, computing all
+ * quantities at once is considerably cheaper than calling the individual methods,
+ * because the intermediate results of the equation of state can be shared.
+ */
+template <class Evaluation>
+struct ComponentPhaseProperties
+{
+    //! The density [kg/m^3]
+    Evaluation density;
+
+    //! The specific enthalpy [J/kg]
+    Evaluation enthalpy;
+
+    //! The specific isobaric heat capacity [J/(kg K)]
+    Evaluation heatCapacity;
+
+    //! The dynamic viscosity [Pa s]
+    Evaluation viscosity;
+
+    //! The thermal conductivity [W/(m K)]
+    Evaluation thermalConductivity;
+};
+} // namespace Opm
+
+#endif
@@ -0,0 +1,321 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::GeneratedCO2Tables
+ */
+#ifndef OPM_GENERATED_CO2_TABLES_HPP
+#define OPM_GENERATED_CO2_TABLES_HPP
+
+#include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/HugePageAllocator.hpp>
+#include <opm/material/common/TableFile.hpp>
+#include <opm/material/common/TableResampling.hpp>
+#include <opm/material/common/UniformTabulated2DFunction.hpp>
+#include <opm/material/components/SpanWagnerCO2.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup Components
+ *
+ * \brief Density and enthalpy tables for Opm::CO2 which are calculated at runtime.
+ *
+ * This class can be used instead of the tables of co2tables.inc, which cover a fixed
+ * range of 280 K to 400 K and 0.1 MPa to 100 MPa. Instead, the range and the
+ * resolution are specified by the caller, so the tables can be adapted to the
+ * conditions of a given problem. The values are calculated using the equation of
+ * state of Span and Wagner, see Opm::SpanWagnerCO2, and the enthalpies use the same
+ * reference state as the compiled-in tables.
+ *
+ * Since the density must be determined iteratively, calculating the tables takes a
+ * while. This is done in parallel if OpenMP is enabled and the result can be stored
+ * in a file, which is used instead of re-calculating the tables if the ranges and
+ * resolutions match. If enabled, the tables are stored on huge pages (cf.
+ * Opm::HugePages).
+ *
+ * Usage:
+ * \code
+ * typedef Opm::GeneratedCO2Tables<double> CO2Tables;
+ * CO2Tables::init(290.0, 360.0, 100, 1e5, 40e6, 200, "co2tables.cache");
+ * typedef Opm::FluidSystems::BrineCO2<double, CO2Tables> FluidSystem;
+ * \endcode
+ *
+ * Besides these tables, coarse ones can be derived by initCoarse(). While the coarse
+ * tables are selected using setUseCoarseTables(), they are used instead of the fine
+ * ones. Since they are small enough to stay in the cache, this is intended for the
+ * early iterations of a nonlinear solver, where the residual is large anyway.
+ *
+ * \tparam Scalar The type used for scalar values
+ */
+template <class Scalar>
+class GeneratedCO2Tables
+{
+    typedef Opm::SpanWagnerCO2<Scalar> SpanWagner;
+
+public:
+    typedef Opm::UniformTabulated2DFunction<Scalar, HugePageAllocator<Scalar> > TabulatedFunction;
+
+    //! The specific enthalpy of CO2 \f$\mathrm{[J/kg]}\f$ depending on temperature and pressure
+    static TabulatedFunction tabulatedEnthalpy;
+
+    //! The density of CO2 \f$\mathrm{[kg/m^3]}\f$ depending on temperature and pressure
+    static TabulatedFunction tabulatedDensity;
+
+    //! The salinity of the brine which is used by the Brine-CO2 fluid system
+    static Scalar brineSalinity;
+
+    /*!
+     * \brief Calculate the tables.
+     *
+     * If the name of a cache file is given and the file contains tables for the same
+     * ranges and resolutions, these are read from it. Otherwise, the tables are
+     * calculated and the file is written. Failing to do so is not an error.
+     *
+     * \param tempMin The minimum of the temperature range in \f$\mathrm{[K]}\f$
+     * \param tempMax The maximum of the temperature range in \f$\mathrm{[K]}\f$
+     * \param nTemp The number of sampling points within the temperature range
+     * \param pressMin The minimum of the pressure range in \f$\mathrm{[Pa]}\f$
+     * \param pressMax The maximum of the pressure range in \f$\mathrm{[Pa]}\f$
+     * \param nPress The number of sampling points within the pressure range
+     * \param cacheFileName The name of the cache file or an empty string
+     */
+    static void init(Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                     Scalar pressMin, Scalar pressMax, unsigned nPress,
+                     const std::string& cacheFileName = "")
+    {
+        if (!cacheFileName.empty()
+            && loadTables(cacheFileName, tempMin, tempMax, nTemp, pressMin, pressMax, nPress))
+            return;
+
+        discardCoarseTables_();
+        tabulatedDensity.resize(tempMin, tempMax, nTemp, pressMin, pressMax, nPress);
+        tabulatedEnthalpy.resize(tempMin, tempMax, nTemp, pressMin, pressMax, nPress);
+
+        int n = static_cast<int>(nTemp);
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic)
+#endif
+        for (int i = 0; i < n; ++i) {
+            Scalar T = tabulatedDensity.iToX(i);
+            for (int j = 0; j < static_cast<int>(nPress); ++j) {
+                Scalar p = tabulatedDensity.jToY(j);
+                Scalar rho = SpanWagner::density(T, p);
+                tabulatedDensity.setSamplePoint(i, j, rho);
+                tabulatedEnthalpy.setSamplePoint(i, j, SpanWagner::enthalpy(T, rho) + enthalpyOffset_());
+            }
+        }
+
+        if (!cacheFileName.empty()) {
+            try {
+                saveTables(cacheFileName);
+            }
+            catch (const std::exception&) {
+                // the cache file is only an optimization: if it cannot be written, e.g.,
+                // because the directory is read-only, the tables which were just
+                // calculated are used and the next run calculates them again
+            }
+        }
+    }
+
+    /*!
+     * \brief Derive coarse tables from the fine ones.
+     *
+     * The coarse tables cover the same range as the fine ones and are obtained by
+     * resampling them, cf. Opm::resampleUniformly(), so no additional evaluations of the
+     * equation of state are required. The coarse tables are only used after they have
+     * been selected by setUseCoarseTables(). Re-initializing the fine tables discards
+     * them.
+     *
+     * \param nTemp The number of sampling points within the temperature range
+     * \param nPress The number of sampling points within the pressure range
+     *
+     * \return The largest deviation of the coarse tables from the fine ones at the
+     *         sampling points of the latter, relative to the magnitude of their values
+     */
+    static Scalar initCoarse(unsigned nTemp, unsigned nPress)
+    {
+        setUseCoarseTables(false);
+
+        Scalar densityError =
+            resampleUniformly(otherDensity_, tabulatedDensity,
+                              static_cast<int>(nTemp), static_cast<int>(nPress));
+        Scalar enthalpyError =
+            resampleUniformly(otherEnthalpy_, tabulatedEnthalpy,
+                              static_cast<int>(nTemp), static_cast<int>(nPress));
+        if (otherDensity_.numX() == 0)
+            OPM_THROW(std::invalid_argument,
+                      "Coarse CO2 tables require initialized fine tables and at least "
+                      "two sampling points per direction");
+
+        return std::max(densityError, enthalpyError);
+    }
+
+    /*!
+     * \brief Specify whether the coarse tables ought to be used instead of the fine
+     *        ones.
+     *
+     * The tables are exchanged in place, so this is cheap. It must not be called while
+     * other threads evaluate the tables.
+     */
+    static void setUseCoarseTables(bool yesno)
+    {
+        if (yesno == useCoarseTables_)
+            return;
+        if (yesno && otherDensity_.numX() == 0)
+            OPM_THROW(std::logic_error,
+                      "The coarse CO2 tables must be initialized by initCoarse() before "
+                      "they can be used");
+
+        std::swap(tabulatedDensity, otherDensity_);
+        std::swap(tabulatedEnthalpy, otherEnthalpy_);
+        useCoarseTables_ = yesno;
+    }
+
+    /*!
+     * \brief Returns true iff the coarse tables are currently used.
+     */
+    static bool useCoarseTables()
+    { return useCoarseTables_; }
+
+    /*!
+     * \brief Write the fine tables to a file.
+     *
+     * \param fileName The name of the file
+     */
+    static void saveTables(const std::string& fileName)
+    {
+        const TabulatedFunction& fineDensity = useCoarseTables_ ? otherDensity_ : tabulatedDensity;
+        const TabulatedFunction& fineEnthalpy = useCoarseTables_ ? otherEnthalpy_ : tabulatedEnthalpy;
+
+        std::vector<Scalar> density, enthalpy;
+        getSamples_(fineDensity, density);
+        getSamples_(fineEnthalpy, enthalpy);
+
+        std::vector<const void*> arrays = { density.data(), enthalpy.data() };
+        std::vector<size_t> sizes = { density.size()*sizeof(Scalar), enthalpy.size()*sizeof(Scalar) };
+        TableFile::write(fileName,
+                         tableKey_(fineDensity.xMin(), fineDensity.xMax(),
+                                   static_cast<unsigned>(fineDensity.numX()),
+                                   fineDensity.yMin(), fineDensity.yMax(),
+                                   static_cast<unsigned>(fineDensity.numY())),
+                         arrays, sizes);
+    }
+
+    /*!
+     * \brief Read the tables from a file which was written by saveTables().
+     *
+     * \return true if the file exists and contains the tables for the given ranges and
+     *         resolutions. If false is returned, the tables are left untouched.
+     */
+    static bool loadTables(const std::string& fileName,
+                           Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                           Scalar pressMin, Scalar pressMax, unsigned nPress)
+    {
+        TableFile file;
+        if (!file.open(fileName, tableKey_(tempMin, tempMax, nTemp, pressMin, pressMax, nPress)))
+            return false;
+
+        size_t size = nTemp*nPress*sizeof(Scalar);
+        if (file.numArrays() != 2 || file.arraySize(0) != size || file.arraySize(1) != size)
+            return false;
+
+        discardCoarseTables_();
+        tabulatedDensity.resize(tempMin, tempMax, nTemp, pressMin, pressMax, nPress);
+        tabulatedEnthalpy.resize(tempMin, tempMax, nTemp, pressMin, pressMax, nPress);
+        setSamples_(tabulatedDensity, static_cast<const Scalar*>(file.array(0)));
+        setSamples_(tabulatedEnthalpy, static_cast<const Scalar*>(file.array(1)));
+
+        return true;
+    }
+
+private:
+    // the difference between the enthalpy reference state of co2tables.inc and the
+    // one of the equation of state [J/kg]
+    static Scalar enthalpyOffset_()
+    { return 21909.63; }
+
+    // switch back to the fine tables and release the coarse ones
+    static void discardCoarseTables_()
+    {
+        setUseCoarseTables(false);
+        otherDensity_ = TabulatedFunction();
+        otherEnthalpy_ = TabulatedFunction();
+    }
+
+    // the tables which are currently not used, i.e., the coarse ones if the fine ones
+    // are used and vice versa
+    static TabulatedFunction otherDensity_;
+    static TabulatedFunction otherEnthalpy_;
+    static bool useCoarseTables_;
+
+    static std::string tableKey_(Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                                 Scalar pressMin, Scalar pressMax, unsigned nPress)
+    {
+        std::ostringstream oss;
+        oss.precision(std::numeric_limits<Scalar>::digits10 + 3);
+        oss << "GeneratedCO2Tables"
+            << " sizeof(Scalar)=" << sizeof(Scalar)
+            << " T=[" << tempMin << ", " << tempMax << "]/" << nTemp
+            << " p=[" << pressMin << ", " << pressMax << "]/" << nPress;
+        return oss.str();
+    }
+
+    static void getSamples_(const TabulatedFunction& fn, std::vector<Scalar>& values)
+    {
+        values.resize(fn.numX()*fn.numY());
+        for (int i = 0; i < fn.numX(); ++i)
+            for (int j = 0; j < fn.numY(); ++j)
+                values[i*fn.numY() + j] = fn.getSamplePoint(i, j);
+    }
+
+    static void setSamples_(TabulatedFunction& fn, const Scalar* values)
+    {
+        for (int i = 0; i < fn.numX(); ++i)
+            for (int j = 0; j < fn.numY(); ++j)
+                fn.setSamplePoint(i, j, values[i*fn.numY() + j]);
+    }
+};
+
+template <class Scalar>
+typename GeneratedCO2Tables<Scalar>::TabulatedFunction GeneratedCO2Tables<Scalar>::tabulatedEnthalpy;
+template <class Scalar>
+typename GeneratedCO2Tables<Scalar>::TabulatedFunction GeneratedCO2Tables<Scalar>::tabulatedDensity;
+template <class Scalar>
+Scalar GeneratedCO2Tables<Scalar>::brineSalinity = 1.000000000000000e-01;
+template <class Scalar>
+typename GeneratedCO2Tables<Scalar>::TabulatedFunction GeneratedCO2Tables<Scalar>::otherDensity_;
+template <class Scalar>
+typename GeneratedCO2Tables<Scalar>::TabulatedFunction GeneratedCO2Tables<Scalar>::otherEnthalpy_;
+template <class Scalar>
+bool GeneratedCO2Tables<Scalar>::useCoarseTables_ = false;
+
+} // namespace Opm
+
+#endif
@@ -28,6 +28,7 @@
 
 #include <cmath>
 #include <cassert>
+#include <limits>
 
 #include <opm/material/IdealGas.hpp>
 #include <opm/material/common/Exceptions.hpp>
@@ -35,6 +36,7 @@
 #include <opm/material/common/Valgrind.hpp>
 
 #include "Component.hpp"
+#include "ComponentPhaseProperties.hpp"
 
 #include "iapws/Common.hpp"
 #include "iapws/Region1.hpp"
@@ -67,6 +69,8 @@ class H2O : public Component<Scalar, H2O<Scalar> >
     static const Scalar Rs; // specific gas constant of water
 
 public:
+    static const bool hasPhaseProperties = true;
+
     /*!
      * \brief A human readable name for the water.
      */
@@ -115,6 +119,41 @@ public:
     static const Scalar triplePressure()
     { return Common::triplePressure; }
 
+    /*!
+     * \brief Returns true if the properties of steam can be calculated for a given
+     *        temperature and pressure, cf. Component::isValidGasState.
+     *
+     * \param temperature Absolute temperature of the fluid in \f$\mathrm{[K]}\f$
+     * \param pressure Phase pressure in \f$\mathrm{[Pa]}\f$
+     */
+    template <class Evaluation>
+    static bool isValidGasState(const Evaluation& temperature, const Evaluation& pressure)
+    { return Region2::isValid(temperature, pressure); }
+
+    /*!
+     * \brief Returns true if the properties of liquid water can be calculated for a
+     *        given temperature and pressure, cf. Component::isValidLiquidState.
+     *
+     * \param temperature Absolute temperature of the fluid in \f$\mathrm{[K]}\f$
+     * \param pressure Phase pressure in \f$\mathrm{[Pa]}\f$
+     */
+    template <class Evaluation>
+    static bool isValidLiquidState(const Evaluation& temperature, const Evaluation& pressure)
+    { return Region1::isValid(temperature, pressure); }
+
+    /*!
+     * \brief Tabulate the vapor pressure and the vapor temperature of water.
+     *
+     * Afterwards, vaporPressure() and vaporTemperature() interpolate the saturation
+     * curve instead of evaluating the relations of the IAPWS, cf. IAPWS::Region4.
+     * Calling this method with less than two sampling points disables the tables.
+     *
+     * \param numSamples The number of sampling points between the triple and the
+     *                   critical point
+     */
+    static void tabulateSaturationCurve(unsigned numSamples = 1024)
+    { Region4::tabulate(numSamples); }
+
     /*!
      * \brief The vapor pressure in \f$\mathrm{[Pa]}\f$ of pure water
      *        at a given temperature.
@@ -150,7 +189,7 @@ public:
      * \param pressure Phase pressure in \f$\mathrm{[Pa]}\f$
      */
     template <class Evaluation>
-    static Evaluation vaporTemperature(const Evaluation& pressure)
+    static Evaluation vaporTemperature(Evaluation pressure)
     {
         if (pressure > criticalPressure())
             pressure = criticalPressure();
@@ -865,6 +904,172 @@ public:
         return Common::thermalConductivityIAPWS(temperature, rho);
     }
 
+    /*!
+     * \brief The density, specific enthalpy, isobaric heat capacity, viscosity and
+     *        thermal conductivity of liquid water.
+     *
+     * This yields the same results as liquidDensity(), liquidEnthalpy(),
+     * liquidHeatCapacity(), liquidViscosity() and liquidThermalConductivity(), but
+     * the derivatives of the Gibbs free energy of region 1 only get evaluated once.
+     *
+     * \param temperature Absolute temperature of the fluid in \f$\mathrm{[K]}\f$
+     * \param pressure Phase pressure in \f$\mathrm{[Pa]}\f$
+     */
+    template <class Evaluation>
+    static ComponentPhaseProperties<Evaluation> liquidProperties(const Evaluation& temperature,
+                                                                 const Evaluation& pressure)
+    {
+        ComponentPhaseProperties<Evaluation> result =
+            liquidThermodynamicProperties(temperature, pressure);
+        result.viscosity = Common::viscosity(temperature, result.density);
+        result.thermalConductivity = Common::thermalConductivityIAPWS(temperature, result.density);
+
+        return result;
+    }
+
+    /*!
+     * \brief The density, specific enthalpy and isobaric heat capacity of liquid water.
+     *
+     * This is liquidProperties() without the transport properties, which are
+     * considerably more expensive than the other quantities. The viscosity and the
+     * thermal conductivity of the result are NaN.
+     *
+     * \param temperature Absolute temperature of the fluid in \f$\mathrm{[K]}\f$
+     * \param pressure Phase pressure in \f$\mathrm{[Pa]}\f$
+     */
+    template <class Evaluation>
+    static ComponentPhaseProperties<Evaluation> liquidThermodynamicProperties(const Evaluation& temperature,
+                                                                              const Evaluation& pressure)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (!Region1::isValid(temperature, pressure))
+        {
+            OPM_THROW(NumericalIssue,
+                      "Properties of water are only implemented for temperatures below 623.15K and "
+                      "pressures below 100MPa. (T = " << temperature << ", p=" << pressure);
+        }
+
+        // below the vapor pressure, all quantities are regularized using their values
+        // at the vapor pressure
+        const Evaluation& pv = vaporPressure(temperature);
+        bool regularize = (pressure < pv);
+        const Evaluation& p = regularize ? pv : pressure;
+
+        Evaluation gamma, dgamma_dtau, dgamma_dpi, ddgamma_dtaudpi, ddgamma_ddpi, ddgamma_ddtau;
+        Region1::gammaAndDerivatives(gamma, dgamma_dtau, dgamma_dpi,
+                                     ddgamma_dtaudpi, ddgamma_ddpi, ddgamma_ddtau,
+                                     temperature, p);
+
+        const Evaluation& tau = Region1::tau(temperature);
+        const Evaluation& h = tau*dgamma_dtau*Rs*temperature;
+        const Evaluation& v = Region1::pi(p)*dgamma_dpi*Rs*temperature/p;
+
+        ComponentPhaseProperties<Evaluation> result;
+        result.heatCapacity = - Toolbox::pow(tau, 2)*ddgamma_ddtau*Rs;
+        if (regularize) {
+            const Evaluation& dh_dp =
+                Rs*temperature*tau*Region1::dpi_dp(Toolbox::value(pv))*ddgamma_dtaudpi;
+            result.enthalpy = h + (pressure - pv)*dh_dp;
+
+            Scalar eps = Toolbox::value(pv)*1e-8;
+            const Evaluation& dv_dp = (volumeRegion1_(temperature, pv + eps) - v)/eps;
+            const Evaluation& drho_dp = - 1/(v*v)*dv_dp;
+            result.density = 1.0/v + (pressure - pv)*drho_dp;
+        }
+        else {
+            result.enthalpy = h;
+            result.density = 1/v;
+        }
+
+        const Evaluation& NaN = Toolbox::createConstant(std::numeric_limits<Scalar>::quiet_NaN());
+        result.viscosity = NaN;
+        result.thermalConductivity = NaN;
+
+        return result;
+    }
+
+    /*!
+     * \brief The density, specific enthalpy, isobaric heat capacity, viscosity and
+     *        thermal conductivity of steam.
+     *
+     * This yields the same results as gasDensity(), gasEnthalpy(), gasHeatCapacity(),
+     * gasViscosity() and gasThermalConductivity(), but the derivatives of the Gibbs
+     * free energy of region 2 only get evaluated once.
+     *
+     * \param temperature Absolute temperature of the fluid in \f$\mathrm{[K]}\f$
+     * \param pressure Phase pressure in \f$\mathrm{[Pa]}\f$
+     */
+    template <class Evaluation>
+    static ComponentPhaseProperties<Evaluation> gasProperties(const Evaluation& temperature,
+                                                              const Evaluation& pressure)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (!Region2::isValid(temperature, pressure))
+        {
+            OPM_THROW(NumericalIssue,
+                      "Properties of steam are only implemented for temperatures below 623.15K and "
+                      "pressures below 100MPa. (T = " << temperature << ", p=" << pressure);
+        }
+
+        // for low pressures, steam is regularized as an ideal gas using the values
+        // slightly below the triple pressure, above the vapor pressure using the values
+        // at the vapor pressure
+        const Evaluation& pMin = Toolbox::createConstant(triplePressure() - 100);
+        Evaluation pv = 0.0;
+        Evaluation p = pressure;
+        bool belowMin = (pressure < pMin);
+        bool aboveVapor = false;
+        if (belowMin)
+            p = pMin;
+        else {
+            pv = vaporPressure(temperature);
+            aboveVapor = (pressure > pv);
+            if (aboveVapor)
+                p = pv;
+        }
+
+        Evaluation gamma, dgamma_dtau, dgamma_dpi, ddgamma_dtaudpi, ddgamma_ddpi, ddgamma_ddtau;
+        Region2::gammaAndDerivatives(gamma, dgamma_dtau, dgamma_dpi,
+                                     ddgamma_dtaudpi, ddgamma_ddpi, ddgamma_ddtau,
+                                     temperature, p);
+
+        const Evaluation& tau = Region2::tau(temperature);
+        const Evaluation& h = tau*dgamma_dtau*Rs*temperature;
+        const Evaluation& v = Region2::pi(p)*dgamma_dpi*Rs*temperature/p;
+
+        ComponentPhaseProperties<Evaluation> result;
+        result.heatCapacity = - Toolbox::pow(tau, 2)*ddgamma_ddtau*Rs;
+        if (belowMin) {
+            const Evaluation& rho0Id =
+                IdealGas<Scalar>::density(Evaluation(molarMass()), temperature, pMin);
+            result.enthalpy = h;
+            result.density =
+                (1.0/v)/rho0Id
+                *IdealGas<Scalar>::density(Evaluation(molarMass()), temperature, pressure);
+        }
+        else if (aboveVapor) {
+            const Evaluation& dh_dp =
+                Rs*temperature*tau*Region2::dpi_dp(pv)*ddgamma_dtaudpi;
+            result.enthalpy = h + (pressure - pv)*dh_dp;
+
+            Scalar eps = Toolbox::value(pv)*1e-8;
+            const Evaluation& dv_dp = (volumeRegion2_(temperature, pv + eps) - v)/eps;
+            const Evaluation& drho_dp = - 1/(v*v)*dv_dp;
+            result.density = 1.0/v + (pressure - pv)*drho_dp;
+        }
+        else {
+            result.enthalpy = h;
+            result.density = 1.0/v;
+        }
+
+        result.viscosity = Common::viscosity(temperature, result.density);
+        result.thermalConductivity = Common::thermalConductivityIAPWS(temperature, result.density);
+
+        return result;
+    }
+
 private:
     // the unregularized specific enthalpy for liquid water
     template <class Evaluation>
@@ -882,7 +1087,7 @@ private:
     {
         typedef Opm::MathToolbox<Evaluation> Toolbox;
         return
-            - Toolbox::pow(Region1::tau(temperature), 2.0) *
+            - Toolbox::pow(Region1::tau(temperature), 2) *
             Region1::ddgamma_ddtau(temperature, pressure) *
             Rs;
     }
@@ -891,24 +1096,33 @@ private:
     template <class Evaluation>
     static Evaluation heatCap_v_Region1_(const Evaluation& temperature, const Evaluation& pressure)
     {
-        double tau = Region1::tau(temperature);
-        double num = Region1::dgamma_dpi(temperature, pressure) - tau * Region1::ddgamma_dtaudpi(temperature, pressure);
-        double diff = std::pow(num, 2) / Region1::ddgamma_ddpi(temperature, pressure);
+        Evaluation gamma, dgamma_dtau, dgamma_dpi, ddgamma_dtaudpi, ddgamma_ddpi, ddgamma_ddtau;
+        Region1::gammaAndDerivatives(gamma, dgamma_dtau, dgamma_dpi,
+                                     ddgamma_dtaudpi, ddgamma_ddpi, ddgamma_ddtau,
+                                     temperature, pressure);
+
+        const Evaluation& tau = Region1::tau(temperature);
+        const Evaluation& num = dgamma_dpi - tau*ddgamma_dtaudpi;
+        const Evaluation& diff = num*num/ddgamma_ddpi;
 
         return
-            - std::pow(tau, 2 ) *
-            Region1::ddgamma_ddtau(temperature, pressure) * Rs +
-            diff;
+            - tau*tau*ddgamma_ddtau*Rs
+            + diff;
     }
 
     // the unregularized specific internal energy for liquid water
     template <class Evaluation>
     static Evaluation internalEnergyRegion1_(const Evaluation& temperature, const Evaluation& pressure)
     {
+        Evaluation gamma, dgamma_dtau, dgamma_dpi, ddgamma_dtaudpi, ddgamma_ddpi, ddgamma_ddtau;
+        Region1::gammaAndDerivatives(gamma, dgamma_dtau, dgamma_dpi,
+                                     ddgamma_dtaudpi, ddgamma_ddpi, ddgamma_ddtau,
+                                     temperature, pressure);
+
         return
             Rs * temperature *
-            ( Region1::tau(temperature)*Region1::dgamma_dtau(temperature, pressure) -
-              Region1::pi(pressure)*Region1::dgamma_dpi(temperature, pressure));
+            ( Region1::tau(temperature)*dgamma_dtau -
+              Region1::pi(pressure)*dgamma_dpi);
     }
 
     // the unregularized specific volume for liquid water
@@ -935,10 +1149,15 @@ private:
     template <class Evaluation>
     static Evaluation internalEnergyRegion2_(const Evaluation& temperature, const Evaluation& pressure)
     {
+        Evaluation gamma, dgamma_dtau, dgamma_dpi, ddgamma_dtaudpi, ddgamma_ddpi, ddgamma_ddtau;
+        Region2::gammaAndDerivatives(gamma, dgamma_dtau, dgamma_dpi,
+                                     ddgamma_dtaudpi, ddgamma_ddpi, ddgamma_ddtau,
+                                     temperature, pressure);
+
         return
             Rs * temperature *
-            ( Region2::tau(temperature)*Region2::dgamma_dtau(temperature, pressure) -
-              Region2::pi(pressure)*Region2::dgamma_dpi(temperature, pressure));
+            ( Region2::tau(temperature)*dgamma_dtau -
+              Region2::pi(pressure)*dgamma_dpi);
     }
 
     // the unregularized specific isobaric heat capacity
@@ -957,13 +1176,17 @@ private:
     template <class Evaluation>
     static Evaluation heatCap_v_Region2_(const Evaluation& temperature, const Evaluation& pressure)
     {
+        Evaluation gamma, dgamma_dtau, dgamma_dpi, ddgamma_dtaudpi, ddgamma_ddpi, ddgamma_ddtau;
+        Region2::gammaAndDerivatives(gamma, dgamma_dtau, dgamma_dpi,
+                                     ddgamma_dtaudpi, ddgamma_ddpi, ddgamma_ddtau,
+                                     temperature, pressure);
+
         const Evaluation& tau = Region2::tau(temperature);
         const Evaluation& pi = Region2::pi(pressure);
-        const Evaluation& num = 1 + pi * Region2::dgamma_dpi(temperature, pressure) + tau * pi * Region2::ddgamma_dtaudpi(temperature, pressure);
-        const Evaluation& diff = num * num / (1 - pi * pi * Region2::ddgamma_ddpi(temperature, pressure));
+        const Evaluation& num = 1 + pi*dgamma_dpi + tau*pi*ddgamma_dtaudpi;
+        const Evaluation& diff = num*num/(1 - pi*pi*ddgamma_ddpi);
         return
-            - std::pow(tau, 2 ) *
-            Region2::ddgamma_ddtau(temperature, pressure) * Rs
+            - tau*tau*ddgamma_ddtau*Rs
             - diff;
     }
 
@@ -0,0 +1,450 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::SpanWagnerCO2
+ */
+#ifndef OPM_SPAN_WAGNER_CO2_HPP
+#define OPM_SPAN_WAGNER_CO2_HPP
+
+#include <cmath>
+#include <limits>
+
+namespace Opm {
+
+/*!
+ * \ingroup Components
+ *
+ * \brief The reference equation of state for carbon dioxide by Span and Wagner.
+ *
+ * The equation is formulated in terms of the reduced Helmholtz free energy
+ * \f$\phi(\delta, \tau) = \phi^0(\delta, \tau) + \phi^r(\delta, \tau)\f$ with
+ * \f$\delta = \rho/\rho_c\f$ and \f$\tau = T_c/T\f$. It is expensive to evaluate and
+ * the density at a given pressure can only be determined iteratively, so it is
+ * intended to be used for generating the property tables which are used by
+ * Opm::CO2, see Opm::GeneratedCO2Tables.
+ *
+ * See:
+ *
+ * R. Span and W. Wagner: A New Equation of State for Carbon Dioxide Covering the
+ * Fluid Region from the Triple-Point Temperature to 1100 K at Pressures up to 800
+ * MPa. Journal of Physical and Chemical Reference Data, 25 (6), pp. 1509-1596, 1996
+ *
+ * \tparam Scalar The type used for scalar values
+ */
+template <class Scalar>
+class SpanWagnerCO2
+{
+public:
+    /*!
+     * \brief Returns the critical temperature of CO2 \f$\mathrm{[K]}\f$.
+     */
+    static Scalar criticalTemperature()
+    { return 304.1282; }
+
+    /*!
+     * \brief Returns the critical density of CO2 \f$\mathrm{[kg/m^3]}\f$.
+     */
+    static Scalar criticalDensity()
+    { return 467.6; }
+
+    /*!
+     * \brief Returns the specific gas constant of CO2 \f$\mathrm{[J/(kg K)]}\f$.
+     */
+    static Scalar specificGasConstant()
+    { return 188.9241; }
+
+    /*!
+     * \brief The pressure of CO2 \f$\mathrm{[Pa]}\f$ at a given temperature and
+     *        density.
+     *
+     * \param temperature Absolute temperature in \f$\mathrm{[K]}\f$
+     * \param density Density in \f$\mathrm{[kg/m^3]}\f$
+     */
+    static Scalar pressure(Scalar temperature, Scalar density)
+    {
+        Scalar delta = density/criticalDensity();
+        Scalar tau = criticalTemperature()/temperature;
+
+        Scalar phir, phir_delta, phir_tau;
+        residual_(phir, phir_delta, phir_tau, delta, tau);
+
+        return density*specificGasConstant()*temperature*(1 + delta*phir_delta);
+    }
+
+    /*!
+     * \brief The specific enthalpy of CO2 \f$\mathrm{[J/kg]}\f$ at a given temperature
+     *        and density.
+     *
+     * The reference state is the one of the equation, i.e., the enthalpy of the ideal
+     * gas is zero at 298.15 K.
+     *
+     * \param temperature Absolute temperature in \f$\mathrm{[K]}\f$
+     * \param density Density in \f$\mathrm{[kg/m^3]}\f$
+     */
+    static Scalar enthalpy(Scalar temperature, Scalar density)
+    {
+        Scalar delta = density/criticalDensity();
+        Scalar tau = criticalTemperature()/temperature;
+
+        Scalar phir, phir_delta, phir_tau;
+        residual_(phir, phir_delta, phir_tau, delta, tau);
+
+        return
+            specificGasConstant()*temperature
+            *(1 + tau*(idealGas_tau_(tau) + phir_tau) + delta*phir_delta);
+    }
+
+    /*!
+     * \brief The specific Gibbs free energy of CO2 \f$\mathrm{[J/kg]}\f$ at a given
+     *        temperature and density.
+     *
+     * \param temperature Absolute temperature in \f$\mathrm{[K]}\f$
+     * \param density Density in \f$\mathrm{[kg/m^3]}\f$
+     */
+    static Scalar gibbsEnergy(Scalar temperature, Scalar density)
+    {
+        Scalar delta = density/criticalDensity();
+        Scalar tau = criticalTemperature()/temperature;
+
+        Scalar phir, phir_delta, phir_tau;
+        residual_(phir, phir_delta, phir_tau, delta, tau);
+
+        return
+            specificGasConstant()*temperature
+            *(1 + idealGas_(delta, tau) + phir + delta*phir_delta);
+    }
+
+    /*!
+     * \brief The density of CO2 \f$\mathrm{[kg/m^3]}\f$ at a given temperature and
+     *        pressure.
+     *
+     * Below the critical temperature, the equation of state exhibits large loops
+     * between the gaseous and the liquid branches, so it can have several roots for a
+     * given pressure. The gaseous root is thus determined using the Newton method
+     * starting at the ideal gas density, the liquid root is determined starting at a
+     * density which is larger than the one of all liquid states. Since the pressure
+     * is concave on the gaseous branch and convex on the liquid one, the iterates
+     * approach the respective root monotonically; if they do not, the root does not
+     * exist. If both roots exist, the thermodynamically stable phase, i.e., the one of
+     * the lower Gibbs free energy, is chosen. If neither of them is found, which can
+     * only happen close to the critical point, the density is determined by
+     * bisection.
+     *
+     * \param temperature Absolute temperature in \f$\mathrm{[K]}\f$
+     * \param pressure Pressure in \f$\mathrm{[Pa]}\f$
+     *
+     * \return The density or NaN if it could not be determined
+     */
+    static Scalar density(Scalar temperature, Scalar pressure)
+    {
+        Scalar rhoGasLast = pressure/(specificGasConstant()*temperature);
+        Scalar rhoGas = solveDensity_(temperature, pressure, rhoGasLast, /*fromBelow=*/true);
+
+        Scalar rhoLiquidLast = 1400.0;
+        while (SpanWagnerCO2::pressure(temperature, rhoLiquidLast) < pressure && rhoLiquidLast < 1e4)
+            rhoLiquidLast *= 1.2;
+        Scalar rhoLiquid = solveDensity_(temperature, pressure, rhoLiquidLast, /*fromBelow=*/false);
+
+        if (std::isfinite(rhoGas) && std::isfinite(rhoLiquid)) {
+            if (std::abs(rhoGas - rhoLiquid) <= 1e-8*rhoLiquid)
+                return rhoGas;
+            if (gibbsEnergy(temperature, rhoGas) < gibbsEnergy(temperature, rhoLiquid))
+                return rhoGas;
+            return rhoLiquid;
+        }
+        else if (std::isfinite(rhoGas))
+            return rhoGas;
+        else if (std::isfinite(rhoLiquid))
+            return rhoLiquid;
+
+        return bisectDensity_(temperature, pressure, rhoGasLast, rhoLiquidLast);
+    }
+
+private:
+    // solve the equation of state for the density using the Newton method. the
+    // iterates must approach the solution monotonically from the specified side. if
+    // they do not, NaN is returned and rhoLast is set to the last iterate which was
+    // on the correct side.
+    static Scalar solveDensity_(Scalar temperature, Scalar pressure, Scalar& rhoLast, bool fromBelow)
+    {
+        Scalar rho = rhoLast;
+        for (int iterIdx = 0; iterIdx < 100; ++iterIdx) {
+            Scalar f = SpanWagnerCO2::pressure(temperature, rho) - pressure;
+            if ((fromBelow && f > 1e-10*pressure) || (!fromBelow && f < -1e-10*pressure))
+                break;
+            rhoLast = rho;
+
+            Scalar eps = rho*1e-7;
+            Scalar df_drho =
+                (SpanWagnerCO2::pressure(temperature, rho + eps)
+                 - SpanWagnerCO2::pressure(temperature, rho - eps))/(2*eps);
+
+            // the equation of state is mechanically unstable at this density
+            if (!(df_drho > 0))
+                break;
+
+            Scalar delta = - f/df_drho;
+            rho += delta;
+            if (!(rho > 0))
+                break;
+
+            if (std::abs(delta) <= 1e-11*rho)
+                return rho;
+        }
+
+        return std::numeric_limits<Scalar>::quiet_NaN();
+    }
+
+    // determine the density by bisection
+    static Scalar bisectDensity_(Scalar temperature, Scalar pressure, Scalar rhoMin, Scalar rhoMax)
+    {
+        if (!(SpanWagnerCO2::pressure(temperature, rhoMin) <= pressure
+              && SpanWagnerCO2::pressure(temperature, rhoMax) >= pressure))
+            return std::numeric_limits<Scalar>::quiet_NaN();
+
+        while (rhoMax - rhoMin > 1e-11*rhoMax) {
+            Scalar rho = (rhoMin + rhoMax)/2;
+            if (SpanWagnerCO2::pressure(temperature, rho) < pressure)
+                rhoMin = rho;
+            else
+                rhoMax = rho;
+        }
+
+        return (rhoMin + rhoMax)/2;
+    }
+
+    // the ideal gas part of the reduced Helmholtz free energy
+    static Scalar idealGas_(Scalar delta, Scalar tau)
+    {
+        Scalar result = std::log(delta) + a0_(0) + a0_(1)*tau + a0_(2)*std::log(tau);
+        for (int i = 3; i < 8; ++i)
+            result += a0_(i)*std::log(1 - std::exp(-theta0_(i)*tau));
+        return result;
+    }
+
+    // the partial derivative of the ideal gas part to tau
+    static Scalar idealGas_tau_(Scalar tau)
+    {
+        Scalar result = a0_(1) + a0_(2)/tau;
+        for (int i = 3; i < 8; ++i)
+            result += a0_(i)*theta0_(i)*(1/(1 - std::exp(-theta0_(i)*tau)) - 1);
+        return result;
+    }
+
+    // the residual part of the reduced Helmholtz free energy and its partial
+    // derivatives to delta and tau
+    static void residual_(Scalar& phi,
+                          Scalar& phi_delta,
+                          Scalar& phi_tau,
+                          Scalar delta,
+                          Scalar tau)
+    {
+        phi = phi_delta = phi_tau = 0.0;
+
+        // polynomial terms
+        for (int i = 0; i < 7; ++i) {
+            Scalar term = n_(i)*std::pow(delta, d_(i))*std::pow(tau, t_(i));
+            phi += term;
+            phi_delta += term*d_(i)/delta;
+            phi_tau += term*t_(i)/tau;
+        }
+
+        // exponential terms
+        for (int i = 7; i < 34; ++i) {
+            Scalar deltaC = std::pow(delta, c_(i));
+            Scalar term = n_(i)*std::pow(delta, d_(i))*std::pow(tau, t_(i))*std::exp(-deltaC);
+            phi += term;
+            phi_delta += term*(d_(i) - c_(i)*deltaC)/delta;
+            phi_tau += term*t_(i)/tau;
+        }
+
+        // Gaussian bell-shaped terms
+        for (int i = 34; i < 39; ++i) {
+            Scalar dd = delta - epsilon_(i);
+            Scalar dt = tau - gamma_(i);
+            Scalar term =
+                n_(i)*std::pow(delta, d_(i))*std::pow(tau, t_(i))
+                *std::exp(-alpha_(i)*dd*dd - beta_(i)*dt*dt);
+            phi += term;
+            phi_delta += term*(d_(i)/delta - 2*alpha_(i)*dd);
+            phi_tau += term*(t_(i)/tau - 2*beta_(i)*dt);
+        }
+
+        // non-analytical terms which describe the critical region
+        for (int i = 39; i < 42; ++i) {
+            Scalar dd = delta - 1;
+            Scalar dd2 = dd*dd;
+            Scalar dt = tau - 1;
+
+            Scalar theta = (1 - tau) + A_(i)*std::pow(dd2, 1/(2*beta_(i)));
+            Scalar Delta = theta*theta + B_(i)*std::pow(dd2, a_(i));
+            Scalar psi = std::exp(- C_(i)*dd2 - D_(i)*dt*dt);
+
+            Scalar Deltab = std::pow(Delta, b_(i));
+            Scalar dDeltab_dDelta = b_(i)*std::pow(Delta, b_(i) - 1);
+            Scalar dDelta_ddelta =
+                dd*(A_(i)*theta*2/beta_(i)*std::pow(dd2, 1/(2*beta_(i)) - 1)
+                    + 2*B_(i)*a_(i)*std::pow(dd2, a_(i) - 1));
+            Scalar dpsi_ddelta = -2*C_(i)*dd*psi;
+            Scalar dpsi_dtau = -2*D_(i)*dt*psi;
+
+            phi += n_(i)*Deltab*delta*psi;
+            phi_delta +=
+                n_(i)*(Deltab*(psi + delta*dpsi_ddelta)
+                       + dDeltab_dDelta*dDelta_ddelta*delta*psi);
+            phi_tau +=
+                n_(i)*delta*(-2*theta*dDeltab_dDelta*psi + Deltab*dpsi_dtau);
+        }
+    }
+
+    static Scalar a0_(int i)
+    {
+        static const Scalar a0[8] = {
+            8.37304456, -3.70454304, 2.50000000, 1.99427042,
+            0.62105248, 0.41195293, 1.04028922, 0.08327678
+        };
+        return a0[i];
+    }
+
+    static Scalar theta0_(int i)
+    {
+        static const Scalar theta0[8] = {
+            0.0, 0.0, 0.0, 3.15163,
+            6.11190, 6.77708, 11.32384, 27.08792
+        };
+        return theta0[i];
+    }
+
+    static Scalar n_(int i)
+    {
+        static const Scalar n[42] = {
+            0.38856823203161, 2.9385475942740, -5.5867188534934,
+           -0.76753199592477, 0.31729005580416, 0.54803315897767,
+            0.12279411220335,
+
+            2.1658961543220, 1.5841735109724, -0.23132705405503,
+            0.058116916431436, -0.55369137205382, 0.48946615909422,
+           -0.024275739843501, 0.062494790501678, -0.12175860225246,
+           -0.37055685270086, -0.016775879700426, -0.11960736637987,
+           -0.045619362508778, 0.035612789270346, -0.0074427727132052,
+           -0.0017395704902432, -0.021810121289527, 0.024332166559236,
+           -0.037440133423463, 0.14338715756878, -0.13491969083286,
+           -0.023151225053480, 0.012363125492901, 0.0021058321972940,
+           -0.00033958519026368, 0.0055993651771592, -0.00030335118055646,
+
+           -213.65488688320, 26641.569149272, -24027.212204557,
+           -283.41603423999, 212.47284400179,
+
+           -0.66642276540751, 0.72608632349897, 0.055068668612842
+        };
+        return n[i];
+    }
+
+    static Scalar d_(int i)
+    {
+        static const short int d[39] = {
+            1, 1, 1, 1, 2, 2, 3,
+            1, 2, 4, 5, 5, 5, 6, 6, 6, 1, 1, 4, 4, 4, 7, 8, 2, 3, 3, 5, 5, 6, 7, 8, 10, 4, 8,
+            2, 2, 2, 3, 3
+        };
+        return d[i];
+    }
+
+    static Scalar t_(int i)
+    {
+        static const Scalar t[39] = {
+            0.00, 0.75, 1.00, 2.00, 0.75, 2.00, 0.75,
+            1.50, 1.50, 2.50, 0.00, 1.50, 2.00, 0.00, 1.00, 2.00, 3.00, 6.00, 3.00, 6.00,
+            8.00, 6.00, 0.00, 7.00, 12.00, 16.00, 22.00, 24.00, 16.00, 24.00, 8.00, 2.00,
+            28.00, 14.00,
+            1.00, 0.00, 1.00, 3.00, 3.00
+        };
+        return t[i];
+    }
+
+    static Scalar c_(int i)
+    {
+        static const short int c[34] = {
+            0, 0, 0, 0, 0, 0, 0,
+            1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 4, 4, 4, 4, 4, 4, 5, 6
+        };
+        return c[i];
+    }
+
+    // the parameters of the Gaussian terms
+    static Scalar alpha_(int i)
+    {
+        static const Scalar alpha[5] = { 25, 25, 25, 15, 20 };
+        return alpha[i - 34];
+    }
+
+    // the parameters of the Gaussian and the non-analytical terms
+    static Scalar beta_(int i)
+    {
+        static const Scalar beta[8] = { 325, 300, 300, 275, 275, 0.3, 0.3, 0.3 };
+        return beta[i - 34];
+    }
+
+    static Scalar gamma_(int i)
+    {
+        static const Scalar gamma[5] = { 1.16, 1.19, 1.19, 1.25, 1.22 };
+        return gamma[i - 34];
+    }
+
+    static Scalar epsilon_(int /*i*/)
+    { return 1.0; }
+
+    // the parameters of the non-analytical terms
+    static Scalar a_(int i)
+    {
+        static const Scalar a[3] = { 3.5, 3.5, 3.0 };
+        return a[i - 39];
+    }
+
+    static Scalar b_(int i)
+    {
+        static const Scalar b[3] = { 0.875, 0.925, 0.875 };
+        return b[i - 39];
+    }
+
+    static Scalar A_(int /*i*/)
+    { return 0.7; }
+
+    static Scalar B_(int i)
+    {
+        static const Scalar B[3] = { 0.3, 0.3, 1.0 };
+        return B[i - 39];
+    }
+
+    static Scalar C_(int i)
+    {
+        static const Scalar C[3] = { 10.0, 10.0, 12.5 };
+        return C[i - 39];
+    }
+
+    static Scalar D_(int /*i*/)
+    { return 275.0; }
+};
+
+} // namespace Opm
+
+#endif
@@ -26,53 +26,182 @@
 #ifndef OPM_TABULATED_COMPONENT_HPP
 #define OPM_TABULATED_COMPONENT_HPP
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <cassert>
 #include <iostream>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <cstring>
+#include <type_traits>
 
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
 
+#include <opm/material/common/Instrumentation.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
+#include <opm/material/common/HugePageAllocator.hpp>
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/TableFile.hpp>
+#include <opm/material/components/ComponentPhaseProperties.hpp>
 
 namespace Opm {
 /*!
  * \ingroup Components
  *
- * \brief A generic class which tabulates all thermodynamic properties
- *        of a given component.
+ * \brief The flags which select the properties that are tabulated by
+ *        TabulatedComponent and TabulatedComponentInstance.
+ */
+class TabulatedComponentProperties
+{
+public:
+    /*!
+     * \brief Flags which select the properties that are tabulated.
+     *
+     * The flags can be combined using the bitwise or operator. The internal energies
+     * of a phase are calculated from its enthalpy and density, so both need to be
+     * tabulated for them. The vapor pressure is always tabulated. The bits
+     * correspond to the indices of the internal property tables.
+     */
+    enum PropertyFlags {
+        gasEnthalpyFlag = 1 << 0,
+        liquidEnthalpyFlag = 1 << 1,
+        gasHeatCapacityFlag = 1 << 2,
+        liquidHeatCapacityFlag = 1 << 3,
+        gasDensityFlag = 1 << 4,
+        liquidDensityFlag = 1 << 5,
+        gasViscosityFlag = 1 << 6,
+        liquidViscosityFlag = 1 << 7,
+        gasThermalConductivityFlag = 1 << 8,
+        liquidThermalConductivityFlag = 1 << 9,
+        gasPressureFlag = 1 << 10,
+        liquidPressureFlag = 1 << 11,
+
+        allPropertiesFlag = (1 << 12) - 1
+    };
+};
+
+/*!
+ * \ingroup Components
+ *
+ * \brief An object which tabulates all thermodynamic properties of a given component
+ *        and provides the same API as Opm::TabulatedComponent using non-static
+ *        methods.
  *
  * At the moment, this class can only handle the sub-critical fluids
  * since it tabulates along the vapor pressure curve.
  *
+ * By default, the two-dimensional tables are interpolated bilinearly. Optionally, the
+ * partial derivatives of the quantities are tabulated as well and bicubic Hermite
+ * interpolation is used. This quadruples the size of each table, but it is much more
+ * accurate for a given resolution and the derivatives of the interpolated quantities
+ * are continuous, so considerably coarser tables can be used.
+ *
+ * If enabled, the two-dimensional tables are stored on huge pages (cf. Opm::HugePages).
+ *
+ * Since each object owns its tables, several tabulations of the same raw component can
+ * be used within a process, e.g., one per model with tables which only cover the
+ * temperature and pressure range of that model. Once it is initialized, an object can
+ * be accessed by multiple threads concurrently.
+ *
  * \tparam Scalar The type used for scalar values
  * \tparam RawComponent The component which ought to be tabulated
  * \tparam useVaporPressure If true, tabulate all quantities along the
  *                          vapor pressure curve, if false use the
  *                          pressure range [p_min, p_max]
+ * \tparam StorageScalarT The type used to store the values of the two-dimensional
+ *                        property tables. Using float halves their memory footprint;
+ *                        the interpolation is still done using Scalar.
  */
-template <class ScalarT, class RawComponent, bool useVaporPressure=true>
-class TabulatedComponent
+template <class ScalarT, class RawComponent, bool useVaporPressure=true, class StorageScalarT=ScalarT>
+class TabulatedComponentInstance : public TabulatedComponentProperties
 {
 public:
     typedef ScalarT Scalar;
+    typedef StorageScalarT StorageScalar;
 
     static const bool isTabulated = true;
 
+    //! liquidProperties() and gasProperties() are provided, but quantities which are not
+    //! tabulated are reported as NaN instead of raising an error, so users of
+    //! Component::hasPhaseProperties keep using the individual lookups
+    static const bool hasPhaseProperties = false;
+
+    TabulatedComponentInstance()
+        : temperatures_(0)
+        , vaporPressure_(0)
+        , minLiquidDensity__(0)
+        , maxLiquidDensity__(0)
+        , minGasDensity__(0)
+        , maxGasDensity__(0)
+        , properties_(allPropertiesFlag)
+        , bicubic_(false)
+        , tablesInFile_(false)
+        , tempMin_(0.0)
+        , tempMax_(0.0)
+        , nTemp_(0)
+        , pressMin_(0.0)
+        , pressMax_(0.0)
+        , nPress_(0)
+        , densityMin_(0.0)
+        , densityMax_(0.0)
+        , nDensity_(0)
+    {
+        for (int tableIdx = 0; tableIdx < numTables; ++tableIdx)
+            tables_[tableIdx].store(nullptr);
+    }
+
+    // the tables are owned by the object and the atomic table pointers cannot be
+    // copied anyway
+    TabulatedComponentInstance(const TabulatedComponentInstance&) = delete;
+    TabulatedComponentInstance& operator=(const TabulatedComponentInstance&) = delete;
+
+    ~TabulatedComponentInstance()
+    { releaseTables_(); }
+
     /*!
      * \brief Initialize the tables.
      *
+     * The rows of the tables are filled in parallel if OpenMP is enabled. If the tables
+     * are initialized lazily, only the temperature dependent quantities (vapor pressure
+     * and the density ranges) are computed by this method. Each of the two-dimensional
+     * property tables is then calculated when it is accessed for the first time. This
+     * is thread-safe: if several threads do this concurrently, the table of the first
+     * thread which finishes the calculation is used and the others are discarded.
+     *
+     * If the tables are not initialized lazily and the raw component provides the
+     * liquidProperties() and gasProperties() methods, these are used to fill the tables
+     * of each phase at once.
+     *
+     * Only the properties which are selected by the properties argument are tabulated
+     * and the memory for the others is not allocated. Querying one of the latter
+     * throws a std::logic_error.
+     *
      * \param tempMin The minimum of the temperature range in \f$\mathrm{[K]}\f$
      * \param tempMax The maximum of the temperature range in \f$\mathrm{[K]}\f$
      * \param nTemp The number of entries/steps within the temperature range
      * \param pressMin The minimum of the pressure range in \f$\mathrm{[Pa]}\f$
      * \param pressMax The maximum of the pressure range in \f$\mathrm{[Pa]}\f$
      * \param nPress The number of entries/steps within the pressure range
+     * \param lazy If true, tabulate the properties on their first use
+     * \param bicubic If true, use bicubic Hermite instead of bilinear interpolation
+     * \param properties The properties to be tabulated, cf. PropertyFlags
      */
-    static void init(Scalar tempMin, Scalar tempMax, unsigned nTemp,
-                     Scalar pressMin, Scalar pressMax, unsigned nPress)
+    void init(Scalar tempMin, Scalar tempMax, unsigned nTemp,
+              Scalar pressMin, Scalar pressMax, unsigned nPress,
+              bool lazy = false,
+              bool bicubic = false,
+              unsigned properties = allPropertiesFlag)
     {
+        OPM_PROFILER_RANGE(std::string("TabulatedComponent<") + RawComponent::name() + ">::init");
+
+        properties_ = properties & allPropertiesFlag;
+        bicubic_ = bicubic;
         tempMin_ = tempMin;
         tempMax_ = tempMax;
         nTemp_ = nTemp;
@@ -81,133 +210,228 @@ public:
         nPress_ = nPress;
         nDensity_ = nPress_;
 
-        // allocate the arrays
-        vaporPressure_ = new Scalar[nTemp_];
-        minGasDensity__ = new Scalar[nTemp_];
-        maxGasDensity__ = new Scalar[nTemp_];
-        minLiquidDensity__ = new Scalar[nTemp_];
-        maxLiquidDensity__ = new Scalar[nTemp_];
-
-        gasEnthalpy_ = new Scalar[nTemp_*nPress_];
-        liquidEnthalpy_ = new Scalar[nTemp_*nPress_];
-        gasHeatCapacity_ = new Scalar[nTemp_*nPress_];
-        liquidHeatCapacity_ = new Scalar[nTemp_*nPress_];
-        gasDensity_ = new Scalar[nTemp_*nPress_];
-        liquidDensity_ = new Scalar[nTemp_*nPress_];
-        gasViscosity_ = new Scalar[nTemp_*nPress_];
-        liquidViscosity_ = new Scalar[nTemp_*nPress_];
-        gasThermalConductivity_ = new Scalar[nTemp_*nPress_];
-        liquidThermalConductivity_ = new Scalar[nTemp_*nPress_];
-        gasPressure_ = new Scalar[nTemp_*nDensity_];
-        liquidPressure_ = new Scalar[nTemp_*nDensity_];
-
-        assert(std::numeric_limits<Scalar>::has_quiet_NaN);
-        Scalar NaN = std::numeric_limits<Scalar>::quiet_NaN();
-
-        // fill the temperature-pressure arrays
-        for (unsigned iT = 0; iT < nTemp_; ++ iT) {
-            Scalar temperature = iT * (tempMax_ - tempMin_)/(nTemp_ - 1) + tempMin_;
+        releaseTables_();
+        allocateTemperatureArrays_();
 
-            try { vaporPressure_[iT] = RawComponent::vaporPressure(temperature); }
-            catch (std::exception) { vaporPressure_[iT] = NaN; }
+        initTables_(lazy);
+    }
 
-            Scalar pgMax = maxGasPressure_(iT);
-            Scalar pgMin = minGasPressure_(iT);
+    /*!
+     * \brief Initialize the tables in a background thread.
+     *
+     * The arguments are the same as the ones of init(). The object must not be used or
+     * destroyed before the returned future is ready, cf. Opm::AsyncInitializer.
+     */
+    std::future<void> initAsync(Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                                Scalar pressMin, Scalar pressMax, unsigned nPress,
+                                bool lazy = false,
+                                bool bicubic = false,
+                                unsigned properties = allPropertiesFlag)
+    {
+        return std::async(std::launch::async, [=]() {
+                init(tempMin, tempMax, nTemp, pressMin, pressMax, nPress, lazy, bicubic, properties);
+            });
+    }
 
-            // fill the temperature, pressure gas arrays
-            for (unsigned iP = 0; iP < nPress_; ++ iP) {
-                Scalar pressure = iP * (pgMax - pgMin)/(nPress_ - 1) + pgMin;
+    /*!
+     * \brief Initialize the tables using sampling temperatures which are chosen
+     *        automatically.
+     *
+     * Instead of sampling the temperature range uniformly, the sampling temperatures
+     * are determined by recursively bisecting it wherever linear interpolation between
+     * the neighboring sampling temperatures deviates from the raw component by more
+     * than the given relative tolerance. This concentrates the sampling temperatures
+     * where the quantities are strongly curved, e.g., where the vapor pressure and thus
+     * the pressure range of the rows changes quickly, while smooth regions only get a
+     * few of them. For the same accuracy, the tables are thus usually considerably
+     * smaller than uniform ones.
+     *
+     * The refinement is decided based on the vapor pressure and on the pressure
+     * dependent quantities of both phases, which are compared at several relative
+     * positions within the pressure range of each row. Within each row, the pressure
+     * sampling points are still equidistant, i.e., the lookup of the second degree of
+     * freedom needs no search. The interpolation is always bilinear and the resulting
+     * tables cannot be written to a file.
+     *
+     * \param tempMin The minimum of the temperature range in \f$\mathrm{[K]}\f$
+     * \param tempMax The maximum of the temperature range in \f$\mathrm{[K]}\f$
+     * \param pressMin The minimum of the pressure range in \f$\mathrm{[Pa]}\f$
+     * \param pressMax The maximum of the pressure range in \f$\mathrm{[Pa]}\f$
+     * \param nPress The number of entries/steps within the pressure range
+     * \param relTolerance The admissible relative error of the interpolation in the
+     *                     direction of temperature
+     * \param maxTemp The maximum number of sampling temperatures
+     * \param lazy If true, tabulate the properties on their first use
+     * \param properties The properties to be tabulated, cf. PropertyFlags. Only these
+     *                   are considered for the refinement.
+     */
+    void initAdaptive(Scalar tempMin, Scalar tempMax,
+                      Scalar pressMin, Scalar pressMax, unsigned nPress,
+                      Scalar relTolerance,
+                      unsigned maxTemp = 10000,
+                      bool lazy = false,
+                      unsigned properties = allPropertiesFlag)
+    {
+        OPM_PROFILER_RANGE(std::string("TabulatedComponent<") + RawComponent::name() + ">::initAdaptive");
 
-                unsigned i = iT + iP*nTemp_;
+        if (!(relTolerance > 0))
+            OPM_THROW(std::invalid_argument,
+                      "The tolerance of adaptive tables must be positive");
 
-                try { gasEnthalpy_[i] = RawComponent::gasEnthalpy(temperature, pressure); }
-                catch (std::exception) { gasEnthalpy_[i] = NaN; }
+        properties_ = properties & allPropertiesFlag;
+        bicubic_ = false;
+        tempMin_ = tempMin;
+        tempMax_ = tempMax;
+        pressMin_ = pressMin;
+        pressMax_ = pressMax;
+        nPress_ = nPress;
+        nDensity_ = nPress_;
 
-                try { gasHeatCapacity_[i] = RawComponent::gasHeatCapacity(temperature, pressure); }
-                catch (std::exception) { gasHeatCapacity_[i] = NaN; }
+        releaseTables_();
+
+        // determine the sampling temperatures. the temperature range is first split
+        // into a few uniform intervals so that no features are missed
+        const unsigned numInitialIntervals = 8;
+        Scalar minSpacing = (tempMax - tempMin)/std::max(maxTemp - 1, numInitialIntervals);
+        std::vector<Scalar> temperatures;
+        std::vector<Scalar> indicatorsLeft;
+        std::vector<Scalar> indicatorsRight;
+        refinementIndicators_(tempMin, indicatorsLeft);
+        for (unsigned intervalIdx = 0; intervalIdx < numInitialIntervals; ++intervalIdx) {
+            Scalar TLeft = tempMin + (tempMax - tempMin)*intervalIdx/numInitialIntervals;
+            Scalar TRight = tempMin + (tempMax - tempMin)*(intervalIdx + 1)/numInitialIntervals;
+            refinementIndicators_(TRight, indicatorsRight);
+
+            temperatures.push_back(TLeft);
+            refineTemperatures_(TLeft, TRight, indicatorsLeft, indicatorsRight,
+                                relTolerance, minSpacing, temperatures);
+
+            indicatorsLeft.swap(indicatorsRight);
+        }
+        temperatures.push_back(tempMax);
 
-                try { gasDensity_[i] = RawComponent::gasDensity(temperature, pressure); }
-                catch (std::exception) { gasDensity_[i] = NaN; }
+        nTemp_ = temperatures.size();
+        temperatures_ = new Scalar[nTemp_];
+        std::copy(temperatures.begin(), temperatures.end(), temperatures_);
 
-                try { gasViscosity_[i] = RawComponent::gasViscosity(temperature, pressure); }
-                catch (std::exception) { gasViscosity_[i] = NaN; }
+        allocateTemperatureArrays_();
 
-                try { gasThermalConductivity_[i] = RawComponent::gasThermalConductivity(temperature, pressure); }
-                catch (std::exception) { gasThermalConductivity_[i] = NaN; }
-            };
+        initTables_(lazy);
+    }
 
-            Scalar plMin = minLiquidPressure_(iT);
-            Scalar plMax = maxLiquidPressure_(iT);
-            for (unsigned iP = 0; iP < nPress_; ++ iP) {
-                Scalar pressure = iP * (plMax - plMin)/(nPress_ - 1) + plMin;
+    /*!
+     * \brief Returns the number of sampling temperatures of the tables.
+     */
+    unsigned numTemperatures() const
+    { return nTemp_; }
 
-                unsigned i = iT + iP*nTemp_;
+    /*!
+     * \brief Write the tables to a file.
+     *
+     * The file can be used by loadTables() to avoid re-calculating the tables. If the
+     * tables are initialized lazily, all of them are calculated before the file is
+     * written. Tables which were created by initAdaptive() cannot be written.
+     *
+     * \param fileName The name of the file
+     */
+    void saveTables(const std::string& fileName) const
+    {
+        if (temperatures_)
+            OPM_THROW(std::logic_error,
+                      "Adaptive tables cannot be written to a file");
+        if (properties_ != allPropertiesFlag)
+            OPM_THROW(std::logic_error,
+                      "Only tables which include all properties can be written to a file");
+
+        std::vector<const void*> arrays;
+        std::vector<size_t> sizes;
+
+        const Scalar* temperatureArrays[] = {
+            vaporPressure_, minGasDensity__, maxGasDensity__, minLiquidDensity__, maxLiquidDensity__
+        };
+        for (const Scalar* values : temperatureArrays) {
+            arrays.push_back(values);
+            sizes.push_back(nTemp_*sizeof(Scalar));
+        }
+        for (int tableIdx = 0; tableIdx < numTables; ++tableIdx) {
+            arrays.push_back(table_(static_cast<Table>(tableIdx)));
+            sizes.push_back(tableSize_()*sizeof(StorageScalar));
+        }
 
-                try { liquidEnthalpy_[i] = RawComponent::liquidEnthalpy(temperature, pressure); }
-                catch (std::exception) { liquidEnthalpy_[i] = NaN; }
+        TableFile::write(fileName, tableKey_(), arrays, sizes);
+    }
 
-                try { liquidHeatCapacity_[i] = RawComponent::liquidHeatCapacity(temperature, pressure); }
-                catch (std::exception) { liquidHeatCapacity_[i] = NaN; }
+    /*!
+     * \brief Initialize the tables using a file which was written by saveTables().
+     *
+     * The file is only used if it was written for the same raw component, temperature
+     * and pressure ranges and resolutions. If the file is mapped into memory, the
+     * two-dimensional tables are used in-place, so all processes on a machine which
+     * use the same file share a single physical copy of them.
+     *
+     * \param fileName The name of the file
+     * \param tempMin The minimum of the temperature range in \f$\mathrm{[K]}\f$
+     * \param tempMax The maximum of the temperature range in \f$\mathrm{[K]}\f$
+     * \param nTemp The number of entries/steps within the temperature range
+     * \param pressMin The minimum of the pressure range in \f$\mathrm{[Pa]}\f$
+     * \param pressMax The maximum of the pressure range in \f$\mathrm{[Pa]}\f$
+     * \param nPress The number of entries/steps within the pressure range
+     * \param map If true, the file is mapped into memory instead of being read
+     * \param bicubic If true, use bicubic Hermite instead of bilinear interpolation
+     *
+     * \return true if the tables were loaded. If false is returned, the object is left
+     *         uninitialized and init() must be called.
+     */
+    bool loadTables(const std::string& fileName,
+                    Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                    Scalar pressMin, Scalar pressMax, unsigned nPress,
+                    bool map = true,
+                    bool bicubic = false)
+    {
+        properties_ = allPropertiesFlag;
+        bicubic_ = bicubic;
+        tempMin_ = tempMin;
+        tempMax_ = tempMax;
+        nTemp_ = nTemp;
+        pressMin_ = pressMin;
+        pressMax_ = pressMax;
+        nPress_ = nPress;
+        nDensity_ = nPress_;
 
-                try { liquidDensity_[i] = RawComponent::liquidDensity(temperature, pressure); }
-                catch (std::exception) { liquidDensity_[i] = NaN; }
+        releaseTables_();
 
-                try { liquidViscosity_[i] = RawComponent::liquidViscosity(temperature, pressure); }
-                catch (std::exception) { liquidViscosity_[i] = NaN; }
+        if (!tableFile_.open(fileName, tableKey_(), map))
+            return false;
 
-                try { liquidThermalConductivity_[i] = RawComponent::liquidThermalConductivity(temperature, pressure); }
-                catch (std::exception) { liquidThermalConductivity_[i] = NaN; }
-            }
+        bool valid = (tableFile_.numArrays() == numTemperatureArrays + numTables);
+        for (unsigned arrayIdx = 0; valid && arrayIdx < tableFile_.numArrays(); ++arrayIdx) {
+            size_t expectedSize =
+                (arrayIdx < numTemperatureArrays)
+                ? nTemp_*sizeof(Scalar)
+                : tableSize_()*sizeof(StorageScalar);
+            valid = (tableFile_.arraySize(arrayIdx) == expectedSize);
+        }
+        if (!valid) {
+            tableFile_.close();
+            return false;
         }
 
-        // fill the temperature-density arrays
-        for (unsigned iT = 0; iT < nTemp_; ++ iT) {
-            Scalar temperature = iT * (tempMax_ - tempMin_)/(nTemp_ - 1) + tempMin_;
-
-            // calculate the minimum and maximum values for the gas
-            // densities
-            minGasDensity__[iT] = RawComponent::gasDensity(temperature, minGasPressure_(iT));
-            if (iT < nTemp_ - 1)
-                maxGasDensity__[iT] = RawComponent::gasDensity(temperature, maxGasPressure_(iT + 1));
-            else
-                maxGasDensity__[iT] = RawComponent::gasDensity(temperature, maxGasPressure_(iT));
-
-            // fill the temperature, density gas arrays
-            for (unsigned iRho = 0; iRho < nDensity_; ++ iRho) {
-                Scalar density =
-                    Scalar(iRho)/(nDensity_ - 1) *
-                    (maxGasDensity__[iT] - minGasDensity__[iT])
-                    +
-                    minGasDensity__[iT];
-
-                unsigned i = iT + iRho*nTemp_;
-
-                try { gasPressure_[i] = RawComponent::gasPressure(temperature, density); }
-                catch (std::exception) { gasPressure_[i] = NaN; };
-            };
-
-            // calculate the minimum and maximum values for the liquid
-            // densities
-            minLiquidDensity__[iT] = RawComponent::liquidDensity(temperature, minLiquidPressure_(iT));
-            if (iT < nTemp_ - 1)
-                maxLiquidDensity__[iT] = RawComponent::liquidDensity(temperature, maxLiquidPressure_(iT + 1));
-            else
-                maxLiquidDensity__[iT] = RawComponent::liquidDensity(temperature, maxLiquidPressure_(iT));
-
-            // fill the temperature, density liquid arrays
-            for (unsigned iRho = 0; iRho < nDensity_; ++ iRho) {
-                Scalar density =
-                    Scalar(iRho)/(nDensity_ - 1) *
-                    (maxLiquidDensity__[iT] - minLiquidDensity__[iT])
-                    +
-                    minLiquidDensity__[iT];
-
-                unsigned i = iT + iRho*nTemp_;
-
-                try { liquidPressure_[i] = RawComponent::liquidPressure(temperature, density); }
-                catch (std::exception) { liquidPressure_[i] = NaN; };
-            };
+        // the temperature dependent arrays are small, so they are copied
+        allocateTemperatureArrays_();
+        Scalar* temperatureArrays[] = {
+            vaporPressure_, minGasDensity__, maxGasDensity__, minLiquidDensity__, maxLiquidDensity__
+        };
+        for (unsigned arrayIdx = 0; arrayIdx < numTemperatureArrays; ++arrayIdx)
+            std::memcpy(temperatureArrays[arrayIdx], tableFile_.array(arrayIdx), nTemp_*sizeof(Scalar));
+
+        for (int tableIdx = 0; tableIdx < numTables; ++tableIdx) {
+            const StorageScalar* values =
+                static_cast<const StorageScalar*>(tableFile_.array(numTemperatureArrays + tableIdx));
+            tables_[tableIdx].store(values, std::memory_order_release);
         }
+        tablesInFile_ = true;
+
+        return true;
     }
 
     /*!
@@ -253,12 +477,12 @@ public:
      * \param T temperature of component
      */
     template <class Evaluation>
-    static Evaluation vaporPressure(const Evaluation& temperature)
+    Evaluation vaporPressure(const Evaluation& temperature) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& result = interpolateT_(vaporPressure_, temperature);
-        if (std::isnan(Toolbox::value(result)))
+        if (isTableMiss_<vaporPressureQuantity_>(Toolbox::value(result)))
             return RawComponent::vaporPressure(temperature);
         return result;
     }
@@ -270,14 +494,14 @@ public:
      * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
      */
     template <class Evaluation>
-    static Evaluation gasEnthalpy(const Evaluation& temperature, const Evaluation& pressure)
+    Evaluation gasEnthalpy(const Evaluation& temperature, const Evaluation& pressure) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& result = interpolateGasTP_(gasEnthalpy_,
+        const Evaluation& result = interpolateGasTP_(table_(gasEnthalpyTable),
                                                      temperature,
                                                      pressure);
-        if (std::isnan(Toolbox::value(result)))
+        if (isTableMiss_<gasEnthalpyTable>(Toolbox::value(result)))
             return RawComponent::gasEnthalpy(temperature, pressure);
         return result;
     }
@@ -289,14 +513,14 @@ public:
      * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
      */
     template <class Evaluation>
-    static Evaluation liquidEnthalpy(const Evaluation& temperature, const Evaluation& pressure)
+    Evaluation liquidEnthalpy(const Evaluation& temperature, const Evaluation& pressure) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& result = interpolateLiquidTP_(liquidEnthalpy_,
+        const Evaluation& result = interpolateLiquidTP_(table_(liquidEnthalpyTable),
                                                         temperature,
                                                         pressure);
-        if (std::isnan(Toolbox::value(result)))
+        if (isTableMiss_<liquidEnthalpyTable>(Toolbox::value(result)))
             return RawComponent::liquidEnthalpy(temperature, pressure);
         return result;
     }
@@ -308,14 +532,14 @@ public:
      * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
      */
     template <class Evaluation>
-    static Evaluation gasHeatCapacity(const Evaluation& temperature, const Evaluation& pressure)
+    Evaluation gasHeatCapacity(const Evaluation& temperature, const Evaluation& pressure) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& result = interpolateGasTP_(gasHeatCapacity_,
+        const Evaluation& result = interpolateGasTP_(table_(gasHeatCapacityTable),
                                                      temperature,
                                                      pressure);
-        if (std::isnan(Toolbox::value(result)))
+        if (isTableMiss_<gasHeatCapacityTable>(Toolbox::value(result)))
             return RawComponent::gasHeatCapacity(temperature, pressure);
         return result;
     }
@@ -327,14 +551,14 @@ public:
      * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
      */
     template <class Evaluation>
-    static Evaluation liquidHeatCapacity(const Evaluation& temperature, const Evaluation& pressure)
+    Evaluation liquidHeatCapacity(const Evaluation& temperature, const Evaluation& pressure) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& result = interpolateLiquidTP_(liquidHeatCapacity_,
+        const Evaluation& result = interpolateLiquidTP_(table_(liquidHeatCapacityTable),
                                                         temperature,
                                                         pressure);
-        if (std::isnan(Toolbox::value(result)))
+        if (isTableMiss_<liquidHeatCapacityTable>(Toolbox::value(result)))
             return RawComponent::liquidHeatCapacity(temperature, pressure);
         return result;
     }
@@ -346,7 +570,7 @@ public:
      * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
      */
     template <class Evaluation>
-    static Evaluation gasInternalEnergy(const Evaluation& temperature, const Evaluation& pressure)
+    Evaluation gasInternalEnergy(const Evaluation& temperature, const Evaluation& pressure) const
     { return gasEnthalpy(temperature, pressure) - pressure/gasDensity(temperature, pressure); }
 
     /*!
@@ -356,7 +580,7 @@ public:
      * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
      */
     template <class Evaluation>
-    static Evaluation liquidInternalEnergy(const Evaluation& temperature, const Evaluation& pressure)
+    Evaluation liquidInternalEnergy(const Evaluation& temperature, const Evaluation& pressure) const
     { return liquidEnthalpy(temperature, pressure) - pressure/liquidDensity(temperature, pressure); }
 
     /*!
@@ -366,14 +590,14 @@ public:
      * \param density density of component in \f$\mathrm{[kg/m^3]}\f$
      */
     template <class Evaluation>
-    static Evaluation gasPressure(const Evaluation& temperature, Scalar density)
+    Evaluation gasPressure(const Evaluation& temperature, Scalar density) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& result = interpolateGasTRho_(gasPressure_,
+        const Evaluation& result = interpolateGasTRho_(table_(gasPressureTable),
                                                        temperature,
                                                        density);
-        if (std::isnan(Toolbox::value(result)))
+        if (isTableMiss_<gasPressureTable>(Toolbox::value(result)))
             return RawComponent::gasPressure(temperature,
                                              density);
         return result;
@@ -386,14 +610,14 @@ public:
      * \param density density of component in \f$\mathrm{[kg/m^3]}\f$
      */
     template <class Evaluation>
-    static Evaluation liquidPressure(const Evaluation& temperature, Scalar density)
+    Evaluation liquidPressure(const Evaluation& temperature, Scalar density) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& result = interpolateLiquidTRho_(liquidPressure_,
+        const Evaluation& result = interpolateLiquidTRho_(table_(liquidPressureTable),
                                                           temperature,
                                                           density);
-        if (std::isnan(Toolbox::value(result)))
+        if (isTableMiss_<liquidPressureTable>(Toolbox::value(result)))
             return RawComponent::liquidPressure(temperature,
                                                 density);
         return result;
@@ -417,6 +641,20 @@ public:
     static bool gasIsIdeal()
     { return RawComponent::gasIsIdeal(); }
 
+    /*!
+     * \copydoc Component::isValidGasState
+     */
+    template <class Evaluation>
+    static bool isValidGasState(const Evaluation& temperature, const Evaluation& pressure)
+    { return RawComponent::isValidGasState(temperature, pressure); }
+
+    /*!
+     * \copydoc Component::isValidLiquidState
+     */
+    template <class Evaluation>
+    static bool isValidLiquidState(const Evaluation& temperature, const Evaluation& pressure)
+    { return RawComponent::isValidLiquidState(temperature, pressure); }
+
 
     /*!
      * \brief The density of gas at a given pressure and temperature
@@ -426,14 +664,14 @@ public:
      * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
      */
     template <class Evaluation>
-    static Evaluation gasDensity(const Evaluation& temperature, const Evaluation& pressure)
+    Evaluation gasDensity(const Evaluation& temperature, const Evaluation& pressure) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& result = interpolateGasTP_(gasDensity_,
+        const Evaluation& result = interpolateGasTP_(table_(gasDensityTable),
                                                      temperature,
                                                      pressure);
-        if (std::isnan(Toolbox::value(result)))
+        if (isTableMiss_<gasDensityTable>(Toolbox::value(result)))
             return RawComponent::gasDensity(temperature, pressure);
         return result;
     }
@@ -446,14 +684,14 @@ public:
      * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
      */
     template <class Evaluation>
-    static Evaluation liquidDensity(const Evaluation& temperature, const Evaluation& pressure)
+    Evaluation liquidDensity(const Evaluation& temperature, const Evaluation& pressure) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& result = interpolateLiquidTP_(liquidDensity_,
+        const Evaluation& result = interpolateLiquidTP_(table_(liquidDensityTable),
                                                         temperature,
                                                         pressure);
-        if (std::isnan(Toolbox::value(result)))
+        if (isTableMiss_<liquidDensityTable>(Toolbox::value(result)))
             return RawComponent::liquidDensity(temperature, pressure);
         return result;
     }
@@ -465,14 +703,14 @@ public:
      * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
      */
     template <class Evaluation>
-    static Evaluation gasViscosity(const Evaluation& temperature, const Evaluation& pressure)
+    Evaluation gasViscosity(const Evaluation& temperature, const Evaluation& pressure) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& result = interpolateGasTP_(gasViscosity_,
+        const Evaluation& result = interpolateGasTP_(table_(gasViscosityTable),
                                                      temperature,
                                                      pressure);
-        if (std::isnan(Toolbox::value(result)))
+        if (isTableMiss_<gasViscosityTable>(Toolbox::value(result)))
             return RawComponent::gasViscosity(temperature, pressure);
         return result;
     }
@@ -484,14 +722,14 @@ public:
      * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
      */
     template <class Evaluation>
-    static Evaluation liquidViscosity(const Evaluation& temperature, const Evaluation& pressure)
+    Evaluation liquidViscosity(const Evaluation& temperature, const Evaluation& pressure) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& result = interpolateLiquidTP_(liquidViscosity_,
+        const Evaluation& result = interpolateLiquidTP_(table_(liquidViscosityTable),
                                                         temperature,
                                                         pressure);
-        if (std::isnan(Toolbox::value(result)))
+        if (isTableMiss_<liquidViscosityTable>(Toolbox::value(result)))
             return RawComponent::liquidViscosity(temperature, pressure);
         return result;
     }
@@ -503,14 +741,14 @@ public:
      * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
      */
     template <class Evaluation>
-    static Evaluation gasThermalConductivity(const Evaluation& temperature, const Evaluation& pressure)
+    Evaluation gasThermalConductivity(const Evaluation& temperature, const Evaluation& pressure) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& result = interpolateGasTP_(gasThermalConductivity_,
+        const Evaluation& result = interpolateGasTP_(table_(gasThermalConductivityTable),
                                                      temperature,
                                                      pressure);
-        if (std::isnan(Toolbox::value(result)))
+        if (isTableMiss_<gasThermalConductivityTable>(Toolbox::value(result)))
             return RawComponent::gasThermalConductivity(temperature, pressure);
         return result;
     }
@@ -522,22 +760,697 @@ public:
      * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
      */
     template <class Evaluation>
-    static Evaluation liquidThermalConductivity(const Evaluation& temperature, const Evaluation& pressure)
+    Evaluation liquidThermalConductivity(const Evaluation& temperature, const Evaluation& pressure) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& result = interpolateLiquidTP_(liquidThermalConductivity_,
+        const Evaluation& result = interpolateLiquidTP_(table_(liquidThermalConductivityTable),
                                                         temperature,
                                                         pressure);
-        if (std::isnan(Toolbox::value(result)))
+        if (isTableMiss_<liquidThermalConductivityTable>(Toolbox::value(result)))
             return RawComponent::liquidThermalConductivity(temperature, pressure);
         return result;
     }
 
+    /*!
+     * \brief The density, enthalpy, heat capacity, viscosity and thermal conductivity
+     *        of the liquid at a given temperature and pressure.
+     *
+     * The tables of a phase share their sampling points, so the cell which contains the
+     * state and the interpolation weights are only determined once for all quantities.
+     * Where no tabulated value is available, the raw component is used like by the
+     * individual methods. Quantities which were not selected when the tables were
+     * initialized are NaN.
+     *
+     * \param temperature temperature of component in \f$\mathrm{[K]}\f$
+     * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
+     */
+    template <class Evaluation>
+    ComponentPhaseProperties<Evaluation> liquidProperties(const Evaluation& temperature,
+                                                          const Evaluation& pressure) const
+    { return lookupPhaseProperties_(temperature, pressure, /*liquid=*/true); }
+
+    /*!
+     * \brief The density, enthalpy, heat capacity, viscosity and thermal conductivity
+     *        of the gas at a given temperature and pressure.
+     *
+     * \copydetails liquidProperties()
+     */
+    template <class Evaluation>
+    ComponentPhaseProperties<Evaluation> gasProperties(const Evaluation& temperature,
+                                                       const Evaluation& pressure) const
+    { return lookupPhaseProperties_(temperature, pressure, /*liquid=*/false); }
+
 private:
+    // the two-dimensional property tables
+    enum Table {
+        // temperature and pressure as degrees of freedom
+        gasEnthalpyTable,
+        liquidEnthalpyTable,
+        gasHeatCapacityTable,
+        liquidHeatCapacityTable,
+        gasDensityTable,
+        liquidDensityTable,
+        gasViscosityTable,
+        liquidViscosityTable,
+        gasThermalConductivityTable,
+        liquidThermalConductivityTable,
+
+        // temperature and density as degrees of freedom
+        gasPressureTable,
+        liquidPressureTable,
+
+        numTables
+    };
+
+    static_assert(allPropertiesFlag == (1 << numTables) - 1,
+                  "The property flags must correspond to the tables");
+
+    // the quantity index of the vapor pressure for the lookup statistics. all other
+    // quantities are identified by their table.
+    enum { vaporPressureQuantity_ = numTables };
+
+    // the number of temperature dependent arrays (vapor pressure and density ranges)
+    enum { numTemperatureArrays = 5 };
+
+    // free the tables of a previous initialization
+    void releaseTables_()
+    {
+        delete[] vaporPressure_;
+        delete[] minGasDensity__;
+        delete[] maxGasDensity__;
+        delete[] minLiquidDensity__;
+        delete[] maxLiquidDensity__;
+        vaporPressure_ = minGasDensity__ = maxGasDensity__ = minLiquidDensity__ = maxLiquidDensity__ = 0;
+        delete[] temperatures_;
+        temperatures_ = 0;
+
+        for (int tableIdx = 0; tableIdx < numTables; ++tableIdx) {
+            const StorageScalar* values = tables_[tableIdx].exchange(nullptr);
+            if (!tablesInFile_)
+                HugePages::deallocate(const_cast<StorageScalar*>(values));
+        }
+
+        tableFile_.close();
+        tablesInFile_ = false;
+    }
+
+    // allocate the memory of a two-dimensional table. these are large and accessed at
+    // random positions, so they are placed on huge pages if this is enabled.
+    StorageScalar* allocateTable_() const
+    { return HugePageAllocator<StorageScalar>().allocate(tableSize_()); }
+
+    // allocate the arrays which only depend on temperature
+    void allocateTemperatureArrays_()
+    {
+        vaporPressure_ = new Scalar[nTemp_];
+        minGasDensity__ = new Scalar[nTemp_];
+        maxGasDensity__ = new Scalar[nTemp_];
+        minLiquidDensity__ = new Scalar[nTemp_];
+        maxLiquidDensity__ = new Scalar[nTemp_];
+    }
+
+    // calculate the temperature dependent arrays and, unless the tables are
+    // initialized lazily, all property tables. the resolution of the tables must
+    // already be set and the temperature dependent arrays must be allocated.
+    void initTables_(bool lazy)
+    {
+        assert(std::numeric_limits<Scalar>::has_quiet_NaN);
+        Scalar NaN = std::numeric_limits<Scalar>::quiet_NaN();
+
+        // fill the vapor pressure array. this needs to be complete before the density
+        // ranges can be calculated because the latter depend on the pressure range of
+        // the next temperature
+        forEachTemperature_([&](unsigned iT) {
+                Scalar temperature = temperatureAt_(iT);
+                try { vaporPressure_[iT] = RawComponent::vaporPressure(temperature); }
+                catch (std::exception) { vaporPressure_[iT] = NaN; }
+            });
+
+        // calculate the minimum and maximum values for the gas and liquid densities.
+        // these are only required for the tables which use density as the second
+        // degree of freedom.
+        bool needDensityRanges = properties_ & (gasPressureFlag | liquidPressureFlag);
+        forEachTemperature_([&](unsigned iT) {
+                if (!needDensityRanges) {
+                    minGasDensity__[iT] = maxGasDensity__[iT] = NaN;
+                    minLiquidDensity__[iT] = maxLiquidDensity__[iT] = NaN;
+                    return;
+                }
+
+                Scalar temperature = temperatureAt_(iT);
+                unsigned iTNext = std::min(iT + 1, nTemp_ - 1);
+
+                // the densities are NaN where the raw component cannot calculate them.
+                // the rows of the pressure tables are then not evaluated at all.
+                minGasDensity__[iT] = rawValue_(gasDensityTable, temperature, minGasPressure_(iT));
+                maxGasDensity__[iT] = rawValue_(gasDensityTable, temperature, maxGasPressure_(iTNext));
+
+                minLiquidDensity__[iT] = rawValue_(liquidDensityTable, temperature, minLiquidPressure_(iT));
+                maxLiquidDensity__[iT] = rawValue_(liquidDensityTable, temperature, maxLiquidPressure_(iTNext));
+            });
+
+        if (lazy)
+            return;
+
+        // fill all requested two-dimensional tables at once
+        StorageScalar* values[numTables];
+        for (int tableIdx = 0; tableIdx < numTables; ++tableIdx)
+            values[tableIdx] = isTabulated_(static_cast<Table>(tableIdx)) ? allocateTable_() : nullptr;
+
+        forEachTemperature_([&](unsigned iT) {
+                fillTableRows_(values, iT,
+                               std::integral_constant<bool, RawComponent::hasPhaseProperties>());
+            });
+
+        for (int tableIdx = 0; tableIdx < numTables; ++tableIdx)
+            tables_[tableIdx].store(values[tableIdx], std::memory_order_release);
+    }
+
+    // returns true if a property table was requested when the tables were initialized
+    bool isTabulated_(Table tableIdx) const
+    { return properties_ & (1 << tableIdx); }
+
+    // the relative positions within the pressure range of a row at which the
+    // quantities are compared to decide about refining the temperatures of adaptive
+    // tables
+    enum { numRefinementPositions_ = 5 };
+
+    // calculate the quantities which decide about the refinement of adaptive tables at
+    // a given temperature: the vapor pressure and the pressure dependent quantities of
+    // both phases at several relative positions within the pressure range of each
+    // phase. quantities which are not available are NaN.
+    void refinementIndicators_(Scalar temperature, std::vector<Scalar>& result) const
+    {
+        result.clear();
+
+        Scalar vaporPressure = std::numeric_limits<Scalar>::quiet_NaN();
+        try { vaporPressure = RawComponent::vaporPressure(temperature); }
+        catch (const std::exception&) { }
+        result.push_back(vaporPressure);
+
+        for (unsigned posIdx = 0; posIdx < numRefinementPositions_; ++posIdx) {
+            Scalar alpha = Scalar(posIdx)/(numRefinementPositions_ - 1);
+            pressureDependentValues_(temperature, vaporPressure, alpha, result);
+        }
+    }
+
+    // append the values of all property tables which use pressure as their second
+    // degree of freedom at a given relative position within the pressure range of
+    // each phase
+    void pressureDependentValues_(Scalar temperature,
+                                  Scalar vaporPressure,
+                                  Scalar alpha,
+                                  std::vector<Scalar>& result) const
+    {
+        Scalar plMin = minLiquidPressureFor_(vaporPressure);
+        Scalar plMax = maxLiquidPressureFor_(vaporPressure);
+        Scalar pgMin = minGasPressureFor_(vaporPressure);
+        Scalar pgMax = maxGasPressureFor_(vaporPressure);
+        Scalar pl = plMin + alpha*(plMax - plMin);
+        Scalar pg = pgMin + alpha*(pgMax - pgMin);
+
+        for (int tableIdx = 0; tableIdx < gasPressureTable; ++tableIdx) {
+            Table table = static_cast<Table>(tableIdx);
+            if (!isTabulated_(table))
+                continue;
+
+            bool isGasTable =
+                table == gasEnthalpyTable
+                || table == gasHeatCapacityTable
+                || table == gasDensityTable
+                || table == gasViscosityTable
+                || table == gasThermalConductivityTable;
+            result.push_back(rawValue_(table, temperature, isGasTable ? pg : pl));
+        }
+    }
+
+    // returns true if linearly interpolating between two sets of refinement
+    // indicators reproduces the ones at the midpoint within a relative tolerance
+    static bool interpolationAccurate_(const std::vector<Scalar>& left,
+                                       const std::vector<Scalar>& mid,
+                                       const std::vector<Scalar>& right,
+                                       Scalar relTolerance)
+    {
+        for (size_t i = 0; i < mid.size(); ++i) {
+            // quantities which are not available everywhere are not considered
+            if (!std::isfinite(left[i]) || !std::isfinite(mid[i]) || !std::isfinite(right[i]))
+                continue;
+
+            Scalar interpolated = (left[i] + right[i])/2;
+            if (std::abs(interpolated - mid[i]) > relTolerance*std::abs(mid[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    // recursively bisect a temperature interval until the linear interpolation
+    // between its ends is accurate enough or it has become too narrow. the interior
+    // temperatures are appended in ascending order.
+    void refineTemperatures_(Scalar TLeft,
+                             Scalar TRight,
+                             const std::vector<Scalar>& indicatorsLeft,
+                             const std::vector<Scalar>& indicatorsRight,
+                             Scalar relTolerance,
+                             Scalar minSpacing,
+                             std::vector<Scalar>& temperatures) const
+    {
+        Scalar TMid = (TLeft + TRight)/2;
+        if (TMid - TLeft < minSpacing)
+            return;
+
+        std::vector<Scalar> indicatorsMid;
+        refinementIndicators_(TMid, indicatorsMid);
+        if (interpolationAccurate_(indicatorsLeft, indicatorsMid, indicatorsRight, relTolerance))
+            return;
+
+        refineTemperatures_(TLeft, TMid, indicatorsLeft, indicatorsMid,
+                            relTolerance, minSpacing, temperatures);
+        temperatures.push_back(TMid);
+        refineTemperatures_(TMid, TRight, indicatorsMid, indicatorsRight,
+                            relTolerance, minSpacing, temperatures);
+    }
+
+    // returns the string which identifies the tables in a file
+    std::string tableKey_() const
+    {
+        std::ostringstream oss;
+        oss.precision(std::numeric_limits<Scalar>::digits10 + 3);
+        oss << "TabulatedComponent<" << RawComponent::name() << ">"
+            << " sizeof(Scalar)=" << sizeof(Scalar)
+            << " sizeof(StorageScalar)=" << sizeof(StorageScalar)
+            << " useVaporPressure=" << useVaporPressure
+            << " bicubic=" << bicubic_
+            << " T=[" << tempMin_ << ", " << tempMax_ << "]/" << nTemp_
+            << " p=[" << pressMin_ << ", " << pressMax_ << "]/" << nPress_;
+        return oss.str();
+    }
+
+    // returns true if no tabulated value is available, i.e., if the raw component
+    // must be used. if instrumentation is enabled, the hits and misses are counted
+    // for each quantity of each component.
+    template <int quantityIdx>
+    static bool isTableMiss_(Scalar value)
+    {
+        if (std::isnan(value)) {
+            OPM_INSTRUMENT_EVENT(statisticsName_(quantityIdx) + " raw fallback");
+            return true;
+        }
+
+        OPM_INSTRUMENT_EVENT(statisticsName_(quantityIdx) + " table hit");
+        return false;
+    }
+
+    static std::string statisticsName_(int quantityIdx)
+    {
+        static const char* quantityNames[numTables + 1] = {
+            "gasEnthalpy",
+            "liquidEnthalpy",
+            "gasHeatCapacity",
+            "liquidHeatCapacity",
+            "gasDensity",
+            "liquidDensity",
+            "gasViscosity",
+            "liquidViscosity",
+            "gasThermalConductivity",
+            "liquidThermalConductivity",
+            "gasPressure",
+            "liquidPressure",
+            "vaporPressure"
+        };
+
+        return std::string("TabulatedComponent<") + RawComponent::name() + ">::"
+            + quantityNames[quantityIdx];
+    }
+
+    // returns the values of a property table. if it has not been calculated yet, this
+    // is done now.
+    const StorageScalar* table_(Table tableIdx) const
+    {
+        const StorageScalar* values = tables_[tableIdx].load(std::memory_order_acquire);
+        if (values)
+            return values;
+
+        if (!isTabulated_(tableIdx))
+            OPM_THROW(std::logic_error,
+                      statisticsName_(tableIdx) << " has not been tabulated. It must be "
+                      "selected by the properties argument of init().");
+
+        return buildTable_(tableIdx);
+    }
+
+    // calculate a property table and publish it. if another thread was faster, its
+    // values are used and ours are thrown away.
+    const StorageScalar* buildTable_(Table tableIdx) const
+    {
+        StorageScalar* values = allocateTable_();
+        try {
+            forEachTemperature_([&](unsigned iT) {
+                    fillTableRow_(tableIdx, values, iT);
+                });
+        }
+        catch (...) {
+            HugePages::deallocate(values);
+            throw;
+        }
+
+        const StorageScalar* expected = nullptr;
+        if (!tables_[tableIdx].compare_exchange_strong(expected, values,
+                                                       std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {
+            HugePages::deallocate(values);
+            return expected;
+        }
+
+        return values;
+    }
+
+    // returns the number of entries of a two-dimensional table. if bicubic
+    // interpolation is used, the tables also contain the partial derivatives to
+    // temperature and to the second degree of freedom as well as the mixed derivative.
+    size_t tableSize_() const
+    { return (bicubic_ ? 4 : 1)*nTemp_*nPress_; }
+
+    // calculate the range of the second degree of freedom of a property table for a
+    // given temperature index
+    void tableRange_(Table tableIdx, unsigned iT, Scalar& xMin, Scalar& xMax) const
+    {
+        switch (tableIdx) {
+        case gasPressureTable:
+            xMin = minGasDensity__[iT];
+            xMax = maxGasDensity__[iT];
+            break;
+        case liquidPressureTable:
+            xMin = minLiquidDensity__[iT];
+            xMax = maxLiquidDensity__[iT];
+            break;
+        case gasEnthalpyTable:
+        case gasHeatCapacityTable:
+        case gasDensityTable:
+        case gasViscosityTable:
+        case gasThermalConductivityTable:
+            xMin = minGasPressure_(iT);
+            xMax = maxGasPressure_(iT);
+            break;
+        default:
+            xMin = minLiquidPressure_(iT);
+            xMax = maxLiquidPressure_(iT);
+            break;
+        }
+    }
+
+    // evaluate the raw component for a property table. If this fails, NaN is returned.
+    static Scalar rawValue_(Table tableIdx, Scalar temperature, Scalar x)
+    {
+        bool implemented;
+        return rawValue_(tableIdx, temperature, x, implemented);
+    }
+
+    // evaluate the raw component for a property table. states for which the raw
+    // component reports that it cannot calculate the phase properties are skipped
+    // without evaluating it, since the exceptions which it would throw are very slow
+    // if there are many of them. If this fails, NaN is returned. if the raw component
+    // throws anything but a NumericalIssue, the failure does not depend on the state,
+    // e.g., because the property is not implemented, and 'implemented' is set to false.
+    static Scalar rawValue_(Table tableIdx, Scalar temperature, Scalar x, bool& implemented)
+    {
+        implemented = true;
+        if (!isValidState_(tableIdx, temperature, x))
+            return std::numeric_limits<Scalar>::quiet_NaN();
+
+        try {
+            switch (tableIdx) {
+            case gasEnthalpyTable: return RawComponent::gasEnthalpy(temperature, x);
+            case liquidEnthalpyTable: return RawComponent::liquidEnthalpy(temperature, x);
+            case gasHeatCapacityTable: return RawComponent::gasHeatCapacity(temperature, x);
+            case liquidHeatCapacityTable: return RawComponent::liquidHeatCapacity(temperature, x);
+            case gasDensityTable: return RawComponent::gasDensity(temperature, x);
+            case liquidDensityTable: return RawComponent::liquidDensity(temperature, x);
+            case gasViscosityTable: return RawComponent::gasViscosity(temperature, x);
+            case liquidViscosityTable: return RawComponent::liquidViscosity(temperature, x);
+            case gasThermalConductivityTable: return RawComponent::gasThermalConductivity(temperature, x);
+            case liquidThermalConductivityTable: return RawComponent::liquidThermalConductivity(temperature, x);
+            case gasPressureTable: return RawComponent::gasPressure(temperature, x);
+            case liquidPressureTable: return RawComponent::liquidPressure(temperature, x);
+            default: break;
+            }
+        }
+        catch (const NumericalIssue&) { }
+        catch (const std::exception&) { implemented = false; }
+
+        return std::numeric_limits<Scalar>::quiet_NaN();
+    }
+
+    // returns true if the raw component considers a state of a property table to be
+    // valid. for the tables which use density as their second degree of freedom, the
+    // pressure is not known in advance, so only the density range of the row is checked.
+    static bool isValidState_(Table tableIdx, Scalar temperature, Scalar x)
+    {
+        switch (tableIdx) {
+        case gasPressureTable:
+        case liquidPressureTable:
+            return std::isfinite(x);
+        case gasEnthalpyTable:
+        case gasHeatCapacityTable:
+        case gasDensityTable:
+        case gasViscosityTable:
+        case gasThermalConductivityTable:
+            return RawComponent::isValidGasState(temperature, x);
+        default:
+            return RawComponent::isValidLiquidState(temperature, x);
+        }
+    }
+
+    // calculate the values of a property table for a given temperature index
+    void fillTableRow_(Table tableIdx, StorageScalar* values, unsigned iT) const
+    {
+        Scalar temperature = temperatureAt_(iT);
+
+        // the range of the second degree of freedom
+        Scalar xMin, xMax;
+        tableRange_(tableIdx, iT, xMin, xMax);
+
+        // if the raw component does not implement the property, the remaining entries
+        // of the row are not evaluated
+        bool implemented = true;
+        for (unsigned iX = 0; iX < nPress_; ++ iX) {
+            Scalar x = Scalar(iX)/(nPress_ - 1) * (xMax - xMin) + xMin;
+            fillTableEntry_</*numValues=*/1>(&values, iT, iX, temperature, x, (xMax - xMin)/(nPress_ - 1),
+                                             [&](Scalar T, Scalar xx, Scalar* result) {
+                                                 result[0] =
+                                                     implemented
+                                                     ? rawValue_(tableIdx, T, xx, implemented)
+                                                     : std::numeric_limits<Scalar>::quiet_NaN();
+                                             });
+        }
+    }
+
+    // store the values of one or several property tables for a table entry. the
+    // functor calculates all of them at a given temperature and value of the second
+    // degree of freedom. For bicubic interpolation, it is additionally evaluated
+    // around the entry to approximate the partial derivatives by finite differences.
+    // these are stored in terms of the table indices.
+    template <int numValues, class Functor>
+    void fillTableEntry_(StorageScalar** values,
+                         unsigned iT,
+                         unsigned iX,
+                         Scalar temperature,
+                         Scalar x,
+                         Scalar dx,
+                         const Functor& functor) const
+    {
+        Scalar v[numValues];
+        functor(temperature, x, v);
+
+        size_t entryIdx = iT + iX*nTemp_;
+        for (int valueIdx = 0; valueIdx < numValues; ++valueIdx)
+            values[valueIdx][entryIdx] = static_cast<StorageScalar>(v[valueIdx]);
+
+        if (!bicubic_)
+            return;
+
+        // the step size of the finite differences relative to the table spacing
+        const Scalar h = 1e-3;
+        Scalar hT = h*(tempMax_ - tempMin_)/(nTemp_ - 1);
+        Scalar hX = h*dx;
+
+        Scalar vTPlus[numValues], vTMinus[numValues], vXPlus[numValues], vXMinus[numValues];
+        Scalar vPlusPlus[numValues], vPlusMinus[numValues], vMinusPlus[numValues], vMinusMinus[numValues];
+        functor(temperature + hT, x, vTPlus);
+        functor(temperature - hT, x, vTMinus);
+        functor(temperature, x + hX, vXPlus);
+        functor(temperature, x - hX, vXMinus);
+        functor(temperature + hT, x + hX, vPlusPlus);
+        functor(temperature + hT, x - hX, vPlusMinus);
+        functor(temperature - hT, x + hX, vMinusPlus);
+        functor(temperature - hT, x - hX, vMinusMinus);
+
+        size_t n = nTemp_*nPress_;
+        for (int valueIdx = 0; valueIdx < numValues; ++valueIdx) {
+            Scalar dv_dT = difference_(vTMinus[valueIdx], v[valueIdx], vTPlus[valueIdx], h);
+            Scalar dv_dX = difference_(vXMinus[valueIdx], v[valueIdx], vXPlus[valueIdx], h);
+            Scalar ddv_dTdX =
+                difference_(difference_(vMinusMinus[valueIdx], vTMinus[valueIdx], vMinusPlus[valueIdx], h),
+                            dv_dX,
+                            difference_(vPlusMinus[valueIdx], vTPlus[valueIdx], vPlusPlus[valueIdx], h),
+                            h);
+
+            values[valueIdx][n + entryIdx] = static_cast<StorageScalar>(dv_dT);
+            values[valueIdx][2*n + entryIdx] = static_cast<StorageScalar>(dv_dX);
+            values[valueIdx][3*n + entryIdx] = static_cast<StorageScalar>(ddv_dTdX);
+        }
+    }
+
+    // approximate a derivative by a central difference. if one of the outer values is
+    // not available, a one-sided difference is used
+    static Scalar difference_(Scalar vMinus, Scalar v, Scalar vPlus, Scalar h)
+    {
+        bool hasMinus = std::isfinite(vMinus);
+        bool hasPlus = std::isfinite(vPlus);
+        if (hasMinus && hasPlus)
+            return (vPlus - vMinus)/(2*h);
+        else if (hasPlus)
+            return (vPlus - v)/h;
+        else if (hasMinus)
+            return (v - vMinus)/h;
+        return std::numeric_limits<Scalar>::quiet_NaN();
+    }
+
+    // calculate the values of all property tables for a given temperature index
+    void fillTableRows_(StorageScalar** values, unsigned iT, std::false_type) const
+    {
+        for (int tableIdx = 0; tableIdx < numTables; ++tableIdx)
+            if (isTabulated_(static_cast<Table>(tableIdx)))
+                fillTableRow_(static_cast<Table>(tableIdx), values[tableIdx], iT);
+    }
+
+    // calculate the values of all property tables for a given temperature index if the
+    // raw component can compute the properties of a phase at once. this is only done if
+    // all pressure dependent tables of a phase are requested.
+    void fillTableRows_(StorageScalar** values, unsigned iT, std::true_type) const
+    {
+        const unsigned liquidFlags =
+            liquidDensityFlag | liquidEnthalpyFlag | liquidHeatCapacityFlag
+            | liquidViscosityFlag | liquidThermalConductivityFlag;
+        const unsigned gasFlags =
+            gasDensityFlag | gasEnthalpyFlag | gasHeatCapacityFlag
+            | gasViscosityFlag | gasThermalConductivityFlag;
+
+        for (int tableIdx = 0; tableIdx < numTables; ++tableIdx) {
+            unsigned flag = 1 << tableIdx;
+            bool phaseAtOnce =
+                ((flag & liquidFlags) && (properties_ & liquidFlags) == liquidFlags)
+                || ((flag & gasFlags) && (properties_ & gasFlags) == gasFlags);
+            if (isTabulated_(static_cast<Table>(tableIdx)) && !phaseAtOnce)
+                fillTableRow_(static_cast<Table>(tableIdx), values[tableIdx], iT);
+        }
+
+        if ((properties_ & liquidFlags) == liquidFlags)
+            fillPhaseTableRows_(values, iT, /*liquid=*/true);
+        if ((properties_ & gasFlags) == gasFlags)
+            fillPhaseTableRows_(values, iT, /*liquid=*/false);
+    }
+
+    // calculate the rows of all tables which use the pressure of a phase as second
+    // degree of freedom using the liquidProperties() or gasProperties() methods of
+    // the raw component
+    void fillPhaseTableRows_(StorageScalar** values, unsigned iT, bool liquid) const
+    {
+        Scalar temperature = temperatureAt_(iT);
+
+        Scalar xMin = liquid ? minLiquidPressure_(iT) : minGasPressure_(iT);
+        Scalar xMax = liquid ? maxLiquidPressure_(iT) : maxGasPressure_(iT);
+
+        // the order must be the same as the one of phaseProperties_()
+        StorageScalar* phaseValues[] = {
+            values[liquid ? liquidDensityTable : gasDensityTable],
+            values[liquid ? liquidEnthalpyTable : gasEnthalpyTable],
+            values[liquid ? liquidHeatCapacityTable : gasHeatCapacityTable],
+            values[liquid ? liquidViscosityTable : gasViscosityTable],
+            values[liquid ? liquidThermalConductivityTable : gasThermalConductivityTable]
+        };
+
+        for (unsigned iX = 0; iX < nPress_; ++ iX) {
+            Scalar x = Scalar(iX)/(nPress_ - 1) * (xMax - xMin) + xMin;
+            fillTableEntry_</*numValues=*/5>(phaseValues, iT, iX, temperature, x, (xMax - xMin)/(nPress_ - 1),
+                                             [&](Scalar T, Scalar xx, Scalar* result) {
+                                                 phaseProperties_(liquid, T, xx, result);
+                                             });
+        }
+    }
+
+    // calculate the density, enthalpy, heat capacity, viscosity and thermal
+    // conductivity of a phase using the raw component. If this fails or if the state
+    // is not valid for the raw component, all of them are set to NaN.
+    static void phaseProperties_(bool liquid, Scalar temperature, Scalar pressure, Scalar* result)
+    {
+        Scalar NaN = std::numeric_limits<Scalar>::quiet_NaN();
+        ComponentPhaseProperties<Scalar> props;
+        props.density = props.enthalpy = props.heatCapacity = props.viscosity =
+            props.thermalConductivity = NaN;
+
+        bool valid =
+            liquid
+            ? RawComponent::isValidLiquidState(temperature, pressure)
+            : RawComponent::isValidGasState(temperature, pressure);
+        if (valid) {
+            try {
+                if (liquid)
+                    props = RawComponent::liquidProperties(temperature, pressure);
+                else
+                    props = RawComponent::gasProperties(temperature, pressure);
+            }
+            catch (const std::exception&) {
+                props.density = props.enthalpy = props.heatCapacity = props.viscosity =
+                    props.thermalConductivity = NaN;
+            }
+        }
+
+        result[0] = props.density;
+        result[1] = props.enthalpy;
+        result[2] = props.heatCapacity;
+        result[3] = props.viscosity;
+        result[4] = props.thermalConductivity;
+    }
+
+    // call a functor for each temperature index. If OpenMP is enabled, this is done in
+    // parallel and the first exception which is thrown by the functor is re-thrown
+    // after all threads are done.
+    template <class Functor>
+    void forEachTemperature_(const Functor& functor) const
+    {
+#ifdef _OPENMP
+        std::exception_ptr exception;
+        #pragma omp parallel for schedule(dynamic)
+        for (int iT = 0; iT < static_cast<int>(nTemp_); ++ iT) {
+            try { functor(static_cast<unsigned>(iT)); }
+            catch (...) {
+                #pragma omp critical (OpmTabulatedComponentException)
+                if (!exception)
+                    exception = std::current_exception();
+            }
+        }
+
+        if (exception)
+            std::rethrow_exception(exception);
+#else
+        for (unsigned iT = 0; iT < nTemp_; ++ iT)
+            functor(iT);
+#endif
+    }
+
+    // returns the temperature for a given temperature index
+    Scalar temperatureAt_(unsigned iT) const
+    {
+        if (temperatures_)
+            return temperatures_[iT];
+        return iT * (tempMax_ - tempMin_)/(nTemp_ - 1) + tempMin_;
+    }
+
     // returns an interpolated value depending on temperature
     template <class Evaluation>
-    static Evaluation interpolateT_(const Scalar *values, const Evaluation& T)
+    Evaluation interpolateT_(const Scalar *values, const Evaluation& T) const
     {
         typedef Opm::MathToolbox<Evaluation> Toolbox;
 
@@ -556,7 +1469,7 @@ private:
     // returns an interpolated value for liquid depending on
     // temperature and pressure
     template <class Evaluation>
-    static Evaluation interpolateLiquidTP_(const Scalar *values, const Evaluation& T, const Evaluation& p)
+    Evaluation interpolateLiquidTP_(const StorageScalar *values, const Evaluation& T, const Evaluation& p) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
@@ -565,6 +1478,11 @@ private:
             return Toolbox::createConstant(std::numeric_limits<Scalar>::quiet_NaN());
         }
 
+        if (bicubic_)
+            return interpolateHermite_(values, alphaT, p,
+                                       [this](const Evaluation& x, unsigned tempIdx)
+                                       { return pressLiquidIdx_(x, tempIdx); });
+
         unsigned iT = std::max<int>(0, std::min<int>(nTemp_ - 2, Toolbox::value(alphaT)));
         alphaT -= iT;
 
@@ -589,16 +1507,16 @@ private:
 #endif
 
         return
-            values[(iT    ) + (iP1    )*nTemp_]*(1 - alphaT)*(1 - alphaP1) +
-            values[(iT    ) + (iP1 + 1)*nTemp_]*(1 - alphaT)*(    alphaP1) +
-            values[(iT + 1) + (iP2    )*nTemp_]*(    alphaT)*(1 - alphaP2) +
-            values[(iT + 1) + (iP2 + 1)*nTemp_]*(    alphaT)*(    alphaP2);
+            Scalar(values[(iT    ) + (iP1    )*nTemp_])*(1 - alphaT)*(1 - alphaP1) +
+            Scalar(values[(iT    ) + (iP1 + 1)*nTemp_])*(1 - alphaT)*(    alphaP1) +
+            Scalar(values[(iT + 1) + (iP2    )*nTemp_])*(    alphaT)*(1 - alphaP2) +
+            Scalar(values[(iT + 1) + (iP2 + 1)*nTemp_])*(    alphaT)*(    alphaP2);
     }
 
     // returns an interpolated value for gas depending on
     // temperature and pressure
     template <class Evaluation>
-    static Evaluation interpolateGasTP_(const Scalar *values, const Evaluation& T, const Evaluation& p)
+    Evaluation interpolateGasTP_(const StorageScalar *values, const Evaluation& T, const Evaluation& p) const
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
@@ -607,6 +1525,11 @@ private:
             return Toolbox::createConstant(std::numeric_limits<Scalar>::quiet_NaN());
         }
 
+        if (bicubic_)
+            return interpolateHermite_(values, alphaT, p,
+                                       [this](const Evaluation& x, unsigned tempIdx)
+                                       { return pressGasIdx_(x, tempIdx); });
+
         unsigned iT = std::max<int>(0, std::min<int>(nTemp_ - 2, Toolbox::value(alphaT)));
         alphaT -= iT;
 
@@ -630,18 +1553,129 @@ private:
 #endif
 
         return
-            values[(iT    ) + (iP1    )*nTemp_]*(1 - alphaT)*(1 - alphaP1) +
-            values[(iT    ) + (iP1 + 1)*nTemp_]*(1 - alphaT)*(    alphaP1) +
-            values[(iT + 1) + (iP2    )*nTemp_]*(    alphaT)*(1 - alphaP2) +
-            values[(iT + 1) + (iP2 + 1)*nTemp_]*(    alphaT)*(    alphaP2);
+            Scalar(values[(iT    ) + (iP1    )*nTemp_])*(1 - alphaT)*(1 - alphaP1) +
+            Scalar(values[(iT    ) + (iP1 + 1)*nTemp_])*(1 - alphaT)*(    alphaP1) +
+            Scalar(values[(iT + 1) + (iP2    )*nTemp_])*(    alphaT)*(1 - alphaP2) +
+            Scalar(values[(iT + 1) + (iP2 + 1)*nTemp_])*(    alphaT)*(    alphaP2);
+    }
+
+    // the tables of the pressure dependent quantities of the gas phase, in the order of
+    // the attributes of ComponentPhaseProperties. the table of the liquid phase always
+    // follows the one of the gas phase.
+    enum { numPhaseTables_ = 5 };
+    static Table phaseTable_(unsigned quantityIdx, bool liquid)
+    {
+        static const Table gasTables[numPhaseTables_] = {
+            gasDensityTable,
+            gasEnthalpyTable,
+            gasHeatCapacityTable,
+            gasViscosityTable,
+            gasThermalConductivityTable
+        };
+
+        return static_cast<Table>(gasTables[quantityIdx] + (liquid ? 1 : 0));
+    }
+
+    // evaluate a pressure dependent quantity using the method which looks it up
+    // individually
+    template <class Evaluation>
+    Evaluation phaseQuantity_(Table tableIdx, const Evaluation& T, const Evaluation& p) const
+    {
+        switch (tableIdx) {
+        case gasEnthalpyTable: return gasEnthalpy(T, p);
+        case liquidEnthalpyTable: return liquidEnthalpy(T, p);
+        case gasHeatCapacityTable: return gasHeatCapacity(T, p);
+        case liquidHeatCapacityTable: return liquidHeatCapacity(T, p);
+        case gasDensityTable: return gasDensity(T, p);
+        case liquidDensityTable: return liquidDensity(T, p);
+        case gasViscosityTable: return gasViscosity(T, p);
+        case liquidViscosityTable: return liquidViscosity(T, p);
+        case gasThermalConductivityTable: return gasThermalConductivity(T, p);
+        default: return liquidThermalConductivity(T, p);
+        }
+    }
+
+    // look up all pressure dependent quantities of a phase using the same cell and
+    // interpolation weights
+    template <class Evaluation>
+    ComponentPhaseProperties<Evaluation> lookupPhaseProperties_(const Evaluation& T,
+                                                                const Evaluation& p,
+                                                                bool liquid) const
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        Evaluation values[numPhaseTables_];
+        Evaluation alphaT = tempIdx_(T);
+        if (bicubic_ || alphaT < 0 || alphaT >= nTemp_ - 1) {
+            // either the interpolation does not share the weights or the temperature
+            // is outside of the tables
+            for (unsigned quantityIdx = 0; quantityIdx < numPhaseTables_; ++quantityIdx) {
+                Table tableIdx = phaseTable_(quantityIdx, liquid);
+                if (isTabulated_(tableIdx))
+                    values[quantityIdx] = phaseQuantity_(tableIdx, T, p);
+                else
+                    values[quantityIdx] = Toolbox::createConstant(std::numeric_limits<Scalar>::quiet_NaN());
+            }
+        }
+        else {
+            unsigned iT = std::max<int>(0, std::min<int>(nTemp_ - 2, Toolbox::value(alphaT)));
+            alphaT -= iT;
+
+            Evaluation alphaP1 = liquid ? pressLiquidIdx_(p, iT) : pressGasIdx_(p, iT);
+            Evaluation alphaP2 = liquid ? pressLiquidIdx_(p, iT + 1) : pressGasIdx_(p, iT + 1);
+            unsigned iP1 = std::max<int>(0, std::min<int>(nPress_ - 2, Toolbox::value(alphaP1)));
+            unsigned iP2 = std::max<int>(0, std::min<int>(nPress_ - 2, Toolbox::value(alphaP2)));
+            alphaP1 -= iP1;
+            alphaP2 -= iP2;
+
+            size_t i00 = iT + iP1*nTemp_;
+            size_t i01 = i00 + nTemp_;
+            size_t i10 = (iT + 1) + iP2*nTemp_;
+            size_t i11 = i10 + nTemp_;
+            const Evaluation& w00 = (1 - alphaT)*(1 - alphaP1);
+            const Evaluation& w01 = (1 - alphaT)*alphaP1;
+            const Evaluation& w10 = alphaT*(1 - alphaP2);
+            const Evaluation& w11 = alphaT*alphaP2;
+
+            for (unsigned quantityIdx = 0; quantityIdx < numPhaseTables_; ++quantityIdx) {
+                Table tableIdx = phaseTable_(quantityIdx, liquid);
+                if (!isTabulated_(tableIdx)) {
+                    values[quantityIdx] = Toolbox::createConstant(std::numeric_limits<Scalar>::quiet_NaN());
+                    continue;
+                }
+
+                const StorageScalar* v = table_(tableIdx);
+                values[quantityIdx] =
+                    Scalar(v[i00])*w00 + Scalar(v[i01])*w01
+                    + Scalar(v[i10])*w10 + Scalar(v[i11])*w11;
+                if (std::isnan(Toolbox::value(values[quantityIdx])))
+                    // records the miss and falls back to the raw component
+                    values[quantityIdx] = phaseQuantity_(tableIdx, T, p);
+                else
+                    OPM_INSTRUMENT_EVENT(statisticsName_(tableIdx) + " table hit");
+            }
+        }
+
+        ComponentPhaseProperties<Evaluation> result;
+        result.density = values[0];
+        result.enthalpy = values[1];
+        result.heatCapacity = values[2];
+        result.viscosity = values[3];
+        result.thermalConductivity = values[4];
+        return result;
     }
 
     // returns an interpolated value for gas depending on
     // temperature and density
     template <class Evaluation>
-    static Evaluation interpolateGasTRho_(const Scalar *values, const Evaluation& T, const Evaluation& rho)
+    Evaluation interpolateGasTRho_(const StorageScalar *values, const Evaluation& T, const Evaluation& rho) const
     {
         Evaluation alphaT = tempIdx_(T);
+        if (bicubic_)
+            return interpolateHermite_(values, alphaT, rho,
+                                       [this](const Evaluation& x, unsigned tempIdx)
+                                       { return densityGasIdx_(x, tempIdx); });
+
         unsigned iT = std::max<int>(0, std::min<int>(nTemp_ - 2, (int) alphaT));
         alphaT -= iT;
 
@@ -653,18 +1687,23 @@ private:
         alphaP2 -= iP2;
 
         return
-            values[(iT    ) + (iP1    )*nTemp_]*(1 - alphaT)*(1 - alphaP1) +
-            values[(iT    ) + (iP1 + 1)*nTemp_]*(1 - alphaT)*(    alphaP1) +
-            values[(iT + 1) + (iP2    )*nTemp_]*(    alphaT)*(1 - alphaP2) +
-            values[(iT + 1) + (iP2 + 1)*nTemp_]*(    alphaT)*(    alphaP2);
+            Scalar(values[(iT    ) + (iP1    )*nTemp_])*(1 - alphaT)*(1 - alphaP1) +
+            Scalar(values[(iT    ) + (iP1 + 1)*nTemp_])*(1 - alphaT)*(    alphaP1) +
+            Scalar(values[(iT + 1) + (iP2    )*nTemp_])*(    alphaT)*(1 - alphaP2) +
+            Scalar(values[(iT + 1) + (iP2 + 1)*nTemp_])*(    alphaT)*(    alphaP2);
     }
 
     // returns an interpolated value for liquid depending on
     // temperature and density
     template <class Evaluation>
-    static Evaluation interpolateLiquidTRho_(const Scalar *values, const Evaluation& T, const Evaluation& rho)
+    Evaluation interpolateLiquidTRho_(const StorageScalar *values, const Evaluation& T, const Evaluation& rho) const
     {
         Evaluation alphaT = tempIdx_(T);
+        if (bicubic_)
+            return interpolateHermite_(values, alphaT, rho,
+                                       [this](const Evaluation& x, unsigned tempIdx)
+                                       { return densityLiquidIdx_(x, tempIdx); });
+
         unsigned iT = std::max<int>(0, std::min<int>(nTemp_ - 2, (int) alphaT));
         alphaT -= iT;
 
@@ -676,23 +1715,96 @@ private:
         alphaP2 -= iP2;
 
         return
-            values[(iT    ) + (iP1    )*nTemp_]*(1 - alphaT)*(1 - alphaP1) +
-            values[(iT    ) + (iP1 + 1)*nTemp_]*(1 - alphaT)*(    alphaP1) +
-            values[(iT + 1) + (iP2    )*nTemp_]*(    alphaT)*(1 - alphaP2) +
-            values[(iT + 1) + (iP2 + 1)*nTemp_]*(    alphaT)*(    alphaP2);
+            Scalar(values[(iT    ) + (iP1    )*nTemp_])*(1 - alphaT)*(1 - alphaP1) +
+            Scalar(values[(iT    ) + (iP1 + 1)*nTemp_])*(1 - alphaT)*(    alphaP1) +
+            Scalar(values[(iT + 1) + (iP2    )*nTemp_])*(    alphaT)*(1 - alphaP2) +
+            Scalar(values[(iT + 1) + (iP2 + 1)*nTemp_])*(    alphaT)*(    alphaP2);
+    }
+
+    // returns a value which is interpolated by bicubic Hermite interpolation. The
+    // values and the derivatives to the second degree of freedom are interpolated
+    // within the two temperature columns which enclose the point, the results are
+    // then interpolated in the direction of temperature.
+    template <class Evaluation, class IndexFunctor>
+    Evaluation interpolateHermite_(const StorageScalar *values,
+                                   Evaluation alphaT,
+                                   const Evaluation& x,
+                                   const IndexFunctor& xIdx) const
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        unsigned iT = std::max<int>(0, std::min<int>(nTemp_ - 2, Toolbox::value(alphaT)));
+        alphaT -= iT;
+
+        size_t n = nTemp_*nPress_;
+        const StorageScalar* dv_dT = values + n;
+        const StorageScalar* dv_dX = values + 2*n;
+        const StorageScalar* ddv_dTdX = values + 3*n;
+
+        Evaluation v[2];
+        Evaluation dv[2];
+        for (unsigned colIdx = 0; colIdx < 2; ++colIdx) {
+            Evaluation alphaX = xIdx(x, iT + colIdx);
+            unsigned iX = std::max<int>(0, std::min<int>(nPress_ - 2, Toolbox::value(alphaX)));
+            alphaX -= iX;
+
+            size_t i0 = (iT + colIdx) + iX*nTemp_;
+            size_t i1 = i0 + nTemp_;
+            v[colIdx] = hermite_(alphaX,
+                                 Scalar(values[i0]), Scalar(values[i1]),
+                                 Scalar(dv_dX[i0]), Scalar(dv_dX[i1]));
+            dv[colIdx] = hermite_(alphaX,
+                                  Scalar(dv_dT[i0]), Scalar(dv_dT[i1]),
+                                  Scalar(ddv_dTdX[i0]), Scalar(ddv_dTdX[i1]));
+        }
+
+        return hermite_(alphaT, v[0], v[1], dv[0], dv[1]);
     }
 
+    // evaluates the cubic Hermite polynomial on the unit interval
+    template <class Evaluation, class ValueType>
+    static Evaluation hermite_(const Evaluation& t,
+                               const ValueType& v0, const ValueType& v1,
+                               const ValueType& d0, const ValueType& d1)
+    {
+        const Evaluation& t2 = t*t;
+        const Evaluation& t3 = t2*t;
+        return
+            (2*t3 - 3*t2 + 1)*v0
+            + (t3 - 2*t2 + t)*d0
+            + (3*t2 - 2*t3)*v1
+            + (t3 - t2)*d1;
+    }
 
     // returns the index of an entry in a temperature field
     template <class Evaluation>
-    static Evaluation tempIdx_(const Evaluation& temperature)
+    Evaluation tempIdx_(const Evaluation& temperature) const
     {
-        return (nTemp_ - 1)*(temperature - tempMin_)/(tempMax_ - tempMin_);
+        if (!temperatures_)
+            return (nTemp_ - 1)*(temperature - tempMin_)/(tempMax_ - tempMin_);
+
+        // the sampling temperatures of adaptive tables are not equidistant, so the
+        // interval needs to be searched. temperatures outside of the tabulated range
+        // are mapped to indices outside of [0, nTemp_ - 1] like for uniform tables.
+        Scalar T = MathToolbox<Evaluation>::value(temperature);
+        unsigned lowerIdx = 0;
+        unsigned upperIdx = nTemp_ - 2;
+        while (lowerIdx < upperIdx) {
+            unsigned pivotIdx = (lowerIdx + upperIdx + 1)/2;
+            if (temperatures_[pivotIdx] <= T)
+                lowerIdx = pivotIdx;
+            else
+                upperIdx = pivotIdx - 1;
+        }
+
+        Scalar T0 = temperatures_[lowerIdx];
+        Scalar T1 = temperatures_[lowerIdx + 1];
+        return lowerIdx + (temperature - T0)/(T1 - T0);
     }
 
     // returns the index of an entry in a pressure field
     template <class Evaluation>
-    static Evaluation pressLiquidIdx_(const Evaluation& pressure, unsigned tempIdx)
+    Evaluation pressLiquidIdx_(const Evaluation& pressure, unsigned tempIdx) const
     {
         Scalar plMin = minLiquidPressure_(tempIdx);
         Scalar plMax = maxLiquidPressure_(tempIdx);
@@ -702,7 +1814,7 @@ private:
 
     // returns the index of an entry in a temperature field
     template <class Evaluation>
-    static Evaluation pressGasIdx_(const Evaluation& pressure, unsigned tempIdx)
+    Evaluation pressGasIdx_(const Evaluation& pressure, unsigned tempIdx) const
     {
         Scalar pgMin = minGasPressure_(tempIdx);
         Scalar pgMax = maxGasPressure_(tempIdx);
@@ -712,7 +1824,7 @@ private:
 
     // returns the index of an entry in a density field
     template <class Evaluation>
-    static Evaluation densityLiquidIdx_(const Evaluation& density, unsigned tempIdx)
+    Evaluation densityLiquidIdx_(const Evaluation& density, unsigned tempIdx) const
     {
         Scalar densityMin = minLiquidDensity_(tempIdx);
         Scalar densityMax = maxLiquidDensity_(tempIdx);
@@ -721,7 +1833,7 @@ private:
 
     // returns the index of an entry in a density field
     template <class Evaluation>
-    static Evaluation densityGasIdx_(const Evaluation& density, unsigned tempIdx)
+    Evaluation densityGasIdx_(const Evaluation& density, unsigned tempIdx) const
     {
         Scalar densityMin = minGasDensity_(tempIdx);
         Scalar densityMax = maxGasDensity_(tempIdx);
@@ -730,163 +1842,406 @@ private:
 
     // returns the minimum tabulized liquid pressure at a given
     // temperature index
-    static Scalar minLiquidPressure_(int tempIdx)
+    Scalar minLiquidPressure_(int tempIdx) const
+    { return minLiquidPressureFor_(vaporPressure_[tempIdx]); }
+
+    // returns the maximum tabulized liquid pressure at a given
+    // temperature index
+    Scalar maxLiquidPressure_(int tempIdx) const
+    { return maxLiquidPressureFor_(vaporPressure_[tempIdx]); }
+
+    // returns the minumum tabulized gas pressure at a given
+    // temperature index
+    Scalar minGasPressure_(int tempIdx) const
+    { return minGasPressureFor_(vaporPressure_[tempIdx]); }
+
+    // returns the maximum tabulized gas pressure at a given
+    // temperature index
+    Scalar maxGasPressure_(int tempIdx) const
+    { return maxGasPressureFor_(vaporPressure_[tempIdx]); }
+
+    // returns the minimum tabulized liquid pressure for a given vapor pressure
+    Scalar minLiquidPressureFor_(Scalar vaporPressure) const
     {
         if (!useVaporPressure)
             return pressMin_;
         else
-            return std::max<Scalar>(pressMin_, vaporPressure_[tempIdx] / 1.1);
+            return std::max<Scalar>(pressMin_, vaporPressure / 1.1);
     }
 
-    // returns the maximum tabulized liquid pressure at a given
-    // temperature index
-    static Scalar maxLiquidPressure_(int tempIdx)
+    // returns the maximum tabulized liquid pressure for a given vapor pressure
+    Scalar maxLiquidPressureFor_(Scalar vaporPressure) const
     {
         if (!useVaporPressure)
             return pressMax_;
         else
-            return std::max<Scalar>(pressMax_, vaporPressure_[tempIdx] * 1.1);
+            return std::max<Scalar>(pressMax_, vaporPressure * 1.1);
     }
 
-    // returns the minumum tabulized gas pressure at a given
-    // temperature index
-    static Scalar minGasPressure_(int tempIdx)
+    // returns the minumum tabulized gas pressure for a given vapor pressure
+    Scalar minGasPressureFor_(Scalar vaporPressure) const
     {
         if (!useVaporPressure)
             return pressMin_;
         else
-            return std::min<Scalar>(pressMin_, vaporPressure_[tempIdx] / 1.1 );
+            return std::min<Scalar>(pressMin_, vaporPressure / 1.1 );
     }
 
-    // returns the maximum tabulized gas pressure at a given
-    // temperature index
-    static Scalar maxGasPressure_(int tempIdx)
+    // returns the maximum tabulized gas pressure for a given vapor pressure
+    Scalar maxGasPressureFor_(Scalar vaporPressure) const
     {
         if (!useVaporPressure)
             return pressMax_;
         else
-            return std::min<Scalar>(pressMax_, vaporPressure_[tempIdx] * 1.1);
+            return std::min<Scalar>(pressMax_, vaporPressure * 1.1);
     }
 
 
     // returns the minimum tabulized liquid density at a given
     // temperature index
-    static Scalar minLiquidDensity_(int tempIdx)
+    Scalar minLiquidDensity_(int tempIdx) const
     { return minLiquidDensity__[tempIdx]; }
 
     // returns the maximum tabulized liquid density at a given
     // temperature index
-    static Scalar maxLiquidDensity_(int tempIdx)
+    Scalar maxLiquidDensity_(int tempIdx) const
     { return maxLiquidDensity__[tempIdx]; }
 
     // returns the minumum tabulized gas density at a given
     // temperature index
-    static Scalar minGasDensity_(int tempIdx)
+    Scalar minGasDensity_(int tempIdx) const
     { return minGasDensity__[tempIdx]; }
 
     // returns the maximum tabulized gas density at a given
     // temperature index
-    static Scalar maxGasDensity_(int tempIdx)
+    Scalar maxGasDensity_(int tempIdx) const
     { return maxGasDensity__[tempIdx]; }
 
+    // the sampling temperatures of adaptive tables. this is null if the sampling
+    // temperatures are equidistant.
+    Scalar *temperatures_;
+
     // 1D fields with the temperature as degree of freedom
-    static Scalar *vaporPressure_;
+    Scalar *vaporPressure_;
 
-    static Scalar *minLiquidDensity__;
-    static Scalar *maxLiquidDensity__;
+    Scalar *minLiquidDensity__;
+    Scalar *maxLiquidDensity__;
 
-    static Scalar *minGasDensity__;
-    static Scalar *maxGasDensity__;
+    Scalar *minGasDensity__;
+    Scalar *maxGasDensity__;
 
-    // 2D fields with the temperature and pressure as degrees of
-    // freedom
-    static Scalar *gasEnthalpy_;
-    static Scalar *liquidEnthalpy_;
+    // 2D fields with the temperature and pressure or density as degrees of
+    // freedom. these are published atomically because they might be calculated
+    // lazily.
+    mutable std::atomic<const StorageScalar*> tables_[numTables];
 
-    static Scalar *gasHeatCapacity_;
-    static Scalar *liquidHeatCapacity_;
+    // the properties which are tabulated, cf. PropertyFlags
+    unsigned properties_;
 
-    static Scalar *gasDensity_;
-    static Scalar *liquidDensity_;
+    // specifies whether the tables include the derivatives for bicubic interpolation
+    bool bicubic_;
 
-    static Scalar *gasViscosity_;
-    static Scalar *liquidViscosity_;
+    // the file which holds the tables if they were loaded using loadTables()
+    TableFile tableFile_;
+    bool tablesInFile_;
 
-    static Scalar *gasThermalConductivity_;
-    static Scalar *liquidThermalConductivity_;
+    // temperature, pressure and density ranges
+    Scalar tempMin_;
+    Scalar tempMax_;
+    unsigned nTemp_;
 
-    // 2D fields with the temperature and density as degrees of
-    // freedom
-    static Scalar *gasPressure_;
-    static Scalar *liquidPressure_;
+    Scalar pressMin_;
+    Scalar pressMax_;
+    unsigned nPress_;
 
-    // temperature, pressure and density ranges
-    static Scalar tempMin_;
-    static Scalar tempMax_;
-    static unsigned nTemp_;
+    Scalar densityMin_;
+    Scalar densityMax_;
+    unsigned nDensity_;
+};
+
+/*!
+ * \ingroup Components
+ *
+ * \brief A generic class which tabulates all thermodynamic properties
+ *        of a given component.
+ *
+ * This class provides a static interface to a default TabulatedComponentInstance
+ * object, so it can be used wherever a component is expected. Optionally, a second
+ * object with coarse tables can be used for the lookups, cf. setUseCoarseTables(). If several tabulations of
+ * the same raw component are required within the same process, e.g., with different
+ * temperature and pressure ranges, TabulatedComponentInstance objects can be used
+ * directly.
+ *
+ * \tparam Scalar The type used for scalar values
+ * \tparam RawComponent The component which ought to be tabulated
+ * \tparam useVaporPressure If true, tabulate all quantities along the
+ *                          vapor pressure curve, if false use the
+ *                          pressure range [p_min, p_max]
+ * \tparam StorageScalarT The type used to store the values of the two-dimensional
+ *                        property tables, cf. TabulatedComponentInstance
+ */
+template <class ScalarT, class RawComponent, bool useVaporPressure=true, class StorageScalarT=ScalarT>
+class TabulatedComponent : public TabulatedComponentProperties
+{
+public:
+    //! The type of the object to which the calls are forwarded
+    typedef TabulatedComponentInstance<ScalarT, RawComponent, useVaporPressure, StorageScalarT> Instance;
+
+    typedef ScalarT Scalar;
+    typedef StorageScalarT StorageScalar;
+
+    static const bool isTabulated = true;
+
+    //! liquidProperties() and gasProperties() are provided, but quantities which are not
+    //! tabulated are reported as NaN instead of raising an error, so users of
+    //! Component::hasPhaseProperties keep using the individual lookups
+    static const bool hasPhaseProperties = false;
+
+    /*!
+     * \brief Returns the object to which all calls of the static methods are forwarded.
+     */
+    static Instance& defaultInstance()
+    { return defaultInstance_; }
+
+    /*!
+     * \brief Returns the object which provides the coarse tables.
+     *
+     * The coarse tables are initialized like the default ones, e.g., using
+     * coarseInstance().init(), but with fewer sampling points. They are only used while
+     * they are selected by setUseCoarseTables().
+     */
+    static Instance& coarseInstance()
+    { return coarseInstance_; }
+
+    /*!
+     * \brief Specify whether the properties ought to be looked up in the coarse tables
+     *        instead of the default ones.
+     *
+     * Coarse tables are small enough to stay in the cache, so they are intended for the
+     * early iterations of a nonlinear solver, where the residual is large anyway. The
+     * methods which initialize, save or load the tables always refer to the default
+     * tables. This must not be called while other threads look up properties.
+     */
+    static void setUseCoarseTables(bool yesno)
+    {
+        if (yesno && coarseInstance_.numTemperatures() == 0)
+            OPM_THROW(std::logic_error,
+                      "The coarse tables of component " << name()
+                      << " must be initialized before they can be used");
+
+        activeInstance_ = yesno ? &coarseInstance_ : &defaultInstance_;
+    }
+
+    /*!
+     * \brief Returns true iff the properties are currently looked up in the coarse
+     *        tables.
+     */
+    static bool useCoarseTables()
+    { return activeInstance_ == &coarseInstance_; }
+
+    //! \copydoc TabulatedComponentInstance::init
+    static void init(Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                     Scalar pressMin, Scalar pressMax, unsigned nPress,
+                     bool lazy = false,
+                     bool bicubic = false,
+                     unsigned properties = allPropertiesFlag)
+    { defaultInstance_.init(tempMin, tempMax, nTemp, pressMin, pressMax, nPress, lazy, bicubic, properties); }
+
+    //! \copydoc TabulatedComponentInstance::initAsync
+    static std::future<void> initAsync(Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                                       Scalar pressMin, Scalar pressMax, unsigned nPress,
+                                       bool lazy = false,
+                                       bool bicubic = false,
+                                       unsigned properties = allPropertiesFlag)
+    {
+        return defaultInstance_.initAsync(tempMin, tempMax, nTemp, pressMin, pressMax, nPress,
+                                          lazy, bicubic, properties);
+    }
+
+    //! \copydoc TabulatedComponentInstance::initAdaptive
+    static void initAdaptive(Scalar tempMin, Scalar tempMax,
+                             Scalar pressMin, Scalar pressMax, unsigned nPress,
+                             Scalar relTolerance,
+                             unsigned maxTemp = 10000,
+                             bool lazy = false,
+                             unsigned properties = allPropertiesFlag)
+    {
+        defaultInstance_.initAdaptive(tempMin, tempMax, pressMin, pressMax, nPress,
+                                      relTolerance, maxTemp, lazy, properties);
+    }
+
+    //! \copydoc TabulatedComponentInstance::numTemperatures
+    static unsigned numTemperatures()
+    { return defaultInstance_.numTemperatures(); }
+
+    //! \copydoc TabulatedComponentInstance::saveTables
+    static void saveTables(const std::string& fileName)
+    { defaultInstance_.saveTables(fileName); }
+
+    //! \copydoc TabulatedComponentInstance::loadTables
+    static bool loadTables(const std::string& fileName,
+                           Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                           Scalar pressMin, Scalar pressMax, unsigned nPress,
+                           bool map = true,
+                           bool bicubic = false)
+    {
+        return defaultInstance_.loadTables(fileName, tempMin, tempMax, nTemp,
+                                           pressMin, pressMax, nPress, map, bicubic);
+    }
+
+    //! \copydoc TabulatedComponentInstance::name
+    static const char *name()
+    { return Instance::name(); }
+
+    //! \copydoc TabulatedComponentInstance::molarMass
+    static Scalar molarMass()
+    { return Instance::molarMass(); }
 
-    static Scalar pressMin_;
-    static Scalar pressMax_;
-    static unsigned nPress_;
+    //! \copydoc TabulatedComponentInstance::criticalTemperature
+    static Scalar criticalTemperature()
+    { return Instance::criticalTemperature(); }
+
+    //! \copydoc TabulatedComponentInstance::criticalPressure
+    static Scalar criticalPressure()
+    { return Instance::criticalPressure(); }
+
+    //! \copydoc TabulatedComponentInstance::tripleTemperature
+    static Scalar tripleTemperature()
+    { return Instance::tripleTemperature(); }
+
+    //! \copydoc TabulatedComponentInstance::triplePressure
+    static Scalar triplePressure()
+    { return Instance::triplePressure(); }
 
-    static Scalar densityMin_;
-    static Scalar densityMax_;
-    static unsigned nDensity_;
+    //! \copydoc TabulatedComponentInstance::vaporPressure
+    template <class Evaluation>
+    static Evaluation vaporPressure(const Evaluation& temperature)
+    { return activeInstance_->vaporPressure(temperature); }
+
+    //! \copydoc TabulatedComponentInstance::gasEnthalpy
+    template <class Evaluation>
+    static Evaluation gasEnthalpy(const Evaluation& temperature, const Evaluation& pressure)
+    { return activeInstance_->gasEnthalpy(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::liquidEnthalpy
+    template <class Evaluation>
+    static Evaluation liquidEnthalpy(const Evaluation& temperature, const Evaluation& pressure)
+    { return activeInstance_->liquidEnthalpy(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::gasHeatCapacity
+    template <class Evaluation>
+    static Evaluation gasHeatCapacity(const Evaluation& temperature, const Evaluation& pressure)
+    { return activeInstance_->gasHeatCapacity(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::liquidHeatCapacity
+    template <class Evaluation>
+    static Evaluation liquidHeatCapacity(const Evaluation& temperature, const Evaluation& pressure)
+    { return activeInstance_->liquidHeatCapacity(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::gasInternalEnergy
+    template <class Evaluation>
+    static Evaluation gasInternalEnergy(const Evaluation& temperature, const Evaluation& pressure)
+    { return activeInstance_->gasInternalEnergy(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::liquidInternalEnergy
+    template <class Evaluation>
+    static Evaluation liquidInternalEnergy(const Evaluation& temperature, const Evaluation& pressure)
+    { return activeInstance_->liquidInternalEnergy(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::gasPressure
+    template <class Evaluation>
+    static Evaluation gasPressure(const Evaluation& temperature, Scalar density)
+    { return activeInstance_->gasPressure(temperature, density); }
+
+    //! \copydoc TabulatedComponentInstance::liquidPressure
+    template <class Evaluation>
+    static Evaluation liquidPressure(const Evaluation& temperature, Scalar density)
+    { return activeInstance_->liquidPressure(temperature, density); }
+
+    //! \copydoc TabulatedComponentInstance::gasIsCompressible
+    static bool gasIsCompressible()
+    { return Instance::gasIsCompressible(); }
+
+    //! \copydoc TabulatedComponentInstance::liquidIsCompressible
+    static bool liquidIsCompressible()
+    { return Instance::liquidIsCompressible(); }
+
+    //! \copydoc TabulatedComponentInstance::gasIsIdeal
+    static bool gasIsIdeal()
+    { return Instance::gasIsIdeal(); }
+
+    //! \copydoc TabulatedComponentInstance::isValidGasState
+    template <class Evaluation>
+    static bool isValidGasState(const Evaluation& temperature, const Evaluation& pressure)
+    { return Instance::isValidGasState(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::isValidLiquidState
+    template <class Evaluation>
+    static bool isValidLiquidState(const Evaluation& temperature, const Evaluation& pressure)
+    { return Instance::isValidLiquidState(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::gasDensity
+    template <class Evaluation>
+    static Evaluation gasDensity(const Evaluation& temperature, const Evaluation& pressure)
+    { return activeInstance_->gasDensity(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::liquidDensity
+    template <class Evaluation>
+    static Evaluation liquidDensity(const Evaluation& temperature, const Evaluation& pressure)
+    { return activeInstance_->liquidDensity(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::gasViscosity
+    template <class Evaluation>
+    static Evaluation gasViscosity(const Evaluation& temperature, const Evaluation& pressure)
+    { return activeInstance_->gasViscosity(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::liquidViscosity
+    template <class Evaluation>
+    static Evaluation liquidViscosity(const Evaluation& temperature, const Evaluation& pressure)
+    { return activeInstance_->liquidViscosity(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::gasThermalConductivity
+    template <class Evaluation>
+    static Evaluation gasThermalConductivity(const Evaluation& temperature, const Evaluation& pressure)
+    { return activeInstance_->gasThermalConductivity(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::liquidThermalConductivity
+    template <class Evaluation>
+    static Evaluation liquidThermalConductivity(const Evaluation& temperature, const Evaluation& pressure)
+    { return activeInstance_->liquidThermalConductivity(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::liquidProperties
+    template <class Evaluation>
+    static ComponentPhaseProperties<Evaluation> liquidProperties(const Evaluation& temperature,
+                                                                 const Evaluation& pressure)
+    { return activeInstance_->liquidProperties(temperature, pressure); }
+
+    //! \copydoc TabulatedComponentInstance::gasProperties
+    template <class Evaluation>
+    static ComponentPhaseProperties<Evaluation> gasProperties(const Evaluation& temperature,
+                                                              const Evaluation& pressure)
+    { return activeInstance_->gasProperties(temperature, pressure); }
+
+private:
+    static Instance defaultInstance_;
+    static Instance coarseInstance_;
+
+    // the object which is used to look up the properties
+    static Instance* activeInstance_;
 };
 
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::vaporPressure_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::minLiquidDensity__;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::maxLiquidDensity__;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::minGasDensity__;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::maxGasDensity__;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::gasEnthalpy_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::liquidEnthalpy_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::gasHeatCapacity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::liquidHeatCapacity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::gasDensity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::liquidDensity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::gasViscosity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::liquidViscosity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::gasThermalConductivity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::liquidThermalConductivity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::gasPressure_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::liquidPressure_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure>::tempMin_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure>::tempMax_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-unsigned TabulatedComponent<Scalar, RawComponent, useVaporPressure>::nTemp_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure>::pressMin_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure>::pressMax_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-unsigned TabulatedComponent<Scalar, RawComponent, useVaporPressure>::nPress_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure>::densityMin_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure>::densityMax_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-unsigned TabulatedComponent<Scalar, RawComponent, useVaporPressure>::nDensity_;
+template <class Scalar, class RawComponent, bool useVaporPressure, class StorageScalar>
+typename TabulatedComponent<Scalar, RawComponent, useVaporPressure, StorageScalar>::Instance
+TabulatedComponent<Scalar, RawComponent, useVaporPressure, StorageScalar>::defaultInstance_;
+
+template <class Scalar, class RawComponent, bool useVaporPressure, class StorageScalar>
+typename TabulatedComponent<Scalar, RawComponent, useVaporPressure, StorageScalar>::Instance
+TabulatedComponent<Scalar, RawComponent, useVaporPressure, StorageScalar>::coarseInstance_;
 
+template <class Scalar, class RawComponent, bool useVaporPressure, class StorageScalar>
+typename TabulatedComponent<Scalar, RawComponent, useVaporPressure, StorageScalar>::Instance*
+TabulatedComponent<Scalar, RawComponent, useVaporPressure, StorageScalar>::activeInstance_ =
+    &TabulatedComponent<Scalar, RawComponent, useVaporPressure, StorageScalar>::defaultInstance_;
 
 } // namespace Opm
 
@@ -223,12 +223,12 @@ public:
         Evaluation rhobarQ = Toolbox::pow(rhobar, Q);
 
         lam +=
-            (thcond_d1 / Toolbox::pow(Tbar,10.0) + thcond_d2) * rhobar18 *
+            (thcond_d1 / Toolbox::pow(Tbar, 10) + thcond_d2) * rhobar18 *
             Toolbox::exp(thcond_c1 * (1 - rhobar * rhobar18))
             + thcond_d3 * S * rhobarQ *
             Toolbox::exp((Q/(1+Q))*(1 - rhobar*rhobarQ))
             + thcond_d4 *
-            Toolbox::exp(thcond_c2 * Toolbox::pow(Troot,3.0) + thcond_c3 / Toolbox::pow(rhobar,5.0));
+            Toolbox::exp(thcond_c2 * Toolbox::pow(Troot, 3) + thcond_c3 / Toolbox::pow(rhobar, 5));
         return /*thcond_kstar * */ lam;
     }
 };
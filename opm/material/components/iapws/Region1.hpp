@@ -138,12 +138,13 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation pi_ = pi(pressure);    /* reduced pressure */
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powPi, powTau, temperature, pressure);
 
-        Evaluation result = 0;
+        Evaluation result = Toolbox::createConstant(0.0);
         for (int i = 0; i < 34; ++i) {
-            result += n(i)*Toolbox::pow(7.1 - pi_, I(i))*Toolbox::pow(tau_ - 1.222, J(i));
+            result += n(i)*powPi[I_(i)]*powTau[J_(i) - minJ_];
         }
 
         return result;
@@ -166,16 +167,13 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation pi_ = pi(pressure);    /* reduced pressure */
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powPi, powTau, temperature, pressure);
 
         Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 34; i++) {
-            result +=
-                n(i) *
-                Toolbox::pow(7.1 - pi_, static_cast<Scalar>(I(i))) *
-                Toolbox::pow(tau_ - 1.222,  static_cast<Scalar>(J(i)-1)) *
-                J(i);
+        for (int i = 0; i < 34; ++i) {
+            result += (n(i)*J(i))*powPi[I_(i)]*powTau[J_(i) - 1 - minJ_];
         }
 
         return result;
@@ -197,16 +195,15 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation pi_ = pi(pressure);    /* reduced pressure */
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powPi, powTau, temperature, pressure);
 
         Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 34; i++) {
-            result +=
-                -n(i) *
-                I(i) *
-                Toolbox::pow(7.1 - pi_, static_cast<Scalar>(I(i) - 1)) *
-                Toolbox::pow(tau_ - 1.222, static_cast<Scalar>(J(i)));
+        for (int i = 0; i < 34; ++i) {
+            if (I_(i) < 1)
+                continue;
+            result += (-n(i)*I(i))*powPi[I_(i) - 1]*powTau[J_(i) - minJ_];
         }
 
         return result;
@@ -229,17 +226,15 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation pi_ = pi(pressure);    /* reduced pressure */
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powPi, powTau, temperature, pressure);
 
         Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 34; i++) {
-            result +=
-                -n(i) *
-                I(i) *
-                J(i) *
-                Toolbox::pow(7.1 - pi_, static_cast<Scalar>(I(i) - 1)) *
-                Toolbox::pow(tau_ - 1.222, static_cast<Scalar>(J(i) - 1));
+        for (int i = 0; i < 34; ++i) {
+            if (I_(i) < 1)
+                continue;
+            result += (-n(i)*I(i)*J(i))*powPi[I_(i) - 1]*powTau[J_(i) - 1 - minJ_];
         }
 
         return result;
@@ -262,17 +257,15 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation pi_ = pi(pressure);    /* reduced pressure */
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powPi, powTau, temperature, pressure);
 
         Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 34; i++) {
-            result +=
-                n(i) *
-                I(i) *
-                (I(i) - 1) *
-                Toolbox::pow(7.1 - pi_, I(i) - 2) *
-                Toolbox::pow(tau_ - 1.222, J(i));
+        for (int i = 0; i < 34; ++i) {
+            if (I_(i) < 2)
+                continue;
+            result += (n(i)*I(i)*(I(i) - 1))*powPi[I_(i) - 2]*powTau[J_(i) - minJ_];
         }
 
         return result;
@@ -294,23 +287,113 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation pi_ = pi(pressure);    /* reduced pressure */
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powPi, powTau, temperature, pressure);
 
         Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 34; i++) {
-            result +=
-                n(i) *
-                Toolbox::pow(7.1 - pi_, I(i)) *
-                J(i) *
-                (J(i) - 1) *
-                Toolbox::pow(tau_ - 1.222,  J(i) - 2);
+        for (int i = 0; i < 34; ++i) {
+            result += (n(i)*J(i)*(J(i) - 1))*powPi[I_(i)]*powTau[J_(i) - 2 - minJ_];
         }
 
         return result;
     }
 
+    /*!
+     * \brief The Gibbs free energy and all of its partial derivatives which are
+     *        defined for IAPWS region 1 (i.e. liquid) (dimensionless).
+     *
+     * This is equivalent to calling gamma(), dgamma_dtau(), dgamma_dpi(),
+     * ddgamma_dtaudpi(), ddgamma_ddpi() and ddgamma_ddtau(), but the powers of the
+     * reduced quantities are only computed once and all terms are evaluated in a
+     * single pass.
+     *
+     * \param temperature temperature of component in \f$\mathrm{[K]}\f$
+     * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
+     */
+    template <class Evaluation>
+    static void gammaAndDerivatives(Evaluation& gamma,
+                                    Evaluation& dgamma_dtau,
+                                    Evaluation& dgamma_dpi,
+                                    Evaluation& ddgamma_dtaudpi,
+                                    Evaluation& ddgamma_ddpi,
+                                    Evaluation& ddgamma_ddtau,
+                                    const Evaluation& temperature,
+                                    const Evaluation& pressure)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powPi, powTau, temperature, pressure);
+
+        gamma = Toolbox::createConstant(0.0);
+        dgamma_dtau = Toolbox::createConstant(0.0);
+        dgamma_dpi = Toolbox::createConstant(0.0);
+        ddgamma_dtaudpi = Toolbox::createConstant(0.0);
+        ddgamma_ddpi = Toolbox::createConstant(0.0);
+        ddgamma_ddtau = Toolbox::createConstant(0.0);
+        for (int i = 0; i < 34; ++i) {
+            const Scalar ni = n(i);
+            const Scalar Ii = I(i);
+            const Scalar Ji = J(i);
+            const int k = I_(i);
+            const int l = J_(i) - minJ_;
+
+            gamma += ni*powPi[k]*powTau[l];
+            dgamma_dtau += (ni*Ji)*powPi[k]*powTau[l - 1];
+            ddgamma_ddtau += (ni*Ji*(Ji - 1))*powPi[k]*powTau[l - 2];
+            if (k >= 1) {
+                dgamma_dpi += (-ni*Ii)*powPi[k - 1]*powTau[l];
+                ddgamma_dtaudpi += (-ni*Ii*Ji)*powPi[k - 1]*powTau[l - 1];
+            }
+            if (k >= 2)
+                ddgamma_ddpi += (ni*Ii*(Ii - 1))*powPi[k - 2]*powTau[l];
+        }
+    }
+
 private:
+    // the range of the exponents of the powers of (7.1 - pi) and (tau - 1.222)
+    // which appear in the equation and its derivatives
+    enum { maxI_ = 32 };
+    enum { minJ_ = -41 - 2 };
+    enum { maxJ_ = 17 };
+    enum { numPowersPi_ = maxI_ + 1 };
+    enum { numPowersTau_ = maxJ_ - minJ_ + 1 };
+
+    // compute all powers of (7.1 - pi) and (tau - 1.222) which are required by
+    // repeated multiplication. powTau[j - minJ_] is (tau - 1.222)^j.
+    template <class Evaluation>
+    static void computePowers_(Evaluation* powPi,
+                               Evaluation* powTau,
+                               const Evaluation& temperature,
+                               const Evaluation& pressure)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        const Evaluation& x = 7.1 - pi(pressure);
+        const Evaluation& y = tau(temperature) - 1.222;
+
+        powPi[0] = Toolbox::createConstant(1.0);
+        for (int k = 1; k <= maxI_; ++k)
+            powPi[k] = powPi[k - 1]*x;
+
+        // tau is larger than 2.22 in region 1, i.e., y is always positive
+        powTau[-minJ_] = Toolbox::createConstant(1.0);
+        for (int l = 1; l <= maxJ_; ++l)
+            powTau[l - minJ_] = powTau[l - 1 - minJ_]*y;
+
+        const Evaluation& yInv = 1.0/y;
+        for (int l = -1; l >= minJ_; --l)
+            powTau[l - minJ_] = powTau[l + 1 - minJ_]*yInv;
+    }
+
+    static int I_(int i)
+    { return static_cast<int>(I(i)); }
+
+    static int J_(int i)
+    { return static_cast<int>(J(i)); }
+
     static Scalar n(int i)
     {
         static const Scalar n[34] = {
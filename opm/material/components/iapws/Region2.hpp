@@ -136,22 +136,20 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& tau_ = tau(temperature); /* reduced temperature */
-        const Evaluation& pi_ = pi(pressure);      /* reduced pressure */
-
-        Evaluation result;
+        Evaluation powTau0[numPowersTau0_];
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powTau0, powPi, powTau, temperature, pressure);
 
         // ideal gas part
-        result = Toolbox::ln(pi_);
+        Evaluation result = Toolbox::log(pi(pressure));
         for (int i = 0; i < 9; ++i)
-            result += n_g(i)*Toolbox::pow(tau_, J_g(i));
+            result += n_g(i)*powTau0[J_g_(i) - minJ_g_];
 
         // residual part
         for (int i = 0; i < 43; ++i)
-            result +=
-                n_r(i)*
-                Toolbox::pow(pi_, I_r(i))*
-                Toolbox::pow(tau_ - 0.5, J_r(i));
+            result += n_r(i)*powPi[I_r_(i)]*powTau[J_r_(i)];
+
         return result;
     }
 
@@ -172,25 +170,21 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation& pi_ = pi(pressure);    /* reduced pressure */
+        Evaluation powTau0[numPowersTau0_];
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powTau0, powPi, powTau, temperature, pressure);
 
         // ideal gas part
         Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 9; i++) {
-            result +=
-                n_g(i) *
-                J_g(i) *
-                Toolbox::pow(tau_, static_cast<Scalar>(J_g(i) - 1));
-        }
+        for (int i = 0; i < 9; ++i)
+            result += (n_g(i)*J_g(i))*powTau0[J_g_(i) - 1 - minJ_g_];
 
         // residual part
-        for (int i = 0; i < 43; i++) {
-            result +=
-                n_r(i) *
-                Toolbox::pow(pi_,  static_cast<Scalar>(I_r(i))) *
-                J_r(i) *
-                Toolbox::pow(tau_ - 0.5, static_cast<Scalar>(J_r(i) - 1));
+        for (int i = 0; i < 43; ++i) {
+            if (J_r_(i) < 1)
+                continue;
+            result += (n_r(i)*J_r(i))*powPi[I_r_(i)]*powTau[J_r_(i) - 1];
         }
 
         return result;
@@ -211,22 +205,17 @@ public:
     template <class Evaluation>
     static Evaluation dgamma_dpi(const Evaluation& temperature, const Evaluation& pressure)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
-
-        const Evaluation& tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation& pi_ = pi(pressure);    /* reduced pressure */
+        Evaluation powTau0[numPowersTau0_];
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powTau0, powPi, powTau, temperature, pressure);
 
         // ideal gas part
-        Evaluation result = 1/pi_;
+        Evaluation result = 1/powPi[1];
 
         // residual part
-        for (int i = 0; i < 43; i++) {
-            result +=
-                n_r(i) *
-                I_r(i) *
-                Toolbox::pow(pi_, static_cast<Scalar>(I_r(i) - 1)) *
-                Toolbox::pow(tau_ - 0.5, static_cast<Scalar>(J_r(i)));
-        }
+        for (int i = 0; i < 43; ++i)
+            result += (n_r(i)*I_r(i))*powPi[I_r_(i) - 1]*powTau[J_r_(i)];
 
         return result;
     }
@@ -248,20 +237,19 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation& pi_ = pi(pressure);    /* reduced pressure */
+        Evaluation powTau0[numPowersTau0_];
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powTau0, powPi, powTau, temperature, pressure);
 
         // ideal gas part
         Evaluation result = Toolbox::createConstant(0.0);
 
         // residual part
-        for (int i = 0; i < 43; i++) {
-            result +=
-                n_r(i) *
-                I_r(i) *
-                J_r(i) *
-                Toolbox::pow(pi_, static_cast<Scalar>(I_r(i) - 1)) *
-                Toolbox::pow(tau_ - 0.5, static_cast<Scalar>(J_r(i) - 1));
+        for (int i = 0; i < 43; ++i) {
+            if (J_r_(i) < 1)
+                continue;
+            result += (n_r(i)*I_r(i)*J_r(i))*powPi[I_r_(i) - 1]*powTau[J_r_(i) - 1];
         }
 
         return result;
@@ -282,22 +270,19 @@ public:
     template <class Evaluation>
     static Evaluation ddgamma_ddpi(const Evaluation& temperature, const Evaluation& pressure)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
-
-        const Evaluation& tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation& pi_ = pi(pressure);    /* reduced pressure */
+        Evaluation powTau0[numPowersTau0_];
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powTau0, powPi, powTau, temperature, pressure);
 
         // ideal gas part
-        Evaluation result = -1/(pi_*pi_);
+        Evaluation result = -1/(powPi[1]*powPi[1]);
 
         // residual part
-        for (int i = 0; i < 43; i++) {
-            result +=
-                n_r(i) *
-                I_r(i) *
-                (I_r(i) - 1) *
-                Toolbox::pow(pi_, static_cast<Scalar>(I_r(i) - 2)) *
-                Toolbox::pow(tau_ - 0.5, static_cast<Scalar>(J_r(i)));
+        for (int i = 0; i < 43; ++i) {
+            if (I_r_(i) < 2)
+                continue;
+            result += (n_r(i)*I_r(i)*(I_r(i) - 1))*powPi[I_r_(i) - 2]*powTau[J_r_(i)];
         }
 
         return result;
@@ -320,34 +305,149 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation& pi_ = pi(pressure);    /* reduced pressure */
+        Evaluation powTau0[numPowersTau0_];
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powTau0, powPi, powTau, temperature, pressure);
 
         // ideal gas part
         Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 9; i++) {
-            result +=
-                n_g(i) *
-                J_g(i) *
-                (J_g(i) - 1) *
-                Toolbox::pow(tau_, static_cast<Scalar>(J_g(i) - 2));
-        }
+        for (int i = 0; i < 9; ++i)
+            result += (n_g(i)*J_g(i)*(J_g(i) - 1))*powTau0[J_g_(i) - 2 - minJ_g_];
 
         // residual part
-        for (int i = 0; i < 43; i++) {
-            result +=
-                n_r(i) *
-                Toolbox::pow(pi_,  I_r(i)) *
-                J_r(i) *
-                (J_r(i) - 1.) *
-                Toolbox::pow(tau_ - 0.5, static_cast<Scalar>(J_r(i) - 2));
+        for (int i = 0; i < 43; ++i) {
+            if (J_r_(i) < 2)
+                continue;
+            result += (n_r(i)*J_r(i)*(J_r(i) - 1))*powPi[I_r_(i)]*powTau[J_r_(i) - 2];
         }
 
         return result;
     }
 
+    /*!
+     * \brief The Gibbs free energy and all of its partial derivatives which are
+     *        defined for IAPWS region 2 (i.e. sub-critical steam) (dimensionless).
+     *
+     * This is equivalent to calling gamma(), dgamma_dtau(), dgamma_dpi(),
+     * ddgamma_dtaudpi(), ddgamma_ddpi() and ddgamma_ddtau(), but the powers of the
+     * reduced quantities are only computed once and all terms are evaluated in a
+     * single pass.
+     *
+     * \param temperature temperature of component in \f$\mathrm{[K]}\f$
+     * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
+     */
+    template <class Evaluation>
+    static void gammaAndDerivatives(Evaluation& gamma,
+                                    Evaluation& dgamma_dtau,
+                                    Evaluation& dgamma_dpi,
+                                    Evaluation& ddgamma_dtaudpi,
+                                    Evaluation& ddgamma_ddpi,
+                                    Evaluation& ddgamma_ddtau,
+                                    const Evaluation& temperature,
+                                    const Evaluation& pressure)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        Evaluation powTau0[numPowersTau0_];
+        Evaluation powPi[numPowersPi_];
+        Evaluation powTau[numPowersTau_];
+        computePowers_(powTau0, powPi, powTau, temperature, pressure);
+
+        // ideal gas part
+        const Evaluation& piInv = 1/powPi[1];
+        gamma = Toolbox::log(powPi[1]);
+        dgamma_dtau = Toolbox::createConstant(0.0);
+        dgamma_dpi = piInv;
+        ddgamma_dtaudpi = Toolbox::createConstant(0.0);
+        ddgamma_ddpi = -piInv*piInv;
+        ddgamma_ddtau = Toolbox::createConstant(0.0);
+        for (int i = 0; i < 9; ++i) {
+            const Scalar ni = n_g(i);
+            const Scalar Ji = J_g(i);
+            const int l = J_g_(i) - minJ_g_;
+
+            gamma += ni*powTau0[l];
+            dgamma_dtau += (ni*Ji)*powTau0[l - 1];
+            ddgamma_ddtau += (ni*Ji*(Ji - 1))*powTau0[l - 2];
+        }
+
+        // residual part
+        for (int i = 0; i < 43; ++i) {
+            const Scalar ni = n_r(i);
+            const Scalar Ii = I_r(i);
+            const Scalar Ji = J_r(i);
+            const int k = I_r_(i);
+            const int l = J_r_(i);
+
+            gamma += ni*powPi[k]*powTau[l];
+            dgamma_dpi += (ni*Ii)*powPi[k - 1]*powTau[l];
+            if (k >= 2)
+                ddgamma_ddpi += (ni*Ii*(Ii - 1))*powPi[k - 2]*powTau[l];
+            if (l >= 1) {
+                dgamma_dtau += (ni*Ji)*powPi[k]*powTau[l - 1];
+                ddgamma_dtaudpi += (ni*Ii*Ji)*powPi[k - 1]*powTau[l - 1];
+            }
+            if (l >= 2)
+                ddgamma_ddtau += (ni*Ji*(Ji - 1))*powPi[k]*powTau[l - 2];
+        }
+    }
 
 private:
+    // the range of the exponents of the powers of tau which appear in the ideal gas
+    // part of the equation and its derivatives
+    enum { minJ_g_ = -5 - 2 };
+    enum { maxJ_g_ = 3 };
+    enum { numPowersTau0_ = maxJ_g_ - minJ_g_ + 1 };
+
+    // the maximum exponents of pi and (tau - 0.5) in the residual part. since all
+    // exponents are non-negative, the terms whose derivatives would require
+    // negative powers vanish.
+    enum { maxI_r_ = 24 };
+    enum { maxJ_r_ = 58 };
+    enum { numPowersPi_ = maxI_r_ + 1 };
+    enum { numPowersTau_ = maxJ_r_ + 1 };
+
+    // compute all powers of tau, pi and (tau - 0.5) which are required by repeated
+    // multiplication. powTau0[j - minJ_g_] is tau^j.
+    template <class Evaluation>
+    static void computePowers_(Evaluation* powTau0,
+                               Evaluation* powPi,
+                               Evaluation* powTau,
+                               const Evaluation& temperature,
+                               const Evaluation& pressure)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        const Evaluation& tau_ = tau(temperature);
+        const Evaluation& pi_ = pi(pressure);
+        const Evaluation& y = tau_ - 0.5;
+
+        powTau0[-minJ_g_] = Toolbox::createConstant(1.0);
+        for (int l = 1; l <= maxJ_g_; ++l)
+            powTau0[l - minJ_g_] = powTau0[l - 1 - minJ_g_]*tau_;
+        const Evaluation& tauInv = 1.0/tau_;
+        for (int l = -1; l >= minJ_g_; --l)
+            powTau0[l - minJ_g_] = powTau0[l + 1 - minJ_g_]*tauInv;
+
+        powPi[0] = Toolbox::createConstant(1.0);
+        for (int k = 1; k <= maxI_r_; ++k)
+            powPi[k] = powPi[k - 1]*pi_;
+
+        powTau[0] = Toolbox::createConstant(1.0);
+        for (int l = 1; l <= maxJ_r_; ++l)
+            powTau[l] = powTau[l - 1]*y;
+    }
+
+    static int I_r_(int i)
+    { return static_cast<int>(I_r(i)); }
+
+    static int J_g_(int i)
+    { return static_cast<int>(J_g(i)); }
+
+    static int J_r_(int i)
+    { return static_cast<int>(J_r(i)); }
+
     static Scalar n_g(int i)
     {
         static const Scalar n[9] = {
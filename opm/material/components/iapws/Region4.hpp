@@ -27,7 +27,12 @@
 #ifndef OPM_IAPWS_REGION4_HPP
 #define OPM_IAPWS_REGION4_HPP
 
+#include "Common.hpp"
+
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/UniformMonotoneTable.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
 
 #include <cmath>
 
@@ -46,11 +51,71 @@ namespace IAPWS {
  * IAPWS: "Revised Release on the IAPWS Industrial Formulation
  * 1997 for the Thermodynamic Properties of Water and Steam",
  * http://www.iapws.org/relguide/IF97-Rev.pdf
+ *
+ * The saturation curve can optionally be tabulated between the triple and the critical
+ * point using tabulate(). Since the slopes of the tables are given by the derivatives
+ * of the relations, their error decreases with the fourth power of the spacing of the
+ * sampling points; for 1024 samples, the relative error of the saturation pressure is
+ * below \f$10^{-8}\f$ and the error of the saturation temperature is below
+ * \f$10^{-6}\,\mathrm{K}\f$.
  */
 template <class Scalar>
 class Region4
 {
+    typedef Opm::IAPWS::Common<Scalar> Common;
+    typedef Opm::UniformMonotoneTable<Scalar> Table;
+
+    class TabulationTag_;
+    typedef Opm::LocalAd::Evaluation<Scalar, TabulationTag_, 1> TabulationEval_;
+
 public:
+    /*!
+     * \brief Tabulate the saturation pressure and the saturation temperature.
+     *
+     * Afterwards, saturationPressure() and vaporTemperature() interpolate the tables
+     * between the triple and the critical point; outside of this range, the original
+     * relations are used. The saturation temperature is tabulated as a function of the
+     * fourth root of the pressure, which the relation of the IAPWS uses as well. Calling
+     * this method with less than two sampling points disables the tables.
+     *
+     * \param numSamples The number of sampling points of each table
+     */
+    static void tabulate(unsigned numSamples)
+    {
+        if (numSamples < 2) {
+            pressureTable_() = Table();
+            temperatureTable_() = Table();
+            return;
+        }
+
+        pressureTable_().init(Common::tripleTemperature, Common::criticalTemperature,
+                              numSamples,
+                              [](Scalar T)
+                              { return saturationPressureRelation_(T); },
+                              [](Scalar T)
+                              {
+                                  const auto& TEval = TabulationEval_::createVariable(T, 0);
+                                  return saturationPressureRelation_(TEval).derivatives[0];
+                              });
+
+        temperatureTable_().init(beta_(Common::triplePressure), beta_(Common::criticalPressure),
+                                 numSamples,
+                                 [](Scalar beta)
+                                 { return vaporTemperatureRelation_(betaToPressure_(beta)); },
+                                 [](Scalar beta)
+                                 {
+                                     const auto& betaEval = TabulationEval_::createVariable(beta, 0);
+                                     const auto& pEval = betaToPressure_(betaEval);
+                                     return vaporTemperatureRelation_(pEval).derivatives[0];
+                                 });
+    }
+
+    /*!
+     * \brief Returns true if the saturation curve is currently tabulated.
+     */
+    static bool isTabulated()
+    { return pressureTable_().isInitialized(); }
+
     /*!
      * \brief Returns the saturation pressure in \f$\mathrm{[Pa]}\f$ of pure water at a given
      *        temperature.
@@ -61,6 +126,34 @@ public:
      */
     template <class Evaluation>
     static Evaluation saturationPressure(const Evaluation& temperature)
+    {
+        const Table& table = pressureTable_();
+        if (applies_(table, temperature))
+            return table.eval(temperature);
+        return saturationPressureRelation_(temperature);
+    }
+
+    /*!
+     * \brief Returns the saturation temperature in \f$\mathrm{[K]}\f$ of pure water at a given
+     *        pressure.
+     *
+     * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
+     *
+     * The saturation pressure is often also called vapor pressure.
+     */
+    template <class Evaluation>
+    static Evaluation vaporTemperature(const Evaluation& pressure)
+    {
+        const Table& table = temperatureTable_();
+        const Evaluation& beta = beta_(pressure);
+        if (applies_(table, beta))
+            return table.eval(beta);
+        return vaporTemperatureRelation_(pressure);
+    }
+
+private:
+    template <class Evaluation>
+    static Evaluation saturationPressureRelation_(const Evaluation& temperature)
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
@@ -84,16 +177,8 @@ public:
         return 1e6*tmp;
     }
 
-    /*!
-     * \brief Returns the saturation temperature in \f$\mathrm{[K]}\f$ of pure water at a given
-     *        pressure.
-     *
-     * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
-     *
-     * The saturation pressure is often also called vapor pressure.
-     */
     template <class Evaluation>
-    static Evaluation vaporTemperature(const Evaluation& pressure)
+    static Evaluation vaporTemperatureRelation_(const Evaluation& pressure)
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
@@ -115,6 +200,47 @@ public:
 
         return temperature;
     }
+
+    // the fourth root of the pressure in MPa, which is the independent variable of the
+    // saturation temperature table
+    template <class Evaluation>
+    static Evaluation beta_(const Evaluation& pressure)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        return Toolbox::sqrt(Toolbox::sqrt(pressure/1e6));
+    }
+
+    template <class Evaluation>
+    static Evaluation betaToPressure_(const Evaluation& beta)
+    {
+        const Evaluation& beta2 = beta*beta;
+        return beta2*beta2*1e6;
+    }
+
+    template <class Evaluation>
+    static bool applies_(const Table& table, const Evaluation& x)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (!table.isInitialized())
+            return false;
+
+        Scalar xValue = Toolbox::value(x);
+        return table.xMin() <= xValue && xValue <= table.xMax();
+    }
+
+    static Table& pressureTable_()
+    {
+        static Table table;
+        return table;
+    }
+
+    static Table& temperatureTable_()
+    {
+        static Table table;
+        return table;
+    }
 };
 
 } // namespace IAPWS
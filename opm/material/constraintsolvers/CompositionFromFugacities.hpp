@@ -34,14 +34,33 @@
 #include <opm/material/common/ErrorMacros.hpp>
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/Valgrind.hpp>
-
+#include <opm/material/constraintsolvers/ConstraintSolverCorpus.hpp>
+#include <opm/material/constraintsolvers/ConstraintSolverStatus.hpp>
+#include <opm/material/constraintsolvers/ConstraintSolverTelemetry.hpp>
+#include <opm/material/fluidstates/CompositionalFluidState.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <limits>
+#include <stdexcept>
+#include <vector>
 
 namespace Opm {
 
 /*!
  * \brief Calculates the chemical equilibrium from the component
  *        fugacities in a phase.
+ *
+ * For phases which are not ideal mixtures, the composition is first updated by
+ * successive substitution, i.e., \f$x_\kappa \leftarrow f_\kappa/(\varphi_\kappa(y)
+ * p)\f$ where \f$y\f$ is the normalized composition, which is accelerated by
+ * extrapolating along the dominant eigenvalue of the iteration (GDEM). This does not
+ * require the Jacobian matrix and converges quickly if the fugacity coefficients
+ * depend only weakly on the composition. If the substitution does not converge fast
+ * enough or if the mole fractions of the result do not sum up to 1 (in which case
+ * the fugacity coefficients for the unnormalized composition differ), the solver
+ * switches to Newton's method.
  */
 template <class Scalar, class FluidSystem, class Evaluation = Scalar>
 class CompositionFromFugacities
@@ -53,6 +72,29 @@ class CompositionFromFugacities
 public:
     typedef Dune::FieldVector<Evaluation, numComponents> ComponentVector;
 
+    //! The outcome of the trySolve() method
+    typedef Opm::ConstraintSolverStatus<Scalar> SolverStatus;
+
+    //! The accuracy which is requested from the trySolve() and solve() methods
+    typedef Opm::ConstraintSolverTolerance<Scalar> SolverTolerance;
+
+    /*!
+     * \brief The number of iterations used by the individual strategies of solve().
+     */
+    struct IterationCounts
+    {
+        IterationCounts()
+            : substitution(0)
+            , newton(0)
+        {}
+
+        //! The number of successive substitution steps
+        int substitution;
+
+        //! The number of Newton iterations
+        int newton;
+    };
+
     /*!
      * \brief Guess an initial value for the composition of the phase.
      */
@@ -74,34 +116,288 @@ public:
         }
     }
 
+    /*!
+     * \brief Calculates the chemical equilibrium from the component
+     *        fugacities in a phase without throwing exceptions.
+     *
+     * This does the same as solve(), but if the calculation fails, this is reported
+     * by the returned status object instead of an exception. The number of
+     * iterations of the status is the total number of successive substitution steps
+     * and Newton iterations.
+     */
+    template <class FluidState>
+    static SolverStatus trySolve(FluidState &fluidState,
+                                 ParameterCache &paramCache,
+                                 int phaseIdx,
+                                 const ComponentVector &targetFug,
+                                 IterationCounts *iterationCounts = 0)
+    {
+        return trySolve(fluidState, paramCache, phaseIdx, targetFug, SolverTolerance(),
+                        iterationCounts);
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium from the component fugacities in a
+     *        phase using a requested accuracy and iteration budget without throwing
+     *        exceptions.
+     *
+     * The tolerance applies to the largest change of a mole fraction in the last
+     * iteration, its default is \f$10^{-9}\f$. The iteration budget limits the total
+     * number of successive substitution steps and Newton iterations. The achieved
+     * accuracy is returned as the residual of the status object, cf.
+     * ConstraintSolverTolerance.
+     */
+    template <class FluidState>
+    static SolverStatus trySolve(FluidState &fluidState,
+                                 ParameterCache &paramCache,
+                                 int phaseIdx,
+                                 const ComponentVector &targetFug,
+                                 const SolverTolerance& tolerance,
+                                 IterationCounts *iterationCounts = 0)
+    {
+        ConstraintSolverTelemetry* sink = telemetry();
+        ConstraintSolverCorpus* corpusSink = corpus();
+        if (!sink && !corpusSink)
+            return trySolve_(fluidState, paramCache, phaseIdx, targetFug, tolerance,
+                             iterationCounts, /*numClamped=*/nullptr);
+
+        // the initial composition is overwritten, so the input must be copied before
+        // it is known whether the call needs to be recorded
+        std::vector<double>* corpusInput = nullptr;
+        if (corpusSink) {
+            corpusInput = &corpusInput_();
+            captureInput_(*corpusInput, fluidState, phaseIdx, targetFug, tolerance);
+        }
+
+        ConstraintSolverTelemetry::Timer timer;
+        int numClamped = 0;
+        SolverStatus status =
+            trySolve_(fluidState, paramCache, phaseIdx, targetFug, tolerance, iterationCounts,
+                      &numClamped);
+        double seconds = timer.seconds();
+        if (sink)
+            sink->record(status, defectNorm_(fluidState, paramCache, phaseIdx, targetFug),
+                         numClamped, seconds);
+        if (corpusSink)
+            corpusSink->record(corpusName(), status, seconds, *corpusInput);
+        return status;
+    }
+
     /*!
      * \brief Calculates the chemical equilibrium from the component
      *        fugacities in a phase.
      *
-     * The phase's fugacities must already be set.
+     * The phase's fugacities must already be set. If iterationCounts is
+     * specified, the number of iterations required by each strategy is added to it.
+     * If the calculation fails, a NumericalIssue exception is thrown.
      */
     template <class FluidState>
     static void solve(FluidState &fluidState,
                       ParameterCache &paramCache,
                       int phaseIdx,
-                      const ComponentVector &targetFug)
+                      const ComponentVector &targetFug,
+                      IterationCounts *iterationCounts = 0)
+    { solve(fluidState, paramCache, phaseIdx, targetFug, SolverTolerance(), iterationCounts); }
+
+    /*!
+     * \brief Calculates the chemical equilibrium from the component fugacities in a
+     *        phase using a requested accuracy and iteration budget.
+     *
+     * If the requested accuracy is not reached within the iteration budget, a
+     * NumericalIssue exception is thrown.
+     */
+    template <class FluidState>
+    static void solve(FluidState &fluidState,
+                      ParameterCache &paramCache,
+                      int phaseIdx,
+                      const ComponentVector &targetFug,
+                      const SolverTolerance& tolerance,
+                      IterationCounts *iterationCounts = 0)
+    {
+        // save initial composition in case something goes wrong
+        Dune::FieldVector<Evaluation, numComponents> xInit;
+        for (int i = 0; i < numComponents; ++i) {
+            xInit[i] = fluidState.moleFraction(phaseIdx, i);
+        }
+
+        const SolverStatus& status =
+            trySolve(fluidState, paramCache, phaseIdx, targetFug, tolerance, iterationCounts);
+        if (status.converged())
+            return;
+
+        OPM_THROW(Opm::NumericalIssue,
+                  "Calculating the " << FluidSystem::phaseName(phaseIdx)
+                  << "Phase composition failed"
+                  << ((status.result == SolverStatus::SingularMatrix)?" (singular Jacobian matrix)":"")
+                  << ". Initial {x} = {"
+                  << xInit
+                  << "}, {fug_t} = {" << targetFug << "}, p = " << fluidState.pressure(phaseIdx)
+                  << ", T = " << fluidState.temperature(phaseIdx));
+    }
+
+    /*!
+     * \brief Attach a telemetry object to the solver.
+     *
+     * If the telemetry object is not null, each call of trySolve() and solve() records
+     * its total number of iterations, the defect of the final composition, the number
+     * of Newton iterations in which the update was clamped and its wall time. The
+     * defect is the sum of the deviations of the mole fractions from the ones which
+     * are given by the fugacity coefficients of the final composition. The object is
+     * used by all threads and must stay alive until it is detached by passing a null
+     * pointer.
+     */
+    static void setTelemetry(ConstraintSolverTelemetry* telemetry)
+    { telemetry_.store(telemetry, std::memory_order_release); }
+
+    /*!
+     * \brief Returns the telemetry object which is attached to the solver.
+     *
+     * If no telemetry object is attached, a null pointer is returned.
+     */
+    static ConstraintSolverTelemetry* telemetry()
+    { return telemetry_.load(std::memory_order_acquire); }
+
+    /*!
+     * \brief Attach a corpus to the solver.
+     *
+     * If the corpus is not null, the inputs of the calls of trySolve() and solve()
+     * which are difficult (cf. ConstraintSolverCorpus) are recorded, so that they can
+     * be repeated using replay(). The object is used by all threads and must stay
+     * alive until it is detached by passing a null pointer.
+     */
+    static void setCorpus(ConstraintSolverCorpus* corpus)
+    { corpus_.store(corpus, std::memory_order_release); }
+
+    /*!
+     * \brief Returns the corpus which is attached to the solver.
+     *
+     * If no corpus is attached, a null pointer is returned.
+     */
+    static ConstraintSolverCorpus* corpus()
+    { return corpus_.load(std::memory_order_acquire); }
+
+    /*!
+     * \brief The name of the solver in the records of a ConstraintSolverCorpus.
+     */
+    static const char* corpusName()
+    { return "CompositionFromFugacities"; }
+
+    /*!
+     * \brief Repeat a calculation which was recorded by a corpus.
+     *
+     * The calculation is started from the initial composition of the recorded call,
+     * using the tolerance and the iteration budget of that call. The record must have
+     * been captured using the same fluid system. Only the temperature, the pressure
+     * and the composition of the recorded phase are set; the remaining quantities of
+     * the fluid state are not modified. Neither the attached telemetry object nor the
+     * attached corpus record the replayed call. If the record is not compatible with
+     * the solver, a std::runtime_error is thrown.
+     *
+     * \param fluidState The fluid state which receives the result
+     * \param record The record of the call
+     */
+    static SolverStatus replay(CompositionalFluidState<Evaluation, FluidSystem>& fluidState,
+                               const ConstraintSolverCorpus::Record& record)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (record.solver != corpusName()
+            || record.input.size() != static_cast<size_t>(corpusInputSize_()))
+            OPM_THROW(std::runtime_error,
+                      "The record of the " << record.solver << " solver with "
+                      << record.input.size() << " inputs can not be replayed by "
+                      << corpusName() << " for " << numComponents << " components");
+
+        const double* input = record.input.data();
+        SolverTolerance tolerance(input[0], static_cast<int>(input[1]));
+        int phaseIdx = static_cast<int>(input[2]);
+        if (phaseIdx < 0 || phaseIdx >= FluidSystem::numPhases)
+            OPM_THROW(std::runtime_error,
+                      "The record of the " << corpusName() << " solver refers to phase "
+                      << phaseIdx);
+        input += 3;
+
+        fluidState.setTemperature(Toolbox::createConstant(*input++));
+        fluidState.setPressure(phaseIdx, Toolbox::createConstant(*input++));
+        ComponentVector targetFug;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            targetFug[compIdx] = Toolbox::createConstant(*input++);
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            fluidState.setMoleFraction(phaseIdx, compIdx, Toolbox::createConstant(*input++));
+
+        ParameterCache paramCache;
+        paramCache.updatePhase(fluidState, phaseIdx);
+        return trySolve_(fluidState, paramCache, phaseIdx, targetFug, tolerance,
+                         /*iterationCounts=*/0, /*numClamped=*/nullptr);
+    }
+
+protected:
+    // the number of inputs of a call in the records of a corpus: tolerance and
+    // iteration budget, phase index, temperature, pressure, target fugacities and
+    // initial composition
+    static int corpusInputSize_()
+    { return 5 + 2*numComponents; }
+
+    // the buffer which receives the input of a call if a corpus is attached
+    static std::vector<double>& corpusInput_()
+    {
+        static thread_local std::vector<double> input;
+        return input;
+    }
+
+    template <class FluidState>
+    static void captureInput_(std::vector<double>& input,
+                              const FluidState& fluidState,
+                              int phaseIdx,
+                              const ComponentVector& targetFug,
+                              const SolverTolerance& tolerance)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        input.clear();
+        input.push_back(tolerance.tolerance);
+        input.push_back(tolerance.maxIterations);
+        input.push_back(phaseIdx);
+        input.push_back(FsToolbox::value(fluidState.temperature(phaseIdx)));
+        input.push_back(FsToolbox::value(fluidState.pressure(phaseIdx)));
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            input.push_back(Toolbox::value(targetFug[compIdx]));
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            input.push_back(FsToolbox::value(fluidState.moleFraction(phaseIdx, compIdx)));
+    }
+
+    // the substitution and Newton iterations of trySolve(). if numClamped is not null,
+    // the number of Newton iterations in which the update was clamped is added to it.
+    template <class FluidState>
+    static SolverStatus trySolve_(FluidState &fluidState,
+                                  ParameterCache &paramCache,
+                                  int phaseIdx,
+                                  const ComponentVector &targetFug,
+                                  const SolverTolerance& tolerance,
+                                  IterationCounts *iterationCounts,
+                                  int* numClamped)
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
+        const Scalar tol = tolerance.toleranceOr(1e-9);
+        const int maxIterations = tolerance.maxIterationsOr(std::numeric_limits<int>::max());
+
+        SolverStatus status;
+
         // use a much more efficient method in case the phase is an
         // ideal mixture
         if (FluidSystem::isIdealMixture(phaseIdx)) {
             solveIdealMix_(fluidState, paramCache, phaseIdx, targetFug);
-            return;
+            status.result = SolverStatus::Converged;
+            status.residual = 0.0;
+            return status;
         }
 
-        //Dune::FMatrixPrecision<Scalar>::set_singular_limit(1e-25);
-
-        // save initial composition in case something goes wrong
-        Dune::FieldVector<Evaluation, numComponents> xInit;
-        for (int i = 0; i < numComponents; ++i) {
-            xInit[i] = fluidState.moleFraction(phaseIdx, i);
-        }
+        IterationCounts dummyCounts;
+        if (!iterationCounts)
+            iterationCounts = &dummyCounts;
+        const int initialIterations = iterationCounts->substitution + iterationCounts->newton;
 
         /////////////////////////
         // Newton method
@@ -116,73 +412,210 @@ public:
 
         paramCache.updatePhase(fluidState, phaseIdx);
 
-        // maximum number of iterations
-        const int nMax = 25;
+        if (solveSubstitution_(fluidState, paramCache, phaseIdx, targetFug,
+                               tol, maxIterations, *iterationCounts, status.residual)) {
+            const Evaluation& rho = FluidSystem::density(fluidState, paramCache, phaseIdx);
+            fluidState.setDensity(phaseIdx, rho);
+            status.result = SolverStatus::Converged;
+            status.iterations = iterationCounts->substitution + iterationCounts->newton - initialIterations;
+            return status;
+        }
+
+        // maximum number of iterations. the substitution steps count against the
+        // iteration budget.
+        const int numSubstitutions =
+            iterationCounts->substitution + iterationCounts->newton - initialIterations;
+        const int nMax = std::min(25, maxIterations - numSubstitutions);
         for (int nIdx = 0; nIdx < nMax; ++nIdx) {
+            ++ iterationCounts->newton;
+            status.iterations = iterationCounts->substitution + iterationCounts->newton - initialIterations;
+
             // calculate Jacobian matrix and right hand side
             linearize_(J, b, fluidState, paramCache, phaseIdx, targetFug);
             Valgrind::CheckDefined(J);
             Valgrind::CheckDefined(b);
 
-            /*
-            std::cout << FluidSystem::phaseName(phaseIdx) << "Phase composition: ";
-            for (int i = 0; i < FluidSystem::numComponents; ++i)
-                std::cout << fluidState.moleFraction(phaseIdx, i) << " ";
-            std::cout << "\n";
-            std::cout << FluidSystem::phaseName(phaseIdx) << "Phase phi: ";
-            for (int i = 0; i < FluidSystem::numComponents; ++i)
-                std::cout << fluidState.fugacityCoefficient(phaseIdx, i) << " ";
-            std::cout << "\n";
-            */
-
             // Solve J*x = b
             x = Toolbox::createConstant(0.0);
-            try { J.solve(x, b); }
-            catch (Dune::FMatrixError e)
-            { throw Opm::NumericalIssue(e.what()); }
-
-            //std::cout << "original delta: " << x << "\n";
-
+            if (!solveLinearSystemNoThrow(J, x, b, Scalar(1e-25))) {
+                status.result = SolverStatus::SingularMatrix;
+                return status;
+            }
             Valgrind::CheckDefined(x);
-
-            /*
-            std::cout << FluidSystem::phaseName(phaseIdx) << "Phase composition: ";
-            for (int i = 0; i < FluidSystem::numComponents; ++i)
-                std::cout << fluidState.moleFraction(phaseIdx, i) << " ";
-            std::cout << "\n";
-            std::cout << "J: " << J << "\n";
-            std::cout << "rho: " << fluidState.density(phaseIdx) << "\n";
-            std::cout << "delta: " << x << "\n";
-            std::cout << "defect: " << b << "\n";
-
-            std::cout << "J: " << J << "\n";
-
-            std::cout << "---------------------------\n";
-            */
+            if (!isFiniteVector(x)) {
+                status.result = SolverStatus::NotConverged;
+                return status;
+            }
 
             // update the fluid composition. b is also used to store
             // the defect for the next iteration.
-            Scalar relError = update_(fluidState, paramCache, x, b, phaseIdx, targetFug);
+            Scalar relError = update_(fluidState, paramCache, x, b, phaseIdx, targetFug, numClamped);
+            status.residual = relError;
 
-            if (relError < 1e-9) {
+            if (relError < tol) {
                 const Evaluation& rho = FluidSystem::density(fluidState, paramCache, phaseIdx);
                 fluidState.setDensity(phaseIdx, rho);
 
-                //std::cout << "num iterations: " << nIdx << "\n";
-                return;
+                status.result = SolverStatus::Converged;
+                return status;
             }
         }
 
-        OPM_THROW(Opm::NumericalIssue,
-                  "Calculating the " << FluidSystem::phaseName(phaseIdx)
-                  << "Phase composition failed. Initial {x} = {"
-                  << xInit
-                  << "}, {fug_t} = {" << targetFug << "}, p = " << fluidState.pressure(phaseIdx)
-                  << ", T = " << fluidState.temperature(phaseIdx));
+        status.result = SolverStatus::NotConverged;
+        return status;
     }
 
+    // try to find the composition using accelerated successive substitution. returns
+    // true if the iteration converged; in this case, the size of the last step is
+    // stored in residual. if it does not converge quickly, false is returned. In this
+    // case, the last composition is used as the starting point for Newton's method if
+    // the substitution made significant progress, else the initial composition is
+    // restored.
+    template <class FluidState>
+    static bool solveSubstitution_(FluidState &fluidState,
+                                   ParameterCache &paramCache,
+                                   int phaseIdx,
+                                   const ComponentVector &targetFug,
+                                   Scalar tolerance,
+                                   int maxIterations,
+                                   IterationCounts &iterationCounts,
+                                   Scalar &residual)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        // maximum number of substitution steps before switching to Newton's method
+        const int nMax = std::min(20, maxIterations);
+        // the substitution is considered to be too slow if the update is reduced by
+        // less than this factor per step
+        const Scalar maxContraction = 0.7;
+
+        ComponentVector xInit;
+        for (int i = 0; i < numComponents; ++i)
+            xInit[i] = fluidState.moleFraction(phaseIdx, i);
+
+        ComponentVector delta;
+        ComponentVector prevDelta;
+        Scalar firstDeltaNorm = 0.0;
+        Scalar prevDeltaNorm = std::numeric_limits<Scalar>::max();
+        bool havePrevDelta = false;
+        for (int nIdx = 0; nIdx < nMax; ++nIdx) {
+            ++ iterationCounts.substitution;
+
+            // calculate the fugacity coefficients for the normalized composition.
+            // (the mole fractions must be positive for the substitution to work, so
+            // using their sum instead of the sum of their absolute values is fine.)
+            ComponentVector x;
+            Evaluation sumx = 0.0;
+            for (int i = 0; i < numComponents; ++i) {
+                x[i] = fluidState.moleFraction(phaseIdx, i);
+                sumx += x[i];
+            }
+            if (!(sumx > 0.0))
+                break;
+
+            for (int i = 0; i < numComponents; ++i)
+                fluidState.setMoleFraction(phaseIdx, i, x[i]/sumx);
+            paramCache.updateComposition(fluidState, phaseIdx);
+            typename FluidState::Scalar phi[numComponents];
+            FluidSystem::fugacityCoefficients(fluidState, paramCache, phaseIdx, phi);
+            for (int i = 0; i < numComponents; ++i)
+                fluidState.setFugacityCoefficient(phaseIdx, i, phi[i]);
+            for (int i = 0; i < numComponents; ++i)
+                fluidState.setMoleFraction(phaseIdx, i, x[i]);
+
+            // calculate the substitution step
+            Scalar deltaNorm = 0.0;
+            for (int i = 0; i < numComponents; ++i) {
+                const Evaluation& phi = fluidState.fugacityCoefficient(phaseIdx, i);
+                delta[i] = targetFug[i]/(phi*fluidState.pressure(phaseIdx)) - x[i];
+                deltaNorm = std::max(deltaNorm, std::abs(Toolbox::value(delta[i])));
+            }
+
+            // give up if the substitution diverges
+            if (!std::isfinite(deltaNorm) || deltaNorm >= prevDeltaNorm)
+                break;
+            if (nIdx == 0)
+                firstDeltaNorm = deltaNorm;
+
+            addToComposition_(fluidState, phaseIdx, delta, targetFug);
+            paramCache.updateComposition(fluidState, phaseIdx);
+
+            if (deltaNorm < tolerance) {
+                residual = deltaNorm;
+
+                // the fugacity coefficients were calculated for the normalized
+                // composition, so the result is only a solution if the mole
+                // fractions sum up to 1. If not, the composition is a very good
+                // starting point for Newton's method.
+                Evaluation sumxNew = 0.0;
+                for (int i = 0; i < numComponents; ++i)
+                    sumxNew += fluidState.moleFraction(phaseIdx, i);
+                return std::abs(Toolbox::value(sumxNew) - 1.0) < tolerance;
+            }
+
+            if (havePrevDelta) {
+                if (deltaNorm > maxContraction*prevDeltaNorm)
+                    break;
+
+                // estimate the dominant eigenvalue of the iteration and extrapolate
+                // the remaining steps
+                Evaluation num = 0.0;
+                Evaluation denom = 0.0;
+                for (int i = 0; i < numComponents; ++i) {
+                    num += delta[i]*prevDelta[i];
+                    denom += prevDelta[i]*prevDelta[i];
+                }
+                Scalar lambda = Toolbox::value(num)/Toolbox::value(denom);
+                if (0.0 < lambda && lambda < 1.0) {
+                    delta *= lambda/(1.0 - lambda);
+                    addToComposition_(fluidState, phaseIdx, delta, targetFug);
+                    paramCache.updateComposition(fluidState, phaseIdx);
+
+                    // the next step is based on the extrapolated composition, so it
+                    // must not be used to estimate the eigenvalue
+                    havePrevDelta = false;
+                    prevDeltaNorm = deltaNorm;
+                    continue;
+                }
+            }
+
+            prevDelta = delta;
+            prevDeltaNorm = deltaNorm;
+            havePrevDelta = true;
+        }
+
+        if (!(prevDeltaNorm < 0.1*firstDeltaNorm)) {
+            for (int i = 0; i < numComponents; ++i)
+                fluidState.setMoleFraction(phaseIdx, i, xInit[i]);
+            paramCache.updateComposition(fluidState, phaseIdx);
+        }
+
+        return false;
+    }
+
+    // add an update to the composition of the phase, obeying the sign of the target
+    // fugacities
+    template <class FluidState>
+    static void addToComposition_(FluidState &fluidState,
+                                  int phaseIdx,
+                                  const ComponentVector &delta,
+                                  const ComponentVector &targetFug)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        for (int i = 0; i < numComponents; ++i) {
+            Evaluation newx = fluidState.moleFraction(phaseIdx, i) + delta[i];
+            if (targetFug[i] > 0)
+                newx = Toolbox::max(0.0, newx);
+            else if (targetFug[i] < 0)
+                newx = Toolbox::min(0.0, newx);
+            else
+                newx = 0;
+
+            fluidState.setMoleFraction(phaseIdx, i, newx);
+        }
+    }
 
-protected:
     // update the phase composition in case the phase is an ideal
     // mixture, i.e. the component's fugacity coefficients are
     // independent of the phase's composition.
@@ -292,7 +725,8 @@ protected:
                           Dune::FieldVector<Evaluation, numComponents> &x,
                           Dune::FieldVector<Evaluation, numComponents> &b,
                           int phaseIdx,
-                          const Dune::FieldVector<Evaluation, numComponents> &targetFug)
+                          const Dune::FieldVector<Evaluation, numComponents> &targetFug,
+                          int* numClamped = nullptr)
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
@@ -311,8 +745,11 @@ protected:
 
         // chop update to at most 20% change in composition
         const Scalar maxDelta = 0.2;
-        if (sumDelta > maxDelta)
+        bool clamped = false;
+        if (sumDelta > maxDelta) {
             x /= (sumDelta/maxDelta);
+            clamped = true;
+        }
 
         // change composition
         for (int i = 0; i < numComponents; ++i) {
@@ -326,12 +763,16 @@ protected:
             // if the target fugacity is zero, the mole fraction must also be zero
             else
                 newx = 0;
+            clamped = clamped || Toolbox::value(newx) != Toolbox::value(origComp[i] - x[i]);
 
             fluidState.setMoleFraction(phaseIdx, i, newx);
         }
 
         paramCache.updateComposition(fluidState, phaseIdx);
 
+        if (numClamped && clamped)
+            ++(*numClamped);
+
         return relError;
     }
 
@@ -351,8 +792,41 @@ protected:
         };
         return result;
     }
+
+    // returns sum_i |f_i/(phi_i p) - x_i| for the fugacity coefficients phi_i of the
+    // current composition. the fluid state is not modified.
+    template <class FluidState>
+    static Scalar defectNorm_(const FluidState &fluidState,
+                              const ParameterCache &paramCache,
+                              int phaseIdx,
+                              const ComponentVector &targetFug)
+    {
+        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        typename FluidState::Scalar phi[numComponents];
+        FluidSystem::fugacityCoefficients(fluidState, paramCache, phaseIdx, phi);
+
+        Scalar p = FsToolbox::value(fluidState.pressure(phaseIdx));
+        Scalar result = 0.0;
+        for (int i = 0; i < numComponents; ++i)
+            result += std::abs(Toolbox::value(targetFug[i])/(FsToolbox::value(phi[i])*p)
+                               - FsToolbox::value(fluidState.moleFraction(phaseIdx, i)));
+        return result;
+    }
+
+    static std::atomic<ConstraintSolverTelemetry*> telemetry_;
+    static std::atomic<ConstraintSolverCorpus*> corpus_;
 }; // namespace Opm
 
+template <class Scalar, class FluidSystem, class Evaluation>
+std::atomic<ConstraintSolverTelemetry*>
+CompositionFromFugacities<Scalar, FluidSystem, Evaluation>::telemetry_(nullptr);
+
+template <class Scalar, class FluidSystem, class Evaluation>
+std::atomic<ConstraintSolverCorpus*>
+CompositionFromFugacities<Scalar, FluidSystem, Evaluation>::corpus_(nullptr);
+
 } // end namespace Opm
 
 #endif
@@ -29,6 +29,7 @@
 
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
 #include <opm/material/common/Valgrind.hpp>
 
 #include <dune/common/fvector.hh>
@@ -168,6 +169,87 @@ public:
                                                              phaseIdx));
         }
     }
+
+    /*!
+     * \brief Computes all quantities of an array of fluid states if a reference
+     *        phase has been specified.
+     *
+     * This is equivalent to calling solve() for each fluid state, but if all
+     * non-reference phases are ideal mixtures, the work is done in stages for the
+     * whole array: First the fugacity coefficients of all fluid states are
+     * calculated using the computeAllBatch() method of the fluid system, then the
+     * compositions of the non-reference phases are updated by a loop over the fluid
+     * states and finally the remaining quantities are calculated by computeAllBatch()
+     * again. Since the fugacity coefficients of ideal mixtures do not depend on the
+     * composition, no iterations are required. If any of the non-reference phases is
+     * not an ideal mixture, solve() is called for each fluid state.
+     *
+     * \param fluidStates The array of the thermodynamic states of the fluids
+     * \param paramCaches The array of the parameter caches of the fluid states
+     * \param n The number of fluid states
+     * \param refPhaseIdx The phase index of the reference phase
+     * \param setViscosity Specify whether the dynamic viscosity of
+     *                     each phase should also be set.
+     * \param setEnthalpy Specify whether the specific
+     *                    enthalpy/internal energy of each phase
+     *                    should also be set.
+     */
+    template <class FluidState, class ParameterCache>
+    static void solveBatch(FluidState *fluidStates,
+                           ParameterCache *paramCaches,
+                           size_t n,
+                           int refPhaseIdx,
+                           bool setViscosity,
+                           bool setEnthalpy)
+    {
+        OPM_PROFILER_RANGE("ComputeFromReferencePhase::solveBatch");
+
+        typedef typename FluidState::Scalar FsEvaluation;
+
+        bool allIdealMixtures = true;
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            if (phaseIdx != refPhaseIdx && !FluidSystem::isIdealMixture(phaseIdx))
+                allIdealMixtures = false;
+
+        if (!allIdealMixtures) {
+            for (size_t i = 0; i < n; ++i)
+                solve(fluidStates[i], paramCaches[i], refPhaseIdx, setViscosity, setEnthalpy);
+            return;
+        }
+
+        // the fugacity coefficients of all phases. since all non-reference phases
+        // are ideal mixtures, they are valid for the compositions calculated below
+        for (size_t i = 0; i < n; ++i)
+            paramCaches[i].updateAll(fluidStates[i]);
+        FluidSystem::computeAllBatch(fluidStates, paramCaches, n, FluidSystem::FugacityCoefficients);
+
+        // the fugacity of each component is the same in all phases, i.e., x_alpha =
+        // x_ref*phi_ref*p_ref/(phi_alpha*p_alpha)
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (phaseIdx == refPhaseIdx)
+                continue;
+
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+                for (size_t i = 0; i < n; ++i) {
+                    FluidState& fs = fluidStates[i];
+                    const FsEvaluation& x =
+                        fs.fugacity(refPhaseIdx, compIdx)
+                        / (fs.fugacityCoefficient(phaseIdx, compIdx)*fs.pressure(phaseIdx));
+                    fs.setMoleFraction(phaseIdx, compIdx, x);
+                }
+            }
+
+            for (size_t i = 0; i < n; ++i)
+                paramCaches[i].updateComposition(fluidStates[i], phaseIdx);
+        }
+
+        int quantities = FluidSystem::Density;
+        if (setViscosity)
+            quantities |= FluidSystem::Viscosity;
+        if (setEnthalpy)
+            quantities |= FluidSystem::Enthalpy;
+        FluidSystem::computeAllBatch(fluidStates, paramCaches, n, quantities);
+    }
 };
 
 } // namespace Opm
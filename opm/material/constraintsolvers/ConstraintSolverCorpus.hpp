@@ -0,0 +1,285 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::ConstraintSolverCorpus
+ */
+#ifndef OPM_CONSTRAINT_SOLVER_CORPUS_HPP
+#define OPM_CONSTRAINT_SOLVER_CORPUS_HPP
+
+#include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/constraintsolvers/ConstraintSolverStatus.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Collects the inputs of the difficult calls of a constraint solver, so that
+ *        they can be replayed later.
+ *
+ * Difficult problems, e.g., mixtures close to their critical point or states at
+ * which a phase appears, are rare but they dominate the cost of the flash solvers.
+ * If a corpus object is attached to a solver (e.g., using NcpFlash::setCorpus()),
+ * each call of the solver's trySolve() or solve() methods which fails, which needs
+ * at least a given number of iterations or which takes at least a given wall time
+ * is recorded. A record consists of the name of the solver, its outcome and the
+ * input of the call, i.e., everything which is required to repeat the call using the
+ * replay() method of the solver, for example NcpFlash::replay().
+ *
+ * Corpora can be written to and read from a text file, so that the problems which
+ * were encountered by a simulation can be used for performance tracking and
+ * regression tests of the solvers; cf. the benchmark_flashcorpus program. Each record
+ * is stored as one line of the file which consists of the name of the solver, the
+ * result, the number of iterations, the wall time in seconds, the number of input
+ * values and the input values themselves. Lines which start with '#' are comments.
+ *
+ * The corpus can be shared by all threads. If no corpus is attached, the solvers do
+ * not do any additional work; if one is attached, they need to copy their input
+ * before each call.
+ */
+class ConstraintSolverCorpus
+{
+public:
+    /*!
+     * \brief The input and the outcome of a single solver call.
+     */
+    struct Record
+    {
+        Record()
+            : result(0)
+            , iterations(0)
+            , seconds(0.0)
+        {}
+
+        //! The name of the solver, e.g., "NcpFlash"
+        std::string solver;
+
+        //! The outcome of the call, i.e., a ConstraintSolverStatus::Result
+        int result;
+
+        //! The number of iterations of the call
+        int iterations;
+
+        //! The wall time of the call
+        double seconds;
+
+        //! The input of the call. Its layout is defined by the solver.
+        std::vector<double> input;
+    };
+
+    /*!
+     * \brief Create an empty corpus.
+     *
+     * \param minIterations The minimum number of iterations of a call which is
+     *                      recorded even if it succeeds
+     * \param minSeconds The minimum wall time of a call which is recorded even if it
+     *                   succeeds
+     * \param maxRecords The maximum number of records. Further calls are discarded.
+     */
+    explicit ConstraintSolverCorpus(int minIterations = 20,
+                                    double minSeconds = std::numeric_limits<double>::infinity(),
+                                    size_t maxRecords = 100000)
+        : minIterations_(minIterations)
+        , minSeconds_(minSeconds)
+        , maxRecords_(maxRecords)
+    {}
+
+    /*!
+     * \brief Returns true if a solver call with a given outcome is recorded.
+     */
+    template <class Scalar>
+    bool isDifficult(const ConstraintSolverStatus<Scalar>& status, double seconds) const
+    {
+        return
+            !status.converged()
+            || status.iterations >= minIterations_
+            || seconds >= minSeconds_;
+    }
+
+    /*!
+     * \brief Record a solver call if it was difficult.
+     *
+     * \param solver The name of the solver
+     * \param status The status which was returned by the solver
+     * \param seconds The wall time of the call
+     * \param input The input of the call
+     */
+    template <class Scalar>
+    void record(const char* solver,
+                const ConstraintSolverStatus<Scalar>& status,
+                double seconds,
+                const std::vector<double>& input)
+    {
+        if (!isDifficult(status, seconds))
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (records_.size() >= maxRecords_)
+            return;
+
+        records_.push_back(Record());
+        Record& rec = records_.back();
+        rec.solver = solver;
+        rec.result = status.result;
+        rec.iterations = status.iterations;
+        rec.seconds = seconds;
+        rec.input = input;
+    }
+
+    /*!
+     * \brief Returns the number of records.
+     */
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return records_.size();
+    }
+
+    /*!
+     * \brief Returns the records.
+     *
+     * This must not be called while a solver records into the corpus.
+     */
+    const std::vector<Record>& records() const
+    { return records_; }
+
+    /*!
+     * \brief Remove all records.
+     */
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        records_.clear();
+    }
+
+    /*!
+     * \brief Write all records to a stream.
+     */
+    void write(std::ostream& os) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        os << "# solver result iterations seconds numInputs inputs...\n";
+        std::ostringstream line;
+        line << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+        for (size_t recIdx = 0; recIdx < records_.size(); ++recIdx) {
+            const Record& rec = records_[recIdx];
+            line.str("");
+            line << rec.solver
+                 << " " << rec.result
+                 << " " << rec.iterations
+                 << " " << rec.seconds
+                 << " " << rec.input.size();
+            for (size_t i = 0; i < rec.input.size(); ++i)
+                line << " " << rec.input[i];
+            os << line.str() << "\n";
+        }
+    }
+
+    /*!
+     * \brief Append the records which are contained by a stream.
+     *
+     * If a line cannot be parsed, a std::runtime_error is thrown.
+     */
+    void read(std::istream& is)
+    {
+        std::vector<Record> newRecords;
+        std::string line;
+        int lineIdx = 0;
+        while (std::getline(is, line)) {
+            ++ lineIdx;
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            std::istringstream iss(line);
+            Record rec;
+            size_t numInputs = 0;
+            iss >> rec.solver >> rec.result >> rec.iterations >> rec.seconds >> numInputs;
+            rec.input.resize(numInputs);
+            bool valid = static_cast<bool>(iss);
+            for (size_t i = 0; valid && i < numInputs; ++i) {
+                // the inputs of failed calls may be non-finite, which cannot be read
+                // by the stream operators
+                std::string token;
+                iss >> token;
+                char* end = 0;
+                rec.input[i] = std::strtod(token.c_str(), &end);
+                valid = !token.empty() && *end == '\0';
+            }
+            if (!valid)
+                OPM_THROW(std::runtime_error,
+                          "Invalid record of a constraint solver corpus in line " << lineIdx);
+            newRecords.push_back(rec);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        records_.insert(records_.end(), newRecords.begin(), newRecords.end());
+    }
+
+    /*!
+     * \brief Write all records to a file.
+     */
+    void save(const std::string& fileName) const
+    {
+        std::ofstream os(fileName.c_str());
+        if (!os)
+            OPM_THROW(std::runtime_error, "Could not open the file '" << fileName << "' for writing");
+        write(os);
+    }
+
+    /*!
+     * \brief Append the records which are contained by a file.
+     */
+    void load(const std::string& fileName)
+    {
+        std::ifstream is(fileName.c_str());
+        if (!is)
+            OPM_THROW(std::runtime_error, "Could not open the file '" << fileName << "'");
+        read(is);
+    }
+
+private:
+    ConstraintSolverCorpus(const ConstraintSolverCorpus&);
+    ConstraintSolverCorpus& operator=(const ConstraintSolverCorpus&);
+
+    int minIterations_;
+    double minSeconds_;
+    size_t maxRecords_;
+
+    mutable std::mutex mutex_;
+    std::vector<Record> records_;
+};
+
+} // namespace Opm
+
+#endif
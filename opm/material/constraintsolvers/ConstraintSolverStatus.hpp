@@ -0,0 +1,295 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::ConstraintSolverStatus
+ */
+#ifndef OPM_CONSTRAINT_SOLVER_STATUS_HPP
+#define OPM_CONSTRAINT_SOLVER_STATUS_HPP
+
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/SmallLuDecomposition.hpp>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/fmatrix.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+namespace Opm {
+
+/*!
+ * \brief The outcome of a constraint solver which was called using one of its
+ *        trySolve() methods.
+ *
+ * In contrast to solve(), the trySolve() methods do not throw exceptions if the
+ * solver fails. Instead the reason of the failure is reported by this object, so
+ * that failures can be dealt with cheaply, e.g., by collecting them for a whole
+ * batch of cells inside of a parallel loop.
+ */
+template <class Scalar>
+struct ConstraintSolverStatus
+{
+    enum Result {
+        //! The solver converged
+        Converged,
+
+        //! The maximum number of iterations was reached without converging or the
+        //! iteration produced non-finite values
+        NotConverged,
+
+        //! A linear system which had to be solved was singular
+        SingularMatrix
+    };
+
+    ConstraintSolverStatus()
+        : result(NotConverged)
+        , iterations(0)
+        , residual(std::numeric_limits<Scalar>::quiet_NaN())
+    {}
+
+    //! Returns true if the solver converged
+    bool converged() const
+    { return result == Converged; }
+
+    //! The outcome of the solver
+    Result result;
+
+    //! The number of iterations which were performed
+    int iterations;
+
+    /*!
+     * \brief The error measure of the last iteration.
+     *
+     * For the Newton solvers, this is the relative size of the last update. It is NaN
+     * if no iteration was performed.
+     */
+    Scalar residual;
+};
+
+/*!
+ * \brief The accuracy which is requested from a constraint solver.
+ *
+ * By default, the solvers iterate until a fixed tight tolerance is reached. If they
+ * are called within the iterations of an outer Newton method, this precision is
+ * wasted as long as the outer method is far from convergence. Objects of this class
+ * allow to relax the tolerance of a solver in proportion to the residual of the outer
+ * method and to limit the number of iterations which it may spend. The accuracy which
+ * was actually achieved is reported by ConstraintSolverStatus::residual.
+ */
+template <class Scalar>
+struct ConstraintSolverTolerance
+{
+    //! Request the default accuracy and iteration limit of the solver
+    ConstraintSolverTolerance()
+        : tolerance(0.0)
+        , maxIterations(0)
+    {}
+
+    ConstraintSolverTolerance(Scalar tol, int maxIter)
+        : tolerance(tol)
+        , maxIterations(maxIter)
+    {}
+
+    /*!
+     * \brief Returns a tolerance which is proportional to the residual of an outer
+     *        iteration.
+     *
+     * The tolerance is relativeTolerance times the outer residual, but it is never
+     * larger than maxTolerance. Since tolerances which are not positive select the
+     * default of the solver, the exact solution is requested once the outer residual
+     * is zero.
+     *
+     * \param outerResidual The residual of the outer iteration
+     * \param relativeTolerance The ratio of the tolerance and the outer residual
+     * \param maxIterations The maximum number of iterations; the default of the solver
+     *                      is used if this is not positive
+     * \param maxTolerance The largest tolerance which is ever requested
+     */
+    static ConstraintSolverTolerance adaptive(Scalar outerResidual,
+                                              Scalar relativeTolerance,
+                                              int maxIterations = 0,
+                                              Scalar maxTolerance = 1e-2)
+    {
+        Scalar tol = relativeTolerance*std::abs(outerResidual);
+        if (!(tol < maxTolerance))
+            tol = maxTolerance;
+        return ConstraintSolverTolerance(tol, maxIterations);
+    }
+
+    //! Returns the tolerance or a default value if no tolerance was requested
+    Scalar toleranceOr(Scalar defaultTolerance) const
+    { return (tolerance > 0.0) ? tolerance : defaultTolerance; }
+
+    //! Returns the iteration limit or a default value if no limit was requested
+    int maxIterationsOr(int defaultMaxIterations) const
+    { return (maxIterations > 0) ? maxIterations : defaultMaxIterations; }
+
+    //! The tolerance; if it is not positive, the default of the solver is used
+    Scalar tolerance;
+
+    //! The maximum number of iterations; if it is not positive, the default of the
+    //! solver is used
+    int maxIterations;
+};
+
+/*!
+ * \brief Accumulated outcome of a constraint solver for a range of problems.
+ *
+ * This is used by the drivers which call a solver for many fluid states, e.g., in
+ * parallel, to report how the solver performed without requiring the caller to
+ * inspect each status object.
+ */
+template <class Scalar>
+struct ConstraintSolverStatistics
+{
+    ConstraintSolverStatistics()
+        : numConverged(0)
+        , numNotConverged(0)
+        , numSingular(0)
+        , totalIterations(0)
+        , maxIterations(0)
+    {}
+
+    //! Accounts for the outcome of a single call of the solver
+    void add(const ConstraintSolverStatus<Scalar>& status)
+    {
+        if (status.result == ConstraintSolverStatus<Scalar>::Converged)
+            ++numConverged;
+        else if (status.result == ConstraintSolverStatus<Scalar>::SingularMatrix)
+            ++numSingular;
+        else
+            ++numNotConverged;
+
+        totalIterations += status.iterations;
+        maxIterations = std::max(maxIterations, status.iterations);
+    }
+
+    //! Adds the statistics of another range of problems
+    void merge(const ConstraintSolverStatistics& other)
+    {
+        numConverged += other.numConverged;
+        numNotConverged += other.numNotConverged;
+        numSingular += other.numSingular;
+        totalIterations += other.totalIterations;
+        maxIterations = std::max(maxIterations, other.maxIterations);
+    }
+
+    //! The number of problems for which the solver failed
+    size_t numFailed() const
+    { return numNotConverged + numSingular; }
+
+    //! The number of problems for which the solver converged
+    size_t numConverged;
+
+    //! The number of problems for which the solver did not converge
+    size_t numNotConverged;
+
+    //! The number of problems for which a singular linear system was encountered
+    size_t numSingular;
+
+    //! The sum of the iterations of all problems
+    size_t totalIterations;
+
+    //! The largest number of iterations required for a single problem
+    int maxIterations;
+};
+
+/*!
+ * \brief Solve a small dense linear system without throwing exceptions.
+ *
+ * This uses Opm::SmallLuDecomposition. Contrary to Dune::FieldMatrix::solve(),
+ * singular matrices are signaled by the return value, which avoids the cost of
+ * unwinding the stack in the constraint solvers. If the entries of the matrix are
+ * function evaluations, only their values are used for the decomposition. The
+ * derivatives of the solution are then obtained by solving for the residual of the
+ * solution's value, i.e., \f$x = \tilde{x} + A^{-1}(b - A\tilde{x})\f$ where
+ * \f$\tilde{x}\f$ is considered to be constant. This only requires an additional
+ * forward and backward substitution.
+ *
+ * \param A The matrix
+ * \param x The vector which receives the solution
+ * \param b The right hand side of the system
+ * \param singularLimit The minimum absolute value of a pivot element
+ *
+ * \return false if the matrix is singular. In this case x is not modified.
+ */
+template <class Evaluation, int n, class Scalar>
+bool solveLinearSystemNoThrow(const Dune::FieldMatrix<Evaluation, n, n>& A,
+                              Dune::FieldVector<Evaluation, n>& x,
+                              const Dune::FieldVector<Evaluation, n>& b,
+                              Scalar singularLimit)
+{
+    typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+    Opm::SmallLuDecomposition<Scalar, n> lu;
+    if (!lu.factorize(A, singularLimit))
+        return false;
+
+    if (std::is_same<Evaluation, Scalar>::value) {
+        lu.solve(x, b);
+        return true;
+    }
+
+    // the values of the solution
+    Dune::FieldVector<Scalar, n> bValue;
+    Dune::FieldVector<Scalar, n> xValue;
+    for (int i = 0; i < n; ++i)
+        bValue[i] = Toolbox::value(b[i]);
+    lu.solve(xValue, bValue);
+
+    // the derivatives. the value of the residual is zero up to round-off errors
+    Dune::FieldVector<Evaluation, n> residual;
+    for (int i = 0; i < n; ++i) {
+        residual[i] = b[i];
+        for (int j = 0; j < n; ++j)
+            residual[i] -= A[i][j]*xValue[j];
+    }
+    lu.solve(x, residual);
+    for (int i = 0; i < n; ++i)
+        x[i] += xValue[i];
+
+    return true;
+}
+
+/*!
+ * \brief Returns true if the values of all entries of a vector are finite.
+ *
+ * The constraint solvers use this to reject Newton updates which would otherwise
+ * spoil the fluid state.
+ */
+template <class Vector>
+bool isFiniteVector(const Vector& v)
+{
+    typedef Opm::MathToolbox<typename Vector::value_type> Toolbox;
+
+    for (int i = 0; i < static_cast<int>(v.size()); ++i)
+        if (!std::isfinite(Toolbox::value(v[i])))
+            return false;
+    return true;
+}
+
+} // namespace Opm
+
+#endif
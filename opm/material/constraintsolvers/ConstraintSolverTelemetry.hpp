@@ -0,0 +1,290 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::ConstraintSolverTelemetry
+ */
+#ifndef OPM_CONSTRAINT_SOLVER_TELEMETRY_HPP
+#define OPM_CONSTRAINT_SOLVER_TELEMETRY_HPP
+
+#include <opm/material/constraintsolvers/ConstraintSolverStatus.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+
+namespace Opm {
+
+/*!
+ * \brief Collects histograms about the calls of a constraint solver.
+ *
+ * If a telemetry object is attached to a solver (e.g., using
+ * NcpFlash::setTelemetry()), each call of the solver's trySolve() or solve() methods
+ * records the number of iterations, the final residual, the number of iterations in
+ * which the update was clamped, whether a singular linear system was encountered and
+ * the wall time of the call. The residual is the error measure which the solver uses
+ * to check whether a given state is a solution, e.g., the scaled defect of
+ * NcpFlash::isConverged().
+ *
+ * The counters are atomic, so a single telemetry object can be shared by all threads.
+ * To get histograms per time step, print() and reset() them after each time step.
+ * reset() must not be called while a solver records into the object. If no telemetry
+ * object is attached, the solvers do not do any additional work.
+ */
+class ConstraintSolverTelemetry
+{
+    typedef std::chrono::steady_clock Clock;
+
+public:
+    enum {
+        //! The number of bins of the iteration histogram. The last bin contains all
+        //! calls which needed at least numIterationBins - 1 iterations.
+        numIterationBins = 64,
+
+        //! The number of bins of the residual histogram. Bin i contains the
+        //! residuals in [10^(i - residualBinOffset), 10^(i - residualBinOffset + 1)),
+        //! the first and the last bin also the smaller and the larger ones.
+        numResidualBins = 32,
+        residualBinOffset = 24,
+
+        //! The number of bins of the histogram of the clamped updates
+        numClampBins = 16,
+
+        //! The number of bins of the wall time histogram. Bin i contains the calls
+        //! which took [2^i, 2^(i + 1)) microseconds, bin 0 also the faster ones.
+        numTimeBins = 32
+    };
+
+    /*!
+     * \brief Measures the wall time of a solver call.
+     */
+    class Timer
+    {
+    public:
+        Timer()
+            : start_(Clock::now())
+        {}
+
+        //! Returns the number of seconds since the construction of the timer
+        double seconds() const
+        { return std::chrono::duration<double>(Clock::now() - start_).count(); }
+
+    private:
+        Clock::time_point start_;
+    };
+
+    ConstraintSolverTelemetry()
+    { reset(); }
+
+    /*!
+     * \brief Record the outcome of a solver call.
+     *
+     * \param status The status which was returned by the solver
+     * \param residual The error measure of the final state
+     * \param numClampedUpdates The number of iterations in which the update was clamped
+     * \param seconds The wall time of the call
+     */
+    template <class Scalar>
+    void record(const ConstraintSolverStatus<Scalar>& status,
+                double residual,
+                int numClampedUpdates,
+                double seconds)
+    {
+        typedef ConstraintSolverStatus<Scalar> Status;
+
+        if (status.result == Status::Converged)
+            increment_(numConverged_);
+        else if (status.result == Status::SingularMatrix)
+            increment_(numSingular_);
+        else
+            increment_(numNotConverged_);
+
+        int iterationBin = std::max(0, std::min<int>(numIterationBins - 1, status.iterations));
+        increment_(iterationHistogram_[iterationBin]);
+
+        if (std::isfinite(residual))
+            increment_(residualHistogram_[residualBin(residual)]);
+        else
+            increment_(numNonFiniteResiduals_);
+
+        int clampBin = std::max(0, std::min<int>(numClampBins - 1, numClampedUpdates));
+        increment_(clampHistogram_[clampBin]);
+
+        increment_(timeHistogram_[timeBin(seconds)]);
+        unsigned long long nanoseconds = static_cast<unsigned long long>(std::max(0.0, seconds)*1e9);
+        totalNanoseconds_.fetch_add(nanoseconds, std::memory_order_relaxed);
+        totalIterations_.fetch_add(static_cast<unsigned long long>(std::max(0, status.iterations)),
+                                   std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Set all histograms to zero.
+     */
+    void reset()
+    {
+        numConverged_.store(0, std::memory_order_relaxed);
+        numNotConverged_.store(0, std::memory_order_relaxed);
+        numSingular_.store(0, std::memory_order_relaxed);
+        numNonFiniteResiduals_.store(0, std::memory_order_relaxed);
+        totalIterations_.store(0, std::memory_order_relaxed);
+        totalNanoseconds_.store(0, std::memory_order_relaxed);
+        for (int i = 0; i < numIterationBins; ++i)
+            iterationHistogram_[i].store(0, std::memory_order_relaxed);
+        for (int i = 0; i < numResidualBins; ++i)
+            residualHistogram_[i].store(0, std::memory_order_relaxed);
+        for (int i = 0; i < numClampBins; ++i)
+            clampHistogram_[i].store(0, std::memory_order_relaxed);
+        for (int i = 0; i < numTimeBins; ++i)
+            timeHistogram_[i].store(0, std::memory_order_relaxed);
+    }
+
+    //! The number of recorded solver calls
+    unsigned long long numSolves() const
+    { return numConverged() + numNotConverged() + numSingular(); }
+
+    //! The number of recorded calls which converged
+    unsigned long long numConverged() const
+    { return numConverged_.load(std::memory_order_relaxed); }
+
+    //! The number of recorded calls which did not converge
+    unsigned long long numNotConverged() const
+    { return numNotConverged_.load(std::memory_order_relaxed); }
+
+    //! The number of recorded calls which encountered a singular linear system
+    unsigned long long numSingular() const
+    { return numSingular_.load(std::memory_order_relaxed); }
+
+    //! The number of recorded calls for which the residual was not finite
+    unsigned long long numNonFiniteResiduals() const
+    { return numNonFiniteResiduals_.load(std::memory_order_relaxed); }
+
+    //! The sum of the iterations of all recorded calls
+    unsigned long long totalIterations() const
+    { return totalIterations_.load(std::memory_order_relaxed); }
+
+    //! The sum of the wall times of all recorded calls in seconds
+    double totalSeconds() const
+    { return totalNanoseconds_.load(std::memory_order_relaxed)*1e-9; }
+
+    //! The number of calls which needed a given number of iterations
+    unsigned long long iterationCount(int binIdx) const
+    { return iterationHistogram_[binIdx].load(std::memory_order_relaxed); }
+
+    //! The number of calls whose residual is in a given bin
+    unsigned long long residualCount(int binIdx) const
+    { return residualHistogram_[binIdx].load(std::memory_order_relaxed); }
+
+    //! The number of calls for which the update was clamped a given number of times
+    unsigned long long clampCount(int binIdx) const
+    { return clampHistogram_[binIdx].load(std::memory_order_relaxed); }
+
+    //! The number of calls whose wall time is in a given bin
+    unsigned long long timeCount(int binIdx) const
+    { return timeHistogram_[binIdx].load(std::memory_order_relaxed); }
+
+    //! Returns the index of the bin of the residual histogram for a given residual
+    static int residualBin(double residual)
+    {
+        if (!(residual > 0.0))
+            return 0;
+        int binIdx = static_cast<int>(std::floor(std::log10(residual))) + residualBinOffset;
+        return std::max(0, std::min<int>(numResidualBins - 1, binIdx));
+    }
+
+    //! Returns the index of the bin of the wall time histogram for a given time
+    static int timeBin(double seconds)
+    {
+        double microseconds = seconds*1e6;
+        if (!(microseconds >= 2.0))
+            return 0;
+        int binIdx = static_cast<int>(std::floor(std::log2(microseconds)));
+        return std::max(0, std::min<int>(numTimeBins - 1, binIdx));
+    }
+
+    /*!
+     * \brief Print the summary and the non-empty bins of all histograms.
+     */
+    void print(std::ostream& os) const
+    {
+        unsigned long long n = numSolves();
+        os << "solves: " << n
+           << ", converged: " << numConverged()
+           << ", not converged: " << numNotConverged()
+           << ", singular: " << numSingular() << "\n";
+        if (n == 0)
+            return;
+
+        os << "iterations: " << totalIterations()
+           << " (" << static_cast<double>(totalIterations())/n << " per solve)"
+           << ", wall time: " << totalSeconds() << " s"
+           << " (" << totalSeconds()/n*1e6 << " us per solve)\n";
+
+        os << "iterations histogram:\n";
+        for (int i = 0; i < numIterationBins; ++i)
+            if (iterationCount(i) > 0)
+                os << "  " << std::setw(3) << i << ((i == numIterationBins - 1)?"+":" ")
+                   << ": " << iterationCount(i) << "\n";
+
+        os << "residual histogram:\n";
+        for (int i = 0; i < numResidualBins; ++i)
+            if (residualCount(i) > 0)
+                os << "  1e" << std::setw(3) << (i - residualBinOffset)
+                   << ": " << residualCount(i) << "\n";
+        if (numNonFiniteResiduals() > 0)
+            os << "  non-finite: " << numNonFiniteResiduals() << "\n";
+
+        os << "clamped updates histogram:\n";
+        for (int i = 0; i < numClampBins; ++i)
+            if (clampCount(i) > 0)
+                os << "  " << std::setw(3) << i << ((i == numClampBins - 1)?"+":" ")
+                   << ": " << clampCount(i) << "\n";
+
+        os << "wall time histogram [us]:\n";
+        for (int i = 0; i < numTimeBins; ++i)
+            if (timeCount(i) > 0)
+                os << "  " << std::setw(10) << (1ULL << i) << ": " << timeCount(i) << "\n";
+    }
+
+private:
+    ConstraintSolverTelemetry(const ConstraintSolverTelemetry&);
+    ConstraintSolverTelemetry& operator=(const ConstraintSolverTelemetry&);
+
+    static void increment_(std::atomic<unsigned long long>& counter)
+    { counter.fetch_add(1, std::memory_order_relaxed); }
+
+    std::atomic<unsigned long long> numConverged_;
+    std::atomic<unsigned long long> numNotConverged_;
+    std::atomic<unsigned long long> numSingular_;
+    std::atomic<unsigned long long> numNonFiniteResiduals_;
+    std::atomic<unsigned long long> totalIterations_;
+    std::atomic<unsigned long long> totalNanoseconds_;
+    std::atomic<unsigned long long> iterationHistogram_[numIterationBins];
+    std::atomic<unsigned long long> residualHistogram_[numResidualBins];
+    std::atomic<unsigned long long> clampHistogram_[numClampBins];
+    std::atomic<unsigned long long> timeHistogram_[numTimeBins];
+};
+
+} // namespace Opm
+
+#endif
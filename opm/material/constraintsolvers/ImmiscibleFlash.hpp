@@ -28,12 +28,21 @@
 #include <opm/material/common/ErrorMacros.hpp>
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/Valgrind.hpp>
+#include <opm/material/common/Instrumentation.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
+#include <opm/material/constraintsolvers/ConstraintSolverStatus.hpp>
+#include <opm/material/constraintsolvers/ConstraintSolverTelemetry.hpp>
+#include <opm/material/fluidstates/ImmiscibleFluidState.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
 
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <atomic>
 #include <limits>
 #include <iostream>
+#include <type_traits>
 
 namespace Opm {
 
@@ -62,6 +71,17 @@ namespace Opm {
  * by this, though. In this case the original pressure is kept, and
  * the saturation of the phase is calculated by dividing the global
  * molarity of the component by the phase density.
+ *
+ * If the fluid system provides exact derivatives (see
+ * BaseFluidSystem::hasExactDerivatives), the Jacobian matrix is calculated using
+ * automatic differentiation instead of finite differences.
+ *
+ * For two phases, no linear systems need to be solved: For a given pressure of the
+ * first phase, the saturation of the first phase follows from the total molarity of
+ * the first component and the pressure of the second phase from the capillary
+ * pressure. This leaves a single scalar equation for the total molarity of the second
+ * component, whose root is bracketed and then located using the Illinois variant of
+ * the regula falsi.
  */
 template <class Scalar, class FluidSystem>
 class ImmiscibleFlash
@@ -82,6 +102,9 @@ class ImmiscibleFlash
 public:
     typedef Dune::FieldVector<Scalar, numComponents> ComponentVector;
 
+    //! The outcome of the trySolve() method
+    typedef Opm::ConstraintSolverStatus<Scalar> SolverStatus;
+
     /*!
      * \brief Guess initial values for all quantities.
      */
@@ -104,11 +127,111 @@ public:
         }
     }
 
+    /*!
+     * \brief Use the solution of a previous flash calculation as initial guess.
+     *
+     * The pressures and saturations of all phases are taken from the previous fluid
+     * state. If the conditions did not change much since the previous solution,
+     * e.g. between two time steps, this usually requires considerably less Newton
+     * iterations than guessInitial().
+     */
+    template <class FluidState, class PrevFluidState>
+    static void guessFromPrevious(FluidState &fluidState,
+                                  ParameterCache &paramCache,
+                                  const PrevFluidState &prevFluidState)
+    {
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            fluidState.setPressure(phaseIdx, prevFluidState.pressure(phaseIdx));
+            fluidState.setSaturation(phaseIdx, prevFluidState.saturation(phaseIdx));
+        }
+    }
+
+    /*!
+     * \brief Returns true if a fluid state already is a solution of the flash
+     *        calculation for the given total molarities.
+     *
+     * This only evaluates the residual of the flash equations, which is much cheaper
+     * than a Newton iteration. It is intended to be used after guessFromPrevious(): if
+     * the previous solution is still valid, the call to solve() can be skipped. The
+     * defects of the component molarities are compared relative to the sum of the
+     * total molarities.
+     *
+     * The fluid state is made consistent with the fluid system and the material law
+     * in any case, i.e., its densities and the pressures and the saturation of the last
+     * phase are updated.
+     */
+    template <class MaterialLaw, class FluidState>
+    static bool isConverged(FluidState &fluidState,
+                            ParameterCache &paramCache,
+                            const typename MaterialLaw::Params &matParams,
+                            const ComponentVector &globalMolarities,
+                            Scalar tolerance = 0.0)
+    {
+        if (tolerance <= 0.0)
+            tolerance = 1e-9;
+
+        completeFluidState_<MaterialLaw>(fluidState, paramCache, matParams);
+
+        return defectNorm_(fluidState, globalMolarities) <= tolerance;
+    }
+
+    /*!
+     * \brief Attach a telemetry object to the flash solver.
+     *
+     * If the telemetry object is not null, each call of trySolve() and solve() records
+     * its number of iterations, the scaled defect of the final state (see
+     * isConverged()), the number of iterations in which the Newton update was clamped
+     * and its wall time. The object is used by all threads and must stay alive until it
+     * is detached by passing a null pointer.
+     */
+    static void setTelemetry(ConstraintSolverTelemetry* telemetry)
+    { telemetry_.store(telemetry, std::memory_order_release); }
+
+    /*!
+     * \brief Returns the telemetry object which is attached to the flash solver.
+     *
+     * If no telemetry object is attached, a null pointer is returned.
+     */
+    static ConstraintSolverTelemetry* telemetry()
+    { return telemetry_.load(std::memory_order_acquire); }
+
+    /*!
+     * \brief Calculates the chemical equilibrium from the component
+     *        fugacities in a phase without throwing exceptions.
+     *
+     * This does the same as solve(), but if the Newton method does not converge or
+     * if the Jacobian matrix becomes singular, this is reported by the returned
+     * status object instead of an exception. In this case, the fluid state contains
+     * the result of the last iteration.
+     */
+    template <class MaterialLaw, class FluidState>
+    static SolverStatus trySolve(FluidState &fluidState,
+                                 ParameterCache &paramCache,
+                                 const typename MaterialLaw::Params &matParams,
+                                 const ComponentVector &globalMolarities)
+    {
+        OPM_INSTRUMENT_SCOPE("ImmiscibleFlash::trySolve");
+        OPM_PROFILER_RANGE("ImmiscibleFlash::trySolve");
+        ConstraintSolverTelemetry* sink = telemetry();
+        if (!sink)
+            return trySolve_<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities,
+                                          /*numClamped=*/nullptr);
+
+        ConstraintSolverTelemetry::Timer timer;
+        int numClamped = 0;
+        SolverStatus status =
+            trySolve_<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, &numClamped);
+        double seconds = timer.seconds();
+        sink->record(status, defectNorm_(fluidState, globalMolarities), numClamped, seconds);
+        return status;
+    }
+
     /*!
      * \brief Calculates the chemical equilibrium from the component
      *        fugacities in a phase.
      *
-     * The phase's fugacities must already be set.
+     * The phase's fugacities must already be set. If the calculation fails, a
+     * NumericalIssue exception is thrown.
      */
     template <class MaterialLaw, class FluidState>
     static void solve(FluidState &fluidState,
@@ -116,7 +239,196 @@ public:
                       const typename MaterialLaw::Params &matParams,
                       const ComponentVector &globalMolarities)
     {
-        Dune::FMatrixPrecision<Scalar>::set_singular_limit(1e-25);
+        OPM_INSTRUMENT_SCOPE("ImmiscibleFlash::solve");
+        OPM_PROFILER_RANGE("ImmiscibleFlash::solve");
+        const SolverStatus& status =
+            trySolve<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities);
+
+        if (status.result == SolverStatus::SingularMatrix)
+            OPM_THROW(Opm::NumericalIssue,
+                      "Flash calculation failed: singular Jacobian matrix."
+                      " {c_alpha^kappa} = {" << globalMolarities << "}, T = "
+                      << fluidState.temperature(/*phaseIdx=*/0));
+        else if (!status.converged())
+            OPM_THROW(Opm::NumericalIssue,
+                      "Flash calculation failed."
+                      " {c_alpha^kappa} = {" << globalMolarities << "}, T = "
+                      << fluidState.temperature(/*phaseIdx=*/0));
+    }
+
+protected:
+    // the maximum number of iterations of the flash
+    static const int maxIterations_ = 50;
+
+    // the flash calculation of trySolve(). if numClamped is not null, the number of
+    // iterations in which the Newton update was clamped is added to it.
+    template <class MaterialLaw, class FluidState>
+    static SolverStatus trySolve_(FluidState &fluidState,
+                                  ParameterCache &paramCache,
+                                  const typename MaterialLaw::Params &matParams,
+                                  const ComponentVector &globalMolarities,
+                                  int* numClamped)
+    {
+        typedef std::integral_constant<bool, numPhases == 2> IsTwoPhase;
+
+        return trySolve_<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities,
+                                      numClamped, IsTwoPhase());
+    }
+
+    // the scalar root finding for two phases. the updates are never clamped.
+    template <class MaterialLaw, class FluidState>
+    static SolverStatus trySolve_(FluidState &fluidState,
+                                  ParameterCache &paramCache,
+                                  const typename MaterialLaw::Params &matParams,
+                                  const ComponentVector &globalMolarities,
+                                  int* /* numClamped */,
+                                  std::true_type /* isTwoPhase */)
+    {
+        SolverStatus status;
+
+        paramCache.updateAll(fluidState, /*except=*/ParameterCache::Composition);
+
+        if (!FluidSystem::isCompressible(/*phaseIdx=*/0)
+            && !FluidSystem::isCompressible(/*phaseIdx=*/1))
+        {
+            // the pressure cannot be determined. the saturations are given by the
+            // volume of the first component, and the result is only a solution if the
+            // volumes of both components add up to the pore volume
+            completeFluidState_<MaterialLaw>(fluidState, paramCache, matParams);
+            fluidState.setSaturation(/*phaseIdx=*/0,
+                                     globalMolarities[/*compIdx=*/0]
+                                     / fluidState.molarDensity(/*phaseIdx=*/0));
+            completeFluidState_<MaterialLaw>(fluidState, paramCache, matParams);
+
+            status.residual = defectNorm_(fluidState, globalMolarities);
+            if (status.residual <= 1e-9)
+                status.result = SolverStatus::Converged;
+            return status;
+        }
+
+        // bracket the root. the defect increases with the pressure: the saturation of
+        // the second phase and its density grow if the pressure is raised.
+        Scalar p = fluidState.pressure(/*phaseIdx=*/0);
+        Scalar defect = twoPhaseDefect_<MaterialLaw>(fluidState, paramCache, matParams,
+                                                     globalMolarities, p);
+        Scalar pLow = p, defectLow = defect;
+        Scalar pHigh = p, defectHigh = defect;
+        int iterIdx = 0;
+        for (; iterIdx < maxIterations_; ++iterIdx) {
+            if (!std::isfinite(defect))
+                return status;
+            if (defect == 0.0) {
+                status.iterations = iterIdx;
+                status.residual = 0.0;
+                status.result = SolverStatus::Converged;
+                return status;
+            }
+            if (defectLow < 0.0 && defectHigh > 0.0)
+                break;
+
+            if (defect < 0.0) {
+                pLow = pHigh;
+                defectLow = defectHigh;
+                pHigh *= 2;
+                p = pHigh;
+                defect = defectHigh = twoPhaseDefect_<MaterialLaw>(fluidState, paramCache, matParams,
+                                                                   globalMolarities, p);
+            }
+            else {
+                pHigh = pLow;
+                defectHigh = defectLow;
+                pLow /= 2;
+                p = pLow;
+                defect = defectLow = twoPhaseDefect_<MaterialLaw>(fluidState, paramCache, matParams,
+                                                                  globalMolarities, p);
+            }
+        }
+
+        status.iterations = iterIdx;
+
+        // Illinois iterations: the secant is taken between the ends of the bracket,
+        // and the defect of an end which is kept twice in a row is halved, so that
+        // the bracket shrinks from both sides
+        int lastKept = 0;
+        for (; iterIdx < maxIterations_; ++iterIdx) {
+            Scalar pNew = (pLow*defectHigh - pHigh*defectLow)/(defectHigh - defectLow);
+            if (!(pLow < pNew && pNew < pHigh))
+                pNew = (pLow + pHigh)/2;
+
+            Scalar relError = std::abs(pNew - p)*quantityWeight_(fluidState, /*pvIdx=*/0);
+            p = pNew;
+            defect = twoPhaseDefect_<MaterialLaw>(fluidState, paramCache, matParams,
+                                                  globalMolarities, p);
+            status.iterations = iterIdx + 1;
+            status.residual = relError;
+            if (!std::isfinite(defect))
+                return status;
+
+            if (relError < 1e-9 || defect == 0.0) {
+                status.result = SolverStatus::Converged;
+                return status;
+            }
+
+            if (defect < 0.0) {
+                pLow = p;
+                defectLow = defect;
+                if (lastKept > 0)
+                    defectHigh /= 2;
+                lastKept = 1;
+            }
+            else {
+                pHigh = p;
+                defectHigh = defect;
+                if (lastKept < 0)
+                    defectLow /= 2;
+                lastKept = -1;
+            }
+        }
+
+        status.result = SolverStatus::NotConverged;
+        return status;
+    }
+
+    // make the fluid state consistent with a given pressure of the first phase and
+    // return the defect of the total molarity of the second component
+    template <class MaterialLaw, class FluidState>
+    static Scalar twoPhaseDefect_(FluidState &fluidState,
+                                  ParameterCache &paramCache,
+                                  const typename MaterialLaw::Params &matParams,
+                                  const ComponentVector &globalMolarities,
+                                  Scalar pressure)
+    {
+        fluidState.setPressure(/*phaseIdx=*/0, pressure);
+        paramCache.updatePressure(fluidState, /*phaseIdx=*/0);
+        fluidState.setDensity(/*phaseIdx=*/0,
+                              FluidSystem::density(fluidState, paramCache, /*phaseIdx=*/0));
+
+        Scalar S0 = globalMolarities[/*compIdx=*/0]/fluidState.molarDensity(/*phaseIdx=*/0);
+        fluidState.setSaturation(/*phaseIdx=*/0, S0);
+        fluidState.setSaturation(/*phaseIdx=*/1, 1.0 - S0);
+
+        Dune::FieldVector<Scalar, numPhases> pC;
+        MaterialLaw::capillaryPressures(pC, matParams, fluidState);
+        fluidState.setPressure(/*phaseIdx=*/1, pressure + (pC[1] - pC[0]));
+        paramCache.updatePressure(fluidState, /*phaseIdx=*/1);
+        fluidState.setDensity(/*phaseIdx=*/1,
+                              FluidSystem::density(fluidState, paramCache, /*phaseIdx=*/1));
+
+        return
+            fluidState.saturation(/*phaseIdx=*/1)*fluidState.molarity(/*phaseIdx=*/1, /*compIdx=*/1)
+            - globalMolarities[/*compIdx=*/1];
+    }
+
+    // the Newton method for more than two phases
+    template <class MaterialLaw, class FluidState>
+    static SolverStatus trySolve_(FluidState &fluidState,
+                                  ParameterCache &paramCache,
+                                  const typename MaterialLaw::Params &matParams,
+                                  const ComponentVector &globalMolarities,
+                                  int* numClamped,
+                                  std::false_type /* isTwoPhase */)
+    {
+        SolverStatus status;
 
         /////////////////////////
         // Check if all fluid phases are incompressible
@@ -159,8 +471,7 @@ public:
 
         completeFluidState_<MaterialLaw>(fluidState, paramCache, matParams);
 
-        const int nMax = 50; // <- maximum number of newton iterations
-        for (int nIdx = 0; nIdx < nMax; ++nIdx) {
+        for (int nIdx = 0; nIdx < maxIterations_; ++nIdx) {
             // calculate Jacobian matrix and right hand side
             linearize_<MaterialLaw>(J, b, fluidState, paramCache, matParams, globalMolarities);
             Valgrind::CheckDefined(J);
@@ -168,63 +479,31 @@ public:
 
             // Solve J*x = b
             deltaX = 0;
-
-            try { J.solve(deltaX, b); }
-            catch (Dune::FMatrixError e)
-            {
-                /*
-                std::cout << "error: " << e << "\n";
-                std::cout << "b: " << b << "\n";
-                */
-
-                throw Opm::NumericalIssue(e.what());
+            if (!solveLinearSystemNoThrow(J, deltaX, b, Scalar(1e-25))) {
+                status.result = SolverStatus::SingularMatrix;
+                return status;
             }
             Valgrind::CheckDefined(deltaX);
-
-            /*
-            printFluidState_(fluidState);
-            std::cout << "J:\n";
-            for (int i = 0; i < numEq; ++i) {
-                for (int j = 0; j < numEq; ++j) {
-                    std::ostringstream os;
-                    os << J[i][j];
-
-                    std::string s(os.str());
-                    do {
-                        s += " ";
-                    } while (s.size() < 20);
-                    std::cout << s;
-                }
-                std::cout << "\n";
-            };
-            std::cout << "residual: " << b << "\n";
-            std::cout << "deltaX: " << deltaX << "\n";
-            std::cout << "---------------\n";
-            */
+            if (!isFiniteVector(deltaX)) {
+                status.result = SolverStatus::NotConverged;
+                return status;
+            }
 
             // update the fluid quantities.
-            Scalar relError = update_<MaterialLaw>(fluidState, paramCache, matParams, deltaX);
+            Scalar relError = update_<MaterialLaw>(fluidState, paramCache, matParams, deltaX, numClamped);
+            status.iterations = nIdx + 1;
+            status.residual = relError;
 
-            if (relError < 1e-9)
-                return;
+            if (relError < 1e-9) {
+                status.result = SolverStatus::Converged;
+                return status;
+            }
         }
 
-        /*
-        printFluidState_(fluidState);
-        std::cout << "globalMolarities: ";
-        for (int compIdx = 0; compIdx < numComponents; ++ compIdx)
-            std::cout << globalMolarities[compIdx] << " ";
-        std::cout << "\n";
-        */
-
-        OPM_THROW(Opm::NumericalIssue,
-                  "Flash calculation failed."
-                  " {c_alpha^kappa} = {" << globalMolarities << "}, T = "
-                  << fluidState.temperature(/*phaseIdx=*/0));
+        status.result = SolverStatus::NotConverged;
+        return status;
     }
 
-
-protected:
     template <class FluidState>
     static void printFluidState_(const FluidState &fs)
     {
@@ -254,6 +533,10 @@ protected:
         std::cout << "\n";
     }
 
+    // the tag for the primary variables of the flash if the Jacobian matrix is
+    // calculated using automatic differentiation
+    class JacobianVarSetTag_;
+
     template <class MaterialLaw, class FluidState>
     static void linearize_(Matrix &J,
                            Vector &b,
@@ -261,6 +544,62 @@ protected:
                            ParameterCache &paramCache,
                            const typename MaterialLaw::Params &matParams,
                            const ComponentVector &globalMolarities)
+    {
+        typedef std::integral_constant<bool, FluidSystem::hasExactDerivatives> UseExactDerivatives;
+
+        linearize_<MaterialLaw>(J, b, fluidState, paramCache, matParams, globalMolarities,
+                                UseExactDerivatives());
+    }
+
+    // calculate the Jacobian matrix using automatic differentiation
+    template <class MaterialLaw, class FluidState>
+    static void linearize_(Matrix &J,
+                           Vector &b,
+                           FluidState &fluidState,
+                           const ParameterCache &paramCache,
+                           const typename MaterialLaw::Params &matParams,
+                           const ComponentVector &globalMolarities,
+                           std::true_type /* useExactDerivatives */)
+    {
+        typedef Opm::LocalAd::Evaluation<Scalar, JacobianVarSetTag_, numEq> FlashEval;
+        typedef Opm::ImmiscibleFluidState<FlashEval, FluidSystem, /*storeEnthalpy=*/false> FlashFluidState;
+        typedef Dune::FieldVector<FlashEval, numEq> FlashDefectVector;
+
+        // make the first pressure and the first M-1 saturations the variables of the
+        // evaluation
+        FlashFluidState flashFluidState;
+        flashFluidState.assign(fluidState);
+        flashFluidState.setPressure(/*phaseIdx=*/0,
+                                    FlashEval::createVariable(fluidState.pressure(0), /*pvIdx=*/0));
+        for (int phaseIdx = 0; phaseIdx < numPhases - 1; ++phaseIdx)
+            flashFluidState.setSaturation(phaseIdx,
+                                          FlashEval::createVariable(fluidState.saturation(phaseIdx),
+                                                                    /*pvIdx=*/phaseIdx + 1));
+
+        ParameterCache flashParamCache(paramCache);
+        completeFluidState_<MaterialLaw>(flashFluidState, flashParamCache, matParams);
+
+        FlashDefectVector flashDefect;
+        calculateDefect_(flashDefect, flashFluidState, flashFluidState, globalMolarities);
+
+        for (int eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            b[eqIdx] = flashDefect[eqIdx].value;
+            for (int pvIdx = 0; pvIdx < numEq; ++ pvIdx)
+                J[eqIdx][pvIdx] = flashDefect[eqIdx].derivatives[pvIdx];
+        }
+        Valgrind::CheckDefined(b);
+        Valgrind::CheckDefined(J);
+    }
+
+    // calculate the Jacobian matrix using forward differences
+    template <class MaterialLaw, class FluidState>
+    static void linearize_(Matrix &J,
+                           Vector &b,
+                           FluidState &fluidState,
+                           ParameterCache &paramCache,
+                           const typename MaterialLaw::Params &matParams,
+                           const ComponentVector &globalMolarities,
+                           std::false_type /* useExactDerivatives */)
     {
         FluidState origFluidState(fluidState);
         ParameterCache origParamCache(paramCache);
@@ -306,8 +645,8 @@ protected:
         }
     }
 
-    template <class FluidState>
-    static void calculateDefect_(Vector &b,
+    template <class FluidState, class DefectVector>
+    static void calculateDefect_(DefectVector &b,
                                  const FluidState &fluidStateEval,
                                  const FluidState &fluidState,
                                  const ComponentVector &globalMolarities)
@@ -322,13 +661,42 @@ protected:
         }
     }
 
+    // returns the largest defect of a consistent fluid state relative to the sum of
+    // the total molarities, see isConverged()
+    template <class FluidState>
+    static Scalar defectNorm_(const FluidState &fluidState,
+                              const ComponentVector &globalMolarities)
+    {
+        Vector b;
+        calculateDefect_(b, fluidState, fluidState, globalMolarities);
+
+        Scalar sumMolarities = 0.0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            sumMolarities += std::abs(globalMolarities[compIdx]);
+
+        // a zero defect is always accepted, and NaN defects yield a NaN norm
+        Scalar norm = 0.0;
+        for (int eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            if (b[eqIdx] == 0.0)
+                continue;
+            Scalar err = std::abs(b[eqIdx])/sumMolarities;
+            if (std::isnan(err))
+                return err;
+            norm = std::max(norm, err);
+        }
+
+        return norm;
+    }
+
     template <class MaterialLaw, class FluidState>
     static Scalar update_(FluidState &fluidState,
                           ParameterCache &paramCache,
                           const typename MaterialLaw::Params &matParams,
-                          const Vector &deltaX)
+                          const Vector &deltaX,
+                          int* numClamped = nullptr)
     {
         Scalar relError = 0;
+        bool clamped = false;
         for (int pvIdx = 0; pvIdx < numEq; ++ pvIdx) {
             Scalar tmp = getQuantity_(fluidState, pvIdx);
             Scalar delta = deltaX[pvIdx];
@@ -345,12 +713,16 @@ protected:
                 // iteration
                 delta = std::min(0.30*fluidState.pressure(0), std::max(-0.30*fluidState.pressure(0), delta));
             };
+            clamped = clamped || delta != deltaX[pvIdx];
 
             setQuantityRaw_(fluidState, pvIdx, tmp - delta);
         }
 
         completeFluidState_<MaterialLaw>(fluidState, paramCache, matParams);
 
+        if (numClamped && clamped)
+            ++(*numClamped);
+
         return relError;
     }
 
@@ -359,9 +731,11 @@ protected:
                                     ParameterCache &paramCache,
                                     const typename MaterialLaw::Params &matParams)
     {
+        typedef typename FluidState::Scalar Evaluation;
+
         // calculate the saturation of the last phase as a function of
         // the other saturations
-        Scalar sumSat = 0.0;
+        Evaluation sumSat = 0.0;
         for (int phaseIdx = 0; phaseIdx < numPhases - 1; ++phaseIdx)
             sumSat += fluidState.saturation(phaseIdx);
 
@@ -370,7 +744,7 @@ protected:
             // negative
             for (int phaseIdx = 0; phaseIdx < numPhases - 1; ++phaseIdx)
             {
-                Scalar S = fluidState.saturation(phaseIdx);
+                Evaluation S = fluidState.saturation(phaseIdx);
                 fluidState.setSaturation(phaseIdx, S/sumSat);
             }
             sumSat = 1;
@@ -382,7 +756,7 @@ protected:
         // update the pressures using the material law (saturations
         // and first pressure are already set because it is implicitly
         // solved for.)
-        ComponentVector pC;
+        Dune::FieldVector<Evaluation, numPhases> pC;
         MaterialLaw::capillaryPressures(pC, matParams, fluidState);
         for (int phaseIdx = 1; phaseIdx < numPhases; ++phaseIdx)
             fluidState.setPressure(phaseIdx,
@@ -394,7 +768,7 @@ protected:
 
         // update all densities
         for (int phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
-            Scalar rho = FluidSystem::density(fluidState, paramCache, phaseIdx);
+            Evaluation rho = FluidSystem::density(fluidState, paramCache, phaseIdx);
             fluidState.setDensity(phaseIdx, rho);
         }
     }
@@ -515,8 +889,13 @@ protected:
             return 1.0;
         }
     }
+
+    static std::atomic<ConstraintSolverTelemetry*> telemetry_;
 };
 
+template <class Scalar, class FluidSystem>
+std::atomic<ConstraintSolverTelemetry*> ImmiscibleFlash<Scalar, FluidSystem>::telemetry_(nullptr);
+
 } // namespace Opm
 
 #endif
@@ -35,6 +35,11 @@
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
 #include <opm/material/common/Valgrind.hpp>
+#include <opm/material/constraintsolvers/ConstraintSolverStatus.hpp>
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
 
 namespace Opm {
 
@@ -132,6 +137,9 @@ class MiscibleMultiPhaseComposition
 
 
 public:
+    //! The outcome of the trySolve() methods
+    typedef Opm::ConstraintSolverStatus<Scalar> SolverStatus;
+
     /*!
      * \brief Computes the composition of all phases of a N-phase,
      *        N-component fluid system assuming that all N phases are
@@ -154,15 +162,20 @@ public:
      * - fugacity coefficients of *all* components in *all* phases
      * - if the setViscosity parameter is true, also dynamic viscosities of *all* phases
      * - if the setInternalEnergy parameter is true, also specific enthalpies and internal energies of *all* phases
+     *
+     * Since the mole fractions are determined by a linear system of equations, the
+     * only way for this to fail is a singular matrix. This is reported by the returned
+     * status object instead of an exception, and the fluid state is left unchanged
+     * except for the fugacity coefficients.
      */
     template <class FluidState, class ParameterCache>
-    static void solve(FluidState &fluidState,
-                      ParameterCache &paramCache,
-                      int phasePresence,
-                      const MMPCAuxConstraint<Evaluation> *auxConstraints,
-                      int numAuxConstraints,
-                      bool setViscosity,
-                      bool setInternalEnergy)
+    static SolverStatus trySolve(FluidState &fluidState,
+                                 ParameterCache &paramCache,
+                                 int phasePresence,
+                                 const MMPCAuxConstraint<Evaluation> *auxConstraints,
+                                 int numAuxConstraints,
+                                 bool setViscosity,
+                                 bool setInternalEnergy)
     {
         typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
         static_assert(std::is_same<typename FluidState::Scalar, Evaluation>::value,
@@ -192,11 +205,134 @@ public:
             }
         }
 
+        // calculate the mole fractions. for two phases and two components, this is
+        // done in closed form.
+        Dune::FieldVector<Evaluation, numEq> x(Toolbox::createConstant(0.0));
+        SolverStatus status;
+        status.iterations = 1;
+        if (!calculateMoleFractions_(x, fluidState, phasePresence, auxConstraints, numAuxConstraints,
+                                     std::integral_constant<bool, numPhases == 2 && numComponents == 2>()))
+        {
+            status.result = SolverStatus::SingularMatrix;
+            return status;
+        }
+        status.result = SolverStatus::Converged;
+        status.residual = 0.0;
+
+        // set all mole fractions and the additional quantities in
+        // the fluid state
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+                int rowIdx = phaseIdx*numComponents + compIdx;
+                fluidState.setMoleFraction(phaseIdx, compIdx, x[rowIdx]);
+            }
+            paramCache.updateComposition(fluidState, phaseIdx);
+
+            const Evaluation& rho = FluidSystem::density(fluidState, paramCache, phaseIdx);
+            fluidState.setDensity(phaseIdx, rho);
+
+            if (setViscosity) {
+                const Evaluation& mu = FluidSystem::viscosity(fluidState, paramCache, phaseIdx);
+                fluidState.setViscosity(phaseIdx, mu);
+            }
+
+            if (setInternalEnergy) {
+                const Evaluation& h =  FluidSystem::enthalpy(fluidState, paramCache, phaseIdx);
+                fluidState.setEnthalpy(phaseIdx, h);
+            }
+        }
+
+        return status;
+    }
+
+    /*!
+     * \brief Computes the composition of all phases of a N-phase,
+     *        N-component fluid system assuming that all N phases are
+     *        present
+     *
+     * This does the same as trySolve(), but a NumericalIssue exception is thrown if
+     * the calculation fails.
+     */
+    template <class FluidState, class ParameterCache>
+    static void solve(FluidState &fluidState,
+                      ParameterCache &paramCache,
+                      int phasePresence,
+                      const MMPCAuxConstraint<Evaluation> *auxConstraints,
+                      int numAuxConstraints,
+                      bool setViscosity,
+                      bool setInternalEnergy)
+    {
+        const SolverStatus& status =
+            trySolve(fluidState, paramCache, phasePresence, auxConstraints, numAuxConstraints,
+                     setViscosity, setInternalEnergy);
+        if (!status.converged())
+            OPM_THROW(NumericalIssue,
+                      "Numerical problem in MiscibleMultiPhaseComposition::solve(): "
+                      "singular matrix");
+    }
+
+    /*!
+     * \brief Computes the composition of all phases of a N-phase,
+     *        N-component fluid system assuming that all N phases are
+     *        present
+     *
+     * This is a convenience method where no auxiliary constraints are used.
+     */
+    template <class FluidState, class ParameterCache>
+    static SolverStatus trySolve(FluidState &fluidState,
+                                 ParameterCache &paramCache,
+                                 bool setViscosity,
+                                 bool setInternalEnergy)
+    {
+        return trySolve(fluidState,
+                        paramCache,
+                        /*phasePresence=*/0xffffff,
+                        /*auxConstraints=*/0,
+                        /*numAuxConstraints=*/0,
+                        setViscosity,
+                        setInternalEnergy);
+    }
+
+    /*!
+     * \brief Computes the composition of all phases of a N-phase,
+     *        N-component fluid system assuming that all N phases are
+     *        present
+     *
+     * This is a convenience method where no auxiliary constraints are used.
+     */
+    template <class FluidState, class ParameterCache>
+    static void solve(FluidState &fluidState,
+                      ParameterCache &paramCache,
+                      bool setViscosity,
+                      bool setInternalEnergy)
+    {
+        solve(fluidState,
+              paramCache,
+              /*phasePresence=*/0xffffff,
+              /*numAuxConstraints=*/0,
+              /*auxConstraints=*/0,
+              setViscosity,
+              setInternalEnergy);
+    }
+
+private:
+    static const int numEq = numComponents*numPhases;
+
+    // calculate the mole fractions for the general case by assembling and solving
+    // the linear system of equations. the mole fraction of component compIdx in phase
+    // phaseIdx is stored at x[phaseIdx*numComponents + compIdx]. returns false if the
+    // system is singular.
+    template <class FluidState>
+    static bool calculateMoleFractions_(Dune::FieldVector<Evaluation, numEq>& x,
+                                        const FluidState &fluidState,
+                                        int phasePresence,
+                                        const MMPCAuxConstraint<Evaluation> *auxConstraints,
+                                        int numAuxConstraints,
+                                        std::false_type /*isTwoPhaseTwoComponent*/)
+    {
         // create the linear system of equations which defines the
         // mole fractions
-        static const int numEq = numComponents*numPhases;
         Dune::FieldMatrix<Evaluation, numEq, numEq> M(Toolbox::createConstant(0.0));
-        Dune::FieldVector<Evaluation, numEq> x(Toolbox::createConstant(0.0));
         Dune::FieldVector<Evaluation, numEq> b(Toolbox::createConstant(0.0));
 
         // assemble the equations expressing the fact that the
@@ -251,63 +387,73 @@ public:
         }
 
         // solve for all mole fractions
-        try {
-            Dune::FMatrixPrecision<Scalar>::set_singular_limit(1e-50);
-            M.solve(x, b);
-        }
-        catch (const Dune::FMatrixError &e) {
-            OPM_THROW(NumericalIssue,
-                      "Numerical problem in MiscibleMultiPhaseComposition::solve(): " << e.what() << "; M="<<M);
-        }
-        catch (...) {
-            throw;
-        }
-
+        return solveLinearSystemNoThrow(M, x, b, Scalar(1e-50));
+    }
 
-        // set all mole fractions and the additional quantities in
-        // the fluid state
+    // calculate the mole fractions for two phases and two components in closed form.
+    //
+    // the equality of the fugacities of component k reads x_1k = K_k*x_0k with K_k =
+    // phi_0k*p_0/(phi_1k*p_1). thus, both the closure conditions of the present phases
+    // and the auxiliary constraints are linear equations in x_00 and x_01: "sum_k
+    // x_0k = 1", "sum_k K_k*x_0k = 1", "x_0k = v" and "K_k*x_0k = v". the resulting
+    // 2x2 system is solved using Cramer's rule.
+    template <class FluidState>
+    static bool calculateMoleFractions_(Dune::FieldVector<Evaluation, numEq>& x,
+                                        const FluidState &fluidState,
+                                        int phasePresence,
+                                        const MMPCAuxConstraint<Evaluation> *auxConstraints,
+                                        int numAuxConstraints,
+                                        std::true_type /*isTwoPhaseTwoComponent*/)
+    {
+        Evaluation K[numComponents];
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            K[compIdx] =
+                (fluidState.fugacityCoefficient(/*phaseIdx=*/0, compIdx)*fluidState.pressure(/*phaseIdx=*/0))
+                / (fluidState.fugacityCoefficient(/*phaseIdx=*/1, compIdx)*fluidState.pressure(/*phaseIdx=*/1));
+
+        // the coefficients of x_00 and x_01 and the right hand sides of the two
+        // equations
+        Evaluation a[2][2];
+        Evaluation c[2];
+        int eqIdx = 0;
         for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
-            for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
-                int rowIdx = phaseIdx*numComponents + compIdx;
-                fluidState.setMoleFraction(phaseIdx, compIdx, x[rowIdx]);
-            }
-            paramCache.updateComposition(fluidState, phaseIdx);
+            if (!(phasePresence & (1 << phaseIdx)))
+                continue;
 
-            const Evaluation& rho = FluidSystem::density(fluidState, paramCache, phaseIdx);
-            fluidState.setDensity(phaseIdx, rho);
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                a[eqIdx][compIdx] = (phaseIdx == 0) ? Toolbox::createConstant(1.0) : K[compIdx];
+            c[eqIdx] = Toolbox::createConstant(1.0);
+            ++eqIdx;
+        }
 
-            if (setViscosity) {
-                const Evaluation& mu = FluidSystem::viscosity(fluidState, paramCache, phaseIdx);
-                fluidState.setViscosity(phaseIdx, mu);
-            }
+        assert(eqIdx + numAuxConstraints == numComponents);
 
-            if (setInternalEnergy) {
-                const Evaluation& h =  FluidSystem::enthalpy(fluidState, paramCache, phaseIdx);
-                fluidState.setEnthalpy(phaseIdx, h);
+        for (int auxEqIdx = 0; auxEqIdx < numAuxConstraints; ++auxEqIdx) {
+            int phaseIdx = auxConstraints[auxEqIdx].phaseIdx();
+            int auxCompIdx = auxConstraints[auxEqIdx].compIdx();
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+                if (compIdx != auxCompIdx)
+                    a[eqIdx][compIdx] = Toolbox::createConstant(0.0);
+                else
+                    a[eqIdx][compIdx] = (phaseIdx == 0) ? Toolbox::createConstant(1.0) : K[compIdx];
             }
+            c[eqIdx] = auxConstraints[auxEqIdx].value();
+            ++eqIdx;
         }
-    }
 
-    /*!
-     * \brief Computes the composition of all phases of a N-phase,
-     *        N-component fluid system assuming that all N phases are
-     *        present
-     *
-     * This is a convenience method where no auxiliary constraints are used.
-     */
-    template <class FluidState, class ParameterCache>
-    static void solve(FluidState &fluidState,
-                      ParameterCache &paramCache,
-                      bool setViscosity,
-                      bool setInternalEnergy)
-    {
-        solve(fluidState,
-              paramCache,
-              /*phasePresence=*/0xffffff,
-              /*numAuxConstraints=*/0,
-              /*auxConstraints=*/0,
-              setViscosity,
-              setInternalEnergy);
+        const Evaluation& det = a[0][0]*a[1][1] - a[0][1]*a[1][0];
+        const Scalar detScale =
+            std::abs(Toolbox::value(a[0][0]*a[1][1])) + std::abs(Toolbox::value(a[0][1]*a[1][0]));
+        if (!(std::abs(Toolbox::value(det)) > std::numeric_limits<Scalar>::epsilon()*detScale))
+            return false;
+
+        const Evaluation& x00 = (c[0]*a[1][1] - a[0][1]*c[1])/det;
+        const Evaluation& x01 = (a[0][0]*c[1] - c[0]*a[1][0])/det;
+        x[0] = x00;
+        x[1] = x01;
+        x[2] = K[0]*x00;
+        x[3] = K[1]*x01;
+        return true;
     }
 };
 
@@ -28,16 +28,32 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <opm/material/constraintsolvers/ConstraintSolverCorpus.hpp>
+#include <opm/material/constraintsolvers/ConstraintSolverStatus.hpp>
+#include <opm/material/constraintsolvers/ConstraintSolverTelemetry.hpp>
+#include <opm/material/constraintsolvers/PhaseStabilityTest.hpp>
 #include <opm/material/fluidmatrixinteractions/NullMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
+#include <opm/material/fluidstates/CompositionalFluidState.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
 #include <opm/material/common/MathToolbox.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/Means.hpp>
+#include <opm/material/common/SmallLuDecomposition.hpp>
 #include <opm/material/common/Valgrind.hpp>
+#include <opm/material/common/Instrumentation.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
+#include <opm/material/Constants.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <limits>
 #include <iostream>
+#include <type_traits>
+#include <vector>
 
 namespace Opm {
 
@@ -79,6 +95,25 @@ namespace Opm {
  * - 1 pressure
  * - M - 1 saturations
  * - M*N mole fractions
+ *
+ * The Jacobian matrix of the system is approximated using forward differences
+ * unless the fluid system specifies that it provides exact derivatives (see
+ * BaseFluidSystem::hasExactDerivatives). In this case, it is calculated using
+ * automatic differentiation, which is cheaper and does not suffer from the
+ * truncation errors of finite differences.
+ *
+ * By default, the Newton updates are applied with the changes of the saturations,
+ * mole fractions and pressure clamped. For poor initial guesses, a backtracking line
+ * search on the scaled defect can be selected using setGlobalization().
+ *
+ * The Jacobian matrix only consists of scalar values, even if the fluid state uses
+ * function evaluations: The derivatives of the solution with regard to the variables
+ * of the evaluations are given by the implicit function theorem, i.e., by solving the
+ * linear system for the derivatives of the defect, for which the derivatives of the
+ * Jacobian matrix are not required. The matrix, the defects and the copies of the
+ * fluid state which are needed to linearize the system are kept in a workspace which
+ * is allocated once per thread, so the stack usage of a flash calculation does not
+ * grow with the number of equations.
  */
 template <class Scalar, class FluidSystem>
 class NcpFlash
@@ -91,6 +126,25 @@ class NcpFlash
     static const int numEq = numPhases*(numComponents + 1);
 
 public:
+    //! The outcome of the trySolve() methods
+    typedef Opm::ConstraintSolverStatus<Scalar> SolverStatus;
+
+    //! The accumulated outcome of trySolveParallel()
+    typedef Opm::ConstraintSolverStatistics<Scalar> SolverStatistics;
+
+    //! The accuracy which is requested from the trySolve() and solve() methods
+    typedef Opm::ConstraintSolverTolerance<Scalar> SolverTolerance;
+
+    //! The strategies to make the Newton method converge from poor initial guesses
+    enum Globalization {
+        //! Apply the Newton updates with the change of each quantity clamped
+        ClampedUpdate,
+
+        //! Additionally halve the clamped updates until the scaled defect decreases
+        //! sufficiently
+        LineSearch
+    };
+
     /*!
      * \brief Guess initial values for all quantities.
      */
@@ -121,136 +175,396 @@ public:
         // set the fugacity coefficients of all components in all phases
         paramCache.updateAll(fluidState);
         for (int phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
-            for (int compIdx = 0; compIdx < numComponents; ++ compIdx) {
-                const typename FluidState::Scalar phi =
-                    FluidSystem::fugacityCoefficient(fluidState, paramCache, phaseIdx, compIdx);
-                fluidState.setFugacityCoefficient(phaseIdx, compIdx, phi);
-            }
+            typename FluidState::Scalar phi[numComponents];
+            FluidSystem::fugacityCoefficients(fluidState, paramCache, phaseIdx, phi);
+            for (int compIdx = 0; compIdx < numComponents; ++ compIdx)
+                fluidState.setFugacityCoefficient(phaseIdx, compIdx, phi[compIdx]);
         }
     }
 
     /*!
-     * \brief Calculates the chemical equilibrium from the component
-     *        fugacities in a phase.
+     * \brief Use the solution of a previous flash calculation as initial guess.
+     *
+     * The pressures, saturations and compositions of all phases are taken from the
+     * previous fluid state, while the temperature of the fluid state is kept. If the
+     * conditions did not change much since the previous solution, e.g. between two
+     * time steps, this usually requires considerably less Newton iterations than
+     * guessInitial().
+     */
+    template <class FluidState, class PrevFluidState>
+    static void guessFromPrevious(FluidState &fluidState,
+                                  ParameterCache &paramCache,
+                                  const PrevFluidState &prevFluidState)
+    {
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            for (int compIdx = 0; compIdx < numComponents; ++ compIdx)
+                fluidState.setMoleFraction(phaseIdx,
+                                           compIdx,
+                                           prevFluidState.moleFraction(phaseIdx, compIdx));
+
+            fluidState.setPressure(phaseIdx, prevFluidState.pressure(phaseIdx));
+            fluidState.setSaturation(phaseIdx, prevFluidState.saturation(phaseIdx));
+        }
+
+        // set the fugacity coefficients of all components in all phases
+        paramCache.updateAll(fluidState);
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            typename FluidState::Scalar phi[numComponents];
+            FluidSystem::fugacityCoefficients(fluidState, paramCache, phaseIdx, phi);
+            for (int compIdx = 0; compIdx < numComponents; ++ compIdx)
+                fluidState.setFugacityCoefficient(phaseIdx, compIdx, phi[compIdx]);
+        }
+    }
+
+    /*!
+     * \brief Returns true if a fluid state already is a solution of the flash
+     *        calculation for the given total molarities.
      *
-     * The phase's fugacities must already be set.
+     * This only evaluates the residual of the flash equations, which is much cheaper
+     * than a Newton iteration. It is intended to be used after guessFromPrevious(): if
+     * the previous solution is still valid, the call to solve() can be skipped. The
+     * fugacity differences are compared relative to the fugacities, the total
+     * molarities relative to their sum and the complementarity conditions are
+     * compared absolutely.
+     *
+     * The fluid state is made consistent with the fluid system and the material law
+     * in any case, i.e., its densities, fugacity coefficients and the pressures and the
+     * saturation of the last phase are updated.
      */
     template <class MaterialLaw, class FluidState>
-    static void solve(FluidState &fluidState,
-                      ParameterCache &paramCache,
-                      const typename MaterialLaw::Params &matParams,
-                      const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
-                      Scalar tolerance = 0.0)
+    static bool isConverged(FluidState &fluidState,
+                            ParameterCache &paramCache,
+                            const typename MaterialLaw::Params &matParams,
+                            const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
+                            Scalar tolerance = 0.0)
     {
-        typedef typename FluidState::Scalar Evaluation;
-        typedef Dune::FieldMatrix<Evaluation, numEq, numEq> Matrix;
-        typedef Dune::FieldVector<Evaluation, numEq> Vector;
+        if (tolerance <= 0.0)
+            tolerance = 1e-9;
+
+        completeFluidState_<MaterialLaw>(fluidState, paramCache, matParams);
+
+        return defectNorm_(fluidState, globalMolarities) <= tolerance;
+    }
+
+    /*!
+     * \brief Attach a telemetry object to the flash solver.
+     *
+     * If the telemetry object is not null, each call of trySolve() and solve() records
+     * its number of iterations, the scaled defect of the final state (see
+     * isConverged()), the number of iterations in which the Newton update was clamped
+     * and its wall time. The batched flash calculations are not recorded. The object
+     * is used by all threads and must stay alive until it is detached by passing a
+     * null pointer.
+     */
+    static void setTelemetry(ConstraintSolverTelemetry* telemetry)
+    { telemetry_.store(telemetry, std::memory_order_release); }
+
+    /*!
+     * \brief Returns the telemetry object which is attached to the flash solver.
+     *
+     * If no telemetry object is attached, a null pointer is returned.
+     */
+    static ConstraintSolverTelemetry* telemetry()
+    { return telemetry_.load(std::memory_order_acquire); }
+
+    /*!
+     * \brief Attach a corpus to the flash solver.
+     *
+     * If the corpus is not null, the inputs of the calls of trySolve() and solve()
+     * which are difficult (cf. ConstraintSolverCorpus) are recorded, so that they can
+     * be repeated using replay(). The batched flash calculations are not recorded.
+     * The object is used by all threads and must stay alive until it is detached by
+     * passing a null pointer.
+     */
+    static void setCorpus(ConstraintSolverCorpus* corpus)
+    { corpus_.store(corpus, std::memory_order_release); }
 
-        Dune::FMatrixPrecision<Scalar>::set_singular_limit(1e-35);
+    /*!
+     * \brief Returns the corpus which is attached to the flash solver.
+     *
+     * If no corpus is attached, a null pointer is returned.
+     */
+    static ConstraintSolverCorpus* corpus()
+    { return corpus_.load(std::memory_order_acquire); }
 
-        if (tolerance <= 0.0) {
-            tolerance = std::min<Scalar>(1e-10,
-                                         Opm::geometricMean(Scalar(1.0),
-                                                            std::numeric_limits<Scalar>::epsilon()));
+    /*!
+     * \brief The name of the solver in the records of a ConstraintSolverCorpus.
+     */
+    static const char* corpusName()
+    { return "NcpFlash"; }
+
+    /*!
+     * \brief Repeat a flash calculation which was recorded by a corpus.
+     *
+     * The flash is started from the initial guess of the recorded call, using the
+     * tolerance and the iteration budget of that call. The record must have been
+     * captured using the same fluid system, and the parameters of the material law are
+     * not part of the record, i.e., they must be specified by the caller. Neither the
+     * attached telemetry object nor the attached corpus record the replayed call. If
+     * the record is not compatible with the solver, a std::runtime_error is thrown.
+     *
+     * \param fluidState The fluid state which receives the result
+     * \param record The record of the call
+     * \param matParams The parameters of the material law
+     */
+    template <class MaterialLaw>
+    static SolverStatus replay(CompositionalFluidState<Scalar, FluidSystem>& fluidState,
+                               const ConstraintSolverCorpus::Record& record,
+                               const typename MaterialLaw::Params& matParams)
+    {
+        if (record.solver != corpusName()
+            || record.input.size() != static_cast<size_t>(corpusInputSize_()))
+            OPM_THROW(std::runtime_error,
+                      "The record of the " << record.solver << " solver with "
+                      << record.input.size() << " inputs can not be replayed by "
+                      << corpusName() << " for " << numPhases << " phases and "
+                      << numComponents << " components");
+
+        const double* input = record.input.data();
+        SolverTolerance tolerance(input[0], static_cast<int>(input[1]));
+        input += 2;
+
+        fluidState.setTemperature(*input++);
+        Dune::FieldVector<Scalar, numComponents> globalMolarities;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            globalMolarities[compIdx] = *input++;
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            fluidState.setPressure(phaseIdx, *input++);
+            fluidState.setSaturation(phaseIdx, *input++);
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                fluidState.setMoleFraction(phaseIdx, compIdx, *input++);
         }
 
-        /////////////////////////
-        // Newton method
-        /////////////////////////
+        ParameterCache paramCache;
+        paramCache.updateAll(fluidState);
+        return trySolve_<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities,
+                                      tolerance, /*numClamped=*/nullptr);
+    }
 
-        // Jacobian matrix
-        Matrix J;
-        // solution, i.e. phase composition
-        Vector deltaX;
-        // right hand side
-        Vector b;
+    /*!
+     * \brief Select the strategy which is used to apply the Newton updates.
+     *
+     * With the line search, a clamped Newton update is only accepted if it reduces the
+     * Euclidean norm of the scaled defect (see isConverged()) sufficiently and if the
+     * fluid system can be evaluated for the updated state. Else it is halved up to
+     * four times, which costs an evaluation of the fluid system for each rejected
+     * update. This makes the flash converge more often if it is started far from the
+     * solution, e.g., from guessInitial(). For good initial guesses it usually needs
+     * more iterations than the clamped updates, though: due to the complementarity
+     * conditions, the defect often grows before the Newton method converges. The
+     * strategy applies to all flash calculations of all threads, the default is
+     * ClampedUpdate.
+     */
+    static void setGlobalization(Globalization globalization)
+    { globalization_.store(globalization, std::memory_order_relaxed); }
 
-        Valgrind::SetUndefined(J);
-        Valgrind::SetUndefined(deltaX);
-        Valgrind::SetUndefined(b);
+    //! Returns the strategy which is used to apply the Newton updates
+    static Globalization globalization()
+    { return globalization_.load(std::memory_order_relaxed); }
 
-        // make the fluid state consistent with the fluid system.
-        completeFluidState_<MaterialLaw>(fluidState,
-                                         paramCache,
-                                         matParams);
+    /*!
+     * \brief Tries to find a single-phase solution of the flash calculation.
+     *
+     * For each fluid phase, the pressure at which this phase alone holds the given
+     * total molarities is determined and the phase is checked for thermodynamic
+     * stability using the tangent plane distance criterion (see
+     * PhaseStabilityTest). The compositions of the absent phases are set to the
+     * stationary points found by the stability test, so that a stable phase yields a
+     * solution of the NCP system without any Newton iterations.
+     *
+     * If true is returned, the fluid state is a solution of the flash and the call
+     * to solve() can be skipped. Otherwise, the fluid state must be initialized
+     * using guessInitial() before solve() is called. Only the temperature of the
+     * fluid state needs to be set.
+     */
+    template <class MaterialLaw, class FluidState>
+    static bool solveSinglePhase(FluidState &fluidState,
+                                 ParameterCache &paramCache,
+                                 const typename MaterialLaw::Params &matParams,
+                                 const Dune::FieldVector<Scalar, numComponents>& globalMolarities,
+                                 Scalar tolerance = 0.0)
+    {
+        static_assert(std::is_same<typename FluidState::Scalar, Scalar>::value,
+                      "The single-phase flash only works for fluid states which use the "
+                      "scalar type of the solver");
+        typedef Opm::PhaseStabilityTest<Scalar, FluidSystem> StabilityTest;
 
-        /*
-        std::cout << "--------------------\n";
-        std::cout << "globalMolarities: ";
-        for (int compIdx = 0; compIdx < numComponents; ++ compIdx)
-            std::cout << globalMolarities[compIdx] << " ";
-        std::cout << "\n";
-        */
-        const int nMax = 50; // <- maximum number of newton iterations
-        for (int nIdx = 0; nIdx < nMax; ++nIdx) {
-            // calculate Jacobian matrix and right hand side
-            linearize_<MaterialLaw>(J,
-                                    b,
-                                    fluidState,
-                                    paramCache,
-                                    matParams,
-                                    globalMolarities);
-            Valgrind::CheckDefined(J);
-            Valgrind::CheckDefined(b);
-
-            // Solve J*x = b
-            deltaX = 0;
-
-            try { J.solve(deltaX, b); }
-            catch (Dune::FMatrixError e)
-            {
-                /*
-                printFluidState_(fluidState);
-                std::cout << "error: " << e << "\n";
-                std::cout << "b: " << b << "\n";
-                std::cout << "J: " << J << "\n";
-                */
-
-                throw Opm::NumericalIssue(e.what());
-            }
-            Valgrind::CheckDefined(deltaX);
-
-            /*
-            printFluidState_(fluidState);
-            std::cout << "J:\n";
-            for (int i = 0; i < numEq; ++i) {
-                for (int j = 0; j < numEq; ++j) {
-                    std::ostringstream os;
-                    os << J[i][j];
-
-                    std::string s(os.str());
-                    do {
-                        s += " ";
-                    } while (s.size() < 20);
-                    std::cout << s;
-                }
-                std::cout << "\n";
+        Scalar sumMolarities = 0.0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            sumMolarities += globalMolarities[compIdx];
+        if (!(sumMolarities > 0.0))
+            return false;
+
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            // the phase holds everything. the compositions of the other phases are
+            // determined by the stability test, but they must be defined before
+            for (int otherPhaseIdx = 0; otherPhaseIdx < numPhases; ++otherPhaseIdx) {
+                fluidState.setSaturation(otherPhaseIdx, (otherPhaseIdx == phaseIdx)?1.0:0.0);
+                for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                    fluidState.setMoleFraction(otherPhaseIdx, compIdx,
+                                               globalMolarities[compIdx]/sumMolarities);
             }
 
-            std::cout << "deltaX: " << deltaX << "\n";
-            std::cout << "---------------\n";
-            */
+            // the capillary pressures only depend on the saturations, so they are
+            // constant for the single-phase state
+            Dune::FieldVector<Scalar, numPhases> pC;
+            MaterialLaw::capillaryPressures(pC, matParams, fluidState);
 
-            // update the fluid quantities.
-            //update_<MaterialLaw>(fluidState, paramCache, matParams, deltaX);
-            Scalar relError = update_<MaterialLaw>(fluidState, paramCache, matParams, deltaX);
+            if (!findSinglePhasePressure_(fluidState, paramCache, phaseIdx, pC, sumMolarities))
+                continue;
 
-            if (relError < 1e-9)
-                return;
+            if (!StabilityTest::isStable(fluidState, paramCache, phaseIdx))
+                continue;
+
+            if (isConverged<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, tolerance))
+                return true;
         }
 
-        /*
-        printFluidState_(fluidState);
-        std::cout << "globalMolarities: ";
-        for (int compIdx = 0; compIdx < numComponents; ++ compIdx)
-            std::cout << globalMolarities[compIdx] << " ";
-        std::cout << "\n";
-        */
+        return false;
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium from the component
+     *        fugacities in a phase without throwing exceptions.
+     *
+     * This does the same as solve(), but if the Newton method does not converge or
+     * if the Jacobian matrix becomes singular, this is reported by the returned
+     * status object instead of an exception. In this case, the fluid state contains
+     * the result of the last iteration.
+     *
+     * The Newton method stops once the relative size of its update falls below the
+     * tolerance. If the tolerance is not positive, \f$10^{-9}\f$ is used.
+     */
+    template <class MaterialLaw, class FluidState>
+    static SolverStatus trySolve(FluidState &fluidState,
+                                 ParameterCache &paramCache,
+                                 const typename MaterialLaw::Params &matParams,
+                                 const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
+                                 Scalar tolerance = 0.0)
+    {
+        return trySolve<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities,
+                                     SolverTolerance(tolerance, /*maxIterations=*/0));
+    }
 
-        OPM_THROW(NumericalIssue,
-                  "Flash calculation failed."
-                  " {c_alpha^kappa} = {" << globalMolarities << "}, T = "
-                  << fluidState.temperature(/*phaseIdx=*/0));
+    /*!
+     * \brief Calculates the chemical equilibrium using a requested accuracy and
+     *        iteration budget without throwing exceptions.
+     *
+     * This is intended for flash calculations within the iterations of an outer Newton
+     * method: The tolerance can be relaxed in proportion to the outer residual (cf.
+     * ConstraintSolverTolerance::adaptive()), so that the flash is only solved
+     * precisely once the outer method approaches convergence. The relative size of the
+     * last update, i.e., the achieved accuracy, is returned as the residual of the
+     * status object. If the iteration budget is exhausted first, the status is
+     * NotConverged, but the fluid state is consistent with the last iterate, so the
+     * caller may still use it if the achieved accuracy is sufficient.
+     */
+    template <class MaterialLaw, class FluidState>
+    static SolverStatus trySolve(FluidState &fluidState,
+                                 ParameterCache &paramCache,
+                                 const typename MaterialLaw::Params &matParams,
+                                 const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
+                                 const SolverTolerance& tolerance)
+    {
+        OPM_INSTRUMENT_SCOPE("NcpFlash::trySolve");
+        OPM_PROFILER_RANGE("NcpFlash::trySolve");
+        ConstraintSolverTelemetry* sink = telemetry();
+        ConstraintSolverCorpus* corpusSink = corpus();
+        if (!sink && !corpusSink)
+            return trySolve_<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities,
+                                          tolerance, /*numClamped=*/nullptr);
+
+        // the initial guess is overwritten by the flash, so the input must be copied
+        // before it is known whether the call needs to be recorded
+        std::vector<double>* corpusInput = nullptr;
+        if (corpusSink) {
+            corpusInput = &corpusInput_();
+            captureInput_(*corpusInput, fluidState, globalMolarities, tolerance);
+        }
+
+        ConstraintSolverTelemetry::Timer timer;
+        int numClamped = 0;
+        SolverStatus status =
+            trySolve_<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities,
+                                   tolerance, &numClamped);
+        double seconds = timer.seconds();
+        if (sink)
+            sink->record(status, defectNorm_(fluidState, globalMolarities), numClamped, seconds);
+        if (corpusSink)
+            corpusSink->record(corpusName(), status, seconds, *corpusInput);
+        return status;
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium from the component
+     *        fugacities in a phase.
+     *
+     * The phase's fugacities must already be set. If the calculation fails, a
+     * NumericalIssue exception is thrown.
+     */
+    template <class MaterialLaw, class FluidState>
+    static void solve(FluidState &fluidState,
+                      ParameterCache &paramCache,
+                      const typename MaterialLaw::Params &matParams,
+                      const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
+                      Scalar tolerance = 0.0)
+    {
+        solve<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities,
+                           SolverTolerance(tolerance, /*maxIterations=*/0));
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium using a requested accuracy and
+     *        iteration budget.
+     *
+     * If the requested accuracy is not reached within the iteration budget, a
+     * NumericalIssue exception is thrown.
+     */
+    template <class MaterialLaw, class FluidState>
+    static void solve(FluidState &fluidState,
+                      ParameterCache &paramCache,
+                      const typename MaterialLaw::Params &matParams,
+                      const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
+                      const SolverTolerance& tolerance)
+    {
+        OPM_INSTRUMENT_SCOPE("NcpFlash::solve");
+        OPM_PROFILER_RANGE("NcpFlash::solve");
+        const SolverStatus& status =
+            trySolve<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, tolerance);
+
+        if (status.result == SolverStatus::SingularMatrix)
+            OPM_THROW(NumericalIssue,
+                      "Flash calculation failed: singular Jacobian matrix."
+                      " {c_alpha^kappa} = {" << globalMolarities << "}, T = "
+                      << fluidState.temperature(/*phaseIdx=*/0));
+        else if (!status.converged())
+            OPM_THROW(NumericalIssue,
+                      "Flash calculation failed."
+                      " {c_alpha^kappa} = {" << globalMolarities << "}, T = "
+                      << fluidState.temperature(/*phaseIdx=*/0));
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium from the component
+     *        fugacities in a phase without throwing exceptions.
+     *
+     * This is a convenience method which assumes that the capillary pressure is
+     * zero...
+     */
+    template <class FluidState, class ComponentVector>
+    static SolverStatus trySolve(FluidState &fluidState,
+                                 const ComponentVector &globalMolarities,
+                                 Scalar tolerance = 0.0)
+    {
+        ParameterCache paramCache;
+        paramCache.updateAll(fluidState);
+
+        typedef NullMaterialTraits<Scalar, numPhases> MaterialTraits;
+        typedef NullMaterial<MaterialTraits> MaterialLaw;
+        typedef typename MaterialLaw::Params MaterialLawParams;
+
+        MaterialLawParams matParams;
+        return trySolve<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, tolerance);
     }
 
     /*!
@@ -276,8 +590,574 @@ public:
         solve<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, tolerance);
     }
 
+    /*!
+     * \brief Calculates the chemical equilibrium for a batch of fluid states without
+     *        throwing exceptions.
+     *
+     * This is equivalent to calling trySolve() for each fluid state, but the Newton
+     * iterations of the fluid states are done in lock-step: The linear systems of all
+     * fluid states which have not yet converged are stored interleaved (i.e., the
+     * index of the fluid state is the innermost one) and they are solved by a single
+     * Gaussian elimination whose inner loops run over the fluid states and can thus be
+     * vectorized by the compiler. Fluid states which have converged or failed are
+     * removed from the batch, i.e., a failure of one fluid state does not affect the
+     * others.
+     *
+     * This method is only available for fluid states which use Scalar, i.e., it does
+     * not compute derivatives.
+     *
+     * \param fluidStates The array of the n fluid states. They must already contain
+     *                    an initial guess (cf. guessInitial()).
+     * \param paramCaches The array of the parameter caches of the fluid states
+     * \param matParams An array of pointers to the parameters of the material law for
+     *                  each fluid state
+     * \param globalMolarities The array of the total molarities of the components for
+     *                         each fluid state
+     * \param statuses The array which receives the outcome for each fluid state
+     * \param n The number of fluid states
+     *
+     * \return The number of fluid states for which the calculation failed
+     */
+    template <class MaterialLaw, class FluidState, class ComponentVector>
+    static size_t trySolveBatch(FluidState* fluidStates,
+                                ParameterCache* paramCaches,
+                                const typename MaterialLaw::Params* const* matParams,
+                                const ComponentVector* globalMolarities,
+                                SolverStatus* statuses,
+                                size_t n,
+                                Scalar tolerance = 0.0)
+    {
+        OPM_INSTRUMENT_SCOPE("NcpFlash::trySolveBatch");
+        OPM_PROFILER_RANGE("NcpFlash::trySolveBatch");
+        static_assert(std::is_same<typename FluidState::Scalar, Scalar>::value,
+                      "The batched flash only supports fluid states which use Scalar");
+
+        // like for trySolve(), convergence is determined by the relative size of the
+        // Newton update
+        if (tolerance <= 0.0)
+            tolerance = defaultTolerance_();
+
+        typedef Dune::FieldVector<Scalar, numEq> Vector;
+
+        // the interleaved linear systems: entry (i, j) of the matrix of the l-th active
+        // fluid state is stored at J[(i*numEq + j)*batchChunkSize_ + l]. they are kept
+        // in the workspace of the thread, so they are only allocated by the first call.
+        Workspace_<FluidState>& ws = workspace_<FluidState>();
+        std::vector<Scalar>& J = ws.batchJ;
+        std::vector<Scalar>& b = ws.batchB;
+        std::vector<Scalar>& x = ws.batchX;
+        std::vector<bool>& singular = ws.batchSingular;
+        std::vector<size_t>& active = ws.batchActive;
+        J.resize(numEq*numEq*batchChunkSize_);
+        b.resize(numEq*batchChunkSize_);
+        x.resize(numEq*batchChunkSize_);
+        singular.resize(batchChunkSize_);
+        active.reserve(batchChunkSize_);
+
+        Vector deltaX;
+
+        size_t numFailed = 0;
+        for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += batchChunkSize_) {
+            size_t chunkSize = std::min<size_t>(batchChunkSize_, n - chunkBegin);
+
+            active.clear();
+            for (size_t i = 0; i < chunkSize; ++i) {
+                size_t idx = chunkBegin + i;
+                completeFluidState_<MaterialLaw>(fluidStates[idx], paramCaches[idx], *matParams[idx]);
+                statuses[idx] = SolverStatus();
+                active.push_back(idx);
+            }
+
+            const int nMax = defaultMaxIterations_();
+            for (int nIdx = 0; nIdx < nMax && !active.empty(); ++nIdx) {
+                size_t numActive = active.size();
+
+                // linearize the systems of all active fluid states
+                for (size_t l = 0; l < numActive; ++l) {
+                    size_t idx = active[l];
+                    linearize_<MaterialLaw>(ws,
+                                            fluidStates[idx],
+                                            paramCaches[idx],
+                                            *matParams[idx],
+                                            globalMolarities[idx]);
+
+                    for (int i = 0; i < numEq; ++i) {
+                        for (int j = 0; j < numEq; ++j)
+                            J[(i*numEq + j)*batchChunkSize_ + l] = ws.J[i][j];
+                        b[i*batchChunkSize_ + l] = ws.b[i];
+                    }
+                }
+
+                // solve all of them at once
+                solveInterleaved_(J.data(), b.data(), x.data(), singular, numActive);
+
+                // update the fluid states and remove the ones which have converged or
+                // failed
+                size_t numStillActive = 0;
+                for (size_t l = 0; l < numActive; ++l) {
+                    size_t idx = active[l];
+                    if (singular[l]) {
+                        statuses[idx].result = SolverStatus::SingularMatrix;
+                        ++numFailed;
+                        continue;
+                    }
+
+                    for (int i = 0; i < numEq; ++i)
+                        deltaX[i] = x[i*batchChunkSize_ + l];
+                    if (!isFiniteVector(deltaX)) {
+                        ++numFailed;
+                        continue;
+                    }
+
+                    Scalar relError = applyUpdate_<MaterialLaw>(fluidStates[idx], paramCaches[idx], *matParams[idx],
+                                                                globalMolarities[idx], deltaX);
+                    statuses[idx].iterations = nIdx + 1;
+                    statuses[idx].residual = relError;
+                    if (relError < tolerance)
+                        statuses[idx].result = SolverStatus::Converged;
+                    else
+                        active[numStillActive++] = idx;
+                }
+                active.resize(numStillActive);
+            }
+
+            // the remaining ones did not converge. their status already says so.
+            numFailed += active.size();
+        }
+
+        return numFailed;
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium for a batch of fluid states.
+     *
+     * This is equivalent to calling solve() for each fluid state, but the Newton
+     * iterations are done in lock-step, see trySolveBatch(). If the flash calculation
+     * fails for any of the fluid states, a NumericalIssue exception is thrown.
+     *
+     * \param fluidStates The array of the n fluid states. They must already contain
+     *                    an initial guess (cf. guessInitial()).
+     * \param paramCaches The array of the parameter caches of the fluid states
+     * \param matParams An array of pointers to the parameters of the material law for
+     *                  each fluid state
+     * \param globalMolarities The array of the total molarities of the components for
+     *                         each fluid state
+     * \param n The number of fluid states
+     */
+    template <class MaterialLaw, class FluidState, class ComponentVector>
+    static void solveBatch(FluidState* fluidStates,
+                           ParameterCache* paramCaches,
+                           const typename MaterialLaw::Params* const* matParams,
+                           const ComponentVector* globalMolarities,
+                           size_t n,
+                           Scalar tolerance = 0.0)
+    {
+        OPM_INSTRUMENT_SCOPE("NcpFlash::solveBatch");
+        OPM_PROFILER_RANGE("NcpFlash::solveBatch");
+        std::vector<SolverStatus> statuses(n);
+        if (trySolveBatch<MaterialLaw>(fluidStates, paramCaches, matParams, globalMolarities,
+                                       statuses.data(), n, tolerance) == 0)
+            return;
+
+        for (size_t idx = 0; idx < n; ++idx) {
+            if (statuses[idx].result == SolverStatus::SingularMatrix)
+                OPM_THROW(NumericalIssue,
+                          "Flash calculation failed: singular Jacobian matrix for"
+                          " fluid state " << idx);
+            else if (!statuses[idx].converged())
+                OPM_THROW(NumericalIssue,
+                          "Flash calculation failed for fluid state " << idx << "."
+                          " {c_alpha^kappa} = {" << globalMolarities[idx] << "}, T = "
+                          << fluidStates[idx].temperature(/*phaseIdx=*/0));
+        }
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium for a batch of fluid states.
+     *
+     * This is a convenience method which assumes that the capillary pressure is
+     * zero...
+     */
+    template <class FluidState, class ComponentVector>
+    static void solveBatch(FluidState* fluidStates,
+                           const ComponentVector* globalMolarities,
+                           size_t n,
+                           Scalar tolerance = 0.0)
+    {
+        OPM_INSTRUMENT_SCOPE("NcpFlash::solveBatch");
+        OPM_PROFILER_RANGE("NcpFlash::solveBatch");
+        typedef NullMaterialTraits<Scalar, numPhases> MaterialTraits;
+        typedef NullMaterial<MaterialTraits> MaterialLaw;
+        typedef typename MaterialLaw::Params MaterialLawParams;
+
+        MaterialLawParams matParams;
+        std::vector<ParameterCache> paramCaches(n);
+        std::vector<const MaterialLawParams*> matParamsPtrs(n, &matParams);
+        for (size_t i = 0; i < n; ++i)
+            paramCaches[i].updateAll(fluidStates[i]);
+
+        solveBatch<MaterialLaw>(fluidStates,
+                                paramCaches.data(),
+                                matParamsPtrs.data(),
+                                globalMolarities,
+                                n,
+                                tolerance);
+    }
+
+
+    /*!
+     * \brief Calculates the chemical equilibrium for a range of fluid states in
+     *        parallel without throwing exceptions.
+     *
+     * This is equivalent to calling trySolve() for each fluid state. If the code is
+     * compiled with OpenMP, the fluid states are distributed to the threads
+     * dynamically in chunks of parallelChunkSize_ fluid states: Since the number of
+     * Newton iterations varies considerably between fluid states, e.g., close to the
+     * critical point, a static partitioning would leave most threads idle while a
+     * few of them are still busy. The temporary space of the Newton method is local
+     * to each thread and the statistics are accumulated per thread and merged at the
+     * end.
+     *
+     * If the fluid system throws a NumericalIssue exception for a fluid state, the
+     * flash is considered to have failed for it. Other exceptions are rethrown after
+     * all fluid states have been processed.
+     *
+     * \param fluidStates The array of the n fluid states. They must already contain
+     *                    an initial guess (cf. guessInitial()).
+     * \param paramCaches The array of the parameter caches of the fluid states
+     * \param matParams An array of pointers to the parameters of the material law for
+     *                  each fluid state
+     * \param globalMolarities The array of the total molarities of the components for
+     *                         each fluid state
+     * \param statuses The array which receives the outcome for each fluid state
+     * \param n The number of fluid states
+     *
+     * \return The accumulated outcome of the flash calculations
+     */
+    template <class MaterialLaw, class FluidState, class ComponentVector>
+    static SolverStatistics trySolveParallel(FluidState* fluidStates,
+                                             ParameterCache* paramCaches,
+                                             const typename MaterialLaw::Params* const* matParams,
+                                             const ComponentVector* globalMolarities,
+                                             SolverStatus* statuses,
+                                             size_t n,
+                                             Scalar tolerance = 0.0)
+    {
+        OPM_INSTRUMENT_SCOPE("NcpFlash::trySolveParallel");
+        OPM_PROFILER_RANGE("NcpFlash::trySolveParallel");
+        SolverStatistics statistics;
+
+#ifdef _OPENMP
+        std::exception_ptr exception;
+        #pragma omp parallel
+        {
+            SolverStatistics threadStatistics;
+
+            #pragma omp for schedule(dynamic, parallelChunkSize_)
+            for (long idx = 0; idx < static_cast<long>(n); ++idx) {
+                try {
+                    statuses[idx] = trySolveNoThrow_<MaterialLaw>(fluidStates[idx],
+                                                                  paramCaches[idx],
+                                                                  *matParams[idx],
+                                                                  globalMolarities[idx],
+                                                                  tolerance);
+                }
+                catch (...) {
+                    statuses[idx] = SolverStatus();
+                    #pragma omp critical (OpmNcpFlashException)
+                    if (!exception)
+                        exception = std::current_exception();
+                }
+                threadStatistics.add(statuses[idx]);
+            }
+
+            #pragma omp critical (OpmNcpFlashStatistics)
+            statistics.merge(threadStatistics);
+        }
+
+        if (exception)
+            std::rethrow_exception(exception);
+#else
+        for (size_t idx = 0; idx < n; ++idx) {
+            statuses[idx] = trySolveNoThrow_<MaterialLaw>(fluidStates[idx],
+                                                          paramCaches[idx],
+                                                          *matParams[idx],
+                                                          globalMolarities[idx],
+                                                          tolerance);
+            statistics.add(statuses[idx]);
+        }
+#endif
+
+        return statistics;
+    }
 
 protected:
+    // the number of fluid states which are handed to a thread at once by
+    // trySolveParallel(). this is small because the cost of a flash varies a lot.
+    enum { parallelChunkSize_ = 4 };
+
+    // calls trySolve() and turns NumericalIssue exceptions thrown by the fluid
+    // system into a failed status
+    template <class MaterialLaw, class FluidState, class ComponentVector>
+    static SolverStatus trySolveNoThrow_(FluidState &fluidState,
+                                         ParameterCache &paramCache,
+                                         const typename MaterialLaw::Params &matParams,
+                                         const ComponentVector &globalMolarities,
+                                         Scalar tolerance)
+    {
+        try {
+            return trySolve<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, tolerance);
+        }
+        catch (const NumericalIssue&) {
+            return SolverStatus();
+        }
+    }
+
+    // the Newton method of trySolve(). if numClamped is not null, the number of
+    // iterations in which the update was clamped is added to it.
+    template <class MaterialLaw, class FluidState>
+    static SolverStatus trySolve_(FluidState &fluidState,
+                                  ParameterCache &paramCache,
+                                  const typename MaterialLaw::Params &matParams,
+                                  const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
+                                  const SolverTolerance& tolerance,
+                                  int* numClamped)
+    {
+        // convergence is determined by the relative size of the Newton update
+        const Scalar tol = tolerance.toleranceOr(defaultTolerance_());
+        const int nMax = tolerance.maxIterationsOr(defaultMaxIterations_());
+
+        SolverStatus status;
+        Workspace_<FluidState>& ws = workspace_<FluidState>();
+
+        /////////////////////////
+        // Newton method
+        /////////////////////////
+
+        // make the fluid state consistent with the fluid system.
+        completeFluidState_<MaterialLaw>(fluidState,
+                                         paramCache,
+                                         matParams);
+
+        for (int nIdx = 0; nIdx < nMax; ++nIdx) {
+            // calculate Jacobian matrix and right hand side
+            linearize_<MaterialLaw>(ws,
+                                    fluidState,
+                                    paramCache,
+                                    matParams,
+                                    globalMolarities);
+            Valgrind::CheckDefined(ws.J);
+            Valgrind::CheckDefined(ws.b);
+
+            // Solve J*x = b. the matrix only consists of values, so the derivatives
+            // of the solution are obtained by the same substitutions
+            if (!ws.lu.factorize(ws.J, singularLimit_())) {
+                status.result = SolverStatus::SingularMatrix;
+                return status;
+            }
+            ws.lu.solve(ws.deltaX, ws.b);
+            Valgrind::CheckDefined(ws.deltaX);
+            if (!isFiniteVector(ws.deltaX)) {
+                status.result = SolverStatus::NotConverged;
+                return status;
+            }
+
+            // update the fluid quantities.
+            Scalar relError = applyUpdate_<MaterialLaw>(fluidState, paramCache, matParams,
+                                                        globalMolarities, ws.deltaX, numClamped);
+            status.iterations = nIdx + 1;
+            status.residual = relError;
+
+            if (relError < tol) {
+                status.result = SolverStatus::Converged;
+                return status;
+            }
+        }
+
+        status.result = SolverStatus::NotConverged;
+        return status;
+    }
+
+    // the relative size of the Newton update below which a flash is considered to be
+    // converged if no tolerance is requested
+    static Scalar defaultTolerance_()
+    { return 1e-9; }
+
+    // the maximum number of Newton iterations if no iteration budget is requested
+    static int defaultMaxIterations_()
+    { return 50; }
+
+    // the number of inputs of a flash in the records of a corpus: tolerance and
+    // iteration budget, temperature, total molarities and the pressure, the
+    // saturation and the composition of each phase of the initial guess
+    static int corpusInputSize_()
+    { return 3 + numComponents + numPhases*(2 + numComponents); }
+
+    // the buffer which receives the input of a flash if a corpus is attached
+    static std::vector<double>& corpusInput_()
+    {
+        static thread_local std::vector<double> input;
+        return input;
+    }
+
+    template <class FluidState>
+    static void captureInput_(std::vector<double>& input,
+                              const FluidState& fluidState,
+                              const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
+                              const SolverTolerance& tolerance)
+    {
+        typedef typename FluidState::Scalar Evaluation;
+        typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+        input.clear();
+        input.push_back(tolerance.tolerance);
+        input.push_back(tolerance.maxIterations);
+        input.push_back(Toolbox::value(fluidState.temperature(/*phaseIdx=*/0)));
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            input.push_back(Toolbox::value(globalMolarities[compIdx]));
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            input.push_back(Toolbox::value(fluidState.pressure(phaseIdx)));
+            input.push_back(Toolbox::value(fluidState.saturation(phaseIdx)));
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                input.push_back(Toolbox::value(fluidState.moleFraction(phaseIdx, compIdx)));
+        }
+    }
+
+    // the fluid state which is used to compute the Jacobian matrix. it only stores
+    // values.
+    typedef Opm::CompositionalFluidState<Scalar, FluidSystem, /*storeEnthalpy=*/false> ValueFluidState;
+
+    // the temporary objects of a flash calculation. they are allocated once per thread
+    // and fluid state type and they are aligned to cache lines, so that neither the
+    // stack nor the cache is churned by large local objects in each call.
+    template <class FluidState>
+    struct alignas(64) Workspace_
+    {
+        typedef typename FluidState::Scalar Evaluation;
+
+        // the Jacobian matrix and its decomposition
+        Dune::FieldMatrix<Scalar, numEq, numEq> J;
+        Opm::SmallLuDecomposition<Scalar, numEq> lu;
+
+        // the defect and the Newton update. they carry the derivatives of the fluid
+        // state
+        Dune::FieldVector<Evaluation, numEq> b;
+        Dune::FieldVector<Evaluation, numEq> deltaX;
+
+        // the values of the defect, the forward differences and the total molarities
+        Dune::FieldVector<Scalar, numEq> bValue;
+        Dune::FieldVector<Scalar, numEq> tmp;
+        Dune::FieldVector<Scalar, numComponents> globalMolarities;
+
+        // the values of the fluid state which are perturbed by the forward differences
+        ValueFluidState valueFluidState;
+        ValueFluidState origFluidState;
+        ParameterCache valueParamCache;
+        ParameterCache origParamCache;
+
+        // the state at the beginning of a line search
+        FluidState lineSearchFluidState;
+        ParameterCache lineSearchParamCache;
+
+        // the interleaved linear systems of trySolveBatch()
+        std::vector<Scalar> batchJ;
+        std::vector<Scalar> batchB;
+        std::vector<Scalar> batchX;
+        std::vector<bool> batchSingular;
+        std::vector<size_t> batchActive;
+    };
+
+    template <class FluidState>
+    static Workspace_<FluidState>& workspace_()
+    {
+        static thread_local Workspace_<FluidState> workspace;
+        return workspace;
+    }
+
+    // the maximum number of fluid states which are solved in lock-step by
+    // solveBatch(). this limits the amount of temporary space required for the
+    // interleaved linear systems.
+    enum { batchChunkSize_ = 64 };
+
+    // the minimum absolute value of a pivot element of the Jacobian matrix
+    static Scalar singularLimit_()
+    { return 1e-35; }
+
+    // solve the interleaved linear systems of solveBatch() using Gaussian elimination
+    // with partial pivoting. the pivoting is done separately for each system, the
+    // elimination and the back substitution are done for all systems at once. if a
+    // system is singular, this is indicated by the singular vector and its solution is
+    // meaningless.
+    static void solveInterleaved_(Scalar* A,
+                                  Scalar* b,
+                                  Scalar* x,
+                                  std::vector<bool>& singular,
+                                  size_t numSystems)
+    {
+        const size_t stride = batchChunkSize_;
+        const Scalar singularLimit = singularLimit_();
+        Scalar factor[batchChunkSize_];
+
+        for (size_t l = 0; l < numSystems; ++l)
+            singular[l] = false;
+
+        for (int k = 0; k < numEq; ++k) {
+            // find the pivot of each system and swap it into the k-th row
+            for (size_t l = 0; l < numSystems; ++l) {
+                int pivotIdx = k;
+                Scalar pivotAbs = std::abs(A[(k*numEq + k)*stride + l]);
+                for (int i = k + 1; i < numEq; ++i) {
+                    Scalar tmp = std::abs(A[(i*numEq + k)*stride + l]);
+                    if (tmp > pivotAbs) {
+                        pivotAbs = tmp;
+                        pivotIdx = i;
+                    }
+                }
+
+                if (pivotIdx != k) {
+                    for (int j = k; j < numEq; ++j)
+                        std::swap(A[(k*numEq + j)*stride + l], A[(pivotIdx*numEq + j)*stride + l]);
+                    std::swap(b[k*stride + l], b[pivotIdx*stride + l]);
+                }
+
+                if (!(pivotAbs > singularLimit)) {
+                    // make sure that no NaNs are produced for the singular system
+                    singular[l] = true;
+                    A[(k*numEq + k)*stride + l] = 1.0;
+                }
+            }
+
+            // eliminate the entries below the pivot
+            const Scalar* pivotRow = A + k*numEq*stride;
+            for (int i = k + 1; i < numEq; ++i) {
+                Scalar* row = A + i*numEq*stride;
+                for (size_t l = 0; l < numSystems; ++l)
+                    factor[l] = row[k*stride + l]/pivotRow[k*stride + l];
+
+                for (int j = k + 1; j < numEq; ++j)
+                    for (size_t l = 0; l < numSystems; ++l)
+                        row[j*stride + l] -= factor[l]*pivotRow[j*stride + l];
+
+                for (size_t l = 0; l < numSystems; ++l)
+                    b[i*stride + l] -= factor[l]*b[k*stride + l];
+            }
+        }
+
+        // back substitution
+        for (int i = numEq - 1; i >= 0; --i) {
+            const Scalar* row = A + i*numEq*stride;
+            for (size_t l = 0; l < numSystems; ++l)
+                x[i*stride + l] = b[i*stride + l];
+
+            for (int j = i + 1; j < numEq; ++j)
+                for (size_t l = 0; l < numSystems; ++l)
+                    x[i*stride + l] -= row[j*stride + l]*x[j*stride + l];
+
+            for (size_t l = 0; l < numSystems; ++l)
+                x[i*stride + l] /= row[i*stride + l];
+        }
+    }
+
     template <class FluidState>
     static void printFluidState_(const FluidState &fluidState)
     {
@@ -323,31 +1203,107 @@ protected:
         std::cout << "\n";
     }
 
+    // the tag for the primary variables of the flash if the Jacobian matrix is
+    // calculated using automatic differentiation
+    class JacobianVarSetTag_;
+
+    // copy the values of a fluid state which are used by the flash
+    template <class FluidState>
+    static void assignValues_(ValueFluidState &valueFluidState, const FluidState &fluidState)
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> Toolbox;
+
+        valueFluidState.assign(fluidState);
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                valueFluidState.setFugacityCoefficient(phaseIdx, compIdx,
+                                                       Toolbox::value(fluidState.fugacityCoefficient(phaseIdx, compIdx)));
+    }
+
     template <class MaterialLaw,
               class FluidState,
-              class Matrix,
-              class Vector,
               class ComponentVector>
-    static void linearize_(Matrix &J,
-                           Vector &b,
-                           FluidState &fluidState,
-                           ParameterCache &paramCache,
+    static void linearize_(Workspace_<FluidState> &ws,
+                           const FluidState &fluidState,
+                           const ParameterCache &paramCache,
                            const typename MaterialLaw::Params &matParams,
                            const ComponentVector &globalMolarities)
     {
-        typedef typename FluidState::Scalar Evaluation;
+        typedef Opm::MathToolbox<typename FluidState::Scalar> Toolbox;
+
+        // the right hand side keeps the derivatives of the fluid state
+        Valgrind::SetUndefined(ws.b);
+        calculateDefect_(ws.b, fluidState, fluidState, globalMolarities);
+        Valgrind::CheckDefined(ws.b);
+
+        // the Jacobian matrix is calculated from the values of the fluid state
+        assignValues_(ws.valueFluidState, fluidState);
+        ws.valueParamCache = paramCache;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            ws.globalMolarities[compIdx] = Toolbox::value(globalMolarities[compIdx]);
 
-        FluidState origFluidState(fluidState);
-        ParameterCache origParamCache(paramCache);
+        // use the exact derivatives if the fluid system provides them
+        typedef std::integral_constant<bool, FluidSystem::hasExactDerivatives> UseExactDerivatives;
+        linearizeValues_<MaterialLaw>(ws, matParams, UseExactDerivatives());
+    }
 
-        Vector tmp;
+    // the objects which are used to calculate the Jacobian matrix using automatic
+    // differentiation. like the workspace of the flash, they are allocated once per
+    // thread.
+    typedef Opm::LocalAd::Evaluation<Scalar, JacobianVarSetTag_, numEq> FlashEval_;
+    struct alignas(64) ExactDerivativesWorkspace_
+    {
+        Opm::CompositionalFluidState<FlashEval_, FluidSystem, /*storeEnthalpy=*/false> fluidState;
+        ParameterCache paramCache;
+        Dune::FieldVector<FlashEval_, numEq> defect;
+    };
 
-        // reset jacobian
-        J = 0;
+    static ExactDerivativesWorkspace_& exactDerivativesWorkspace_()
+    {
+        static thread_local ExactDerivativesWorkspace_ workspace;
+        return workspace;
+    }
 
-        Valgrind::SetUndefined(b);
-        calculateDefect_(b, fluidState, fluidState, globalMolarities);
-        Valgrind::CheckDefined(b);
+    // calculate the Jacobian matrix using automatic differentiation
+    template <class MaterialLaw, class FluidState>
+    static void linearizeValues_(Workspace_<FluidState> &ws,
+                                 const typename MaterialLaw::Params &matParams,
+                                 std::true_type /* useExactDerivatives */)
+    {
+        ExactDerivativesWorkspace_& ews = exactDerivativesWorkspace_();
+
+        // make the primary variables of the flash the variables of the evaluation
+        ews.fluidState.assign(ws.valueFluidState);
+        for (int pvIdx = 0; pvIdx < numEq; ++ pvIdx)
+            setQuantityRaw_(ews.fluidState, pvIdx,
+                            FlashEval_::createVariable(getQuantity_(ws.valueFluidState, pvIdx), pvIdx));
+
+        ews.paramCache = ws.valueParamCache;
+        completeFluidState_<MaterialLaw>(ews.fluidState, ews.paramCache, matParams);
+
+        calculateDefect_(ews.defect, ews.fluidState, ews.fluidState, ws.globalMolarities);
+
+        for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            for (int pvIdx = 0; pvIdx < numEq; ++ pvIdx)
+                ws.J[eqIdx][pvIdx] = ews.defect[eqIdx].derivatives[pvIdx];
+        Valgrind::CheckDefined(ws.J);
+    }
+
+    // calculate the Jacobian matrix using forward differences
+    template <class MaterialLaw, class FluidState>
+    static void linearizeValues_(Workspace_<FluidState> &ws,
+                                 const typename MaterialLaw::Params &matParams,
+                                 std::false_type /* useExactDerivatives */)
+    {
+        ValueFluidState& valueFluidState = ws.valueFluidState;
+        ParameterCache& valueParamCache = ws.valueParamCache;
+
+        ws.origFluidState = valueFluidState;
+        ws.origParamCache = valueParamCache;
+
+        Valgrind::SetUndefined(ws.bValue);
+        calculateDefect_(ws.bValue, valueFluidState, valueFluidState, ws.globalMolarities);
+        Valgrind::CheckDefined(ws.bValue);
 
         ///////
         // assemble jacobian matrix
@@ -360,24 +1316,21 @@ protected:
             // forward differences
 
             // deviate the mole fraction of the i-th component
-            const Evaluation& x_i = getQuantity_(fluidState, pvIdx);
-            const Scalar eps = std::numeric_limits<Scalar>::epsilon()*1e7/(quantityWeight_(fluidState, pvIdx));
+            Scalar x_i = getQuantity_(valueFluidState, pvIdx);
+            const Scalar eps = std::numeric_limits<Scalar>::epsilon()*1e7/(quantityWeight_(valueFluidState, pvIdx));
 
-            setQuantity_<MaterialLaw>(fluidState, paramCache, matParams, pvIdx, x_i + eps);
+            setQuantity_<MaterialLaw>(valueFluidState, valueParamCache, matParams, pvIdx, x_i + eps);
 
             // compute derivative of the defect
-            calculateDefect_(tmp, origFluidState, fluidState, globalMolarities);
-            tmp -= b;
-            for (int i = 0; i < numEq; ++ i)
-                tmp[i] /= eps;
+            calculateDefect_(ws.tmp, ws.origFluidState, valueFluidState, ws.globalMolarities);
 
             // store derivative in jacobian matrix
             for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
-                J[eqIdx][pvIdx] = tmp[eqIdx];
+                ws.J[eqIdx][pvIdx] = (ws.tmp[eqIdx] - ws.bValue[eqIdx])/eps;
 
             // fluid state and parameter cache to their original values
-            fluidState = origFluidState;
-            paramCache = origParamCache;
+            valueFluidState = ws.origFluidState;
+            valueParamCache = ws.origParamCache;
 
             // end forward differences
             ////////
@@ -442,11 +1395,143 @@ protected:
         }
     }
 
+    // calculate the absolute values of the defects of a consistent fluid state divided
+    // by their scales, see isConverged(). the scales of the fugacity differences are
+    // taken from scaleFluidState unless they are zero there. zero defects are zero
+    // regardless of the scale
+    template <class FluidState, class ComponentVector>
+    static void scaledDefects_(Dune::FieldVector<Scalar, numEq> &r,
+                               const FluidState &fluidState,
+                               const FluidState &scaleFluidState,
+                               const ComponentVector &globalMolarities)
+    {
+        typedef typename FluidState::Scalar Evaluation;
+        typedef Opm::MathToolbox<Evaluation> Toolbox;
+        typedef Dune::FieldVector<Evaluation, numEq> Vector;
+
+        Vector b;
+        calculateDefect_(b, fluidState, fluidState, globalMolarities);
+
+        int eqIdx = 0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            for (int phaseIdx = 1; phaseIdx < numPhases; ++phaseIdx) {
+                Scalar scale =
+                    std::abs(Toolbox::value(scaleFluidState.fugacity(/*phaseIdx=*/0, compIdx)))
+                    + std::abs(Toolbox::value(scaleFluidState.fugacity(phaseIdx, compIdx)));
+                if (scale == 0.0)
+                    scale =
+                        std::abs(Toolbox::value(fluidState.fugacity(/*phaseIdx=*/0, compIdx)))
+                        + std::abs(Toolbox::value(fluidState.fugacity(phaseIdx, compIdx)));
+                r[eqIdx] = scaledDefect_(Toolbox::value(b[eqIdx]), scale);
+                ++eqIdx;
+            }
+        }
+
+        Scalar sumMolarities = 0.0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            sumMolarities += std::abs(Toolbox::value(globalMolarities[compIdx]));
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            r[eqIdx] = scaledDefect_(Toolbox::value(b[eqIdx]), sumMolarities);
+            ++eqIdx;
+        }
+
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            r[eqIdx] = std::abs(Toolbox::value(b[eqIdx]));
+            ++eqIdx;
+        }
+    }
+
+    static Scalar scaledDefect_(Scalar defect, Scalar scale)
+    { return (defect == 0.0) ? 0.0 : std::abs(defect)/scale; }
+
+    // returns the largest scaled defect of a consistent fluid state or NaN if any of
+    // them is NaN, see isConverged()
+    template <class FluidState, class ComponentVector>
+    static Scalar defectNorm_(const FluidState &fluidState,
+                              const ComponentVector &globalMolarities)
+    {
+        Dune::FieldVector<Scalar, numEq> r;
+        scaledDefects_(r, fluidState, fluidState, globalMolarities);
+
+        Scalar norm = 0.0;
+        for (int eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            if (std::isnan(r[eqIdx]))
+                return r[eqIdx];
+            norm = std::max(norm, r[eqIdx]);
+        }
+        return norm;
+    }
+
+    // returns the Euclidean norm of the scaled defects which is used by the line
+    // search. the scales are fixed during a line search, so they are taken from the
+    // fluid state at its start
+    template <class FluidState, class ComponentVector>
+    static Scalar meritNorm_(const FluidState &fluidState,
+                             const FluidState &scaleFluidState,
+                             const ComponentVector &globalMolarities)
+    {
+        Dune::FieldVector<Scalar, numEq> r;
+        scaledDefects_(r, fluidState, scaleFluidState, globalMolarities);
+        return r.two_norm();
+    }
+
+    // apply a Newton update using the selected globalization strategy and return the
+    // weighted size of the full update. the fluid state must be consistent.
+    template <class MaterialLaw, class FluidState, class ComponentVector, class Vector>
+    static Scalar applyUpdate_(FluidState &fluidState,
+                               ParameterCache &paramCache,
+                               const typename MaterialLaw::Params &matParams,
+                               const ComponentVector &globalMolarities,
+                               const Vector &deltaX,
+                               int* numClamped = nullptr)
+    {
+        if (globalization() != LineSearch)
+            return update_<MaterialLaw>(fluidState, paramCache, matParams, deltaX, numClamped);
+
+        Workspace_<FluidState>& ws = workspace_<FluidState>();
+        FluidState& origFluidState = ws.lineSearchFluidState;
+        ParameterCache& origParamCache = ws.lineSearchParamCache;
+        origFluidState = fluidState;
+        origParamCache = paramCache;
+        Scalar merit0 = meritNorm_(fluidState, origFluidState, globalMolarities);
+
+        // the weights of the quantities do not depend on the fluid state, so the size
+        // of the full update is the one of the reduced update divided by lambda
+        const int maxBacktracks = 4;
+        Scalar lambda = 1.0;
+        Vector step(deltaX);
+        for (int backtrackIdx = 0; ; ++backtrackIdx) {
+            int* clampCounter = (backtrackIdx == 0) ? numClamped : nullptr;
+            if (backtrackIdx == maxBacktracks)
+                return update_<MaterialLaw>(fluidState, paramCache, matParams, step, clampCounter)/lambda;
+
+            try {
+                Scalar relError =
+                    update_<MaterialLaw>(fluidState, paramCache, matParams, step, clampCounter)/lambda;
+
+                // close to the solution the full update is always taken
+                if (relError < 1e-9 || !std::isfinite(merit0)
+                    || meritNorm_(fluidState, origFluidState, globalMolarities) <= (1.0 - 1e-4*lambda)*merit0)
+                    return relError;
+            }
+            catch (const NumericalIssue&) {
+                // the fluid system cannot be evaluated for the updated state
+            }
+
+            lambda /= 2;
+            step = deltaX;
+            step *= lambda;
+            fluidState = origFluidState;
+            paramCache = origParamCache;
+        }
+    }
+
     template <class MaterialLaw, class FluidState, class Vector>
     static Scalar update_(FluidState &fluidState,
                           ParameterCache &paramCache,
                           const typename MaterialLaw::Params &matParams,
-                          const Vector &deltaX)
+                          const Vector &deltaX,
+                          int* numClamped = nullptr)
     {
         typedef typename FluidState::Scalar Evaluation;
         typedef Opm::MathToolbox<Evaluation> Toolbox;
@@ -459,6 +1544,7 @@ protected:
 #endif
 
         Scalar relError = 0;
+        bool clamped = false;
         for (int pvIdx = 0; pvIdx < numEq; ++ pvIdx) {
             const Evaluation& tmp = getQuantity_(fluidState, pvIdx);
             Evaluation delta = deltaX[pvIdx];
@@ -480,6 +1566,7 @@ protected:
                 delta = Toolbox::min(0.5*fluidState.pressure(0),
                                      Toolbox::max(-0.5*fluidState.pressure(0), delta));
             }
+            clamped = clamped || Toolbox::value(delta) != Toolbox::value(deltaX[pvIdx]);
 
             setQuantityRaw_(fluidState, pvIdx, tmp - delta);
         }
@@ -517,6 +1604,9 @@ protected:
 
         completeFluidState_<MaterialLaw>(fluidState, paramCache, matParams);
 
+        if (numClamped && clamped)
+            ++(*numClamped);
+
         return relError;
     }
 
@@ -537,7 +1627,7 @@ protected:
         // update the pressures using the material law (saturations
         // and first pressure are already set because it is implicitly
         // solved for.)
-        Dune::FieldVector<Scalar, numPhases> pC;
+        Dune::FieldVector<Evaluation, numPhases> pC;
         MaterialLaw::capillaryPressures(pC, matParams, fluidState);
         for (int phaseIdx = 1; phaseIdx < numPhases; ++phaseIdx)
             fluidState.setPressure(phaseIdx,
@@ -552,13 +1642,65 @@ protected:
             const Evaluation& rho = FluidSystem::density(fluidState, paramCache, phaseIdx);
             fluidState.setDensity(phaseIdx, rho);
 
-            for (int compIdx = 0; compIdx < numComponents; ++ compIdx) {
-                const Evaluation& phi = FluidSystem::fugacityCoefficient(fluidState, paramCache, phaseIdx, compIdx);
-                fluidState.setFugacityCoefficient(phaseIdx, compIdx, phi);
-            }
+            Evaluation phi[numComponents];
+            FluidSystem::fugacityCoefficients(fluidState, paramCache, phaseIdx, phi);
+            for (int compIdx = 0; compIdx < numComponents; ++ compIdx)
+                fluidState.setFugacityCoefficient(phaseIdx, compIdx, phi[compIdx]);
         }
     }
 
+    // find the pressure at which the molar density of a phase is equal to a given
+    // value using Newton's method. the derivative is approximated using forward
+    // differences.
+    template <class FluidState>
+    static bool findSinglePhasePressure_(FluidState &fluidState,
+                                         ParameterCache &paramCache,
+                                         int phaseIdx,
+                                         const Dune::FieldVector<Scalar, numPhases>& pC,
+                                         Scalar molarity)
+    {
+        // use the ideal gas law for the initial guess
+        Scalar p = molarity*Opm::Constants<Scalar>::R*fluidState.temperature(phaseIdx);
+
+        const int nMax = 50;
+        for (int nIdx = 0; nIdx < nMax; ++nIdx) {
+            Scalar f = singlePhaseMolarDensity_(fluidState, paramCache, phaseIdx, pC, p) - molarity;
+            if (std::abs(f) <= 1e-12*molarity)
+                return true;
+
+            Scalar eps = 1e-7*p;
+            Scalar df =
+                (singlePhaseMolarDensity_(fluidState, paramCache, phaseIdx, pC, p + eps)
+                 - molarity - f)/eps;
+
+            Scalar delta = f/df;
+            if (!std::isfinite(delta))
+                return false;
+
+            // dampen to at most 50% change in pressure per iteration
+            delta = std::min(0.5*p, std::max(-0.5*p, delta));
+            p -= delta;
+        }
+
+        return false;
+    }
+
+    template <class FluidState>
+    static Scalar singlePhaseMolarDensity_(FluidState &fluidState,
+                                           ParameterCache &paramCache,
+                                           int phaseIdx,
+                                           const Dune::FieldVector<Scalar, numPhases>& pC,
+                                           Scalar p)
+    {
+        for (int otherPhaseIdx = 0; otherPhaseIdx < numPhases; ++otherPhaseIdx)
+            fluidState.setPressure(otherPhaseIdx, p + (pC[otherPhaseIdx] - pC[phaseIdx]));
+        paramCache.updateAll(fluidState, /*except=*/ParameterCache::Temperature);
+
+        Scalar rho = FluidSystem::density(fluidState, paramCache, phaseIdx);
+        fluidState.setDensity(phaseIdx, rho);
+        return fluidState.molarDensity(phaseIdx);
+    }
+
     static bool isPressureIdx_(int pvIdx)
     { return pvIdx == 0; }
 
@@ -620,10 +1762,11 @@ protected:
                 Valgrind::CheckDefined(rho);
                 fluidState.setDensity(phaseIdx, rho);
 
+                Evaluation phi[numComponents];
+                FluidSystem::fugacityCoefficients(fluidState, paramCache, phaseIdx, phi);
                 for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
-                    const Evaluation& phi = FluidSystem::fugacityCoefficient(fluidState, paramCache, phaseIdx, compIdx);
-                    Valgrind::CheckDefined(phi);
-                    fluidState.setFugacityCoefficient(phaseIdx, compIdx, phi);
+                    Valgrind::CheckDefined(phi[compIdx]);
+                    fluidState.setFugacityCoefficient(phaseIdx, compIdx, phi[compIdx]);
                 }
             }
         }
@@ -653,10 +1796,11 @@ protected:
                 Valgrind::CheckDefined(rho);
                 fluidState.setDensity(phaseIdx, rho);
 
+                Evaluation phi[numComponents];
+                FluidSystem::fugacityCoefficients(fluidState, paramCache, phaseIdx, phi);
                 for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
-                    const Evaluation& phi = FluidSystem::fugacityCoefficient(fluidState, paramCache, phaseIdx, compIdx);
-                    Valgrind::CheckDefined(phi);
-                    fluidState.setFugacityCoefficient(phaseIdx, compIdx, phi);
+                    Valgrind::CheckDefined(phi[compIdx]);
+                    fluidState.setFugacityCoefficient(phaseIdx, compIdx, phi[compIdx]);
                 }
             }
         }
@@ -677,10 +1821,11 @@ protected:
             // if the phase's fugacity coefficients are composition
             // dependent, update them as well.
             if (!FluidSystem::isIdealMixture(phaseIdx)) {
+                Evaluation phi[numComponents];
+                FluidSystem::fugacityCoefficients(fluidState, paramCache, phaseIdx, phi);
                 for (int fugCompIdx = 0; fugCompIdx < numComponents; ++fugCompIdx) {
-                    const Evaluation& phi = FluidSystem::fugacityCoefficient(fluidState, paramCache, phaseIdx, fugCompIdx);
-                    Valgrind::CheckDefined(phi);
-                    fluidState.setFugacityCoefficient(phaseIdx, fugCompIdx, phi);
+                    Valgrind::CheckDefined(phi[fugCompIdx]);
+                    fluidState.setFugacityCoefficient(phaseIdx, fugCompIdx, phi[fugCompIdx]);
                 }
             }
         }
@@ -730,8 +1875,22 @@ protected:
         else // if (pvIdx < numPhases + numPhases*numComponents)
             return 1.0;
     }
+
+    static std::atomic<ConstraintSolverTelemetry*> telemetry_;
+    static std::atomic<ConstraintSolverCorpus*> corpus_;
+    static std::atomic<Globalization> globalization_;
 };
 
+template <class Scalar, class FluidSystem>
+std::atomic<ConstraintSolverTelemetry*> NcpFlash<Scalar, FluidSystem>::telemetry_(nullptr);
+
+template <class Scalar, class FluidSystem>
+std::atomic<ConstraintSolverCorpus*> NcpFlash<Scalar, FluidSystem>::corpus_(nullptr);
+
+template <class Scalar, class FluidSystem>
+std::atomic<typename NcpFlash<Scalar, FluidSystem>::Globalization>
+NcpFlash<Scalar, FluidSystem>::globalization_(NcpFlash<Scalar, FluidSystem>::ClampedUpdate);
+
 } // namespace Opm
 
 #endif
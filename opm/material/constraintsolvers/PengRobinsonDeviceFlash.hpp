@@ -0,0 +1,494 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::PengRobinsonDeviceFlash
+ */
+#ifndef OPM_PENG_ROBINSON_DEVICE_FLASH_HPP
+#define OPM_PENG_ROBINSON_DEVICE_FLASH_HPP
+
+#include <opm/material/common/HostDevice.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
+#include <opm/material/eos/PengRobinsonMixtureKernels.hpp>
+
+#include <cmath>
+#include <cstddef>
+
+namespace Opm {
+
+/*!
+ * \brief The arrays of a batch of flash problems for PengRobinsonDeviceFlash.
+ *
+ * All arrays are stored as structure of arrays, i.e., the value of component compIdx
+ * of problem idx is at position compIdx*n + idx. If the flash is done by a kernel on
+ * an accelerator, the pointers must point to the memory of the accelerator.
+ */
+template <class Scalar>
+struct PengRobinsonDeviceFlashBatch
+{
+    //! The number of problems
+    size_t n;
+
+    //! The temperatures of the problems
+    const Scalar* temperature;
+
+    //! The pressures of the problems
+    const Scalar* pressure;
+
+    //! The overall mole fractions. They do not need to sum up to one.
+    const Scalar* z;
+
+    //! The K-values. They are used as initial guess if requested and they receive the
+    //! result.
+    Scalar* K;
+
+    //! Receives the mole fractions of the liquid phase
+    Scalar* x;
+
+    //! Receives the mole fractions of the gas phase
+    Scalar* y;
+
+    //! Receives the molar fractions of the gas phase
+    Scalar* vaporFraction;
+
+    //! Receives the number of iterations of each problem
+    int* iterations;
+
+    //! Receives 1 for each problem which converged and 0 for the others
+    unsigned char* converged;
+};
+
+/*!
+ * \brief Determines the vapor-liquid equilibrium of many mixtures which are described
+ *        by the Peng-Robinson equation of state, one mixture per thread.
+ *
+ * This implements the same algorithm as RachfordRiceFlash, i.e., successive
+ * substitution of the K-values which is replaced by a Newton method for \f$\ln K\f$
+ * once the fugacity residual is small, but it works on plain arrays and it uses
+ * PengRobinsonMixtureKernels to evaluate the fugacity coefficients. The per-problem
+ * solver solveProblem() does not allocate memory, does not throw exceptions and does
+ * not depend on the fluid system, so it can be called by the threads of a CUDA or HIP
+ * kernel which solves a whole batch without any communication between the threads.
+ * solveBatch() does the same on the host using OpenMP.
+ *
+ * Both phases have the same pressure, capillary pressure is not considered. If one of
+ * the phases is absent, its mole fractions are the ones of the stationary point of the
+ * tangent plane distance, i.e., they sum up to at most 1, as for RachfordRiceFlash.
+ * Since PengRobinsonMixtureKernels does not extrapolate the molar volume of a phase if
+ * the cubic equation of state only has a single root, the results of the two solvers
+ * may differ for absent phases.
+ */
+template <class Scalar, int numComponents>
+class PengRobinsonDeviceFlash
+{
+    typedef Opm::PengRobinsonMixtureKernels<Scalar, numComponents> Kernels;
+
+public:
+    //! The component data which is shared by all problems
+    typedef typename Kernels::Data Data;
+
+    //! The arrays of a batch of problems
+    typedef PengRobinsonDeviceFlashBatch<Scalar> Batch;
+
+    /*!
+     * \brief The default tolerance for the logarithms of the fugacity ratios.
+     */
+    OPM_HOST_DEVICE static Scalar defaultTolerance()
+    { return 1e-10; }
+
+    /*!
+     * \brief The default maximum number of iterations for the K-values.
+     */
+    OPM_HOST_DEVICE static int defaultMaxIterations()
+    { return 200; }
+
+    /*!
+     * \brief Compute the K-values of all components using the correlation of Wilson.
+     *
+     * The K-value of component i is written to K[i*stride].
+     */
+    OPM_HOST_DEVICE static void wilsonKValues(Scalar* K,
+                                              size_t stride,
+                                              const Data& data,
+                                              Scalar temperature,
+                                              Scalar pressure)
+    {
+        for (int i = 0; i < numComponents; ++i) {
+            Scalar Tc = data.criticalTemperature[i];
+            Scalar pc = data.criticalPressure[i];
+            Scalar omega = data.acentricFactor[i];
+            K[i*stride] = pc/pressure*std::exp(5.373*(1 + omega)*(1 - Tc/temperature));
+        }
+    }
+
+    /*!
+     * \brief Solve the Rachford-Rice equation for a single problem.
+     *
+     * The overall mole fractions must be normalized. This is the scalar version of
+     * RachfordRiceFlash::solveRachfordRice(), i.e., the result is restricted to
+     * [0, 1].
+     */
+    OPM_HOST_DEVICE static Scalar solveRachfordRice(const Scalar* K, const Scalar* z)
+    {
+        Scalar f = 0.0;
+        Scalar df = 0.0;
+        for (int i = 0; i < numComponents; ++i) {
+            f += z[i]*(K[i] - 1);
+            df += z[i]*(K[i] - 1)/K[i];
+        }
+        if (!(f > 0.0))
+            return 0.0; // subcooled
+        if (!(df < 0.0))
+            return 1.0; // superheated
+
+        Scalar lo = 0.0;
+        Scalar hi = 1.0;
+        Scalar V = 0.5;
+        for (int iterIdx = 0; iterIdx < maxRachfordRiceIterations_; ++iterIdx) {
+            f = 0.0;
+            df = 0.0;
+            for (int i = 0; i < numComponents; ++i) {
+                Scalar a = K[i] - 1;
+                Scalar d = 1/(1 + V*a);
+                Scalar t = z[i]*a*d;
+                f += t;
+                df -= t*a*d;
+            }
+
+            // safeguarded Newton method, cf. RachfordRiceFlash
+            lo = (f > 0.0) ? V : lo;
+            hi = (f > 0.0) ? hi : V;
+            Scalar Vnew = (df < 0.0) ? V - f/df : 0.5*(lo + hi);
+            if (!(lo < Vnew && Vnew < hi))
+                Vnew = 0.5*(lo + hi);
+
+            bool converged = std::abs(Vnew - V) <= 1e-14;
+            V = Vnew;
+            if (converged)
+                break;
+        }
+        return V;
+    }
+
+    /*!
+     * \brief Calculate the vapor-liquid equilibrium of a single problem of a batch.
+     *
+     * \param data The component data
+     * \param batch The arrays of the batch
+     * \param idx The index of the problem within the batch
+     * \param useInitialK Use the K-values of the batch as the initial guess instead of
+     *                    the ones of the Wilson correlation
+     * \param tolerance The tolerance for the logarithms of the fugacity ratios
+     * \param maxIterations The maximum number of iterations
+     *
+     * \return true if the flash converged
+     */
+    OPM_HOST_DEVICE static bool solveProblem(const Data& data,
+                                             const Batch& batch,
+                                             size_t idx,
+                                             bool useInitialK,
+                                             Scalar tolerance,
+                                             int maxIterations)
+    {
+        const size_t n = batch.n;
+        const Scalar T = batch.temperature[idx];
+        const Scalar p = batch.pressure[idx];
+
+        batch.iterations[idx] = 0;
+        batch.converged[idx] = 0;
+
+        // the problem is copied to thread-local arrays, so that the strided memory of
+        // the batch is only accessed at the beginning and at the end
+        Scalar z[numComponents];
+        Scalar K[numComponents];
+        Scalar sumZ = 0.0;
+        for (int i = 0; i < numComponents; ++i)
+            sumZ += batch.z[i*n + idx];
+        if (!(sumZ > 0.0))
+            return false;
+        for (int i = 0; i < numComponents; ++i)
+            z[i] = batch.z[i*n + idx]/sumZ;
+
+        if (useInitialK)
+            for (int i = 0; i < numComponents; ++i)
+                K[i] = batch.K[i*n + idx];
+        else
+            wilsonKValues(K, /*stride=*/1, data, T, p);
+
+        // the temperature of the problem is fixed, so are the parameters of the pure
+        // components
+        Scalar sqrtA[numComponents];
+        Scalar b[numComponents];
+        Kernels::computePureParams(sqrtA, b, data, T);
+
+        Scalar g[numComponents];
+        Scalar Knew[numComponents];
+        Scalar prevKnew[numComponents];
+        Scalar V = 0.0;
+        Scalar prevResidual = 1e100;
+        bool useNewton = true;
+        bool newtonStep = false;
+        for (int iterIdx = 0; iterIdx < maxIterations; ++iterIdx) {
+            batch.iterations[idx] = iterIdx + 1;
+            if (!fugacityResidual_(g, Knew, V, data, sqrtA, b, T, p, K, z))
+                return false;
+
+            Scalar residual = maxAbs_(g);
+            if (residual <= tolerance) {
+                for (int i = 0; i < numComponents; ++i) {
+                    Scalar xi = z[i]/(1 + V*(K[i] - 1));
+                    batch.K[i*n + idx] = K[i];
+                    batch.x[i*n + idx] = xi;
+                    batch.y[i*n + idx] = K[i]*xi;
+                }
+                batch.vaporFraction[idx] = V;
+                batch.converged[idx] = 1;
+                return true;
+            }
+
+            // a Newton step which did not reduce the residual is discarded and the
+            // remaining iterations use successive substitution
+            if (newtonStep && !(residual < prevResidual)) {
+                useNewton = false;
+                newtonStep = false;
+                for (int i = 0; i < numComponents; ++i)
+                    K[i] = prevKnew[i];
+                continue;
+            }
+
+            for (int i = 0; i < numComponents; ++i)
+                prevKnew[i] = Knew[i];
+            prevResidual = residual;
+            newtonStep =
+                useNewton
+                && residual <= switchTolerance_()
+                && newtonUpdate_(K, g, data, sqrtA, b, T, p, z);
+            if (!newtonStep)
+                for (int i = 0; i < numComponents; ++i)
+                    K[i] = Knew[i];
+        }
+
+        return false;
+    }
+
+    /*!
+     * \brief Calculate the vapor-liquid equilibria of a batch of problems on the host.
+     *
+     * The problems are distributed to the threads using OpenMP.
+     *
+     * \return The number of problems which did not converge
+     */
+    static size_t solveBatch(const Data& data,
+                             const Batch& batch,
+                             bool useInitialK = false,
+                             Scalar tolerance = defaultTolerance(),
+                             int maxIterations = defaultMaxIterations())
+    {
+        OPM_PROFILER_RANGE("PengRobinsonDeviceFlash::solveBatch");
+
+        size_t numFailed = 0;
+        const long n = static_cast<long>(batch.n);
+#ifdef _OPENMP
+        #pragma omp parallel for reduction(+:numFailed)
+#endif
+        for (long idx = 0; idx < n; ++idx)
+            if (!solveProblem(data, batch, static_cast<size_t>(idx), useInitialK, tolerance, maxIterations))
+                ++numFailed;
+
+        return numFailed;
+    }
+
+private:
+    // the maximum number of iterations for the Rachford-Rice equation
+    static const int maxRachfordRiceIterations_ = 100;
+
+    // the fugacity residual below which the Newton method is used instead of
+    // successive substitution
+    OPM_HOST_DEVICE static Scalar switchTolerance_()
+    { return 1e-2; }
+
+    // the perturbation of ln(K) used to approximate the Jacobian matrix
+    OPM_HOST_DEVICE static Scalar epsilon_()
+    { return 1e-7; }
+
+    // the maximum change of ln(K) of a Newton step
+    OPM_HOST_DEVICE static Scalar maxNewtonUpdate_()
+    { return 1.0; }
+
+    OPM_HOST_DEVICE static Scalar maxAbs_(const Scalar* v)
+    {
+        Scalar result = 0.0;
+        for (int i = 0; i < numComponents; ++i)
+            result = (std::abs(v[i]) > result) ? std::abs(v[i]) : result;
+        return result;
+    }
+
+    // solve the Rachford-Rice equation for given K-values and compute the logarithms
+    // of the fugacity ratios of the resulting phases. the fugacity coefficients of an
+    // absent phase are evaluated for the normalized composition of the stationary
+    // point, cf. RachfordRiceFlash.
+    OPM_HOST_DEVICE static bool fugacityResidual_(Scalar* g,
+                                                  Scalar* Knew,
+                                                  Scalar& V,
+                                                  const Data& data,
+                                                  const Scalar* sqrtA,
+                                                  const Scalar* b,
+                                                  Scalar T,
+                                                  Scalar p,
+                                                  const Scalar* K,
+                                                  const Scalar* z)
+    {
+        V = solveRachfordRice(K, z);
+
+        Scalar x[numComponents];
+        Scalar y[numComponents];
+        Scalar sumX = 0.0, sumY = 0.0;
+        for (int i = 0; i < numComponents; ++i) {
+            x[i] = z[i]/(1 + V*(K[i] - 1));
+            y[i] = K[i]*x[i];
+            sumX += x[i];
+            sumY += y[i];
+        }
+        for (int i = 0; i < numComponents; ++i) {
+            x[i] /= sumX;
+            y[i] /= sumY;
+        }
+
+        Scalar phiL[numComponents];
+        Scalar phiG[numComponents];
+        Scalar Z;
+        if (!Kernels::computeFugacityCoefficients(phiL, Z, data, sqrtA, b, T, p, x,
+                                                  /*stride=*/1, /*isGasPhase=*/false)
+            || !Kernels::computeFugacityCoefficients(phiG, Z, data, sqrtA, b, T, p, y,
+                                                     /*stride=*/1, /*isGasPhase=*/true))
+            return false;
+
+        for (int i = 0; i < numComponents; ++i) {
+            Knew[i] = phiL[i]/phiG[i];
+            g[i] = std::log(K[i]/Knew[i]);
+            if (!std::isfinite(g[i]) || !(Knew[i] > 0.0))
+                return false;
+        }
+
+        return true;
+    }
+
+    // do a Newton step for ln(K). the Jacobian matrix is approximated by forward
+    // differences and the linear system is solved by Gaussian elimination with partial
+    // pivoting.
+    OPM_HOST_DEVICE static bool newtonUpdate_(Scalar* K,
+                                              const Scalar* g,
+                                              const Data& data,
+                                              const Scalar* sqrtA,
+                                              const Scalar* b,
+                                              Scalar T,
+                                              Scalar p,
+                                              const Scalar* z)
+    {
+        Scalar J[numComponents][numComponents];
+        Scalar Kpert[numComponents];
+        Scalar gpert[numComponents];
+        Scalar Kdummy[numComponents];
+        Scalar Vdummy;
+        for (int colIdx = 0; colIdx < numComponents; ++colIdx) {
+            for (int i = 0; i < numComponents; ++i)
+                Kpert[i] = K[i];
+            Kpert[colIdx] *= std::exp(epsilon_());
+            if (!fugacityResidual_(gpert, Kdummy, Vdummy, data, sqrtA, b, T, p, Kpert, z))
+                return false;
+
+            for (int rowIdx = 0; rowIdx < numComponents; ++rowIdx)
+                J[rowIdx][colIdx] = (gpert[rowIdx] - g[rowIdx])/epsilon_();
+        }
+
+        Scalar delta[numComponents];
+        for (int i = 0; i < numComponents; ++i)
+            delta[i] = g[i];
+        for (int colIdx = 0; colIdx < numComponents; ++colIdx) {
+            int pivotIdx = colIdx;
+            for (int rowIdx = colIdx + 1; rowIdx < numComponents; ++rowIdx)
+                if (std::abs(J[rowIdx][colIdx]) > std::abs(J[pivotIdx][colIdx]))
+                    pivotIdx = rowIdx;
+            if (!(std::abs(J[pivotIdx][colIdx]) > 1e-30))
+                return false;
+
+            if (pivotIdx != colIdx) {
+                for (int j = colIdx; j < numComponents; ++j) {
+                    Scalar tmp = J[colIdx][j];
+                    J[colIdx][j] = J[pivotIdx][j];
+                    J[pivotIdx][j] = tmp;
+                }
+                Scalar tmp = delta[colIdx];
+                delta[colIdx] = delta[pivotIdx];
+                delta[pivotIdx] = tmp;
+            }
+
+            for (int rowIdx = colIdx + 1; rowIdx < numComponents; ++rowIdx) {
+                Scalar factor = J[rowIdx][colIdx]/J[colIdx][colIdx];
+                for (int j = colIdx; j < numComponents; ++j)
+                    J[rowIdx][j] -= factor*J[colIdx][j];
+                delta[rowIdx] -= factor*delta[colIdx];
+            }
+        }
+        for (int rowIdx = numComponents - 1; rowIdx >= 0; --rowIdx) {
+            for (int j = rowIdx + 1; j < numComponents; ++j)
+                delta[rowIdx] -= J[rowIdx][j]*delta[j];
+            delta[rowIdx] /= J[rowIdx][rowIdx];
+            if (!std::isfinite(delta[rowIdx]))
+                return false;
+        }
+
+        // limit the step while keeping its direction
+        Scalar maxDelta = maxAbs_(delta);
+        Scalar factor = (maxDelta > maxNewtonUpdate_()) ? maxNewtonUpdate_()/maxDelta : 1.0;
+        for (int i = 0; i < numComponents; ++i)
+            K[i] *= std::exp(-factor*delta[i]);
+
+        return true;
+    }
+};
+
+#if OPM_HAVE_DEVICE_COMPILER
+/*!
+ * \brief The kernel which solves a batch of flash problems on an accelerator, one
+ *        problem per thread.
+ *
+ * The component data and all arrays of the batch must reside in the memory of the
+ * accelerator. The data is usually uploaded once and it is then used by all launches.
+ */
+template <class Scalar, int numComponents>
+__global__ void pengRobinsonDeviceFlashKernel(const PengRobinsonMixtureData<Scalar, numComponents>* data,
+                                              PengRobinsonDeviceFlashBatch<Scalar> batch,
+                                              bool useInitialK,
+                                              Scalar tolerance,
+                                              int maxIterations)
+{
+    size_t idx = static_cast<size_t>(blockIdx.x)*blockDim.x + threadIdx.x;
+    if (idx < batch.n)
+        PengRobinsonDeviceFlash<Scalar, numComponents>::solveProblem(*data, batch, idx,
+                                                                     useInitialK, tolerance,
+                                                                     maxIterations);
+}
+#endif
+
+} // namespace Opm
+
+#endif
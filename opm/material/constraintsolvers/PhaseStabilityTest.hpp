@@ -0,0 +1,175 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::PhaseStabilityTest
+ */
+#ifndef OPM_PHASE_STABILITY_TEST_HPP
+#define OPM_PHASE_STABILITY_TEST_HPP
+
+#include <opm/material/common/Valgrind.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace Opm {
+
+/*!
+ * \brief Determines whether a single fluid phase is thermodynamically stable.
+ *
+ * This implements the tangent plane distance criterion of Michelsen (1982): For a
+ * reference phase \f$\alpha\f$ of composition \f$z\f$, the stationary points of the
+ * tangent plane distance function of each other phase \f$\beta\f$ are located by
+ * successive substitution, i.e.,
+ *
+ * \f[ W_\kappa = z_\kappa \frac{\varphi_{\alpha,\kappa}(z)\;p_\alpha}{\varphi_{\beta,\kappa}(W)\;p_\beta} \f]
+ *
+ * is iterated starting from \f$W = z\f$. If \f$\sum_\kappa W_\kappa > 1\f$ for any
+ * of the other phases, the tangent plane distance is negative and the reference
+ * phase would split. The fugacity coefficients are provided by the fluid system,
+ * i.e., this works for the equation of state based fluid systems as well as for
+ * those which use Henry coefficients and vapor pressures.
+ *
+ * At a stationary point, the unnormalized compositions \f$W\f$ are exactly the
+ * compositions of the absent phases which the NCP flash expects: They exhibit the same
+ * fugacities as the reference phase and their mole fractions sum up to at most 1.
+ */
+template <class Scalar, class FluidSystem>
+class PhaseStabilityTest
+{
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+
+public:
+    /*!
+     * \brief Returns true if the reference phase of a fluid state is stable.
+     *
+     * The temperatures and pressures of all phases and the composition of the
+     * reference phase must be set. On return, the mole fractions of all other phases
+     * are set to the stationary points of their tangent plane distance functions and
+     * the fugacity coefficients of all phases are updated. If the successive
+     * substitution does not converge, the phase is not considered to be stable.
+     */
+    template <class FluidState>
+    static bool isStable(FluidState &fluidState,
+                         ParameterCache &paramCache,
+                         int refPhaseIdx,
+                         Scalar tolerance = 0.0,
+                         int maxIterations = 100)
+    {
+        static_assert(std::is_same<typename FluidState::Scalar, Scalar>::value,
+                      "The stability test only works for fluid states which use the "
+                      "scalar type of the solver");
+
+        if (tolerance <= 0.0)
+            tolerance = 1e-12;
+
+        // the fugacities of the reference phase stay constant during the test
+        paramCache.updatePhase(fluidState, refPhaseIdx);
+        Scalar refFugacity[numComponents];
+        Scalar refPhi[numComponents];
+        FluidSystem::fugacityCoefficients(fluidState, paramCache, refPhaseIdx, refPhi);
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            Scalar phi = refPhi[compIdx];
+            fluidState.setFugacityCoefficient(refPhaseIdx, compIdx, phi);
+            refFugacity[compIdx] =
+                fluidState.moleFraction(refPhaseIdx, compIdx)*phi*fluidState.pressure(refPhaseIdx);
+        }
+        Valgrind::CheckDefined(refFugacity);
+
+        bool stable = true;
+        for (int trialPhaseIdx = 0; trialPhaseIdx < numPhases; ++trialPhaseIdx) {
+            if (trialPhaseIdx == refPhaseIdx)
+                continue;
+
+            if (!findStationaryPoint_(fluidState, paramCache, refPhaseIdx, trialPhaseIdx, refFugacity,
+                                      tolerance, maxIterations))
+                return false;
+
+            Scalar sumW = 0.0;
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                sumW += fluidState.moleFraction(trialPhaseIdx, compIdx);
+
+            // we do not stop at the first unstable phase: This way, all trial
+            // compositions are available to the caller
+            if (sumW > 1.0)
+                stable = false;
+        }
+
+        return stable;
+    }
+
+private:
+    template <class FluidState>
+    static bool findStationaryPoint_(FluidState &fluidState,
+                                     ParameterCache &paramCache,
+                                     int refPhaseIdx,
+                                     int trialPhaseIdx,
+                                     const Scalar *refFugacity,
+                                     Scalar tolerance,
+                                     int maxIterations)
+    {
+        const Scalar pTrial = fluidState.pressure(trialPhaseIdx);
+
+        // start with the composition of the reference phase
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            fluidState.setMoleFraction(trialPhaseIdx, compIdx,
+                                       fluidState.moleFraction(refPhaseIdx, compIdx));
+
+        for (int iterIdx = 0; iterIdx < maxIterations; ++iterIdx) {
+            paramCache.updateComposition(fluidState, trialPhaseIdx);
+
+            Scalar phi[numComponents];
+            FluidSystem::fugacityCoefficients(fluidState, paramCache, trialPhaseIdx, phi);
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                fluidState.setFugacityCoefficient(trialPhaseIdx, compIdx, phi[compIdx]);
+
+            Scalar maxDelta = 0.0;
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+                Scalar W = refFugacity[compIdx]/(phi[compIdx]*pTrial);
+                if (!std::isfinite(W))
+                    return false;
+
+                Scalar delta = std::abs(W - fluidState.moleFraction(trialPhaseIdx, compIdx));
+                maxDelta = std::max(maxDelta, delta);
+                fluidState.setMoleFraction(trialPhaseIdx, compIdx, W);
+            }
+
+            if (maxDelta <= tolerance) {
+                // make the fugacity coefficients consistent with the final composition
+                paramCache.updateComposition(fluidState, trialPhaseIdx);
+                FluidSystem::fugacityCoefficients(fluidState, paramCache, trialPhaseIdx, phi);
+                for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                    fluidState.setFugacityCoefficient(trialPhaseIdx, compIdx, phi[compIdx]);
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+} // namespace Opm
+
+#endif
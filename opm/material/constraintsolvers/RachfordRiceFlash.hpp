@@ -0,0 +1,673 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::RachfordRiceFlash
+ */
+#ifndef OPM_RACHFORD_RICE_FLASH_HPP
+#define OPM_RACHFORD_RICE_FLASH_HPP
+
+#include <dune/common/fvector.hh>
+#include <dune/common/fmatrix.hh>
+
+#include <opm/material/constraintsolvers/ConstraintSolverStatus.hpp>
+#include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/Valgrind.hpp>
+#include <opm/material/common/Instrumentation.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Determines the compositions and saturations of a liquid and a vapor phase
+ *        given the pressure, the temperature and the overall composition.
+ *
+ * In contrast to NcpFlash, which solves the full system of
+ * numPhases*(numComponents + 1) equations for given total molarities, this solver
+ * only considers the two phases which are specified by the caller and iterates on the
+ * equilibrium ratios \f$K_\kappa = y_\kappa/x_\kappa\f$ of the components. For given
+ * K-values, the molar fraction of the vapor phase \f$V\f$ is the root of the
+ * Rachford-Rice equation
+ *
+ * \f[ \sum_\kappa \frac{z_\kappa (K_\kappa - 1)}{1 + V (K_\kappa - 1)} = 0 \f]
+ *
+ * which is solved by a safeguarded Newton method (see solveRachfordRice()). The
+ * K-values are then updated by successive substitution, i.e.,
+ *
+ * \f[ K_\kappa = \frac{\varphi_{l,\kappa}\;p_l}{\varphi_{g,\kappa}\;p_g} \f]
+ *
+ * Once the fugacities of all components agree to within a loose tolerance,
+ * successive substitution is replaced by a Newton method for \f$\ln K\f$ whose
+ * Jacobian matrix is approximated using forward differences. This accelerates the
+ * convergence considerably close to the critical point, where successive substitution
+ * becomes very slow. If a Newton step does not reduce the fugacity residual, the
+ * solver falls back to successive substitution.
+ *
+ * The vapor fraction is restricted to [0, 1]. If one of the phases is absent, its
+ * mole fractions are the ones of the stationary point of the tangent plane distance
+ * (cf. PhaseStabilityTest), i.e., they sum up to at most 1. This is the same
+ * convention as the one used by NcpFlash, so the result can be used as an initial
+ * guess for it.
+ *
+ * The initial K-values are given by the correlation of Wilson, so the fluid system
+ * must provide the critical temperatures, the critical pressures and the acentric
+ * factors of its components. Capillary pressure is not considered: the pressures of
+ * both phases must be set by the caller and they are not modified.
+ */
+template <class Scalar, class FluidSystem>
+class RachfordRiceFlash
+{
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+
+public:
+    //! The outcome of the trySolve() methods
+    typedef Opm::ConstraintSolverStatus<Scalar> SolverStatus;
+
+    //! The type used for the K-values and the overall composition
+    typedef Dune::FieldVector<Scalar, numComponents> ComponentVector;
+
+    /*!
+     * \brief Compute the K-values of all components using the correlation of Wilson.
+     *
+     * \f[ K_\kappa = \frac{p_{c,\kappa}}{p} \exp\left(5.373 (1 + \omega_\kappa)
+     *                \left(1 - \frac{T_{c,\kappa}}{T}\right)\right) \f]
+     */
+    static void wilsonKValues(ComponentVector& K, Scalar temperature, Scalar pressure)
+    {
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            Scalar Tc = FluidSystem::criticalTemperature(compIdx);
+            Scalar pc = FluidSystem::criticalPressure(compIdx);
+            Scalar omega = FluidSystem::acentricFactor(compIdx);
+            K[compIdx] = pc/pressure*std::exp(5.373*(1 + omega)*(1 - Tc/temperature));
+        }
+    }
+
+    /*!
+     * \brief Solve the Rachford-Rice equation for a batch of problems.
+     *
+     * The K-values and the overall mole fractions are stored interleaved, i.e., the
+     * value for component compIdx of problem idx is at position compIdx*n + idx. The
+     * iterations of all problems are done in lock-step and the inner loops run over
+     * the problems, so they can be vectorized by the compiler. If the mixture is
+     * subcooled, i.e., \f$\sum_\kappa z_\kappa K_\kappa \leq 1\f$, the vapor fraction
+     * is 0. If it is superheated, i.e., \f$\sum_\kappa z_\kappa/K_\kappa \leq 1\f$, it
+     * is 1.
+     *
+     * \param vaporFraction The array which receives the molar fractions of the vapor
+     *                      phase of the n problems
+     * \param K The interleaved K-values
+     * \param z The interleaved overall mole fractions
+     * \param n The number of problems
+     */
+    static void solveRachfordRice(Scalar* vaporFraction,
+                                  const Scalar* K,
+                                  const Scalar* z,
+                                  size_t n)
+    {
+        for (size_t offset = 0; offset < n; offset += batchChunkSize_)
+            solveRachfordRiceChunk_(vaporFraction + offset, K + offset, z + offset,
+                                    n, std::min<size_t>(batchChunkSize_, n - offset));
+    }
+
+    /*!
+     * \brief Calculates the vapor-liquid equilibrium for given initial K-values
+     *        without throwing exceptions.
+     *
+     * Using the K-values of a previous solution as the initial guess usually saves
+     * most of the iterations if the conditions did not change much. The temperature and the pressures of the liquid and the gas phase must be set
+     * in the fluid state. On success, the mole fractions, densities, saturations and
+     * fugacity coefficients of both phases are set. The saturations of all other
+     * phases are set to zero.
+     *
+     * \param fluidState The fluid state
+     * \param paramCache The parameter cache of the fluid state
+     * \param K The K-values. On input they are the initial guess (cf.
+     *          wilsonKValues()), on output they are the result.
+     * \param globalMoleFractions The overall mole fractions of the components. They
+     *                            are normalized before they are used, i.e., the total
+     *                            molarities may be passed as well.
+     * \param liquidPhaseIdx The index of the liquid phase
+     * \param gasPhaseIdx The index of the gas phase
+     * \param tolerance The maximum difference of the logarithms of the fugacities of
+     *                  the phases for which the solution is accepted
+     */
+    template <class FluidState, class ComponentVectorT>
+    static SolverStatus trySolveFromKValues(FluidState &fluidState,
+                                            ParameterCache &paramCache,
+                                            ComponentVector& K,
+                                            const ComponentVectorT& globalMoleFractions,
+                                            int liquidPhaseIdx,
+                                            int gasPhaseIdx,
+                                            Scalar tolerance = 0.0)
+    {
+        static_assert(std::is_same<typename FluidState::Scalar, Scalar>::value,
+                      "The Rachford-Rice flash only works for fluid states which use the "
+                      "scalar type of the solver");
+        OPM_INSTRUMENT_SCOPE("RachfordRiceFlash::trySolve");
+        OPM_PROFILER_RANGE("RachfordRiceFlash::trySolve");
+
+        if (tolerance <= 0.0)
+            tolerance = 1e-10;
+
+        ComponentVector z;
+        if (!normalize_(z, globalMoleFractions))
+            return SolverStatus();
+
+        paramCache.updateAll(fluidState);
+        return trySolve_(fluidState, paramCache, K, z, liquidPhaseIdx, gasPhaseIdx, tolerance);
+    }
+
+    /*!
+     * \brief Calculates the vapor-liquid equilibrium without throwing exceptions.
+     *
+     * This uses the K-values of Wilson as the initial guess, cf.
+     * trySolveFromKValues().
+     */
+    template <class FluidState, class ComponentVectorT>
+    static SolverStatus trySolve(FluidState &fluidState,
+                                 ParameterCache &paramCache,
+                                 const ComponentVectorT& globalMoleFractions,
+                                 int liquidPhaseIdx,
+                                 int gasPhaseIdx,
+                                 Scalar tolerance = 0.0)
+    {
+        ComponentVector K;
+        wilsonKValues(K, fluidState.temperature(liquidPhaseIdx), fluidState.pressure(liquidPhaseIdx));
+        return trySolveFromKValues(fluidState, paramCache, K, globalMoleFractions,
+                                   liquidPhaseIdx, gasPhaseIdx, tolerance);
+    }
+
+    /*!
+     * \brief Calculates the vapor-liquid equilibrium.
+     *
+     * This does the same as trySolve(), but a NumericalIssue exception is thrown if
+     * the calculation fails.
+     */
+    template <class FluidState, class ComponentVectorT>
+    static void solve(FluidState &fluidState,
+                      ParameterCache &paramCache,
+                      const ComponentVectorT& globalMoleFractions,
+                      int liquidPhaseIdx,
+                      int gasPhaseIdx,
+                      Scalar tolerance = 0.0)
+    {
+        const SolverStatus& status =
+            trySolve(fluidState, paramCache, globalMoleFractions,
+                     liquidPhaseIdx, gasPhaseIdx, tolerance);
+
+        if (!status.converged())
+            OPM_THROW(NumericalIssue,
+                      "Rachford-Rice flash calculation failed."
+                      " {z^kappa} = {" << globalMoleFractions << "}, T = "
+                      << fluidState.temperature(liquidPhaseIdx) << ", p = "
+                      << fluidState.pressure(liquidPhaseIdx));
+    }
+
+    /*!
+     * \brief Calculates the vapor-liquid equilibrium for a batch of fluid states
+     *        without throwing exceptions.
+     *
+     * This is equivalent to calling trySolve() with the K-values of Wilson for each
+     * fluid state, but the successive substitution iterations of all fluid states are
+     * done in lock-step, so that the Rachford-Rice equations of all fluid states are
+     * solved at once by solveRachfordRice(). The remaining iterations are done
+     * separately for each fluid state.
+     *
+     * \return The number of fluid states for which the calculation failed
+     */
+    template <class FluidState, class ComponentVectorT>
+    static size_t trySolveBatch(FluidState* fluidStates,
+                                ParameterCache* paramCaches,
+                                const ComponentVectorT* globalMoleFractions,
+                                int liquidPhaseIdx,
+                                int gasPhaseIdx,
+                                SolverStatus* statuses,
+                                size_t n,
+                                Scalar tolerance = 0.0)
+    {
+        static_assert(std::is_same<typename FluidState::Scalar, Scalar>::value,
+                      "The Rachford-Rice flash only works for fluid states which use the "
+                      "scalar type of the solver");
+        OPM_INSTRUMENT_SCOPE("RachfordRiceFlash::trySolveBatch");
+        OPM_PROFILER_RANGE("RachfordRiceFlash::trySolveBatch");
+
+        if (tolerance <= 0.0)
+            tolerance = 1e-10;
+
+        std::vector<ComponentVector> K(n);
+        std::vector<ComponentVector> z(n);
+        std::vector<int> numIterations(n, 0);
+        std::vector<size_t> active;
+        for (size_t idx = 0; idx < n; ++idx) {
+            statuses[idx] = SolverStatus();
+            if (!normalize_(z[idx], globalMoleFractions[idx]))
+                continue;
+
+            FluidState& fs = fluidStates[idx];
+            paramCaches[idx].updateAll(fs);
+            wilsonKValues(K[idx], fs.temperature(liquidPhaseIdx), fs.pressure(liquidPhaseIdx));
+            active.push_back(idx);
+        }
+
+        // successive substitution in lock-step. the fluid states leave the batch as soon
+        // as they are close enough to the solution for the Newton method.
+        std::vector<Scalar> Kbuf, zbuf, Vbuf;
+        for (int iterIdx = 0; iterIdx < maxIterations_ && !active.empty(); ++iterIdx) {
+            size_t numActive = active.size();
+            Kbuf.resize(numComponents*numActive);
+            zbuf.resize(numComponents*numActive);
+            Vbuf.resize(numActive);
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+                for (size_t i = 0; i < numActive; ++i) {
+                    Kbuf[compIdx*numActive + i] = K[active[i]][compIdx];
+                    zbuf[compIdx*numActive + i] = z[active[i]][compIdx];
+                }
+            }
+            solveRachfordRice(Vbuf.data(), Kbuf.data(), zbuf.data(), numActive);
+
+            size_t numRemaining = 0;
+            for (size_t i = 0; i < numActive; ++i) {
+                size_t idx = active[i];
+                FluidState& fs = fluidStates[idx];
+                ParameterCache& paramCache = paramCaches[idx];
+
+                setCompositions_(fs, paramCache, K[idx], z[idx], Vbuf[i],
+                                 liquidPhaseIdx, gasPhaseIdx);
+
+                ComponentVector g, Knew;
+                ++numIterations[idx];
+                if (!fugacityResidual_(g, Knew, fs, paramCache, K[idx],
+                                       liquidPhaseIdx, gasPhaseIdx)) {
+                    // the fluid state failed. it is not solved individually
+                    statuses[idx].iterations = numIterations[idx];
+                    numIterations[idx] = -1;
+                    continue;
+                }
+
+                if (maxAbs_(g) <= switchTolerance_())
+                    continue;
+
+                K[idx] = Knew;
+                active[numRemaining++] = idx;
+            }
+            active.resize(numRemaining);
+        }
+
+        size_t numFailed = 0;
+        for (size_t idx = 0; idx < n; ++idx) {
+            if (numIterations[idx] > 0) {
+                statuses[idx] = trySolve_(fluidStates[idx], paramCaches[idx], K[idx], z[idx],
+                                          liquidPhaseIdx, gasPhaseIdx, tolerance);
+                statuses[idx].iterations += numIterations[idx];
+            }
+
+            if (!statuses[idx].converged())
+                ++numFailed;
+        }
+
+        return numFailed;
+    }
+
+private:
+    // the maximum number of problems which are processed in lock-step by
+    // solveRachfordRice(). this limits the amount of temporary stack space.
+    enum { batchChunkSize_ = 64 };
+
+    // the maximum number of iterations for the K-values
+    static const int maxIterations_ = 200;
+
+    // the maximum number of iterations for the Rachford-Rice equation
+    static const int maxRachfordRiceIterations_ = 100;
+
+    // the fugacity residual below which the Newton method is used instead of
+    // successive substitution
+    static Scalar switchTolerance_()
+    { return 1e-2; }
+
+    // the perturbation of ln(K) used to approximate the Jacobian matrix
+    static Scalar epsilon_()
+    { return 1e-7; }
+
+    // the maximum change of ln(K) of a Newton step
+    static Scalar maxNewtonUpdate_()
+    { return 1.0; }
+
+    static void solveRachfordRiceChunk_(Scalar* vaporFraction,
+                                        const Scalar* K,
+                                        const Scalar* z,
+                                        size_t stride,
+                                        size_t n)
+    {
+        Scalar lo[batchChunkSize_];
+        Scalar hi[batchChunkSize_];
+        Scalar f[batchChunkSize_];
+        Scalar df[batchChunkSize_];
+
+        // the values of the Rachford-Rice function at V = 0 and V = 1 determine
+        // whether a root exists within [0, 1]
+        for (size_t i = 0; i < n; ++i) {
+            f[i] = 0.0;
+            df[i] = 0.0;
+        }
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            const Scalar* Kc = K + compIdx*stride;
+            const Scalar* zc = z + compIdx*stride;
+            for (size_t i = 0; i < n; ++i) {
+                f[i] += zc[i]*(Kc[i] - 1);
+                df[i] += zc[i]*(Kc[i] - 1)/Kc[i];
+            }
+        }
+
+        bool converged = true;
+        for (size_t i = 0; i < n; ++i) {
+            bool twoPhase = f[i] > 0.0 && df[i] < 0.0;
+            lo[i] = 0.0;
+            hi[i] = 1.0;
+            vaporFraction[i] = twoPhase ? 0.5 : (f[i] > 0.0 ? 1.0 : 0.0);
+
+            // single-phase problems are considered to be converged
+            lo[i] = twoPhase ? lo[i] : vaporFraction[i];
+            hi[i] = twoPhase ? hi[i] : vaporFraction[i];
+            converged = converged && !twoPhase;
+        }
+
+        for (int iterIdx = 0; iterIdx < maxRachfordRiceIterations_ && !converged; ++iterIdx) {
+            for (size_t i = 0; i < n; ++i) {
+                f[i] = 0.0;
+                df[i] = 0.0;
+            }
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+                const Scalar* Kc = K + compIdx*stride;
+                const Scalar* zc = z + compIdx*stride;
+                for (size_t i = 0; i < n; ++i) {
+                    Scalar a = Kc[i] - 1;
+                    Scalar d = 1/(1 + vaporFraction[i]*a);
+                    Scalar t = zc[i]*a*d;
+                    f[i] += t;
+                    df[i] -= t*a*d;
+                }
+            }
+
+            // the Rachford-Rice function is monotonically decreasing, so its sign
+            // tells on which side of the root the current vapor fraction is. if the
+            // Newton update leaves the bracket, bisection is used.
+            converged = true;
+            for (size_t i = 0; i < n; ++i) {
+                Scalar V = vaporFraction[i];
+                lo[i] = (f[i] > 0.0) ? V : lo[i];
+                hi[i] = (f[i] > 0.0) ? hi[i] : V;
+
+                Scalar Vnew = (df[i] < 0.0) ? V - f[i]/df[i] : 0.5*(lo[i] + hi[i]);
+                bool inBracket = lo[i] < Vnew && Vnew < hi[i];
+                Vnew = inBracket ? Vnew : 0.5*(lo[i] + hi[i]);
+
+                converged = converged && std::abs(Vnew - V) <= 1e-14;
+                vaporFraction[i] = Vnew;
+            }
+        }
+    }
+
+    template <class ComponentVectorT>
+    static bool normalize_(ComponentVector& z, const ComponentVectorT& globalMoleFractions)
+    {
+        Scalar sumMoles = 0.0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            sumMoles += globalMoleFractions[compIdx];
+        if (!(sumMoles > 0.0))
+            return false;
+
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            z[compIdx] = globalMoleFractions[compIdx]/sumMoles;
+        return true;
+    }
+
+    static Scalar maxAbs_(const ComponentVector& v)
+    {
+        Scalar result = 0.0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            result = std::max(result, std::abs(v[compIdx]));
+        return result;
+    }
+
+    // set the phase compositions which correspond to the K-values and the vapor
+    // fraction. the compositions are normalized, which only makes a difference for an
+    // absent phase: its fugacity coefficients are evaluated for the normalized
+    // composition of the stationary point as in the stability test of Michelsen.
+    template <class FluidState>
+    static void setCompositions_(FluidState &fluidState,
+                                 ParameterCache &paramCache,
+                                 const ComponentVector& K,
+                                 const ComponentVector& z,
+                                 Scalar V,
+                                 int liquidPhaseIdx,
+                                 int gasPhaseIdx)
+    {
+        ComponentVector x, y;
+        Scalar sumX = 0.0, sumY = 0.0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            x[compIdx] = z[compIdx]/(1 + V*(K[compIdx] - 1));
+            y[compIdx] = K[compIdx]*x[compIdx];
+            sumX += x[compIdx];
+            sumY += y[compIdx];
+        }
+
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            fluidState.setMoleFraction(liquidPhaseIdx, compIdx, x[compIdx]/sumX);
+            fluidState.setMoleFraction(gasPhaseIdx, compIdx, y[compIdx]/sumY);
+        }
+
+        paramCache.updateComposition(fluidState, liquidPhaseIdx);
+        paramCache.updateComposition(fluidState, gasPhaseIdx);
+    }
+
+    // solve the Rachford-Rice equation for a single problem and set the compositions
+    template <class FluidState>
+    static Scalar updateCompositions_(FluidState &fluidState,
+                                      ParameterCache &paramCache,
+                                      const ComponentVector& K,
+                                      const ComponentVector& z,
+                                      int liquidPhaseIdx,
+                                      int gasPhaseIdx)
+    {
+        Scalar V;
+        solveRachfordRice(&V, &K[0], &z[0], /*n=*/1);
+        setCompositions_(fluidState, paramCache, K, z, V, liquidPhaseIdx, gasPhaseIdx);
+        return V;
+    }
+
+    // compute the K-values given by the fugacity coefficients of the current phase
+    // compositions and the difference of their logarithms to the current K-values.
+    // the fugacity coefficients are stored in the fluid state.
+    template <class FluidState>
+    static bool fugacityResidual_(ComponentVector& g,
+                                  ComponentVector& Knew,
+                                  FluidState &fluidState,
+                                  const ParameterCache &paramCache,
+                                  const ComponentVector& K,
+                                  int liquidPhaseIdx,
+                                  int gasPhaseIdx)
+    {
+        Scalar phiL[numComponents];
+        Scalar phiG[numComponents];
+        FluidSystem::fugacityCoefficients(fluidState, paramCache, liquidPhaseIdx, phiL);
+        FluidSystem::fugacityCoefficients(fluidState, paramCache, gasPhaseIdx, phiG);
+
+        Scalar pRatio = fluidState.pressure(liquidPhaseIdx)/fluidState.pressure(gasPhaseIdx);
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            fluidState.setFugacityCoefficient(liquidPhaseIdx, compIdx, phiL[compIdx]);
+            fluidState.setFugacityCoefficient(gasPhaseIdx, compIdx, phiG[compIdx]);
+
+            Knew[compIdx] = phiL[compIdx]/phiG[compIdx]*pRatio;
+            g[compIdx] = std::log(K[compIdx]/Knew[compIdx]);
+            if (!std::isfinite(g[compIdx]) || !(Knew[compIdx] > 0.0))
+                return false;
+        }
+
+        return true;
+    }
+
+    // the iterations for a single fluid state. the parameter cache must be up to date
+    // with the temperature and the pressures.
+    template <class FluidState>
+    static SolverStatus trySolve_(FluidState &fluidState,
+                                  ParameterCache &paramCache,
+                                  ComponentVector& K,
+                                  const ComponentVector& z,
+                                  int liquidPhaseIdx,
+                                  int gasPhaseIdx,
+                                  Scalar tolerance)
+    {
+        SolverStatus status;
+
+        ComponentVector g, Knew;
+        ComponentVector prevK, prevKnew;
+        Scalar prevResidual = std::numeric_limits<Scalar>::infinity();
+        bool useNewton = true;
+        bool newtonStep = false;
+        for (int iterIdx = 0; iterIdx < maxIterations_; ++iterIdx) {
+            Scalar V = updateCompositions_(fluidState, paramCache, K, z,
+                                           liquidPhaseIdx, gasPhaseIdx);
+            status.iterations = iterIdx + 1;
+            if (!fugacityResidual_(g, Knew, fluidState, paramCache, K,
+                                   liquidPhaseIdx, gasPhaseIdx))
+                return status;
+
+            Scalar residual = maxAbs_(g);
+            status.residual = residual;
+            if (residual <= tolerance) {
+                completeFluidState_(fluidState, paramCache, K, z, V, liquidPhaseIdx, gasPhaseIdx);
+                status.result = SolverStatus::Converged;
+                return status;
+            }
+
+            // a Newton step which did not reduce the residual is discarded and the
+            // remaining iterations use successive substitution
+            if (newtonStep && !(residual < prevResidual)) {
+                useNewton = false;
+                K = prevKnew;
+                newtonStep = false;
+                continue;
+            }
+
+            prevK = K;
+            prevKnew = Knew;
+            prevResidual = residual;
+            newtonStep =
+                useNewton
+                && residual <= switchTolerance_()
+                && newtonUpdate_(K, g, fluidState, paramCache, z, liquidPhaseIdx, gasPhaseIdx);
+            if (!newtonStep)
+                K = Knew;
+        }
+
+        return status;
+    }
+
+    // apply a Newton update to ln(K). the Jacobian matrix of the fugacity residual is
+    // approximated using forward differences.
+    template <class FluidState>
+    static bool newtonUpdate_(ComponentVector& K,
+                              const ComponentVector& g,
+                              FluidState &fluidState,
+                              ParameterCache &paramCache,
+                              const ComponentVector& z,
+                              int liquidPhaseIdx,
+                              int gasPhaseIdx)
+    {
+        typedef Dune::FieldMatrix<Scalar, numComponents, numComponents> Matrix;
+
+        Matrix J;
+        ComponentVector Kpert, gpert, Kdummy;
+        for (int colIdx = 0; colIdx < numComponents; ++colIdx) {
+            Kpert = K;
+            Kpert[colIdx] *= std::exp(epsilon_());
+            updateCompositions_(fluidState, paramCache, Kpert, z, liquidPhaseIdx, gasPhaseIdx);
+            if (!fugacityResidual_(gpert, Kdummy, fluidState, paramCache, Kpert,
+                                   liquidPhaseIdx, gasPhaseIdx))
+                return false;
+
+            for (int rowIdx = 0; rowIdx < numComponents; ++rowIdx)
+                J[rowIdx][colIdx] = (gpert[rowIdx] - g[rowIdx])/epsilon_();
+        }
+        Valgrind::CheckDefined(J);
+
+        ComponentVector delta(0.0);
+        if (!solveLinearSystemNoThrow(J, delta, g, /*singularLimit=*/1e-30)
+            || !isFiniteVector(delta))
+            return false;
+
+        // limit the step while keeping its direction
+        Scalar maxDelta = maxAbs_(delta);
+        Scalar factor = (maxDelta > maxNewtonUpdate_()) ? maxNewtonUpdate_()/maxDelta : 1.0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            K[compIdx] *= std::exp(-factor*delta[compIdx]);
+
+        return true;
+    }
+
+    // set the densities and saturations of the phases for a converged solution
+    template <class FluidState>
+    static void completeFluidState_(FluidState &fluidState,
+                                    ParameterCache &paramCache,
+                                    const ComponentVector& K,
+                                    const ComponentVector& z,
+                                    Scalar V,
+                                    int liquidPhaseIdx,
+                                    int gasPhaseIdx)
+    {
+        Scalar rhoL = FluidSystem::density(fluidState, paramCache, liquidPhaseIdx);
+        Scalar rhoG = FluidSystem::density(fluidState, paramCache, gasPhaseIdx);
+        fluidState.setDensity(liquidPhaseIdx, rhoL);
+        fluidState.setDensity(gasPhaseIdx, rhoG);
+
+        // the volumes of the phases per mole of the mixture
+        Scalar volL = (V < 1.0) ? (1 - V)/fluidState.molarDensity(liquidPhaseIdx) : 0.0;
+        Scalar volG = (V > 0.0) ? V/fluidState.molarDensity(gasPhaseIdx) : 0.0;
+
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            fluidState.setSaturation(phaseIdx, 0.0);
+        fluidState.setSaturation(liquidPhaseIdx, volL/(volL + volG));
+        fluidState.setSaturation(gasPhaseIdx, volG/(volL + volG));
+
+        // the mole fractions of an absent phase are the unnormalized ones of the
+        // stationary point, so that its fugacities are the ones of the present phase
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            Scalar x = z[compIdx]/(1 + V*(K[compIdx] - 1));
+            fluidState.setMoleFraction(liquidPhaseIdx, compIdx, x);
+            fluidState.setMoleFraction(gasPhaseIdx, compIdx, K[compIdx]*x);
+        }
+    }
+};
+
+} // namespace Opm
+
+#endif
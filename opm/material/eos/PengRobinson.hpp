@@ -28,12 +28,22 @@
 
 #include <opm/material/fluidstates/TemperatureOverlayFluidState.hpp>
 #include <opm/material/IdealGas.hpp>
-#include <opm/material/common/UniformTabulated2DFunction.hpp>
+#include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
 
 #include <opm/material/common/Unused.hpp>
 #include <opm/material/common/PolynomialUtils.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/Tabulated1DFunction.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <csignal>
+#include <cstddef>
+#include <future>
+#include <limits>
+#include <vector>
 
 namespace Opm {
 
@@ -60,41 +70,112 @@ class PengRobinson
     { }
 
 public:
-    static void  init(Scalar aMin, Scalar aMax, int na,
-                      Scalar bMin, Scalar bMax, int nb)
+    /*!
+     * \brief Set up the tabulation of the critical points.
+     *
+     * The critical molar volume is required for fluids whose equation of state does
+     * not exhibit any extrema. Computing it is considerably more expensive than
+     * solving the cubic, so the critical points are tabulated for the given range of
+     * attractive and repulsive parameters. Outside of this range and for the points
+     * where no critical point could be determined, the critical point is calculated
+     * directly.
+     *
+     * The table is organized in tiles of tileIntervals_ x tileIntervals_ intervals.
+     * Each tile is filled in one go. If the table is created lazily, this happens on
+     * the first access of a tile. Concurrent accesses are safe.
+     *
+     * \param aMin The minimum of the attractive parameter
+     * \param aMax The maximum of the attractive parameter
+     * \param na The number of sampling points for the attractive parameter
+     * \param bMin The minimum of the repulsive parameter
+     * \param bMax The maximum of the repulsive parameter
+     * \param nb The number of sampling points for the repulsive parameter
+     * \param lazy If true, tabulate the critical points of a tile on its first use
+     * \param adaptiveTolerance If larger than zero, the resolution of a tile is
+     *                          doubled (up to maxTileRefinement_ times) until the
+     *                          relative error of the interpolated critical molar
+     *                          volume at the cell centers is below this value
+     */
+    static void init(Scalar aMin, Scalar aMax, int na,
+                     Scalar bMin, Scalar bMax, int nb,
+                     bool lazy = false,
+                     Scalar adaptiveTolerance = 0.0)
     {
-/*
-        // resize the tabulation for the critical points
-        criticalTemperature_.resize(aMin, aMax, na, bMin, bMax, nb);
-        criticalPressure_.resize(aMin, aMax, na, bMin, bMax, nb);
-        criticalMolarVolume_.resize(aMin, aMax, na, bMin, bMax, nb);
-
-        Scalar VmCrit, pCrit, TCrit;
-        for (int i = 0; i < na; ++i) {
-            Scalar a = criticalTemperature_.iToX(i);
-            assert(std::abs(criticalTemperature_.xToI(criticalTemperature_.iToX(i)) - i) < 1e-10);
-
-            for (int j = 0; j < nb; ++j) {
-                Scalar b = criticalTemperature_.jToY(j);
-                assert(std::abs(criticalTemperature_.yToJ(criticalTemperature_.jToY(j)) - j) < 1e-10);
-
-                findCriticalPoint_(TCrit, pCrit, VmCrit,  a, b);
-
-                criticalTemperature_.setSamplePoint(i, j, TCrit);
-                criticalPressure_.setSamplePoint(i, j, pCrit);
-                criticalMolarVolume_.setSamplePoint(i, j, VmCrit);
+        OPM_PROFILER_RANGE("PengRobinson::init");
+
+        // this is not thread safe with respect to concurrent accesses of the table
+        releaseTiles_();
+
+        if (na < 2 || nb < 2 || !(aMin < aMax) || !(bMin < bMax))
+            OPM_THROW(std::runtime_error,
+                      "Invalid range for the tabulation of the critical points");
+
+        critAMin_ = aMin;
+        critAMax_ = aMax;
+        critBMin_ = bMin;
+        critBMax_ = bMax;
+        critNa_ = na;
+        critNb_ = nb;
+        critAdaptiveTolerance_ = adaptiveTolerance;
+
+        numTilesA_ = (na - 1 + tileIntervals_ - 1)/tileIntervals_;
+        numTilesB_ = (nb - 1 + tileIntervals_ - 1)/tileIntervals_;
+        int numTiles = numTilesA_*numTilesB_;
+        std::atomic<const CriticalTile_*>* tiles = new std::atomic<const CriticalTile_*>[numTiles];
+        for (int tileIdx = 0; tileIdx < numTiles; ++tileIdx)
+            tiles[tileIdx].store(nullptr, std::memory_order_relaxed);
+        tiles_.store(tiles, std::memory_order_release);
+
+        if (lazy)
+            return;
+
+        bool failed = false;
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic)
+#endif
+        for (int tileIdx = 0; tileIdx < numTiles; ++tileIdx) {
+            try {
+                tile_(tileIdx);
+            }
+            catch (...) {
+#ifdef _OPENMP
+                #pragma omp critical (OpmPengRobinsonTabulationFailure)
+#endif
+                failed = true;
             }
         }
-        */
+
+        if (failed)
+            OPM_THROW(std::runtime_error,
+                      "Could not tabulate the critical points of the Peng-Robinson EOS");
+    }
+
+    /*!
+     * \brief Set up the tabulation of the critical points in a background thread.
+     *
+     * The arguments are the same as the ones of init(). The equation of state must not
+     * be used before the returned future is ready, cf. Opm::AsyncInitializer.
+     */
+    static std::future<void> initAsync(Scalar aMin, Scalar aMax, int na,
+                                       Scalar bMin, Scalar bMax, int nb,
+                                       bool lazy = false,
+                                       Scalar adaptiveTolerance = 0.0)
+    {
+        return std::async(std::launch::async, [=]() {
+                init(aMin, aMax, na, bMin, bMax, nb, lazy, adaptiveTolerance);
+            });
     }
 
     /*!
-     * \brief Predicts the vapor pressure for the temperature given in
-     *        setTP().
+     * \brief Predicts the vapor pressure of a pure component.
      *
      * Initially, the vapor pressure is roughly estimated by using the
      * Ambrose-Walton method, then the Newton method is used to make
      * difference between the gas and liquid phase fugacity zero.
+     *
+     * The component is given by Params::Component. It must provide its
+     * critical temperature, critical pressure and acentric factor. Above the
+     * critical temperature, the critical pressure is returned.
      */
     template <class Params>
     static Scalar computeVaporPressure(const Params &params, Scalar T)
@@ -103,30 +184,63 @@ public:
         if (T >= Component::criticalTemperature())
             return Component::criticalPressure();
 
-        // initial guess of the vapor pressure
-        Scalar Vm[3];
-        const Scalar eps = Component::criticalPressure()*1e-10;
+        Scalar a, b;
+        pureParameters_<Component>(a, b, T);
+        Scalar RT = R*T;
 
         // use the Ambrose-Walton method to get an initial guess of
         // the vapor pressure
         Scalar pVap = ambroseWalton_(params, T);
 
-        // Newton-Raphson method
-        for (int i = 0; i < 5; ++i) {
-            // calculate the molar densities
-            OPM_UNUSED int numSol = molarVolumes(Vm, params, T, pVap);
-            assert(numSol == 3);
+        // Newton-Raphson method. the derivative of the logarithm of a pure fluid's
+        // fugacity coefficient with regard to pressure is (Z - 1)/p, so the
+        // derivative of the difference between the liquid and the gas phase is
+        // (Z_liquid - Z_gas)/p. since the range where liquid and gas coexist
+        // according to the EOS becomes very narrow close to the critical point,
+        // the vapor pressure is bracketed and bisection is used if the Newton
+        // method leaves the bracket.
+        Scalar pLow = 0.0;
+        Scalar pHigh = Component::criticalPressure();
+        for (int i = 0; i < 100; ++i) {
+            Scalar Astar = a*pVap/(RT*RT);
+            Scalar Bstar = b*pVap/RT;
+
+            // the compressibility factor of the liquid is tiny at low temperatures,
+            // so instead of solving the cubic in closed form, the largest and the
+            // smallest root are determined using Newton's method. starting at Bstar
+            // and 1, it converges monotonically if the respective root exists.
+            Scalar a2 = - (1 - Bstar);
+            Scalar a3 = Astar - Bstar*(3*Bstar + 2);
+            Scalar a4 = Bstar*(- Astar + Bstar*(1 + Bstar));
+            Scalar ZGas = cubicRootNewton_(1.0, a2, a3, a4);
+            Scalar ZLiquid = cubicRootNewton_(Bstar, a2, a3, a4);
+            if (!std::isfinite(ZLiquid) || !(ZLiquid < ZGas*(1 - 1e-8))) {
+                // liquid and gas do not coexist at this pressure. if the only
+                // intersection is liquid-like, i.e., its molar volume is below the
+                // critical one of the EOS (approximately 3.95 b), the pressure is too
+                // high.
+                if (ZGas*RT/pVap < 3.95*b)
+                    pHigh = pVap;
+                else
+                    pLow = pVap;
+                pVap = (pLow > 0.0) ? (pLow + pHigh)/2 : 0.9*pVap;
+                continue;
+            }
 
-            Scalar f = fugacityDifference_(params, T, pVap, Vm[0], Vm[2]);
-            Scalar df_dp =
-                fugacityDifference_(params, T, pVap  + eps, Vm[0], Vm[2])
-                -
-                fugacityDifference_(params, T, pVap - eps, Vm[0], Vm[2]);
-            df_dp /= 2*eps;
+            Scalar f =
+                pureLogFugacityCoefficient_(ZLiquid, Astar, Bstar)
+                - pureLogFugacityCoefficient_(ZGas, Astar, Bstar);
+            if (f > 0.0)
+                pLow = pVap;
+            else
+                pHigh = pVap;
 
-            Scalar delta = f/df_dp;
-            pVap = pVap - delta;
+            Scalar pNew = pVap - f*pVap/(ZLiquid - ZGas);
+            if (!(pLow < pNew && pNew < pHigh))
+                pNew = (pLow > 0.0) ? (pLow + pHigh)/2 : pHigh/2;
 
+            Scalar delta = pNew - pVap;
+            pVap = pNew;
             if (std::abs(delta/pVap) < 1e-10)
                 break;
         }
@@ -134,6 +248,39 @@ public:
         return pVap;
     }
 
+    /*!
+     * \brief Returns the vapor pressure of a pure component using a table.
+     *
+     * This yields the same result as computeVaporPressure() up to the
+     * interpolation error, but it avoids the Newton method. The table of
+     * ln(p_vap) over 1/T is created on the first call for a given component and
+     * covers the temperatures between 0.3 times the critical temperature and the
+     * critical temperature. Below this range, the vapor pressure is calculated
+     * directly and its derivatives are determined by extrapolating the table,
+     * i.e., using the Clausius-Clapeyron relation. If the temperature is a
+     * function evaluation, the derivative of the vapor pressure with regard to
+     * temperature is also provided.
+     */
+    template <class Params, class Evaluation>
+    static Evaluation tabulatedVaporPressure(const Params &params, const Evaluation& T)
+    {
+        typedef typename Params::Component Component;
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (Toolbox::value(T) >= Component::criticalTemperature())
+            return Toolbox::createConstant(Component::criticalPressure());
+
+        const auto& table = vaporPressureTable_(params);
+        const Evaluation& invT = 1.0/T;
+        const Evaluation& pVap = Toolbox::exp(table.eval(invT, /*extrapolate=*/true));
+        if (table.applies(Toolbox::value(invT)))
+            return pVap;
+
+        // below the range of the table, the value is calculated directly while the
+        // derivatives are taken from the extrapolated table
+        return pVap*(computeVaporPressure(params, Toolbox::value(T))/Toolbox::value(pVap));
+    }
+
     /*!
      * \brief Computes molar volumes where the Peng-Robinson EOS is
      *        true.
@@ -189,35 +336,8 @@ public:
             else
                 Vm = Z[0]*RT/p;
         }
-        else if (numSol == 1) {
-            // the EOS only has one intersection with the pressure,
-            // for the other phase, we take the extremum of the EOS
-            // with the largest distance from the intersection.
-            Scalar VmCubic = Z[0]*RT/p;
-            Vm = VmCubic;
-
-            // find the extrema (if they are present)
-            Scalar Vmin, Vmax, pmin, pmax;
-            if (findExtrema_(Vmin, Vmax,
-                             pmin, pmax,
-                             a, b, T))
-            {
-                if (isGasPhase)
-                    Vm = std::max(Vmax, VmCubic);
-                else {
-                    if (Vmin > 0)
-                        Vm = std::min(Vmin, VmCubic);
-                    else
-                        Vm = VmCubic;
-                }
-            }
-            else {
-                // the EOS does not exhibit any physically meaningful
-                // extrema, and the fluid is critical...
-                Vm = VmCubic;
-                handleCriticalFluid_(Vm, fs, params, phaseIdx, isGasPhase);
-            }
-        }
+        else if (numSol == 1)
+            Vm = molarVolumeFromSingleRoot_(Z[0]*RT/p, fs, params, phaseIdx, isGasPhase);
 
         Valgrind::CheckDefined(Vm);
         assert(std::isfinite(Vm));
@@ -225,6 +345,79 @@ public:
         return Vm;
     }
 
+    /*!
+     * \brief Computes the molar volume of a fluid phase for a batch of fluid states.
+     *
+     * The result is the same as calling computeMolarVolume() for each fluid state,
+     * but the cubic equations of all fluid states are solved at once using
+     * invertCubicPolynomialBatch(). The parameters of the i-th fluid state are given
+     * by *params[i].
+     */
+    template <class FluidState, class Params>
+    static void computeMolarVolumeBatch(Scalar *Vm,
+                                        const FluidState *fluidStates,
+                                        const Params * const *params,
+                                        int phaseIdx,
+                                        bool isGasPhase,
+                                        size_t n)
+    {
+        Scalar a1[batchChunkSize_];
+        Scalar a2[batchChunkSize_];
+        Scalar a3[batchChunkSize_];
+        Scalar a4[batchChunkSize_];
+        Scalar RTp[batchChunkSize_];
+        bool valid[batchChunkSize_];
+        Scalar Z[3*batchChunkSize_];
+        int numSol[batchChunkSize_];
+
+        for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += batchChunkSize_) {
+            const size_t m = std::min<size_t>(batchChunkSize_, n - chunkBegin);
+            const FluidState *fsc = fluidStates + chunkBegin;
+            const Params * const *paramsc = params + chunkBegin;
+            Scalar *Vmc = Vm + chunkBegin;
+
+            // assemble the coefficients of the cubic equations. invalid parameters
+            // are replaced by a trivial equation and result in NaN.
+            for (size_t i = 0; i < m; ++i) {
+                Scalar T = fsc[i].temperature(phaseIdx);
+                Scalar p = fsc[i].pressure(phaseIdx);
+                Scalar a = paramsc[i]->a(phaseIdx);
+                Scalar b = paramsc[i]->b(phaseIdx);
+                Valgrind::CheckDefined(T);
+                Valgrind::CheckDefined(p);
+
+                valid[i] = std::isfinite(a) && a != 0 && std::isfinite(b) && b > 0;
+
+                Scalar RT = R*T;
+                Scalar Astar = a*p/(RT*RT);
+                Scalar Bstar = b*p/RT;
+
+                RTp[i] = RT/p;
+                a1[i] = 1.0;
+                a2[i] = valid[i] ? - (1 - Bstar) : 0.0;
+                a3[i] = valid[i] ? Astar - Bstar*(3*Bstar + 2) : 0.0;
+                a4[i] = valid[i] ? Bstar*(- Astar + Bstar*(1 + Bstar)) : 0.0;
+            }
+
+            invertCubicPolynomialBatch(Z, numSol, a1, a2, a3, a4, m);
+
+            // the gas phase uses the largest, the liquid phase the smallest root. if
+            // the EOS has a single intersection with the pressure, the molar volume
+            // of the other phase is determined by the extrema of the EOS
+            const int rootIdx = isGasPhase ? 2 : 0;
+            for (size_t i = 0; i < m; ++i) {
+                if (!valid[i])
+                    Vmc[i] = std::numeric_limits<Scalar>::quiet_NaN();
+                else if (numSol[i] == 3)
+                    Vmc[i] = Z[3*i + rootIdx]*RTp[i];
+                else
+                    Vmc[i] = molarVolumeFromSingleRoot_(Z[3*i]*RTp[i], fsc[i], *paramsc[i],
+                                                        phaseIdx, isGasPhase);
+                Valgrind::CheckDefined(Vmc[i]);
+            }
+        }
+    }
+
     /*!
      * \brief Returns the fugacity coefficient for a given pressure
      *        and molar volume.
@@ -272,6 +465,49 @@ public:
     { return params.pressure()*computeFugacityCoeff(params); }
 
 protected:
+    // the number of fluid states which are processed at once by the batched methods.
+    // this limits the amount of temporary space required
+    enum { batchChunkSize_ = 64 };
+
+    // determine the molar volume of a phase if the EOS only has one intersection
+    // with the pressure: for the other phase, we take the extremum of the EOS with
+    // the largest distance from the intersection.
+    template <class FluidState, class Params>
+    static Scalar molarVolumeFromSingleRoot_(Scalar VmCubic,
+                                             const FluidState &fs,
+                                             const Params &params,
+                                             int phaseIdx,
+                                             bool isGasPhase)
+    {
+        Scalar T = fs.temperature(phaseIdx);
+        Scalar a = params.a(phaseIdx);
+        Scalar b = params.b(phaseIdx);
+        Scalar Vm = VmCubic;
+
+        // find the extrema (if they are present)
+        Scalar Vmin, Vmax, pmin, pmax;
+        if (findExtrema_(Vmin, Vmax,
+                         pmin, pmax,
+                         a, b, T))
+        {
+            if (isGasPhase)
+                Vm = std::max(Vmax, VmCubic);
+            else {
+                if (Vmin > 0)
+                    Vm = std::min(Vmin, VmCubic);
+                else
+                    Vm = VmCubic;
+            }
+        }
+        else {
+            // the EOS does not exhibit any physically meaningful
+            // extrema, and the fluid is critical...
+            handleCriticalFluid_(Vm, fs, params, phaseIdx, isGasPhase);
+        }
+
+        return Vm;
+    }
+
     template <class FluidState, class Params>
     static void handleCriticalFluid_(Scalar &Vm,
                                      const FluidState &fs,
@@ -279,15 +515,14 @@ protected:
                                      int phaseIdx,
                                      bool isGasPhase)
     {
-        Scalar Tcrit, pcrit, Vcrit;
-        findCriticalPoint_(Tcrit,
-                           pcrit,
-                           Vcrit,
-                           params.a(phaseIdx),
-                           params.b(phaseIdx));
-
+        Scalar a = params.a(phaseIdx);
+        Scalar b = params.b(phaseIdx);
 
-        //Scalar Vcrit = criticalMolarVolume_.eval(params.a(phaseIdx), params.b(phaseIdx));
+        Scalar Vcrit = tabulatedCriticalMolarVolume_(a, b);
+        if (!std::isfinite(Vcrit)) {
+            Scalar Tcrit, pcrit;
+            findCriticalPoint_(Tcrit, pcrit, Vcrit, a, b);
+        }
 
         if (isGasPhase)
             Vm = std::max(Vm, Vcrit);
@@ -295,6 +530,205 @@ protected:
             Vm = std::min(Vm, Vcrit);
     }
 
+    // the number of intervals per dimension of a tile of the critical point table at
+    // its base resolution
+    enum { tileIntervals_ = 8 };
+
+    // the maximum factor by which the resolution of a tile may be increased if the
+    // table is adaptive
+    enum { maxTileRefinement_ = 16 };
+
+    // the tabulated critical points for a rectangular part of the (a, b) range
+    struct CriticalTile_
+    {
+        Scalar aMin;
+        Scalar bMin;
+        Scalar da;
+        Scalar db;
+        int na; // number of intervals
+        int nb;
+
+        // the critical temperature, pressure and molar volume of each sampling
+        // point. NaN if no critical point could be determined.
+        std::vector<Scalar> Tcrit;
+        std::vector<Scalar> pcrit;
+        std::vector<Scalar> Vcrit;
+
+        int index(int i, int j) const
+        { return j*(na + 1) + i; }
+    };
+
+    // returns the interpolated critical molar volume or NaN if the parameters are
+    // not covered by the table
+    static Scalar tabulatedCriticalMolarVolume_(Scalar a, Scalar b)
+    {
+        const Scalar NaN = std::numeric_limits<Scalar>::quiet_NaN();
+        if (!tiles_.load(std::memory_order_acquire)
+            || !(critAMin_ <= a && a <= critAMax_)
+            || !(critBMin_ <= b && b <= critBMax_))
+            return NaN;
+
+        // find the tile
+        Scalar daBase = (critAMax_ - critAMin_)/(critNa_ - 1);
+        Scalar dbBase = (critBMax_ - critBMin_)/(critNb_ - 1);
+        int tileI = std::min<int>(static_cast<int>((a - critAMin_)/(daBase*tileIntervals_)),
+                                  numTilesA_ - 1);
+        int tileJ = std::min<int>(static_cast<int>((b - critBMin_)/(dbBase*tileIntervals_)),
+                                  numTilesB_ - 1);
+
+        const CriticalTile_* tile;
+        try {
+            tile = tile_(tileJ*numTilesA_ + tileI);
+        }
+        catch (...) {
+            return NaN;
+        }
+
+        return interpolate_(*tile, tile->Vcrit, a, b);
+    }
+
+    // bi-linearly interpolate a quantity within a tile
+    static Scalar interpolate_(const CriticalTile_& tile,
+                               const std::vector<Scalar>& values,
+                               Scalar a,
+                               Scalar b)
+    {
+        Scalar alpha = (a - tile.aMin)/tile.da;
+        Scalar beta = (b - tile.bMin)/tile.db;
+        int i = std::max(0, std::min(tile.na - 1, static_cast<int>(alpha)));
+        int j = std::max(0, std::min(tile.nb - 1, static_cast<int>(beta)));
+        alpha -= i;
+        beta -= j;
+
+        // NaN values propagate, i.e., the caller falls back to the direct
+        // computation
+        return
+            (1 - beta)*((1 - alpha)*values[tile.index(i, j)] + alpha*values[tile.index(i + 1, j)])
+            + beta*((1 - alpha)*values[tile.index(i, j + 1)] + alpha*values[tile.index(i + 1, j + 1)]);
+    }
+
+    // returns a tile of the critical point table. the tile is computed if it does
+    // not exist yet
+    static const CriticalTile_* tile_(int tileIdx)
+    {
+        std::atomic<const CriticalTile_*>* tiles = tiles_.load(std::memory_order_acquire);
+        const CriticalTile_* tile = tiles[tileIdx].load(std::memory_order_acquire);
+        if (tile)
+            return tile;
+
+        return buildTile_(tiles, tileIdx);
+    }
+
+    static const CriticalTile_* buildTile_(std::atomic<const CriticalTile_*>* tiles, int tileIdx)
+    {
+        int tileI = tileIdx % numTilesA_;
+        int tileJ = tileIdx / numTilesA_;
+
+        Scalar daBase = (critAMax_ - critAMin_)/(critNa_ - 1);
+        Scalar dbBase = (critBMax_ - critBMin_)/(critNb_ - 1);
+
+        // the last tiles may be smaller than the other ones
+        int naBase = std::min<int>(tileIntervals_, critNa_ - 1 - tileI*tileIntervals_);
+        int nbBase = std::min<int>(tileIntervals_, critNb_ - 1 - tileJ*tileIntervals_);
+
+        CriticalTile_* tile = new CriticalTile_;
+        try {
+            for (int refinement = 1; ; refinement *= 2) {
+                tile->aMin = critAMin_ + tileI*tileIntervals_*daBase;
+                tile->bMin = critBMin_ + tileJ*tileIntervals_*dbBase;
+                tile->na = naBase*refinement;
+                tile->nb = nbBase*refinement;
+                tile->da = daBase/refinement;
+                tile->db = dbBase/refinement;
+                fillTile_(*tile);
+
+                if (critAdaptiveTolerance_ <= 0
+                    || 2*refinement > maxTileRefinement_
+                    || tileIsAccurate_(*tile))
+                    break;
+            }
+        }
+        catch (...) {
+            delete tile;
+            throw;
+        }
+
+        const CriticalTile_* expected = nullptr;
+        if (!tiles[tileIdx].compare_exchange_strong(expected, tile,
+                                                    std::memory_order_acq_rel,
+                                                    std::memory_order_acquire)) {
+            // some other thread was faster
+            delete tile;
+            return expected;
+        }
+
+        return tile;
+    }
+
+    static void fillTile_(CriticalTile_& tile)
+    {
+        const Scalar NaN = std::numeric_limits<Scalar>::quiet_NaN();
+        int numPoints = (tile.na + 1)*(tile.nb + 1);
+        tile.Tcrit.resize(numPoints);
+        tile.pcrit.resize(numPoints);
+        tile.Vcrit.resize(numPoints);
+
+        for (int j = 0; j <= tile.nb; ++j) {
+            Scalar b = tile.bMin + j*tile.db;
+            for (int i = 0; i <= tile.na; ++i) {
+                Scalar a = tile.aMin + i*tile.da;
+                int idx = tile.index(i, j);
+                try {
+                    findCriticalPoint_(tile.Tcrit[idx], tile.pcrit[idx], tile.Vcrit[idx], a, b);
+                }
+                catch (const NumericalIssue&) {
+                    tile.Tcrit[idx] = tile.pcrit[idx] = tile.Vcrit[idx] = NaN;
+                }
+            }
+        }
+    }
+
+    // check whether the critical molar volume interpolated at the cell centers of a
+    // tile is within the tolerance of the adaptive table
+    static bool tileIsAccurate_(const CriticalTile_& tile)
+    {
+        for (int j = 0; j < tile.nb; ++j) {
+            Scalar b = tile.bMin + (j + 0.5)*tile.db;
+            for (int i = 0; i < tile.na; ++i) {
+                Scalar a = tile.aMin + (i + 0.5)*tile.da;
+
+                Scalar VcritInterp = interpolate_(tile, tile.Vcrit, a, b);
+                if (!std::isfinite(VcritInterp))
+                    // the direct computation is used for this cell anyway
+                    continue;
+
+                Scalar Tcrit, pcrit, Vcrit;
+                try {
+                    findCriticalPoint_(Tcrit, pcrit, Vcrit, a, b);
+                }
+                catch (const NumericalIssue&) {
+                    continue;
+                }
+
+                if (std::abs(VcritInterp - Vcrit) > critAdaptiveTolerance_*std::abs(Vcrit))
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    static void releaseTiles_()
+    {
+        std::atomic<const CriticalTile_*>* tiles = tiles_.exchange(nullptr);
+        if (!tiles)
+            return;
+
+        for (int tileIdx = 0; tileIdx < numTilesA_*numTilesB_; ++tileIdx)
+            delete tiles[tileIdx].load();
+        delete[] tiles;
+    }
+
     static void findCriticalPoint_(Scalar &Tcrit,
                                    Scalar &pcrit,
                                    Scalar &Vcrit,
@@ -501,44 +935,136 @@ protected:
         return Component::criticalPressure()*std::exp(f0 + omega * (f1 + omega*f2));
     }
 
-    /*!
-     * \brief Returns the difference between the liquid and the gas phase
-     *        fugacities in [bar]
-     *
-     * \param params Parameters
-     * \param T Temperature [K]
-     * \param p Pressure [bar]
-     * \param VmLiquid Molar volume of the liquid phase [cm^3/mol]
-     * \param VmGas Molar volume of the gas phase [cm^3/mol]
-     */
+    // calculates the Peng-Robinson parameters of a pure component at a given
+    // temperature. (see: R. Reid, et al.: The Properties of Gases and Liquids, 4th
+    // edition, McGraw-Hill, 1987, p. 43)
+    template <class Component>
+    static void pureParameters_(Scalar &a, Scalar &b, Scalar T)
+    {
+        Scalar pc = Component::criticalPressure();
+        Scalar omega = Component::acentricFactor();
+        Scalar Tr = T/Component::criticalTemperature();
+        Scalar RTc = R*Component::criticalTemperature();
+
+        Scalar f_omega = 0.37464 + omega*(1.54226 - omega*0.26992);
+        Scalar tmp = 1 + f_omega*(1 - std::sqrt(Tr));
+
+        a = 0.4572355*RTc*RTc/pc * tmp*tmp;
+        b = 0.0777961 * RTc / pc;
+    }
+
+    // finds a root of the normalized cubic polynomial x^3 + a2*x^2 + a3*x + a4
+    // using Newton's method. NaN is returned if the method does not converge
+    static Scalar cubicRootNewton_(Scalar x, Scalar a2, Scalar a3, Scalar a4)
+    {
+        for (int i = 0; i < 100; ++i) {
+            Scalar f = ((x + a2)*x + a3)*x + a4;
+            Scalar df = (3*x + 2*a2)*x + a3;
+            Scalar delta = f/df;
+            x -= delta;
+            if (std::abs(delta) <= 1e-14*std::abs(x))
+                return x;
+        }
+        return std::numeric_limits<Scalar>::quiet_NaN();
+    }
+
+    // returns the logarithm of the fugacity coefficient of a pure fluid given its
+    // compressibility factor and the reduced attractive and repulsive parameters.
+    // (see: R. Reid, et al.: The Properties of Gases and Liquids, 4th edition,
+    // McGraw-Hill, 1987, p. 143)
+    static Scalar pureLogFugacityCoefficient_(Scalar Z, Scalar Astar, Scalar Bstar)
+    {
+        return
+            Z - 1 - std::log(Z - Bstar)
+            - Astar/(2*std::sqrt(2.0)*Bstar)
+            * std::log((Z + (1 + std::sqrt(2.0))*Bstar)/(Z + (1 - std::sqrt(2.0))*Bstar));
+    }
+
+    // returns the table of the logarithm of the vapor pressure over the inverse
+    // temperature of a component. it is created on first use.
     template <class Params>
-    static Scalar fugacityDifference_(const Params &params,
-                                      Scalar T,
-                                      Scalar p,
-                                      Scalar VmLiquid,
-                                      Scalar VmGas)
-    { return fugacity(params, T, p, VmLiquid) - fugacity(params, T, p, VmGas); }
+    static const Tabulated1DFunction<Scalar>& vaporPressureTable_(const Params &params)
+    {
+        static const Tabulated1DFunction<Scalar> table = createVaporPressureTable_(params);
+        return table;
+    }
 
-/*
-    static UniformTabulated2DFunction<Scalar> criticalTemperature_;
-    static UniformTabulated2DFunction<Scalar> criticalPressure_;
-    static UniformTabulated2DFunction<Scalar> criticalMolarVolume_;
-*/
+    template <class Params>
+    static Tabulated1DFunction<Scalar> createVaporPressureTable_(const Params &params)
+    {
+        typedef typename Params::Component Component;
+
+        Scalar Tc = Component::criticalTemperature();
+        Scalar TMin = vaporPressureTableMinReducedTemperature_()*Tc;
+        int n = vaporPressureTableSamples_();
+
+        // the last sampling point is the critical point, where the vapor pressure
+        // of the equation of state is the critical pressure
+        std::vector<Scalar> invT(n);
+        std::vector<Scalar> logPVap(n);
+        for (int i = 0; i < n - 1; ++i) {
+            Scalar T = TMin + (Tc - TMin)*i/(n - 1);
+            invT[i] = 1/T;
+            logPVap[i] = std::log(computeVaporPressure(params, T));
+        }
+        invT[n - 1] = 1/Tc;
+        logPVap[n - 1] = std::log(Component::criticalPressure());
+
+        return Tabulated1DFunction<Scalar>(invT, logPVap, /*sortInputs=*/true);
+    }
+
+    // the reduced temperature of the first sampling point of the vapor pressure
+    // tables and their number of sampling points
+    static Scalar vaporPressureTableMinReducedTemperature_()
+    { return 0.3; }
+    static int vaporPressureTableSamples_()
+    { return 200; }
+
+    static Scalar critAMin_;
+    static Scalar critAMax_;
+    static Scalar critBMin_;
+    static Scalar critBMax_;
+    static int critNa_;
+    static int critNb_;
+    static Scalar critAdaptiveTolerance_;
+    static int numTilesA_;
+    static int numTilesB_;
+    static std::atomic<std::atomic<const CriticalTile_*>*> tiles_;
 };
 
 template <class Scalar>
 const Scalar PengRobinson<Scalar>::R = Opm::Constants<Scalar>::R;
 
-/*
 template <class Scalar>
-UniformTabulated2DFunction<Scalar> PengRobinson<Scalar>::criticalTemperature_;
+Scalar PengRobinson<Scalar>::critAMin_;
 
 template <class Scalar>
-UniformTabulated2DFunction<Scalar> PengRobinson<Scalar>::criticalPressure_;
+Scalar PengRobinson<Scalar>::critAMax_;
 
 template <class Scalar>
-UniformTabulated2DFunction<Scalar> PengRobinson<Scalar>::criticalMolarVolume_;
-*/
+Scalar PengRobinson<Scalar>::critBMin_;
+
+template <class Scalar>
+Scalar PengRobinson<Scalar>::critBMax_;
+
+template <class Scalar>
+int PengRobinson<Scalar>::critNa_;
+
+template <class Scalar>
+int PengRobinson<Scalar>::critNb_;
+
+template <class Scalar>
+Scalar PengRobinson<Scalar>::critAdaptiveTolerance_;
+
+template <class Scalar>
+int PengRobinson<Scalar>::numTilesA_;
+
+template <class Scalar>
+int PengRobinson<Scalar>::numTilesB_;
+
+template <class Scalar>
+std::atomic<std::atomic<const typename PengRobinson<Scalar>::CriticalTile_*>*>
+PengRobinson<Scalar>::tiles_(nullptr);
 
 } // namespace Opm
 
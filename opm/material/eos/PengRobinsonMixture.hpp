@@ -124,6 +124,78 @@ public:
         };
         deltai *= tmp;
 
+        return fugacityCoefficient_(bi_b, deltai, Z, Astar, Bstar);
+    }
+
+    /*!
+     * \brief Computes the fugacity coefficients of all components in the phase.
+     *
+     * This yields the same results as calling computeFugacityCoefficient() for each
+     * component, but the quantities which only depend on the phase (compressibility
+     * factor, the normalized mole fractions, the square roots of the pure component
+     * attractive parameters, etc.) are only calculated once.
+     *
+     * \param fs The fluid state
+     * \param params The parameters of the phase's equation of state
+     * \param phaseIdx The index of the phase
+     * \param fugCoeffs The array of size numComponents which receives the results
+     */
+    template <class FluidState, class Params>
+    static void computeFugacityCoefficients(const FluidState &fs,
+                                            const Params &params,
+                                            int phaseIdx,
+                                            Scalar *fugCoeffs)
+    {
+        Scalar Vm = params.molarVolume(phaseIdx);
+        Scalar b = params.b(phaseIdx);
+        Scalar a = params.a(phaseIdx);
+
+        Scalar RT = R*fs.temperature(phaseIdx);
+        Scalar p = fs.pressure(phaseIdx);
+        Scalar Z = p*Vm/RT;
+
+        Scalar Astar = a*p/(RT*RT);
+        Scalar Bstar = b*p/(RT);
+
+        Scalar sumMoleFractions = 0.0;
+        for (int compJIdx = 0; compJIdx < numComponents; ++compJIdx)
+            sumMoleFractions += fs.moleFraction(phaseIdx, compJIdx);
+
+        // x_j/sum(x)*sqrt(a_j) and sqrt(a_j) are the same for all components i
+        Scalar sqrtAPure[numComponents];
+        Scalar xSqrtAPure[numComponents];
+        for (int compJIdx = 0; compJIdx < numComponents; ++compJIdx) {
+            sqrtAPure[compJIdx] = std::sqrt(params.aPure(phaseIdx, compJIdx));
+            xSqrtAPure[compJIdx] =
+                fs.moleFraction(phaseIdx, compJIdx)
+                / sumMoleFractions
+                * sqrtAPure[compJIdx];
+        }
+
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            Scalar bi_b = params.bPure(phaseIdx, compIdx) / b;
+
+            Scalar deltai = 2*sqrtAPure[compIdx]/a;
+            Scalar tmp = 0;
+            for (int compJIdx = 0; compJIdx < numComponents; ++compJIdx)
+                tmp +=
+                    xSqrtAPure[compJIdx]
+                    * (1.0 - StaticParameters::interactionCoefficient(compIdx, compJIdx));
+            deltai *= tmp;
+
+            fugCoeffs[compIdx] = fugacityCoefficient_(bi_b, deltai, Z, Astar, Bstar);
+        }
+    }
+
+private:
+    // evaluates the fugacity coefficient of a component given the quantities of the
+    // mixture and the component specific quantities b_i/b and delta_i
+    static Scalar fugacityCoefficient_(Scalar bi_b,
+                                       Scalar deltai,
+                                       Scalar Z,
+                                       Scalar Astar,
+                                       Scalar Bstar)
+    {
         Scalar base =
             (2*Z + Bstar*(u + std::sqrt(u*u - 4*w))) /
             (2*Z + Bstar*(u - std::sqrt(u*u - 4*w)));
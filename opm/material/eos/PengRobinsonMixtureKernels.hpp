@@ -0,0 +1,300 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::PengRobinsonMixtureKernels
+ */
+#ifndef OPM_PENG_ROBINSON_MIXTURE_KERNELS_HPP
+#define OPM_PENG_ROBINSON_MIXTURE_KERNELS_HPP
+
+#include <opm/material/common/HostDevice.hpp>
+#include <opm/material/Constants.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+namespace Opm {
+
+/*!
+ * \brief The component data which is required to evaluate the Peng-Robinson equation
+ *        of state of a mixture.
+ *
+ * This is a plain value type without any pointers. It is created once on the host
+ * (cf. PengRobinsonMixtureKernels::createData()) and can then be copied to the memory
+ * of an accelerator, where it is shared by all threads of the kernels.
+ */
+template <class Scalar, int numComponents>
+struct PengRobinsonMixtureData
+{
+    Scalar criticalTemperature[numComponents];
+    Scalar criticalPressure[numComponents];
+    Scalar acentricFactor[numComponents];
+
+    //! The binary interaction coefficient of components i and j is stored at
+    //! i*numComponents + j
+    Scalar interactionCoefficient[numComponents*numComponents];
+
+    //! The ideal gas constant
+    Scalar R;
+
+    //! Use the relation of the SPE-5 problem for the temperature dependence of the
+    //! attractive parameter (cf. PengRobinsonParamsMixture)
+    int useSpe5Relations;
+};
+
+/*!
+ * \brief Evaluates the Peng-Robinson equation of state of a mixture for individual
+ *        fluid states in kernels which run on the host or on an accelerator.
+ *
+ * The methods of this class correspond to PengRobinsonParamsMixture and
+ * PengRobinsonMixture, but they neither depend on the fluid system nor on fluid
+ * state objects, they do not allocate memory and they do not throw exceptions. All
+ * per-state quantities are passed as arrays with an arbitrary stride, so that a
+ * thread of a kernel can work on its entry of a structure-of-arrays batch. If the
+ * state cannot be evaluated (e.g., because the co-volume is not positive), this is
+ * reported by the return value.
+ *
+ * The molar volume is the smallest (for the liquid phase) or the largest (for the
+ * gas phase) root of the cubic equation of state. Contrary to PengRobinson, no
+ * fictitious volume is extrapolated if the cubic only has a single real root, i.e.,
+ * the results only agree with the ones of PengRobinsonMixture if the cubic has three
+ * real roots or if the single root belongs to the requested phase.
+ */
+template <class Scalar, int numComponents>
+class PengRobinsonMixtureKernels
+{
+public:
+    typedef PengRobinsonMixtureData<Scalar, numComponents> Data;
+
+    static_assert(std::is_trivially_copyable<Data>::value,
+                  "The component data must be trivially copyable");
+
+    /*!
+     * \brief Gather the component data from a fluid system.
+     *
+     * The fluid system must provide the critical temperatures, the critical pressures,
+     * the acentric factors and the binary interaction coefficients of its components.
+     * This method is only available on the host.
+     */
+    template <class FluidSystem>
+    static Data createData(bool useSpe5Relations)
+    {
+        static_assert(FluidSystem::numComponents == numComponents,
+                      "The number of components of the fluid system does not match");
+
+        Data data;
+        for (int i = 0; i < numComponents; ++i) {
+            data.criticalTemperature[i] = FluidSystem::criticalTemperature(i);
+            data.criticalPressure[i] = FluidSystem::criticalPressure(i);
+            data.acentricFactor[i] = FluidSystem::acentricFactor(i);
+            for (int j = 0; j < numComponents; ++j)
+                data.interactionCoefficient[i*numComponents + j] =
+                    FluidSystem::interactionCoefficient(i, j);
+        }
+        data.R = Opm::Constants<Scalar>::R;
+        data.useSpe5Relations = useSpe5Relations;
+        return data;
+    }
+
+    /*!
+     * \brief Compute the square roots of the attractive parameters and the co-volumes
+     *        of the pure components at a given temperature.
+     *
+     * See: R. Reid, et al.: The Properties of Gases and Liquids, 4th edition,
+     * McGraw-Hill, 1987, p. 43
+     */
+    OPM_HOST_DEVICE static void computePureParams(Scalar* sqrtA,
+                                                  Scalar* b,
+                                                  const Data& data,
+                                                  Scalar temperature)
+    {
+        for (int i = 0; i < numComponents; ++i) {
+            Scalar pc = data.criticalPressure[i];
+            Scalar omega = data.acentricFactor[i];
+            Scalar Tr = temperature/data.criticalTemperature[i];
+            Scalar RTc = data.R*data.criticalTemperature[i];
+
+            Scalar fOmega;
+            if (data.useSpe5Relations && !(omega < 0.49))
+                fOmega = 0.379642 + omega*(1.48503 + omega*(-0.164423 + omega*0.016666));
+            else
+                fOmega = 0.37464 + omega*(1.54226 - omega*0.26992);
+
+            // a = 0.4572355*RTc^2/pc*(1 + fOmega*(1 - sqrt(Tr)))^2
+            sqrtA[i] = std::sqrt(0.4572355/pc)*RTc*std::abs(1 + fOmega*(1 - std::sqrt(Tr)));
+            b[i] = 0.0777961*RTc/pc;
+        }
+    }
+
+    /*!
+     * \brief Compute the fugacity coefficients of all components of a phase.
+     *
+     * \param fugCoeffs The array which receives the fugacity coefficients. The
+     *                  coefficient of component i is stored at i*stride.
+     * \param Z Receives the compressibility factor of the phase
+     * \param data The component data
+     * \param sqrtA The square roots of the attractive parameters of the pure
+     *              components, cf. computePureParams()
+     * \param b The co-volumes of the pure components
+     * \param temperature The temperature of the phase
+     * \param pressure The pressure of the phase
+     * \param x The mole fractions of the phase. The mole fraction of component i is
+     *          read from i*stride. They do not need to sum up to one.
+     * \param stride The distance of the entries of x and fugCoeffs
+     * \param isGasPhase Specifies whether the largest or the smallest root of the
+     *                   cubic equation is used
+     *
+     * \return false if the phase cannot be evaluated
+     */
+    OPM_HOST_DEVICE static bool computeFugacityCoefficients(Scalar* fugCoeffs,
+                                                            Scalar& Z,
+                                                            const Data& data,
+                                                            const Scalar* sqrtA,
+                                                            const Scalar* b,
+                                                            Scalar temperature,
+                                                            Scalar pressure,
+                                                            const Scalar* x,
+                                                            size_t stride,
+                                                            bool isGasPhase)
+    {
+        // the mixing rules use the mole fractions clamped to [0, 1], the terms
+        // delta_i use the normalized ones (cf. PengRobinsonParamsMixture and
+        // PengRobinsonMixture)
+        Scalar sumX = 0.0;
+        Scalar aMix = 0.0;
+        Scalar bMix = 0.0;
+        Scalar xSqrtA[numComponents];
+        for (int j = 0; j < numComponents; ++j) {
+            sumX += x[j*stride];
+            xSqrtA[j] = x[j*stride]*sqrtA[j];
+        }
+        for (int i = 0; i < numComponents; ++i) {
+            Scalar xi = clamp_(x[i*stride]);
+            Scalar tmp = 0.0;
+            for (int j = 0; j < numComponents; ++j)
+                tmp += sqrtA[j]*clamp_(x[j*stride])*(1 - data.interactionCoefficient[i*numComponents + j]);
+            aMix += xi*sqrtA[i]*tmp;
+            bMix += xi*b[i];
+        }
+        if (!(aMix > 0.0) || !(bMix > 0.0) || !(sumX > 0.0))
+            return false;
+
+        Scalar RT = data.R*temperature;
+        Scalar Astar = aMix*pressure/(RT*RT);
+        Scalar Bstar = bMix*pressure/RT;
+
+        // the cubic equation of the compressibility factor
+        Scalar roots[3];
+        int numRoots = solveCubic(roots,
+                                  /*a2=*/-(1 - Bstar),
+                                  /*a1=*/Astar - Bstar*(3*Bstar + 2),
+                                  /*a0=*/Bstar*(-Astar + Bstar*(1 + Bstar)));
+        Z = (numRoots == 3 && !isGasPhase) ? roots[0] : roots[2];
+        if (!(Z > 0.0))
+            return false;
+
+        const Scalar sqrt2 = std::sqrt(Scalar(2.0));
+        Scalar base = (Z + Bstar*(1 + sqrt2))/(Z + Bstar*(1 - sqrt2));
+        Scalar logBase = std::log(base);
+        Scalar ZmB = (Z - Bstar > 1e-9) ? Z - Bstar : Scalar(1e-9);
+        for (int i = 0; i < numComponents; ++i) {
+            Scalar bi_b = b[i]/bMix;
+
+            Scalar tmp = 0.0;
+            for (int j = 0; j < numComponents; ++j)
+                tmp += xSqrtA[j]*(1 - data.interactionCoefficient[i*numComponents + j]);
+            Scalar deltai = 2*sqrtA[i]/aMix*tmp/sumX;
+
+            Scalar expo = Astar/(Bstar*2*sqrt2)*(bi_b - deltai);
+            Scalar fugCoeff = std::exp(bi_b*(Z - 1) + expo*logBase)/ZmB;
+
+            // limit the fugacity coefficients like PengRobinsonMixture
+            fugCoeff = (fugCoeff < 1e10) ? fugCoeff : Scalar(1e10);
+            fugCoeff = (fugCoeff > 1e-10) ? fugCoeff : Scalar(1e-10);
+            fugCoeffs[i*stride] = fugCoeff;
+        }
+
+        return true;
+    }
+
+    /*!
+     * \brief Compute the real roots of a monic cubic polynomial.
+     *
+     * The polynomial is \f$z^3 + a_2 z^2 + a_1 z + a_0\f$. The roots are written to
+     * the array in ascending order; if the polynomial only has a single real root, all
+     * three entries are set to it. This uses the same method as
+     * invertCubicPolynomialBatch(), i.e., each root is polished by one Newton
+     * iteration.
+     *
+     * \return The number of distinct real roots, i.e., 1 or 3
+     */
+    OPM_HOST_DEVICE static int solveCubic(Scalar* roots, Scalar a2, Scalar a1, Scalar a0)
+    {
+        // substitute z = t - a2/3, which yields t^3 + p*t + q = 0
+        Scalar p = a1 - a2*a2/3;
+        Scalar q = a0 + (2*a2*a2*a2 - 9*a2*a1)/27;
+        Scalar wDisc = q*q/4 + p*p*p/27;
+
+        int numRoots;
+        if (wDisc >= 0) {
+            // a single real root: Cardano's formula. the sign of the square root is
+            // chosen such that no cancellation occurs.
+            Scalar sqrtDisc = std::sqrt(wDisc);
+            Scalar u = std::cbrt(-q/2 - std::copysign(sqrtDisc, q));
+            Scalar t = (u != 0.0) ? u - p/(3*u) : Scalar(0.0);
+            roots[0] = roots[1] = roots[2] = t - a2/3;
+            numRoots = 1;
+        }
+        else {
+            // three real roots: trigonometric method. p is negative in this case.
+            const Scalar pi = 3.14159265358979323846;
+            Scalar r = 2*std::sqrt(-p/3);
+            Scalar cosArg = 3*q/(p*r);
+            cosArg = (cosArg < -1.0) ? Scalar(-1.0) : ((cosArg > 1.0) ? Scalar(1.0) : cosArg);
+            Scalar theta = std::acos(cosArg)/3;
+
+            roots[0] = r*std::cos(theta + 2*pi/3) - a2/3;
+            roots[1] = r*std::cos(theta - 2*pi/3) - a2/3;
+            roots[2] = r*std::cos(theta) - a2/3;
+            numRoots = 3;
+        }
+
+        for (int j = 0; j < 3; ++j) {
+            Scalar z = roots[j];
+            Scalar fOld = a0 + z*(a1 + z*(a2 + z));
+            Scalar fPrime = a1 + z*(2*a2 + 3*z);
+            Scalar zNew = (fPrime != 0.0) ? z - fOld/fPrime : z;
+            Scalar fNew = a0 + zNew*(a1 + zNew*(a2 + zNew));
+            roots[j] = (std::abs(fNew) < std::abs(fOld)) ? zNew : z;
+        }
+
+        return numRoots;
+    }
+
+private:
+    OPM_HOST_DEVICE static Scalar clamp_(Scalar x)
+    { return (x < 0.0) ? Scalar(0.0) : ((x > 1.0) ? Scalar(1.0) : x); }
+};
+
+} // namespace Opm
+
+#endif
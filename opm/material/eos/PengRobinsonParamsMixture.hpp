@@ -26,6 +26,7 @@
 #define OPM_PENG_ROBINSON_PARAMS_MIXTURE_HPP
 
 #include <algorithm>
+#include <limits>
 #include <opm/material/Constants.hpp>
 
 #include "PengRobinsonParams.hpp"
@@ -49,6 +50,12 @@ namespace Opm
  * J.E. Killough, et al.: Fifth Comparative Solution Project:
  * Evaluation of Miscible Flood Simulators, Ninth SPE Symposium on
  * Reservoir Simulation, 1987
+ *
+ * The parameters of the pure components and the matrix of the mixing rule,
+ * \f$\sqrt{a_i a_j}(1 - k_{ij})\f$, only depend on temperature. They are thus
+ * only recalculated if the temperature changes. For the mixture, the product of
+ * this matrix with the composition is stored, so that the parameters can be
+ * updated in linear time if only a single mole fraction changes.
  */
 template <class Scalar, class FluidSystem, int phaseIdx, bool useSpe5Relations=false>
 class PengRobinsonParamsMixture
@@ -63,6 +70,12 @@ class PengRobinsonParamsMixture
     static const Scalar R;
 
 public:
+    PengRobinsonParamsMixture()
+    {
+        cachedTemperature_ = std::numeric_limits<Scalar>::quiet_NaN();
+        mixUpToDate_ = false;
+    }
+
     /*!
      * \brief Update Peng-Robinson parameters for the pure components.
      */
@@ -83,6 +96,12 @@ public:
         Valgrind::CheckDefined(temperature);
         Valgrind::CheckDefined(pressure);
 
+        // the parameters of the pure components do not depend on pressure
+        if (temperature == cachedTemperature_)
+            return;
+        cachedTemperature_ = temperature;
+        mixUpToDate_ = false;
+
         // Calculate the Peng-Robinson parameters of the pure
         // components
         //
@@ -132,43 +151,24 @@ public:
     template <class FluidState>
     void updateMix(const FluidState &fs)
     {
-        Scalar sumx = 0.0;
-        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
-            sumx += fs.moleFraction(phaseIdx, compIdx);
-        sumx = std::max(1e-10, sumx);
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            x_[compIdx] = std::max(0.0, std::min(1.0, fs.moleFraction(phaseIdx, compIdx)));
+            Valgrind::CheckDefined(x_[compIdx]);
+        }
 
         // Calculate the Peng-Robinson parameters of the mixture
         //
         // See: R. Reid, et al.: The Properties of Gases and Liquids,
         // 4th edition, McGraw-Hill, 1987, p. 82
-        Scalar a = 0;
-        Scalar b = 0;
         for (int compIIdx = 0; compIIdx < numComponents; ++compIIdx) {
-            Scalar xi = std::max(0.0, std::min(1.0, fs.moleFraction(phaseIdx, compIIdx)));
-            Valgrind::CheckDefined(xi);
-
-            for (int compJIdx = 0; compJIdx < numComponents; ++compJIdx) {
-                Scalar xj = std::max(0.0, std::min(1.0, fs.moleFraction(phaseIdx, compJIdx)));
-                Valgrind::CheckDefined(xj);
-
-                // mixing rule from Reid, page 82
-                a +=  xi * xj * aCache_[compIIdx][compJIdx];
-
-                assert(std::isfinite(a));
-            }
-
-            // mixing rule from Reid, page 82
-            b += std::max(0.0, xi) * this->pureParams_[compIIdx].b();
-            assert(std::isfinite(b));
+            Scalar tmp = 0;
+            for (int compJIdx = 0; compJIdx < numComponents; ++compJIdx)
+                tmp += aCache_[compIIdx][compJIdx] * x_[compJIdx];
+            aTimesX_[compIIdx] = tmp;
         }
+        mixUpToDate_ = true;
 
-        // assert(b > 0);
-        this->setA(a);
-        this->setB(b);
-
-        Valgrind::CheckDefined(this->a());
-        Valgrind::CheckDefined(this->b());
-
+        updateMixFromCache_();
     }
 
     /*!
@@ -183,7 +183,21 @@ public:
     void updateSingleMoleFraction(const FluidState &fs,
                                   int compIdx)
     {
-        updateMix(fs);
+        if (!mixUpToDate_) {
+            updateMix(fs);
+            return;
+        }
+
+        // only the column of the mixing matrix which corresponds to the
+        // component is affected
+        Scalar xNew = std::max(0.0, std::min(1.0, fs.moleFraction(phaseIdx, compIdx)));
+        Valgrind::CheckDefined(xNew);
+        Scalar deltaX = xNew - x_[compIdx];
+        x_[compIdx] = xNew;
+        for (int compIIdx = 0; compIIdx < numComponents; ++compIIdx)
+            aTimesX_[compIIdx] += aCache_[compIIdx][compIdx] * deltaX;
+
+        updateMixFromCache_();
     }
 
     /*!
@@ -220,22 +234,59 @@ protected:
     PureParams pureParams_[numComponents];
 
 private:
+    // calculate the parameters of the mixture from the stored composition and the
+    // product of the mixing matrix with the composition
+    void updateMixFromCache_()
+    {
+        Scalar a = 0;
+        Scalar b = 0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            // mixing rule from Reid, page 82
+            a += x_[compIdx] * aTimesX_[compIdx];
+            b += x_[compIdx] * this->pureParams_[compIdx].b();
+        }
+        assert(std::isfinite(a));
+        assert(std::isfinite(b));
+
+        // assert(b > 0);
+        this->setA(a);
+        this->setB(b);
+
+        Valgrind::CheckDefined(this->a());
+        Valgrind::CheckDefined(this->b());
+    }
+
     void updateACache_()
     {
+        // sqrt(a_i*a_j) = sqrt(a_i)*sqrt(a_j), i.e., only one square root per
+        // component is required. since the mixing matrix is symmetric, only its lower
+        // triangle needs to be computed.
+        Scalar sqrtA[numComponents];
+        for (int compIdx = 0; compIdx < numComponents; ++ compIdx)
+            sqrtA[compIdx] = std::sqrt(this->pureParams_[compIdx].a());
+
         for (int compIIdx = 0; compIIdx < numComponents; ++ compIIdx) {
-            for (int compJIdx = 0; compJIdx < numComponents; ++ compJIdx) {
+            for (int compJIdx = 0; compJIdx <= compIIdx; ++ compJIdx) {
                 // interaction coefficient as given in SPE5
                 Scalar Psi = FluidSystem::interactionCoefficient(compIIdx, compJIdx);
 
-                aCache_[compIIdx][compJIdx] =
-                    std::sqrt(this->pureParams_[compIIdx].a()
-                              * this->pureParams_[compJIdx].a())
-                    * (1 - Psi);
+                Scalar aIJ = sqrtA[compIIdx]*sqrtA[compJIdx]*(1 - Psi);
+                aCache_[compIIdx][compJIdx] = aIJ;
+                aCache_[compJIdx][compIIdx] = aIJ;
             }
         }
     }
 
     Scalar aCache_[numComponents][numComponents];
+
+    // the temperature for which the parameters of the pure components are valid
+    Scalar cachedTemperature_;
+
+    // the (clamped) composition used for the mixture parameters and the product of
+    // the mixing matrix with it
+    Scalar x_[numComponents];
+    Scalar aTimesX_[numComponents];
+    bool mixUpToDate_;
 };
 
 template <class Scalar, class FluidSystem, int phaseIdx, bool useSpe5Relations>
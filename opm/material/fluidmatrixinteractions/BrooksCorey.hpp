@@ -30,6 +30,7 @@
 #include "BrooksCoreyParams.hpp"
 
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/SimdPack.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
 #include <opm/material/common/Exceptions.hpp>
 
@@ -88,6 +89,14 @@ public:
     //! are dependent on the phase composition
     static const bool isCompositionDependent = false;
 
+    //! The relative permeability of each phase only depends on its own saturation
+    static constexpr unsigned relativePermeabilityDependencies(int phaseIdx)
+    { return 1u << phaseIdx; }
+
+    //! The capillary pressure only depends on the saturation of the wetting phase
+    static constexpr unsigned capillaryPressureDependencies(int phaseIdx)
+    { return (phaseIdx == Traits::nonWettingPhaseIdx) ? (1u << Traits::wettingPhaseIdx) : 0u; }
+
     static_assert(Traits::numPhases == 2,
                   "The number of fluid phases must be two if you want to use "
                   "this material law!");
@@ -157,7 +166,7 @@ public:
         const Evaluation& Sw =
             FsToolbox::template toLhs<Evaluation>(fs.saturation(Traits::wettingPhaseIdx));
 
-        assert(0 <= Sw && Sw <= 1);
+        assert(allTrue(0 <= Sw && Sw <= 1));
 
         return twoPhaseSatPcnw(params, Sw);
     }
@@ -167,9 +176,9 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        assert(0 <= Sw && Sw <= 1);
+        assert(allTrue(0 <= Sw && Sw <= 1));
 
-        return params.entryPressure()*Toolbox::pow(Sw, -1/params.lambda());
+        return params.entryPressure()*Toolbox::pow(Sw, params.pcnwExponent());
     }
 
     template <class Evaluation>
@@ -177,7 +186,7 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        assert(pcnw > 0.0);
+        assert(allTrue(pcnw > 0.0));
 
         return Toolbox::pow(params.entryPressure()/pcnw, -params.lambda());
     }
@@ -210,7 +219,7 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        assert(pc > 0); // if we don't assume that, std::pow will screw up!
+        assert(allTrue(pc > 0)); // if we don't assume that, std::pow will screw up!
 
         return Toolbox::pow(pc/params.entryPressure(), -params.lambda());
     }
@@ -250,9 +259,9 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        assert(0 <= Sw && Sw <= 1);
+        assert(allTrue(0 <= Sw && Sw <= 1));
 
-        return Toolbox::pow(Sw, 2.0/params.lambda() + 3);
+        return Toolbox::pow(Sw, params.krwExponent());
     }
 
     template <class Evaluation>
@@ -260,7 +269,7 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        return Toolbox::pow(krw, 1.0/(2.0/params.lambda() + 3));
+        return Toolbox::pow(krw, 1.0/params.krwExponent());
     }
 
     /*!
@@ -287,11 +296,10 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        assert(0 <= Sw && Sw <= 1);
+        assert(allTrue(0 <= Sw && Sw <= 1));
 
-        Scalar exponent = 2.0/params.lambda() + 1;
         const Evaluation Sn = 1. - Sw;
-        return Sn*Sn*(1. - Toolbox::pow(Sw, exponent));
+        return Sn*Sn*(1. - Toolbox::pow(Sw, params.krnExponent()));
     }
 
     template <class Evaluation>
@@ -68,6 +68,10 @@ public:
      */
     void finalize()
     {
+        pcnwExponent_ = -1/lambda_;
+        krwExponent_ = 2/lambda_ + 3;
+        krnExponent_ = 2/lambda_ + 1;
+
 #ifndef NDEBUG
         finalized_ = true;
 #endif
@@ -98,6 +102,26 @@ public:
     void setLambda(Scalar v)
     { lambda_ = v; }
 
+    /*!
+     * \brief Returns the exponent of the capillary pressure curve, \f$-1/\lambda\f$
+     */
+    Scalar pcnwExponent() const
+    { assertFinalized_(); return pcnwExponent_; }
+
+    /*!
+     * \brief Returns the exponent of the wetting phase relative permeability,
+     *        \f$2/\lambda + 3\f$
+     */
+    Scalar krwExponent() const
+    { assertFinalized_(); return krwExponent_; }
+
+    /*!
+     * \brief Returns the exponent in the non-wetting phase relative permeability,
+     *        \f$2/\lambda + 1\f$
+     */
+    Scalar krnExponent() const
+    { assertFinalized_(); return krnExponent_; }
+
 private:
 #ifndef NDEBUG
     void assertFinalized_() const
@@ -111,6 +135,11 @@ private:
 
     Scalar entryPressure_;
     Scalar lambda_;
+
+    // exponents which only depend on lambda. these are calculated by finalize()
+    Scalar pcnwExponent_;
+    Scalar krwExponent_;
+    Scalar krnExponent_;
 };
 } // namespace Opm
 
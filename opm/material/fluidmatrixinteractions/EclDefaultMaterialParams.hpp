@@ -25,6 +25,8 @@
 #ifndef OPM_ECL_DEFAULT_MATERIAL_PARAMS_HPP
 #define OPM_ECL_DEFAULT_MATERIAL_PARAMS_HPP
 
+#include <opm/material/common/UniformTabulated2DFunction.hpp>
+
 #include <type_traits>
 #include <cassert>
 #include <memory>
@@ -47,6 +49,7 @@ class EclDefaultMaterialParams
 public:
     typedef GasOilParamsT GasOilParams;
     typedef OilWaterParamsT OilWaterParams;
+    typedef Opm::UniformTabulated2DFunction<Scalar> KroTable;
 
     /*!
      * \brief The default constructor.
@@ -136,6 +139,23 @@ public:
     bool inconsistentHysteresisUpdate() const
     { return true; }
 
+    /*!
+     * \brief Set a table of the oil relative permeability.
+     *
+     * The table maps the water and gas saturations to the three-phase oil relative
+     * permeability. If it is set, the material law uses it instead of combining the
+     * two-phase curves for all saturations within the table's range. Passing an
+     * empty pointer removes the table.
+     */
+    void setKroTable(std::shared_ptr<const KroTable> val)
+    { kroTable_ = val; }
+
+    /*!
+     * \brief Returns the table of the oil relative permeability or 0 if none is set.
+     */
+    const KroTable* kroTable() const
+    { return kroTable_.get(); }
+
 private:
 #ifndef NDEBUG
     void assertFinalized_() const
@@ -151,6 +171,8 @@ private:
     std::shared_ptr<OilWaterParams> oilWaterParams_;
 
     Scalar Swl_;
+
+    std::shared_ptr<const KroTable> kroTable_;
 };
 } // namespace Opm
 
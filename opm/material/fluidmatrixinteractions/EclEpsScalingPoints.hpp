@@ -33,6 +33,7 @@
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
 #endif
 
+#include <array>
 #include <string>
 #include <iostream>
 #include <cassert>
@@ -496,6 +497,18 @@ template <class Scalar>
 class EclEpsScalingPoints
 {
 public:
+    EclEpsScalingPoints()
+        : maxPcnw_(0.0)
+        , maxKrw_(0.0)
+        , maxKrn_(0.0)
+    {
+        // make sure that the points which are not used by two-point scaling are
+        // deterministic, so that identical objects can be recognized
+        saturationPcPoints_.fill(0.0);
+        saturationKrwPoints_.fill(0.0);
+        saturationKrnPoints_.fill(0.0);
+    }
+
     /*!
      * \brief Assigns the scaling points which actually ought to be used.
      */
@@ -674,6 +687,248 @@ private:
     std::array<Scalar, 3> saturationKrnPoints_;
 };
 
+/*!
+ * \ingroup FluidMatrixInteractions
+ *
+ * \brief A piecewise linear mapping of saturations which consists of at most two
+ *        segments.
+ *
+ * This is used to convert between the scaled and the unscaled saturations of the
+ * endpoint scaling. Since the coefficients of the segments are computed in advance,
+ * mapping a saturation only requires to select the segment and a multiply-add.
+ */
+template <class Scalar>
+class EclEpsSaturationMapping
+{
+public:
+    EclEpsSaturationMapping()
+    { setIdentity(); }
+
+    /*!
+     * \brief Make the mapping return its argument.
+     */
+    void setIdentity()
+    {
+        breakPoint_ = 0.0;
+        for (unsigned segmentIdx = 0; segmentIdx < 2; ++segmentIdx) {
+            origin_[segmentIdx] = 0.0;
+            image_[segmentIdx] = 0.0;
+            slope_[segmentIdx] = 1.0;
+        }
+    }
+
+    /*!
+     * \brief Linearly map the interval [from[0], from[1]] to [to[0], to[1]].
+     */
+    template <class PointsContainer>
+    void setTwoPoint(const PointsContainer& from, const PointsContainer& to)
+    {
+        breakPoint_ = from[0];
+        for (unsigned segmentIdx = 0; segmentIdx < 2; ++segmentIdx) {
+            origin_[segmentIdx] = from[0];
+            image_[segmentIdx] = to[0];
+            slope_[segmentIdx] = (to[1] - to[0])/(from[1] - from[0]);
+        }
+    }
+
+    /*!
+     * \brief Linearly map the interval [from[0], from[1]] to [to[0], to[1]] and the
+     *        interval [from[1], from[2]] to [to[1], to[2]].
+     */
+    template <class PointsContainer>
+    void setThreePoint(const PointsContainer& from, const PointsContainer& to)
+    {
+        setTwoPoint(from, to);
+
+        breakPoint_ = from[1];
+        origin_[1] = from[1];
+        image_[1] = to[1];
+        slope_[1] = (to[2] - to[1])/(from[2] - from[1]);
+    }
+
+    /*!
+     * \brief Map a saturation.
+     */
+    template <class Evaluation>
+    Evaluation map(const Evaluation& sat) const
+    {
+        unsigned segmentIdx = (sat < breakPoint_) ? 0 : 1;
+        return image_[segmentIdx] + (sat - origin_[segmentIdx])*slope_[segmentIdx];
+    }
+
+private:
+    // the saturation at which the second segment starts
+    Scalar breakPoint_;
+
+    // the first saturation of each segment, its image and the slope of the segment
+    Scalar origin_[2];
+    Scalar image_[2];
+    Scalar slope_[2];
+};
+
+/*!
+ * \ingroup FluidMatrixInteractions
+ *
+ * \brief The coefficients which are required to convert between the unscaled and the
+ *        scaled quantities of the endpoint scaling.
+ *
+ * These depend on the unscaled as well as on the scaled points, so they are computed
+ * once for each combination of the two. Scalings which are disabled by the
+ * configuration are represented by an identity mapping, so that the conversion does not
+ * need to query the configuration.
+ */
+template <class Scalar>
+class EclEpsScalingCoefficients
+{
+public:
+    typedef Opm::EclEpsSaturationMapping<Scalar> SaturationMapping;
+
+    EclEpsScalingCoefficients()
+        : pcnwScalingFactor_(1.0)
+        , krwScalingFactor_(1.0)
+        , krnScalingFactor_(1.0)
+    {}
+
+    /*!
+     * \brief Compute the coefficients for a given set of unscaled and scaled points.
+     */
+    void init(const EclEpsScalingPoints<Scalar>& unscaledPoints,
+              const EclEpsScalingPoints<Scalar>& scaledPoints,
+              const EclEpsConfig& config)
+    {
+        if (config.enableSatScaling()) {
+            // the saturations of capillary pressure are always scaled using two-point
+            // scaling
+            scaledToUnscaledSatPc_.setTwoPoint(scaledPoints.saturationPcPoints(),
+                                               unscaledPoints.saturationPcPoints());
+            unscaledToScaledSatPc_.setTwoPoint(unscaledPoints.saturationPcPoints(),
+                                               scaledPoints.saturationPcPoints());
+
+            bool threePoint = config.enableThreePointKrSatScaling();
+            initKrMappings_(scaledToUnscaledSatKrw_,
+                            unscaledToScaledSatKrw_,
+                            unscaledPoints.saturationKrwPoints(),
+                            scaledPoints.saturationKrwPoints(),
+                            threePoint);
+            initKrMappings_(scaledToUnscaledSatKrn_,
+                            unscaledToScaledSatKrn_,
+                            unscaledPoints.saturationKrnPoints(),
+                            scaledPoints.saturationKrnPoints(),
+                            threePoint);
+        }
+        else {
+            scaledToUnscaledSatPc_.setIdentity();
+            unscaledToScaledSatPc_.setIdentity();
+            scaledToUnscaledSatKrw_.setIdentity();
+            unscaledToScaledSatKrw_.setIdentity();
+            scaledToUnscaledSatKrn_.setIdentity();
+            unscaledToScaledSatKrn_.setIdentity();
+        }
+
+        pcnwScalingFactor_ = 1.0;
+        if (config.enablePcScaling())
+            pcnwScalingFactor_ = scaledPoints.maxPcnw()/unscaledPoints.maxPcnw();
+
+        // TODO: three point kr y-scaling
+        krwScalingFactor_ = 1.0;
+        if (config.enableKrwScaling())
+            krwScalingFactor_ = scaledPoints.maxKrw()/unscaledPoints.maxKrw();
+
+        krnScalingFactor_ = 1.0;
+        if (config.enableKrnScaling())
+            krnScalingFactor_ = scaledPoints.maxKrn()/unscaledPoints.maxKrn();
+    }
+
+    /*!
+     * \brief Maps the scaled saturations of capillary pressure to the unscaled ones.
+     */
+    const SaturationMapping& scaledToUnscaledSatPc() const
+    { return scaledToUnscaledSatPc_; }
+
+    /*!
+     * \brief Maps the unscaled saturations of capillary pressure to the scaled ones.
+     */
+    const SaturationMapping& unscaledToScaledSatPc() const
+    { return unscaledToScaledSatPc_; }
+
+    /*!
+     * \brief Maps the scaled saturations of the wetting phase relperm to the unscaled
+     *        ones.
+     */
+    const SaturationMapping& scaledToUnscaledSatKrw() const
+    { return scaledToUnscaledSatKrw_; }
+
+    /*!
+     * \brief Maps the unscaled saturations of the wetting phase relperm to the scaled
+     *        ones.
+     */
+    const SaturationMapping& unscaledToScaledSatKrw() const
+    { return unscaledToScaledSatKrw_; }
+
+    /*!
+     * \brief Maps the scaled saturations of the non-wetting phase relperm to the
+     *        unscaled ones.
+     */
+    const SaturationMapping& scaledToUnscaledSatKrn() const
+    { return scaledToUnscaledSatKrn_; }
+
+    /*!
+     * \brief Maps the unscaled saturations of the non-wetting phase relperm to the
+     *        scaled ones.
+     */
+    const SaturationMapping& unscaledToScaledSatKrn() const
+    { return unscaledToScaledSatKrn_; }
+
+    /*!
+     * \brief The factor by which the unscaled capillary pressure is multiplied.
+     */
+    Scalar pcnwScalingFactor() const
+    { return pcnwScalingFactor_; }
+
+    /*!
+     * \brief The factor by which the unscaled wetting phase relperm is multiplied.
+     */
+    Scalar krwScalingFactor() const
+    { return krwScalingFactor_; }
+
+    /*!
+     * \brief The factor by which the unscaled non-wetting phase relperm is multiplied.
+     */
+    Scalar krnScalingFactor() const
+    { return krnScalingFactor_; }
+
+private:
+    template <class PointsContainer>
+    static void initKrMappings_(SaturationMapping& scaledToUnscaled,
+                                SaturationMapping& unscaledToScaled,
+                                const PointsContainer& unscaledSats,
+                                const PointsContainer& scaledSats,
+                                bool threePoint)
+    {
+        // three-point scaling falls back to two-point scaling if the unscaled points
+        // are not strictly ordered
+        if (!threePoint || unscaledSats[1] >= unscaledSats[2]) {
+            scaledToUnscaled.setTwoPoint(scaledSats, unscaledSats);
+            unscaledToScaled.setTwoPoint(unscaledSats, scaledSats);
+        }
+        else {
+            scaledToUnscaled.setThreePoint(scaledSats, unscaledSats);
+            unscaledToScaled.setThreePoint(unscaledSats, scaledSats);
+        }
+    }
+
+    SaturationMapping scaledToUnscaledSatPc_;
+    SaturationMapping unscaledToScaledSatPc_;
+    SaturationMapping scaledToUnscaledSatKrw_;
+    SaturationMapping unscaledToScaledSatKrw_;
+    SaturationMapping scaledToUnscaledSatKrn_;
+    SaturationMapping unscaledToScaledSatKrn_;
+
+    Scalar pcnwScalingFactor_;
+    Scalar krwScalingFactor_;
+    Scalar krnScalingFactor_;
+};
+
 } // namespace Opm
 
 #endif
@@ -31,6 +31,8 @@
 #include <opm/material/common/ErrorMacros.hpp>
 #include <opm/material/common/Exceptions.hpp>
 
+#include <algorithm>
+
 namespace Opm {
 /*!
  * \ingroup FluidMatrixInteractions
@@ -158,6 +160,9 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnw(const Params &params, const Evaluation& SwScaled)
     {
+        if (const auto* directCurves = params.directCurves())
+            return EffLaw::twoPhaseSatPcnw(*directCurves, SwScaled);
+
         const Evaluation& SwUnscaled = scaledToUnscaledSatPc(params, SwScaled);
         const Evaluation& pcUnscaled = EffLaw::twoPhaseSatPcnw(params.effectiveLawParams(), SwUnscaled);
         return unscaledToScaledPcnw_(params, pcUnscaled);
@@ -166,11 +171,49 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnwInv(const Params &params, const Evaluation& pcnwScaled)
     {
+        if (const auto* directCurves = params.directCurves())
+            return EffLaw::twoPhaseSatPcnwInv(*directCurves, pcnwScaled);
+
         Evaluation pcnwUnscaled = scaledToUnscaledPcnw_(params, pcnwScaled);
         Evaluation SwUnscaled = EffLaw::twoPhaseSatPcnwInv(params.effectiveLawParams(), pcnwUnscaled);
         return unscaledToScaledSatPc(params, SwUnscaled);
     }
 
+    /*!
+     * \brief The scaled wetting phase saturations for a batch of scaled capillary
+     *        pressures.
+     *
+     * This is equivalent to calling twoPhaseSatPcnwInv() for each entry of the pcnw
+     * array. The inversion of the unscaled curve is done by the batched method of the
+     * nested material law.
+     */
+    static void twoPhaseSatPcnwInvBatch(const Params &params,
+                                        const Scalar* pcnwScaled,
+                                        Scalar* SwScaled,
+                                        size_t n)
+    {
+        if (const auto* directCurves = params.directCurves()) {
+            EffLaw::twoPhaseSatPcnwInvBatch(*directCurves, pcnwScaled, SwScaled, n);
+            return;
+        }
+
+        const auto& SwMapping = params.scalingCoefficients().unscaledToScaledSatPc();
+        for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += batchChunkSize_) {
+            size_t chunkSize = std::min<size_t>(batchChunkSize_, n - chunkBegin);
+
+            Scalar pcnwUnscaled[batchChunkSize_];
+            for (size_t i = 0; i < chunkSize; ++i)
+                pcnwUnscaled[i] = scaledToUnscaledPcnw_(params, pcnwScaled[chunkBegin + i]);
+
+            EffLaw::twoPhaseSatPcnwInvBatch(params.effectiveLawParams(),
+                                            pcnwUnscaled,
+                                            SwScaled + chunkBegin,
+                                            chunkSize);
+            for (size_t i = 0; i < chunkSize; ++i)
+                SwScaled[chunkBegin + i] = SwMapping.map(SwScaled[chunkBegin + i]);
+        }
+    }
+
     /*!
      * \brief The saturation-capillary pressure curves.
      */
@@ -249,6 +292,9 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrw(const Params &params, const Evaluation& SwScaled)
     {
+        if (const auto* directCurves = params.directCurves())
+            return EffLaw::twoPhaseSatKrw(*directCurves, SwScaled);
+
         const Evaluation& SwUnscaled = scaledToUnscaledSatKrw(params, SwScaled);
         const Evaluation& krwUnscaled = EffLaw::twoPhaseSatKrw(params.effectiveLawParams(), SwUnscaled);
         return unscaledToScaledKrw_(params, krwUnscaled);
@@ -277,6 +323,9 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrn(const Params &params, const Evaluation& SwScaled)
     {
+        if (const auto* directCurves = params.directCurves())
+            return EffLaw::twoPhaseSatKrn(*directCurves, SwScaled);
+
         const Evaluation& SwUnscaled = scaledToUnscaledSatKrn(params, SwScaled);
         const Evaluation& krnUnscaled = EffLaw::twoPhaseSatKrn(params.effectiveLawParams(), SwUnscaled);
         return unscaledToScaledKrn_(params, krnUnscaled);
@@ -297,29 +346,11 @@ public:
      */
     template <class Evaluation>
     static Evaluation scaledToUnscaledSatPc(const Params &params, const Evaluation& SwScaled)
-    {
-        if (!params.config().enableSatScaling())
-            return SwScaled;
-
-        // the saturations of capillary pressure are always scaled using two-point
-        // scaling
-        return scaledToUnscaledSatTwoPoint_(SwScaled,
-                                            params.unscaledPoints().saturationPcPoints(),
-                                            params.scaledPoints().saturationPcPoints());
-    }
+    { return params.scalingCoefficients().scaledToUnscaledSatPc().map(SwScaled); }
 
     template <class Evaluation>
     static Evaluation unscaledToScaledSatPc(const Params &params, const Evaluation& SwUnscaled)
-    {
-        if (!params.config().enableSatScaling())
-            return SwUnscaled;
-
-        // the saturations of capillary pressure are always scaled using two-point
-        // scaling
-        return unscaledToScaledSatTwoPoint_(SwUnscaled,
-                                            params.unscaledPoints().saturationPcPoints(),
-                                            params.scaledPoints().saturationPcPoints());
-    }
+    { return params.scalingCoefficients().unscaledToScaledSatPc().map(SwUnscaled); }
 
     /*!
      * \brief Convert an absolute saturation to an effective one for the scaling of the
@@ -327,39 +358,11 @@ public:
      */
     template <class Evaluation>
     static Evaluation scaledToUnscaledSatKrw(const Params &params, const Evaluation& SwScaled)
-    {
-        if (!params.config().enableSatScaling())
-            return SwScaled;
-
-        if (params.config().enableThreePointKrSatScaling()) {
-            return scaledToUnscaledSatThreePoint_(SwScaled,
-                                                  params.unscaledPoints().saturationKrwPoints(),
-                                                  params.scaledPoints().saturationKrwPoints());
-        }
-        else { // two-point relperm saturation scaling
-            return scaledToUnscaledSatTwoPoint_(SwScaled,
-                                                params.unscaledPoints().saturationKrwPoints(),
-                                                params.scaledPoints().saturationKrwPoints());
-        }
-    }
+    { return params.scalingCoefficients().scaledToUnscaledSatKrw().map(SwScaled); }
 
     template <class Evaluation>
     static Evaluation unscaledToScaledSatKrw(const Params &params, const Evaluation& SwUnscaled)
-    {
-        if (!params.config().enableSatScaling())
-            return SwUnscaled;
-
-        if (params.config().enableThreePointKrSatScaling()) {
-            return unscaledToScaledSatThreePoint_(SwUnscaled,
-                                                  params.unscaledPoints().saturationKrwPoints(),
-                                                  params.scaledPoints().saturationKrwPoints());
-        }
-        else { // two-point relperm saturation scaling
-            return unscaledToScaledSatTwoPoint_(SwUnscaled,
-                                                params.unscaledPoints().saturationKrwPoints(),
-                                                params.scaledPoints().saturationKrwPoints());
-        }
-    }
+    { return params.scalingCoefficients().unscaledToScaledSatKrw().map(SwUnscaled); }
 
     /*!
      * \brief Convert an absolute saturation to an effective one for the scaling of the
@@ -367,114 +370,19 @@ public:
      */
     template <class Evaluation>
     static Evaluation scaledToUnscaledSatKrn(const Params &params, const Evaluation& SwScaled)
-    {
-        if (!params.config().enableSatScaling())
-            return SwScaled;
-
-        if (params.config().enableThreePointKrSatScaling())
-            return scaledToUnscaledSatThreePoint_(SwScaled,
-                                                  params.unscaledPoints().saturationKrnPoints(),
-                                                  params.scaledPoints().saturationKrnPoints());
-        else // two-point relperm saturation scaling
-            return scaledToUnscaledSatTwoPoint_(SwScaled,
-                                                params.unscaledPoints().saturationKrnPoints(),
-                                                params.scaledPoints().saturationKrnPoints());
-    }
-
+    { return params.scalingCoefficients().scaledToUnscaledSatKrn().map(SwScaled); }
 
     template <class Evaluation>
     static Evaluation unscaledToScaledSatKrn(const Params &params, const Evaluation& SwUnscaled)
-    {
-        if (!params.config().enableSatScaling())
-            return SwUnscaled;
-
-        if (params.config().enableThreePointKrSatScaling()) {
-            return unscaledToScaledSatThreePoint_(SwUnscaled,
-                                                  params.unscaledPoints().saturationKrnPoints(),
-                                                  params.scaledPoints().saturationKrnPoints());
-        }
-        else { // two-point relperm saturation scaling
-            return unscaledToScaledSatTwoPoint_(SwUnscaled,
-                                                params.unscaledPoints().saturationKrnPoints(),
-                                                params.scaledPoints().saturationKrnPoints());
-        }
-    }
+    { return params.scalingCoefficients().unscaledToScaledSatKrn().map(SwUnscaled); }
 
 private:
-    template <class Evaluation, class PointsContainer>
-    static Evaluation scaledToUnscaledSatTwoPoint_(const Evaluation& scaledSat,
-                                                   const PointsContainer& unscaledSats,
-                                                   const PointsContainer& scaledSats)
-    {
-        return
-            unscaledSats[0]
-            +
-            (scaledSat - scaledSats[0])*((unscaledSats[1] - unscaledSats[0])/(scaledSats[1] - scaledSats[0]));
-    }
-
-    template <class Evaluation, class PointsContainer>
-    static Evaluation unscaledToScaledSatTwoPoint_(const Evaluation& unscaledSat,
-                                                   const PointsContainer& unscaledSats,
-                                                   const PointsContainer& scaledSats)
-    {
-        return
-            scaledSats[0]
-            +
-            (unscaledSat - unscaledSats[0])*((scaledSats[1] - scaledSats[0])/(unscaledSats[1] - unscaledSats[0]));
-    }
-
-    template <class Evaluation, class PointsContainer>
-    static Evaluation scaledToUnscaledSatThreePoint_(const Evaluation& scaledSat,
-                                                     const PointsContainer& unscaledSats,
-                                                     const PointsContainer& scaledSats)
-    {
-        if (unscaledSats[1] >= unscaledSats[2])
-            return scaledToUnscaledSatTwoPoint_(scaledSat, unscaledSats, scaledSats);
-
-        if (scaledSat < scaledSats[1])
-            return
-                unscaledSats[0]
-                +
-                (scaledSat - scaledSats[0])*((unscaledSats[1] - unscaledSats[0])/(scaledSats[1] - scaledSats[0]));
-        else
-            return
-                unscaledSats[1]
-                +
-                (scaledSat - scaledSats[1])*((unscaledSats[2] - unscaledSats[1])/(scaledSats[2] - scaledSats[1]));
-    }
-
-    template <class Evaluation, class PointsContainer>
-    static Evaluation unscaledToScaledSatThreePoint_(const Evaluation& unscaledSat,
-                                                     const PointsContainer& unscaledSats,
-                                                     const PointsContainer& scaledSats)
-    {
-        if (unscaledSats[1] >= unscaledSats[2])
-            return unscaledToScaledSatTwoPoint_(unscaledSat, unscaledSats, scaledSats);
-
-        if (unscaledSat < unscaledSats[1])
-            return
-                scaledSats[0]
-                +
-                (unscaledSat - unscaledSats[0])*((scaledSats[1] - scaledSats[0])/(unscaledSats[1] - unscaledSats[0]));
-        else
-            return
-                scaledSats[1]
-                +
-                (unscaledSat - unscaledSats[1])*((scaledSats[2] - scaledSats[1])/(unscaledSats[2] - unscaledSats[1]));
-    }
-
     /*!
      * \brief Scale the capillary pressure according to the given parameters
      */
     template <class Evaluation>
     static Evaluation unscaledToScaledPcnw_(const Params &params, const Evaluation& unscaledPcnw)
-    {
-        if (!params.config().enablePcScaling())
-            return unscaledPcnw;
-
-        Scalar alpha = params.scaledPoints().maxPcnw()/params.unscaledPoints().maxPcnw();
-        return unscaledPcnw*alpha;
-    }
+    { return unscaledPcnw*params.scalingCoefficients().pcnwScalingFactor(); }
 
     template <class Evaluation>
     static Evaluation scaledToUnscaledPcnw_(const Params &params, const Evaluation& scaledPcnw)
@@ -483,7 +391,7 @@ private:
             return scaledPcnw;
 
         Scalar alpha = params.unscaledPoints().maxPcnw()/params.scaledPoints().maxPcnw();
-        return scaledPcnw/alpha;
+        return scaledPcnw*alpha;
     }
 
     /*!
@@ -491,14 +399,7 @@ private:
      */
     template <class Evaluation>
     static Evaluation unscaledToScaledKrw_(const Params &params, const Evaluation& unscaledKrw)
-    {
-        if (!params.config().enableKrwScaling())
-            return unscaledKrw;
-
-        // TODO: three point krw y-scaling
-        Scalar alpha = params.scaledPoints().maxKrw()/params.unscaledPoints().maxKrw();
-        return unscaledKrw*alpha;
-    }
+    { return unscaledKrw*params.scalingCoefficients().krwScalingFactor(); }
 
     template <class Evaluation>
     static Evaluation scaledToUnscaledKrw_(const Params &params, const Evaluation& scaledKrw)
@@ -515,14 +416,7 @@ private:
      */
     template <class Evaluation>
     static Evaluation unscaledToScaledKrn_(const Params &params, const Evaluation& unscaledKrn)
-    {
-        if (!params.config().enableKrnScaling())
-            return unscaledKrn;
-
-        //TODO: three point krn y-scaling
-        Scalar alpha = params.scaledPoints().maxKrn()/params.unscaledPoints().maxKrn();
-        return unscaledKrn*alpha;
-    }
+    { return unscaledKrn*params.scalingCoefficients().krnScalingFactor(); }
 
     template <class Evaluation>
     static Evaluation scaledToUnscaledKrn_(const Params &params, const Evaluation& scaledKrn)
@@ -533,6 +427,10 @@ private:
         Scalar alpha = params.unscaledPoints().maxKrn()/params.scaledPoints().maxKrn();
         return scaledKrn*alpha;
     }
+
+    // the number of entries of a batch which are processed at once. this limits the
+    // amount of temporary space required on the stack.
+    enum { batchChunkSize_ = 64 };
 };
 } // namespace Opm
 
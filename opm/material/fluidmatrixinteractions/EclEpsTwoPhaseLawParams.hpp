@@ -54,8 +54,10 @@ class EclEpsTwoPhaseLawParams
 public:
     typedef typename EffLawParams::Traits Traits;
     typedef Opm::EclEpsScalingPoints<Scalar> ScalingPoints;
+    typedef Opm::EclEpsScalingCoefficients<Scalar> ScalingCoefficients;
 
     EclEpsTwoPhaseLawParams()
+        : directCurves_(0)
     {
 #ifndef NDEBUG
         finalized_ = false;
@@ -65,6 +67,9 @@ public:
     /*!
      * \brief Calculate all dependent quantities once the independent
      *        quantities of the parameter object have been set.
+     *
+     * This needs to be called again after the configuration or the scaling points have
+     * been modified.
      */
     void finalize()
     {
@@ -77,13 +82,23 @@ public:
 
         finalized_ = true;
 #endif
+
+        if (!scalingCoefficients_) {
+            auto coefficients = std::make_shared<ScalingCoefficients>();
+            // without scaling points, the endpoint scaling is disabled and the default
+            // coefficients do not modify anything
+            if (unscaledPoints_ && scaledPoints_)
+                coefficients->init(*unscaledPoints_, *scaledPoints_, *config_);
+            scalingCoefficients_ = coefficients;
+        }
+        updateDirectCurves_();
     }
 
     /*!
      * \brief Set the endpoint scaling configuration object.
      */
     void setConfig(std::shared_ptr<EclEpsConfig> value)
-    { config_ = value; }
+    { config_ = value; precomputedCurves_.reset(); scalingCoefficients_.reset(); updateDirectCurves_(); }
 
     /*!
      * \brief Returns the endpoint scaling configuration object.
@@ -95,7 +110,7 @@ public:
      * \brief Set the scaling points which are seen by the nested material law
      */
     void setUnscaledPoints(std::shared_ptr<ScalingPoints> value)
-    { unscaledPoints_ = value; }
+    { unscaledPoints_ = value; precomputedCurves_.reset(); scalingCoefficients_.reset(); updateDirectCurves_(); }
 
     /*!
      * \brief Returns the scaling points which are seen by the nested material law
@@ -107,25 +122,56 @@ public:
      * \brief Set the scaling points which are seen by the physical model
      */
     void setScaledPoints(std::shared_ptr<ScalingPoints> value)
-    { scaledPoints_ = *value; }
+    { scaledPoints_ = value; precomputedCurves_.reset(); scalingCoefficients_.reset(); updateDirectCurves_(); }
 
     /*!
      * \brief Returns the scaling points which are seen by the physical model
      */
     const ScalingPoints& scaledPoints() const
-    { return scaledPoints_; }
+    { return *scaledPoints_; }
 
     /*!
      * \brief Returns the scaling points which are seen by the physical model
+     *
+     * The scaling points object may be shared with other parameter objects. If this is
+     * the case, a private copy is created before they can be modified. Since the
+     * points may be changed, the precomputed curves and the scaling coefficients are
+     * discarded, i.e., finalize() needs to be called again afterwards.
      */
     ScalingPoints& scaledPoints()
-    { return scaledPoints_; }
+    {
+        precomputedCurves_.reset();
+        scalingCoefficients_.reset();
+        updateDirectCurves_();
+        if (scaledPoints_.use_count() > 1)
+            scaledPoints_ = std::make_shared<ScalingPoints>(*scaledPoints_);
+        return *scaledPoints_;
+    }
+
+    /*!
+     * \brief Set the coefficients which convert between the unscaled and the scaled
+     *        quantities.
+     *
+     * This allows parameter objects which use the same scaling points to share their
+     * coefficients. If no coefficients are set, finalize() computes them. Like the
+     * precomputed curves, they are discarded if the configuration or the scaling points
+     * are modified.
+     */
+    void setScalingCoefficients(std::shared_ptr<const ScalingCoefficients> value)
+    { scalingCoefficients_ = value; }
+
+    /*!
+     * \brief Returns the coefficients which convert between the unscaled and the scaled
+     *        quantities.
+     */
+    const ScalingCoefficients& scalingCoefficients() const
+    { assert(scalingCoefficients_); return *scalingCoefficients_; }
 
     /*!
      * \brief Sets the parameter object for the effective/nested material law.
      */
-    void setEffectiveLawParams(std::shared_ptr<EffLawParams> value)
-    { effectiveLawParams_ = value; }
+    void setEffectiveLawParams(std::shared_ptr<const EffLawParams> value)
+    { effectiveLawParams_ = value; precomputedCurves_.reset(); updateDirectCurves_(); }
 
     /*!
      * \brief Returns the parameter object for the effective/nested material law.
@@ -133,7 +179,80 @@ public:
     const EffLawParams& effectiveLawParams() const
     { return *effectiveLawParams_; }
 
+    /*!
+     * \brief Set a parameter object for the effective/nested material law which
+     *        already includes the end point scaling.
+     *
+     * If such an object is set, the capillary pressure and the relative permeabilities
+     * are evaluated using the nested law and this object directly, i.e., the saturation
+     * and value scaling is skipped. The object is discarded as soon as any of the
+     * quantities it is based on is modified.
+     */
+    void setPrecomputedCurves(std::shared_ptr<EffLawParams> value)
+    { precomputedCurves_ = value; updateDirectCurves_(); }
+
+    /*!
+     * \brief Returns true iff a parameter object which includes the end point scaling
+     *        is available.
+     */
+    bool hasPrecomputedCurves() const
+    { return static_cast<bool>(precomputedCurves_); }
+
+    /*!
+     * \brief Returns the parameter object of the nested law which includes the end
+     *        point scaling.
+     */
+    const EffLawParams& precomputedCurves() const
+    { return *precomputedCurves_; }
+
+    /*!
+     * \brief Returns true iff the unscaled and the scaled points have been set.
+     */
+    bool hasScalingPoints() const
+    { return unscaledPoints_ && scaledPoints_; }
+
+    /*!
+     * \brief Returns true iff the end point scaling does not modify anything.
+     *
+     * This is the case if no scaling points are set or if all kinds of scaling are
+     * disabled by the configuration, e.g., for decks without the ENDSCALE keyword.
+     */
+    bool isPassThrough() const
+    {
+        if (!config_)
+            return false;
+        if (!hasScalingPoints())
+            return true;
+        return
+            !config_->enableSatScaling()
+            && !config_->enablePcScaling()
+            && !config_->enableKrwScaling()
+            && !config_->enableKrnScaling();
+    }
+
+    /*!
+     * \brief Returns the parameter object of the nested law which can be evaluated for
+     *        the scaled saturations directly, or 0 if the scaling must be applied.
+     *
+     * This is the object which includes the end point scaling if one was set (cf.
+     * setPrecomputedCurves()) and the parameter object of the nested law if the
+     * scaling does not modify anything (cf. isPassThrough()). It is determined when the
+     * parameters are modified, so EclEpsTwoPhaseLaw only needs a single branch to
+     * bypass the scaling.
+     */
+    const EffLawParams* directCurves() const
+    { return directCurves_; }
+
 private:
+    void updateDirectCurves_()
+    {
+        if (precomputedCurves_)
+            directCurves_ = precomputedCurves_.get();
+        else if (effectiveLawParams_ && isPassThrough())
+            directCurves_ = effectiveLawParams_.get();
+        else
+            directCurves_ = 0;
+    }
 
 #ifndef NDEBUG
     void assertFinalized_() const
@@ -145,11 +264,16 @@ private:
     { }
 #endif
 
-    std::shared_ptr<EffLawParams> effectiveLawParams_;
+    std::shared_ptr<const EffLawParams> effectiveLawParams_;
+    std::shared_ptr<EffLawParams> precomputedCurves_;
 
     std::shared_ptr<EclEpsConfig> config_;
     std::shared_ptr<ScalingPoints> unscaledPoints_;
-    ScalingPoints scaledPoints_;
+    std::shared_ptr<ScalingPoints> scaledPoints_;
+    std::shared_ptr<const ScalingCoefficients> scalingCoefficients_;
+
+    // either the precomputed curves, the effective law parameters or 0
+    const EffLawParams* directCurves_;
 };
 
 } // namespace Opm
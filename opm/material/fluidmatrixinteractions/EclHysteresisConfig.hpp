@@ -50,6 +50,7 @@ public:
         enableHysteresis_ = false;
         pcHysteresisModel_ = 0;
         krHysteresisModel_ = 0;
+        activeStateBuffer_ = 0;
     }
 
     /*!
@@ -100,6 +101,27 @@ public:
     int krHysteresisModel() const
     { return krHysteresisModel_; };
 
+    /*!
+     * \brief Returns the index of the buffer which holds the current hysteresis state
+     *        of the parameter objects which use this configuration.
+     *
+     * This is only relevant for parameter objects with a double buffered state, cf.
+     * EclHysteresisTwoPhaseLawParams: Their current state is read from this buffer and
+     * updates are written to the other one.
+     */
+    unsigned activeStateBuffer() const
+    { return activeStateBuffer_; }
+
+    /*!
+     * \brief Make the updated hysteresis state of all parameter objects which use this
+     *        configuration the current one.
+     *
+     * This must not be called concurrently with the evaluation or the update of any of
+     * these parameter objects.
+     */
+    void swapStateBuffers()
+    { activeStateBuffer_ = 1 - activeStateBuffer_; }
+
 #if HAVE_OPM_PARSER
     /*!
      * \brief Reads all relevant material parameters form a cell of a parsed ECL deck.
@@ -165,6 +187,7 @@ private:
     // the capillary pressure and the relperm hysteresis models to be used
     int pcHysteresisModel_;
     int krHysteresisModel_;
+    unsigned activeStateBuffer_;
 };
 
 } // namespace Opm
@@ -149,7 +149,7 @@ public:
         // TODO: capillary pressure hysteresis
         return EffectiveLaw::twoPhaseSatPcnw(params.drainageParams(), Sw);
 /*
-        if (!params.config().enableHysteresis() || params.config().pcHysteresisModel() < 0)
+        if (!params.hysteresisActive() || params.config().pcHysteresisModel() < 0)
             return EffectiveLaw::twoPhaseSatPcnw(params.drainageParams(), Sw);
 
         if (Sw < params.SwMdc())
@@ -162,6 +162,28 @@ public:
 */
     }
 
+    /*!
+     * \brief The wetting phase saturation for a given capillary pressure.
+     *
+     * Since the capillary pressure is always given by the drainage curve, this is its
+     * inverse.
+     */
+    template <class Evaluation>
+    static Evaluation twoPhaseSatPcnwInv(const Params &params, const Evaluation& pcnw)
+    { return EffectiveLaw::twoPhaseSatPcnwInv(params.drainageParams(), pcnw); }
+
+    /*!
+     * \brief The wetting phase saturations for a batch of capillary pressures.
+     *
+     * This is equivalent to calling twoPhaseSatPcnwInv() for each entry of the pcnw
+     * array.
+     */
+    static void twoPhaseSatPcnwInvBatch(const Params &params,
+                                        const Scalar* pcnw,
+                                        Scalar* Sw,
+                                        size_t n)
+    { EffectiveLaw::twoPhaseSatPcnwInvBatch(params.drainageParams(), pcnw, Sw, n); }
+
     /*!
      * \brief The saturation-capillary pressure curves.
      */
@@ -236,7 +258,7 @@ public:
     {
 
         // if no relperm hysteresis is enabled, use the drainage curve
-        if (!params.config().enableHysteresis() || params.config().krHysteresisModel() < 0)
+        if (!params.hysteresisActive() || params.config().krHysteresisModel() < 0)
             return EffectiveLaw::twoPhaseSatKrw(params.drainageParams(), Sw);
 
         // if it is enabled, use either the drainage or the imbibition curve. if the
@@ -263,7 +285,7 @@ public:
     static Evaluation twoPhaseSatKrn(const Params &params, const Evaluation& Sw)
     {
         // if no relperm hysteresis is enabled, use the drainage curve
-        if (!params.config().enableHysteresis() || params.config().krHysteresisModel() < 0)
+        if (!params.hysteresisActive() || params.config().krHysteresisModel() < 0)
             return EffectiveLaw::twoPhaseSatKrn(params.drainageParams(), Sw);
 
         // if it is enabled, use either the drainage or the imbibition curve. if the
@@ -28,6 +28,8 @@
 #include "EclHysteresisConfig.hpp"
 #include "EclEpsScalingPoints.hpp"
 
+#include <opm/material/common/QuantizedSaturation.hpp>
+
 #if HAVE_OPM_PARSER
 #include <opm/parser/eclipse/Deck/Deck.hpp>
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
@@ -37,6 +39,7 @@
 #include <memory>
 #include <cassert>
 #include <algorithm>
+#include <type_traits>
 
 namespace Opm {
 /*!
@@ -44,8 +47,23 @@ namespace Opm {
  *
  * \brief A default implementation of the parameters for the material law which
  *        implements the ECL relative permeability and capillary pressure hysteresis
+ *
+ * \tparam StateScalarT The type which stores the hysteresis state, i.e., the saturations
+ *                      at the reversal points and the shifts of the imbibition curves.
+ *                      Besides the scalar type of the effective law, this can be a
+ *                      QuantizedSaturation to reduce the memory required per element.
+ * \tparam doubleBufferedStateT Store two copies of the hysteresis state. The current
+ *                              state is the one selected by
+ *                              EclHysteresisConfig::activeStateBuffer() and update()
+ *                              writes the other one, which becomes the current state
+ *                              once EclHysteresisConfig::swapStateBuffers() is called.
+ *                              Since update() thus does not modify anything which is
+ *                              read by the evaluation of the material law, both can be
+ *                              done concurrently.
  */
-template <class EffLawT>
+template <class EffLawT,
+          class StateScalarT = typename EffLawT::Params::Traits::Scalar,
+          bool doubleBufferedStateT = false>
 class EclHysteresisTwoPhaseLawParams
 {
     typedef typename EffLawT::Params EffLawParams;
@@ -53,15 +71,24 @@ class EclHysteresisTwoPhaseLawParams
 
 public:
     typedef typename EffLawParams::Traits Traits;
+    typedef StateScalarT StateScalar;
+
+    //! The number of copies of the hysteresis state
+    static const unsigned numStateBuffers = doubleBufferedStateT ? 2 : 1;
 
     EclHysteresisTwoPhaseLawParams()
     {
-        pcSwMdc_ = 2.0;
-        krnSwMdc_ = 2.0;
-        // krwSwMdc_ = 2.0;
+        for (unsigned bufIdx = 0; bufIdx < numStateBuffers; ++bufIdx) {
+            pcSwMdc_[bufIdx] = 2.0;
+            krnSwMdc_[bufIdx] = 2.0;
+            // krwSwMdc_ = 2.0;
+
+            deltaSwImbKrn_[bufIdx] = 0.0;
+            deltaSwImbPc_[bufIdx] = 0.0;
+            // deltaSwImbKrw_ = 0.0;
+        }
 
-        deltaSwImbKrn_ = 0.0;
-        // deltaSwImbKrw_ = 0.0;
+        drainageOnly_ = false;
 
 #ifndef NDEBUG
         finalized_ = false;
@@ -74,10 +101,11 @@ public:
      */
     void finalize()
     {
-        if (config().enableHysteresis()) {
+        if (hysteresisActive()) {
             //C_ = 1.0/(Sncri_ - Sncrd_) + 1.0/(Snmaxd_ - Sncrd_);
 
-            updateDynamicParams_();
+            for (unsigned bufIdx = 0; bufIdx < numStateBuffers; ++bufIdx)
+                updateDynamicParams_(bufIdx);
         }
 
 #ifndef NDEBUG
@@ -97,6 +125,28 @@ public:
     const EclHysteresisConfig& config() const
     { return *config_; }
 
+    /*!
+     * \brief Specify whether this object always uses the drainage curve.
+     *
+     * This is intended for the elements for which the drainage and the imbibition
+     * curves coincide: The hysteresis model does not have any effect for them, so no
+     * imbibition parameters need to be set and update() does not do anything.
+     */
+    void setDrainageOnly(bool yesno)
+    { drainageOnly_ = yesno; }
+
+    /*!
+     * \brief Returns true iff this object always uses the drainage curve.
+     */
+    bool drainageOnly() const
+    { return drainageOnly_; }
+
+    /*!
+     * \brief Returns true iff the hysteresis model is used by this object.
+     */
+    bool hysteresisActive() const
+    { return config().enableHysteresis() && !drainageOnly_; }
+
     /*!
      * \brief Sets the parameters used for the drainage curve
      */
@@ -119,12 +169,16 @@ public:
 
     /*!
      * \brief Sets the parameters used for the imbibition curve
+     *
+     * In contrast to the drainage parameters, the object is not copied: The imbibition
+     * curve is not modified by the hysteresis model, so it can be shared by all
+     * parameter objects which use the same one.
      */
     void setImbibitionParams(std::shared_ptr<EffLawParams> value,
                              const EclEpsScalingPointsInfo<Scalar>& /* info */,
                              EclTwoPhaseSystemType /* twoPhaseSystem */)
     {
-        imbibitionParams_ = *value;
+        imbibitionParams_ = value;
 
 /*
         if (twoPhaseSystem == EclGasOilSystem) {
@@ -141,24 +195,29 @@ public:
      * \brief Returns the parameters used for the imbibition curve
      */
     const EffLawParams& imbibitionParams() const
-    { return imbibitionParams_; }
+    { return *imbibitionParams_; }
 
+    /*!
+     * \brief Returns the parameters used for the imbibition curve
+     *
+     * Note that this object may be shared with other hysteresis parameter objects.
+     */
     EffLawParams& imbibitionParams()
-    { return imbibitionParams_; }
+    { return *imbibitionParams_; }
 
     /*!
      * \brief Set the saturation of the wetting phase where the last switch from the main
      *        drainage curve (MDC) to imbibition happend on the capillary pressure curve.
      */
     void setPcSwMdc(Scalar value)
-    { pcSwMdc_ = value; };
+    { setState_(pcSwMdc_, value); };
 
     /*!
      * \brief Set the saturation of the wetting phase where the last switch from the main
      *        drainage curve to imbibition happend on the capillary pressure curve.
      */
     Scalar pcSwMdc() const
-    { return pcSwMdc_; };
+    { return pcSwMdc_[readBuffer_()]; };
 
     /*!
      * \brief Set the saturation of the wetting phase where the last switch from the main
@@ -184,7 +243,7 @@ public:
      *        non-wetting phase.
      */
     void setKrnSwMdc(Scalar value)
-    { krnSwMdc_ = value; };
+    { setState_(krnSwMdc_, value); };
 
     /*!
      * \brief Set the saturation of the wetting phase where the last switch from the main
@@ -192,7 +251,7 @@ public:
      *        non-wetting phase.
      */
     Scalar krnSwMdc() const
-    { return krnSwMdc_; };
+    { return krnSwMdc_[readBuffer_()]; };
 
     /*!
      * \brief Sets the saturation value which must be added if krw is calculated using
@@ -224,7 +283,7 @@ public:
      * krn(Sw) = krn_imbibition(Sw + Sw_shift,krn) else
      */
     void setDeltaSwImbKrn(Scalar value)
-    { deltaSwImbKrn_ = value; }
+    { setState_(deltaSwImbKrn_, value); }
 
     /*!
      * \brief Returns the saturation value which must be added if krn is calculated using
@@ -234,20 +293,58 @@ public:
      * krn(Sw) = krn_imbibition(Sw + Sw_shift,krn) else
      */
     Scalar deltaSwImbKrn() const
-    { return deltaSwImbKrn_; }
+    { return deltaSwImbKrn_[readBuffer_()]; }
+
+    /*!
+     * \brief Sets the saturation value which must be added if the capillary pressure is
+     *        calculated using the imbibition curve.
+     *
+     * This is only required to restore a state which was obtained using
+     * deltaSwImbPc(). Normally, the value is calculated by update().
+     */
+    void setDeltaSwImbPc(Scalar value)
+    { setState_(deltaSwImbPc_, value); }
+
+    /*!
+     * \brief Returns the saturation value which must be added if the capillary pressure
+     *        is calculated using the imbibition curve.
+     */
+    Scalar deltaSwImbPc() const
+    { return deltaSwImbPc_[readBuffer_()]; }
 
     /*!
      * \brief Notify the hysteresis law that a given wetting-phase saturation has been seen
      *
      * This updates the scanning curves and the imbibition<->drainage reversal points as
-     * appropriate.
+     * appropriate. Changes of the reversal points which are below the round-off
+     * tolerance are ignored and quantities which depend on the imbibition curves are
+     * only recalculated for the reversal points which actually moved.
+     *
+     * If the state is double buffered, the updated state is the current state plus the
+     * given saturation, i.e., if this method is called several times before the
+     * buffers are swapped, only the last call has an effect.
      */
     void update(Scalar pcSw, Scalar /* krwSw */, Scalar krnSw)
     {
-        bool updateParams = false;
-        if (pcSw < pcSwMdc_) {
-            pcSwMdc_ = pcSw;
-            updateParams = true;
+        if (drainageOnly_)
+            return;
+
+        const unsigned bufIdx = writeBuffer_();
+        if (numStateBuffers > 1) {
+            const unsigned curBufIdx = readBuffer_();
+            pcSwMdc_[bufIdx] = pcSwMdc_[curBufIdx];
+            krnSwMdc_[bufIdx] = krnSwMdc_[curBufIdx];
+            deltaSwImbKrn_[bufIdx] = deltaSwImbKrn_[curBufIdx];
+            deltaSwImbPc_[bufIdx] = deltaSwImbPc_[curBufIdx];
+        }
+
+        // the reversal points are minima, so they are rounded down if the state is
+        // stored with a reduced precision. seeing the same saturation again then does
+        // not move them.
+        const StateScalar& pcSwState = roundDown_(pcSw, std::is_same<StateScalar, Scalar>());
+        if (pcSwState < pcSwMdc_[bufIdx] - mdcTolerance_()) {
+            pcSwMdc_[bufIdx] = pcSwState;
+            updatePcParams_(bufIdx);
         }
 
 /*
@@ -263,13 +360,11 @@ public:
         }
 */
 
-        if (krnSw < krnSwMdc_) {
-            krnSwMdc_ = krnSw;
-            updateParams = true;
+        const StateScalar& krnSwState = roundDown_(krnSw, std::is_same<StateScalar, Scalar>());
+        if (krnSwState < krnSwMdc_[bufIdx] - mdcTolerance_()) {
+            krnSwMdc_[bufIdx] = krnSwState;
+            updateKrnParams_(bufIdx);
         }
-
-        if (updateParams)
-            updateDynamicParams_();
     }
 
 private:
@@ -284,7 +379,45 @@ private:
     { }
 #endif
 
-    void updateDynamicParams_()
+    // changes of the saturations at the reversal points which are smaller than this are
+    // considered to be caused by round-off
+    static Scalar mdcTolerance_()
+    { return 1e-10; }
+
+    static const Scalar& roundDown_(const Scalar& value, std::true_type)
+    { return value; }
+
+    static StateScalar roundDown_(Scalar value, std::false_type)
+    { return StateScalar::roundDown(value); }
+
+    // the buffer which holds the current state and the one which is written by update()
+    unsigned readBuffer_() const
+    { return (numStateBuffers > 1) ? config_->activeStateBuffer() : 0; }
+
+    unsigned writeBuffer_() const
+    { return (numStateBuffers > 1) ? 1 - config_->activeStateBuffer() : 0; }
+
+    // a state which is set explicitly is the same in all buffers
+    static void setState_(StateScalar* buffers, Scalar value)
+    {
+        for (unsigned bufIdx = 0; bufIdx < numStateBuffers; ++bufIdx)
+            buffers[bufIdx] = value;
+    }
+
+    void updateDynamicParams_(unsigned bufIdx)
+    {
+        updateKrnParams_(bufIdx);
+        updatePcParams_(bufIdx);
+
+#if 0
+        Scalar Snhy = 1.0 - SwMdc_;
+
+        Sncrt_ = Sncrd_ + (Snhy - Sncrd_)/(1 + C_*(Snhy - Sncrd_));
+#endif
+    }
+
+    // calculate the saturation delta for the non-wetting phase relative permeability
+    void updateKrnParams_(unsigned bufIdx)
     {
         // HACK: Eclipse seems to disable the wetting-phase relperm even though this is
         // quite pointless from the physical POV. (see comment above)
@@ -295,45 +428,53 @@ private:
         deltaSwImbKrw_ = SwKrwMdcImbibition - krwSwMdc_;
 */
 
-        Scalar krnMdcDrainage = EffLawT::twoPhaseSatKrn(drainageParams(), krnSwMdc_);
+        const Scalar krnSwMdc = krnSwMdc_[bufIdx];
+        Scalar krnMdcDrainage = EffLawT::twoPhaseSatKrn(drainageParams(), krnSwMdc);
         Scalar SwKrnMdcImbibition = EffLawT::twoPhaseSatKrnInv(imbibitionParams(), krnMdcDrainage);
-        deltaSwImbKrn_ = SwKrnMdcImbibition - krnSwMdc_;
-
-        Scalar pcMdcDrainage = EffLawT::twoPhaseSatPcnw(drainageParams(), pcSwMdc_);
-        Scalar SwPcMdcImbibition = EffLawT::twoPhaseSatPcnwInv(imbibitionParams(), pcMdcDrainage);
-        deltaSwImbPc_ = SwPcMdcImbibition - pcSwMdc_;
+        deltaSwImbKrn_[bufIdx] = SwKrnMdcImbibition - krnSwMdc;
 
-//        assert(std::abs(EffLawT::twoPhaseSatPcnw(imbibitionParams(), pcSwMdc_ + deltaSwImbPc_)
-//                        - EffLawT::twoPhaseSatPcnw(drainageParams(), pcSwMdc_)) < 1e-8);
-        assert(std::abs(EffLawT::twoPhaseSatKrn(imbibitionParams(), krnSwMdc_ + deltaSwImbKrn_)
-                        - EffLawT::twoPhaseSatKrn(drainageParams(), krnSwMdc_)) < 1e-8);
+        // the shift is stored with the precision of the hysteresis state
+        assert(!(std::is_same<StateScalar, Scalar>::value)
+               || std::abs(EffLawT::twoPhaseSatKrn(imbibitionParams(), krnSwMdc + Scalar(deltaSwImbKrn_[bufIdx]))
+                           - EffLawT::twoPhaseSatKrn(drainageParams(), krnSwMdc)) < 1e-8);
 //        assert(std::abs(EffLawT::twoPhaseSatKrw(imbibitionParams(), krwSwMdc_ + deltaSwImbKrw_)
 //                        - EffLawT::twoPhaseSatKrw(drainageParams(), krwSwMdc_)) < 1e-8);
+    }
 
-#if 0
-        Scalar Snhy = 1.0 - SwMdc_;
+    // calculate the saturation delta for the capillary pressure
+    void updatePcParams_(unsigned bufIdx)
+    {
+        const Scalar pcSwMdc = pcSwMdc_[bufIdx];
+        Scalar pcMdcDrainage = EffLawT::twoPhaseSatPcnw(drainageParams(), pcSwMdc);
+        Scalar SwPcMdcImbibition = EffLawT::twoPhaseSatPcnwInv(imbibitionParams(), pcMdcDrainage);
+        deltaSwImbPc_[bufIdx] = SwPcMdcImbibition - pcSwMdc;
 
-        Sncrt_ = Sncrd_ + (Snhy - Sncrd_)/(1 + C_*(Snhy - Sncrd_));
-#endif
+//        assert(std::abs(EffLawT::twoPhaseSatPcnw(imbibitionParams(), pcSwMdc_ + deltaSwImbPc_)
+//                        - EffLawT::twoPhaseSatPcnw(drainageParams(), pcSwMdc_)) < 1e-8);
     }
 
     std::shared_ptr<EclHysteresisConfig> config_;
-    EffLawParams imbibitionParams_;
+    std::shared_ptr<EffLawParams> imbibitionParams_;
     EffLawParams drainageParams_;
 
     // largest wettinging phase saturation which is on the main-drainage curve. These are
     // three different values because the sourounding code can choose to use different
-    // definitions for the saturations for different quantities
+    // definitions for the saturations for different quantities. all quantities of the
+    // hysteresis state are stored once per state buffer.
 //    Scalar krwSwMdc_;
-    Scalar krnSwMdc_;
-    Scalar pcSwMdc_;
+    StateScalar krnSwMdc_[numStateBuffers];
+    StateScalar pcSwMdc_[numStateBuffers];
 
     // offsets added to wetting phase saturation uf using the imbibition curves need to
     // be used to calculate the wetting phase relperm, the non-wetting phase relperm and
     // the capillary pressure
 //    Scalar deltaSwImbKrw_;
-    Scalar deltaSwImbKrn_;
-    Scalar deltaSwImbPc_;
+    StateScalar deltaSwImbKrn_[numStateBuffers];
+    StateScalar deltaSwImbPc_[numStateBuffers];
+
+    // stored after the hysteresis state so that it fits into the padding if the state
+    // is quantized
+    bool drainageOnly_;
 
     // trapped non-wetting phase saturation
     //Scalar Sncrt_;
@@ -39,15 +39,38 @@
 #include <opm/material/fluidmatrixinteractions/EclHysteresisConfig.hpp>
 #include <opm/material/fluidmatrixinteractions/EclMultiplexerMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
+#include <opm/material/fluidmatrixinteractions/SaturationDerivatives.hpp>
 #include <opm/material/fluidstates/SimpleModularFluidState.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
 
+#include <opm/material/common/CompactRegionIndices.hpp>
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/HugePageAllocator.hpp>
+#include <opm/material/common/MappedFile.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
+#include <opm/material/common/TableRegistry.hpp>
+#include <opm/material/common/TableFile.hpp>
+#include <opm/material/common/TableSimplification.hpp>
 
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
 #include <opm/parser/eclipse/Deck/Deck.hpp>
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 
 namespace Opm {
@@ -57,13 +80,31 @@ namespace Opm {
  *
  * \brief Provides an simple way to create and manage the material law objects
  *        for a complete ECL deck.
+ *
+ * \tparam TraitsT The traits of the three-phase material law
+ * \tparam HysteresisStateScalarT The type which stores the hysteresis state of the
+ *                                elements. If this is a QuantizedSaturation, e.g.,
+ *                                QuantizedSaturation<Scalar, int16_t>, the saturations of
+ *                                the reversal points and the shifts of the imbibition
+ *                                curves are only stored with the precision of this type.
+ *                                The reversal points are rounded down, so they never
+ *                                exceed the saturations which have actually been seen.
+ * \tparam doubleBufferedHysteresisT Store the hysteresis state of the elements twice,
+ *                                   so that updateHysteresis() can run concurrently
+ *                                   with the evaluation of the saturation functions.
+ *                                   The updated state becomes visible once
+ *                                   swapHysteresisStates() is called.
  */
-template <class TraitsT>
+template <class TraitsT,
+          class HysteresisStateScalarT = typename TraitsT::Scalar,
+          bool doubleBufferedHysteresisT = false>
 class EclMaterialLawManager
 {
 private:
     typedef TraitsT Traits;
     typedef typename Traits::Scalar Scalar;
+    typedef HysteresisStateScalarT HysteresisStateScalar;
+    static const bool doubleBufferedHysteresis = doubleBufferedHysteresisT;
     enum { waterPhaseIdx = Traits::wettingPhaseIdx };
     enum { oilPhaseIdx = Traits::nonWettingPhaseIdx };
     enum { gasPhaseIdx = Traits::gasPhaseIdx };
@@ -85,8 +126,14 @@ private:
     typedef typename OilWaterEpsTwoPhaseLaw::Params OilWaterEpsTwoPhaseParams;
 
     // the scaled two-phase material laws with hystersis
-    typedef EclHysteresisTwoPhaseLaw<GasOilEpsTwoPhaseLaw> GasOilTwoPhaseLaw;
-    typedef EclHysteresisTwoPhaseLaw<OilWaterEpsTwoPhaseLaw> OilWaterTwoPhaseLaw;
+    typedef EclHysteresisTwoPhaseLawParams<GasOilEpsTwoPhaseLaw,
+                                           HysteresisStateScalar,
+                                           doubleBufferedHysteresis> GasOilHystParams_;
+    typedef EclHysteresisTwoPhaseLawParams<OilWaterEpsTwoPhaseLaw,
+                                           HysteresisStateScalar,
+                                           doubleBufferedHysteresis> OilWaterHystParams_;
+    typedef EclHysteresisTwoPhaseLaw<GasOilEpsTwoPhaseLaw, GasOilHystParams_> GasOilTwoPhaseLaw;
+    typedef EclHysteresisTwoPhaseLaw<OilWaterEpsTwoPhaseLaw, OilWaterHystParams_> OilWaterTwoPhaseLaw;
     typedef typename GasOilTwoPhaseLaw::Params GasOilTwoPhaseHystParams;
     typedef typename OilWaterTwoPhaseLaw::Params OilWaterTwoPhaseHystParams;
 
@@ -97,24 +144,521 @@ public:
 
 private:
     // internal typedefs
-    typedef std::vector<std::shared_ptr<GasOilEffectiveTwoPhaseParams> > GasOilEffectiveParamVector;
-    typedef std::vector<std::shared_ptr<OilWaterEffectiveTwoPhaseParams> > OilWaterEffectiveParamVector;
+    typedef std::vector<std::shared_ptr<const GasOilEffectiveTwoPhaseParams> > GasOilEffectiveParamVector;
+    typedef std::vector<std::shared_ptr<const OilWaterEffectiveTwoPhaseParams> > OilWaterEffectiveParamVector;
     typedef std::vector<std::shared_ptr<EclEpsScalingPoints<Scalar> > > GasOilScalingPointsVector;
     typedef std::vector<std::shared_ptr<EclEpsScalingPoints<Scalar> > > OilWaterScalingPointsVector;
     typedef std::vector<std::shared_ptr<EclEpsScalingPointsInfo<Scalar> > > GasOilScalingInfoVector;
     typedef std::vector<std::shared_ptr<EclEpsScalingPointsInfo<Scalar> > > OilWaterScalingInfoVector;
+    typedef std::vector<std::shared_ptr<GasOilEpsTwoPhaseParams> > GasOilEpsParamVector;
+    typedef std::vector<std::shared_ptr<OilWaterEpsTwoPhaseParams> > OilWaterEpsParamVector;
     typedef std::vector<std::shared_ptr<GasOilTwoPhaseHystParams> > GasOilParamVector;
     typedef std::vector<std::shared_ptr<OilWaterTwoPhaseHystParams> > OilWaterParamVector;
     typedef std::vector<std::shared_ptr<MaterialLawParams> > MaterialLawParamsVector;
 
+    // a set of scaling point objects in which each distinct object is only stored once
+    class ScalingPointsPool_
+    {
+        typedef EclEpsScalingPoints<Scalar> ScalingPoints;
+        typedef std::array<Scalar, 11> Key;
+
+    public:
+        // returns the shared instance of the pool which equals the argument. If no such
+        // object exists yet, a copy of the argument is added to the pool.
+        std::shared_ptr<ScalingPoints> intern(const ScalingPoints& points)
+        {
+            Key key = makeKey_(points);
+            auto it = index_.find(key);
+            if (it != index_.end())
+                return objects_[it->second];
+
+            index_[key] = objects_.size();
+            objects_.push_back(std::make_shared<ScalingPoints>(points));
+            return objects_.back();
+        }
+
+        // interns all objects of a vector of scaling points
+        void internAll(std::vector<std::shared_ptr<ScalingPoints> >& dest,
+                       const std::vector<ScalingPoints>& points)
+        {
+            dest.resize(points.size());
+            for (size_t i = 0; i < points.size(); ++i)
+                dest[i] = intern(points[i]);
+        }
+
+        // returns the number of distinct objects in the pool
+        size_t size() const
+        { return objects_.size(); }
+
+        // returns true iff two objects would be represented by the same instance
+        static bool equal(const ScalingPoints& a, const ScalingPoints& b)
+        { return makeKey_(a) == makeKey_(b); }
+
+    private:
+        static Key makeKey_(const ScalingPoints& points)
+        {
+            const auto& pcPoints = points.saturationPcPoints();
+            const auto& krwPoints = points.saturationKrwPoints();
+            const auto& krnPoints = points.saturationKrnPoints();
+            Key key = {{ points.maxPcnw(), points.maxKrw(), points.maxKrn(),
+                         pcPoints[0], pcPoints[1],
+                         krwPoints[0], krwPoints[1], krwPoints[2],
+                         krnPoints[0], krnPoints[1], krnPoints[2] }};
+            return key;
+        }
+
+        std::map<Key, size_t> index_;
+        std::vector<std::shared_ptr<ScalingPoints> > objects_;
+    };
+
+    // measures the wall clock time which elapsed since its creation or the last lap
+    class Stopwatch_
+    {
+        typedef std::chrono::steady_clock Clock;
+
+    public:
+        Stopwatch_()
+            : lastLap_(Clock::now())
+        {}
+
+        // returns the number of seconds since the last lap and starts a new one
+        double lap()
+        {
+            Clock::time_point now = Clock::now();
+            double result = std::chrono::duration<double>(now - lastLap_).count();
+            lastLap_ = now;
+            return result;
+        }
+
+    private:
+        Clock::time_point lastLap_;
+    };
+
 public:
+    /*!
+     * \brief The wall clock times in seconds which were required by the individual
+     *        phases of initFromDeck().
+     */
+    struct InitTimings
+    {
+        InitTimings()
+            : satRegionParams(0.0)
+            , scaledPoints(0.0)
+            , twoPhaseParams(0.0)
+            , threePhaseParams(0.0)
+        {}
+
+        //! reading the parameters which are specific for the saturation regions
+        double satRegionParams;
+        //! calculating the scaled end points of the elements
+        double scaledPoints;
+        //! creating the parameter objects of the two-phase laws for the elements
+        double twoPhaseParams;
+        //! creating the parameter objects of the three-phase law for the elements
+        double threePhaseParams;
+    };
+
+    /*!
+     * \brief The memory in bytes which is used by the parameter objects of the elements.
+     *
+     * Objects which are shared by several elements are only counted once. The tables of
+     * the saturation regions are not included because their size does not depend on the
+     * number of elements.
+     */
+    struct MemoryUsage
+    {
+        MemoryUsage()
+            : params(0)
+            , scalingPoints(0)
+            , scalingInfo(0)
+            , hysteresisState(0)
+            , overhead(0)
+            , other(0)
+        {}
+
+        //! the parameter objects of the three-phase and two-phase laws without the
+        //! hysteresis state
+        size_t params;
+        //! the scaled and unscaled end points and the coefficients computed from them
+        size_t scalingPoints;
+        //! the information about the scaled end points which is kept for applySwatinit()
+        size_t scalingInfo;
+        //! the quantities which are modified by updateHysteresis()
+        size_t hysteresisState;
+        //! the shared pointers, their control blocks and the bookkeeping of the heap
+        size_t overhead;
+        //! the region indices, the lists of elements and the result cache
+        size_t other;
+
+        size_t total() const
+        { return params + scalingPoints + scalingInfo + hysteresisState + overhead + other; }
+    };
+
     EclMaterialLawManager()
+        : enableCompactStorage_(false)
+        , enableFirstTouchAllocation_(false)
+        , enableMappedStorage_(false)
+        , enablePrecomputedCurves_(false)
+        , enableTableSharing_(false)
+        , satTableResolution_(0)
+        , maxKrResamplingError_(0.0)
+        , maxPcResamplingError_(0.0)
+        , tableSimplificationTolerance_(0.0)
+        , maxKrSimplificationError_(0.0)
+        , maxPcSimplificationError_(0.0)
+        , kroTableResolution_(0)
+        , maxKroTableError_(0.0)
+        , enableResultCache_(false)
+        , resultCacheTolerance_(0.0)
+        , enableSaturationDerivatives_(false)
     {}
 
+    /*!
+     * \brief Specify whether the element specific parameter objects ought to be stored
+     *        compactly.
+     *
+     * If this is enabled, the parameter objects of all elements are allocated in a few
+     * contiguous arrays (one per kind of object) instead of one heap allocation per
+     * object and element. This saves a lot of memory and improves the locality of the
+     * material law evaluations for large models. If enabled, the arrays are placed on
+     * huge pages (cf. Opm::HugePages). This method must be called before
+     * initFromDeck().
+     */
+    void setEnableCompactStorage(bool yesno)
+    { enableCompactStorage_ = yesno; }
+
+    /*!
+     * \brief Returns true iff the element specific parameter objects are stored
+     *        compactly.
+     *
+     * This is always the case if they are stored in memory mapped files.
+     */
+    bool enableCompactStorage() const
+    { return enableCompactStorage_ || enableMappedStorage_; }
+
+    /*!
+     * \brief Specify whether the element specific parameter objects ought to be
+     *        allocated and constructed concurrently.
+     *
+     * If this is enabled and OpenMP is used, the parameter objects of each element
+     * (including its end point scaling and hysteresis state) are constructed by the
+     * thread which processes the element in a static OpenMP schedule over all elements.
+     * Since operating systems usually place a memory page on the NUMA node of the thread
+     * which touches it first, the parameters then reside close to the threads which use
+     * them, provided that the simulator uses the same partition. This method must be
+     * called before initFromDeck().
+     */
+    void setEnableFirstTouchAllocation(bool yesno)
+    { enableFirstTouchAllocation_ = yesno; }
+
+    /*!
+     * \brief Returns true iff the element specific parameter objects are allocated and
+     *        constructed concurrently.
+     */
+    bool enableFirstTouchAllocation() const
+    { return enableFirstTouchAllocation_; }
+
+    /*!
+     * \brief Specify whether the element specific parameter objects ought to be stored
+     *        in memory mapped files.
+     *
+     * If this is enabled, each of the contiguous arrays of the compact storage is placed
+     * in a file whose name is the prefix followed by the kind of the objects, e.g.,
+     * "<prefix>materialLawParams.bin". Since the pages of these arrays are backed by the
+     * files instead of the swap space, the operating system can evict them if the memory
+     * is required elsewhere, e.g., by the linear solver. The objects are stored in the
+     * order of the element indices, so for a process which uses a partition of the
+     * grid, the elements which are close to each other in the partition are also close
+     * to each other in the files. If several processes use the same directory, the
+     * prefix must be unique for each of them, e.g., by including the MPI rank.
+     *
+     * The files are removed when the objects are released. The parameter objects
+     * contain pointers, so the files cannot be used by other processes; for a restart,
+     * the hysteresis state can be stored using writeHysteresisState(). This option
+     * implies compact storage, is only available on POSIX systems and must be set
+     * before initFromDeck().
+     *
+     * \param yesno Specifies whether the memory mapped storage is used
+     * \param filePrefix The prefix of the names of the files
+     */
+    void setEnableMappedStorage(bool yesno, const std::string& filePrefix = "")
+    {
+        enableMappedStorage_ = yesno;
+        mappedStorageFilePrefix_ = filePrefix;
+    }
+
+    /*!
+     * \brief Returns true iff the element specific parameter objects are stored in
+     *        memory mapped files.
+     */
+    bool enableMappedStorage() const
+    { return enableMappedStorage_; }
+
+    /*!
+     * \brief Returns the prefix of the names of the files which store the element
+     *        specific parameter objects.
+     */
+    const std::string& mappedStorageFilePrefix() const
+    { return mappedStorageFilePrefix_; }
+
+    /*!
+     * \brief Specify whether the end point scaling ought to be included in precomputed
+     *        saturation function tables.
+     *
+     * If this is enabled, the scaled capillary pressure and relative permeability
+     * curves are tabulated by initFromDeck() for each distinct combination of
+     * saturation region and scaled end points. Evaluating them then only requires a
+     * single table lookup instead of transforming the saturation, looking up the
+     * unscaled table and scaling the result. The tables are exact because the scaled
+     * curves are piecewise linear themselves. This method must be called before
+     * initFromDeck().
+     */
+    void setEnablePrecomputedCurves(bool yesno)
+    { enablePrecomputedCurves_ = yesno; }
+
+    /*!
+     * \brief Returns true iff the end point scaling is included in precomputed tables.
+     */
+    bool enablePrecomputedCurves() const
+    { return enablePrecomputedCurves_; }
+
+    /*!
+     * \brief Specify whether the unscaled saturation function tables ought to be shared
+     *        with other manager objects of the process.
+     *
+     * If this is enabled, the tables of each saturation region are passed through the
+     * process-wide Opm::TableRegistry, i.e., the tables which are identical for several
+     * managers, e.g., the ones of the realizations of an ensemble that are simulated by
+     * the same process, are only stored once. This method must be called before
+     * initFromDeck().
+     */
+    void setEnableTableSharing(bool yesno)
+    { enableTableSharing_ = yesno; }
+
+    /*!
+     * \brief Returns true iff the unscaled saturation function tables are shared with
+     *        other manager objects.
+     */
+    bool enableTableSharing() const
+    { return enableTableSharing_; }
+
+    /*!
+     * \brief Specify the number of uniformly spaced sampling points onto which the
+     *        unscaled saturation function tables ought to be resampled.
+     *
+     * The tables given by the deck usually use irregularly spaced saturations, which
+     * requires to search for the segment of a saturation for each evaluation. On a
+     * uniform grid, the segment can be computed directly. Since resampling changes the
+     * curves slightly, the maximum deviation from the original tables can be retrieved
+     * using maxKrResamplingError() and maxPcResamplingError() after initFromDeck(). A
+     * value smaller than 2 disables resampling, which is the default. This method must
+     * be called before initFromDeck().
+     */
+    void setSaturationTableResolution(unsigned numSamples)
+    { satTableResolution_ = numSamples; }
+
+    /*!
+     * \brief Returns the number of sampling points used for resampled saturation
+     *        function tables.
+     */
+    unsigned saturationTableResolution() const
+    { return satTableResolution_; }
+
+    /*!
+     * \brief Returns the maximum absolute deviation of the resampled relative
+     *        permeability curves from those given by the deck.
+     */
+    Scalar maxKrResamplingError() const
+    { return maxKrResamplingError_; }
+
+    /*!
+     * \brief Returns the maximum absolute deviation of the resampled capillary pressure
+     *        curves from those given by the deck [Pa].
+     */
+    Scalar maxPcResamplingError() const
+    { return maxPcResamplingError_; }
+
+    /*!
+     * \brief Specify the tolerance for removing redundant sampling points from the
+     *        unscaled saturation function tables.
+     *
+     * Deck tables are often sampled much more finely than required to represent the
+     * curves. If the tolerance is positive, sampling points are removed from each curve
+     * as long as the curve does not deviate from the original one by more than the
+     * tolerance times the largest magnitude of its values (cf. simplifyTable()). Shorter
+     * tables are faster to search and need less memory. The actual deviations can be
+     * retrieved using maxKrSimplificationError() and maxPcSimplificationError() after
+     * initFromDeck(). The default is zero, i.e., the tables are used as given. The
+     * tables are not simplified if they are resampled (cf.
+     * setSaturationTableResolution()). This method must be called before
+     * initFromDeck().
+     */
+    void setTableSimplificationTolerance(Scalar tolerance)
+    { tableSimplificationTolerance_ = tolerance; }
+
+    /*!
+     * \brief Returns the relative tolerance used to simplify the saturation function
+     *        tables.
+     */
+    Scalar tableSimplificationTolerance() const
+    { return tableSimplificationTolerance_; }
+
+    /*!
+     * \brief Returns the maximum absolute deviation of the simplified relative
+     *        permeability curves from those given by the deck.
+     */
+    Scalar maxKrSimplificationError() const
+    { return maxKrSimplificationError_; }
+
+    /*!
+     * \brief Returns the maximum absolute deviation of the simplified capillary pressure
+     *        curves from those given by the deck [Pa].
+     */
+    Scalar maxPcSimplificationError() const
+    { return maxPcSimplificationError_; }
+
+    /*!
+     * \brief Specify the number of sampling points per saturation for the tables of
+     *        the three-phase oil relative permeability.
+     *
+     * If the saturation functions do not depend on the element, i.e., if neither end
+     * point scaling nor hysteresis is enabled, initFromDeck() tabulates the oil
+     * relative permeability of the Stone 1, Stone 2 and default three-phase laws as a
+     * function of the water and the gas saturations for each saturation region. Each
+     * evaluation of the oil relative permeability is then a single bilinear lookup
+     * instead of two lookups in the two-phase curves and their combination. Since the
+     * result is an approximation, its maximum deviation from the three-phase law can be
+     * retrieved using maxKroTableError() after initFromDeck(). A value smaller than 2
+     * disables the tables, which is the default. This method must be called before
+     * initFromDeck().
+     */
+    void setThreePhaseKroTableResolution(unsigned numSamples)
+    { kroTableResolution_ = numSamples; }
+
+    /*!
+     * \brief Returns the number of sampling points per saturation used for the tables
+     *        of the three-phase oil relative permeability.
+     */
+    unsigned threePhaseKroTableResolution() const
+    { return kroTableResolution_; }
+
+    /*!
+     * \brief Returns the maximum absolute deviation of the tabulated three-phase oil
+     *        relative permeabilities from the ones of the three-phase law.
+     *
+     * The deviation is measured at the centers of the cells of the tables which are
+     * within the saturation triangle and above the connate water saturation.
+     */
+    Scalar maxKroTableError() const
+    { return maxKroTableError_; }
+
+    /*!
+     * \brief Specify whether the results of relativePermeabilities() and
+     *        capillaryPressures() ought to be cached for each element.
+     *
+     * For each element, the saturations of the last evaluation are stored together
+     * with the resulting values and their derivatives with respect to the
+     * saturations. If the saturations of the next evaluation of the element do not
+     * deviate by more than resultCacheTolerance() from the stored ones, the result is
+     * extrapolated linearly from the stored values instead of evaluating the material
+     * law. The derivatives of the result with respect to the primary variables are
+     * obtained from the ones of the saturations using the chain rule. Since the
+     * saturation functions are piecewise linear, the extrapolation is usually exact.
+     *
+     * The cache of an element is discarded by the methods which modify its hysteresis
+     * state and by applySwatinit(). If the parameters are modified in any other way,
+     * invalidateResultCache() must be called. The elements may be evaluated concurrently, but a single element
+     * must not be evaluated by several threads at the same time. This method must be
+     * called before initFromDeck().
+     */
+    void setEnableResultCache(bool yesno)
+    { enableResultCache_ = yesno; }
+
+    /*!
+     * \brief Returns true iff the results of the saturation functions are cached for
+     *        each element.
+     */
+    bool enableResultCache() const
+    { return enableResultCache_; }
+
+    /*!
+     * \brief Specify the maximum deviation of the saturations for which the cached
+     *        results of an element are used.
+     *
+     * The default is 0, i.e., the saturations must match exactly.
+     */
+    void setResultCacheTolerance(Scalar tolerance)
+    { resultCacheTolerance_ = tolerance; }
+
+    /*!
+     * \brief Returns the maximum deviation of the saturations for which the cached
+     *        results of an element are used.
+     */
+    Scalar resultCacheTolerance() const
+    { return resultCacheTolerance_; }
+
+    /*!
+     * \brief Specify whether the saturation functions ought to be evaluated with
+     *        respect to the saturations only.
+     *
+     * If this is enabled, relativePermeabilities() and capillaryPressures() evaluate
+     * the material law using evaluations which only carry the derivatives with respect
+     * to the saturations and apply the chain rule to the derivatives of the saturations
+     * of the fluid state at the end, cf. Opm::SaturationDerivatives. This makes the
+     * cost of the scaling and hysteresis steps independent of the number of primary
+     * variables. If the result cache is enabled, this is always done.
+     */
+    void setEnableSaturationDerivatives(bool yesno)
+    { enableSaturationDerivatives_ = yesno; }
+
+    /*!
+     * \brief Returns true iff the saturation functions are evaluated with respect to
+     *        the saturations only.
+     */
+    bool enableSaturationDerivatives() const
+    { return enableSaturationDerivatives_; }
+
+    /*!
+     * \brief Discard the cached results of all elements.
+     */
+    void invalidateResultCache()
+    {
+        for (auto& entry : resultCache_)
+            entry.valid = 0;
+    }
+
+    /*!
+     * \brief Discard the cached results of a single element.
+     */
+    void invalidateResultCache(int elemIdx)
+    {
+        if (!resultCache_.empty())
+            resultCache_[elemIdx].valid = 0;
+    }
+
+    /*!
+     * \brief Read the parameters of the saturation functions for all elements.
+     *
+     * Only the tables of the saturation regions which are used by at least one of the
+     * given elements are read, i.e., if each process of a parallel run only passes its
+     * own elements, its memory and time requirements do not depend on the total number
+     * of saturation regions. If OpenMP is enabled, the element specific parameter
+     * objects are created by multiple threads. The time spent in each phase of the
+     * initialization can be retrieved using initTimings().
+     */
     void initFromDeck(Opm::DeckConstPtr deck,
                       Opm::EclipseStateConstPtr eclState,
                       const std::vector<int>& compressedToCartesianElemIdx)
     {
+        OPM_PROFILER_RANGE("EclMaterialLawManager::initFromDeck");
+
+        initTimings_ = InitTimings();
+        maxKrResamplingError_ = 0.0;
+        maxPcResamplingError_ = 0.0;
+        maxKrSimplificationError_ = 0.0;
+        maxPcSimplificationError_ = 0.0;
+        maxKroTableError_ = 0.0;
+        resultCache_.clear();
         compressedToCartesianElemIdx_ = compressedToCartesianElemIdx;
         // get the number of saturation regions and the number of cells in the deck
         int numSatRegions = deck->getKeyword("TABDIMS")->getRecord(0)->getItem("NTSFUN")->getInt(0);
@@ -137,14 +681,35 @@ public:
         readGlobalHysteresisOptions_(deck);
         readGlobalThreePhaseOptions_(deck);
 
+        // determine the saturation regions which are used by the elements. the
+        // imbibition curves of the hysteresis model refer to the same tables.
+        imbnumRegionIdx_.clear();
+        usedSatRegions_.setRegionIndices(satnumRegionIdx_, numSatRegions);
+        if (enableHysteresis()) {
+            const auto& imbnumRawData = eclState->getIntGridProperty("IMBNUM")->getData();
+            imbnumRegionIdx_.resize(numCompressedElems);
+            for (int elemIdx = 0; elemIdx < numCompressedElems; ++elemIdx) {
+                int cartesianElemIdx = compressedToCartesianElemIdx_[elemIdx];
+                imbnumRegionIdx_[elemIdx] = imbnumRawData[cartesianElemIdx] - 1;
+            }
+            usedSatRegions_.addRegionIndices(imbnumRegionIdx_);
+        }
+
+        unscaledEpsInfo_.clear();
         unscaledEpsInfo_.resize(numSatRegions);
         for (int satnumRegionIdx = 0; satnumRegionIdx < numSatRegions; ++satnumRegionIdx)
-            unscaledEpsInfo_[satnumRegionIdx].extractUnscaled(deck, eclState, satnumRegionIdx);
+            if (usedSatRegions_.isUsed(satnumRegionIdx))
+                unscaledEpsInfo_[satnumRegionIdx].extractUnscaled(deck, eclState, satnumRegionIdx);
 
         if (!hasElementSpecificParameters())
             initNonElemSpecific_(deck, eclState);
         else
             initElemSpecific_(deck, eclState);
+
+        sortElementsByApproach_();
+
+        if (enableResultCache_)
+            resultCache_.resize(numCompressedElems);
     }
 
     /*!
@@ -188,16 +753,233 @@ public:
             MaterialLaw::capillaryPressures(pc, materialLawParams(elemIdx), fs);
 
             Scalar pcowAtSw = pc[oilPhaseIdx] - pc[waterPhaseIdx];
-            if (pcowAtSw > 0.0) {
-                elemScaledEpsInfo.maxPcow *= pcow/pcowAtSw;
-                auto& elemEclEpsScalingPoints = getOilWaterScaledEpsPointsDrainage_(elemIdx);
-                elemEclEpsScalingPoints.init(elemScaledEpsInfo, *oilWaterEclEpsConfig_, Opm::EclOilWaterSystem);
-            }
+            if (pcowAtSw > 0.0)
+                scaleOilWaterPc_(elemIdx, pcow/pcowAtSw);
         }
 
         return Sw;
     }
 
+    /*!
+     * \brief Modify the initial condition of all elements according to the SWATINIT
+     *        keyword.
+     *
+     * This is equivalent to calling applySwatinit(elemIdx, pcow[elemIdx], Sw[elemIdx])
+     * and storing the result in Sw[elemIdx] for each element. The capillary pressures
+     * are evaluated in batches for the elements which use the same three-phase approach,
+     * though, and the elements are processed concurrently if OpenMP is enabled.
+     *
+     * \param pcow A random access container of the capillary pressures which ought to be
+     *             attained, indexed by the element index
+     * \param Sw A random access container of the initial water saturations, indexed by
+     *           the element index. It is overwritten with the adjusted saturations.
+     */
+    template <class PcContainer, class SatContainer>
+    void applySwatinit(const PcContainer& pcow, SatContainer& Sw)
+    {
+        assert(pcow.size() == materialLawParams_.size());
+        assert(Sw.size() == materialLawParams_.size());
+
+        invalidateResultCache();
+        applySwatinit_<EclDefaultApproach, typename MaterialLaw::DefaultMaterial>(pcow, Sw);
+        applySwatinit_<EclStone1Approach, typename MaterialLaw::Stone1Material>(pcow, Sw);
+        applySwatinit_<EclStone2Approach, typename MaterialLaw::Stone2Material>(pcow, Sw);
+
+        // the two-phase law does not provide a batched version of the capillary
+        // pressures
+        const auto& twoPhaseElems = elementsByApproach_[EclTwoPhaseApproach];
+        forEachElement_(twoPhaseElems.size(), [&](unsigned i) {
+            unsigned elemIdx = twoPhaseElems[i];
+            Sw[elemIdx] = applySwatinit(elemIdx, pcow[elemIdx], Sw[elemIdx]);
+        });
+    }
+
+    /*!
+     * \brief The sets of quantities which can be requested from
+     *        saturationFunctionsBatch().
+     */
+    enum SaturationFunctionQuantities {
+        RelativePermeabilities = 1,
+        CapillaryPressures = 2,
+        AllSaturationFunctions = RelativePermeabilities | CapillaryPressures
+    };
+
+    /*!
+     * \brief Evaluate a set of saturation functions for all elements.
+     *
+     * All arrays are indexed by the element index. The oil saturation is 1 - Sw - Sg.
+     * The elements are processed in batches of the elements which use the same
+     * three-phase approach, so the parameters of each element are looked up only once
+     * for all requested quantities, and concurrently if OpenMP is enabled. Like for the
+     * batched methods of the three-phase laws, the capillary pressures are the
+     * differences \f$p_{c,ow} = p_o - p_w\f$ and \f$p_{c,go} = p_g - p_o\f$.
+     *
+     * \param quantities A combination of the SaturationFunctionQuantities flags
+     * \param Sw The water saturations
+     * \param Sg The gas saturations
+     * \param krw, kro, krg The arrays for the relative permeabilities. They are only
+     *                      accessed if the RelativePermeabilities flag is set.
+     * \param pcow, pcgo The arrays for the capillary pressures. They are only accessed
+     *                   if the CapillaryPressures flag is set.
+     */
+    void saturationFunctionsBatch(unsigned quantities,
+                                  const Scalar* Sw,
+                                  const Scalar* Sg,
+                                  Scalar* krw,
+                                  Scalar* kro,
+                                  Scalar* krg,
+                                  Scalar* pcow,
+                                  Scalar* pcgo) const
+    {
+        OPM_PROFILER_RANGE("EclMaterialLawManager::saturationFunctionsBatch");
+
+        if (!(quantities & AllSaturationFunctions))
+            return;
+
+        SaturationFunctionsKernel_ kernel(*this, quantities, Sw, Sg, krw, kro, krg, pcow, pcgo);
+        applyToApproachBlocks(kernel);
+    }
+
+    /*!
+     * \brief Evaluate a set of saturation functions for a range of elements.
+     *
+     * Only the entries of the elements in [beginElemIdx, endElemIdx) are written, and
+     * the elements are processed by the calling thread. This allows to evaluate the
+     * saturation functions for tiles of elements whose other properties are also
+     * computed while they are in the cache, and to process disjoint tiles
+     * concurrently. Apart from this, the semantics are the same as for the variant
+     * which evaluates all elements.
+     */
+    void saturationFunctionsBatch(unsigned quantities,
+                                  unsigned beginElemIdx,
+                                  unsigned endElemIdx,
+                                  const Scalar* Sw,
+                                  const Scalar* Sg,
+                                  Scalar* krw,
+                                  Scalar* kro,
+                                  Scalar* krg,
+                                  Scalar* pcow,
+                                  Scalar* pcgo) const
+    {
+        OPM_PROFILER_RANGE("EclMaterialLawManager::saturationFunctionsBatch");
+
+        if (!(quantities & AllSaturationFunctions) || !(beginElemIdx < endElemIdx))
+            return;
+
+        const SaturationFunctionsKernel_ kernel(*this, quantities, Sw, Sg, krw, kro, krg, pcow, pcgo);
+        saturationFunctionsRange_<EclDefaultApproach, typename MaterialLaw::DefaultMaterial>(
+            kernel, beginElemIdx, endElemIdx);
+        saturationFunctionsRange_<EclStone1Approach, typename MaterialLaw::Stone1Material>(
+            kernel, beginElemIdx, endElemIdx);
+        saturationFunctionsRange_<EclStone2Approach, typename MaterialLaw::Stone2Material>(
+            kernel, beginElemIdx, endElemIdx);
+        saturationFunctionsRange_<EclTwoPhaseApproach, typename MaterialLaw::TwoPhaseMaterial>(
+            kernel, beginElemIdx, endElemIdx);
+    }
+
+    /*!
+     * \brief Evaluate the relative permeabilities of all elements.
+     *
+     * \copydetails saturationFunctionsBatch()
+     */
+    void relativePermeabilitiesBatch(const Scalar* Sw,
+                                     const Scalar* Sg,
+                                     Scalar* krw,
+                                     Scalar* kro,
+                                     Scalar* krg) const
+    {
+        saturationFunctionsBatch(RelativePermeabilities, Sw, Sg,
+                                 krw, kro, krg, /*pcow=*/nullptr, /*pcgo=*/nullptr);
+    }
+
+    /*!
+     * \brief Evaluate the capillary pressures of all elements.
+     *
+     * \copydetails saturationFunctionsBatch()
+     */
+    void capillaryPressuresBatch(const Scalar* Sw,
+                                 const Scalar* Sg,
+                                 Scalar* pcow,
+                                 Scalar* pcgo) const
+    {
+        saturationFunctionsBatch(CapillaryPressures, Sw, Sg,
+                                 /*krw=*/nullptr, /*kro=*/nullptr, /*krg=*/nullptr, pcow, pcgo);
+    }
+
+    /*!
+     * \brief Returns the time spent in the phases of the last call to initFromDeck().
+     */
+    const InitTimings& initTimings() const
+    { return initTimings_; }
+
+    /*!
+     * \brief Returns the memory used by the parameter objects.
+     *
+     * This shows the effect of the compact storage mode and of sharing the scaled end
+     * points and the imbibition curves between elements. The size of the control blocks
+     * of the shared pointers and of the bookkeeping of the heap depends on the standard
+     * library and on malloc(), so the overhead is only an estimate.
+     */
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage usage;
+        std::unordered_set<const void*> visited;
+
+        // in compact mode, the objects of the elements are stored in contiguous arrays
+        // instead of one heap block per object
+        bool compact = enableCompactStorage() && hasElementSpecificParameters();
+
+        usage.overhead += materialLawParams_.size()*sizeof(std::shared_ptr<MaterialLawParams>);
+        for (const auto& paramsPtr : materialLawParams_) {
+            if (!paramsPtr || !visited.insert(paramsPtr.get()).second)
+                continue;
+
+            usage.params += sizeof(MaterialLawParams);
+            if (!compact)
+                usage.overhead += sharedObjectOverhead_(sizeof(MaterialLawParams));
+
+            const MaterialLawParams& params = *paramsPtr;
+            switch (params.approach()) {
+            case EclStone1Approach:
+                addThreePhaseMemoryUsage_(usage, visited, params.template getRealParams<EclStone1Approach>(), compact);
+                break;
+            case EclStone2Approach:
+                addThreePhaseMemoryUsage_(usage, visited, params.template getRealParams<EclStone2Approach>(), compact);
+                break;
+            case EclDefaultApproach:
+                addThreePhaseMemoryUsage_(usage, visited, params.template getRealParams<EclDefaultApproach>(), compact);
+                break;
+            case EclTwoPhaseApproach:
+                addThreePhaseMemoryUsage_(usage, visited, params.template getRealParams<EclTwoPhaseApproach>(), compact);
+                break;
+            }
+        }
+
+        typedef EclEpsScalingPointsInfo<Scalar> ScalingInfo;
+        usage.overhead += oilWaterScaledEpsInfoDrainage_.size()*sizeof(std::shared_ptr<ScalingInfo>);
+        for (const auto& infoPtr : oilWaterScaledEpsInfoDrainage_) {
+            if (!infoPtr || !visited.insert(infoPtr.get()).second)
+                continue;
+            usage.scalingInfo += sizeof(ScalingInfo);
+            if (!compact)
+                usage.overhead += sharedObjectOverhead_(sizeof(ScalingInfo));
+        }
+        usage.scalingInfo += unscaledEpsInfo_.capacity()*sizeof(ScalingInfo);
+
+        // the hysteresis state is a part of the parameter objects of the two-phase laws
+        usage.hysteresisState = hysteresisStateSize()*sizeof(HysteresisStateScalar);
+        usage.params -= std::min(usage.params, usage.hysteresisState);
+
+        usage.other += (compressedToCartesianElemIdx_.capacity()
+                        + satnumRegionIdx_.capacity()
+                        + imbnumRegionIdx_.capacity())*sizeof(int);
+        for (const auto& elemIndices : elementsByApproach_)
+            usage.other += elemIndices.capacity()*sizeof(unsigned);
+        usage.other += resultCache_.capacity()*sizeof(ResultCacheEntry_);
+
+        return usage;
+    }
+
     bool enableEndPointScaling() const
     { return enableEndPointScaling_; }
 
@@ -213,8 +995,10 @@ public:
             assert(0 <= elemIdx && elemIdx < (int) materialLawParams_.size());
             return *materialLawParams_[elemIdx];
         }
-        else
+        else {
+            assert(0 <= satnumRegionIdx_[elemIdx] && satnumRegionIdx_[elemIdx] < (int) materialLawParams_.size());
             return *materialLawParams_[satnumRegionIdx_[elemIdx]];
+        }
     }
 
     const MaterialLawParams& materialLawParams(int elemIdx) const
@@ -223,10 +1007,97 @@ public:
             assert(0 <= elemIdx && elemIdx < (int) materialLawParams_.size());
             return *materialLawParams_[elemIdx];
         }
-        else
+        else {
+            assert(0 <= satnumRegionIdx_[elemIdx] && satnumRegionIdx_[elemIdx] < (int) materialLawParams_.size());
             return *materialLawParams_[satnumRegionIdx_[elemIdx]];
+        }
+    }
+
+    /*!
+     * \brief Calculate the relative permeabilities of all phases for an element.
+     *
+     * This is equivalent to calling MaterialLaw::relativePermeabilities() with the
+     * parameters of the element, but uses the results of the previous call for the
+     * element if the result cache is enabled and the saturations did not change.
+     */
+    template <class ContainerT, class FluidState>
+    void relativePermeabilities(ContainerT& values, const FluidState& fluidState, int elemIdx) const
+    {
+        if (resultCache_.empty()) {
+            if (enableSaturationDerivatives_)
+                SaturationDerivatives<MaterialLaw>::relativePermeabilities(values, materialLawParams(elemIdx), fluidState);
+            else
+                MaterialLaw::relativePermeabilities(values, materialLawParams(elemIdx), fluidState);
+            return;
+        }
+
+        const auto& entry = updatedResultCacheEntry_(fluidState, elemIdx, ResultCacheEntry_::krValid);
+        SaturationDerivatives<MaterialLaw>::extrapolate(values, fluidState, entry.saturation,
+                                                        entry.kr, entry.dkr);
+    }
+
+    /*!
+     * \brief Calculate the capillary pressures of all phases for an element.
+     *
+     * This is equivalent to calling MaterialLaw::capillaryPressures() with the
+     * parameters of the element, but uses the results of the previous call for the
+     * element if the result cache is enabled and the saturations did not change.
+     */
+    template <class ContainerT, class FluidState>
+    void capillaryPressures(ContainerT& values, const FluidState& fluidState, int elemIdx) const
+    {
+        if (resultCache_.empty()) {
+            if (enableSaturationDerivatives_)
+                SaturationDerivatives<MaterialLaw>::capillaryPressures(values, materialLawParams(elemIdx), fluidState);
+            else
+                MaterialLaw::capillaryPressures(values, materialLawParams(elemIdx), fluidState);
+            return;
+        }
+
+        const auto& entry = updatedResultCacheEntry_(fluidState, elemIdx, ResultCacheEntry_::pcValid);
+        SaturationDerivatives<MaterialLaw>::extrapolate(values, fluidState, entry.saturation,
+                                                        entry.pc, entry.dpc);
+    }
+
+    /*!
+     * \brief Calculate the relative permeabilities and the capillary pressures of all
+     *        phases for an element together with their derivatives with respect to the
+     *        saturations.
+     *
+     * The quantities and their derivatives are the ones of
+     * MaterialLaw::relativePermeabilities() and MaterialLaw::capillaryPressures(), cf.
+     * SaturationDerivatives::relativePermeabilitiesAt(). In particular, the
+     * saturations of all phases are treated as independent variables. The result cache
+     * is not used by this method, so it may be called concurrently for different
+     * elements.
+     *
+     * \param saturations The saturations of the phases, indexed by the phase index
+     * \param kr, dKr_dS Receive the relative permeabilities and their derivatives. If
+     *                   kr is null, the relative permeabilities are not calculated.
+     * \param pc, dPc_dS Receive the capillary pressures and their derivatives. If pc is
+     *                   null, the capillary pressures are not calculated.
+     */
+    void saturationFunctionsWithDerivatives(int elemIdx,
+                                            const Scalar* saturations,
+                                            Scalar* kr,
+                                            Scalar (*dKr_dS)[numPhases],
+                                            Scalar* pc,
+                                            Scalar (*dPc_dS)[numPhases]) const
+    {
+        const auto& params = materialLawParams(elemIdx);
+        if (kr)
+            SaturationDerivatives<MaterialLaw>::relativePermeabilitiesAt(kr, dKr_dS, params, saturations);
+        if (pc)
+            SaturationDerivatives<MaterialLaw>::capillaryPressuresAt(pc, dPc_dS, params, saturations);
     }
 
+    /*!
+     * \brief Update the hysteresis parameters of a single element.
+     *
+     * If the hysteresis state is double buffered, the update only becomes visible once
+     * swapHysteresisStates() is called and all elements must be updated before this is
+     * done.
+     */
     template <class FluidState>
     void updateHysteresis(const FluidState& fluidState, int elemIdx)
     {
@@ -235,6 +1106,253 @@ public:
 
         auto threePhaseParams = materialLawParams_[elemIdx];
         MaterialLaw::updateHysteresis(*threePhaseParams, fluidState);
+        if (!doubleBufferedHysteresis)
+            invalidateResultCache(elemIdx);
+    }
+
+    /*!
+     * \brief Make the hysteresis state which was computed by the last update the one
+     *        which is used to evaluate the saturation functions.
+     *
+     * This only applies if the hysteresis state is double buffered (cf. the
+     * doubleBufferedHysteresisT template parameter). In this case, updateHysteresis()
+     * writes the next state of the elements while the saturation functions are still
+     * evaluated for their current one, i.e., the update can be done concurrently with
+     * code which evaluates the saturation functions, e.g., for the output of the
+     * previous time step, without any locks. Swapping the states only flips the index
+     * of the current buffer, but it must not be done while saturation functions are
+     * evaluated or the hysteresis is updated. If the state is not double buffered,
+     * this method does not do anything because updateHysteresis() modifies the
+     * current state directly.
+     */
+    void swapHysteresisStates()
+    {
+        if (!doubleBufferedHysteresis || !enableHysteresis())
+            return;
+
+        hysteresisConfig_->swapStateBuffers();
+        invalidateResultCache();
+    }
+
+    /*!
+     * \brief Returns true iff the hysteresis of the saturation functions is active for
+     *        an element.
+     *
+     * This is not the case if hysteresis is disabled or if the imbibition curves of the
+     * element are the same as its drainage curves.
+     */
+    bool isHysteretic(int elemIdx) const
+    {
+        if (!enableHysteresis())
+            return false;
+
+        bool hysteretic = false;
+        applyToTwoPhaseParams_(elemIdx, [&](const GasOilTwoPhaseHystParams& gasOilParams,
+                                            const OilWaterTwoPhaseHystParams& oilWaterParams) {
+            hysteretic = gasOilParams.hysteresisActive() || oilWaterParams.hysteresisActive();
+        });
+        return hysteretic;
+    }
+
+    /*!
+     * \brief Returns the three-phase approach used by an element.
+     */
+    EclMultiplexerApproach threePhaseApproach(int elemIdx) const
+    { return materialLawParams(elemIdx).approach(); }
+
+    /*!
+     * \brief Returns the sorted indices of all elements which use a given three-phase
+     *        approach.
+     */
+    const std::vector<unsigned>& elementsWithApproach(EclMultiplexerApproach approach) const
+    { return elementsByApproach_[approach]; }
+
+    /*!
+     * \brief Returns the parameters of the three-phase law of an element for a
+     *        statically known approach.
+     *
+     * The element must use the approach specified by the template argument.
+     */
+    template <EclMultiplexerApproach approachV>
+    auto realMaterialLawParams(int elemIdx) const
+        -> decltype(std::declval<const MaterialLawParams&>().template getRealParams<approachV>())
+    { return materialLawParams(elemIdx).template getRealParams<approachV>(); }
+
+    /*!
+     * \brief Calls a kernel for each block of elements which use the same three-phase
+     *        approach.
+     *
+     * The kernel is called via <code>kernel.template apply<approach,
+     * RealMaterialLaw>(elemIndices)</code>, where RealMaterialLaw is the three-phase law
+     * which corresponds to the approach and elemIndices are the sorted indices of the
+     * elements which use it. Together with realMaterialLawParams(), this allows inner
+     * loops over elements which are dispatched statically instead of switching on the
+     * approach for each call of the multiplexer law.
+     */
+    template <class Kernel>
+    void applyToApproachBlocks(Kernel& kernel) const
+    {
+        if (!elementsByApproach_[EclDefaultApproach].empty())
+            kernel.template apply<EclDefaultApproach, typename MaterialLaw::DefaultMaterial>(
+                elementsByApproach_[EclDefaultApproach]);
+        if (!elementsByApproach_[EclStone1Approach].empty())
+            kernel.template apply<EclStone1Approach, typename MaterialLaw::Stone1Material>(
+                elementsByApproach_[EclStone1Approach]);
+        if (!elementsByApproach_[EclStone2Approach].empty())
+            kernel.template apply<EclStone2Approach, typename MaterialLaw::Stone2Material>(
+                elementsByApproach_[EclStone2Approach]);
+        if (!elementsByApproach_[EclTwoPhaseApproach].empty())
+            kernel.template apply<EclTwoPhaseApproach, typename MaterialLaw::TwoPhaseMaterial>(
+                elementsByApproach_[EclTwoPhaseApproach]);
+    }
+
+    /*!
+     * \brief Update the hysteresis parameters of all elements.
+     *
+     * The argument is a random access container of fluid states which is indexed by the
+     * element index. Since all elements use the same three-phase approach, the material
+     * law is selected only once instead of for each element and the elements are
+     * processed concurrently if OpenMP is enabled. Elements whose saturations did not
+     * move past the recorded reversal points are left alone by the two-phase
+     * hysteresis laws. If the hysteresis state is double buffered, the update only
+     * becomes visible once swapHysteresisStates() is called.
+     */
+    template <class FluidStateContainer>
+    void updateHysteresis(const FluidStateContainer& fluidStates)
+    {
+        if (!enableHysteresis())
+            return;
+
+        assert(fluidStates.size() == materialLawParams_.size());
+        if (!doubleBufferedHysteresis)
+            invalidateResultCache();
+        switch (threePhaseApproach_) {
+        case EclStone1Approach:
+            updateHysteresis_<EclStone1Approach, typename MaterialLaw::Stone1Material>(fluidStates);
+            break;
+
+        case EclStone2Approach:
+            updateHysteresis_<EclStone2Approach, typename MaterialLaw::Stone2Material>(fluidStates);
+            break;
+
+        case EclDefaultApproach:
+            updateHysteresis_<EclDefaultApproach, typename MaterialLaw::DefaultMaterial>(fluidStates);
+            break;
+
+        case EclTwoPhaseApproach:
+            updateHysteresis_<EclTwoPhaseApproach, typename MaterialLaw::TwoPhaseMaterial>(fluidStates);
+            break;
+        }
+    }
+
+    /*!
+     * \brief Returns the number of scalars which are required to store the hysteresis
+     *        state of all elements.
+     *
+     * This is zero if hysteresis is disabled.
+     */
+    size_t hysteresisStateSize() const
+    {
+        if (!enableHysteresis())
+            return 0;
+
+        return numHysteresisStateQuantities_*materialLawParams_.size();
+    }
+
+    /*!
+     * \brief Copy the hysteresis state of all elements into a contiguous array.
+     *
+     * The hysteresis state is everything which is modified by updateHysteresis(), i.e.,
+     * the saturation reversal points of the gas-oil and oil-water two-phase laws plus the
+     * saturation shifts of their imbibition curves. It is stored quantity by quantity:
+     * Quantity qIdx of element elemIdx ends up at data[qIdx*numElems + elemIdx]. Together
+     * with restoreHysteresisState(), this allows to restart a simulation without
+     * replaying the history of the saturations.
+     *
+     * \param data An array of at least hysteresisStateSize() scalars
+     */
+    void saveHysteresisState(Scalar* data) const
+    {
+        if (!enableHysteresis())
+            return;
+
+        unsigned numElems = materialLawParams_.size();
+        forEachElement_(numElems, [&](unsigned elemIdx) {
+            applyToTwoPhaseParams_(elemIdx, [&](const GasOilTwoPhaseHystParams& gasOilParams,
+                                                const OilWaterTwoPhaseHystParams& oilWaterParams) {
+                saveTwoPhaseHysteresisState_(gasOilParams, data, elemIdx, numElems);
+                saveTwoPhaseHysteresisState_(oilWaterParams,
+                                             data + numTwoPhaseHysteresisStateQuantities_*numElems,
+                                             elemIdx,
+                                             numElems);
+            });
+        });
+    }
+
+    /*!
+     * \brief Set the hysteresis state of all elements from an array which was filled by
+     *        saveHysteresisState().
+     *
+     * The state is set verbatim, i.e., the imbibition curves are not recalculated.
+     *
+     * \param data An array of at least hysteresisStateSize() scalars
+     */
+    void restoreHysteresisState(const Scalar* data)
+    {
+        if (!enableHysteresis())
+            return;
+
+        invalidateResultCache();
+
+        unsigned numElems = materialLawParams_.size();
+        forEachElement_(numElems, [&](unsigned elemIdx) {
+            applyToTwoPhaseParams_(elemIdx, [&](GasOilTwoPhaseHystParams& gasOilParams,
+                                                OilWaterTwoPhaseHystParams& oilWaterParams) {
+                restoreTwoPhaseHysteresisState_(gasOilParams, data, elemIdx, numElems);
+                restoreTwoPhaseHysteresisState_(oilWaterParams,
+                                                data + numTwoPhaseHysteresisStateQuantities_*numElems,
+                                                elemIdx,
+                                                numElems);
+            });
+        });
+    }
+
+    /*!
+     * \brief Write the hysteresis state of all elements to a binary file.
+     *
+     * \param fileName The name of the file
+     */
+    void writeHysteresisState(const std::string& fileName) const
+    {
+        std::vector<Scalar> data(hysteresisStateSize());
+        saveHysteresisState(data.data());
+
+        std::vector<const void*> arrays(1, data.data());
+        std::vector<size_t> sizes(1, data.size()*sizeof(Scalar));
+        TableFile::write(fileName, hysteresisStateKey_(), arrays, sizes);
+    }
+
+    /*!
+     * \brief Set the hysteresis state of all elements from a file which was written by
+     *        writeHysteresisState().
+     *
+     * \return false if the file does not exist, is corrupted or was written for a
+     *         different number of elements, three-phase approach or hysteresis
+     *         configuration. In this case the hysteresis state is not modified.
+     */
+    bool readHysteresisState(const std::string& fileName)
+    {
+        // the state is large for big models, so the file is mapped instead of being
+        // read into a temporary buffer
+        TableFile file;
+        if (!file.open(fileName, hysteresisStateKey_(), /*map=*/true))
+            return false;
+
+        if (file.numArrays() != 1 || file.arraySize(0) != hysteresisStateSize()*sizeof(Scalar))
+            return false;
+
+        restoreHysteresisState(static_cast<const Scalar*>(file.array(0)));
+        return true;
     }
 
     const Opm::EclEpsScalingPointsInfo<Scalar>& oilWaterScaledEpsInfoDrainage(int elemIdx) const
@@ -245,6 +1363,15 @@ public:
         return unscaledEpsInfo_[satnumRegionIdx_[elemIdx]];
     }
 
+    /*!
+     * \brief Returns the saturation regions which are used by the elements.
+     *
+     * The parameters of the other saturation regions have not been read by
+     * initFromDeck().
+     */
+    const Opm::CompactRegionIndices& usedSaturationRegions() const
+    { return usedSatRegions_; }
+
 private:
     void readGlobalEpsOptions_(Opm::DeckConstPtr deck, Opm::EclipseStateConstPtr eclState)
     {
@@ -323,8 +1450,10 @@ private:
 
     void initNonElemSpecific_(DeckConstPtr deck, EclipseStateConstPtr eclState)
     {
+        OPM_PROFILER_RANGE("EclMaterialLawManager::initFromDeck satRegionParams");
+        Stopwatch_ stopwatch;
+
         unsigned numSatRegions = deck->getKeyword("TABDIMS")->getRecord(0)->getItem("NTSFUN")->getInt(0);
-        unsigned numCompressedElems = compressedToCartesianElemIdx_.size();;
 
         GasOilEffectiveParamVector gasOilEffectiveParamVector(numSatRegions);
         OilWaterEffectiveParamVector oilWaterEffectiveParamVector(numSatRegions);
@@ -333,9 +1462,16 @@ private:
         MaterialLawParamsVector satRegionParams(numSatRegions);
         EclEpsScalingPointsInfo<Scalar> dummyInfo;
         for (size_t satnumRegionIdx = 0; satnumRegionIdx < numSatRegions; ++satnumRegionIdx) {
+            if (!usedSatRegions_.isUsed(satnumRegionIdx))
+                continue;
+
             // the parameters for the effective two-phase matererial laws
             readGasOilEffectiveParameters_(gasOilEffectiveParamVector, deck, eclState, satnumRegionIdx);
             readOilWaterEffectiveParameters_(oilWaterEffectiveParamVector, deck, eclState, satnumRegionIdx);
+            if (enableTableSharing_) {
+                shareTable_(gasOilEffectiveParamVector[satnumRegionIdx]);
+                shareTable_(oilWaterEffectiveParamVector[satnumRegionIdx]);
+            }
 
             auto gasOilDrainParams = std::make_shared<GasOilEpsTwoPhaseParams>();
             gasOilDrainParams->setConfig(oilWaterEclEpsConfig_);
@@ -362,11 +1498,9 @@ private:
             // material law parameters for a elem point to its corresponding PVT region object.
             satRegionParams[satnumRegionIdx] = std::make_shared<MaterialLawParams>();
 
-            // find the connate water saturation. this is pretty slow because it does a
-            // lot of stuff which not needed, but for the moment it is fast enough
-            // because the initialization is not performance critical
-            EclEpsScalingPointsInfo<Scalar> epsInfo;
-            epsInfo.extractUnscaled(deck, eclState, satnumRegionIdx);
+            // the connate water saturation has already been determined by
+            // initFromDeck()
+            const auto& epsInfo = unscaledEpsInfo_[satnumRegionIdx];
 
             initThreePhaseParams_(deck,
                                   eclState,
@@ -377,13 +1511,16 @@ private:
                                   gasOilParams[satnumRegionIdx]);
 
             satRegionParams[satnumRegionIdx]->finalize();
-        }
 
-        materialLawParams_.resize(numCompressedElems);
-        for (unsigned elemIdx = 0; elemIdx < numCompressedElems; ++elemIdx) {
-            int satnumRegionIdx = satnumRegionIdx_[elemIdx];
-            materialLawParams_[elemIdx] = satRegionParams[satnumRegionIdx];
+            if (kroTableResolution_ >= 2)
+                setKroTable_(*satRegionParams[satnumRegionIdx]);
         }
+
+        // without element specific parameters, the elements use the parameter object
+        // of their saturation region (cf. materialLawParams())
+        materialLawParams_ = satRegionParams;
+
+        initTimings_.satRegionParams = stopwatch.lap();
     }
 
     void initElemSpecific_(DeckConstPtr deck, EclipseStateConstPtr eclState)
@@ -391,6 +1528,9 @@ private:
         unsigned numSatRegions = deck->getKeyword("TABDIMS")->getRecord(0)->getItem("NTSFUN")->getInt(0);
         unsigned numCompressedElems = compressedToCartesianElemIdx_.size();;
 
+        Stopwatch_ stopwatch;
+        Opm::ProfilerRanges::PhaseRanges phases("EclMaterialLawManager::initFromDeck satRegionParams");
+
         // read the end point scaling configuration. this needs to be done only once per
         // deck.
         auto gasOilConfig = std::make_shared<Opm::EclEpsConfig>();
@@ -404,6 +1544,9 @@ private:
         GasOilEffectiveParamVector gasOilEffectiveParamVector(numSatRegions);
         OilWaterEffectiveParamVector oilWaterEffectiveParamVector(numSatRegions);
         for (unsigned satnumRegionIdx = 0; satnumRegionIdx < numSatRegions; ++satnumRegionIdx) {
+            if (!usedSatRegions_.isUsed(satnumRegionIdx))
+                continue;
+
             // unscaled points for end-point scaling
             readGasOilUnscaledPoints_(gasOilUnscaledPointsVector, gasOilConfig, deck, eclState, satnumRegionIdx);
             readOilWaterUnscaledPoints_(oilWaterUnscaledPointsVector, oilWaterConfig, deck, eclState, satnumRegionIdx);
@@ -411,96 +1554,187 @@ private:
             // the parameters for the effective two-phase matererial laws
             readGasOilEffectiveParameters_(gasOilEffectiveParamVector, deck, eclState, satnumRegionIdx);
             readOilWaterEffectiveParameters_(oilWaterEffectiveParamVector, deck, eclState, satnumRegionIdx);
-
-            // read the end point scaling info for the saturation region
-            unscaledEpsInfo_[satnumRegionIdx].extractUnscaled(deck, eclState, satnumRegionIdx);
-
+            if (enableTableSharing_) {
+                shareTable_(gasOilEffectiveParamVector[satnumRegionIdx]);
+                shareTable_(oilWaterEffectiveParamVector[satnumRegionIdx]);
+            }
         }
+        initTimings_.satRegionParams = stopwatch.lap();
+        phases.next("EclMaterialLawManager::initFromDeck scaledPoints");
 
         // read the scaled end point scaling parameters which are specific for each
         // element
-        GasOilScalingInfoVector gasOilScaledInfoVector(numCompressedElems);
-        oilWaterScaledEpsInfoDrainage_.resize(numCompressedElems);
+        GasOilScalingInfoVector gasOilScaledInfoVector;
         GasOilScalingInfoVector gasOilScaledImbInfoVector;
         OilWaterScalingInfoVector oilWaterScaledImbInfoVector;
 
-        GasOilScalingPointsVector gasOilScaledPointsVector(numCompressedElems);
-        GasOilScalingPointsVector oilWaterScaledEpsPointsDrainage(numCompressedElems);
+        GasOilScalingPointsVector gasOilScaledPointsVector;
+        GasOilScalingPointsVector oilWaterScaledEpsPointsDrainage;
         GasOilScalingPointsVector gasOilScaledImbPointsVector;
         OilWaterScalingPointsVector oilWaterScaledImbPointsVector;
 
+        allocateElementObjects_(gasOilScaledInfoVector, numCompressedElems, "gasOilScaledInfo");
+        allocateElementObjects_(oilWaterScaledEpsInfoDrainage_, numCompressedElems, "oilWaterScaledInfo");
         if (enableHysteresis()) {
-            gasOilScaledImbInfoVector.resize(numCompressedElems);
-            gasOilScaledImbPointsVector.resize(numCompressedElems);
-            oilWaterScaledImbInfoVector.resize(numCompressedElems);
-            oilWaterScaledImbPointsVector.resize(numCompressedElems);
+            allocateElementObjects_(gasOilScaledImbInfoVector, numCompressedElems, "gasOilScaledImbInfo");
+            allocateElementObjects_(oilWaterScaledImbInfoVector, numCompressedElems, "oilWaterScaledImbInfo");
         }
 
         EclEpsGridProperties epsGridProperties, epsImbGridProperties;
         epsGridProperties.initFromDeck(deck, eclState, /*imbibition=*/false);
         if (enableHysteresis())
             epsImbGridProperties.initFromDeck(deck, eclState, /*imbibition=*/true);
-        for (unsigned elemIdx = 0; elemIdx < numCompressedElems; ++elemIdx) {
+
+        // the scaling points are first calculated for each element into temporary
+        // arrays. this can be done concurrently because no element accesses the objects
+        // of any other.
+        std::vector<EclEpsScalingPoints<Scalar> > gasOilPoints(numCompressedElems);
+        std::vector<EclEpsScalingPoints<Scalar> > oilWaterPoints(numCompressedElems);
+        std::vector<EclEpsScalingPoints<Scalar> > gasOilImbPoints;
+        std::vector<EclEpsScalingPoints<Scalar> > oilWaterImbPoints;
+        if (enableHysteresis()) {
+            gasOilImbPoints.resize(numCompressedElems);
+            oilWaterImbPoints.resize(numCompressedElems);
+        }
+
+        forEachElement_(numCompressedElems, [&](unsigned elemIdx) {
             readGasOilScaledPoints_(gasOilScaledInfoVector,
-                                    gasOilScaledPointsVector,
+                                    gasOilPoints,
                                     gasOilConfig,
                                     epsGridProperties,
                                     elemIdx);
             readOilWaterScaledPoints_(oilWaterScaledEpsInfoDrainage_,
-                                      oilWaterScaledEpsPointsDrainage,
+                                      oilWaterPoints,
                                       oilWaterConfig,
                                       epsGridProperties,
                                       elemIdx);
 
             if (enableHysteresis()) {
                 readGasOilScaledPoints_(gasOilScaledImbInfoVector,
-                                        gasOilScaledImbPointsVector,
+                                        gasOilImbPoints,
                                         gasOilConfig,
                                         epsImbGridProperties,
                                         elemIdx);
                 readOilWaterScaledPoints_(oilWaterScaledImbInfoVector,
-                                          oilWaterScaledImbPointsVector,
+                                          oilWaterImbPoints,
                                           oilWaterConfig,
                                           epsImbGridProperties,
                                           elemIdx);
             }
+        });
+
+        // in most decks, a large fraction of the elements exhibits the same scaled end
+        // points. these are only stored once and shared by all elements which use
+        // them. since the pool is shared by all elements, this is done sequentially.
+        ScalingPointsPool_ scaledPointsPool;
+        scaledPointsPool.internAll(gasOilScaledPointsVector, gasOilPoints);
+        scaledPointsPool.internAll(oilWaterScaledEpsPointsDrainage, oilWaterPoints);
+        if (enableHysteresis()) {
+            scaledPointsPool.internAll(gasOilScaledImbPointsVector, gasOilImbPoints);
+            scaledPointsPool.internAll(oilWaterScaledImbPointsVector, oilWaterImbPoints);
         }
+        initTimings_.scaledPoints = stopwatch.lap();
+        phases.next("EclMaterialLawManager::initFromDeck twoPhaseParams");
 
         // create the parameter objects for the two-phase laws
-        GasOilParamVector gasOilParams(numCompressedElems);
-        OilWaterParamVector oilWaterParams(numCompressedElems);
-        GasOilParamVector gasOilImbParams;
-        OilWaterParamVector oilWaterImbParams;
+        GasOilParamVector gasOilParams;
+        OilWaterParamVector oilWaterParams;
+        GasOilEpsParamVector gasOilDrainParamVector;
+        OilWaterEpsParamVector oilWaterDrainParamVector;
+        GasOilEpsParamVector gasOilImbParamVector;
+        OilWaterEpsParamVector oilWaterImbParamVector;
+
+        allocateElementObjects_(gasOilParams, numCompressedElems, "gasOilParams");
+        allocateElementObjects_(oilWaterParams, numCompressedElems, "oilWaterParams");
+        if (enableEndPointScaling()) {
+            allocateElementObjects_(gasOilDrainParamVector, numCompressedElems, "gasOilDrainageParams");
+            allocateElementObjects_(oilWaterDrainParamVector, numCompressedElems, "oilWaterDrainageParams");
+        }
+        else {
+            // without end point scaling, the element specific parameters are only
+            // required for the hysteresis model. the drainage curves of all elements of
+            // a saturation region are then identical and they do not scale anything, so
+            // they are only created once per region (cf. EclEpsTwoPhaseLawParams::
+            // isPassThrough())
+            createSharedDrainageParams_(gasOilDrainParamVector, gasOilConfig, gasOilEffectiveParamVector);
+            createSharedDrainageParams_(oilWaterDrainParamVector, oilWaterConfig, oilWaterEffectiveParamVector);
+        }
 
+        std::vector<char> gasOilDrainageOnly, oilWaterDrainageOnly;
         if (enableHysteresis()) {
-            gasOilImbParams.resize(numCompressedElems);
-            oilWaterImbParams.resize(numCompressedElems);
+            // if the imbibition curve of an element is the same as its drainage curve,
+            // the hysteresis model does not have any effect, so the element can always
+            // use the drainage curve
+            findDrainageOnlyElements_(gasOilDrainageOnly,
+                                      gasOilUnscaledPointsVector,
+                                      gasOilScaledPointsVector,
+                                      gasOilScaledImbPointsVector,
+                                      gasOilEffectiveParamVector);
+            findDrainageOnlyElements_(oilWaterDrainageOnly,
+                                      oilWaterUnscaledPointsVector,
+                                      oilWaterScaledEpsPointsDrainage,
+                                      oilWaterScaledImbPointsVector,
+                                      oilWaterEffectiveParamVector);
+
+            // the imbibition curves are not modified by the hysteresis model, so they
+            // only need to be created once for each combination of imbibition region and
+            // scaled end points instead of once for each element.
+            createSharedImbibitionParams_(gasOilImbParamVector,
+                                          imbnumRegionIdx_,
+                                          gasOilDrainageOnly,
+                                          gasOilConfig,
+                                          gasOilUnscaledPointsVector,
+                                          gasOilScaledImbPointsVector,
+                                          gasOilEffectiveParamVector);
+            createSharedImbibitionParams_(oilWaterImbParamVector,
+                                          imbnumRegionIdx_,
+                                          oilWaterDrainageOnly,
+                                          oilWaterConfig,
+                                          oilWaterUnscaledPointsVector,
+                                          oilWaterScaledImbPointsVector,
+                                          oilWaterEffectiveParamVector);
         }
 
-        const auto& imbnumData = eclState->getIntGridProperty("IMBNUM")->getData();
+        // the coefficients of the endpoint scaling only depend on the unscaled and the
+        // scaled points, so the elements which use the same saturation region and the
+        // same scaled points share them.
+        std::vector<std::shared_ptr<const EclEpsScalingCoefficients<Scalar> > > gasOilCoefficients;
+        std::vector<std::shared_ptr<const EclEpsScalingCoefficients<Scalar> > > oilWaterCoefficients;
+        createSharedScalingCoefficients_(gasOilCoefficients,
+                                         satnumRegionIdx_,
+                                         *gasOilConfig,
+                                         gasOilUnscaledPointsVector,
+                                         gasOilScaledPointsVector);
+        createSharedScalingCoefficients_(oilWaterCoefficients,
+                                         satnumRegionIdx_,
+                                         *oilWaterConfig,
+                                         oilWaterUnscaledPointsVector,
+                                         oilWaterScaledEpsPointsDrainage);
+
         assert(numCompressedElems == satnumRegionIdx_.size());
-        for (unsigned elemIdx = 0; elemIdx < numCompressedElems; ++elemIdx) {
+        forEachElement_(numCompressedElems, [&](unsigned elemIdx) {
             int satnumRegionIdx = satnumRegionIdx_[elemIdx];
 
-            gasOilParams[elemIdx] = std::make_shared<GasOilTwoPhaseHystParams>();
-            oilWaterParams[elemIdx] = std::make_shared<OilWaterTwoPhaseHystParams>();
-
             gasOilParams[elemIdx]->setConfig(hysteresisConfig_);
             oilWaterParams[elemIdx]->setConfig(hysteresisConfig_);
 
-            auto gasOilDrainParams = std::make_shared<GasOilEpsTwoPhaseParams>();
-            gasOilDrainParams->setConfig(gasOilConfig);
-            gasOilDrainParams->setUnscaledPoints(gasOilUnscaledPointsVector[satnumRegionIdx]);
-            gasOilDrainParams->setScaledPoints(gasOilScaledPointsVector[elemIdx]);
-            gasOilDrainParams->setEffectiveLawParams(gasOilEffectiveParamVector[satnumRegionIdx]);
-            gasOilDrainParams->finalize();
-
-            auto oilWaterDrainParams = std::make_shared<OilWaterEpsTwoPhaseParams>();
-            oilWaterDrainParams->setConfig(oilWaterConfig);
-            oilWaterDrainParams->setUnscaledPoints(oilWaterUnscaledPointsVector[satnumRegionIdx]);
-            oilWaterDrainParams->setScaledPoints(oilWaterScaledEpsPointsDrainage[elemIdx]);
-            oilWaterDrainParams->setEffectiveLawParams(oilWaterEffectiveParamVector[satnumRegionIdx]);
-            oilWaterDrainParams->finalize();
+            const auto& gasOilDrainParams = gasOilDrainParamVector[elemIdx];
+            const auto& oilWaterDrainParams = oilWaterDrainParamVector[elemIdx];
+            if (enableEndPointScaling()) {
+                gasOilDrainParams->setConfig(gasOilConfig);
+                gasOilDrainParams->setUnscaledPoints(gasOilUnscaledPointsVector[satnumRegionIdx]);
+                gasOilDrainParams->setScaledPoints(gasOilScaledPointsVector[elemIdx]);
+                gasOilDrainParams->setEffectiveLawParams(gasOilEffectiveParamVector[satnumRegionIdx]);
+                gasOilDrainParams->setScalingCoefficients(gasOilCoefficients[elemIdx]);
+                gasOilDrainParams->finalize();
+
+                oilWaterDrainParams->setConfig(oilWaterConfig);
+                oilWaterDrainParams->setUnscaledPoints(oilWaterUnscaledPointsVector[satnumRegionIdx]);
+                oilWaterDrainParams->setScaledPoints(oilWaterScaledEpsPointsDrainage[elemIdx]);
+                oilWaterDrainParams->setEffectiveLawParams(oilWaterEffectiveParamVector[satnumRegionIdx]);
+                oilWaterDrainParams->setScalingCoefficients(oilWaterCoefficients[elemIdx]);
+                oilWaterDrainParams->finalize();
+            }
 
             gasOilParams[elemIdx]->setDrainageParams(gasOilDrainParams,
                                                          *gasOilScaledInfoVector[elemIdx],
@@ -510,38 +1744,63 @@ private:
                                                            EclOilWaterSystem);
 
             if (enableHysteresis()) {
-                int imbRegionIdx = imbnumData[elemIdx] - 1;
-
-                auto gasOilImbParamsHyst = std::make_shared<GasOilEpsTwoPhaseParams>();
-                gasOilImbParamsHyst->setConfig(gasOilConfig);
-                gasOilImbParamsHyst->setUnscaledPoints(gasOilUnscaledPointsVector[imbRegionIdx]);
-                gasOilImbParamsHyst->setScaledPoints(gasOilScaledImbPointsVector[elemIdx]);
-                gasOilImbParamsHyst->setEffectiveLawParams(gasOilEffectiveParamVector[imbRegionIdx]);
-                gasOilImbParamsHyst->finalize();
-
-                auto oilWaterImbParamsHyst = std::make_shared<OilWaterEpsTwoPhaseParams>();
-                oilWaterImbParamsHyst->setConfig(oilWaterConfig);
-                oilWaterImbParamsHyst->setUnscaledPoints(oilWaterUnscaledPointsVector[imbRegionIdx]);
-                oilWaterImbParamsHyst->setScaledPoints(oilWaterScaledImbPointsVector[elemIdx]);
-                oilWaterImbParamsHyst->setEffectiveLawParams(oilWaterEffectiveParamVector[imbRegionIdx]);
-                oilWaterImbParamsHyst->finalize();
-
-                gasOilParams[elemIdx]->setImbibitionParams(gasOilImbParamsHyst,
+                gasOilParams[elemIdx]->setDrainageOnly(gasOilDrainageOnly[elemIdx] != 0);
+                oilWaterParams[elemIdx]->setDrainageOnly(oilWaterDrainageOnly[elemIdx] != 0);
+
+                const auto& gasOilImbParamsHyst = gasOilImbParamVector[elemIdx];
+                const auto& oilWaterImbParamsHyst = oilWaterImbParamVector[elemIdx];
+                if (gasOilImbParamsHyst)
+                    gasOilParams[elemIdx]->setImbibitionParams(gasOilImbParamsHyst,
                                                                *gasOilScaledImbInfoVector[elemIdx],
                                                                EclGasOilSystem);
-                oilWaterParams[elemIdx]->setImbibitionParams(oilWaterImbParamsHyst,
+                if (oilWaterImbParamsHyst)
+                    oilWaterParams[elemIdx]->setImbibitionParams(oilWaterImbParamsHyst,
                                                                  *gasOilScaledImbInfoVector[elemIdx],
                                                                  EclGasOilSystem);
             }
 
             gasOilParams[elemIdx]->finalize();
             oilWaterParams[elemIdx]->finalize();
+        });
+
+        // if the endpoint scaling is disabled, the curves are evaluated directly, so
+        // precomputing them would only cost memory
+        if (enablePrecomputedCurves() && enableEndPointScaling()) {
+            // the elements which use the same saturation region and the same scaled end
+            // points share their tables. since the cache is shared by all elements, this
+            // is done sequentially.
+            PrecomputedCurvesCache_<GasOilEffectiveTwoPhaseParams> gasOilCache;
+            PrecomputedCurvesCache_<OilWaterEffectiveTwoPhaseParams> oilWaterCache;
+            for (unsigned elemIdx = 0; elemIdx < numCompressedElems; ++elemIdx) {
+                unsigned satnumRegionIdx = satnumRegionIdx_[elemIdx];
+                setPrecomputedCurves_<GasOilEpsTwoPhaseLaw>(gasOilParams[elemIdx]->drainageParams(),
+                                                            satnumRegionIdx,
+                                                            gasOilCache);
+                setPrecomputedCurves_<OilWaterEpsTwoPhaseLaw>(oilWaterParams[elemIdx]->drainageParams(),
+                                                              satnumRegionIdx,
+                                                              oilWaterCache);
+
+                if (enableHysteresis()) {
+                    // the imbibition parameters are shared by the elements which use the
+                    // same curves. setting the curves again for the others is harmless
+                    unsigned imbRegionIdx = imbnumRegionIdx_[elemIdx];
+                    if (!gasOilParams[elemIdx]->drainageOnly())
+                        setPrecomputedCurves_<GasOilEpsTwoPhaseLaw>(gasOilParams[elemIdx]->imbibitionParams(),
+                                                                    imbRegionIdx,
+                                                                    gasOilCache);
+                    if (!oilWaterParams[elemIdx]->drainageOnly())
+                        setPrecomputedCurves_<OilWaterEpsTwoPhaseLaw>(oilWaterParams[elemIdx]->imbibitionParams(),
+                                                                      imbRegionIdx,
+                                                                      oilWaterCache);
+                }
+            }
         }
+        initTimings_.twoPhaseParams = stopwatch.lap();
+        phases.next("EclMaterialLawManager::initFromDeck threePhaseParams");
 
         // create the parameter objects for the three-phase law
-        materialLawParams_.resize(numCompressedElems);
-        for (unsigned elemIdx = 0; elemIdx < numCompressedElems; ++elemIdx) {
-            materialLawParams_[elemIdx] = std::make_shared<MaterialLawParams>();
+        allocateElementObjects_(materialLawParams_, numCompressedElems, "materialLawParams");
+        forEachElement_(numCompressedElems, [&](unsigned elemIdx) {
             int satnumRegionIdx = satnumRegionIdx_[elemIdx];
 
             initThreePhaseParams_(deck,
@@ -553,7 +1812,8 @@ private:
                                   gasOilParams[elemIdx]);
 
             materialLawParams_[elemIdx]->finalize();
-        }
+        });
+        initTimings_.threePhaseParams = stopwatch.lap();
     }
 
     // The saturation function family.
@@ -603,13 +1863,14 @@ private:
                                         Opm::EclipseStateConstPtr eclState,
                                         int satnumRegionIdx)
     {
-        dest[satnumRegionIdx] = std::make_shared<GasOilEffectiveTwoPhaseParams>();
+        auto effParamsPtr = std::make_shared<GasOilEffectiveTwoPhaseParams>();
+        dest[satnumRegionIdx] = effParamsPtr;
 
         bool hasWater = deck->hasKeyword("WATER");
         bool hasGas = deck->hasKeyword("GAS");
         bool hasOil = deck->hasKeyword("OIL");
 
-        auto& effParams = *dest[satnumRegionIdx];
+        auto& effParams = *effParamsPtr;
 
         // the situation for the gas phase is complicated that all saturations are
         // shifted by the connate water saturation.
@@ -685,7 +1946,7 @@ private:
         effParams.setKrwSamples(SoKroSamples, sgofTable.getKrogColumn());
         effParams.setKrnSamples(SoSamples, sgofTable.getKrgColumn());
         effParams.setPcnwSamples(SoSamples, sgofTable.getPcogColumn());
-        effParams.finalize();
+        finalizeEffectiveParams_(effParams);
     }
 
     void readGasOilEffectiveParametersSlgof_(GasOilEffectiveTwoPhaseParams& effParams,
@@ -703,7 +1964,7 @@ private:
         effParams.setKrwSamples(SoKroSamples, slgofTable.getKrogColumn());
         effParams.setKrnSamples(SoSamples, slgofTable.getKrgColumn());
         effParams.setPcnwSamples(SoSamples, slgofTable.getPcogColumn());
-        effParams.finalize();
+        finalizeEffectiveParams_(effParams);
     }
 
     void readGasOilEffectiveParametersFamily2_(GasOilEffectiveTwoPhaseParams& effParams,
@@ -721,23 +1982,161 @@ private:
         effParams.setKrwSamples(SoColumn, sof3Table.getKrogColumn());
         effParams.setKrnSamples(SoSamples, sgfnTable.getKrgColumn());
         effParams.setPcnwSamples(SoSamples, sgfnTable.getPcogColumn());
+        finalizeEffectiveParams_(effParams);
+    }
+
+    // replace a table by the identical one of the process-wide registry if there is one
+    template <class Table>
+    static void shareTable_(std::shared_ptr<const Table>& table)
+    { table = TableRegistry<Table>::instance().intern(table); }
+
+    // finish the initialization of an effective parameter object and simplify its
+    // curves or resample them onto uniformly spaced saturations if requested
+    template <class EffParams>
+    void finalizeEffectiveParams_(EffParams& effParams)
+    {
+        effParams.finalize();
+        if (satTableResolution_ < 2) {
+            if (tableSimplificationTolerance_ > 0)
+                simplifyEffectiveParams_(effParams);
+            return;
+        }
+
+        std::vector<Scalar> SwPcSamples, pcSamples;
+        std::vector<Scalar> SwKrwSamples, krwSamples;
+        std::vector<Scalar> SwKrnSamples, krnSamples;
+        maxPcResamplingError_ =
+            std::max(maxPcResamplingError_,
+                     resampleCurve_(SwPcSamples, pcSamples, effParams.SwPcwnSamples(), effParams.pcnwSamples()));
+        maxKrResamplingError_ =
+            std::max(maxKrResamplingError_,
+                     resampleCurve_(SwKrwSamples, krwSamples, effParams.SwKrwSamples(), effParams.krwSamples()));
+        maxKrResamplingError_ =
+            std::max(maxKrResamplingError_,
+                     resampleCurve_(SwKrnSamples, krnSamples, effParams.SwKrnSamples(), effParams.krnSamples()));
+
+        effParams.setPcnwSamples(SwPcSamples, pcSamples);
+        effParams.setKrwSamples(SwKrwSamples, krwSamples);
+        effParams.setKrnSamples(SwKrnSamples, krnSamples);
+        effParams.finalize();
+    }
+
+    // remove the redundant sampling points of the curves of an effective parameter
+    // object
+    template <class EffParams>
+    void simplifyEffectiveParams_(EffParams& effParams)
+    {
+        std::vector<Scalar> SwPcSamples, pcSamples;
+        std::vector<Scalar> SwKrwSamples, krwSamples;
+        std::vector<Scalar> SwKrnSamples, krnSamples;
+        maxPcSimplificationError_ =
+            std::max(maxPcSimplificationError_,
+                     simplifyCurve_(SwPcSamples, pcSamples, effParams.SwPcwnSamples(), effParams.pcnwSamples()));
+        maxKrSimplificationError_ =
+            std::max(maxKrSimplificationError_,
+                     simplifyCurve_(SwKrwSamples, krwSamples, effParams.SwKrwSamples(), effParams.krwSamples()));
+        maxKrSimplificationError_ =
+            std::max(maxKrSimplificationError_,
+                     simplifyCurve_(SwKrnSamples, krnSamples, effParams.SwKrnSamples(), effParams.krnSamples()));
+
+        effParams.setPcnwSamples(SwPcSamples, pcSamples);
+        effParams.setKrwSamples(SwKrwSamples, krwSamples);
+        effParams.setKrnSamples(SwKrnSamples, krnSamples);
         effParams.finalize();
     }
 
+    // simplify a piecewise linear curve and return the maximum deviation of the result
+    // from the original curve. (the simplified curve is exact at its own sampling
+    // points, so the deviation is maximal at one of the original ones.)
+    template <class ValueVector>
+    Scalar simplifyCurve_(std::vector<Scalar>& SwSimplified,
+                          std::vector<Scalar>& valuesSimplified,
+                          const ValueVector& SwValues,
+                          const ValueVector& values) const
+    {
+        SwSimplified.assign(SwValues.begin(), SwValues.end());
+        valuesSimplified.assign(values.begin(), values.end());
+        Opm::simplifyTable(SwSimplified, valuesSimplified, tableSimplificationTolerance_);
+        if (SwSimplified.size() == SwValues.size())
+            return 0.0;
+
+        Scalar maxError = 0.0;
+        for (size_t i = 0; i < SwValues.size(); ++i) {
+            Scalar delta = interpolate_(SwSimplified, valuesSimplified, SwValues[i]) - values[i];
+            maxError = std::max(maxError, std::abs(delta));
+        }
+
+        return maxError;
+    }
+
+    // resample a piecewise linear curve with ascending sampling points onto
+    // satTableResolution_ uniformly spaced points in the same interval. the maximum
+    // deviation of the result from the original curve is returned. (both curves are
+    // piecewise linear and the new curve is exact at its own sampling points, so the
+    // deviation is maximal at one of the original ones.)
+    template <class ValueVector>
+    Scalar resampleCurve_(std::vector<Scalar>& SwResampled,
+                          std::vector<Scalar>& valuesResampled,
+                          const ValueVector& SwValues,
+                          const ValueVector& values) const
+    {
+        size_t n = satTableResolution_;
+        Scalar SwMin = SwValues.front();
+        Scalar SwMax = SwValues.back();
+        if (!(SwMin < SwMax)) {
+            // the curve is not in ascending order. keep it as it is.
+            SwResampled.assign(SwValues.begin(), SwValues.end());
+            valuesResampled.assign(values.begin(), values.end());
+            return 0.0;
+        }
+
+        SwResampled.resize(n);
+        valuesResampled.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            SwResampled[i] = SwMin + i*(SwMax - SwMin)/(n - 1);
+            valuesResampled[i] = interpolate_(SwValues, values, SwResampled[i]);
+        }
+
+        Scalar maxError = 0.0;
+        for (size_t i = 0; i < SwValues.size(); ++i) {
+            Scalar delta = interpolate_(SwResampled, valuesResampled, SwValues[i]) - values[i];
+            maxError = std::max(maxError, std::abs(delta));
+        }
+
+        return maxError;
+    }
+
+    // linear interpolation of a curve with ascending sampling points which is constant
+    // outside of the sampled interval
+    template <class ValueVector>
+    static Scalar interpolate_(const ValueVector& xValues, const ValueVector& yValues, Scalar x)
+    {
+        if (x <= xValues.front())
+            return yValues.front();
+        if (x >= xValues.back())
+            return yValues.back();
+
+        size_t segIdx = std::upper_bound(xValues.begin(), xValues.end(), x) - xValues.begin() - 1;
+        Scalar x0 = xValues[segIdx];
+        Scalar x1 = xValues[segIdx + 1];
+        return yValues[segIdx] + (x - x0)*(yValues[segIdx + 1] - yValues[segIdx])/(x1 - x0);
+    }
+
     template <class Container>
     void readOilWaterEffectiveParameters_(Container& dest,
                                           Opm::DeckConstPtr deck,
                                           Opm::EclipseStateConstPtr eclState,
                                           int satnumRegionIdx)
     {
-        dest[satnumRegionIdx] = std::make_shared<OilWaterEffectiveTwoPhaseParams>();
+        auto effParamsPtr = std::make_shared<OilWaterEffectiveTwoPhaseParams>();
+        dest[satnumRegionIdx] = effParamsPtr;
 
         bool hasWater = deck->hasKeyword("WATER");
         bool hasGas = deck->hasKeyword("GAS");
         bool hasOil = deck->hasKeyword("OIL");
 
         const auto tableManager = eclState->getTableManager();
-        auto& effParams = *dest[satnumRegionIdx];
+        auto& effParams = *effParamsPtr;
 
         // handle the twophase case
         if (!hasWater) {
@@ -750,7 +2149,7 @@ private:
             effParams.setKrwSamples(SwColumn, swofTable.getKrwColumn());
             effParams.setKrnSamples(SwColumn, swofTable.getKrowColumn());
             effParams.setPcnwSamples(SwColumn, swofTable.getPcowColumn());
-            effParams.finalize();
+            finalizeEffectiveParams_(effParams);
 
             // Todo (?): support for twophase simulations using family2?
             return;
@@ -769,7 +2168,7 @@ private:
             effParams.setKrwSamples(SwColumn, swofTable.getKrwColumn());
             effParams.setKrnSamples(SwColumn, swofTable.getKrowColumn());
             effParams.setPcnwSamples(SwColumn, swofTable.getPcowColumn());
-            effParams.finalize();
+            finalizeEffectiveParams_(effParams);
             break;
         }
         case FamilyII:
@@ -786,7 +2185,7 @@ private:
             effParams.setKrwSamples(SwColumn, swfnTable.getKrwColumn());
             effParams.setKrnSamples(SwSamples, sof3Table.getKrowColumn());
             effParams.setPcnwSamples(SwColumn, swfnTable.getPcowColumn());
-            effParams.finalize();
+            finalizeEffectiveParams_(effParams);
             break;
         }
         default:
@@ -825,14 +2224,13 @@ private:
                                  const EclEpsGridProperties& epsGridProperties,
                                  int elemIdx)
     {
-        int satnumRegionIdx = (*epsGridProperties.satnum)[elemIdx] - 1; // ECL uses Fortran indices!
+        int satnumRegionIdx = satnumRegionIdx_[elemIdx];
         int cartElemIdx = compressedToCartesianElemIdx_[elemIdx];
 
-        destInfo[elemIdx] = std::make_shared<EclEpsScalingPointsInfo<Scalar> >(unscaledEpsInfo_[satnumRegionIdx]);
+        *destInfo[elemIdx] = unscaledEpsInfo_[satnumRegionIdx];
         destInfo[elemIdx]->extractScaled(epsGridProperties, cartElemIdx);
 
-        destPoints[elemIdx] = std::make_shared<EclEpsScalingPoints<Scalar> >();
-        destPoints[elemIdx]->init(*destInfo[elemIdx], *config, EclGasOilSystem);
+        destPoints[elemIdx].init(*destInfo[elemIdx], *config, EclGasOilSystem);
     }
 
     template <class InfoContainer, class PointsContainer>
@@ -842,14 +2240,13 @@ private:
                                    const EclEpsGridProperties& epsGridProperties,
                                    int elemIdx)
     {
-        int satnumRegionIdx = (*epsGridProperties.satnum)[elemIdx] - 1; // ECL uses Fortran indices!
+        int satnumRegionIdx = satnumRegionIdx_[elemIdx];
         int cartElemIdx = compressedToCartesianElemIdx_[elemIdx];
 
-        destInfo[elemIdx] = std::make_shared<EclEpsScalingPointsInfo<Scalar> >(unscaledEpsInfo_[satnumRegionIdx]);;
+        *destInfo[elemIdx] = unscaledEpsInfo_[satnumRegionIdx];
         destInfo[elemIdx]->extractScaled(epsGridProperties, cartElemIdx);
 
-        destPoints[elemIdx] = std::make_shared<EclEpsScalingPoints<Scalar> >();
-        destPoints[elemIdx]->init(*destInfo[elemIdx], *config, EclOilWaterSystem);
+        destPoints[elemIdx].init(*destInfo[elemIdx], *config, EclOilWaterSystem);
     }
 
     void initThreePhaseParams_(Opm::DeckConstPtr deck,
@@ -910,32 +2307,998 @@ private:
         }
     }
 
-    EclEpsScalingPoints<Scalar>& getOilWaterScaledEpsPointsDrainage_(int elemIdx)
+    // tabulate the three-phase oil relative permeability of a saturation region
+    void setKroTable_(MaterialLawParams& materialParams)
+    {
+        switch (materialParams.approach()) {
+        case EclStone1Approach:
+            setKroTable_<typename MaterialLaw::Stone1Material>(
+                materialParams.template getRealParams<Opm::EclStone1Approach>());
+            break;
+
+        case EclStone2Approach:
+            setKroTable_<typename MaterialLaw::Stone2Material>(
+                materialParams.template getRealParams<Opm::EclStone2Approach>());
+            break;
+
+        case EclDefaultApproach:
+            setKroTable_<typename MaterialLaw::DefaultMaterial>(
+                materialParams.template getRealParams<Opm::EclDefaultApproach>());
+            break;
+
+        case EclTwoPhaseApproach:
+            // the two-phase approach does not combine any curves
+            break;
+        }
+    }
+
+    template <class RealMaterialLaw, class RealParams>
+    void setKroTable_(RealParams& realParams)
+    {
+        typedef typename RealParams::KroTable KroTable;
+
+        // the samples are computed by the three-phase law itself, so any table which
+        // was set before must be removed first
+        realParams.setKroTable(nullptr);
+
+        int n = kroTableResolution_;
+        auto kroTable = std::make_shared<KroTable>(/*SwMin=*/0.0, /*SwMax=*/1.0, n,
+                                                   /*SgMin=*/0.0, /*SgMax=*/1.0, n);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                kroTable->setSamplePoint(i, j, analyticKro_<RealMaterialLaw>(realParams,
+                                                                             kroTable->iToX(i),
+                                                                             kroTable->jToY(j)));
+
+        // the deviation of the bilinear interpolation is largest between the sampling
+        // points, so it is checked at the centers of the cells. water saturations below
+        // the connate one are not considered because they do not occur physically.
+        Scalar h = 1.0/(n - 1);
+        for (int i = 0; i < n - 1; ++i) {
+            for (int j = 0; j < n - 1; ++j) {
+                Scalar Sw = (i + 0.5)*h;
+                Scalar Sg = (j + 0.5)*h;
+                if (Sw < realParams.Swl() || Sw + Sg > 1.0)
+                    continue;
+
+                Scalar delta = kroTable->eval(Sw, Sg) - analyticKro_<RealMaterialLaw>(realParams, Sw, Sg);
+                maxKroTableError_ = std::max(maxKroTableError_, std::abs(delta));
+            }
+        }
+
+        realParams.setKroTable(kroTable);
+    }
+
+    // evaluate the oil relative permeability of a three-phase law for an oil saturation
+    // of 1 - Sw - Sg. outside of the saturation triangle, the gas saturation is reduced
+    // so that the tables continuously extend the curves.
+    template <class RealMaterialLaw, class RealParams>
+    static Scalar analyticKro_(const RealParams& realParams, Scalar Sw, Scalar Sg)
+    {
+        typedef Opm::SimpleModularFluidState<Scalar,
+                                             numPhases,
+                                             /*numComponents=*/0,
+                                             /*FluidSystem=*/void, /* -> don't care */
+                                             /*storePressure=*/false,
+                                             /*storeTemperature=*/false,
+                                             /*storeComposition=*/false,
+                                             /*storeFugacity=*/false,
+                                             /*storeSaturation=*/true,
+                                             /*storeDensity=*/false,
+                                             /*storeViscosity=*/false,
+                                             /*storeEnthalpy=*/false> FluidState;
+
+        Sg = std::min(Sg, 1 - Sw);
+
+        FluidState fs;
+        fs.setSaturation(waterPhaseIdx, Sw);
+        fs.setSaturation(oilPhaseIdx, 1 - Sw - Sg);
+        fs.setSaturation(gasPhaseIdx, Sg);
+        Scalar kro = RealMaterialLaw::template krn<FluidState, Scalar>(realParams, fs);
+
+        // the Stone 1 law is singular where the normalized water or gas saturation
+        // becomes one. the oil is immobile there.
+        return std::isfinite(kro) ? kro : 0.0;
+    }
+
+    // group the element indices by the three-phase approach used by the elements
+    void sortElementsByApproach_()
+    {
+        for (auto& elemIndices : elementsByApproach_)
+            elemIndices.clear();
+
+        unsigned numElems = satnumRegionIdx_.size();
+        for (unsigned elemIdx = 0; elemIdx < numElems; ++elemIdx)
+            elementsByApproach_[threePhaseApproach(elemIdx)].push_back(elemIdx);
+    }
+
+    template <EclMultiplexerApproach approach, class RealMaterialLaw, class FluidStateContainer>
+    void updateHysteresis_(const FluidStateContainer& fluidStates)
+    {
+        forEachElement_(materialLawParams_.size(), [&](unsigned elemIdx) {
+            auto& realParams = materialLawParams_[elemIdx]->template getRealParams<approach>();
+            RealMaterialLaw::updateHysteresis(realParams, fluidStates[elemIdx]);
+        });
+    }
+
+    // the reversal points and imbibition shifts of the two-phase hysteresis laws
+    enum { numTwoPhaseHysteresisStateQuantities_ = 4 };
+    enum { numHysteresisStateQuantities_ = 2*numTwoPhaseHysteresisStateQuantities_ };
+
+    template <class HystParams>
+    static void saveTwoPhaseHysteresisState_(const HystParams& params,
+                                             Scalar* data,
+                                             unsigned elemIdx,
+                                             unsigned numElems)
+    {
+        data[0*numElems + elemIdx] = params.pcSwMdc();
+        data[1*numElems + elemIdx] = params.krnSwMdc();
+        data[2*numElems + elemIdx] = params.deltaSwImbPc();
+        data[3*numElems + elemIdx] = params.deltaSwImbKrn();
+    }
+
+    template <class HystParams>
+    static void restoreTwoPhaseHysteresisState_(HystParams& params,
+                                                const Scalar* data,
+                                                unsigned elemIdx,
+                                                unsigned numElems)
+    {
+        params.setPcSwMdc(data[0*numElems + elemIdx]);
+        params.setKrnSwMdc(data[1*numElems + elemIdx]);
+        params.setDeltaSwImbPc(data[2*numElems + elemIdx]);
+        params.setDeltaSwImbKrn(data[3*numElems + elemIdx]);
+    }
+
+    std::string hysteresisStateKey_() const
+    {
+        std::ostringstream oss;
+        oss << "EclMaterialLawManager hysteresis state"
+            << " sizeof(Scalar)=" << sizeof(Scalar)
+            << " numElems=" << materialLawParams_.size()
+            << " threePhaseApproach=" << threePhaseApproach_
+            << " enableHysteresis=" << enableHysteresis();
+        return oss.str();
+    }
+
+    // calls a functor with the gas-oil and the oil-water parameters of an element
+    template <class Functor>
+    void applyToTwoPhaseParams_(unsigned elemIdx, const Functor& functor) const
+    {
+        auto& materialParams = *materialLawParams_[elemIdx];
+        switch (materialParams.approach()) {
+        case EclStone1Approach: {
+            auto& realParams = materialParams.template getRealParams<Opm::EclStone1Approach>();
+            functor(realParams.gasOilParams(), realParams.oilWaterParams());
+            break;
+        }
+
+        case EclStone2Approach: {
+            auto& realParams = materialParams.template getRealParams<Opm::EclStone2Approach>();
+            functor(realParams.gasOilParams(), realParams.oilWaterParams());
+            break;
+        }
+
+        case EclDefaultApproach: {
+            auto& realParams = materialParams.template getRealParams<Opm::EclDefaultApproach>();
+            functor(realParams.gasOilParams(), realParams.oilWaterParams());
+            break;
+        }
+
+        case EclTwoPhaseApproach: {
+            auto& realParams = materialParams.template getRealParams<Opm::EclTwoPhaseApproach>();
+            functor(realParams.gasOilParams(), realParams.oilWaterParams());
+            break;
+        }
+        }
+    }
+
+    // create the end point scaling parameters of the imbibition curve for each
+    // element. all elements which use the same imbibition region and the same scaled end
+    // points share a single object.
+    template <class EpsParams, class EffectiveParamVector>
+    void createSharedDrainageParams_(std::vector<std::shared_ptr<EpsParams> >& dest,
+                                     const std::shared_ptr<EclEpsConfig>& config,
+                                     const EffectiveParamVector& effectiveParams) const
+    {
+        std::vector<std::shared_ptr<EpsParams> > regionParams(effectiveParams.size());
+        for (size_t satnumRegionIdx = 0; satnumRegionIdx < effectiveParams.size(); ++satnumRegionIdx) {
+            if (!effectiveParams[satnumRegionIdx])
+                continue;
+
+            auto& params = regionParams[satnumRegionIdx];
+            params = std::make_shared<EpsParams>();
+            params->setConfig(config);
+            params->setEffectiveLawParams(effectiveParams[satnumRegionIdx]);
+            params->finalize();
+        }
+
+        size_t numElems = satnumRegionIdx_.size();
+        dest.resize(numElems);
+        for (size_t elemIdx = 0; elemIdx < numElems; ++elemIdx)
+            dest[elemIdx] = regionParams[satnumRegionIdx_[elemIdx]];
+    }
+
+    template <class EpsParams, class ScalingPointsVector, class EffectiveParamVector>
+    static void createSharedImbibitionParams_(std::vector<std::shared_ptr<EpsParams> >& dest,
+                                              const std::vector<int>& imbnumRegionIdx,
+                                              const std::vector<char>& drainageOnly,
+                                              const std::shared_ptr<EclEpsConfig>& config,
+                                              const ScalingPointsVector& unscaledPoints,
+                                              const ScalingPointsVector& scaledPoints,
+                                              const EffectiveParamVector& effectiveParams)
+    {
+        std::map<std::pair<int, const EclEpsScalingPoints<Scalar>*>, std::shared_ptr<EpsParams> > sharedParams;
+
+        size_t numElems = scaledPoints.size();
+        dest.resize(numElems);
+        for (size_t elemIdx = 0; elemIdx < numElems; ++elemIdx) {
+            if (drainageOnly[elemIdx])
+                // the element does not need any imbibition parameters
+                continue;
+
+            int imbRegionIdx = imbnumRegionIdx[elemIdx];
+            auto& params = sharedParams[std::make_pair(imbRegionIdx, scaledPoints[elemIdx].get())];
+            if (!params) {
+                params = std::make_shared<EpsParams>();
+                params->setConfig(config);
+                params->setUnscaledPoints(unscaledPoints[imbRegionIdx]);
+                params->setScaledPoints(scaledPoints[elemIdx]);
+                params->setEffectiveLawParams(effectiveParams[imbRegionIdx]);
+                params->finalize();
+            }
+            dest[elemIdx] = params;
+        }
+    }
+
+    // compute the coefficients of the endpoint scaling of the drainage curve for each
+    // element. all elements which use the same saturation region and the same scaled end
+    // points share a single object.
+    template <class ScalingPointsVector>
+    static void createSharedScalingCoefficients_(std::vector<std::shared_ptr<const EclEpsScalingCoefficients<Scalar> > >& dest,
+                                                 const std::vector<int>& satnumRegionIdx,
+                                                 const EclEpsConfig& config,
+                                                 const ScalingPointsVector& unscaledPoints,
+                                                 const ScalingPointsVector& scaledPoints)
+    {
+        typedef EclEpsScalingCoefficients<Scalar> Coefficients;
+        std::map<std::pair<int, const EclEpsScalingPoints<Scalar>*>, std::shared_ptr<const Coefficients> > sharedCoefficients;
+
+        size_t numElems = scaledPoints.size();
+        dest.resize(numElems);
+        for (size_t elemIdx = 0; elemIdx < numElems; ++elemIdx) {
+            int regionIdx = satnumRegionIdx[elemIdx];
+            auto& coefficients = sharedCoefficients[std::make_pair(regionIdx, scaledPoints[elemIdx].get())];
+            if (!coefficients) {
+                auto newCoefficients = std::make_shared<Coefficients>();
+                newCoefficients->init(*unscaledPoints[regionIdx], *scaledPoints[elemIdx], config);
+                coefficients = newCoefficients;
+            }
+            dest[elemIdx] = coefficients;
+        }
+    }
+
+    // determine the elements for which the imbibition curve is the same as the drainage
+    // curve. this is the case if the scaled end points are the same (they are taken from
+    // the same pool, so this means that they are represented by the same object) and if
+    // both curves refer to the same region or to regions with identical tables.
+    template <class ScalingPointsVector, class EffectiveParamVector>
+    void findDrainageOnlyElements_(std::vector<char>& drainageOnly,
+                                   const ScalingPointsVector& unscaledPoints,
+                                   const ScalingPointsVector& scaledDrainagePoints,
+                                   const ScalingPointsVector& scaledImbibitionPoints,
+                                   const EffectiveParamVector& effectiveParams) const
+    {
+        size_t numElems = scaledDrainagePoints.size();
+        drainageOnly.resize(numElems);
+        for (size_t elemIdx = 0; elemIdx < numElems; ++elemIdx) {
+            int satRegionIdx = satnumRegionIdx_[elemIdx];
+            int imbRegionIdx = imbnumRegionIdx_[elemIdx];
+
+            bool sameRegion =
+                satRegionIdx == imbRegionIdx
+                || ((effectiveParams[satRegionIdx] == effectiveParams[imbRegionIdx]
+                     || *effectiveParams[satRegionIdx] == *effectiveParams[imbRegionIdx])
+                    && ScalingPointsPool_::equal(*unscaledPoints[satRegionIdx],
+                                                 *unscaledPoints[imbRegionIdx]));
+
+            drainageOnly[elemIdx] =
+                sameRegion && scaledDrainagePoints[elemIdx] == scaledImbibitionPoints[elemIdx];
+        }
+    }
+
+    // maps a saturation region index and a scaled end points object to the effective
+    // law parameters which include the scaling
+    template <class EffParams>
+    using PrecomputedCurvesCache_ =
+        std::map<std::pair<unsigned, const EclEpsScalingPoints<Scalar>*>, std::shared_ptr<EffParams> >;
+
+    // attach the precomputed curves to an end point scaling parameter object. the
+    // curves are taken from the cache if they were already calculated for another
+    // element with the same saturation region and scaled end points.
+    template <class EpsLaw, class EpsParams, class Cache>
+    static void setPrecomputedCurves_(EpsParams& epsParams, unsigned regionIdx, Cache& cache)
+    {
+        // make sure that the const accessor is used: the mutable one un-shares the
+        // scaled points
+        const EpsParams& constEpsParams = epsParams;
+        auto key = std::make_pair(regionIdx, &constEpsParams.scaledPoints());
+
+        auto it = cache.find(key);
+        if (it == cache.end())
+            it = cache.insert(std::make_pair(key, precomputeCurves_<EpsLaw>(constEpsParams))).first;
+
+        if (it->second)
+            epsParams.setPrecomputedCurves(it->second);
+    }
+
+    // tabulate the scaled curves of an end point scaling parameter object. since both,
+    // the saturation scaling and the unscaled tables are piecewise linear, the scaled
+    // curves are exactly represented by tables which use the images of the unscaled
+    // sampling points and the scaled end points as sampling points. if the scaling is
+    // not strictly monotonic, no tables are created.
+    template <class EpsLaw, class EpsParams>
+    static auto precomputeCurves_(const EpsParams& epsParams)
+        -> std::shared_ptr<typename std::decay<decltype(epsParams.effectiveLawParams())>::type>
+    {
+        typedef typename std::decay<decltype(epsParams.effectiveLawParams())>::type EffParams;
+
+        const auto& config = epsParams.config();
+        const auto& effParams = epsParams.effectiveLawParams();
+        unsigned numKrPoints = config.enableThreePointKrSatScaling() ? 3 : 2;
+
+        std::vector<Scalar> SwPcSamples, SwKrwSamples, SwKrnSamples;
+        if (config.enableSatScaling()) {
+            const auto& unscaledPoints = epsParams.unscaledPoints();
+            const auto& scaledPoints = epsParams.scaledPoints();
+            if (!isStrictlyIncreasing_(unscaledPoints.saturationPcPoints(), 2)
+                || !isStrictlyIncreasing_(scaledPoints.saturationPcPoints(), 2)
+                || !isStrictlyIncreasing_(unscaledPoints.saturationKrwPoints(), numKrPoints)
+                || !isStrictlyIncreasing_(scaledPoints.saturationKrwPoints(), numKrPoints)
+                || !isStrictlyIncreasing_(unscaledPoints.saturationKrnPoints(), numKrPoints)
+                || !isStrictlyIncreasing_(scaledPoints.saturationKrnPoints(), numKrPoints))
+                return nullptr;
+
+            SwPcSamples.assign(scaledPoints.saturationPcPoints().begin(),
+                               scaledPoints.saturationPcPoints().begin() + 2);
+            SwKrwSamples.assign(scaledPoints.saturationKrwPoints().begin(),
+                                scaledPoints.saturationKrwPoints().begin() + numKrPoints);
+            SwKrnSamples.assign(scaledPoints.saturationKrnPoints().begin(),
+                                scaledPoints.saturationKrnPoints().begin() + numKrPoints);
+        }
+
+        for (Scalar Sw : effParams.SwPcwnSamples())
+            SwPcSamples.push_back(EpsLaw::unscaledToScaledSatPc(epsParams, Sw));
+        for (Scalar Sw : effParams.SwKrwSamples())
+            SwKrwSamples.push_back(EpsLaw::unscaledToScaledSatKrw(epsParams, Sw));
+        for (Scalar Sw : effParams.SwKrnSamples())
+            SwKrnSamples.push_back(EpsLaw::unscaledToScaledSatKrn(epsParams, Sw));
+
+        sortSamples_(SwPcSamples);
+        sortSamples_(SwKrwSamples);
+        sortSamples_(SwKrnSamples);
+
+        std::vector<Scalar> pcValues(SwPcSamples.size());
+        std::vector<Scalar> krwValues(SwKrwSamples.size());
+        std::vector<Scalar> krnValues(SwKrnSamples.size());
+        for (size_t i = 0; i < SwPcSamples.size(); ++i)
+            pcValues[i] = EpsLaw::twoPhaseSatPcnw(epsParams, SwPcSamples[i]);
+        for (size_t i = 0; i < SwKrwSamples.size(); ++i)
+            krwValues[i] = EpsLaw::twoPhaseSatKrw(epsParams, SwKrwSamples[i]);
+        for (size_t i = 0; i < SwKrnSamples.size(); ++i)
+            krnValues[i] = EpsLaw::twoPhaseSatKrn(epsParams, SwKrnSamples[i]);
+
+        auto result = std::make_shared<EffParams>();
+        result->setPcnwSamples(SwPcSamples, pcValues);
+        result->setKrwSamples(SwKrwSamples, krwValues);
+        result->setKrnSamples(SwKrnSamples, krnValues);
+        result->finalize();
+        return result;
+    }
+
+    template <class PointsContainer>
+    static bool isStrictlyIncreasing_(const PointsContainer& points, unsigned numPoints)
+    {
+        for (unsigned i = 1; i < numPoints; ++i)
+            if (!(points[i - 1] < points[i]))
+                return false;
+        return true;
+    }
+
+    // sort the sampling points and remove the duplicates
+    static void sortSamples_(std::vector<Scalar>& samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        samples.erase(std::unique(samples.begin(), samples.end()), samples.end());
+    }
+
+    // the estimated number of bytes of a heap block which holds a given number of bytes.
+    // most implementations of malloc() store the size in front of each block and round
+    // the blocks up to a multiple of twice the size of a pointer.
+    static size_t heapBlockSize_(size_t numBytes)
+    {
+        size_t alignment = 2*sizeof(void*);
+        return (numBytes + sizeof(size_t) + alignment - 1)/alignment*alignment;
+    }
+
+    // the estimated overhead of an object which was created by std::make_shared(). the
+    // control block consists of a pointer to its virtual methods and the reference counts.
+    static size_t sharedObjectOverhead_(size_t objectSize)
+    {
+        size_t controlBlockSize = sizeof(void*) + 2*sizeof(int);
+        return heapBlockSize_(controlBlockSize + objectSize) - objectSize;
+    }
+
+    template <class RealParams>
+    void addThreePhaseMemoryUsage_(MemoryUsage& usage,
+                                   std::unordered_set<const void*>& visited,
+                                   const RealParams& realParams,
+                                   bool compact) const
+    {
+        // the parameters of the real law are allocated by the multiplexer using new
+        usage.params += sizeof(RealParams);
+        usage.overhead += heapBlockSize_(sizeof(RealParams)) - sizeof(RealParams);
+
+        addTwoPhaseMemoryUsage_(usage, visited, realParams.gasOilParams(), compact);
+        addTwoPhaseMemoryUsage_(usage, visited, realParams.oilWaterParams(), compact);
+    }
+
+    template <class HystParams>
+    void addTwoPhaseMemoryUsage_(MemoryUsage& usage,
+                                 std::unordered_set<const void*>& visited,
+                                 const HystParams& hystParams,
+                                 bool compact) const
+    {
+        if (!visited.insert(&hystParams).second)
+            return;
+
+        // the drainage parameters are a part of the object, the imbibition parameters
+        // are shared
+        usage.params += sizeof(HystParams);
+        if (!compact)
+            usage.overhead += sharedObjectOverhead_(sizeof(HystParams));
+        addEpsMemoryUsage_(usage, visited, hystParams.drainageParams());
+
+        if (hystParams.hysteresisActive()) {
+            const auto& imbParams = hystParams.imbibitionParams();
+            if (visited.insert(&imbParams).second) {
+                usage.params += sizeof(imbParams);
+                usage.overhead += sharedObjectOverhead_(sizeof(imbParams));
+                addEpsMemoryUsage_(usage, visited, imbParams);
+            }
+        }
+    }
+
+    template <class EpsParams>
+    void addEpsMemoryUsage_(MemoryUsage& usage,
+                            std::unordered_set<const void*>& visited,
+                            const EpsParams& epsParams) const
+    {
+        if (epsParams.hasPrecomputedCurves()) {
+            const auto& curves = epsParams.precomputedCurves();
+            if (visited.insert(&curves).second) {
+                usage.params += sizeof(curves);
+                usage.overhead += sharedObjectOverhead_(sizeof(curves));
+            }
+        }
+
+        // the end points are only set if the parameters are specific for the elements
+        // and the end point scaling is enabled for the curve
+        if (!hasElementSpecificParameters() || !epsParams.hasScalingPoints())
+            return;
+
+        const void* points[2] = { &epsParams.unscaledPoints(), &epsParams.scaledPoints() };
+        for (const void* p : points) {
+            if (!visited.insert(p).second)
+                continue;
+            usage.scalingPoints += sizeof(EclEpsScalingPoints<Scalar>);
+            usage.overhead += sharedObjectOverhead_(sizeof(EclEpsScalingPoints<Scalar>));
+        }
+
+        const auto& coefficients = epsParams.scalingCoefficients();
+        if (visited.insert(&coefficients).second) {
+            usage.scalingPoints += sizeof(coefficients);
+            usage.overhead += sharedObjectOverhead_(sizeof(coefficients));
+        }
+    }
+
+    // calls a functor for the indices of all elements. If OpenMP is enabled, this is done
+    // concurrently, so the functor must not modify any state which is shared between
+    // elements. If the functor throws an exception, the first one is re-thrown.
+    template <class Functor>
+    static void forEachElement_(unsigned numElems, const Functor& functor)
+    {
+#ifdef _OPENMP
+        std::exception_ptr exception;
+        #pragma omp parallel for schedule(static)
+        for (int elemIdx = 0; elemIdx < static_cast<int>(numElems); ++ elemIdx) {
+            try { functor(static_cast<unsigned>(elemIdx)); }
+            catch (...) {
+                #pragma omp critical (OpmEclMaterialLawManagerException)
+                if (!exception)
+                    exception = std::current_exception();
+            }
+        }
+
+        if (exception)
+            std::rethrow_exception(exception);
+#else
+        for (unsigned elemIdx = 0; elemIdx < numElems; ++ elemIdx)
+            functor(elemIdx);
+#endif
+    }
+
+    // allocate the objects for a vector of per-element shared pointers. In compact mode,
+    // all objects are stored in a single contiguous array and the pointers share the
+    // ownership of it, else each object is allocated individually. the name identifies
+    // the file of the array if the memory mapped storage is used.
+    template <class T>
+    void allocateElementObjects_(std::vector<std::shared_ptr<T> >& dest,
+                                 size_t numElems,
+                                 const char* name) const
+    {
+        dest.resize(numElems);
+        if (enableMappedStorage()) {
+            auto storage =
+                std::make_shared<MappedArray_<T> >(mappedStorageFilePrefix_ + name + ".bin",
+                                                   numElems);
+            forEachElement_(numElems, [&](unsigned elemIdx) {
+                dest[elemIdx] = std::shared_ptr<T>(storage, storage->data() + elemIdx);
+            });
+            return;
+        }
+
+        if (enableFirstTouchAllocation()) {
+            if (!enableCompactStorage()) {
+                forEachElement_(numElems, [&](unsigned elemIdx) {
+                    dest[elemIdx] = std::make_shared<T>();
+                });
+                return;
+            }
+
+            auto storage = std::make_shared<FirstTouchArray_<T> >(numElems);
+            forEachElement_(numElems, [&](unsigned elemIdx) {
+                dest[elemIdx] = std::shared_ptr<T>(storage, storage->data() + elemIdx);
+            });
+            return;
+        }
+
+        if (!enableCompactStorage()) {
+            for (size_t elemIdx = 0; elemIdx < numElems; ++elemIdx)
+                dest[elemIdx] = std::make_shared<T>();
+            return;
+        }
+
+        auto storage = std::make_shared<std::vector<T, HugePageAllocator<T> > >(numElems);
+        for (size_t elemIdx = 0; elemIdx < numElems; ++elemIdx)
+            dest[elemIdx] = std::shared_ptr<T>(storage, &(*storage)[elemIdx]);
+    }
+
+    // a contiguous array of objects whose elements are constructed by the threads
+    // which process them in forEachElement_(). the memory is not touched before, so its
+    // pages are placed on the NUMA nodes of these threads.
+    template <class T>
+    class FirstTouchArray_
+    {
+    public:
+        explicit FirstTouchArray_(size_t size)
+            : data_(HugePageAllocator<T>().allocate(size))
+            , size_(size)
+        {
+            std::vector<unsigned char> isConstructed(size, 0);
+            try {
+                forEachElement_(size, [&](unsigned elemIdx) {
+                    new (data_ + elemIdx) T();
+                    isConstructed[elemIdx] = 1;
+                });
+            }
+            catch (...) {
+                for (size_t elemIdx = 0; elemIdx < size; ++elemIdx)
+                    if (isConstructed[elemIdx])
+                        data_[elemIdx].~T();
+                HugePageAllocator<T>().deallocate(data_, size);
+                throw;
+            }
+        }
+
+        ~FirstTouchArray_()
+        {
+            for (size_t elemIdx = 0; elemIdx < size_; ++elemIdx)
+                data_[elemIdx].~T();
+            HugePageAllocator<T>().deallocate(data_, size_);
+        }
+
+        T* data()
+        { return data_; }
+
+    private:
+        FirstTouchArray_(const FirstTouchArray_&) = delete;
+        FirstTouchArray_& operator=(const FirstTouchArray_&) = delete;
+
+        T* data_;
+        size_t size_;
+    };
+
+    // a contiguous array of objects which is stored in a memory mapped file. like for
+    // FirstTouchArray_, the objects are constructed by the threads which process them.
+    template <class T>
+    class MappedArray_
+    {
+    public:
+        MappedArray_(const std::string& fileName, size_t size)
+            : size_(size)
+        {
+            file_.create(fileName, size*sizeof(T));
+            data_ = static_cast<T*>(file_.data());
+
+            std::vector<unsigned char> isConstructed(size, 0);
+            try {
+                forEachElement_(size, [&](unsigned elemIdx) {
+                    new (data_ + elemIdx) T();
+                    isConstructed[elemIdx] = 1;
+                });
+            }
+            catch (...) {
+                for (size_t elemIdx = 0; elemIdx < size; ++elemIdx)
+                    if (isConstructed[elemIdx])
+                        data_[elemIdx].~T();
+                throw;
+            }
+        }
+
+        ~MappedArray_()
+        {
+            for (size_t elemIdx = 0; elemIdx < size_; ++elemIdx)
+                data_[elemIdx].~T();
+        }
+
+        T* data()
+        { return data_; }
+
+    private:
+        MappedArray_(const MappedArray_&) = delete;
+        MappedArray_& operator=(const MappedArray_&) = delete;
+
+        MappedFile file_;
+        T* data_;
+        size_t size_;
+    };
+
+    OilWaterEpsTwoPhaseParams& getOilWaterDrainageParams_(int elemIdx)
     {
         auto& materialParams = *materialLawParams_[elemIdx];
         switch (materialParams.approach()) {
         case EclStone1Approach: {
             auto& realParams = materialParams.template getRealParams<Opm::EclStone1Approach>();
-            return realParams.oilWaterParams().drainageParams().scaledPoints();
+            return realParams.oilWaterParams().drainageParams();
         }
 
         case EclStone2Approach: {
             auto& realParams = materialParams.template getRealParams<Opm::EclStone2Approach>();
-            return realParams.oilWaterParams().drainageParams().scaledPoints();
+            return realParams.oilWaterParams().drainageParams();
         }
 
         case EclDefaultApproach: {
             auto& realParams = materialParams.template getRealParams<Opm::EclDefaultApproach>();
-            return realParams.oilWaterParams().drainageParams().scaledPoints();
+            return realParams.oilWaterParams().drainageParams();
         }
 
         case EclTwoPhaseApproach: {
             auto& realParams = materialParams.template getRealParams<Opm::EclTwoPhaseApproach>();
-            return realParams.oilWaterParams().drainageParams().scaledPoints();
+            return realParams.oilWaterParams().drainageParams();
+        }
+        }
+    }
+
+    // scale the oil-water capillary pressure curve of an element by a factor. the
+    // element gets its own copy of the scaled end points, so this may be called
+    // concurrently for different elements even if they shared their points before.
+    // the cached results of the element are discarded because they are outdated.
+    void scaleOilWaterPc_(unsigned elemIdx, Scalar factor)
+    {
+        invalidateResultCache(elemIdx);
+
+        auto& elemScaledEpsInfo = *oilWaterScaledEpsInfoDrainage_[elemIdx];
+        elemScaledEpsInfo.maxPcow *= factor;
+
+        auto& drainageParams = getOilWaterDrainageParams_(elemIdx);
+        const auto& constDrainageParams = drainageParams;
+        auto points = std::make_shared<EclEpsScalingPoints<Scalar> >(constDrainageParams.scaledPoints());
+        points->init(elemScaledEpsInfo, *oilWaterEclEpsConfig_, Opm::EclOilWaterSystem);
+        drainageParams.setScaledPoints(points);
+
+        // this recomputes the scaling coefficients of the element
+        drainageParams.finalize();
+    }
+
+    // apply SWATINIT to the elements of a three-phase approach. the capillary pressures
+    // of the elements which need them are evaluated in chunks using the batched method
+    // of the three-phase law.
+    template <EclMultiplexerApproach approach, class RealMaterialLaw, class PcContainer, class SatContainer>
+    void applySwatinit_(const PcContainer& pcow, SatContainer& Sw)
+    {
+        typedef typename RealMaterialLaw::Params RealParams;
+
+        const auto& elems = elementsByApproach_[approach];
+        unsigned numChunks = (elems.size() + batchChunkSize_ - 1)/batchChunkSize_;
+        forEachElement_(numChunks, [&](unsigned chunkIdx) {
+            size_t begin = chunkIdx*batchChunkSize_;
+            size_t end = std::min<size_t>(begin + batchChunkSize_, elems.size());
+
+            const RealParams* params[batchChunkSize_];
+            unsigned chunkElems[batchChunkSize_];
+            Scalar chunkSw[batchChunkSize_];
+            Scalar chunkSg[batchChunkSize_];
+            size_t n = 0;
+            for (size_t i = begin; i < end; ++i) {
+                unsigned elemIdx = elems[i];
+                const auto& elemScaledEpsInfo = *oilWaterScaledEpsInfoDrainage_[elemIdx];
+
+                // TODO: Mixed wettability systems - see ecl kw OPTIONS switch 74
+                if (Sw[elemIdx] <= elemScaledEpsInfo.Swl)
+                    Sw[elemIdx] = elemScaledEpsInfo.Swl;
+                else if (pcow[elemIdx] < 0.0)
+                    Sw[elemIdx] = elemScaledEpsInfo.Swu;
+                else {
+                    params[n] = &materialLawParams_[elemIdx]->template getRealParams<approach>();
+                    chunkElems[n] = elemIdx;
+                    chunkSw[n] = Sw[elemIdx];
+                    chunkSg[n] = 0.0;
+                    ++n;
+                }
+            }
+
+            Scalar pcowAtSw[batchChunkSize_];
+            Scalar pcgo[batchChunkSize_];
+            RealMaterialLaw::capillaryPressuresBatch(params, chunkSw, chunkSg, pcowAtSw, pcgo, n);
+            for (size_t i = 0; i < n; ++i) {
+                unsigned elemIdx = chunkElems[i];
+                if (pcowAtSw[i] > 0.0)
+                    scaleOilWaterPc_(elemIdx, pcow[elemIdx]/pcowAtSw[i]);
+            }
+        });
+    }
+
+    // the kernel of saturationFunctionsBatch() which is called for each block of
+    // elements that use the same three-phase approach
+    class SaturationFunctionsKernel_
+    {
+    public:
+        SaturationFunctionsKernel_(const EclMaterialLawManager& manager,
+                                   unsigned quantities,
+                                   const Scalar* Sw,
+                                   const Scalar* Sg,
+                                   Scalar* krw,
+                                   Scalar* kro,
+                                   Scalar* krg,
+                                   Scalar* pcow,
+                                   Scalar* pcgo)
+            : manager_(manager)
+            , quantities_(quantities)
+            , Sw_(Sw), Sg_(Sg)
+            , krw_(krw), kro_(kro), krg_(krg)
+            , pcow_(pcow), pcgo_(pcgo)
+        {}
+
+        // process the chunks of a block concurrently
+        template <EclMultiplexerApproach approach, class RealMaterialLaw>
+        void apply(const std::vector<unsigned>& elems) const
+        {
+            unsigned numChunks = (elems.size() + batchChunkSize_ - 1)/batchChunkSize_;
+            forEachElement_(numChunks, [&](unsigned chunkIdx) {
+                size_t begin = chunkIdx*batchChunkSize_;
+                size_t n = std::min<size_t>(batchChunkSize_, elems.size() - begin);
+                applyToChunk_<approach, RealMaterialLaw>(elems.data() + begin, n);
+            });
+        }
+
+        // process the chunks of a block by the calling thread
+        template <EclMultiplexerApproach approach, class RealMaterialLaw>
+        void applySerial(const unsigned* elems, size_t numElems) const
+        {
+            for (size_t begin = 0; begin < numElems; begin += batchChunkSize_) {
+                size_t n = std::min<size_t>(batchChunkSize_, numElems - begin);
+                applyToChunk_<approach, RealMaterialLaw>(elems + begin, n);
+            }
+        }
+
+    private:
+        template <EclMultiplexerApproach approach, class RealMaterialLaw>
+        typename std::enable_if<approach != EclTwoPhaseApproach>::type
+        applyToChunk_(const unsigned* chunkElems, size_t numElems) const
+        {
+            typedef typename RealMaterialLaw::Params RealParams;
+
+            // the arrays are zeroed because GCC cannot see that all entries which are
+            // read by the batched methods get written
+            const RealParams* params[batchChunkSize_] = {};
+            Scalar chunkSw[batchChunkSize_] = {};
+            Scalar chunkSo[batchChunkSize_] = {};
+            Scalar chunkSg[batchChunkSize_] = {};
+            size_t n = 0;
+            for (size_t i = 0; i < numElems; ++i, ++n) {
+                unsigned elemIdx = chunkElems[i];
+                params[n] = &manager_.template realMaterialLawParams<approach>(elemIdx);
+                chunkSw[n] = Sw_[elemIdx];
+                chunkSg[n] = Sg_[elemIdx];
+                chunkSo[n] = 1 - chunkSw[n] - chunkSg[n];
+            }
+
+            if (quantities_ & RelativePermeabilities) {
+                Scalar chunkKrw[batchChunkSize_];
+                Scalar chunkKro[batchChunkSize_];
+                Scalar chunkKrg[batchChunkSize_];
+                RealMaterialLaw::relativePermeabilitiesBatch(params, chunkSw, chunkSo, chunkSg,
+                                                             chunkKrw, chunkKro, chunkKrg, n);
+                for (size_t i = 0; i < n; ++i) {
+                    unsigned elemIdx = chunkElems[i];
+                    krw_[elemIdx] = chunkKrw[i];
+                    kro_[elemIdx] = chunkKro[i];
+                    krg_[elemIdx] = chunkKrg[i];
+                }
+            }
+
+            if (quantities_ & CapillaryPressures) {
+                Scalar chunkPcow[batchChunkSize_];
+                Scalar chunkPcgo[batchChunkSize_];
+                RealMaterialLaw::capillaryPressuresBatch(params, chunkSw, chunkSg,
+                                                         chunkPcow, chunkPcgo, n);
+                for (size_t i = 0; i < n; ++i) {
+                    unsigned elemIdx = chunkElems[i];
+                    pcow_[elemIdx] = chunkPcow[i];
+                    pcgo_[elemIdx] = chunkPcgo[i];
+                }
+            }
+        }
+
+        // the two-phase law does not provide batched versions of the saturation
+        // functions
+        template <EclMultiplexerApproach approach, class RealMaterialLaw>
+        typename std::enable_if<approach == EclTwoPhaseApproach>::type
+        applyToChunk_(const unsigned* chunkElems, size_t numElems) const
+        {
+            typedef Opm::SimpleModularFluidState<Scalar,
+                                                 numPhases,
+                                                 /*numComponents=*/0,
+                                                 /*FluidSystem=*/void, /* -> don't care */
+                                                 /*storePressure=*/false,
+                                                 /*storeTemperature=*/false,
+                                                 /*storeComposition=*/false,
+                                                 /*storeFugacity=*/false,
+                                                 /*storeSaturation=*/true,
+                                                 /*storeDensity=*/false,
+                                                 /*storeViscosity=*/false,
+                                                 /*storeEnthalpy=*/false> FluidState;
+
+            for (size_t i = 0; i < numElems; ++i) {
+                unsigned elemIdx = chunkElems[i];
+                const auto& params = manager_.template realMaterialLawParams<approach>(elemIdx);
+
+                FluidState fs;
+                fs.setSaturation(waterPhaseIdx, Sw_[elemIdx]);
+                fs.setSaturation(oilPhaseIdx, 1 - Sw_[elemIdx] - Sg_[elemIdx]);
+                fs.setSaturation(gasPhaseIdx, Sg_[elemIdx]);
+
+                // the law only sets the quantities of the phases which it considers
+                Scalar values[numPhases];
+                if (quantities_ & RelativePermeabilities) {
+                    std::fill(values, values + numPhases, 0.0);
+                    RealMaterialLaw::relativePermeabilities(values, params, fs);
+                    krw_[elemIdx] = values[waterPhaseIdx];
+                    kro_[elemIdx] = values[oilPhaseIdx];
+                    krg_[elemIdx] = values[gasPhaseIdx];
+                }
+
+                if (quantities_ & CapillaryPressures) {
+                    std::fill(values, values + numPhases, 0.0);
+                    RealMaterialLaw::capillaryPressures(values, params, fs);
+                    pcow_[elemIdx] = values[oilPhaseIdx] - values[waterPhaseIdx];
+                    pcgo_[elemIdx] = values[gasPhaseIdx] - values[oilPhaseIdx];
+                }
+            }
+        }
+
+        const EclMaterialLawManager& manager_;
+        unsigned quantities_;
+        const Scalar* Sw_;
+        const Scalar* Sg_;
+        Scalar* krw_;
+        Scalar* kro_;
+        Scalar* krg_;
+        Scalar* pcow_;
+        Scalar* pcgo_;
+    };
+
+    // evaluate the saturation functions of the elements of a range which use a given
+    // three-phase approach
+    template <EclMultiplexerApproach approach, class RealMaterialLaw>
+    void saturationFunctionsRange_(const SaturationFunctionsKernel_& kernel,
+                                   unsigned beginElemIdx,
+                                   unsigned endElemIdx) const
+    {
+        const auto& elems = elementsByApproach_[approach];
+        auto first = std::lower_bound(elems.begin(), elems.end(), beginElemIdx);
+        auto last = std::lower_bound(first, elems.end(), endElemIdx);
+        if (first != last)
+            kernel.template applySerial<approach, RealMaterialLaw>(&*first, last - first);
+    }
+
+    // the number of elements of a batch which are processed at once. this limits the
+    // amount of temporary space required on the stack.
+    enum { batchChunkSize_ = 64 };
+
+    // the saturations of the last evaluation of an element and the resulting values
+    // of the saturation functions including their derivatives with respect to the
+    // saturations
+    struct ResultCacheEntry_
+    {
+        enum { krValid = 1, pcValid = 2 };
+
+        ResultCacheEntry_()
+            : valid(0)
+        {}
+
+        Scalar saturation[numPhases];
+        Scalar kr[numPhases];
+        Scalar dkr[numPhases][numPhases];
+        Scalar pc[numPhases];
+        Scalar dpc[numPhases][numPhases];
+        unsigned char valid;
+    };
+
+    // returns the cache entry of an element after making sure that it contains the
+    // requested quantity for the saturations of a fluid state
+    template <class FluidState>
+    const ResultCacheEntry_& updatedResultCacheEntry_(const FluidState& fluidState,
+                                                      int elemIdx,
+                                                      unsigned char quantity) const
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        ResultCacheEntry_& entry = resultCache_[elemIdx];
+
+        bool sameSaturations = (entry.valid != 0);
+        for (int phaseIdx = 0; sameSaturations && phaseIdx < numPhases; ++phaseIdx) {
+            Scalar S = FsToolbox::value(fluidState.saturation(phaseIdx));
+            sameSaturations = std::abs(S - entry.saturation[phaseIdx]) <= resultCacheTolerance_;
         }
+
+        if (sameSaturations && (entry.valid & quantity))
+            return entry;
+
+        if (!sameSaturations) {
+            entry.valid = 0;
+            for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+                entry.saturation[phaseIdx] = FsToolbox::value(fluidState.saturation(phaseIdx));
         }
+
+        const auto& params = materialLawParams(elemIdx);
+        if (quantity == ResultCacheEntry_::krValid)
+            SaturationDerivatives<MaterialLaw>::relativePermeabilitiesAt(entry.kr, entry.dkr,
+                                                                         params, entry.saturation);
+        else
+            SaturationDerivatives<MaterialLaw>::capillaryPressuresAt(entry.pc, entry.dpc,
+                                                                     params, entry.saturation);
+
+        entry.valid |= quantity;
+        return entry;
     }
 
+    InitTimings initTimings_;
+
+    bool enableCompactStorage_;
+    bool enableFirstTouchAllocation_;
+    bool enableMappedStorage_;
+    std::string mappedStorageFilePrefix_;
+    bool enablePrecomputedCurves_;
+    bool enableTableSharing_;
+    unsigned satTableResolution_;
+    Scalar maxKrResamplingError_;
+    Scalar maxPcResamplingError_;
+    Scalar tableSimplificationTolerance_;
+    Scalar maxKrSimplificationError_;
+    Scalar maxPcSimplificationError_;
+    unsigned kroTableResolution_;
+    Scalar maxKroTableError_;
     bool enableEndPointScaling_;
     std::shared_ptr<EclHysteresisConfig> hysteresisConfig_;
 
@@ -952,7 +3315,29 @@ private:
 
     std::vector<int> compressedToCartesianElemIdx_;
     std::vector<int> satnumRegionIdx_;
+    std::vector<int> imbnumRegionIdx_;
+    Opm::CompactRegionIndices usedSatRegions_;
+
+    // the indices of the elements for each three-phase approach
+    std::array<std::vector<unsigned>, 4> elementsByApproach_;
+
+    bool enableResultCache_;
+    Scalar resultCacheTolerance_;
+    mutable std::vector<ResultCacheEntry_> resultCache_;
+    bool enableSaturationDerivatives_;
 };
 } // namespace Opm
 
+// the instantiation which is provided by the library, cf. ExplicitInstantiations.hpp. the
+// phase indices are the ones of the black-oil fluid system.
+#define OPM_ECL_MATERIAL_LAW_MANAGER_INSTANTIATIONS(KEYWORD) \
+    KEYWORD class Opm::EclMaterialLawManager<Opm::ThreePhaseMaterialTraits<double, \
+                                                                           /*wettingPhaseIdx=*/0, \
+                                                                           /*nonWettingPhaseIdx=*/1, \
+                                                                           /*gasPhaseIdx=*/2> >;
+
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+OPM_ECL_MATERIAL_LAW_MANAGER_INSTANTIATIONS(extern template)
+#endif
+
 #endif
@@ -35,6 +35,7 @@
 #include <opm/material/common/MathToolbox.hpp>
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/Instrumentation.hpp>
 
 #include <algorithm>
 
@@ -111,6 +112,26 @@ public:
     //! are dependent on the phase composition
     static const bool isCompositionDependent = false;
 
+    //! The union of the saturation dependencies of the possible three-phase approaches
+    static constexpr unsigned relativePermeabilityDependencies(int phaseIdx)
+    {
+        return
+            Stone1Material::relativePermeabilityDependencies(phaseIdx)
+            | Stone2Material::relativePermeabilityDependencies(phaseIdx)
+            | DefaultMaterial::relativePermeabilityDependencies(phaseIdx)
+            | TwoPhaseMaterial::relativePermeabilityDependencies(phaseIdx);
+    }
+
+    //! \copydoc relativePermeabilityDependencies
+    static constexpr unsigned capillaryPressureDependencies(int phaseIdx)
+    {
+        return
+            Stone1Material::capillaryPressureDependencies(phaseIdx)
+            | Stone2Material::capillaryPressureDependencies(phaseIdx)
+            | DefaultMaterial::capillaryPressureDependencies(phaseIdx)
+            | TwoPhaseMaterial::capillaryPressureDependencies(phaseIdx);
+    }
+
     /*!
      * \brief Implements the multiplexer three phase capillary pressure law
      *        used by the ECLipse simulator.
@@ -130,6 +151,7 @@ public:
                                    const Params &params,
                                    const FluidState &fluidState)
     {
+        OPM_INSTRUMENT_SCOPE("EclMultiplexerMaterial::capillaryPressures");
         switch (params.approach()) {
         case EclStone1Approach:
             Stone1Material::capillaryPressures(values,
@@ -250,6 +272,7 @@ public:
                                        const Params &params,
                                        const FluidState &fluidState)
     {
+        OPM_INSTRUMENT_SCOPE("EclMultiplexerMaterial::relativePermeabilities");
         switch (params.approach()) {
         case EclStone1Approach:
             Stone1Material::relativePermeabilities(values,
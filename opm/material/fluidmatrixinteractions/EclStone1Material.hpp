@@ -118,6 +118,21 @@ public:
     //! are dependent on the phase composition
     static const bool isCompositionDependent = false;
 
+    /*!
+     * \brief The relative permeabilities of water and gas only depend on the respective
+     *        saturation, the one of oil on all three saturations.
+     */
+    static constexpr unsigned relativePermeabilityDependencies(int phaseIdx)
+    {
+        return
+            (phaseIdx == oilPhaseIdx) ? ((1u << waterPhaseIdx) | (1u << oilPhaseIdx) | (1u << gasPhaseIdx))
+            : (1u << phaseIdx);
+    }
+
+    //! The capillary pressures of water and gas only depend on the respective saturation
+    static constexpr unsigned capillaryPressureDependencies(int phaseIdx)
+    { return (phaseIdx == oilPhaseIdx) ? 0u : (1u << phaseIdx); }
+
     /*!
      * \brief Implements the default three phase capillary pressure law
      *        used by the ECLipse simulator.
@@ -305,6 +320,12 @@ public:
         const Evaluation& So = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(oilPhaseIdx));
         const Evaluation& Sg = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
 
+        // if the oil relative permeability has been tabulated, a single lookup
+        // replaces the combination of the two-phase curves
+        const auto* kroTable = params.kroTable();
+        if (kroTable && kroTable->applies(Toolbox::value(Sw), Toolbox::value(Sg)))
+            return kroTable->eval(Sw, Sg);
+
         Evaluation SSw;
         if (Sw > Swco)
             SSw = (Sw - Swco)/(1 - Swco - Som);
@@ -327,6 +348,121 @@ public:
         return beta*krow*krog/krocw;
     }
 
+    /*!
+     * \brief Evaluate the relative permeabilities of all phases for a batch of cells.
+     *
+     * The saturations and the results are passed in structure-of-arrays layout,
+     * i.e., each quantity is a contiguous array with one entry per cell. The batch is
+     * processed in two passes per chunk of cells: The first pass only performs the
+     * lookups in the two-phase saturation functions, the second one combines the
+     * results using straight-line arithmetic which can be vectorized by the compiler.
+     *
+     * The results are identical to the ones of relativePermeabilities() for scalar
+     * saturations.
+     *
+     * \param params An array of n pointers to the parameter objects of the cells
+     * \param Sw The array of water saturations
+     * \param So The array of oil saturations
+     * \param Sg The array of gas saturations
+     * \param krw The array in which the relative permeabilities of water are stored
+     * \param kro The array in which the relative permeabilities of oil are stored
+     * \param krg The array in which the relative permeabilities of gas are stored
+     * \param n The number of cells of the batch
+     */
+    static void relativePermeabilitiesBatch(const Params* const* params,
+                                            const Scalar* Sw,
+                                            const Scalar* So,
+                                            const Scalar* Sg,
+                                            Scalar* krw,
+                                            Scalar* kro,
+                                            Scalar* krg,
+                                            size_t n)
+    {
+        Scalar Swco[batchChunkSize_];
+        Scalar Som[batchChunkSize_];
+        Scalar eta[batchChunkSize_];
+        Scalar krocw[batchChunkSize_];
+        Scalar krow[batchChunkSize_];
+        Scalar krog[batchChunkSize_];
+        Scalar tabulatedKro[batchChunkSize_];
+        bool useKroTable[batchChunkSize_];
+        for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += batchChunkSize_) {
+            size_t chunkSize = std::min<size_t>(batchChunkSize_, n - chunkBegin);
+            const Params* const* paramsChunk = params + chunkBegin;
+            const Scalar* SwChunk = Sw + chunkBegin;
+            const Scalar* SoChunk = So + chunkBegin;
+            const Scalar* SgChunk = Sg + chunkBegin;
+            Scalar* krwChunk = krw + chunkBegin;
+            Scalar* kroChunk = kro + chunkBegin;
+            Scalar* krgChunk = krg + chunkBegin;
+
+            // pass 1: lookups in the two-phase curves
+            for (size_t i = 0; i < chunkSize; ++i) {
+                const Params& p = *paramsChunk[i];
+                Swco[i] = p.Swl();
+                Som[i] = std::min(p.Sowcr(), p.Sogcr());
+                eta[i] = p.eta();
+
+                krwChunk[i] = OilWaterMaterialLaw::twoPhaseSatKrw(p.oilWaterParams(), SwChunk[i]);
+                krgChunk[i] = GasOilMaterialLaw::twoPhaseSatKrn(p.gasOilParams(), 1 - SgChunk[i]);
+
+                const auto* kroTable = p.kroTable();
+                useKroTable[i] = kroTable && kroTable->applies(SwChunk[i], SgChunk[i]);
+                if (useKroTable[i]) {
+                    tabulatedKro[i] = kroTable->eval(SwChunk[i], SgChunk[i]);
+                    krocw[i] = 1.0;
+                    krow[i] = krog[i] = 0.0;
+                    continue;
+                }
+
+                krocw[i] = OilWaterMaterialLaw::twoPhaseSatKrn(p.oilWaterParams(), Swco[i]);
+                krow[i] = OilWaterMaterialLaw::twoPhaseSatKrn(p.oilWaterParams(), SwChunk[i]);
+                krog[i] = GasOilMaterialLaw::twoPhaseSatKrw(p.gasOilParams(), 1 - SgChunk[i]);
+            }
+
+            // pass 2: combine the oil relative permeabilities
+            for (size_t i = 0; i < chunkSize; ++i) {
+                Scalar denom = 1 - Swco[i] - Som[i];
+                Scalar SSw = (SwChunk[i] > Swco[i]) ? (SwChunk[i] - Swco[i])/denom : 0.0;
+                Scalar SSo = (SoChunk[i] > Som[i]) ? (SoChunk[i] - Som[i])/denom : 0.0;
+                Scalar SSg = SgChunk[i]/denom;
+
+                Scalar beta = std::pow(SSo/((1 - SSw)*(1 - SSg)), eta[i]);
+                Scalar combinedKro = beta*krow[i]*krog[i]/krocw[i];
+                kroChunk[i] = useKroTable[i] ? tabulatedKro[i] : combinedKro;
+            }
+        }
+    }
+
+    /*!
+     * \brief Evaluate the capillary pressures for a batch of cells.
+     *
+     * The saturations and the results are passed in structure-of-arrays layout. In
+     * contrast to capillaryPressures(), the results are the differences of the
+     * pressures of the oil phase and the water phase and of the gas phase and the oil
+     * phase, i.e., \f$p_{c,ow} = p_o - p_w\f$ and \f$p_{c,go} = p_g - p_o\f$.
+     *
+     * \param params An array of n pointers to the parameter objects of the cells
+     * \param Sw The array of water saturations
+     * \param Sg The array of gas saturations
+     * \param pcow The array in which the oil-water capillary pressures are stored
+     * \param pcgo The array in which the gas-oil capillary pressures are stored
+     * \param n The number of cells of the batch
+     */
+    static void capillaryPressuresBatch(const Params* const* params,
+                                        const Scalar* Sw,
+                                        const Scalar* Sg,
+                                        Scalar* pcow,
+                                        Scalar* pcgo,
+                                        size_t n)
+    {
+        for (size_t i = 0; i < n; ++i) {
+            const Params& p = *params[i];
+            pcow[i] = OilWaterMaterialLaw::twoPhaseSatPcnw(p.oilWaterParams(), Sw[i]);
+            pcgo[i] = GasOilMaterialLaw::twoPhaseSatPcnw(p.gasOilParams(), 1 - Sg[i]);
+        }
+    }
+
     /*!
      * \brief Update the hysteresis parameters after a time step.
      *
@@ -345,6 +481,10 @@ public:
         params.oilWaterParams().update(/*pcSw=*/Sw, /*krwSw=*/Sw, /*krnSw=*/Sw);
         params.gasOilParams().update(/*pcSw=*/1 - Sg, /*krwSw=*/1 - Sg, /*krnSw=*/1 - Sg);
     }
+private:
+    // the number of cells of a batch which are processed at once. this limits the
+    // amount of temporary space required on the stack.
+    enum { batchChunkSize_ = 64 };
 };
 } // namespace Opm
 
@@ -25,6 +25,8 @@
 #ifndef OPM_ECL_STONE1_MATERIAL_PARAMS_HPP
 #define OPM_ECL_STONE1_MATERIAL_PARAMS_HPP
 
+#include <opm/material/common/UniformTabulated2DFunction.hpp>
+
 #include <type_traits>
 #include <cassert>
 #include <memory>
@@ -48,6 +50,7 @@ class EclStone1MaterialParams
 public:
     typedef GasOilParamsT GasOilParams;
     typedef OilWaterParamsT OilWaterParams;
+    typedef Opm::UniformTabulated2DFunction<Scalar> KroTable;
 
     /*!
      * \brief The default constructor.
@@ -161,6 +164,24 @@ public:
     Scalar eta() const
     { assertFinalized_(); return eta_; }
 
+    /*!
+     * \brief Set a table of the oil relative permeability.
+     *
+     * The table maps the water and gas saturations to the three-phase oil relative
+     * permeability. If it is set, the material law uses it instead of combining the
+     * two-phase curves for all saturations within the table's range. Since the
+     * table does not depend on the oil saturation, this assumes that it is
+     * 1 - Sw - Sg. Passing an empty pointer removes the table.
+     */
+    void setKroTable(std::shared_ptr<const KroTable> val)
+    { kroTable_ = val; }
+
+    /*!
+     * \brief Returns the table of the oil relative permeability or 0 if none is set.
+     */
+    const KroTable* kroTable() const
+    { return kroTable_.get(); }
+
 private:
 #ifndef NDEBUG
     void assertFinalized_() const
@@ -179,6 +200,8 @@ private:
     Scalar Sowcr_;
     Scalar Sogcr_;
     Scalar eta_;
+
+    std::shared_ptr<const KroTable> kroTable_;
 };
 } // namespace Opm
 
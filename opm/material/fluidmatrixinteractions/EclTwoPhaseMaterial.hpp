@@ -106,6 +106,29 @@ public:
     //! are dependent on the phase composition
     static const bool isCompositionDependent = false;
 
+    /*!
+     * \brief The saturations which the relative permeabilities may depend on for any
+     *        of the two-phase approaches.
+     *
+     * The gas-oil approach uses the oil saturation, the oil-water and the gas-water
+     * approaches use the water saturation.
+     */
+    static constexpr unsigned relativePermeabilityDependencies(int phaseIdx)
+    {
+        return
+            (phaseIdx == waterPhaseIdx) ? (1u << waterPhaseIdx)
+            : ((1u << waterPhaseIdx) | (1u << oilPhaseIdx));
+    }
+
+    //! \copydoc relativePermeabilityDependencies
+    static constexpr unsigned capillaryPressureDependencies(int phaseIdx)
+    {
+        return
+            (phaseIdx == waterPhaseIdx) ? 0u
+            : (phaseIdx == oilPhaseIdx) ? (1u << waterPhaseIdx)
+            : ((1u << waterPhaseIdx) | (1u << oilPhaseIdx));
+    }
+
     /*!
      * \brief Implements the multiplexer three phase capillary pressure law
      *        used by the ECLipse simulator.
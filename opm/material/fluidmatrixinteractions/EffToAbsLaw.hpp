@@ -28,6 +28,9 @@
 #include "EffToAbsLawParams.hpp"
 
 #include <opm/material/fluidstates/SaturationOverlayFluidState.hpp>
+#include <opm/material/common/Instrumentation.hpp>
+
+#include <algorithm>
 
 namespace Opm {
 /*!
@@ -101,6 +104,14 @@ public:
     //! are dependent on the phase composition
     static const bool isCompositionDependent = EffLaw::isCompositionDependent;
 
+    //! The effective saturation of each phase only depends on its absolute saturation
+    static constexpr unsigned relativePermeabilityDependencies(int phaseIdx)
+    { return EffLaw::relativePermeabilityDependencies(phaseIdx); }
+
+    //! \copydoc relativePermeabilityDependencies
+    static constexpr unsigned capillaryPressureDependencies(int phaseIdx)
+    { return EffLaw::capillaryPressureDependencies(phaseIdx); }
+
     /*!
      * \brief The capillary pressure-saturation curves depending on absolute saturations.
      *
@@ -114,6 +125,7 @@ public:
     template <class Container, class FluidState>
     static void capillaryPressures(Container &values, const Params &params, const FluidState &fs)
     {
+        OPM_INSTRUMENT_SCOPE("EffToAbsLaw::capillaryPressures");
         typedef Opm::SaturationOverlayFluidState<FluidState> OverlayFluidState;
 
         OverlayFluidState overlayFs(fs);
@@ -140,6 +152,7 @@ public:
     template <class Container, class FluidState>
     static void relativePermeabilities(Container &values, const Params &params, const FluidState &fs)
     {
+        OPM_INSTRUMENT_SCOPE("EffToAbsLaw::relativePermeabilities");
         typedef Opm::SaturationOverlayFluidState<FluidState> OverlayFluidState;
 
         OverlayFluidState overlayFs(fs);
@@ -292,7 +305,7 @@ public:
     template <class Evaluation>
     static typename std::enable_if<implementsTwoPhaseSatApi, Evaluation>::type
     twoPhaseSatKrw(const Params &params, const Evaluation& Sw)
-    { return EffLaw::twoPhaseSatKrw(params, effectiveSaturation(params, Sw, Traits::nonWettingPhaseIdx)); }
+    { return EffLaw::twoPhaseSatKrw(params, effectiveSaturation(params, Sw, Traits::wettingPhaseIdx)); }
 
     /*!
      * \brief The relative permeability of the non-wetting phase.
@@ -320,7 +333,7 @@ public:
     template <class Evaluation>
     static typename std::enable_if<implementsTwoPhaseSatApi, Evaluation>::type
     twoPhaseSatKrn(const Params &params, const Evaluation& Sw)
-    { return EffLaw::twoPhaseSatKrn(params, effectiveSaturation(params, Sw, Traits::nonWettingPhaseIdx)); }
+    { return EffLaw::twoPhaseSatKrn(params, effectiveSaturation(params, Sw, Traits::wettingPhaseIdx)); }
 
     /*!
      * \brief The relative permability of the gas phase
@@ -348,12 +361,88 @@ public:
         return EffLaw::template krg<OverlayFluidState, Evaluation>(params, overlayFs);
     }
 
+    /*!
+     * \brief Evaluate the relative permeabilities of both phases for a batch of
+     *        cells.
+     *
+     * The saturations and the results are passed in structure-of-arrays layout,
+     * i.e., each quantity is a contiguous array with one entry per cell. For each
+     * chunk of cells, the conversion to effective saturations is done in a separate
+     * pass which can be vectorized by the compiler. This method is only available if
+     * the effective law implements the two-phase saturation API.
+     *
+     * \param params An array of n pointers to the parameter objects of the cells
+     * \param Sw The array of absolute saturations of the wetting phase
+     * \param krw The array in which the relative permeabilities of the wetting phase
+     *            are stored
+     * \param krn The array in which the relative permeabilities of the non-wetting
+     *            phase are stored
+     * \param n The number of cells of the batch
+     */
+    static void relativePermeabilitiesBatch(const Params* const* params,
+                                            const Scalar* Sw,
+                                            Scalar* krw,
+                                            Scalar* krn,
+                                            size_t n)
+    {
+        OPM_INSTRUMENT_SCOPE("EffToAbsLaw::relativePermeabilitiesBatch");
+        static_assert(implementsTwoPhaseSatApi,
+                      "The batched API requires the effective law to implement the "
+                      "two-phase saturation API");
+
+        Scalar SwEff[batchChunkSize_];
+        for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += batchChunkSize_) {
+            size_t chunkSize = std::min<size_t>(batchChunkSize_, n - chunkBegin);
+            const Params* const* paramsChunk = params + chunkBegin;
+
+            effectiveSaturationsBatch_(paramsChunk, Sw + chunkBegin, SwEff, chunkSize);
+
+            for (size_t i = 0; i < chunkSize; ++i) {
+                krw[chunkBegin + i] = EffLaw::twoPhaseSatKrw(*paramsChunk[i], SwEff[i]);
+                krn[chunkBegin + i] = EffLaw::twoPhaseSatKrn(*paramsChunk[i], SwEff[i]);
+            }
+        }
+    }
+
+    /*!
+     * \brief Evaluate the capillary pressure for a batch of cells.
+     *
+     * This is the batched version of twoPhaseSatPcnw(), see
+     * relativePermeabilitiesBatch().
+     *
+     * \param params An array of n pointers to the parameter objects of the cells
+     * \param Sw The array of absolute saturations of the wetting phase
+     * \param pcnw The array in which the capillary pressures are stored
+     * \param n The number of cells of the batch
+     */
+    static void capillaryPressuresBatch(const Params* const* params,
+                                        const Scalar* Sw,
+                                        Scalar* pcnw,
+                                        size_t n)
+    {
+        OPM_INSTRUMENT_SCOPE("EffToAbsLaw::capillaryPressuresBatch");
+        static_assert(implementsTwoPhaseSatApi,
+                      "The batched API requires the effective law to implement the "
+                      "two-phase saturation API");
+
+        Scalar SwEff[batchChunkSize_];
+        for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += batchChunkSize_) {
+            size_t chunkSize = std::min<size_t>(batchChunkSize_, n - chunkBegin);
+            const Params* const* paramsChunk = params + chunkBegin;
+
+            effectiveSaturationsBatch_(paramsChunk, Sw + chunkBegin, SwEff, chunkSize);
+
+            for (size_t i = 0; i < chunkSize; ++i)
+                pcnw[chunkBegin + i] = EffLaw::twoPhaseSatPcnw(*paramsChunk[i], SwEff[i]);
+        }
+    }
+
     /*!
      * \brief Convert an absolute saturation to an effective one.
      */
     template <class Evaluation>
     static Evaluation effectiveSaturation(const Params &params, const Evaluation& S, int phaseIdx)
-    { return (S - params.residualSaturation(phaseIdx))/(1.0 - params.sumResidualSaturations()); }
+    { return S*params.effectiveSaturationScale() + params.effectiveSaturationOffset(phaseIdx); }
 
     /*!
      * \brief Convert an effective saturation to an absolute one.
@@ -363,6 +452,19 @@ public:
     { return S*(1.0 - params.sumResidualSaturations()) + params.residualSaturation(phaseIdx); }
 
 private:
+    enum { batchChunkSize_ = 64 };
+
+    static void effectiveSaturationsBatch_(const Params* const* params,
+                                           const Scalar* Sw,
+                                           Scalar* SwEff,
+                                           size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            SwEff[i] =
+                Sw[i]*params[i]->effectiveSaturationScale()
+                + params[i]->effectiveSaturationOffset(Traits::wettingPhaseIdx);
+    }
+
     /*!
      * \brief           Derivative of the effective saturation w.r.t. the absolute saturation.
      *
@@ -372,7 +474,7 @@ private:
      * \return          Derivative of the effective saturation w.r.t. the absolute saturation.
      */
     static Scalar dSeff_dSabs_(const Params &params, int phaseIdx)
-    { return 1.0/(1 - params.sumResidualSaturations()); }
+    { return params.effectiveSaturationScale(); }
 
     /*!
      * \brief           Derivative of the absolute saturation w.r.t. the effective saturation.
@@ -66,6 +66,12 @@ public:
         for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
             sumResidualSaturations_ += residualSaturation_[phaseIdx];
 
+        // S_eff = (S - S_r)/(1 - sum S_r) = S*scale + offset
+        effectiveSaturationScale_ = 1.0/(1.0 - sumResidualSaturations_);
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            effectiveSaturationOffset_[phaseIdx] =
+                -residualSaturation_[phaseIdx]*effectiveSaturationScale_;
+
         EffLawParams::finalize();
 
 #ifndef NDEBUG
@@ -85,6 +91,24 @@ public:
     Scalar sumResidualSaturations() const
     { assertFinalized_(); return sumResidualSaturations_; }
 
+    /*!
+     * \brief Return the factor by which an absolute saturation must be multiplied
+     *        to get the effective one.
+     *
+     * This is \f$1/(1 - \sum_\alpha S_{r,\alpha})\f$.
+     */
+    Scalar effectiveSaturationScale() const
+    { assertFinalized_(); return effectiveSaturationScale_; }
+
+    /*!
+     * \brief Return the offset which must be added to the scaled absolute
+     *        saturation of a phase to get the effective one.
+     *
+     * This is \f$-S_{r,\alpha}/(1 - \sum_\beta S_{r,\beta})\f$.
+     */
+    Scalar effectiveSaturationOffset(int phaseIdx) const
+    { assertFinalized_(); return effectiveSaturationOffset_[phaseIdx]; }
+
     /*!
      * \brief Set the residual saturation of a phase.
      */
@@ -104,6 +128,8 @@ private:
 
     Scalar residualSaturation_[numPhases];
     Scalar sumResidualSaturations_;
+    Scalar effectiveSaturationScale_;
+    Scalar effectiveSaturationOffset_[numPhases];
 };
 
 } // namespace Opm
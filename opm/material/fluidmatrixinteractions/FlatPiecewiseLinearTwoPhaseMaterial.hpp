@@ -0,0 +1,96 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::FlatPiecewiseLinearTwoPhaseParams
+ */
+#ifndef OPM_FLAT_PIECEWISE_LINEAR_TWO_PHASE_MATERIAL_HPP
+#define OPM_FLAT_PIECEWISE_LINEAR_TWO_PHASE_MATERIAL_HPP
+
+#include <opm/material/common/FlatTables.hpp>
+
+namespace Opm {
+/*!
+ * \ingroup FluidMatrixInteractions
+ *
+ * \brief A pointer-free copy of the parameters of PiecewiseLinearTwoPhaseMaterial.
+ *
+ * The curves are stored in a FlatTableBuffer, so the parameters of all saturation
+ * regions can be copied to an accelerator at once and be evaluated there using
+ * flatPiecewiseLinearTwoPhaseEval().
+ */
+struct FlatPiecewiseLinearTwoPhaseParams
+{
+    //! The capillary pressure over the wetting phase saturation
+    FlatTable1D pcnw;
+
+    //! The relative permeability of the wetting phase over its saturation
+    FlatTable1D krw;
+
+    //! The relative permeability of the non-wetting phase over the wetting phase
+    //! saturation
+    FlatTable1D krn;
+};
+
+/*!
+ * \brief Append the curves of a finalized PiecewiseLinearTwoPhaseMaterialParams object
+ *        to a buffer.
+ */
+template <class Params, class Scalar>
+FlatPiecewiseLinearTwoPhaseParams flattenPiecewiseLinearTwoPhaseParams(const Params& params,
+                                                                       FlatTableBuffer<Scalar>& buffer)
+{
+    FlatPiecewiseLinearTwoPhaseParams result;
+    result.pcnw = buffer.addTable(params.SwPcwnSamples(), params.pcnwSamples());
+    result.krw = buffer.addTable(params.SwKrwSamples(), params.krwSamples());
+    result.krn = buffer.addTable(params.SwKrnSamples(), params.krnSamples());
+    return result;
+}
+
+/*!
+ * \brief Evaluate the capillary pressure and the relative permeabilities of a flat copy
+ *        of PiecewiseLinearTwoPhaseMaterial together with their derivatives with
+ *        regard to the wetting phase saturation.
+ *
+ * Like PiecewiseLinearTwoPhaseMaterial, the curves are kept constant outside of the
+ * range of their sampling points.
+ *
+ * \param tables The view on the buffer or on a copy of it
+ * \param params The parameters of the saturation region
+ * \param Sw The saturation of the wetting phase
+ * \param values Receives the capillary pressure, krw and krn, in this order
+ * \param dSw Receives the derivatives of the values
+ */
+template <class Scalar>
+OPM_HOST_DEVICE inline void flatPiecewiseLinearTwoPhaseEval(const FlatTableView<Scalar>& tables,
+                                                            const FlatPiecewiseLinearTwoPhaseParams& params,
+                                                            Scalar Sw,
+                                                            Scalar* values,
+                                                            Scalar* dSw)
+{
+    values[0] = tables.eval(params.pcnw, Sw, /*extrapolate=*/false, dSw[0]);
+    values[1] = tables.eval(params.krw, Sw, /*extrapolate=*/false, dSw[1]);
+    values[2] = tables.eval(params.krn, Sw, /*extrapolate=*/false, dSw[2]);
+}
+
+} // namespace Opm
+
+#endif
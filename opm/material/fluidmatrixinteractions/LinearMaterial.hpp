@@ -82,6 +82,14 @@ public:
     //! are dependent on the phase composition
     static const bool isCompositionDependent = false;
 
+    //! The quantities of each phase only depend on its own saturation
+    static constexpr unsigned relativePermeabilityDependencies(int phaseIdx)
+    { return 1u << phaseIdx; }
+
+    //! \copydoc relativePermeabilityDependencies
+    static constexpr unsigned capillaryPressureDependencies(int phaseIdx)
+    { return 1u << phaseIdx; }
+
     /*!
      * \brief The linear capillary pressure-saturation curve.
      *
@@ -46,6 +46,32 @@ public:
 
     //! The number of fluid phases
     static const int numPhases = numPhasesV;
+
+    /*!
+     * \brief Returns the phases whose saturations the relative permeability of a
+     *        phase may depend on.
+     *
+     * Bit i of the result is set if the relative permeability of the phase
+     * 'phaseIdx' may depend on the saturation of the fluid state's phase i. This
+     * allows the users of a material law to leave out the derivatives which are
+     * structurally zero. The default is to assume that it depends on all
+     * saturations, material laws which know better override this method. Whether
+     * the quantities of a law depend on anything else is specified by its
+     * isPressureDependent, isTemperatureDependent and isCompositionDependent
+     * attributes.
+     */
+    static constexpr unsigned relativePermeabilityDependencies(int /*phaseIdx*/)
+    { return (1u << numPhases) - 1; }
+
+    /*!
+     * \brief Returns the phases whose saturations the capillary pressure of a phase
+     *        may depend on.
+     *
+     * This is the analogon of relativePermeabilityDependencies() for the values
+     * which are computed by the capillaryPressures() method of a material law.
+     */
+    static constexpr unsigned capillaryPressureDependencies(int /*phaseIdx*/)
+    { return (1u << numPhases) - 1; }
 };
 
 /*!
@@ -69,6 +95,14 @@ public:
     //! The index of the non-wetting phase
     static const int nonWettingPhaseIdx = nonWettingPhaseIdxV;
 
+    //! \copydoc NullMaterialTraits::relativePermeabilityDependencies
+    static constexpr unsigned relativePermeabilityDependencies(int /*phaseIdx*/)
+    { return (1u << numPhases) - 1; }
+
+    //! \copydoc NullMaterialTraits::capillaryPressureDependencies
+    static constexpr unsigned capillaryPressureDependencies(int /*phaseIdx*/)
+    { return (1u << numPhases) - 1; }
+
     // some safety checks...
     static_assert(wettingPhaseIdx != nonWettingPhaseIdx,
                   "wettingPhaseIdx and nonWettingPhaseIdx must be different");
@@ -98,6 +132,14 @@ public:
     //! The index of the gas phase (i.e., the least wetting phase)
     static const int gasPhaseIdx = gasPhaseIdxV;
 
+    //! \copydoc NullMaterialTraits::relativePermeabilityDependencies
+    static constexpr unsigned relativePermeabilityDependencies(int /*phaseIdx*/)
+    { return (1u << numPhases) - 1; }
+
+    //! \copydoc NullMaterialTraits::capillaryPressureDependencies
+    static constexpr unsigned capillaryPressureDependencies(int /*phaseIdx*/)
+    { return (1u << numPhases) - 1; }
+
     // some safety checks...
     static_assert(0 <= wettingPhaseIdx && wettingPhaseIdx < numPhases,
                   "wettingPhaseIdx is out of range");
@@ -79,6 +79,14 @@ public:
     //! are dependent on the phase composition
     static const bool isCompositionDependent = false;
 
+    //! The relative permeability of each phase only depends on its own saturation
+    static constexpr unsigned relativePermeabilityDependencies(int phaseIdx)
+    { return 1u << phaseIdx; }
+
+    //! The capillary pressures are always zero
+    static constexpr unsigned capillaryPressureDependencies(int /*phaseIdx*/)
+    { return 0u; }
+
     /*!
      * \brief Returns constant 0 for all phases.
      *
@@ -35,199 +35,6 @@
 
 namespace Opm {
 
-/*!
- * \brief Represents a scanning curve in the Parker-Lenhard hysteresis model.
- *
- * The class has pointers to the scanning curves
- * with higher and lower loop number, this saving
- * the history of the imbibitions and drainages.
- */
-template <class ScalarT>
-class PLScanningCurve
-{
-public:
-    typedef ScalarT Scalar;
-
-    /*!
-     * \brief Constructs main imbibition curve.
-     *
-     * Further scanning curves can be added with
-     * setNext.
-     */
-    PLScanningCurve(Scalar Swr)
-    {
-        loopNum_ = 0;
-        prev_ = new PLScanningCurve(NULL, // prev
-                                    this, // next
-                                    -1, // loop number
-                                    Swr, // Sw
-                                    1e12, // pcnw
-                                    Swr, // SwMic
-                                    Swr); // SwMdc
-        next_ = NULL;
-
-        Sw_ = 1.0;
-        pcnw_ = 0.0;
-        SwMic_ = 1.0;
-        SwMdc_ = 1.0;
-    }
-
-protected:
-    PLScanningCurve(PLScanningCurve *prev,
-                    PLScanningCurve *next,
-                    int loopN,
-                    Scalar Sw,
-                    Scalar pcnw,
-                    Scalar SwMic,
-                    Scalar SwMdc)
-    {
-        prev_ = prev;
-        next_ = next;
-        loopNum_ = loopN;
-        Sw_ = Sw;
-        pcnw_ = pcnw;
-        SwMic_ = SwMic;
-        SwMdc_ = SwMdc;
-    }
-
-public:
-    /*!
-     * \brief Destructor. After it was called
-     *        all references to the next() curve are
-     *        invalid!
-     */
-    ~PLScanningCurve()
-    {
-        if (loopNum_ == 0)
-            delete prev_;
-        if (loopNum_ >= 0)
-            delete next_;
-    }
-
-    /*!
-     * \brief Return the previous scanning curve, i.e. the curve
-     *        with one less reversal than the current one.
-     */
-    PLScanningCurve *prev() const
-    { return prev_; }
-
-    /*!
-     * \brief Return the next scanning curve, i.e. the curve
-     *        with one more reversal than the current one.
-     */
-    PLScanningCurve *next() const
-    { return next_; }
-
-    /*!
-     * \brief Set the next scanning curve.
-     *
-     * Next in the sense of the number of reversals
-     * from imbibition to drainage or vince versa. If this
-     * curve already has a list of next curves, it is
-     * deleted and thus forgotten.
-     */
-    void setNext(Scalar Sw,
-                 Scalar pcnw,
-                 Scalar SwMic,
-                 Scalar SwMdc)
-    {
-        // if next_ is NULL, delete does nothing, so
-        // this is valid!!
-        delete next_;
-
-        next_ = new PLScanningCurve(this, // prev
-                                    NULL, // next
-                                    loopNum() + 1,
-                                    Sw,
-                                    pcnw,
-                                    SwMic,
-                                    SwMdc);
-    }
-
-    /*!
-     * \brief Returns true iff the given effective saturation
-     *        Swei is within the scope of the curve, i.e.
-     *        whether Swei is part of the curve's
-     *        domain and the curve thus applies to Swi.
-     */
-    bool isValidAt_Sw(Scalar Sw)
-    {
-        if (isImbib())
-            // for inbibition the given saturation
-            // must be between the start of the
-            // current imbibition and the the start
-            // of the last drainage
-            return this->Sw() < Sw && Sw < prev_->Sw();
-        else
-            // for drainage the given saturation
-            // must be between the start of the
-            // last imbibition and the start
-            // of the current drainage
-            return prev_->Sw() < Sw && Sw < this->Sw();
-    }
-
-    /*!
-     * \brief Returns true iff the scanning curve is a
-     *        imbibition curve.
-     */
-    bool isImbib()
-    { return loopNum()%2 == 1; }
-
-    /*!
-     * \brief Returns true iff the scanning curve is a
-     *        drainage curve.
-     */
-    bool isDrain()
-    { return !isImbib(); }
-
-    /*!
-     * \brief The loop number of the scanning curve.
-     *
-     * The MDC is 0, PISC is 1, PDSC is 2, ...
-     */
-    int loopNum()
-    { return loopNum_; }
-
-    /*!
-     * \brief Absolute wetting-phase saturation at the
-     *        scanning curve's reversal point.
-     */
-    Scalar Sw() const
-    { return Sw_; }
-
-    /*!
-     * \brief Capillary pressure at the last reversal point.
-     */
-    Scalar pcnw() const
-    { return pcnw_; }
-
-    /*!
-     * \brief Apparent saturation of the last reversal point on
-     *        the pressure MIC.
-     */
-    Scalar SwMic()
-    { return SwMic_; }
-
-    /*!
-     * \brief Apparent saturation of the last reversal point on
-     *        the pressure MDC.
-     */
-    Scalar SwMdc()
-    { return SwMdc_; }
-
-private:
-    PLScanningCurve *prev_;
-    PLScanningCurve *next_;
-
-    int loopNum_;
-
-    Scalar Sw_;
-    Scalar pcnw_;
-
-    Scalar SwMdc_;
-    Scalar SwMic_;
-};
-
 /*!
  * \ingroup material
  * \brief Implements the Parker-Lenhard twophase
@@ -272,6 +79,14 @@ public:
     //! are dependent on the phase composition
     static const bool isCompositionDependent = false;
 
+    //! All quantities only depend on the saturation of the wetting phase
+    static constexpr unsigned relativePermeabilityDependencies(int /*phaseIdx*/)
+    { return 1u << Traits::wettingPhaseIdx; }
+
+    //! \copydoc relativePermeabilityDependencies
+    static constexpr unsigned capillaryPressureDependencies(int phaseIdx)
+    { return (phaseIdx == Traits::nonWettingPhaseIdx) ? (1u << Traits::wettingPhaseIdx) : 0u; }
+
     static_assert(Traits::numPhases == 2,
                   "The number of fluid phases must be two if you want to use "
                   "this material law!");
@@ -287,10 +102,7 @@ public:
      */
     static void reset(Params &params)
     {
-        delete params.mdc(); // this will work even if mdc_ == NULL!
-        params.setMdc(new ScanningCurve(params.SwrPc()));
-        params.setCsc(params.mdc());
-        params.setPisc(NULL);
+        params.resetScanningCurves();
         params.setCurrentSnr(0.0);
     }
 
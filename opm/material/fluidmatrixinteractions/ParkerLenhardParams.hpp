@@ -27,19 +27,246 @@
 
 #include <opm/material/fluidmatrixinteractions/RegularizedVanGenuchten.hpp>
 
+#include <array>
 #include <cassert>
 
 namespace Opm
 {
-// forward declaration
+/*!
+ * \brief Represents a scanning curve in the Parker-Lenhard hysteresis model.
+ *
+ * The class has pointers to the scanning curves
+ * with higher and lower loop number, this saving
+ * the history of the imbibitions and drainages. The curves are
+ * stored consecutively in an array which is owned by the parameter
+ * object, i.e., no memory is allocated when the history changes.
+ */
 template <class ScalarT>
-class PLScanningCurve;
+class PLScanningCurve
+{
+public:
+    typedef ScalarT Scalar;
+
+    /*!
+     * \brief Creates an unused scanning curve.
+     *
+     * Scanning curves are not allocated individually, but they are stored in
+     * an array which is owned by the parameter object. Use createMdc() to set up such
+     * an array.
+     */
+    PLScanningCurve()
+        : prev_(NULL)
+        , next_(NULL)
+        , storageEnd_(NULL)
+        , loopNum_(-1)
+        , Sw_(0.0)
+        , pcnw_(0.0)
+        , SwMdc_(0.0)
+        , SwMic_(0.0)
+    {}
+
+    /*!
+     * \brief Set up the main drainage curve in an array of scanning curves.
+     *
+     * The first entry of the array is used as the sentinel curve which precedes the
+     * main drainage curve and the second one becomes the main drainage curve. The
+     * scanning curves with more reversals are stored in the subsequent elements, so
+     * the array limits the number of reversals which are remembered.
+     *
+     * \param storageBegin The first element of the array
+     * \param storageEnd The element after the last element of the array
+     * \param Swr The residual saturation of the wetting phase
+     * \return The main drainage curve
+     */
+    static PLScanningCurve *createMdc(PLScanningCurve *storageBegin,
+                                      PLScanningCurve *storageEnd,
+                                      Scalar Swr)
+    {
+        assert(storageEnd - storageBegin >= 2);
+
+        PLScanningCurve *sentinel = storageBegin;
+        PLScanningCurve *mdc = storageBegin + 1;
+        sentinel->assign_(NULL, // prev
+                          mdc, // next
+                          -1, // loop number
+                          Swr, // Sw
+                          1e12, // pcnw
+                          Swr, // SwMic
+                          Swr, // SwMdc
+                          storageEnd);
+        mdc->assign_(sentinel, // prev
+                     NULL, // next
+                     0, // loop number
+                     1.0, // Sw
+                     0.0, // pcnw
+                     1.0, // SwMic
+                     1.0, // SwMdc
+                     storageEnd);
+        return mdc;
+    }
+
+    /*!
+     * \brief Return the previous scanning curve, i.e. the curve
+     *        with one less reversal than the current one.
+     */
+    PLScanningCurve *prev() const
+    { return prev_; }
+
+    /*!
+     * \brief Return the next scanning curve, i.e. the curve
+     *        with one more reversal than the current one.
+     */
+    PLScanningCurve *next() const
+    { return next_; }
+
+    /*!
+     * \brief Set the next scanning curve.
+     *
+     * Next in the sense of the number of reversals
+     * from imbibition to drainage or vince versa. If this
+     * curve already has a list of next curves, it is
+     * forgotten. If the array which stores the scanning curves is
+     * exhausted, no next curve is set, i.e., the reversal is ignored.
+     */
+    void setNext(Scalar Sw,
+                 Scalar pcnw,
+                 Scalar SwMic,
+                 Scalar SwMdc)
+    {
+        // the curve with one more reversal is always stored directly
+        // after this one
+        if (this + 1 >= storageEnd_) {
+            next_ = NULL;
+            return;
+        }
+
+        next_ = this + 1;
+        next_->assign_(this, // prev
+                       NULL, // next
+                       loopNum() + 1,
+                       Sw,
+                       pcnw,
+                       SwMic,
+                       SwMdc,
+                       storageEnd_);
+    }
+
+    /*!
+     * \brief Returns true iff the given effective saturation
+     *        Swei is within the scope of the curve, i.e.
+     *        whether Swei is part of the curve's
+     *        domain and the curve thus applies to Swi.
+     */
+    bool isValidAt_Sw(Scalar Sw)
+    {
+        if (isImbib())
+            // for inbibition the given saturation
+            // must be between the start of the
+            // current imbibition and the the start
+            // of the last drainage
+            return this->Sw() < Sw && Sw < prev_->Sw();
+        else
+            // for drainage the given saturation
+            // must be between the start of the
+            // last imbibition and the start
+            // of the current drainage
+            return prev_->Sw() < Sw && Sw < this->Sw();
+    }
+
+    /*!
+     * \brief Returns true iff the scanning curve is a
+     *        imbibition curve.
+     */
+    bool isImbib()
+    { return loopNum()%2 == 1; }
+
+    /*!
+     * \brief Returns true iff the scanning curve is a
+     *        drainage curve.
+     */
+    bool isDrain()
+    { return !isImbib(); }
+
+    /*!
+     * \brief The loop number of the scanning curve.
+     *
+     * The MDC is 0, PISC is 1, PDSC is 2, ...
+     */
+    int loopNum()
+    { return loopNum_; }
+
+    /*!
+     * \brief Absolute wetting-phase saturation at the
+     *        scanning curve's reversal point.
+     */
+    Scalar Sw() const
+    { return Sw_; }
+
+    /*!
+     * \brief Capillary pressure at the last reversal point.
+     */
+    Scalar pcnw() const
+    { return pcnw_; }
+
+    /*!
+     * \brief Apparent saturation of the last reversal point on
+     *        the pressure MIC.
+     */
+    Scalar SwMic()
+    { return SwMic_; }
+
+    /*!
+     * \brief Apparent saturation of the last reversal point on
+     *        the pressure MDC.
+     */
+    Scalar SwMdc()
+    { return SwMdc_; }
+
+private:
+    void assign_(PLScanningCurve *prev,
+                 PLScanningCurve *next,
+                 int loopN,
+                 Scalar Sw,
+                 Scalar pcnw,
+                 Scalar SwMic,
+                 Scalar SwMdc,
+                 PLScanningCurve *storageEnd)
+    {
+        prev_ = prev;
+        next_ = next;
+        storageEnd_ = storageEnd;
+        loopNum_ = loopN;
+        Sw_ = Sw;
+        pcnw_ = pcnw;
+        SwMic_ = SwMic;
+        SwMdc_ = SwMdc;
+    }
+
+    PLScanningCurve *prev_;
+    PLScanningCurve *next_;
+    PLScanningCurve *storageEnd_;
+
+    int loopNum_;
+
+    Scalar Sw_;
+    Scalar pcnw_;
+
+    Scalar SwMdc_;
+    Scalar SwMic_;
+};
 
 /*!
  * \brief Default parameter class for the Parker-Lenhard hysteresis
  *        model.
+ *
+ * The scanning curves are stored in an array of fixed size which is part of the
+ * parameter object. If the saturation is reversed more often than this array
+ * allows, the additional reversals are ignored.
+ *
+ * \tparam maxScanningCurvesV The maximum number of scanning curves including the
+ *                            main drainage curve
  */
-template <class TraitsT>
+template <class TraitsT, int maxScanningCurvesV = 16>
 class ParkerLenhardParams
 {
 public:
@@ -48,11 +275,15 @@ public:
     typedef typename VanGenuchten::Params VanGenuchtenParams;
     typedef PLScanningCurve<Scalar> ScanningCurve;
 
+    //! The maximum number of scanning curves including the main drainage curve
+    static const int maxScanningCurves = maxScanningCurvesV;
+    static_assert(maxScanningCurves >= 1,
+                  "At least the main drainage curve must be stored");
+
     ParkerLenhardParams()
     {
         currentSnr_ = 0;
-        mdc_ = new ScanningCurve(/*Swr=*/0);
-        pisc_ = csc_ = NULL;
+        resetScanningCurves_(/*Swr=*/0);
 
 #ifndef NDEBUG
         finalized_ = false;
@@ -63,16 +294,26 @@ public:
     {
         currentSnr_ = 0;
         SwrPc_ = p.SwrPc_;
-        mdc_ = new ScanningCurve(SwrPc_);
-        pisc_ = csc_ = NULL;
+        resetScanningCurves_(SwrPc_);
 
 #ifndef NDEBUG
         finalized_ = p.finalized_;
 #endif
     }
 
-    ~ParkerLenhardParams()
-    { delete mdc_; }
+    ParkerLenhardParams &operator=(const ParkerLenhardParams &p)
+    {
+        // the scanning curves point into the storage of their own object, so they
+        // cannot be copied
+        currentSnr_ = 0;
+        SwrPc_ = p.SwrPc_;
+        resetScanningCurves_(SwrPc_);
+
+#ifndef NDEBUG
+        finalized_ = p.finalized_;
+#endif
+        return *this;
+    }
 
     /*!
      * \brief Calculate all dependent quantities once the independent
@@ -162,6 +403,13 @@ public:
     void setCurrentSnr(Scalar val)
     { currentSnr_ = val; }
 
+    /*!
+     * \brief Forget the history of the saturation, i.e., only keep the main
+     *        drainage curve.
+     */
+    void resetScanningCurves()
+    { resetScanningCurves_(SwrPc()); }
+
     /*!
      * \brief Returns the main drainage curve
      */
@@ -170,6 +418,8 @@ public:
 
     /*!
      * \brief Set the main drainage curve.
+     *
+     * The parameter object does not take over the ownership of the curve.
      */
     void setMdc(ScanningCurve *val)
     { mdc_ = val; }
@@ -199,6 +449,15 @@ public:
     { csc_ = val; }
 
 private:
+    void resetScanningCurves_(Scalar Swr)
+    {
+        mdc_ = ScanningCurve::createMdc(scanningCurves_.data(),
+                                        scanningCurves_.data() + scanningCurves_.size(),
+                                        Swr);
+        pisc_ = NULL;
+        csc_ = mdc_;
+    }
+
 #ifndef NDEBUG
     void assertFinalized_() const
     { assert(finalized_); }
@@ -218,6 +477,9 @@ private:
     mutable ScanningCurve *mdc_;
     mutable ScanningCurve *pisc_;
     mutable ScanningCurve *csc_;
+
+    // the first entry is the sentinel which precedes the main drainage curve
+    std::array<ScanningCurve, maxScanningCurves + 1> scanningCurves_;
 };
 } // namespace Opm
 
@@ -28,9 +28,12 @@
 
 #include "PiecewiseLinearTwoPhaseMaterialParams.hpp"
 
+#include <opm/material/common/CurveShape.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
 #include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/InterpolationWeights.hpp>
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/SegmentHint.hpp>
 
 #include <algorithm>
 #include <cmath>
@@ -92,6 +95,14 @@ public:
     //! are dependent on the phase composition
     static const bool isCompositionDependent = false;
 
+    //! All quantities only depend on the saturation of the wetting phase
+    static constexpr unsigned relativePermeabilityDependencies(int /*phaseIdx*/)
+    { return 1u << Traits::wettingPhaseIdx; }
+
+    //! \copydoc relativePermeabilityDependencies
+    static constexpr unsigned capillaryPressureDependencies(int phaseIdx)
+    { return (phaseIdx == Traits::nonWettingPhaseIdx) ? (1u << Traits::wettingPhaseIdx) : 0u; }
+
     /*!
      * \brief The capillary pressure-saturation curve.
      */
@@ -142,11 +153,87 @@ public:
      */
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnw(const Params &params, const Evaluation& Sw)
-    { return eval_(params.SwPcwnSamples(), params.pcnwSamples(), Sw); }
+    {
+        return evalCurve_(params.pcnwShape(), params.SwPcwnSamples(), params.pcnwSamples(),
+                          params.SwPcwnInvSpacing(), Sw);
+    }
+
+    /*!
+     * \brief The saturation-capillary pressure curve using a segment hint
+     *
+     * The hint must only be used for the capillary pressure curve of a single
+     * parameter object.
+     */
+    template <class Evaluation>
+    static Evaluation twoPhaseSatPcnw(const Params &params, const Evaluation& Sw, SegmentHint& hint)
+    { return evalCurve_(params.pcnwShape(), params.SwPcwnSamples(), params.pcnwSamples(), Sw, hint); }
 
+    /*!
+     * \brief The wetting phase saturation for a given capillary pressure.
+     *
+     * If the capillary pressure curve is monotonic, the inverse tables of the
+     * parameter object are used (cf. Params::hasPcnwInverse()), so that the segment is
+     * usually determined without a search. Else, the sampling points of the capillary
+     * pressure curve are searched.
+     */
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnwInv(const Params &params, const Evaluation& pcnw)
-    { return eval_(params.pcnwSamples(), params.SwPcwnSamples(), pcnw); }
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (!params.hasPcnwInverse())
+            return eval_(params.pcnwSamples(), params.SwPcwnSamples(), pcnw);
+
+        const ValueVector& pcValues = params.pcnwInvSamples();
+        const ValueVector& SwValues = params.SwPcnwInvSamples();
+        if (pcnw <= pcValues.front())
+            return SwValues.front();
+        if (pcnw >= pcValues.back())
+            return SwValues.back();
+
+        int segIdx = findPcnwInvSegment_(params, Toolbox::value(pcnw));
+        return SwValues[segIdx] + (pcnw - pcValues[segIdx])*params.pcnwInvSlopes()[segIdx];
+    }
+
+    /*!
+     * \brief The wetting phase saturations for a batch of capillary pressures.
+     *
+     * This is equivalent to calling twoPhaseSatPcnwInv() for each entry of the pcnw
+     * array, e.g., for the nodes of the depth table of a hydrostatic equilibration.
+     *
+     * \param params The parameter object of the capillary pressure curve
+     * \param pcnw The array of capillary pressures
+     * \param Sw The array in which the wetting phase saturations are stored
+     * \param n The number of capillary pressures of the batch
+     */
+    static void twoPhaseSatPcnwInvBatch(const Params &params,
+                                        const Scalar* pcnw,
+                                        Scalar* Sw,
+                                        size_t n)
+    {
+        if (!params.hasPcnwInverse()) {
+            for (size_t i = 0; i < n; ++i)
+                Sw[i] = eval_(params.pcnwSamples(), params.SwPcwnSamples(), pcnw[i]);
+            return;
+        }
+
+        const ValueVector& pcValues = params.pcnwInvSamples();
+        const ValueVector& SwValues = params.SwPcnwInvSamples();
+        const ValueVector& slopes = params.pcnwInvSlopes();
+        Scalar pcMin = pcValues.front();
+        Scalar pcMax = pcValues.back();
+        for (size_t i = 0; i < n; ++i) {
+            Scalar pc = pcnw[i];
+            if (pc <= pcMin)
+                Sw[i] = SwValues.front();
+            else if (pc >= pcMax)
+                Sw[i] = SwValues.back();
+            else {
+                int segIdx = findPcnwInvSegment_(params, pc);
+                Sw[i] = SwValues[segIdx] + (pc - pcValues[segIdx])*slopes[segIdx];
+            }
+        }
+    }
 
     /*!
      * \brief The saturation-capillary pressure curve
@@ -187,7 +274,20 @@ public:
 
     template <class Evaluation>
     static Evaluation twoPhaseSatKrw(const Params &params, const Evaluation& Sw)
-    { return eval_(params.SwKrwSamples(), params.krwSamples(), Sw); }
+    {
+        return evalCurve_(params.krwShape(), params.SwKrwSamples(), params.krwSamples(),
+                          params.SwKrwInvSpacing(), Sw);
+    }
+
+    /*!
+     * \brief The relative permeability for the wetting phase using a segment hint
+     *
+     * The hint must only be used for the wetting phase relperm curve of a single
+     * parameter object.
+     */
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrw(const Params &params, const Evaluation& Sw, SegmentHint& hint)
+    { return evalCurve_(params.krwShape(), params.SwKrwSamples(), params.krwSamples(), Sw, hint); }
 
     template <class Evaluation>
     static Evaluation twoPhaseSatKrwInv(const Params &params, const Evaluation& krw)
@@ -209,13 +309,225 @@ public:
 
     template <class Evaluation>
     static Evaluation twoPhaseSatKrn(const Params &params, const Evaluation& Sw)
-    { return eval_(params.SwKrnSamples(), params.krnSamples(), Sw); }
+    {
+        return evalCurve_(params.krnShape(), params.SwKrnSamples(), params.krnSamples(),
+                          params.SwKrnInvSpacing(), Sw);
+    }
+
+    /*!
+     * \brief The relative permeability for the non-wetting phase using a segment hint
+     *
+     * The hint must only be used for the non-wetting phase relperm curve of a single
+     * parameter object.
+     */
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrn(const Params &params, const Evaluation& Sw, SegmentHint& hint)
+    { return evalCurve_(params.krnShape(), params.SwKrnSamples(), params.krnSamples(), Sw, hint); }
 
     template <class Evaluation>
     static Evaluation twoPhaseSatKrnInv(const Params &params, const Evaluation& krn)
     { return eval_(params.krnSamples(), params.SwKrnSamples(), krn); }
 
+    /*!
+     * \brief The capillary pressure and the weights of the sampling points which
+     *        contribute to it.
+     *
+     * The capillary pressure is the weighted sum of the values of at most two sampling
+     * points, so the weights are its partial derivatives with regard to the entries of
+     * the pcnwSamples() array (cf. Opm::InterpolationWeights). This is useful for
+     * computing the sensitivities with regard to the table values, e.g., in
+     * gradient-based history matching. Outside of the sampled saturation range, the
+     * curve is constant, so the only contributing sampling point is then the first or
+     * the last one. The indices refer to the sampling points after finalize(), i.e., the
+     * order is reversed if they were specified with decreasing saturations.
+     */
+    static Scalar twoPhaseSatPcnwWeights(const Params &params,
+                                         Scalar Sw,
+                                         InterpolationWeights<Scalar, 2>& weights)
+    { return evalWeights_(params.SwPcwnSamples(), params.pcnwSamples(), Sw, weights); }
+
+    /*!
+     * \brief The relative permeability of the wetting phase and the weights of the
+     *        sampling points which contribute to it.
+     *
+     * \copydetails twoPhaseSatPcnwWeights
+     */
+    static Scalar twoPhaseSatKrwWeights(const Params &params,
+                                        Scalar Sw,
+                                        InterpolationWeights<Scalar, 2>& weights)
+    { return evalWeights_(params.SwKrwSamples(), params.krwSamples(), Sw, weights); }
+
+    /*!
+     * \brief The relative permeability of the non-wetting phase and the weights of the
+     *        sampling points which contribute to it.
+     *
+     * \copydetails twoPhaseSatPcnwWeights
+     */
+    static Scalar twoPhaseSatKrnWeights(const Params &params,
+                                        Scalar Sw,
+                                        InterpolationWeights<Scalar, 2>& weights)
+    { return evalWeights_(params.SwKrnSamples(), params.krnSamples(), Sw, weights); }
+
+    /*!
+     * \brief Evaluate both relative permeabilities and the capillary pressure at once
+     *
+     * If all curves use the same saturation sampling points (cf.
+     * Params::hasSharedAbscissa()), the segment is determined only once and the values
+     * are interpolated from the interleaved sampling points. Else, or if all curves can
+     * be evaluated in closed form, this is equivalent to calling twoPhaseSatKrw(),
+     * twoPhaseSatKrn() and twoPhaseSatPcnw().
+     */
+    template <class Evaluation>
+    static void twoPhaseSatAll(const Params &params,
+                               const Evaluation& Sw,
+                               Evaluation& krw,
+                               Evaluation& krn,
+                               Evaluation& pcnw)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        bool allClosedForm =
+            params.krwShape() != GeneralCurve
+            && params.krnShape() != GeneralCurve
+            && params.pcnwShape() != GeneralCurve;
+        if (!params.hasSharedAbscissa() || allClosedForm) {
+            krw = twoPhaseSatKrw(params, Sw);
+            krn = twoPhaseSatKrn(params, Sw);
+            pcnw = twoPhaseSatPcnw(params, Sw);
+            return;
+        }
+
+        const ValueVector& samples = params.interleavedSamples();
+        int numSamples = samples.size()/4;
+        if (Sw <= samples[0]) {
+            krw = samples[1];
+            krn = samples[2];
+            pcnw = samples[3];
+            return;
+        }
+        if (Sw >= samples[4*(numSamples - 1)]) {
+            krw = samples[4*(numSamples - 1) + 1];
+            krn = samples[4*(numSamples - 1) + 2];
+            pcnw = samples[4*(numSamples - 1) + 3];
+            return;
+        }
+
+        const Scalar SwValue = Toolbox::value(Sw);
+        int lowIdx = 0;
+        Scalar invSpacing = params.SwKrwInvSpacing();
+        if (invSpacing > 0) {
+            // uniformly spaced samples: compute the segment directly and correct it if
+            // round-off moved it out of place
+            lowIdx = std::min(numSamples - 2,
+                              std::max(0, static_cast<int>((SwValue - samples[0])*invSpacing)));
+            if (lowIdx > 0 && SwValue < samples[4*lowIdx])
+                -- lowIdx;
+            else if (lowIdx < numSamples - 2 && SwValue > samples[4*(lowIdx + 1)])
+                ++ lowIdx;
+        }
+        else {
+            // bisection on the saturations of the interleaved samples
+            int highIdx = numSamples - 1;
+            while (lowIdx + 1 < highIdx) {
+                int curIdx = (lowIdx + highIdx)/2;
+                if (samples[4*curIdx] < SwValue)
+                    lowIdx = curIdx;
+                else
+                    highIdx = curIdx;
+            }
+        }
+
+        const Scalar* s0 = &samples[4*lowIdx];
+        const Scalar* s1 = s0 + 4;
+        const Evaluation& alpha = (Sw - s0[0])/(s1[0] - s0[0]);
+        krw = s0[1] + (s1[1] - s0[1])*alpha;
+        krn = s0[2] + (s1[2] - s0[2])*alpha;
+        pcnw = s0[3] + (s1[3] - s0[3])*alpha;
+    }
+
 private:
+    // evaluate a curve. zero, constant and linear curves are evaluated in closed form,
+    // for all others the segment is determined.
+    template <class Evaluation>
+    static Evaluation evalCurve_(CurveShape shape,
+                                 const ValueVector &xValues,
+                                 const ValueVector &yValues,
+                                 Scalar xInvSpacing,
+                                 const Evaluation& x)
+    {
+        if (shape != GeneralCurve)
+            return evalClosedForm_(shape, xValues, yValues, x);
+        return eval_(xValues, yValues, xInvSpacing, x);
+    }
+
+    template <class Evaluation>
+    static Evaluation evalCurve_(CurveShape shape,
+                                 const ValueVector &xValues,
+                                 const ValueVector &yValues,
+                                 const Evaluation& x,
+                                 SegmentHint& hint)
+    {
+        if (shape != GeneralCurve)
+            return evalClosedForm_(shape, xValues, yValues, x);
+        return eval_(xValues, yValues, x, hint);
+    }
+
+    template <class Evaluation>
+    static Evaluation evalClosedForm_(CurveShape shape,
+                                      const ValueVector &xValues,
+                                      const ValueVector &yValues,
+                                      const Evaluation& x)
+    {
+        if (shape == ZeroCurve)
+            return 0.0;
+        if (shape == ConstantCurve)
+            return yValues.front();
+
+        // linear curve. like the general one, it is constant outside of the sampled
+        // interval
+        assert(shape == LinearCurve);
+        if (x <= xValues.front())
+            return yValues.front();
+        if (x >= xValues.back())
+            return yValues.back();
+
+        Scalar x0 = xValues.front();
+        Scalar y0 = yValues.front();
+        Scalar m = (yValues.back() - y0)/(xValues.back() - x0);
+
+        return y0 + (x - x0)*m;
+    }
+
+    // evaluate a curve. if the sampling points are uniformly spaced, i.e., the
+    // inverse spacing is larger than 0, the segment is calculated directly.
+    template <class Evaluation>
+    static Evaluation eval_(const ValueVector &xValues,
+                            const ValueVector &yValues,
+                            Scalar xInvSpacing,
+                            const Evaluation& x)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (!(xInvSpacing > 0))
+            return eval_(xValues, yValues, x);
+
+        if (x <= xValues.front())
+            return yValues.front();
+        if (x >= xValues.back())
+            return yValues.back();
+
+        const Scalar xv = Toolbox::value(x);
+        int numSegments = xValues.size() - 1;
+        int segIdx = std::min(numSegments - 1,
+                              std::max(0, static_cast<int>((xv - xValues.front())*xInvSpacing)));
+        if (segIdx > 0 && xv < xValues[segIdx])
+            -- segIdx;
+        else if (segIdx < numSegments - 1 && xv > xValues[segIdx + 1])
+            ++ segIdx;
+
+        return evalSegment_(xValues, yValues, x, segIdx);
+    }
+
     template <class Evaluation>
     static Evaluation eval_(const ValueVector &xValues,
                             const ValueVector &yValues,
@@ -226,6 +538,43 @@ private:
         return evalDescending_(xValues, yValues, x);
     }
 
+    template <class Evaluation>
+    static Evaluation eval_(const ValueVector &xValues,
+                            const ValueVector &yValues,
+                            const Evaluation& x,
+                            SegmentHint& hint)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (xValues.front() < xValues.back()) {
+            if (x <= xValues.front())
+                return yValues.front();
+            if (x >= xValues.back())
+                return yValues.back();
+
+            int segIdx = hint.segmentIdx;
+            const Scalar xv = Toolbox::value(x);
+            if (!(0 <= segIdx && segIdx < static_cast<int>(xValues.size()) - 1
+                  && xValues[segIdx] <= xv && xv <= xValues[segIdx + 1]))
+                hint.segmentIdx = segIdx = findSegmentIndex_(xValues, xv);
+
+            return evalSegment_(xValues, yValues, x, segIdx);
+        }
+
+        if (x >= xValues.front())
+            return yValues.front();
+        if (x <= xValues.back())
+            return yValues.back();
+
+        int segIdx = hint.segmentIdx;
+        const Scalar xv = Toolbox::value(x);
+        if (!(0 <= segIdx && segIdx < static_cast<int>(xValues.size()) - 1
+              && xValues[segIdx] >= xv && xv >= xValues[segIdx + 1]))
+            hint.segmentIdx = segIdx = findSegmentIndexDescending_(xValues, xv);
+
+        return evalSegment_(xValues, yValues, x, segIdx);
+    }
+
     template <class Evaluation>
     static Evaluation evalAscending_(const ValueVector &xValues,
                                      const ValueVector &yValues,
@@ -240,15 +589,7 @@ private:
 
         int segIdx = findSegmentIndex_(xValues, Toolbox::value(x));
 
-        Scalar x0 = xValues[segIdx];
-        Scalar x1 = xValues[segIdx + 1];
-
-        Scalar y0 = yValues[segIdx];
-        Scalar y1 = yValues[segIdx + 1];
-
-        Scalar m = (y1 - y0)/(x1 - x0);
-
-        return y0 + (x - x0)*m;
+        return evalSegment_(xValues, yValues, x, segIdx);
     }
 
     template <class Evaluation>
@@ -265,6 +606,43 @@ private:
 
         int segIdx = findSegmentIndexDescending_(xValues, Toolbox::value(x));
 
+        return evalSegment_(xValues, yValues, x, segIdx);
+    }
+
+    // evaluate a curve with ascending sampling points and determine the weights of the
+    // contributing sampling points. the shape of the curve is not considered because
+    // the weights of a closed-form curve are the same as the ones of a general curve.
+    static Scalar evalWeights_(const ValueVector &xValues,
+                               const ValueVector &yValues,
+                               Scalar x,
+                               InterpolationWeights<Scalar, 2>& weights)
+    {
+        assert(xValues.front() < xValues.back());
+
+        weights.clear();
+        if (x <= xValues.front()) {
+            weights.add(0, 0, 1.0);
+            return yValues.front();
+        }
+        if (x >= xValues.back()) {
+            weights.add(static_cast<int>(xValues.size()) - 1, 0, 1.0);
+            return yValues.back();
+        }
+
+        int segIdx = findSegmentIndex_(xValues, x);
+        Scalar t = (x - xValues[segIdx])/(xValues[segIdx + 1] - xValues[segIdx]);
+        weights.add(segIdx, 0, 1 - t);
+        weights.add(segIdx + 1, 0, t);
+
+        return evalSegment_(xValues, yValues, x, segIdx);
+    }
+
+    template <class Evaluation>
+    static Evaluation evalSegment_(const ValueVector &xValues,
+                                   const ValueVector &yValues,
+                                   const Evaluation& x,
+                                   int segIdx)
+    {
         Scalar x0 = xValues[segIdx];
         Scalar x1 = xValues[segIdx + 1];
 
@@ -299,6 +677,28 @@ private:
         return Toolbox::createConstant((y1 - y0)/(x1 - x0));
     }
 
+    // determine the segment of the inverse capillary pressure curve for a capillary
+    // pressure within its range, i.e., the last segment which begins below it. the
+    // bucket of the capillary pressure yields the first candidate. if round-off moved
+    // the bucket out of place, the search goes back.
+    static int findPcnwInvSegment_(const Params& params, Scalar pcnw)
+    {
+        const ValueVector& pcValues = params.pcnwInvSamples();
+        const auto& buckets = params.pcnwInvBuckets();
+        int numSegments = pcValues.size() - 1;
+
+        int bucketIdx = static_cast<int>((pcnw - pcValues.front())*params.pcnwInvBucketScale());
+        bucketIdx = std::max(0, std::min<int>(buckets.size() - 1, bucketIdx));
+
+        int segIdx = buckets[bucketIdx];
+        while (segIdx > 0 && !(pcValues[segIdx] < pcnw))
+            -- segIdx;
+        while (segIdx < numSegments - 1 && pcValues[segIdx + 1] < pcnw)
+            ++ segIdx;
+
+        return segIdx;
+    }
+
     static int findSegmentIndex_(const ValueVector &xValues, Scalar x)
     {
         int n = xValues.size() - 1;
@@ -25,9 +25,15 @@
 #ifndef OPM_PIECEWISE_LINEAR_TWO_PHASE_MATERIAL_PARAMS_HPP
 #define OPM_PIECEWISE_LINEAR_TWO_PHASE_MATERIAL_PARAMS_HPP
 
+#include <opm/material/common/CurveShape.hpp>
+#include <opm/material/common/TableHash.hpp>
+
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 #include <cassert>
+#include <cmath>
 
 namespace Opm {
 /*!
@@ -35,14 +41,18 @@ namespace Opm {
  *
  * \brief Specification of the material parameters for a two-phase material law which
  *        uses a table and piecewise constant interpolation.
+ *
+ * The Allocator template parameter can be used to place the sampling points into shared
+ * memory (cf. SharedMemoryAllocator).
  */
-template<class TraitsT>
+template<class TraitsT, class Allocator = std::allocator<typename TraitsT::Scalar> >
 class PiecewiseLinearTwoPhaseMaterialParams
 {
     typedef typename TraitsT::Scalar Scalar;
 
 public:
-    typedef std::vector<Scalar> ValueVector;
+    typedef std::vector<Scalar, Allocator> ValueVector;
+    typedef std::vector<int, typename std::allocator_traits<Allocator>::template rebind_alloc<int> > IndexVector;
 
     typedef TraitsT Traits;
 
@@ -75,6 +85,189 @@ public:
         if (SwKrnSamples_.front() > SwKrnSamples_.back())
             swapOrder_(SwKrnSamples_, krnSamples_);
 
+        // determine which curves are sampled on a uniform saturation grid
+        SwPcwnInvSpacing_ = invUniformSpacing_(SwPcwnSamples_);
+        SwKrwInvSpacing_ = invUniformSpacing_(SwKrwSamples_);
+        SwKrnInvSpacing_ = invUniformSpacing_(SwKrnSamples_);
+
+        // determine which curves can be evaluated in closed form
+        pcnwShape_ = classifyCurve(SwPcwnSamples_, pcwnSamples_);
+        krwShape_ = classifyCurve(SwKrwSamples_, krwSamples_);
+        krnShape_ = classifyCurve(SwKrnSamples_, krnSamples_);
+
+        // if all curves use the same saturations (e.g., for SWOF), store the sampling
+        // points interleaved, so that all quantities can be interpolated using a single
+        // segment search
+        interleavedSamples_.clear();
+        if (SwKrwSamples_.front() < SwKrwSamples_.back()
+            && SwKrwSamples_ == SwKrnSamples_
+            && SwKrwSamples_ == SwPcwnSamples_)
+        {
+            size_t n = SwKrwSamples_.size();
+            interleavedSamples_.resize(4*n);
+            for (size_t sampleIdx = 0; sampleIdx < n; ++ sampleIdx) {
+                interleavedSamples_[4*sampleIdx + 0] = SwKrwSamples_[sampleIdx];
+                interleavedSamples_[4*sampleIdx + 1] = krwSamples_[sampleIdx];
+                interleavedSamples_[4*sampleIdx + 2] = krnSamples_[sampleIdx];
+                interleavedSamples_[4*sampleIdx + 3] = pcwnSamples_[sampleIdx];
+            }
+        }
+
+        updatePcnwInverse_();
+    }
+
+    /*!
+     * \brief Return the inverse distance between the saturations of the capillary
+     *        pressure sampling points if they are ascending and uniformly spaced.
+     *
+     * If the sampling points are not uniformly spaced, 0 is returned. The same applies
+     * to SwKrwInvSpacing() and SwKrnInvSpacing().
+     */
+    Scalar SwPcwnInvSpacing() const
+    { assertFinalized_(); return SwPcwnInvSpacing_; }
+
+    /*!
+     * \brief Return the inverse distance between the saturations of the sampling points
+     *        of the wetting phase relperm curve if they are uniformly spaced.
+     */
+    Scalar SwKrwInvSpacing() const
+    { assertFinalized_(); return SwKrwInvSpacing_; }
+
+    /*!
+     * \brief Return the inverse distance between the saturations of the sampling points
+     *        of the non-wetting phase relperm curve if they are uniformly spaced.
+     */
+    Scalar SwKrnInvSpacing() const
+    { assertFinalized_(); return SwKrnInvSpacing_; }
+
+    /*!
+     * \brief Return the shape of the capillary pressure curve.
+     *
+     * Curves which are zero, constant or linear are evaluated in closed form by the
+     * material law. The same applies to krwShape() and krnShape().
+     */
+    CurveShape pcnwShape() const
+    { assertFinalized_(); return pcnwShape_; }
+
+    /*!
+     * \brief Return the shape of the relperm curve of the wetting phase.
+     */
+    CurveShape krwShape() const
+    { assertFinalized_(); return krwShape_; }
+
+    /*!
+     * \brief Return the shape of the relperm curve of the non-wetting phase.
+     */
+    CurveShape krnShape() const
+    { assertFinalized_(); return krnShape_; }
+
+    /*!
+     * \brief Returns true iff the capillary pressure and both relative permeability
+     *        curves use the same, ascending wetting phase saturations.
+     */
+    bool hasSharedAbscissa() const
+    { assertFinalized_(); return !interleavedSamples_.empty(); }
+
+    /*!
+     * \brief Return the sampling points of all curves in interleaved order.
+     *
+     * This is only available if hasSharedAbscissa() is true. For each sampling point,
+     * the wetting phase saturation, the relative permeability of the wetting phase,
+     * the relative permeability of the non-wetting phase and the capillary pressure
+     * are stored consecutively.
+     */
+    const ValueVector& interleavedSamples() const
+    { assertFinalized_(); return interleavedSamples_; }
+
+    /*!
+     * \brief Returns true iff the tables of the inverse of the capillary pressure curve
+     *        are available.
+     *
+     * This is the case if the capillary pressure is a monotonic and non-constant
+     * function of the wetting phase saturation.
+     */
+    bool hasPcnwInverse() const
+    { assertFinalized_(); return !pcnwInvSamples_.empty(); }
+
+    /*!
+     * \brief Return the capillary pressures of the sampling points of the inverse of the
+     *        capillary pressure curve in ascending order.
+     *
+     * These are the sampling points of the capillary pressure curve, which are reversed
+     * if the capillary pressure decreases with the saturation. The same applies to
+     * SwPcnwInvSamples().
+     */
+    const ValueVector& pcnwInvSamples() const
+    { assertFinalized_(); return pcnwInvSamples_; }
+
+    /*!
+     * \brief Return the wetting phase saturations of the sampling points of the inverse
+     *        of the capillary pressure curve.
+     */
+    const ValueVector& SwPcnwInvSamples() const
+    { assertFinalized_(); return SwPcnwInvSamples_; }
+
+    /*!
+     * \brief Return the derivatives of the saturation with regard to the capillary
+     *        pressure of the segments of the inverse curve.
+     *
+     * Segments which do not exhibit an extent on the capillary pressure axis have a
+     * slope of zero.
+     */
+    const ValueVector& pcnwInvSlopes() const
+    { assertFinalized_(); return pcnwInvSlopes_; }
+
+    /*!
+     * \brief Return the index of the first segment of the inverse curve which needs to
+     *        be considered for each bucket of a uniform capillary pressure grid.
+     *
+     * The buckets subdivide the range of pcnwInvSamples() into intervals of the same
+     * length, so the bucket of a capillary pressure is determined by index arithmetic,
+     * cf. pcnwInvBucketScale(). The segment of a capillary pressure is then found by a
+     * short linear search starting at the segment of its bucket.
+     */
+    const IndexVector& pcnwInvBuckets() const
+    { assertFinalized_(); return pcnwInvBuckets_; }
+
+    /*!
+     * \brief Return the inverse length of the buckets of the inverse capillary pressure
+     *        curve.
+     */
+    Scalar pcnwInvBucketScale() const
+    { assertFinalized_(); return pcnwInvBucketScale_; }
+
+    /*!
+     * \brief Returns true iff two parameter objects use the same sampling points.
+     *
+     * All other quantities are computed from the sampling points by finalize().
+     * Together with contentHash(), this allows to share identical objects between the
+     * realizations of an ensemble, cf. Opm::TableRegistry.
+     */
+    bool operator==(const PiecewiseLinearTwoPhaseMaterialParams& other) const
+    {
+        return
+            SwPcwnSamples_ == other.SwPcwnSamples_
+            && SwKrwSamples_ == other.SwKrwSamples_
+            && SwKrnSamples_ == other.SwKrnSamples_
+            && pcwnSamples_ == other.pcwnSamples_
+            && krwSamples_ == other.krwSamples_
+            && krnSamples_ == other.krnSamples_;
+    }
+
+    bool operator!=(const PiecewiseLinearTwoPhaseMaterialParams& other) const
+    { return !operator==(other); }
+
+    /*!
+     * \brief Returns a hash value of the sampling points, cf. Opm::TableRegistry.
+     */
+    size_t contentHash() const
+    {
+        size_t seed = hashValues(0, SwPcwnSamples_);
+        seed = hashValues(seed, pcwnSamples_);
+        seed = hashValues(seed, SwKrwSamples_);
+        seed = hashValues(seed, krwSamples_);
+        seed = hashValues(seed, SwKrnSamples_);
+        return hashValues(seed, krnSamples_);
     }
 
     /*!
@@ -177,7 +370,117 @@ public:
         std::copy(values.begin(), values.end(), krnSamples_.begin());
     }
 
+    /*!
+     * \brief Replace the values of the capillary pressure curve of a finalized object
+     *        while keeping its saturations.
+     *
+     * The values must be given in the order of SwPcwnSamples(). Only the quantities
+     * which depend on the values are updated, so that calling finalize() again is not
+     * required. This is useful if the same curves are modified many times, e.g., by
+     * the iterations of a history matching loop.
+     */
+    template <class Container>
+    void updatePcnwValues(const Container& values)
+    {
+        updateValues_(SwPcwnSamples_, pcwnSamples_, pcnwShape_, /*interleavedIdx=*/3, values);
+        updatePcnwInverse_();
+    }
+
+    /*!
+     * \brief Replace the values of the relative permeability curve of the wetting
+     *        phase of a finalized object while keeping its saturations.
+     *
+     * The values must be given in the order of SwKrwSamples(), cf. updatePcnwValues().
+     */
+    template <class Container>
+    void updateKrwValues(const Container& values)
+    { updateValues_(SwKrwSamples_, krwSamples_, krwShape_, /*interleavedIdx=*/1, values); }
+
+    /*!
+     * \brief Replace the values of the relative permeability curve of the non-wetting
+     *        phase of a finalized object while keeping its saturations.
+     *
+     * The values must be given in the order of SwKrnSamples(), cf. updatePcnwValues().
+     */
+    template <class Container>
+    void updateKrnValues(const Container& values)
+    { updateValues_(SwKrnSamples_, krnSamples_, krnShape_, /*interleavedIdx=*/2, values); }
+
 private:
+    // the spacing of the saturations does not change, so only the shape of the curve
+    // and the copy of the values in the interleaved array need to be updated
+    template <class Container>
+    void updateValues_(const ValueVector& swValues,
+                       ValueVector& samples,
+                       CurveShape& shape,
+                       unsigned interleavedIdx,
+                       const Container& values)
+    {
+        assertFinalized_();
+        assert(values.size() == samples.size());
+
+        std::copy(values.begin(), values.end(), samples.begin());
+        shape = classifyCurve(swValues, samples);
+
+        if (!interleavedSamples_.empty()) {
+            for (size_t sampleIdx = 0; sampleIdx < samples.size(); ++ sampleIdx)
+                interleavedSamples_[4*sampleIdx + interleavedIdx] = samples[sampleIdx];
+        }
+    }
+
+    // tabulate the inverse of the capillary pressure curve. since the curve is
+    // monotonic, this only requires to order its sampling points by the capillary
+    // pressure. the slopes of the segments and the first segment of each bucket of a
+    // uniform grid of capillary pressures are precomputed.
+    void updatePcnwInverse_()
+    {
+        pcnwInvSamples_.clear();
+        SwPcnwInvSamples_.clear();
+        pcnwInvSlopes_.clear();
+        pcnwInvBuckets_.clear();
+        pcnwInvBucketScale_ = 0.0;
+
+        size_t n = pcwnSamples_.size();
+        if (n < 2 || pcwnSamples_.front() == pcwnSamples_.back())
+            return;
+
+        bool descending = pcwnSamples_.front() > pcwnSamples_.back();
+        for (size_t sampleIdx = 1; sampleIdx < n; ++ sampleIdx) {
+            Scalar delta = pcwnSamples_[sampleIdx] - pcwnSamples_[sampleIdx - 1];
+            if (descending ? delta > 0 : delta < 0)
+                return; // not monotonic
+        }
+
+        pcnwInvSamples_.resize(n);
+        SwPcnwInvSamples_.resize(n);
+        for (size_t sampleIdx = 0; sampleIdx < n; ++ sampleIdx) {
+            size_t origIdx = descending ? n - 1 - sampleIdx : sampleIdx;
+            pcnwInvSamples_[sampleIdx] = pcwnSamples_[origIdx];
+            SwPcnwInvSamples_[sampleIdx] = SwPcwnSamples_[origIdx];
+        }
+
+        pcnwInvSlopes_.resize(n - 1);
+        for (size_t segIdx = 0; segIdx < n - 1; ++ segIdx) {
+            Scalar deltaPc = pcnwInvSamples_[segIdx + 1] - pcnwInvSamples_[segIdx];
+            Scalar deltaSw = SwPcnwInvSamples_[segIdx + 1] - SwPcnwInvSamples_[segIdx];
+            pcnwInvSlopes_[segIdx] = (deltaPc > 0) ? deltaSw/deltaPc : 0.0;
+        }
+
+        // use as many buckets as there are segments. the segment of a bucket is the
+        // last one which begins below the lower end of the bucket.
+        size_t numBuckets = n - 1;
+        Scalar pcMin = pcnwInvSamples_.front();
+        pcnwInvBucketScale_ = numBuckets/(pcnwInvSamples_.back() - pcMin);
+        pcnwInvBuckets_.resize(numBuckets);
+        size_t segIdx = 0;
+        for (size_t bucketIdx = 0; bucketIdx < numBuckets; ++ bucketIdx) {
+            Scalar pcLow = pcMin + bucketIdx/pcnwInvBucketScale_;
+            while (segIdx + 2 < n && pcnwInvSamples_[segIdx + 1] < pcLow)
+                ++ segIdx;
+            pcnwInvBuckets_[bucketIdx] = static_cast<int>(segIdx);
+        }
+    }
+
 #ifndef NDEBUG
     void assertFinalized_() const
     { assert(finalized_); }
@@ -188,6 +491,24 @@ private:
     { }
 #endif
 
+    // returns the inverse distance of ascending and uniformly spaced sampling points or
+    // 0 if the sampling points are not uniformly spaced
+    static Scalar invUniformSpacing_(const ValueVector& swValues)
+    {
+        size_t n = swValues.size();
+        if (n < 2 || !(swValues.front() < swValues.back()))
+            return 0.0;
+
+        Scalar delta = (swValues.back() - swValues.front())/(n - 1);
+        for (size_t sampleIdx = 1; sampleIdx < n - 1; ++ sampleIdx) {
+            Scalar SwUniform = swValues.front() + sampleIdx*delta;
+            if (std::abs(swValues[sampleIdx] - SwUniform) > 1e-10*delta)
+                return 0.0;
+        }
+
+        return 1.0/delta;
+    }
+
     void swapOrder_(ValueVector& swValues, ValueVector& values) const
     {
         if (swValues.front() > values.back()) {
@@ -209,6 +530,18 @@ private:
     ValueVector pcwnSamples_;
     ValueVector krwSamples_;
     ValueVector krnSamples_;
+    ValueVector interleavedSamples_;
+    ValueVector pcnwInvSamples_;
+    ValueVector SwPcnwInvSamples_;
+    ValueVector pcnwInvSlopes_;
+    IndexVector pcnwInvBuckets_;
+    Scalar pcnwInvBucketScale_;
+    Scalar SwPcwnInvSpacing_;
+    Scalar SwKrwInvSpacing_;
+    Scalar SwKrnInvSpacing_;
+    CurveShape pcnwShape_;
+    CurveShape krwShape_;
+    CurveShape krnShape_;
 };
 } // namespace Opm
 
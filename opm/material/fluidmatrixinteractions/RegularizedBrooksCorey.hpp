@@ -58,6 +58,11 @@ namespace Opm {
  *   - yes: use the regularization
  *   - no: forward to the standard material law.
  *
+ * Alternatively, the regularized curves can be tabulated when the parameters are
+ * finalized, see Params::setNumTabulationSamples(). In this case, the capillary
+ * pressure and the relative permeabilities are interpolated by monotonic cubic
+ * polynomials on a uniform grid, which avoids the branches and the powers.
+ *
  * \see BrooksCorey
  */
 template <class TraitsT, class ParamsT = RegularizedBrooksCoreyParams<TraitsT> >
@@ -100,6 +105,14 @@ public:
     //! are dependent on the phase composition
     static const bool isCompositionDependent = false;
 
+    //! The relative permeability of each phase only depends on its own saturation
+    static constexpr unsigned relativePermeabilityDependencies(int phaseIdx)
+    { return 1u << phaseIdx; }
+
+    //! The capillary pressure only depends on the saturation of the wetting phase
+    static constexpr unsigned capillaryPressureDependencies(int phaseIdx)
+    { return (phaseIdx == Traits::nonWettingPhaseIdx) ? (1u << Traits::wettingPhaseIdx) : 0u; }
+
     static_assert(Traits::numPhases == 2,
                   "The number of fluid phases must be two if you want to use "
                   "this material law!");
@@ -181,6 +194,9 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnw(const Params &params, const Evaluation& Sw)
     {
+        if (params.tabulated())
+            return params.pcnwTable().eval(Sw, /*extrapolate=*/true);
+
         const Scalar Sthres = params.pcnwLowSw();
 
         if (Sw <= Sthres) {
@@ -291,6 +307,9 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
+        if (params.tabulated())
+            return params.krwTable().eval(Sw);
+
         if (Sw <= 0.0)
             return Toolbox::createConstant(0.0);
         else if (Sw >= 1.0)
@@ -341,6 +360,9 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
+        if (params.tabulated())
+            return params.krnTable().eval(Sw);
+
         if (Sw >= 1.0)
             return Toolbox::createConstant(0.0);
         else if (Sw <= 0.0)
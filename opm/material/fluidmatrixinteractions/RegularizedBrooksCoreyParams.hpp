@@ -28,11 +28,17 @@
 #include "BrooksCorey.hpp"
 #include "BrooksCoreyParams.hpp"
 
+#include <opm/material/common/UniformMonotoneTable.hpp>
+
 #include <dune/common/deprecated.hh>
 
+#include <array>
 #include <cassert>
 
 namespace Opm {
+template <class TraitsT, class ParamsT>
+class RegularizedBrooksCorey;
+
 /*!
  * \ingroup FluidMatrixInteractions
  *
@@ -44,6 +50,7 @@ class RegularizedBrooksCoreyParams : public Opm::BrooksCoreyParams<TraitsT>
 {
     typedef Opm::BrooksCoreyParams<TraitsT> BrooksCoreyParams;
     typedef Opm::BrooksCorey<TraitsT, RegularizedBrooksCoreyParams> BrooksCorey;
+    typedef Opm::RegularizedBrooksCorey<TraitsT, RegularizedBrooksCoreyParams> RegularizedBrooksCorey;
     typedef typename TraitsT::Scalar Scalar;
 
 public:
@@ -52,6 +59,8 @@ public:
     RegularizedBrooksCoreyParams()
         : BrooksCoreyParams()
         , pcnwLowSw_(0.01)
+        , numTabulationSamples_(0)
+        , tabulated_(false)
     {
 #ifndef NDEBUG
         finalized_ = false;
@@ -61,6 +70,8 @@ public:
     RegularizedBrooksCoreyParams(Scalar entryPressure, Scalar lambda)
         : BrooksCoreyParams(entryPressure, lambda)
         , pcnwLowSw_(0.01)
+        , numTabulationSamples_(0)
+        , tabulated_(false)
     { finalize(); }
 
     /*!
@@ -79,6 +90,24 @@ public:
 #ifndef NDEBUG
         finalized_ = true;
 #endif
+
+        // the curves are tabulated using the analytic law, so this must happen
+        // after everything else has been calculated
+        tabulated_ = false;
+        if (numTabulationSamples_ > 0) {
+            const RegularizedBrooksCoreyParams& self = *this;
+            pcnwTable_.init(0.0, 1.0, numTabulationSamples_,
+                            [&self](Scalar Sw)
+                            { return RegularizedBrooksCorey::twoPhaseSatPcnw(self, Sw); });
+            pcnwTable_.setExtrapolationSlopes(pcnwSlopeLow_, pcnwSlopeHigh_);
+            krwTable_.init(0.0, 1.0, numTabulationSamples_,
+                           [&self](Scalar Sw)
+                           { return RegularizedBrooksCorey::twoPhaseSatKrw(self, Sw); });
+            krnTable_.init(0.0, 1.0, numTabulationSamples_,
+                           [&self](Scalar Sw)
+                           { return RegularizedBrooksCorey::twoPhaseSatKrn(self, Sw); });
+            tabulated_ = true;
+        }
     }
 
     /*!
@@ -130,6 +159,61 @@ public:
     Scalar pcnwSlopeHigh() const
     { assertFinalized_(); return pcnwSlopeHigh_; }
 
+    /*!
+     * \brief Specify the number of sampling points used to tabulate the regularized
+     *        curves.
+     *
+     * If this is larger than zero, finalize() tabulates the capillary pressure and
+     * the relative permeabilities for \f$0 \leq \overline S_w \leq 1\f$ on a uniform
+     * grid and the saturation dependent methods of the material law evaluate these
+     * tables instead of the analytic curves. Since the capillary pressure is very
+     * steep close to the low threshold saturation, it should be checked using
+     * tabulationError() whether the resolution is sufficient. The inverse relations
+     * are always evaluated analytically. By default, the curves are not tabulated.
+     */
+    void setNumTabulationSamples(unsigned value)
+    { numTabulationSamples_ = value; }
+
+    /*!
+     * \brief Returns true if the material law ought to use the tabulated curves.
+     */
+    bool tabulated() const
+    { return tabulated_; }
+
+    /*!
+     * \brief Returns the table for the capillary pressure.
+     */
+    const UniformMonotoneTable<Scalar>& pcnwTable() const
+    { assertFinalized_(); return pcnwTable_; }
+
+    /*!
+     * \brief Returns the table for the relative permeability of the wetting phase.
+     */
+    const UniformMonotoneTable<Scalar>& krwTable() const
+    { assertFinalized_(); return krwTable_; }
+
+    /*!
+     * \brief Returns the table for the relative permeability of the non-wetting
+     *        phase.
+     */
+    const UniformMonotoneTable<Scalar>& krnTable() const
+    { assertFinalized_(); return krnTable_; }
+
+    /*!
+     * \brief Returns the estimated maximum deviation of the tabulated curves from
+     *        the analytic ones.
+     *
+     * The first entry is the absolute error of the capillary pressure in
+     * \f$\mathrm{[Pa]}\f$, the second and third ones are the absolute errors of the
+     * relative permeabilities of the wetting and non-wetting phases.
+     */
+    std::array<Scalar, 3> tabulationError() const
+    {
+        assertFinalized_();
+        std::array<Scalar, 3> err = {{ pcnwTable_.maxError(), krwTable_.maxError(), krnTable_.maxError() }};
+        return err;
+    }
+
 private:
 #ifndef NDEBUG
     void assertFinalized_() const
@@ -171,6 +255,12 @@ private:
     Scalar pcnwSlopeLow_;
     Scalar pcnwHigh_;
     Scalar pcnwSlopeHigh_;
+
+    unsigned numTabulationSamples_;
+    bool tabulated_;
+    UniformMonotoneTable<Scalar> pcnwTable_;
+    UniformMonotoneTable<Scalar> krwTable_;
+    UniformMonotoneTable<Scalar> krnTable_;
 };
 } // namespace Opm
 
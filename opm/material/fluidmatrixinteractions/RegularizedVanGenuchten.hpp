@@ -62,6 +62,11 @@ namespace Opm {
  *  - yes: use the regularization
  *  - no: forward to the standard material law.
  *
+ * Alternatively, the regularized curves can be tabulated when the parameters are
+ * finalized, see Params::setNumTabulationSamples(). In this case, the capillary
+ * pressure and the relative permeabilities are interpolated by monotonic cubic
+ * polynomials on a uniform grid, which avoids the branches and the powers.
+ *
  * An example of the regularization of the capillary pressure curve is
  * shown below: \image html regularizedVanGenuchten.png
  *
@@ -108,6 +113,14 @@ public:
     //! are dependent on the phase composition
     static const bool isCompositionDependent = false;
 
+    //! The relative permeability of each phase only depends on its own saturation
+    static constexpr unsigned relativePermeabilityDependencies(int phaseIdx)
+    { return 1u << phaseIdx; }
+
+    //! The capillary pressure only depends on the saturation of the wetting phase
+    static constexpr unsigned capillaryPressureDependencies(int phaseIdx)
+    { return (phaseIdx == Traits::nonWettingPhaseIdx) ? (1u << Traits::wettingPhaseIdx) : 0u; }
+
     /*!
      * \brief Calculate the pressure difference of the phases in the
      *        most generic way.
@@ -171,6 +184,9 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnw(const Params &params, const Evaluation& Sw)
     {
+        if (params.tabulated())
+            return params.pcnwTable().eval(Sw, /*extrapolate=*/true);
+
         // retrieve the low and the high threshold saturations for the
         // unregularized capillary pressure curve from the parameters
         const Scalar SwThLow = params.pcnwLowSw();
@@ -308,6 +324,9 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
+        if (params.tabulated())
+            return params.krwTable().eval(Sw);
+
         // regularize
         if (Sw <= 0)
             return Toolbox::createConstant(0);
@@ -346,6 +365,9 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
+        if (params.tabulated())
+            return params.krnTable().eval(Sw);
+
         // regularize
         if (Sw <= 0)
             return Toolbox::createConstant(1);
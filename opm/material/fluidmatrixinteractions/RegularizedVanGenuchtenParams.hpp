@@ -30,10 +30,15 @@
 #include "VanGenuchtenParams.hpp"
 
 #include <opm/material/common/Spline.hpp>
+#include <opm/material/common/UniformMonotoneTable.hpp>
 
+#include <array>
 #include <cassert>
 
 namespace Opm {
+template <class TraitsT, class ParamsT>
+class RegularizedVanGenuchten;
+
 /*!
  * \ingroup FluidMatrixInteractions
  *
@@ -47,6 +52,7 @@ class RegularizedVanGenuchtenParams : public VanGenuchtenParams<TraitsT>
     typedef typename TraitsT::Scalar Scalar;
     typedef VanGenuchtenParams<TraitsT> Parent;
     typedef Opm::VanGenuchten<TraitsT> VanGenuchten;
+    typedef Opm::RegularizedVanGenuchten<TraitsT, RegularizedVanGenuchtenParams> RegularizedVanGenuchten;
 
 public:
     typedef TraitsT Traits;
@@ -54,12 +60,16 @@ public:
     RegularizedVanGenuchtenParams()
         : pcnwLowSw_(0.01)
         , pcnwHighSw_(0.99)
+        , numTabulationSamples_(0)
+        , tabulated_(false)
     {}
 
     RegularizedVanGenuchtenParams(Scalar vgAlpha, Scalar vgN)
         : Parent(vgAlpha, vgN)
         , pcnwLowSw_(0.01)
         , pcnwHighSw_(0.99)
+        , numTabulationSamples_(0)
+        , tabulated_(false)
     {
         finalize();
     }
@@ -86,6 +96,24 @@ public:
 #ifndef NDEBUG
         finalized_ = true;
 #endif
+
+        // the curves are tabulated using the analytic law, so this must happen
+        // after everything else has been calculated
+        tabulated_ = false;
+        if (numTabulationSamples_ > 0) {
+            const RegularizedVanGenuchtenParams& self = *this;
+            pcnwTable_.init(0.0, 1.0, numTabulationSamples_,
+                            [&self](Scalar Sw)
+                            { return RegularizedVanGenuchten::twoPhaseSatPcnw(self, Sw); });
+            pcnwTable_.setExtrapolationSlopes(pcnwSlopeLow_, pcnwSlopeHigh_);
+            krwTable_.init(0.0, 1.0, numTabulationSamples_,
+                           [&self](Scalar Sw)
+                           { return RegularizedVanGenuchten::twoPhaseSatKrw(self, Sw); });
+            krnTable_.init(0.0, 1.0, numTabulationSamples_,
+                           [&self](Scalar Sw)
+                           { return RegularizedVanGenuchten::twoPhaseSatKrn(self, Sw); });
+            tabulated_ = true;
+        }
     }
 
     /*!
@@ -155,6 +183,61 @@ public:
     void setPCHighSw(Scalar value)
     { pcnwHighSw_ = value; }
 
+    /*!
+     * \brief Specify the number of sampling points used to tabulate the regularized
+     *        curves.
+     *
+     * If this is larger than zero, finalize() tabulates the capillary pressure and
+     * the relative permeabilities for \f$0 \leq \overline S_w \leq 1\f$ on a uniform
+     * grid and the saturation dependent methods of the material law evaluate these
+     * tables instead of the analytic curves. This avoids the exponentials and the
+     * branches of the regularization at the cost of accuracy, see tabulationError().
+     * The inverse relation \f$\overline S_w(p_c)\f$ is always evaluated analytically.
+     * By default, the curves are not tabulated.
+     */
+    void setNumTabulationSamples(unsigned value)
+    { numTabulationSamples_ = value; }
+
+    /*!
+     * \brief Returns true if the material law ought to use the tabulated curves.
+     */
+    bool tabulated() const
+    { return tabulated_; }
+
+    /*!
+     * \brief Returns the table for the capillary pressure.
+     */
+    const UniformMonotoneTable<Scalar>& pcnwTable() const
+    { assertFinalized_(); return pcnwTable_; }
+
+    /*!
+     * \brief Returns the table for the relative permeability of the wetting phase.
+     */
+    const UniformMonotoneTable<Scalar>& krwTable() const
+    { assertFinalized_(); return krwTable_; }
+
+    /*!
+     * \brief Returns the table for the relative permeability of the non-wetting
+     *        phase.
+     */
+    const UniformMonotoneTable<Scalar>& krnTable() const
+    { assertFinalized_(); return krnTable_; }
+
+    /*!
+     * \brief Returns the estimated maximum deviation of the tabulated curves from
+     *        the analytic ones.
+     *
+     * The first entry is the absolute error of the capillary pressure in
+     * \f$\mathrm{[Pa]}\f$, the second and third ones are the absolute errors of the
+     * relative permeabilities of the wetting and non-wetting phases.
+     */
+    std::array<Scalar, 3> tabulationError() const
+    {
+        assertFinalized_();
+        std::array<Scalar, 3> err = {{ pcnwTable_.maxError(), krwTable_.maxError(), krnTable_.maxError() }};
+        return err;
+    }
+
 private:
 #ifndef NDEBUG
     void assertFinalized_() const
@@ -186,6 +269,12 @@ private:
     Scalar pcnwSlopeHigh_;
 
     Spline<Scalar> pcnwHighSpline_;
+
+    unsigned numTabulationSamples_;
+    bool tabulated_;
+    UniformMonotoneTable<Scalar> pcnwTable_;
+    UniformMonotoneTable<Scalar> krwTable_;
+    UniformMonotoneTable<Scalar> krnTable_;
 };
 } // namespace Opm
 
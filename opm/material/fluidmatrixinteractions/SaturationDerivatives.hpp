@@ -0,0 +1,315 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::SaturationDerivatives
+ */
+#ifndef OPM_SATURATION_DERIVATIVES_HPP
+#define OPM_SATURATION_DERIVATIVES_HPP
+
+#include <opm/material/fluidstates/SimpleModularFluidState.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+
+namespace Opm {
+/*!
+ * \ingroup FluidMatrixInteractions
+ *
+ * \brief Evaluates a material law together with the derivatives of its results with
+ *        respect to the phase saturations as plain scalars.
+ *
+ * The saturation functions only depend on the saturations, but if they are called
+ * with function evaluations, every operation of the law is applied to the full vector
+ * of derivatives with respect to the primary variables. Instead, this class evaluates
+ * the law using evaluations which only carry the derivatives with respect to the
+ * numPhases saturations (or to the single saturation of the twoPhaseSat*() API) and
+ * applies the chain rule to the derivatives of the saturations once at the end. This
+ * reduces the work of each operation of the law from O(numVars) to O(numPhases).
+ *
+ * The results are identical to the ones of calling the law directly up to the
+ * rounding errors of the chain rule.
+ */
+template <class MaterialLaw>
+class SaturationDerivatives
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+
+public:
+    enum { numPhases = MaterialLaw::numPhases };
+
+    //! The tag of the evaluations with respect to the saturations
+    class Variables;
+
+    //! The evaluation type of the saturations and the results of the law
+    typedef Opm::LocalAd::Evaluation<Scalar, Variables, numPhases> SatEval;
+
+    //! The evaluation type used for the twoPhaseSat*() API
+    typedef Opm::LocalAd::Evaluation<Scalar, Variables, 1> TwoPhaseSatEval;
+
+    /*!
+     * \brief Calculate the relative permeabilities of all phases and their derivatives
+     *        with respect to the saturations.
+     *
+     * \param values Receives the relative permeabilities
+     * \param dValues_dS Receives the derivative of the relative permeability of each
+     *                   phase with respect to the saturation of each phase
+     * \param params The parameters of the material law
+     * \param fluidState The fluid state. Only the values of its saturations are used.
+     */
+    template <class FluidState>
+    static void relativePermeabilities(Scalar* values,
+                                       Scalar (*dValues_dS)[numPhases],
+                                       const Params& params,
+                                       const FluidState& fluidState)
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        Scalar saturations[numPhases];
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            saturations[phaseIdx] = FsToolbox::value(fluidState.saturation(phaseIdx));
+        relativePermeabilitiesAt(values, dValues_dS, params, saturations);
+    }
+
+    /*!
+     * \brief Calculate the relative permeabilities of all phases and their derivatives
+     *        with respect to the saturations for explicitly given saturations.
+     */
+    static void relativePermeabilitiesAt(Scalar* values,
+                                         Scalar (*dValues_dS)[numPhases],
+                                         const Params& params,
+                                         const Scalar* saturations)
+    {
+        SatEval satValues[numPhases];
+        SatFluidState_ satFluidState;
+        prepare_(satValues, satFluidState, saturations);
+        MaterialLaw::relativePermeabilities(satValues, params, satFluidState);
+        unpack_(values, dValues_dS, satValues);
+    }
+
+    /*!
+     * \brief Calculate the capillary pressures of all phases and their derivatives
+     *        with respect to the saturations.
+     *
+     * \copydetails relativePermeabilities()
+     */
+    template <class FluidState>
+    static void capillaryPressures(Scalar* values,
+                                   Scalar (*dValues_dS)[numPhases],
+                                   const Params& params,
+                                   const FluidState& fluidState)
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        Scalar saturations[numPhases];
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            saturations[phaseIdx] = FsToolbox::value(fluidState.saturation(phaseIdx));
+        capillaryPressuresAt(values, dValues_dS, params, saturations);
+    }
+
+    /*!
+     * \brief Calculate the capillary pressures of all phases and their derivatives
+     *        with respect to the saturations for explicitly given saturations.
+     */
+    static void capillaryPressuresAt(Scalar* values,
+                                     Scalar (*dValues_dS)[numPhases],
+                                     const Params& params,
+                                     const Scalar* saturations)
+    {
+        SatEval satValues[numPhases];
+        SatFluidState_ satFluidState;
+        prepare_(satValues, satFluidState, saturations);
+        MaterialLaw::capillaryPressures(satValues, params, satFluidState);
+        unpack_(values, dValues_dS, satValues);
+    }
+
+    /*!
+     * \brief Calculate the relative permeabilities of all phases for a fluid state
+     *        with arbitrary evaluations.
+     *
+     * This is equivalent to MaterialLaw::relativePermeabilities().
+     */
+    template <class ContainerT, class FluidState>
+    static void relativePermeabilities(ContainerT& values,
+                                       const Params& params,
+                                       const FluidState& fluidState)
+    {
+        Scalar result[numPhases];
+        Scalar dResult_dS[numPhases][numPhases];
+        relativePermeabilities(result, dResult_dS, params, fluidState);
+        applyChainRule(values, fluidState, result, dResult_dS);
+    }
+
+    /*!
+     * \brief Calculate the capillary pressures of all phases for a fluid state with
+     *        arbitrary evaluations.
+     *
+     * This is equivalent to MaterialLaw::capillaryPressures().
+     */
+    template <class ContainerT, class FluidState>
+    static void capillaryPressures(ContainerT& values,
+                                   const Params& params,
+                                   const FluidState& fluidState)
+    {
+        Scalar result[numPhases];
+        Scalar dResult_dS[numPhases][numPhases];
+        capillaryPressures(result, dResult_dS, params, fluidState);
+        applyChainRule(values, fluidState, result, dResult_dS);
+    }
+
+    /*!
+     * \brief Convert quantities and their derivatives with respect to the saturations to
+     *        the evaluation type of a fluid state.
+     *
+     * The values are assumed to correspond to the saturations of the fluid state.
+     */
+    template <class ContainerT, class FluidState>
+    static void applyChainRule(ContainerT& values,
+                               const FluidState& fluidState,
+                               const Scalar* result,
+                               const Scalar (*dResult_dS)[numPhases])
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        Scalar referenceSaturations[numPhases];
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            referenceSaturations[phaseIdx] = FsToolbox::value(fluidState.saturation(phaseIdx));
+        extrapolate(values, fluidState, referenceSaturations, result, dResult_dS);
+    }
+
+    /*!
+     * \brief Extrapolate quantities which have been computed for a set of reference
+     *        saturations linearly to the saturations of a fluid state.
+     *
+     * This also yields the derivatives with respect to the primary variables if the
+     * saturations of the fluid state are function evaluations.
+     */
+    template <class ContainerT, class FluidState>
+    static void extrapolate(ContainerT& values,
+                            const FluidState& fluidState,
+                            const Scalar* referenceSaturations,
+                            const Scalar* result,
+                            const Scalar (*dResult_dS)[numPhases])
+    {
+        typedef typename FluidState::Scalar Evaluation;
+        typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+        Evaluation deltaS[numPhases];
+        for (int satIdx = 0; satIdx < numPhases; ++satIdx)
+            deltaS[satIdx] = fluidState.saturation(satIdx) - referenceSaturations[satIdx];
+
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            Evaluation value = Toolbox::createConstant(result[phaseIdx]);
+            for (int satIdx = 0; satIdx < numPhases; ++satIdx)
+                if (dResult_dS[phaseIdx][satIdx] != 0.0)
+                    value += dResult_dS[phaseIdx][satIdx]*deltaS[satIdx];
+            values[phaseIdx] = value;
+        }
+    }
+
+    /*!
+     * \brief The relative permeability of the wetting phase of a two-phase law and its
+     *        derivative with respect to the wetting phase saturation.
+     */
+    static Scalar twoPhaseSatKrw(const Params& params, Scalar Sw, Scalar& dKrw_dSw)
+    { return unpack_(MaterialLaw::twoPhaseSatKrw(params, satVariable_(Sw)), dKrw_dSw); }
+
+    /*!
+     * \brief The relative permeability of the non-wetting phase of a two-phase law and
+     *        its derivative with respect to the wetting phase saturation.
+     */
+    static Scalar twoPhaseSatKrn(const Params& params, Scalar Sw, Scalar& dKrn_dSw)
+    { return unpack_(MaterialLaw::twoPhaseSatKrn(params, satVariable_(Sw)), dKrn_dSw); }
+
+    /*!
+     * \brief The capillary pressure of a two-phase law and its derivative with respect
+     *        to the wetting phase saturation.
+     */
+    static Scalar twoPhaseSatPcnw(const Params& params, Scalar Sw, Scalar& dPcnw_dSw)
+    { return unpack_(MaterialLaw::twoPhaseSatPcnw(params, satVariable_(Sw)), dPcnw_dSw); }
+
+    /*!
+     * \brief Convert a function of a single saturation to the evaluation type of the
+     *        saturation.
+     */
+    template <class Evaluation>
+    static Evaluation chainRule(Scalar value, Scalar dValue_dS, const Evaluation& S)
+    {
+        typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+        Evaluation result = Toolbox::createConstant(value);
+        if (dValue_dS != 0.0)
+            result += dValue_dS*(S - Toolbox::value(S));
+        return result;
+    }
+
+private:
+    typedef Opm::SimpleModularFluidState<SatEval,
+                                         numPhases,
+                                         /*numComponents=*/0,
+                                         /*FluidSystem=*/void, /* -> don't care */
+                                         /*storePressure=*/false,
+                                         /*storeTemperature=*/false,
+                                         /*storeComposition=*/false,
+                                         /*storeFugacity=*/false,
+                                         /*storeSaturation=*/true,
+                                         /*storeDensity=*/false,
+                                         /*storeViscosity=*/false,
+                                         /*storeEnthalpy=*/false> SatFluidState_;
+
+    static void prepare_(SatEval* satValues,
+                         SatFluidState_& satFluidState,
+                         const Scalar* saturations)
+    {
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            satFluidState.setSaturation(phaseIdx,
+                                        SatEval::createVariable(saturations[phaseIdx], phaseIdx));
+
+            // the two-phase laws only set the quantities of the phases which they
+            // consider
+            satValues[phaseIdx] = SatEval::createConstant(0.0);
+        }
+    }
+
+    static void unpack_(Scalar* values,
+                        Scalar (*dValues_dS)[numPhases],
+                        const SatEval* satValues)
+    {
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            values[phaseIdx] = satValues[phaseIdx].value;
+            for (int satIdx = 0; satIdx < numPhases; ++satIdx)
+                dValues_dS[phaseIdx][satIdx] = satValues[phaseIdx].derivatives[satIdx];
+        }
+    }
+
+    static TwoPhaseSatEval satVariable_(Scalar Sw)
+    { return TwoPhaseSatEval::createVariable(Sw, 0); }
+
+    static Scalar unpack_(const TwoPhaseSatEval& value, Scalar& dValue_dSw)
+    {
+        dValue_dSw = value.derivatives[0];
+        return value.value;
+    }
+};
+} // namespace Opm
+
+#endif
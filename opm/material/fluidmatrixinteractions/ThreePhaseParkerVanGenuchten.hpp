@@ -30,8 +30,10 @@
 #include "ThreePhaseParkerVanGenuchtenParams.hpp"
 
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
 
 #include <algorithm>
+#include <cstddef>
 
 namespace Opm {
 /*!
@@ -44,6 +46,12 @@ namespace Opm {
  * Reference: J.B. Kool, J.C. Parker, M.Th. van Genuchten: Parameter
  * Estimation for Unsaturated Flow and Transport Models -- A Review;
  * Journal of Hydrology, 91 (1987) 255-293
+ *
+ * Besides the usual API, relativePermeabilitiesBatch() and
+ * capillaryPressuresBatch() evaluate the curves for many cells at once.
+ * If the shape functions of the curves are tabulated (see
+ * Params::setNumTabulationSamples()), all methods interpolate the tables
+ * instead of evaluating the powers.
  */
 template <class TraitsT,
           class ParamsT = ThreePhaseParkerVanGenuchtenParams<TraitsT> >
@@ -87,6 +95,27 @@ public:
     //! are dependent on the phase composition
     static const bool isCompositionDependent = false;
 
+    /*!
+     * \brief The relative permeabilities of the wetting phase and of gas only depend on
+     *        the respective saturation, the one of the non-wetting liquid also depends on
+     *        the saturation of the wetting phase.
+     */
+    static constexpr unsigned relativePermeabilityDependencies(int phaseIdx)
+    {
+        return
+            (phaseIdx == nonWettingPhaseIdx) ? ((1u << wettingPhaseIdx) | (1u << nonWettingPhaseIdx))
+            : (1u << phaseIdx);
+    }
+
+    //! The capillary pressures only depend on the saturations of the liquid phases
+    static constexpr unsigned capillaryPressureDependencies(int phaseIdx)
+    {
+        return
+            (phaseIdx == wettingPhaseIdx) ? (1u << wettingPhaseIdx)
+            : (phaseIdx == gasPhaseIdx) ? ((1u << wettingPhaseIdx) | (1u << nonWettingPhaseIdx))
+            : 0u;
+    }
+
     /*!
      * \brief Implements the three phase capillary pressure law
      *        proposed by Parker and van Genuchten.
@@ -123,47 +152,13 @@ public:
     static Evaluation pcgn(const Params &params, const FluidState &fluidState)
     {
         typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
-        typedef MathToolbox<Evaluation> Toolbox;
-
-        Scalar PC_VG_REG = 0.01;
 
         // sum of liquid saturations
         const auto& St =
             FsToolbox::template toLhs<Evaluation>(fluidState.saturation(wettingPhaseIdx))
             + FsToolbox::template toLhs<Evaluation>(fluidState.saturation(nonWettingPhaseIdx));
 
-        Evaluation Se = (St - params.Swrx())/(1. - params.Swrx());
-
-        // regularization
-        if (Se < 0.0)
-            Se=0.0;
-        if (Se > 1.0)
-            Se=1.0;
-
-        if (Se>PC_VG_REG && Se<1-PC_VG_REG)
-        {
-            const Evaluation& x = Toolbox::pow(Se,-1/params.vgM()) - 1;
-            return Toolbox::pow(x, 1.0 - params.vgM())/params.vgAlpha();
-        }
-
-        // value and derivative at regularization point
-        Scalar Se_regu;
-        if (Se<=PC_VG_REG)
-            Se_regu = PC_VG_REG;
-        else
-            Se_regu = 1-PC_VG_REG;
-        const Evaluation& x = std::pow(Se_regu,-1/params.vgM())-1;
-        const Evaluation& pc = Toolbox::pow(x, 1.0/params.vgN())/params.vgAlpha();
-        const Evaluation& pc_prime =
-            Toolbox::pow(x, 1/params.vgN()-1)
-            * std::pow(Se_regu,-1/params.vgM()-1)
-            / (-params.vgM())
-            / params.vgAlpha()
-            / (1 - params.Sgr() - params.Swrx())
-            / params.vgN();
-
-        // evaluate tangential
-        return ((Se-Se_regu)*pc_prime + pc)/params.betaGN();
+        return pcgnFromSt_<Evaluation>(params, St);
     }
 
     /*!
@@ -179,45 +174,11 @@ public:
     static Evaluation pcnw(const Params &params, const FluidState &fluidState)
     {
         typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
-        typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& Sw =
             FsToolbox::template toLhs<Evaluation>(fluidState.saturation(wettingPhaseIdx));
-        Evaluation Se = (Sw-params.Swr())/(1.-params.Snr());
-
-        Scalar PC_VG_REG = 0.01;
-
-        // regularization
-        if (Se<0.0)
-            Se=0.0;
-        if (Se>1.0)
-            Se=1.0;
-
-        if (Se>PC_VG_REG && Se<1-PC_VG_REG) {
-            Evaluation x = Toolbox::pow(Se,-1/params.vgM()) - 1.0;
-            x = Toolbox::pow(x, 1 - params.vgM());
-            return x/params.vgAlpha();
-        }
 
-        // value and derivative at regularization point
-        Scalar Se_regu;
-        if (Se<=PC_VG_REG)
-            Se_regu = PC_VG_REG;
-        else
-            Se_regu = 1.0 - PC_VG_REG;
-
-        const Evaluation& x = std::pow(Se_regu,-1/params.vgM())-1;
-        const Evaluation& pc = Toolbox::pow(x, 1/params.vgN())/params.vgAlpha();
-        const Evaluation& pc_prime =
-            Toolbox::pow(x,1/params.vgN()-1)
-            * std::pow(Se_regu, -1.0/params.vgM() - 1)
-            / (-params.vgM())
-            / params.vgAlpha()
-            / (1-params.Snr()-params.Swr())
-            / params.vgN();
-
-        // evaluate tangential
-        return ((Se-Se_regu)*pc_prime + pc)/params.betaNW();
+        return pcnwFromSw_<Evaluation>(params, Sw);
     }
 
     /*!
@@ -278,19 +239,11 @@ public:
     static Evaluation krw(const Params &params, const FluidState &fluidState)
     {
         typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
-        typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& Sw =
             FsToolbox::template toLhs<Evaluation>(fluidState.saturation(wettingPhaseIdx));
-        // transformation to effective saturation
-        const Evaluation& Se = (Sw - params.Swr()) / (1-params.Swr());
-
-        // regularization
-        if(Se > 1.0) return 1.;
-        if(Se < 0.0) return 0.;
 
-        const Evaluation& r = 1. - Toolbox::pow(1 - Toolbox::pow(Se, 1/params.vgM()), params.vgM());
-        return Toolbox::sqrt(Se)*r*r;
+        return krwFromSw_<Evaluation>(params, Sw);
     }
 
     /*!
@@ -309,23 +262,205 @@ public:
     static Evaluation krn(const Params &params, const FluidState &fluidState)
     {
         typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
-        typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& Sn =
             FsToolbox::template toLhs<Evaluation>(fluidState.saturation(nonWettingPhaseIdx));
         const Evaluation& Sw =
             FsToolbox::template toLhs<Evaluation>(fluidState.saturation(wettingPhaseIdx));
-        Evaluation Swe = Toolbox::min((Sw - params.Swr()) / (1 - params.Swr()), 1.);
-        Evaluation Ste = Toolbox::min((Sw + Sn - params.Swr()) / (1 - params.Swr()), 1.);
+
+        return krnFromSwSn_<Evaluation>(params, Sw, Sn);
+    }
+
+    /*!
+     * \brief The relative permeability for the non-wetting phase
+     *        of the medium implied by van Genuchten's
+     *        parameterization.
+     *
+     * The permeability of gas in a three-phase system equals the
+     * standard two-phase description. (see p61. of "Comparison of the
+     * Three-Phase Oil Relative Permeability Models" M.  Delshad and
+     * G. A. Pope, Transport in Porous Media 4 (1989), 59-83.)
+     */
+    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    static Evaluation krg(const Params &params, const FluidState &fluidState)
+    {
+        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        const Evaluation& Sg =
+            FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
+
+        return krgFromSg_<Evaluation>(params, Sg);
+    }
+
+    /*!
+     * \brief Evaluate the relative permeabilities of all phases for a batch
+     *        of cells.
+     *
+     * The saturations and the results are passed in structure-of-arrays
+     * layout, i.e., each quantity is a contiguous array with one entry per
+     * cell. The results are identical to the ones of
+     * relativePermeabilities() for scalar saturations.
+     *
+     * \param params An array of n pointers to the parameter objects of the cells
+     * \param Sw The array of water saturations
+     * \param Sn The array of NAPL saturations
+     * \param Sg The array of gas saturations
+     * \param krw The array in which the relative permeabilities of water are stored
+     * \param krn The array in which the relative permeabilities of NAPL are stored
+     * \param krg The array in which the relative permeabilities of gas are stored
+     * \param n The number of cells of the batch
+     */
+    static void relativePermeabilitiesBatch(const Params* const* params,
+                                            const Scalar* Sw,
+                                            const Scalar* Sn,
+                                            const Scalar* Sg,
+                                            Scalar* krw,
+                                            Scalar* krn,
+                                            Scalar* krg,
+                                            size_t n)
+    {
+        OPM_PROFILER_RANGE("ThreePhaseParkerVanGenuchten::relativePermeabilitiesBatch");
+
+        for (size_t i = 0; i < n; ++i) {
+            const Params& p = *params[i];
+            krw[i] = krwFromSw_<Scalar>(p, Sw[i]);
+            krn[i] = krnFromSwSn_<Scalar>(p, Sw[i], Sn[i]);
+            krg[i] = krgFromSg_<Scalar>(p, Sg[i]);
+        }
+    }
+
+    /*!
+     * \brief Evaluate the capillary pressures for a batch of cells.
+     *
+     * The saturations and the results are passed in structure-of-arrays
+     * layout. In contrast to capillaryPressures(), the results are
+     * \f$p_{c,gn} = p_g - p_n\f$ and \f$p_{c,nw} = p_n - p_w\f$, i.e., the
+     * values of pcgn() and pcnw().
+     *
+     * \param params An array of n pointers to the parameter objects of the cells
+     * \param Sw The array of water saturations
+     * \param Sn The array of NAPL saturations
+     * \param pcgn The array in which the gas-NAPL capillary pressures are stored
+     * \param pcnw The array in which the NAPL-water capillary pressures are stored
+     * \param n The number of cells of the batch
+     */
+    static void capillaryPressuresBatch(const Params* const* params,
+                                        const Scalar* Sw,
+                                        const Scalar* Sn,
+                                        Scalar* pcgn,
+                                        Scalar* pcnw,
+                                        size_t n)
+    {
+        OPM_PROFILER_RANGE("ThreePhaseParkerVanGenuchten::capillaryPressuresBatch");
+
+        for (size_t i = 0; i < n; ++i) {
+            const Params& p = *params[i];
+            pcgn[i] = pcgnFromSt_<Scalar>(p, Sw[i] + Sn[i]);
+            pcnw[i] = pcnwFromSw_<Scalar>(p, Sw[i]);
+        }
+    }
+
+private:
+    // (1 - S^(1/m))^m, which appears in all relative permeabilities
+    template <class Evaluation>
+    static Evaluation krShape_(const Params &params, const Evaluation& S)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (params.tabulated())
+            return params.krShapeTable().eval(S);
+
+        return Toolbox::pow(1 - Toolbox::pow(S, params.vgMInv()), params.vgM());
+    }
+
+    // (Se^(-1/m) - 1)^(1 - m), i.e., alpha times the capillary pressure
+    // between the regularization points
+    template <class Evaluation>
+    static Evaluation pcShape_(const Params &params, const Evaluation& Se)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (params.tabulated())
+            return params.pcShapeTable().eval(Se);
+
+        const Evaluation& x = Toolbox::pow(Se, -params.vgMInv()) - 1;
+        return Toolbox::pow(x, params.pcExponent());
+    }
+
+    template <class Evaluation>
+    static Evaluation pcgnFromSt_(const Params &params, const Evaluation& St)
+    {
+        Scalar PC_VG_REG = Params::pcRegularizationSe();
+
+        Evaluation Se = (St - params.Swrx())*params.oneMinusSwrxInv();
+
+        // regularization
+        if (Se < 0.0)
+            Se=0.0;
+        if (Se > 1.0)
+            Se=1.0;
+
+        if (Se>PC_VG_REG && Se<1-PC_VG_REG)
+            return pcShape_(params, Se)/params.vgAlpha();
+
+        // evaluate tangential
+        if (Se<=PC_VG_REG)
+            return ((Se - PC_VG_REG)*params.pcgnSlopeLow() + params.pcgnLow())/params.betaGN();
+        return ((Se - (1 - PC_VG_REG))*params.pcgnSlopeHigh() + params.pcgnHigh())/params.betaGN();
+    }
+
+    template <class Evaluation>
+    static Evaluation pcnwFromSw_(const Params &params, const Evaluation& Sw)
+    {
+        Scalar PC_VG_REG = Params::pcRegularizationSe();
+
+        Evaluation Se = (Sw - params.Swr())*params.oneMinusSnrInv();
+
+        // regularization
+        if (Se<0.0)
+            Se=0.0;
+        if (Se>1.0)
+            Se=1.0;
+
+        if (Se>PC_VG_REG && Se<1-PC_VG_REG)
+            return pcShape_(params, Se)/params.vgAlpha();
+
+        // evaluate tangential
+        if (Se<=PC_VG_REG)
+            return ((Se - PC_VG_REG)*params.pcnwSlopeLow() + params.pcnwLow())/params.betaNW();
+        return ((Se - (1 - PC_VG_REG))*params.pcnwSlopeHigh() + params.pcnwHigh())/params.betaNW();
+    }
+
+    template <class Evaluation>
+    static Evaluation krwFromSw_(const Params &params, const Evaluation& Sw)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        // transformation to effective saturation
+        const Evaluation& Se = (Sw - params.Swr())*params.oneMinusSwrInv();
+
+        // regularization
+        if(Se > 1.0) return 1.;
+        if(Se < 0.0) return 0.;
+
+        const Evaluation& r = 1. - krShape_(params, Se);
+        return Toolbox::sqrt(Se)*r*r;
+    }
+
+    template <class Evaluation>
+    static Evaluation krnFromSwSn_(const Params &params, const Evaluation& Sw, const Evaluation& Sn)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        Evaluation Swe = Toolbox::min((Sw - params.Swr())*params.oneMinusSwrInv(), 1.);
+        Evaluation Ste = Toolbox::min((Sw + Sn - params.Swr())*params.oneMinusSwrInv(), 1.);
 
         // regularization
         if(Swe <= 0.0) Swe = 0.;
         if(Ste <= 0.0) Ste = 0.;
         if(Ste - Swe <= 0.0) return 0.;
 
-        Evaluation krn_;
-        krn_ = Toolbox::pow(1 - Toolbox::pow(Swe, 1/params.vgM()), params.vgM());
-        krn_ -= Toolbox::pow(1 - Toolbox::pow(Ste, 1/params.vgM()), params.vgM());
+        Evaluation krn_ = krShape_(params, Swe) - krShape_(params, Ste);
         krn_ *= krn_;
 
         if (params.krRegardsSnr())
@@ -333,35 +468,21 @@ public:
             // regard Snr in the permeability of the non-wetting
             // phase, see Helmig1997
             const Evaluation& resIncluded =
-                Toolbox::max(Toolbox::min(Sw - params.Snr() / (1-params.Swr()), 1.0), 0.0);
+                Toolbox::max(Toolbox::min(Sw - params.Snr()*params.oneMinusSwrInv(), 1.0), 0.0);
             krn_ *= Toolbox::sqrt(resIncluded );
         }
         else
-            krn_ *= Toolbox::sqrt(Sn / (1 - params.Swr()));
+            krn_ *= Toolbox::sqrt(Sn*params.oneMinusSwrInv());
 
         return krn_;
     }
 
-
-    /*!
-     * \brief The relative permeability for the non-wetting phase
-     *        of the medium implied by van Genuchten's
-     *        parameterization.
-     *
-     * The permeability of gas in a three-phase system equals the
-     * standard two-phase description. (see p61. of "Comparison of the
-     * Three-Phase Oil Relative Permeability Models" M.  Delshad and
-     * G. A. Pope, Transport in Porous Media 4 (1989), 59-83.)
-     */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
-    static Evaluation krg(const Params &params, const FluidState &fluidState)
+    template <class Evaluation>
+    static Evaluation krgFromSg_(const Params &params, const Evaluation& Sg)
     {
-        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& Sg =
-            FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
-        const Evaluation& Se = Toolbox::min(((1-Sg) - params.Sgr()) / (1 - params.Sgr()), 1.);
+        const Evaluation& Se = Toolbox::min(((1-Sg) - params.Sgr())*params.oneMinusSgrInv(), 1.);
 
         // regularization
         if(Se > 1.0)
@@ -376,9 +497,11 @@ public:
                 return 0.0;
         }
 
+        // (1 - Se^(1/m))^(2m) is the square of the shape function
+        const Evaluation& f = krShape_(params, Se);
         return scaleFactor
             * Toolbox::pow(1 - Se, 1.0/3.)
-            * Toolbox::pow(1 - Toolbox::pow(Se, 1/params.vgM()), 2*params.vgM());
+            * f*f;
     }
 };
 } // namespace Opm
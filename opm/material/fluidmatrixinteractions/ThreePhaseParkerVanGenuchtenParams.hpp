@@ -32,8 +32,11 @@
 
 #include <opm/material/common/ErrorMacros.hpp>
 #include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/UniformMonotoneTable.hpp>
 
+#include <array>
 #include <cassert>
+#include <cmath>
 
 namespace Opm {
 /*!
@@ -45,6 +48,12 @@ namespace Opm {
  * In comparison to the two-phase version, this parameter object also
  * includes the residual saturations, as their handling is very
  * model-specific.
+ *
+ * finalize() precomputes the reciprocals of the exponents and of the
+ * saturation ranges as well as the values and the slopes of the
+ * capillary pressure curves at the regularization thresholds. These
+ * quantities are thus not recomputed for each evaluation of the
+ * material law.
  */
 template<class TraitsT>
 class ThreePhaseParkerVanGenuchtenParams
@@ -58,6 +67,9 @@ public:
         betaNW_ = 1.0;
         betaGN_ = 1.0;
 
+        numTabulationSamples_ = 0;
+        tabulated_ = false;
+
 #ifndef NDEBUG
         finalized_ = false;
 #endif
@@ -68,11 +80,55 @@ public:
      */
     void finalize()
     {
+        vgMInv_ = 1/vgM_;
+        vgNInv_ = 1/vgN_;
+        pcExponent_ = 1 - vgM_;
+
+        oneMinusSwrInv_ = 1/(1 - Swr_);
+        oneMinusSnrInv_ = 1/(1 - Snr_);
+        oneMinusSgrInv_ = 1/(1 - Sgr_);
+        oneMinusSwrxInv_ = 1/(1 - Swrx_);
+
+        // value and derivative of the capillary pressure curves at the
+        // regularization points
+        Scalar SeLow = pcRegularizationSe();
+        Scalar SeHigh = 1 - pcRegularizationSe();
+        pcgnLow_ = regularizationPc_(SeLow);
+        pcgnHigh_ = regularizationPc_(SeHigh);
+        pcgnSlopeLow_ = regularizationPcSlope_(SeLow, 1 - Sgr_ - Swrx_);
+        pcgnSlopeHigh_ = regularizationPcSlope_(SeHigh, 1 - Sgr_ - Swrx_);
+        pcnwLow_ = pcgnLow_;
+        pcnwHigh_ = pcgnHigh_;
+        pcnwSlopeLow_ = regularizationPcSlope_(SeLow, 1 - Snr_ - Swr_);
+        pcnwSlopeHigh_ = regularizationPcSlope_(SeHigh, 1 - Snr_ - Swr_);
+
 #ifndef NDEBUG
         finalized_ = true;
 #endif
+
+        tabulated_ = false;
+        if (numTabulationSamples_ > 0) {
+            Scalar m = vgM_;
+            Scalar mInv = vgMInv_;
+            Scalar pcExp = pcExponent_;
+            krShapeTable_.init(0.0, 1.0, numTabulationSamples_,
+                               [m, mInv](Scalar S)
+                               { return std::pow(1 - std::pow(S, mInv), m); });
+            pcShapeTable_.init(SeLow, SeHigh, numTabulationSamples_,
+                               [mInv, pcExp](Scalar Se)
+                               { return std::pow(std::pow(Se, -mInv) - 1, pcExp); });
+            tabulated_ = true;
+        }
     }
 
+    /*!
+     * \brief Return the effective saturation below which (and above
+     *        one minus which) the capillary pressure curves are
+     *        continued by straight lines.
+     */
+    static Scalar pcRegularizationSe()
+    { return 0.01; }
+
     /*!
      * \brief Return the \f$\alpha\f$ shape parameter of van Genuchten's
      *        curve.
@@ -193,6 +249,139 @@ public:
     bool krRegardsSnr() const
     { assertFinalized_(); return krRegardsSnr_; }
 
+    /*!
+     * \brief Return \f$1/m\f$.
+     */
+    Scalar vgMInv() const
+    { assertFinalized_(); return vgMInv_; }
+
+    /*!
+     * \brief Return \f$1/n\f$.
+     */
+    Scalar vgNInv() const
+    { assertFinalized_(); return vgNInv_; }
+
+    /*!
+     * \brief Return the exponent \f$1 - m\f$ of the capillary pressure
+     *        curves.
+     */
+    Scalar pcExponent() const
+    { assertFinalized_(); return pcExponent_; }
+
+    /*!
+     * \brief Return \f$1/(1 - S_{wr})\f$.
+     */
+    Scalar oneMinusSwrInv() const
+    { assertFinalized_(); return oneMinusSwrInv_; }
+
+    /*!
+     * \brief Return \f$1/(1 - S_{nr})\f$.
+     */
+    Scalar oneMinusSnrInv() const
+    { assertFinalized_(); return oneMinusSnrInv_; }
+
+    /*!
+     * \brief Return \f$1/(1 - S_{gr})\f$.
+     */
+    Scalar oneMinusSgrInv() const
+    { assertFinalized_(); return oneMinusSgrInv_; }
+
+    /*!
+     * \brief Return \f$1/(1 - S_{wrx})\f$.
+     */
+    Scalar oneMinusSwrxInv() const
+    { assertFinalized_(); return oneMinusSwrxInv_; }
+
+    /*!
+     * \brief Return the unscaled gas-NAPL capillary pressure at the low
+     *        regularization point and the slope of its continuation.
+     */
+    Scalar pcgnLow() const
+    { assertFinalized_(); return pcgnLow_; }
+
+    Scalar pcgnSlopeLow() const
+    { assertFinalized_(); return pcgnSlopeLow_; }
+
+    /*!
+     * \brief Return the unscaled gas-NAPL capillary pressure at the high
+     *        regularization point and the slope of its continuation.
+     */
+    Scalar pcgnHigh() const
+    { assertFinalized_(); return pcgnHigh_; }
+
+    Scalar pcgnSlopeHigh() const
+    { assertFinalized_(); return pcgnSlopeHigh_; }
+
+    /*!
+     * \brief Return the unscaled NAPL-water capillary pressure at the low
+     *        regularization point and the slope of its continuation.
+     */
+    Scalar pcnwLow() const
+    { assertFinalized_(); return pcnwLow_; }
+
+    Scalar pcnwSlopeLow() const
+    { assertFinalized_(); return pcnwSlopeLow_; }
+
+    /*!
+     * \brief Return the unscaled NAPL-water capillary pressure at the high
+     *        regularization point and the slope of its continuation.
+     */
+    Scalar pcnwHigh() const
+    { assertFinalized_(); return pcnwHigh_; }
+
+    Scalar pcnwSlopeHigh() const
+    { assertFinalized_(); return pcnwSlopeHigh_; }
+
+    /*!
+     * \brief Specify the number of sampling points used to tabulate the
+     *        shape functions of the curves.
+     *
+     * If this is larger than zero, finalize() tabulates the function
+     * \f$(1 - S^{1/m})^m\f$ which appears in all relative permeabilities
+     * and the function \f$(S_e^{-1/m} - 1)^{1 - m}\f$ of the capillary
+     * pressures on uniform grids. The material law then interpolates
+     * these tables instead of evaluating the powers, at the cost of
+     * accuracy, see tabulationError(). By default, the curves are not
+     * tabulated.
+     */
+    void setNumTabulationSamples(unsigned value)
+    { numTabulationSamples_ = value; }
+
+    /*!
+     * \brief Returns true if the material law ought to use the tabulated
+     *        shape functions.
+     */
+    bool tabulated() const
+    { return tabulated_; }
+
+    /*!
+     * \brief Returns the table of \f$(1 - S^{1/m})^m\f$ for \f$0 \leq S \leq 1\f$.
+     */
+    const UniformMonotoneTable<Scalar>& krShapeTable() const
+    { assertFinalized_(); return krShapeTable_; }
+
+    /*!
+     * \brief Returns the table of \f$(S_e^{-1/m} - 1)^{1 - m}\f$ between the
+     *        regularization points.
+     */
+    const UniformMonotoneTable<Scalar>& pcShapeTable() const
+    { assertFinalized_(); return pcShapeTable_; }
+
+    /*!
+     * \brief Returns the estimated maximum deviation of the tabulated shape
+     *        functions from the analytic ones.
+     *
+     * The first entry is the error of the shape function of the relative
+     * permeabilities, the second one is the error of the one of the
+     * capillary pressures, i.e., the error of \f$\alpha p_c\f$.
+     */
+    std::array<Scalar, 2> tabulationError() const
+    {
+        assertFinalized_();
+        std::array<Scalar, 2> err = {{ krShapeTable_.maxError(), pcShapeTable_.maxError() }};
+        return err;
+    }
+
     void checkDefined() const
     {
         Valgrind::CheckDefined(vgAlpha_);
@@ -218,6 +407,26 @@ private:
     { }
 #endif
 
+    // the expressions are the ones which were used by the material law
+    // before they were precomputed, so the results do not change
+    Scalar regularizationPc_(Scalar SeRegu) const
+    {
+        Scalar x = std::pow(SeRegu, -1/vgM_) - 1;
+        return std::pow(x, 1/vgN_)/vgAlpha_;
+    }
+
+    Scalar regularizationPcSlope_(Scalar SeRegu, Scalar denom) const
+    {
+        Scalar x = std::pow(SeRegu, -1/vgM_) - 1;
+        return
+            std::pow(x, 1/vgN_ - 1)
+            * std::pow(SeRegu, -1/vgM_ - 1)
+            / (-vgM_)
+            / vgAlpha_
+            / denom
+            / vgN_;
+    }
+
     Scalar vgAlpha_;
     Scalar vgM_;
     Scalar vgN_;
@@ -230,6 +439,28 @@ private:
     Scalar betaGN_;
 
     bool krRegardsSnr_ ;
+
+    Scalar vgMInv_;
+    Scalar vgNInv_;
+    Scalar pcExponent_;
+    Scalar oneMinusSwrInv_;
+    Scalar oneMinusSnrInv_;
+    Scalar oneMinusSgrInv_;
+    Scalar oneMinusSwrxInv_;
+
+    Scalar pcgnLow_;
+    Scalar pcgnSlopeLow_;
+    Scalar pcgnHigh_;
+    Scalar pcgnSlopeHigh_;
+    Scalar pcnwLow_;
+    Scalar pcnwSlopeLow_;
+    Scalar pcnwHigh_;
+    Scalar pcnwSlopeHigh_;
+
+    unsigned numTabulationSamples_;
+    bool tabulated_;
+    UniformMonotoneTable<Scalar> krShapeTable_;
+    UniformMonotoneTable<Scalar> pcShapeTable_;
 };
 } // namespace Opm
 
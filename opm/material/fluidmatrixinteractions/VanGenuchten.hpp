@@ -29,6 +29,7 @@
 #include "VanGenuchtenParams.hpp"
 
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/SimdPack.hpp>
 
 #include <algorithm>
 #include <cmath>
@@ -93,6 +94,14 @@ public:
     //! are dependent on the phase composition
     static const bool isCompositionDependent = false;
 
+    //! The relative permeability of each phase only depends on its own saturation
+    static constexpr unsigned relativePermeabilityDependencies(int phaseIdx)
+    { return 1u << phaseIdx; }
+
+    //! The capillary pressure only depends on the saturation of the wetting phase
+    static constexpr unsigned capillaryPressureDependencies(int phaseIdx)
+    { return (phaseIdx == Traits::nonWettingPhaseIdx) ? (1u << Traits::wettingPhaseIdx) : 0u; }
+
     /*!
      * \brief The capillary pressure-saturation curves according to van Genuchten.
      *
@@ -172,7 +181,7 @@ public:
         const Evaluation& Sw =
             FsToolbox::template toLhs<Evaluation>(fs.saturation(Traits::wettingPhaseIdx));
 
-        assert(0 <= Sw && Sw <= 1);
+        assert(allTrue(0 <= Sw && Sw <= 1));
 
         return twoPhaseSatPcnw(params, Sw);
     }
@@ -196,7 +205,12 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        return Toolbox::pow(Toolbox::pow(Sw, -1.0/params.vgM()) - 1, 1.0/params.vgN())/params.vgAlpha();
+        if (params.fusedEvaluation())
+            return
+                Toolbox::exp(params.vgNInv()*Toolbox::log(Toolbox::exp(-params.vgMInv()*Toolbox::log(Sw)) - 1))
+                /params.vgAlpha();
+
+        return Toolbox::pow(Toolbox::pow(Sw, -params.vgMInv()) - 1, params.vgNInv())/params.vgAlpha();
     }
 
     /*!
@@ -227,7 +241,10 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        assert(pC >= 0);
+        assert(allTrue(pC >= 0));
+
+        if (params.fusedEvaluation())
+            return Toolbox::exp(-params.vgM()*Toolbox::log(Toolbox::exp(params.vgN()*Toolbox::log(params.vgAlpha()*pC)) + 1));
 
         return Toolbox::pow(Toolbox::pow(params.vgAlpha()*pC, params.vgN()) + 1, -params.vgM());
     }
@@ -270,9 +287,13 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        assert(0.0 <= Sw && Sw <= 1.0);
+        assert(allTrue(0.0 <= Sw && Sw <= 1.0));
 
-        Evaluation r = 1.0 - Toolbox::pow(1.0 - Toolbox::pow(Sw, 1/params.vgM()), params.vgM());
+        Evaluation r;
+        if (params.fusedEvaluation())
+            r = 1.0 - Toolbox::exp(params.vgM()*Toolbox::log(1.0 - Toolbox::exp(params.vgMInv()*Toolbox::log(Sw))));
+        else
+            r = 1.0 - Toolbox::pow(1.0 - Toolbox::pow(Sw, params.vgMInv()), params.vgM());
         return Toolbox::sqrt(Sw)*r*r;
     }
 
@@ -301,11 +322,17 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        assert(0 <= Sw && Sw <= 1);
+        assert(allTrue(0 <= Sw && Sw <= 1));
+
+        if (params.fusedEvaluation())
+            // the product of the two powers becomes a single exponential
+            return
+                Toolbox::exp(Toolbox::log(1 - Sw)/3
+                             + 2*params.vgM()*Toolbox::log(1 - Toolbox::exp(params.vgMInv()*Toolbox::log(Sw))));
 
         return
             Toolbox::pow(1 - Sw, 1.0/3) *
-            Toolbox::pow(1 - Toolbox::pow(Sw, 1/params.vgM()), 2*params.vgM());
+            Toolbox::pow(1 - Toolbox::pow(Sw, params.vgMInv()), 2*params.vgM());
     }
 };
 } // namespace Opm
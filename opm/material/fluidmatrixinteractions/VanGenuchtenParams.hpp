@@ -47,6 +47,7 @@ public:
     typedef TraitsT Traits;
 
     VanGenuchtenParams()
+        : fusedEvaluation_(false)
     {
 #ifndef NDEBUG
         finalized_ = false;
@@ -54,6 +55,7 @@ public:
     }
 
     VanGenuchtenParams(Scalar vgAlpha, Scalar vgN)
+        : fusedEvaluation_(false)
     {
         setVgAlpha(vgAlpha);
         setVgN(vgN);
@@ -66,6 +68,9 @@ public:
      */
     void finalize()
     {
+        vgMInv_ = 1/vgM_;
+        vgNInv_ = 1/vgN_;
+
 #ifndef NDEBUG
         finalized_ = true;
 #endif
@@ -117,6 +122,37 @@ public:
     void setVgN(Scalar n)
     { vgN_ = n; vgM_ = 1 - 1/vgN_; }
 
+    /*!
+     * \brief Return \f$1/m\f$ of van Genuchten's curve.
+     */
+    Scalar vgMInv() const
+    { assertFinalized_(); return vgMInv_; }
+
+    /*!
+     * \brief Return \f$1/n\f$ of van Genuchten's curve.
+     */
+    Scalar vgNInv() const
+    { assertFinalized_(); return vgNInv_; }
+
+    /*!
+     * \brief Specify whether the nested powers of van Genuchten's curves are
+     *        evaluated in logarithmic space.
+     *
+     * If enabled, expressions like \f$(1 - S_w^{1/m})^m\f$ are calculated using
+     * exp() and log() directly and products of powers are combined into a single
+     * exponential. This saves some transcendental function calls, but the results
+     * may differ from the default evaluation in the last few digits.
+     */
+    void setFusedEvaluation(bool yesno)
+    { fusedEvaluation_ = yesno; }
+
+    /*!
+     * \brief Returns true if the nested powers of van Genuchten's curves are
+     *        evaluated in logarithmic space.
+     */
+    bool fusedEvaluation() const
+    { return fusedEvaluation_; }
+
 private:
 #ifndef NDEBUG
     void assertFinalized_() const
@@ -131,6 +167,10 @@ private:
     Scalar vgAlpha_;
     Scalar vgM_;
     Scalar vgN_;
+
+    Scalar vgMInv_;
+    Scalar vgNInv_;
+    bool fusedEvaluation_;
 };
 } // namespace Opm
 
@@ -0,0 +1,71 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::BlackOilFluidState
+ */
+#ifndef OPM_BLACK_OIL_FLUID_STATE_HPP
+#define OPM_BLACK_OIL_FLUID_STATE_HPP
+
+#include "ModularFluidState.hpp"
+
+#include <type_traits>
+
+namespace Opm {
+
+/*!
+ * \brief A compact fluid state for the black-oil model.
+ *
+ * Compared to CompositionalFluidState, this fluid state only stores the two mole
+ * fractions which are not structurally zero or one (see
+ * FluidStateBlackOilCompositionModule) and does not store fugacities. Since the
+ * temperature is the same for all phases, it is only stored once. This makes the
+ * fluid state substantially smaller, which matters if one object is kept per
+ * degree of freedom. If the fluid system does not consider the gas phase (see
+ * FluidSystems::BlackOilTraits), no mole fractions are stored at all because the
+ * remaining phases are immiscible.
+ *
+ * \tparam Scalar The type used for scalar values
+ * \tparam FluidSystem The black-oil fluid system
+ * \tparam storeEnthalpy Specifies whether the phase enthalpies are stored
+ */
+template <class Scalar, class FluidSystem, bool storeEnthalpy=false>
+class BlackOilFluidState
+    : public ModularFluidState<Scalar,
+                               FluidSystem::numPhases,
+                               FluidSystem::numComponents,
+                               FluidStateExplicitPressureModule<Scalar, FluidSystem::numPhases, BlackOilFluidState<Scalar, FluidSystem, storeEnthalpy> >,
+                               FluidStateEquilibriumTemperatureModule<Scalar, FluidSystem::numPhases, BlackOilFluidState<Scalar, FluidSystem, storeEnthalpy> >,
+                               typename std::conditional<(FluidSystem::gasPhaseIdx >= 0),
+                                                         FluidStateBlackOilCompositionModule<Scalar, FluidSystem, BlackOilFluidState<Scalar, FluidSystem, storeEnthalpy> >,
+                                                         FluidStateImmiscibleCompositionModule<Scalar, FluidSystem, BlackOilFluidState<Scalar, FluidSystem, storeEnthalpy> > >::type,
+                               FluidStateNullFugacityModule<Scalar>,
+                               FluidStateExplicitSaturationModule<Scalar, FluidSystem::numPhases, BlackOilFluidState<Scalar, FluidSystem, storeEnthalpy> >,
+                               FluidStateExplicitDensityModule<Scalar, FluidSystem::numPhases, BlackOilFluidState<Scalar, FluidSystem, storeEnthalpy> >,
+                               FluidStateExplicitViscosityModule<Scalar, FluidSystem::numPhases, BlackOilFluidState<Scalar, FluidSystem, storeEnthalpy> >,
+                               typename std::conditional<storeEnthalpy,
+                                                         FluidStateExplicitEnthalpyModule<Scalar, FluidSystem::numPhases, BlackOilFluidState<Scalar, FluidSystem, storeEnthalpy> >,
+                                                         FluidStateNullEnthalpyModule<Scalar, FluidSystem::numPhases, BlackOilFluidState<Scalar, FluidSystem, storeEnthalpy> > >::type>
+{};
+
+} // namespace Opm
+
+#endif
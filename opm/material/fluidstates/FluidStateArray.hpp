@@ -0,0 +1,471 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::FluidStateArray
+ */
+#ifndef OPM_FLUID_STATE_ARRAY_HPP
+#define OPM_FLUID_STATE_ARRAY_HPP
+
+#include <opm/material/common/Valgrind.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+
+template <class Scalar, class FluidSystem>
+class FluidStateArray;
+
+/*!
+ * \brief A lightweight handle for a single element of a FluidStateArray.
+ *
+ * The proxy exhibits the same interface as CompositionalFluidState, i.e., it can be
+ * passed to the fluid systems, the parameter caches and the constraint solvers. All
+ * quantities are read from and written to the arrays of the container, so copying a
+ * proxy does not copy the quantities it refers to.
+ */
+template <class ScalarT, class FluidSystem>
+class FluidStateArrayProxy
+{
+    typedef Opm::FluidStateArray<ScalarT, FluidSystem> Array;
+
+public:
+    typedef ScalarT Scalar;
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+
+    FluidStateArrayProxy(Array& array, size_t elemIdx)
+        : array_(&array)
+        , elemIdx_(elemIdx)
+    { }
+
+    /*!
+     * \brief Returns the index of the element within the container.
+     */
+    size_t index() const
+    { return elemIdx_; }
+
+    /*****************************************************
+     * Generic access to fluid properties
+     *****************************************************/
+    /*!
+     * \brief The temperature of a fluid phase [K]
+     */
+    const Scalar& temperature(int /* phaseIdx */) const
+    { return array_->temperature_[elemIdx_]; }
+
+    /*!
+     * \brief The pressure of a fluid phase [Pa]
+     */
+    const Scalar& pressure(int phaseIdx) const
+    { return array_->pressure_[array_->phaseOffset_(phaseIdx) + elemIdx_]; }
+
+    /*!
+     * \brief The saturation of a fluid phase []
+     */
+    const Scalar& saturation(int phaseIdx) const
+    { return array_->saturation_[array_->phaseOffset_(phaseIdx) + elemIdx_]; }
+
+    /*!
+     * \brief The mole fraction of a component in a phase []
+     */
+    const Scalar& moleFraction(int phaseIdx, int compIdx) const
+    { return array_->moleFraction_[array_->compOffset_(phaseIdx, compIdx) + elemIdx_]; }
+
+    /*!
+     * \brief The mass fraction of a component in a phase []
+     */
+    Scalar massFraction(int phaseIdx, int compIdx) const
+    {
+        typedef Opm::MathToolbox<Scalar> Toolbox;
+
+        size_t offset = array_->phaseOffset_(phaseIdx) + elemIdx_;
+        return
+            Toolbox::abs(array_->sumMoleFractions_[offset])
+            *moleFraction(phaseIdx, compIdx)
+            *FluidSystem::molarMass(compIdx)
+            / Toolbox::max(1e-40, Toolbox::abs(array_->averageMolarMass_[offset]));
+    }
+
+    /*!
+     * \brief The mean molar mass of a fluid phase [kg/mol]
+     */
+    const Scalar& averageMolarMass(int phaseIdx) const
+    { return array_->averageMolarMass_[array_->phaseOffset_(phaseIdx) + elemIdx_]; }
+
+    /*!
+     * \brief The concentration of a component in a phase [mol/m^3]
+     */
+    Scalar molarity(int phaseIdx, int compIdx) const
+    { return molarDensity(phaseIdx)*moleFraction(phaseIdx, compIdx); }
+
+    /*!
+     * \brief The density of a fluid phase [kg/m^3]
+     */
+    const Scalar& density(int phaseIdx) const
+    { return array_->density_[array_->phaseOffset_(phaseIdx) + elemIdx_]; }
+
+    /*!
+     * \brief The molar density of a fluid phase [mol/m^3]
+     */
+    Scalar molarDensity(int phaseIdx) const
+    { return density(phaseIdx)/averageMolarMass(phaseIdx); }
+
+    /*!
+     * \brief The molar volume of a fluid phase [m^3/mol]
+     */
+    Scalar molarVolume(int phaseIdx) const
+    { return 1/molarDensity(phaseIdx); }
+
+    /*!
+     * \brief The fugacity coefficient of a component in a phase []
+     */
+    const Scalar& fugacityCoefficient(int phaseIdx, int compIdx) const
+    { return array_->fugacityCoefficient_[array_->compOffset_(phaseIdx, compIdx) + elemIdx_]; }
+
+    /*!
+     * \brief The fugacity of a component in a phase [Pa]
+     */
+    Scalar fugacity(int phaseIdx, int compIdx) const
+    { return pressure(phaseIdx)*fugacityCoefficient(phaseIdx, compIdx)*moleFraction(phaseIdx, compIdx); }
+
+    /*!
+     * \brief The specific enthalpy of a fluid phase [J/kg]
+     */
+    const Scalar& enthalpy(int phaseIdx) const
+    { return array_->enthalpy_[array_->phaseOffset_(phaseIdx) + elemIdx_]; }
+
+    /*!
+     * \brief The specific internal energy of a fluid phase [J/kg]
+     */
+    Scalar internalEnergy(int phaseIdx) const
+    { return enthalpy(phaseIdx) - pressure(phaseIdx)/density(phaseIdx); }
+
+    /*!
+     * \brief The dynamic viscosity of a fluid phase [Pa s]
+     */
+    const Scalar& viscosity(int phaseIdx) const
+    { return array_->viscosity_[array_->phaseOffset_(phaseIdx) + elemIdx_]; }
+
+    /*****************************************************
+     * Setter methods
+     *****************************************************/
+    /*!
+     * \brief Set the temperature of all phases [K]
+     */
+    void setTemperature(const Scalar& value)
+    { array_->temperature_[elemIdx_] = value; }
+
+    /*!
+     * \brief Set the pressure of a fluid phase [Pa]
+     */
+    void setPressure(int phaseIdx, const Scalar& value)
+    { array_->pressure_[array_->phaseOffset_(phaseIdx) + elemIdx_] = value; }
+
+    /*!
+     * \brief Set the saturation of a fluid phase []
+     */
+    void setSaturation(int phaseIdx, const Scalar& value)
+    { array_->saturation_[array_->phaseOffset_(phaseIdx) + elemIdx_] = value; }
+
+    /*!
+     * \brief Set the mole fraction of a component in a phase [] and update the
+     *        average molar mass of the phase
+     */
+    void setMoleFraction(int phaseIdx, int compIdx, const Scalar& value)
+    {
+        Valgrind::CheckDefined(value);
+        array_->moleFraction_[array_->compOffset_(phaseIdx, compIdx) + elemIdx_] = value;
+        array_->updateAverageMolarMass_(phaseIdx, elemIdx_);
+    }
+
+    /*!
+     * \brief Set the fugacity coefficient of a component in a phase []
+     */
+    void setFugacityCoefficient(int phaseIdx, int compIdx, const Scalar& value)
+    { array_->fugacityCoefficient_[array_->compOffset_(phaseIdx, compIdx) + elemIdx_] = value; }
+
+    /*!
+     * \brief Set the density of a fluid phase [kg/m^3]
+     */
+    void setDensity(int phaseIdx, const Scalar& value)
+    { array_->density_[array_->phaseOffset_(phaseIdx) + elemIdx_] = value; }
+
+    /*!
+     * \brief Set the specific enthalpy of a fluid phase [J/kg]
+     */
+    void setEnthalpy(int phaseIdx, const Scalar& value)
+    { array_->enthalpy_[array_->phaseOffset_(phaseIdx) + elemIdx_] = value; }
+
+    /*!
+     * \brief Set the dynamic viscosity of a fluid phase [Pa s]
+     */
+    void setViscosity(int phaseIdx, const Scalar& value)
+    { array_->viscosity_[array_->phaseOffset_(phaseIdx) + elemIdx_] = value; }
+
+    /*!
+     * \brief Retrieve all parameters from an arbitrary fluid state.
+     *
+     * The fluid state must provide all quantities which are stored by the
+     * container.
+     */
+    template <class FluidState>
+    void assign(const FluidState& fs)
+    {
+        typedef typename FluidState::Scalar FsScalar;
+        typedef Opm::MathToolbox<FsScalar> FsToolbox;
+
+        setTemperature(FsToolbox::template toLhs<Scalar>(fs.temperature(/*phaseIdx=*/0)));
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            setPressure(phaseIdx, FsToolbox::template toLhs<Scalar>(fs.pressure(phaseIdx)));
+            setSaturation(phaseIdx, FsToolbox::template toLhs<Scalar>(fs.saturation(phaseIdx)));
+            setDensity(phaseIdx, FsToolbox::template toLhs<Scalar>(fs.density(phaseIdx)));
+            setViscosity(phaseIdx, FsToolbox::template toLhs<Scalar>(fs.viscosity(phaseIdx)));
+            setEnthalpy(phaseIdx, FsToolbox::template toLhs<Scalar>(fs.enthalpy(phaseIdx)));
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+                array_->moleFraction_[array_->compOffset_(phaseIdx, compIdx) + elemIdx_] =
+                    FsToolbox::template toLhs<Scalar>(fs.moleFraction(phaseIdx, compIdx));
+                setFugacityCoefficient(phaseIdx, compIdx,
+                                       FsToolbox::template toLhs<Scalar>(fs.fugacityCoefficient(phaseIdx, compIdx)));
+            }
+            array_->updateAverageMolarMass_(phaseIdx, elemIdx_);
+        }
+    }
+
+    /*!
+     * \brief Make sure that all attributes are defined.
+     *
+     * This method does not do anything if the program is not run
+     * under valgrind. If it is, then valgrind will print an error
+     * message if some attributes of the object have not been properly
+     * defined.
+     */
+    void checkDefined() const
+    {
+        Valgrind::CheckDefined(temperature(/*phaseIdx=*/0));
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            Valgrind::CheckDefined(pressure(phaseIdx));
+            Valgrind::CheckDefined(saturation(phaseIdx));
+            Valgrind::CheckDefined(averageMolarMass(phaseIdx));
+            Valgrind::CheckDefined(density(phaseIdx));
+            Valgrind::CheckDefined(viscosity(phaseIdx));
+            Valgrind::CheckDefined(enthalpy(phaseIdx));
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+                Valgrind::CheckDefined(moleFraction(phaseIdx, compIdx));
+                Valgrind::CheckDefined(fugacityCoefficient(phaseIdx, compIdx));
+            }
+        }
+    }
+
+private:
+    Array* array_;
+    size_t elemIdx_;
+};
+
+/*!
+ * \brief Stores the fluid states of many degrees of freedom in "structure of
+ *        arrays" order.
+ *
+ * The container stores the same quantities as CompositionalFluidState, but each
+ * quantity of a phase (or of a component within a phase) is kept in a contiguous
+ * array over all elements. operator[] returns a FluidStateArrayProxy which models the
+ * fluid state concept, so the fluid systems and material laws can be used as usual,
+ * while kernels which process many elements at once can operate on the raw arrays.
+ *
+ * If mole fractions are modified using the raw arrays, updateAverageMolarMasses()
+ * must be called afterwards.
+ *
+ * \tparam Scalar The type used for scalar values
+ * \tparam FluidSystem The fluid system for which the fluid states are stored
+ */
+template <class Scalar, class FluidSystem>
+class FluidStateArray
+{
+    friend class FluidStateArrayProxy<Scalar, FluidSystem>;
+
+public:
+    typedef FluidStateArrayProxy<Scalar, FluidSystem> Proxy;
+
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+
+    FluidStateArray()
+        : size_(0)
+    { }
+
+    explicit FluidStateArray(size_t n)
+        : size_(0)
+    { resize(n); }
+
+    /*!
+     * \brief Set the number of elements.
+     *
+     * This invalidates all pointers to the arrays and the quantities which have been
+     * stored previously.
+     */
+    void resize(size_t n)
+    {
+        size_ = n;
+        temperature_.resize(n);
+        pressure_.resize(numPhases*n);
+        saturation_.resize(numPhases*n);
+        moleFraction_.resize(numPhases*numComponents*n);
+        averageMolarMass_.resize(numPhases*n);
+        sumMoleFractions_.resize(numPhases*n);
+        fugacityCoefficient_.resize(numPhases*numComponents*n);
+        density_.resize(numPhases*n);
+        viscosity_.resize(numPhases*n);
+        enthalpy_.resize(numPhases*n);
+    }
+
+    /*!
+     * \brief Returns the number of elements.
+     */
+    size_t size() const
+    { return size_; }
+
+    /*!
+     * \brief Returns a fluid state proxy for a given element.
+     */
+    Proxy operator[](size_t elemIdx)
+    {
+        assert(elemIdx < size_);
+        return Proxy(*this, elemIdx);
+    }
+
+    /*!
+     * \brief Returns a read-only fluid state proxy for a given element.
+     */
+    const Proxy operator[](size_t elemIdx) const
+    {
+        assert(elemIdx < size_);
+        return Proxy(const_cast<FluidStateArray&>(*this), elemIdx);
+    }
+
+    /*****************************************************
+     * Access to the raw arrays. Each of them has size() entries.
+     *****************************************************/
+    //! The temperatures of all elements [K]
+    Scalar* temperatureArray()
+    { return &temperature_[0]; }
+    const Scalar* temperatureArray() const
+    { return &temperature_[0]; }
+
+    //! The pressures of a phase for all elements [Pa]
+    Scalar* pressureArray(int phaseIdx)
+    { return &pressure_[phaseOffset_(phaseIdx)]; }
+    const Scalar* pressureArray(int phaseIdx) const
+    { return &pressure_[phaseOffset_(phaseIdx)]; }
+
+    //! The saturations of a phase for all elements []
+    Scalar* saturationArray(int phaseIdx)
+    { return &saturation_[phaseOffset_(phaseIdx)]; }
+    const Scalar* saturationArray(int phaseIdx) const
+    { return &saturation_[phaseOffset_(phaseIdx)]; }
+
+    //! The mole fractions of a component in a phase for all elements []
+    Scalar* moleFractionArray(int phaseIdx, int compIdx)
+    { return &moleFraction_[compOffset_(phaseIdx, compIdx)]; }
+    const Scalar* moleFractionArray(int phaseIdx, int compIdx) const
+    { return &moleFraction_[compOffset_(phaseIdx, compIdx)]; }
+
+    //! The mean molar masses of a phase for all elements [kg/mol]
+    const Scalar* averageMolarMassArray(int phaseIdx) const
+    { return &averageMolarMass_[phaseOffset_(phaseIdx)]; }
+
+    //! The fugacity coefficients of a component in a phase for all elements []
+    Scalar* fugacityCoefficientArray(int phaseIdx, int compIdx)
+    { return &fugacityCoefficient_[compOffset_(phaseIdx, compIdx)]; }
+    const Scalar* fugacityCoefficientArray(int phaseIdx, int compIdx) const
+    { return &fugacityCoefficient_[compOffset_(phaseIdx, compIdx)]; }
+
+    //! The densities of a phase for all elements [kg/m^3]
+    Scalar* densityArray(int phaseIdx)
+    { return &density_[phaseOffset_(phaseIdx)]; }
+    const Scalar* densityArray(int phaseIdx) const
+    { return &density_[phaseOffset_(phaseIdx)]; }
+
+    //! The viscosities of a phase for all elements [Pa s]
+    Scalar* viscosityArray(int phaseIdx)
+    { return &viscosity_[phaseOffset_(phaseIdx)]; }
+    const Scalar* viscosityArray(int phaseIdx) const
+    { return &viscosity_[phaseOffset_(phaseIdx)]; }
+
+    //! The specific enthalpies of a phase for all elements [J/kg]
+    Scalar* enthalpyArray(int phaseIdx)
+    { return &enthalpy_[phaseOffset_(phaseIdx)]; }
+    const Scalar* enthalpyArray(int phaseIdx) const
+    { return &enthalpy_[phaseOffset_(phaseIdx)]; }
+
+    /*!
+     * \brief Re-calculate the mean molar masses of all phases and elements.
+     *
+     * This needs to be called if the mole fractions were modified via
+     * moleFractionArray().
+     */
+    void updateAverageMolarMasses()
+    {
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            for (size_t elemIdx = 0; elemIdx < size_; ++elemIdx)
+                updateAverageMolarMass_(phaseIdx, elemIdx);
+    }
+
+private:
+    size_t phaseOffset_(int phaseIdx) const
+    { return phaseIdx*size_; }
+
+    size_t compOffset_(int phaseIdx, int compIdx) const
+    { return (phaseIdx*numComponents + compIdx)*size_; }
+
+    void updateAverageMolarMass_(int phaseIdx, size_t elemIdx)
+    {
+        Scalar sumx = 0.0;
+        Scalar M = 0.0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            const Scalar& x = moleFraction_[compOffset_(phaseIdx, compIdx) + elemIdx];
+            sumx += x;
+            M += x*FluidSystem::molarMass(compIdx);
+        }
+
+        sumMoleFractions_[phaseOffset_(phaseIdx) + elemIdx] = sumx;
+        averageMolarMass_[phaseOffset_(phaseIdx) + elemIdx] = M;
+    }
+
+    size_t size_;
+
+    std::vector<Scalar> temperature_;
+    std::vector<Scalar> pressure_;
+    std::vector<Scalar> saturation_;
+    std::vector<Scalar> moleFraction_;
+    std::vector<Scalar> averageMolarMass_;
+    std::vector<Scalar> sumMoleFractions_;
+    std::vector<Scalar> fugacityCoefficient_;
+    std::vector<Scalar> density_;
+    std::vector<Scalar> viscosity_;
+    std::vector<Scalar> enthalpy_;
+};
+
+} // namespace Opm
+
+#endif
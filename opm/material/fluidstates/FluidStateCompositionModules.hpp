@@ -248,6 +248,186 @@ protected:
     { return *static_cast<const Implementation*>(this); }
 };
 
+/*!
+ * \brief Module for the modular fluid state which stores only the
+ *        structurally non-zero mole fractions of the black-oil model.
+ *
+ * In the black-oil model, the water phase only consists of the water component, gas
+ * can be dissolved in the oil phase and oil can be vaporized in the gas phase. Thus,
+ * only two of the nine mole fractions are independent (which corresponds to
+ * \f$R_s\f$ and \f$R_v\f$), and only these are stored. The remaining quantities
+ * are derived on the fly.
+ *
+ * Setting the mole fraction of the main component of the oil or gas phase sets the
+ * one of the dissolved component to the complement, i.e., the last call of
+ * setMoleFraction() for a phase wins. Mole fractions which are always zero can only
+ * be set to zero. The water phase may be disabled by the fluid system.
+ */
+template <class Scalar,
+          class FluidSystem,
+          class Implementation>
+class FluidStateBlackOilCompositionModule
+{
+    enum { numPhases = FluidSystem::numPhases };
+
+    enum { waterPhaseIdx = FluidSystem::waterPhaseIdx };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+    enum { waterCompIdx = FluidSystem::waterCompIdx };
+    enum { oilCompIdx = FluidSystem::oilCompIdx };
+    enum { gasCompIdx = FluidSystem::gasCompIdx };
+
+public:
+    enum { numComponents = FluidSystem::numComponents };
+    static_assert((int) numPhases == (int) numComponents,
+                  "The black-oil composition module requires the same number of phases and components");
+    static_assert((int) oilPhaseIdx >= 0 && (int) gasPhaseIdx >= 0,
+                  "The black-oil composition module requires the oil and the gas phases");
+
+    FluidStateBlackOilCompositionModule()
+    {
+        Valgrind::SetUndefined(oilGasMoleFraction_);
+        Valgrind::SetUndefined(gasOilMoleFraction_);
+    }
+
+    /*!
+     * \brief The mole fraction of a component in a phase []
+     */
+    Scalar moleFraction(int phaseIdx, int compIdx) const
+    {
+        if (phaseIdx == waterPhaseIdx)
+            return (compIdx == waterCompIdx)?1.0:0.0;
+
+        const Scalar& x = dissolvedMoleFraction_(phaseIdx);
+        if (compIdx == dissolvedCompIdx_(phaseIdx))
+            return x;
+        else if (compIdx == mainCompIdx_(phaseIdx))
+            return 1.0 - x;
+        return 0.0;
+    }
+
+    /*!
+     * \brief The mass fraction of a component in a phase []
+     */
+    Scalar massFraction(int phaseIdx, int compIdx) const
+    {
+        return
+            moleFraction(phaseIdx, compIdx)
+            *FluidSystem::molarMass(compIdx)
+            / averageMolarMass(phaseIdx);
+    }
+
+    /*!
+     * \brief The mean molar mass of a fluid phase [kg/mol]
+     *
+     * The average molar mass is the mean mass of one mole of the
+     * fluid at current composition. It is defined as the sum of the
+     * component's molar masses weighted by the current mole fraction:
+     * \f[ \bar M_\alpha = \sum_\kappa M^\kappa x_\alpha^\kappa \f]
+     */
+    Scalar averageMolarMass(int phaseIdx) const
+    {
+        if (phaseIdx == waterPhaseIdx)
+            return FluidSystem::molarMass(waterCompIdx);
+
+        const Scalar& x = dissolvedMoleFraction_(phaseIdx);
+        return
+            (1.0 - x)*FluidSystem::molarMass(mainCompIdx_(phaseIdx))
+            + x*FluidSystem::molarMass(dissolvedCompIdx_(phaseIdx));
+    }
+
+    /*!
+     * \brief The concentration of a component in a phase [mol/m^3]
+     *
+     * This quantity is often called "molar concentration" or just
+     * "concentration", but there are many other (though less common)
+     * measures for concentration.
+     *
+     * http://en.wikipedia.org/wiki/Concentration
+     */
+    Scalar molarity(int phaseIdx, int compIdx) const
+    { return asImp_().molarDensity(phaseIdx)*moleFraction(phaseIdx, compIdx); }
+
+    /*!
+     * \brief Set the mole fraction of a component in a phase []
+     */
+    void setMoleFraction(int phaseIdx, int compIdx, const Scalar& value)
+    {
+        typedef Opm::MathToolbox<Scalar> Toolbox;
+
+        Valgrind::CheckDefined(value);
+
+        if (phaseIdx != waterPhaseIdx) {
+            if (compIdx == dissolvedCompIdx_(phaseIdx)) {
+                dissolvedMoleFraction_(phaseIdx) = value;
+                return;
+            }
+            else if (compIdx == mainCompIdx_(phaseIdx)) {
+                dissolvedMoleFraction_(phaseIdx) = 1.0 - value;
+                return;
+            }
+        }
+        else if (compIdx == waterCompIdx)
+            // the water phase always consists of pure water
+            return;
+
+        if (Toolbox::value(value) != 0.0)
+            OPM_THROW(std::logic_error,
+                      "The mole fraction of component " << compIdx << " in phase " << phaseIdx
+                      << " is always zero for the black-oil model");
+    }
+
+    /*!
+     * \brief Retrieve all parameters from an arbitrary fluid
+     *        state.
+     */
+    template <class FluidState>
+    void assign(const FluidState& fs)
+    {
+        typedef typename FluidState::Scalar FsScalar;
+        typedef Opm::MathToolbox<FsScalar> FsToolbox;
+
+        oilGasMoleFraction_ = FsToolbox::template toLhs<Scalar>(fs.moleFraction(oilPhaseIdx, gasCompIdx));
+        gasOilMoleFraction_ = FsToolbox::template toLhs<Scalar>(fs.moleFraction(gasPhaseIdx, oilCompIdx));
+    }
+
+    /*!
+     * \brief Make sure that all attributes are defined.
+     *
+     * This method does not do anything if the program is not run
+     * under valgrind. If it is, then valgrind will print an error
+     * message if some attributes of the object have not been properly
+     * defined.
+     */
+    void checkDefined() const
+    {
+        Valgrind::CheckDefined(oilGasMoleFraction_);
+        Valgrind::CheckDefined(gasOilMoleFraction_);
+    }
+
+protected:
+    const Implementation &asImp_() const
+    { return *static_cast<const Implementation*>(this); }
+
+    static int mainCompIdx_(int phaseIdx)
+    { return (phaseIdx == oilPhaseIdx)?static_cast<int>(oilCompIdx):static_cast<int>(gasCompIdx); }
+
+    static int dissolvedCompIdx_(int phaseIdx)
+    { return (phaseIdx == oilPhaseIdx)?static_cast<int>(gasCompIdx):static_cast<int>(oilCompIdx); }
+
+    const Scalar& dissolvedMoleFraction_(int phaseIdx) const
+    { return (phaseIdx == oilPhaseIdx)?oilGasMoleFraction_:gasOilMoleFraction_; }
+
+    Scalar& dissolvedMoleFraction_(int phaseIdx)
+    { return (phaseIdx == oilPhaseIdx)?oilGasMoleFraction_:gasOilMoleFraction_; }
+
+    // mole fraction of the gas component in the oil phase
+    Scalar oilGasMoleFraction_;
+    // mole fraction of the oil component in the gas phase
+    Scalar gasOilMoleFraction_;
+};
+
 /*!
  * \brief Module for the modular fluid state which does not store the
  *        compositions but throws std::logic_error instead.
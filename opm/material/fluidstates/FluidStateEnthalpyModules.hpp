@@ -119,7 +119,7 @@ public:
      */
     const Scalar& internalEnergy(int /* phaseIdx */) const
     {
-        static Scalar tmp = 0;
+        static const Scalar tmp = 0;
         Valgrind::SetUndefined(tmp);
         return tmp;
     }
@@ -129,7 +129,7 @@ public:
      */
     const Scalar& enthalpy(int /* phaseIdx */) const
     {
-        static Scalar tmp = 0;
+        static const Scalar tmp = 0;
         Valgrind::SetUndefined(tmp);
         return tmp;
     }
@@ -34,8 +34,6 @@
 
 #include <algorithm>
 
-#include <string.h>
-
 namespace Opm {
 
 /*!
@@ -65,8 +63,8 @@ public:
     ImmiscibleFluidState()
     {}
 
-    ImmiscibleFluidState(const ImmiscibleFluidState &fs)
-    { memcpy(this, &fs, sizeof(fs)); }
+    // this is a plain memcpy() if the scalar type is trivially copyable
+    ImmiscibleFluidState(const ImmiscibleFluidState &fs) = default;
 };
 
 // specialization for the enthalpy disabled case
@@ -88,8 +86,8 @@ public:
     ImmiscibleFluidState()
     {}
 
-    ImmiscibleFluidState(const ImmiscibleFluidState &fs)
-    { memcpy(this, &fs, sizeof(fs)); }
+    // this is a plain memcpy() if the scalar type is trivially copyable
+    ImmiscibleFluidState(const ImmiscibleFluidState &fs) = default;
 };
 } // namespace Opm
 
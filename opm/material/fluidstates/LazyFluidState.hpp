@@ -0,0 +1,254 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::LazyFluidState
+ */
+#ifndef OPM_LAZY_FLUID_STATE_HPP
+#define OPM_LAZY_FLUID_STATE_HPP
+
+#include "ModularFluidState.hpp"
+
+#include <algorithm>
+
+namespace Opm {
+
+/*!
+ * \brief Represents all relevant thermodynamic quantities of a multi-phase,
+ *        multi-component fluid system assuming thermodynamic equilibrium, but
+ *        only computes the densities, viscosities and enthalpies of the phases
+ *        when they are accessed.
+ *
+ * The pressures, the temperature, the compositions, the saturations and the fugacities
+ * are stored explicitly like for the CompositionalFluidState. The density, the
+ * viscosity and the enthalpy of a phase are computed by the fluid system when they are
+ * accessed for the first time and are cached until the pressure or the composition of
+ * the phase or the temperature is modified. Before a quantity is computed, the state's
+ * parameter cache is updated for the phase. Code which only needs some of the
+ * quantities thus does not pay for the others.
+ *
+ * Since the cached quantities are computed by const methods, a single object must not
+ * be accessed by several threads concurrently.
+ */
+template <class Scalar, class FluidSystem>
+class LazyFluidState
+    : public ModularFluidState<Scalar,
+                               FluidSystem::numPhases,
+                               FluidSystem::numComponents,
+                               FluidStateExplicitPressureModule<Scalar, FluidSystem::numPhases, LazyFluidState<Scalar, FluidSystem> >,
+                               FluidStateEquilibriumTemperatureModule<Scalar, FluidSystem::numPhases, LazyFluidState<Scalar, FluidSystem> >,
+                               FluidStateExplicitCompositionModule<Scalar, FluidSystem, LazyFluidState<Scalar, FluidSystem> >,
+                               FluidStateExplicitFugacityModule<Scalar, FluidSystem::numPhases, FluidSystem::numComponents, LazyFluidState<Scalar, FluidSystem> >,
+                               FluidStateExplicitSaturationModule<Scalar, FluidSystem::numPhases, LazyFluidState<Scalar, FluidSystem> >,
+                               FluidStateNullDensityModule<Scalar, FluidSystem::numPhases, LazyFluidState<Scalar, FluidSystem> >,
+                               FluidStateNullViscosityModule<Scalar, FluidSystem::numPhases, LazyFluidState<Scalar, FluidSystem> >,
+                               FluidStateNullEnthalpyModule<Scalar, FluidSystem::numPhases, LazyFluidState<Scalar, FluidSystem> > >
+{
+    typedef ModularFluidState<Scalar,
+                              FluidSystem::numPhases,
+                              FluidSystem::numComponents,
+                              FluidStateExplicitPressureModule<Scalar, FluidSystem::numPhases, LazyFluidState<Scalar, FluidSystem> >,
+                              FluidStateEquilibriumTemperatureModule<Scalar, FluidSystem::numPhases, LazyFluidState<Scalar, FluidSystem> >,
+                              FluidStateExplicitCompositionModule<Scalar, FluidSystem, LazyFluidState<Scalar, FluidSystem> >,
+                              FluidStateExplicitFugacityModule<Scalar, FluidSystem::numPhases, FluidSystem::numComponents, LazyFluidState<Scalar, FluidSystem> >,
+                              FluidStateExplicitSaturationModule<Scalar, FluidSystem::numPhases, LazyFluidState<Scalar, FluidSystem> >,
+                              FluidStateNullDensityModule<Scalar, FluidSystem::numPhases, LazyFluidState<Scalar, FluidSystem> >,
+                              FluidStateNullViscosityModule<Scalar, FluidSystem::numPhases, LazyFluidState<Scalar, FluidSystem> >,
+                              FluidStateNullEnthalpyModule<Scalar, FluidSystem::numPhases, LazyFluidState<Scalar, FluidSystem> > >
+    ParentType;
+
+    enum { numPhases = FluidSystem::numPhases };
+
+    // the bits of the flags which specify the cached quantities of a phase
+    enum {
+        paramCacheValid = 1,
+        densityValid = 2,
+        viscosityValid = 4,
+        enthalpyValid = 8
+    };
+
+public:
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+
+    LazyFluidState()
+    { invalidate(); }
+
+    /*!
+     * \brief Create a fluid state that uses a copy of a given parameter cache.
+     *
+     * This is required for fluid systems whose parameter caches store more than the
+     * quantities which are derived from the fluid state, e.g., the PVT region index of
+     * the black-oil fluid system.
+     */
+    explicit LazyFluidState(const ParameterCache& paramCache)
+        : paramCache_(paramCache)
+    { invalidate(); }
+
+    /*!
+     * \brief Returns the parameter cache which is used to compute the quantities.
+     *
+     * The parameter cache is only guaranteed to be up to date for the phases for which a
+     * quantity has already been computed.
+     */
+    const ParameterCache& paramCache() const
+    { return paramCache_; }
+
+    /*!
+     * \brief Replace the parameter cache and discard all cached quantities.
+     */
+    void setParamCache(const ParameterCache& paramCache)
+    {
+        paramCache_ = paramCache;
+        invalidate();
+    }
+
+    /*!
+     * \brief Discard the cached quantities of all phases.
+     */
+    void invalidate()
+    { std::fill(valid_, valid_ + numPhases, 0); }
+
+    /*!
+     * \brief Discard the cached quantities of a phase.
+     */
+    void invalidate(int phaseIdx)
+    { valid_[phaseIdx] = 0; }
+
+    /*!
+     * \brief Set the pressure of a phase [Pa]
+     */
+    void setPressure(int phaseIdx, const Scalar& value)
+    {
+        ParentType::setPressure(phaseIdx, value);
+        invalidate(phaseIdx);
+    }
+
+    /*!
+     * \brief Set the temperature [K] of all phases
+     */
+    void setTemperature(Scalar value)
+    {
+        ParentType::setTemperature(value);
+        invalidate();
+    }
+
+    /*!
+     * \brief Set the mole fraction of a component in a phase []
+     */
+    void setMoleFraction(int phaseIdx, int compIdx, const Scalar& value)
+    {
+        ParentType::setMoleFraction(phaseIdx, compIdx, value);
+        invalidate(phaseIdx);
+    }
+
+    /*!
+     * \brief The density of a fluid phase [kg/m^3]
+     */
+    const Scalar& density(int phaseIdx) const
+    {
+        if (!(valid_[phaseIdx] & densityValid)) {
+            density_[phaseIdx] = FluidSystem::density(*this, updatedParamCache_(phaseIdx), phaseIdx);
+            valid_[phaseIdx] |= densityValid;
+        }
+        return density_[phaseIdx];
+    }
+
+    /*!
+     * \brief The molar density of a fluid phase [mol/m^3]
+     */
+    Scalar molarDensity(int phaseIdx) const
+    { return density(phaseIdx)/this->averageMolarMass(phaseIdx); }
+
+    /*!
+     * \brief The molar volume of a fluid phase [m^3/mol]
+     */
+    Scalar molarVolume(int phaseIdx) const
+    { return 1/molarDensity(phaseIdx); }
+
+    /*!
+     * \brief The concentration of a component in a phase [mol/m^3]
+     */
+    Scalar molarity(int phaseIdx, int compIdx) const
+    { return molarDensity(phaseIdx)*this->moleFraction(phaseIdx, compIdx); }
+
+    /*!
+     * \brief The dynamic viscosity of a fluid phase [Pa s]
+     */
+    const Scalar& viscosity(int phaseIdx) const
+    {
+        if (!(valid_[phaseIdx] & viscosityValid)) {
+            viscosity_[phaseIdx] = FluidSystem::viscosity(*this, updatedParamCache_(phaseIdx), phaseIdx);
+            valid_[phaseIdx] |= viscosityValid;
+        }
+        return viscosity_[phaseIdx];
+    }
+
+    /*!
+     * \brief The specific enthalpy of a fluid phase [J/kg]
+     */
+    const Scalar& enthalpy(int phaseIdx) const
+    {
+        if (!(valid_[phaseIdx] & enthalpyValid)) {
+            enthalpy_[phaseIdx] = FluidSystem::enthalpy(*this, updatedParamCache_(phaseIdx), phaseIdx);
+            valid_[phaseIdx] |= enthalpyValid;
+        }
+        return enthalpy_[phaseIdx];
+    }
+
+    /*!
+     * \brief The specific internal energy of a fluid phase [J/kg]
+     */
+    Scalar internalEnergy(int phaseIdx) const
+    { return enthalpy(phaseIdx) - this->pressure(phaseIdx)/density(phaseIdx); }
+
+    /*!
+     * \brief Retrieve all parameters from an arbitrary fluid state.
+     *
+     * The densities, viscosities and enthalpies of the other fluid state are not
+     * copied but computed when they are accessed.
+     */
+    template <class FluidState>
+    void assign(const FluidState& fs)
+    {
+        ParentType::assign(fs);
+        invalidate();
+    }
+
+private:
+    const ParameterCache& updatedParamCache_(int phaseIdx) const
+    {
+        if (!(valid_[phaseIdx] & paramCacheValid)) {
+            paramCache_.updatePhase(*this, phaseIdx);
+            valid_[phaseIdx] |= paramCacheValid;
+        }
+        return paramCache_;
+    }
+
+    mutable ParameterCache paramCache_;
+    mutable Scalar density_[numPhases];
+    mutable Scalar viscosity_[numPhases];
+    mutable Scalar enthalpy_[numPhases];
+    mutable unsigned char valid_[numPhases];
+};
+
+} // namespace Opm
+
+#endif
@@ -36,6 +36,7 @@
 
 #include <opm/material/common/Valgrind.hpp>
 #include <algorithm>
+#include <type_traits>
 
 namespace Opm {
 
@@ -95,9 +96,26 @@ public:
     /*!
      * \brief Retrieve all parameters from an arbitrary fluid
      *        state.
+     *
+     * If the other fluid state is of the same type, all modules are copied at once
+     * instead of quantity by quantity. The modules are trivially copyable if the
+     * scalar type is, so this boils down to a memcpy() in this case. Note that the
+     * fugacity coefficients are only retrieved from fluid states of the same type.
      */
     template <class FluidState>
     void assign(const FluidState& fs)
+    {
+        typedef std::integral_constant<bool, std::is_base_of<ModularFluidState, FluidState>::value> IsSameType;
+        assign_(fs, IsSameType());
+    }
+
+private:
+    template <class FluidState>
+    void assign_(const FluidState& fs, std::true_type /* isSameType */)
+    { ModularFluidState::operator=(fs); }
+
+    template <class FluidState>
+    void assign_(const FluidState& fs, std::false_type /* isSameType */)
     {
         PressureModule::assign(fs);
         TemperatureModule::assign(fs);
@@ -59,20 +59,9 @@ public:
             pressure_[phaseIdx] = fs.pressure(phaseIdx);
     }
 
-    // copy constructor
-    PressureOverlayFluidState(const PressureOverlayFluidState &fs)
-        : fs_(fs.fs_)
-        , pressure_(fs.pressure_)
-    {
-    }
-
-    // assignment operator
-    PressureOverlayFluidState &operator=(const PressureOverlayFluidState &fs)
-    {
-        fs_ = fs.fs_;
-        pressure_ = fs.pressure_;
-        return *this;
-    }
+    // the default copy operations keep the overlay trivially copyable
+    PressureOverlayFluidState(const PressureOverlayFluidState &fs) = default;
+    PressureOverlayFluidState &operator=(const PressureOverlayFluidState &fs) = default;
 
     /*****************************************************
      * Generic access to fluid properties (No assumptions
@@ -59,19 +59,9 @@ public:
             saturation_[phaseIdx] = fs.saturation(phaseIdx);
     }
 
-    // copy constructor
-    SaturationOverlayFluidState(const SaturationOverlayFluidState &fs)
-        : fs_(fs.fs_)
-        , saturation_(fs.saturation_)
-    {}
-
-    // assignment operator
-    SaturationOverlayFluidState &operator=(const SaturationOverlayFluidState &fs)
-    {
-        fs_ = fs.fs_;
-        saturation_ = fs.saturation_;
-        return *this;
-    }
+    // the default copy operations keep the overlay trivially copyable
+    SaturationOverlayFluidState(const SaturationOverlayFluidState &fs) = default;
+    SaturationOverlayFluidState &operator=(const SaturationOverlayFluidState &fs) = default;
 
     /*****************************************************
      * Generic access to fluid properties (No assumptions
@@ -61,19 +61,9 @@ public:
         : temperature_(T), fs_(&fs)
     { }
 
-    // copy constructor
-    TemperatureOverlayFluidState(const TemperatureOverlayFluidState &fs)
-        : fs_(fs.fs_)
-        , temperature_(fs.temperature_)
-    {}
-
-    // assignment operator
-    TemperatureOverlayFluidState &operator=(const TemperatureOverlayFluidState &fs)
-    {
-        fs_ = fs.fs_;
-        temperature_ = fs.temperature_;
-        return *this;
-    }
+    // the default copy operations keep the overlay trivially copyable
+    TemperatureOverlayFluidState(const TemperatureOverlayFluidState &fs) = default;
+    TemperatureOverlayFluidState &operator=(const TemperatureOverlayFluidState &fs) = default;
 
     /*****************************************************
      * Generic access to fluid properties (No assumptions
@@ -33,6 +33,8 @@
 #include <opm/material/common/ErrorMacros.hpp>
 #include <opm/material/common/ClassName.hpp>
 
+#include <cstddef>
+
 namespace Opm {
 
 /*!
@@ -59,6 +61,101 @@ public:
     //! Number of fluid phases in the fluid system
     static const int numPhases = -2000;
 
+    /*!
+     * \brief Constants for ORing the quantities which ought to be calculated by
+     *        computeAll().
+     */
+    enum ComputedQuantities {
+        //! The densities of all phases
+        Density = 1,
+
+        //! The viscosities of all phases
+        Viscosity = 2,
+
+        //! The specific enthalpies of all phases
+        Enthalpy = 4,
+
+        //! The fugacity coefficients of all components in all phases
+        FugacityCoefficients = 8,
+
+        //! All of the above
+        AllQuantities = Density | Viscosity | Enthalpy | FugacityCoefficients
+    };
+
+    /*!
+     * \brief Specifies whether the fluid system provides exact derivatives
+     *
+     * If this is true, density() and fugacityCoefficient() propagate the
+     * derivatives of all quantities of fluid states which use automatic
+     * differentiation and the parameter cache can be updated using such fluid
+     * states. The flash solvers then use exact Jacobian matrices instead of
+     * approximating them using finite differences.
+     */
+    static const bool hasExactDerivatives = false;
+
+    /*!
+     * \brief Constants for ORing the quantities of a fluid state on which a
+     *        thermodynamic relation may depend.
+     *
+     * The quantities are the ones of the phase for which the relation is evaluated.
+     */
+    enum StateDependencies {
+        //! The pressure of the phase
+        PressureDependency = 1,
+
+        //! The temperature of the phase
+        TemperatureDependency = 2,
+
+        //! The composition of the phase
+        CompositionDependency = 4,
+
+        //! All of the above
+        AllDependencies = PressureDependency | TemperatureDependency | CompositionDependency
+    };
+
+    /*!
+     * \brief Returns the quantities of a fluid state on which the density of a phase
+     *        may depend.
+     *
+     * The result is a combination of the StateDependencies constants. It allows the
+     * users of a fluid system to leave out the derivatives which are structurally
+     * zero, e.g., the ones of the water density with regard to the composition. The
+     * default is to assume that the density depends on all quantities, fluid systems
+     * which know better override this method.
+     *
+     * \copydoc Doxygen::phaseIdxParam
+     */
+    static unsigned densityDependencies(int phaseIdx)
+    { return AllDependencies; }
+
+    /*!
+     * \brief Returns the quantities of a fluid state on which the viscosity of a phase
+     *        may depend.
+     *
+     * \copydetails densityDependencies
+     */
+    static unsigned viscosityDependencies(int phaseIdx)
+    { return AllDependencies; }
+
+    /*!
+     * \brief Returns the quantities of a fluid state on which the specific enthalpy of
+     *        a phase may depend.
+     *
+     * \copydetails densityDependencies
+     */
+    static unsigned enthalpyDependencies(int phaseIdx)
+    { return AllDependencies; }
+
+    /*!
+     * \brief Returns the quantities of a fluid state on which the fugacity coefficient
+     *        of a component in a phase may depend.
+     *
+     * \copydetails densityDependencies
+     * \copydoc Doxygen::compIdxParam
+     */
+    static unsigned fugacityCoefficientDependencies(int phaseIdx, int compIdx)
+    { return AllDependencies; }
+
     /*!
      * \brief Return the human readable name of a fluid phase
      *
@@ -156,6 +253,69 @@ public:
     static void init()
     { }
 
+    /*!
+     * \brief Calculate the requested quantities of all phases and store them in a
+     *        fluid state.
+     *
+     * This is equivalent to calling density(), viscosity(), enthalpy() and
+     * fugacityCoefficient() for each phase and passing the results to the fluid
+     * state, but fluid systems can override this method to share the intermediate
+     * results of these relations. The parameter cache must have been updated for
+     * the fluid state.
+     *
+     * \param fluidState The fluid state which provides the temperature, pressures
+     *                   and compositions and which receives the results
+     * \param paramCache The parameter cache of the fluid state
+     * \param quantities The ORed ComputedQuantities which ought to be calculated
+     */
+    template <class FluidState, class ParameterCache>
+    static void computeAll(FluidState &fluidState,
+                           const ParameterCache &paramCache,
+                           int quantities = AllQuantities)
+    {
+        typedef typename FluidState::Scalar Evaluation;
+
+        for (int phaseIdx = 0; phaseIdx < Implementation::numPhases; ++phaseIdx) {
+            if (quantities & Density)
+                fluidState.setDensity(phaseIdx,
+                                      Implementation::template density<FluidState, Evaluation>(fluidState, paramCache, phaseIdx));
+            if (quantities & Viscosity)
+                fluidState.setViscosity(phaseIdx,
+                                        Implementation::template viscosity<FluidState, Evaluation>(fluidState, paramCache, phaseIdx));
+            if (quantities & Enthalpy)
+                fluidState.setEnthalpy(phaseIdx,
+                                       Implementation::template enthalpy<FluidState, Evaluation>(fluidState, paramCache, phaseIdx));
+            if (quantities & FugacityCoefficients) {
+                Evaluation fugCoeffs[Implementation::numComponents];
+                Implementation::fugacityCoefficients(fluidState, paramCache, phaseIdx, fugCoeffs);
+                for (int compIdx = 0; compIdx < Implementation::numComponents; ++compIdx)
+                    fluidState.setFugacityCoefficient(phaseIdx, compIdx, fugCoeffs[compIdx]);
+            }
+        }
+    }
+
+    /*!
+     * \brief Calculate the requested quantities for an array of fluid states.
+     *
+     * This calls the computeAll() method of the fluid system for each fluid state,
+     * i.e., overridden versions are used.
+     *
+     * \param fluidStates The array of fluid states
+     * \param paramCaches The array of the parameter caches of the fluid states. They
+     *                    must have been updated for the respective fluid state.
+     * \param n The number of fluid states
+     * \param quantities The ORed ComputedQuantities which ought to be calculated
+     */
+    template <class FluidState, class ParameterCache>
+    static void computeAllBatch(FluidState *fluidStates,
+                                const ParameterCache *paramCaches,
+                                size_t n,
+                                int quantities = AllQuantities)
+    {
+        for (size_t i = 0; i < n; ++i)
+            Implementation::computeAll(fluidStates[i], paramCaches[i], quantities);
+    }
+
     /*!
      * \brief Calculate the density [kg/m^3] of a fluid phase
      *
@@ -194,6 +354,28 @@ public:
         OPM_THROW(std::runtime_error, "Not implemented: The fluid system '" << Opm::className<Implementation>() << "'  does not provide a fugacityCoefficient() method!");
     }
 
+    /*!
+     * \brief Calculate the fugacity coefficients of all components in a fluid phase
+     *
+     * This is equivalent to calling fugacityCoefficient() for each component, but
+     * fluid systems can override this method to share the intermediate results
+     * which only depend on the phase.
+     *
+     * \copydoc Doxygen::fluidSystemBaseParams
+     * \copydoc Doxygen::phaseIdxParam
+     * \param fugCoeffs The array of size numComponents which receives the results
+     */
+    template <class FluidState, class LhsEval, class ParameterCache>
+    static void fugacityCoefficients(const FluidState &fluidState,
+                                     const ParameterCache &paramCache,
+                                     int phaseIdx,
+                                     LhsEval *fugCoeffs)
+    {
+        for (int compIdx = 0; compIdx < Implementation::numComponents; ++compIdx)
+            fugCoeffs[compIdx] =
+                Implementation::template fugacityCoefficient<FluidState, LhsEval>(fluidState, paramCache, phaseIdx, compIdx);
+    }
+
     /*!
      * \brief Calculate the dynamic viscosity of a fluid phase [Pa*s]
      *
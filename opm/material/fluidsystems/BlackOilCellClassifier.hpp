@@ -0,0 +1,198 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::BlackOilCellClassifier
+ */
+#ifndef OPM_BLACK_OIL_CELL_CLASSIFIER_HPP
+#define OPM_BLACK_OIL_CELL_CLASSIFIER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Groups the cells of a black-oil model into classes which can be processed by
+ *        specialized kernels.
+ *
+ * The class of a cell is given by the phases which are present in it and by whether the
+ * hysteresis of its saturation functions is active. For example, the cells of the water
+ * leg only contain water, the cells of an undersaturated oil zone contain oil and water
+ * but no free gas, and the cells of a saturated zone contain all three phases. The sorted
+ * indices of the cells of each class are available via cellsOfClass(), so the
+ * quantities of a class can be computed by a kernel which only considers the phases
+ * which are present, cf. BlackOilPropertyPipeline::run().
+ *
+ * The phase presence of a cell is a bit mask where phase phaseIdx is present if bit
+ * (1 << phaseIdx) is set. Since the phase states usually only change for a few cells at
+ * a time, update() only moves the cells whose class has changed.
+ */
+class BlackOilCellClassifier
+{
+public:
+    //! The bits of a cell class which represent the phases which are present
+    enum { phasePresenceMask = 0x7 };
+
+    //! The bit of a cell class which is set if the hysteresis of the cell is active
+    enum { hystereticFlag = 0x8 };
+
+    //! The number of cell classes
+    enum { numClasses = 16 };
+
+    /*!
+     * \brief Returns the class of a cell for a given phase presence.
+     */
+    static unsigned cellClass(unsigned phasePresence, bool hysteretic)
+    { return (phasePresence & phasePresenceMask) | (hysteretic ? hystereticFlag : 0); }
+
+    /*!
+     * \brief Returns the phases which are present in the cells of a class.
+     */
+    static unsigned phasePresence(unsigned classIdx)
+    { return classIdx & phasePresenceMask; }
+
+    /*!
+     * \brief Returns true iff the hysteresis is active for the cells of a class.
+     */
+    static bool isHysteretic(unsigned classIdx)
+    { return (classIdx & hystereticFlag) != 0; }
+
+    /*!
+     * \brief Specify the number of cells.
+     *
+     * All cells are unclassified until the next call to update(), and the hysteresis is
+     * considered to be inactive for all cells.
+     */
+    void resize(unsigned numCells)
+    {
+        cellClass_.assign(numCells, unclassified_);
+        hysteretic_.assign(numCells, 0);
+        for (auto& cells : cellsOfClass_)
+            cells.clear();
+    }
+
+    /*!
+     * \brief Returns the number of cells.
+     */
+    unsigned size() const
+    { return cellClass_.size(); }
+
+    /*!
+     * \brief Specify whether the hysteresis is active for a cell.
+     *
+     * The cell is moved to its new class by the next call to update().
+     */
+    void setHysteretic(unsigned cellIdx, bool yesno)
+    { hysteretic_[cellIdx] = yesno ? 1 : 0; }
+
+    /*!
+     * \brief Take the activity of the hysteresis of all cells from the saturation
+     *        functions.
+     *
+     * \tparam SaturationFunctions The class which provides the saturation functions,
+     *                             usually EclMaterialLawManager. It must provide an
+     *                             isHysteretic(elemIdx) method.
+     */
+    template <class SaturationFunctions>
+    void setHysteretic(const SaturationFunctions& saturationFunctions)
+    {
+        for (unsigned cellIdx = 0; cellIdx < size(); ++cellIdx)
+            setHysteretic(cellIdx, saturationFunctions.isHysteretic(cellIdx));
+    }
+
+    /*!
+     * \brief Assign the cells to the classes which correspond to their phase presence.
+     *
+     * \param phasePresence The phases which are present in each cell
+     *
+     * \return The number of cells whose class has changed
+     */
+    unsigned update(const unsigned char* phasePresence)
+    {
+        std::array<std::vector<unsigned>, numClasses> addedCells;
+        std::array<bool, numClasses> modified;
+        std::fill(modified.begin(), modified.end(), false);
+
+        unsigned numChanged = 0;
+        for (unsigned cellIdx = 0; cellIdx < size(); ++cellIdx) {
+            unsigned newClass = cellClass(phasePresence[cellIdx], hysteretic_[cellIdx] != 0);
+            unsigned oldClass = cellClass_[cellIdx];
+            if (newClass == oldClass)
+                continue;
+
+            if (oldClass != unclassified_)
+                modified[oldClass] = true;
+            modified[newClass] = true;
+            addedCells[newClass].push_back(cellIdx);
+            cellClass_[cellIdx] = static_cast<unsigned char>(newClass);
+            ++numChanged;
+        }
+
+        // remove the cells which went to another class and merge the ones which were
+        // added. the cells were visited in ascending order, so the added ones are
+        // already sorted.
+        for (unsigned classIdx = 0; classIdx < numClasses; ++classIdx) {
+            if (!modified[classIdx])
+                continue;
+
+            auto& cells = cellsOfClass_[classIdx];
+            cells.erase(std::remove_if(cells.begin(), cells.end(),
+                                       [&](unsigned cellIdx)
+                                       { return cellClass_[cellIdx] != classIdx; }),
+                        cells.end());
+
+            size_t numKept = cells.size();
+            cells.insert(cells.end(), addedCells[classIdx].begin(), addedCells[classIdx].end());
+            std::inplace_merge(cells.begin(), cells.begin() + numKept, cells.end());
+        }
+
+        return numChanged;
+    }
+
+    /*!
+     * \brief Returns the class of a cell.
+     *
+     * The cell must have been classified by update().
+     */
+    unsigned cellClassOf(unsigned cellIdx) const
+    {
+        assert(cellClass_[cellIdx] != unclassified_);
+        return cellClass_[cellIdx];
+    }
+
+    /*!
+     * \brief Returns the sorted indices of the cells of a class.
+     */
+    const std::vector<unsigned>& cellsOfClass(unsigned classIdx) const
+    { return cellsOfClass_[classIdx]; }
+
+private:
+    enum { unclassified_ = 0xff };
+
+    std::vector<unsigned char> cellClass_;
+    std::vector<char> hysteretic_;
+    std::array<std::vector<unsigned>, numClasses> cellsOfClass_;
+};
+} // namespace Opm
+
+#endif
@@ -25,42 +25,126 @@
 #ifndef OPM_BLACK_OIL_FLUID_SYSTEM_HPP
 #define OPM_BLACK_OIL_FLUID_SYSTEM_HPP
 
-#include "blackoilpvt/OilPvtInterface.hpp"
-#include "blackoilpvt/GasPvtInterface.hpp"
-#include "blackoilpvt/WaterPvtInterface.hpp"
+namespace Opm {
+namespace FluidSystems {
+/*!
+ * \brief Specifies at compile time which phases and which miscibility effects are
+ *        considered by the black-oil fluid system.
+ *
+ * The oil phase is always considered. If the water or the gas phase is disabled, the
+ * fluid system only provides the remaining phases and components, i.e., fluid states
+ * become smaller and the code for the disabled phase is removed by the compiler. If
+ * dissolved gas or vaporized oil are disabled, the respective methods of the fluid
+ * system return a compile-time constant false and the respective runtime switches can
+ * no longer be enabled.
+ *
+ * \tparam enableWaterV Specifies whether the water phase is considered
+ * \tparam enableGasV Specifies whether the gas phase is considered
+ * \tparam enableDissolvedGasV Specifies whether gas may dissolve in the oil phase
+ * \tparam enableVaporizedOilV Specifies whether oil may vaporize into the gas phase
+ */
+template <bool enableWaterV = true,
+          bool enableGasV = true,
+          bool enableDissolvedGasV = true,
+          bool enableVaporizedOilV = true>
+struct BlackOilTraits
+{
+    static const bool enableWater = enableWaterV;
+    static const bool enableGas = enableGasV;
+    static const bool enableDissolvedGas = enableGasV && enableDissolvedGasV;
+    static const bool enableVaporizedOil = enableGasV && enableVaporizedOilV;
+};
+
+//! The traits for models which only consider the water and the (dead) oil phases
+typedef BlackOilTraits</*enableWater=*/true,
+                       /*enableGas=*/false,
+                       /*enableDissolvedGas=*/false,
+                       /*enableVaporizedOil=*/false> BlackOilWaterOilTraits;
+
+// the PVT implementation classes need this declaration because they are included by
+// the multiplexers below
+template <class Scalar, class Evaluation = Scalar, class Traits = BlackOilTraits<> >
+class BlackOil;
+}} // namespace Opm, FluidSystems
+
+#include "blackoilpvt/OilPvtMultiplexer.hpp"
+#include "blackoilpvt/GasPvtMultiplexer.hpp"
+#include "blackoilpvt/WaterPvtMultiplexer.hpp"
 
 #include <opm/material/fluidsystems/BaseFluidSystem.hpp>
+#include <opm/material/fluidsystems/ParameterCacheBase.hpp>
 #include <opm/material/Constants.hpp>
 
 #include <opm/material/common/MathToolbox.hpp>
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/Instrumentation.hpp>
 
 #include <memory>
 #include <vector>
 #include <array>
+#include <type_traits>
 
 namespace Opm {
 namespace FluidSystems {
 /*!
- * \brief A fluid system which uses the black-oil parameters
- *        to calculate termodynamically meaningful quantities.
+ * \brief An object which stores all parameters of the black-oil fluid system and
+ *        provides the same API as FluidSystems::BlackOil using non-static methods.
+ *
+ * Since all state is kept by the object, several differently configured fluid systems
+ * can be used within the same process. Once initEnd() has been called, an object can be
+ * accessed by multiple threads concurrently because all methods which calculate
+ * quantities are const. Note that the PVT objects which are used by such an object
+ * must be told about the reference densities via their setReferenceDensities() method
+ * if these differ from the ones of the default instance. The PVT objects derive the
+ * molar masses of the components from these, so they never access the default
+ * instance if the reference densities are set.
+ *
+ * The phases and the miscibility effects which are considered can be restricted at
+ * compile time using the Traits parameter, see BlackOilTraits. If a phase is disabled,
+ * the remaining phases and components are numbered consecutively and the index of the
+ * disabled one is negative. The PVT objects always use the numbering of the fluid
+ * system with all phases; canonicalPhaseIdx() and canonicalCompIdx() convert the
+ * indices.
  */
-template <class Scalar, class Evaluation = Scalar>
-class BlackOil : public BaseFluidSystem<Scalar, BlackOil<Scalar, Evaluation> >
+template <class Scalar, class Evaluation = Scalar, class Traits = BlackOilTraits<> >
+class BlackOilInstance
 {
     typedef Opm::GasPvtInterface<Scalar, Evaluation> GasPvtInterface;
     typedef Opm::OilPvtInterface<Scalar, Evaluation> OilPvtInterface;
     typedef Opm::WaterPvtInterface<Scalar, Evaluation> WaterPvtInterface;
 
+    // used for the constants which are independent of the actual fluid system
+    typedef Opm::BaseFluidSystem<Scalar, BlackOil<Scalar, Evaluation, Traits> > Base;
+
 public:
     //! \copydoc BaseFluidSystem::ParameterCache
-    class ParameterCache : public Opm::NullParameterCache
+    /*!
+     * Besides the index of the PVT region, the cache stores the results of the PVT
+     * relations of each phase, i.e., its formation volume factor, viscosity and
+     * density, as well as its fugacity coefficients. These are calculated by the first
+     * method of the fluid system which requires them and are re-used by the subsequent
+     * calls for the same cell as long as the temperature, the pressure and the
+     * dissolved mass fraction of the phase stay the same. The comparison includes the
+     * derivatives of these quantities, so the cached values are always consistent with
+     * the fluid state which is passed to the fluid system.
+     *
+     * The quantities are only cached for the evaluation types of the PVT interfaces,
+     * i.e., for Scalar and Evaluation. Since a cache is modified by the const methods of
+     * the fluid system, each thread needs to use its own cache objects.
+     */
+    class ParameterCache : public Opm::ParameterCacheBase<ParameterCache>
     {
+        typedef Opm::ParameterCacheBase<ParameterCache> ParentType;
+
+        friend class BlackOilInstance;
+
     public:
         ParameterCache(int regionIdx=0)
-        { regionIdx_ = 0; }
+            : regionIdx_(regionIdx)
+            , owner_(nullptr)
+        { invalidateAll_(); }
 
         /*!
          * \brief Return the index of the region which should be used to determine the
@@ -74,54 +158,110 @@ public:
          *        thermodynamic properties
          */
         void setRegionIndex(int val)
-        { regionIdx_ = val; }
+        {
+            if (val != regionIdx_)
+                invalidateAll_();
+            regionIdx_ = val;
+        }
+
+        /*!
+         * \brief Forget the cached quantities of a fluid phase.
+         *
+         * Since the cached quantities are keyed on the state of the phase, calling this
+         * is only required if the PVT relations of the fluid system have been
+         * modified.
+         */
+        template <class FluidState>
+        void updatePhase(const FluidState& /*fluidState*/,
+                         int phaseIdx,
+                         int exceptQuantities = ParentType::None)
+        {
+            const int allQuantities =
+                ParentType::Temperature
+                | ParentType::Pressure
+                | ParentType::Composition;
+            if (exceptQuantities == allQuantities)
+                return;
+
+            invalidatePhase_(phaseIdx);
+        }
 
     private:
+        struct PropertiesEntry
+        {
+            Evaluation temperature;
+            Evaluation pressure;
+            Evaluation massFraction;
+            BlackOilPhaseProperties<Evaluation> properties;
+            bool isValid;
+            bool hasDerivatives;
+        };
+
+        struct FugacityEntry
+        {
+            Evaluation temperature;
+            Evaluation pressure;
+            Evaluation value;
+            bool isValid;
+            bool hasDerivatives;
+        };
+
+        // the cached quantities only belong to the fluid system object which
+        // calculated them
+        void checkOwner_(const BlackOilInstance* fluidSystem) const
+        {
+            if (owner_ != fluidSystem) {
+                invalidateAll_();
+                owner_ = fluidSystem;
+            }
+        }
+
+        void invalidatePhase_(int phaseIdx) const
+        {
+            propertiesEntries_[phaseIdx].isValid = false;
+            for (int compIdx = 0; compIdx < 3; ++compIdx)
+                fugacityEntries_[phaseIdx][compIdx].isValid = false;
+        }
+
+        void invalidateAll_() const
+        {
+            for (int phaseIdx = 0; phaseIdx < 3; ++phaseIdx)
+                invalidatePhase_(phaseIdx);
+        }
+
         int regionIdx_;
+        mutable const BlackOilInstance* owner_;
+
+        // the entries are indexed by the phase and component indices of the fluid
+        // system. (the literal '3' is used for the same reason as for the reference
+        // densities below.)
+        mutable PropertiesEntry propertiesEntries_[/*numPhases=*/3];
+        mutable FugacityEntry fugacityEntries_[/*numPhases=*/3][/*numComponents=*/3];
     };
 
     /****************************************
      * Fluid phase parameters
      ****************************************/
 
+    //! Specifies whether the water phase is considered
+    static const bool waterIsActive = Traits::enableWater;
+    //! Specifies whether the gas phase is considered
+    static const bool gasIsActive = Traits::enableGas;
+
     //! \copydoc BaseFluidSystem::numPhases
-    static const int numPhases = 3;
+    static const int numPhases = 1 + (waterIsActive?1:0) + (gasIsActive?1:0);
 
-    //! Index of the water phase
-    static const int waterPhaseIdx = 0;
+    //! Index of the water phase. This is -1 if the water phase is disabled.
+    static const int waterPhaseIdx = waterIsActive?0:-1;
     //! Index of the oil phase
-    static const int oilPhaseIdx = 1;
-    //! Index of the gas phase
-    static const int gasPhaseIdx = 2;
-
-    //! The pressure at the surface
-    static const Scalar surfacePressure;
+    static const int oilPhaseIdx = waterIsActive?1:0;
+    //! Index of the gas phase. This is -2 if the gas phase is disabled.
+    static const int gasPhaseIdx = gasIsActive?(oilPhaseIdx + 1):-2;
 
-    //! The temperature at the surface
-    static const Scalar surfaceTemperature;
-
-    /*!
-     * \copydoc BaseFluidSystem::init
-     *
-     * \attention For this fluid system, this method just throws a
-     *            <tt>std::logic_error</tt> as there is no
-     *            way to generically calculate the required black oil
-     *            parameters. Instead of this method, use
-     * \code
-     * FluidSystem::initBegin();
-     * // set the black oil parameters
-     * FluidSystem::initEnd();
-     * \endcode
-     */
-    static void init()
-    {
-        OPM_THROW(std::logic_error,
-                  "There is no generic init() method for this fluid system. The "
-                  << "black-oil fluid system must be initialized using:\n"
-                  << "    FluidSystem::initBegin()\n"
-                  << "    // set black oil parameters\n"
-                  << "    FluidSystem::initEnd()\n");
-    }
+    BlackOilInstance()
+        : enableDissolvedGas_(Traits::enableDissolvedGas)
+        , enableVaporizedOil_(false)
+    {}
 
     /*!
      * \brief Begin the initialization of the black oil fluid system.
@@ -130,10 +270,13 @@ public:
      * volume factors, the oil bubble pressure, all viscosities and the water
      * compressibility must be set. Before the fluid system can be used, initEnd() must
      * be called to finalize the initialization.
+     *
+     * In parallel runs, it is sufficient to set up the PVT regions which are used by
+     * the local cells. CompactRegionIndices can be used to number them consecutively.
      */
-    static void initBegin(int numPvtRegions)
+    void initBegin(int numPvtRegions)
     {
-        enableDissolvedGas_ = true;
+        enableDissolvedGas_ = Traits::enableDissolvedGas;
         enableVaporizedOil_ = false;
 
         resizeArrays_(numPvtRegions);
@@ -143,10 +286,15 @@ public:
      * \brief Specify whether the fluid system should consider that the gas component can
      *        dissolve in the oil phase
      *
-     * By default, dissolved gas is considered.
+     * By default, dissolved gas is considered unless it has been disabled by the
+     * traits.
      */
-    static void setEnableDissolvedGas(bool yesno)
-    { enableDissolvedGas_ = yesno; }
+    void setEnableDissolvedGas(bool yesno)
+    {
+        if (yesno && !Traits::enableDissolvedGas)
+            OPM_THROW(std::logic_error, "Dissolved gas has been disabled at compile time");
+        enableDissolvedGas_ = yesno;
+    }
 
     /*!
      * \brief Specify whether the fluid system should consider that the oil component can
@@ -154,26 +302,30 @@ public:
      *
      * By default, vaporized oil is not considered.
      */
-    static void setEnableVaporizedOil(bool yesno)
-    { enableVaporizedOil_ = yesno; }
+    void setEnableVaporizedOil(bool yesno)
+    {
+        if (yesno && !Traits::enableVaporizedOil)
+            OPM_THROW(std::logic_error, "Vaporized oil has been disabled at compile time");
+        enableVaporizedOil_ = yesno;
+    }
 
     /*!
      * \brief Set the pressure-volume-saturation (PVT) relations for the gas phase.
      */
-    static void setGasPvt(std::shared_ptr<const GasPvtInterface> pvtObj)
-    { gasPvt_ = pvtObj; }
+    void setGasPvt(std::shared_ptr<const GasPvtInterface> pvtObj)
+    { gasPvt_.setPvt(pvtObj); }
 
     /*!
      * \brief Set the pressure-volume-saturation (PVT) relations for the oil phase.
      */
-    static void setOilPvt(std::shared_ptr<const OilPvtInterface> pvtObj)
-    { oilPvt_ = pvtObj; }
+    void setOilPvt(std::shared_ptr<const OilPvtInterface> pvtObj)
+    { oilPvt_.setPvt(pvtObj); }
 
     /*!
      * \brief Set the pressure-volume-saturation (PVT) relations for the water phase.
      */
-    static void setWaterPvt(std::shared_ptr<const WaterPvtInterface> pvtObj)
-    { waterPvt_ = pvtObj; }
+    void setWaterPvt(std::shared_ptr<const WaterPvtInterface> pvtObj)
+    { waterPvt_.setPvt(pvtObj); }
 
     /*!
      * \brief Initialize the values of the reference densities
@@ -182,20 +334,20 @@ public:
      * \param rhoWater The reference density of the water phase.
      * \param rhoGas The reference density of the gas phase.
      */
-    static void setReferenceDensities(Scalar rhoOil,
-                                      Scalar rhoWater,
-                                      Scalar rhoGas,
-                                      int regionIdx)
+    void setReferenceDensities(Scalar rhoOil,
+                               Scalar rhoWater,
+                               Scalar rhoGas,
+                               int regionIdx)
     {
-        referenceDensity_[regionIdx][oilPhaseIdx] = rhoOil;
-        referenceDensity_[regionIdx][waterPhaseIdx] = rhoWater;
-        referenceDensity_[regionIdx][gasPhaseIdx] = rhoGas;
+        referenceDensity_[regionIdx][canonicalPhaseIdx(oilPhaseIdx)] = rhoOil;
+        referenceDensity_[regionIdx][canonicalPhaseIdx(waterPhaseIdx)] = rhoWater;
+        referenceDensity_[regionIdx][canonicalPhaseIdx(gasPhaseIdx)] = rhoGas;
     }
 
     /*!
      * \brief Finish initializing the black oil fluid system.
      */
-    static void initEnd()
+    void initEnd()
     {
         // calculate the final 2D functions which are used for interpolation.
         int numRegions = molarMass_.size();
@@ -203,17 +355,17 @@ public:
             // calculate molar masses
 
             // water is simple: 18 g/mol
-            molarMass_[regionIdx][waterCompIdx] = 18e-3;
+            molarMass_[regionIdx][canonicalCompIdx(waterCompIdx)] = 18e-3;
 
             // for gas, we take the density at standard conditions and assume it to be ideal
-            Scalar p = surfacePressure;
-            Scalar T = surfaceTemperature;
-            Scalar rho_g = referenceDensity_[/*regionIdx=*/0][gasPhaseIdx];
-            molarMass_[regionIdx][gasCompIdx] = Opm::Constants<Scalar>::R*T*rho_g / p;
+            Scalar p = BlackOil<Scalar, Evaluation, Traits>::surfacePressure;
+            Scalar T = BlackOil<Scalar, Evaluation, Traits>::surfaceTemperature;
+            Scalar rho_g = referenceDensity_[/*regionIdx=*/0][canonicalPhaseIdx(gasPhaseIdx)];
+            molarMass_[regionIdx][canonicalCompIdx(gasCompIdx)] = Opm::Constants<Scalar>::R*T*rho_g / p;
 
             // finally, for oil phase, we take the molar mass from the
             // spe9 paper
-            molarMass_[regionIdx][oilCompIdx] = 175e-3; // kg/mol
+            molarMass_[regionIdx][canonicalCompIdx(oilCompIdx)] = 175e-3; // kg/mol
         }
     }
 
@@ -223,7 +375,7 @@ public:
         static const char *name[] = { "water", "oil", "gas" };
 
         assert(0 <= phaseIdx && phaseIdx < numPhases + 1);
-        return name[phaseIdx];
+        return name[canonicalPhaseIdx(phaseIdx)];
     }
 
     //! \copydoc BaseFluidSystem::isLiquid
@@ -238,14 +390,30 @@ public:
      ****************************************/
 
     //! \copydoc BaseFluidSystem::numComponents
-    static const int numComponents = 3;
+    static const int numComponents = numPhases;
 
+    // if the gas phase is disabled, the components are numbered like the phases, so
+    // that fluid states can assume immiscibility
     //! Index of the oil component
-    static const int oilCompIdx = 0;
-    //! Index of the water component
-    static const int waterCompIdx = 1;
-    //! Index of the gas component
-    static const int gasCompIdx = 2;
+    static const int oilCompIdx = (gasIsActive || !waterIsActive)?0:1;
+    //! Index of the water component. This is -1 if the water phase is disabled.
+    static const int waterCompIdx = !waterIsActive?-1:(gasIsActive?1:0);
+    //! Index of the gas component. This is -2 if the gas phase is disabled.
+    static const int gasCompIdx = !gasIsActive?-2:(waterIsActive?2:1);
+
+    /*!
+     * \brief Returns the index of a phase for the fluid system which considers all
+     *        phases, i.e., 0 for water, 1 for oil and 2 for gas.
+     */
+    static int canonicalPhaseIdx(int phaseIdx)
+    { return (phaseIdx == waterPhaseIdx)?0:((phaseIdx == oilPhaseIdx)?1:2); }
+
+    /*!
+     * \brief Returns the index of a component for the fluid system which considers all
+     *        phases, i.e., 0 for oil, 1 for water and 2 for gas.
+     */
+    static int canonicalCompIdx(int compIdx)
+    { return (compIdx == oilCompIdx)?0:((compIdx == waterCompIdx)?1:2); }
 
     //! \copydoc BaseFluidSystem::componentName
     static const char *componentName(int compIdx)
@@ -253,12 +421,12 @@ public:
         static const char *name[] = { "Oil", "Water", "Gas" };
 
         assert(0 <= compIdx && compIdx < numComponents);
-        return name[compIdx];
+        return name[canonicalCompIdx(compIdx)];
     }
 
     //! \copydoc BaseFluidSystem::molarMass
-    static Scalar molarMass(int compIdx, int regionIdx = 0)
-    { return molarMass_[regionIdx][compIdx]; }
+    Scalar molarMass(int compIdx, int regionIdx = 0) const
+    { return molarMass_[regionIdx][canonicalCompIdx(compIdx)]; }
 
     //! \copydoc BaseFluidSystem::isIdealMixture
     static bool isIdealMixture(int phaseIdx)
@@ -281,10 +449,11 @@ public:
      ****************************************/
     //! \copydoc BaseFluidSystem::density
     template <class FluidState, class LhsEval = typename FluidState::Scalar>
-    static LhsEval density(const FluidState &fluidState,
-                           ParameterCache &paramCache,
-                           const int phaseIdx)
+    LhsEval density(const FluidState &fluidState,
+                    ParameterCache &paramCache,
+                    const int phaseIdx) const
     {
+        OPM_INSTRUMENT_SCOPE("BlackOil::density");
         assert(0 <= phaseIdx  && phaseIdx <= numPhases);
 
         typedef typename FluidState::Scalar FsEval;
@@ -292,29 +461,17 @@ public:
 
         const auto& p = FsToolbox::template toLhs<LhsEval>(fluidState.pressure(phaseIdx));
         const auto& T = FsToolbox::template toLhs<LhsEval>(fluidState.temperature(phaseIdx));
-        int regionIdx = paramCache.regionIndex();
-
-        switch (phaseIdx) {
-        case waterPhaseIdx: return waterDensity<LhsEval>(T, p, regionIdx);
-        case gasPhaseIdx: {
-            const auto& XgO = FsToolbox::template toLhs<LhsEval>(fluidState.massFraction(gasPhaseIdx, oilCompIdx));
-            return gasDensity<LhsEval>(T, p, XgO, regionIdx);
-        }
-        case oilPhaseIdx: {
-            const auto& XoG = FsToolbox::template toLhs<LhsEval>(fluidState.massFraction(oilPhaseIdx, gasCompIdx));
-            return oilDensity<LhsEval>(T, p, XoG, regionIdx);
-        }
-        }
 
-        OPM_THROW(std::logic_error, "Unhandled phase index " << phaseIdx);
+        const auto& X = dissolvedMassFraction_<LhsEval>(fluidState, phaseIdx);
+        return cachedProperties_(paramCache, phaseIdx, T, p, X).density;
     }
 
     //! \copydoc BaseFluidSystem::fugacityCoefficient
     template <class FluidState, class LhsEval = typename FluidState::Scalar>
-    static LhsEval fugacityCoefficient(const FluidState &fluidState,
-                                       const ParameterCache &paramCache,
-                                       int phaseIdx,
-                                       int compIdx)
+    LhsEval fugacityCoefficient(const FluidState &fluidState,
+                                const ParameterCache &paramCache,
+                                int phaseIdx,
+                                int compIdx) const
     {
         assert(0 <= phaseIdx  && phaseIdx <= numPhases);
         assert(0 <= compIdx  && compIdx <= numComponents);
@@ -323,55 +480,37 @@ public:
 
         const auto& p = FsToolbox::template toLhs<LhsEval>(fluidState.pressure(phaseIdx));
         const auto& T = FsToolbox::template toLhs<LhsEval>(fluidState.temperature(phaseIdx));
-        int regionIdx = paramCache.regionIndex();
-
-        switch (phaseIdx) {
-        case waterPhaseIdx: return fugCoefficientInWater<LhsEval>(compIdx, T, p, regionIdx);
-        case gasPhaseIdx: return fugCoefficientInGas<LhsEval>(compIdx, T, p, regionIdx);
-        case oilPhaseIdx: return fugCoefficientInOil<LhsEval>(compIdx, T, p, regionIdx);
-        }
 
-        OPM_THROW(std::logic_error, "Unhandled phase or component index");
+        return cachedFugacityCoefficient_(paramCache, phaseIdx, compIdx, T, p);
     }
 
     //! \copydoc BaseFluidSystem::viscosity
     template <class FluidState, class LhsEval = typename FluidState::Scalar>
-    static LhsEval viscosity(const FluidState &fluidState,
-                             const ParameterCache &paramCache,
-                             int phaseIdx)
+    LhsEval viscosity(const FluidState &fluidState,
+                      const ParameterCache &paramCache,
+                      int phaseIdx) const
     {
+        OPM_INSTRUMENT_SCOPE("BlackOil::viscosity");
         assert(0 <= phaseIdx  && phaseIdx <= numPhases);
 
         typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
 
         const auto& p = FsToolbox::template toLhs<LhsEval>(fluidState.pressure(phaseIdx));
         const auto& T = FsToolbox::template toLhs<LhsEval>(fluidState.temperature(phaseIdx));
-        int regionIdx = paramCache.regionIndex();
-
-        switch (phaseIdx) {
-        case oilPhaseIdx: {
-            const auto& XoG = FsToolbox::template toLhs<LhsEval>(fluidState.massFraction(oilPhaseIdx, gasCompIdx));
-            return oilPvt_->viscosity(regionIdx, T, p, XoG);
-        }
-        case waterPhaseIdx:
-            return waterPvt_->viscosity(regionIdx, T, p);
-        case gasPhaseIdx: {
-            const auto& XgO = FsToolbox::template toLhs<LhsEval>(fluidState.massFraction(gasPhaseIdx, oilCompIdx));
-            return gasPvt_->viscosity(regionIdx, T, p, XgO);
-        }
-        }
 
-        OPM_THROW(std::logic_error, "Unhandled phase index " << phaseIdx);
+        const auto& X = dissolvedMassFraction_<LhsEval>(fluidState, phaseIdx);
+        return cachedProperties_(paramCache, phaseIdx, T, p, X).mu;
     }
 
     /*!
      * \brief Returns whether the fluid system should consider that the gas component can
      *        dissolve in the oil phase
      *
-     * By default, dissolved gas is considered.
+     * By default, dissolved gas is considered unless it has been disabled by the
+     * traits.
      */
-    static bool enableDissolvedGas()
-    { return enableDissolvedGas_; }
+    bool enableDissolvedGas() const
+    { return Traits::enableDissolvedGas && enableDissolvedGas_; }
 
     /*!
      * \brief Returns whether the fluid system should consider that the oil component can
@@ -379,16 +518,45 @@ public:
      *
      * By default, vaporized oil is not considered.
      */
-    static bool enableVaporizedOil()
-    { return enableVaporizedOil_; }
+    bool enableVaporizedOil() const
+    { return Traits::enableVaporizedOil && enableVaporizedOil_; }
+
+    /*!
+     * \copydoc BaseFluidSystem::densityDependencies
+     *
+     * The composition of the oil phase is only considered if dissolved gas is
+     * enabled, the one of the gas phase only if vaporized oil is enabled. Water
+     * never contains any other component.
+     */
+    unsigned densityDependencies(int phaseIdx) const
+    {
+        unsigned result = Base::PressureDependency | Base::TemperatureDependency;
+        if ((phaseIdx == oilPhaseIdx && enableDissolvedGas())
+            || (phaseIdx == gasPhaseIdx && enableVaporizedOil()))
+            result |= Base::CompositionDependency;
+        return result;
+    }
+
+    //! \copydoc densityDependencies
+    unsigned viscosityDependencies(int phaseIdx) const
+    { return densityDependencies(phaseIdx); }
+
+    /*!
+     * \copydoc BaseFluidSystem::fugacityCoefficientDependencies
+     *
+     * All phases are ideal mixtures, so the fugacity coefficients never depend on the
+     * composition.
+     */
+    static unsigned fugacityCoefficientDependencies(int /*phaseIdx*/, int /*compIdx*/)
+    { return Base::PressureDependency | Base::TemperatureDependency; }
 
     /*!
      * \brief Returns the density of a fluid phase at surface pressure [kg/m^3]
      *
      * \copydoc Doxygen::phaseIdxParam
      */
-    static Scalar referenceDensity(int phaseIdx, int regionIdx)
-    { return referenceDensity_[regionIdx][phaseIdx]; }
+    Scalar referenceDensity(int phaseIdx, int regionIdx) const
+    { return referenceDensity_[regionIdx][canonicalPhaseIdx(phaseIdx)]; }
 
     /*!
      * \brief Returns the oil formation volume factor \f$B_o\f$ of saturated oil for a given pressure
@@ -396,9 +564,9 @@ public:
      * \param pressure The pressure of interest [Pa]
      */
     template <class LhsEval>
-    static LhsEval saturatedOilFormationVolumeFactor(const LhsEval& temperature,
-                                                     const LhsEval& pressure,
-                                                     int regionIdx)
+    LhsEval saturatedOilFormationVolumeFactor(const LhsEval& temperature,
+                                              const LhsEval& pressure,
+                                              int regionIdx) const
     {
         Valgrind::CheckDefined(pressure);
 
@@ -412,10 +580,10 @@ public:
      * \brief Return the formation volume factor of water.
      */
     template <class LhsEval>
-    static LhsEval waterFormationVolumeFactor(const LhsEval& temperature,
-                                              const LhsEval& pressure,
-                                              int regionIdx)
-    { return waterPvt_->formationVolumeFactor(regionIdx, temperature, pressure); }
+    LhsEval waterFormationVolumeFactor(const LhsEval& temperature,
+                                       const LhsEval& pressure,
+                                       int regionIdx) const
+    { return waterPvt_.formationVolumeFactor(regionIdx, temperature, pressure); }
 
     /*!
      * \brief Returns the gas dissolution factor \f$R_s\f$ for a given pressure
@@ -423,10 +591,10 @@ public:
      * \param pressure The pressure of interest [Pa]
      */
     template <class LhsEval>
-    static LhsEval gasDissolutionFactor(const LhsEval& temperature,
-                                        const LhsEval& pressure,
-                                        int regionIdx)
-    { return oilPvt_->gasDissolutionFactor(regionIdx, temperature, pressure); }
+    LhsEval gasDissolutionFactor(const LhsEval& temperature,
+                                 const LhsEval& pressure,
+                                 int regionIdx) const
+    { return oilPvt_.gasDissolutionFactor(regionIdx, temperature, pressure); }
 
     /*!
      * \brief Returns the oil vaporization factor \f$R_v\f$ for a given pressure
@@ -434,10 +602,10 @@ public:
      * \param pressure The pressure of interest [Pa]
      */
     template <class LhsEval>
-    static LhsEval oilVaporizationFactor(const LhsEval& temperature,
-                                         const LhsEval& pressure,
-                                         int regionIdx)
-    { return gasPvt_->oilVaporizationFactor(regionIdx, temperature, pressure); }
+    LhsEval oilVaporizationFactor(const LhsEval& temperature,
+                                  const LhsEval& pressure,
+                                  int regionIdx) const
+    { return gasPvt_.oilVaporizationFactor(regionIdx, temperature, pressure); }
 
     /*!
      * \brief Returns the fugacity coefficient of a given component in the water phase
@@ -446,11 +614,11 @@ public:
      * \param pressure The pressure of interest [Pa]
      */
     template <class LhsEval>
-    static LhsEval fugCoefficientInWater(int compIdx,
-                                         const LhsEval& temperature,
-                                         const LhsEval& pressure,
-                                         int regionIdx)
-    { return waterPvt_->fugacityCoefficient(regionIdx, temperature, pressure, compIdx); }
+    LhsEval fugCoefficientInWater(int compIdx,
+                                  const LhsEval& temperature,
+                                  const LhsEval& pressure,
+                                  int regionIdx) const
+    { return waterPvt_.fugacityCoefficient(regionIdx, temperature, pressure, canonicalCompIdx(compIdx)); }
 
     /*!
      * \brief Returns the fugacity coefficient of a given component in the gas phase
@@ -459,11 +627,11 @@ public:
      * \param pressure The pressure of interest [Pa]
      */
     template <class LhsEval>
-    static LhsEval fugCoefficientInGas(int compIdx,
-                                       const LhsEval& temperature,
-                                       const LhsEval& pressure,
-                                       int regionIdx)
-    { return gasPvt_->fugacityCoefficient(regionIdx, temperature, pressure, compIdx); }
+    LhsEval fugCoefficientInGas(int compIdx,
+                                const LhsEval& temperature,
+                                const LhsEval& pressure,
+                                int regionIdx) const
+    { return gasPvt_.fugacityCoefficient(regionIdx, temperature, pressure, canonicalCompIdx(compIdx)); }
 
     /*!
      * \brief Returns the fugacity coefficient of a given component in the oil phase
@@ -472,11 +640,11 @@ public:
      * \param pressure The pressure of interest [Pa]
      */
     template <class LhsEval>
-    static LhsEval fugCoefficientInOil(int compIdx,
-                                       const LhsEval& temperature,
-                                       const LhsEval& pressure,
-                                       int regionIdx)
-    { return oilPvt_->fugacityCoefficient(regionIdx, temperature, pressure, compIdx); }
+    LhsEval fugCoefficientInOil(int compIdx,
+                                const LhsEval& temperature,
+                                const LhsEval& pressure,
+                                int regionIdx) const
+    { return oilPvt_.fugacityCoefficient(regionIdx, temperature, pressure, canonicalCompIdx(compIdx)); }
 
     /*!
      * \brief Returns the saturation pressure of the oil phase [Pa]
@@ -485,164 +653,741 @@ public:
      * \param XoG The mass fraction of the gas component in the oil phase [-]
      */
     template <class LhsEval>
-    static LhsEval oilSaturationPressure(const LhsEval& temperature,
-                                         const LhsEval& XoG,
-                                         int regionIdx)
-    { return oilPvt_->oilSaturationPressure(regionIdx, temperature, XoG); }
+    LhsEval oilSaturationPressure(const LhsEval& temperature,
+                                  const LhsEval& XoG,
+                                  int regionIdx) const
+    { return oilPvt_.oilSaturationPressure(regionIdx, temperature, XoG); }
 
     /*!
      * \brief The maximum mass fraction of the gas component in the oil phase.
      */
     template <class LhsEval>
-    static LhsEval saturatedOilGasMassFraction(const LhsEval& temperature,
-                                               const LhsEval& pressure,
-                                               int regionIdx)
-    { return oilPvt_->saturatedOilGasMassFraction(regionIdx, temperature, pressure); }
+    LhsEval saturatedOilGasMassFraction(const LhsEval& temperature,
+                                        const LhsEval& pressure,
+                                        int regionIdx) const
+    { return oilPvt_.saturatedOilGasMassFraction(regionIdx, temperature, pressure); }
 
     /*!
      * \brief The maximum mole fraction of the gas component in the oil phase.
      */
     template <class LhsEval>
-    static LhsEval saturatedOilGasMoleFraction(const LhsEval& temperature,
-                                               const LhsEval& pressure,
-                                               int regionIdx)
-    { return oilPvt_->saturatedOilGasMoleFraction(regionIdx, temperature, pressure); }
+    LhsEval saturatedOilGasMoleFraction(const LhsEval& temperature,
+                                        const LhsEval& pressure,
+                                        int regionIdx) const
+    { return oilPvt_.saturatedOilGasMoleFraction(regionIdx, temperature, pressure); }
 
     /*!
      * \brief The maximum mass fraction of the oil component in the gas phase.
      */
     template <class LhsEval>
-    static LhsEval saturatedGasOilMassFraction(const LhsEval& temperature,
-                                               const LhsEval& pressure,
-                                               int regionIdx)
-    { return gasPvt_->saturatedGasOilMassFraction(regionIdx, temperature, pressure); }
+    LhsEval saturatedGasOilMassFraction(const LhsEval& temperature,
+                                        const LhsEval& pressure,
+                                        int regionIdx) const
+    { return gasPvt_.saturatedGasOilMassFraction(regionIdx, temperature, pressure); }
 
     /*!
      * \brief The maximum mole fraction of the oil component in the gas phase.
      */
     template <class LhsEval>
-    static LhsEval saturatedGasOilMoleFraction(const LhsEval& temperature,
-                                               const LhsEval& pressure,
-                                               int regionIdx)
-    { return gasPvt_->saturatedGasOilMoleFraction(regionIdx, temperature, pressure); }
+    LhsEval saturatedGasOilMoleFraction(const LhsEval& temperature,
+                                        const LhsEval& pressure,
+                                        int regionIdx) const
+    { return gasPvt_.saturatedGasOilMoleFraction(regionIdx, temperature, pressure); }
 
     /*!
      * \brief Return the normalized formation volume factor of (potentially)
      *        under-saturated oil.
      */
     template <class LhsEval>
-    static LhsEval oilFormationVolumeFactor(const LhsEval& temperature,
-                                            const LhsEval& pressure,
-                                            const LhsEval& XoG,
-                                            int regionIdx)
-    { return oilPvt_->formationVolumeFactor(regionIdx, temperature, pressure, XoG); }
+    LhsEval oilFormationVolumeFactor(const LhsEval& temperature,
+                                     const LhsEval& pressure,
+                                     const LhsEval& XoG,
+                                     int regionIdx) const
+    { return oilPvt_.formationVolumeFactor(regionIdx, temperature, pressure, XoG); }
 
     /*!
      * \brief Return the density of (potentially) under-saturated oil.
      */
     template <class LhsEval>
-    static LhsEval oilDensity(const LhsEval& temperature,
-                              const LhsEval& pressure,
-                              const LhsEval& XoG,
-                              int regionIdx)
-    { return oilPvt_->density(regionIdx, temperature, pressure, XoG); }
+    LhsEval oilDensity(const LhsEval& temperature,
+                       const LhsEval& pressure,
+                       const LhsEval& XoG,
+                       int regionIdx) const
+    { return oilPvt_.density(regionIdx, temperature, pressure, XoG); }
 
     /*!
      * \brief Return the density of gas-saturated oil.
      */
     template <class LhsEval>
-    static LhsEval saturatedOilDensity(const LhsEval& temperature,
-                                       const LhsEval& pressure,
-                                       int regionIdx)
+    LhsEval saturatedOilDensity(const LhsEval& temperature,
+                                const LhsEval& pressure,
+                                int regionIdx) const
     {
         // mass fraction of gas-saturated oil
         const LhsEval& XoG = saturatedOilGasMassFraction(temperature, pressure, regionIdx);
-        return oilPvt_->density(regionIdx, temperature, pressure, XoG);
+        return oilPvt_.density(regionIdx, temperature, pressure, XoG);
     }
 
     /*!
      * \brief Return the formation volume factor of gas.
      */
     template <class LhsEval>
-    static LhsEval gasFormationVolumeFactor(const LhsEval& temperature,
-                                            const LhsEval& pressure,
-                                            const LhsEval& XgO,
-                                            int regionIdx)
-    { return gasPvt_->formationVolumeFactor(regionIdx, temperature, pressure, XgO); }
+    LhsEval gasFormationVolumeFactor(const LhsEval& temperature,
+                                     const LhsEval& pressure,
+                                     const LhsEval& XgO,
+                                     int regionIdx) const
+    { return gasPvt_.formationVolumeFactor(regionIdx, temperature, pressure, XgO); }
 
     /*!
      * \brief Return the density of dry gas.
      */
     template <class LhsEval>
-    static LhsEval gasDensity(const LhsEval& temperature,
-                              const LhsEval& pressure,
-                              const LhsEval& XgO,
-                              int regionIdx)
-    { return gasPvt_->density(regionIdx, temperature, pressure, XgO); }
+    LhsEval gasDensity(const LhsEval& temperature,
+                       const LhsEval& pressure,
+                       const LhsEval& XgO,
+                       int regionIdx) const
+    { return gasPvt_.density(regionIdx, temperature, pressure, XgO); }
 
     /*!
      * \brief Return the density of water.
      */
     template <class LhsEval>
-    static LhsEval waterDensity(const LhsEval& temperature,
-                                const LhsEval& pressure,
-                                int regionIdx)
-    { return waterPvt_->density(regionIdx, temperature, pressure); }
+    LhsEval waterDensity(const LhsEval& temperature,
+                         const LhsEval& pressure,
+                         int regionIdx) const
+    { return waterPvt_.density(regionIdx, temperature, pressure); }
+
+    /*!
+     * \brief Return the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of (potentially) under-saturated oil.
+     *
+     * This is cheaper than calling the respective methods individually.
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> oilProperties(const LhsEval& temperature,
+                                                   const LhsEval& pressure,
+                                                   const LhsEval& XoG,
+                                                   int regionIdx) const
+    { return oilPvt_.properties(regionIdx, temperature, pressure, XoG); }
+
+    /*!
+     * \brief Return the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of gas.
+     *
+     * This is cheaper than calling the respective methods individually.
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> gasProperties(const LhsEval& temperature,
+                                                   const LhsEval& pressure,
+                                                   const LhsEval& XgO,
+                                                   int regionIdx) const
+    { return gasPvt_.properties(regionIdx, temperature, pressure, XgO); }
+
+    /*!
+     * \brief Return the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of water.
+     *
+     * This is cheaper than calling the respective methods individually.
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> waterProperties(const LhsEval& temperature,
+                                                     const LhsEval& pressure,
+                                                     int regionIdx) const
+    { return waterPvt_.properties(regionIdx, temperature, pressure); }
 
 private:
-    static void resizeArrays_(int numRegions)
+    // the PVT interfaces only provide the quantities for these types, so the parameter
+    // cache can only store them for these
+    template <class LhsEval>
+    struct IsCacheable_
+        : public std::integral_constant<bool,
+                                        std::is_same<LhsEval, Scalar>::value
+                                        || std::is_same<LhsEval, Evaluation>::value>
+    {};
+
+    // the mass fraction of the component which is dissolved in a phase, i.e., of gas in
+    // oil and of oil in gas. water does not dissolve anything.
+    template <class LhsEval, class FluidState>
+    static LhsEval dissolvedMassFraction_(const FluidState& fluidState, int phaseIdx)
     {
-        molarMass_.resize(numRegions);
-        referenceDensity_.resize(numRegions);
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        if (phaseIdx == oilPhaseIdx)
+            return oilGasMassFraction_<LhsEval>(fluidState);
+        else if (phaseIdx == gasPhaseIdx)
+            return FsToolbox::template toLhs<LhsEval>(fluidState.massFraction(gasPhaseIdx, oilCompIdx));
+        return 0.0;
     }
 
-    static std::shared_ptr<const Opm::GasPvtInterface<Scalar, Evaluation> > gasPvt_;
-    static std::shared_ptr<const Opm::OilPvtInterface<Scalar, Evaluation> > oilPvt_;
-    static std::shared_ptr<const Opm::WaterPvtInterface<Scalar, Evaluation> > waterPvt_;
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> calculateProperties_(int regionIdx,
+                                                          int phaseIdx,
+                                                          const LhsEval& T,
+                                                          const LhsEval& p,
+                                                          const LhsEval& X) const
+    {
+        switch (phaseIdx) {
+        case waterPhaseIdx: return waterPvt_.properties(regionIdx, T, p);
+        case gasPhaseIdx: return gasPvt_.properties(regionIdx, T, p, X);
+        case oilPhaseIdx: return oilPvt_.properties(regionIdx, T, p, X);
+        }
 
-    static bool enableDissolvedGas_;
-    static bool enableVaporizedOil_;
+        OPM_THROW(std::logic_error, "Unhandled phase index " << phaseIdx);
+    }
 
-    // HACK for GCC 4.4: the array size has to be specified using the literal value '3'
-    // here, because GCC 4.4 seems to be unable to determine the number of phases from
-    // the BlackOil fluid system in the attribute declaration below...
-    static std::vector<std::array<Scalar, /*numPhases=*/3> > referenceDensity_;
-    static std::vector<std::array<Scalar, /*numComponents=*/3> > molarMass_;
-};
+    template <class LhsEval>
+    LhsEval calculateFugacityCoefficient_(int regionIdx,
+                                          int phaseIdx,
+                                          int compIdx,
+                                          const LhsEval& T,
+                                          const LhsEval& p) const
+    {
+        switch (phaseIdx) {
+        case waterPhaseIdx: return fugCoefficientInWater<LhsEval>(compIdx, T, p, regionIdx);
+        case gasPhaseIdx: return fugCoefficientInGas<LhsEval>(compIdx, T, p, regionIdx);
+        case oilPhaseIdx: return fugCoefficientInOil<LhsEval>(compIdx, T, p, regionIdx);
+        }
 
-template <class Scalar, class Evaluation>
-const Scalar
-BlackOil<Scalar, Evaluation>::surfaceTemperature = 273.15 + 15.56; // [K]
+        OPM_THROW(std::logic_error, "Unhandled phase or component index");
+    }
 
-template <class Scalar, class Evaluation>
-const Scalar
-BlackOil<Scalar, Evaluation>::surfacePressure = 101325.0; // [Pa]
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> cachedProperties_(const ParameterCache& paramCache,
+                                                       int phaseIdx,
+                                                       const LhsEval& T,
+                                                       const LhsEval& p,
+                                                       const LhsEval& X) const
+    { return cachedProperties_(paramCache, phaseIdx, T, p, X, IsCacheable_<LhsEval>()); }
 
-template <class Scalar, class Evaluation>
-bool BlackOil<Scalar, Evaluation>::enableDissolvedGas_;
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> cachedProperties_(const ParameterCache& paramCache,
+                                                       int phaseIdx,
+                                                       const LhsEval& T,
+                                                       const LhsEval& p,
+                                                       const LhsEval& X,
+                                                       std::false_type) const
+    { return calculateProperties_(paramCache.regionIndex(), phaseIdx, T, p, X); }
 
-template <class Scalar, class Evaluation>
-bool BlackOil<Scalar, Evaluation>::enableVaporizedOil_;
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> cachedProperties_(const ParameterCache& paramCache,
+                                                       int phaseIdx,
+                                                       const LhsEval& T,
+                                                       const LhsEval& p,
+                                                       const LhsEval& X,
+                                                       std::true_type) const
+    {
+        typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+        // if LhsEval is Scalar, only the values of the cached quantities are compared
+        // and used
+        const bool needDerivatives = !std::is_same<LhsEval, Scalar>::value;
+
+        paramCache.checkOwner_(this);
+        auto& entry = paramCache.propertiesEntries_[phaseIdx];
+        if (!entry.isValid
+            || (needDerivatives && !entry.hasDerivatives)
+            || !(entry.temperature == T && entry.pressure == p && entry.massFraction == X))
+        {
+            const auto& props = calculateProperties_(paramCache.regionIndex(), phaseIdx, T, p, X);
+            entry.temperature = T;
+            entry.pressure = p;
+            entry.massFraction = X;
+            entry.properties.invB = props.invB;
+            entry.properties.mu = props.mu;
+            entry.properties.invBMu = props.invBMu;
+            entry.properties.density = props.density;
+            entry.isValid = true;
+            entry.hasDerivatives = needDerivatives;
+            return props;
+        }
 
-template <class Scalar, class Evaluation>
-std::shared_ptr<const OilPvtInterface<Scalar, Evaluation> >
-BlackOil<Scalar, Evaluation>::oilPvt_;
+        BlackOilPhaseProperties<LhsEval> result;
+        result.invB = Toolbox::template toLhs<LhsEval>(entry.properties.invB);
+        result.mu = Toolbox::template toLhs<LhsEval>(entry.properties.mu);
+        result.invBMu = Toolbox::template toLhs<LhsEval>(entry.properties.invBMu);
+        result.density = Toolbox::template toLhs<LhsEval>(entry.properties.density);
+        return result;
+    }
 
-template <class Scalar, class Evaluation>
-std::shared_ptr<const GasPvtInterface<Scalar, Evaluation> >
-BlackOil<Scalar, Evaluation>::gasPvt_;
+    template <class LhsEval>
+    LhsEval cachedFugacityCoefficient_(const ParameterCache& paramCache,
+                                       int phaseIdx,
+                                       int compIdx,
+                                       const LhsEval& T,
+                                       const LhsEval& p) const
+    { return cachedFugacityCoefficient_(paramCache, phaseIdx, compIdx, T, p, IsCacheable_<LhsEval>()); }
 
-template <class Scalar, class Evaluation>
-std::shared_ptr<const WaterPvtInterface<Scalar, Evaluation> >
-BlackOil<Scalar, Evaluation>::waterPvt_;
+    template <class LhsEval>
+    LhsEval cachedFugacityCoefficient_(const ParameterCache& paramCache,
+                                       int phaseIdx,
+                                       int compIdx,
+                                       const LhsEval& T,
+                                       const LhsEval& p,
+                                       std::false_type) const
+    { return calculateFugacityCoefficient_(paramCache.regionIndex(), phaseIdx, compIdx, T, p); }
 
-template <class Scalar, class Evaluation>
-std::vector<std::array<Scalar, 3> >
-BlackOil<Scalar, Evaluation>::referenceDensity_;
+    template <class LhsEval>
+    LhsEval cachedFugacityCoefficient_(const ParameterCache& paramCache,
+                                       int phaseIdx,
+                                       int compIdx,
+                                       const LhsEval& T,
+                                       const LhsEval& p,
+                                       std::true_type) const
+    {
+        typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+        const bool needDerivatives = !std::is_same<LhsEval, Scalar>::value;
+
+        paramCache.checkOwner_(this);
+        auto& entry = paramCache.fugacityEntries_[phaseIdx][compIdx];
+        if (!entry.isValid
+            || (needDerivatives && !entry.hasDerivatives)
+            || !(entry.temperature == T && entry.pressure == p))
+        {
+            const LhsEval& phi = calculateFugacityCoefficient_(paramCache.regionIndex(), phaseIdx, compIdx, T, p);
+            entry.temperature = T;
+            entry.pressure = p;
+            entry.value = phi;
+            entry.isValid = true;
+            entry.hasDerivatives = needDerivatives;
+            return phi;
+        }
 
-template <class Scalar, class Evaluation>
-std::vector<std::array<Scalar, 3> >
-BlackOil<Scalar, Evaluation>::molarMass_;
-}} // namespace Opm, FluidSystems
+        return Toolbox::template toLhs<LhsEval>(entry.value);
+    }
+
+    // the mass fraction of the gas component in the oil phase, which is always zero if
+    // the gas phase is disabled
+    template <class LhsEval, class FluidState>
+    static LhsEval oilGasMassFraction_(const FluidState& fluidState)
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        if (!gasIsActive)
+            return 0.0;
+        return FsToolbox::template toLhs<LhsEval>(fluidState.massFraction(oilPhaseIdx, gasCompIdx));
+    }
+
+    void resizeArrays_(int numRegions)
+    {
+        molarMass_.resize(numRegions);
+        referenceDensity_.resize(numRegions);
+    }
+
+    // the PVT objects are accessed via multiplexers which call the methods of the
+    // actual implementation classes directly instead of using virtual methods
+    Opm::GasPvtMultiplexer<Scalar, Evaluation> gasPvt_;
+    Opm::OilPvtMultiplexer<Scalar, Evaluation> oilPvt_;
+    Opm::WaterPvtMultiplexer<Scalar, Evaluation> waterPvt_;
+
+    bool enableDissolvedGas_;
+    bool enableVaporizedOil_;
+
+    // the reference densities and the molar masses are indexed using the canonical
+    // phase and component indices, i.e., all three phases are always stored.
+    //
+    // HACK for GCC 4.4: the array size has to be specified using the literal value '3'
+    // here, because GCC 4.4 seems to be unable to determine the number of phases from
+    // the BlackOil fluid system in the attribute declaration below...
+    std::vector<std::array<Scalar, /*numPhases=*/3> > referenceDensity_;
+    std::vector<std::array<Scalar, /*numComponents=*/3> > molarMass_;
+};
+
+/*!
+ * \brief A fluid system which uses the black-oil parameters
+ *        to calculate termodynamically meaningful quantities.
+ *
+ * This class provides a static interface to a default BlackOilInstance object. If
+ * several differently parameterized black-oil fluid systems are required within the
+ * same process, BlackOilInstance objects can be used directly.
+ *
+ * The considered phases can be restricted at compile time using the Traits parameter,
+ * see BlackOilTraits.
+ */
+template <class Scalar, class Evaluation, class Traits>
+class BlackOil : public BaseFluidSystem<Scalar, BlackOil<Scalar, Evaluation, Traits> >
+{
+    typedef Opm::GasPvtInterface<Scalar, Evaluation> GasPvtInterface;
+    typedef Opm::OilPvtInterface<Scalar, Evaluation> OilPvtInterface;
+    typedef Opm::WaterPvtInterface<Scalar, Evaluation> WaterPvtInterface;
+
+public:
+    //! The type of the objects to which the calls are forwarded
+    typedef BlackOilInstance<Scalar, Evaluation, Traits> Instance;
+
+    //! \copydoc BaseFluidSystem::ParameterCache
+    typedef typename Instance::ParameterCache ParameterCache;
+
+    /****************************************
+     * Fluid phase parameters
+     ****************************************/
+
+    //! \copydoc BlackOilInstance::waterIsActive
+    static const bool waterIsActive = Instance::waterIsActive;
+    //! \copydoc BlackOilInstance::gasIsActive
+    static const bool gasIsActive = Instance::gasIsActive;
+
+    //! \copydoc BaseFluidSystem::numPhases
+    static const int numPhases = Instance::numPhases;
+
+    //! Index of the water phase
+    static const int waterPhaseIdx = Instance::waterPhaseIdx;
+    //! Index of the oil phase
+    static const int oilPhaseIdx = Instance::oilPhaseIdx;
+    //! Index of the gas phase
+    static const int gasPhaseIdx = Instance::gasPhaseIdx;
+
+    //! The pressure at the surface
+    static const Scalar surfacePressure;
+
+    //! The temperature at the surface
+    static const Scalar surfaceTemperature;
+
+    /*!
+     * \brief Returns the object to which all calls of the static methods are forwarded.
+     */
+    static Instance& defaultInstance()
+    { return defaultInstance_; }
+
+    /*!
+     * \copydoc BaseFluidSystem::init
+     *
+     * \attention For this fluid system, this method just throws a
+     *            <tt>std::logic_error</tt> as there is no
+     *            way to generically calculate the required black oil
+     *            parameters. Instead of this method, use
+     * \code
+     * FluidSystem::initBegin();
+     * // set the black oil parameters
+     * FluidSystem::initEnd();
+     * \endcode
+     */
+    static void init()
+    {
+        OPM_THROW(std::logic_error,
+                  "There is no generic init() method for this fluid system. The "
+                  << "black-oil fluid system must be initialized using:\n"
+                  << "    FluidSystem::initBegin()\n"
+                  << "    // set black oil parameters\n"
+                  << "    FluidSystem::initEnd()\n");
+    }
+
+    //! \copydoc BlackOilInstance::initBegin
+    static void initBegin(int numPvtRegions)
+    { defaultInstance_.initBegin(numPvtRegions); }
+
+    //! \copydoc BlackOilInstance::setEnableDissolvedGas
+    static void setEnableDissolvedGas(bool yesno)
+    { defaultInstance_.setEnableDissolvedGas(yesno); }
+
+    //! \copydoc BlackOilInstance::setEnableVaporizedOil
+    static void setEnableVaporizedOil(bool yesno)
+    { defaultInstance_.setEnableVaporizedOil(yesno); }
+
+    //! \copydoc BlackOilInstance::setGasPvt
+    static void setGasPvt(std::shared_ptr<const GasPvtInterface> pvtObj)
+    { defaultInstance_.setGasPvt(pvtObj); }
+
+    //! \copydoc BlackOilInstance::setOilPvt
+    static void setOilPvt(std::shared_ptr<const OilPvtInterface> pvtObj)
+    { defaultInstance_.setOilPvt(pvtObj); }
+
+    //! \copydoc BlackOilInstance::setWaterPvt
+    static void setWaterPvt(std::shared_ptr<const WaterPvtInterface> pvtObj)
+    { defaultInstance_.setWaterPvt(pvtObj); }
+
+    //! \copydoc BlackOilInstance::setReferenceDensities
+    static void setReferenceDensities(Scalar rhoOil,
+                                      Scalar rhoWater,
+                                      Scalar rhoGas,
+                                      int regionIdx)
+    { defaultInstance_.setReferenceDensities(rhoOil, rhoWater, rhoGas, regionIdx); }
+
+    //! \copydoc BlackOilInstance::initEnd
+    static void initEnd()
+    { defaultInstance_.initEnd(); }
+
+    //! \copydoc BaseFluidSystem::phaseName
+    static const char *phaseName(const int phaseIdx)
+    { return Instance::phaseName(phaseIdx); }
+
+    //! \copydoc BaseFluidSystem::isLiquid
+    static bool isLiquid(const int phaseIdx)
+    { return Instance::isLiquid(phaseIdx); }
+
+    /****************************************
+     * Component related parameters
+     ****************************************/
+
+    //! \copydoc BaseFluidSystem::numComponents
+    static const int numComponents = Instance::numComponents;
+
+    //! Index of the oil component
+    static const int oilCompIdx = Instance::oilCompIdx;
+    //! Index of the water component
+    static const int waterCompIdx = Instance::waterCompIdx;
+    //! Index of the gas component
+    static const int gasCompIdx = Instance::gasCompIdx;
+
+    //! \copydoc BlackOilInstance::canonicalPhaseIdx
+    static int canonicalPhaseIdx(int phaseIdx)
+    { return Instance::canonicalPhaseIdx(phaseIdx); }
+
+    //! \copydoc BlackOilInstance::canonicalCompIdx
+    static int canonicalCompIdx(int compIdx)
+    { return Instance::canonicalCompIdx(compIdx); }
+
+    //! \copydoc BaseFluidSystem::componentName
+    static const char *componentName(int compIdx)
+    { return Instance::componentName(compIdx); }
+
+    //! \copydoc BaseFluidSystem::molarMass
+    static Scalar molarMass(int compIdx, int regionIdx = 0)
+    { return defaultInstance_.molarMass(compIdx, regionIdx); }
+
+    //! \copydoc BaseFluidSystem::isIdealMixture
+    static bool isIdealMixture(int phaseIdx)
+    { return Instance::isIdealMixture(phaseIdx); }
+
+    //! \copydoc BaseFluidSystem::isCompressible
+    static bool isCompressible(int phaseIdx)
+    { return Instance::isCompressible(phaseIdx); }
+
+    //! \copydoc BaseFluidSystem::isIdealGas
+    static bool isIdealGas(int phaseIdx)
+    { return Instance::isIdealGas(phaseIdx); }
+
+    /****************************************
+     * thermodynamic relations
+     ****************************************/
+    //! \copydoc BaseFluidSystem::density
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    static LhsEval density(const FluidState &fluidState,
+                           ParameterCache &paramCache,
+                           const int phaseIdx)
+    { return defaultInstance_.template density<FluidState, LhsEval>(fluidState, paramCache, phaseIdx); }
+
+    //! \copydoc BaseFluidSystem::fugacityCoefficient
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    static LhsEval fugacityCoefficient(const FluidState &fluidState,
+                                       const ParameterCache &paramCache,
+                                       int phaseIdx,
+                                       int compIdx)
+    { return defaultInstance_.template fugacityCoefficient<FluidState, LhsEval>(fluidState, paramCache, phaseIdx, compIdx); }
+
+    //! \copydoc BaseFluidSystem::viscosity
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    static LhsEval viscosity(const FluidState &fluidState,
+                             const ParameterCache &paramCache,
+                             int phaseIdx)
+    { return defaultInstance_.template viscosity<FluidState, LhsEval>(fluidState, paramCache, phaseIdx); }
+
+    //! \copydoc BlackOilInstance::enableDissolvedGas
+    static bool enableDissolvedGas()
+    { return defaultInstance_.enableDissolvedGas(); }
+
+    //! \copydoc BlackOilInstance::enableVaporizedOil
+    static bool enableVaporizedOil()
+    { return defaultInstance_.enableVaporizedOil(); }
+
+    //! \copydoc BlackOilInstance::densityDependencies
+    static unsigned densityDependencies(int phaseIdx)
+    { return defaultInstance_.densityDependencies(phaseIdx); }
+
+    //! \copydoc BlackOilInstance::viscosityDependencies
+    static unsigned viscosityDependencies(int phaseIdx)
+    { return defaultInstance_.viscosityDependencies(phaseIdx); }
+
+    //! \copydoc BlackOilInstance::fugacityCoefficientDependencies
+    static unsigned fugacityCoefficientDependencies(int phaseIdx, int compIdx)
+    { return Instance::fugacityCoefficientDependencies(phaseIdx, compIdx); }
+
+    //! \copydoc BlackOilInstance::referenceDensity
+    static Scalar referenceDensity(int phaseIdx, int regionIdx)
+    { return defaultInstance_.referenceDensity(phaseIdx, regionIdx); }
+
+    //! \copydoc BlackOilInstance::saturatedOilFormationVolumeFactor
+    template <class LhsEval>
+    static LhsEval saturatedOilFormationVolumeFactor(const LhsEval& temperature,
+                                                     const LhsEval& pressure,
+                                                     int regionIdx)
+    { return defaultInstance_.saturatedOilFormationVolumeFactor(temperature, pressure, regionIdx); }
+
+    //! \copydoc BlackOilInstance::waterFormationVolumeFactor
+    template <class LhsEval>
+    static LhsEval waterFormationVolumeFactor(const LhsEval& temperature,
+                                              const LhsEval& pressure,
+                                              int regionIdx)
+    { return defaultInstance_.waterFormationVolumeFactor(temperature, pressure, regionIdx); }
+
+    //! \copydoc BlackOilInstance::gasDissolutionFactor
+    template <class LhsEval>
+    static LhsEval gasDissolutionFactor(const LhsEval& temperature,
+                                        const LhsEval& pressure,
+                                        int regionIdx)
+    { return defaultInstance_.gasDissolutionFactor(temperature, pressure, regionIdx); }
+
+    //! \copydoc BlackOilInstance::oilVaporizationFactor
+    template <class LhsEval>
+    static LhsEval oilVaporizationFactor(const LhsEval& temperature,
+                                         const LhsEval& pressure,
+                                         int regionIdx)
+    { return defaultInstance_.oilVaporizationFactor(temperature, pressure, regionIdx); }
+
+    //! \copydoc BlackOilInstance::fugCoefficientInWater
+    template <class LhsEval>
+    static LhsEval fugCoefficientInWater(int compIdx,
+                                         const LhsEval& temperature,
+                                         const LhsEval& pressure,
+                                         int regionIdx)
+    { return defaultInstance_.fugCoefficientInWater(compIdx, temperature, pressure, regionIdx); }
+
+    //! \copydoc BlackOilInstance::fugCoefficientInGas
+    template <class LhsEval>
+    static LhsEval fugCoefficientInGas(int compIdx,
+                                       const LhsEval& temperature,
+                                       const LhsEval& pressure,
+                                       int regionIdx)
+    { return defaultInstance_.fugCoefficientInGas(compIdx, temperature, pressure, regionIdx); }
+
+    //! \copydoc BlackOilInstance::fugCoefficientInOil
+    template <class LhsEval>
+    static LhsEval fugCoefficientInOil(int compIdx,
+                                       const LhsEval& temperature,
+                                       const LhsEval& pressure,
+                                       int regionIdx)
+    { return defaultInstance_.fugCoefficientInOil(compIdx, temperature, pressure, regionIdx); }
+
+    //! \copydoc BlackOilInstance::oilSaturationPressure
+    template <class LhsEval>
+    static LhsEval oilSaturationPressure(const LhsEval& temperature,
+                                         const LhsEval& XoG,
+                                         int regionIdx)
+    { return defaultInstance_.oilSaturationPressure(temperature, XoG, regionIdx); }
+
+    //! \copydoc BlackOilInstance::saturatedOilGasMassFraction
+    template <class LhsEval>
+    static LhsEval saturatedOilGasMassFraction(const LhsEval& temperature,
+                                               const LhsEval& pressure,
+                                               int regionIdx)
+    { return defaultInstance_.saturatedOilGasMassFraction(temperature, pressure, regionIdx); }
+
+    //! \copydoc BlackOilInstance::saturatedOilGasMoleFraction
+    template <class LhsEval>
+    static LhsEval saturatedOilGasMoleFraction(const LhsEval& temperature,
+                                               const LhsEval& pressure,
+                                               int regionIdx)
+    { return defaultInstance_.saturatedOilGasMoleFraction(temperature, pressure, regionIdx); }
+
+    //! \copydoc BlackOilInstance::saturatedGasOilMassFraction
+    template <class LhsEval>
+    static LhsEval saturatedGasOilMassFraction(const LhsEval& temperature,
+                                               const LhsEval& pressure,
+                                               int regionIdx)
+    { return defaultInstance_.saturatedGasOilMassFraction(temperature, pressure, regionIdx); }
+
+    //! \copydoc BlackOilInstance::saturatedGasOilMoleFraction
+    template <class LhsEval>
+    static LhsEval saturatedGasOilMoleFraction(const LhsEval& temperature,
+                                               const LhsEval& pressure,
+                                               int regionIdx)
+    { return defaultInstance_.saturatedGasOilMoleFraction(temperature, pressure, regionIdx); }
+
+    //! \copydoc BlackOilInstance::oilFormationVolumeFactor
+    template <class LhsEval>
+    static LhsEval oilFormationVolumeFactor(const LhsEval& temperature,
+                                            const LhsEval& pressure,
+                                            const LhsEval& XoG,
+                                            int regionIdx)
+    { return defaultInstance_.oilFormationVolumeFactor(temperature, pressure, XoG, regionIdx); }
+
+    //! \copydoc BlackOilInstance::oilDensity
+    template <class LhsEval>
+    static LhsEval oilDensity(const LhsEval& temperature,
+                              const LhsEval& pressure,
+                              const LhsEval& XoG,
+                              int regionIdx)
+    { return defaultInstance_.oilDensity(temperature, pressure, XoG, regionIdx); }
+
+    //! \copydoc BlackOilInstance::saturatedOilDensity
+    template <class LhsEval>
+    static LhsEval saturatedOilDensity(const LhsEval& temperature,
+                                       const LhsEval& pressure,
+                                       int regionIdx)
+    { return defaultInstance_.saturatedOilDensity(temperature, pressure, regionIdx); }
+
+    //! \copydoc BlackOilInstance::gasFormationVolumeFactor
+    template <class LhsEval>
+    static LhsEval gasFormationVolumeFactor(const LhsEval& temperature,
+                                            const LhsEval& pressure,
+                                            const LhsEval& XgO,
+                                            int regionIdx)
+    { return defaultInstance_.gasFormationVolumeFactor(temperature, pressure, XgO, regionIdx); }
+
+    //! \copydoc BlackOilInstance::gasDensity
+    template <class LhsEval>
+    static LhsEval gasDensity(const LhsEval& temperature,
+                              const LhsEval& pressure,
+                              const LhsEval& XgO,
+                              int regionIdx)
+    { return defaultInstance_.gasDensity(temperature, pressure, XgO, regionIdx); }
+
+    //! \copydoc BlackOilInstance::waterDensity
+    template <class LhsEval>
+    static LhsEval waterDensity(const LhsEval& temperature,
+                                const LhsEval& pressure,
+                                int regionIdx)
+    { return defaultInstance_.waterDensity(temperature, pressure, regionIdx); }
+
+    //! \copydoc BlackOilInstance::oilProperties
+    template <class LhsEval>
+    static BlackOilPhaseProperties<LhsEval> oilProperties(const LhsEval& temperature,
+                                                          const LhsEval& pressure,
+                                                          const LhsEval& XoG,
+                                                          int regionIdx)
+    { return defaultInstance_.oilProperties(temperature, pressure, XoG, regionIdx); }
+
+    //! \copydoc BlackOilInstance::gasProperties
+    template <class LhsEval>
+    static BlackOilPhaseProperties<LhsEval> gasProperties(const LhsEval& temperature,
+                                                          const LhsEval& pressure,
+                                                          const LhsEval& XgO,
+                                                          int regionIdx)
+    { return defaultInstance_.gasProperties(temperature, pressure, XgO, regionIdx); }
+
+    //! \copydoc BlackOilInstance::waterProperties
+    template <class LhsEval>
+    static BlackOilPhaseProperties<LhsEval> waterProperties(const LhsEval& temperature,
+                                                            const LhsEval& pressure,
+                                                            int regionIdx)
+    { return defaultInstance_.waterProperties(temperature, pressure, regionIdx); }
+
+private:
+    static Instance defaultInstance_;
+};
+
+template <class Scalar, class Evaluation, class Traits>
+const Scalar
+BlackOil<Scalar, Evaluation, Traits>::surfaceTemperature = 273.15 + 15.56; // [K]
+
+template <class Scalar, class Evaluation, class Traits>
+const Scalar
+BlackOil<Scalar, Evaluation, Traits>::surfacePressure = 101325.0; // [Pa]
+
+template <class Scalar, class Evaluation, class Traits>
+BlackOilInstance<Scalar, Evaluation, Traits>
+BlackOil<Scalar, Evaluation, Traits>::defaultInstance_;
+}} // namespace Opm, FluidSystems
+
+// the instantiations which are provided by the library, cf. ExplicitInstantiations.hpp
+#define OPM_BLACK_OIL_FLUID_SYSTEM_INSTANTIATIONS(KEYWORD, Evaluation) \
+    KEYWORD class Opm::FluidSystems::BlackOilInstance<double, Evaluation>; \
+    KEYWORD class Opm::FluidSystems::BlackOil<double, Evaluation>;
+
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+#include <opm/material/common/ExplicitInstantiations.hpp>
+
+OPM_MATERIAL_FOR_EACH_EVALUATION(OPM_BLACK_OIL_FLUID_SYSTEM_INSTANTIATIONS, extern template)
+#endif
 
 #endif
@@ -0,0 +1,418 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::BlackOilPropertyCache
+ */
+#ifndef OPM_BLACK_OIL_PROPERTY_CACHE_HPP
+#define OPM_BLACK_OIL_PROPERTY_CACHE_HPP
+
+#include <opm/material/fluidsystems/blackoilpvt/BlackOilPhaseProperties.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/Exceptions.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Approximates the densities and the viscosities of the black-oil phases of
+ *        many cells by first-order Taylor expansions around previously computed
+ *        values.
+ *
+ * For each cell and phase, the pressure and the mass fraction of the dissolved
+ * component of the last exact evaluation are stored together with the density, the
+ * viscosity and their derivatives with respect to these two quantities. If the
+ * pressure and the mass fraction of the next call deviate by no more than the
+ * respective tolerance from the stored ones, the density and the viscosity are
+ * extrapolated linearly instead of evaluating the PVT tables. Otherwise, they are
+ * evaluated and become the new expansion point. The expansion point is not moved by
+ * the approximated calls, so the errors do not accumulate. Since the black-oil model
+ * is isothermal, the temperature and the PVT region must match exactly.
+ *
+ * The derivatives at the expansion point are computed using the evaluation type of
+ * the fluid system, whose first two derivatives are used for the pressure and the mass
+ * fraction. If the fluid system is only usable for scalars, they are approximated by
+ * forward differences. If the quantities of the fluid state are function evaluations,
+ * the derivatives of the results follow from the ones of the inputs by the chain rule.
+ *
+ * The PVT tables are piecewise linear, so tabulated quantities like the densities are
+ * approximated exactly as long as no sampling point of a table is crossed, while the
+ * error of quantities which are computed from several tables, e.g., the viscosities,
+ * is of second order. Since the sampling points are not visible through the interface
+ * of the fluid system, crossing them is not detected; the deviation is instead bounded
+ * by the change of the slope at the sampling point times the tolerance. With the
+ * default tolerances of zero, the stored results are only reused for exactly the same
+ * inputs.
+ *
+ * A cached evaluation of a cell must not be done by several threads at the same time,
+ * but different cells may be evaluated concurrently.
+ *
+ * \tparam Scalar The floating point type
+ * \tparam FluidSystem The black-oil fluid system, e.g., FluidSystems::BlackOilInstance or
+ *                     FluidSystems::BlackOil
+ * \tparam Evaluation The evaluation type for which the PVT objects of the fluid system
+ *                    can be used besides Scalar
+ */
+template <class Scalar, class FluidSystem, class Evaluation = Scalar>
+class BlackOilPropertyCache
+{
+    enum { waterPhaseIdx = FluidSystem::waterPhaseIdx };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+    enum { oilCompIdx = FluidSystem::oilCompIdx };
+    enum { gasCompIdx = FluidSystem::gasCompIdx };
+
+    // the variables of the Taylor expansions
+    enum { pressureIdx = 0, massFractionIdx = 1, numVars = 2 };
+
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+
+    // the expansion point of a phase in a cell
+    struct Entry_
+    {
+        Entry_()
+            : regionIdx(-1)
+        {}
+
+        int regionIdx;
+        Scalar temperature;
+        Scalar x[numVars];
+        Scalar density;
+        Scalar densityDerivatives[numVars];
+        Scalar viscosity;
+        Scalar viscosityDerivatives[numVars];
+    };
+
+public:
+    enum { numPhases = FluidSystem::numPhases };
+
+    BlackOilPropertyCache()
+        : pressureTolerance_(0.0)
+        , massFractionTolerance_(0.0)
+    {}
+
+    /*!
+     * \brief Specify the number of cells and discard all stored results.
+     */
+    void resize(unsigned numCells)
+    {
+        entries_.clear();
+        entries_.resize(numCells*numPhases);
+    }
+
+    /*!
+     * \brief Returns the number of cells.
+     */
+    unsigned size() const
+    { return entries_.size()/numPhases; }
+
+    /*!
+     * \brief Discard the stored results of all cells.
+     *
+     * This must be called if the PVT properties of the fluid system are changed.
+     */
+    void invalidate()
+    {
+        for (auto& entry : entries_)
+            entry.regionIdx = -1;
+    }
+
+    /*!
+     * \brief Discard the stored results of a single cell.
+     */
+    void invalidate(unsigned cellIdx)
+    {
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            entry_(cellIdx, phaseIdx).regionIdx = -1;
+    }
+
+    /*!
+     * \brief Specify the maximum deviations from the expansion point for which the
+     *        densities and viscosities are approximated.
+     *
+     * \param pressure The maximum deviation of the pressure [Pa]
+     * \param massFraction The maximum deviation of the mass fraction of the dissolved
+     *                     component, i.e., of the gas component in the oil phase and of
+     *                     the oil component in the gas phase
+     */
+    void setTolerances(Scalar pressure, Scalar massFraction)
+    {
+        pressureTolerance_ = pressure;
+        massFractionTolerance_ = massFraction;
+    }
+
+    /*!
+     * \brief Returns the maximum deviation of the pressure for which the quantities
+     *        are approximated [Pa].
+     */
+    Scalar pressureTolerance() const
+    { return pressureTolerance_; }
+
+    /*!
+     * \brief Returns the maximum deviation of the mass fraction of the dissolved
+     *        component for which the quantities are approximated.
+     */
+    Scalar massFractionTolerance() const
+    { return massFractionTolerance_; }
+
+    /*!
+     * \brief Returns true iff the next call for a phase of a cell would use the stored
+     *        expansion point.
+     */
+    template <class FluidState>
+    bool canReuse(const FluidState& fluidState,
+                  const ParameterCache& paramCache,
+                  int phaseIdx,
+                  unsigned cellIdx) const
+    {
+        Scalar T;
+        Scalar x[numVars];
+        inputs_(T, x, fluidState, phaseIdx);
+        return isWithinTolerances_(entry_(cellIdx, phaseIdx), T, x, paramCache.regionIndex());
+    }
+
+    /*!
+     * \brief The density of a fluid phase in a cell [kg/m^3]
+     *
+     * This corresponds to FluidSystem::density().
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval density(const FluidSystem& fluidSystem,
+                    const FluidState& fluidState,
+                    const ParameterCache& paramCache,
+                    int phaseIdx,
+                    unsigned cellIdx) const
+    {
+        const Entry_& entry = updatedEntry_(fluidSystem, fluidState, paramCache, phaseIdx, cellIdx);
+        return extrapolate_<LhsEval>(fluidState, phaseIdx, entry, entry.density, entry.densityDerivatives);
+    }
+
+    /*!
+     * \brief The dynamic viscosity of a fluid phase in a cell [Pa s]
+     *
+     * This corresponds to FluidSystem::viscosity().
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval viscosity(const FluidSystem& fluidSystem,
+                      const FluidState& fluidState,
+                      const ParameterCache& paramCache,
+                      int phaseIdx,
+                      unsigned cellIdx) const
+    {
+        const Entry_& entry = updatedEntry_(fluidSystem, fluidState, paramCache, phaseIdx, cellIdx);
+        return extrapolate_<LhsEval>(fluidState, phaseIdx, entry, entry.viscosity, entry.viscosityDerivatives);
+    }
+
+private:
+    Entry_& entry_(unsigned cellIdx, int phaseIdx) const
+    {
+        assert(cellIdx < size());
+        return entries_[cellIdx*numPhases + phaseIdx];
+    }
+
+    // the mass fraction of the dissolved component, which is zero for water and if the
+    // gas phase is disabled
+    template <class LhsEval, class FluidState>
+    static LhsEval massFraction_(const FluidState& fluidState, int phaseIdx)
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        if (gasPhaseIdx < 0 || phaseIdx == waterPhaseIdx)
+            return 0.0;
+        else if (phaseIdx == oilPhaseIdx)
+            return FsToolbox::template toLhs<LhsEval>(fluidState.massFraction(oilPhaseIdx, gasCompIdx));
+        return FsToolbox::template toLhs<LhsEval>(fluidState.massFraction(gasPhaseIdx, oilCompIdx));
+    }
+
+    template <class FluidState>
+    static void inputs_(Scalar& T, Scalar* x, const FluidState& fluidState, int phaseIdx)
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        T = FsToolbox::value(fluidState.temperature(phaseIdx));
+        x[pressureIdx] = FsToolbox::value(fluidState.pressure(phaseIdx));
+        x[massFractionIdx] = massFraction_<Scalar>(fluidState, phaseIdx);
+    }
+
+    bool isWithinTolerances_(const Entry_& entry, Scalar T, const Scalar* x, int regionIdx) const
+    {
+        return
+            entry.regionIdx >= 0
+            && entry.regionIdx == regionIdx
+            && entry.temperature == T
+            && std::abs(x[pressureIdx] - entry.x[pressureIdx]) <= pressureTolerance_
+            && std::abs(x[massFractionIdx] - entry.x[massFractionIdx]) <= massFractionTolerance_;
+    }
+
+    template <class LhsEval>
+    static Opm::BlackOilPhaseProperties<LhsEval> properties_(const FluidSystem& fluidSystem,
+                                                             int phaseIdx,
+                                                             const LhsEval& T,
+                                                             const LhsEval* x,
+                                                             int regionIdx)
+    {
+        if (phaseIdx == waterPhaseIdx)
+            return fluidSystem.waterProperties(T, x[pressureIdx], regionIdx);
+        else if (phaseIdx == oilPhaseIdx)
+            return fluidSystem.oilProperties(T, x[pressureIdx], x[massFractionIdx], regionIdx);
+        else if (phaseIdx == gasPhaseIdx)
+            return fluidSystem.gasProperties(T, x[pressureIdx], x[massFractionIdx], regionIdx);
+
+        OPM_THROW(std::logic_error, "Unhandled phase index " << phaseIdx);
+    }
+
+    // compute the quantities and their derivatives at the expansion point using
+    // function evaluations
+    static void updateExpansionPoint_(Entry_& entry,
+                                      const FluidSystem& fluidSystem,
+                                      int phaseIdx,
+                                      const Scalar* x,
+                                      int regionIdx,
+                                      std::false_type /*isScalar*/)
+    {
+        typedef Opm::MathToolbox<Evaluation> Toolbox;
+        static_assert(static_cast<int>(Evaluation::size) >= static_cast<int>(numVars),
+                      "The evaluation type of the fluid system must provide at least two derivatives");
+
+        Evaluation T = Toolbox::createConstant(entry.temperature);
+        Evaluation xEval[numVars];
+        for (int varIdx = 0; varIdx < numVars; ++varIdx)
+            xEval[varIdx] = Toolbox::createVariable(x[varIdx], varIdx);
+
+        const auto& props = properties_(fluidSystem, phaseIdx, T, xEval, regionIdx);
+        entry.density = props.density.value;
+        entry.viscosity = props.mu.value;
+        for (int varIdx = 0; varIdx < numVars; ++varIdx) {
+            entry.densityDerivatives[varIdx] = props.density.derivatives[varIdx];
+            entry.viscosityDerivatives[varIdx] = props.mu.derivatives[varIdx];
+        }
+    }
+
+    // compute the quantities at the expansion point using scalars and their
+    // derivatives by forward differences
+    static void updateExpansionPoint_(Entry_& entry,
+                                      const FluidSystem& fluidSystem,
+                                      int phaseIdx,
+                                      const Scalar* x,
+                                      int regionIdx,
+                                      std::true_type /*isScalar*/)
+    {
+        Scalar T = entry.temperature;
+        const auto& props = properties_(fluidSystem, phaseIdx, T, x, regionIdx);
+        entry.density = props.density;
+        entry.viscosity = props.mu;
+
+        // the step sizes are chosen to balance the truncation and the round-off errors
+        static const Scalar relStep = std::sqrt(std::numeric_limits<Scalar>::epsilon());
+        for (int varIdx = 0; varIdx < numVars; ++varIdx) {
+            entry.densityDerivatives[varIdx] = 0.0;
+            entry.viscosityDerivatives[varIdx] = 0.0;
+            if (varIdx == massFractionIdx && !dependsOnMassFraction_(fluidSystem, phaseIdx))
+                continue;
+
+            Scalar xPlus[numVars] = { x[0], x[1] };
+            Scalar scale = (varIdx == pressureIdx) ? std::max<Scalar>(std::abs(x[varIdx]), 1e5) : 1.0;
+            xPlus[varIdx] += relStep*scale;
+            Scalar h = xPlus[varIdx] - x[varIdx];
+
+            const auto& propsPlus = properties_(fluidSystem, phaseIdx, T, xPlus, regionIdx);
+            entry.densityDerivatives[varIdx] = (propsPlus.density - props.density)/h;
+            entry.viscosityDerivatives[varIdx] = (propsPlus.mu - props.mu)/h;
+        }
+    }
+
+    // returns true iff a quantity of a phase may depend on the mass fraction of the
+    // dissolved component
+    static bool dependsOnMassFraction_(const FluidSystem& fluidSystem, int phaseIdx)
+    {
+        if (phaseIdx == oilPhaseIdx)
+            return gasPhaseIdx >= 0 && fluidSystem.enableDissolvedGas();
+        else if (phaseIdx == gasPhaseIdx)
+            return fluidSystem.enableVaporizedOil();
+        return false;
+    }
+
+    // returns the expansion point of a phase in a cell after making sure that it can
+    // be used for the quantities of a fluid state
+    template <class FluidState>
+    const Entry_& updatedEntry_(const FluidSystem& fluidSystem,
+                                const FluidState& fluidState,
+                                const ParameterCache& paramCache,
+                                int phaseIdx,
+                                unsigned cellIdx) const
+    {
+        assert(0 <= phaseIdx && phaseIdx < numPhases);
+
+        int regionIdx = paramCache.regionIndex();
+        Scalar T;
+        Scalar x[numVars];
+        inputs_(T, x, fluidState, phaseIdx);
+
+        Entry_& entry = entry_(cellIdx, phaseIdx);
+        if (isWithinTolerances_(entry, T, x, regionIdx))
+            return entry;
+
+        entry.regionIdx = regionIdx;
+        entry.temperature = T;
+        for (int varIdx = 0; varIdx < numVars; ++varIdx)
+            entry.x[varIdx] = x[varIdx];
+        updateExpansionPoint_(entry, fluidSystem, phaseIdx, x, regionIdx,
+                              std::is_same<Evaluation, Scalar>());
+
+        return entry;
+    }
+
+    template <class LhsEval, class FluidState>
+    static LhsEval extrapolate_(const FluidState& fluidState,
+                                int phaseIdx,
+                                const Entry_& entry,
+                                Scalar value,
+                                const Scalar* derivatives)
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+        typedef Opm::MathToolbox<LhsEval> LhsToolbox;
+
+        LhsEval result = LhsToolbox::createConstant(value);
+        if (derivatives[pressureIdx] != 0.0)
+            result +=
+                derivatives[pressureIdx]
+                *(FsToolbox::template toLhs<LhsEval>(fluidState.pressure(phaseIdx)) - entry.x[pressureIdx]);
+        if (derivatives[massFractionIdx] != 0.0)
+            result +=
+                derivatives[massFractionIdx]
+                *(massFraction_<LhsEval>(fluidState, phaseIdx) - entry.x[massFractionIdx]);
+        return result;
+    }
+
+    Scalar pressureTolerance_;
+    Scalar massFractionTolerance_;
+    mutable std::vector<Entry_> entries_;
+};
+} // namespace Opm
+
+#endif
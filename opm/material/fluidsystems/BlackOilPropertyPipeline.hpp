@@ -0,0 +1,592 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::BlackOilPropertyPipeline
+ */
+#ifndef OPM_BLACK_OIL_PROPERTY_PIPELINE_HPP
+#define OPM_BLACK_OIL_PROPERTY_PIPELINE_HPP
+
+#include <opm/material/fluidsystems/BlackOilCellClassifier.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/BlackOilPhaseProperties.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <exception>
+
+namespace Opm {
+/*!
+ * \brief Computes the saturation functions, the PVT properties and the mobilities of
+ *        all phases for many cells, tile by tile.
+ *
+ * Instead of computing all quantities for one cell after the other, the cells are
+ * split into tiles of contiguous cells. For each tile, the saturation functions are
+ * evaluated first, then the PVT properties of the oil, the water and the gas phases
+ * (one phase after the other) and finally the mobilities. Each stage is a tight loop
+ * over the cells of the tile, so only the tables of a single subsystem need to be in
+ * the cache at a time, and the intermediate results of a tile are still cached when
+ * the next stage uses them. If OpenMP is enabled, the tiles are processed concurrently.
+ *
+ * The saturation functions are evaluated first because the pressures of the water and
+ * the gas phases are determined by the oil pressure and the capillary pressures.
+ *
+ * If the cells are grouped by a BlackOilCellClassifier, the PVT stage can alternatively
+ * be driven class by class, using a kernel that is compiled for the phases which are
+ * present in the cells of the class.
+ *
+ * \tparam Scalar The floating point type
+ * \tparam FluidSystem The black-oil fluid system, e.g., FluidSystems::BlackOilInstance or
+ *                     FluidSystems::BlackOil
+ * \tparam SaturationFunctions The class which provides the saturation functions,
+ *                             usually EclMaterialLawManager. It must provide the
+ *                             variant of saturationFunctionsBatch() for a range of
+ *                             elements and, if the mobilities are computed with their
+ *                             derivatives, saturationFunctionsWithDerivatives().
+ */
+template <class Scalar, class FluidSystem, class SaturationFunctions>
+class BlackOilPropertyPipeline
+{
+    enum { waterPhaseIdx = FluidSystem::waterPhaseIdx };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+public:
+    enum { numPhases = FluidSystem::numPhases };
+    static_assert(numPhases == 3,
+                  "The property pipeline requires a fluid system with all three phases");
+
+    //! The default number of cells of a tile
+    enum { defaultTileSize = 256 };
+
+    /*!
+     * \brief The input arrays of the pipeline, indexed by the cell index.
+     */
+    struct Inputs
+    {
+        //! The temperatures [K]
+        const Scalar* temperature;
+        //! The pressures of the oil phase [Pa]
+        const Scalar* oilPressure;
+        //! The saturations of the water phase
+        const Scalar* waterSaturation;
+        //! The saturations of the gas phase. The oil saturation is 1 - Sw - Sg.
+        const Scalar* gasSaturation;
+        //! The mass fractions of the gas component in the oil phase
+        const Scalar* oilGasMassFraction;
+        //! The mass fractions of the oil component in the gas phase
+        const Scalar* gasOilMassFraction;
+        //! The PVT region indices. If this is null, all cells use region 0.
+        const int* pvtRegionIndex;
+        //! The phases which are present in the cells. Phase phaseIdx is present if bit
+        //! (1 << phaseIdx) is set. If this is null, all phases are present in all cells.
+        const unsigned char* phasePresence;
+    };
+
+    /*!
+     * \brief The output arrays of the pipeline, indexed by the cell index.
+     *
+     * The arrays of the phase quantities are indexed by the phase indices of the
+     * fluid system. The PVT properties of a phase which is not present are
+     * BlackOilPhaseProperties::absentPhase() and its mobility is zero. The saturation
+     * functions are evaluated for all phases.
+     */
+    struct Outputs
+    {
+        //! The PVT properties of the phases
+        BlackOilPhaseProperties<Scalar>* phaseProperties[numPhases];
+        //! The relative permeabilities of the phases
+        Scalar* relativePermeability[numPhases];
+        //! The mobilities \f$k_r/\mu\f$ of the phases [1/(Pa s)]
+        Scalar* mobility[numPhases];
+        //! The oil-water capillary pressures \f$p_o - p_w\f$ [Pa]
+        Scalar* pcow;
+        //! The gas-oil capillary pressures \f$p_g - p_o\f$ [Pa]
+        Scalar* pcgo;
+    };
+
+    //! The tag of the evaluations which are returned by runMobilities()
+    class MobilityVariables;
+
+    /*!
+     * \brief The indices of the variables of the evaluations which are returned by
+     *        runMobilities().
+     *
+     * The oil saturation is 1 - Sw - Sg and the pressures of the water and the gas
+     * phases are determined by the oil pressure and the capillary pressures, so the
+     * derivatives with respect to the saturations include the ones of the capillary
+     * pressures. The dissolution variable is the mass fraction of the gas component in
+     * the oil phase for oil and the one of the oil component in the gas phase for gas.
+     */
+    enum {
+        waterSaturationVarIdx = 0,
+        gasSaturationVarIdx = 1,
+        oilPressureVarIdx = 2,
+        dissolutionVarIdx = 3,
+        numMobilityVars = 4
+    };
+
+    //! The evaluation type of the mobilities which are returned by runMobilities()
+    typedef Opm::LocalAd::Evaluation<Scalar, MobilityVariables, numMobilityVars> MobilityEvaluation;
+
+    /*!
+     * \brief The output arrays of runMobilities(), indexed by the cell index.
+     *
+     * The arrays are indexed by the phase indices of the fluid system. If an array is
+     * null, the respective quantity is not stored. The quantities of a phase which is
+     * not present are zero.
+     */
+    struct MobilityOutputs
+    {
+        //! The mobilities \f$\lambda = k_r/\mu\f$ of the phases [1/(Pa s)]
+        MobilityEvaluation* mobility[numPhases];
+        //! The products \f$b \lambda = k_r b/\mu\f$ of the inverse formation volume
+        //! factors and the mobilities of the phases [1/(Pa s)]
+        MobilityEvaluation* invBMobility[numPhases];
+    };
+
+    BlackOilPropertyPipeline(const FluidSystem& fluidSystem,
+                             const SaturationFunctions& saturationFunctions)
+        : fluidSystem_(fluidSystem)
+        , saturationFunctions_(saturationFunctions)
+        , tileSize_(defaultTileSize)
+    {}
+
+    /*!
+     * \brief Specify the number of cells of a tile.
+     *
+     * The intermediate results of a tile should fit into the L1 or L2 cache. The
+     * default is defaultTileSize.
+     */
+    void setTileSize(unsigned numCells)
+    {
+        assert(numCells > 0);
+        tileSize_ = numCells;
+    }
+
+    /*!
+     * \brief Returns the number of cells of a tile.
+     */
+    unsigned tileSize() const
+    { return tileSize_; }
+
+    /*!
+     * \brief Compute all quantities for the cells [0, numCells).
+     */
+    void run(unsigned numCells, const Inputs& inputs, const Outputs& outputs) const
+    {
+        unsigned numTiles = (numCells + tileSize_ - 1)/tileSize_;
+        forEachTile_(numTiles, [&](unsigned tileIdx) {
+            runTile_(tileIdx, numCells, inputs, outputs);
+        });
+    }
+
+    /*!
+     * \brief Compute all quantities for the cells [beginCellIdx, endCellIdx).
+     *
+     * The cells are processed by the calling thread in a single tile, irrespective of
+     * the tile size.
+     */
+    void runTile(unsigned beginCellIdx,
+                 unsigned endCellIdx,
+                 const Inputs& inputs,
+                 const Outputs& outputs) const
+    {
+        // stage 1: the saturation functions
+        saturationFunctions_.saturationFunctionsBatch(SaturationFunctions::AllSaturationFunctions,
+                                                      beginCellIdx,
+                                                      endCellIdx,
+                                                      inputs.waterSaturation,
+                                                      inputs.gasSaturation,
+                                                      outputs.relativePermeability[waterPhaseIdx],
+                                                      outputs.relativePermeability[oilPhaseIdx],
+                                                      outputs.relativePermeability[gasPhaseIdx],
+                                                      outputs.pcow,
+                                                      outputs.pcgo);
+
+        // stage 2: the PVT properties, one phase after the other. the PVT relations of
+        // absent phases are not evaluated.
+        pvtStage_<oilPhaseIdx>(beginCellIdx, endCellIdx, inputs, outputs);
+        pvtStage_<waterPhaseIdx>(beginCellIdx, endCellIdx, inputs, outputs);
+        pvtStage_<gasPhaseIdx>(beginCellIdx, endCellIdx, inputs, outputs);
+
+        // stage 3: the derived quantities
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            const auto* props = outputs.phaseProperties[phaseIdx];
+            const Scalar* kr = outputs.relativePermeability[phaseIdx];
+            Scalar* mobility = outputs.mobility[phaseIdx];
+            for (unsigned cellIdx = beginCellIdx; cellIdx < endCellIdx; ++cellIdx)
+                mobility[cellIdx] =
+                    isPresent_(inputs, cellIdx, phaseIdx) ? kr[cellIdx]/props[cellIdx].mu : 0.0;
+        }
+    }
+
+    /*!
+     * \brief Compute all quantities for the cells [0, numCells) using a kernel for each
+     *        class of cells.
+     *
+     * The saturation functions are evaluated tile by tile as for run(). The PVT
+     * properties and the mobilities of the cells of a class are then computed by a
+     * kernel which is specialized for the phases that are present in the class, so the
+     * cells do not need to check the phase presence individually. The phase presence is
+     * taken from the classifier and Inputs::phasePresence is ignored.
+     *
+     * \param classifier The classes of the cells. Its size must be numCells.
+     */
+    void run(unsigned numCells,
+             const BlackOilCellClassifier& classifier,
+             const Inputs& inputs,
+             const Outputs& outputs) const
+    {
+        assert(classifier.size() == numCells);
+
+        // stage 1: the saturation functions
+        unsigned numTiles = (numCells + tileSize_ - 1)/tileSize_;
+        forEachTile_(numTiles, [&](unsigned tileIdx) {
+            unsigned beginCellIdx = tileIdx*tileSize_;
+            unsigned endCellIdx = std::min(beginCellIdx + tileSize_, numCells);
+            saturationFunctions_.saturationFunctionsBatch(SaturationFunctions::AllSaturationFunctions,
+                                                          beginCellIdx,
+                                                          endCellIdx,
+                                                          inputs.waterSaturation,
+                                                          inputs.gasSaturation,
+                                                          outputs.relativePermeability[waterPhaseIdx],
+                                                          outputs.relativePermeability[oilPhaseIdx],
+                                                          outputs.relativePermeability[gasPhaseIdx],
+                                                          outputs.pcow,
+                                                          outputs.pcgo);
+        });
+
+        // stages 2 and 3: the kernels of the cell classes. whether the hysteresis is
+        // active does not matter here, so both classes of a phase presence are
+        // processed by the same kernel.
+        for (unsigned classIdx = 0; classIdx < BlackOilCellClassifier::numClasses; ++classIdx) {
+            const auto& cells = classifier.cellsOfClass(classIdx);
+            if (cells.empty())
+                continue;
+
+            unsigned numChunks = (cells.size() + tileSize_ - 1)/tileSize_;
+            forEachTile_(numChunks, [&](unsigned chunkIdx) {
+                size_t begin = chunkIdx*tileSize_;
+                size_t n = std::min<size_t>(tileSize_, cells.size() - begin);
+                runClassKernel_(BlackOilCellClassifier::phasePresence(classIdx),
+                                cells.data() + begin, n, inputs, outputs);
+            });
+        }
+    }
+
+    /*!
+     * \brief Compute the mobilities of all phases and their derivatives for the cells
+     *        [0, numCells).
+     *
+     * For each cell, the relative permeabilities and the capillary pressures are
+     * evaluated together with their derivatives with respect to the saturations and
+     * combined with the \f$b/\mu\f$ and \f$\mu\f$ values of the PVT relations,
+     * which are evaluated with derivatives with respect to the phase pressure and the
+     * dissolved mass fraction only. Thus, no evaluation with the derivatives of all
+     * variables is created for the individual quantities. The Inputs are the same as
+     * for run(), and the cells are processed tile by tile.
+     */
+    void runMobilities(unsigned numCells,
+                       const Inputs& inputs,
+                       const MobilityOutputs& outputs) const
+    {
+        unsigned numTiles = (numCells + tileSize_ - 1)/tileSize_;
+        forEachTile_(numTiles, [&](unsigned tileIdx) {
+            unsigned beginCellIdx = tileIdx*tileSize_;
+            unsigned endCellIdx = std::min(beginCellIdx + tileSize_, numCells);
+            runMobilitiesTile(beginCellIdx, endCellIdx, inputs, outputs);
+        });
+    }
+
+    /*!
+     * \brief Compute the mobilities of all phases and their derivatives for the cells
+     *        [beginCellIdx, endCellIdx).
+     *
+     * The cells are processed by the calling thread, cf. runTile().
+     */
+    void runMobilitiesTile(unsigned beginCellIdx,
+                           unsigned endCellIdx,
+                           const Inputs& inputs,
+                           const MobilityOutputs& outputs) const
+    {
+        for (unsigned cellIdx = beginCellIdx; cellIdx < endCellIdx; ++cellIdx) {
+            Scalar S[numPhases];
+            S[waterPhaseIdx] = inputs.waterSaturation[cellIdx];
+            S[gasPhaseIdx] = inputs.gasSaturation[cellIdx];
+            S[oilPhaseIdx] = 1 - S[waterPhaseIdx] - S[gasPhaseIdx];
+
+            Scalar kr[numPhases], dKr_dS[numPhases][numPhases];
+            Scalar pc[numPhases], dPc_dS[numPhases][numPhases];
+            saturationFunctions_.saturationFunctionsWithDerivatives(cellIdx, S, kr, dKr_dS, pc, dPc_dS);
+
+            mobilityStage_<oilPhaseIdx>(cellIdx, inputs, outputs, kr, dKr_dS, pc, dPc_dS);
+            mobilityStage_<waterPhaseIdx>(cellIdx, inputs, outputs, kr, dKr_dS, pc, dPc_dS);
+            mobilityStage_<gasPhaseIdx>(cellIdx, inputs, outputs, kr, dKr_dS, pc, dPc_dS);
+        }
+    }
+
+private:
+    // the evaluations of the PVT relations. they only carry the derivatives with
+    // respect to the pressure and the dissolved mass fraction of a phase.
+    class PvtVariables_;
+    enum { pvtPressureVarIdx = 0, pvtDissolutionVarIdx = 1 };
+    typedef Opm::LocalAd::Evaluation<Scalar, PvtVariables_, 2> PvtEvaluation_;
+
+    // the mobility of a phase and its product with the inverse formation volume factor
+    // for a cell, given the saturation functions and their derivatives with respect to
+    // the saturations of all phases
+    template <int phaseIdx>
+    void mobilityStage_(unsigned cellIdx,
+                        const Inputs& inputs,
+                        const MobilityOutputs& outputs,
+                        const Scalar* kr,
+                        const Scalar (*dKr_dS)[numPhases],
+                        const Scalar* pc,
+                        const Scalar (*dPc_dS)[numPhases]) const
+    {
+        MobilityEvaluation* mobility = outputs.mobility[phaseIdx];
+        MobilityEvaluation* invBMobility = outputs.invBMobility[phaseIdx];
+        if (!mobility && !invBMobility)
+            return;
+
+        if (!isPresent_(inputs, cellIdx, phaseIdx)) {
+            if (mobility)
+                mobility[cellIdx] = MobilityEvaluation::createConstant(0.0);
+            if (invBMobility)
+                invBMobility[cellIdx] = MobilityEvaluation::createConstant(0.0);
+            return;
+        }
+
+        // the derivatives of the relative permeability and of the phase pressure with
+        // respect to the water and the gas saturations. the oil saturation depends on
+        // both of them.
+        Scalar dKr_dSw = dKr_dS[phaseIdx][waterPhaseIdx] - dKr_dS[phaseIdx][oilPhaseIdx];
+        Scalar dKr_dSg = dKr_dS[phaseIdx][gasPhaseIdx] - dKr_dS[phaseIdx][oilPhaseIdx];
+        Scalar dP_dSw =
+            (dPc_dS[phaseIdx][waterPhaseIdx] - dPc_dS[phaseIdx][oilPhaseIdx])
+            - (dPc_dS[oilPhaseIdx][waterPhaseIdx] - dPc_dS[oilPhaseIdx][oilPhaseIdx]);
+        Scalar dP_dSg =
+            (dPc_dS[phaseIdx][gasPhaseIdx] - dPc_dS[phaseIdx][oilPhaseIdx])
+            - (dPc_dS[oilPhaseIdx][gasPhaseIdx] - dPc_dS[oilPhaseIdx][oilPhaseIdx]);
+
+        int regionIdx = regionIndex_(inputs, cellIdx);
+        const PvtEvaluation_& T = PvtEvaluation_::createConstant(inputs.temperature[cellIdx]);
+        const PvtEvaluation_& p =
+            PvtEvaluation_::createVariable(inputs.oilPressure[cellIdx] + pc[phaseIdx] - pc[oilPhaseIdx],
+                                           pvtPressureVarIdx);
+
+        BlackOilPhaseProperties<PvtEvaluation_> props;
+        if (phaseIdx == oilPhaseIdx) {
+            const PvtEvaluation_& X =
+                PvtEvaluation_::createVariable(inputs.oilGasMassFraction[cellIdx], pvtDissolutionVarIdx);
+            props = fluidSystem_.oilProperties(T, p, X, regionIdx);
+        }
+        else if (phaseIdx == gasPhaseIdx) {
+            const PvtEvaluation_& X =
+                PvtEvaluation_::createVariable(inputs.gasOilMassFraction[cellIdx], pvtDissolutionVarIdx);
+            props = fluidSystem_.gasProperties(T, p, X, regionIdx);
+        }
+        else
+            props = fluidSystem_.waterProperties(T, p, regionIdx);
+
+        const Scalar& krValue = kr[phaseIdx];
+        if (mobility) {
+            // lambda = kr/mu
+            const auto& mu = props.mu;
+            Scalar lambda = krValue/mu.value;
+            Scalar dLambda_dMu = -lambda/mu.value;
+            storeMobility_(mobility[cellIdx], lambda,
+                           dKr_dSw/mu.value, dKr_dSg/mu.value, dP_dSw, dP_dSg,
+                           dLambda_dMu*mu.derivatives[pvtPressureVarIdx],
+                           dLambda_dMu*mu.derivatives[pvtDissolutionVarIdx]);
+        }
+
+        if (invBMobility) {
+            // b lambda = kr (b/mu), where b/mu is directly provided by the PVT relations
+            const auto& invBMu = props.invBMu;
+            storeMobility_(invBMobility[cellIdx], krValue*invBMu.value,
+                           dKr_dSw*invBMu.value, dKr_dSg*invBMu.value, dP_dSw, dP_dSg,
+                           krValue*invBMu.derivatives[pvtPressureVarIdx],
+                           krValue*invBMu.derivatives[pvtDissolutionVarIdx]);
+        }
+    }
+
+    // assemble the evaluation of a mobility from the partial derivatives with respect to
+    // the relative permeability and to the PVT variables
+    static void storeMobility_(MobilityEvaluation& result,
+                               Scalar value,
+                               Scalar dValue_dSwViaKr,
+                               Scalar dValue_dSgViaKr,
+                               Scalar dP_dSw,
+                               Scalar dP_dSg,
+                               Scalar dValue_dP,
+                               Scalar dValue_dX)
+    {
+        result.value = value;
+        result.derivatives[waterSaturationVarIdx] = dValue_dSwViaKr + dValue_dP*dP_dSw;
+        result.derivatives[gasSaturationVarIdx] = dValue_dSgViaKr + dValue_dP*dP_dSg;
+        result.derivatives[oilPressureVarIdx] = dValue_dP;
+        result.derivatives[dissolutionVarIdx] = dValue_dX;
+    }
+
+    void runTile_(unsigned tileIdx,
+                  unsigned numCells,
+                  const Inputs& inputs,
+                  const Outputs& outputs) const
+    {
+        unsigned beginCellIdx = tileIdx*tileSize_;
+        unsigned endCellIdx = std::min(beginCellIdx + tileSize_, numCells);
+        runTile(beginCellIdx, endCellIdx, inputs, outputs);
+    }
+
+    // calls functor(tileIdx) for all tiles, concurrently if OpenMP is enabled
+    template <class Functor>
+    static void forEachTile_(unsigned numTiles, const Functor& functor)
+    {
+#ifdef _OPENMP
+        std::exception_ptr exception;
+        #pragma omp parallel for schedule(static)
+        for (int tileIdx = 0; tileIdx < static_cast<int>(numTiles); ++ tileIdx) {
+            try { functor(static_cast<unsigned>(tileIdx)); }
+            catch (...) {
+                #pragma omp critical (OpmBlackOilPropertyPipelineException)
+                if (!exception)
+                    exception = std::current_exception();
+            }
+        }
+
+        if (exception)
+            std::rethrow_exception(exception);
+#else
+        for (unsigned tileIdx = 0; tileIdx < numTiles; ++ tileIdx)
+            functor(tileIdx);
+#endif
+    }
+
+    // the PVT properties of a phase for a cell
+    template <int phaseIdx>
+    BlackOilPhaseProperties<Scalar> phaseProperties_(const Inputs& inputs,
+                                                     const Outputs& outputs,
+                                                     unsigned cellIdx) const
+    {
+        int regionIdx = regionIndex_(inputs, cellIdx);
+        const Scalar& T = inputs.temperature[cellIdx];
+        const Scalar& po = inputs.oilPressure[cellIdx];
+        if (phaseIdx == oilPhaseIdx)
+            return fluidSystem_.oilProperties(T, po, inputs.oilGasMassFraction[cellIdx], regionIdx);
+        else if (phaseIdx == waterPhaseIdx)
+            return fluidSystem_.waterProperties(T, Scalar(po - outputs.pcow[cellIdx]), regionIdx);
+        return fluidSystem_.gasProperties(T,
+                                          Scalar(po + outputs.pcgo[cellIdx]),
+                                          inputs.gasOilMassFraction[cellIdx],
+                                          regionIdx);
+    }
+
+    // the PVT properties of a phase for the cells of a tile
+    template <int phaseIdx>
+    void pvtStage_(unsigned beginCellIdx,
+                   unsigned endCellIdx,
+                   const Inputs& inputs,
+                   const Outputs& outputs) const
+    {
+        const auto& absentProperties = BlackOilPhaseProperties<Scalar>::absentPhase();
+        auto* props = outputs.phaseProperties[phaseIdx];
+        for (unsigned cellIdx = beginCellIdx; cellIdx < endCellIdx; ++cellIdx) {
+            if (!isPresent_(inputs, cellIdx, phaseIdx))
+                props[cellIdx] = absentProperties;
+            else
+                props[cellIdx] = phaseProperties_<phaseIdx>(inputs, outputs, cellIdx);
+        }
+    }
+
+    // select the kernel for a given phase presence
+    void runClassKernel_(unsigned phasePresence,
+                         const unsigned* cells,
+                         size_t numCells,
+                         const Inputs& inputs,
+                         const Outputs& outputs) const
+    {
+        switch (phasePresence) {
+        case 0: classKernel_<0>(cells, numCells, inputs, outputs); break;
+        case 1: classKernel_<1>(cells, numCells, inputs, outputs); break;
+        case 2: classKernel_<2>(cells, numCells, inputs, outputs); break;
+        case 3: classKernel_<3>(cells, numCells, inputs, outputs); break;
+        case 4: classKernel_<4>(cells, numCells, inputs, outputs); break;
+        case 5: classKernel_<5>(cells, numCells, inputs, outputs); break;
+        case 6: classKernel_<6>(cells, numCells, inputs, outputs); break;
+        case 7: classKernel_<7>(cells, numCells, inputs, outputs); break;
+        }
+    }
+
+    // the PVT properties and the mobilities of cells which all contain the same phases
+    template <unsigned phasePresence>
+    void classKernel_(const unsigned* cells,
+                      size_t numCells,
+                      const Inputs& inputs,
+                      const Outputs& outputs) const
+    {
+        classPhaseKernel_<oilPhaseIdx, (phasePresence & (1 << oilPhaseIdx)) != 0>(cells, numCells, inputs, outputs);
+        classPhaseKernel_<waterPhaseIdx, (phasePresence & (1 << waterPhaseIdx)) != 0>(cells, numCells, inputs, outputs);
+        classPhaseKernel_<gasPhaseIdx, (phasePresence & (1 << gasPhaseIdx)) != 0>(cells, numCells, inputs, outputs);
+    }
+
+    template <int phaseIdx, bool isPresent>
+    void classPhaseKernel_(const unsigned* cells,
+                           size_t numCells,
+                           const Inputs& inputs,
+                           const Outputs& outputs) const
+    {
+        auto* props = outputs.phaseProperties[phaseIdx];
+        const Scalar* kr = outputs.relativePermeability[phaseIdx];
+        Scalar* mobility = outputs.mobility[phaseIdx];
+
+        if (!isPresent) {
+            const auto& absentProperties = BlackOilPhaseProperties<Scalar>::absentPhase();
+            for (size_t i = 0; i < numCells; ++i) {
+                props[cells[i]] = absentProperties;
+                mobility[cells[i]] = 0.0;
+            }
+            return;
+        }
+
+        for (size_t i = 0; i < numCells; ++i) {
+            unsigned cellIdx = cells[i];
+            props[cellIdx] = phaseProperties_<phaseIdx>(inputs, outputs, cellIdx);
+            mobility[cellIdx] = kr[cellIdx]/props[cellIdx].mu;
+        }
+    }
+
+    static int regionIndex_(const Inputs& inputs, unsigned cellIdx)
+    { return inputs.pvtRegionIndex ? inputs.pvtRegionIndex[cellIdx] : 0; }
+
+    static bool isPresent_(const Inputs& inputs, unsigned cellIdx, int phaseIdx)
+    { return !inputs.phasePresence || (inputs.phasePresence[cellIdx] & (1 << phaseIdx)); }
+
+    const FluidSystem& fluidSystem_;
+    const SaturationFunctions& saturationFunctions_;
+    unsigned tileSize_;
+};
+} // namespace Opm
+
+#endif
@@ -27,7 +27,7 @@
 #define OPM_BRINE_CO2_SYSTEM_HPP
 
 #include "BaseFluidSystem.hpp"
-#include "NullParameterCache.hpp"
+#include "BrineCO2ParameterCache.hpp"
 
 #include <opm/material/IdealGas.hpp>
 
@@ -41,11 +41,15 @@
 #include <opm/material/binarycoefficients/Brine_CO2.hpp>
 #include <opm/material/binarycoefficients/H2O_N2.hpp>
 
+#include <opm/material/common/Tabulated1DFunction.hpp>
+
 #if HAVE_MPI
 #include <mpi.h>
 #endif
 
 #include <iostream>
+#include <future>
+#include <vector>
 
 namespace Opm {
 namespace FluidSystems {
@@ -61,6 +65,9 @@ template <class Scalar, class CO2Tables>
 class BrineCO2
     : public BaseFluidSystem<Scalar, BrineCO2<Scalar, CO2Tables> >
 {
+    typedef BrineCO2<Scalar, CO2Tables> ThisType;
+    typedef BaseFluidSystem<Scalar, ThisType> Base;
+
     typedef Opm::H2O<Scalar> H2O_IAPWS;
     typedef Opm::Brine<Scalar, H2O_IAPWS> Brine_IAPWS;
     typedef Opm::TabulatedComponent<Scalar, H2O_IAPWS> H2O_Tabulated;
@@ -68,12 +75,14 @@ class BrineCO2
 
     typedef H2O_Tabulated H2O;
 
+    friend class Opm::BrineCO2ParameterCache<Scalar, ThisType>;
+
 public:
     //! The binary coefficients for brine and CO2 used by this fluid system
     typedef Opm::BinaryCoeff::Brine_CO2<Scalar, CO2Tables> BinaryCoeffBrineCO2;
 
     //! \copydoc BaseFluidSystem::ParameterCache
-    typedef Opm::NullParameterCache ParameterCache;
+    typedef Opm::BrineCO2ParameterCache<Scalar, ThisType> ParameterCache;
 
     /****************************************
      * Fluid phase related static parameters
@@ -207,9 +216,13 @@ public:
      * \param pressMin The minimum pressure used for tabulation of water [Pa]
      * \param pressMax The maximum pressure used for tabulation of water [Pa]
      * \param nPress The number of ticks on the pressure axis of the  table of water
+     * \param tabulateMoleFractions If true, the equilibrium mole fractions of the
+     *        brine and CO2 system are tabulated for the same ranges, see
+     *        BinaryCoeff::Brine_CO2::tabulateMoleFractions()
      */
     static void init(Scalar tempMin, Scalar tempMax, int nTemp,
-                     Scalar pressMin, Scalar pressMax, int nPress)
+                     Scalar pressMin, Scalar pressMax, int nPress,
+                     bool tabulateMoleFractions = false)
     {
         if (H2O::isTabulated) {
             H2O_Tabulated::init(tempMin, tempMax, nTemp,
@@ -223,8 +236,94 @@ public:
             Brine_Tabulated::init(tempMin, tempMax, nTemp,
                                   pressMin, pressMax, nPress);
         }
+
+        if (tabulateMoleFractions)
+            BinaryCoeffBrineCO2::tabulateMoleFractions(tempMin, tempMax, nTemp,
+                                                       pressMin, pressMax, nPress,
+                                                       Brine_IAPWS::salinity);
+
+        // look up the viscosity and the heat capacity of CO2 in tables like its density
+        // and enthalpy. this requires the tables of CO2 to be initialized already.
+        if (CO2Tables::tabulatedDensity.numX() > 1 && CO2Tables::tabulatedDensity.numY() > 1)
+            CO2::tabulateTransportProperties();
     }
 
+    /*!
+     * \brief Initialize the fluid system's static parameters in a background thread.
+     *
+     * The arguments are the same as the ones of init(). The fluid system must not be used
+     * before the returned future is ready, cf. Opm::AsyncInitializer.
+     */
+    static std::future<void> initAsync(Scalar tempMin, Scalar tempMax, int nTemp,
+                                       Scalar pressMin, Scalar pressMax, int nPress,
+                                       bool tabulateMoleFractions = false)
+    {
+        return std::async(std::launch::async, [=]() {
+                init(tempMin, tempMax, nTemp, pressMin, pressMax, nPress, tabulateMoleFractions);
+            });
+    }
+
+    /*!
+     * \brief Prepare the fluid system for isothermal simulations.
+     *
+     * This freezes the temperature: Density and viscosity of both phases are
+     * tabulated as functions of pressure, so evaluating them for fluid states at the
+     * given temperature neither requires the two-dimensional tables nor the
+     * temperature dependence of the correlations. The temperature of such fluid
+     * states is treated as a constant, i.e., its derivatives are ignored. For all
+     * other temperatures, the usual relations are used.
+     *
+     * init() must have been called before this method.
+     *
+     * \param temperature The temperature of the simulation [K]
+     * \param pressMin The minimum of the pressure range [Pa]
+     * \param pressMax The maximum of the pressure range [Pa]
+     * \param nPress The number of sampling points on the pressure axis
+     */
+    static void initIsothermal(Scalar temperature,
+                               Scalar pressMin, Scalar pressMax, int nPress)
+    {
+        if (temperature < 273.15)
+            OPM_THROW(NumericalIssue,
+                      "Liquid density for Brine and CO2 is only "
+                      "defined above 273.15K (is " << temperature << "K)");
+        if (nPress < 2 || !(pressMin < pressMax))
+            OPM_THROW(std::invalid_argument,
+                      "Invalid pressure range for the isothermal tables");
+
+        std::vector<Scalar> pressures(nPress);
+        std::vector<Scalar> rhoBrine(nPress), rhoH2O(nPress), rhoCO2(nPress);
+        std::vector<Scalar> muBrine(nPress), muCO2(nPress);
+        for (int i = 0; i < nPress; ++i) {
+            Scalar p = pressMin + i*(pressMax - pressMin)/(nPress - 1);
+            pressures[i] = p;
+            const auto& brine = Brine_IAPWS::liquidProperties(temperature, p);
+            rhoBrine[i] = brine.density;
+            rhoH2O[i] = H2O_IAPWS::liquidDensity(temperature, p);
+            const auto& co2 = CO2::gasProperties(temperature, p);
+            rhoCO2[i] = co2.density;
+            muBrine[i] = brine.viscosity;
+            muCO2[i] = co2.viscosity;
+        }
+
+        isothermalBrineDensity_.setXYContainers(pressures, rhoBrine);
+        isothermalH2ODensity_.setXYContainers(pressures, rhoH2O);
+        isothermalCO2Density_.setXYContainers(pressures, rhoCO2);
+        isothermalBrineViscosity_.setXYContainers(pressures, muBrine);
+        isothermalCO2Viscosity_.setXYContainers(pressures, muCO2);
+
+        Scalar tempC = temperature - 273.15;
+        isothermalVPhi_ = apparentMolarVolumeCO2_(tempC);
+        isothermalTemperature_ = temperature;
+        isothermal_ = true;
+    }
+
+    /*!
+     * \brief Switch back to the temperature dependent relations after initIsothermal().
+     */
+    static void disableIsothermal()
+    { isothermal_ = false; }
+
     /*!
      * \copydoc BaseFluidSystem::density
      */
@@ -251,10 +350,14 @@ public:
             xlBrine /= sumx;
             xlCO2 /= sumx;
 
-            LhsEval result = liquidDensity_(temperature,
-                                            pressure,
-                                            xlBrine,
-                                            xlCO2);
+            LhsEval result =
+                useIsothermalTables_(fluidState, phaseIdx)
+                ? isothermalLiquidDensity_(pressure, xlCO2)
+                : liquidDensity_(paramCache,
+                                 temperature,
+                                 pressure,
+                                 xlBrine,
+                                 xlCO2);
 
             Valgrind::CheckDefined(result);
             return result;
@@ -262,19 +365,11 @@ public:
 
         assert(phaseIdx == gasPhaseIdx);
 
-        // use normalized composition for to calculate the density
-        // (the relations don't seem to take non-normalized
-        // compositions too well...)
-        LhsEval xgBrine = LhsToolbox::min(1.0, LhsToolbox::max(0.0, FsToolbox::template toLhs<LhsEval>(fluidState.moleFraction(gasPhaseIdx, BrineIdx))));
-        LhsEval xgCO2 = LhsToolbox::min(1.0, LhsToolbox::max(0.0,  FsToolbox::template toLhs<LhsEval>(fluidState.moleFraction(gasPhaseIdx, CO2Idx))));
-        LhsEval sumx = xgBrine + xgCO2;
-        xgBrine /= sumx;
-        xgCO2 /= sumx;
-
-        LhsEval result = gasDensity_(temperature,
-                                     pressure,
-                                     xgBrine,
-                                     xgCO2);
+        // the density of the gas phase is assumed to be the one of pure CO2
+        LhsEval result =
+            useIsothermalTables_(fluidState, phaseIdx)
+            ? isothermalCO2Density_.eval(pressure, /*extrapolate=*/true)
+            : paramCache.co2GasDensity(phaseIdx, temperature, pressure);
         Valgrind::CheckDefined(result);
         return result;
     }
@@ -294,16 +389,23 @@ public:
         const LhsEval& temperature = FsToolbox::template toLhs<LhsEval>(fluidState.temperature(phaseIdx));
         const LhsEval& pressure = FsToolbox::template toLhs<LhsEval>(fluidState.pressure(phaseIdx));
 
+        bool isothermal = useIsothermalTables_(fluidState, phaseIdx);
         if (phaseIdx == liquidPhaseIdx) {
             // assume pure brine for the liquid phase. TODO: viscosity
             // of mixture
-            LhsEval result = Brine::liquidViscosity(temperature, pressure);
+            LhsEval result =
+                isothermal
+                ? isothermalBrineViscosity_.eval(pressure, /*extrapolate=*/true)
+                : paramCache.brineLiquidViscosity(phaseIdx, temperature, pressure);
             Valgrind::CheckDefined(result);
             return result;
         }
 
         assert(phaseIdx == gasPhaseIdx);
-        LhsEval result = CO2::gasViscosity(temperature, pressure);
+        LhsEval result =
+            isothermal
+            ? isothermalCO2Viscosity_.eval(pressure, /*extrapolate=*/true)
+            : paramCache.co2GasViscosity(phaseIdx, temperature, pressure);
         Valgrind::CheckDefined(result);
         return result;
     }
@@ -331,38 +433,39 @@ public:
 
         const LhsEval& temperature = FsToolbox::template toLhs<LhsEval>(fluidState.temperature(phaseIdx));
         const LhsEval& pressure = FsToolbox::template toLhs<LhsEval>(fluidState.pressure(phaseIdx));
-        assert(temperature > 0);
-        assert(pressure > 0);
 
-        // calulate the equilibrium composition for the given
-        // temperature and pressure. TODO: calculateMoleFractions()
-        // could use some cleanup.
-        LhsEval xlH2O, xgH2O;
-        LhsEval xlCO2, xgCO2;
-        BinaryCoeffBrineCO2::calculateMoleFractions(temperature,
-                                                    pressure,
-                                                    Brine_IAPWS::salinity,
-                                                    /*knownPhaseIdx=*/-1,
-                                                    xlCO2,
-                                                    xgH2O);
-
-        // normalize the phase compositions
-        xlCO2 = LhsToolbox::max(0.0, LhsToolbox::min(1.0, xlCO2));
-        xgH2O = LhsToolbox::max(0.0, LhsToolbox::min(1.0, xgH2O));
-
-        xlH2O = 1.0 - xlCO2;
-        xgCO2 = 1.0 - xgH2O;
+        LhsEval phi[numComponents];
+        liquidFugacityCoefficients_(paramCache, temperature, pressure, phi);
+        return phi[compIdx];
+    }
 
-        if (compIdx == BrineIdx) {
-            Scalar phigH2O = 1.0;
-            return phigH2O * xgH2O / xlH2O;
+    /*!
+     * \copydoc BaseFluidSystem::computeAll
+     *
+     * The fugacity coefficients of both components in the liquid phase are
+     * determined by the equilibrium composition of the system, which is thus only
+     * calculated once.
+     */
+    template <class FluidState>
+    static void computeAll(FluidState &fluidState,
+                           const ParameterCache &paramCache,
+                           int quantities = Base::AllQuantities)
+    {
+        typedef typename FluidState::Scalar Evaluation;
+
+        Base::computeAll(fluidState, paramCache, quantities & ~Base::FugacityCoefficients);
+        if (!(quantities & Base::FugacityCoefficients))
+            return;
+
+        Evaluation phi[numComponents];
+        liquidFugacityCoefficients_(paramCache,
+                                    fluidState.temperature(liquidPhaseIdx),
+                                    fluidState.pressure(liquidPhaseIdx),
+                                    phi);
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            fluidState.setFugacityCoefficient(liquidPhaseIdx, compIdx, phi[compIdx]);
+            fluidState.setFugacityCoefficient(gasPhaseIdx, compIdx, 1.0);
         }
-        else {
-            assert(compIdx == CO2Idx);
-
-            Scalar phigCO2 = 1.0;
-            return phigCO2 * xgCO2 / xlCO2;
-        };
     }
 
     /*!
@@ -403,7 +506,8 @@ public:
 
         if (phaseIdx == liquidPhaseIdx) {
             const LhsEval& XlCO2 = FsToolbox::template toLhs<LhsEval>(fluidState.massFraction(phaseIdx, CO2Idx));
-            const LhsEval& result = liquidEnthalpyBrineCO2_(temperature,
+            const LhsEval& result = liquidEnthalpyBrineCO2_(paramCache,
+                                                            temperature,
                                                             pressure,
                                                             Brine_IAPWS::salinity,
                                                             XlCO2);
@@ -415,8 +519,8 @@ public:
             const LhsEval& XBrine = FsToolbox::template toLhs<LhsEval>(fluidState.massFraction(gasPhaseIdx, BrineIdx));
 
             LhsEval result = LhsToolbox::createConstant(0);
-            result += XBrine * Brine::gasEnthalpy(temperature, pressure);
-            result += XCO2 * CO2::gasEnthalpy(temperature, pressure);
+            result += XBrine * paramCache.brineGasEnthalpy(phaseIdx, temperature, pressure);
+            result += XCO2 * paramCache.co2GasEnthalpy(phaseIdx, temperature, pressure);
             Valgrind::CheckDefined(result);
             return result;
         }
@@ -472,19 +576,67 @@ public:
 
 private:
     template <class LhsEval>
-    static LhsEval gasDensity_(const LhsEval& T,
-                               const LhsEval& pg,
-                               const LhsEval& xgH2O,
-                               const LhsEval& xgCO2)
+    static void liquidFugacityCoefficients_(const ParameterCache& paramCache,
+                                            const LhsEval& temperature,
+                                            const LhsEval& pressure,
+                                            LhsEval* phi)
     {
-        Valgrind::CheckDefined(T);
-        Valgrind::CheckDefined(pg);
-        Valgrind::CheckDefined(xgH2O);
-        Valgrind::CheckDefined(xgCO2);
+        typedef MathToolbox<LhsEval> LhsToolbox;
+
+        assert(temperature > 0);
+        assert(pressure > 0);
+
+        // calulate the equilibrium composition for the given
+        // temperature and pressure. TODO: calculateMoleFractions()
+        // could use some cleanup.
+        LhsEval xlCO2 = paramCache.equilibriumLiquidCO2MoleFraction(liquidPhaseIdx, temperature, pressure);
+        LhsEval xgH2O = paramCache.equilibriumGasH2OMoleFraction(liquidPhaseIdx, temperature, pressure);
+
+        // normalize the phase compositions
+        xlCO2 = LhsToolbox::max(0.0, LhsToolbox::min(1.0, xlCO2));
+        xgH2O = LhsToolbox::max(0.0, LhsToolbox::min(1.0, xgH2O));
+
+        const LhsEval& xlH2O = 1.0 - xlCO2;
+        const LhsEval& xgCO2 = 1.0 - xgH2O;
+
+        Scalar phigH2O = 1.0;
+        phi[BrineIdx] = phigH2O * xgH2O / xlH2O;
+
+        Scalar phigCO2 = 1.0;
+        phi[CO2Idx] = phigCO2 * xgCO2 / xlCO2;
+    }
+
+    template <class FluidState>
+    static bool useIsothermalTables_(const FluidState& fluidState, int phaseIdx)
+    {
+        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        return
+            isothermal_
+            && FsToolbox::value(fluidState.temperature(phaseIdx)) == isothermalTemperature_;
+    }
+
+    template <class LhsEval>
+    static LhsEval isothermalLiquidDensity_(const LhsEval& pl, const LhsEval& xlCO2)
+    {
+        Valgrind::CheckDefined(pl);
+        Valgrind::CheckDefined(xlCO2);
+
+        if(pl >= 2.5e8) {
+            OPM_THROW(NumericalIssue,
+                      "Liquid density for Brine and CO2 is only "
+                      "defined below 250MPa (is " << pl << "Pa)");
+        }
 
-        return CO2::gasDensity(T, pg);
+        const LhsEval& rho_brine = isothermalBrineDensity_.eval(pl, /*extrapolate=*/true);
+        const LhsEval& rho_pure = isothermalH2ODensity_.eval(pl, /*extrapolate=*/true);
+        const LhsEval& rho_lCO2 = liquidDensityWaterCO2_(rho_pure, isothermalVPhi_, xlCO2);
+        const LhsEval& contribCO2 = rho_lCO2 - rho_pure;
+
+        return rho_brine + contribCO2;
     }
 
+
     /***********************************************************************/
     /*                                                                     */
     /* Total brine density with dissolved CO2                              */
@@ -492,7 +644,8 @@ private:
     /*                                                                     */
     /***********************************************************************/
     template <class LhsEval>
-    static LhsEval liquidDensity_(const LhsEval& T,
+    static LhsEval liquidDensity_(const ParameterCache& paramCache,
+                                  const LhsEval& T,
                                   const LhsEval& pl,
                                   const LhsEval& xlH2O,
                                   const LhsEval& xlCO2)
@@ -513,40 +666,48 @@ private:
                       "defined below 250MPa (is " << pl << "Pa)");
         }
 
-        const LhsEval& rho_brine = Brine::liquidDensity(T, pl);
-        const LhsEval& rho_pure = H2O::liquidDensity(T, pl);
-        const LhsEval& rho_lCO2 = liquidDensityWaterCO2_(T, pl, xlH2O, xlCO2);
+        const LhsEval& rho_brine = paramCache.brineLiquidDensity(liquidPhaseIdx, T, pl);
+        const LhsEval& rho_pure = paramCache.waterLiquidDensity(liquidPhaseIdx, T, pl);
+        const LhsEval& rho_lCO2 = liquidDensityWaterCO2_(rho_pure, apparentMolarVolumeCO2_(T - 273.15), xlCO2);
         const LhsEval& contribCO2 = rho_lCO2 - rho_pure;
 
         return rho_brine + contribCO2;
     }
 
-    template <class LhsEval>
-    static LhsEval liquidDensityWaterCO2_(const LhsEval& temperature,
-                                          const LhsEval& pl,
-                                          const LhsEval& /*xlH2O*/,
+
+    // the density of water with dissolved CO2 given the density of pure water and the
+    // apparent molar volume of CO2
+    template <class LhsEval, class VPhiEval>
+    static LhsEval liquidDensityWaterCO2_(const LhsEval& rho_pure,
+                                          const VPhiEval& V_phi,
                                           const LhsEval& xlCO2)
     {
         Scalar M_CO2 = CO2::molarMass();
         Scalar M_H2O = H2O::molarMass();
 
-        const LhsEval& tempC = temperature - 273.15;        /* tempC : temperature in °C */
-        const LhsEval& rho_pure = H2O::liquidDensity(temperature, pl);
         // calculate the mole fraction of CO2 in the liquid. note that xlH2O is available
         // as a function parameter, but in the case of a pure gas phase the value of M_T
         // for the virtual liquid phase can become very large
         const LhsEval xlH2O = 1.0 - xlCO2;
         const LhsEval& M_T = M_H2O * xlH2O + M_CO2 * xlCO2;
-        const LhsEval& V_phi =
+        return 1/ (xlCO2 * V_phi/M_T + M_H2O * xlH2O / (rho_pure * M_T));
+    }
+
+    // the apparent molar volume of dissolved CO2 [m^3/mol] depending on the
+    // temperature in °C
+    template <class Evaluation>
+    static Evaluation apparentMolarVolumeCO2_(const Evaluation& tempC)
+    {
+        return
             (37.51 +
              tempC*(-9.585e-2 +
                     tempC*(8.74e-4 -
                            tempC*5.044e-7))) / 1.0e6;
-        return 1/ (xlCO2 * V_phi/M_T + M_H2O * xlH2O / (rho_pure * M_T));
     }
 
     template <class LhsEval>
-    static LhsEval liquidEnthalpyBrineCO2_(const LhsEval& T,
+    static LhsEval liquidEnthalpyBrineCO2_(const ParameterCache& paramCache,
+                                           const LhsEval& T,
                                            const LhsEval& p,
                                            Scalar S, // salinity
                                            const LhsEval& X_CO2_w)
@@ -558,12 +719,12 @@ private:
         /* same function as enthalpy_brine, only extended by CO2 content */
 
         /*Numerical coefficents from PALLISER*/
-        static Scalar f[] = {
+        static const Scalar f[] = {
             2.63500E-1, 7.48368E-6, 1.44611E-6, -3.80860E-10
         };
 
         /*Numerical coefficents from MICHAELIDES for the enthalpy of brine*/
-        static Scalar a[4][3] = {
+        static const Scalar a[4][3] = {
             { 9633.6, -4080.0, +286.49 },
             { +166.58, +68.577, -4.6856 },
             { -0.90963, -0.36524, +0.249667E-1 },
@@ -583,7 +744,7 @@ private:
         if (S > S_lSAT)
             S = S_lSAT;
 
-        hw = H2O::liquidEnthalpy(T, p) /1E3; /* kJ/kg */
+        hw = paramCache.waterLiquidEnthalpy(liquidPhaseIdx, T, p) /1E3; /* kJ/kg */
 
         /*DAUBERT and DANNER*/
         /*U=*/h_NaCl = (3.6710E4*T + 0.5*(6.2770E1)*T*T - ((6.6670E-2)/3)*T*T*T
@@ -611,13 +772,39 @@ private:
         delta_hCO2 = (-57.4375 + T * 0.1325) * 1000/44;
 
         /* enthalpy contribution of CO2 (kJ/kg) */
-        hg = CO2::gasEnthalpy(T, p)/1E3 + delta_hCO2;
+        hg = paramCache.co2GasEnthalpy(liquidPhaseIdx, T, p)/1E3 + delta_hCO2;
 
         /* Enthalpy of brine with dissolved CO2 */
         return (h_ls1 - X_CO2_w*hw + hg*X_CO2_w)*1E3; /*J/kg*/
     }
+
+    static bool isothermal_;
+    static Scalar isothermalTemperature_;
+    static Scalar isothermalVPhi_;
+    static Opm::Tabulated1DFunction<Scalar> isothermalBrineDensity_;
+    static Opm::Tabulated1DFunction<Scalar> isothermalH2ODensity_;
+    static Opm::Tabulated1DFunction<Scalar> isothermalCO2Density_;
+    static Opm::Tabulated1DFunction<Scalar> isothermalBrineViscosity_;
+    static Opm::Tabulated1DFunction<Scalar> isothermalCO2Viscosity_;
 };
 
+template <class Scalar, class CO2Tables>
+bool BrineCO2<Scalar, CO2Tables>::isothermal_ = false;
+template <class Scalar, class CO2Tables>
+Scalar BrineCO2<Scalar, CO2Tables>::isothermalTemperature_;
+template <class Scalar, class CO2Tables>
+Scalar BrineCO2<Scalar, CO2Tables>::isothermalVPhi_;
+template <class Scalar, class CO2Tables>
+Opm::Tabulated1DFunction<Scalar> BrineCO2<Scalar, CO2Tables>::isothermalBrineDensity_;
+template <class Scalar, class CO2Tables>
+Opm::Tabulated1DFunction<Scalar> BrineCO2<Scalar, CO2Tables>::isothermalH2ODensity_;
+template <class Scalar, class CO2Tables>
+Opm::Tabulated1DFunction<Scalar> BrineCO2<Scalar, CO2Tables>::isothermalCO2Density_;
+template <class Scalar, class CO2Tables>
+Opm::Tabulated1DFunction<Scalar> BrineCO2<Scalar, CO2Tables>::isothermalBrineViscosity_;
+template <class Scalar, class CO2Tables>
+Opm::Tabulated1DFunction<Scalar> BrineCO2<Scalar, CO2Tables>::isothermalCO2Viscosity_;
+
 } // namespace FluidSystems
 } // namespace Opm
 
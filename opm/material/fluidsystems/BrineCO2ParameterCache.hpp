@@ -0,0 +1,308 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::BrineCO2ParameterCache
+ */
+#ifndef OPM_BRINE_CO2_PARAMETER_CACHE_HPP
+#define OPM_BRINE_CO2_PARAMETER_CACHE_HPP
+
+#include "ParameterCacheBase.hpp"
+
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+
+#include <cassert>
+#include <limits>
+#include <type_traits>
+
+namespace Opm {
+
+/*!
+ * \ingroup Fluidsystems
+ * \brief A parameter cache which stores the pure component properties and the
+ *        equilibrium composition of the brine-CO2 fluid system for each fluid phase.
+ *
+ * The density, viscosity, fugacity coefficient and enthalpy relations of the brine-CO2
+ * fluid system all evaluate pure component relations which only depend on the
+ * temperature and the pressure of a phase, and several of them evaluate the same
+ * ones, e.g., the density of pure water is required for the liquid density and the
+ * enthalpy of CO2 is required for the enthalpy of both phases. Like
+ * Opm::H2OParameterCache, this cache stores these quantities per phase and only
+ * re-calculates a quantity if it is requested for a temperature or pressure which
+ * differs from the one for which it was calculated last. The equilibrium mole
+ * fractions which are required for the fugacity coefficients are always calculated
+ * together.
+ *
+ * Besides the values, the partial derivatives with regard to temperature and
+ * pressure are stored if the quantity is requested for a function evaluation. The
+ * derivatives of the result are then obtained using the chain rule.
+ *
+ * \tparam Scalar The type used for scalar values
+ * \tparam FluidSystem The brine-CO2 fluid system. The cache accesses its private
+ *                     component types, so it must be declared as a friend.
+ */
+template <class Scalar, class FluidSystem>
+class BrineCO2ParameterCache
+    : public Opm::ParameterCacheBase<BrineCO2ParameterCache<Scalar, FluidSystem> >
+{
+    typedef BrineCO2ParameterCache<Scalar, FluidSystem> ThisType;
+    typedef Opm::ParameterCacheBase<ThisType> ParentType;
+
+    typedef typename FluidSystem::H2O H2O;
+    typedef typename FluidSystem::Brine Brine;
+    typedef typename FluidSystem::CO2 CO2;
+    typedef typename FluidSystem::Brine_IAPWS Brine_IAPWS;
+    typedef typename FluidSystem::BinaryCoeffBrineCO2 BinaryCoeffBrineCO2;
+
+    // evaluations w.r.t. temperature and pressure
+    typedef Opm::LocalAd::Evaluation<Scalar, ThisType, 2> TpEvaluation;
+
+    enum { numPhases = FluidSystem::numPhases };
+
+    enum {
+        brineLiquidDensityIdx,
+        waterLiquidDensityIdx,
+        brineLiquidViscosityIdx,
+        waterLiquidEnthalpyIdx,
+        brineGasEnthalpyIdx,
+        co2GasDensityIdx,
+        co2GasViscosityIdx,
+        co2GasEnthalpyIdx,
+        liquidCO2MoleFractionIdx,
+        gasH2OMoleFractionIdx,
+        numQuantities
+    };
+
+    struct Entry
+    {
+        Scalar temperature;
+        Scalar pressure;
+        Scalar value;
+        Scalar dT;
+        Scalar dp;
+        bool hasDerivatives;
+    };
+
+public:
+    BrineCO2ParameterCache()
+    {
+        const Scalar NaN = std::numeric_limits<Scalar>::quiet_NaN();
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            for (int qIdx = 0; qIdx < numQuantities; ++qIdx) {
+                // NaN never compares equal, so all quantities are calculated when
+                // they are requested for the first time
+                entries_[phaseIdx][qIdx].temperature = NaN;
+                entries_[phaseIdx][qIdx].pressure = NaN;
+                entries_[phaseIdx][qIdx].hasDerivatives = false;
+            }
+        }
+    }
+
+    /*!
+     * \brief Returns the density of liquid brine at the conditions of a phase [kg/m^3]
+     */
+    template <class LhsEval>
+    LhsEval brineLiquidDensity(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, brineLiquidDensityIdx, temperature, pressure); }
+
+    /*!
+     * \brief Returns the density of pure liquid water at the conditions of a phase [kg/m^3]
+     */
+    template <class LhsEval>
+    LhsEval waterLiquidDensity(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, waterLiquidDensityIdx, temperature, pressure); }
+
+    /*!
+     * \brief Returns the viscosity of liquid brine at the conditions of a phase [Pa s]
+     */
+    template <class LhsEval>
+    LhsEval brineLiquidViscosity(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, brineLiquidViscosityIdx, temperature, pressure); }
+
+    /*!
+     * \brief Returns the specific enthalpy of pure liquid water at the conditions of a
+     *        phase [J/kg]
+     */
+    template <class LhsEval>
+    LhsEval waterLiquidEnthalpy(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, waterLiquidEnthalpyIdx, temperature, pressure); }
+
+    /*!
+     * \brief Returns the specific enthalpy of gaseous brine at the conditions of a
+     *        phase [J/kg]
+     */
+    template <class LhsEval>
+    LhsEval brineGasEnthalpy(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, brineGasEnthalpyIdx, temperature, pressure); }
+
+    /*!
+     * \brief Returns the density of CO2 at the conditions of a phase [kg/m^3]
+     */
+    template <class LhsEval>
+    LhsEval co2GasDensity(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, co2GasDensityIdx, temperature, pressure); }
+
+    /*!
+     * \brief Returns the viscosity of CO2 at the conditions of a phase [Pa s]
+     */
+    template <class LhsEval>
+    LhsEval co2GasViscosity(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, co2GasViscosityIdx, temperature, pressure); }
+
+    /*!
+     * \brief Returns the specific enthalpy of CO2 at the conditions of a phase [J/kg]
+     */
+    template <class LhsEval>
+    LhsEval co2GasEnthalpy(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, co2GasEnthalpyIdx, temperature, pressure); }
+
+    /*!
+     * \brief Returns the mole fraction of CO2 in the liquid if the liquid is in
+     *        equilibrium with the gas at the conditions of a phase [-]
+     *
+     * The value is not clipped to the interval [0, 1].
+     */
+    template <class LhsEval>
+    LhsEval equilibriumLiquidCO2MoleFraction(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, liquidCO2MoleFractionIdx, temperature, pressure); }
+
+    /*!
+     * \brief Returns the mole fraction of water in the gas if the gas is in
+     *        equilibrium with the liquid at the conditions of a phase [-]
+     *
+     * The value is not clipped to the interval [0, 1].
+     */
+    template <class LhsEval>
+    LhsEval equilibriumGasH2OMoleFraction(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, gasH2OMoleFractionIdx, temperature, pressure); }
+
+private:
+    template <class LhsEval>
+    LhsEval quantity_(int phaseIdx, int qIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    {
+        typedef Opm::MathToolbox<LhsEval> Toolbox;
+
+        const bool needDerivatives = !std::is_same<LhsEval, Scalar>::value;
+        Scalar T = Toolbox::value(temperature);
+        Scalar p = Toolbox::value(pressure);
+
+        Entry& entry = entries_[phaseIdx][qIdx];
+        if (!(entry.temperature == T && entry.pressure == p)
+            || (needDerivatives && !entry.hasDerivatives))
+            update_(phaseIdx, qIdx, T, p, needDerivatives);
+
+        return entry.value + entry.dT*(temperature - T) + entry.dp*(pressure - p);
+    }
+
+    void update_(int phaseIdx, int qIdx, Scalar T, Scalar p, bool needDerivatives) const
+    {
+        if (qIdx == liquidCO2MoleFractionIdx || qIdx == gasH2OMoleFractionIdx) {
+            // both mole fractions are the result of the same calculation
+            Entry& xlEntry = entries_[phaseIdx][liquidCO2MoleFractionIdx];
+            Entry& xgEntry = entries_[phaseIdx][gasH2OMoleFractionIdx];
+            if (needDerivatives) {
+                TpEvaluation xlCO2, xgH2O;
+                BinaryCoeffBrineCO2::calculateMoleFractions(TpEvaluation::createVariable(T, 0),
+                                                            TpEvaluation::createVariable(p, 1),
+                                                            Brine_IAPWS::salinity,
+                                                            /*knownPhaseIdx=*/-1,
+                                                            xlCO2,
+                                                            xgH2O);
+                store_(xlEntry, xlCO2, T, p);
+                store_(xgEntry, xgH2O, T, p);
+            }
+            else {
+                Scalar xlCO2, xgH2O;
+                BinaryCoeffBrineCO2::calculateMoleFractions(T,
+                                                            p,
+                                                            Brine_IAPWS::salinity,
+                                                            /*knownPhaseIdx=*/-1,
+                                                            xlCO2,
+                                                            xgH2O);
+                store_(xlEntry, xlCO2, T, p);
+                store_(xgEntry, xgH2O, T, p);
+            }
+            return;
+        }
+
+        Entry& entry = entries_[phaseIdx][qIdx];
+        if (needDerivatives)
+            store_(entry,
+                   calculate_(qIdx,
+                              TpEvaluation::createVariable(T, 0),
+                              TpEvaluation::createVariable(p, 1)),
+                   T, p);
+        else
+            store_(entry, calculate_(qIdx, T, p), T, p);
+    }
+
+    static void store_(Entry& entry, const TpEvaluation& result, Scalar T, Scalar p)
+    {
+        entry.value = result.value;
+        entry.dT = result.derivatives[0];
+        entry.dp = result.derivatives[1];
+        entry.temperature = T;
+        entry.pressure = p;
+        entry.hasDerivatives = true;
+    }
+
+    static void store_(Entry& entry, Scalar result, Scalar T, Scalar p)
+    {
+        entry.value = result;
+        entry.dT = 0.0;
+        entry.dp = 0.0;
+        entry.temperature = T;
+        entry.pressure = p;
+        entry.hasDerivatives = false;
+    }
+
+    template <class Evaluation>
+    static Evaluation calculate_(int qIdx, const Evaluation& T, const Evaluation& p)
+    {
+        switch (qIdx) {
+        case brineLiquidDensityIdx:
+            return Brine::liquidDensity(T, p);
+        case waterLiquidDensityIdx:
+            return H2O::liquidDensity(T, p);
+        case brineLiquidViscosityIdx:
+            return Brine::liquidViscosity(T, p);
+        case waterLiquidEnthalpyIdx:
+            return H2O::liquidEnthalpy(T, p);
+        case brineGasEnthalpyIdx:
+            return Brine::gasEnthalpy(T, p);
+        case co2GasDensityIdx:
+            return CO2::gasDensity(T, p);
+        case co2GasViscosityIdx:
+            return CO2::gasViscosity(T, p);
+        default:
+            assert(qIdx == co2GasEnthalpyIdx);
+            return CO2::gasEnthalpy(T, p);
+        }
+    }
+
+    mutable Entry entries_[numPhases][numQuantities];
+};
+
+} // namespace Opm
+
+#endif
@@ -26,7 +26,7 @@
 #define OPM_H2O_AIR_SYSTEM_HPP
 
 #include "BaseFluidSystem.hpp"
-#include "NullParameterCache.hpp"
+#include "H2OParameterCache.hpp"
 
 #include <opm/material/IdealGas.hpp>
 #include <opm/material/binarycoefficients/H2O_Air.hpp>
@@ -66,7 +66,7 @@ class H2OAir
 
 public:
     //! \copydoc BaseFluidSystem::ParameterCache
-    typedef NullParameterCache ParameterCache;
+    typedef Opm::H2OParameterCache<Scalar, ThisType> ParameterCache;
 
     //! The type of the water component used for this fluid system
     typedef H2Otype H2O;
@@ -221,13 +221,12 @@ public:
      */
     static void init()
     {
-        if (H2O::isTabulated)
-            init(/*tempMin=*/273.15,
-                 /*tempMax=*/623.15,
-                 /*numTemp=*/100,
-                 /*pMin=*/-10,
-                 /*pMax=*/20e6,
-                 /*numP=*/200);
+        init(/*tempMin=*/273.15,
+             /*tempMax=*/623.15,
+             /*numTemp=*/100,
+             /*pMin=*/-10,
+             /*pMax=*/20e6,
+             /*numP=*/200);
     }
 
     /*!
@@ -248,6 +247,10 @@ public:
             H2O::init(tempMin, tempMax, nTemp,
                                pressMin, pressMax, nPress);
         }
+
+        // the gas diffusion coefficient times the pressure only depends on
+        // temperature
+        Opm::BinaryCoeff::H2O_Air::tabulate(tempMin, tempMax, nTemp);
     }
 
     //! \copydoc BaseFluidSystem::density
@@ -281,11 +284,11 @@ public:
         {
             if (!useComplexRelations)
                 // assume pure water
-                return H2O::liquidDensity(T, p);
+                return paramCache.liquidDensity(phaseIdx, T, p);
             else
             {
                 // See: Ochs 2008 (2.6)
-                const LhsEval& rholH2O = H2O::liquidDensity(T, p);
+                const LhsEval& rholH2O = paramCache.liquidDensity(phaseIdx, T, p);
                 const LhsEval& clH2O = rholH2O/H2O::molarMass();
 
                 const auto& xlH2O = FsToolbox::template toLhs<LhsEval>(fluidState.moleFraction(liquidPhaseIdx, H2OIdx));
@@ -335,7 +338,7 @@ public:
             // assume pure water for the liquid phase
             // TODO: viscosity of mixture
             // couldn't find a way to solve the mixture problem
-            return H2O::liquidViscosity(T, p);
+            return paramCache.liquidViscosity(phaseIdx, T, p);
         }
         else if (phaseIdx == gasPhaseIdx)
         {
@@ -354,7 +357,7 @@ public:
 
                 LhsEval muResult = 0;
                 const LhsEval mu[numComponents] = {
-                    H2O::gasViscosity(T, H2O::vaporPressure(T)),
+                    paramCache.saturatedGasViscosity(phaseIdx, T),
                     Air::gasViscosity(T, p)
                 };
 
@@ -404,7 +407,7 @@ public:
 
         if (phaseIdx == liquidPhaseIdx) {
             if (compIdx == H2OIdx)
-                return H2O::vaporPressure(T)/p;
+                return paramCache.vaporPressure(phaseIdx, T)/p;
             return Opm::BinaryCoeff::H2O_Air::henry(T)/p;
         }
 
@@ -448,14 +451,14 @@ public:
         if (phaseIdx == liquidPhaseIdx)
         {
             // TODO: correct way to deal with the solutes???
-            return H2O::liquidEnthalpy(T, p);
+            return paramCache.liquidEnthalpy(phaseIdx, T, p);
         }
 
         else if (phaseIdx == gasPhaseIdx)
         {
             LhsEval result = 0.0;
             result +=
-                H2O::gasEnthalpy(T, p) *
+                paramCache.gasEnthalpy(phaseIdx, T, p) *
                 FsToolbox::template toLhs<LhsEval>(fluidState.massFraction(gasPhaseIdx, H2OIdx));
 
             result +=
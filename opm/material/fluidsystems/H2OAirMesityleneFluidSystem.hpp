@@ -42,6 +42,7 @@
 #include <opm/material/binarycoefficients/Air_Mesitylene.hpp>
 
 #include <iostream>
+#include <type_traits>
 
 namespace Opm {
 namespace FluidSystems {
@@ -50,26 +51,40 @@ namespace FluidSystems {
  * \ingroup Fluidsystems
  * \brief A fluid system with water, gas and NAPL as phases and
  *        water, air and mesitylene (DNAPL) as components.
+ *
+ * Water is always tabulated. If tabulateComponents is true, mesitylene and air are
+ * tabulated as well, using the same temperature and pressure range, so that all
+ * component properties are looked up from tables.
+ *
+ * \tparam Scalar The type used for scalar values
+ * \tparam tabulateComponents Specifies whether all components or only water ought to be
+ *                            tabulated by init()
  */
-template <class Scalar>
+template <class Scalar, bool tabulateComponents = false>
 class H2OAirMesitylene
-    : public BaseFluidSystem<Scalar, H2OAirMesitylene<Scalar> >
+    : public BaseFluidSystem<Scalar, H2OAirMesitylene<Scalar, tabulateComponents> >
 {
-    typedef H2OAirMesitylene<Scalar> ThisType;
+    typedef H2OAirMesitylene<Scalar, tabulateComponents> ThisType;
     typedef BaseFluidSystem<Scalar, ThisType> Base;
 
     typedef Opm::H2O<Scalar> IapwsH2O;
     typedef Opm::TabulatedComponent<Scalar, IapwsH2O, /*alongVaporPressure=*/false> TabulatedH2O;
 
+    typedef Opm::Mesitylene<Scalar> RawNAPL;
+    typedef Opm::TabulatedComponent<Scalar, RawNAPL, /*alongVaporPressure=*/false> TabulatedNAPL;
+
+    typedef Opm::Air<Scalar> RawAir;
+    typedef Opm::TabulatedComponent<Scalar, RawAir, /*alongVaporPressure=*/false> TabulatedAir;
+
 public:
     //! \copydoc BaseFluidSystem::ParameterCache
     typedef NullParameterCache ParameterCache;
 
     //! The type of the mesithylene/napl component
-    typedef Opm::Mesitylene<Scalar> NAPL;
+    typedef typename std::conditional<tabulateComponents, TabulatedNAPL, RawNAPL>::type NAPL;
 
     //! The type of the air component
-    typedef Opm::Air<Scalar> Air;
+    typedef typename std::conditional<tabulateComponents, TabulatedAir, RawAir>::type Air;
 
     //! The type of the water component
     //typedef SimpleH2O H2O;
@@ -110,6 +125,10 @@ public:
      * \brief Initialize the fluid system's static parameters using
      *        problem specific temperature and pressure ranges
      *
+     * If the fluid system tabulates all components, the tables of mesitylene and air
+     * use the same range as the ones of water. Only the properties which are used by
+     * the fluid system are tabulated for them.
+     *
      * \param tempMin The minimum temperature used for tabulation of water [K]
      * \param tempMax The maximum temperature used for tabulation of water [K]
      * \param nTemp The number of ticks on the temperature axis of the  table of water
@@ -120,10 +139,38 @@ public:
     static void init(Scalar tempMin, Scalar tempMax, unsigned nTemp,
                      Scalar pressMin, Scalar pressMax, unsigned nPress)
     {
+        // the saturation curve of water is also used while tabulating the water
+        // component, so it is tabulated first
+        IapwsH2O::tabulateSaturationCurve();
+
         if (H2O::isTabulated) {
             TabulatedH2O::init(tempMin, tempMax, nTemp,
                                pressMin, pressMax, nPress);
         }
+
+        if (tabulateComponents) {
+            TabulatedNAPL::init(tempMin, tempMax, nTemp,
+                                pressMin, pressMax, nPress,
+                                /*lazy=*/false, /*bicubic=*/false,
+                                TabulatedNAPL::liquidDensityFlag
+                                | TabulatedNAPL::liquidViscosityFlag
+                                | TabulatedNAPL::liquidEnthalpyFlag
+                                | TabulatedNAPL::gasDensityFlag
+                                | TabulatedNAPL::gasViscosityFlag
+                                | TabulatedNAPL::gasEnthalpyFlag);
+            TabulatedAir::init(tempMin, tempMax, nTemp,
+                               pressMin, pressMax, nPress,
+                               /*lazy=*/false, /*bicubic=*/false,
+                               TabulatedAir::gasDensityFlag
+                               | TabulatedAir::gasViscosityFlag
+                               | TabulatedAir::gasEnthalpyFlag
+                               | TabulatedAir::gasThermalConductivityFlag);
+        }
+
+        // the Henry coefficient of air (which is approximated by the one of nitrogen)
+        // and the diffusion coefficient of water in air only depend on temperature
+        Opm::BinaryCoeff::H2O_N2::tabulate(tempMin, tempMax, nTemp);
+        Opm::BinaryCoeff::H2O_Air::tabulate(tempMin, tempMax, nTemp);
     }
 
     //! \copydoc BaseFluidSystem::isLiquid
@@ -223,11 +270,13 @@ public:
                        NAPL::molarMass()*FsToolbox::template toLhs<LhsEval>(fluidState.moleFraction(waterPhaseIdx, NAPLIdx)));
         }
         else if (phaseIdx == naplPhaseIdx) {
-            // assume pure NAPL for the NAPL phase
+            // assume pure NAPL for the NAPL phase. if it is incompressible, an
+            // arbitrary pressure is used which is within the range of the tables if
+            // the component is tabulated
             const LhsEval& p =
                 NAPL::liquidIsCompressible()
                 ? FsToolbox::template toLhs<LhsEval>(fluidState.pressure(phaseIdx))
-                : 1e100;
+                : 1e5;
             return NAPL::liquidDensity(T, p);
         }
 
@@ -37,7 +37,9 @@
 #include <opm/material/binarycoefficients/Air_Xylene.hpp>
 
 #include "BaseFluidSystem.hpp"
-#include "NullParameterCache.hpp"
+#include "H2OParameterCache.hpp"
+
+#include <type_traits>
 
 namespace Opm {
 namespace FluidSystems {
@@ -46,24 +48,41 @@ namespace FluidSystems {
  * \ingroup Fluidsystems
  * \brief A fluid system with water, gas and NAPL as phases and
  *        water, air and NAPL (contaminant) as components.
+ *
+ * If tabulateComponents is true, all components are tabulated by init() using the
+ * same temperature and pressure range, so that their properties are looked up from
+ * tables. (The simplified gas viscosity of air, which is used for the Wilke mixing
+ * rule, is always calculated.)
+ *
+ * \tparam Scalar The type used for scalar values
+ * \tparam tabulateComponents Specifies whether the components ought to be tabulated
  */
-template <class Scalar>
+template <class Scalar, bool tabulateComponents = false>
 class H2OAirXylene
-    : public BaseFluidSystem<Scalar, H2OAirXylene<Scalar> >
+    : public BaseFluidSystem<Scalar, H2OAirXylene<Scalar, tabulateComponents> >
 {
-    typedef H2OAirXylene<Scalar> ThisType;
+    typedef H2OAirXylene<Scalar, tabulateComponents> ThisType;
     typedef BaseFluidSystem<Scalar, ThisType> Base;
 
+    typedef Opm::H2O<Scalar> IapwsH2O;
+    typedef Opm::TabulatedComponent<Scalar, IapwsH2O, /*alongVaporPressure=*/false> TabulatedH2O;
+
+    typedef Opm::Xylene<Scalar> RawNAPL;
+    typedef Opm::TabulatedComponent<Scalar, RawNAPL, /*alongVaporPressure=*/false> TabulatedNAPL;
+
+    typedef Opm::Air<Scalar> RawAir;
+    typedef Opm::TabulatedComponent<Scalar, RawAir, /*alongVaporPressure=*/false> TabulatedAir;
+
 public:
     //! \copydoc BaseFluidSystem::ParameterCache
-    typedef NullParameterCache ParameterCache;
+    typedef Opm::H2OParameterCache<Scalar, ThisType> ParameterCache;
 
     //! The type of the water component
-    typedef Opm::H2O<Scalar> H2O;
+    typedef typename std::conditional<tabulateComponents, TabulatedH2O, IapwsH2O>::type H2O;
     //! The type of the xylene/napl component
-    typedef Opm::Xylene<Scalar> NAPL;
+    typedef typename std::conditional<tabulateComponents, TabulatedNAPL, RawNAPL>::type NAPL;
     //! The type of the air component
-    typedef Opm::Air<Scalar> Air;
+    typedef typename std::conditional<tabulateComponents, TabulatedAir, RawAir>::type Air;
 
     //! \copydoc BaseFluidSystem::numPhases
     static const int numPhases = 3;
@@ -86,7 +105,60 @@ public:
 
     //! \copydoc BaseFluidSystem::init
     static void init()
-    { }
+    {
+        init(/*tempMin=*/273.15,
+             /*tempMax=*/623.15,
+             /*numTemp=*/100,
+             /*pMin=*/0.0,
+             /*pMax=*/20e6,
+             /*numP=*/200);
+    }
+
+    /*!
+     * \brief Initialize the fluid system's static parameters using
+     *        problem specific temperature and pressure ranges
+     *
+     * The pressure range is only used if the components are tabulated. In this case,
+     * only the properties which are used by the fluid system are tabulated for xylene
+     * and air.
+     *
+     * \param tempMin The minimum temperature used for tabulation [K]
+     * \param tempMax The maximum temperature used for tabulation [K]
+     * \param nTemp The number of ticks on the temperature axis of the tables
+     * \param pressMin The minimum pressure used for tabulation [Pa]
+     * \param pressMax The maximum pressure used for tabulation [Pa]
+     * \param nPress The number of ticks on the pressure axis of the tables
+     */
+    static void init(Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                     Scalar pressMin, Scalar pressMax, unsigned nPress)
+    {
+        // the saturation curve of water is also used while tabulating the water
+        // component, so it is tabulated first
+        IapwsH2O::tabulateSaturationCurve();
+
+        if (tabulateComponents) {
+            TabulatedH2O::init(tempMin, tempMax, nTemp,
+                               pressMin, pressMax, nPress);
+            TabulatedNAPL::init(tempMin, tempMax, nTemp,
+                                pressMin, pressMax, nPress,
+                                /*lazy=*/false, /*bicubic=*/false,
+                                TabulatedNAPL::liquidDensityFlag
+                                | TabulatedNAPL::liquidViscosityFlag
+                                | TabulatedNAPL::liquidEnthalpyFlag
+                                | TabulatedNAPL::gasDensityFlag
+                                | TabulatedNAPL::gasViscosityFlag
+                                | TabulatedNAPL::gasEnthalpyFlag);
+            TabulatedAir::init(tempMin, tempMax, nTemp,
+                               pressMin, pressMax, nPress,
+                               /*lazy=*/false, /*bicubic=*/false,
+                               TabulatedAir::gasDensityFlag
+                               | TabulatedAir::gasEnthalpyFlag);
+        }
+
+        // the diffusion coefficient of water in air times the pressure only depends
+        // on temperature
+        Opm::BinaryCoeff::H2O_Air::tabulate(tempMin, tempMax, nTemp);
+    }
 
     //! \copydoc BaseFluidSystem::isLiquid
     static bool isLiquid(int phaseIdx)
@@ -176,7 +248,7 @@ public:
 
             // See: Ochs 2008
             // \todo: proper citation
-            const LhsEval& rholH2O = H2O::liquidDensity(T, p);
+            const LhsEval& rholH2O = paramCache.liquidDensity(phaseIdx, T, p);
             const LhsEval& clH2O = rholH2O/H2O::molarMass();
 
             const auto& xwH2O = FsToolbox::template toLhs<LhsEval>(fluidState.moleFraction(waterPhaseIdx, H2OIdx));
@@ -187,9 +259,11 @@ public:
             return clH2O*(H2O::molarMass()*xwH2O + Air::molarMass()*xwAir + NAPL::molarMass()*xwNapl);
         }
         else if (phaseIdx == naplPhaseIdx) {
-            // assume pure NAPL for the NAPL phase
+            // assume pure NAPL for the NAPL phase. the density of xylene does not
+            // depend on pressure, so an arbitrary one is used which is within the
+            // range of the tables if the component is tabulated
             const auto& T = FsToolbox::template toLhs<LhsEval>(fluidState.temperature(phaseIdx));
-            return NAPL::liquidDensity(T, LhsEval(1e100));
+            return NAPL::liquidDensity(T, LhsEval(1e5));
         }
 
         assert (phaseIdx == gasPhaseIdx);
@@ -218,7 +292,7 @@ public:
 
         if (phaseIdx == waterPhaseIdx) {
             // assume pure water viscosity
-            return H2O::liquidViscosity(T, p);
+            return paramCache.liquidViscosity(phaseIdx, T, p);
         }
         else if (phaseIdx == naplPhaseIdx) {
             // assume pure NAPL viscosity
@@ -239,8 +313,8 @@ public:
          * -- compare e.g. with Promo Class p. 32/33
          */
         const LhsEval mu[numComponents] = {
-            H2O::gasViscosity(T, H2O::vaporPressure(T)),
-            Air::simpleGasViscosity(T, p),
+            paramCache.saturatedGasViscosity(phaseIdx, T),
+            RawAir::simpleGasViscosity(T, p),
             NAPL::gasViscosity(T, NAPL::vaporPressure(T))
         };
         // molar masses
@@ -340,7 +414,7 @@ public:
 
         if (phaseIdx == waterPhaseIdx) {
             if (compIdx == H2OIdx)
-                return H2O::vaporPressure(T)/p;
+                return paramCache.vaporPressure(phaseIdx, T)/p;
             else if (compIdx == airIdx)
                 return Opm::BinaryCoeff::H2O_Air::henry(T)/p;
             else if (compIdx == NAPLIdx)
@@ -380,14 +454,14 @@ public:
         const auto& p = FsToolbox::template toLhs<LhsEval>(fluidState.pressure(phaseIdx));
 
         if (phaseIdx == waterPhaseIdx) {
-            return H2O::liquidEnthalpy(T, p);
+            return paramCache.liquidEnthalpy(phaseIdx, T, p);
         }
         else if (phaseIdx == naplPhaseIdx) {
             return NAPL::liquidEnthalpy(T, p);
         }
         else if (phaseIdx == gasPhaseIdx) {  // gas phase enthalpy depends strongly on composition
             const LhsEval& hgc = NAPL::gasEnthalpy(T, p);
-            const LhsEval& hgw = H2O::gasEnthalpy(T, p);
+            const LhsEval& hgw = paramCache.gasEnthalpy(phaseIdx, T, p);
             const LhsEval& hga = Air::gasEnthalpy(T, p);
 
             LhsEval result = 0;
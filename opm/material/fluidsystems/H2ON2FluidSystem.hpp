@@ -26,7 +26,7 @@
 #define OPM_H2O_N2_FLUID_SYSTEM_HPP
 
 #include "BaseFluidSystem.hpp"
-#include "NullParameterCache.hpp"
+#include "H2OParameterCache.hpp"
 
 #include <opm/material/IdealGas.hpp>
 #include <opm/material/components/N2.hpp>
@@ -35,12 +35,14 @@
 #include <opm/material/components/TabulatedComponent.hpp>
 #include <opm/material/binarycoefficients/H2O_N2.hpp>
 #include <opm/material/common/Valgrind.hpp>
+#include <opm/material/common/Tabulated1DFunction.hpp>
 
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/ErrorMacros.hpp>
 
 #include <iostream>
 #include <cassert>
+#include <vector>
 
 namespace Opm {
 namespace FluidSystems {
@@ -65,7 +67,10 @@ class H2ON2
 
 public:
     //! \copydoc BaseFluidSystem::ParameterCache
-    typedef NullParameterCache ParameterCache;
+    typedef Opm::H2OParameterCache<Scalar, ThisType> ParameterCache;
+
+    //! \copydoc BaseFluidSystem::hasExactDerivatives
+    static const bool hasExactDerivatives = true;
 
     /****************************************
      * Fluid phase related static parameters
@@ -249,12 +254,67 @@ public:
     static void init(Scalar tempMin, Scalar tempMax, unsigned nTemp,
                      Scalar pressMin, Scalar pressMax, unsigned nPress)
     {
+        // the saturation curve of water is also used while tabulating the water
+        // component, so it is tabulated first
+        IapwsH2O::tabulateSaturationCurve();
+
         if (H2O::isTabulated) {
             TabulatedH2O::init(tempMin, tempMax, nTemp,
                                pressMin, pressMax, nPress);
         }
+        // the Henry coefficient and the gas diffusion coefficient only depend on
+        // temperature
+        Opm::BinaryCoeff::H2O_N2::tabulate(tempMin, tempMax, nTemp);
+    }
+
+    /*!
+     * \brief Prepare the fluid system for isothermal simulations.
+     *
+     * This freezes the temperature: The density and the viscosity of liquid water
+     * are tabulated as functions of pressure and all quantities which only depend on
+     * temperature (vapor pressure, Henry coefficient and viscosity of steam) are
+     * calculated once. Fluid states at the given temperature then neither use the
+     * two-dimensional tables of water nor the temperature dependence of the
+     * relations, i.e., the derivatives of their temperature are ignored. For all
+     * other temperatures, the usual relations are used.
+     *
+     * init() must have been called before this method.
+     *
+     * \param temperature The temperature of the simulation [K]
+     * \param pressMin The minimum of the pressure range [Pa]
+     * \param pressMax The maximum of the pressure range [Pa]
+     * \param nPress The number of sampling points on the pressure axis
+     */
+    static void initIsothermal(Scalar temperature,
+                               Scalar pressMin, Scalar pressMax, unsigned nPress)
+    {
+        if (nPress < 2 || !(pressMin < pressMax))
+            OPM_THROW(std::invalid_argument,
+                      "Invalid pressure range for the isothermal tables");
+
+        std::vector<Scalar> pressures(nPress), rhoH2O(nPress), muH2O(nPress);
+        for (unsigned i = 0; i < nPress; ++i) {
+            Scalar p = pressMin + i*(pressMax - pressMin)/(nPress - 1);
+            pressures[i] = p;
+            rhoH2O[i] = IapwsH2O::liquidDensity(temperature, p);
+            muH2O[i] = IapwsH2O::liquidViscosity(temperature, p);
+        }
+        isothermalH2ODensity_.setXYContainers(pressures, rhoH2O);
+        isothermalH2OViscosity_.setXYContainers(pressures, muH2O);
+
+        isothermalVaporPressure_ = IapwsH2O::vaporPressure(temperature);
+        isothermalHenry_ = Opm::BinaryCoeff::H2O_N2::henry(temperature);
+        isothermalH2OGasViscosity_ = IapwsH2O::gasViscosity(temperature, isothermalVaporPressure_);
+        isothermalTemperature_ = temperature;
+        isothermal_ = true;
     }
 
+    /*!
+     * \brief Switch back to the temperature dependent relations after initIsothermal().
+     */
+    static void disableIsothermal()
+    { isothermal_ = false; }
+
     /*!
      * \copydoc BaseFluidSystem::density
      *
@@ -281,13 +341,17 @@ public:
 
         // liquid phase
         if (phaseIdx == liquidPhaseIdx) {
+            const LhsEval& rholH2O =
+                useIsothermalTables_(fluidState, phaseIdx)
+                ? isothermalH2ODensity_.eval(p, /*extrapolate=*/true)
+                : paramCache.liquidDensity(phaseIdx, T, p);
+
             if (!useComplexRelations)
                 // assume pure water
-                return H2O::liquidDensity(T, p);
+                return rholH2O;
             else
             {
                 // See: Ochs 2008
-                const auto& rholH2O = H2O::liquidDensity(T, p);
                 const auto& clH2O = rholH2O/H2O::molarMass();
 
                 const auto& xlH2O = FsToolbox::template toLhs<LhsEval>(fluidState.moleFraction(liquidPhaseIdx, H2OIdx));
@@ -332,10 +396,15 @@ public:
         const auto& T = FsToolbox::template toLhs<LhsEval>(fluidState.temperature(phaseIdx));
         const auto& p = FsToolbox::template toLhs<LhsEval>(fluidState.pressure(phaseIdx));
 
+        bool isothermal = useIsothermalTables_(fluidState, phaseIdx);
+
         // liquid phase
         if (phaseIdx == liquidPhaseIdx)
             // assume pure water for the liquid phase
-            return H2O::liquidViscosity(T, p);
+            return
+                isothermal
+                ? isothermalH2OViscosity_.eval(p, /*extrapolate=*/true)
+                : paramCache.liquidViscosity(phaseIdx, T, p);
 
         // gas phase
         assert(phaseIdx == gasPhaseIdx);
@@ -352,7 +421,9 @@ public:
              */
             LhsEval muResult = 0;
             const LhsEval mu[numComponents] = {
-                H2O::gasViscosity(T, H2O::vaporPressure(T)),
+                isothermal
+                ? LhsToolbox::createConstant(isothermalH2OGasViscosity_)
+                : paramCache.saturatedGasViscosity(phaseIdx, T),
                 N2::gasViscosity(T, p)
             };
 
@@ -396,8 +467,14 @@ public:
 
         // liquid phase
         if (phaseIdx == liquidPhaseIdx) {
+            if (useIsothermalTables_(fluidState, phaseIdx)) {
+                if (compIdx == H2OIdx)
+                    return isothermalVaporPressure_/p;
+                return isothermalHenry_/p;
+            }
+
             if (compIdx == H2OIdx)
-                return H2O::vaporPressure(T)/p;
+                return paramCache.vaporPressure(phaseIdx, T)/p;
             return Opm::BinaryCoeff::H2O_N2::henry(T)/p;
         }
 
@@ -446,7 +523,7 @@ public:
         // liquid phase
         if (phaseIdx == liquidPhaseIdx) {
             // TODO: correct way to deal with the solutes???
-            return H2O::liquidEnthalpy(T, p);
+            return paramCache.liquidEnthalpy(phaseIdx, T, p);
         }
 
         // gas phase
@@ -459,7 +536,7 @@ public:
         const auto& XgH2O = FsToolbox::template toLhs<LhsEval>(fluidState.massFraction(gasPhaseIdx, H2OIdx));
         const auto& XgN2 = FsToolbox::template toLhs<LhsEval>(fluidState.massFraction(gasPhaseIdx, N2Idx));
 
-        LhsEval hH2O = XgH2O*H2O::gasEnthalpy(T, p);
+        LhsEval hH2O = XgH2O*paramCache.gasEnthalpy(phaseIdx, T, p);
         LhsEval hN2 = XgN2*N2::gasEnthalpy(T, p);
         return hH2O + hN2;
     }
@@ -547,8 +624,42 @@ public:
         // interaction" between both flavors of molecules.
         return XAlphaH2O*c_pH2O + XAlphaN2*c_pN2;
     }
+
+private:
+    template <class FluidState>
+    static bool useIsothermalTables_(const FluidState& fluidState, int phaseIdx)
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        return
+            isothermal_
+            && FsToolbox::value(fluidState.temperature(phaseIdx)) == isothermalTemperature_;
+    }
+
+    static bool isothermal_;
+    static Scalar isothermalTemperature_;
+    static Scalar isothermalVaporPressure_;
+    static Scalar isothermalHenry_;
+    static Scalar isothermalH2OGasViscosity_;
+    static Opm::Tabulated1DFunction<Scalar> isothermalH2ODensity_;
+    static Opm::Tabulated1DFunction<Scalar> isothermalH2OViscosity_;
 };
 
+template <class Scalar, bool useComplexRelations>
+bool H2ON2<Scalar, useComplexRelations>::isothermal_ = false;
+template <class Scalar, bool useComplexRelations>
+Scalar H2ON2<Scalar, useComplexRelations>::isothermalTemperature_;
+template <class Scalar, bool useComplexRelations>
+Scalar H2ON2<Scalar, useComplexRelations>::isothermalVaporPressure_;
+template <class Scalar, bool useComplexRelations>
+Scalar H2ON2<Scalar, useComplexRelations>::isothermalHenry_;
+template <class Scalar, bool useComplexRelations>
+Scalar H2ON2<Scalar, useComplexRelations>::isothermalH2OGasViscosity_;
+template <class Scalar, bool useComplexRelations>
+Opm::Tabulated1DFunction<Scalar> H2ON2<Scalar, useComplexRelations>::isothermalH2ODensity_;
+template <class Scalar, bool useComplexRelations>
+Opm::Tabulated1DFunction<Scalar> H2ON2<Scalar, useComplexRelations>::isothermalH2OViscosity_;
+
 } // namespace FluidSystems
 
 } // namespace Opm
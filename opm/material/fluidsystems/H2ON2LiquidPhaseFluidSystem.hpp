@@ -240,10 +240,16 @@ public:
     static void init(Scalar tempMin, Scalar tempMax, unsigned nTemp,
                      Scalar pressMin, Scalar pressMax, unsigned nPress)
     {
+        // the saturation curve of water is also used while tabulating the water
+        // component, so it is tabulated first
+        IapwsH2O::tabulateSaturationCurve();
+
         if (H2O::isTabulated) {
             TabulatedH2O::init(tempMin, tempMax, nTemp,
                                pressMin, pressMax, nPress);
         }
+        // the Henry coefficient only depends on temperature
+        Opm::BinaryCoeff::H2O_N2::tabulate(tempMin, tempMax, nTemp);
     }
 
     //! \copydoc BaseFluidSystem::density
@@ -0,0 +1,217 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::H2OParameterCache
+ */
+#ifndef OPM_H2O_PARAMETER_CACHE_HPP
+#define OPM_H2O_PARAMETER_CACHE_HPP
+
+#include "ParameterCacheBase.hpp"
+
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+
+#include <cassert>
+#include <limits>
+#include <type_traits>
+
+namespace Opm {
+
+/*!
+ * \ingroup Fluidsystems
+ * \brief A parameter cache which stores the properties of the water component
+ *        for each fluid phase.
+ *
+ * The fluid systems which use water as a component evaluate the same pure water
+ * relations for most of the phase properties, e.g., the liquid density for the
+ * density, and the vapor pressure for the fugacity coefficients. Since the relations
+ * for water are expensive, this cache stores them per phase: A quantity is only
+ * re-calculated if it is requested for a temperature or pressure which differs from
+ * the one for which it was calculated last. This means that the update*() methods do
+ * not need to do anything and all quantities are only calculated on demand.
+ *
+ * Besides the values, the partial derivatives with regard to temperature and
+ * pressure are stored if the quantity is requested for a function evaluation. The
+ * derivatives of the result are then obtained using the chain rule.
+ *
+ * \tparam Scalar The type used for scalar values
+ * \tparam FluidSystem The fluid system. It must provide the water component as H2O.
+ */
+template <class Scalar, class FluidSystem>
+class H2OParameterCache
+    : public Opm::ParameterCacheBase<H2OParameterCache<Scalar, FluidSystem> >
+{
+    typedef H2OParameterCache<Scalar, FluidSystem> ThisType;
+    typedef Opm::ParameterCacheBase<ThisType> ParentType;
+
+    typedef typename FluidSystem::H2O H2O;
+
+    // evaluations w.r.t. temperature and pressure
+    typedef Opm::LocalAd::Evaluation<Scalar, ThisType, 2> TpEvaluation;
+
+    enum { numPhases = FluidSystem::numPhases };
+
+    enum {
+        liquidDensityIdx,
+        liquidViscosityIdx,
+        liquidEnthalpyIdx,
+        gasEnthalpyIdx,
+        vaporPressureIdx,
+        saturatedGasViscosityIdx,
+        numQuantities
+    };
+
+    struct Entry
+    {
+        Scalar temperature;
+        Scalar pressure;
+        Scalar value;
+        Scalar dT;
+        Scalar dp;
+        bool hasDerivatives;
+    };
+
+public:
+    H2OParameterCache()
+    {
+        const Scalar NaN = std::numeric_limits<Scalar>::quiet_NaN();
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            for (int qIdx = 0; qIdx < numQuantities; ++qIdx) {
+                // NaN never compares equal, so all quantities are calculated when
+                // they are requested for the first time
+                entries_[phaseIdx][qIdx].temperature = NaN;
+                entries_[phaseIdx][qIdx].pressure = NaN;
+                entries_[phaseIdx][qIdx].hasDerivatives = false;
+            }
+        }
+    }
+
+    /*!
+     * \brief Returns the density of liquid water at the conditions of a phase [kg/m^3]
+     */
+    template <class LhsEval>
+    LhsEval liquidDensity(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, liquidDensityIdx, temperature, pressure); }
+
+    /*!
+     * \brief Returns the viscosity of liquid water at the conditions of a phase [Pa s]
+     */
+    template <class LhsEval>
+    LhsEval liquidViscosity(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, liquidViscosityIdx, temperature, pressure); }
+
+    /*!
+     * \brief Returns the specific enthalpy of liquid water at the conditions of a phase [J/kg]
+     */
+    template <class LhsEval>
+    LhsEval liquidEnthalpy(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, liquidEnthalpyIdx, temperature, pressure); }
+
+    /*!
+     * \brief Returns the specific enthalpy of steam at the conditions of a phase [J/kg]
+     */
+    template <class LhsEval>
+    LhsEval gasEnthalpy(int phaseIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    { return quantity_(phaseIdx, gasEnthalpyIdx, temperature, pressure); }
+
+    /*!
+     * \brief Returns the vapor pressure of water at the temperature of a phase [Pa]
+     */
+    template <class LhsEval>
+    LhsEval vaporPressure(int phaseIdx, const LhsEval& temperature) const
+    { return quantity_(phaseIdx, vaporPressureIdx, temperature, LhsEval(0.0)); }
+
+    /*!
+     * \brief Returns the viscosity of steam at the temperature of a phase and the
+     *        vapor pressure [Pa s]
+     */
+    template <class LhsEval>
+    LhsEval saturatedGasViscosity(int phaseIdx, const LhsEval& temperature) const
+    { return quantity_(phaseIdx, saturatedGasViscosityIdx, temperature, LhsEval(0.0)); }
+
+private:
+    template <class LhsEval>
+    LhsEval quantity_(int phaseIdx, int qIdx, const LhsEval& temperature, const LhsEval& pressure) const
+    {
+        typedef Opm::MathToolbox<LhsEval> Toolbox;
+
+        const bool needDerivatives = !std::is_same<LhsEval, Scalar>::value;
+        Scalar T = Toolbox::value(temperature);
+        Scalar p = Toolbox::value(pressure);
+
+        Entry& entry = entries_[phaseIdx][qIdx];
+        if (!(entry.temperature == T && entry.pressure == p)
+            || (needDerivatives && !entry.hasDerivatives))
+            update_(entry, qIdx, T, p, needDerivatives);
+
+        return entry.value + entry.dT*(temperature - T) + entry.dp*(pressure - p);
+    }
+
+    void update_(Entry& entry, int qIdx, Scalar T, Scalar p, bool needDerivatives) const
+    {
+        if (needDerivatives) {
+            const TpEvaluation& result =
+                calculate_(qIdx,
+                           TpEvaluation::createVariable(T, 0),
+                           TpEvaluation::createVariable(p, 1));
+            entry.value = result.value;
+            entry.dT = result.derivatives[0];
+            entry.dp = result.derivatives[1];
+        }
+        else {
+            entry.value = calculate_(qIdx, T, p);
+            entry.dT = 0.0;
+            entry.dp = 0.0;
+        }
+
+        entry.temperature = T;
+        entry.pressure = p;
+        entry.hasDerivatives = needDerivatives;
+    }
+
+    template <class Evaluation>
+    static Evaluation calculate_(int qIdx, const Evaluation& T, const Evaluation& p)
+    {
+        switch (qIdx) {
+        case liquidDensityIdx:
+            return H2O::liquidDensity(T, p);
+        case liquidViscosityIdx:
+            return H2O::liquidViscosity(T, p);
+        case liquidEnthalpyIdx:
+            return H2O::liquidEnthalpy(T, p);
+        case gasEnthalpyIdx:
+            return H2O::gasEnthalpy(T, p);
+        case vaporPressureIdx:
+            return H2O::vaporPressure(T);
+        default:
+            assert(qIdx == saturatedGasViscosityIdx);
+            return H2O::gasViscosity(T, H2O::vaporPressure(T));
+        }
+    }
+
+    mutable Entry entries_[numPhases][numQuantities];
+};
+
+} // namespace Opm
+
+#endif
@@ -179,6 +179,27 @@ public:
     static void init()
     { }
 
+    /*!
+     * \copydoc BaseFluidSystem::densityDependencies
+     *
+     * The phases consist of a single component, so their properties never depend on
+     * the composition.
+     */
+    static unsigned densityDependencies(int phaseIdx)
+    { return Base::PressureDependency | Base::TemperatureDependency; }
+
+    //! \copydoc densityDependencies
+    static unsigned viscosityDependencies(int phaseIdx)
+    { return Base::PressureDependency | Base::TemperatureDependency; }
+
+    //! \copydoc densityDependencies
+    static unsigned enthalpyDependencies(int phaseIdx)
+    { return Base::PressureDependency | Base::TemperatureDependency; }
+
+    //! The fugacity coefficients are constant
+    static unsigned fugacityCoefficientDependencies(int phaseIdx, int compIdx)
+    { return 0; }
+
     //! \copydoc BaseFluidSystem::density
     template <class FluidState, class LhsEval = typename FluidState::Scalar>
     static LhsEval density(const FluidState &fluidState,
@@ -166,19 +166,7 @@ public:
         return
             (compIdx == H2OIdx)
             ? H2O::molarMass()
-            : (compIdx == C1Idx)
-            ? 16.04e-3
-            : (compIdx == C3Idx)
-            ? 44.10e-3
-            : (compIdx == C6Idx)
-            ? 86.18e-3
-            : (compIdx == C10Idx)
-            ? 142.29e-3
-            : (compIdx == C15Idx)
-            ? 206.00e-3
-            : (compIdx == C20Idx)
-            ? 282.00e-3
-            : 1e100;
+            : molarMass_[compIdx - C1Idx];
     }
 
     /*!
@@ -189,19 +177,7 @@ public:
         return
             (compIdx == H2OIdx)
             ? H2O::criticalTemperature()
-            : (compIdx == C1Idx)
-            ? 343.0*5/9
-            : (compIdx == C3Idx)
-            ? 665.7*5/9
-            : (compIdx == C6Idx)
-            ? 913.4*5/9
-            : (compIdx == C10Idx)
-            ? 1111.8*5/9
-            : (compIdx == C15Idx)
-            ? 1270.0*5/9
-            : (compIdx == C20Idx)
-            ? 1380.0*5/9
-            : 1e100;
+            : criticalTemperature_[compIdx - C1Idx];
     }
 
     /*!
@@ -212,19 +188,7 @@ public:
         return
             (compIdx == H2OIdx)
             ? H2O::criticalPressure()
-            : (compIdx == C1Idx)
-            ? 667.8 * 6894.7573
-            : (compIdx == C3Idx)
-            ? 616.3 * 6894.7573
-            : (compIdx == C6Idx)
-            ? 436.9 * 6894.7573
-            : (compIdx == C10Idx)
-            ? 304.0 * 6894.7573
-            : (compIdx == C15Idx)
-            ? 200.0 * 6894.7573
-            : (compIdx == C20Idx)
-            ? 162.0 * 6894.7573
-            : 1e100;
+            : criticalPressure_[compIdx - C1Idx];
     }
 
     /*!
@@ -235,19 +199,9 @@ public:
         return
             (compIdx == H2OIdx)
             ? H2O::criticalMolarVolume()
-            : (compIdx == C1Idx)
-            ? 0.290*R*criticalTemperature(C1Idx)/criticalPressure(C1Idx)
-            : (compIdx == C3Idx)
-            ? 0.277*R*criticalTemperature(C3Idx)/criticalPressure(C3Idx)
-            : (compIdx == C6Idx)
-            ? 0.264*R*criticalTemperature(C6Idx)/criticalPressure(C6Idx)
-            : (compIdx == C10Idx)
-            ? 0.257*R*criticalTemperature(C10Idx)/criticalPressure(C10Idx)
-            : (compIdx == C15Idx)
-            ? 0.245*R*criticalTemperature(C15Idx)/criticalPressure(C15Idx)
-            : (compIdx == C20Idx)
-            ? 0.235*R*criticalTemperature(C20Idx)/criticalPressure(C20Idx)
-            : 1e100;
+            : criticalCompressibility_[compIdx - C1Idx]*R
+            * criticalTemperature_[compIdx - C1Idx]
+            / criticalPressure_[compIdx - C1Idx];
     }
 
     /*!
@@ -258,19 +212,7 @@ public:
         return
             (compIdx == H2OIdx)
             ? H2O::acentricFactor()
-            : (compIdx == C1Idx)
-            ? 0.0130
-            : (compIdx == C3Idx)
-            ? 0.1524
-            : (compIdx == C6Idx)
-            ? 0.3007
-            : (compIdx == C10Idx)
-            ? 0.4885
-            : (compIdx == C15Idx)
-            ? 0.6500
-            : (compIdx == C20Idx)
-            ? 0.8500
-            : 1e100;
+            : acentricFactor_[compIdx - C1Idx];
     }
 
     /*!
@@ -279,15 +221,7 @@ public:
      * The values are given by the SPE5 paper.
      */
     static Scalar interactionCoefficient(int comp1Idx, int comp2Idx)
-    {
-        int i = std::min(comp1Idx, comp2Idx);
-        int j = std::max(comp1Idx, comp2Idx);
-        if (i == C1Idx && (j == C15Idx || j == C20Idx))
-            return 0.05;
-        else if (i == C3Idx && (j == C15Idx || j == C20Idx))
-            return 0.005;
-        return 0;
-    }
+    { return interactionCoefficients_[comp1Idx][comp2Idx]; }
 
     /****************************************
      * Methods which compute stuff
@@ -349,8 +283,11 @@ public:
             maxB = std::max(prParams.pureParams(compIdx).b(), maxB);
         };
 
+        // the critical points are only required for very few fluid states, so we
+        // only tabulate the parts of the table which are actually used
         PengRobinson::init(/*aMin=*/minA, /*aMax=*/maxA, /*na=*/100,
-                           /*bMin=*/minB, /*bMax=*/maxB, /*nb=*/200);
+                           /*bMin=*/minB, /*bMax=*/maxB, /*nb=*/200,
+                           /*lazy=*/true);
     }
 
     //! \copydoc BaseFluidSystem::density
@@ -417,7 +354,57 @@ public:
         }
     }
 
+    //! \copydoc BaseFluidSystem::fugacityCoefficients
+    template <class FluidState>
+    static void fugacityCoefficients(const FluidState &fluidState,
+                                     const ParameterCache &paramCache,
+                                     int phaseIdx,
+                                     Scalar *fugCoeffs)
+    {
+        assert(0 <= phaseIdx  && phaseIdx <= numPhases);
+
+        if (phaseIdx == oilPhaseIdx || phaseIdx == gasPhaseIdx)
+            PengRobinsonMixture::computeFugacityCoefficients(fluidState,
+                                                             paramCache,
+                                                             phaseIdx,
+                                                             fugCoeffs);
+        else {
+            assert(phaseIdx == waterPhaseIdx);
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                fugCoeffs[compIdx] =
+                    henryCoeffWater_(compIdx, fluidState.temperature(waterPhaseIdx))
+                    / fluidState.pressure(waterPhaseIdx);
+        }
+    }
+
 protected:
+    // the properties of the hydrocarbons, indexed by compIdx - C1Idx. they are
+    // compile-time constants so that the compiler can fold them into the equation of
+    // state.
+    static constexpr Scalar molarMass_[numComponents - 1] =
+    { 16.04e-3, 44.10e-3, 86.18e-3, 142.29e-3, 206.00e-3, 282.00e-3 };
+    static constexpr Scalar criticalTemperature_[numComponents - 1] =
+    { 343.0*5/9, 665.7*5/9, 913.4*5/9, 1111.8*5/9, 1270.0*5/9, 1380.0*5/9 };
+    static constexpr Scalar criticalPressure_[numComponents - 1] =
+    { 667.8*6894.7573, 616.3*6894.7573, 436.9*6894.7573,
+      304.0*6894.7573, 200.0*6894.7573, 162.0*6894.7573 };
+    static constexpr Scalar criticalCompressibility_[numComponents - 1] =
+    { 0.290, 0.277, 0.264, 0.257, 0.245, 0.235 };
+    static constexpr Scalar acentricFactor_[numComponents - 1] =
+    { 0.0130, 0.1524, 0.3007, 0.4885, 0.6500, 0.8500 };
+
+    // the binary interaction coefficients of the Peng-Robinson EOS
+    static constexpr Scalar interactionCoefficients_[numComponents][numComponents] = {
+        //  H2O    C1     C3     C6     C10    C15    C20
+        {   0,     0,     0,     0,     0,     0,     0     }, // H2O
+        {   0,     0,     0,     0,     0,     0.05,  0.05  }, // C1
+        {   0,     0,     0,     0,     0,     0.005, 0.005 }, // C3
+        {   0,     0,     0,     0,     0,     0,     0     }, // C6
+        {   0,     0,     0,     0,     0,     0,     0     }, // C10
+        {   0,     0.05,  0.005, 0,     0,     0,     0     }, // C15
+        {   0,     0.05,  0.005, 0,     0,     0,     0     }  // C20
+    };
+
     static Scalar henryCoeffWater_(int compIdx, Scalar temperature)
     {
         // use henry's law for the solutes and the vapor pressure for
@@ -441,6 +428,19 @@ protected:
 template <class Scalar>
 const Scalar Spe5<Scalar>::R = Opm::Constants<Scalar>::R;
 
+template <class Scalar>
+constexpr Scalar Spe5<Scalar>::molarMass_[Spe5<Scalar>::numComponents - 1];
+template <class Scalar>
+constexpr Scalar Spe5<Scalar>::criticalTemperature_[Spe5<Scalar>::numComponents - 1];
+template <class Scalar>
+constexpr Scalar Spe5<Scalar>::criticalPressure_[Spe5<Scalar>::numComponents - 1];
+template <class Scalar>
+constexpr Scalar Spe5<Scalar>::criticalCompressibility_[Spe5<Scalar>::numComponents - 1];
+template <class Scalar>
+constexpr Scalar Spe5<Scalar>::acentricFactor_[Spe5<Scalar>::numComponents - 1];
+template <class Scalar>
+constexpr Scalar Spe5<Scalar>::interactionCoefficients_[Spe5<Scalar>::numComponents][Spe5<Scalar>::numComponents];
+
 } // namespace FluidSystems
 } // namespace Opm
 
@@ -26,6 +26,7 @@
 #define OPM_SPE5_PARAMETER_CACHE_HPP
 
 #include <cassert>
+#include <limits>
 
 #include <opm/material/components/H2O.hpp>
 #include <opm/material/fluidsystems/ParameterCacheBase.hpp>
@@ -49,6 +50,7 @@ class Spe5ParameterCache
     typedef Opm::PengRobinson<Scalar> PengRobinson;
 
     enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
 
     enum { waterPhaseIdx = FluidSystem::waterPhaseIdx };
     enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
@@ -62,10 +64,19 @@ public:
 
     Spe5ParameterCache()
     {
+        const Scalar NaN = std::numeric_limits<Scalar>::quiet_NaN();
         for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             VmUpToDate_[phaseIdx] = false;
             Valgrind::SetUndefined(Vm_[phaseIdx]);
+
+            // NaN never compares equal, so the first update is never skipped
+            cachedTemperature_[phaseIdx] = NaN;
+            cachedPressure_[phaseIdx] = NaN;
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                cachedMoleFraction_[phaseIdx][compIdx] = NaN;
         }
+
+        resetStatistics();
     }
 
     //! \copydoc ParameterCacheBase::updatePhase
@@ -97,9 +108,41 @@ public:
             gasPhaseParams_.updateSingleMoleFraction(fluidState, compIdx);
 
         // update the phase's molar volume
+        cachedMoleFraction_[phaseIdx][compIdx] = fluidState.moleFraction(phaseIdx, compIdx);
         updateMolarVolume_(fluidState, phaseIdx);
     }
 
+    /*!
+     * \brief Returns the number of updates of the temperature dependent parameters
+     *        which were skipped because the temperature did not change.
+     */
+    unsigned long numSkippedTemperatureUpdates() const
+    { return numSkippedTemperatureUpdates_; }
+
+    /*!
+     * \brief Returns the number of updates of the mixing rule which were skipped
+     *        because neither the temperature nor the composition changed.
+     */
+    unsigned long numSkippedCompositionUpdates() const
+    { return numSkippedCompositionUpdates_; }
+
+    /*!
+     * \brief Returns the number of molar volume computations which were skipped
+     *        because none of the quantities of the phase changed.
+     */
+    unsigned long numSkippedMolarVolumeUpdates() const
+    { return numSkippedMolarVolumeUpdates_; }
+
+    /*!
+     * \brief Set the counters for the skipped updates to zero.
+     */
+    void resetStatistics()
+    {
+        numSkippedTemperatureUpdates_ = 0;
+        numSkippedCompositionUpdates_ = 0;
+        numSkippedMolarVolumeUpdates_ = 0;
+    }
+
     /*!
      * \brief The Peng-Robinson attractive parameter for a phase.
      *
@@ -204,6 +247,11 @@ public:
      * \brief Update all parameters required by the equation of state to
      *        calculate some quantities for the phase.
      *
+     * Besides the quantities which are excluded by the caller, the quantities which
+     * did not change since the last update are detected by comparing them to the
+     * values that were used for the last update. This means that no EOS work is done
+     * if e.g., only the saturations of the fluid state were modified.
+     *
      * \param fluidState The representation of the thermodynamic system of interest.
      * \param phaseIdx The index of the fluid phase of interest.
      * \param exceptQuantities The quantities of the fluid state that have not changed since the last update.
@@ -213,20 +261,35 @@ public:
                          int phaseIdx,
                          int exceptQuantities = ParentType::None)
     {
-        if (!(exceptQuantities & ParentType::Temperature))
-        {
+        bool temperatureChanged =
+            !(exceptQuantities & ParentType::Temperature)
+            && temperatureChanged_(fluidState, phaseIdx);
+        bool compositionChanged =
+            !(exceptQuantities & ParentType::Composition)
+            && compositionChanged_(fluidState, phaseIdx);
+        bool pressureChanged =
+            !(exceptQuantities & ParentType::Pressure)
+            && pressureChanged_(fluidState, phaseIdx);
+
+        if (temperatureChanged) {
             updatePure_(fluidState, phaseIdx);
             updateMix_(fluidState, phaseIdx);
             VmUpToDate_[phaseIdx] = false;
         }
-        else if (!(exceptQuantities & ParentType::Composition))
-        {
+        else if (compositionChanged) {
+            ++ numSkippedTemperatureUpdates_;
             updateMix_(fluidState, phaseIdx);
             VmUpToDate_[phaseIdx] = false;
         }
-        else if (!(exceptQuantities & ParentType::Pressure)) {
-            VmUpToDate_[phaseIdx] = false;
+        else {
+            ++ numSkippedTemperatureUpdates_;
+            ++ numSkippedCompositionUpdates_;
+            if (pressureChanged)
+                VmUpToDate_[phaseIdx] = false;
         }
+
+        if (VmUpToDate_[phaseIdx])
+            ++ numSkippedMolarVolumeUpdates_;
     }
 
 protected:
@@ -236,11 +299,29 @@ protected:
      *
      * This usually means the parameters for the pure components.
      */
+    template <class FluidState>
+    bool temperatureChanged_(const FluidState &fluidState, int phaseIdx) const
+    { return fluidState.temperature(phaseIdx) != cachedTemperature_[phaseIdx]; }
+
+    template <class FluidState>
+    bool pressureChanged_(const FluidState &fluidState, int phaseIdx) const
+    { return fluidState.pressure(phaseIdx) != cachedPressure_[phaseIdx]; }
+
+    template <class FluidState>
+    bool compositionChanged_(const FluidState &fluidState, int phaseIdx) const
+    {
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            if (fluidState.moleFraction(phaseIdx, compIdx) != cachedMoleFraction_[phaseIdx][compIdx])
+                return true;
+        return false;
+    }
+
     template <class FluidState>
     void updatePure_(const FluidState &fluidState, int phaseIdx)
     {
         Scalar T = fluidState.temperature(phaseIdx);
         Scalar p = fluidState.pressure(phaseIdx);
+        cachedTemperature_[phaseIdx] = T;
 
         switch (phaseIdx)
         {
@@ -261,6 +342,9 @@ protected:
     void updateMix_(const FluidState &fluidState, int phaseIdx)
     {
         Valgrind::CheckDefined(fluidState.averageMolarMass(phaseIdx));
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            cachedMoleFraction_[phaseIdx][compIdx] = fluidState.moleFraction(phaseIdx, compIdx);
+
         switch (phaseIdx)
         {
         case oilPhaseIdx:
@@ -279,6 +363,7 @@ protected:
                             int phaseIdx)
     {
         VmUpToDate_[phaseIdx] = true;
+        cachedPressure_[phaseIdx] = fluidState.pressure(phaseIdx);
 
         // calculate molar volume of the phase (we will need this for the
         // fugacity coefficients and the density anyway)
@@ -294,6 +379,7 @@ protected:
                                                  *this,
                                                  phaseIdx,
                                                  /*isGasPhase=*/true);
+            break;
         }
         case oilPhaseIdx: {
             // calculate molar volumes for the given composition. although
@@ -306,7 +392,7 @@ protected:
                                                  *this,
                                                  phaseIdx,
                                                  /*isGasPhase=*/false);
-
+            break;
         }
         case waterPhaseIdx: {
             // Density of water in the stock tank (i.e. atmospheric
@@ -328,6 +414,15 @@ protected:
     bool VmUpToDate_[numPhases];
     Scalar Vm_[numPhases];
 
+    // the quantities of the fluid state which were used for the last update
+    Scalar cachedTemperature_[numPhases];
+    Scalar cachedPressure_[numPhases];
+    Scalar cachedMoleFraction_[numPhases][numComponents];
+
+    unsigned long numSkippedTemperatureUpdates_;
+    unsigned long numSkippedCompositionUpdates_;
+    unsigned long numSkippedMolarVolumeUpdates_;
+
     OilPhaseParams oilPhaseParams_;
     GasPhaseParams gasPhaseParams_;
 };
@@ -217,6 +217,27 @@ public:
         assert(WettingPhase::isLiquid() || NonwettingPhase::isLiquid());
     }
 
+    /*!
+     * \copydoc BaseFluidSystem::densityDependencies
+     *
+     * The phases consist of a single component, so their properties never depend on
+     * the composition.
+     */
+    static unsigned densityDependencies(int phaseIdx)
+    { return Base::PressureDependency | Base::TemperatureDependency; }
+
+    //! \copydoc densityDependencies
+    static unsigned viscosityDependencies(int phaseIdx)
+    { return Base::PressureDependency | Base::TemperatureDependency; }
+
+    //! \copydoc densityDependencies
+    static unsigned enthalpyDependencies(int phaseIdx)
+    { return Base::PressureDependency | Base::TemperatureDependency; }
+
+    //! The fugacity coefficients are constant
+    static unsigned fugacityCoefficientDependencies(int phaseIdx, int compIdx)
+    { return 0; }
+
     //! \copydoc BaseFluidSystem::density
     template <class FluidState, class LhsEval = typename FluidState::Scalar>
     static LhsEval density(const FluidState &fluidState,
@@ -0,0 +1,73 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::BlackOilPhaseProperties
+ */
+#ifndef OPM_BLACK_OIL_PHASE_PROPERTIES_HPP
+#define OPM_BLACK_OIL_PHASE_PROPERTIES_HPP
+
+namespace Opm {
+/*!
+ * \brief The PVT quantities of a fluid phase in the black-oil model which are usually
+ *        required together.
+ *
+ * Objects of this class are returned by the properties() methods of the PVT
+ * classes. Computing these quantities at once is considerably cheaper than calling the
+ * individual methods of the PVT classes, because the table lookups can be shared.
+ */
+template <class Evaluation>
+struct BlackOilPhaseProperties
+{
+    //! The inverse of the formation volume factor \f$b = 1/B\f$ [-]
+    Evaluation invB;
+
+    //! The dynamic viscosity \f$\mu\f$ [Pa s]
+    Evaluation mu;
+
+    //! The inverse of the product of the formation volume factor and the viscosity
+    //! \f$b/\mu\f$ [1/(Pa s)]
+    Evaluation invBMu;
+
+    //! The density [kg/m^3]
+    Evaluation density;
+
+    /*!
+     * \brief The placeholder quantities of a phase which is not present.
+     *
+     * All quantities are constants, i.e., their derivatives are zero. The formation
+     * volume factor is infinite and the viscosity is one, so that the quantities are
+     * consistent with each other and a phase mobility which is derived from them is
+     * zero.
+     */
+    static BlackOilPhaseProperties absentPhase()
+    {
+        BlackOilPhaseProperties result;
+        result.invB = 0.0;
+        result.mu = 1.0;
+        result.invBMu = 0.0;
+        result.density = 0.0;
+        return result;
+    }
+};
+} // namespace Opm
+
+#endif
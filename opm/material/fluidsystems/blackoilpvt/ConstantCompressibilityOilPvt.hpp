@@ -26,6 +26,7 @@
 #define OPM_CONSTANT_COMPRESSIBILITY_OIL_PVT_HPP
 
 #include "OilPvtInterface.hpp"
+#include "PvtReferenceDensities.hpp"
 
 #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
 
@@ -52,6 +53,7 @@ class ConstantCompressibilityOilPvt  : public OilPvtInterfaceTemplateWrapper<Sca
     friend class OilPvtInterfaceTemplateWrapper<Scalar,
                                                 Evaluation,
                                                 ConstantCompressibilityOilPvt<Scalar, Evaluation> >;
+    friend class OilPvtMultiplexer<Scalar, Evaluation>;
 
     typedef FluidSystems::BlackOil<Scalar, Evaluation> BlackOilFluidSystem;
 
@@ -137,6 +139,18 @@ public:
     void setViscosibility(int regionIdx, Scalar muComp)
     { oilViscosibility_[regionIdx] = muComp; }
 
+    /*!
+     * \brief Set the reference densities which are used by this object.
+     *
+     * This is only required if the object is used by a black-oil fluid system
+     * instance which is not the default one.
+     */
+    void setReferenceDensities(Scalar rhoOil,
+                               Scalar rhoWater,
+                               Scalar rhoGas,
+                               int regionIdx)
+    { referenceDensities_.setReferenceDensities(rhoOil, rhoWater, rhoGas, regionIdx); }
+
     /*!
      * \brief Finish initializing the oil phase PVT properties.
      */
@@ -176,10 +190,38 @@ private:
                      const LhsEval& XoG) const
     {
         const LhsEval& Bo = formationVolumeFactor_(regionIdx, temperature, pressure, XoG);
-        Scalar rhooRef = BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx);
+        Scalar rhooRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
         return rhooRef/Bo;
     }
 
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the fluid phase at once.
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> properties_(int regionIdx,
+                                                 const LhsEval& temperature,
+                                                 const LhsEval& pressure,
+                                                 const LhsEval& XoG) const
+    {
+        Scalar pRef = oilReferencePressure_[regionIdx];
+        Scalar BoRef = oilReferenceFormationVolumeFactor_[regionIdx];
+        Scalar BoMuoRef = oilViscosity_[regionIdx]*BoRef;
+
+        const LhsEval& X = oilCompressibility_[regionIdx]*(pressure - pRef);
+        const LhsEval& Y =
+            (oilCompressibility_[regionIdx] - oilViscosibility_[regionIdx])
+            * (pressure - pRef);
+
+        BlackOilPhaseProperties<LhsEval> result;
+        result.invB = (1 + X*(1 + X/2))/BoRef;
+        result.invBMu = (1 + Y*(1 + Y/2))/BoMuoRef;
+        result.mu = result.invB/result.invBMu;
+        result.density = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx)*result.invB;
+
+        return result;
+    }
+
     /*!
      * \brief Returns the formation volume factor [-] of the fluid phase.
      */
@@ -280,8 +322,22 @@ private:
     std::vector<Scalar> oilCompressibility_;
     std::vector<Scalar> oilViscosity_;
     std::vector<Scalar> oilViscosibility_;
+
+    PvtReferenceDensities<Scalar, BlackOilFluidSystem> referenceDensities_;
 };
 
 } // namespace Opm
 
+// the instantiations which are provided by the library, cf. ExplicitInstantiations.hpp
+#define OPM_CONSTANT_COMPRESSIBILITY_OIL_PVT_INSTANTIATIONS(KEYWORD, Evaluation) \
+    KEYWORD class Opm::OilPvtInterfaceTemplateWrapper<double, Evaluation, \
+                                                      Opm::ConstantCompressibilityOilPvt<double, Evaluation> >; \
+    KEYWORD class Opm::ConstantCompressibilityOilPvt<double, Evaluation>;
+
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+#include <opm/material/common/ExplicitInstantiations.hpp>
+
+OPM_MATERIAL_FOR_EACH_EVALUATION(OPM_CONSTANT_COMPRESSIBILITY_OIL_PVT_INSTANTIATIONS, extern template)
+#endif
+
 #endif
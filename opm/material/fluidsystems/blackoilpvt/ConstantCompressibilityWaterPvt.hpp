@@ -26,6 +26,8 @@
 #define OPM_CONSTANT_COMPRESSIBILITY_WATER_HPP
 
 #include "WaterPvtInterface.hpp"
+#include "PvtReferenceDensities.hpp"
+#include "FlatBlackOilPvt.hpp"
 
 #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
 
@@ -49,6 +51,7 @@ class ConstantCompressibilityWaterPvt
     : public WaterPvtInterfaceTemplateWrapper<Scalar, Evaluation, ConstantCompressibilityWaterPvt<Scalar, Evaluation> >
 {
     friend class WaterPvtInterfaceTemplateWrapper<Scalar, Evaluation, ConstantCompressibilityWaterPvt<Scalar, Evaluation> >;
+    friend class WaterPvtMultiplexer<Scalar, Evaluation>;
 
     typedef FluidSystems::BlackOil<Scalar, Evaluation> BlackOilFluidSystem;
 
@@ -134,12 +137,59 @@ public:
     void setViscosibility(int regionIdx, Scalar muComp)
     { waterViscosibility_[regionIdx] = muComp; }
 
+    /*!
+     * \brief Set the reference densities which are used by this object.
+     *
+     * This is only required if the object is used by a black-oil fluid system
+     * instance which is not the default one.
+     */
+    void setReferenceDensities(Scalar rhoOil,
+                               Scalar rhoWater,
+                               Scalar rhoGas,
+                               int regionIdx)
+    { referenceDensities_.setReferenceDensities(rhoOil, rhoWater, rhoGas, regionIdx); }
+
     /*!
      * \brief Finish initializing the water phase PVT properties.
      */
     void initEnd()
     { }
 
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the water phase together with their
+     *        partial derivatives with regard to pressure.
+     *
+     * The derivatives are calculated in closed form from the same second order Taylor
+     * expansions which are used for the values.
+     *
+     * \param dp Receives the partial derivatives of the returned quantities with regard
+     *           to pressure
+     */
+    BlackOilPhaseProperties<Scalar> propertiesWithPressureDerivatives(int regionIdx,
+                                                                      Scalar temperature,
+                                                                      Scalar pressure,
+                                                                      BlackOilPhaseProperties<Scalar>& dp) const
+    { return flatWaterPvtProperties(flatRegion(regionIdx), pressure, dp); }
+
+    /*!
+     * \brief Returns a pointer-free copy of the PVT relations of a region.
+     *
+     * The result can be evaluated using flatWaterPvtProperties(), e.g., after copying
+     * it to an accelerator.
+     */
+    FlatConstantCompressibilityWaterRegion<Scalar> flatRegion(int regionIdx) const
+    {
+        FlatConstantCompressibilityWaterRegion<Scalar> result;
+        result.referencePressure = waterReferencePressure_[regionIdx];
+        result.referenceFormationVolumeFactor = waterReferenceFormationVolumeFactor_[regionIdx];
+        result.referenceViscosity = waterViscosity_[regionIdx];
+        result.compressibility = waterCompressibility_[regionIdx];
+        result.viscosibility = waterViscosibility_[regionIdx];
+        result.referenceDensity = referenceDensities_.referenceDensity(waterPhaseIdx, regionIdx);
+        return result;
+    }
+
 private:
     /*!
      * \brief Returns the dynamic viscosity [Pa s] of the fluid phase given a set of parameters.
@@ -171,10 +221,37 @@ private:
                      const LhsEval& pressure) const
     {
         const LhsEval& Bw = formationVolumeFactor_(regionIdx, temperature, pressure);
-        Scalar rhowRef = BlackOilFluidSystem::referenceDensity(waterPhaseIdx, regionIdx);
+        Scalar rhowRef = referenceDensities_.referenceDensity(waterPhaseIdx, regionIdx);
         return rhowRef/Bw;
     }
 
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the fluid phase at once.
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> properties_(int regionIdx,
+                                                 const LhsEval& temperature,
+                                                 const LhsEval& pressure) const
+    {
+        Scalar pRef = waterReferencePressure_[regionIdx];
+        Scalar BwRef = waterReferenceFormationVolumeFactor_[regionIdx];
+        Scalar BwMuwRef = waterViscosity_[regionIdx]*BwRef;
+
+        const LhsEval& X = waterCompressibility_[regionIdx]*(pressure - pRef);
+        const LhsEval& Y =
+            (waterCompressibility_[regionIdx] - waterViscosibility_[regionIdx])
+            * (pressure - pRef);
+
+        BlackOilPhaseProperties<LhsEval> result;
+        result.invB = (1 + X*(1 + X/2))/BwRef;
+        result.invBMu = (1 + Y*(1 + Y/2))/BwMuwRef;
+        result.mu = result.invB/result.invBMu;
+        result.density = referenceDensities_.referenceDensity(waterPhaseIdx, regionIdx)*result.invB;
+
+        return result;
+    }
+
     /*!
      * \brief Returns the formation volume factor [-] of the fluid phase.
      */
@@ -222,8 +299,22 @@ private:
     std::vector<Scalar> waterCompressibility_;
     std::vector<Scalar> waterViscosity_;
     std::vector<Scalar> waterViscosibility_;
+
+    PvtReferenceDensities<Scalar, BlackOilFluidSystem> referenceDensities_;
 };
 
 } // namespace Opm
 
+// the instantiations which are provided by the library, cf. ExplicitInstantiations.hpp
+#define OPM_CONSTANT_COMPRESSIBILITY_WATER_PVT_INSTANTIATIONS(KEYWORD, Evaluation) \
+    KEYWORD class Opm::WaterPvtInterfaceTemplateWrapper<double, Evaluation, \
+                                                        Opm::ConstantCompressibilityWaterPvt<double, Evaluation> >; \
+    KEYWORD class Opm::ConstantCompressibilityWaterPvt<double, Evaluation>;
+
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+#include <opm/material/common/ExplicitInstantiations.hpp>
+
+OPM_MATERIAL_FOR_EACH_EVALUATION(OPM_CONSTANT_COMPRESSIBILITY_WATER_PVT_INSTANTIATIONS, extern template)
+#endif
+
 #endif
@@ -26,12 +26,18 @@
 #define OPM_DEAD_OIL_PVT_HPP
 
 #include "OilPvtInterface.hpp"
+#include "PvtReferenceDensities.hpp"
+#include "PvtRegionLoop.hpp"
+#include "FlatBlackOilPvt.hpp"
 
 #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
 
 #include <opm/material/common/OpmFinal.hpp>
+#include <opm/material/common/InterpolationWeights.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
 #include <opm/material/common/UniformXTabulated2DFunction.hpp>
 #include <opm/material/common/Tabulated1DFunction.hpp>
+#include <opm/material/common/TableSimplification.hpp>
 #include <opm/material/common/Spline.hpp>
 
 #if HAVE_OPM_PARSER
@@ -52,6 +58,7 @@ class DeadOilPvt : public OilPvtInterfaceTemplateWrapper<Scalar,
     friend class OilPvtInterfaceTemplateWrapper<Scalar,
                                                 Evaluation,
                                                 DeadOilPvt<Scalar, Evaluation> >;
+    friend class OilPvtMultiplexer<Scalar, Evaluation>;
 
     typedef FluidSystems::BlackOil<Scalar, Evaluation> BlackOilFluidSystem;
 
@@ -67,6 +74,10 @@ class DeadOilPvt : public OilPvtInterfaceTemplateWrapper<Scalar,
     static const int waterCompIdx = BlackOilFluidSystem::waterCompIdx;
 
 public:
+    DeadOilPvt()
+        : tableSimplificationTolerance_(0.0)
+    {}
+
     void setNumRegions(int numRegions)
     {
         if (static_cast<int>(inverseOilB_.size()) < numRegions) {
@@ -98,45 +109,99 @@ public:
     { oilMu_[regionIdx] = muo; }
 
 
+    /*!
+     * \brief Specify the tolerance for removing redundant sampling points from the
+     *        PVDO tables.
+     *
+     * If the tolerance is positive, sampling points are removed as long as no column
+     * of the table deviates from the original one by more than the tolerance times
+     * the largest magnitude of its values (cf. simplifyTable()). The default is zero,
+     * i.e., the tables are used as given. This method must be called before
+     * setPvdoTable() or setPvdoArrays().
+     */
+    void setTableSimplificationTolerance(Scalar tolerance)
+    { tableSimplificationTolerance_ = tolerance; }
+
 #if HAVE_OPM_PARSER
     /*!
      * \brief Initialize the oil parameters via the data specified by the PVDO ECL keyword.
      */
     void setPvdoTable(int regionIdx, const PvdoTable &pvdoTable)
     {
-        assert(pvdoTable.numRows() > 1);
+        std::vector<Scalar> po(pvdoTable.getPressureColumn().begin(),
+                               pvdoTable.getPressureColumn().end());
+        std::vector<Scalar> Bo(pvdoTable.getFormationFactorColumn().begin(),
+                               pvdoTable.getFormationFactorColumn().end());
+        std::vector<Scalar> muo(pvdoTable.getViscosityColumn().begin(),
+                                pvdoTable.getViscosityColumn().end());
+        setPvdoArrays(regionIdx, static_cast<int>(po.size()), po.data(), Bo.data(), muo.data());
+    }
+#endif // HAVE_OPM_PARSER
 
-        const auto& BColumn(pvdoTable.getFormationFactorColumn());
-        std::vector<Scalar> invBColumn(BColumn.size());
-        for (unsigned i = 0; i < invBColumn.size(); ++i)
-            invBColumn[i] = 1/BColumn[i];
+    /*!
+     * \brief Initialize the oil parameters of a region from the columns of a PVDO table.
+     *
+     * This is equivalent to setPvdoTable(), but it does not require opm-parser.
+     *
+     * \param regionIdx The index of the PVT region
+     * \param numRows The number of rows of the table
+     * \param po The oil pressures of the rows in ascending order [Pa]
+     * \param Bo The oil formation volume factors of the rows
+     * \param muo The oil viscosities of the rows [Pa s]
+     */
+    void setPvdoArrays(int regionIdx, int numRows, const Scalar* po, const Scalar* Bo, const Scalar* muo)
+    {
+        assert(numRows > 1);
 
-        inverseOilB_[regionIdx].setXYArrays(pvdoTable.numRows(),
-                                            pvdoTable.getPressureColumn(),
-                                            invBColumn);
-        oilMu_[regionIdx].setXYArrays(pvdoTable.numRows(),
-                                      pvdoTable.getPressureColumn(),
-                                      pvdoTable.getViscosityColumn());
+        std::vector<std::vector<Scalar> > columns(2);
+        auto& invBColumn = columns[0];
+        auto& muColumn = columns[1];
+        invBColumn.resize(numRows);
+        for (int i = 0; i < numRows; ++i)
+            invBColumn[i] = 1/Bo[i];
+        muColumn.assign(muo, muo + numRows);
+
+        std::vector<Scalar> pressureColumn(po, po + numRows);
+        Opm::simplifyTable(pressureColumn, columns, tableSimplificationTolerance_);
 
+        inverseOilB_[regionIdx].setXYArrays(pressureColumn.size(),
+                                            pressureColumn,
+                                            invBColumn);
+        oilMu_[regionIdx].setXYArrays(pressureColumn.size(),
+                                      pressureColumn,
+                                      muColumn);
     }
-#endif // HAVE_OPM_PARSER
+
+    /*!
+     * \brief Set the reference densities which are used by this object.
+     *
+     * This is only required if the object is used by a black-oil fluid system
+     * instance which is not the default one.
+     */
+    void setReferenceDensities(Scalar rhoOil,
+                               Scalar rhoWater,
+                               Scalar rhoGas,
+                               int regionIdx)
+    { referenceDensities_.setReferenceDensities(rhoOil, rhoWater, rhoGas, regionIdx); }
 
     /*!
      * \brief Finish initializing the oil phase PVT properties.
      */
     void initEnd()
     {
+        OPM_PROFILER_RANGE("DeadOilPvt::initEnd");
+
         // calculate the final 2D functions which are used for interpolation.
         int numRegions = oilMu_.size();
-        for (int regionIdx = 0; regionIdx < numRegions; ++ regionIdx) {
+        forEachPvtRegion<Scalar>(numRegions, [&](int regionIdx, PvtRegionWorkspace<Scalar>& workspace) {
             // calculate the table which stores the inverse of the product of the oil
             // formation volume factor and the oil viscosity
             const auto& oilMu = oilMu_[regionIdx];
             const auto& invOilB = inverseOilB_[regionIdx];
             assert(oilMu.numSamples() == invOilB.numSamples());
 
-            std::vector<Scalar> invBMuColumn;
-            std::vector<Scalar> pressureColumn;
+            std::vector<Scalar>& invBMuColumn = workspace.yValues;
+            std::vector<Scalar>& pressureColumn = workspace.xValues;
             invBMuColumn.resize(oilMu.numSamples());
             pressureColumn.resize(oilMu.numSamples());
 
@@ -148,7 +213,95 @@ public:
             inverseOilBMu_[regionIdx].setXYArrays(pressureColumn.size(),
                                                   pressureColumn,
                                                   invBMuColumn);
-        }
+        });
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the oil phase together with their
+     *        partial derivatives with regard to pressure.
+     *
+     * This is cheaper than evaluating properties() using an Evaluation which only
+     * depends on pressure: The tables are piecewise linear and share their sampling
+     * points, so the segment is searched for once and the derivatives are the slopes
+     * of that segment.
+     *
+     * \param dp Receives the partial derivatives of the returned quantities with regard
+     *           to pressure
+     */
+    BlackOilPhaseProperties<Scalar> propertiesWithPressureDerivatives(int regionIdx,
+                                                                      Scalar temperature,
+                                                                      Scalar pressure,
+                                                                      Scalar XoG,
+                                                                      BlackOilPhaseProperties<Scalar>& dp) const
+    {
+        const auto& invB = inverseOilB_[regionIdx];
+        const auto& invBMu = inverseOilBMu_[regionIdx];
+        Scalar rhooRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
+
+        SegmentHint hint;
+        BlackOilPhaseProperties<Scalar> result;
+        result.invB = invB.eval(pressure, hint, /*extrapolate=*/true);
+        result.invBMu = invBMu.eval(pressure, hint, /*extrapolate=*/true);
+        result.mu = result.invB/result.invBMu;
+        result.density = rhooRef*result.invB;
+
+        dp.invB = invB.evalDerivative(pressure, hint, /*extrapolate=*/true);
+        dp.invBMu = invBMu.evalDerivative(pressure, hint, /*extrapolate=*/true);
+        dp.mu = (dp.invB - result.mu*dp.invBMu)/result.invBMu;
+        dp.density = rhooRef*dp.invB;
+
+        return result;
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the oil phase together with the
+     *        weights of the table rows which contribute to them.
+     *
+     * Both tables are sampled at the same pressures, so \f$1/B_o = \sum_k w_k/B_{o,k}\f$
+     * and \f$1/(B_o\mu_o) = \sum_k w_k/(B_{o,k}\mu_{o,k})\f$ where k is the index of a
+     * row of the PVDO table and the \f$w_k\f$ are the weights (cf.
+     * Opm::InterpolationWeights). The partial derivatives of all returned quantities
+     * with regard to the entries of the table thus follow from the chain rule, so all
+     * sensitivities are obtained from a single evaluation. If the table was simplified
+     * (cf. setTableSimplificationTolerance()), the indices refer to the remaining rows.
+     *
+     * \param weights Receives the indices and the weights of the contributing rows
+     */
+    BlackOilPhaseProperties<Scalar> propertiesWithTableWeights(int regionIdx,
+                                                               Scalar /* temperature */,
+                                                               Scalar pressure,
+                                                               Scalar /* XoG */,
+                                                               InterpolationWeights<Scalar, 2>& weights) const
+    {
+        Scalar rhooRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
+
+        InterpolationWeights<Scalar, 2> invBMuWeights;
+        BlackOilPhaseProperties<Scalar> result;
+        result.invB = inverseOilB_[regionIdx].evalWeights(pressure, weights, /*extrapolate=*/true);
+        result.invBMu = inverseOilBMu_[regionIdx].evalWeights(pressure, invBMuWeights, /*extrapolate=*/true);
+        result.mu = result.invB/result.invBMu;
+        result.density = rhooRef*result.invB;
+
+        return result;
+    }
+
+
+    /*!
+     * \brief Returns a pointer-free copy of the PVT relations of a region.
+     *
+     * The tables are appended to a buffer. The result can be evaluated using
+     * flatTabulatedPvtProperties(), e.g., after copying the buffer and the region
+     * object to an accelerator.
+     */
+    FlatTabulatedPvtRegion<Scalar> flatRegion(int regionIdx, FlatTableBuffer<Scalar>& buffer) const
+    {
+        FlatTabulatedPvtRegion<Scalar> result;
+        result.inverseB = buffer.addFunction(inverseOilB_[regionIdx]);
+        result.inverseBMu = buffer.addFunction(inverseOilBMu_[regionIdx]);
+        result.referenceDensity = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
+        return result;
     }
 
 private:
@@ -176,12 +329,34 @@ private:
                      const LhsEval& pressure,
                      const LhsEval& XoG) const
     {
-        Scalar rhooRef = BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx);
+        Scalar rhooRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
 
         const LhsEval& Bo = formationVolumeFactor_(regionIdx, temperature, pressure, XoG);
         return rhooRef/Bo;
     }
 
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the fluid phase at once.
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> properties_(int regionIdx,
+                                                 const LhsEval& temperature,
+                                                 const LhsEval& pressure,
+                                                 const LhsEval& XoG) const
+    {
+        // both tables are sampled at the same pressures, so the segment only needs to be
+        // searched for once
+        SegmentHint hint;
+        BlackOilPhaseProperties<LhsEval> result;
+        result.invB = inverseOilB_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        result.invBMu = inverseOilBMu_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        result.mu = result.invB/result.invBMu;
+        result.density = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx)*result.invB;
+
+        return result;
+    }
+
     /*!
      * \brief Returns the formation volume factor [-] of the fluid phase.
      */
@@ -273,8 +448,24 @@ private:
     std::vector<TabulatedOneDFunction> inverseOilB_;
     std::vector<TabulatedOneDFunction> oilMu_;
     std::vector<TabulatedOneDFunction> inverseOilBMu_;
+
+    Scalar tableSimplificationTolerance_;
+
+    PvtReferenceDensities<Scalar, BlackOilFluidSystem> referenceDensities_;
 };
 
 } // namespace Opm
 
+// the instantiations which are provided by the library, cf. ExplicitInstantiations.hpp
+#define OPM_DEAD_OIL_PVT_INSTANTIATIONS(KEYWORD, Evaluation) \
+    KEYWORD class Opm::OilPvtInterfaceTemplateWrapper<double, Evaluation, \
+                                                      Opm::DeadOilPvt<double, Evaluation> >; \
+    KEYWORD class Opm::DeadOilPvt<double, Evaluation>;
+
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+#include <opm/material/common/ExplicitInstantiations.hpp>
+
+OPM_MATERIAL_FOR_EACH_EVALUATION(OPM_DEAD_OIL_PVT_INSTANTIATIONS, extern template)
+#endif
+
 #endif
@@ -26,11 +26,17 @@
 #define OPM_DRY_GAS_PVT_HPP
 
 #include "GasPvtInterface.hpp"
+#include "PvtReferenceDensities.hpp"
+#include "PvtRegionLoop.hpp"
+#include "FlatBlackOilPvt.hpp"
 
 #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
 
 #include <opm/material/common/OpmFinal.hpp>
+#include <opm/material/common/InterpolationWeights.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
 #include <opm/material/common/Tabulated1DFunction.hpp>
+#include <opm/material/common/TableSimplification.hpp>
 
 #if HAVE_OPM_PARSER
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
@@ -49,6 +55,7 @@ class DryGasPvt
     : public GasPvtInterfaceTemplateWrapper<Scalar, Evaluation, DryGasPvt<Scalar, Evaluation> >
 {
     friend class GasPvtInterfaceTemplateWrapper<Scalar, Evaluation, DryGasPvt<Scalar, Evaluation> >;
+    friend class GasPvtMultiplexer<Scalar, Evaluation>;
 
     typedef FluidSystems::BlackOil<Scalar, Evaluation> BlackOilFluidSystem;
 
@@ -64,6 +71,10 @@ class DryGasPvt
     static const int waterCompIdx = BlackOilFluidSystem::waterCompIdx;
 
 public:
+    DryGasPvt()
+        : tableSimplificationTolerance_(0.0)
+    {}
+
     void setNumRegions(int numRegions)
     {
         inverseGasB_.resize(numRegions);
@@ -71,24 +82,65 @@ public:
         gasMu_.resize(numRegions);
     }
 
+    /*!
+     * \brief Specify the tolerance for removing redundant sampling points from the
+     *        PVDG tables.
+     *
+     * If the tolerance is positive, sampling points are removed as long as no column
+     * of the table deviates from the original one by more than the tolerance times
+     * the largest magnitude of its values (cf. simplifyTable()). The default is zero,
+     * i.e., the tables are used as given. This method must be called before
+     * setPvdgTable() or setPvdgArrays().
+     */
+    void setTableSimplificationTolerance(Scalar tolerance)
+    { tableSimplificationTolerance_ = tolerance; }
+
 #if HAVE_OPM_PARSER
     void setPvdgTable(int regionIdx, const PvdgTable& pvdgTable)
     {
-        int numSamples = pvdgTable.numRows();
-        assert(numSamples > 1);
+        std::vector<Scalar> pg(pvdgTable.getPressureColumn().begin(),
+                               pvdgTable.getPressureColumn().end());
+        std::vector<Scalar> Bg(pvdgTable.getFormationFactorColumn().begin(),
+                               pvdgTable.getFormationFactorColumn().end());
+        std::vector<Scalar> mug(pvdgTable.getViscosityColumn().begin(),
+                                pvdgTable.getViscosityColumn().end());
+        setPvdgArrays(regionIdx, static_cast<int>(pg.size()), pg.data(), Bg.data(), mug.data());
+    }
+#endif
+
+    /*!
+     * \brief Initialize the gas parameters of a region from the columns of a PVDG table.
+     *
+     * This is equivalent to setPvdgTable(), but it does not require opm-parser.
+     *
+     * \param regionIdx The index of the PVT region
+     * \param numRows The number of rows of the table
+     * \param pg The gas pressures of the rows in ascending order [Pa]
+     * \param Bg The gas formation volume factors of the rows
+     * \param mug The gas viscosities of the rows [Pa s]
+     */
+    void setPvdgArrays(int regionIdx, int numRows, const Scalar* pg, const Scalar* Bg, const Scalar* mug)
+    {
+        assert(numRows > 1);
 
         // say 99.97% of all time: "premature optimization is the root of all
         // evil". Eclipse does it this way for no good reason!
-        std::vector<Scalar> invB(pvdgTable.numRows());
-        const auto& Bg = pvdgTable.getFormationFactorColumn();
-        for (unsigned i = 0; i < Bg.size(); ++ i) {
+        std::vector<std::vector<Scalar> > columns(2);
+        auto& invB = columns[0];
+        auto& mu = columns[1];
+        invB.resize(numRows);
+        for (int i = 0; i < numRows; ++ i) {
             invB[i] = 1.0/Bg[i];
         }
+        mu.assign(mug, mug + numRows);
+
+        std::vector<Scalar> pressure(pg, pg + numRows);
+        Opm::simplifyTable(pressure, columns, tableSimplificationTolerance_);
+        int numSamples = pressure.size();
 
-        inverseGasB_[regionIdx].setXYArrays(numSamples, pvdgTable.getPressureColumn(), invB);
-        gasMu_[regionIdx].setXYArrays(numSamples, pvdgTable.getPressureColumn(), pvdgTable.getViscosityColumn());
+        inverseGasB_[regionIdx].setXYArrays(numSamples, pressure, invB);
+        gasMu_[regionIdx].setXYArrays(numSamples, pressure, mu);
     }
-#endif
 
     /*!
      * \brief Initialize the viscosity of the gas phase.
@@ -115,29 +167,131 @@ public:
         assert(inverseGasB_[regionIdx].monotonic());
     }
 
+    /*!
+     * \brief Set the reference densities which are used by this object.
+     *
+     * This is only required if the object is used by a black-oil fluid system
+     * instance which is not the default one.
+     */
+    void setReferenceDensities(Scalar rhoOil,
+                               Scalar rhoWater,
+                               Scalar rhoGas,
+                               int regionIdx)
+    { referenceDensities_.setReferenceDensities(rhoOil, rhoWater, rhoGas, regionIdx); }
+
     /*!
      * \brief Finish initializing the oil phase PVT properties.
      */
     void initEnd()
     {
+        OPM_PROFILER_RANGE("DryGasPvt::initEnd");
+
         // calculate the final 2D functions which are used for interpolation.
         int numRegions = gasMu_.size();
-        for (int regionIdx = 0; regionIdx < numRegions; ++ regionIdx) {
+        forEachPvtRegion<Scalar>(numRegions, [&](int regionIdx, PvtRegionWorkspace<Scalar>& workspace) {
             // calculate the table which stores the inverse of the product of the gas
             // formation volume factor and the gas viscosity
             const auto& gasMu = gasMu_[regionIdx];
             const auto& invGasB = inverseGasB_[regionIdx];
             assert(gasMu.numSamples() == invGasB.numSamples());
 
-            std::vector<Scalar> pressureValues(gasMu.numSamples());
-            std::vector<Scalar> invGasBMuValues(gasMu.numSamples());
+            std::vector<Scalar>& pressureValues = workspace.xValues;
+            std::vector<Scalar>& invGasBMuValues = workspace.yValues;
+            pressureValues.resize(gasMu.numSamples());
+            invGasBMuValues.resize(gasMu.numSamples());
             for (int pIdx = 0; pIdx < gasMu.numSamples(); ++pIdx) {
                 pressureValues[pIdx] = invGasB.xAt(pIdx);
                 invGasBMuValues[pIdx] = invGasB.valueAt(pIdx) * (1.0/gasMu.valueAt(pIdx));
             }
 
             inverseGasBMu_[regionIdx].setXYContainers(pressureValues, invGasBMuValues);
-        }
+        });
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the gas phase together with their
+     *        partial derivatives with regard to pressure.
+     *
+     * Both tables are piecewise linear and share their sampling points, so the segment
+     * is searched for once and the derivatives are the slopes of that segment.
+     *
+     * \param dp Receives the partial derivatives of the returned quantities with regard
+     *           to pressure
+     */
+    BlackOilPhaseProperties<Scalar> propertiesWithPressureDerivatives(int regionIdx,
+                                                                      Scalar temperature,
+                                                                      Scalar pressure,
+                                                                      Scalar XgO,
+                                                                      BlackOilPhaseProperties<Scalar>& dp) const
+    {
+        const auto& invB = inverseGasB_[regionIdx];
+        const auto& invBMu = inverseGasBMu_[regionIdx];
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+
+        SegmentHint hint;
+        BlackOilPhaseProperties<Scalar> result;
+        result.invB = invB.eval(pressure, hint, /*extrapolate=*/true);
+        result.invBMu = invBMu.eval(pressure, hint, /*extrapolate=*/true);
+        result.mu = result.invB/result.invBMu;
+        result.density = rhogRef*result.invB;
+
+        dp.invB = invB.evalDerivative(pressure, hint, /*extrapolate=*/true);
+        dp.invBMu = invBMu.evalDerivative(pressure, hint, /*extrapolate=*/true);
+        dp.mu = (dp.invB - result.mu*dp.invBMu)/result.invBMu;
+        dp.density = rhogRef*dp.invB;
+
+        return result;
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the gas phase together with the
+     *        weights of the table rows which contribute to them.
+     *
+     * Both tables are sampled at the same pressures, so \f$1/B_g = \sum_k w_k/B_{g,k}\f$
+     * and \f$1/(B_g\mu_g) = \sum_k w_k/(B_{g,k}\mu_{g,k})\f$ where k is the index of a
+     * row of the PVDG table and the \f$w_k\f$ are the weights (cf.
+     * Opm::InterpolationWeights). The partial derivatives of all returned quantities
+     * with regard to the entries of the table thus follow from the chain rule, so all
+     * sensitivities are obtained from a single evaluation. If the table was simplified
+     * (cf. setTableSimplificationTolerance()), the indices refer to the remaining rows.
+     *
+     * \param weights Receives the indices and the weights of the contributing rows
+     */
+    BlackOilPhaseProperties<Scalar> propertiesWithTableWeights(int regionIdx,
+                                                               Scalar /* temperature */,
+                                                               Scalar pressure,
+                                                               Scalar /* XgO */,
+                                                               InterpolationWeights<Scalar, 2>& weights) const
+    {
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+
+        InterpolationWeights<Scalar, 2> invBMuWeights;
+        BlackOilPhaseProperties<Scalar> result;
+        result.invB = inverseGasB_[regionIdx].evalWeights(pressure, weights, /*extrapolate=*/true);
+        result.invBMu = inverseGasBMu_[regionIdx].evalWeights(pressure, invBMuWeights, /*extrapolate=*/true);
+        result.mu = result.invB/result.invBMu;
+        result.density = rhogRef*result.invB;
+
+        return result;
+    }
+
+
+    /*!
+     * \brief Returns a pointer-free copy of the PVT relations of a region.
+     *
+     * The tables are appended to a buffer. The result can be evaluated using
+     * flatTabulatedPvtProperties(), e.g., after copying the buffer and the region
+     * object to an accelerator.
+     */
+    FlatTabulatedPvtRegion<Scalar> flatRegion(int regionIdx, FlatTableBuffer<Scalar>& buffer) const
+    {
+        FlatTabulatedPvtRegion<Scalar> result;
+        result.inverseB = buffer.addFunction(inverseGasB_[regionIdx]);
+        result.inverseBMu = buffer.addFunction(inverseGasBMu_[regionIdx]);
+        result.referenceDensity = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+        return result;
     }
 
 private:
@@ -167,7 +321,29 @@ private:
     {
         // gas formation volume factor at reservoir pressure
         const LhsEval& Bg = formationVolumeFactor_(regionIdx, temperature, pressure, XgO);
-        return BlackOilFluidSystem::referenceDensity(gasPhaseIdx, regionIdx)/Bg;
+        return referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx)/Bg;
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the fluid phase at once.
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> properties_(int regionIdx,
+                                                 const LhsEval& temperature,
+                                                 const LhsEval& pressure,
+                                                 const LhsEval& XgO) const
+    {
+        // both tables are sampled at the same pressures, so the segment only needs to be
+        // searched for once
+        SegmentHint hint;
+        BlackOilPhaseProperties<LhsEval> result;
+        result.invB = inverseGasB_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        result.invBMu = inverseGasBMu_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        result.mu = result.invB/result.invBMu;
+        result.density = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx)*result.invB;
+
+        return result;
     }
 
     /*!
@@ -247,8 +423,24 @@ private:
     std::vector<TabulatedOneDFunction> inverseGasB_;
     std::vector<TabulatedOneDFunction> gasMu_;
     std::vector<TabulatedOneDFunction> inverseGasBMu_;
+
+    Scalar tableSimplificationTolerance_;
+
+    PvtReferenceDensities<Scalar, BlackOilFluidSystem> referenceDensities_;
 };
 
 } // namespace Opm
 
+// the instantiations which are provided by the library, cf. ExplicitInstantiations.hpp
+#define OPM_DRY_GAS_PVT_INSTANTIATIONS(KEYWORD, Evaluation) \
+    KEYWORD class Opm::GasPvtInterfaceTemplateWrapper<double, Evaluation, \
+                                                      Opm::DryGasPvt<double, Evaluation> >; \
+    KEYWORD class Opm::DryGasPvt<double, Evaluation>;
+
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+#include <opm/material/common/ExplicitInstantiations.hpp>
+
+OPM_MATERIAL_FOR_EACH_EVALUATION(OPM_DRY_GAS_PVT_INSTANTIATIONS, extern template)
+#endif
+
 #endif
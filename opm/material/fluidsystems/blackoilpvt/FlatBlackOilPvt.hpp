@@ -0,0 +1,146 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \brief Pointer-free representations of the PVT relations of the black-oil phases
+ *        which can be copied to accelerators.
+ */
+#ifndef OPM_FLAT_BLACK_OIL_PVT_HPP
+#define OPM_FLAT_BLACK_OIL_PVT_HPP
+
+#include "BlackOilPhaseProperties.hpp"
+
+#include <opm/material/common/FlatTables.hpp>
+
+namespace Opm {
+/*!
+ * \brief The PVT relations of a PVT region of a phase which is described by pressure
+ *        dependent tables, i.e., dead oil or dry gas.
+ *
+ * Objects of this class are created by the flatRegion() methods of DeadOilPvt and
+ * DryGasPvt. The tables are stored in a FlatTableBuffer.
+ */
+template <class Scalar>
+struct FlatTabulatedPvtRegion
+{
+    //! The inverse formation volume factor over pressure
+    FlatTable1D inverseB;
+
+    //! The inverse of the product of the formation volume factor and the viscosity
+    //! over pressure. This uses the same sampling points as inverseB.
+    FlatTable1D inverseBMu;
+
+    //! The density of the phase at surface conditions [kg/m^3]
+    Scalar referenceDensity;
+};
+
+/*!
+ * \brief The PVT relations of a PVT region of water with constant compressibility.
+ *
+ * Objects of this class are created by ConstantCompressibilityWaterPvt::flatRegion().
+ */
+template <class Scalar>
+struct FlatConstantCompressibilityWaterRegion
+{
+    Scalar referencePressure;
+    Scalar referenceFormationVolumeFactor;
+    Scalar referenceViscosity;
+    Scalar compressibility;
+    Scalar viscosibility;
+
+    //! The density of water at surface conditions [kg/m^3]
+    Scalar referenceDensity;
+};
+
+/*!
+ * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+ *        their product and the density of a tabulated phase together with their
+ *        derivatives with regard to pressure.
+ *
+ * This is equivalent to DeadOilPvt::propertiesWithPressureDerivatives() resp.
+ * DryGasPvt::propertiesWithPressureDerivatives().
+ *
+ * \param tables The view on the FlatTableBuffer of the region or on a copy of it
+ * \param region The PVT region
+ * \param pressure The pressure of the phase [Pa]
+ * \param dp Receives the partial derivatives with regard to pressure
+ */
+template <class Scalar>
+OPM_HOST_DEVICE inline BlackOilPhaseProperties<Scalar>
+flatTabulatedPvtProperties(const FlatTableView<Scalar>& tables,
+                           const FlatTabulatedPvtRegion<Scalar>& region,
+                           Scalar pressure,
+                           BlackOilPhaseProperties<Scalar>& dp)
+{
+    BlackOilPhaseProperties<Scalar> result;
+    result.invB = tables.eval(region.inverseB, pressure, /*extrapolate=*/true, dp.invB);
+    result.invBMu = tables.eval(region.inverseBMu, pressure, /*extrapolate=*/true, dp.invBMu);
+    result.mu = result.invB/result.invBMu;
+    result.density = region.referenceDensity*result.invB;
+
+    dp.mu = (dp.invB - result.mu*dp.invBMu)/result.invBMu;
+    dp.density = region.referenceDensity*dp.invB;
+
+    return result;
+}
+
+/*!
+ * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+ *        their product and the density of water together with their derivatives with
+ *        regard to pressure.
+ *
+ * This is equivalent to ConstantCompressibilityWaterPvt::propertiesWithPressureDerivatives().
+ *
+ * \param region The PVT region
+ * \param pressure The pressure of the phase [Pa]
+ * \param dp Receives the partial derivatives with regard to pressure
+ */
+template <class Scalar>
+OPM_HOST_DEVICE inline BlackOilPhaseProperties<Scalar>
+flatWaterPvtProperties(const FlatConstantCompressibilityWaterRegion<Scalar>& region,
+                       Scalar pressure,
+                       BlackOilPhaseProperties<Scalar>& dp)
+{
+    Scalar BwRef = region.referenceFormationVolumeFactor;
+    Scalar BwMuwRef = region.referenceViscosity*BwRef;
+
+    Scalar cX = region.compressibility;
+    Scalar cY = region.compressibility - region.viscosibility;
+    Scalar X = cX*(pressure - region.referencePressure);
+    Scalar Y = cY*(pressure - region.referencePressure);
+
+    BlackOilPhaseProperties<Scalar> result;
+    result.invB = (1 + X*(1 + X/2))/BwRef;
+    result.invBMu = (1 + Y*(1 + Y/2))/BwMuwRef;
+    result.mu = result.invB/result.invBMu;
+    result.density = region.referenceDensity*result.invB;
+
+    dp.invB = cX*(1 + X)/BwRef;
+    dp.invBMu = cY*(1 + Y)/BwMuwRef;
+    dp.mu = (dp.invB - result.mu*dp.invBMu)/result.invBMu;
+    dp.density = region.referenceDensity*dp.invB;
+
+    return result;
+}
+
+} // namespace Opm
+
+#endif
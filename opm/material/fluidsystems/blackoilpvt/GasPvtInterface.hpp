@@ -25,9 +25,14 @@
 #ifndef OPM_GAS_PVT_INTERFACE_HPP
 #define OPM_GAS_PVT_INTERFACE_HPP
 
+#include "BlackOilPhaseProperties.hpp"
+
 #include <opm/material/common/OpmFinal.hpp>
 
 namespace Opm {
+template <class Scalar, class Evaluation>
+class GasPvtMultiplexer;
+
 /*!
  * \brief This class represents the Pressure-Volume-Temperature relations of the gas
  *        phase in the black-oil model.
@@ -80,6 +85,22 @@ public:
                            Scalar pressure,
                            Scalar XgO) const = 0;
 
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the fluid phase at once.
+     *
+     * This is cheaper than calling the individual methods because the table
+     * lookups are shared.
+     */
+    virtual BlackOilPhaseProperties<Evaluation> properties(int regionIdx,
+                                                           const Evaluation& temperature,
+                                                           const Evaluation& pressure,
+                                                           const Evaluation& XgO) const = 0;
+    virtual BlackOilPhaseProperties<Scalar> properties(int regionIdx,
+                                                       Scalar temperature,
+                                                       Scalar pressure,
+                                                       Scalar XgO) const = 0;
+
     /*!
      * \brief Returns the fugacity coefficient [Pa] of a component in the fluid phase given
      *        a set of parameters.
@@ -155,6 +176,10 @@ public:
                            Scalar temperature,
                            Scalar pressure,
                            Scalar XgO) const = 0;
+    virtual BlackOilPhaseProperties<Scalar> properties(int regionIdx,
+                                                       Scalar temperature,
+                                                       Scalar pressure,
+                                                       Scalar XgO) const = 0;
     virtual Scalar fugacityCoefficient(int regionIdx,
                                        Scalar temperature,
                                        Scalar pressure,
@@ -213,6 +238,17 @@ public:
                            Scalar XgO) const OPM_FINAL
     { return asImp_().density_(regionIdx, temperature, pressure, XgO); };
 
+    virtual BlackOilPhaseProperties<Evaluation> properties(int regionIdx,
+                                                           const Evaluation& temperature,
+                                                           const Evaluation& pressure,
+                                                           const Evaluation& XgO) const OPM_FINAL
+    { return asImp_().properties_(regionIdx, temperature, pressure, XgO); };
+    virtual BlackOilPhaseProperties<Scalar> properties(int regionIdx,
+                                                       Scalar temperature,
+                                                       Scalar pressure,
+                                                       Scalar XgO) const OPM_FINAL
+    { return asImp_().properties_(regionIdx, temperature, pressure, XgO); };
+
     virtual Evaluation fugacityCoefficient(int regionIdx,
                                            const Evaluation& temperature,
                                            const Evaluation& pressure,
@@ -284,6 +320,11 @@ public:
                            Scalar pressure,
                            Scalar XgO) const OPM_FINAL
     { return asImp_().density_(regionIdx, temperature, pressure, XgO); };
+    virtual BlackOilPhaseProperties<Scalar> properties(int regionIdx,
+                                                       Scalar temperature,
+                                                       Scalar pressure,
+                                                       Scalar XgO) const OPM_FINAL
+    { return asImp_().properties_(regionIdx, temperature, pressure, XgO); };
     virtual Scalar fugacityCoefficient(int regionIdx,
                                        Scalar temperature,
                                        Scalar pressure,
@@ -0,0 +1,274 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::GasPvtMultiplexer
+ */
+#ifndef OPM_GAS_PVT_MULTIPLEXER_HPP
+#define OPM_GAS_PVT_MULTIPLEXER_HPP
+
+#include "GasPvtInterface.hpp"
+#include "GenericPvtProperties.hpp"
+
+namespace Opm {
+// the implementation classes include the black-oil fluid system which in turn includes
+// this file, so they might not be defined yet at this point.
+template <class Scalar, class Evaluation>
+class DryGasPvt;
+template <class Scalar, class Evaluation>
+class WetGasPvt;
+} // namespace Opm
+
+#include "DryGasPvt.hpp"
+#include "WetGasPvt.hpp"
+
+#include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/Instrumentation.hpp>
+
+#include <cassert>
+#include <memory>
+#include <type_traits>
+
+namespace Opm {
+enum GasPvtApproach {
+    NoGasPvtApproach,
+    GenericGasPvtApproach,
+    DryGasPvtApproach,
+    WetGasPvtApproach
+};
+
+#define OPM_GAS_PVT_MULTIPLEXER_CALL(codeToCall)                                     \
+    switch (approach_) {                                                             \
+    case DryGasPvtApproach: {                                                        \
+        const auto& pvtImpl = getRealPvt<DryGasPvtApproach>();                       \
+        codeToCall;                                                                  \
+    }                                                                                \
+    case WetGasPvtApproach: {                                                        \
+        const auto& pvtImpl = getRealPvt<WetGasPvtApproach>();                       \
+        codeToCall;                                                                  \
+    }                                                                                \
+    case NoGasPvtApproach:                                                           \
+        OPM_THROW(std::logic_error, "No PVT relations have been set for the gas phase"); \
+    case GenericGasPvtApproach:                                                      \
+        break;                                                                       \
+    }
+
+/*!
+ * \brief Dispatches the calls for the PVT relations of the gas phase to the actual
+ *        implementation without using virtual methods.
+ *
+ * \copydetails Opm::OilPvtMultiplexer
+ */
+template <class Scalar, class Evaluation = Scalar>
+class GasPvtMultiplexer
+{
+    typedef Opm::GasPvtInterface<Scalar, Evaluation> GasPvtInterface;
+    typedef Opm::DryGasPvt<Scalar, Evaluation> DryGasPvt;
+    typedef Opm::WetGasPvt<Scalar, Evaluation> WetGasPvt;
+
+public:
+    GasPvtMultiplexer()
+        : approach_(NoGasPvtApproach)
+    {}
+
+    /*!
+     * \brief Set the object which implements the PVT relations.
+     *
+     * This determines the approach which is used for all subsequent calls.
+     */
+    void setPvt(std::shared_ptr<const GasPvtInterface> pvtObj)
+    {
+        pvt_ = pvtObj;
+
+        const GasPvtInterface* p = pvt_.get();
+        if (!p)
+            approach_ = NoGasPvtApproach;
+        else if (dynamic_cast<const DryGasPvt*>(p))
+            approach_ = DryGasPvtApproach;
+        else if (dynamic_cast<const WetGasPvt*>(p))
+            approach_ = WetGasPvtApproach;
+        else
+            approach_ = GenericGasPvtApproach;
+    }
+
+    /*!
+     * \brief Returns the object which implements the PVT relations.
+     */
+    const std::shared_ptr<const GasPvtInterface>& pvt() const
+    { return pvt_; }
+
+    /*!
+     * \brief Returns the approach which is used to dispatch the calls.
+     */
+    GasPvtApproach approach() const
+    { return approach_; }
+
+    // get the implementation object for dry gas
+    template <GasPvtApproach approachV>
+    typename std::enable_if<approachV == DryGasPvtApproach, const DryGasPvt>::type&
+    getRealPvt() const
+    {
+        assert(approach() == approachV);
+        return *static_cast<const DryGasPvt*>(pvt_.get());
+    }
+
+    // get the implementation object for wet gas
+    template <GasPvtApproach approachV>
+    typename std::enable_if<approachV == WetGasPvtApproach, const WetGasPvt>::type&
+    getRealPvt() const
+    {
+        assert(approach() == approachV);
+        return *static_cast<const WetGasPvt*>(pvt_.get());
+    }
+
+    /*!
+     * \copydoc GasPvtInterface::viscosity
+     */
+    template <class LhsEval>
+    LhsEval viscosity(int regionIdx,
+                      const LhsEval& temperature,
+                      const LhsEval& pressure,
+                      const LhsEval& XgO) const
+    {
+        OPM_INSTRUMENT_SCOPE("GasPvt::viscosity");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.template viscosity_<LhsEval>(regionIdx, temperature, pressure, XgO));
+        return pvt_->viscosity(regionIdx, temperature, pressure, XgO);
+    }
+
+    /*!
+     * \copydoc GasPvtInterface::formationVolumeFactor
+     */
+    template <class LhsEval>
+    LhsEval formationVolumeFactor(int regionIdx,
+                                  const LhsEval& temperature,
+                                  const LhsEval& pressure,
+                                  const LhsEval& XgO) const
+    {
+        OPM_INSTRUMENT_SCOPE("GasPvt::formationVolumeFactor");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.template formationVolumeFactor_<LhsEval>(regionIdx, temperature, pressure, XgO));
+        return pvt_->formationVolumeFactor(regionIdx, temperature, pressure, XgO);
+    }
+
+    /*!
+     * \copydoc GasPvtInterface::density
+     */
+    template <class LhsEval>
+    LhsEval density(int regionIdx,
+                    const LhsEval& temperature,
+                    const LhsEval& pressure,
+                    const LhsEval& XgO) const
+    {
+        OPM_INSTRUMENT_SCOPE("GasPvt::density");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.template density_<LhsEval>(regionIdx, temperature, pressure, XgO));
+        return pvt_->density(regionIdx, temperature, pressure, XgO);
+    }
+
+    /*!
+     * \copydoc GasPvtInterface::properties
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> properties(int regionIdx,
+                                                const LhsEval& temperature,
+                                                const LhsEval& pressure,
+                                                const LhsEval& XgO) const
+    {
+        OPM_INSTRUMENT_SCOPE("GasPvt::properties");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.template properties_<LhsEval>(regionIdx, temperature, pressure, XgO));
+        return GenericPvtProperties<Scalar, Evaluation>::template eval<LhsEval>(*pvt_, "gas", regionIdx, temperature, pressure, XgO);
+    }
+
+    /*!
+     * \copydoc GasPvtInterface::fugacityCoefficient
+     */
+    template <class LhsEval>
+    LhsEval fugacityCoefficient(int regionIdx,
+                                const LhsEval& temperature,
+                                const LhsEval& pressure,
+                                int compIdx) const
+    {
+        OPM_INSTRUMENT_SCOPE("GasPvt::fugacityCoefficient");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.template fugacityCoefficient_<LhsEval>(regionIdx, temperature, pressure, compIdx));
+        return pvt_->fugacityCoefficient(regionIdx, temperature, pressure, compIdx);
+    }
+
+    /*!
+     * \copydoc GasPvtInterface::oilVaporizationFactor
+     */
+    template <class LhsEval>
+    LhsEval oilVaporizationFactor(int regionIdx,
+                                  const LhsEval& temperature,
+                                  const LhsEval& pressure) const
+    {
+        OPM_INSTRUMENT_SCOPE("GasPvt::oilVaporizationFactor");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.template oilVaporizationFactor_<LhsEval>(regionIdx, temperature, pressure));
+        return pvt_->oilVaporizationFactor(regionIdx, temperature, pressure);
+    }
+
+    /*!
+     * \copydoc GasPvtInterface::gasSaturationPressure
+     */
+    template <class LhsEval>
+    LhsEval gasSaturationPressure(int regionIdx,
+                                  const LhsEval& temperature,
+                                  const LhsEval& XgO) const
+    {
+        OPM_INSTRUMENT_SCOPE("GasPvt::gasSaturationPressure");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.template gasSaturationPressure_<LhsEval>(regionIdx, temperature, XgO));
+        return pvt_->gasSaturationPressure(regionIdx, temperature, XgO);
+    }
+
+    /*!
+     * \copydoc GasPvtInterface::saturatedGasOilMassFraction
+     */
+    template <class LhsEval>
+    LhsEval saturatedGasOilMassFraction(int regionIdx,
+                                        const LhsEval& temperature,
+                                        const LhsEval& pressure) const
+    {
+        OPM_INSTRUMENT_SCOPE("GasPvt::saturatedGasOilMassFraction");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.template saturatedGasOilMassFraction_<LhsEval>(regionIdx, temperature, pressure));
+        return pvt_->saturatedGasOilMassFraction(regionIdx, temperature, pressure);
+    }
+
+    /*!
+     * \copydoc GasPvtInterface::saturatedGasOilMoleFraction
+     */
+    template <class LhsEval>
+    LhsEval saturatedGasOilMoleFraction(int regionIdx,
+                                        const LhsEval& temperature,
+                                        const LhsEval& pressure) const
+    {
+        OPM_INSTRUMENT_SCOPE("GasPvt::saturatedGasOilMoleFraction");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.template saturatedGasOilMoleFraction_<LhsEval>(regionIdx, temperature, pressure));
+        return pvt_->saturatedGasOilMoleFraction(regionIdx, temperature, pressure);
+    }
+
+private:
+    GasPvtApproach approach_;
+    std::shared_ptr<const GasPvtInterface> pvt_;
+};
+
+#undef OPM_GAS_PVT_MULTIPLEXER_CALL
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,99 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::GenericPvtProperties
+ */
+#ifndef OPM_GENERIC_PVT_PROPERTIES_HPP
+#define OPM_GENERIC_PVT_PROPERTIES_HPP
+
+#include "BlackOilPhaseProperties.hpp"
+
+#include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/ErrorMacros.hpp>
+
+#include <type_traits>
+
+namespace Opm {
+/*!
+ * \brief Evaluates the properties() method of a PVT object which is not one of the
+ *        implementations shipped with opm-material.
+ *
+ * The PVT multiplexers can only call such objects via the virtual methods of the PVT
+ * interfaces. These only exist for the Scalar and the Evaluation types of the
+ * interface, while the methods of the multiplexers are templates which can be
+ * instantiated for any evaluation type. For the other types, the properties cannot be
+ * computed and an exception is thrown at runtime.
+ */
+template <class Scalar, class Evaluation>
+class GenericPvtProperties
+{
+public:
+    /*!
+     * \brief Returns true iff LhsEval is one of the evaluation types of the PVT
+     *        interface.
+     */
+    template <class LhsEval>
+    struct IsInterfaceType
+        : public std::integral_constant<bool,
+                                        std::is_same<LhsEval, Scalar>::value
+                                        || std::is_same<LhsEval, Evaluation>::value>
+    {};
+
+    /*!
+     * \brief Call the properties() method of a PVT interface object.
+     *
+     * \param pvt The PVT object
+     * \param phaseName The name of the phase which is used for the error message
+     * \param regionIdx The index of the PVT region
+     * \param args The remaining arguments of the properties() method
+     */
+    template <class LhsEval, class PvtInterface, class... Args>
+    static BlackOilPhaseProperties<LhsEval> eval(const PvtInterface& pvt,
+                                                 const char* phaseName,
+                                                 int regionIdx,
+                                                 const Args&... args)
+    { return eval_<LhsEval>(IsInterfaceType<LhsEval>(), pvt, phaseName, regionIdx, args...); }
+
+private:
+    template <class LhsEval, class PvtInterface, class... Args>
+    static BlackOilPhaseProperties<LhsEval> eval_(std::true_type,
+                                                  const PvtInterface& pvt,
+                                                  const char* /*phaseName*/,
+                                                  int regionIdx,
+                                                  const Args&... args)
+    { return pvt.properties(regionIdx, args...); }
+
+    template <class LhsEval, class PvtInterface, class... Args>
+    static BlackOilPhaseProperties<LhsEval> eval_(std::false_type,
+                                                  const PvtInterface& /*pvt*/,
+                                                  const char* phaseName,
+                                                  int /*regionIdx*/,
+                                                  const Args&... /*args*/)
+    {
+        OPM_THROW(std::logic_error,
+                  "The properties of generic " << phaseName << " PVT objects can only be "
+                  "evaluated for the evaluation types of the PVT interface");
+    }
+};
+} // namespace Opm
+
+#endif
@@ -26,13 +26,20 @@
 #define OPM_LIVE_OIL_PVT_HPP
 
 #include "OilPvtInterface.hpp"
+#include "PvtReferenceDensities.hpp"
+#include "PvtRegionLoop.hpp"
 
 #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
 
 #include <opm/material/common/OpmFinal.hpp>
+#include <opm/material/common/InterpolationWeights.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
 #include <opm/material/common/UniformXTabulated2DFunction.hpp>
 #include <opm/material/common/Tabulated1DFunction.hpp>
+#include <opm/material/common/TableSimplification.hpp>
+#include <opm/material/common/TableResampling.hpp>
 #include <opm/material/common/Spline.hpp>
+#include <opm/material/common/TableHash.hpp>
 
 #if HAVE_OPM_PARSER
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
@@ -48,10 +55,12 @@ template <class Scalar, class Evaluation = Scalar>
 class LiveOilPvt : public OilPvtInterfaceTemplateWrapper<Scalar, Evaluation, LiveOilPvt<Scalar, Evaluation> >
 {
     friend class OilPvtInterfaceTemplateWrapper<Scalar, Evaluation, LiveOilPvt<Scalar, Evaluation> >;
+    friend class OilPvtMultiplexer<Scalar, Evaluation>;
 
     typedef FluidSystems::BlackOil<Scalar, Evaluation> BlackOilFluidSystem;
 
     typedef Opm::UniformXTabulated2DFunction<Scalar> TabulatedTwoDFunction;
+    typedef Opm::UniformTabulated2DFunction<Scalar> UniformTabulatedTwoDFunction;
     typedef Opm::Tabulated1DFunction<Scalar> TabulatedOneDFunction;
     typedef Opm::Spline<Scalar> Spline;
     typedef std::vector<std::pair<Scalar, Scalar> > SamplingPoints;
@@ -65,6 +74,14 @@ class LiveOilPvt : public OilPvtInterfaceTemplateWrapper<Scalar, Evaluation, Liv
     static const int waterCompIdx = BlackOilFluidSystem::waterCompIdx;
 
 public:
+    LiveOilPvt()
+        : tableSimplificationTolerance_(0.0)
+        , numResampledRs_(0)
+        , numResampledPressures_(0)
+        , maxResamplingError_(0.0)
+        , enableResampledTables_(true)
+    {}
+
     void setNumRegions(int numRegions)
     {
         if (static_cast<int>(inverseOilBTable_.size()) < numRegions) {
@@ -73,6 +90,11 @@ public:
             oilMuTable_.resize(numRegions);
             gasDissolutionFactorTable_.resize(numRegions);
             saturationPressureSpline_.resize(numRegions);
+            saturationPressureTable_.resize(numRegions);
+            saturatedInverseOilBTable_.resize(numRegions);
+            saturatedInverseOilBMuTable_.resize(numRegions);
+            resampledInverseOilBTable_.resize(numRegions);
+            resampledInverseOilBMuTable_.resize(numRegions);
         }
     }
 
@@ -82,7 +104,10 @@ public:
      * \param samplePoints A container of (x,y) values.
      */
     void setSaturatedOilGasDissolutionFactor(int regionIdx, const SamplingPoints &samplePoints)
-    { gasDissolutionFactorTable_[regionIdx].setContainerOfTuples(samplePoints); }
+    {
+        gasDissolutionFactorTable_[regionIdx].setContainerOfTuples(samplePoints);
+        saturationPressureTable_[regionIdx] = TabulatedOneDFunction();
+    }
 
     /*!
      * \brief Initialize the function for the oil formation volume factor
@@ -110,13 +135,14 @@ public:
         size_t nRs = 20;
         size_t nP = samplePoints.size()*2;
 
-        Scalar rhogRef = BlackOilFluidSystem::referenceDensity(gasPhaseIdx, regionIdx);
-        Scalar rhooRef = BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx);
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+        Scalar rhooRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
 
         Spline oilFormationVolumeFactorSpline;
         oilFormationVolumeFactorSpline.setContainerOfTuples(samplePoints, /*type=*/Spline::Monotonic);
 
-        updateSaturationPressureSpline_(regionIdx);
+        PvtRegionWorkspace<Scalar> workspace;
+        updateSaturationPressureSpline_(regionIdx, workspace);
 
         // calculate a table of estimated densities depending on pressure and gas mass
         // fraction
@@ -132,9 +158,9 @@ public:
                 Scalar poSat = oilSaturationPressure_(regionIdx, T, XoG);
                 Scalar BoSat = oilFormationVolumeFactorSpline.eval(poSat, /*extrapolate=*/true);
                 Scalar drhoo_dp = (1.1200 - 1.1189)/((5000 - 4000)*6894.76);
-                Scalar rhoo = BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx)/BoSat*(1 + drhoo_dp*(po - poSat));
+                Scalar rhoo = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx)/BoSat*(1 + drhoo_dp*(po - poSat));
 
-                Scalar Bo = BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx)/rhoo;
+                Scalar Bo = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx)/rhoo;
 
                 invOilB.appendSamplePoint(RsIdx, po, 1.0/Bo);
             }
@@ -203,6 +229,67 @@ public:
         }
     }
 
+    /*!
+     * \brief Specify the tolerance for removing redundant sampling points from the
+     *        undersaturated parts of the PVTO tables.
+     *
+     * If the tolerance is positive, pressures are removed from each undersaturated
+     * table as long as neither the inverse formation volume factor nor the viscosity
+     * deviates from the original one by more than the tolerance times the largest
+     * magnitude of its values (cf. simplifyTable()). The saturated part of the tables is not
+     * modified. The default is zero, i.e., the tables are used as given. This method
+     * must be called before setPvtoTable() or setPvtoArrays().
+     */
+    void setTableSimplificationTolerance(Scalar tolerance)
+    { tableSimplificationTolerance_ = tolerance; }
+
+    /*!
+     * \brief Specify the resolution of the uniform grids onto which the undersaturated
+     *        parts of the PVTO tables ought to be resampled.
+     *
+     * The lookups in the original tables need to search the pressure in the two columns
+     * of the gas dissolution factors which enclose the state, whereas the cell of a
+     * uniform (R_s, p) grid is given by index arithmetic. Since resampling changes the
+     * tables, the largest relative deviation from the original ones can be queried using
+     * maxResamplingError() after initEnd(). Outside of the range of the uniform grid,
+     * the original tables are used. A number of sampling points smaller than 2
+     * disables resampling, which is the default. This method must be called before
+     * initEnd().
+     */
+    void setUniformTableResolution(int numRs, int numPressures)
+    {
+        numResampledRs_ = numRs;
+        numResampledPressures_ = numPressures;
+    }
+
+    /*!
+     * \brief Returns the largest deviation of the resampled undersaturated tables from
+     *        the original ones relative to the magnitude of their values.
+     *
+     * This is zero if the tables are not resampled, cf. setUniformTableResolution().
+     */
+    Scalar maxResamplingError() const
+    { return maxResamplingError_; }
+
+    /*!
+     * \brief Specify whether the resampled tables ought to be used if they are available.
+     *
+     * A coarse resolution of the uniform grids (cf. setUniformTableResolution()) yields
+     * small tables which stay in the cache, but which are less accurate than the
+     * original ones. Disabling the resampled tables allows to use them for the early
+     * iterations of a nonlinear solver and the original tables for the final ones.
+     * Unlike the resolution, this can be changed after initEnd(), but not while other
+     * threads evaluate the PVT relations. By default, the resampled tables are used.
+     */
+    void setEnableResampledTables(bool yesno)
+    { enableResampledTables_ = yesno; }
+
+    /*!
+     * \brief Returns true iff the resampled tables are used if they are available.
+     */
+    bool enableResampledTables() const
+    { return enableResampledTables_; }
+
 #if HAVE_OPM_PARSER
     /*!
      * \brief Initialize the oil parameters via the data specified by the PVTO ECL keyword.
@@ -210,36 +297,95 @@ public:
     void setPvtoTable(int regionIdx, const PvtoTable &pvtoTable)
     {
         const auto saturatedTable = pvtoTable.getOuterTable();
-        assert(saturatedTable->numRows() > 1);
+        int numOuterRows = saturatedTable->numRows();
+
+        std::vector<Scalar> Rs(numOuterRows);
+        std::vector<int> rowOffsets(numOuterRows + 1, 0);
+        std::vector<Scalar> po, Bo, muo;
+        for (int outerIdx = 0; outerIdx < numOuterRows; ++ outerIdx) {
+            Rs[outerIdx] = saturatedTable->getGasSolubilityColumn()[outerIdx];
+
+            const auto underSaturatedTable = pvtoTable.getInnerTable(outerIdx);
+            int numRows = underSaturatedTable->numRows();
+            for (int innerIdx = 0; innerIdx < numRows; ++ innerIdx) {
+                po.push_back(underSaturatedTable->getPressureColumn()[innerIdx]);
+                Bo.push_back(underSaturatedTable->getOilFormationFactorColumn()[innerIdx]);
+                muo.push_back(underSaturatedTable->getOilViscosityColumn()[innerIdx]);
+            }
+            rowOffsets[outerIdx + 1] = static_cast<int>(po.size());
+        }
+
+        setPvtoArrays(regionIdx, numOuterRows, Rs.data(), rowOffsets.data(),
+                      po.data(), Bo.data(), muo.data());
+    }
+#endif // HAVE_OPM_PARSER
+
+    /*!
+     * \brief Initialize the oil parameters of a region from the columns of a PVTO table.
+     *
+     * This is equivalent to setPvtoTable(), but it does not require opm-parser. The
+     * rows of all gas dissolution factors are stored contiguously: The rows of the
+     * outer index i are [rowOffsets[i], rowOffsets[i + 1]) and the first of them is the
+     * saturated state.
+     *
+     * \param regionIdx The index of the PVT region
+     * \param numRs The number of gas dissolution factors
+     * \param Rs The gas dissolution factors in ascending order
+     * \param rowOffsets The index of the first row of each gas dissolution factor; this
+     *                   array has numRs + 1 entries
+     * \param po The oil pressures of the rows [Pa]
+     * \param Bo The oil formation volume factors of the rows
+     * \param muo The oil viscosities of the rows [Pa s]
+     */
+    void setPvtoArrays(int regionIdx,
+                       int numRs,
+                       const Scalar* Rs,
+                       const int* rowOffsets,
+                       const Scalar* po,
+                       const Scalar* Bo,
+                       const Scalar* muo)
+    {
+        assert(numRs > 1);
 
         auto& oilMu = oilMuTable_[regionIdx];
         auto& invOilB = inverseOilBTable_[regionIdx];
         auto& gasDissolutionFactor = gasDissolutionFactorTable_[regionIdx];
 
-        gasDissolutionFactor.setXYArrays(saturatedTable->numRows(),
-                                         saturatedTable->getPressureColumn(),
-                                         saturatedTable->getGasSolubilityColumn());
-
-        // extract the table for the gas dissolution and the oil formation volume factors
-        for (int outerIdx = 0; outerIdx < static_cast<int>(saturatedTable->numRows()); ++ outerIdx) {
-            Scalar Rs = saturatedTable->getGasSolubilityColumn()[outerIdx];
-
-            invOilB.appendXPos(Rs);
-            oilMu.appendXPos(Rs);
+        // the saturated states are the first rows of the undersaturated tables
+        std::vector<Scalar> saturatedPo(numRs);
+        for (int outerIdx = 0; outerIdx < numRs; ++ outerIdx)
+            saturatedPo[outerIdx] = po[rowOffsets[outerIdx]];
+        gasDissolutionFactor.setXYArrays(numRs, saturatedPo, std::vector<Scalar>(Rs, Rs + numRs));
+        saturationPressureTable_[regionIdx] = TabulatedOneDFunction();
+
+        // extract the table for the gas dissolution and the oil formation volume
+        // factors. each column is added in a single pass.
+        invOilB.reserveXPos(numRs);
+        oilMu.reserveXPos(numRs);
+        std::vector<Scalar> pressure;
+        std::vector<std::vector<Scalar> > columns(2);
+        auto& invBColumn = columns[0];
+        auto& muColumn = columns[1];
+        for (int outerIdx = 0; outerIdx < numRs; ++ outerIdx) {
+            int beginRowIdx = rowOffsets[outerIdx];
+            int endRowIdx = rowOffsets[outerIdx + 1];
+            assert(beginRowIdx < endRowIdx);
+
+            pressure.assign(po + beginRowIdx, po + endRowIdx);
+            invBColumn.resize(endRowIdx - beginRowIdx);
+            muColumn.assign(muo + beginRowIdx, muo + endRowIdx);
+            for (int rowIdx = beginRowIdx; rowIdx < endRowIdx; ++ rowIdx)
+                invBColumn[rowIdx - beginRowIdx] = 1.0/Bo[rowIdx];
+
+            // the first row of each undersaturated table is the saturated state,
+            // which is always kept
+            Opm::simplifyTable(pressure, columns, tableSimplificationTolerance_);
+
+            invOilB.appendColumn(Rs[outerIdx], pressure, invBColumn);
+            oilMu.appendColumn(Rs[outerIdx], pressure, muColumn);
 
             assert(invOilB.numX() == outerIdx + 1);
             assert(oilMu.numX() == outerIdx + 1);
-
-            const auto underSaturatedTable = pvtoTable.getInnerTable(outerIdx);
-            int numRows = underSaturatedTable->numRows();
-            for (int innerIdx = 0; innerIdx < numRows; ++ innerIdx) {
-                Scalar po = underSaturatedTable->getPressureColumn()[innerIdx];
-                Scalar Bo = underSaturatedTable->getOilFormationFactorColumn()[innerIdx];
-                Scalar muo = underSaturatedTable->getOilViscosityColumn()[innerIdx];
-
-                invOilB.appendSamplePoint(outerIdx, po, 1.0/Bo);
-                oilMu.appendSamplePoint(outerIdx, po, muo);
-            }
         }
 
         // make sure to have at least two sample points per mole fraction
@@ -256,14 +402,13 @@ public:
             // current line. We define master table as the first table which has values
             // for undersaturated oil...
             int masterTableIdx = xIdx + 1;
-            for (; masterTableIdx < static_cast<int>(pvtoTable.getOuterTable()->numRows());
-                 ++masterTableIdx)
+            for (; masterTableIdx < numRs; ++masterTableIdx)
             {
-                if (pvtoTable.getInnerTable(masterTableIdx)->numRows() > 1)
+                if (rowOffsets[masterTableIdx + 1] - rowOffsets[masterTableIdx] > 1)
                     break;
             }
 
-            if (masterTableIdx >= static_cast<int>(pvtoTable.getOuterTable()->numRows()))
+            if (masterTableIdx >= numRs)
                 OPM_THROW(std::runtime_error,
                           "PVTO tables are invalid: The last table must exhibit at least one "
                           "entry for undersaturated oil!");
@@ -272,43 +417,51 @@ public:
             // that the current table exhibits the same ratios of the oil formation
             // volume factors and viscosities for identical pressure rations as in the
             // master table.
-            const auto masterTable = pvtoTable.getInnerTable(masterTableIdx);
-            const auto curTable = pvtoTable.getInnerTable(xIdx);
-            for (int newRowIdx = 1;
-                 newRowIdx < static_cast<int>(masterTable->numRows());
-                 ++ newRowIdx)
+            int masterRowIdx = rowOffsets[masterTableIdx];
+            int numMasterRows = rowOffsets[masterTableIdx + 1] - masterRowIdx;
+            int curRowIdx = rowOffsets[xIdx];
+            for (int newRowIdx = 1; newRowIdx < numMasterRows; ++ newRowIdx)
             {
-                Scalar alphaPo =
-                    masterTable->getPressureColumn()[newRowIdx]
-                    / masterTable->getPressureColumn()[0];
-
-                Scalar alphaBo =
-                    masterTable->getOilFormationFactorColumn()[newRowIdx]
-                    / masterTable->getOilFormationFactorColumn()[0];
+                Scalar alphaPo = po[masterRowIdx + newRowIdx]/po[masterRowIdx];
+                Scalar alphaBo = Bo[masterRowIdx + newRowIdx]/Bo[masterRowIdx];
+                Scalar alphaMuo = muo[masterRowIdx + newRowIdx]/muo[masterRowIdx];
 
-                Scalar alphaMuo =
-                    masterTable->getOilViscosityColumn()[newRowIdx]
-                    / masterTable->getOilViscosityColumn()[0];
-
-                Scalar newPo = curTable->getPressureColumn()[0]*alphaPo;
-                Scalar newBo = curTable->getOilFormationFactorColumn()[0]*alphaBo;
-                Scalar newMuo = curTable->getOilViscosityColumn()[0]*alphaMuo;
+                Scalar newPo = po[curRowIdx]*alphaPo;
+                Scalar newBo = Bo[curRowIdx]*alphaBo;
+                Scalar newMuo = muo[curRowIdx]*alphaMuo;
 
                 invOilB.appendSamplePoint(xIdx, newPo, 1.0/newBo);
                 oilMu.appendSamplePoint(xIdx, newPo, newMuo);
             }
         }
     }
-#endif // HAVE_OPM_PARSER
+
+    /*!
+     * \brief Set the reference densities which are used by this object.
+     *
+     * This is only required if the object is used by a black-oil fluid system
+     * instance which is not the default one.
+     */
+    void setReferenceDensities(Scalar rhoOil,
+                               Scalar rhoWater,
+                               Scalar rhoGas,
+                               int regionIdx)
+    { referenceDensities_.setReferenceDensities(rhoOil, rhoWater, rhoGas, regionIdx); }
 
     /*!
      * \brief Finish initializing the oil phase PVT properties.
      */
     void initEnd()
     {
+        OPM_PROFILER_RANGE("LiveOilPvt::initEnd");
+
+        maxResamplingError_ = 0.0;
+
         // calculate the final 2D functions which are used for interpolation.
         int numRegions = oilMuTable_.size();
-        for (int regionIdx = 0; regionIdx < numRegions; ++ regionIdx) {
+        // the regions are independent of each other, so they are set up in parallel
+        std::vector<Scalar> resamplingErrors(numRegions, 0.0);
+        forEachPvtRegion<Scalar>(numRegions, [&](int regionIdx, PvtRegionWorkspace<Scalar>& workspace) {
             // calculate the table which stores the inverse of the product of the oil
             // formation volume factor and the oil viscosity
             const auto& oilMu = oilMuTable_[regionIdx];
@@ -317,12 +470,14 @@ public:
 
             auto& invOilBMu = inverseOilBMuTable_[regionIdx];
 
+            invOilBMu.reserveXPos(oilMu.numX());
             for (int rsIdx = 0; rsIdx < oilMu.numX(); ++rsIdx) {
                 invOilBMu.appendXPos(oilMu.xAt(rsIdx));
 
                 assert(oilMu.numY(rsIdx) == invOilB.numY(rsIdx));
 
                 int numPressures = oilMu.numY(rsIdx);
+                invOilBMu.reserveSamplePoints(rsIdx, numPressures);
                 for (int pIdx = 0; pIdx < numPressures; ++pIdx)
                     invOilBMu.appendSamplePoint(rsIdx,
                                                 oilMu.yAt(rsIdx, pIdx),
@@ -330,26 +485,176 @@ public:
                                                 1/oilMu.valueAt(rsIdx, pIdx));
             }
 
-            updateSaturationPressureSpline_(regionIdx);
+            updateSaturationPressureSpline_(regionIdx, workspace);
+            updateSaturationPressureTable_(regionIdx, workspace);
+
+            // convert the tables to the compact layout which is used for the lookups
+            inverseOilBTable_[regionIdx].finalize();
+            oilMuTable_[regionIdx].finalize();
+            inverseOilBMuTable_[regionIdx].finalize();
+
+            updateSaturatedTables_(regionIdx, workspace);
+            resamplingErrors[regionIdx] = updateResampledTables_(regionIdx);
+        });
+
+        for (int regionIdx = 0; regionIdx < numRegions; ++ regionIdx)
+            maxResamplingError_ = std::max(maxResamplingError_, resamplingErrors[regionIdx]);
+    }
+
+    /*!
+     * \brief Returns true iff two objects represent the same PVT relations.
+     *
+     * Together with contentHash(), this allows to share identical objects between the
+     * realizations of an ensemble, cf. Opm::TableRegistry. Both objects must have been
+     * finalized using initEnd().
+     */
+    bool operator==(const LiveOilPvt& other) const
+    {
+        return
+            tableSimplificationTolerance_ == other.tableSimplificationTolerance_
+            && numResampledRs_ == other.numResampledRs_
+            && numResampledPressures_ == other.numResampledPressures_
+            && referenceDensities_ == other.referenceDensities_
+            && inverseOilBTable_ == other.inverseOilBTable_
+            && oilMuTable_ == other.oilMuTable_
+            && inverseOilBMuTable_ == other.inverseOilBMuTable_
+            && gasDissolutionFactorTable_ == other.gasDissolutionFactorTable_
+            && saturationPressureSpline_ == other.saturationPressureSpline_
+            && saturationPressureTable_ == other.saturationPressureTable_
+            && saturatedInverseOilBTable_ == other.saturatedInverseOilBTable_
+            && saturatedInverseOilBMuTable_ == other.saturatedInverseOilBMuTable_;
+    }
+
+    /*!
+     * \brief Returns a hash value of the PVT relations, cf. Opm::TableRegistry.
+     *
+     * The tables which are derived from the ones given by the deck are not considered.
+     */
+    size_t contentHash() const
+    {
+        size_t seed = referenceDensities_.contentHash();
+        seed = hashCombine(seed, inverseOilBTable_.size());
+        for (size_t regionIdx = 0; regionIdx < inverseOilBTable_.size(); ++regionIdx) {
+            seed = hashCombine(seed, inverseOilBTable_[regionIdx].contentHash());
+            seed = hashCombine(seed, oilMuTable_[regionIdx].contentHash());
+            seed = hashCombine(seed, gasDissolutionFactorTable_[regionIdx].contentHash());
         }
+        return seed;
     }
 
-private:
     /*!
-     * \brief Returns the dynamic viscosity [Pa s] of the fluid phase given a set of parameters.
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of gas-saturated oil at once.
+     *
+     * In contrast to properties(), the gas dissolution factor is not specified but
+     * given by the saturated one at the pressure. Instead of the two-dimensional tables,
+     * this uses one-dimensional tables of the properties of saturated oil which are
+     * created by initEnd(). They are sampled at the pressures of the gas dissolution
+     * factor table, so all quantities are determined using a single segment lookup.
+     * Between these pressures, the saturated properties are interpolated linearly, which
+     * corresponds to how the saturated part of a PVTO table is interpreted.
      */
     template <class LhsEval>
-    LhsEval viscosity_(int regionIdx,
-                       const LhsEval& temperature,
-                       const LhsEval& pressure,
-                       const LhsEval& XoG) const
+    BlackOilPhaseProperties<LhsEval> saturatedProperties(int regionIdx,
+                                                         const LhsEval& /* temperature */,
+                                                         const LhsEval& pressure) const
+    {
+        Scalar rhooRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+
+        SegmentHint hint;
+        BlackOilPhaseProperties<LhsEval> result;
+        const LhsEval& Rs = gasDissolutionFactorTable_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        result.invB = saturatedInverseOilBTable_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        result.invBMu = saturatedInverseOilBMuTable_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        result.mu = result.invB/result.invBMu;
+        result.density = rhooRef*result.invB + rhogRef*Rs*result.invB;
+
+        return result;
+    }
+
+    /*!
+     * \brief Returns the dynamic viscosity [Pa s] of gas-saturated oil.
+     *
+     * \copydetails saturatedProperties
+     */
+    template <class LhsEval>
+    LhsEval saturatedViscosity(int regionIdx,
+                               const LhsEval& /* temperature */,
+                               const LhsEval& pressure) const
+    {
+        SegmentHint hint;
+        const LhsEval& invBo = saturatedInverseOilBTable_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        const LhsEval& invMuoBo = saturatedInverseOilBMuTable_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+
+        return invBo/invMuoBo;
+    }
+
+    /*!
+     * \brief Returns the formation volume factor [-] of gas-saturated oil.
+     *
+     * \copydetails saturatedProperties
+     */
+    template <class LhsEval>
+    LhsEval saturatedFormationVolumeFactor(int regionIdx,
+                                           const LhsEval& /* temperature */,
+                                           const LhsEval& pressure) const
+    { return 1.0 / saturatedInverseOilBTable_[regionIdx].eval(pressure, /*extrapolate=*/true); }
+
+    /*!
+     * \brief Returns the density [kg/m^3] of gas-saturated oil.
+     *
+     * \copydetails saturatedProperties
+     */
+    template <class LhsEval>
+    LhsEval saturatedDensity(int regionIdx,
+                             const LhsEval& /* temperature */,
+                             const LhsEval& pressure) const
     {
-        const LhsEval& Rs =
-            XoG/(1 - XoG)
-            * (BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx)
-               / BlackOilFluidSystem::referenceDensity(gasPhaseIdx, regionIdx));
+        Scalar rhooRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+
+        SegmentHint hint;
+        const LhsEval& Rs = gasDissolutionFactorTable_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        const LhsEval& invBo = saturatedInverseOilBTable_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+
+        return (rhooRef + rhogRef*Rs)*invBo;
+    }
+
+    /*!
+     * \brief Returns true if the saturation pressure of a region is determined by a
+     *        single lookup in the inverse of the gas dissolution factor table.
+     *
+     * This is the case after initEnd() if the gas dissolution factor is strictly
+     * increasing with pressure. Otherwise, the saturation pressure is determined
+     * iteratively.
+     */
+    bool hasSaturationPressureTable(int regionIdx) const
+    { return saturationPressureTable_[regionIdx].numSamples() > 1; }
 
+    /*!
+     * \brief Returns the dynamic viscosity [Pa s] of the oil phase given its gas
+     *        dissolution factor.
+     *
+     * In contrast to the methods of the PVT interface, the composition of the oil phase
+     * is specified by the gas dissolution factor R_s instead of the mass fraction of the
+     * gas component. If R_s is known anyway, e.g., because it is a primary variable, this
+     * avoids converting it to a mass fraction and back.
+     */
+    template <class LhsEval>
+    LhsEval viscosityFromRs(int regionIdx,
+                            const LhsEval& /* temperature */,
+                            const LhsEval& pressure,
+                            const LhsEval& Rs) const
+    {
         // ATTENTION: Rs is the first axis!
+        if (useResampledTables_(regionIdx, Rs, pressure)) {
+            const LhsEval& invBo = resampledInverseOilBTable_[regionIdx].eval(Rs, pressure);
+            const LhsEval& invMuoBo = resampledInverseOilBMuTable_[regionIdx].eval(Rs, pressure);
+
+            return invBo/invMuoBo;
+        }
+
         const LhsEval& invBo = inverseOilBTable_[regionIdx].eval(Rs, pressure, /*extrapolate=*/true);
         const LhsEval& invMuoBo = inverseOilBMuTable_[regionIdx].eval(Rs, pressure, /*extrapolate=*/true);
 
@@ -357,31 +662,186 @@ private:
     }
 
     /*!
-     * \brief Returns the density [kg/m^3] of the fluid phase given a set of parameters.
+     * \brief Returns the formation volume factor [-] of the oil phase given its gas
+     *        dissolution factor.
+     *
+     * \copydetails viscosityFromRs
      */
     template <class LhsEval>
-    LhsEval density_(int regionIdx,
-                     const LhsEval& temperature,
-                     const LhsEval& pressure,
-                     const LhsEval& XoG) const
+    LhsEval formationVolumeFactorFromRs(int regionIdx,
+                                        const LhsEval& /* temperature */,
+                                        const LhsEval& pressure,
+                                        const LhsEval& Rs) const
     {
-        Scalar rhooRef = BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx);
-        Scalar rhogRef = BlackOilFluidSystem::referenceDensity(gasPhaseIdx, regionIdx);
+        Valgrind::CheckDefined(Rs);
+
+        // ATTENTION: Rs is represented by the _first_ axis!
+        if (useResampledTables_(regionIdx, Rs, pressure))
+            return 1.0 / resampledInverseOilBTable_[regionIdx].eval(Rs, pressure);
+        return 1.0 / inverseOilBTable_[regionIdx].eval(Rs, pressure, /*extrapolate=*/true);
+    }
+
+    /*!
+     * \brief Returns the density [kg/m^3] of the oil phase given its gas dissolution
+     *        factor.
+     *
+     * \copydetails viscosityFromRs
+     */
+    template <class LhsEval>
+    LhsEval densityFromRs(int regionIdx,
+                          const LhsEval& temperature,
+                          const LhsEval& pressure,
+                          const LhsEval& Rs) const
+    {
+        Scalar rhooRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
         Valgrind::CheckDefined(rhooRef);
         Valgrind::CheckDefined(rhogRef);
 
-        const LhsEval& Bo = formationVolumeFactor_(regionIdx, temperature, pressure, XoG);
+        const LhsEval& Bo = formationVolumeFactorFromRs(regionIdx, temperature, pressure, Rs);
         Valgrind::CheckDefined(Bo);
 
-        LhsEval rhoo = rhooRef/Bo;
-
         // the oil formation volume factor just represents the partial density of the oil
         // component in the oil phase. to get the total density of the phase, we have to
         // add the partial density of the gas component.
-        const LhsEval Rs = XoG/(1 - XoG) * rhooRef/rhogRef;
-        rhoo += rhogRef*Rs/Bo;
+        return (rhooRef + rhogRef*Rs)/Bo;
+    }
 
-        return rhoo;
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the oil phase at once given its gas
+     *        dissolution factor.
+     *
+     * \copydetails viscosityFromRs
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> propertiesFromRs(int regionIdx,
+                                                      const LhsEval& /* temperature */,
+                                                      const LhsEval& pressure,
+                                                      const LhsEval& Rs) const
+    {
+        Scalar rhooRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+
+        // the table for 1/(B_o mu_o) is sampled at the same points as the one for 1/B_o,
+        // so the segments found by the first lookup can be reused for the second one.
+        // ATTENTION: Rs is the first axis!
+        BlackOilPhaseProperties<LhsEval> result;
+        if (useResampledTables_(regionIdx, Rs, pressure)) {
+            result.invB = resampledInverseOilBTable_[regionIdx].eval(Rs, pressure);
+            result.invBMu = resampledInverseOilBMuTable_[regionIdx].eval(Rs, pressure);
+        }
+        else {
+            SegmentHint2D hint;
+            result.invB = inverseOilBTable_[regionIdx].eval(Rs, pressure, hint, /*extrapolate=*/true);
+            result.invBMu = inverseOilBMuTable_[regionIdx].eval(Rs, pressure, hint, /*extrapolate=*/true);
+        }
+        result.mu = result.invB/result.invBMu;
+        result.density = rhooRef*result.invB + rhogRef*Rs*result.invB;
+
+        return result;
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the oil phase given its gas dissolution
+     *        factor together with the weights of the table rows which contribute to
+     *        them.
+     *
+     * Both tables are sampled at the same points, so \f$1/B_o = \sum_k w_k/B_{o,k}\f$
+     * and \f$1/(B_o\mu_o) = \sum_k w_k/(B_{o,k}\mu_{o,k})\f$ where the sum goes over
+     * the four contributing rows of the PVTO table and the \f$w_k\f$ are the weights
+     * (cf. Opm::InterpolationWeights). The partial derivatives of all returned
+     * quantities with regard to the entries of the table thus follow from the chain
+     * rule, so all sensitivities are obtained from a single evaluation.
+     *
+     * For each contributing row, xIdx() is the index of the record, i.e., of its gas
+     * dissolution factor, and yIdx() is the index of the row within the record. Rows
+     * which do not exist in the table because they were extrapolated for a record
+     * without undersaturated data (cf. setPvtoArrays()) have indices beyond the last
+     * row of the record. If the table was simplified (cf.
+     * setTableSimplificationTolerance()), the indices refer to the remaining rows.
+     * The resampled tables are never used by this method.
+     *
+     * \param weights Receives the indices and the weights of the contributing rows
+     */
+    BlackOilPhaseProperties<Scalar> propertiesFromRsWithTableWeights(int regionIdx,
+                                                                     Scalar /* temperature */,
+                                                                     Scalar pressure,
+                                                                     Scalar Rs,
+                                                                     InterpolationWeights<Scalar, 4>& weights) const
+    {
+        Scalar rhooRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+
+        // ATTENTION: Rs is the first axis!
+        InterpolationWeights<Scalar, 4> invBMuWeights;
+        BlackOilPhaseProperties<Scalar> result;
+        result.invB = inverseOilBTable_[regionIdx].evalWeights(Rs, pressure, weights, /*extrapolate=*/true);
+        result.invBMu = inverseOilBMuTable_[regionIdx].evalWeights(Rs, pressure, invBMuWeights, /*extrapolate=*/true);
+        result.mu = result.invB/result.invBMu;
+        result.density = rhooRef*result.invB + rhogRef*Rs*result.invB;
+
+        return result;
+    }
+
+private:
+    // convert the mass fraction of the gas component in the oil phase to the gas
+    // dissolution factor
+    template <class LhsEval>
+    LhsEval gasDissolutionFactorFromMassFraction_(int regionIdx, const LhsEval& XoG) const
+    {
+        Valgrind::CheckDefined(XoG);
+
+        Scalar rhooRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+        return XoG/(1 - XoG)*(rhooRef/rhogRef);
+    }
+
+    /*!
+     * \brief Returns the dynamic viscosity [Pa s] of the fluid phase given a set of parameters.
+     */
+    template <class LhsEval>
+    LhsEval viscosity_(int regionIdx,
+                       const LhsEval& temperature,
+                       const LhsEval& pressure,
+                       const LhsEval& XoG) const
+    {
+        return viscosityFromRs(regionIdx,
+                               temperature,
+                               pressure,
+                               gasDissolutionFactorFromMassFraction_(regionIdx, XoG));
+    }
+
+    /*!
+     * \brief Returns the density [kg/m^3] of the fluid phase given a set of parameters.
+     */
+    template <class LhsEval>
+    LhsEval density_(int regionIdx,
+                     const LhsEval& temperature,
+                     const LhsEval& pressure,
+                     const LhsEval& XoG) const
+    {
+        return densityFromRs(regionIdx,
+                             temperature,
+                             pressure,
+                             gasDissolutionFactorFromMassFraction_(regionIdx, XoG));
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the fluid phase at once.
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> properties_(int regionIdx,
+                                                 const LhsEval& temperature,
+                                                 const LhsEval& pressure,
+                                                 const LhsEval& XoG) const
+    {
+        return propertiesFromRs(regionIdx,
+                                temperature,
+                                pressure,
+                                gasDissolutionFactorFromMassFraction_(regionIdx, XoG));
     }
 
     /*!
@@ -393,15 +853,10 @@ private:
                                    const LhsEval& pressure,
                                    const LhsEval& XoG) const
     {
-        const LhsEval& Rs =
-            XoG/(1-XoG)
-            *(BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx)
-              /BlackOilFluidSystem::referenceDensity(gasPhaseIdx, regionIdx));
-        Valgrind::CheckDefined(Rs);
-        Valgrind::CheckDefined(XoG);
-
-        // ATTENTION: Rs is represented by the _first_ axis!
-        return 1.0 / inverseOilBTable_[regionIdx].eval(Rs, pressure, /*extrapolate=*/true);
+        return formationVolumeFactorFromRs(regionIdx,
+                                           temperature,
+                                           pressure,
+                                           gasDissolutionFactorFromMassFraction_(regionIdx, XoG));
     }
 
     /*!
@@ -437,11 +892,11 @@ private:
 
         // then, scale the gas component's gas phase fugacity
         // coefficient, so that the oil phase ends up at the right
-        // composition if we were doing a flash experiment
-        const LhsEval& phi_gG = BlackOilFluidSystem::fugCoefficientInGas(gasCompIdx,
-                                                                         temperature,
-                                                                         pressure,
-                                                                         regionIdx);
+        // composition if we were doing a flash experiment. the gas PVT classes all use a
+        // fugacity coefficient of one for the gas component in the gas phase. it is not
+        // taken from a fluid system object because this PVT object may be used by any
+        // BlackOilInstance.
+        Scalar phi_gG = 1.0;
 
         return phi_gG / x_oGSat;
     }
@@ -468,6 +923,14 @@ private:
     {
         typedef Opm::MathToolbox<LhsEval> Toolbox;
 
+        // if the gas dissolution factor is strictly increasing, the saturation pressure
+        // is given directly by the inverse of its table. the derivatives are the ones of
+        // the inverse's segment.
+        if (hasSaturationPressureTable(regionIdx)) {
+            const LhsEval& Rs = gasDissolutionFactorFromMassFraction_(regionIdx, XoG);
+            return saturationPressureTable_[regionIdx].eval(Rs, /*extrapolate=*/true);
+        }
+
         // use the saturation pressure spline to get a pretty good initial value
         LhsEval pSat = saturationPressureSpline_[regionIdx].eval(XoG, /*extrapolate=*/true);
         LhsEval eps = pSat*1e-11;
@@ -495,8 +958,8 @@ private:
                                          const LhsEval& temperature,
                                          const LhsEval& pressure) const
     {
-        Scalar rho_gRef = BlackOilFluidSystem::referenceDensity(gasPhaseIdx, regionIdx);
-        Scalar rho_oRef = BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx);
+        Scalar rho_gRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+        Scalar rho_oRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
 
         // calculate the mass of the gas component [kg/m^3] in the oil phase. This is
         // equivalent to the gas dissolution factor [m^3/m^3] at current pressure times
@@ -518,14 +981,14 @@ private:
 
         // which can be converted to mole fractions, given the
         // components' molar masses
-        Scalar MG = BlackOilFluidSystem::molarMass(gasCompIdx, regionIdx);
-        Scalar MO = BlackOilFluidSystem::molarMass(oilCompIdx, regionIdx);
+        Scalar MG = referenceDensities_.molarMass(gasCompIdx, regionIdx);
+        Scalar MO = referenceDensities_.molarMass(oilCompIdx, regionIdx);
 
         LhsEval avgMolarMass = MO/(1 + XoG*(MO/MG - 1));
         return XoG*avgMolarMass/MG;
     }
 
-    void updateSaturationPressureSpline_(int regionIdx)
+    void updateSaturationPressureSpline_(int regionIdx, PvtRegionWorkspace<Scalar>& workspace)
     {
         auto& gasDissolutionFactor = gasDissolutionFactorTable_[regionIdx];
 
@@ -534,7 +997,9 @@ private:
         int n = gasDissolutionFactor.numSamples()*5;
         int delta = (gasDissolutionFactor.xMax() - gasDissolutionFactor.xMin())/(n + 1);
 
-        SamplingPoints pSatSamplePoints;
+        SamplingPoints& pSatSamplePoints = workspace.samplePoints;
+        pSatSamplePoints.clear();
+        pSatSamplePoints.reserve(n + 1);
         Scalar XoG = 0;
         for (int i=0; i <= n; ++ i) {
             Scalar pSat = gasDissolutionFactor.xMin() + i*delta;
@@ -542,6 +1007,12 @@ private:
                                                /*temperature=*/Scalar(1e100),
                                                pSat);
 
+            // the spline requires strictly increasing mass fractions. if the saturated
+            // mass fraction decreases at some pressure, only the branch below this
+            // pressure is used as the initial guess of the Newton method
+            if (!pSatSamplePoints.empty() && XoG <= pSatSamplePoints.back().first)
+                break;
+
             std::pair<Scalar, Scalar> val(XoG, pSat);
             pSatSamplePoints.push_back(val);
         }
@@ -549,13 +1020,133 @@ private:
                                                                   /*type=*/Spline::Monotonic);
     }
 
+    // the saturation pressure as a function of the gas dissolution factor, i.e., the
+    // inverse of gasDissolutionFactorTable_. empty if the latter is not invertible.
+    void updateSaturationPressureTable_(int regionIdx, PvtRegionWorkspace<Scalar>& workspace)
+    {
+        const auto& gasDissolutionFactor = gasDissolutionFactorTable_[regionIdx];
+        auto& pSatTable = saturationPressureTable_[regionIdx];
+
+        int n = gasDissolutionFactor.numSamples();
+        std::vector<Scalar>& RsValues = workspace.xValues;
+        std::vector<Scalar>& pValues = workspace.yValues;
+        RsValues.resize(n);
+        pValues.resize(n);
+        for (int i = 0; i < n; ++i) {
+            RsValues[i] = gasDissolutionFactor.valueAt(i);
+            pValues[i] = gasDissolutionFactor.xAt(i);
+
+            if (i > 0 && RsValues[i] <= RsValues[i - 1]) {
+                // the gas dissolution factor is not strictly increasing. use the Newton
+                // method instead
+                pSatTable = TabulatedOneDFunction();
+                return;
+            }
+        }
+
+        if (n < 2)
+            pSatTable = TabulatedOneDFunction();
+        else
+            pSatTable.setXYContainers(RsValues, pValues);
+    }
+
+    // tabulate the inverse formation volume factor of gas-saturated oil and the inverse
+    // of its product with the viscosity. they use the same pressures as the gas
+    // dissolution factor table, so the segment found for one of them applies to all.
+    void updateSaturatedTables_(int regionIdx, PvtRegionWorkspace<Scalar>& workspace)
+    {
+        const auto& gasDissolutionFactor = gasDissolutionFactorTable_[regionIdx];
+
+        int n = gasDissolutionFactor.numSamples();
+        std::vector<Scalar>& pValues = workspace.xValues;
+        std::vector<Scalar>& invBValues = workspace.yValues;
+        std::vector<Scalar>& invBMuValues = workspace.y2Values;
+        pValues.resize(n);
+        invBValues.resize(n);
+        invBMuValues.resize(n);
+        for (int i = 0; i < n; ++i) {
+            Scalar p = gasDissolutionFactor.xAt(i);
+            Scalar RsSat = gasDissolutionFactor.valueAt(i);
+
+            pValues[i] = p;
+            invBValues[i] = inverseOilBTable_[regionIdx].eval(RsSat, p, /*extrapolate=*/true);
+            invBMuValues[i] = inverseOilBMuTable_[regionIdx].eval(RsSat, p, /*extrapolate=*/true);
+        }
+
+        if (n < 2) {
+            saturatedInverseOilBTable_[regionIdx] = TabulatedOneDFunction();
+            saturatedInverseOilBMuTable_[regionIdx] = TabulatedOneDFunction();
+        }
+        else {
+            saturatedInverseOilBTable_[regionIdx].setXYContainers(pValues, invBValues);
+            saturatedInverseOilBMuTable_[regionIdx].setXYContainers(pValues, invBMuValues);
+        }
+    }
+
+    // resample the undersaturated tables onto uniform (R_s, p) grids if this was
+    // requested by setUniformTableResolution()
+    Scalar updateResampledTables_(int regionIdx)
+    {
+        auto& invB = resampledInverseOilBTable_[regionIdx];
+        auto& invBMu = resampledInverseOilBMuTable_[regionIdx];
+        if (numResampledRs_ < 2 || numResampledPressures_ < 2) {
+            invB = UniformTabulatedTwoDFunction();
+            invBMu = UniformTabulatedTwoDFunction();
+            return 0.0;
+        }
+
+        Scalar err = resampleUniformly(invB, inverseOilBTable_[regionIdx],
+                                       numResampledRs_, numResampledPressures_);
+        return std::max(err,
+                        resampleUniformly(invBMu, inverseOilBMuTable_[regionIdx],
+                                          numResampledRs_, numResampledPressures_));
+    }
+
+    // returns true iff the resampled tables are available and cover a given state
+    template <class LhsEval>
+    bool useResampledTables_(int regionIdx, const LhsEval& Rs, const LhsEval& pressure) const
+    {
+        typedef Opm::MathToolbox<LhsEval> Toolbox;
+
+        const auto& invB = resampledInverseOilBTable_[regionIdx];
+        return
+            enableResampledTables_
+            && invB.numX() > 0
+            && invB.applies(Toolbox::value(Rs), Toolbox::value(pressure));
+    }
+
     std::vector<TabulatedTwoDFunction> inverseOilBTable_;
     std::vector<TabulatedTwoDFunction> oilMuTable_;
     std::vector<TabulatedTwoDFunction> inverseOilBMuTable_;
     std::vector<TabulatedOneDFunction> gasDissolutionFactorTable_;
     std::vector<Spline> saturationPressureSpline_;
+    std::vector<TabulatedOneDFunction> saturationPressureTable_;
+    std::vector<TabulatedOneDFunction> saturatedInverseOilBTable_;
+    std::vector<TabulatedOneDFunction> saturatedInverseOilBMuTable_;
+    std::vector<UniformTabulatedTwoDFunction> resampledInverseOilBTable_;
+    std::vector<UniformTabulatedTwoDFunction> resampledInverseOilBMuTable_;
+
+    Scalar tableSimplificationTolerance_;
+    int numResampledRs_;
+    int numResampledPressures_;
+    Scalar maxResamplingError_;
+    bool enableResampledTables_;
+
+    PvtReferenceDensities<Scalar, BlackOilFluidSystem> referenceDensities_;
 };
 
 } // namespace Opm
 
+// the instantiations which are provided by the library, cf. ExplicitInstantiations.hpp
+#define OPM_LIVE_OIL_PVT_INSTANTIATIONS(KEYWORD, Evaluation) \
+    KEYWORD class Opm::OilPvtInterfaceTemplateWrapper<double, Evaluation, \
+                                                      Opm::LiveOilPvt<double, Evaluation> >; \
+    KEYWORD class Opm::LiveOilPvt<double, Evaluation>;
+
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+#include <opm/material/common/ExplicitInstantiations.hpp>
+
+OPM_MATERIAL_FOR_EACH_EVALUATION(OPM_LIVE_OIL_PVT_INSTANTIATIONS, extern template)
+#endif
+
 #endif
@@ -25,9 +25,14 @@
 #ifndef OPM_OIL_PVT_INTERFACE_HPP
 #define OPM_OIL_PVT_INTERFACE_HPP
 
+#include "BlackOilPhaseProperties.hpp"
+
 #include <opm/material/common/OpmFinal.hpp>
 
 namespace Opm {
+template <class Scalar, class Evaluation>
+class OilPvtMultiplexer;
+
 /*!
  * \brief This class represents the Pressure-Volume-Temperature relations of the oil
  *        phase in the black-oil model.
@@ -80,6 +85,22 @@ public:
                            Scalar pressure,
                            Scalar XoG) const = 0;
 
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the fluid phase at once.
+     *
+     * This is cheaper than calling the individual methods because the table
+     * lookups are shared.
+     */
+    virtual BlackOilPhaseProperties<Evaluation> properties(int regionIdx,
+                                                           const Evaluation& temperature,
+                                                           const Evaluation& pressure,
+                                                           const Evaluation& XoG) const = 0;
+    virtual BlackOilPhaseProperties<Scalar> properties(int regionIdx,
+                                                       Scalar temperature,
+                                                       Scalar pressure,
+                                                       Scalar XoG) const = 0;
+
     /*!
      * \brief Returns the fugacity coefficient [Pa] of a component in the fluid phase given
      *        a set of parameters.
@@ -176,6 +197,18 @@ public:
                            Scalar pressure,
                            Scalar XoG) const = 0;
 
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the fluid phase at once.
+     *
+     * This is cheaper than calling the individual methods because the table
+     * lookups are shared.
+     */
+    virtual BlackOilPhaseProperties<Scalar> properties(int regionIdx,
+                                                       Scalar temperature,
+                                                       Scalar pressure,
+                                                       Scalar XoG) const = 0;
+
     /*!
      * \brief Returns the fugacity coefficient [Pa] of a component in the fluid phase given
      *        a set of parameters.
@@ -265,6 +298,17 @@ class OilPvtInterfaceTemplateWrapper
                    Scalar XoG) const OPM_FINAL
     { return asImp_().template density_<Scalar>(regionIdx, temperature, pressure, XoG); }
 
+    BlackOilPhaseProperties<Evaluation> properties(int regionIdx,
+                                                   const Evaluation& temperature,
+                                                   const Evaluation& pressure,
+                                                   const Evaluation& XoG) const OPM_FINAL
+    { return asImp_().template properties_<Evaluation>(regionIdx, temperature, pressure, XoG); }
+    BlackOilPhaseProperties<Scalar> properties(int regionIdx,
+                                               Scalar temperature,
+                                               Scalar pressure,
+                                               Scalar XoG) const OPM_FINAL
+    { return asImp_().template properties_<Scalar>(regionIdx, temperature, pressure, XoG); }
+
     Evaluation fugacityCoefficient(int regionIdx,
                                    const Evaluation& temperature,
                                    const Evaluation& pressure,
@@ -336,6 +380,11 @@ class OilPvtInterfaceTemplateWrapper<Scalar, Scalar, Implementation>
                    Scalar pressure,
                    Scalar XoG) const OPM_FINAL
     { return asImp_().template density_<Scalar>(regionIdx, temperature, pressure, XoG); }
+    BlackOilPhaseProperties<Scalar> properties(int regionIdx,
+                                               Scalar temperature,
+                                               Scalar pressure,
+                                               Scalar XoG) const OPM_FINAL
+    { return asImp_().template properties_<Scalar>(regionIdx, temperature, pressure, XoG); }
     Scalar fugacityCoefficient(int regionIdx,
                                Scalar temperature,
                                Scalar pressure,
@@ -0,0 +1,403 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::OilPvtMultiplexer
+ */
+#ifndef OPM_OIL_PVT_MULTIPLEXER_HPP
+#define OPM_OIL_PVT_MULTIPLEXER_HPP
+
+#include "OilPvtInterface.hpp"
+#include "GenericPvtProperties.hpp"
+#include "PvtRegionOrdering.hpp"
+
+namespace Opm {
+// the implementation classes include the black-oil fluid system which in turn includes
+// this file, so they might not be defined yet at this point.
+template <class Scalar, class Evaluation>
+class LiveOilPvt;
+template <class Scalar, class Evaluation>
+class DeadOilPvt;
+template <class Scalar, class Evaluation>
+class ConstantCompressibilityOilPvt;
+} // namespace Opm
+
+#include "LiveOilPvt.hpp"
+#include "DeadOilPvt.hpp"
+#include "ConstantCompressibilityOilPvt.hpp"
+
+#include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/Instrumentation.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
+
+#include <cassert>
+#include <memory>
+#include <type_traits>
+
+namespace Opm {
+enum OilPvtApproach {
+    NoOilPvtApproach,
+    GenericOilPvtApproach,
+    LiveOilPvtApproach,
+    DeadOilPvtApproach,
+    ConstantCompressibilityOilPvtApproach
+};
+
+#define OPM_OIL_PVT_MULTIPLEXER_CALL(codeToCall)                                     \
+    switch (approach_) {                                                             \
+    case LiveOilPvtApproach: {                                                       \
+        const auto& pvtImpl = getRealPvt<LiveOilPvtApproach>();                      \
+        codeToCall;                                                                  \
+    }                                                                                \
+    case DeadOilPvtApproach: {                                                       \
+        const auto& pvtImpl = getRealPvt<DeadOilPvtApproach>();                      \
+        codeToCall;                                                                  \
+    }                                                                                \
+    case ConstantCompressibilityOilPvtApproach: {                                    \
+        const auto& pvtImpl = getRealPvt<ConstantCompressibilityOilPvtApproach>();   \
+        codeToCall;                                                                  \
+    }                                                                                \
+    case NoOilPvtApproach:                                                           \
+        OPM_THROW(std::logic_error, "No PVT relations have been set for the oil phase"); \
+    case GenericOilPvtApproach:                                                      \
+        break;                                                                       \
+    }
+
+/*!
+ * \brief Dispatches the calls for the PVT relations of the oil phase to the actual
+ *        implementation without using virtual methods.
+ *
+ * The PVT objects are passed to the black-oil fluid system as pointers to
+ * OilPvtInterface. This class determines the implementation class of such an object
+ * when it is set and then calls the (inlinable) methods of the implementation
+ * directly. If the object is not one of the implementations which are shipped with
+ * opm-material, the virtual methods of the interface are used.
+ */
+template <class Scalar, class Evaluation = Scalar>
+class OilPvtMultiplexer
+{
+    typedef Opm::OilPvtInterface<Scalar, Evaluation> OilPvtInterface;
+    typedef Opm::LiveOilPvt<Scalar, Evaluation> LiveOilPvt;
+    typedef Opm::DeadOilPvt<Scalar, Evaluation> DeadOilPvt;
+    typedef Opm::ConstantCompressibilityOilPvt<Scalar, Evaluation> ConstantCompressibilityOilPvt;
+
+public:
+    OilPvtMultiplexer()
+        : approach_(NoOilPvtApproach)
+    {}
+
+    /*!
+     * \brief Set the object which implements the PVT relations.
+     *
+     * This determines the approach which is used for all subsequent calls.
+     */
+    void setPvt(std::shared_ptr<const OilPvtInterface> pvtObj)
+    {
+        pvt_ = pvtObj;
+
+        const OilPvtInterface* p = pvt_.get();
+        if (!p)
+            approach_ = NoOilPvtApproach;
+        else if (dynamic_cast<const LiveOilPvt*>(p))
+            approach_ = LiveOilPvtApproach;
+        else if (dynamic_cast<const DeadOilPvt*>(p))
+            approach_ = DeadOilPvtApproach;
+        else if (dynamic_cast<const ConstantCompressibilityOilPvt*>(p))
+            approach_ = ConstantCompressibilityOilPvtApproach;
+        else
+            approach_ = GenericOilPvtApproach;
+    }
+
+    /*!
+     * \brief Returns the object which implements the PVT relations.
+     */
+    const std::shared_ptr<const OilPvtInterface>& pvt() const
+    { return pvt_; }
+
+    /*!
+     * \brief Returns the approach which is used to dispatch the calls.
+     */
+    OilPvtApproach approach() const
+    { return approach_; }
+
+    // get the implementation object for live oil
+    template <OilPvtApproach approachV>
+    typename std::enable_if<approachV == LiveOilPvtApproach, const LiveOilPvt>::type&
+    getRealPvt() const
+    {
+        assert(approach() == approachV);
+        return *static_cast<const LiveOilPvt*>(pvt_.get());
+    }
+
+    // get the implementation object for dead oil
+    template <OilPvtApproach approachV>
+    typename std::enable_if<approachV == DeadOilPvtApproach, const DeadOilPvt>::type&
+    getRealPvt() const
+    {
+        assert(approach() == approachV);
+        return *static_cast<const DeadOilPvt*>(pvt_.get());
+    }
+
+    // get the implementation object for oil with constant compressibility
+    template <OilPvtApproach approachV>
+    typename std::enable_if<approachV == ConstantCompressibilityOilPvtApproach, const ConstantCompressibilityOilPvt>::type&
+    getRealPvt() const
+    {
+        assert(approach() == approachV);
+        return *static_cast<const ConstantCompressibilityOilPvt*>(pvt_.get());
+    }
+
+    /*!
+     * \copydoc OilPvtInterface::viscosity
+     */
+    template <class LhsEval>
+    LhsEval viscosity(int regionIdx,
+                      const LhsEval& temperature,
+                      const LhsEval& pressure,
+                      const LhsEval& XoG) const
+    {
+        OPM_INSTRUMENT_SCOPE("OilPvt::viscosity");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.template viscosity_<LhsEval>(regionIdx, temperature, pressure, XoG));
+        return pvt_->viscosity(regionIdx, temperature, pressure, XoG);
+    }
+
+    /*!
+     * \copydoc OilPvtInterface::formationVolumeFactor
+     */
+    template <class LhsEval>
+    LhsEval formationVolumeFactor(int regionIdx,
+                                  const LhsEval& temperature,
+                                  const LhsEval& pressure,
+                                  const LhsEval& XoG) const
+    {
+        OPM_INSTRUMENT_SCOPE("OilPvt::formationVolumeFactor");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.template formationVolumeFactor_<LhsEval>(regionIdx, temperature, pressure, XoG));
+        return pvt_->formationVolumeFactor(regionIdx, temperature, pressure, XoG);
+    }
+
+    /*!
+     * \copydoc OilPvtInterface::density
+     */
+    template <class LhsEval>
+    LhsEval density(int regionIdx,
+                    const LhsEval& temperature,
+                    const LhsEval& pressure,
+                    const LhsEval& XoG) const
+    {
+        OPM_INSTRUMENT_SCOPE("OilPvt::density");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.template density_<LhsEval>(regionIdx, temperature, pressure, XoG));
+        return pvt_->density(regionIdx, temperature, pressure, XoG);
+    }
+
+    /*!
+     * \copydoc OilPvtInterface::properties
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> properties(int regionIdx,
+                                                const LhsEval& temperature,
+                                                const LhsEval& pressure,
+                                                const LhsEval& XoG) const
+    {
+        OPM_INSTRUMENT_SCOPE("OilPvt::properties");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.template properties_<LhsEval>(regionIdx, temperature, pressure, XoG));
+        return GenericPvtProperties<Scalar, Evaluation>::template eval<LhsEval>(*pvt_, "oil", regionIdx, temperature, pressure, XoG);
+    }
+
+    /*!
+     * \copydoc OilPvtInterface::fugacityCoefficient
+     */
+    template <class LhsEval>
+    LhsEval fugacityCoefficient(int regionIdx,
+                                const LhsEval& temperature,
+                                const LhsEval& pressure,
+                                int compIdx) const
+    {
+        OPM_INSTRUMENT_SCOPE("OilPvt::fugacityCoefficient");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.template fugacityCoefficient_<LhsEval>(regionIdx, temperature, pressure, compIdx));
+        return pvt_->fugacityCoefficient(regionIdx, temperature, pressure, compIdx);
+    }
+
+    /*!
+     * \copydoc OilPvtInterface::gasDissolutionFactor
+     */
+    template <class LhsEval>
+    LhsEval gasDissolutionFactor(int regionIdx,
+                                 const LhsEval& temperature,
+                                 const LhsEval& pressure) const
+    {
+        OPM_INSTRUMENT_SCOPE("OilPvt::gasDissolutionFactor");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.template gasDissolutionFactor_<LhsEval>(regionIdx, temperature, pressure));
+        return pvt_->gasDissolutionFactor(regionIdx, temperature, pressure);
+    }
+
+    /*!
+     * \copydoc OilPvtInterface::oilSaturationPressure
+     */
+    template <class LhsEval>
+    LhsEval oilSaturationPressure(int regionIdx,
+                                  const LhsEval& temperature,
+                                  const LhsEval& XoG) const
+    {
+        OPM_INSTRUMENT_SCOPE("OilPvt::oilSaturationPressure");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.template oilSaturationPressure_<LhsEval>(regionIdx, temperature, XoG));
+        return pvt_->oilSaturationPressure(regionIdx, temperature, XoG);
+    }
+
+    /*!
+     * \copydoc OilPvtInterface::saturatedOilGasMassFraction
+     */
+    template <class LhsEval>
+    LhsEval saturatedOilGasMassFraction(int regionIdx,
+                                        const LhsEval& temperature,
+                                        const LhsEval& pressure) const
+    {
+        OPM_INSTRUMENT_SCOPE("OilPvt::saturatedOilGasMassFraction");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.template saturatedOilGasMassFraction_<LhsEval>(regionIdx, temperature, pressure));
+        return pvt_->saturatedOilGasMassFraction(regionIdx, temperature, pressure);
+    }
+
+    /*!
+     * \copydoc OilPvtInterface::saturatedOilGasMoleFraction
+     */
+    template <class LhsEval>
+    LhsEval saturatedOilGasMoleFraction(int regionIdx,
+                                        const LhsEval& temperature,
+                                        const LhsEval& pressure) const
+    {
+        OPM_INSTRUMENT_SCOPE("OilPvt::saturatedOilGasMoleFraction");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.template saturatedOilGasMoleFraction_<LhsEval>(regionIdx, temperature, pressure));
+        return pvt_->saturatedOilGasMoleFraction(regionIdx, temperature, pressure);
+    }
+
+    /*!
+     * \brief Computes the inverse formation volume factor, the viscosity, the inverse
+     *        of their product and the density of the oil phase for a set of cells.
+     *
+     * The input and output arrays are indexed by the cell index. The cells are
+     * processed in the order given by the PvtRegionOrdering object, i.e., region by
+     * region, and the PVT approach is only dispatched once for the whole batch.
+     */
+    template <class LhsEval>
+    void propertiesBatch(const PvtRegionOrdering& ordering,
+                         const LhsEval* temperature,
+                         const LhsEval* pressure,
+                         const LhsEval* XoG,
+                         BlackOilPhaseProperties<LhsEval>* result) const
+    {
+        OPM_PROFILER_RANGE("OilPvtMultiplexer::propertiesBatch");
+
+        OPM_OIL_PVT_MULTIPLEXER_CALL(forEachCell_(ordering, [&](int regionIdx, unsigned cellIdx) {
+                    result[cellIdx] = pvtImpl.template properties_<LhsEval>(regionIdx, temperature[cellIdx], pressure[cellIdx], XoG[cellIdx]);
+                }); return);
+        forEachCell_(ordering, [&](int regionIdx, unsigned cellIdx) {
+                result[cellIdx] = pvt_->properties(regionIdx, temperature[cellIdx], pressure[cellIdx], XoG[cellIdx]);
+            });
+    }
+
+    /*!
+     * \brief Computes the viscosity of the oil phase for a set of cells.
+     *
+     * \copydetails propertiesBatch
+     */
+    template <class LhsEval>
+    void viscosityBatch(const PvtRegionOrdering& ordering,
+                        const LhsEval* temperature,
+                        const LhsEval* pressure,
+                        const LhsEval* XoG,
+                        LhsEval* result) const
+    {
+        OPM_PROFILER_RANGE("OilPvtMultiplexer::viscosityBatch");
+
+        OPM_OIL_PVT_MULTIPLEXER_CALL(forEachCell_(ordering, [&](int regionIdx, unsigned cellIdx) {
+                    result[cellIdx] = pvtImpl.template viscosity_<LhsEval>(regionIdx, temperature[cellIdx], pressure[cellIdx], XoG[cellIdx]);
+                }); return);
+        forEachCell_(ordering, [&](int regionIdx, unsigned cellIdx) {
+                result[cellIdx] = pvt_->viscosity(regionIdx, temperature[cellIdx], pressure[cellIdx], XoG[cellIdx]);
+            });
+    }
+
+    /*!
+     * \brief Computes the formation volume factor of the oil phase for a set of cells.
+     *
+     * \copydetails propertiesBatch
+     */
+    template <class LhsEval>
+    void formationVolumeFactorBatch(const PvtRegionOrdering& ordering,
+                                    const LhsEval* temperature,
+                                    const LhsEval* pressure,
+                                    const LhsEval* XoG,
+                                    LhsEval* result) const
+    {
+        OPM_PROFILER_RANGE("OilPvtMultiplexer::formationVolumeFactorBatch");
+
+        OPM_OIL_PVT_MULTIPLEXER_CALL(forEachCell_(ordering, [&](int regionIdx, unsigned cellIdx) {
+                    result[cellIdx] = pvtImpl.template formationVolumeFactor_<LhsEval>(regionIdx, temperature[cellIdx], pressure[cellIdx], XoG[cellIdx]);
+                }); return);
+        forEachCell_(ordering, [&](int regionIdx, unsigned cellIdx) {
+                result[cellIdx] = pvt_->formationVolumeFactor(regionIdx, temperature[cellIdx], pressure[cellIdx], XoG[cellIdx]);
+            });
+    }
+
+    /*!
+     * \brief Computes the density of the oil phase for a set of cells.
+     *
+     * \copydetails propertiesBatch
+     */
+    template <class LhsEval>
+    void densityBatch(const PvtRegionOrdering& ordering,
+                      const LhsEval* temperature,
+                      const LhsEval* pressure,
+                      const LhsEval* XoG,
+                      LhsEval* result) const
+    {
+        OPM_PROFILER_RANGE("OilPvtMultiplexer::densityBatch");
+
+        OPM_OIL_PVT_MULTIPLEXER_CALL(forEachCell_(ordering, [&](int regionIdx, unsigned cellIdx) {
+                    result[cellIdx] = pvtImpl.template density_<LhsEval>(regionIdx, temperature[cellIdx], pressure[cellIdx], XoG[cellIdx]);
+                }); return);
+        forEachCell_(ordering, [&](int regionIdx, unsigned cellIdx) {
+                result[cellIdx] = pvt_->density(regionIdx, temperature[cellIdx], pressure[cellIdx], XoG[cellIdx]);
+            });
+    }
+
+private:
+    // call a functor for all cells, region by region
+    template <class Functor>
+    static void forEachCell_(const PvtRegionOrdering& ordering, const Functor& f)
+    {
+        for (int regionIdx = 0; regionIdx < ordering.numRegions(); ++regionIdx) {
+            const unsigned* cells = ordering.regionCells(regionIdx);
+            size_t n = ordering.numCells(regionIdx);
+            for (size_t i = 0; i < n; ++i)
+                f(regionIdx, cells[i]);
+        }
+    }
+
+    OilPvtApproach approach_;
+    std::shared_ptr<const OilPvtInterface> pvt_;
+};
+
+#undef OPM_OIL_PVT_MULTIPLEXER_CALL
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,120 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::PvtReferenceDensities
+ */
+#ifndef OPM_PVT_REFERENCE_DENSITIES_HPP
+#define OPM_PVT_REFERENCE_DENSITIES_HPP
+
+#include <opm/material/common/TableHash.hpp>
+#include <opm/material/Constants.hpp>
+
+#include <array>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Stores the densities of the fluid phases at surface conditions which are used
+ *        by the PVT classes of the black-oil model.
+ *
+ * If the reference densities have not been set explicitly, the ones of the default
+ * instance of the black-oil fluid system are used. Explicitly setting them is required
+ * if the PVT object is used by a BlackOilInstance object with different reference
+ * densities. The same applies to the molar masses of the components, which are
+ * derived from the reference densities.
+ */
+template <class Scalar, class BlackOilFluidSystem>
+class PvtReferenceDensities
+{
+public:
+    /*!
+     * \brief Set the reference densities of a PVT region.
+     *
+     * \param rhoOil The reference density of (gas saturated) oil phase.
+     * \param rhoWater The reference density of the water phase.
+     * \param rhoGas The reference density of the gas phase.
+     */
+    void setReferenceDensities(Scalar rhoOil,
+                               Scalar rhoWater,
+                               Scalar rhoGas,
+                               int regionIdx)
+    {
+        if (static_cast<int>(referenceDensity_.size()) <= regionIdx)
+            referenceDensity_.resize(regionIdx + 1);
+
+        referenceDensity_[regionIdx][BlackOilFluidSystem::oilPhaseIdx] = rhoOil;
+        referenceDensity_[regionIdx][BlackOilFluidSystem::waterPhaseIdx] = rhoWater;
+        referenceDensity_[regionIdx][BlackOilFluidSystem::gasPhaseIdx] = rhoGas;
+    }
+
+    /*!
+     * \brief Returns the density of a fluid phase at surface conditions [kg/m^3]
+     */
+    Scalar referenceDensity(int phaseIdx, int regionIdx) const
+    {
+        if (referenceDensity_.empty())
+            return BlackOilFluidSystem::referenceDensity(phaseIdx, regionIdx);
+
+        return referenceDensity_[regionIdx][phaseIdx];
+    }
+
+    /*!
+     * \brief Returns the molar mass of a component [kg/mol]
+     *
+     * The molar masses are derived from the reference densities in the same way as by
+     * BlackOilInstance::initEnd(): The gas component is assumed to be an ideal gas at
+     * surface conditions and the molar masses of the oil and the water components are
+     * fixed. Thus, the PVT objects do not need to access a fluid system object for them.
+     */
+    Scalar molarMass(int compIdx, int /*regionIdx*/) const
+    {
+        if (compIdx == BlackOilFluidSystem::waterCompIdx)
+            return 18e-3;
+        else if (compIdx == BlackOilFluidSystem::oilCompIdx)
+            return 175e-3;
+
+        Scalar p = BlackOilFluidSystem::surfacePressure;
+        Scalar T = BlackOilFluidSystem::surfaceTemperature;
+        Scalar rho_g = referenceDensity(BlackOilFluidSystem::gasPhaseIdx, /*regionIdx=*/0);
+        return Opm::Constants<Scalar>::R*T*rho_g / p;
+    }
+
+    bool operator==(const PvtReferenceDensities& other) const
+    { return referenceDensity_ == other.referenceDensity_; }
+
+    /*!
+     * \brief Returns a hash value of the explicitly set reference densities.
+     */
+    size_t contentHash() const
+    {
+        size_t seed = hashCombine(0, referenceDensity_.size());
+        for (const auto& densities : referenceDensity_)
+            seed = hashValues(seed, densities);
+        return seed;
+    }
+
+private:
+    std::vector<std::array<Scalar, 3> > referenceDensity_;
+};
+} // namespace Opm
+
+#endif
@@ -0,0 +1,90 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::forEachPvtRegion
+ */
+#ifndef OPM_PVT_REGION_LOOP_HPP
+#define OPM_PVT_REGION_LOOP_HPP
+
+#include <exception>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Scratch space for the setup of the tables of a single PVT region.
+ *
+ * The initEnd() methods of the PVT classes build several temporary columns for
+ * each region. Each thread reuses one workspace for all of its regions, so the
+ * vectors are only reallocated if a region has more sampling points than the
+ * previous ones.
+ */
+template <class Scalar>
+struct PvtRegionWorkspace
+{
+    std::vector<std::pair<Scalar, Scalar> > samplePoints;
+    std::vector<Scalar> xValues;
+    std::vector<Scalar> yValues;
+    std::vector<Scalar> y2Values;
+};
+
+/*!
+ * \brief Call a functor for each PVT region.
+ *
+ * The functor is called with the index of the region and the workspace of the
+ * calling thread, i.e., as functor(regionIdx, workspace). If OpenMP is enabled,
+ * the regions are processed in parallel, so the functor must only modify the
+ * objects which belong to its region. The first exception which is thrown by the
+ * functor is re-thrown after all threads are done.
+ */
+template <class Scalar, class Functor>
+void forEachPvtRegion(int numRegions, const Functor& functor)
+{
+#ifdef _OPENMP
+    std::exception_ptr exception;
+    #pragma omp parallel if (numRegions > 1)
+    {
+        PvtRegionWorkspace<Scalar> workspace;
+
+        #pragma omp for schedule(dynamic)
+        for (int regionIdx = 0; regionIdx < numRegions; ++ regionIdx) {
+            try { functor(regionIdx, workspace); }
+            catch (...) {
+                #pragma omp critical (OpmPvtRegionLoopException)
+                if (!exception)
+                    exception = std::current_exception();
+            }
+        }
+    }
+
+    if (exception)
+        std::rethrow_exception(exception);
+#else
+    PvtRegionWorkspace<Scalar> workspace;
+    for (int regionIdx = 0; regionIdx < numRegions; ++ regionIdx)
+        functor(regionIdx, workspace);
+#endif
+}
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,127 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::PvtRegionOrdering
+ */
+#ifndef OPM_PVT_REGION_ORDERING_HPP
+#define OPM_PVT_REGION_ORDERING_HPP
+
+#include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief An ordering of the cells of a grid which groups them by their PVT region.
+ *
+ * The batched methods of the PVT multiplexers process the cells in this order, so
+ * that the tables of a region only need to be brought into the cache once for all
+ * of its cells. Within a region, the cells are sorted by their index.
+ *
+ * The ordering is usually built once after the grid has been loaded, e.g. from the
+ * PVTNUM keyword.
+ */
+class PvtRegionOrdering
+{
+public:
+    PvtRegionOrdering()
+    { regionOffsets_.resize(1, 0); }
+
+    /*!
+     * \brief Build the ordering from the PVT region index of each cell.
+     *
+     * The region indices must be in the range [0, numRegions). If numRegions is not
+     * specified, it is determined by the largest region index.
+     */
+    void setRegionIndices(const std::vector<int>& cellRegionIdx, int numRegions = -1)
+    {
+        if (numRegions < 0) {
+            numRegions = 0;
+            for (size_t cellIdx = 0; cellIdx < cellRegionIdx.size(); ++cellIdx)
+                numRegions = std::max(numRegions, cellRegionIdx[cellIdx] + 1);
+        }
+
+        // counting sort: determine the number of cells of each region and convert
+        // these numbers to offsets
+        regionOffsets_.assign(numRegions + 1, 0);
+        for (size_t cellIdx = 0; cellIdx < cellRegionIdx.size(); ++cellIdx) {
+            int regionIdx = cellRegionIdx[cellIdx];
+            if (regionIdx < 0 || regionIdx >= numRegions)
+                OPM_THROW(std::runtime_error,
+                          "Invalid PVT region index " << regionIdx << " for cell " << cellIdx);
+            ++ regionOffsets_[regionIdx + 1];
+        }
+        for (int regionIdx = 0; regionIdx < numRegions; ++regionIdx)
+            regionOffsets_[regionIdx + 1] += regionOffsets_[regionIdx];
+
+        std::vector<unsigned> nextPos(regionOffsets_.begin(), regionOffsets_.end() - 1);
+        cellIndices_.resize(cellRegionIdx.size());
+        for (size_t cellIdx = 0; cellIdx < cellRegionIdx.size(); ++cellIdx)
+            cellIndices_[nextPos[cellRegionIdx[cellIdx]]++] = static_cast<unsigned>(cellIdx);
+    }
+
+    /*!
+     * \brief Returns the number of PVT regions.
+     */
+    int numRegions() const
+    { return static_cast<int>(regionOffsets_.size()) - 1; }
+
+    /*!
+     * \brief Returns the total number of cells.
+     */
+    size_t numCells() const
+    { return cellIndices_.size(); }
+
+    /*!
+     * \brief Returns the number of cells of a PVT region.
+     */
+    size_t numCells(int regionIdx) const
+    { return regionOffsets_[regionIdx + 1] - regionOffsets_[regionIdx]; }
+
+    /*!
+     * \brief Returns a pointer to the sorted indices of the cells of a PVT region.
+     *
+     * The indices of all cells of the region are stored contiguously, i.e., the
+     * pointer can be used for numCells(regionIdx) entries.
+     */
+    const unsigned* regionCells(int regionIdx) const
+    {
+        assert(0 <= regionIdx && regionIdx < numRegions());
+        return cellIndices_.data() + regionOffsets_[regionIdx];
+    }
+
+    /*!
+     * \brief Returns the indices of all cells grouped by their PVT region.
+     */
+    const std::vector<unsigned>& cellIndices() const
+    { return cellIndices_; }
+
+private:
+    std::vector<unsigned> cellIndices_;
+    std::vector<unsigned> regionOffsets_;
+};
+} // namespace Opm
+
+#endif
@@ -0,0 +1,242 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::PvtTableArrays
+ */
+#ifndef OPM_PVT_TABLE_ARRAYS_HPP
+#define OPM_PVT_TABLE_ARRAYS_HPP
+
+#include <opm/material/common/TableFile.hpp>
+
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief The columns of the PVT tables of all regions for one of the PVTO, PVTG, PVDO
+ *        or PVDG keywords.
+ *
+ * This allows to set up the PVT classes without opm-parser, e.g., by programs which
+ * need to create the PVT relations of many similar models: The tables can be filled
+ * directly or be read from a file which was written by save(). The tables are then
+ * passed to the PVT objects using setPvtoTables(), setPvtgTables(), setPvdoTables() or
+ * setPvdgTables(). The number of regions and the reference densities of the PVT
+ * objects still need to be set by the caller.
+ *
+ * \tparam Scalar The type used for scalar values
+ */
+template <class Scalar>
+class PvtTableArrays
+{
+public:
+    /*!
+     * \brief The columns of the table of a PVT region.
+     *
+     * For PVTO and PVTG tables, the rows of the outer value i are
+     * [rowOffsets[i], rowOffsets[i + 1]); for PVDO and PVDG tables, the outer values
+     * and the row offsets are empty.
+     */
+    struct Region
+    {
+        //! The gas dissolution factors (PVTO) resp. the gas pressures (PVTG)
+        std::vector<Scalar> outer;
+
+        //! The index of the first row of each outer value and the number of rows
+        std::vector<int> rowOffsets;
+
+        //! The pressures (PVTO, PVDO, PVDG) resp. the oil vaporization factors (PVTG)
+        std::vector<Scalar> inner;
+
+        //! The formation volume factors of the rows
+        std::vector<Scalar> formationVolumeFactor;
+
+        //! The viscosities of the rows [Pa s]
+        std::vector<Scalar> viscosity;
+    };
+
+    /*!
+     * \brief Returns the number of PVT regions.
+     */
+    int numRegions() const
+    { return static_cast<int>(regions_.size()); }
+
+    /*!
+     * \brief Set the number of PVT regions.
+     */
+    void setNumRegions(int numRegions)
+    { regions_.resize(numRegions); }
+
+    /*!
+     * \brief Returns the columns of the table of a PVT region.
+     */
+    Region& region(int regionIdx)
+    { return regions_[regionIdx]; }
+
+    /*!
+     * \brief Returns the columns of the table of a PVT region.
+     */
+    const Region& region(int regionIdx) const
+    { return regions_[regionIdx]; }
+
+    /*!
+     * \brief Write the tables to a file.
+     *
+     * \param fileName The name of the file
+     * \param key The string which identifies the tables, e.g., the name of the model
+     */
+    void save(const std::string& fileName, const std::string& key) const
+    {
+        std::vector<const void*> arrays;
+        std::vector<size_t> sizes;
+        for (size_t regionIdx = 0; regionIdx < regions_.size(); ++regionIdx) {
+            const Region& r = regions_[regionIdx];
+            addArray_(arrays, sizes, r.outer);
+            addArray_(arrays, sizes, r.rowOffsets);
+            addArray_(arrays, sizes, r.inner);
+            addArray_(arrays, sizes, r.formationVolumeFactor);
+            addArray_(arrays, sizes, r.viscosity);
+        }
+
+        TableFile::write(fileName, fileKey_(key), arrays, sizes);
+    }
+
+    /*!
+     * \brief Read the tables from a file which was written by save().
+     *
+     * \return false if the file does not exist or if it was written using a different
+     *         key or scalar type. In this case, the object is not modified.
+     */
+    bool load(const std::string& fileName, const std::string& key)
+    {
+        TableFile file;
+        if (!file.open(fileName, fileKey_(key))
+            || file.numArrays() % numArraysPerRegion_ != 0)
+            return false;
+
+        std::vector<Region> regions(file.numArrays()/numArraysPerRegion_);
+        for (size_t regionIdx = 0; regionIdx < regions.size(); ++regionIdx) {
+            Region& r = regions[regionIdx];
+            size_t arrayIdx = regionIdx*numArraysPerRegion_;
+            if (!readArray_(r.outer, file, arrayIdx + 0)
+                || !readArray_(r.rowOffsets, file, arrayIdx + 1)
+                || !readArray_(r.inner, file, arrayIdx + 2)
+                || !readArray_(r.formationVolumeFactor, file, arrayIdx + 3)
+                || !readArray_(r.viscosity, file, arrayIdx + 4))
+                return false;
+        }
+
+        regions_.swap(regions);
+        return true;
+    }
+
+    /*!
+     * \brief Initialize the PVTO tables of a LiveOilPvt object.
+     */
+    template <class OilPvt>
+    void setPvtoTables(OilPvt& oilPvt) const
+    {
+        for (int regionIdx = 0; regionIdx < numRegions(); ++regionIdx) {
+            const Region& r = regions_[regionIdx];
+            assert(r.rowOffsets.size() == r.outer.size() + 1);
+            oilPvt.setPvtoArrays(regionIdx, static_cast<int>(r.outer.size()), r.outer.data(),
+                                 r.rowOffsets.data(), r.inner.data(),
+                                 r.formationVolumeFactor.data(), r.viscosity.data());
+        }
+    }
+
+    /*!
+     * \brief Initialize the PVTG tables of a WetGasPvt object.
+     */
+    template <class GasPvt>
+    void setPvtgTables(GasPvt& gasPvt) const
+    {
+        for (int regionIdx = 0; regionIdx < numRegions(); ++regionIdx) {
+            const Region& r = regions_[regionIdx];
+            assert(r.rowOffsets.size() == r.outer.size() + 1);
+            gasPvt.setPvtgArrays(regionIdx, static_cast<int>(r.outer.size()), r.outer.data(),
+                                 r.rowOffsets.data(), r.inner.data(),
+                                 r.formationVolumeFactor.data(), r.viscosity.data());
+        }
+    }
+
+    /*!
+     * \brief Initialize the PVDO tables of a DeadOilPvt object.
+     */
+    template <class OilPvt>
+    void setPvdoTables(OilPvt& oilPvt) const
+    {
+        for (int regionIdx = 0; regionIdx < numRegions(); ++regionIdx) {
+            const Region& r = regions_[regionIdx];
+            oilPvt.setPvdoArrays(regionIdx, static_cast<int>(r.inner.size()), r.inner.data(),
+                                 r.formationVolumeFactor.data(), r.viscosity.data());
+        }
+    }
+
+    /*!
+     * \brief Initialize the PVDG tables of a DryGasPvt object.
+     */
+    template <class GasPvt>
+    void setPvdgTables(GasPvt& gasPvt) const
+    {
+        for (int regionIdx = 0; regionIdx < numRegions(); ++regionIdx) {
+            const Region& r = regions_[regionIdx];
+            gasPvt.setPvdgArrays(regionIdx, static_cast<int>(r.inner.size()), r.inner.data(),
+                                 r.formationVolumeFactor.data(), r.viscosity.data());
+        }
+    }
+
+private:
+    enum { numArraysPerRegion_ = 5 };
+
+    static std::string fileKey_(const std::string& key)
+    { return key + " (PVT tables, sizeof(Scalar)=" + std::to_string(sizeof(Scalar)) + ")"; }
+
+    template <class T>
+    static void addArray_(std::vector<const void*>& arrays,
+                          std::vector<size_t>& sizes,
+                          const std::vector<T>& values)
+    {
+        static const T dummy = T();
+        arrays.push_back(values.empty() ? &dummy : values.data());
+        sizes.push_back(values.size()*sizeof(T));
+    }
+
+    template <class T>
+    static bool readArray_(std::vector<T>& values, const TableFile& file, size_t arrayIdx)
+    {
+        size_t size = file.arraySize(arrayIdx);
+        if (size % sizeof(T) != 0)
+            return false;
+
+        values.resize(size/sizeof(T));
+        if (size > 0)
+            std::memcpy(values.data(), file.array(arrayIdx), size);
+        return true;
+    }
+
+    std::vector<Region> regions_;
+};
+} // namespace Opm
+
+#endif
@@ -25,9 +25,14 @@
 #ifndef OPM_WATER_PVT_INTERFACE_HPP
 #define OPM_WATER_PVT_INTERFACE_HPP
 
+#include "BlackOilPhaseProperties.hpp"
+
 #include <opm/material/common/OpmFinal.hpp>
 
 namespace Opm {
+template <class Scalar, class Evaluation>
+class WaterPvtMultiplexer;
+
 /*!
  * \brief This class represents the Pressure-Volume-Temperature relations of the water
  *        phase in the black-oil model.
@@ -74,6 +79,20 @@ public:
                            Scalar temperature,
                            Scalar pressure) const = 0;
 
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the fluid phase at once.
+     *
+     * This is cheaper than calling the individual methods because the table
+     * lookups are shared.
+     */
+    virtual BlackOilPhaseProperties<Evaluation> properties(int regionIdx,
+                                                           const Evaluation& temperature,
+                                                           const Evaluation& pressure) const = 0;
+    virtual BlackOilPhaseProperties<Scalar> properties(int regionIdx,
+                                                       Scalar temperature,
+                                                       Scalar pressure) const = 0;
+
     /*!
      * \brief Returns the fugacity coefficient [Pa] of a component in the fluid phase given
      *        a set of parameters.
@@ -102,6 +121,9 @@ public:
     virtual Scalar density(int regionIdx,
                            Scalar temperature,
                            Scalar pressure) const = 0;
+    virtual BlackOilPhaseProperties<Scalar> properties(int regionIdx,
+                                                       Scalar temperature,
+                                                       Scalar pressure) const = 0;
     virtual Scalar fugacityCoefficient(int regionIdx,
                                        Scalar temperature,
                                        Scalar pressure,
@@ -142,6 +164,15 @@ public:
                    Scalar pressure) const OPM_FINAL
     { return asImp_().density_(regionIdx, temperature, pressure); }
 
+    BlackOilPhaseProperties<Evaluation> properties(int regionIdx,
+                                                   const Evaluation& temperature,
+                                                   const Evaluation& pressure) const OPM_FINAL
+    { return asImp_().properties_(regionIdx, temperature, pressure); }
+    BlackOilPhaseProperties<Scalar> properties(int regionIdx,
+                                               Scalar temperature,
+                                               Scalar pressure) const OPM_FINAL
+    { return asImp_().properties_(regionIdx, temperature, pressure); }
+
     Evaluation fugacityCoefficient(int regionIdx,
                                    const Evaluation& temperature,
                                    const Evaluation& pressure,
@@ -177,6 +208,11 @@ public:
                    Scalar pressure) const OPM_FINAL
     { return asImp_().density_(regionIdx, temperature, pressure); }
 
+    BlackOilPhaseProperties<Scalar> properties(int regionIdx,
+                                               Scalar temperature,
+                                               Scalar pressure) const OPM_FINAL
+    { return asImp_().properties_(regionIdx, temperature, pressure); }
+
     Scalar fugacityCoefficient(int regionIdx,
                                Scalar temperature,
                                Scalar pressure,
@@ -0,0 +1,198 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ * \copydoc Opm::WaterPvtMultiplexer
+ */
+#ifndef OPM_WATER_PVT_MULTIPLEXER_HPP
+#define OPM_WATER_PVT_MULTIPLEXER_HPP
+
+#include "WaterPvtInterface.hpp"
+#include "GenericPvtProperties.hpp"
+
+namespace Opm {
+// the implementation classes include the black-oil fluid system which in turn includes
+// this file, so they might not be defined yet at this point.
+template <class Scalar, class Evaluation>
+class ConstantCompressibilityWaterPvt;
+} // namespace Opm
+
+#include "ConstantCompressibilityWaterPvt.hpp"
+
+#include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/ErrorMacros.hpp>
+#include <opm/material/common/Instrumentation.hpp>
+
+#include <cassert>
+#include <memory>
+#include <type_traits>
+
+namespace Opm {
+enum WaterPvtApproach {
+    NoWaterPvtApproach,
+    GenericWaterPvtApproach,
+    ConstantCompressibilityWaterPvtApproach
+};
+
+#define OPM_WATER_PVT_MULTIPLEXER_CALL(codeToCall)                                   \
+    switch (approach_) {                                                             \
+    case ConstantCompressibilityWaterPvtApproach: {                                  \
+        const auto& pvtImpl = getRealPvt<ConstantCompressibilityWaterPvtApproach>(); \
+        codeToCall;                                                                  \
+    }                                                                                \
+    case NoWaterPvtApproach:                                                         \
+        OPM_THROW(std::logic_error, "No PVT relations have been set for the water phase"); \
+    case GenericWaterPvtApproach:                                                    \
+        break;                                                                       \
+    }
+
+/*!
+ * \brief Dispatches the calls for the PVT relations of the water phase to the actual
+ *        implementation without using virtual methods.
+ *
+ * \copydetails Opm::OilPvtMultiplexer
+ */
+template <class Scalar, class Evaluation = Scalar>
+class WaterPvtMultiplexer
+{
+    typedef Opm::WaterPvtInterface<Scalar, Evaluation> WaterPvtInterface;
+    typedef Opm::ConstantCompressibilityWaterPvt<Scalar, Evaluation> ConstantCompressibilityWaterPvt;
+
+public:
+    WaterPvtMultiplexer()
+        : approach_(NoWaterPvtApproach)
+    {}
+
+    /*!
+     * \brief Set the object which implements the PVT relations.
+     *
+     * This determines the approach which is used for all subsequent calls.
+     */
+    void setPvt(std::shared_ptr<const WaterPvtInterface> pvtObj)
+    {
+        pvt_ = pvtObj;
+
+        const WaterPvtInterface* p = pvt_.get();
+        if (!p)
+            approach_ = NoWaterPvtApproach;
+        else if (dynamic_cast<const ConstantCompressibilityWaterPvt*>(p))
+            approach_ = ConstantCompressibilityWaterPvtApproach;
+        else
+            approach_ = GenericWaterPvtApproach;
+    }
+
+    /*!
+     * \brief Returns the object which implements the PVT relations.
+     */
+    const std::shared_ptr<const WaterPvtInterface>& pvt() const
+    { return pvt_; }
+
+    /*!
+     * \brief Returns the approach which is used to dispatch the calls.
+     */
+    WaterPvtApproach approach() const
+    { return approach_; }
+
+    // get the implementation object for water with constant compressibility
+    template <WaterPvtApproach approachV>
+    typename std::enable_if<approachV == ConstantCompressibilityWaterPvtApproach, const ConstantCompressibilityWaterPvt>::type&
+    getRealPvt() const
+    {
+        assert(approach() == approachV);
+        return *static_cast<const ConstantCompressibilityWaterPvt*>(pvt_.get());
+    }
+
+    /*!
+     * \copydoc WaterPvtInterface::viscosity
+     */
+    template <class LhsEval>
+    LhsEval viscosity(int regionIdx,
+                      const LhsEval& temperature,
+                      const LhsEval& pressure) const
+    {
+        OPM_INSTRUMENT_SCOPE("WaterPvt::viscosity");
+        OPM_WATER_PVT_MULTIPLEXER_CALL(return pvtImpl.template viscosity_<LhsEval>(regionIdx, temperature, pressure));
+        return pvt_->viscosity(regionIdx, temperature, pressure);
+    }
+
+    /*!
+     * \copydoc WaterPvtInterface::formationVolumeFactor
+     */
+    template <class LhsEval>
+    LhsEval formationVolumeFactor(int regionIdx,
+                                  const LhsEval& temperature,
+                                  const LhsEval& pressure) const
+    {
+        OPM_INSTRUMENT_SCOPE("WaterPvt::formationVolumeFactor");
+        OPM_WATER_PVT_MULTIPLEXER_CALL(return pvtImpl.template formationVolumeFactor_<LhsEval>(regionIdx, temperature, pressure));
+        return pvt_->formationVolumeFactor(regionIdx, temperature, pressure);
+    }
+
+    /*!
+     * \copydoc WaterPvtInterface::density
+     */
+    template <class LhsEval>
+    LhsEval density(int regionIdx,
+                    const LhsEval& temperature,
+                    const LhsEval& pressure) const
+    {
+        OPM_INSTRUMENT_SCOPE("WaterPvt::density");
+        OPM_WATER_PVT_MULTIPLEXER_CALL(return pvtImpl.template density_<LhsEval>(regionIdx, temperature, pressure));
+        return pvt_->density(regionIdx, temperature, pressure);
+    }
+
+    /*!
+     * \copydoc WaterPvtInterface::properties
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> properties(int regionIdx,
+                                                const LhsEval& temperature,
+                                                const LhsEval& pressure) const
+    {
+        OPM_INSTRUMENT_SCOPE("WaterPvt::properties");
+        OPM_WATER_PVT_MULTIPLEXER_CALL(return pvtImpl.template properties_<LhsEval>(regionIdx, temperature, pressure));
+        return GenericPvtProperties<Scalar, Evaluation>::template eval<LhsEval>(*pvt_, "water", regionIdx, temperature, pressure);
+    }
+
+    /*!
+     * \copydoc WaterPvtInterface::fugacityCoefficient
+     */
+    template <class LhsEval>
+    LhsEval fugacityCoefficient(int regionIdx,
+                                const LhsEval& temperature,
+                                const LhsEval& pressure,
+                                int compIdx) const
+    {
+        OPM_INSTRUMENT_SCOPE("WaterPvt::fugacityCoefficient");
+        OPM_WATER_PVT_MULTIPLEXER_CALL(return pvtImpl.template fugacityCoefficient_<LhsEval>(regionIdx, temperature, pressure, compIdx));
+        return pvt_->fugacityCoefficient(regionIdx, temperature, pressure, compIdx);
+    }
+
+private:
+    WaterPvtApproach approach_;
+    std::shared_ptr<const WaterPvtInterface> pvt_;
+};
+
+#undef OPM_WATER_PVT_MULTIPLEXER_CALL
+
+} // namespace Opm
+
+#endif
@@ -26,12 +26,17 @@
 #define OPM_WET_GAS_PVT_HPP
 
 #include "GasPvtInterface.hpp"
+#include "PvtReferenceDensities.hpp"
+#include "PvtRegionLoop.hpp"
 
 #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
 
 #include <opm/material/common/OpmFinal.hpp>
+#include <opm/material/common/InterpolationWeights.hpp>
+#include <opm/material/common/ProfilerRanges.hpp>
 #include <opm/material/common/UniformXTabulated2DFunction.hpp>
 #include <opm/material/common/Tabulated1DFunction.hpp>
+#include <opm/material/common/TableResampling.hpp>
 #include <opm/material/common/Spline.hpp>
 
 #if HAVE_OPM_PARSER
@@ -48,10 +53,12 @@ class WetGasPvt
     : public GasPvtInterfaceTemplateWrapper<Scalar, Evaluation, WetGasPvt<Scalar, Evaluation> >
 {
     friend class GasPvtInterfaceTemplateWrapper<Scalar, Evaluation, WetGasPvt<Scalar, Evaluation> >;
+    friend class GasPvtMultiplexer<Scalar, Evaluation>;
 
     typedef FluidSystems::BlackOil<Scalar, Evaluation> BlackOilFluidSystem;
 
     typedef Opm::UniformXTabulated2DFunction<Scalar> TabulatedTwoDFunction;
+    typedef Opm::UniformTabulated2DFunction<Scalar> UniformTabulatedTwoDFunction;
     typedef Opm::Tabulated1DFunction<Scalar> TabulatedOneDFunction;
     typedef Opm::Spline<Scalar> Spline;
     typedef std::vector<std::pair<Scalar, Scalar> > SamplingPoints;
@@ -65,6 +72,13 @@ class WetGasPvt
     static const int waterCompIdx = BlackOilFluidSystem::waterCompIdx;
 
 public:
+    WetGasPvt()
+        : numResampledPressures_(0)
+        , numResampledRv_(0)
+        , maxResamplingError_(0.0)
+        , enableResampledTables_(true)
+    {}
+
     void setNumRegions(int numRegions)
     {
         inverseGasB_.resize(numRegions);
@@ -72,6 +86,11 @@ public:
         gasMu_.resize(numRegions);
         oilVaporizationFactorTable_.resize(numRegions);
         saturationPressureSpline_.resize(numRegions);
+        saturationPressureTable_.resize(numRegions);
+        saturatedInverseGasB_.resize(numRegions);
+        saturatedInverseGasBMu_.resize(numRegions);
+        resampledInverseGasB_.resize(numRegions);
+        resampledInverseGasBMu_.resize(numRegions);
     }
 
     /*!
@@ -80,7 +99,10 @@ public:
      * \param samplePoints A container of (x,y) values.
      */
     void setSaturatedGasOilVaporizationFactor(int regionIdx, const SamplingPoints &samplePoints)
-    { oilVaporizationFactorTable_[regionIdx].setContainerOfTuples(samplePoints); }
+    {
+        oilVaporizationFactorTable_[regionIdx].setContainerOfTuples(samplePoints);
+        saturationPressureTable_[regionIdx] = TabulatedOneDFunction();
+    }
 
     /*!
      * \brief Initialize the function for the gas formation volume factor
@@ -108,13 +130,14 @@ public:
         size_t nRv = 20;
         size_t nP = samplePoints.size()*2;
 
-        Scalar rhogRef = BlackOilFluidSystem::referenceDensity(gasPhaseIdx, regionIdx);
-        Scalar rhooRef = BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx);
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+        Scalar rhooRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
 
         Spline gasFormationVolumeFactorSpline;
         gasFormationVolumeFactorSpline.setContainerOfTuples(samplePoints, /*type=*/Spline::Monotonic);
 
-        updateSaturationPressureSpline_(regionIdx);
+        PvtRegionWorkspace<Scalar> workspace;
+        updateSaturationPressureSpline_(regionIdx, workspace);
 
         // calculate a table of estimated densities depending on pressure and gas mass
         // fraction
@@ -127,12 +150,12 @@ public:
             for (size_t pIdx = 0; pIdx < nP; ++pIdx) {
                 Scalar pg = poMin + (poMax - poMin)*pIdx/nP;
 
-                Scalar poSat = gasSaturationPressure(regionIdx, T, XgO);
+                Scalar poSat = gasSaturationPressure_(regionIdx, T, XgO);
                 Scalar BgSat = gasFormationVolumeFactorSpline.eval(poSat, /*extrapolate=*/true);
                 Scalar drhoo_dp = (1.1200 - 1.1189)/((5000 - 4000)*6894.76);
-                Scalar rhoo = BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx)/BgSat*(1 + drhoo_dp*(pg - poSat));
+                Scalar rhoo = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx)/BgSat*(1 + drhoo_dp*(pg - poSat));
 
-                Scalar Bg = BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx)/rhoo;
+                Scalar Bg = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx)/rhoo;
 
                 invGasB.appendSamplePoint(RvIdx, pg, 1.0/Bg);
             }
@@ -208,36 +231,89 @@ public:
     void setPvtgTable(int regionIdx, const PvtgTable &pvtgTable)
     {
         const auto saturatedTable = pvtgTable.getOuterTable();
-        assert(saturatedTable->numRows() > 1);
+        int numOuterRows = saturatedTable->numRows();
+
+        std::vector<Scalar> pg(numOuterRows);
+        std::vector<int> rowOffsets(numOuterRows + 1, 0);
+        std::vector<Scalar> Rv, Bg, mug;
+        for (int outerIdx = 0; outerIdx < numOuterRows; ++ outerIdx) {
+            pg[outerIdx] = saturatedTable->getPressureColumn()[outerIdx];
+
+            const auto underSaturatedTable = pvtgTable.getInnerTable(outerIdx);
+            int numRows = underSaturatedTable->numRows();
+            for (int innerIdx = 0; innerIdx < numRows; ++ innerIdx) {
+                Rv.push_back(underSaturatedTable->getOilSolubilityColumn()[innerIdx]);
+                Bg.push_back(underSaturatedTable->getGasFormationFactorColumn()[innerIdx]);
+                mug.push_back(underSaturatedTable->getGasViscosityColumn()[innerIdx]);
+            }
+            rowOffsets[outerIdx + 1] = static_cast<int>(Rv.size());
+        }
+
+        setPvtgArrays(regionIdx, numOuterRows, pg.data(), rowOffsets.data(),
+                      Rv.data(), Bg.data(), mug.data());
+    }
+#endif // HAVE_OPM_PARSER
+
+    /*!
+     * \brief Initialize the gas parameters of a region from the columns of a PVTG table.
+     *
+     * This is equivalent to setPvtgTable(), but it does not require opm-parser. The
+     * rows of all gas pressures are stored contiguously: The rows of the outer index i
+     * are [rowOffsets[i], rowOffsets[i + 1]) and the first of them is the saturated
+     * state.
+     *
+     * \param regionIdx The index of the PVT region
+     * \param numPg The number of gas pressures
+     * \param pg The gas pressures in ascending order [Pa]
+     * \param rowOffsets The index of the first row of each gas pressure; this array has
+     *                   numPg + 1 entries
+     * \param Rv The oil vaporization factors of the rows
+     * \param Bg The gas formation volume factors of the rows
+     * \param mug The gas viscosities of the rows [Pa s]
+     */
+    void setPvtgArrays(int regionIdx,
+                       int numPg,
+                       const Scalar* pg,
+                       const int* rowOffsets,
+                       const Scalar* Rv,
+                       const Scalar* Bg,
+                       const Scalar* mug)
+    {
+        assert(numPg > 1);
 
         auto& gasMu = gasMu_[regionIdx];
         auto& invGasB = inverseGasB_[regionIdx];
         auto& oilVaporizationFactor = oilVaporizationFactorTable_[regionIdx];
 
-        oilVaporizationFactor.setXYArrays(saturatedTable->numRows(),
-                                          saturatedTable->getPressureColumn(),
-                                          saturatedTable->getOilSolubilityColumn());
-
-        // extract the table for the gas dissolution and the oil formation volume factors
-        for (int outerIdx = 0; outerIdx < static_cast<int>(saturatedTable->numRows()); ++ outerIdx) {
-            Scalar pg = saturatedTable->getPressureColumn()[outerIdx];
-
-            invGasB.appendXPos(pg);
-            gasMu.appendXPos(pg);
+        // the saturated states are the first rows of the undersaturated tables
+        std::vector<Scalar> saturatedRv(numPg);
+        for (int outerIdx = 0; outerIdx < numPg; ++ outerIdx)
+            saturatedRv[outerIdx] = Rv[rowOffsets[outerIdx]];
+        oilVaporizationFactor.setXYArrays(numPg, std::vector<Scalar>(pg, pg + numPg), saturatedRv);
+        saturationPressureTable_[regionIdx] = TabulatedOneDFunction();
+
+        // extract the table for the gas dissolution and the oil formation volume
+        // factors. each column is added in a single pass, which avoids inserting at
+        // the front for the descending oil vaporization factors used by PVTG.
+        invGasB.reserveXPos(numPg);
+        gasMu.reserveXPos(numPg);
+        std::vector<Scalar> RvColumn, invBg, muColumn;
+        for (int outerIdx = 0; outerIdx < numPg; ++ outerIdx) {
+            int beginRowIdx = rowOffsets[outerIdx];
+            int endRowIdx = rowOffsets[outerIdx + 1];
+            assert(beginRowIdx < endRowIdx);
+
+            RvColumn.assign(Rv + beginRowIdx, Rv + endRowIdx);
+            muColumn.assign(mug + beginRowIdx, mug + endRowIdx);
+            invBg.resize(endRowIdx - beginRowIdx);
+            for (int rowIdx = beginRowIdx; rowIdx < endRowIdx; ++ rowIdx)
+                invBg[rowIdx - beginRowIdx] = 1.0/Bg[rowIdx];
+
+            invGasB.appendColumn(pg[outerIdx], RvColumn, invBg);
+            gasMu.appendColumn(pg[outerIdx], RvColumn, muColumn);
 
             assert(invGasB.numX() == outerIdx + 1);
             assert(gasMu.numX() == outerIdx + 1);
-
-            const auto underSaturatedTable = pvtgTable.getInnerTable(outerIdx);
-            int numRows = underSaturatedTable->numRows();
-            for (int innerIdx = 0; innerIdx < numRows; ++ innerIdx) {
-                Scalar Rv = underSaturatedTable->getOilSolubilityColumn()[innerIdx];
-                Scalar Bg = underSaturatedTable->getGasFormationFactorColumn()[innerIdx];
-                Scalar mug = underSaturatedTable->getGasViscosityColumn()[innerIdx];
-
-                invGasB.appendSamplePoint(outerIdx, Rv, 1.0/Bg);
-                gasMu.appendSamplePoint(outerIdx, Rv, mug);
-            }
         }
 
         // make sure to have at least two sample points per mole fraction
@@ -254,14 +330,13 @@ public:
             // current line. We define master table as the first table which has values
             // for undersaturated gas...
             int masterTableIdx = xIdx + 1;
-            for (; masterTableIdx < static_cast<int>(pvtgTable.getOuterTable()->numRows());
-                 ++masterTableIdx)
+            for (; masterTableIdx < numPg; ++masterTableIdx)
             {
-                if (pvtgTable.getInnerTable(masterTableIdx)->numRows() > 1)
+                if (rowOffsets[masterTableIdx + 1] - rowOffsets[masterTableIdx] > 1)
                     break;
             }
 
-            if (masterTableIdx >= static_cast<int>(pvtgTable.getOuterTable()->numRows()))
+            if (masterTableIdx >= numPg)
                 OPM_THROW(std::runtime_error,
                           "PVTG tables are invalid: The last table must exhibit at least one "
                           "entry for undersaturated gas!");
@@ -270,43 +345,98 @@ public:
             // that the current table exhibits the same ratios of the gas formation
             // volume factors and viscosities for identical pressure rations as in the
             // master table.
-            const auto masterTable = pvtgTable.getInnerTable(masterTableIdx);
-            const auto curTable = pvtgTable.getInnerTable(xIdx);
-            for (int newRowIdx = 1;
-                 newRowIdx < static_cast<int>(masterTable->numRows());
-                 ++ newRowIdx)
+            int masterRowIdx = rowOffsets[masterTableIdx];
+            int numMasterRows = rowOffsets[masterTableIdx + 1] - masterRowIdx;
+            int curRowIdx = rowOffsets[xIdx];
+            for (int newRowIdx = 1; newRowIdx < numMasterRows; ++ newRowIdx)
             {
-                Scalar alphaRv =
-                    masterTable->getOilSolubilityColumn()[newRowIdx]
-                    / masterTable->getOilSolubilityColumn()[0];
-
-                Scalar alphaBg =
-                    masterTable->getGasFormationFactorColumn()[newRowIdx]
-                    / masterTable->getGasFormationFactorColumn()[0];
+                Scalar alphaRv = Rv[masterRowIdx + newRowIdx]/Rv[masterRowIdx];
+                Scalar alphaBg = Bg[masterRowIdx + newRowIdx]/Bg[masterRowIdx];
+                Scalar alphaMug = mug[masterRowIdx + newRowIdx]/mug[masterRowIdx];
 
-                Scalar alphaMug =
-                    masterTable->getGasViscosityColumn()[newRowIdx]
-                    / masterTable->getGasViscosityColumn()[0];
-
-                Scalar newRv = curTable->getOilSolubilityColumn()[0]*alphaRv;
-                Scalar newBg = curTable->getGasFormationFactorColumn()[0]*alphaBg;
-                Scalar newMug = curTable->getGasViscosityColumn()[0]*alphaMug;
+                Scalar newRv = Rv[curRowIdx]*alphaRv;
+                Scalar newBg = Bg[curRowIdx]*alphaBg;
+                Scalar newMug = mug[curRowIdx]*alphaMug;
 
                 invGasB.appendSamplePoint(xIdx, newRv, 1.0/newBg);
                 gasMu.appendSamplePoint(xIdx, newRv, newMug);
             }
         }
     }
-#endif // HAVE_OPM_PARSER
+
+    /*!
+     * \brief Specify the resolution of the uniform grids onto which the undersaturated
+     *        parts of the PVTG tables ought to be resampled.
+     *
+     * The lookups in the original tables need to search the oil vaporization factor in
+     * the two columns of the pressures which enclose the state, whereas the cell of a
+     * uniform (p, R_v) grid is given by index arithmetic. Since resampling changes the
+     * tables, the largest relative deviation from the original ones can be queried using
+     * maxResamplingError() after initEnd(). Outside of the range of the uniform grid,
+     * the original tables are used. A number of sampling points smaller than 2
+     * disables resampling, which is the default. This method must be called before
+     * initEnd().
+     */
+    void setUniformTableResolution(int numPressures, int numRv)
+    {
+        numResampledPressures_ = numPressures;
+        numResampledRv_ = numRv;
+    }
+
+    /*!
+     * \brief Returns the largest deviation of the resampled undersaturated tables from
+     *        the original ones relative to the magnitude of their values.
+     *
+     * This is zero if the tables are not resampled, cf. setUniformTableResolution().
+     */
+    Scalar maxResamplingError() const
+    { return maxResamplingError_; }
+
+    /*!
+     * \brief Specify whether the resampled tables ought to be used if they are available.
+     *
+     * A coarse resolution of the uniform grids (cf. setUniformTableResolution()) yields
+     * small tables which stay in the cache, but which are less accurate than the
+     * original ones. Disabling the resampled tables allows to use them for the early
+     * iterations of a nonlinear solver and the original tables for the final ones.
+     * Unlike the resolution, this can be changed after initEnd(), but not while other
+     * threads evaluate the PVT relations. By default, the resampled tables are used.
+     */
+    void setEnableResampledTables(bool yesno)
+    { enableResampledTables_ = yesno; }
+
+    /*!
+     * \brief Returns true iff the resampled tables are used if they are available.
+     */
+    bool enableResampledTables() const
+    { return enableResampledTables_; }
+
+    /*!
+     * \brief Set the reference densities which are used by this object.
+     *
+     * This is only required if the object is used by a black-oil fluid system
+     * instance which is not the default one.
+     */
+    void setReferenceDensities(Scalar rhoOil,
+                               Scalar rhoWater,
+                               Scalar rhoGas,
+                               int regionIdx)
+    { referenceDensities_.setReferenceDensities(rhoOil, rhoWater, rhoGas, regionIdx); }
 
     /*!
      * \brief Finish initializing the gas phase PVT properties.
      */
     void initEnd()
     {
+        OPM_PROFILER_RANGE("WetGasPvt::initEnd");
+
+        maxResamplingError_ = 0.0;
+
         // calculate the final 2D functions which are used for interpolation.
         int numRegions = gasMu_.size();
-        for (int regionIdx = 0; regionIdx < numRegions; ++ regionIdx) {
+        // the regions are independent of each other, so they are set up in parallel
+        std::vector<Scalar> resamplingErrors(numRegions, 0.0);
+        forEachPvtRegion<Scalar>(numRegions, [&](int regionIdx, PvtRegionWorkspace<Scalar>& workspace) {
             // calculate the table which stores the inverse of the product of the gas
             // formation volume factor and the gas viscosity
             const auto& gasMu = gasMu_[regionIdx];
@@ -315,12 +445,14 @@ public:
 
             auto& invGasBMu = inverseGasBMu_[regionIdx];
 
+            invGasBMu.reserveXPos(gasMu.numX());
             for (int pIdx = 0; pIdx < gasMu.numX(); ++pIdx) {
                 invGasBMu.appendXPos(gasMu.xAt(pIdx));
 
                 assert(gasMu.numY(pIdx) == invGasB.numY(pIdx));
 
                 int numPressures = gasMu.numY(pIdx);
+                invGasBMu.reserveSamplePoints(pIdx, numPressures);
                 for (int rvIdx = 0; rvIdx < numPressures; ++rvIdx)
                     invGasBMu.appendSamplePoint(pIdx,
                                                 gasMu.yAt(pIdx, rvIdx),
@@ -328,11 +460,260 @@ public:
                                                 1/gasMu.valueAt(pIdx, rvIdx));
             }
 
-            updateSaturationPressureSpline_(regionIdx);
+            updateSaturationPressureSpline_(regionIdx, workspace);
+            updateSaturationPressureTable_(regionIdx, workspace);
+
+            // convert the tables to the compact layout which is used for the lookups
+            inverseGasB_[regionIdx].finalize();
+            gasMu_[regionIdx].finalize();
+            inverseGasBMu_[regionIdx].finalize();
+
+            updateSaturatedTables_(regionIdx, workspace);
+            resamplingErrors[regionIdx] = updateResampledTables_(regionIdx);
+        });
+
+        for (int regionIdx = 0; regionIdx < numRegions; ++ regionIdx)
+            maxResamplingError_ = std::max(maxResamplingError_, resamplingErrors[regionIdx]);
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of oil-saturated gas at once.
+     *
+     * In contrast to properties(), the oil vaporization factor is not specified but
+     * given by the saturated one at the pressure. Instead of the two-dimensional tables,
+     * this uses one-dimensional tables of the properties of saturated gas which are
+     * created by initEnd(). They are sampled at the pressures of the oil vaporization
+     * factor table, so all quantities are determined using a single segment lookup.
+     * Between these pressures, the saturated properties are interpolated linearly, which
+     * corresponds to how the saturated part of a PVTG table is interpreted.
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> saturatedProperties(int regionIdx,
+                                                         const LhsEval& /* temperature */,
+                                                         const LhsEval& pressure) const
+    {
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+
+        SegmentHint hint;
+        BlackOilPhaseProperties<LhsEval> result;
+        const LhsEval& Rv = oilVaporizationFactorTable_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        result.invB = saturatedInverseGasB_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        result.invBMu = saturatedInverseGasBMu_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        result.mu = result.invB/result.invBMu;
+        result.density = rhogRef*result.invB + rhogRef*Rv*result.invB;
+
+        return result;
+    }
+
+    /*!
+     * \brief Returns the dynamic viscosity [Pa s] of oil-saturated gas.
+     *
+     * \copydetails saturatedProperties
+     */
+    template <class LhsEval>
+    LhsEval saturatedViscosity(int regionIdx,
+                               const LhsEval& /* temperature */,
+                               const LhsEval& pressure) const
+    {
+        SegmentHint hint;
+        const LhsEval& invBg = saturatedInverseGasB_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        const LhsEval& invMugBg = saturatedInverseGasBMu_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+
+        return invBg/invMugBg;
+    }
+
+    /*!
+     * \brief Returns the formation volume factor [-] of oil-saturated gas.
+     *
+     * \copydetails saturatedProperties
+     */
+    template <class LhsEval>
+    LhsEval saturatedFormationVolumeFactor(int regionIdx,
+                                           const LhsEval& /* temperature */,
+                                           const LhsEval& pressure) const
+    { return 1.0 / saturatedInverseGasB_[regionIdx].eval(pressure, /*extrapolate=*/true); }
+
+    /*!
+     * \brief Returns the density [kg/m^3] of oil-saturated gas.
+     *
+     * \copydetails saturatedProperties
+     */
+    template <class LhsEval>
+    LhsEval saturatedDensity(int regionIdx,
+                             const LhsEval& /* temperature */,
+                             const LhsEval& pressure) const
+    {
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+
+        SegmentHint hint;
+        const LhsEval& Rv = oilVaporizationFactorTable_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+        const LhsEval& invBg = saturatedInverseGasB_[regionIdx].eval(pressure, hint, /*extrapolate=*/true);
+
+        return (rhogRef + rhogRef*Rv)*invBg;
+    }
+
+    /*!
+     * \brief Returns true if the saturation pressure of a region is determined by a
+     *        single lookup in the inverse of the oil vaporization factor table.
+     *
+     * This is the case after initEnd() if the oil vaporization factor is strictly
+     * increasing with pressure. Otherwise, the saturation pressure is determined
+     * iteratively.
+     */
+    bool hasSaturationPressureTable(int regionIdx) const
+    { return saturationPressureTable_[regionIdx].numSamples() > 1; }
+
+    /*!
+     * \brief Returns the dynamic viscosity [Pa s] of the gas phase given its oil
+     *        vaporization factor.
+     *
+     * In contrast to the methods of the PVT interface, the composition of the gas phase
+     * is specified by the oil vaporization factor R_v instead of the mass fraction of the
+     * oil component. If R_v is known anyway, e.g., because it is a primary variable, this
+     * avoids converting it to a mass fraction and back.
+     */
+    template <class LhsEval>
+    LhsEval viscosityFromRv(int regionIdx,
+                            const LhsEval& /* temperature */,
+                            const LhsEval& pressure,
+                            const LhsEval& Rv) const
+    {
+        if (useResampledTables_(regionIdx, pressure, Rv)) {
+            const LhsEval& invBg = resampledInverseGasB_[regionIdx].eval(pressure, Rv);
+            const LhsEval& invMugBg = resampledInverseGasBMu_[regionIdx].eval(pressure, Rv);
+
+            return invBg/invMugBg;
         }
+
+        const LhsEval& invBg = inverseGasB_[regionIdx].eval(pressure, Rv, /*extrapolate=*/true);
+        const LhsEval& invMugBg = inverseGasBMu_[regionIdx].eval(pressure, Rv, /*extrapolate=*/true);
+
+        return invBg/invMugBg;
+    }
+
+    /*!
+     * \brief Returns the formation volume factor [-] of the gas phase given its oil
+     *        vaporization factor.
+     *
+     * \copydetails viscosityFromRv
+     */
+    template <class LhsEval>
+    LhsEval formationVolumeFactorFromRv(int regionIdx,
+                                        const LhsEval& /* temperature */,
+                                        const LhsEval& pressure,
+                                        const LhsEval& Rv) const
+    {
+        if (useResampledTables_(regionIdx, pressure, Rv))
+            return 1.0 / resampledInverseGasB_[regionIdx].eval(pressure, Rv);
+        return 1.0 / inverseGasB_[regionIdx].eval(pressure, Rv, /*extrapolate=*/true);
+    }
+
+    /*!
+     * \brief Returns the density [kg/m^3] of the gas phase given its oil vaporization
+     *        factor.
+     *
+     * \copydetails viscosityFromRv
+     */
+    template <class LhsEval>
+    LhsEval densityFromRv(int regionIdx,
+                          const LhsEval& temperature,
+                          const LhsEval& pressure,
+                          const LhsEval& Rv) const
+    {
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+
+        const LhsEval& Bg = formationVolumeFactorFromRv(regionIdx, temperature, pressure, Rv);
+
+        // the gas formation volume factor just represents the partial density of the gas
+        // component in the gas phase. to get the total density of the phase, we have to
+        // add the partial density of the oil component.
+        return (rhogRef + rhogRef*Rv)/Bg;
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the gas phase at once given its oil
+     *        vaporization factor.
+     *
+     * \copydetails viscosityFromRv
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> propertiesFromRv(int regionIdx,
+                                                      const LhsEval& /* temperature */,
+                                                      const LhsEval& pressure,
+                                                      const LhsEval& Rv) const
+    {
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+
+        // the table for 1/(B_g mu_g) is sampled at the same points as the one for 1/B_g,
+        // so the segments found by the first lookup can be reused for the second one
+        BlackOilPhaseProperties<LhsEval> result;
+        if (useResampledTables_(regionIdx, pressure, Rv)) {
+            result.invB = resampledInverseGasB_[regionIdx].eval(pressure, Rv);
+            result.invBMu = resampledInverseGasBMu_[regionIdx].eval(pressure, Rv);
+        }
+        else {
+            SegmentHint2D hint;
+            result.invB = inverseGasB_[regionIdx].eval(pressure, Rv, hint, /*extrapolate=*/true);
+            result.invBMu = inverseGasBMu_[regionIdx].eval(pressure, Rv, hint, /*extrapolate=*/true);
+        }
+        result.mu = result.invB/result.invBMu;
+        result.density = rhogRef*result.invB + rhogRef*Rv*result.invB;
+
+        return result;
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the gas phase given its oil vaporization
+     *        factor together with the weights of the table rows which contribute to
+     *        them.
+     *
+     * Both tables are sampled at the same points, so \f$1/B_g = \sum_k w_k/B_{g,k}\f$
+     * and \f$1/(B_g\mu_g) = \sum_k w_k/(B_{g,k}\mu_{g,k})\f$ where the sum goes over
+     * the four contributing rows of the PVTG table and the \f$w_k\f$ are the weights
+     * (cf. Opm::InterpolationWeights). The partial derivatives of all returned
+     * quantities with regard to the entries of the table thus follow from the chain
+     * rule, so all sensitivities are obtained from a single evaluation.
+     *
+     * For each contributing row, xIdx() is the index of the record, i.e., of its
+     * pressure, and yIdx() is the index of the row within the record. Rows which do not
+     * exist in the table because they were extrapolated for a record without
+     * undersaturated data (cf. setPvtgArrays()) have indices beyond the last row of the
+     * record. The resampled tables are never used by this method.
+     *
+     * \param weights Receives the indices and the weights of the contributing rows
+     */
+    BlackOilPhaseProperties<Scalar> propertiesFromRvWithTableWeights(int regionIdx,
+                                                                     Scalar /* temperature */,
+                                                                     Scalar pressure,
+                                                                     Scalar Rv,
+                                                                     InterpolationWeights<Scalar, 4>& weights) const
+    {
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+
+        InterpolationWeights<Scalar, 4> invBMuWeights;
+        BlackOilPhaseProperties<Scalar> result;
+        result.invB = inverseGasB_[regionIdx].evalWeights(pressure, Rv, weights, /*extrapolate=*/true);
+        result.invBMu = inverseGasBMu_[regionIdx].evalWeights(pressure, Rv, invBMuWeights, /*extrapolate=*/true);
+        result.mu = result.invB/result.invBMu;
+        result.density = rhogRef*result.invB + rhogRef*Rv*result.invB;
+
+        return result;
     }
 
 private:
+    // convert the mass fraction of the oil component in the gas phase to the oil
+    // vaporization factor
+    template <class LhsEval>
+    LhsEval oilVaporizationFactorFromMassFraction_(int regionIdx, const LhsEval& XgO) const
+    {
+        Scalar rhooRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
+        Scalar rhogRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+        return XgO/(1 - XgO)*(rhogRef/rhooRef);
+    }
+
     /*!
      * \brief Returns the dynamic viscosity [Pa s] of the fluid phase given a set of parameters.
      */
@@ -342,15 +723,10 @@ private:
                        const LhsEval& pressure,
                        const LhsEval& XgO) const
     {
-        const LhsEval& Rv =
-            XgO/(1 - XgO)
-            * (BlackOilFluidSystem::referenceDensity(gasPhaseIdx, regionIdx)
-               / BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx));
-
-        const LhsEval& invBg = inverseGasB_[regionIdx].eval(pressure, Rv, /*extrapolate=*/true);
-        const LhsEval& invMugBg = inverseGasBMu_[regionIdx].eval(pressure, Rv, /*extrapolate=*/true);
-
-        return invBg/invMugBg;
+        return viscosityFromRv(regionIdx,
+                               temperature,
+                               pressure,
+                               oilVaporizationFactorFromMassFraction_(regionIdx, XgO));
     }
 
     /*!
@@ -362,20 +738,26 @@ private:
                      const LhsEval& pressure,
                      const LhsEval& XgO) const
     {
-        Scalar rhooRef = BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx);
-        Scalar rhogRef = BlackOilFluidSystem::referenceDensity(gasPhaseIdx, regionIdx);
-
-        const LhsEval& Bg = formationVolumeFactor_(regionIdx, temperature, pressure, XgO);
-
-        LhsEval rhog = rhogRef/Bg;
-
-        // the oil formation volume factor just represents the partial density of the gas
-        // component in the gas phase. to get the total density of the phase, we have to
-        // add the partial density of the oil component.
-        const LhsEval& Rv = XgO/(1 - XgO) * (rhogRef/rhooRef);
-        rhog += (rhogRef*Rv)/Bg;
+        return densityFromRv(regionIdx,
+                             temperature,
+                             pressure,
+                             oilVaporizationFactorFromMassFraction_(regionIdx, XgO));
+    }
 
-        return rhog;
+    /*!
+     * \brief Returns the inverse formation volume factor, the viscosity, the inverse of
+     *        their product and the density of the fluid phase at once.
+     */
+    template <class LhsEval>
+    BlackOilPhaseProperties<LhsEval> properties_(int regionIdx,
+                                                 const LhsEval& temperature,
+                                                 const LhsEval& pressure,
+                                                 const LhsEval& XgO) const
+    {
+        return propertiesFromRv(regionIdx,
+                                temperature,
+                                pressure,
+                                oilVaporizationFactorFromMassFraction_(regionIdx, XgO));
     }
 
     /*!
@@ -387,12 +769,10 @@ private:
                                    const LhsEval& pressure,
                                    const LhsEval& XgO) const
     {
-        const LhsEval& Rv =
-            XgO/(1-XgO)
-            *(BlackOilFluidSystem::referenceDensity(gasPhaseIdx, regionIdx)
-              /BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx));
-
-        return 1.0 / inverseGasB_[regionIdx].eval(pressure, Rv, /*extrapolate=*/true);
+        return formationVolumeFactorFromRv(regionIdx,
+                                           temperature,
+                                           pressure,
+                                           oilVaporizationFactorFromMassFraction_(regionIdx, XgO));
     }
 
     /*!
@@ -429,11 +809,11 @@ private:
 
         // then, scale the oil component's gas phase fugacity
         // coefficient, so that the oil phase ends up at the right
-        // composition if we were doing a flash experiment
-        const LhsEval& phi_oO = BlackOilFluidSystem::fugCoefficientInOil(oilCompIdx,
-                                                                         temperature,
-                                                                         pressure,
-                                                                         regionIdx);
+        // composition if we were doing a flash experiment. the oil PVT classes all use
+        // the same pseudo vapor pressure for the fugacity coefficient of the oil
+        // component in the oil phase. it is not taken from a fluid system object
+        // because this PVT object may be used by any BlackOilInstance.
+        const LhsEval& phi_oO = 20e3/pressure;
 
         return phi_oO / x_gOSat;
     }
@@ -460,6 +840,14 @@ private:
     {
         typedef Opm::MathToolbox<LhsEval> Toolbox;
 
+        // if the oil vaporization factor is strictly increasing, the saturation pressure
+        // is given directly by the inverse of its table. the derivatives are the ones of
+        // the inverse's segment.
+        if (hasSaturationPressureTable(regionIdx)) {
+            const LhsEval& Rv = oilVaporizationFactorFromMassFraction_(regionIdx, XgO);
+            return saturationPressureTable_[regionIdx].eval(Rv, /*extrapolate=*/true);
+        }
+
         // use the saturation pressure spline to get a pretty good initial value
         LhsEval pSat = saturationPressureSpline_[regionIdx].eval(XgO, /*extrapolate=*/true);
         const LhsEval& eps = pSat*1e-11;
@@ -486,8 +874,8 @@ private:
                                          const LhsEval& temperature,
                                          const LhsEval& pressure) const
     {
-        Scalar rho_gRef = BlackOilFluidSystem::referenceDensity(gasPhaseIdx, regionIdx);
-        Scalar rho_oRef = BlackOilFluidSystem::referenceDensity(oilPhaseIdx, regionIdx);
+        Scalar rho_gRef = referenceDensities_.referenceDensity(gasPhaseIdx, regionIdx);
+        Scalar rho_oRef = referenceDensities_.referenceDensity(oilPhaseIdx, regionIdx);
 
         // calculate the mass of the oil component [kg/m^3] in the gas phase. This is
         // equivalent to the oil vaporization factor [m^3/m^3] at current pressure times
@@ -510,15 +898,15 @@ private:
 
         // which can be converted to mole fractions, given the
         // components' molar masses
-        Scalar MG = BlackOilFluidSystem::molarMass(gasCompIdx, regionIdx);
-        Scalar MO = BlackOilFluidSystem::molarMass(oilCompIdx, regionIdx);
+        Scalar MG = referenceDensities_.molarMass(gasCompIdx, regionIdx);
+        Scalar MO = referenceDensities_.molarMass(oilCompIdx, regionIdx);
 
         const LhsEval& avgMolarMass = MO/(1 + (1 - XgO)*(MO/MG - 1));
         return XgO*avgMolarMass/MO;
     }
 
 private:
-    void updateSaturationPressureSpline_(int regionIdx)
+    void updateSaturationPressureSpline_(int regionIdx, PvtRegionWorkspace<Scalar>& workspace)
     {
         auto& oilVaporizationFactor = oilVaporizationFactorTable_[regionIdx];
 
@@ -527,12 +915,20 @@ private:
         int n = oilVaporizationFactor.numSamples()*5;
         int delta = (oilVaporizationFactor.xMax() - oilVaporizationFactor.xMin())/(n + 1);
 
-        SamplingPoints pSatSamplePoints;
+        SamplingPoints& pSatSamplePoints = workspace.samplePoints;
+        pSatSamplePoints.clear();
+        pSatSamplePoints.reserve(n + 1);
         Scalar XgO = 0;
         for (int i=0; i <= n; ++ i) {
             Scalar pSat = oilVaporizationFactor.xMin() + i*delta;
             XgO = saturatedGasOilMassFraction_(regionIdx, /*temperature=*/Scalar(1e100), pSat);
 
+            // the spline requires strictly increasing mass fractions. if the saturated
+            // mass fraction decreases at some pressure, only the branch below this
+            // pressure is used as the initial guess of the Newton method
+            if (!pSatSamplePoints.empty() && XgO <= pSatSamplePoints.back().first)
+                break;
+
             std::pair<Scalar, Scalar> val(XgO, pSat);
             pSatSamplePoints.push_back(val);
         }
@@ -540,13 +936,132 @@ private:
                                                                   /*type=*/Spline::Monotonic);
     }
 
+    // the saturation pressure as a function of the oil vaporization factor, i.e., the
+    // inverse of oilVaporizationFactorTable_. empty if the latter is not invertible.
+    void updateSaturationPressureTable_(int regionIdx, PvtRegionWorkspace<Scalar>& workspace)
+    {
+        const auto& oilVaporizationFactor = oilVaporizationFactorTable_[regionIdx];
+        auto& pSatTable = saturationPressureTable_[regionIdx];
+
+        int n = oilVaporizationFactor.numSamples();
+        std::vector<Scalar>& RvValues = workspace.xValues;
+        std::vector<Scalar>& pValues = workspace.yValues;
+        RvValues.resize(n);
+        pValues.resize(n);
+        for (int i = 0; i < n; ++i) {
+            RvValues[i] = oilVaporizationFactor.valueAt(i);
+            pValues[i] = oilVaporizationFactor.xAt(i);
+
+            if (i > 0 && RvValues[i] <= RvValues[i - 1]) {
+                // the oil vaporization factor is not strictly increasing. use the Newton
+                // method instead
+                pSatTable = TabulatedOneDFunction();
+                return;
+            }
+        }
+
+        if (n < 2)
+            pSatTable = TabulatedOneDFunction();
+        else
+            pSatTable.setXYContainers(RvValues, pValues);
+    }
+
+    // tabulate the inverse formation volume factor of oil-saturated gas and the inverse
+    // of its product with the viscosity. they use the same pressures as the oil
+    // vaporization factor table, so the segment found for one of them applies to all.
+    void updateSaturatedTables_(int regionIdx, PvtRegionWorkspace<Scalar>& workspace)
+    {
+        const auto& oilVaporizationFactor = oilVaporizationFactorTable_[regionIdx];
+
+        int n = oilVaporizationFactor.numSamples();
+        std::vector<Scalar>& pValues = workspace.xValues;
+        std::vector<Scalar>& invBValues = workspace.yValues;
+        std::vector<Scalar>& invBMuValues = workspace.y2Values;
+        pValues.resize(n);
+        invBValues.resize(n);
+        invBMuValues.resize(n);
+        for (int i = 0; i < n; ++i) {
+            Scalar p = oilVaporizationFactor.xAt(i);
+            Scalar RvSat = oilVaporizationFactor.valueAt(i);
+
+            pValues[i] = p;
+            invBValues[i] = inverseGasB_[regionIdx].eval(p, RvSat, /*extrapolate=*/true);
+            invBMuValues[i] = inverseGasBMu_[regionIdx].eval(p, RvSat, /*extrapolate=*/true);
+        }
+
+        if (n < 2) {
+            saturatedInverseGasB_[regionIdx] = TabulatedOneDFunction();
+            saturatedInverseGasBMu_[regionIdx] = TabulatedOneDFunction();
+        }
+        else {
+            saturatedInverseGasB_[regionIdx].setXYContainers(pValues, invBValues);
+            saturatedInverseGasBMu_[regionIdx].setXYContainers(pValues, invBMuValues);
+        }
+    }
+
+    // resample the undersaturated tables onto uniform (p, R_v) grids if this was
+    // requested by setUniformTableResolution()
+    Scalar updateResampledTables_(int regionIdx)
+    {
+        auto& invB = resampledInverseGasB_[regionIdx];
+        auto& invBMu = resampledInverseGasBMu_[regionIdx];
+        if (numResampledPressures_ < 2 || numResampledRv_ < 2) {
+            invB = UniformTabulatedTwoDFunction();
+            invBMu = UniformTabulatedTwoDFunction();
+            return 0.0;
+        }
+
+        Scalar err = resampleUniformly(invB, inverseGasB_[regionIdx],
+                                       numResampledPressures_, numResampledRv_);
+        return std::max(err,
+                        resampleUniformly(invBMu, inverseGasBMu_[regionIdx],
+                                          numResampledPressures_, numResampledRv_));
+    }
+
+    // returns true iff the resampled tables are available and cover a given state
+    template <class LhsEval>
+    bool useResampledTables_(int regionIdx, const LhsEval& pressure, const LhsEval& Rv) const
+    {
+        typedef Opm::MathToolbox<LhsEval> Toolbox;
+
+        const auto& invB = resampledInverseGasB_[regionIdx];
+        return
+            enableResampledTables_
+            && invB.numX() > 0
+            && invB.applies(Toolbox::value(pressure), Toolbox::value(Rv));
+    }
+
     std::vector<TabulatedTwoDFunction> inverseGasB_;
     std::vector<TabulatedTwoDFunction> gasMu_;
     std::vector<TabulatedTwoDFunction> inverseGasBMu_;
     std::vector<TabulatedOneDFunction> oilVaporizationFactorTable_;
     std::vector<Spline> saturationPressureSpline_;
+    std::vector<TabulatedOneDFunction> saturationPressureTable_;
+    std::vector<TabulatedOneDFunction> saturatedInverseGasB_;
+    std::vector<TabulatedOneDFunction> saturatedInverseGasBMu_;
+    std::vector<UniformTabulatedTwoDFunction> resampledInverseGasB_;
+    std::vector<UniformTabulatedTwoDFunction> resampledInverseGasBMu_;
+
+    int numResampledPressures_;
+    int numResampledRv_;
+    Scalar maxResamplingError_;
+    bool enableResampledTables_;
+
+    PvtReferenceDensities<Scalar, BlackOilFluidSystem> referenceDensities_;
 };
 
 } // namespace Opm
 
+// the instantiations which are provided by the library, cf. ExplicitInstantiations.hpp
+#define OPM_WET_GAS_PVT_INSTANTIATIONS(KEYWORD, Evaluation) \
+    KEYWORD class Opm::GasPvtInterfaceTemplateWrapper<double, Evaluation, \
+                                                      Opm::WetGasPvt<double, Evaluation> >; \
+    KEYWORD class Opm::WetGasPvt<double, Evaluation>;
+
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+#include <opm/material/common/ExplicitInstantiations.hpp>
+
+OPM_MATERIAL_FOR_EACH_EVALUATION(OPM_WET_GAS_PVT_INSTANTIATIONS, extern template)
+#endif
+
 #endif
@@ -27,12 +27,11 @@
 
 #include "SomertonParams.hpp"
 
-#include <opm/material/common/Spline.hpp>
-
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/MathToolbox.hpp>
 
 #include <algorithm>
+#include <cmath>
 
 namespace Opm
 {
@@ -112,27 +111,73 @@ public:
         return lambda;
     }
 
+    /*!
+     * \brief Return the effective heat conductivities of the porous medium for a
+     *        batch of cells.
+     *
+     * The saturations are passed in structure-of-arrays layout, i.e., saturation[phaseIdx]
+     * is a contiguous array with one entry per cell. The results are identical to the
+     * ones of heatConductivity() for scalar saturations, but the loop over the cells
+     * does not contain any branches, so it can be vectorized by the compiler.
+     *
+     * \param params An array of n pointers to the parameter objects of the cells
+     * \param saturation An array of numPhases pointers to the saturation arrays
+     * \param lambda The array in which the heat conductivities are stored
+     * \param n The number of cells of the batch
+     */
+    static void heatConductivityBatch(const Params* const* params,
+                                      const Scalar* const* saturation,
+                                      Scalar* lambda,
+                                      size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            lambda[i] = params[i]->vacuumLambda();
+
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            const Scalar* sat = saturation[phaseIdx];
+            if (FluidSystem::isLiquid(phaseIdx)) {
+                for (size_t i = 0; i < n; ++i) {
+                    Scalar x = std::max<Scalar>(0.0, std::min<Scalar>(1.0, sat[i]));
+                    lambda[i] +=
+                        regularizedSqrtInRange_(x)
+                        * (params[i]->fullySaturatedLambda(phaseIdx) - params[i]->vacuumLambda());
+                }
+            }
+            else { // gas phase
+                for (size_t i = 0; i < n; ++i)
+                    lambda[i] += params[i]->fullySaturatedLambda(phaseIdx) - params[i]->vacuumLambda();
+            }
+        }
+    }
+
 protected:
+    // the square root is replaced by a cubic polynomial for x < xMin. It exhibits the
+    // value and slope of the square root at xMin and twice that slope at 0, i.e.,
+    // p(x) = c1*x + c2*x^2 + c3*x^3 with c1 = 1/sqrt(xMin), c2 = 1/(2*xMin^1.5) and
+    // c3 = -1/(2*xMin^2.5). For xMin = 10^-2, these coefficients are exact.
+    static constexpr Scalar regXMin_() { return 1e-2; }
+    static constexpr Scalar regC1_() { return 10.0; }
+    static constexpr Scalar regC2_() { return 500.0; }
+    static constexpr Scalar regC3_() { return -50000.0; }
+
     template <class Evaluation>
     static Evaluation regularizedSqrt_(const Evaluation& x)
     {
         typedef Opm::MathToolbox<Evaluation> Toolbox;
 
-        static const Scalar xMin = 1e-2;
-        static const Scalar sqrtXMin = std::sqrt(xMin);
-        static const Scalar fPrimeXMin = 1.0/(2*std::sqrt(xMin));
-        static const Scalar fPrime0 = 2*fPrimeXMin;
-        typedef Opm::Spline<Scalar> Spline;
-        static const Spline sqrtRegSpline(0, xMin, // x0, x1
-                                          0, sqrtXMin, // y0, y1
-                                          fPrime0, fPrimeXMin); // m0, m1
-
-        if (x > xMin)
+        if (x > regXMin_())
             return Toolbox::sqrt(x);
         else if (x <= 0)
-            return fPrime0 * x;
+            return regC1_() * x;
         else
-            return sqrtRegSpline.eval(x);
+            return x*(regC1_() + x*(regC2_() + x*regC3_()));
+    }
+
+    // the regularized square root for 0 <= x <= 1 without branches
+    static Scalar regularizedSqrtInRange_(Scalar x)
+    {
+        Scalar poly = x*(regC1_() + x*(regC2_() + x*regC3_()));
+        return (x > regXMin_()) ? std::sqrt(x) : poly;
     }
 };
 } // namespace Opm
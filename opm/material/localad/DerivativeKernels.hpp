@@ -0,0 +1,293 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief The kernels which are used by the localized automatic differentiation (AD)
+ *        framework to operate on the derivative vectors of function evaluations.
+ *
+ * The generic implementation of these kernels consists of plain loops. For double and
+ * single precision values, versions which use SIMD instructions are provided if the
+ * compiler targets a platform which supports AVX, SSE2 or (64 bit) NEON. This can be
+ * disabled by defining the OPM_LOCAL_AD_DISABLE_SIMD macro before any of the localad
+ * headers are included.
+ */
+#ifndef OPM_LOCAL_AD_DERIVATIVE_KERNELS_HPP
+#define OPM_LOCAL_AD_DERIVATIVE_KERNELS_HPP
+
+#if !defined OPM_LOCAL_AD_DISABLE_SIMD
+#if defined __AVX__
+#include <immintrin.h>
+#define OPM_LOCAL_AD_SIMD_AVX 1
+#elif defined __SSE2__
+#include <emmintrin.h>
+#define OPM_LOCAL_AD_SIMD_SSE2 1
+#elif defined __ARM_NEON && defined __aarch64__
+#include <arm_neon.h>
+#define OPM_LOCAL_AD_SIMD_NEON 1
+#endif
+#endif
+
+namespace Opm {
+namespace LocalAd {
+/*!
+ * \brief Operations on the derivative vectors of function evaluations.
+ *
+ * All kernels operate on arrays of exactly numVars entries. The destination array may
+ * be identical to any of the source arrays.
+ */
+template <class Scalar, int numVars>
+struct DerivativeKernels
+{
+    //! a += b
+    static void add(Scalar* a, const Scalar* b)
+    {
+        for (int i = 0; i < numVars; ++i)
+            a[i] += b[i];
+    }
+
+    //! a -= b
+    static void sub(Scalar* a, const Scalar* b)
+    {
+        for (int i = 0; i < numVars; ++i)
+            a[i] -= b[i];
+    }
+
+    //! a *= alpha
+    static void scale(Scalar* a, Scalar alpha)
+    {
+        for (int i = 0; i < numVars; ++i)
+            a[i] *= alpha;
+    }
+
+    //! a = alpha*b
+    static void scaledCopy(Scalar* a, Scalar alpha, const Scalar* b)
+    {
+        for (int i = 0; i < numVars; ++i)
+            a[i] = alpha*b[i];
+    }
+
+    //! a = alpha*b + beta*c
+    static void linearCombination(Scalar* a, Scalar alpha, const Scalar* b, Scalar beta, const Scalar* c)
+    {
+        for (int i = 0; i < numVars; ++i)
+            a[i] = alpha*b[i] + beta*c[i];
+    }
+};
+
+#if defined OPM_LOCAL_AD_SIMD_AVX || defined OPM_LOCAL_AD_SIMD_SSE2 || defined OPM_LOCAL_AD_SIMD_NEON
+/*!
+ * \brief Thin wrapper around the SIMD instructions for double precision values of the
+ *        target platform.
+ *
+ * Since the derivative vectors are not necessarily aligned (e.g., if they are stored in
+ * a std::vector), unaligned loads and stores are used.
+ */
+struct SimdDoublePack
+{
+    typedef double Value;
+#if defined OPM_LOCAL_AD_SIMD_AVX
+    enum { width = 4 };
+    typedef __m256d Type;
+
+    static Type load(const double* p)
+    { return _mm256_loadu_pd(p); }
+    static void store(double* p, Type v)
+    { _mm256_storeu_pd(p, v); }
+    static Type broadcast(double v)
+    { return _mm256_set1_pd(v); }
+    static Type add(Type a, Type b)
+    { return _mm256_add_pd(a, b); }
+    static Type sub(Type a, Type b)
+    { return _mm256_sub_pd(a, b); }
+    static Type mul(Type a, Type b)
+    { return _mm256_mul_pd(a, b); }
+#elif defined OPM_LOCAL_AD_SIMD_SSE2
+    enum { width = 2 };
+    typedef __m128d Type;
+
+    static Type load(const double* p)
+    { return _mm_loadu_pd(p); }
+    static void store(double* p, Type v)
+    { _mm_storeu_pd(p, v); }
+    static Type broadcast(double v)
+    { return _mm_set1_pd(v); }
+    static Type add(Type a, Type b)
+    { return _mm_add_pd(a, b); }
+    static Type sub(Type a, Type b)
+    { return _mm_sub_pd(a, b); }
+    static Type mul(Type a, Type b)
+    { return _mm_mul_pd(a, b); }
+#else // NEON
+    enum { width = 2 };
+    typedef float64x2_t Type;
+
+    static Type load(const double* p)
+    { return vld1q_f64(p); }
+    static void store(double* p, Type v)
+    { vst1q_f64(p, v); }
+    static Type broadcast(double v)
+    { return vdupq_n_f64(v); }
+    static Type add(Type a, Type b)
+    { return vaddq_f64(a, b); }
+    static Type sub(Type a, Type b)
+    { return vsubq_f64(a, b); }
+    static Type mul(Type a, Type b)
+    { return vmulq_f64(a, b); }
+#endif
+};
+
+/*!
+ * \brief Thin wrapper around the SIMD instructions for single precision values of the
+ *        target platform.
+ *
+ * A register holds twice as many single precision values as double precision ones.
+ * This is used by evaluations which store their derivatives as float.
+ */
+struct SimdFloatPack
+{
+    typedef float Value;
+#if defined OPM_LOCAL_AD_SIMD_AVX
+    enum { width = 8 };
+    typedef __m256 Type;
+
+    static Type load(const float* p)
+    { return _mm256_loadu_ps(p); }
+    static void store(float* p, Type v)
+    { _mm256_storeu_ps(p, v); }
+    static Type broadcast(float v)
+    { return _mm256_set1_ps(v); }
+    static Type add(Type a, Type b)
+    { return _mm256_add_ps(a, b); }
+    static Type sub(Type a, Type b)
+    { return _mm256_sub_ps(a, b); }
+    static Type mul(Type a, Type b)
+    { return _mm256_mul_ps(a, b); }
+#elif defined OPM_LOCAL_AD_SIMD_SSE2
+    enum { width = 4 };
+    typedef __m128 Type;
+
+    static Type load(const float* p)
+    { return _mm_loadu_ps(p); }
+    static void store(float* p, Type v)
+    { _mm_storeu_ps(p, v); }
+    static Type broadcast(float v)
+    { return _mm_set1_ps(v); }
+    static Type add(Type a, Type b)
+    { return _mm_add_ps(a, b); }
+    static Type sub(Type a, Type b)
+    { return _mm_sub_ps(a, b); }
+    static Type mul(Type a, Type b)
+    { return _mm_mul_ps(a, b); }
+#else // NEON
+    enum { width = 4 };
+    typedef float32x4_t Type;
+
+    static Type load(const float* p)
+    { return vld1q_f32(p); }
+    static void store(float* p, Type v)
+    { vst1q_f32(p, v); }
+    static Type broadcast(float v)
+    { return vdupq_n_f32(v); }
+    static Type add(Type a, Type b)
+    { return vaddq_f32(a, b); }
+    static Type sub(Type a, Type b)
+    { return vsubq_f32(a, b); }
+    static Type mul(Type a, Type b)
+    { return vmulq_f32(a, b); }
+#endif
+};
+
+/*!
+ * \brief SIMD version of the derivative kernels.
+ *
+ * The number of derivatives is a compile time constant, so the loops over the packs
+ * are completely unrolled by the compiler. The entries which do not fill a complete
+ * pack are processed using scalar instructions.
+ */
+template <class Pack, int numVars>
+struct PackedDerivativeKernels
+{
+    typedef typename Pack::Value Value;
+    enum { width = Pack::width };
+    enum { numPacked = (numVars/width)*width };
+
+    static void add(Value* a, const Value* b)
+    {
+        for (int i = 0; i < numPacked; i += width)
+            Pack::store(a + i, Pack::add(Pack::load(a + i), Pack::load(b + i)));
+        for (int i = numPacked; i < numVars; ++i)
+            a[i] += b[i];
+    }
+
+    static void sub(Value* a, const Value* b)
+    {
+        for (int i = 0; i < numPacked; i += width)
+            Pack::store(a + i, Pack::sub(Pack::load(a + i), Pack::load(b + i)));
+        for (int i = numPacked; i < numVars; ++i)
+            a[i] -= b[i];
+    }
+
+    static void scale(Value* a, Value alpha)
+    {
+        const typename Pack::Type alphaPack = Pack::broadcast(alpha);
+        for (int i = 0; i < numPacked; i += width)
+            Pack::store(a + i, Pack::mul(alphaPack, Pack::load(a + i)));
+        for (int i = numPacked; i < numVars; ++i)
+            a[i] *= alpha;
+    }
+
+    static void scaledCopy(Value* a, Value alpha, const Value* b)
+    {
+        const typename Pack::Type alphaPack = Pack::broadcast(alpha);
+        for (int i = 0; i < numPacked; i += width)
+            Pack::store(a + i, Pack::mul(alphaPack, Pack::load(b + i)));
+        for (int i = numPacked; i < numVars; ++i)
+            a[i] = alpha*b[i];
+    }
+
+    static void linearCombination(Value* a, Value alpha, const Value* b, Value beta, const Value* c)
+    {
+        const typename Pack::Type alphaPack = Pack::broadcast(alpha);
+        const typename Pack::Type betaPack = Pack::broadcast(beta);
+        for (int i = 0; i < numPacked; i += width)
+            Pack::store(a + i, Pack::add(Pack::mul(alphaPack, Pack::load(b + i)),
+                                         Pack::mul(betaPack, Pack::load(c + i))));
+        for (int i = numPacked; i < numVars; ++i)
+            a[i] = alpha*b[i] + beta*c[i];
+    }
+};
+
+template <int numVars>
+struct DerivativeKernels<double, numVars>
+    : public PackedDerivativeKernels<SimdDoublePack, numVars>
+{};
+
+template <int numVars>
+struct DerivativeKernels<float, numVars>
+    : public PackedDerivativeKernels<SimdFloatPack, numVars>
+{};
+#endif
+
+} // namespace LocalAd
+} // namespace Opm
+
+#endif
@@ -0,0 +1,475 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Representation of an evaluation of a function and its derivatives w.r.t. a set
+ *        of variables in the localized OPM automatic differentiation (AD) framework
+ *        whose number of derivatives is specified at runtime.
+ */
+#ifndef OPM_LOCAL_AD_DYNAMIC_EVALUATION_HPP
+#define OPM_LOCAL_AD_DYNAMIC_EVALUATION_HPP
+
+#include "Evaluation.hpp"
+
+#include <opm/material/common/Valgrind.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <iostream>
+
+namespace Opm {
+namespace LocalAd {
+/*!
+ * \brief Represents a function evaluation and its derivatives w.r.t. a set of
+ *        variables whose size is only known at runtime.
+ *
+ * The derivatives are stored inline in an array of maxVars entries, but only the first
+ * numDerivatives() of them are processed by the arithmetic operators. This allows a
+ * single instantiation of the fluid systems and the material laws to serve models with
+ * a different number of primary variables: The capacity is the largest number of
+ * variables which is used by any model, while the operators only do the work which is
+ * required by the model at hand. Since the loops of the operators do not depend on the
+ * number of derivatives at compile time, they are vectorized in a strip-mined fashion
+ * by the compiler.
+ *
+ * The derivatives beyond numDerivatives() are always zero, so that the 'derivatives'
+ * attribute can be read like the one of the Evaluation class. Operations on two
+ * evaluations with a different number of derivatives yield a result which has the
+ * larger one of them. This means that constants do not need to know the number of
+ * variables: They have no derivatives at all. Likewise, a variable which is created by
+ * createVariable() without specifying the number of derivatives has just enough of
+ * them to contain its own one. If the derivatives are modified directly, the entries
+ * beyond numDerivatives() must not become non-zero, i.e., setNumDerivatives() must be
+ * called first. (Default constructed objects use all maxVars derivatives.)
+ */
+template <class ScalarT, class VarSetTag, int maxVars>
+class DynamicEvaluation
+{
+public:
+    typedef ScalarT Scalar;
+
+    //! The maximum number of derivatives
+    enum { size = maxVars };
+
+    DynamicEvaluation()
+        : numDerivs_(maxVars)
+    {}
+
+    // create an evaluation which represents a constant function
+    //
+    // i.e., f(x) = c. this implies an evaluation with the given value and no
+    // derivatives.
+    DynamicEvaluation(Scalar c)
+        : value(c)
+        , derivatives{}
+        , numDerivs_(0)
+    {}
+
+    // convert a dense evaluation. the result has the number of derivatives of the dense
+    // evaluation.
+    template <int numVars>
+    explicit DynamicEvaluation(const Evaluation<Scalar, VarSetTag, numVars>& other)
+        : value(other.value)
+        , derivatives{}
+        , numDerivs_(numVars)
+    {
+        static_assert(numVars <= maxVars,
+                      "The dense evaluation has more derivatives than the dynamic one can store");
+        std::copy(other.derivatives.begin(), other.derivatives.end(), derivatives.begin());
+    }
+
+    // create a function evaluation for a "naked" depending variable (i.e., f(x) = x)
+    // with a given number of derivatives.
+    static DynamicEvaluation createVariable(Scalar value, int varPos, int numDerivatives)
+    {
+        // The variable position must be in represented by the given variable descriptor
+        assert(0 <= varPos && varPos < numDerivatives && numDerivatives <= size);
+
+        DynamicEvaluation result(value);
+        result.numDerivs_ = numDerivatives;
+        result.derivatives[varPos] = 1.0;
+
+        return result;
+    }
+
+    // create a function evaluation for a "naked" depending variable which only has the
+    // derivatives up to its own one.
+    static DynamicEvaluation createVariable(Scalar value, int varPos)
+    { return createVariable(value, varPos, varPos + 1); }
+
+    // "evaluate" a constant function (i.e. a function that does not depend on the set of
+    // relevant variables, f(x) = c).
+    static DynamicEvaluation createConstant(Scalar value)
+    {
+        DynamicEvaluation result(value);
+        Valgrind::CheckDefined(result.value);
+        return result;
+    }
+
+    // convert the evaluation to a dense one with a given number of derivatives. the
+    // derivatives beyond numDerivatives() are zero.
+    template <int numVars>
+    Evaluation<Scalar, VarSetTag, numVars> toDense() const
+    {
+        static_assert(numVars <= maxVars,
+                      "The dense evaluation can have at most as many derivatives as the dynamic one");
+        assert(numDerivs_ <= numVars);
+
+        Evaluation<Scalar, VarSetTag, numVars> result;
+        result.value = value;
+        std::copy(derivatives.begin(), derivatives.begin() + numVars, result.derivatives.begin());
+        return result;
+    }
+
+    // returns the number of derivatives which are processed by the operators
+    int numDerivatives() const
+    { return numDerivs_; }
+
+    // change the number of derivatives. the derivatives which are added are zero,
+    // the ones which are removed are set to zero.
+    void setNumDerivatives(int n)
+    {
+        assert(0 <= n && n <= size);
+        for (int varIdx = n; varIdx < numDerivs_; ++varIdx)
+            derivatives[varIdx] = 0.0;
+        numDerivs_ = n;
+    }
+
+    // print the value and the derivatives of the function evaluation
+    void print(std::ostream& os = std::cout) const
+    {
+        os << "v: " << value << " / d:";
+        for (int varIdx = 0; varIdx < numDerivs_; ++varIdx)
+            os << " " << derivatives[varIdx];
+    }
+
+    DynamicEvaluation& operator+=(const DynamicEvaluation& other)
+    {
+        // value and derivatives are added
+        this->value += other.value;
+        int n = other.numDerivs_;
+        Scalar* a = derivatives.data();
+        const Scalar* b = other.derivatives.data();
+        for (int i = 0; i < n; ++i)
+            a[i] += b[i];
+        numDerivs_ = std::max(numDerivs_, n);
+
+        return *this;
+    }
+
+    DynamicEvaluation& operator+=(Scalar other)
+    {
+        // value is added, derivatives stay the same
+        this->value += other;
+
+        return *this;
+    }
+
+    DynamicEvaluation& operator-=(const DynamicEvaluation& other)
+    {
+        // value and derivatives are subtracted
+        this->value -= other.value;
+        int n = other.numDerivs_;
+        Scalar* a = derivatives.data();
+        const Scalar* b = other.derivatives.data();
+        for (int i = 0; i < n; ++i)
+            a[i] -= b[i];
+        numDerivs_ = std::max(numDerivs_, n);
+
+        return *this;
+    }
+
+    DynamicEvaluation& operator-=(Scalar other)
+    {
+        // for constants, values are subtracted, derivatives stay the same
+        this->value -= other;
+
+        return *this;
+    }
+
+    DynamicEvaluation& operator*=(const DynamicEvaluation& other)
+    {
+        // while the values are multiplied, the derivatives follow the product rule,
+        // i.e., (u*v)' = (v'u + u'v).
+        Scalar u = this->value;
+        Scalar v = other.value;
+        this->value *= v;
+        linearCombination(v, u, other);
+
+        return *this;
+    }
+
+    DynamicEvaluation& operator*=(Scalar other)
+    {
+        // values and derivatives are multiplied
+        this->value *= other;
+        int n = numDerivs_;
+        Scalar* a = derivatives.data();
+        for (int i = 0; i < n; ++i)
+            a[i] *= other;
+
+        return *this;
+    }
+
+    DynamicEvaluation& operator/=(const DynamicEvaluation& other)
+    {
+        // values are divided, derivatives follow the rule for division, i.e., (u/v)' =
+        // (u'v - v'u)/v^2 = u'/v - v'u/v^2.
+        Scalar u = this->value;
+        Scalar v = other.value;
+        this->value /= v;
+        linearCombination(1.0/v, -u/(v*v), other);
+
+        return *this;
+    }
+
+    DynamicEvaluation& operator/=(Scalar other)
+    {
+        // values and derivatives are divided. the value is divided directly instead of
+        // being multiplied by the reciprocal so that it is bit-for-bit identical to the
+        // result of the same operation on plain scalars.
+        Scalar quotient = this->value/other;
+        (*this) *= 1.0/other;
+        this->value = quotient;
+        return *this;
+    }
+
+    DynamicEvaluation operator+(const DynamicEvaluation& other) const
+    {
+        DynamicEvaluation result(*this);
+        result += other;
+        return result;
+    }
+
+    DynamicEvaluation operator+(Scalar other) const
+    {
+        DynamicEvaluation result(*this);
+        result += other;
+        return result;
+    }
+
+    DynamicEvaluation operator-(const DynamicEvaluation& other) const
+    {
+        DynamicEvaluation result(*this);
+        result -= other;
+        return result;
+    }
+
+    DynamicEvaluation operator-(Scalar other) const
+    {
+        DynamicEvaluation result(*this);
+        result -= other;
+        return result;
+    }
+
+    // negation (unary minus) operator
+    DynamicEvaluation operator-() const
+    {
+        DynamicEvaluation result(*this);
+        result *= -1.0;
+        return result;
+    }
+
+    DynamicEvaluation operator*(const DynamicEvaluation& other) const
+    {
+        DynamicEvaluation result(*this);
+        result *= other;
+        return result;
+    }
+
+    DynamicEvaluation operator*(Scalar other) const
+    {
+        DynamicEvaluation result(*this);
+        result *= other;
+        return result;
+    }
+
+    DynamicEvaluation operator/(const DynamicEvaluation& other) const
+    {
+        DynamicEvaluation result(*this);
+        result /= other;
+        return result;
+    }
+
+    DynamicEvaluation operator/(Scalar other) const
+    {
+        DynamicEvaluation result(*this);
+        result /= other;
+        return result;
+    }
+
+    DynamicEvaluation& operator=(Scalar other)
+    {
+        this->value = other;
+        setNumDerivatives(0);
+        return *this;
+    }
+
+    bool operator==(Scalar other) const
+    { return this->value == other; }
+
+    bool operator==(const DynamicEvaluation& other) const
+    {
+        if (this->value != other.value)
+            return false;
+
+        // the derivatives beyond the number of derivatives of both operands are zero
+        int n = std::max(numDerivs_, other.numDerivs_);
+        for (int varIdx = 0; varIdx < n; ++varIdx)
+            if (this->derivatives[varIdx] != other.derivatives[varIdx])
+                return false;
+
+        return true;
+    }
+
+    bool operator!=(const DynamicEvaluation& other) const
+    { return !operator==(other); }
+
+    bool operator>(Scalar other) const
+    { return this->value > other; }
+
+    bool operator>(const DynamicEvaluation& other) const
+    { return this->value > other.value; }
+
+    bool operator<(Scalar other) const
+    { return this->value < other; }
+
+    bool operator<(const DynamicEvaluation& other) const
+    { return this->value < other.value; }
+
+    bool operator>=(Scalar other) const
+    { return this->value >= other; }
+
+    bool operator>=(const DynamicEvaluation& other) const
+    { return this->value >= other.value; }
+
+    bool operator<=(Scalar other) const
+    { return this->value <= other; }
+
+    bool operator<=(const DynamicEvaluation& other) const
+    { return this->value <= other.value; }
+
+    // this' = alpha*this' + beta*other'. the value is not modified.
+    void linearCombination(Scalar alpha, Scalar beta, const DynamicEvaluation& other)
+    {
+        // the derivatives beyond the number of derivatives of both operands stay zero
+        int n = std::max(numDerivs_, other.numDerivs_);
+        Scalar* a = derivatives.data();
+        const Scalar* b = other.derivatives.data();
+        for (int i = 0; i < n; ++i)
+            a[i] = alpha*a[i] + beta*b[i];
+        numDerivs_ = n;
+    }
+
+    Scalar value;
+    std::array<Scalar, size> derivatives;
+
+private:
+    int numDerivs_;
+};
+
+template <class ScalarA, class Scalar, class VarSetTag, int maxVars>
+bool operator<(const ScalarA& a, const DynamicEvaluation<Scalar, VarSetTag, maxVars> &b)
+{ return b > a; }
+
+template <class ScalarA, class Scalar, class VarSetTag, int maxVars>
+bool operator>(const ScalarA& a, const DynamicEvaluation<Scalar, VarSetTag, maxVars> &b)
+{ return b < a; }
+
+template <class ScalarA, class Scalar, class VarSetTag, int maxVars>
+bool operator<=(const ScalarA& a, const DynamicEvaluation<Scalar, VarSetTag, maxVars> &b)
+{ return b >= a; }
+
+template <class ScalarA, class Scalar, class VarSetTag, int maxVars>
+bool operator>=(const ScalarA& a, const DynamicEvaluation<Scalar, VarSetTag, maxVars> &b)
+{ return b <= a; }
+
+template <class ScalarA, class Scalar, class VarSetTag, int maxVars>
+bool operator!=(const ScalarA& a, const DynamicEvaluation<Scalar, VarSetTag, maxVars> &b)
+{ return a != b.value; }
+
+template <class ScalarA, class Scalar, class VarSetTag, int maxVars>
+DynamicEvaluation<Scalar, VarSetTag, maxVars> operator+(const ScalarA& a, const DynamicEvaluation<Scalar, VarSetTag, maxVars> &b)
+{
+    DynamicEvaluation<Scalar, VarSetTag, maxVars> result(b);
+    result += a;
+    return result;
+}
+
+template <class ScalarA, class Scalar, class VarSetTag, int maxVars>
+DynamicEvaluation<Scalar, VarSetTag, maxVars> operator-(const ScalarA& a, const DynamicEvaluation<Scalar, VarSetTag, maxVars> &b)
+{
+    DynamicEvaluation<Scalar, VarSetTag, maxVars> result(b);
+    result *= -1.0;
+    result += a;
+    return result;
+}
+
+template <class ScalarA, class Scalar, class VarSetTag, int maxVars>
+DynamicEvaluation<Scalar, VarSetTag, maxVars> operator/(const ScalarA& a, const DynamicEvaluation<Scalar, VarSetTag, maxVars> &b)
+{
+    DynamicEvaluation<Scalar, VarSetTag, maxVars> result(b);
+
+    // outer derivative
+    Scalar df_dg = - a/(b.value*b.value);
+    result *= df_dg;
+    result.value = a/b.value;
+
+    return result;
+}
+
+template <class ScalarA, class Scalar, class VarSetTag, int maxVars>
+DynamicEvaluation<Scalar, VarSetTag, maxVars> operator*(const ScalarA& a, const DynamicEvaluation<Scalar, VarSetTag, maxVars> &b)
+{
+    DynamicEvaluation<Scalar, VarSetTag, maxVars> result(b);
+    result *= a;
+    return result;
+}
+
+template <class Scalar, class VarSetTag, int maxVars>
+std::ostream& operator<<(std::ostream& os, const DynamicEvaluation<Scalar, VarSetTag, maxVars>& eval)
+{
+    os << eval.value;
+    return os;
+}
+
+} // namespace LocalAd
+} // namespace Opm
+
+// this makes the Dune matrix/vector classes happy...
+#include <dune/common/ftraits.hh>
+
+namespace Dune {
+template <class Scalar, class VarSetTag, int maxVars>
+struct FieldTraits<Opm::LocalAd::DynamicEvaluation<Scalar, VarSetTag, maxVars> >
+{
+public:
+    typedef Opm::LocalAd::DynamicEvaluation<Scalar, VarSetTag, maxVars> field_type;
+    // setting real_type to field_type here potentially leads to slightly worse
+    // performance, but at least it makes things compile.
+    typedef field_type real_type;
+};
+
+} // namespace Dune
+
+#endif
@@ -29,74 +29,119 @@
 
 #include <iostream>
 #include <array>
+#include <type_traits>
+#include <utility>
 #include <cassert>
 #include <opm/material/common/Valgrind.hpp>
 
+#include "DerivativeKernels.hpp"
+
+#ifndef OPM_LOCAL_AD_EXPRESSION_TEMPLATES
+#define OPM_LOCAL_AD_EXPRESSION_TEMPLATES 0
+#endif
+
+#if OPM_LOCAL_AD_EXPRESSION_TEMPLATES
+#include "ExpressionTemplates.hpp"
+#endif
+
 #include <dune/common/version.hh>
 
 namespace Opm {
 namespace LocalAd {
+/*!
+ * \brief A sequence of indices which are known at compile time.
+ *
+ * This is a C++11 replacement for std::integer_sequence.
+ */
+template <int... indices>
+struct IndexSequence
+{};
+
+template <int n, int... indices>
+struct MakeIndexSequence
+    : public MakeIndexSequence<n - 1, n - 1, indices...>
+{};
+
+template <int... indices>
+struct MakeIndexSequence<0, indices...>
+{ typedef IndexSequence<indices...> type; };
+
 /*!
  * \brief Represents a function evaluation and its derivatives w.r.t. a fixed set of
  *        variables.
+ *
+ * By default, the derivatives are stored using the same type as the value. If
+ * DerivativeScalarT is set to a less precise type, e.g. float, while ScalarT is double,
+ * the value is still computed with full precision but the memory required for the
+ * derivatives is halved and their kernels process twice as many entries per SIMD
+ * instruction. This is usually sufficient for assembling Jacobian matrices. Such mixed
+ * precision evaluations are not supported if expression templates are enabled.
  */
-template <class ScalarT, class VarSetTag, int numVars>
+template <class ScalarT, class VarSetTag, int numVars, class DerivativeScalarT = ScalarT>
 class Evaluation
 {
+    typedef DerivativeKernels<DerivativeScalarT, numVars> Kernels;
+
+#if OPM_LOCAL_AD_EXPRESSION_TEMPLATES
+    static_assert(std::is_same<ScalarT, DerivativeScalarT>::value,
+                  "Mixed precision evaluations cannot be used with expression templates");
+#endif
+
 public:
     typedef ScalarT Scalar;
+    typedef DerivativeScalarT DerivativeScalar;
+
+    // the result of comparing two evaluations. this is a plain bool for floating point
+    // scalars, but a mask if the scalars are packs of SIMD lanes.
+    typedef decltype(std::declval<ScalarT>() < std::declval<ScalarT>()) Condition;
 
     enum { size = numVars };
 
-    Evaluation()
-    {};
+    Evaluation() = default;
 
-    // copy other function evaluation
-    Evaluation(const Evaluation& other)
-    {
-        // copy evaluated function value and derivatives
-        value = other.value;
-        std::copy(other.derivatives.begin(), other.derivatives.end(), derivatives.begin());
-    };
+    // the copy constructor and the assignment operator are the ones generated by the
+    // compiler, i.e., Evaluation objects are trivially copyable.
+    Evaluation(const Evaluation& other) = default;
+    Evaluation& operator=(const Evaluation& other) = default;
 
     // create an evaluation which represents a constant function
     //
     // i.e., f(x) = c. this implies an evaluation with the given value and all
     // derivatives being zero.
-    Evaluation(Scalar c)
+    constexpr Evaluation(Scalar c)
+        : value(c)
+        , derivatives{}
+    {}
+
+    // convert an evaluation which stores its derivatives using a different precision
+    template <class OtherDerivativeScalar>
+    explicit Evaluation(const Evaluation<Scalar, VarSetTag, numVars, OtherDerivativeScalar>& other)
+        : value(other.value)
     {
-        value = c;
-        std::fill(derivatives.begin(), derivatives.end(), 0.0);
-    };
+        for (int varIdx = 0; varIdx < size; ++varIdx)
+            derivatives[varIdx] = static_cast<DerivativeScalar>(other.derivatives[varIdx]);
+    }
+
+#if OPM_LOCAL_AD_EXPRESSION_TEMPLATES
+    // evaluate an expression
+    template <class Expr>
+    Evaluation(const Expr& expr,
+               typename std::enable_if<IsExpression<Expr>::value, int>::type = 0)
+    { assignExpression_(expr); }
+#endif
 
     // create a function evaluation for a "naked" depending variable (i.e., f(x) = x)
-    static Evaluation createVariable(Scalar value, int varPos)
+    static constexpr Evaluation createVariable(Scalar value, int varPos)
     {
         // The variable position must be in represented by the given variable descriptor
-        assert(0 <= varPos && varPos < size);
-
-        Evaluation result;
-
-        // copy function value and set all derivatives to 0, except for the variable
-        // which is represented by the value (which is set to 1.0)
-        result.value = value;
-        std::fill(result.derivatives.begin(), result.derivatives.end(), 0.0);
-        result.derivatives[varPos] = 1.0;
-
-        return result;
+        return assert(0 <= varPos && varPos < size),
+            Evaluation(value, varPos, typename MakeIndexSequence<numVars>::type());
     }
 
     // "evaluate" a constant function (i.e. a function that does not depend on the set of
     // relevant variables, f(x) = c).
-    static Evaluation createConstant(Scalar value)
-    {
-        Evaluation result;
-        result.value = value;
-        std::fill(result.derivatives.begin(), result.derivatives.end(), 0.0);
-        Valgrind::CheckDefined(result.value);
-        Valgrind::CheckDefined(result.derivatives);
-        return result;
-    }
+    static constexpr Evaluation createConstant(Scalar value)
+    { return Evaluation(value); }
 
     // print the value and the derivatives of the function evaluation
     void print(std::ostream& os = std::cout) const
@@ -111,8 +156,7 @@ public:
     {
         // value and derivatives are added
         this->value += other.value;
-        for (int varIdx= 0; varIdx < size; ++varIdx)
-            this->derivatives[varIdx] += other.derivatives[varIdx];
+        Kernels::add(this->derivatives.data(), other.derivatives.data());
 
         return *this;
     }
@@ -129,8 +173,7 @@ public:
     {
         // value and derivatives are subtracted
         this->value -= other.value;
-        for (int varIdx= 0; varIdx < size; ++varIdx)
-            this->derivatives[varIdx] -= other.derivatives[varIdx];
+        Kernels::sub(this->derivatives.data(), other.derivatives.data());
 
         return *this;
     }
@@ -150,12 +193,9 @@ public:
         Scalar u = this->value;
         Scalar v = other.value;
         this->value *= v;
-        for (int varIdx= 0; varIdx < size; ++varIdx) {
-            Scalar uPrime = this->derivatives[varIdx];
-            Scalar vPrime = other.derivatives[varIdx];
-
-            this->derivatives[varIdx] = (v*uPrime + u*vPrime);
-        }
+        Kernels::linearCombination(this->derivatives.data(),
+                                   v, this->derivatives.data(),
+                                   u, other.derivatives.data());
 
         return *this;
     }
@@ -164,40 +204,97 @@ public:
     {
         // values and derivatives are multiplied
         this->value *= other;
-        for (int varIdx= 0; varIdx < size; ++varIdx)
-            this->derivatives[varIdx] *= other;
+        Kernels::scale(this->derivatives.data(), other);
 
         return *this;
     }
 
     Evaluation& operator/=(const Evaluation& other)
     {
-        // values are divided, derivatives follow the rule for division, i.e., (u/v)' = (v'u -
-        // u'v)/v^2.
+        // values are divided, derivatives follow the rule for division, i.e., (u/v)' =
+        // (u'v - v'u)/v^2 = u'/v - v'u/v^2.
         Scalar u = this->value;
         Scalar v = other.value;
         this->value /= v;
-        for (int varIdx= 0; varIdx < size; ++varIdx) {
-            Scalar uPrime = this->derivatives[varIdx];
-            Scalar vPrime = other.derivatives[varIdx];
-
-            this->derivatives[varIdx] = (v*uPrime - u*vPrime)/(v*v);
-        }
+        Kernels::linearCombination(this->derivatives.data(),
+                                   1.0/v, this->derivatives.data(),
+                                   -u/(v*v), other.derivatives.data());
 
         return *this;
     }
 
     Evaluation& operator/=(Scalar other)
     {
-        // values and derivatives are divided
-        other = 1.0/other;
-        this->value *= other;
-        for (int varIdx= 0; varIdx < size; ++varIdx)
-            this->derivatives[varIdx] *= other;
+        // values and derivatives are divided. the value is divided directly instead of
+        // being multiplied by the reciprocal so that it is bit-for-bit identical to the
+        // result of the same operation on plain scalars.
+        this->value /= other;
+        Kernels::scale(this->derivatives.data(), 1.0/other);
+
+        return *this;
+    }
 
+#if OPM_LOCAL_AD_EXPRESSION_TEMPLATES
+    template <class Expr>
+    typename std::enable_if<IsExpression<Expr>::value, Evaluation&>::type
+    operator=(const Expr& expr)
+    {
+        assignExpression_(expr);
+        return *this;
+    }
+
+    template <class Expr>
+    typename std::enable_if<IsExpression<Expr>::value, Evaluation&>::type
+    operator+=(const Expr& expr)
+    {
+        checkExpression_(expr);
+        this->value += expr.value;
+        for (int varIdx = 0; varIdx < size; ++varIdx)
+            this->derivatives[varIdx] += expr.derivative(varIdx);
         return *this;
     }
 
+    template <class Expr>
+    typename std::enable_if<IsExpression<Expr>::value, Evaluation&>::type
+    operator-=(const Expr& expr)
+    {
+        checkExpression_(expr);
+        this->value -= expr.value;
+        for (int varIdx = 0; varIdx < size; ++varIdx)
+            this->derivatives[varIdx] -= expr.derivative(varIdx);
+        return *this;
+    }
+
+    template <class Expr>
+    typename std::enable_if<IsExpression<Expr>::value, Evaluation&>::type
+    operator*=(const Expr& expr)
+    {
+        checkExpression_(expr);
+        Scalar u = this->value;
+        Scalar v = expr.value;
+        this->value *= v;
+        for (int varIdx = 0; varIdx < size; ++varIdx)
+            this->derivatives[varIdx] = v*this->derivatives[varIdx] + u*expr.derivative(varIdx);
+        return *this;
+    }
+
+    template <class Expr>
+    typename std::enable_if<IsExpression<Expr>::value, Evaluation&>::type
+    operator/=(const Expr& expr)
+    {
+        checkExpression_(expr);
+        Scalar u = this->value;
+        Scalar v = expr.value;
+        Scalar alpha = 1.0/v;
+        Scalar beta = -u/(v*v);
+        this->value /= v;
+        for (int varIdx = 0; varIdx < size; ++varIdx)
+            this->derivatives[varIdx] = alpha*this->derivatives[varIdx] + beta*expr.derivative(varIdx);
+        return *this;
+    }
+#else
+    // if expression templates are used, the binary operators are provided by
+    // ExpressionTemplates.hpp
     Evaluation operator+(const Evaluation& other) const
     {
         Evaluation result(*this);
@@ -231,8 +328,7 @@ public:
     {
         Evaluation result;
         result.value = -this->value;
-        for (int varIdx= 0; varIdx < size; ++varIdx)
-            result.derivatives[varIdx] = - this->derivatives[varIdx];
+        Kernels::scaledCopy(result.derivatives.data(), -1.0, this->derivatives.data());
 
         return result;
     }
@@ -264,6 +360,7 @@ public:
         result /= other;
         return result;
     }
+#endif
 
     Evaluation& operator=(Scalar other)
     {
@@ -272,14 +369,6 @@ public:
         return *this;
     }
 
-    // copy assignment from evaluation
-    Evaluation& operator=(const Evaluation& other)
-    {
-        this->value = other.value;
-        std::copy(other.derivatives.begin(), other.derivatives.end(), this->derivatives.begin());
-        return *this;
-    }
-
     bool operator==(Scalar other) const
     { return this->value == other; }
 
@@ -313,106 +402,140 @@ public:
     bool operator!=(const Evaluation& other) const
     { return !operator==(other); }
 
-    bool operator>(Scalar other) const
+    Condition operator>(Scalar other) const
     { return this->value > other; }
 
-    bool operator>(const Evaluation& other) const
+    Condition operator>(const Evaluation& other) const
     { return this->value > other.value; }
 
-    bool operator<(Scalar other) const
+    Condition operator<(Scalar other) const
     { return this->value < other; }
 
-    bool operator<(const Evaluation& other) const
+    Condition operator<(const Evaluation& other) const
     { return this->value < other.value; }
 
-    bool operator>=(Scalar other) const
+    Condition operator>=(Scalar other) const
     { return this->value >= other; }
 
-    bool operator>=(const Evaluation& other) const
+    Condition operator>=(const Evaluation& other) const
     { return this->value >= other.value; }
 
-    bool operator<=(Scalar other) const
+    Condition operator<=(Scalar other) const
     { return this->value <= other; }
 
-    bool operator<=(const Evaluation& other) const
+    Condition operator<=(const Evaluation& other) const
     { return this->value <= other.value; }
 
     // maybe this should be made 'private'...
     Scalar value;
-    std::array<Scalar, size> derivatives;
+    std::array<DerivativeScalar, size> derivatives;
+
+private:
+    // the constructor used by createVariable(). the derivatives are initialized
+    // using a pack expansion to keep it constexpr.
+    template <int... varIdx>
+    constexpr Evaluation(Scalar val, int varPos, IndexSequence<varIdx...>)
+        : value(val)
+        , derivatives{{ DerivativeScalar((varIdx == varPos) ? 1 : 0)... }}
+    {}
+
+#if OPM_LOCAL_AD_EXPRESSION_TEMPLATES
+    template <class Expr>
+    static void checkExpression_(const Expr&)
+    {
+        static_assert(std::is_same<typename Expr::EvalType, Evaluation>::value,
+                      "The expression must be based on the same Evaluation type");
+    }
+
+    template <class Expr>
+    void assignExpression_(const Expr& expr)
+    {
+        checkExpression_(expr);
+
+        // the expression may refer to this object. since the derivatives are
+        // calculated element-wise and the value of the expression is already known,
+        // this is not a problem, though.
+        for (int varIdx = 0; varIdx < size; ++varIdx)
+            this->derivatives[varIdx] = expr.derivative(varIdx);
+        this->value = expr.value;
+    }
+#endif
 };
 
-template <class ScalarA, class Scalar, class VarSetTag, int numVars>
-bool operator<(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars> &b)
+template <class ScalarA, class Scalar, class VarSetTag, int numVars, class DerivScalar>
+typename Evaluation<Scalar, VarSetTag, numVars, DerivScalar>::Condition
+operator<(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars, DerivScalar> &b)
 { return b > a; }
 
-template <class ScalarA, class Scalar, class VarSetTag, int numVars>
-bool operator>(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars> &b)
+template <class ScalarA, class Scalar, class VarSetTag, int numVars, class DerivScalar>
+typename Evaluation<Scalar, VarSetTag, numVars, DerivScalar>::Condition
+operator>(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars, DerivScalar> &b)
 { return b < a; }
 
-template <class ScalarA, class Scalar, class VarSetTag, int numVars>
-bool operator<=(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars> &b)
+template <class ScalarA, class Scalar, class VarSetTag, int numVars, class DerivScalar>
+typename Evaluation<Scalar, VarSetTag, numVars, DerivScalar>::Condition
+operator<=(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars, DerivScalar> &b)
 { return b >= a; }
 
-template <class ScalarA, class Scalar, class VarSetTag, int numVars>
-bool operator>=(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars> &b)
+template <class ScalarA, class Scalar, class VarSetTag, int numVars, class DerivScalar>
+typename Evaluation<Scalar, VarSetTag, numVars, DerivScalar>::Condition
+operator>=(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars, DerivScalar> &b)
 { return b <= a; }
 
-template <class ScalarA, class Scalar, class VarSetTag, int numVars>
-bool operator!=(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars> &b)
+template <class ScalarA, class Scalar, class VarSetTag, int numVars, class DerivScalar>
+bool operator!=(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars, DerivScalar> &b)
 { return a != b.value; }
 
-template <class ScalarA, class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> operator+(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars> &b)
+#if !OPM_LOCAL_AD_EXPRESSION_TEMPLATES
+template <class ScalarA, class Scalar, class VarSetTag, int numVars, class DerivScalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> operator+(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars, DerivScalar> &b)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result(b);
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result(b);
 
     result += a;
 
     return result;
 }
 
-template <class ScalarA, class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> operator-(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars> &b)
+template <class ScalarA, class Scalar, class VarSetTag, int numVars, class DerivScalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> operator-(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars, DerivScalar> &b)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
     result.value = a - b.value;
-    for (int varIdx= 0; varIdx < numVars; ++varIdx)
-        result.derivatives[varIdx] = - b.derivatives[varIdx];
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), -1.0, b.derivatives.data());
 
     return result;
 }
 
-template <class ScalarA, class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> operator/(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars> &b)
+template <class ScalarA, class Scalar, class VarSetTag, int numVars, class DerivScalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> operator/(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars, DerivScalar> &b)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
     result.value = a/b.value;
 
     // outer derivative
     Scalar df_dg = - a/(b.value*b.value);
-    for (int varIdx= 0; varIdx < numVars; ++varIdx)
-        result.derivatives[varIdx] = df_dg*b.derivatives[varIdx];
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dg, b.derivatives.data());
 
     return result;
 }
 
-template <class ScalarA, class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> operator*(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars> &b)
+template <class ScalarA, class Scalar, class VarSetTag, int numVars, class DerivScalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> operator*(const ScalarA& a, const Evaluation<Scalar, VarSetTag, numVars, DerivScalar> &b)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
     result.value = a*b.value;
-    for (int varIdx= 0; varIdx < numVars; ++varIdx)
-        result.derivatives[varIdx] = a*b.derivatives[varIdx];
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), a, b.derivatives.data());
 
     return result;
 }
+#endif // !OPM_LOCAL_AD_EXPRESSION_TEMPLATES
 
-template <class Scalar, class VarSetTag, int numVars>
-std::ostream& operator<<(std::ostream& os, const Evaluation<Scalar, VarSetTag, numVars>& eval)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar>
+std::ostream& operator<<(std::ostream& os, const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& eval)
 {
     os << eval.value;
     return os;
@@ -447,13 +570,13 @@ std::ostream& operator<<(std::ostream& os, const Evaluation<Scalar, VarSetTag, n
 
 namespace Opm {
 namespace LocalAd {
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> abs(const Evaluation<Scalar, VarSetTag, numVars>&);
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> abs(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>&);
 }}
 
 namespace std {
-template <class Scalar, class VarSetTag, int numVars>
-const Opm::LocalAd::Evaluation<Scalar, VarSetTag, numVars> abs(const Opm::LocalAd::Evaluation<Scalar, VarSetTag, numVars>& x)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar>
+const Opm::LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivScalar> abs(const Opm::LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x)
 { return Opm::LocalAd::abs(x); }
 
 } // namespace std
@@ -471,11 +594,11 @@ const Opm::LocalAd::Evaluation<Scalar, VarSetTag, numVars> abs(const Opm::LocalA
 #include <dune/common/ftraits.hh>
 
 namespace Dune {
-template <class Scalar, class VarSetTag, int numVars>
-struct FieldTraits<Opm::LocalAd::Evaluation<Scalar, VarSetTag, numVars> >
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar>
+struct FieldTraits<Opm::LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivScalar> >
 {
 public:
-    typedef Opm::LocalAd::Evaluation<Scalar, VarSetTag, numVars> field_type;
+    typedef Opm::LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivScalar> field_type;
     // setting real_type to field_type here potentially leads to slightly worse
     // performance, but at least it makes things compile.
     typedef field_type real_type;
@@ -0,0 +1,438 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Expression templates for the localized automatic differentiation (AD)
+ *        framework.
+ *
+ * This file is only used if the OPM_LOCAL_AD_EXPRESSION_TEMPLATES macro is set to a
+ * non-zero value before Evaluation.hpp is included. In this case, the arithmetic
+ * operators of Evaluation objects do not return Evaluations but expression objects,
+ * which are evaluated when they are assigned to an Evaluation. This way, the
+ * derivatives of an expression like 'a*b + c/d' are computed in a single pass over the
+ * derivative vectors instead of creating a temporary Evaluation for each operator.
+ *
+ * The approach is based on the fact that the derivatives of all arithmetic operators
+ * are linear combinations of the derivatives of their operands, i.e., \f$ f' = \alpha
+ * a' + \beta b' \f$. The value of each sub-expression and the coefficients \f$\alpha\f$
+ * and \f$\beta\f$ are computed when the expression object is created, the derivatives
+ * are only computed on demand.
+ *
+ * Expression objects expose the 'value' attribute like Evaluations, they are implicitly
+ * convertible to Evaluations and the functions of Math.hpp accept them as arguments.
+ * Expression objects store references to the Evaluation objects on which they operate
+ * if these are lvalues, so they should not be stored in variables which outlive their
+ * operands.
+ */
+#ifndef OPM_LOCAL_AD_EXPRESSION_TEMPLATES_HPP
+#define OPM_LOCAL_AD_EXPRESSION_TEMPLATES_HPP
+
+#include <type_traits>
+
+namespace Opm {
+namespace LocalAd {
+template <class ScalarT, class VarSetTag, int numVars, class DerivativeScalarT>
+class Evaluation;
+
+/*!
+ * \brief Leaf of an expression which refers to an Evaluation object.
+ *
+ * If the Evaluation is a temporary object, it is stored by value. Otherwise, only a
+ * reference to it is kept.
+ */
+template <class EvalT, bool byValue>
+class EvaluationLeaf
+{
+    typedef typename std::conditional<byValue, EvalT, const EvalT&>::type Storage;
+
+public:
+    typedef EvalT EvalType;
+    typedef typename EvalT::Scalar Scalar;
+
+    EvaluationLeaf(const EvalT& eval)
+        : eval_(eval)
+        , value(eval.value)
+    {}
+
+    Scalar derivative(int varIdx) const
+    { return eval_.derivatives[varIdx]; }
+
+private:
+    Storage eval_;
+
+public:
+    Scalar value;
+};
+
+/*!
+ * \brief An expression which depends on a single sub-expression.
+ *
+ * The derivatives of the expression are \f$ f' = \alpha a' \f$.
+ */
+template <class ArgExpr>
+class UnaryExpression
+{
+public:
+    typedef typename ArgExpr::EvalType EvalType;
+    typedef typename ArgExpr::Scalar Scalar;
+
+    UnaryExpression(const ArgExpr& arg, Scalar val, Scalar alpha)
+        : arg_(arg)
+        , alpha_(alpha)
+        , value(val)
+    {}
+
+    Scalar derivative(int varIdx) const
+    { return alpha_*arg_.derivative(varIdx); }
+
+private:
+    ArgExpr arg_;
+    Scalar alpha_;
+
+public:
+    Scalar value;
+};
+
+/*!
+ * \brief An expression which depends on two sub-expressions.
+ *
+ * The derivatives of the expression are \f$ f' = \alpha a' + \beta b' \f$.
+ */
+template <class Arg1Expr, class Arg2Expr>
+class BinaryExpression
+{
+public:
+    typedef typename Arg1Expr::EvalType EvalType;
+    typedef typename Arg1Expr::Scalar Scalar;
+
+    static_assert(std::is_same<EvalType, typename Arg2Expr::EvalType>::value,
+                  "Both operands of an expression must use the same Evaluation type");
+
+    BinaryExpression(const Arg1Expr& arg1, const Arg2Expr& arg2, Scalar val, Scalar alpha, Scalar beta)
+        : arg1_(arg1)
+        , arg2_(arg2)
+        , alpha_(alpha)
+        , beta_(beta)
+        , value(val)
+    {}
+
+    Scalar derivative(int varIdx) const
+    { return alpha_*arg1_.derivative(varIdx) + beta_*arg2_.derivative(varIdx); }
+
+private:
+    Arg1Expr arg1_;
+    Arg2Expr arg2_;
+    Scalar alpha_;
+    Scalar beta_;
+
+public:
+    Scalar value;
+};
+
+/*!
+ * \brief Specifies whether a type is an expression of the localized AD framework.
+ */
+template <class T>
+struct IsExpression : public std::false_type {};
+
+template <class ArgExpr>
+struct IsExpression<UnaryExpression<ArgExpr> > : public std::true_type {};
+
+template <class Arg1Expr, class Arg2Expr>
+struct IsExpression<BinaryExpression<Arg1Expr, Arg2Expr> > : public std::true_type {};
+
+/*!
+ * \brief Specifies whether a type is an Evaluation.
+ */
+template <class T>
+struct IsEvaluation : public std::false_type {};
+
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar>
+struct IsEvaluation<Evaluation<Scalar, VarSetTag, numVars, DerivScalar> > : public std::true_type {};
+
+/*!
+ * \brief Specifies whether a type can be used as an operand of the expression
+ *        operators, i.e., whether it is an Evaluation or an expression.
+ */
+template <class T, class D = typename std::decay<T>::type>
+struct IsAdOperand
+    : public std::integral_constant<bool, IsEvaluation<D>::value || IsExpression<D>::value>
+{};
+
+/*!
+ * \brief Determines the type which is used to store an operand in an expression.
+ *
+ * Expressions are stored by value, Evaluations are stored by reference if they are
+ * lvalues and by value if they are temporaries.
+ */
+template <class T, class D = typename std::decay<T>::type, bool isEval = IsEvaluation<D>::value>
+struct ExpressionOperand
+{ typedef D type; };
+
+template <class T, class D>
+struct ExpressionOperand<T, D, /*isEval=*/true>
+{ typedef EvaluationLeaf<D, !std::is_lvalue_reference<T>::value> type; };
+
+/*!
+ * \brief Returns the type of an expression which results of an operator applied on
+ *        two AD operands.
+ */
+template <class T1, class T2,
+          bool enable = IsAdOperand<T1>::value && IsAdOperand<T2>::value>
+struct BinaryExpressionResult
+{};
+
+template <class T1, class T2>
+struct BinaryExpressionResult<T1, T2, /*enable=*/true>
+{
+    typedef typename ExpressionOperand<T1>::type Arg1;
+    typedef typename ExpressionOperand<T2>::type Arg2;
+    typedef BinaryExpression<Arg1, Arg2> type;
+};
+
+/*!
+ * \brief Returns the type of an expression which results of an operator applied on
+ *        an AD operand and a scalar.
+ */
+template <class T, class S,
+          bool enable = IsAdOperand<T>::value && !IsAdOperand<S>::value>
+struct ScalarExpressionResult
+{};
+
+template <class T, class S>
+struct ScalarExpressionResult<T, S, /*enable=*/true>
+{
+    typedef typename ExpressionOperand<T>::type Arg;
+    typedef UnaryExpression<Arg> type;
+};
+
+template <class T>
+struct UnaryExpressionResult
+    : public ScalarExpressionResult<T, double>
+{};
+
+/*!
+ * \brief Returns the Evaluation type of the arguments of a function which accepts two
+ *        arguments if at least one of them is an expression.
+ */
+template <class T1, class T2,
+          bool isExpr1 = IsExpression<T1>::value,
+          bool isExpr2 = IsExpression<T2>::value>
+struct MixedExpressionEval
+{};
+
+template <class T1, class T2, bool isExpr2>
+struct MixedExpressionEval<T1, T2, /*isExpr1=*/true, isExpr2>
+{ typedef typename T1::EvalType type; };
+
+template <class T1, class T2>
+struct MixedExpressionEval<T1, T2, /*isExpr1=*/false, /*isExpr2=*/true>
+{ typedef typename T2::EvalType type; };
+
+/*!
+ * \brief Converts an expression to an Evaluation. Everything else is passed through.
+ */
+template <class Expr>
+typename std::enable_if<IsExpression<Expr>::value, typename Expr::EvalType>::type
+evaluateExpression(const Expr& expr)
+{ return typename Expr::EvalType(expr); }
+
+template <class T>
+typename std::enable_if<!IsExpression<T>::value, const T&>::type
+evaluateExpression(const T& t)
+{ return t; }
+
+////////////
+// arithmetic operators
+////////////
+template <class T1, class T2>
+typename BinaryExpressionResult<T1, T2>::type
+operator+(T1&& a, T2&& b)
+{
+    typedef BinaryExpressionResult<T1, T2> R;
+    typename R::Arg1 arg1(a);
+    typename R::Arg2 arg2(b);
+    return typename R::type(arg1, arg2, arg1.value + arg2.value, 1.0, 1.0);
+}
+
+template <class T1, class T2>
+typename BinaryExpressionResult<T1, T2>::type
+operator-(T1&& a, T2&& b)
+{
+    typedef BinaryExpressionResult<T1, T2> R;
+    typename R::Arg1 arg1(a);
+    typename R::Arg2 arg2(b);
+    return typename R::type(arg1, arg2, arg1.value - arg2.value, 1.0, -1.0);
+}
+
+template <class T1, class T2>
+typename BinaryExpressionResult<T1, T2>::type
+operator*(T1&& a, T2&& b)
+{
+    // product rule: (u*v)' = v*u' + u*v'
+    typedef BinaryExpressionResult<T1, T2> R;
+    typename R::Arg1 arg1(a);
+    typename R::Arg2 arg2(b);
+    return typename R::type(arg1, arg2, arg1.value*arg2.value, arg2.value, arg1.value);
+}
+
+template <class T1, class T2>
+typename BinaryExpressionResult<T1, T2>::type
+operator/(T1&& a, T2&& b)
+{
+    // quotient rule: (u/v)' = u'/v - v'u/v^2
+    typedef BinaryExpressionResult<T1, T2> R;
+    typename R::Arg1 arg1(a);
+    typename R::Arg2 arg2(b);
+    const auto u = arg1.value;
+    const auto v = arg2.value;
+    return typename R::type(arg1, arg2, u/v, 1.0/v, -u/(v*v));
+}
+
+template <class T, class S>
+typename ScalarExpressionResult<T, S>::type
+operator+(T&& a, const S& b)
+{
+    typedef ScalarExpressionResult<T, S> R;
+    typename R::Arg arg(a);
+    return typename R::type(arg, arg.value + b, 1.0);
+}
+
+template <class S, class T>
+typename ScalarExpressionResult<T, S>::type
+operator+(const S& a, T&& b)
+{
+    typedef ScalarExpressionResult<T, S> R;
+    typename R::Arg arg(b);
+    return typename R::type(arg, a + arg.value, 1.0);
+}
+
+template <class T, class S>
+typename ScalarExpressionResult<T, S>::type
+operator-(T&& a, const S& b)
+{
+    typedef ScalarExpressionResult<T, S> R;
+    typename R::Arg arg(a);
+    return typename R::type(arg, arg.value - b, 1.0);
+}
+
+template <class S, class T>
+typename ScalarExpressionResult<T, S>::type
+operator-(const S& a, T&& b)
+{
+    typedef ScalarExpressionResult<T, S> R;
+    typename R::Arg arg(b);
+    return typename R::type(arg, a - arg.value, -1.0);
+}
+
+template <class T, class S>
+typename ScalarExpressionResult<T, S>::type
+operator*(T&& a, const S& b)
+{
+    typedef ScalarExpressionResult<T, S> R;
+    typename R::Arg arg(a);
+    return typename R::type(arg, arg.value*b, b);
+}
+
+template <class S, class T>
+typename ScalarExpressionResult<T, S>::type
+operator*(const S& a, T&& b)
+{
+    typedef ScalarExpressionResult<T, S> R;
+    typename R::Arg arg(b);
+    return typename R::type(arg, a*arg.value, a);
+}
+
+template <class T, class S>
+typename ScalarExpressionResult<T, S>::type
+operator/(T&& a, const S& b)
+{
+    typedef ScalarExpressionResult<T, S> R;
+    typename R::Arg arg(a);
+    const typename R::type::Scalar bInv = 1.0/b;
+    return typename R::type(arg, arg.value*bInv, bInv);
+}
+
+template <class S, class T>
+typename ScalarExpressionResult<T, S>::type
+operator/(const S& a, T&& b)
+{
+    typedef ScalarExpressionResult<T, S> R;
+    typename R::Arg arg(b);
+    const auto v = arg.value;
+    return typename R::type(arg, a/v, -a/(v*v));
+}
+
+template <class T>
+typename UnaryExpressionResult<T>::type
+operator-(T&& a)
+{
+    typedef UnaryExpressionResult<T> R;
+    typename R::Arg arg(a);
+    return typename R::type(arg, -arg.value, -1.0);
+}
+
+////////////
+// comparison operators for expressions. (Evaluations provide their own.)
+////////////
+template <class T>
+typename std::enable_if<IsAdOperand<T>::value, typename std::decay<T>::type::Scalar>::type
+expressionValue_(const T& t)
+{ return t.value; }
+
+template <class T>
+typename std::enable_if<!IsAdOperand<T>::value, const T&>::type
+expressionValue_(const T& t)
+{ return t; }
+
+template <class T1, class T2>
+struct ComparisonResult
+    : public std::enable_if<IsExpression<T1>::value || IsExpression<T2>::value, bool>
+{};
+
+#define OPM_LOCAL_AD_EXPRESSION_COMPARISON(OP)                          \
+    template <class T1, class T2>                                       \
+    typename ComparisonResult<T1, T2>::type                             \
+    operator OP(const T1& a, const T2& b)                               \
+    { return expressionValue_(a) OP expressionValue_(b); }
+
+OPM_LOCAL_AD_EXPRESSION_COMPARISON(<)
+OPM_LOCAL_AD_EXPRESSION_COMPARISON(>)
+OPM_LOCAL_AD_EXPRESSION_COMPARISON(<=)
+OPM_LOCAL_AD_EXPRESSION_COMPARISON(>=)
+OPM_LOCAL_AD_EXPRESSION_COMPARISON(==)
+OPM_LOCAL_AD_EXPRESSION_COMPARISON(!=)
+
+#undef OPM_LOCAL_AD_EXPRESSION_COMPARISON
+
+template <class Expr>
+typename std::enable_if<IsExpression<Expr>::value, std::ostream&>::type
+operator<<(std::ostream& os, const Expr& expr)
+{
+    os << expr.value;
+    return os;
+}
+
+} // namespace LocalAd
+} // namespace Opm
+
+#endif
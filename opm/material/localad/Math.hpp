@@ -33,364 +33,490 @@
 #include "Evaluation.hpp"
 
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/SimdPack.hpp>
 
 namespace Opm {
 namespace LocalAd {
 // provide some algebraic functions
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> abs(const Evaluation<Scalar, VarSetTag, numVars>& x)
+//
+// the functions which need to distinguish between the values of their arguments do so
+// by means of ConditionalSelect. for plain scalars, this boils down to a conventional
+// branch, whereas evaluations which use packs of SIMD lanes as scalars select the
+// result lane-wise.
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> abs(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    typedef decltype(x.value < 0.0) Condition;
 
-    result.value = std::abs(x.value);
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
+
+    result.value = MathToolbox<Scalar>::abs(x.value);
 
     // derivatives use the chain rule
-    if (x.value < 0.0) {
-        for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx)
-            result.derivatives[curVarIdx] = -x.derivatives[curVarIdx];
-    }
-    else {
-        for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx)
-            result.derivatives[curVarIdx] = x.derivatives[curVarIdx];
-    }
+    Scalar df_dx = ConditionalSelect<Condition>::exec(x.value < 0.0, Scalar(-1.0), Scalar(1.0));
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dx, x.derivatives.data());
 
     return result;
 }
 
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> min(const Evaluation<Scalar, VarSetTag, numVars>& x1,
-                                           const Evaluation<Scalar, VarSetTag, numVars>& x2)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> min(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x1,
+                                           const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x2)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    typedef decltype(x1.value < x2.value) Condition;
 
-    if (x1.value < x2.value) {
-        result.value = x1.value;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-        std::copy(x1.derivatives.begin(),
-                  x1.derivatives.end(),
-                  result.derivatives.begin());
-    }
-    else  {
-        result.value = x2.value;
-
-        std::copy(x2.derivatives.begin(),
-                  x2.derivatives.end(),
-                  result.derivatives.begin());
-    }
+    const Condition cond = x1.value < x2.value;
+    result.value = ConditionalSelect<Condition>::exec(cond, x1.value, x2.value);
+    ConditionalSelect<Condition>::copy(cond,
+                                       result.derivatives.data(),
+                                       x1.derivatives.data(),
+                                       x2.derivatives.data(),
+                                       numVars);
 
     return result;
 }
 
-template <class ScalarA, class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> min(ScalarA x1,
-                                           const Evaluation<Scalar, VarSetTag, numVars>& x2)
+template <class ScalarA, class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> min(ScalarA x1,
+                                           const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x2)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
-
-    if (x1 < x2.value) {
-        result.value = x1;
-
-        std::fill(result.derivatives.begin(),
-                  result.derivatives.end(),
-                  0.0);
-    }
-    else  {
-        result.value = x2.value;
-
-        std::copy(x2.derivatives.begin(),
-                  x2.derivatives.end(),
-                  result.derivatives.begin());
-    }
-
-    return result;
+    // treat the first argument like a constant function
+    return min(Evaluation<Scalar, VarSetTag, numVars, DerivScalar>::createConstant(x1), x2);
 }
 
-template <class ScalarB, class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> min(const Evaluation<Scalar, VarSetTag, numVars>& x2,
+template <class ScalarB, class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> min(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x2,
                                            ScalarB x1)
 { return min(x1, x2); }
 
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> max(const Evaluation<Scalar, VarSetTag, numVars>& x1,
-                                           const Evaluation<Scalar, VarSetTag, numVars>& x2)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> max(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x1,
+                                           const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x2)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
-
-    if (x1.value > x2.value) {
-        result.value = x1.value;
+    typedef decltype(x1.value > x2.value) Condition;
 
-        std::copy(x1.derivatives.begin(),
-                  x1.derivatives.end(),
-                  result.derivatives.begin());
-    }
-    else  {
-        result.value = x2.value;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-        std::copy(x2.derivatives.begin(),
-                  x2.derivatives.end(),
-                  result.derivatives.begin());
-    }
+    const Condition cond = x1.value > x2.value;
+    result.value = ConditionalSelect<Condition>::exec(cond, x1.value, x2.value);
+    ConditionalSelect<Condition>::copy(cond,
+                                       result.derivatives.data(),
+                                       x1.derivatives.data(),
+                                       x2.derivatives.data(),
+                                       numVars);
 
     return result;
 }
 
-template <class ScalarA, class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> max(ScalarA x1,
-                                           const Evaluation<Scalar, VarSetTag, numVars>& x2)
+template <class ScalarA, class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> max(ScalarA x1,
+                                           const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x2)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
-
-    if (x1 > x2.value) {
-        result.value = x1;
-
-        std::fill(result.derivatives.begin(),
-                  result.derivatives.end(),
-                  0.0);
-    }
-    else  {
-        result.value = x2.value;
-
-        std::copy(x2.derivatives.begin(),
-                  x2.derivatives.end(),
-                  result.derivatives.begin());
-    }
-
-    return result;
+    // treat the first argument like a constant function
+    return max(Evaluation<Scalar, VarSetTag, numVars, DerivScalar>::createConstant(x1), x2);
 }
 
-template <class ScalarB, class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> max(const Evaluation<Scalar, VarSetTag, numVars>& x2,
+template <class ScalarB, class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> max(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x2,
                                            ScalarB x1)
 { return max(x1, x2); }
 
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> tan(const Evaluation<Scalar, VarSetTag, numVars>& x)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> tan(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-    Scalar tmp = std::tan(x.value);
+    Scalar tmp = MathToolbox<Scalar>::tan(x.value);
     result.value = tmp;
 
     // derivatives use the chain rule
     Scalar df_dx = 1 + tmp*tmp;
-    for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx)
-        result.derivatives[curVarIdx] = df_dx*x.derivatives[curVarIdx];
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dx, x.derivatives.data());
 
     return result;
 }
 
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> atan(const Evaluation<Scalar, VarSetTag, numVars>& x)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> atan(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-    result.value = std::atan(x.value);
+    result.value = MathToolbox<Scalar>::atan(x.value);
 
     // derivatives use the chain rule
     Scalar df_dx = 1/(1 + x.value*x.value);
-    for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx)
-        result.derivatives[curVarIdx] = df_dx*x.derivatives[curVarIdx];
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dx, x.derivatives.data());
 
     return result;
 }
 
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> atan2(const Evaluation<Scalar, VarSetTag, numVars>& x,
-                                             const Evaluation<Scalar, VarSetTag, numVars>& y)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> atan2(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x,
+                                             const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& y)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-    result.value = std::atan2(x.value, y.value);
+    result.value = MathToolbox<Scalar>::atan2(x.value, y.value);
 
     // derivatives use the chain rule
     Scalar alpha = 1/(1 + (x.value*x.value)/(y.value*y.value));
-    for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx) {
-        result.derivatives[curVarIdx] =
-            alpha
-            /(y.value*y.value)
-            *(x.derivatives[curVarIdx]*y.value - x.value*y.derivatives[curVarIdx]);
-    }
+    Scalar beta = alpha/(y.value*y.value);
+    DerivativeKernels<DerivScalar, numVars>::linearCombination(result.derivatives.data(),
+                                                          beta*y.value, x.derivatives.data(),
+                                                          -beta*x.value, y.derivatives.data());
 
     return result;
 }
 
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> sin(const Evaluation<Scalar, VarSetTag, numVars>& x)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> sin(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-    result.value = std::sin(x.value);
+    result.value = MathToolbox<Scalar>::sin(x.value);
 
     // derivatives use the chain rule
-    Scalar df_dx = std::cos(x.value);
-    for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx)
-        result.derivatives[curVarIdx] = df_dx*x.derivatives[curVarIdx];
+    Scalar df_dx = MathToolbox<Scalar>::cos(x.value);
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dx, x.derivatives.data());
 
     return result;
 }
 
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> asin(const Evaluation<Scalar, VarSetTag, numVars>& x)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> asin(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-    result.value = std::asin(x.value);
+    result.value = MathToolbox<Scalar>::asin(x.value);
 
     // derivatives use the chain rule
-    Scalar df_dx = 1.0/std::sqrt(1 - x.value*x.value);
-    for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx)
-        result.derivatives[curVarIdx] = df_dx*x.derivatives[curVarIdx];
+    Scalar df_dx = 1.0/MathToolbox<Scalar>::sqrt(1 - x.value*x.value);
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dx, x.derivatives.data());
 
     return result;
 }
 
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> cos(const Evaluation<Scalar, VarSetTag, numVars>& x)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> cos(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-    result.value = std::cos(x.value);
+    result.value = MathToolbox<Scalar>::cos(x.value);
 
     // derivatives use the chain rule
-    Scalar df_dx = -std::sin(x.value);
-    for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx)
-        result.derivatives[curVarIdx] = df_dx*x.derivatives[curVarIdx];
+    Scalar df_dx = -MathToolbox<Scalar>::sin(x.value);
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dx, x.derivatives.data());
 
     return result;
 }
 
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> acos(const Evaluation<Scalar, VarSetTag, numVars>& x)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> acos(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-    result.value = std::acos(x.value);
+    result.value = MathToolbox<Scalar>::acos(x.value);
 
     // derivatives use the chain rule
-    Scalar df_dx = - 1.0/std::sqrt(1 - x.value*x.value);
-    for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx)
-        result.derivatives[curVarIdx] = df_dx*x.derivatives[curVarIdx];
+    Scalar df_dx = - 1.0/MathToolbox<Scalar>::sqrt(1 - x.value*x.value);
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dx, x.derivatives.data());
 
     return result;
 }
 
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> sqrt(const Evaluation<Scalar, VarSetTag, numVars>& x)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> sqrt(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-    Scalar sqrt_x = std::sqrt(x.value);
+    Scalar sqrt_x = MathToolbox<Scalar>::sqrt(x.value);
     result.value = sqrt_x;
 
     // derivatives use the chain rule
     Scalar df_dx = 0.5/sqrt_x;
-    for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx) {
-        result.derivatives[curVarIdx] = df_dx*x.derivatives[curVarIdx];
-    }
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dx, x.derivatives.data());
 
     return result;
 }
 
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> exp(const Evaluation<Scalar, VarSetTag, numVars>& x)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> exp(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-    Scalar exp_x = std::exp(x.value);
+    Scalar exp_x = MathToolbox<Scalar>::exp(x.value);
     result.value = exp_x;
 
     // derivatives use the chain rule
     Scalar df_dx = exp_x;
-    for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx)
-        result.derivatives[curVarIdx] = df_dx*x.derivatives[curVarIdx];
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dx, x.derivatives.data());
 
     return result;
 }
 
-// exponentiation of arbitrary base with a fixed constant
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> pow(const Evaluation<Scalar, VarSetTag, numVars>& base, Scalar exp)
+// exponentiation of arbitrary base with a fixed constant. the type of the exponent is
+// not deduced, so that plain floating point constants can be used if the scalars of the
+// evaluation are SIMD packs.
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> pow(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& base,
+                                           typename Evaluation<Scalar, VarSetTag, numVars, DerivScalar>::Scalar exp)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-    Scalar pow_x = std::pow(base.value, exp);
+    Scalar pow_x = MathToolbox<Scalar>::pow(base.value, exp);
     result.value = pow_x;
 
     // derivatives use the chain rule
     Scalar df_dx = pow_x/base.value*exp;
-    for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx)
-        result.derivatives[curVarIdx] = df_dx*base.derivatives[curVarIdx];
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dx, base.derivatives.data());
+
+    return result;
+}
+
+// exponentiation of arbitrary base with a constant integer exponent. this only requires
+// multiplications, i.e., std::pow() is avoided. only arguments which are integers
+// already are accepted, so floating point exponents never get truncated.
+template <class IntType, class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+typename std::enable_if<std::is_integral<IntType>::value, Evaluation<Scalar, VarSetTag, numVars, DerivScalar> >::type
+pow(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& base, IntType intExp)
+{
+    const int exp = static_cast<int>(intExp);
+
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
+
+    if (exp == 0) {
+        result.value = 1.0;
+        std::fill(result.derivatives.begin(), result.derivatives.end(), 0.0);
+        return result;
+    }
+
+    // the value is computed exactly like for plain scalars so that value-only
+    // evaluations yield bit-for-bit identical results
+    result.value = integerPow(base.value, exp);
+
+    // derivatives use the chain rule
+    Scalar df_dx = exp*integerPow(base.value, exp - 1);
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dx, base.derivatives.data());
 
     return result;
 }
 
 // exponentiation of constant base with an arbitrary exponent
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> pow(Scalar base, const Evaluation<Scalar, VarSetTag, numVars>& exp)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> pow(typename Evaluation<Scalar, VarSetTag, numVars, DerivScalar>::Scalar base,
+                                           const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& exp)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-    Scalar lnBase = std::log(base);
-    result.value = std::exp(lnBase*exp.value);
+    Scalar lnBase = MathToolbox<Scalar>::log(base);
+    result.value = MathToolbox<Scalar>::exp(lnBase*exp.value);
 
     // derivatives use the chain rule
     Scalar df_dx = lnBase*result.value;
-    for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx)
-        result.derivatives[curVarIdx] = df_dx*exp.derivatives[curVarIdx];
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dx, exp.derivatives.data());
 
     return result;
 }
 
 // this is the most expensive power function. Computationally it is pretty expensive, so
 // one of the above two variants above should be preferred if possible.
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> pow(const Evaluation<Scalar, VarSetTag, numVars>& base, const Evaluation<Scalar, VarSetTag, numVars>& exp)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> pow(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& base, const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& exp)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-    Scalar valuePow = std::pow(base.value, exp.value);
+    Scalar valuePow = MathToolbox<Scalar>::pow(base.value, exp.value);
     result.value = valuePow;
 
     // use the chain rule for the derivatives. since both, the base and the exponent can
     // potentially depend on the variable set, calculating these is quite elaborate...
     Scalar f = base.value;
     Scalar g = exp.value;
-    Scalar logF = std::log(f);
-    for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx) {
-        Scalar fPrime = base.derivatives[curVarIdx];
-        Scalar gPrime = exp.derivatives[curVarIdx];
-        result.derivatives[curVarIdx] = (g*fPrime/f + logF*gPrime) * valuePow;
-    }
+    Scalar logF = MathToolbox<Scalar>::log(f);
+    DerivativeKernels<DerivScalar, numVars>::linearCombination(result.derivatives.data(),
+                                                          g/f*valuePow, base.derivatives.data(),
+                                                          logF*valuePow, exp.derivatives.data());
 
     return result;
 }
 
-template <class Scalar, class VarSetTag, int numVars>
-Evaluation<Scalar, VarSetTag, numVars> log(const Evaluation<Scalar, VarSetTag, numVars>& x)
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar = Scalar>
+Evaluation<Scalar, VarSetTag, numVars, DerivScalar> log(const Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& x)
 {
-    Evaluation<Scalar, VarSetTag, numVars> result;
+    Evaluation<Scalar, VarSetTag, numVars, DerivScalar> result;
 
-    result.value = std::log(x.value);
+    result.value = MathToolbox<Scalar>::log(x.value);
 
     // derivatives use the chain rule
     Scalar df_dx = 1/x.value;
-    for (unsigned curVarIdx = 0; curVarIdx < result.derivatives.size(); ++curVarIdx)
-        result.derivatives[curVarIdx] = df_dx*x.derivatives[curVarIdx];
+    DerivativeKernels<DerivScalar, numVars>::scaledCopy(result.derivatives.data(), df_dx, x.derivatives.data());
 
     return result;
 }
 
+#if OPM_LOCAL_AD_EXPRESSION_TEMPLATES
+// versions of the functions above for expressions. Functions of a single argument
+// result in an expression themselves, i.e., their derivatives are calculated in the
+// same pass as the ones of the surrounding expression. Everything else evaluates the
+// expression arguments first.
+template <class Expr>
+struct FunctionExpressionResult
+    : public std::enable_if<IsExpression<Expr>::value, UnaryExpression<Expr> >
+{};
+
+template <class Expr>
+typename FunctionExpressionResult<Expr>::type
+abs(const Expr& x)
+{
+    typedef typename Expr::Scalar Scalar;
+    Scalar df_dx = (x.value < 0.0) ? -1.0 : 1.0;
+    return UnaryExpression<Expr>(x, std::abs(x.value), df_dx);
+}
+
+template <class Expr>
+typename FunctionExpressionResult<Expr>::type
+tan(const Expr& x)
+{
+    typedef typename Expr::Scalar Scalar;
+    Scalar tmp = std::tan(x.value);
+    return UnaryExpression<Expr>(x, tmp, 1 + tmp*tmp);
+}
+
+template <class Expr>
+typename FunctionExpressionResult<Expr>::type
+atan(const Expr& x)
+{ return UnaryExpression<Expr>(x, std::atan(x.value), 1/(1 + x.value*x.value)); }
+
+template <class Expr>
+typename FunctionExpressionResult<Expr>::type
+sin(const Expr& x)
+{ return UnaryExpression<Expr>(x, std::sin(x.value), std::cos(x.value)); }
+
+template <class Expr>
+typename FunctionExpressionResult<Expr>::type
+asin(const Expr& x)
+{ return UnaryExpression<Expr>(x, std::asin(x.value), 1.0/std::sqrt(1 - x.value*x.value)); }
+
+template <class Expr>
+typename FunctionExpressionResult<Expr>::type
+cos(const Expr& x)
+{ return UnaryExpression<Expr>(x, std::cos(x.value), -std::sin(x.value)); }
+
+template <class Expr>
+typename FunctionExpressionResult<Expr>::type
+acos(const Expr& x)
+{ return UnaryExpression<Expr>(x, std::acos(x.value), - 1.0/std::sqrt(1 - x.value*x.value)); }
+
+template <class Expr>
+typename FunctionExpressionResult<Expr>::type
+sqrt(const Expr& x)
+{
+    typedef typename Expr::Scalar Scalar;
+    Scalar sqrt_x = std::sqrt(x.value);
+    return UnaryExpression<Expr>(x, sqrt_x, 0.5/sqrt_x);
+}
+
+template <class Expr>
+typename FunctionExpressionResult<Expr>::type
+exp(const Expr& x)
+{
+    typedef typename Expr::Scalar Scalar;
+    Scalar exp_x = std::exp(x.value);
+    return UnaryExpression<Expr>(x, exp_x, exp_x);
+}
+
+template <class Expr>
+typename FunctionExpressionResult<Expr>::type
+log(const Expr& x)
+{ return UnaryExpression<Expr>(x, std::log(x.value), 1/x.value); }
+
+template <class Expr, class ScalarB>
+typename std::enable_if<!IsAdOperand<ScalarB>::value,
+                        typename FunctionExpressionResult<Expr>::type>::type
+pow(const Expr& base, ScalarB exp)
+{
+    typedef typename Expr::Scalar Scalar;
+    Scalar pow_x = std::pow(base.value, exp);
+    return UnaryExpression<Expr>(base, pow_x, pow_x/base.value*exp);
+}
+
+template <class ScalarA, class Expr>
+typename std::enable_if<!IsAdOperand<ScalarA>::value,
+                        typename FunctionExpressionResult<Expr>::type>::type
+pow(ScalarA base, const Expr& exp)
+{
+    typedef typename Expr::Scalar Scalar;
+    Scalar lnBase = std::log(base);
+    Scalar value = std::exp(lnBase*exp.value);
+    return UnaryExpression<Expr>(exp, value, lnBase*value);
+}
+
+template <class T1, class T2>
+typename std::enable_if<IsAdOperand<T1>::value && IsAdOperand<T2>::value,
+                        typename MixedExpressionEval<T1, T2>::type>::type
+pow(const T1& base, const T2& exp)
+{
+    typedef typename MixedExpressionEval<T1, T2>::type Eval;
+    return pow(Eval(base), Eval(exp));
+}
+
+template <class T1, class T2>
+typename MixedExpressionEval<T1, T2>::type
+atan2(const T1& x, const T2& y)
+{
+    typedef typename MixedExpressionEval<T1, T2>::type Eval;
+    return atan2(Eval(x), Eval(y));
+}
+
+template <class T1, class T2>
+typename MixedExpressionEval<T1, T2>::type
+min(const T1& x1, const T2& x2)
+{ return min(evaluateExpression(x1), evaluateExpression(x2)); }
+
+template <class T1, class T2>
+typename MixedExpressionEval<T1, T2>::type
+max(const T1& x1, const T2& x2)
+{ return max(evaluateExpression(x1), evaluateExpression(x2)); }
+#endif // OPM_LOCAL_AD_EXPRESSION_TEMPLATES
+
 } // namespace LocalAd
 
+// evaluations which only differ by the precision of their derivatives are converted
+// explicitly...
+template <class Scalar, class VarSetTag, int numVars, class LhsDerivScalar, class RhsDerivScalar>
+struct ToLhsEvalHelper<LocalAd::Evaluation<Scalar, VarSetTag, numVars, LhsDerivScalar>,
+                       LocalAd::Evaluation<Scalar, VarSetTag, numVars, RhsDerivScalar>,
+                       false, false>
+{
+    typedef LocalAd::Evaluation<Scalar, VarSetTag, numVars, LhsDerivScalar> ResultType;
+
+    static ResultType exec(const LocalAd::Evaluation<Scalar, VarSetTag, numVars, RhsDerivScalar>& eval)
+    { return ResultType(eval); }
+};
+
+// ... while identical ones are still passed through by reference
+template <class Scalar, class VarSetTag, int numVars, class DerivScalar>
+struct ToLhsEvalHelper<LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivScalar>,
+                       LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivScalar>,
+                       false, false>
+{
+    typedef const LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& ResultType;
+
+    static ResultType exec(const LocalAd::Evaluation<Scalar, VarSetTag, numVars, DerivScalar>& eval)
+    { return eval; }
+};
+
 // a kind of traits class for the automatic differentiation case. (The toolbox for the
 // scalar case is provided by the MathToolbox.hpp header file.)
-template <class ScalarT, class VariableSetTag, int numVars>
-struct MathToolbox<Opm::LocalAd::Evaluation<ScalarT, VariableSetTag, numVars>, false>
+template <class ScalarT, class VariableSetTag, int numVars, class DerivativeScalarT>
+struct MathToolbox<Opm::LocalAd::Evaluation<ScalarT, VariableSetTag, numVars, DerivativeScalarT>, false>
 {
 private:
 public:
     typedef ScalarT Scalar;
-    typedef Opm::LocalAd::Evaluation<ScalarT, VariableSetTag, numVars> Evaluation;
+    typedef Opm::LocalAd::Evaluation<ScalarT, VariableSetTag, numVars, DerivativeScalarT> Evaluation;
 
     static Scalar value(const Evaluation& eval)
     { return eval.value; }
@@ -401,8 +527,16 @@ public:
     static Evaluation createVariable(Scalar value, int varIdx)
     { return Evaluation::createVariable(value, varIdx); }
 
+    // if LhsEval is the same type as Evaluation, a reference to the argument is
+    // returned instead of a copy
     template <class LhsEval>
-    static LhsEval toLhs(const Evaluation& eval)
+    static typename ToLhsEvalHelper<LhsEval, Evaluation>::ResultType toLhs(const Evaluation& eval)
+    { return ToLhsEvalHelper<LhsEval, Evaluation>::exec(eval); }
+
+    // temporary arguments are always returned by value because a reference to them
+    // would not outlive the full expression of the call
+    template <class LhsEval>
+    static LhsEval toLhs(Evaluation&& eval)
     { return ToLhsEvalHelper<LhsEval, Evaluation>::exec(eval); }
 
     static const Evaluation passThroughOrCreateConstant(Scalar value)
@@ -457,6 +591,11 @@ public:
     static Evaluation pow(const Evaluation& arg1, typename Evaluation::Scalar arg2)
     { return Opm::LocalAd::pow(arg1, arg2); }
 
+    template <class IntType>
+    static typename std::enable_if<std::is_integral<IntType>::value, Evaluation>::type
+    pow(const Evaluation& arg1, IntType arg2)
+    { return Opm::LocalAd::pow(arg1, arg2); }
+
     static Evaluation pow(typename Evaluation::Scalar arg1, const Evaluation& arg2)
     { return Opm::LocalAd::pow(arg1, arg2); }
 
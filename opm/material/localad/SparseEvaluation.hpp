@@ -0,0 +1,471 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Representation of an evaluation of a function and its derivatives w.r.t. a set
+ *        of variables in the localized OPM automatic differentiation (AD) framework
+ *        which only operates on the derivatives which are potentially non-zero.
+ */
+#ifndef OPM_LOCAL_AD_SPARSE_EVALUATION_HPP
+#define OPM_LOCAL_AD_SPARSE_EVALUATION_HPP
+
+#include "Evaluation.hpp"
+
+#include <opm/material/common/Valgrind.hpp>
+
+#include <iostream>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+namespace Opm {
+namespace LocalAd {
+/*!
+ * \brief Represents a function evaluation and its derivatives w.r.t. a fixed set of
+ *        variables which keeps track of the derivatives that are non-zero.
+ *
+ * Many intermediate quantities only depend on one or two of the primary variables.
+ * Objects of this class carry a bit mask which specifies the derivatives that may be
+ * non-zero and the arithmetic operators only process these. The derivatives which are
+ * not part of the mask are always zero, so the 'derivatives' attribute can be used
+ * like the one of the Evaluation class. If it is modified directly, the mask must be
+ * updated by calling updateNonZeroMask(), though. (Default constructed objects consider
+ * all derivatives to be potentially non-zero.)
+ *
+ * The number of variables is limited to 64.
+ */
+template <class ScalarT, class VarSetTag, int numVars>
+class SparseEvaluation
+{
+    static_assert(numVars <= 64,
+                  "Sparse evaluations support at most 64 variables");
+
+public:
+    typedef ScalarT Scalar;
+
+    //! The type used to store the set of the potentially non-zero derivatives
+    typedef typename std::conditional<(numVars <= 32), std::uint32_t, std::uint64_t>::type Mask;
+
+    enum { size = numVars };
+
+    SparseEvaluation()
+        : nonZeroMask_(fullMask_())
+    {};
+
+    // create an evaluation which represents a constant function
+    //
+    // i.e., f(x) = c. this implies an evaluation with the given value and all
+    // derivatives being zero.
+    SparseEvaluation(Scalar c)
+        : nonZeroMask_(0)
+    {
+        value = c;
+        std::fill(derivatives.begin(), derivatives.end(), 0.0);
+    };
+
+    // convert a dense evaluation. only the derivatives which are non-zero are
+    // considered by subsequent operations.
+    explicit SparseEvaluation(const Evaluation<Scalar, VarSetTag, numVars>& other)
+    {
+        value = other.value;
+        derivatives = other.derivatives;
+        updateNonZeroMask();
+    }
+
+    // create a function evaluation for a "naked" depending variable (i.e., f(x) = x)
+    static SparseEvaluation createVariable(Scalar value, int varPos)
+    {
+        // The variable position must be in represented by the given variable descriptor
+        assert(0 <= varPos && varPos < size);
+
+        SparseEvaluation result(value);
+        result.derivatives[varPos] = 1.0;
+        result.nonZeroMask_ = Mask(1) << varPos;
+
+        return result;
+    }
+
+    // "evaluate" a constant function (i.e. a function that does not depend on the set of
+    // relevant variables, f(x) = c).
+    static SparseEvaluation createConstant(Scalar value)
+    {
+        SparseEvaluation result(value);
+        Valgrind::CheckDefined(result.value);
+        Valgrind::CheckDefined(result.derivatives);
+        return result;
+    }
+
+    // convert the evaluation to a dense one
+    Evaluation<Scalar, VarSetTag, numVars> toDense() const
+    {
+        Evaluation<Scalar, VarSetTag, numVars> result;
+        result.value = value;
+        result.derivatives = derivatives;
+        return result;
+    }
+
+    // returns the bit mask of the derivatives which are potentially non-zero
+    Mask nonZeroMask() const
+    { return nonZeroMask_; }
+
+    // returns true if the derivative w.r.t. a given variable is potentially non-zero
+    bool isNonZero(int varIdx) const
+    { return (nonZeroMask_ >> varIdx) & 1; }
+
+    // re-calculate the set of non-zero derivatives. this needs to be called if the
+    // 'derivatives' attribute was modified directly.
+    void updateNonZeroMask()
+    {
+        nonZeroMask_ = 0;
+        for (int varIdx = 0; varIdx < size; ++varIdx)
+            if (derivatives[varIdx] != 0.0)
+                nonZeroMask_ |= Mask(1) << varIdx;
+    }
+
+    // print the value and the derivatives of the function evaluation
+    void print(std::ostream& os = std::cout) const
+    {
+        os << "v: " << value << " / d:";
+        for (int varIdx = 0; varIdx < size; ++varIdx)
+            os << " " << derivatives[varIdx];
+    }
+
+    SparseEvaluation& operator+=(const SparseEvaluation& other)
+    {
+        // value and derivatives are added
+        this->value += other.value;
+        for (Mask m = other.nonZeroMask_; m; m &= m - 1) {
+            int varIdx = lowestBit_(m);
+            this->derivatives[varIdx] += other.derivatives[varIdx];
+        }
+        nonZeroMask_ |= other.nonZeroMask_;
+
+        return *this;
+    }
+
+    SparseEvaluation& operator+=(Scalar other)
+    {
+        // value is added, derivatives stay the same
+        this->value += other;
+
+        return *this;
+    }
+
+    SparseEvaluation& operator-=(const SparseEvaluation& other)
+    {
+        // value and derivatives are subtracted
+        this->value -= other.value;
+        for (Mask m = other.nonZeroMask_; m; m &= m - 1) {
+            int varIdx = lowestBit_(m);
+            this->derivatives[varIdx] -= other.derivatives[varIdx];
+        }
+        nonZeroMask_ |= other.nonZeroMask_;
+
+        return *this;
+    }
+
+    SparseEvaluation& operator-=(Scalar other)
+    {
+        // for constants, values are subtracted, derivatives stay the same
+        this->value -= other;
+
+        return *this;
+    }
+
+    SparseEvaluation& operator*=(const SparseEvaluation& other)
+    {
+        // while the values are multiplied, the derivatives follow the product rule,
+        // i.e., (u*v)' = (v'u + u'v).
+        Scalar u = this->value;
+        Scalar v = other.value;
+        this->value *= v;
+        linearCombination(v, u, other);
+
+        return *this;
+    }
+
+    SparseEvaluation& operator*=(Scalar other)
+    {
+        // values and derivatives are multiplied
+        this->value *= other;
+        for (Mask m = nonZeroMask_; m; m &= m - 1)
+            this->derivatives[lowestBit_(m)] *= other;
+
+        return *this;
+    }
+
+    SparseEvaluation& operator/=(const SparseEvaluation& other)
+    {
+        // values are divided, derivatives follow the rule for division, i.e., (u/v)' =
+        // (u'v - v'u)/v^2 = u'/v - v'u/v^2.
+        Scalar u = this->value;
+        Scalar v = other.value;
+        this->value /= v;
+        linearCombination(1.0/v, -u/(v*v), other);
+
+        return *this;
+    }
+
+    SparseEvaluation& operator/=(Scalar other)
+    {
+        // values and derivatives are divided
+        return (*this) *= 1.0/other;
+    }
+
+    SparseEvaluation operator+(const SparseEvaluation& other) const
+    {
+        SparseEvaluation result(*this);
+        result += other;
+        return result;
+    }
+
+    SparseEvaluation operator+(Scalar other) const
+    {
+        SparseEvaluation result(*this);
+        result += other;
+        return result;
+    }
+
+    SparseEvaluation operator-(const SparseEvaluation& other) const
+    {
+        SparseEvaluation result(*this);
+        result -= other;
+        return result;
+    }
+
+    SparseEvaluation operator-(Scalar other) const
+    {
+        SparseEvaluation result(*this);
+        result -= other;
+        return result;
+    }
+
+    // negation (unary minus) operator
+    SparseEvaluation operator-() const
+    {
+        SparseEvaluation result(*this);
+        result *= -1.0;
+        return result;
+    }
+
+    SparseEvaluation operator*(const SparseEvaluation& other) const
+    {
+        SparseEvaluation result(*this);
+        result *= other;
+        return result;
+    }
+
+    SparseEvaluation operator*(Scalar other) const
+    {
+        SparseEvaluation result(*this);
+        result *= other;
+        return result;
+    }
+
+    SparseEvaluation operator/(const SparseEvaluation& other) const
+    {
+        SparseEvaluation result(*this);
+        result /= other;
+        return result;
+    }
+
+    SparseEvaluation operator/(Scalar other) const
+    {
+        SparseEvaluation result(*this);
+        result /= other;
+        return result;
+    }
+
+    SparseEvaluation& operator=(Scalar other)
+    {
+        this->value = other;
+        for (Mask m = nonZeroMask_; m; m &= m - 1)
+            this->derivatives[lowestBit_(m)] = 0.0;
+        nonZeroMask_ = 0;
+        return *this;
+    }
+
+    bool operator==(Scalar other) const
+    { return this->value == other; }
+
+    bool operator==(const SparseEvaluation& other) const
+    {
+        if (this->value != other.value)
+            return false;
+
+        for (Mask m = nonZeroMask_ | other.nonZeroMask_; m; m &= m - 1) {
+            int varIdx = lowestBit_(m);
+            if (this->derivatives[varIdx] != other.derivatives[varIdx])
+                return false;
+        }
+
+        return true;
+    }
+
+    bool operator!=(const SparseEvaluation& other) const
+    { return !operator==(other); }
+
+    bool operator>(Scalar other) const
+    { return this->value > other; }
+
+    bool operator>(const SparseEvaluation& other) const
+    { return this->value > other.value; }
+
+    bool operator<(Scalar other) const
+    { return this->value < other; }
+
+    bool operator<(const SparseEvaluation& other) const
+    { return this->value < other.value; }
+
+    bool operator>=(Scalar other) const
+    { return this->value >= other; }
+
+    bool operator>=(const SparseEvaluation& other) const
+    { return this->value >= other.value; }
+
+    bool operator<=(Scalar other) const
+    { return this->value <= other; }
+
+    bool operator<=(const SparseEvaluation& other) const
+    { return this->value <= other.value; }
+
+    // this' = alpha*this' + beta*other'. the value is not modified.
+    void linearCombination(Scalar alpha, Scalar beta, const SparseEvaluation& other)
+    {
+        // the derivatives which are zero for both operands stay zero
+        nonZeroMask_ |= other.nonZeroMask_;
+        for (Mask m = nonZeroMask_; m; m &= m - 1) {
+            int varIdx = lowestBit_(m);
+            this->derivatives[varIdx] =
+                alpha*this->derivatives[varIdx] + beta*other.derivatives[varIdx];
+        }
+    }
+
+    Scalar value;
+    std::array<Scalar, size> derivatives;
+
+private:
+    static Mask fullMask_()
+    { return (numVars == 8*sizeof(Mask)) ? ~Mask(0) : (Mask(1) << numVars) - 1; }
+
+    static int lowestBit_(Mask m)
+    {
+        assert(m != 0);
+#if defined __GNUC__
+        return __builtin_ctzll(static_cast<unsigned long long>(m));
+#else
+        int i = 0;
+        for (; !(m & 1); m >>= 1)
+            ++i;
+        return i;
+#endif
+    }
+
+    Mask nonZeroMask_;
+};
+
+template <class ScalarA, class Scalar, class VarSetTag, int numVars>
+bool operator<(const ScalarA& a, const SparseEvaluation<Scalar, VarSetTag, numVars> &b)
+{ return b > a; }
+
+template <class ScalarA, class Scalar, class VarSetTag, int numVars>
+bool operator>(const ScalarA& a, const SparseEvaluation<Scalar, VarSetTag, numVars> &b)
+{ return b < a; }
+
+template <class ScalarA, class Scalar, class VarSetTag, int numVars>
+bool operator<=(const ScalarA& a, const SparseEvaluation<Scalar, VarSetTag, numVars> &b)
+{ return b >= a; }
+
+template <class ScalarA, class Scalar, class VarSetTag, int numVars>
+bool operator>=(const ScalarA& a, const SparseEvaluation<Scalar, VarSetTag, numVars> &b)
+{ return b <= a; }
+
+template <class ScalarA, class Scalar, class VarSetTag, int numVars>
+bool operator!=(const ScalarA& a, const SparseEvaluation<Scalar, VarSetTag, numVars> &b)
+{ return a != b.value; }
+
+template <class ScalarA, class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> operator+(const ScalarA& a, const SparseEvaluation<Scalar, VarSetTag, numVars> &b)
+{
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(b);
+    result += a;
+    return result;
+}
+
+template <class ScalarA, class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> operator-(const ScalarA& a, const SparseEvaluation<Scalar, VarSetTag, numVars> &b)
+{
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(b);
+    result *= -1.0;
+    result += a;
+    return result;
+}
+
+template <class ScalarA, class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> operator/(const ScalarA& a, const SparseEvaluation<Scalar, VarSetTag, numVars> &b)
+{
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(b);
+
+    // outer derivative
+    Scalar df_dg = - a/(b.value*b.value);
+    result *= df_dg;
+    result.value = a/b.value;
+
+    return result;
+}
+
+template <class ScalarA, class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> operator*(const ScalarA& a, const SparseEvaluation<Scalar, VarSetTag, numVars> &b)
+{
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(b);
+    result *= a;
+    return result;
+}
+
+template <class Scalar, class VarSetTag, int numVars>
+std::ostream& operator<<(std::ostream& os, const SparseEvaluation<Scalar, VarSetTag, numVars>& eval)
+{
+    os << eval.value;
+    return os;
+}
+
+} // namespace LocalAd
+} // namespace Opm
+
+// this makes the Dune matrix/vector classes happy...
+#include <dune/common/ftraits.hh>
+
+namespace Dune {
+template <class Scalar, class VarSetTag, int numVars>
+struct FieldTraits<Opm::LocalAd::SparseEvaluation<Scalar, VarSetTag, numVars> >
+{
+public:
+    typedef Opm::LocalAd::SparseEvaluation<Scalar, VarSetTag, numVars> field_type;
+    // setting real_type to field_type here potentially leads to slightly worse
+    // performance, but at least it makes things compile.
+    typedef field_type real_type;
+};
+
+} // namespace Dune
+
+#endif
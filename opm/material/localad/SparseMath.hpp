@@ -0,0 +1,366 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief A number of commonly used algebraic functions for the sparse evaluations of
+ *        the localized OPM automatic differentiation (AD) framework.
+ *
+ * This file provides variants of the functions of Math.hpp for SparseEvaluation
+ * objects.
+ */
+#ifndef OPM_LOCAL_AD_SPARSE_MATH_HPP
+#define OPM_LOCAL_AD_SPARSE_MATH_HPP
+
+#include "SparseEvaluation.hpp"
+#include "Math.hpp"
+
+#include <opm/material/common/MathToolbox.hpp>
+
+namespace Opm {
+namespace LocalAd {
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> abs(const SparseEvaluation<Scalar, VarSetTag, numVars>& x)
+{
+    Scalar df_dx = (x.value < 0.0) ? -1.0 : 1.0;
+
+    // derivatives use the chain rule
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(x);
+    result *= df_dx;
+    result.value = std::abs(x.value);
+
+    return result;
+}
+
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> min(const SparseEvaluation<Scalar, VarSetTag, numVars>& x1,
+                                                 const SparseEvaluation<Scalar, VarSetTag, numVars>& x2)
+{ return (x1.value < x2.value) ? x1 : x2; }
+
+template <class ScalarA, class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> min(ScalarA x1,
+                                                 const SparseEvaluation<Scalar, VarSetTag, numVars>& x2)
+{
+    if (x1 < x2.value)
+        return SparseEvaluation<Scalar, VarSetTag, numVars>::createConstant(x1);
+    return x2;
+}
+
+template <class ScalarB, class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> min(const SparseEvaluation<Scalar, VarSetTag, numVars>& x2,
+                                                 ScalarB x1)
+{ return min(x1, x2); }
+
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> max(const SparseEvaluation<Scalar, VarSetTag, numVars>& x1,
+                                                 const SparseEvaluation<Scalar, VarSetTag, numVars>& x2)
+{ return (x1.value > x2.value) ? x1 : x2; }
+
+template <class ScalarA, class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> max(ScalarA x1,
+                                                 const SparseEvaluation<Scalar, VarSetTag, numVars>& x2)
+{
+    if (x1 > x2.value)
+        return SparseEvaluation<Scalar, VarSetTag, numVars>::createConstant(x1);
+    return x2;
+}
+
+template <class ScalarB, class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> max(const SparseEvaluation<Scalar, VarSetTag, numVars>& x2,
+                                                 ScalarB x1)
+{ return max(x1, x2); }
+
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> tan(const SparseEvaluation<Scalar, VarSetTag, numVars>& x)
+{
+    Scalar tmp = std::tan(x.value);
+    Scalar df_dx = 1 + tmp*tmp;
+
+    // derivatives use the chain rule
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(x);
+    result *= df_dx;
+    result.value = tmp;
+
+    return result;
+}
+
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> atan(const SparseEvaluation<Scalar, VarSetTag, numVars>& x)
+{
+    Scalar df_dx = 1/(1 + x.value*x.value);
+
+    // derivatives use the chain rule
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(x);
+    result *= df_dx;
+    result.value = std::atan(x.value);
+
+    return result;
+}
+
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> atan2(const SparseEvaluation<Scalar, VarSetTag, numVars>& x,
+                                                   const SparseEvaluation<Scalar, VarSetTag, numVars>& y)
+{
+    // derivatives use the chain rule
+    Scalar alpha = 1/(1 + (x.value*x.value)/(y.value*y.value));
+    Scalar beta = alpha/(y.value*y.value);
+
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(x);
+    result.linearCombination(beta*y.value, -beta*x.value, y);
+    result.value = std::atan2(x.value, y.value);
+
+    return result;
+}
+
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> sin(const SparseEvaluation<Scalar, VarSetTag, numVars>& x)
+{
+    Scalar df_dx = std::cos(x.value);
+
+    // derivatives use the chain rule
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(x);
+    result *= df_dx;
+    result.value = std::sin(x.value);
+
+    return result;
+}
+
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> asin(const SparseEvaluation<Scalar, VarSetTag, numVars>& x)
+{
+    Scalar df_dx = 1.0/std::sqrt(1 - x.value*x.value);
+
+    // derivatives use the chain rule
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(x);
+    result *= df_dx;
+    result.value = std::asin(x.value);
+
+    return result;
+}
+
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> cos(const SparseEvaluation<Scalar, VarSetTag, numVars>& x)
+{
+    Scalar df_dx = -std::sin(x.value);
+
+    // derivatives use the chain rule
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(x);
+    result *= df_dx;
+    result.value = std::cos(x.value);
+
+    return result;
+}
+
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> acos(const SparseEvaluation<Scalar, VarSetTag, numVars>& x)
+{
+    Scalar df_dx = - 1.0/std::sqrt(1 - x.value*x.value);
+
+    // derivatives use the chain rule
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(x);
+    result *= df_dx;
+    result.value = std::acos(x.value);
+
+    return result;
+}
+
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> sqrt(const SparseEvaluation<Scalar, VarSetTag, numVars>& x)
+{
+    Scalar sqrt_x = std::sqrt(x.value);
+    Scalar df_dx = 0.5/sqrt_x;
+
+    // derivatives use the chain rule
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(x);
+    result *= df_dx;
+    result.value = sqrt_x;
+
+    return result;
+}
+
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> exp(const SparseEvaluation<Scalar, VarSetTag, numVars>& x)
+{
+    Scalar exp_x = std::exp(x.value);
+    Scalar df_dx = exp_x;
+
+    // derivatives use the chain rule
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(x);
+    result *= df_dx;
+    result.value = exp_x;
+
+    return result;
+}
+
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> log(const SparseEvaluation<Scalar, VarSetTag, numVars>& x)
+{
+    Scalar df_dx = 1/x.value;
+
+    // derivatives use the chain rule
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(x);
+    result *= df_dx;
+    result.value = std::log(x.value);
+
+    return result;
+}
+
+// exponentiation of arbitrary base with a fixed constant
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> pow(const SparseEvaluation<Scalar, VarSetTag, numVars>& base, Scalar exp)
+{
+    Scalar pow_x = std::pow(base.value, exp);
+
+    // derivatives use the chain rule
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(base);
+    result *= pow_x/base.value*exp;
+    result.value = pow_x;
+
+    return result;
+}
+
+// exponentiation of constant base with an arbitrary exponent
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> pow(Scalar base, const SparseEvaluation<Scalar, VarSetTag, numVars>& exp)
+{
+    Scalar lnBase = std::log(base);
+    Scalar value = std::exp(lnBase*exp.value);
+
+    // derivatives use the chain rule
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(exp);
+    result *= lnBase*value;
+    result.value = value;
+
+    return result;
+}
+
+// this is the most expensive power function. Computationally it is pretty expensive, so
+// one of the above two variants above should be preferred if possible.
+template <class Scalar, class VarSetTag, int numVars>
+SparseEvaluation<Scalar, VarSetTag, numVars> pow(const SparseEvaluation<Scalar, VarSetTag, numVars>& base, const SparseEvaluation<Scalar, VarSetTag, numVars>& exp)
+{
+    Scalar valuePow = std::pow(base.value, exp.value);
+
+    // use the chain rule for the derivatives. since both, the base and the exponent can
+    // potentially depend on the variable set, calculating these is quite elaborate...
+    Scalar f = base.value;
+    Scalar g = exp.value;
+    Scalar logF = std::log(f);
+
+    SparseEvaluation<Scalar, VarSetTag, numVars> result(base);
+    result.linearCombination(g/f*valuePow, logF*valuePow, exp);
+    result.value = valuePow;
+
+    return result;
+}
+
+} // namespace LocalAd
+
+template <class ScalarT, class VariableSetTag, int numVars>
+struct MathToolbox<Opm::LocalAd::SparseEvaluation<ScalarT, VariableSetTag, numVars>, false>
+{
+public:
+    typedef ScalarT Scalar;
+    typedef Opm::LocalAd::SparseEvaluation<ScalarT, VariableSetTag, numVars> Evaluation;
+
+    static Scalar value(const Evaluation& eval)
+    { return eval.value; }
+
+    static Evaluation createConstant(Scalar value)
+    { return Evaluation::createConstant(value); }
+
+    static Evaluation createVariable(Scalar value, int varIdx)
+    { return Evaluation::createVariable(value, varIdx); }
+
+    // if LhsEval is the same type as Evaluation, a reference to the argument is
+    // returned instead of a copy
+    template <class LhsEval>
+    static typename ToLhsEvalHelper<LhsEval, Evaluation>::ResultType toLhs(const Evaluation& eval)
+    { return ToLhsEvalHelper<LhsEval, Evaluation>::exec(eval); }
+
+    // temporary arguments are always returned by value because a reference to them
+    // would not outlive the full expression of the call
+    template <class LhsEval>
+    static LhsEval toLhs(Evaluation&& eval)
+    { return ToLhsEvalHelper<LhsEval, Evaluation>::exec(eval); }
+
+    static const Evaluation passThroughOrCreateConstant(Scalar value)
+    { return createConstant(value); }
+
+    static const Evaluation& passThroughOrCreateConstant(const Evaluation& eval)
+    { return eval; }
+
+
+    // arithmetic functions
+    template <class Arg1Eval, class Arg2Eval>
+    static Evaluation max(const Arg1Eval& arg1, const Arg2Eval& arg2)
+    { return Opm::LocalAd::max(arg1, arg2); }
+
+    template <class Arg1Eval, class Arg2Eval>
+    static Evaluation min(const Arg1Eval& arg1, const Arg2Eval& arg2)
+    { return Opm::LocalAd::min(arg1, arg2); }
+
+    static Evaluation abs(const Evaluation& arg)
+    { return Opm::LocalAd::abs(arg); }
+
+    static Evaluation tan(const Evaluation& arg)
+    { return Opm::LocalAd::tan(arg); }
+
+    static Evaluation atan(const Evaluation& arg)
+    { return Opm::LocalAd::atan(arg); }
+
+    static Evaluation atan2(const Evaluation& arg1, const Evaluation& arg2)
+    { return Opm::LocalAd::atan2(arg1, arg2); }
+
+    static Evaluation sin(const Evaluation& arg)
+    { return Opm::LocalAd::sin(arg); }
+
+    static Evaluation asin(const Evaluation& arg)
+    { return Opm::LocalAd::asin(arg); }
+
+    static Evaluation cos(const Evaluation& arg)
+    { return Opm::LocalAd::cos(arg); }
+
+    static Evaluation acos(const Evaluation& arg)
+    { return Opm::LocalAd::acos(arg); }
+
+    static Evaluation sqrt(const Evaluation& arg)
+    { return Opm::LocalAd::sqrt(arg); }
+
+    static Evaluation exp(const Evaluation& arg)
+    { return Opm::LocalAd::exp(arg); }
+
+    static Evaluation log(const Evaluation& arg)
+    { return Opm::LocalAd::log(arg); }
+
+    static Evaluation pow(const Evaluation& arg1, typename Evaluation::Scalar arg2)
+    { return Opm::LocalAd::pow(arg1, arg2); }
+
+    static Evaluation pow(typename Evaluation::Scalar arg1, const Evaluation& arg2)
+    { return Opm::LocalAd::pow(arg1, arg2); }
+
+    static Evaluation pow(const Evaluation& arg1, const Evaluation& arg2)
+    { return Opm::LocalAd::pow(arg1, arg2); }
+};
+
+}
+
+#endif
@@ -63,6 +63,8 @@ void checkComponent()
         { OPM_UNUSED Evaluation pv = Component::vaporPressure(T); }
         { OPM_UNUSED Evaluation rho = Component::gasDensity(T, p); }
         { OPM_UNUSED Evaluation rho = Component::liquidDensity(T, p); }
+        { OPM_UNUSED bool b = Component::isValidGasState(T, p); }
+        { OPM_UNUSED bool b = Component::isValidLiquidState(T, p); }
     }
     std::cout << "----------------------------------\n";
 }
@@ -0,0 +1,802 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief This is the unit test for the Tabulated1DFunction class.
+ */
+#include "config.h"
+
+#include <opm/material/common/Tabulated1DFunction.hpp>
+#include <opm/material/common/FlatTables.hpp>
+#include <opm/material/common/TableRegistry.hpp>
+#include <opm/material/common/TableSimplification.hpp>
+#include <opm/material/common/SharedMemoryArena.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+
+#if OPM_SHARED_MEMORY_ARENA_HAVE_SHM
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+typedef double Scalar;
+
+Scalar testFn(Scalar x)
+{ return x*x*x - 2*x; }
+
+// create a table with non-equidistant sampling points
+template <class Table>
+Table createTable()
+{
+    int n = 75;
+    Scalar xMin = -2.0;
+    Scalar xMax = 3.0;
+
+    std::vector<Scalar> x(n), y(n);
+    for (int i = 0; i < n; ++i) {
+        Scalar alpha = Scalar(i)/(n - 1);
+        x[i] = xMin + alpha*alpha*(xMax - xMin);
+        y[i] = testFn(x[i]);
+    }
+
+    return Table(x, y);
+}
+
+// make sure that the table evaluates to the same thing as a brute force linear
+// interpolation of the sampling points
+template <class Table>
+bool testEval(const Table& table)
+{
+    int n = 5000;
+    for (int i = 0; i <= n; ++i) {
+        Scalar x = table.xMin() + Scalar(i)/n*(table.xMax() - table.xMin());
+        if (i % 100 == 0)
+            // hit the sampling points exactly from time to time
+            x = table.xAt(i/100 % table.numSamples());
+
+        int segIdx = 0;
+        while (segIdx < table.numSamples() - 2 && table.xAt(segIdx + 1) < x)
+            ++segIdx;
+
+        Scalar x0 = table.xAt(segIdx);
+        Scalar x1 = table.xAt(segIdx + 1);
+        Scalar y0 = table.valueAt(segIdx);
+        Scalar y1 = table.valueAt(segIdx + 1);
+        Scalar yRef = y0 + (y1 - y0)*(x - x0)/(x1 - x0);
+
+        Scalar y = table.eval(x);
+        if (std::abs(y - yRef) > 1e-12*std::max(1.0, std::abs(yRef))) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": eval(" << x << ") != reference: "
+                      << y << " != " << yRef << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <class Table>
+bool testBatch(const Table& table)
+{
+    // use a batch size which is not a multiple of the internal chunk size and
+    // positions which jump around so that the segment search is exercised
+    int n = 1000;
+    std::vector<Scalar> x(n), y(n);
+    std::vector<Scalar> dx0(n), dx1(n), dy0(n), dy1(n);
+    for (int i = 0; i < n; ++i) {
+        Scalar alpha = std::abs(std::sin(0.1*i));
+        x[i] = table.xMin() - 0.5 + alpha*(table.xMax() - table.xMin() + 1.0);
+        dx0[i] = 1.0;
+        dx1[i] = -2.0*i;
+    }
+
+    table.evalBatch(x.data(), y.data(), n, /*extrapolate=*/true);
+    for (int i = 0; i < n; ++i) {
+        Scalar yRef = table.eval(x[i], /*extrapolate=*/true);
+        if (std::abs(y[i] - yRef) > 1e-14*std::max(1.0, std::abs(yRef))) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": evalBatch(" << x[i] << ") != eval(" << x[i] << "): "
+                      << y[i] << " != " << yRef << "\n";
+            return false;
+        }
+    }
+
+    const Scalar* xDerivs[2] = { dx0.data(), dx1.data() };
+    Scalar* yDerivs[2] = { dy0.data(), dy1.data() };
+    std::fill(y.begin(), y.end(), 0.0);
+    table.evalBatch(x.data(), xDerivs, y.data(), yDerivs, /*numDerivatives=*/2, n, /*extrapolate=*/true);
+    for (int i = 0; i < n; ++i) {
+        Scalar yRef = table.eval(x[i], /*extrapolate=*/true);
+        Scalar xClamped = std::max(table.xMin(), std::min(table.xMax(), x[i]));
+        Scalar m = table.evalDerivative(xClamped);
+        if (std::abs(y[i] - yRef) > 1e-14*std::max(1.0, std::abs(yRef))
+            || std::abs(dy0[i] - m*dx0[i]) > 1e-10*std::max(1.0, std::abs(m*dx0[i]))
+            || std::abs(dy1[i] - m*dx1[i]) > 1e-10*std::max(1.0, std::abs(m*dx1[i])))
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": SoA evalBatch(" << x[i] << ") is inconsistent with eval()\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <class Table>
+bool testSegmentHint(const Table& table)
+{
+    // sweep back and forth over the table, so that the cached segment is hit most of
+    // the time but also sometimes misses
+    Opm::SegmentHint hint;
+    int n = 2000;
+    for (int i = 0; i < n; ++i) {
+        Scalar alpha = 0.5 + 0.5*std::sin(0.01*i);
+        Scalar x = table.xMin() + alpha*(table.xMax() - table.xMin());
+
+        Scalar y = table.eval(x, hint);
+        Scalar yRef = table.eval(x);
+        if (std::abs(y - yRef) > 1e-14*std::max(1.0, std::abs(yRef))) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": eval(" << x << ", hint) != eval(" << x << "): "
+                      << y << " != " << yRef << "\n";
+            return false;
+        }
+
+        if (!hint.isValid()
+            || table.xAt(hint.segmentIdx) > x
+            || table.xAt(hint.segmentIdx + 1) < x)
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": the segment hint does not contain " << x << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// make sure that a table which stores its sampling points in single precision agrees with
+// the double precision one up to the precision of float
+template <class FloatTable, class DoubleTable>
+bool testFloatStorage(const FloatTable& floatTable, const DoubleTable& doubleTable)
+{
+    int n = 5000;
+    for (int i = 0; i <= n; ++i) {
+        Scalar x = doubleTable.xMin() + Scalar(i)/n*(doubleTable.xMax() - doubleTable.xMin());
+
+        Scalar y = floatTable.eval(x, /*extrapolate=*/true);
+        Scalar yRef = doubleTable.eval(x);
+        if (std::abs(y - yRef) > 1e-5*std::max(1.0, std::abs(yRef))) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": eval(" << x << ") of the float table != reference: "
+                      << y << " != " << yRef << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// make sure that a table which is stored in a flat buffer evaluates to the same thing as
+// the original one, also if the buffer is copied
+template <class Table>
+bool testFlatTable(const Table& table)
+{
+    Opm::FlatTableBuffer<Scalar> buffer;
+    Opm::FlatTable1D dummy = buffer.addFunction(table);
+    Opm::FlatTable1D flatTable = buffer.addFunction(table);
+    if (flatTable.offset != 2*dummy.numSamples*sizeof(Scalar)) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": unexpected offset of a flat table\n";
+        return false;
+    }
+    std::vector<Scalar> data(buffer.size()/sizeof(Scalar));
+    std::memcpy(data.data(), buffer.data(), buffer.size());
+    Opm::FlatTableView<Scalar> view(data.data());
+
+    int n = 5000;
+    for (int i = 0; i <= n; ++i) {
+        Scalar x = table.xMin() - 0.5 + Scalar(i)/n*(table.xMax() - table.xMin() + 1.0);
+
+        Scalar dydx;
+        Scalar y = view.eval(flatTable, x, /*extrapolate=*/true, dydx);
+        Scalar yRef = table.eval(x, /*extrapolate=*/true);
+        Opm::SegmentHint hint;
+        table.eval(x, hint, /*extrapolate=*/true);
+        Scalar dydxRef = table.evalDerivative(x, hint, /*extrapolate=*/true);
+        if (std::abs(y - yRef) > 1e-12*std::max(1.0, std::abs(yRef))
+            || std::abs(dydx - dydxRef) > 1e-10*std::max(1.0, std::abs(dydxRef)))
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": FlatTableView::eval(" << x << ") != eval(" << x << "): "
+                      << y << " != " << yRef << "\n";
+            return false;
+        }
+
+        y = view.eval(flatTable, x, /*extrapolate=*/false, dydx);
+        yRef = table.eval(std::max(table.xMin(), std::min(table.xMax(), x)));
+        if (std::abs(y - yRef) > 1e-12*std::max(1.0, std::abs(yRef))) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": FlatTableView::eval(" << x << ") is not clamped: "
+                      << y << " != " << yRef << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// value-only evaluations of the table must be bit-for-bit identical to the value of
+// the evaluations which also consider derivatives
+template <class Table>
+bool testValueOnly(const Table& table)
+{
+    typedef Opm::LocalAd::Evaluation<Scalar, struct ValueOnlyTestTag, 2> Eval;
+
+    int n = 1000;
+    std::vector<Scalar> x(n), y(n);
+    for (int i = 0; i < n; ++i) {
+        Scalar alpha = std::abs(std::sin(0.1*i));
+        x[i] = table.xMin() - 0.5 + alpha*(table.xMax() - table.xMin() + 1.0);
+    }
+
+    table.evalBatch(x.data(), y.data(), n, /*extrapolate=*/true);
+    for (int i = 0; i < n; ++i) {
+        Eval xEval = Eval::createVariable(x[i], 0);
+        Eval yEval = table.eval(xEval, /*extrapolate=*/true);
+        if (table.eval(x[i], /*extrapolate=*/true) != yEval.value || y[i] != yEval.value) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": value-only eval(" << x[i] << ") differs from "
+                      << "the value of the evaluation with derivatives\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// make sure that tables whose sampling points are located on a straight line are
+// classified as such and that their closed form evaluation agrees with the brute force
+// interpolation
+template <class Table>
+bool testCurveShapes()
+{
+    int n = 40;
+    std::vector<Scalar> x(n), yLinear(n), yConstant(n), yZero(n), yKinked(n);
+    for (int i = 0; i < n; ++i) {
+        Scalar alpha = Scalar(i)/(n - 1);
+        x[i] = -1.0 + 3.0*alpha*alpha;
+        yLinear[i] = 2.5 - 0.75*x[i];
+        yConstant[i] = 1e-3;
+        yZero[i] = 0.0;
+        yKinked[i] = std::abs(x[i]);
+    }
+
+    const Table linearTable(x, yLinear);
+    const Table constantTable(x, yConstant);
+    const Table zeroTable(x, yZero);
+    const Table kinkedTable(x, yKinked);
+    if (linearTable.shape() != Opm::LinearCurve
+        || constantTable.shape() != Opm::ConstantCurve
+        || zeroTable.shape() != Opm::ZeroCurve
+        || kinkedTable.shape() != Opm::GeneralCurve)
+    {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": the shape of a table has not been detected correctly\n";
+        return false;
+    }
+
+    return
+        testEval(linearTable) && testBatch(linearTable) && testValueOnly(linearTable)
+        && testEval(constantTable) && testBatch(constantTable) && testValueOnly(constantTable)
+        && testEval(zeroTable) && testBatch(zeroTable) && testValueOnly(zeroTable);
+}
+
+// make sure that removing the redundant sampling points of a finely sampled table keeps
+// all its columns within the tolerance, the end points, the points where a column
+// becomes non-zero and the monotonicity
+template <class Table>
+bool testTableSimplification()
+{
+    int n = 301;
+    Scalar tolerance = 1e-3;
+    std::vector<Scalar> x(n);
+    std::vector<std::vector<Scalar> > columns(2, std::vector<Scalar>(n));
+    for (int i = 0; i < n; ++i) {
+        x[i] = Scalar(i)/(n - 1);
+
+        // a piecewise linear relative permeability curve which is zero below 0.2, has a
+        // kink at 0.6 and is sampled much more finely than required
+        Scalar S = x[i];
+        columns[0][i] = (S < 0.2) ? 0.0 : ((S < 0.6) ? 0.25*(S - 0.2) : 0.1 + 2.25*(S - 0.6));
+
+        // a smooth, strictly decreasing column
+        columns[1][i] = std::exp(-2.0*x[i]);
+    }
+
+    std::vector<Scalar> xSimplified(x);
+    std::vector<std::vector<Scalar> > columnsSimplified(columns);
+    Opm::simplifyTable(xSimplified, columnsSimplified, tolerance);
+
+    if (xSimplified.size() >= x.size()/2
+        || xSimplified.front() != x.front()
+        || xSimplified.back() != x.back()
+        || std::find(xSimplified.begin(), xSimplified.end(), x[60]) == xSimplified.end())
+    {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": the table has not been simplified correctly\n";
+        return false;
+    }
+
+    for (unsigned colIdx = 0; colIdx < columns.size(); ++colIdx) {
+        const auto& y = columnsSimplified[colIdx];
+        const Table table(xSimplified, y);
+        Scalar scale = *std::max_element(columns[colIdx].begin(), columns[colIdx].end());
+        for (int i = 0; i < n; ++i) {
+            if (std::abs(table.eval(x[i]) - columns[colIdx][i]) > tolerance*scale*(1 + 1e-10)) {
+                std::cerr << __FILE__ << ":" << __LINE__ << ": the simplified column " << colIdx
+                          << " deviates by more than the tolerance at x=" << x[i] << "\n";
+                return false;
+            }
+        }
+
+        for (unsigned i = 1; i < y.size(); ++i) {
+            if ((colIdx == 0 && y[i] < y[i - 1]) || (colIdx == 1 && !(y[i] < y[i - 1]))) {
+                std::cerr << __FILE__ << ":" << __LINE__ << ": the simplified column " << colIdx
+                          << " is not monotonic anymore\n";
+                return false;
+            }
+        }
+    }
+
+    // a table which is not strictly ascending is left alone
+    std::vector<Scalar> xDescending(x.rbegin(), x.rend());
+    std::vector<Scalar> yDescending(columns[1]);
+    Opm::simplifyTable(xDescending, yDescending, tolerance);
+    if (xDescending.size() != x.size()) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": a descending table has been modified\n";
+        return false;
+    }
+
+    return true;
+}
+
+// make sure that the table registry hands out the same object for identical tables,
+// distinguishes different ones and forgets the tables which are not used anymore
+template <class Table>
+bool testTableRegistry(const Table& table)
+{
+    auto& registry = Opm::TableRegistry<Table>::instance();
+
+    std::vector<Scalar> x, y;
+    for (int i = 0; i < table.numSamples(); ++i) {
+        x.push_back(table.xAt(i));
+        y.push_back(table.valueAt(i));
+    }
+
+    std::shared_ptr<const Table> first = registry.intern(std::make_shared<Table>(x, y));
+    std::shared_ptr<const Table> second = registry.internCopy(Table(x, y));
+    y.back() += 1e-12;
+    std::shared_ptr<const Table> modified = registry.intern(std::make_shared<Table>(x, y));
+    if (first != second || first == modified || *first == *modified
+        || first->contentHash() != table.contentHash() || registry.size() != 2)
+    {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": the table registry does not deduplicate correctly\n";
+        return false;
+    }
+
+    modified.reset();
+    if (registry.size() != 1) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": the table registry keeps unused tables alive\n";
+        return false;
+    }
+
+    return true;
+}
+
+template <class Table>
+bool testTable(const Table& table)
+{
+    return
+        testEval(table)
+        && testBatch(table)
+        && testValueOnly(table)
+        && testSegmentHint(table)
+        && testFlatTable(table);
+}
+
+// make sure that updating the values of a table in place yields the same function as
+// creating it from scratch, also if the shape of the curve changes
+template <class Table>
+bool testValueUpdate(const Table& table)
+{
+    std::vector<Scalar> x, y, yLinear;
+    for (int i = 0; i < table.numSamples(); ++i) {
+        x.push_back(table.xAt(i));
+        y.push_back(table.valueAt(i));
+        yLinear.push_back(2.0*x.back() + 1.0);
+    }
+
+    Table updatedTable(table);
+    updatedTable.updateValues(yLinear);
+    if (!(updatedTable == Table(x, yLinear)) || updatedTable.shape() != Opm::LinearCurve) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": the values of the table have not been updated correctly\n";
+        return false;
+    }
+    if (!testEval(updatedTable))
+        return false;
+
+    updatedTable.updateValues(y);
+    if (!(updatedTable == table) || updatedTable.shape() != table.shape()) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": the values of the table have not been restored correctly\n";
+        return false;
+    }
+
+    if (!testEval(updatedTable) || !testBatch(updatedTable))
+        return false;
+
+    bool thrown = false;
+    try {
+        updatedTable.updateValues(std::vector<Scalar>(3, 0.0));
+    }
+    catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    if (!thrown) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": updating a table with the wrong number of values has been accepted\n";
+        return false;
+    }
+
+    return true;
+}
+
+// make sure that monotone cubic interpolation reproduces the sampling points, that its
+// derivative is continuous, that it does not overshoot and that it is more accurate
+// than linear interpolation for smooth functions
+template <class Table>
+bool testMonotoneCubic(const Table& linearTable)
+{
+    Table table(linearTable);
+    table.setInterpolationMode(Opm::MonotoneCubicInterpolation);
+    if (table == linearTable) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": the interpolation mode is not considered by operator==\n";
+        return false;
+    }
+
+    for (int i = 0; i < table.numSamples(); ++i) {
+        Scalar xi = table.xAt(i);
+        if (table.eval(xi) != table.valueAt(i)) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": cubic interpolation does not reproduce the sampling point "
+                      << xi << "\n";
+            return false;
+        }
+
+        if (i == 0 || i == table.numSamples() - 1)
+            continue;
+
+        Scalar eps = 1e-9*(table.xAt(i + 1) - table.xAt(i - 1));
+        Scalar mLeft = table.evalDerivative(xi - eps);
+        Scalar mRight = table.evalDerivative(xi + eps);
+        if (std::abs(mLeft - mRight) > 1e-6*std::max(1.0, std::abs(mLeft))) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": the derivative of the cubic interpolation jumps at "
+                      << xi << ": " << mLeft << " != " << mRight << "\n";
+            return false;
+        }
+    }
+
+    Scalar linearError = 0.0;
+    Scalar cubicError = 0.0;
+    int n = 5000;
+    for (int i = 0; i <= n; ++i) {
+        Scalar x = table.xMin() + Scalar(i)/n*(table.xMax() - table.xMin());
+        linearError = std::max(linearError, std::abs(linearTable.eval(x) - testFn(x)));
+        cubicError = std::max(cubicError, std::abs(table.eval(x) - testFn(x)));
+    }
+    if (!(cubicError < linearError)) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": cubic interpolation is less accurate than linear interpolation: "
+                  << cubicError << " >= " << linearError << "\n";
+        return false;
+    }
+
+    // step-like data must not cause any overshoots
+    std::vector<Scalar> xStep = { 0.0, 0.1, 0.5, 0.6, 0.65, 2.0 };
+    std::vector<Scalar> yStep = { 0.0, 0.0, 0.1, 0.9, 1.0, 1.0 };
+    Table stepTable(xStep, yStep);
+    stepTable.setInterpolationMode(Opm::MonotoneCubicInterpolation);
+    Scalar yPrev = stepTable.eval(xStep.front());
+    for (int i = 1; i <= n; ++i) {
+        Scalar x = xStep.front() + Scalar(i)/n*(xStep.back() - xStep.front());
+        Scalar y = stepTable.eval(x);
+        if (y < yPrev || y < 0.0 || y > 1.0) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": cubic interpolation of monotonic data overshoots at "
+                      << x << ": " << y << "\n";
+            return false;
+        }
+        yPrev = y;
+    }
+
+    // beyond the range of the function, it is extrapolated by its tangents
+    Scalar xBeyond = table.xMax() + 1.0;
+    Scalar yBeyondRef = table.valueAt(table.numSamples() - 1) + table.evalDerivative(table.xMax());
+    if (std::abs(table.eval(xBeyond, /*extrapolate=*/true) - yBeyondRef) > 1e-12*std::max(1.0, std::abs(yBeyondRef))
+        || table.evalSecondDerivative(xBeyond, /*extrapolate=*/true) != 0.0)
+    {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": cubic interpolation is not extrapolated linearly\n";
+        return false;
+    }
+
+    // switching back yields the original function
+    table.setInterpolationMode(Opm::LinearInterpolation);
+    if (!(table == linearTable) || table.eval(0.123) != linearTable.eval(0.123)) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": switching back to linear interpolation failed\n";
+        return false;
+    }
+    table.setInterpolationMode(Opm::MonotoneCubicInterpolation);
+
+    return
+        testBatch(table)
+        && testValueOnly(table)
+        && testSegmentHint(table);
+}
+
+// make sure that the interpolation weights reproduce the value of the table and that
+// they are its derivatives with regard to the values of the sampling points, also
+// beyond the range of the table and for curves which are evaluated in closed form
+template <class Table>
+bool testInterpolationWeights(const Table& table)
+{
+    std::vector<Scalar> x, yLinear;
+    for (int i = 0; i < table.numSamples(); ++i) {
+        x.push_back(table.xAt(i));
+        yLinear.push_back(2.0*x.back() + 1.0);
+    }
+    const Table linearTable(x, yLinear);
+
+    const Table* tables[] = { &table, &linearTable };
+    for (const Table* tab : tables) {
+        int n = 200;
+        Scalar range = tab->xMax() - tab->xMin();
+        for (int i = 0; i <= n; ++i) {
+            Scalar xv = tab->xMin() - 0.1*range + Scalar(i)/n*1.2*range;
+            Opm::InterpolationWeights<Scalar, 2> weights;
+            Scalar y = tab->evalWeights(xv, weights, /*extrapolate=*/true);
+
+            Scalar ySum = 0.0;
+            for (int k = 0; k < weights.size(); ++k)
+                ySum += weights.weight(k)*tab->valueAt(weights.xIdx(k));
+            if (weights.size() != 2
+                || std::abs(y - tab->eval(xv, /*extrapolate=*/true)) > 1e-12*std::max(1.0, std::abs(y))
+                || std::abs(y - ySum) > 1e-12*std::max(1.0, std::abs(y)))
+            {
+                std::cerr << __FILE__ << ":" << __LINE__ << ": the interpolation weights at "
+                          << xv << " do not reproduce the value of the table\n";
+                return false;
+            }
+
+            // the function is linear in the values of the sampling points, so
+            // perturbing a single one changes the value by exactly its weight
+            if (i % 20 != 0)
+                continue;
+            Scalar h = 1e-3;
+            for (int k = 0; k < weights.size(); ++k) {
+                std::vector<Scalar> yPerturbed;
+                for (int j = 0; j < tab->numSamples(); ++j)
+                    yPerturbed.push_back(tab->valueAt(j));
+                yPerturbed[weights.xIdx(k)] += h;
+
+                Table perturbedTable(*tab);
+                perturbedTable.updateValues(yPerturbed);
+                Scalar dy = (perturbedTable.eval(xv, /*extrapolate=*/true) - y)/h;
+                if (std::abs(dy - weights.weight(k)) > 1e-8*std::max(1.0, std::abs(weights.weight(k)))) {
+                    std::cerr << __FILE__ << ":" << __LINE__ << ": the weight of sampling point "
+                              << weights.xIdx(k) << " at " << xv << " is not the derivative of the value: "
+                              << weights.weight(k) << " != " << dy << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+
+    Table cubicTable(table);
+    cubicTable.setInterpolationMode(Opm::MonotoneCubicInterpolation);
+    bool thrown = false;
+    try {
+        Opm::InterpolationWeights<Scalar, 2> weights;
+        cubicTable.evalWeights(0.5*(table.xMin() + table.xMax()), weights);
+    }
+    catch (const std::logic_error&) {
+        thrown = true;
+    }
+    if (!thrown) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": interpolation weights have been computed for monotone cubic interpolation\n";
+        return false;
+    }
+
+    return true;
+}
+
+// builds a table inside a shared memory arena and reads it back from a second process
+bool testSharedMemoryArena()
+{
+#if OPM_SHARED_MEMORY_ARENA_HAVE_SHM
+    typedef Opm::SharedMemoryAllocator<Scalar> Allocator;
+    typedef Opm::Tabulated1DFunction<Scalar, Allocator> SharedTable;
+
+    const std::string name = "/opm_test_1dtables_" + std::to_string(::getpid());
+    Opm::SharedMemoryArena::remove(name);
+
+    Opm::SharedMemoryArena arena;
+    if (!arena.create(name, 1 << 16)) {
+        std::cout << "shared memory segments are not available, skipping the test of the arena\n";
+        return true;
+    }
+
+    // the arena must respect the requested alignment
+    char* p1 = static_cast<char*>(arena.allocate(3, 1));
+    void* p2 = arena.allocate(5, 64);
+    if (!arena.contains(p1) || !arena.contains(p2)
+        || reinterpret_cast<std::uintptr_t>(p2) % 64 != 0
+        || static_cast<char*>(p2) < p1 + 3)
+    {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": invalid allocation from the shared memory arena\n";
+        Opm::SharedMemoryArena::remove(name);
+        return false;
+    }
+
+    // outside of a scope, the allocator must use the heap
+    {
+        std::vector<Scalar, Allocator> v(10, 1.0);
+        if (Opm::SharedMemoryArena::isInAnyArena(v.data())) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": the allocator used an arena which is not active\n";
+            Opm::SharedMemoryArena::remove(name);
+            return false;
+        }
+    }
+
+    // inside of a scope, the allocator must use the arena
+    {
+        Opm::SharedMemoryArena::Scope scope(arena);
+        std::vector<Scalar, Allocator> v(10, 1.0);
+        if (!arena.contains(v.data()) || !arena.contains(v.data() + v.size() - 1)) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": the allocator did not use the active arena\n";
+            Opm::SharedMemoryArena::remove(name);
+            return false;
+        }
+    }
+    if (Opm::SharedMemoryArena::current()) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": the arena is still active after its scope was left\n";
+        Opm::SharedMemoryArena::remove(name);
+        return false;
+    }
+
+    // an exhausted arena must throw std::bad_alloc
+    bool thrown = false;
+    try {
+        arena.allocate(1 << 17);
+    }
+    catch (const std::bad_alloc&) {
+        thrown = true;
+    }
+    if (!thrown) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": an oversized allocation from the arena succeeded\n";
+        Opm::SharedMemoryArena::remove(name);
+        return false;
+    }
+
+    std::vector<Scalar> x = { 0.0, 1.0, 2.5, 4.0 };
+    std::vector<Scalar> y = { 1.0, -2.0, 3.0, 0.5 };
+    const SharedTable* table = arena.construct<SharedTable>(x, y);
+    if (!arena.contains(table) || table->numSamples() != 4) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": the table was not placed into the shared memory arena\n";
+        Opm::SharedMemoryArena::remove(name);
+        return false;
+    }
+    arena.publish(table);
+
+    // no memory can be allocated after the root object has been published
+    thrown = false;
+    try {
+        arena.allocate(8);
+    }
+    catch (const std::logic_error&) {
+        thrown = true;
+    }
+    if (!thrown) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": memory was allocated from a published arena\n";
+        Opm::SharedMemoryArena::remove(name);
+        return false;
+    }
+
+    // attaching within the creating process is impossible because the segment must be
+    // mapped at the creator's address. thus, let a child process read the table.
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        arena.detach();
+
+        Opm::SharedMemoryArena attached;
+        if (!attached.attach(name) || attached.isCreator())
+            ::_exit(1);
+
+        const SharedTable* sharedTable = attached.root<SharedTable>();
+        if (!sharedTable || sharedTable->numSamples() != static_cast<int>(x.size()))
+            ::_exit(1);
+
+        for (size_t i = 0; i < x.size(); ++i) {
+            if (sharedTable->xAt(static_cast<int>(i)) != x[i] || sharedTable->valueAt(static_cast<int>(i)) != y[i])
+                ::_exit(1);
+        }
+        if (std::abs(sharedTable->eval(0.5*(x[1] + x[2])) - 0.5*(y[1] + y[2])) > 1e-12)
+            ::_exit(1);
+
+        ::_exit(0);
+    }
+
+    int status = 1;
+    bool childOk = pid > 0 && ::waitpid(pid, &status, 0) == pid
+        && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    Opm::SharedMemoryArena::remove(name);
+
+    if (!childOk) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": the table could not be read from the attached arena\n";
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+int main()
+{
+    typedef Opm::Tabulated1DFunction<Scalar> DoubleTable;
+    typedef Opm::Tabulated1DFunction<Scalar, std::allocator<Scalar>, float> FloatTable;
+
+    auto table = createTable<DoubleTable>();
+    if (!testTable(table))
+        return 1;
+
+    auto floatTable = createTable<FloatTable>();
+    if (!testTable(floatTable))
+        return 1;
+
+    if (!testFloatStorage(floatTable, table))
+        return 1;
+
+    if (!testCurveShapes<DoubleTable>())
+        return 1;
+
+    if (!testTableSimplification<DoubleTable>())
+        return 1;
+
+    if (!testTableRegistry(table))
+        return 1;
+
+    if (!testValueUpdate(table))
+        return 1;
+
+    if (!testInterpolationWeights(table))
+        return 1;
+
+    if (!testMonotoneCubic(table))
+        return 1;
+
+    if (!testSharedMemoryArena())
+        return 1;
+
+    return 0;
+}
@@ -29,13 +29,49 @@
 
 #include <opm/material/common/UniformXTabulated2DFunction.hpp>
 #include <opm/material/common/UniformTabulated2DFunction.hpp>
+#include <opm/material/common/UniformTabulated2DMultiFunction.hpp>
+#include <opm/material/common/FlatTables.hpp>
+#include <opm/material/common/FlatTableBroadcast.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
 
 #include <memory>
+#include <vector>
+#include <stdexcept>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <string>
+
+// include the MPI header if available
+#if HAVE_MPI
+#include <mpi.h>
+#endif // HAVE_MPI
 
 typedef double Scalar;
 
+class MyMpiHelper
+{
+public:
+#if HAVE_MPI
+    MyMpiHelper(int &argc, char **&argv)
+    {
+        MPI_Init(&argc, &argv);
+    };
+#else
+    MyMpiHelper(int &/*argc*/, char **&/*argv*/)
+    {};
+#endif // HAVE_MPI
+
+    ~MyMpiHelper()
+    {
+#if HAVE_MPI
+        MPI_Finalize();
+#endif // HAVE_MPI
+    };
+};
+
 Scalar testFn1(Scalar x, Scalar /* y */)
 { return x; }
 
@@ -154,6 +190,412 @@ bool compareTableWithAnalyticFn(const Table &table,
     return true;
 }
 
+template <class UniformXTablePtr>
+bool compareSegmentHintEval(const UniformXTablePtr uXTable,
+                            Scalar xMin,
+                            Scalar xMax,
+                            Scalar yMin,
+                            Scalar yMax,
+                            int numSteps)
+{
+    // walk along a curve through the tabulated domain and make sure that the variant
+    // of eval() which uses a segment hint yields the same result as the one which
+    // does not
+    Opm::SegmentHint2D hint;
+    for (int i = 0; i <= numSteps; ++i) {
+        Scalar alpha = 0.5 + 0.5*std::sin(0.02*i);
+        Scalar beta = 0.5 + 0.5*std::cos(0.03*i);
+        Scalar x = xMin + alpha*(xMax - xMin);
+        Scalar y = yMin + beta*(yMax - yMin);
+
+        Scalar value = uXTable->eval(x, y, hint, /*extrapolate=*/true);
+        Scalar valueRef = uXTable->eval(x, y, /*extrapolate=*/true);
+        if (std::abs(value - valueRef) > 1e-10*std::max(1.0, std::abs(valueRef))) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": uXTable->eval("<<x<<","<<y<<",hint) != uXTable->eval("<<x<<","<<y<<"): " << value << " != " << valueRef << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <class UniformXTablePtr>
+bool compareInterpolationWeights(const UniformXTablePtr uXTable,
+                                 Scalar xMin,
+                                 Scalar xMax,
+                                 Scalar yMin,
+                                 Scalar yMax,
+                                 int numSteps)
+{
+    // the weights of the sampling points must reproduce the value of the table, also
+    // if the table is extrapolated
+    for (int i = 0; i <= numSteps; ++i) {
+        Scalar alpha = 0.5 + 0.5*std::sin(0.02*i);
+        Scalar beta = 0.5 + 0.5*std::cos(0.03*i);
+        Scalar x = xMin + alpha*(xMax - xMin);
+        Scalar y = yMin + beta*(yMax - yMin);
+
+        Opm::InterpolationWeights<Scalar, 4> weights;
+        Scalar value = uXTable->evalWeights(x, y, weights, /*extrapolate=*/true);
+        Scalar valueRef = uXTable->eval(x, y, /*extrapolate=*/true);
+
+        Scalar valueSum = 0.0;
+        Scalar weightSum = 0.0;
+        for (int k = 0; k < weights.size(); ++k) {
+            valueSum += weights.weight(k)*uXTable->valueAt(weights.xIdx(k), weights.yIdx(k));
+            weightSum += weights.weight(k);
+        }
+
+        if (std::abs(value - valueRef) > 1e-10*std::max(1.0, std::abs(valueRef))
+            || std::abs(valueSum - valueRef) > 1e-10*std::max(1.0, std::abs(valueRef))
+            || std::abs(weightSum - 1.0) > 1e-10)
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": the interpolation weights at ("<<x<<","<<y<<") do not reproduce uXTable->eval("<<x<<","<<y<<"): " << valueSum << " != " << valueRef << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <class UniformXTablePtr>
+bool compareFinalizedTable(const UniformXTablePtr uXTable,
+                           Scalar xMin,
+                           Scalar xMax,
+                           Scalar yMin,
+                           Scalar yMax,
+                           int numSteps)
+{
+    // the compact layout of the table must not change any results
+    typename UniformXTablePtr::element_type finalizedTable(*uXTable);
+    finalizedTable.finalize();
+
+    for (int i = 0; i < uXTable->numX(); ++i) {
+        if (finalizedTable.numY(i) != uXTable->numY(i)) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": the number of sampling points changed by finalize()\n";
+            return false;
+        }
+    }
+
+    for (int i = 0; i <= numSteps; ++i) {
+        for (int j = 0; j <= numSteps; ++j) {
+            Scalar x = xMin + Scalar(i)/numSteps*(xMax - xMin);
+            Scalar y = yMin + Scalar(j)/numSteps*(yMax - yMin);
+
+            Scalar value = finalizedTable.eval(x, y, /*extrapolate=*/true);
+            Scalar valueRef = uXTable->eval(x, y, /*extrapolate=*/true);
+            if (value != valueRef) {
+                std::cerr << __FILE__ << ":" << __LINE__ << ": finalized table differs at ("<<x<<","<<y<<"): " << value << " != " << valueRef << "\n";
+                return false;
+            }
+        }
+    }
+
+    // no sampling points can be added to a finalized table
+    try {
+        finalizedTable.appendSamplePoint(0, 1e100, 0.0);
+        std::cerr << __FILE__ << ":" << __LINE__ << ": sampling point was added to a finalized table\n";
+        return false;
+    }
+    catch (const std::logic_error&) {}
+
+    return true;
+}
+
+// tables that are built column-wise must be identical to the ones which are built one
+// sampling point at a time, regardless of the order of the sampling points
+template <class UniformXTablePtr>
+bool compareColumnWiseTable(const UniformXTablePtr uXTable)
+{
+    typedef typename UniformXTablePtr::element_type Table;
+
+    // specify the columns in descending X order and every other column with
+    // descending Y positions
+    int m = uXTable->numX();
+    std::vector<Scalar> x(m);
+    std::vector<std::vector<Scalar> > y(m), values(m);
+    for (int i = 0; i < m; ++i) {
+        int origIdx = m - 1 - i;
+        x[i] = uXTable->xAt(origIdx);
+
+        int n = uXTable->numY(origIdx);
+        for (int j = 0; j < n; ++j) {
+            int origJ = (i % 2 == 0) ? n - 1 - j : j;
+            y[i].push_back(uXTable->yAt(origIdx, origJ));
+            values[i].push_back(uXTable->valueAt(origIdx, origJ));
+        }
+    }
+    // a column which is neither ascending nor descending
+    if (y[0].size() > 2) {
+        std::swap(y[0][0], y[0][1]);
+        std::swap(values[0][0], values[0][1]);
+    }
+
+    Table columnTable;
+    columnTable.setColumns(x, y, values);
+    if (columnTable.numX() != m) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": wrong number of columns\n";
+        return false;
+    }
+
+    for (int i = 0; i < m; ++i) {
+        if (columnTable.xAt(i) != uXTable->xAt(i)
+            || columnTable.numY(i) != uXTable->numY(i))
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": column " << i << " differs\n";
+            return false;
+        }
+
+        for (int j = 0; j < uXTable->numY(i); ++j) {
+            if (columnTable.yAt(i, j) != uXTable->yAt(i, j)
+                || columnTable.valueAt(i, j) != uXTable->valueAt(i, j))
+            {
+                std::cerr << __FILE__ << ":" << __LINE__ << ": sampling point (" << i << ", " << j << ") differs\n";
+                return false;
+            }
+        }
+    }
+
+    // duplicate Y positions are rejected
+    Table invalidTable;
+    try {
+        std::vector<Scalar> yDup = { 1.0, 2.0, 1.0 };
+        invalidTable.appendColumn(0.0, yDup, yDup);
+        std::cerr << __FILE__ << ":" << __LINE__ << ": duplicate Y positions were accepted\n";
+        return false;
+    }
+    catch (const std::invalid_argument&) {}
+
+    return true;
+}
+
+struct FlatTestHandles
+{
+    Opm::FlatUniformTable2D uTable;
+    Opm::FlatUniformXTable2D uXTable;
+};
+
+template <class UniformTablePtr, class UniformXTablePtr>
+bool compareFlatTables(const UniformTablePtr uTable,
+                       const UniformXTablePtr uXTable,
+                       Scalar xMin,
+                       Scalar xMax,
+                       Scalar yMin,
+                       Scalar yMax,
+                       int numSteps)
+{
+    // the flat copies of the tables must yield the same results as the original ones,
+    // also if they are evaluated on a snapshot which was written to a file
+    typename UniformXTablePtr::element_type finalizedTable(*uXTable);
+    finalizedTable.finalize();
+
+    Opm::FlatTableBuffer<Scalar> buffer;
+    FlatTestHandles handles;
+    handles.uTable = buffer.addUniformTable2D(*uTable);
+    handles.uXTable = buffer.addUniformXTable2D(finalizedTable);
+
+    const char* fileName = "test_2dtables_flat.tables";
+
+    // the temporary file of a concurrent writer of the same file must not be touched
+    std::string otherTmpFileName = std::string(fileName) + ".tmp";
+    {
+        std::ofstream otherTmpFile(otherTmpFileName.c_str());
+        otherTmpFile << "other writer";
+    }
+
+    buffer.save(fileName, "test_2dtables", handles);
+
+    std::string otherTmpContents;
+    {
+        std::ifstream otherTmpFile(otherTmpFileName.c_str());
+        std::getline(otherTmpFile, otherTmpContents);
+    }
+    std::remove(otherTmpFileName.c_str());
+    if (otherTmpContents != "other writer") {
+        std::remove(fileName);
+        std::cerr << __FILE__ << ":" << __LINE__ << ": the temporary file of another writer was overwritten\n";
+        return false;
+    }
+
+    Opm::FlatTableSnapshot<Scalar> snapshot;
+    FlatTestHandles loadedHandles;
+    bool loaded = snapshot.open(fileName, "test_2dtables", loadedHandles);
+    std::remove(fileName);
+    if (!loaded || snapshot.size() != buffer.size()) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": the flat tables could not be read back\n";
+        return false;
+    }
+
+    Opm::FlatTableView<Scalar> views[3] = { buffer.view(), snapshot.view(), Opm::FlatTableView<Scalar>() };
+    const FlatTestHandles* handlesOfView[3] = { &handles, &loadedHandles, 0 };
+    int numViews = 2;
+
+#if HAVE_MPI
+    // only the first process builds the tables, all others receive them
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    Opm::FlatTableBuffer<Scalar> rootBuffer;
+    FlatTestHandles broadcastHandles;
+    if (rank == 0) {
+        broadcastHandles.uTable = rootBuffer.addUniformTable2D(*uTable);
+        broadcastHandles.uXTable = rootBuffer.addUniformXTable2D(finalizedTable);
+    }
+    Opm::FlatTableBroadcast<Scalar> broadcastTables;
+    broadcastTables.broadcast(rootBuffer, broadcastHandles, MPI_COMM_WORLD);
+    if (broadcastTables.size() != buffer.size()) {
+        std::cerr << __FILE__ << ":" << __LINE__ << ": the broadcast flat tables have the wrong size\n";
+        return false;
+    }
+    views[numViews] = broadcastTables.view();
+    handlesOfView[numViews] = &broadcastHandles;
+    ++numViews;
+#endif // HAVE_MPI
+
+    for (int viewIdx = 0; viewIdx < numViews; ++viewIdx) {
+        const auto& view = views[viewIdx];
+        const auto& h = *handlesOfView[viewIdx];
+        for (int i = 0; i <= numSteps; ++i) {
+            for (int j = 0; j <= numSteps; ++j) {
+                Scalar x = xMin + Scalar(i)/numSteps*(xMax - xMin);
+                Scalar y = yMin + Scalar(j)/numSteps*(yMax - yMin);
+
+                Scalar value = view.eval(h.uXTable, x, y);
+                Scalar valueRef = finalizedTable.eval(x, y, /*extrapolate=*/true);
+                if (std::abs(value - valueRef) > 1e-10*std::max(1.0, std::abs(valueRef))) {
+                    std::cerr << __FILE__ << ":" << __LINE__ << ": flat uXTable differs at ("<<x<<","<<y<<"): " << value << " != " << valueRef << "\n";
+                    return false;
+                }
+
+                if (!uTable->applies(x, y))
+                    continue;
+                value = view.eval(h.uTable, x, y);
+                valueRef = uTable->eval(x, y);
+                if (std::abs(value - valueRef) > 1e-10*std::max(1.0, std::abs(valueRef))) {
+                    std::cerr << __FILE__ << ":" << __LINE__ << ": flat uTable differs at ("<<x<<","<<y<<"): " << value << " != " << valueRef << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+template <class UniformTablePtr>
+bool compareBatchEval(const UniformTablePtr uTable, int numSteps)
+{
+    // the batched evaluation must yield the same values as eval() and the same
+    // derivatives as eval() for function evaluations
+    class BatchEvalTag;
+    typedef Opm::LocalAd::Evaluation<Scalar, BatchEvalTag, 2> Evaluation;
+
+    int n = (numSteps + 1)*(numSteps + 1);
+    std::vector<Scalar> x(n), y(n), dx0(n), dx1(n), dy0(n), dy1(n);
+    for (int i = 0; i <= numSteps; ++i) {
+        for (int j = 0; j <= numSteps; ++j) {
+            int k = i*(numSteps + 1) + j;
+            x[k] = uTable->xMin() + Scalar(i)/numSteps*(uTable->xMax() - uTable->xMin());
+            y[k] = uTable->yMin() + Scalar(j)/numSteps*(uTable->yMax() - uTable->yMin());
+            dx0[k] = 1.0;
+            dx1[k] = 0.5*j;
+            dy0[k] = 0.0;
+            dy1[k] = 2.0 - i;
+        }
+    }
+
+    std::vector<Scalar> result(n), resultValue(n), dResult0(n), dResult1(n);
+    uTable->evalBatch(x.data(), y.data(), result.data(), n);
+
+    const Scalar* xDerivatives[2] = { dx0.data(), dx1.data() };
+    const Scalar* yDerivatives[2] = { dy0.data(), dy1.data() };
+    Scalar* resultDerivatives[2] = { dResult0.data(), dResult1.data() };
+    uTable->evalBatch(x.data(), xDerivatives,
+                      y.data(), yDerivatives,
+                      resultValue.data(), resultDerivatives,
+                      /*numDerivatives=*/2, n);
+
+    for (int k = 0; k < n; ++k) {
+        Scalar valueRef = uTable->eval(x[k], y[k]);
+        if (result[k] != valueRef || resultValue[k] != valueRef) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": batched evaluation differs at ("
+                      << x[k] << "," << y[k] << "): " << result[k] << " != " << valueRef << "\n";
+            return false;
+        }
+
+        Evaluation xEval, yEval;
+        xEval.value = x[k];
+        xEval.derivatives[0] = dx0[k];
+        xEval.derivatives[1] = dx1[k];
+        yEval.value = y[k];
+        yEval.derivatives[0] = dy0[k];
+        yEval.derivatives[1] = dy1[k];
+        const Evaluation& ref = uTable->eval(xEval, yEval);
+        Scalar dResult[2] = { dResult0[k], dResult1[k] };
+        for (int varIdx = 0; varIdx < 2; ++varIdx) {
+            Scalar dRef = ref.derivatives[varIdx];
+            if (std::abs(dResult[varIdx] - dRef) > 1e-8*std::max(1.0, std::abs(dRef))) {
+                std::cerr << __FILE__ << ":" << __LINE__ << ": batched derivative differs at ("
+                          << x[k] << "," << y[k] << "): " << dResult[varIdx] << " != " << dRef << "\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template <class UniformTablePtr>
+bool compareMultiFunction(const UniformTablePtr uTable, int numSteps)
+{
+    // an interleaved table of a function and of its negation must yield the same values
+    // and derivatives as the table of the function
+    class MultiFunctionTag;
+    typedef Opm::LocalAd::Evaluation<Scalar, MultiFunctionTag, 2> Evaluation;
+
+    Opm::UniformTabulated2DMultiFunction<Scalar, 2> multiTable;
+    multiTable.resize(uTable->xMin(), uTable->xMax(), uTable->numX(),
+                      uTable->yMin(), uTable->yMax(), uTable->numY());
+    for (int i = 0; i < uTable->numX(); ++i) {
+        for (int j = 0; j < uTable->numY(); ++j) {
+            multiTable.setSamplePoint(i, j, 0, uTable->getSamplePoint(i, j));
+            multiTable.setSamplePoint(i, j, 1, -uTable->getSamplePoint(i, j));
+        }
+    }
+
+    for (int i = 0; i <= numSteps; ++i) {
+        for (int j = 0; j <= numSteps; ++j) {
+            Evaluation x, y;
+            x.value = uTable->xMin() + Scalar(i)/numSteps*(uTable->xMax() - uTable->xMin());
+            x.derivatives[0] = 1.0;
+            x.derivatives[1] = 0.0;
+            y.value = uTable->yMin() + Scalar(j)/numSteps*(uTable->yMax() - uTable->yMin());
+            y.derivatives[0] = 0.0;
+            y.derivatives[1] = 1.0;
+
+            const Evaluation& ref = uTable->eval(x, y);
+            Evaluation values[2];
+            multiTable.eval(x, y, values);
+            const Evaluation& single = multiTable.eval(x, y, 1);
+            for (int varIdx = -1; varIdx < 2; ++varIdx) {
+                Scalar vRef = (varIdx < 0) ? ref.value : ref.derivatives[varIdx];
+                Scalar v0 = (varIdx < 0) ? values[0].value : values[0].derivatives[varIdx];
+                Scalar v1 = (varIdx < 0) ? values[1].value : values[1].derivatives[varIdx];
+                Scalar vSingle = (varIdx < 0) ? single.value : single.derivatives[varIdx];
+                Scalar tol = 1e-10*std::max(1.0, std::abs(vRef));
+                if (std::abs(v0 - vRef) > tol || std::abs(v1 + vRef) > tol
+                    || std::abs(vSingle + vRef) > tol)
+                {
+                    std::cerr << __FILE__ << ":" << __LINE__ << ": interleaved table differs at ("
+                              << x.value << "," << y.value << "): " << v0 << " != " << vRef << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
 template <class UniformTablePtr, class UniformXTablePtr, class Fn>
 bool compareTables(const UniformTablePtr uTable,
                    const UniformXTablePtr uXTable,
@@ -321,8 +763,10 @@ bool compareTables(const UniformTablePtr uTable,
     return true;
 }
 
-int main()
+int main(int argc, char **argv)
 {
+    MyMpiHelper mpiHelper(argc, argv);
+
     auto uniformTab = createUniformTabulatedFunction(testFn1);
     auto uniformXTab = createUniformXTabulatedFunction(testFn1);
     if (!compareTables(uniformTab, uniformXTab, testFn1, /*tolerance=*/1e-12))
@@ -338,6 +782,18 @@ int main()
     if (!compareTables(uniformTab, uniformXTab, testFn3, /*tolerance=*/1e-2))
         return 1;
 
+    if (!compareFlatTables(uniformTab, uniformXTab,
+                           -3, 4,
+                           -1, 1,
+                           100))
+        return 1;
+
+    if (!compareBatchEval(uniformTab, 100))
+        return 1;
+
+    if (!compareMultiFunction(uniformTab, 100))
+        return 1;
+
     uniformXTab = createUniformXTabulatedFunction2(testFn3);
     if (!compareTableWithAnalyticFn(uniformXTab,
                                     -10, 10, 100,
@@ -346,6 +802,33 @@ int main()
                                     /*tolerance=*/1e-2))
         return 1;
 
+    if (!compareSegmentHintEval(uniformXTab,
+                                -2, 3,
+                                -4, 4,
+                                1000))
+        return 1;
+
+    if (!compareInterpolationWeights(uniformXTab,
+                                     -11, 11,
+                                     -11, 11,
+                                     1000))
+        return 1;
+
+    if (!compareColumnWiseTable(uniformXTab))
+        return 1;
+
+    if (!compareFinalizedTable(uniformXTab,
+                               -11, 11,
+                               -11, 11,
+                               100))
+        return 1;
+
+    if (!compareFlatTables(uniformTab, uniformXTab,
+                           -11, 11,
+                           -11, 11,
+                           100))
+        return 1;
+
     // CSV output for debugging
 #if 0
     int m = 100;
@@ -50,6 +50,7 @@
 #include <opm/material/components/Xylene.hpp>
 #include <opm/material/components/Air.hpp>
 #include <opm/material/components/SimpleCO2.hpp>
+#include <opm/material/components/GeneratedCO2Tables.hpp>
 
 #include <opm/material/common/UniformTabulated2DFunction.hpp>
 
@@ -102,6 +103,183 @@ void testAllComponents()
     checkComponent<Opm::Xylene<Scalar>, Evaluation>();
 }
 
+// check the CO2 tables which are calculated at runtime against co2tables.inc. The
+// sampling points are chosen to be a subset of the ones of the compiled-in tables.
+template <class Scalar>
+void testGeneratedCO2Tables()
+{
+    typedef Opm::ComponentsTest::TabulatedDensityTraits DensityTraits;
+    typedef Opm::ComponentsTest::TabulatedEnthalpyTraits EnthalpyTraits;
+    typedef Opm::GeneratedCO2Tables<Scalar> CO2Tables;
+
+    const int iStride = 33;
+    const int jStride = 6;
+    const int nTemp = (DensityTraits::numX - 1)/iStride + 1;
+    const int nPress = (DensityTraits::numY - 1)/jStride + 1;
+    Scalar dT = (DensityTraits::xMax - DensityTraits::xMin)/(DensityTraits::numX - 1);
+    Scalar dp = (DensityTraits::yMax - DensityTraits::yMin)/(DensityTraits::numY - 1);
+    Scalar tempMax = DensityTraits::xMin + (nTemp - 1)*iStride*dT;
+    Scalar pressMax = DensityTraits::yMin + (nPress - 1)*jStride*dp;
+
+    const char* fileName = "test_components_co2.tables";
+    for (int pass = 0; pass < 2; ++pass) {
+        // the first pass calculates the tables and writes the cache file, the second
+        // one reads it
+        CO2Tables::init(DensityTraits::xMin, tempMax, nTemp,
+                        DensityTraits::yMin, pressMax, nPress,
+                        fileName);
+
+        for (int i = 0; i < nTemp; ++i) {
+            for (int j = 0; j < nPress; ++j) {
+                Scalar rho = CO2Tables::tabulatedDensity.getSamplePoint(i, j);
+                Scalar rhoRef = DensityTraits::vals[i*iStride][j*jStride];
+                Scalar h = CO2Tables::tabulatedEnthalpy.getSamplePoint(i, j);
+                Scalar hRef = EnthalpyTraits::vals[i*iStride][j*jStride];
+                if (!(std::abs(rho - rhoRef) <= 1e-7*rhoRef) || !(std::abs(h - hRef) <= 1e-2))
+                    OPM_THROW(std::logic_error,
+                              "Generated CO2 tables differ from the compiled-in ones at "
+                              "T=" << CO2Tables::tabulatedDensity.iToX(i)
+                              << ", p=" << CO2Tables::tabulatedDensity.jToY(j)
+                              << ": rho=" << rho << " (expected " << rhoRef << ")"
+                              << ", h=" << h << " (expected " << hRef << ")");
+            }
+        }
+    }
+    std::remove(fileName);
+
+    // the coarse tables cover the same range, and switching back yields the same values
+    // as before. close to the saturation curve, the density changes steeply, so the
+    // largest error of the coarse tables is considerable
+    typedef Opm::CO2<Scalar, CO2Tables> CO2;
+    Scalar T = (DensityTraits::xMin + tempMax)/2;
+    Scalar p = (DensityTraits::yMin + pressMax)/2;
+    Scalar rhoFine = CO2::gasDensity(T, p);
+    Scalar coarseError = CO2Tables::initCoarse(nTemp/2 + 1, nPress/2 + 1);
+    CO2Tables::setUseCoarseTables(true);
+    Scalar rhoCoarse = CO2::gasDensity(T, p);
+    if (CO2Tables::tabulatedDensity.numX() != nTemp/2 + 1
+        || CO2Tables::tabulatedDensity.yMin() != DensityTraits::yMin
+        || !(coarseError > 0.0) || !(coarseError < 1.0)
+        || !(std::abs(rhoCoarse - rhoFine) <= 0.1*rhoFine))
+        OPM_THROW(std::logic_error,
+                  "Wrong coarse CO2 tables: rho=" << rhoCoarse << " (fine: " << rhoFine << ")"
+                  << ", error=" << coarseError);
+    CO2Tables::setUseCoarseTables(false);
+    if (CO2::gasDensity(T, p) != rhoFine)
+        OPM_THROW(std::logic_error, "The fine CO2 tables are not restored");
+
+    checkComponent<CO2, Scalar>();
+}
+
+// the tabulated viscosity and heat capacity of CO2 must agree with the ones which are
+// calculated from the density and enthalpy tables
+template <class Scalar, class Evaluation>
+void testTabulatedCO2TransportProperties()
+{
+    typedef Opm::ComponentsTest::CO2Tables CO2Tables;
+    typedef Opm::CO2<Scalar, CO2Tables> CO2;
+    typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+    const auto& densityTable = CO2Tables::tabulatedDensity;
+    std::vector<Scalar> temperatures, pressures, mu, cp;
+    for (int i = 0; i < 20; ++i) {
+        // the positions are between the sampling points and away from the boundaries of
+        // the tables, where the heat capacity uses one-sided differences
+        Scalar alpha = 0.05 + 0.9*(i + 0.37)/20;
+        Scalar beta = 0.05 + 0.9*(19 - i + 0.61)/20;
+        Scalar T = densityTable.xMin() + alpha*(densityTable.xMax() - densityTable.xMin());
+        Scalar p = densityTable.yMin() + beta*(densityTable.yMax() - densityTable.yMin());
+        temperatures.push_back(T);
+        pressures.push_back(p);
+        mu.push_back(CO2::gasViscosity(T, p));
+        cp.push_back(CO2::gasHeatCapacity(T, p));
+    }
+
+    CO2::tabulateTransportProperties();
+    if (!CO2::transportPropertiesTabulated())
+        OPM_THROW(std::logic_error, "The transport properties of CO2 are not tabulated");
+
+    for (size_t i = 0; i < temperatures.size(); ++i) {
+        const Evaluation& T = Toolbox::createVariable(temperatures[i], 0);
+        const Evaluation& p = Toolbox::createVariable(pressures[i], 1);
+        const Evaluation& muTab = CO2::gasViscosity(T, p);
+        const Evaluation& cpTab = CO2::gasHeatCapacity(T, p);
+        if (!(std::abs(Toolbox::value(muTab) - mu[i]) <= 1e-3*mu[i])
+            || !(std::abs(Toolbox::value(cpTab) - cp[i]) <= 5e-2*cp[i]))
+            OPM_THROW(std::logic_error,
+                      "Wrong tabulated transport properties of CO2 at T=" << temperatures[i]
+                      << ", p=" << pressures[i] << ": mu=" << Toolbox::value(muTab)
+                      << " (expected " << mu[i] << "), cp=" << Toolbox::value(cpTab)
+                      << " (expected " << cp[i] << ")");
+
+        // all properties are provided by a single lookup
+        const auto& props = CO2::gasProperties(T, p);
+        if (std::abs(props.viscosity.value - muTab.value) > 1e-12*muTab.value
+            || std::abs(props.heatCapacity.value - cpTab.value) > 1e-12*cpTab.value
+            || std::abs(props.density.value - CO2::gasDensity(T, p).value) > 1e-10*props.density.value
+            || std::abs(props.enthalpy.value - CO2::gasEnthalpy(T, p).value) > 1e-8)
+            OPM_THROW(std::logic_error, "Wrong phase properties of CO2");
+
+        // the viscosity of a dense fluid increases with pressure
+        if (!(muTab.derivatives[1] > 0.0))
+            OPM_THROW(std::logic_error,
+                      "The tabulated viscosity of CO2 does not provide its derivatives");
+    }
+}
+
+// compare the tabulated saturation curve of water with the relations of the IAPWS,
+// including the derivatives
+template <class Scalar, class Evaluation>
+void testTabulatedSaturationCurve()
+{
+    typedef Opm::IAPWS::Region4<Scalar> Region4;
+    typedef Opm::H2O<Scalar> H2O;
+
+    const int n = 1000;
+    std::vector<Evaluation> temperature(n), pressure(n);
+    std::vector<Evaluation> pSatRef(n), TSatRef(n);
+    for (int i = 0; i < n; ++i) {
+        Scalar x = Scalar(i)/(n - 1);
+        temperature[i] = Evaluation::createVariable(H2O::tripleTemperature()
+                                                    + x*(H2O::criticalTemperature()
+                                                         - H2O::tripleTemperature()), 0);
+        pressure[i] = Evaluation::createVariable(H2O::triplePressure()
+                                                 *std::pow(H2O::criticalPressure()
+                                                           /H2O::triplePressure(), x), 0);
+        pSatRef[i] = Region4::saturationPressure(temperature[i]);
+        TSatRef[i] = Region4::vaporTemperature(pressure[i]);
+    }
+
+    H2O::tabulateSaturationCurve();
+    if (!Region4::isTabulated())
+        OPM_THROW(std::logic_error, "The saturation curve of water is not tabulated");
+
+    for (int i = 0; i < n; ++i) {
+        const Evaluation& pSat = Region4::saturationPressure(temperature[i]);
+        const Evaluation& TSat = Region4::vaporTemperature(pressure[i]);
+        if (std::abs(pSat.value/pSatRef[i].value - 1) > 1e-7
+            || std::abs(pSat.derivatives[0]/pSatRef[i].derivatives[0] - 1) > 1e-5)
+            OPM_THROW(std::logic_error,
+                      "The tabulated saturation pressure of water at T="
+                      << temperature[i].value << " is " << pSat.value << " (d/dT: "
+                      << pSat.derivatives[0] << ") instead of " << pSatRef[i].value
+                      << " (d/dT: " << pSatRef[i].derivatives[0] << ")");
+        if (std::abs(TSat.value - TSatRef[i].value) > 1e-5
+            || std::abs(TSat.derivatives[0]/TSatRef[i].derivatives[0] - 1) > 1e-5)
+            OPM_THROW(std::logic_error,
+                      "The tabulated saturation temperature of water at p="
+                      << pressure[i].value << " is " << TSat.value << " (d/dp: "
+                      << TSat.derivatives[0] << ") instead of " << TSatRef[i].value
+                      << " (d/dp: " << TSatRef[i].derivatives[0] << ")");
+    }
+
+    checkComponent<H2O, Evaluation>();
+
+    H2O::tabulateSaturationCurve(/*numSamples=*/0);
+    if (Region4::isTabulated())
+        OPM_THROW(std::logic_error, "The tables of the saturation curve cannot be disabled");
+}
+
 class TestAdTag;
 
 int main(int argc, char **argv)
@@ -115,5 +293,9 @@ int main(int argc, char **argv)
     testAllComponents<Scalar, Scalar>();
     testAllComponents<Scalar, Evaluation>();
 
+    testGeneratedCO2Tables<Scalar>();
+    testTabulatedCO2TransportProperties<Scalar, Evaluation>();
+    testTabulatedSaturationCurve<Scalar, Evaluation>();
+
     return 0;
 }
@@ -0,0 +1,151 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Test for the evaluations of the localized automatic differentiation (AD)
+ *        framework whose number of derivatives is specified at runtime.
+ *
+ * The results of a single dynamic evaluation type are compared to the ones of dense
+ * evaluations with different numbers of derivatives which are computed by the same
+ * code.
+ */
+#include "config.h"
+
+#include <opm/material/localad/DynamicEvaluation.hpp>
+#include <opm/material/localad/DynamicMath.hpp>
+#include <opm/material/localad/Math.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <iostream>
+#include <cmath>
+
+struct TestVariables
+{
+    static const int maxSize = 12;
+};
+
+typedef double Scalar;
+typedef Opm::LocalAd::DynamicEvaluation<Scalar, TestVariables, TestVariables::maxSize> DynamicEval;
+
+template <class Evaluation>
+Evaluation testFunction(const Evaluation& x, const Evaluation& y, int variant)
+{
+    typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+    switch (variant) {
+    case 0:
+        return Toolbox::exp(2.0*x) - Toolbox::sqrt(x)/3.0 + Toolbox::pow(x, 1.7);
+    case 1:
+        return Toolbox::log(y*y + 1.0)*Toolbox::sin(y) - 1.0/Toolbox::cos(y);
+    case 2:
+        return Toolbox::max(x*y, y - x) + Toolbox::atan2(x, y) + Toolbox::pow(x, y);
+    case 3:
+        return Toolbox::pow(x - y, 3) + 2.0/(x*y) - Toolbox::pow(y, -2)*x;
+    default:
+        return Toolbox::min(x/y, 0.5) - Toolbox::abs(x - y) + Toolbox::atan(-y);
+    }
+}
+
+template <int numVars>
+bool compare(const DynamicEval& dynamic,
+             const Opm::LocalAd::Evaluation<Scalar, TestVariables, numVars>& dense,
+             int variant)
+{
+    bool ok = std::abs(dynamic.value - dense.value) <= 1e-14*std::max(1.0, std::abs(dense.value));
+    ok = ok && dynamic.numDerivatives() <= numVars;
+    for (int varIdx = 0; varIdx < DynamicEval::size; ++varIdx) {
+        // the derivatives which are not represented by the dense evaluation must be
+        // zero
+        Scalar d = (varIdx < numVars) ? dense.derivatives[varIdx] : 0.0;
+        ok = ok && std::abs(dynamic.derivatives[varIdx] - d) <= 1e-14*std::max(1.0, std::abs(d));
+    }
+
+    if (!ok) {
+        std::cerr << "dynamic and dense evaluation of variant " << variant
+                  << " with " << numVars << " variables differ:\n";
+        dynamic.print(std::cerr);
+        std::cerr << "\n";
+        dense.print(std::cerr);
+        std::cerr << "\n";
+    }
+
+    return ok;
+}
+
+// compare the dynamic evaluation with a dense one which has numVars derivatives
+template <int numVars>
+bool testNumVars()
+{
+    typedef Opm::LocalAd::Evaluation<Scalar, TestVariables, numVars> DenseEval;
+
+    const int xIdx = 0;
+    const int yIdx = numVars - 1;
+    for (int i = 0; i < 100; ++i) {
+        Scalar x = 0.1 + 0.05*i;
+        Scalar y = 2.0 - 0.03*i;
+        int variant = i%5;
+
+        DynamicEval dx = DynamicEval::createVariable(x, xIdx, numVars);
+        DynamicEval dy = DynamicEval::createVariable(y, yIdx, numVars);
+        DenseEval denseX = DenseEval::createVariable(x, xIdx);
+        DenseEval denseY = DenseEval::createVariable(y, yIdx);
+
+        DynamicEval dynamic = testFunction(dx, dy, variant);
+        DenseEval dense = testFunction(denseX, denseY, variant);
+        if (!compare(dynamic, dense, variant))
+            return false;
+
+        // the variables which are created without the number of derivatives only
+        // have the derivatives up to their own one, but yield the same result
+        DynamicEval implicitX = Opm::MathToolbox<DynamicEval>::createVariable(x, xIdx);
+        DynamicEval implicitY = Opm::MathToolbox<DynamicEval>::createVariable(y, yIdx);
+        if (implicitX.numDerivatives() != xIdx + 1
+            || !compare(testFunction(implicitX, implicitY, variant), dense, variant))
+            return false;
+
+        // the conversions from and to dense evaluations must be lossless
+        if (!compare(DynamicEval(dense), dynamic.template toDense<numVars>(), variant))
+            return false;
+    }
+
+    // the number of derivatives of the result is the largest one of the operands and
+    // constants do not have any
+    DynamicEval x = DynamicEval::createVariable(0.3, 0, numVars);
+    DynamicEval c = DynamicEval::createConstant(2.0);
+    if (c.numDerivatives() != 0
+        || (x*c).numDerivatives() != numVars
+        || (c - x).numDerivatives() != numVars)
+    {
+        std::cerr << "the number of derivatives is not propagated correctly\n";
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    if (!testNumVars<2>() || !testNumVars<5>() || !testNumVars<TestVariables::maxSize>())
+        return 1;
+
+    return 0;
+}
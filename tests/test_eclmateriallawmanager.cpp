@@ -0,0 +1,177 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief This is the unit test for the EclMaterialLawManager class.
+ *
+ * It requires opm-parser. If opm-parser is not available, the test does nothing.
+ */
+#include "config.h"
+
+#if HAVE_OPM_PARSER
+#include <opm/material/fluidmatrixinteractions/EclMaterialLawManager.hpp>
+#include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
+#include <opm/material/fluidstates/SimpleModularFluidState.hpp>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Parser/ParseMode.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+#endif // HAVE_OPM_PARSER
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// include the MPI header if available
+#if HAVE_MPI
+#include <mpi.h>
+#endif // HAVE_MPI
+
+class MyMpiHelper
+{
+public:
+#if HAVE_MPI
+    MyMpiHelper(int &argc, char **&argv)
+    {
+        MPI_Init(&argc, &argv);
+    };
+#else
+    MyMpiHelper(int &/*argc*/, char **&/*argv*/)
+    {};
+#endif // HAVE_MPI
+
+    ~MyMpiHelper()
+    {
+#if HAVE_MPI
+        MPI_Finalize();
+#endif // HAVE_MPI
+    };
+};
+
+#if HAVE_OPM_PARSER
+// SWATINIT requires element specific scaling points, i.e., end point scaling, and
+// enables the scaling of the oil-water capillary pressure
+static const char* threePhaseDeckString =
+    "RUNSPEC\n"
+    "DIMENS\n"
+    "   1 1 1 /\n"
+    "TABDIMS\n"
+    "/\n"
+    "OIL\n"
+    "WATER\n"
+    "GAS\n"
+    "ENDSCALE\n"
+    "/\n"
+    "GRID\n"
+    "DX\n"
+    "   1*1 /\n"
+    "DY\n"
+    "   1*1 /\n"
+    "DZ\n"
+    "   1*1 /\n"
+    "TOPS\n"
+    "   1*0 /\n"
+    "PROPS\n"
+    "SWOF\n"
+    "   0.2  0.0  1.0  4.0\n"
+    "   0.5  0.3  0.4  2.0\n"
+    "   1.0  1.0  0.0  0.0 /\n"
+    "SGOF\n"
+    "   0.0  0.0  1.0  0.0\n"
+    "   0.5  0.5  0.2  0.1\n"
+    "   0.8  1.0  0.0  0.2 /\n"
+    "SWATINIT\n"
+    "   1*0.35 /\n";
+
+// the capillary pressure of an element must be re-evaluated after SWATINIT rescaled
+// it, even if the result for the same saturations is cached
+template <class Scalar>
+void testSwatinitInvalidatesResultCache(Opm::DeckConstPtr deck,
+                                        Opm::EclipseStateConstPtr eclState)
+{
+    typedef Opm::ThreePhaseMaterialTraits<Scalar,
+                                          /*wettingPhaseIdx=*/0,
+                                          /*nonWettingPhaseIdx=*/1,
+                                          /*gasPhaseIdx=*/2> MaterialTraits;
+    typedef Opm::EclMaterialLawManager<MaterialTraits> MaterialLawManager;
+    typedef Opm::SimpleModularFluidState<Scalar,
+                                         /*numPhases=*/3,
+                                         /*numComponents=*/0,
+                                         /*FluidSystem=*/void,
+                                         /*storePressure=*/false,
+                                         /*storeTemperature=*/false,
+                                         /*storeComposition=*/false,
+                                         /*storeFugacity=*/false,
+                                         /*storeSaturation=*/true,
+                                         /*storeDensity=*/false,
+                                         /*storeViscosity=*/false,
+                                         /*storeEnthalpy=*/false> FluidState;
+    enum { waterPhaseIdx = 0, oilPhaseIdx = 1, gasPhaseIdx = 2 };
+
+    MaterialLawManager manager;
+    manager.setEnableResultCache(true);
+    manager.initFromDeck(deck, eclState, std::vector<int>(1, 0));
+
+    Scalar Sw = 0.35;
+    FluidState fs;
+    fs.setSaturation(waterPhaseIdx, Sw);
+    fs.setSaturation(oilPhaseIdx, 1 - Sw);
+    fs.setSaturation(gasPhaseIdx, 0.0);
+
+    Scalar pc[3];
+    manager.capillaryPressures(pc, fs, /*elemIdx=*/0);
+    Scalar pcow = pc[oilPhaseIdx] - pc[waterPhaseIdx];
+    if (!(pcow > 0.0))
+        OPM_THROW(std::logic_error, "EclMaterialLawManager: Wrong capillary pressure " << pcow);
+
+    // request twice the capillary pressure at the same water saturation
+    Scalar SwInit = manager.applySwatinit(/*elemIdx=*/0, 2*pcow, Sw);
+    if (SwInit != Sw)
+        OPM_THROW(std::logic_error, "EclMaterialLawManager: SWATINIT changed the saturation");
+
+    manager.capillaryPressures(pc, fs, /*elemIdx=*/0);
+    Scalar pcowInit = pc[oilPhaseIdx] - pc[waterPhaseIdx];
+    if (std::abs(pcowInit - 2*pcow) > 1e-8*pcow)
+        OPM_THROW(std::logic_error,
+                  "EclMaterialLawManager: The capillary pressure after SWATINIT is "
+                  << pcowInit << " instead of " << 2*pcow);
+}
+#endif // HAVE_OPM_PARSER
+
+int main(int argc, char **argv)
+{
+    MyMpiHelper mpiHelper(argc, argv);
+
+#if HAVE_OPM_PARSER
+    Opm::ParseMode parseMode;
+    Opm::ParserPtr parser(new Opm::Parser);
+    Opm::DeckConstPtr deck = parser->parseString(threePhaseDeckString, parseMode);
+    Opm::EclipseStateConstPtr eclState(new Opm::EclipseState(deck, parseMode));
+
+    testSwatinitInvalidatesResultCache<double>(deck, eclState);
+#endif // HAVE_OPM_PARSER
+
+    return 0;
+}
@@ -44,11 +44,13 @@
 #include <opm/material/fluidmatrixinteractions/ThreePhaseParkerVanGenuchten.hpp>
 #include <opm/material/fluidmatrixinteractions/EclEpsTwoPhaseLaw.hpp>
 #include <opm/material/fluidmatrixinteractions/EclHysteresisTwoPhaseLaw.hpp>
+#include <opm/material/common/QuantizedSaturation.hpp>
 #include <opm/material/fluidmatrixinteractions/EclDefaultMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/EclStone1Material.hpp>
 #include <opm/material/fluidmatrixinteractions/EclStone2Material.hpp>
 #include <opm/material/fluidmatrixinteractions/EclTwoPhaseMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/EclMultiplexerMaterial.hpp>
+#include <opm/material/fluidmatrixinteractions/SaturationDerivatives.hpp>
 
 // include the helper classes to construct traits
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
@@ -67,6 +69,12 @@
 
 #include <opm/material/common/Unused.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 // include dune's MPI helper header
 #include <dune/common/version.hh>
 #if DUNE_VERSION_NEWER(DUNE_COMMON, 2,3)
@@ -256,13 +264,1024 @@ void testThreePhaseApi()
     }
 }
 
+// make sure that the batched API of the three-phase ECL material laws is available
+template <class MaterialLaw>
+void testEclThreePhaseBatchApi()
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+
+    while (0) {
+        const Params params;
+        const Params* paramsPtr[1] = { &params };
+        const Scalar Sw[1] = { 0.3 }, So[1] = { 0.5 }, Sg[1] = { 0.2 };
+        Scalar krw[1], kro[1], krg[1], pcow[1], pcgo[1];
+
+        MaterialLaw::relativePermeabilitiesBatch(paramsPtr, Sw, So, Sg, krw, kro, krg, /*n=*/1);
+        MaterialLaw::capillaryPressuresBatch(paramsPtr, Sw, Sg, pcow, pcgo, /*n=*/1);
+    }
+}
+
+template <class Params>
+void setStone1Parameters_(Params&)
+{ }
+
+template <class Traits, class GasOilParams, class OilWaterParams>
+void setStone1Parameters_(Opm::EclStone1MaterialParams<Traits, GasOilParams, OilWaterParams>& params)
+{
+    params.setSowcr(0.15);
+    params.setSogcr(0.1);
+    params.setEta(1.0);
+}
+
+// make sure that the tabulated oil relative permeability of the three-phase ECL
+// material laws approximates the one of the law and that it is used by the batched API
+template <class MaterialLaw, class FluidState>
+void testEclKroTable()
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+    typedef typename Params::KroTable KroTable;
+    enum { waterPhaseIdx = MaterialLaw::waterPhaseIdx };
+    enum { oilPhaseIdx = MaterialLaw::oilPhaseIdx };
+    enum { gasPhaseIdx = MaterialLaw::gasPhaseIdx };
+
+    auto gasOilParams = std::make_shared<typename Params::GasOilParams>();
+    gasOilParams->setEntryPressure(1e4);
+    gasOilParams->setLambda(2.0);
+    gasOilParams->finalize();
+
+    auto oilWaterParams = std::make_shared<typename Params::OilWaterParams>();
+    oilWaterParams->setEntryPressure(2e4);
+    oilWaterParams->setLambda(1.5);
+    oilWaterParams->finalize();
+
+    Params params;
+    params.setGasOilParams(gasOilParams);
+    params.setOilWaterParams(oilWaterParams);
+    params.setSwl(0.1);
+    setStone1Parameters_(params);
+    params.finalize();
+
+    FluidState fs;
+    auto setSaturations = [&fs](Scalar Sw, Scalar Sg) {
+        fs.setSaturation(waterPhaseIdx, Sw);
+        fs.setSaturation(oilPhaseIdx, 1 - Sw - Sg);
+        fs.setSaturation(gasPhaseIdx, Sg);
+    };
+
+    // the table does not cover the largest gas saturations, so the three-phase law
+    // must be used for them
+    const int numSamples = 51;
+    auto kroTable = std::make_shared<KroTable>(0.0, 1.0, numSamples, 0.0, 0.8, numSamples);
+    for (int i = 0; i < numSamples; ++i) {
+        for (int j = 0; j < numSamples; ++j) {
+            Scalar Sw = kroTable->iToX(i);
+            setSaturations(Sw, std::min(kroTable->jToY(j), 1 - Sw));
+            Scalar kro = MaterialLaw::krn(params, fs);
+            kroTable->setSamplePoint(i, j, std::isfinite(kro) ? kro : 0.0);
+        }
+    }
+
+    const size_t n = 6;
+    const Scalar Sw[n] = { 0.2, 0.35, 0.5, 0.25, 0.6, 0.1 };
+    const Scalar Sg[n] = { 0.1, 0.3, 0.05, 0.5, 0.0, 0.85 };
+    Scalar So[n], analyticKro[n];
+    for (size_t i = 0; i < n; ++i) {
+        So[i] = 1 - Sw[i] - Sg[i];
+        setSaturations(Sw[i], Sg[i]);
+        analyticKro[i] = MaterialLaw::krn(params, fs);
+    }
+
+    params.setKroTable(kroTable);
+
+    const Params* paramsPtr[n];
+    Scalar krw[n], kro[n], krg[n];
+    std::fill(paramsPtr, paramsPtr + n, &params);
+    MaterialLaw::relativePermeabilitiesBatch(paramsPtr, Sw, So, Sg, krw, kro, krg, n);
+
+    for (size_t i = 0; i < n; ++i) {
+        setSaturations(Sw[i], Sg[i]);
+        Scalar tabulatedKro = MaterialLaw::krn(params, fs);
+        if (std::abs(tabulatedKro - analyticKro[i]) > 5e-3)
+            OPM_THROW(std::logic_error,
+                      "The tabulated oil relative permeability deviates from the "
+                      "three-phase law for Sw = " << Sw[i] << ", Sg = " << Sg[i]);
+        if (!kroTable->applies(Sw[i], Sg[i]) && tabulatedKro != analyticKro[i])
+            OPM_THROW(std::logic_error,
+                      "The three-phase law is not used for saturations outside of the "
+                      "range of the oil relative permeability table");
+        if (kro[i] != tabulatedKro)
+            OPM_THROW(std::logic_error,
+                      "The batched API does not use the oil relative permeability table "
+                      "for cell " << i);
+    }
+}
+
 template <class MaterialLaw>
 void testThreePhaseSatApi()
 {
 }
 
+// make sure that the fused evaluation of the van Genuchten law yields the same
+// results as the default one
+template <class MaterialLaw>
+void testVanGenuchtenFusedEvaluation()
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+
+    Params defaultParams;
+    defaultParams.setVgAlpha(1e-4);
+    defaultParams.setVgN(2.5);
+    defaultParams.finalize();
+
+    Params fusedParams(defaultParams);
+    fusedParams.setFusedEvaluation(true);
+
+    const Scalar tolerance = 1e-10;
+    for (int i = 1; i < 100; ++i) {
+        Scalar Sw = Scalar(i)/100;
+
+        Scalar values[2][4];
+        const Params* params[2] = { &defaultParams, &fusedParams };
+        for (int j = 0; j < 2; ++j) {
+            values[j][0] = MaterialLaw::twoPhaseSatPcnw(*params[j], Sw);
+            values[j][1] = MaterialLaw::twoPhaseSatSw(*params[j], values[j][0]);
+            values[j][2] = MaterialLaw::twoPhaseSatKrw(*params[j], Sw);
+            values[j][3] = MaterialLaw::twoPhaseSatKrn(*params[j], Sw);
+        }
+
+        for (int k = 0; k < 4; ++k) {
+            if (std::abs(values[0][k] - values[1][k]) > tolerance*std::max<Scalar>(1.0, std::abs(values[0][k])))
+                OPM_THROW(std::logic_error,
+                          "Fused evaluation of quantity " << k << " of the van Genuchten law deviates at Sw="
+                          << Sw << ": " << values[1][k] << " vs. " << values[0][k]);
+        }
+
+        if (std::abs(values[0][1] - Sw) > tolerance)
+            OPM_THROW(std::logic_error,
+                      "twoPhaseSatSw() is not the inverse of twoPhaseSatPcnw() at Sw=" << Sw);
+    }
+}
+
+// make sure that the tabulated curves of the regularized material laws agree with
+// the analytic ones within the estimated accuracy
+template <class MaterialLaw>
+void testRegularizedTabulation(typename MaterialLaw::Params& params)
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+
+    params.finalize();
+    Params tabulatedParams(params);
+    tabulatedParams.setNumTabulationSamples(1000);
+    tabulatedParams.finalize();
+
+    const auto& err = tabulatedParams.tabulationError();
+    if (err[1] > 1e-2 || err[2] > 1e-2)
+        OPM_THROW(std::logic_error,
+                  "The estimated error of the tabulated relative permeabilities is too large: "
+                  << err[1] << ", " << err[2]);
+
+    for (int i = -10; i <= 1010; ++i) {
+        // avoid hitting the sampling points
+        Scalar Sw = (i + 0.3)/1000;
+
+        Scalar values[2][3];
+        const Params* p[2] = { &params, &tabulatedParams };
+        for (int j = 0; j < 2; ++j) {
+            values[j][0] = MaterialLaw::twoPhaseSatPcnw(*p[j], Sw);
+            values[j][1] = MaterialLaw::twoPhaseSatKrw(*p[j], Sw);
+            values[j][2] = MaterialLaw::twoPhaseSatKrn(*p[j], Sw);
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            // outside of the tabulated range the curves are extrapolated starting
+            // at the tabulated values at the end points
+            Scalar tol = 2*err[k];
+            if (Sw < 0.0 || Sw > 1.0)
+                tol = std::max<Scalar>(tol, 1e-2*std::abs(values[0][k])) + 1e-10;
+
+            if (std::abs(values[0][k] - values[1][k]) > tol)
+                OPM_THROW(std::logic_error,
+                          "Tabulated quantity " << k << " deviates at Sw=" << Sw << ": "
+                          << values[1][k] << " vs. " << values[0][k]);
+        }
+    }
+}
+
+// make sure that the Parker-Lenhard hysteresis model copes with more saturation
+// reversals than it can remember
+template <class MaterialLaw, class FluidState>
+void testParkerLenhardHistory()
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+    typedef typename Params::VanGenuchtenParams VanGenuchtenParams;
+    typedef typename MaterialLaw::Traits Traits;
+
+    VanGenuchtenParams micParams(2e-4, 3.0);
+    VanGenuchtenParams mdcParams(1e-4, 3.0);
+
+    Params params;
+    params.setMicParams(&micParams);
+    params.setMdcParams(&mdcParams);
+    params.setSwr(0.0);
+    params.setSnr(0.1);
+    params.finalize();
+    MaterialLaw::reset(params);
+
+    FluidState fs;
+    for (int i = 0; i < 4*Params::maxScanningCurves; ++i) {
+        // oscillate around Sw = 0.5 with a decreasing amplitude
+        Scalar Sw = 0.5 + 0.4*std::pow(0.8, i)*((i%2 == 0)?-1.0:1.0);
+        fs.setSaturation(Traits::wettingPhaseIdx, Sw);
+        fs.setSaturation(Traits::nonWettingPhaseIdx, 1 - Sw);
+        MaterialLaw::update(params, fs);
+
+        Scalar pc = MaterialLaw::template pcnw<FluidState, Scalar>(params, fs);
+        if (!std::isfinite(pc))
+            OPM_THROW(std::logic_error,
+                      "The Parker-Lenhard capillary pressure is not finite after "
+                      << i << " reversals");
+        if (params.csc()->loopNum() >= Params::maxScanningCurves)
+            OPM_THROW(std::logic_error,
+                      "The Parker-Lenhard model uses more scanning curves than it can store");
+    }
+}
+
+// make sure that the batched API of EffToAbsLaw yields the same results as the
+// two-phase saturation API
+template <class MaterialLaw>
+void testEffToAbsLawBatch()
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+    typedef typename MaterialLaw::Traits Traits;
+
+    const size_t n = 150;
+    std::vector<Params> params(n);
+    std::vector<const Params*> paramsPtr(n);
+    std::vector<Scalar> Sw(n), krw(n), krn(n), pcnw(n);
+    for (size_t i = 0; i < n; ++i) {
+        params[i].setVgAlpha(1e-4*(1 + (i%7)));
+        params[i].setVgN(2.0 + 0.1*(i%5));
+        params[i].setResidualSaturation(Traits::wettingPhaseIdx, 0.01*(i%11));
+        params[i].setResidualSaturation(Traits::nonWettingPhaseIdx, 0.02*(i%3));
+        params[i].finalize();
+        paramsPtr[i] = &params[i];
+
+        Sw[i] = 0.25 + 0.5*Scalar(i)/n;
+    }
+
+    MaterialLaw::relativePermeabilitiesBatch(paramsPtr.data(), Sw.data(), krw.data(), krn.data(), n);
+    MaterialLaw::capillaryPressuresBatch(paramsPtr.data(), Sw.data(), pcnw.data(), n);
+
+    for (size_t i = 0; i < n; ++i) {
+        if (krw[i] != MaterialLaw::twoPhaseSatKrw(params[i], Sw[i])
+            || krn[i] != MaterialLaw::twoPhaseSatKrn(params[i], Sw[i])
+            || pcnw[i] != MaterialLaw::twoPhaseSatPcnw(params[i], Sw[i]))
+            OPM_THROW(std::logic_error,
+                      "The batched API of EffToAbsLaw deviates for cell " << i);
+    }
+}
+
+// make sure that the batched API of the three-phase van Genuchten law yields the same
+// results as the point-wise one and that tabulating its shape functions is accurate
+template <class MaterialLaw, class FluidState>
+void testThreePhaseVanGenuchtenBatch()
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+    typedef typename MaterialLaw::Traits Traits;
+
+    const int wIdx = Traits::wettingPhaseIdx;
+    const int nIdx = Traits::nonWettingPhaseIdx;
+    const int gIdx = Traits::gasPhaseIdx;
+
+    const size_t n = 200;
+    std::vector<Params> params(n);
+    std::vector<Params> tabulatedParams(n);
+    std::vector<const Params*> paramsPtr(n), tabulatedParamsPtr(n);
+    std::vector<Scalar> Sw(n), Sn(n), Sg(n);
+    for (size_t i = 0; i < n; ++i) {
+        Params& p = params[i];
+        p.setVgAlpha(5e-4*(1 + (i%3)));
+        p.setVgN(2.0 + 0.5*(i%4));
+        Scalar Swr = 0.02*(i%5);
+        Scalar Snr = 0.01*(i%3);
+        p.setSwr(Swr);
+        p.setSnr(Snr);
+        p.setSgr(0.01*(i%2));
+        p.setSwrx(Swr + Snr);
+        p.setBetaNW(1.0 + 0.1*(i%2));
+        p.setBetaGN(1.0);
+        p.setkrRegardsSnr((i%2) == 0);
+        p.finalize();
+        paramsPtr[i] = &params[i];
+
+        tabulatedParams[i] = p;
+        tabulatedParams[i].setNumTabulationSamples(2000);
+        tabulatedParams[i].finalize();
+        tabulatedParamsPtr[i] = &tabulatedParams[i];
+
+        // cover the regularized ranges of the capillary pressure curves as well
+        Sg[i] = 0.4*((i*37)%n)/n;
+        Sw[i] = (1 - Sg[i])*Scalar(i)/(n - 1);
+        Sn[i] = 1 - Sw[i] - Sg[i];
+    }
+
+    std::vector<Scalar> krw(n), krn(n), krg(n), pcgn(n), pcnw(n);
+    std::vector<Scalar> krwTab(n), krnTab(n), krgTab(n), pcgnTab(n), pcnwTab(n);
+    MaterialLaw::relativePermeabilitiesBatch(paramsPtr.data(), Sw.data(), Sn.data(), Sg.data(),
+                                             krw.data(), krn.data(), krg.data(), n);
+    MaterialLaw::capillaryPressuresBatch(paramsPtr.data(), Sw.data(), Sn.data(),
+                                         pcgn.data(), pcnw.data(), n);
+    MaterialLaw::relativePermeabilitiesBatch(tabulatedParamsPtr.data(), Sw.data(), Sn.data(), Sg.data(),
+                                             krwTab.data(), krnTab.data(), krgTab.data(), n);
+    MaterialLaw::capillaryPressuresBatch(tabulatedParamsPtr.data(), Sw.data(), Sn.data(),
+                                         pcgnTab.data(), pcnwTab.data(), n);
+
+    FluidState fs;
+    for (size_t i = 0; i < n; ++i) {
+        fs.setSaturation(wIdx, Sw[i]);
+        fs.setSaturation(nIdx, Sn[i]);
+        fs.setSaturation(gIdx, Sg[i]);
+
+        if (krw[i] != MaterialLaw::template krw<FluidState, Scalar>(params[i], fs)
+            || krn[i] != MaterialLaw::template krn<FluidState, Scalar>(params[i], fs)
+            || krg[i] != MaterialLaw::template krg<FluidState, Scalar>(params[i], fs)
+            || pcgn[i] != MaterialLaw::template pcgn<FluidState, Scalar>(params[i], fs)
+            || pcnw[i] != MaterialLaw::template pcnw<FluidState, Scalar>(params[i], fs))
+            OPM_THROW(std::logic_error,
+                      "The batched API of ThreePhaseParkerVanGenuchten deviates for cell " << i);
+
+        // the capillary pressure shape function is steep close to the lower
+        // regularization point, so its error is checked relative to its maximum
+        const auto& err = tabulatedParams[i].tabulationError();
+        Scalar pcShapeMax = params[i].pcgnLow()*params[i].vgAlpha();
+        if (err[0] > 1e-2 || err[1] > 1e-3*pcShapeMax)
+            OPM_THROW(std::logic_error,
+                      "The estimated error of the tabulated van Genuchten shape functions is too large: "
+                      << err[0] << ", " << err[1]);
+
+        Scalar krTol = 4*err[0] + 1e-12;
+        Scalar pcTol = 2*err[1]/params[i].vgAlpha() + 1e-12;
+        if (std::abs(krw[i] - krwTab[i]) > krTol
+            || std::abs(krn[i] - krnTab[i]) > krTol
+            || std::abs(krg[i] - krgTab[i]) > krTol
+            || std::abs(pcgn[i] - pcgnTab[i]) > pcTol
+            || std::abs(pcnw[i] - pcnwTab[i]) > pcTol)
+            OPM_THROW(std::logic_error,
+                      "The tabulated three-phase van Genuchten curves deviate for cell " << i);
+    }
+}
+
+// make sure that the curves of the piecewise linear law which are zero, constant or
+// linear are detected and that their closed form evaluation yields the interpolated values
+template <class MaterialLaw>
+void testPiecewiseLinearCurveShapes()
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+
+    const int n = 11;
+    std::vector<Scalar> Sw(n), pcnw(n), krw(n), krn(n);
+    for (int i = 0; i < n; ++i) {
+        Sw[i] = 0.2 + 0.7*Scalar(i)/(n - 1)*Scalar(i)/(n - 1);
+        pcnw[i] = 0.0;
+        krw[i] = 0.8*(Sw[i] - 0.2)/0.7;
+        krn[i] = 0.95;
+    }
+
+    Params params;
+    params.setPcnwSamples(Sw, pcnw);
+    params.setKrwSamples(Sw, krw);
+    params.setKrnSamples(Sw, krn);
+    params.finalize();
+
+    if (params.pcnwShape() != Opm::ZeroCurve
+        || params.krwShape() != Opm::LinearCurve
+        || params.krnShape() != Opm::ConstantCurve)
+        OPM_THROW(std::logic_error,
+                  "The shapes of the curves of PiecewiseLinearTwoPhaseMaterial have not "
+                  "been detected correctly");
+
+    for (int i = 0; i <= 100; ++i) {
+        Scalar S = 0.1 + 0.9*Scalar(i)/100;
+        Scalar krwRef = 0.8*std::max<Scalar>(0.0, std::min<Scalar>(1.0, (S - 0.2)/0.7));
+
+        Scalar krwValue, krnValue, pcnwValue;
+        MaterialLaw::twoPhaseSatAll(params, S, krwValue, krnValue, pcnwValue);
+        if (MaterialLaw::twoPhaseSatPcnw(params, S) != 0.0
+            || std::abs(MaterialLaw::twoPhaseSatKrw(params, S) - krwRef) > 1e-14
+            || MaterialLaw::twoPhaseSatKrn(params, S) != 0.95
+            || pcnwValue != 0.0
+            || std::abs(krwValue - krwRef) > 1e-14
+            || krnValue != 0.95)
+            OPM_THROW(std::logic_error,
+                      "The closed form evaluation of PiecewiseLinearTwoPhaseMaterial "
+                      "deviates for Sw = " << S);
+    }
+}
+
+// make sure that updating the values of the curves in place yields the same results as
+// setting up the parameter object from scratch
+template <class MaterialLaw>
+void testPiecewiseLinearValueUpdate()
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+
+    const int n = 11;
+    std::vector<Scalar> Sw(n), pcnw(n), krw(n), krn(n);
+    for (int i = 0; i < n; ++i) {
+        Sw[i] = 0.2 + 0.7*Scalar(i)/(n - 1)*Scalar(i)/(n - 1);
+        pcnw[i] = 0.0;
+        krw[i] = 0.8*(Sw[i] - 0.2)/0.7;
+        krn[i] = 0.95;
+    }
+
+    Params params;
+    params.setPcnwSamples(Sw, pcnw);
+    params.setKrwSamples(Sw, krw);
+    params.setKrnSamples(Sw, krn);
+    params.finalize();
+
+    for (int i = 0; i < n; ++i) {
+        pcnw[i] = 1e4*(1.0 - Sw[i]);
+        krw[i] = std::pow((Sw[i] - 0.2)/0.7, 2.0);
+        krn[i] = std::pow(1.0 - (Sw[i] - 0.2)/0.7, 3.0);
+    }
+    params.updatePcnwValues(pcnw);
+    params.updateKrwValues(krw);
+    params.updateKrnValues(krn);
+
+    Params refParams;
+    refParams.setPcnwSamples(Sw, pcnw);
+    refParams.setKrwSamples(Sw, krw);
+    refParams.setKrnSamples(Sw, krn);
+    refParams.finalize();
+
+    if (params.pcnwShape() != refParams.pcnwShape()
+        || params.krwShape() != refParams.krwShape()
+        || params.krnShape() != refParams.krnShape()
+        || params.interleavedSamples() != refParams.interleavedSamples())
+        OPM_THROW(std::logic_error,
+                  "The derived quantities of PiecewiseLinearTwoPhaseMaterial are not "
+                  "updated correctly");
+
+    for (int i = 0; i <= 100; ++i) {
+        Scalar S = 0.1 + 0.9*Scalar(i)/100;
+
+        Scalar krwValue, krnValue, pcnwValue;
+        MaterialLaw::twoPhaseSatAll(params, S, krwValue, krnValue, pcnwValue);
+        Scalar krwRef, krnRef, pcnwRef;
+        MaterialLaw::twoPhaseSatAll(refParams, S, krwRef, krnRef, pcnwRef);
+        if (krwValue != krwRef || krnValue != krnRef || pcnwValue != pcnwRef
+            || MaterialLaw::twoPhaseSatPcnw(params, S) != MaterialLaw::twoPhaseSatPcnw(refParams, S)
+            || MaterialLaw::twoPhaseSatKrw(params, S) != MaterialLaw::twoPhaseSatKrw(refParams, S)
+            || MaterialLaw::twoPhaseSatKrn(params, S) != MaterialLaw::twoPhaseSatKrn(refParams, S))
+            OPM_THROW(std::logic_error,
+                      "The updated curves of PiecewiseLinearTwoPhaseMaterial deviate for "
+                      "Sw = " << S);
+    }
+}
+
 class TestAdTag;
 
+// the tabulated inverse of the capillary pressure curve must be consistent with the
+// curve itself, also if the endpoint scaling is applied on top of it
+template <class MaterialLaw>
+void testPiecewiseLinearPcnwInverse()
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+
+    // the capillary pressure decreases and exhibits a plateau in the middle and a
+    // zero capillary pressure at high saturations
+    std::vector<Scalar> Sw = { 0.1, 0.15, 0.3, 0.35, 0.5, 0.6, 0.8, 0.9, 1.0 };
+    std::vector<Scalar> pcnw = { 3e5, 2e5, 1e5, 1e5, 0.5e5, 0.2e5, 0.0, 0.0, 0.0 };
+    std::vector<Scalar> kr = { 0.0, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8 };
+
+    Params params;
+    params.setPcnwSamples(Sw, pcnw);
+    params.setKrwSamples(Sw, kr);
+    params.setKrnSamples(Sw, kr);
+    params.finalize();
+    if (!params.hasPcnwInverse())
+        OPM_THROW(std::logic_error, "The inverse of a monotonic pc curve is not tabulated");
+
+    const int numPc = 301;
+    std::vector<Scalar> pcValues(numPc), SwBatch(numPc);
+    for (int i = 0; i < numPc; ++i)
+        pcValues[i] = -1e4 + 3.2e5*Scalar(i)/(numPc - 1);
+    pcValues[10] = 1e5;
+    MaterialLaw::twoPhaseSatPcnwInvBatch(params, pcValues.data(), SwBatch.data(), numPc);
+
+    for (int i = 0; i < numPc; ++i) {
+        Scalar pc = pcValues[i];
+        Scalar S = MaterialLaw::twoPhaseSatPcnwInv(params, pc);
+        if (S != SwBatch[i])
+            OPM_THROW(std::logic_error, "The batched inverse pc curve deviates for pc = " << pc);
+
+        Scalar pcRef = std::max(0.0, std::min(3e5, pc));
+        if (std::abs(MaterialLaw::twoPhaseSatPcnw(params, S) - pcRef) > 1e-6)
+            OPM_THROW(std::logic_error, "The inverse pc curve is wrong for pc = " << pc);
+    }
+
+    // on a plateau, the saturation of the end of the capillary pressure curve is used
+    if (std::abs(MaterialLaw::twoPhaseSatPcnwInv(params, Scalar(1e5)) - 0.35) > 1e-12
+        || MaterialLaw::twoPhaseSatPcnwInv(params, Scalar(0.0)) != 1.0)
+        OPM_THROW(std::logic_error, "The inverse pc curve is wrong on its plateaus");
+
+    // the derivative of the saturation is the inverse of the one of the pc curve
+    typedef Opm::LocalAd::Evaluation<Scalar, TestAdTag, 1> Eval;
+    Eval pcEval = Eval::createVariable(1.5e5, 0);
+    const Eval& SEval = MaterialLaw::twoPhaseSatPcnwInv(params, pcEval);
+    if (std::abs(SEval.derivatives[0] - (0.3 - 0.15)/(1e5 - 2e5)) > 1e-16)
+        OPM_THROW(std::logic_error, "The derivative of the inverse pc curve is wrong");
+
+    // non-monotonic curves are searched
+    std::vector<Scalar> pcnwKink = { 3e5, 2e5, 1e5, 2e5, 0.5e5, 0.2e5, 0.0, 0.0, 0.0 };
+    Params kinkParams;
+    kinkParams.setPcnwSamples(Sw, pcnwKink);
+    kinkParams.setKrwSamples(Sw, kr);
+    kinkParams.setKrnSamples(Sw, kr);
+    kinkParams.finalize();
+    if (kinkParams.hasPcnwInverse())
+        OPM_THROW(std::logic_error, "The inverse of a non-monotonic pc curve is tabulated");
+
+    // the scaled inverse is the inverse of the scaled curve
+    typedef Opm::EclEpsTwoPhaseLaw<MaterialLaw> EpsLaw;
+    typedef typename EpsLaw::Params EpsParams;
+    typedef Opm::EclEpsScalingPoints<Scalar> ScalingPoints;
+
+    auto config = std::make_shared<Opm::EclEpsConfig>();
+    config->setEnableSatScaling(true);
+    config->setEnablePcScaling(true);
+    auto unscaledPoints = std::make_shared<ScalingPoints>();
+    auto scaledPoints = std::make_shared<ScalingPoints>();
+    for (int pointIdx = 0; pointIdx < 3; ++pointIdx) {
+        Scalar unscaledS[3] = { 0.1, 0.5, 1.0 };
+        Scalar scaledS[3] = { 0.2, 0.55, 1.0 };
+        unscaledPoints->setSaturationPcPoint(pointIdx, unscaledS[pointIdx]);
+        unscaledPoints->setSaturationKrwPoint(pointIdx, unscaledS[pointIdx]);
+        unscaledPoints->setSaturationKrnPoint(pointIdx, unscaledS[pointIdx]);
+        scaledPoints->setSaturationPcPoint(pointIdx, scaledS[pointIdx]);
+        scaledPoints->setSaturationKrwPoint(pointIdx, scaledS[pointIdx]);
+        scaledPoints->setSaturationKrnPoint(pointIdx, scaledS[pointIdx]);
+    }
+    unscaledPoints->setMaxPcnw(3e5);
+    scaledPoints->setMaxPcnw(1.5e5);
+    unscaledPoints->setMaxKrw(0.8);
+    scaledPoints->setMaxKrw(0.8);
+    unscaledPoints->setMaxKrn(0.8);
+    scaledPoints->setMaxKrn(0.8);
+
+    EpsParams epsParams;
+    epsParams.setConfig(config);
+    epsParams.setUnscaledPoints(unscaledPoints);
+    epsParams.setScaledPoints(scaledPoints);
+    epsParams.setEffectiveLawParams(std::make_shared<Params>(params));
+    epsParams.finalize();
+
+    for (int i = 0; i < numPc; ++i)
+        pcValues[i] = 1.5e5*Scalar(i)/(numPc - 1);
+    EpsLaw::twoPhaseSatPcnwInvBatch(epsParams, pcValues.data(), SwBatch.data(), numPc);
+    for (int i = 0; i < numPc; ++i) {
+        Scalar S = EpsLaw::twoPhaseSatPcnwInv(epsParams, pcValues[i]);
+        if (std::abs(S - SwBatch[i]) > 1e-14
+            || std::abs(EpsLaw::twoPhaseSatPcnw(epsParams, S) - pcValues[i]) > 1e-6)
+            OPM_THROW(std::logic_error,
+                      "The scaled inverse pc curve is wrong for pc = " << pcValues[i]);
+    }
+
+    // if the configuration disables all kinds of scaling, the nested law is evaluated
+    // directly
+    if (epsParams.isPassThrough() || epsParams.directCurves())
+        OPM_THROW(std::logic_error, "The scaled curves are bypassed");
+    EpsParams passThroughParams(epsParams);
+    passThroughParams.setConfig(std::make_shared<Opm::EclEpsConfig>());
+    passThroughParams.finalize();
+    if (!passThroughParams.isPassThrough()
+        || passThroughParams.directCurves() != &passThroughParams.effectiveLawParams())
+        OPM_THROW(std::logic_error, "The unscaled curves are not bypassed");
+    for (int i = 0; i < numPc; ++i) {
+        Scalar S = Scalar(i)/(numPc - 1);
+        if (EpsLaw::twoPhaseSatPcnw(passThroughParams, S) != MaterialLaw::twoPhaseSatPcnw(params, S)
+            || EpsLaw::twoPhaseSatKrw(passThroughParams, S) != MaterialLaw::twoPhaseSatKrw(params, S)
+            || EpsLaw::twoPhaseSatKrn(passThroughParams, S) != MaterialLaw::twoPhaseSatKrn(params, S))
+            OPM_THROW(std::logic_error,
+                      "The pass-through end point scaling modifies the curves at Sw = " << S);
+    }
+}
+
+// make sure that evaluating a material law with respect to the saturations only and
+// applying the chain rule afterwards yields the same results as evaluating it with the
+// full function evaluations
+template <class MaterialLaw, class FluidState>
+void testSaturationDerivatives(const typename MaterialLaw::Params& params,
+                               const typename MaterialLaw::Scalar* saturations)
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename FluidState::Scalar Evaluation;
+    typedef Opm::SaturationDerivatives<MaterialLaw> SatDerivatives;
+    enum { numPhases = MaterialLaw::numPhases };
+
+    FluidState fs;
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        Evaluation S = Evaluation::createConstant(saturations[phaseIdx]);
+        for (int varIdx = 0; varIdx < Evaluation::size; ++varIdx)
+            S.derivatives[varIdx] = 0.1*(phaseIdx + 1) - 0.25*varIdx;
+        fs.setSaturation(phaseIdx, S);
+    }
+
+    Evaluation kr[numPhases], krRef[numPhases], pc[numPhases], pcRef[numPhases];
+    MaterialLaw::relativePermeabilities(krRef, params, fs);
+    MaterialLaw::capillaryPressures(pcRef, params, fs);
+    SatDerivatives::relativePermeabilities(kr, params, fs);
+    SatDerivatives::capillaryPressures(pc, params, fs);
+
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        if (kr[phaseIdx].value != krRef[phaseIdx].value
+            || pc[phaseIdx].value != pcRef[phaseIdx].value)
+            OPM_THROW(std::logic_error,
+                      "The values of the saturation functions of phase " << phaseIdx
+                      << " change if they are evaluated with respect to the saturations");
+
+        for (int varIdx = 0; varIdx < Evaluation::size; ++varIdx) {
+            Scalar krScale = 1.0 + std::abs(krRef[phaseIdx].derivatives[varIdx]);
+            Scalar pcScale = 1.0 + std::abs(pcRef[phaseIdx].derivatives[varIdx]);
+            if (std::abs(kr[phaseIdx].derivatives[varIdx] - krRef[phaseIdx].derivatives[varIdx]) > 1e-12*krScale
+                || std::abs(pc[phaseIdx].derivatives[varIdx] - pcRef[phaseIdx].derivatives[varIdx]) > 1e-12*pcScale)
+                OPM_THROW(std::logic_error,
+                          "The derivatives of the saturation functions of phase " << phaseIdx
+                          << " deviate if the chain rule is applied to the derivatives with"
+                          " respect to the saturations");
+        }
+    }
+}
+
+// make sure that the saturation functions do not depend on any saturation which is not
+// reported by the relativePermeabilityDependencies() and
+// capillaryPressureDependencies() methods of a material law
+template <class MaterialLaw, class FluidState>
+void testSaturationDependencies(const typename MaterialLaw::Params& params,
+                                const typename MaterialLaw::Scalar* saturations)
+{
+    typedef typename FluidState::Scalar Evaluation;
+    static const int numPhases = MaterialLaw::numPhases;
+    static_assert(int(Evaluation::size) >= numPhases,
+                  "The evaluation must provide a derivative for each saturation");
+
+    static_assert(MaterialLaw::relativePermeabilityDependencies(0) < (1u << numPhases)
+                  && MaterialLaw::capillaryPressureDependencies(0) < (1u << numPhases),
+                  "The dependencies must only refer to the phases of the material law");
+
+    FluidState fs;
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+        fs.setSaturation(phaseIdx, Evaluation::createVariable(saturations[phaseIdx], phaseIdx));
+
+    Evaluation kr[numPhases], pc[numPhases];
+    MaterialLaw::relativePermeabilities(kr, params, fs);
+    MaterialLaw::capillaryPressures(pc, params, fs);
+
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        unsigned krMask = MaterialLaw::relativePermeabilityDependencies(phaseIdx);
+        unsigned pcMask = MaterialLaw::capillaryPressureDependencies(phaseIdx);
+        for (int satIdx = 0; satIdx < numPhases; ++satIdx) {
+            if (!(krMask & (1u << satIdx)) && kr[phaseIdx].derivatives[satIdx] != 0.0)
+                OPM_THROW(std::logic_error,
+                          "The relative permeability of phase " << phaseIdx
+                          << " depends on the saturation of phase " << satIdx
+                          << " which is not reported by the material law");
+            if (!(pcMask & (1u << satIdx)) && pc[phaseIdx].derivatives[satIdx] != 0.0)
+                OPM_THROW(std::logic_error,
+                          "The capillary pressure of phase " << phaseIdx
+                          << " depends on the saturation of phase " << satIdx
+                          << " which is not reported by the material law");
+        }
+    }
+}
+
+// the same for the three-phase laws of ECL which are composed of two-phase laws
+template <class MaterialLaw, class FluidState>
+void testEclSaturationDerivatives()
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+
+    auto gasOilParams = std::make_shared<typename Params::GasOilParams>();
+    gasOilParams->setEntryPressure(1e4);
+    gasOilParams->setLambda(2.0);
+    gasOilParams->finalize();
+
+    auto oilWaterParams = std::make_shared<typename Params::OilWaterParams>();
+    oilWaterParams->setEntryPressure(2e4);
+    oilWaterParams->setLambda(1.5);
+    oilWaterParams->finalize();
+
+    Params params;
+    params.setGasOilParams(gasOilParams);
+    params.setOilWaterParams(oilWaterParams);
+    params.setSwl(0.1);
+    setStone1Parameters_(params);
+    params.finalize();
+
+    Scalar saturations[MaterialLaw::numPhases];
+    saturations[MaterialLaw::waterPhaseIdx] = 0.35;
+    saturations[MaterialLaw::oilPhaseIdx] = 0.45;
+    saturations[MaterialLaw::gasPhaseIdx] = 0.2;
+    testSaturationDerivatives<MaterialLaw, FluidState>(params, saturations);
+    testSaturationDependencies<MaterialLaw, FluidState>(params, saturations);
+}
+
+// the same for the twoPhaseSat*() API
+template <class MaterialLaw>
+void testTwoPhaseSatDerivatives(const typename MaterialLaw::Params& params)
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef Opm::SaturationDerivatives<MaterialLaw> SatDerivatives;
+    typedef typename SatDerivatives::TwoPhaseSatEval Eval;
+
+    for (int i = 1; i < 20; ++i) {
+        Scalar Sw = Scalar(i)/20;
+        Eval SwEval = Eval::createVariable(Sw, 0);
+
+        Scalar dKrw, dKrn, dPcnw;
+        Scalar krw = SatDerivatives::twoPhaseSatKrw(params, Sw, dKrw);
+        Scalar krn = SatDerivatives::twoPhaseSatKrn(params, Sw, dKrn);
+        Scalar pcnw = SatDerivatives::twoPhaseSatPcnw(params, Sw, dPcnw);
+        Eval krwRef = MaterialLaw::twoPhaseSatKrw(params, SwEval);
+        Eval krnRef = MaterialLaw::twoPhaseSatKrn(params, SwEval);
+        Eval pcnwRef = MaterialLaw::twoPhaseSatPcnw(params, SwEval);
+        if (krw != krwRef.value || dKrw != krwRef.derivatives[0]
+            || krn != krnRef.value || dKrn != krnRef.derivatives[0]
+            || pcnw != pcnwRef.value || dPcnw != pcnwRef.derivatives[0])
+            OPM_THROW(std::logic_error,
+                      "The saturation derivatives of the two-phase law deviate for Sw = " << Sw);
+
+        if (SatDerivatives::chainRule(krw, dKrw, 2.0*SwEval).derivatives[0] != 2.0*dKrw)
+            OPM_THROW(std::logic_error, "The chain rule is not applied correctly");
+    }
+}
+
+// make sure that the hysteresis law always uses the drainage curve if it is told that
+// the imbibition curve is the same, while the scanning curves are used otherwise
+template <class MaterialLaw>
+void testHysteresisDrainageOnly()
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+    typedef typename MaterialLaw::EffectiveLaw EffectiveLaw;
+    typedef typename EffectiveLaw::Params EffectiveParams;
+
+    auto config = std::make_shared<Opm::EclHysteresisConfig>();
+    config->setEnableHysteresis(true);
+    config->setPcHysteresisModel(0);
+    config->setKrHysteresisModel(0);
+
+    // the imbibition curves of the non-wetting phase permeability and of the capillary
+    // pressure are lower than the drainage ones
+    const int n = 11;
+    std::vector<Scalar> Sw(n), krw(n), krnDrain(n), krnImb(n), pcDrain(n), pcImb(n);
+    for (int i = 0; i < n; ++i) {
+        Sw[i] = Scalar(i)/(n - 1);
+        krw[i] = Sw[i]*Sw[i];
+        krnDrain[i] = (1 - Sw[i])*(1 - Sw[i]);
+        krnImb[i] = krnDrain[i]*(1 - Sw[i]);
+        pcDrain[i] = 1e4*(1 - Sw[i]) + 1e3;
+        pcImb[i] = 0.5e4*(1 - Sw[i]) + 1e3;
+    }
+
+    auto drainageParams = std::make_shared<EffectiveParams>();
+    drainageParams->setKrwSamples(Sw, krw);
+    drainageParams->setKrnSamples(Sw, krnDrain);
+    drainageParams->setPcnwSamples(Sw, pcDrain);
+    drainageParams->finalize();
+
+    auto imbibitionParams = std::make_shared<EffectiveParams>();
+    imbibitionParams->setKrwSamples(Sw, krw);
+    imbibitionParams->setKrnSamples(Sw, krnImb);
+    imbibitionParams->setPcnwSamples(Sw, pcImb);
+    imbibitionParams->finalize();
+
+    Opm::EclEpsScalingPointsInfo<Scalar> info;
+    Params hystParams;
+    hystParams.setConfig(config);
+    hystParams.setDrainageParams(drainageParams, info, Opm::EclOilWaterSystem);
+    hystParams.setImbibitionParams(imbibitionParams, info, Opm::EclOilWaterSystem);
+    hystParams.finalize();
+
+    Params drainageOnlyParams;
+    drainageOnlyParams.setConfig(config);
+    drainageOnlyParams.setDrainageOnly(true);
+    drainageOnlyParams.setDrainageParams(drainageParams, info, Opm::EclOilWaterSystem);
+    drainageOnlyParams.finalize();
+
+    if (!hystParams.hysteresisActive() || drainageOnlyParams.hysteresisActive())
+        OPM_THROW(std::logic_error,
+                  "The hysteresis law does not report whether its scanning curves are used");
+
+    hystParams.update(/*pcSw=*/0.4, /*krwSw=*/0.4, /*krnSw=*/0.4);
+    drainageOnlyParams.update(/*pcSw=*/0.4, /*krwSw=*/0.4, /*krnSw=*/0.4);
+
+    Scalar S = 0.6;
+    Scalar krnDrainage = EffectiveLaw::twoPhaseSatKrn(*drainageParams, S);
+    if (MaterialLaw::twoPhaseSatKrn(drainageOnlyParams, S) != krnDrainage
+        || MaterialLaw::twoPhaseSatKrw(drainageOnlyParams, S)
+           != EffectiveLaw::twoPhaseSatKrw(*drainageParams, S)
+        || drainageOnlyParams.krnSwMdc() != 2.0)
+        OPM_THROW(std::logic_error,
+                  "The hysteresis law does not use the drainage curve if told so");
+    if (MaterialLaw::twoPhaseSatKrn(hystParams, S) == krnDrainage)
+        OPM_THROW(std::logic_error,
+                  "The hysteresis law does not use the imbibition curve after a reversal");
+
+    // the capillary pressure is given by the drainage curve, so is its inverse
+    Scalar pc = 5e3;
+    Scalar SwPc;
+    MaterialLaw::twoPhaseSatPcnwInvBatch(hystParams, &pc, &SwPc, 1);
+    if (MaterialLaw::twoPhaseSatPcnwInv(hystParams, pc)
+        != EffectiveLaw::twoPhaseSatPcnwInv(*drainageParams, pc)
+        || SwPc != EffectiveLaw::twoPhaseSatPcnwInv(*drainageParams, pc))
+        OPM_THROW(std::logic_error,
+                  "The hysteresis law does not invert the drainage capillary pressure");
+}
+
+// the reversal points of a quantized hysteresis state must be rounded down to the
+// resolution of the quantization
+template <class MaterialLaw>
+void testQuantizedHysteresisState()
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+    typedef typename Params::StateScalar StateScalar;
+    typedef typename MaterialLaw::EffectiveLaw EffectiveLaw;
+    typedef typename EffectiveLaw::Params EffectiveParams;
+
+    auto config = std::make_shared<Opm::EclHysteresisConfig>();
+    config->setEnableHysteresis(true);
+    config->setPcHysteresisModel(0);
+    config->setKrHysteresisModel(0);
+
+    std::vector<Scalar> Sw = { 0.0, 0.5, 1.0 };
+    std::vector<Scalar> krw = { 0.0, 0.25, 1.0 };
+    std::vector<Scalar> krn = { 1.0, 0.25, 0.0 };
+    std::vector<Scalar> pc = { 2e4, 1e4, 0.0 };
+    auto effParams = std::make_shared<EffectiveParams>();
+    effParams->setKrwSamples(Sw, krw);
+    effParams->setKrnSamples(Sw, krn);
+    effParams->setPcnwSamples(Sw, pc);
+    effParams->finalize();
+
+    Opm::EclEpsScalingPointsInfo<Scalar> info;
+    Params params;
+    params.setConfig(config);
+    params.setDrainageParams(effParams, info, Opm::EclOilWaterSystem);
+    params.setImbibitionParams(effParams, info, Opm::EclOilWaterSystem);
+    params.finalize();
+
+    const Scalar resolution = StateScalar::resolution();
+    const Scalar Sw0 = 0.123456789;
+    params.update(/*pcSw=*/Sw0, /*krwSw=*/Sw0, /*krnSw=*/Sw0);
+    if (params.pcSwMdc() > Sw0 || params.pcSwMdc() <= Sw0 - resolution
+        || params.krnSwMdc() > Sw0 || params.krnSwMdc() <= Sw0 - resolution)
+        OPM_THROW(std::logic_error,
+                  "The reversal points are not rounded down to the quantization");
+
+    // seeing the same saturation again must not modify the state
+    const Scalar pcSwMdc = params.pcSwMdc();
+    params.update(/*pcSw=*/Sw0, /*krwSw=*/Sw0, /*krnSw=*/Sw0);
+    if (params.pcSwMdc() != pcSwMdc)
+        OPM_THROW(std::logic_error, "The quantized hysteresis state is not stable");
+
+    if (sizeof(StateScalar) >= sizeof(Scalar))
+        OPM_THROW(std::logic_error, "The quantized hysteresis state is not compact");
+}
+
+template <class MaterialLaw>
+void testDoubleBufferedHysteresisState()
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLaw::Params Params;
+    typedef typename MaterialLaw::EffectiveLaw EffectiveLaw;
+    typedef typename EffectiveLaw::Params EffectiveParams;
+    static_assert(Params::numStateBuffers == 2, "The hysteresis state must be double buffered");
+
+    auto config = std::make_shared<Opm::EclHysteresisConfig>();
+    config->setEnableHysteresis(true);
+    config->setPcHysteresisModel(0);
+    config->setKrHysteresisModel(0);
+
+    std::vector<Scalar> Sw = { 0.0, 0.5, 1.0 };
+    std::vector<Scalar> krw = { 0.0, 0.25, 1.0 };
+    std::vector<Scalar> krn = { 1.0, 0.25, 0.0 };
+    std::vector<Scalar> krnImb = { 1.0, 0.1, 0.0 };
+    std::vector<Scalar> pc = { 2e4, 1e4, 0.0 };
+    auto drainParams = std::make_shared<EffectiveParams>();
+    drainParams->setKrwSamples(Sw, krw);
+    drainParams->setKrnSamples(Sw, krn);
+    drainParams->setPcnwSamples(Sw, pc);
+    drainParams->finalize();
+    auto imbParams = std::make_shared<EffectiveParams>();
+    imbParams->setKrwSamples(Sw, krw);
+    imbParams->setKrnSamples(Sw, krnImb);
+    imbParams->setPcnwSamples(Sw, pc);
+    imbParams->finalize();
+
+    Opm::EclEpsScalingPointsInfo<Scalar> info;
+    Params params;
+    params.setConfig(config);
+    params.setDrainageParams(drainParams, info, Opm::EclOilWaterSystem);
+    params.setImbibitionParams(imbParams, info, Opm::EclOilWaterSystem);
+    params.finalize();
+
+    // the update is not visible before the buffers are swapped
+    const Scalar krnBefore = MaterialLaw::twoPhaseSatKrn(params, Scalar(0.6));
+    params.update(/*pcSw=*/0.3, /*krwSw=*/0.3, /*krnSw=*/0.3);
+    if (params.pcSwMdc() != 2.0 || MaterialLaw::twoPhaseSatKrn(params, Scalar(0.6)) != krnBefore)
+        OPM_THROW(std::logic_error, "The update of a double buffered hysteresis state is visible");
+
+    config->swapStateBuffers();
+    if (params.pcSwMdc() != 0.3 || params.krnSwMdc() != 0.3)
+        OPM_THROW(std::logic_error, "The updated hysteresis state is not visible after the swap");
+    const Scalar krnAfter = MaterialLaw::twoPhaseSatKrn(params, Scalar(0.6));
+    if (krnAfter == krnBefore)
+        OPM_THROW(std::logic_error, "The imbibition curve is not used after the swap");
+
+    // the next update starts from the current state, i.e., a larger saturation does not
+    // move the reversal point, even though the other buffer still holds the old state
+    params.update(/*pcSw=*/0.4, /*krwSw=*/0.4, /*krnSw=*/0.4);
+    config->swapStateBuffers();
+    if (params.pcSwMdc() != 0.3 || MaterialLaw::twoPhaseSatKrn(params, Scalar(0.6)) != krnAfter)
+        OPM_THROW(std::logic_error, "The double buffered hysteresis state is not carried over");
+}
+
+// the saturation mappings of the endpoint scaling must yield the same results as the
+// formulas of the interpolation between the scaling points
+template <class Scalar>
+void testEclEpsScalingCoefficients()
+{
+    Opm::EclEpsScalingPoints<Scalar> unscaledPoints, scaledPoints;
+    Scalar unscaledKrw[3] = { 0.1, 0.5, 0.9 };
+    Scalar scaledKrw[3] = { 0.2, 0.4, 0.8 };
+    for (int pointIdx = 0; pointIdx < 3; ++pointIdx) {
+        unscaledPoints.setSaturationKrwPoint(pointIdx, unscaledKrw[pointIdx]);
+        scaledPoints.setSaturationKrwPoint(pointIdx, scaledKrw[pointIdx]);
+    }
+    unscaledPoints.setMaxKrw(0.8);
+    scaledPoints.setMaxKrw(0.6);
+
+    // without saturation scaling, the saturations are not modified
+    Opm::EclEpsConfig config;
+    config.setEnableKrwScaling(true);
+    Opm::EclEpsScalingCoefficients<Scalar> coefficients;
+    coefficients.init(unscaledPoints, scaledPoints, config);
+    if (coefficients.scaledToUnscaledSatKrw().map(Scalar(0.3)) != 0.3
+        || coefficients.unscaledToScaledSatPc().map(Scalar(0.3)) != 0.3
+        || coefficients.krwScalingFactor() != Scalar(0.6)/Scalar(0.8)
+        || coefficients.pcnwScalingFactor() != 1.0)
+        OPM_THROW(std::logic_error,
+                  "The disabled endpoint scaling modifies the quantities");
+
+    for (int threePoint = 0; threePoint < 2; ++threePoint) {
+        config.setEnableSatScaling(true);
+        config.setEnableThreePointKrSatScaling(threePoint != 0);
+        coefficients.init(unscaledPoints, scaledPoints, config);
+
+        for (int i = 0; i <= 10; ++i) {
+            Scalar SwScaled = Scalar(i)/10;
+            Scalar SwUnscaled;
+            if (!threePoint)
+                SwUnscaled =
+                    unscaledKrw[0]
+                    + (SwScaled - scaledKrw[0])*((unscaledKrw[1] - unscaledKrw[0])/(scaledKrw[1] - scaledKrw[0]));
+            else if (SwScaled < scaledKrw[1])
+                SwUnscaled =
+                    unscaledKrw[0]
+                    + (SwScaled - scaledKrw[0])*((unscaledKrw[1] - unscaledKrw[0])/(scaledKrw[1] - scaledKrw[0]));
+            else
+                SwUnscaled =
+                    unscaledKrw[1]
+                    + (SwScaled - scaledKrw[1])*((unscaledKrw[2] - unscaledKrw[1])/(scaledKrw[2] - scaledKrw[1]));
+
+            if (coefficients.scaledToUnscaledSatKrw().map(SwScaled) != SwUnscaled)
+                OPM_THROW(std::logic_error,
+                          "The scaled saturation " << SwScaled << " is not mapped to "
+                          << SwUnscaled << " by the endpoint scaling");
+
+            Scalar SwRoundTrip = coefficients.unscaledToScaledSatKrw().map(SwUnscaled);
+            if (std::abs(SwRoundTrip - SwScaled) > 1e-10)
+                OPM_THROW(std::logic_error,
+                          "The unscaled saturation " << SwUnscaled
+                          << " is not mapped back to " << SwScaled);
+        }
+    }
+}
+
 int main(int argc, char **argv)
 {
     typedef double Scalar;
@@ -296,6 +1315,15 @@ int main(int argc, char **argv)
         testGenericApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
+
+        MaterialLaw::Params params;
+        params.setEntryPressure(1e4);
+        params.setLambda(2.0);
+        params.finalize();
+        const Scalar saturations[2] = { 0.3, 0.7 };
+        testSaturationDerivatives<MaterialLaw, TwoPhaseFluidState>(params, saturations);
+        testSaturationDependencies<MaterialLaw, TwoPhaseFluidState>(params, saturations);
+        testTwoPhaseSatDerivatives<MaterialLaw>(params);
     }
     {
         typedef Opm::LinearMaterial<TwoPhaseTraits> MaterialLaw;
@@ -325,6 +1353,9 @@ int main(int argc, char **argv)
                                         /*OilWaterMaterial=*/TwoPhaseMaterial> MaterialLaw;
         testGenericApi<MaterialLaw, ThreePhaseFluidState>();
         testThreePhaseApi<MaterialLaw, ThreePhaseFluidState>();
+        testEclThreePhaseBatchApi<MaterialLaw>();
+        testEclKroTable<MaterialLaw, Opm::ImmiscibleFluidState<Scalar, ThreePFluidSystem> >();
+        testEclSaturationDerivatives<MaterialLaw, ThreePhaseFluidState>();
         //testThreePhaseSatApi<MaterialLaw, ThreePhaseFluidState>();
     }
     {
@@ -334,6 +1365,9 @@ int main(int argc, char **argv)
                                        /*OilWaterMaterial=*/TwoPhaseMaterial> MaterialLaw;
         testGenericApi<MaterialLaw, ThreePhaseFluidState>();
         testThreePhaseApi<MaterialLaw, ThreePhaseFluidState>();
+        testEclThreePhaseBatchApi<MaterialLaw>();
+        testEclKroTable<MaterialLaw, Opm::ImmiscibleFluidState<Scalar, ThreePFluidSystem> >();
+        testEclSaturationDerivatives<MaterialLaw, ThreePhaseFluidState>();
         //testThreePhaseSatApi<MaterialLaw, ThreePhaseFluidState>();
     }
     {
@@ -343,6 +1377,9 @@ int main(int argc, char **argv)
                                        /*OilWaterMaterial=*/TwoPhaseMaterial> MaterialLaw;
         testGenericApi<MaterialLaw, ThreePhaseFluidState>();
         testThreePhaseApi<MaterialLaw, ThreePhaseFluidState>();
+        testEclThreePhaseBatchApi<MaterialLaw>();
+        testEclKroTable<MaterialLaw, Opm::ImmiscibleFluidState<Scalar, ThreePFluidSystem> >();
+        testEclSaturationDerivatives<MaterialLaw, ThreePhaseFluidState>();
         //testThreePhaseSatApi<MaterialLaw, ThreePhaseFluidState>();
     }
     {
@@ -367,6 +1404,7 @@ int main(int argc, char **argv)
         typedef Opm::ThreePhaseParkerVanGenuchten<ThreePhaseTraits> MaterialLaw;
         testGenericApi<MaterialLaw, ThreePhaseFluidState>();
         testThreePhaseApi<MaterialLaw, ThreePhaseFluidState>();
+        testThreePhaseVanGenuchtenBatch<MaterialLaw, ThreePhaseFluidState>();
         //testThreePhaseSatApi<MaterialLaw, ThreePhaseFluidState>();
     }
     {
@@ -386,12 +1424,18 @@ int main(int argc, char **argv)
         testGenericApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
+
+        typedef Opm::ImmiscibleFluidState<Scalar, TwoPFluidSystem> ScalarFluidState;
+        testParkerLenhardHistory<MaterialLaw, ScalarFluidState>();
     }
     {
         typedef Opm::PiecewiseLinearTwoPhaseMaterial<TwoPhaseTraits> MaterialLaw;
         testGenericApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
+        testPiecewiseLinearCurveShapes<MaterialLaw>();
+        testPiecewiseLinearValueUpdate<MaterialLaw>();
+        testPiecewiseLinearPcnwInverse<MaterialLaw>();
     }
     {
         typedef Opm::SplineTwoPhaseMaterial<TwoPhaseTraits> MaterialLaw;
@@ -404,18 +1448,35 @@ int main(int argc, char **argv)
         testGenericApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
+        testVanGenuchtenFusedEvaluation<MaterialLaw>();
+
+        typedef Opm::EffToAbsLaw<MaterialLaw> TwoPAbsLaw;
+        testGenericApi<TwoPAbsLaw, TwoPhaseFluidState>();
+        testTwoPhaseApi<TwoPAbsLaw, TwoPhaseFluidState>();
+        testTwoPhaseSatApi<TwoPAbsLaw, TwoPhaseFluidState>();
+        testEffToAbsLawBatch<TwoPAbsLaw>();
     }
     {
         typedef Opm::RegularizedBrooksCorey<TwoPhaseTraits> MaterialLaw;
         testGenericApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
+
+        MaterialLaw::Params params;
+        params.setEntryPressure(1e4);
+        params.setLambda(2.0);
+        testRegularizedTabulation<MaterialLaw>(params);
     }
     {
         typedef Opm::RegularizedVanGenuchten<TwoPhaseTraits> MaterialLaw;
         testGenericApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
+
+        MaterialLaw::Params params;
+        params.setVgAlpha(1e-4);
+        params.setVgN(2.5);
+        testRegularizedTabulation<MaterialLaw>(params);
     }
 
     {
@@ -432,6 +1493,26 @@ int main(int argc, char **argv)
         testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
     }
+    {
+        typedef Opm::PiecewiseLinearTwoPhaseMaterial<TwoPhaseTraits> RawMaterialLaw;
+        typedef Opm::EclHysteresisTwoPhaseLaw<RawMaterialLaw> MaterialLaw;
+        testHysteresisDrainageOnly<MaterialLaw>();
+    }
+    {
+        typedef Opm::PiecewiseLinearTwoPhaseMaterial<TwoPhaseTraits> RawMaterialLaw;
+        typedef Opm::QuantizedSaturation<Scalar, int16_t> StateScalar;
+        typedef Opm::EclHysteresisTwoPhaseLawParams<RawMaterialLaw, StateScalar> Params;
+        typedef Opm::EclHysteresisTwoPhaseLaw<RawMaterialLaw, Params> MaterialLaw;
+        testHysteresisDrainageOnly<MaterialLaw>();
+        testQuantizedHysteresisState<MaterialLaw>();
+    }
+    {
+        typedef Opm::PiecewiseLinearTwoPhaseMaterial<TwoPhaseTraits> RawMaterialLaw;
+        typedef Opm::EclHysteresisTwoPhaseLawParams<RawMaterialLaw, Scalar, /*doubleBuffered=*/true> Params;
+        typedef Opm::EclHysteresisTwoPhaseLaw<RawMaterialLaw, Params> MaterialLaw;
+        testDoubleBufferedHysteresisState<MaterialLaw>();
+    }
+    testEclEpsScalingCoefficients<Scalar>();
 
     return 0;
 }
@@ -35,12 +35,25 @@
 #include <opm/material/fluidsystems/SinglePhaseFluidSystem.hpp>
 #include <opm/material/fluidsystems/TwoPhaseImmiscibleFluidSystem.hpp>
 #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
+#include <opm/material/fluidsystems/BlackOilPropertyPipeline.hpp>
+#include <opm/material/fluidsystems/BlackOilCellClassifier.hpp>
+#include <opm/material/fluidsystems/BlackOilPropertyCache.hpp>
+#include <opm/material/common/CompactRegionIndices.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/DeadOilPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/DryGasPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/ConstantCompressibilityWaterPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/LiveOilPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/WetGasPvt.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/PvtTableArrays.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/OilPvtMultiplexer.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/PvtRegionOrdering.hpp>
 #include <opm/material/fluidsystems/BrineCO2FluidSystem.hpp>
 #include <opm/material/fluidsystems/H2ON2FluidSystem.hpp>
 #include <opm/material/fluidsystems/H2ON2LiquidPhaseFluidSystem.hpp>
 #include <opm/material/fluidsystems/H2OAirFluidSystem.hpp>
 #include <opm/material/fluidsystems/H2OAirMesityleneFluidSystem.hpp>
 #include <opm/material/fluidsystems/H2OAirXyleneFluidSystem.hpp>
+#include <opm/material/binarycoefficients/H2O_CO2.hpp>
 
 // include all fluid states
 #include <opm/material/fluidstates/PressureOverlayFluidState.hpp>
@@ -50,6 +63,12 @@
 #include <opm/material/fluidstates/NonEquilibriumFluidState.hpp>
 #include <opm/material/fluidstates/ImmiscibleFluidState.hpp>
 #include <opm/material/fluidstates/SimpleModularFluidState.hpp>
+#include <opm/material/fluidstates/BlackOilFluidState.hpp>
+#include <opm/material/fluidstates/FluidStateArray.hpp>
+#include <opm/material/fluidstates/LazyFluidState.hpp>
+
+#include <algorithm>
+#include <type_traits>
 
 // include the tables for CO2 which are delivered with opm-material by default
 #include <opm/material/common/UniformTabulated2DFunction.hpp>
@@ -131,6 +150,12 @@ void testAllFluidStates()
     {   Opm::ImmiscibleFluidState<Scalar, FluidSystem> fs;
         checkFluidState<Scalar>(fs); }
 
+    // LazyFluidState. Since it calls the fluid system, the latter must be usable for
+    // the fluid state's scalar type.
+    {   typedef Opm::FluidSystems::H2ON2<double, /*enableComplexRelations=*/false> LazyFluidSystem;
+        Opm::LazyFluidState<Scalar, LazyFluidSystem> fs;
+        checkFluidState<Scalar>(fs); }
+
     typedef Opm::CompositionalFluidState<Scalar, FluidSystem> BaseFluidState;
     BaseFluidState baseFs;
 
@@ -147,6 +172,316 @@ void testAllFluidStates()
         checkFluidState<Scalar>(fs); }
 }
 
+// make sure that assigning a modular fluid state from a fluid state of the same type
+// copies all quantities and that the fluid states can be copied using memcpy()
+template <class Scalar>
+void testSameTypeAssign()
+{
+    typedef Opm::FluidSystems::H2ON2<Scalar, /*enableComplexRelations=*/false> FluidSystem;
+    typedef Opm::CompositionalFluidState<Scalar, FluidSystem> FluidState;
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+
+    static_assert(!std::is_trivially_copyable<Scalar>::value
+                  || (std::is_trivially_copyable<FluidState>::value
+                      && std::is_trivially_copyable<Opm::ImmiscibleFluidState<Scalar, FluidSystem> >::value
+                      && std::is_trivially_copyable<Opm::PressureOverlayFluidState<FluidState> >::value),
+                  "The fluid states must be trivially copyable if their scalars are");
+
+    FluidState fs;
+    fs.setTemperature(300.0);
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        fs.setPressure(phaseIdx, 1e5*(phaseIdx + 1));
+        fs.setSaturation(phaseIdx, 0.25*(phaseIdx + 1));
+        fs.setDensity(phaseIdx, 100.0*(phaseIdx + 1));
+        fs.setViscosity(phaseIdx, 1e-3*(phaseIdx + 1));
+        fs.setEnthalpy(phaseIdx, 1e3*(phaseIdx + 1));
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            fs.setMoleFraction(phaseIdx, compIdx, 0.1*(phaseIdx + compIdx + 1));
+            fs.setFugacityCoefficient(phaseIdx, compIdx, 2.0*(phaseIdx + compIdx + 1));
+        }
+    }
+
+    FluidState fs2;
+    fs2.assign(fs);
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        if (fs2.pressure(phaseIdx) != fs.pressure(phaseIdx)
+            || fs2.temperature(phaseIdx) != fs.temperature(phaseIdx)
+            || fs2.saturation(phaseIdx) != fs.saturation(phaseIdx)
+            || fs2.density(phaseIdx) != fs.density(phaseIdx)
+            || fs2.viscosity(phaseIdx) != fs.viscosity(phaseIdx)
+            || fs2.enthalpy(phaseIdx) != fs.enthalpy(phaseIdx)
+            || fs2.averageMolarMass(phaseIdx) != fs.averageMolarMass(phaseIdx))
+            OPM_THROW(std::logic_error, "Same-type assign: Wrong quantities of phase " << phaseIdx);
+
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            if (fs2.moleFraction(phaseIdx, compIdx) != fs.moleFraction(phaseIdx, compIdx)
+                || fs2.fugacityCoefficient(phaseIdx, compIdx) != fs.fugacityCoefficient(phaseIdx, compIdx))
+                OPM_THROW(std::logic_error,
+                          "Same-type assign: Wrong composition of phase " << phaseIdx);
+    }
+
+    // the generic path must still retrieve the quantities from a different fluid state
+    Opm::PressureOverlayFluidState<FluidState> overlayFs(fs);
+    overlayFs.setPressure(/*phaseIdx=*/0, 3e5);
+    fs2.assign(overlayFs);
+    if (fs2.pressure(/*phaseIdx=*/0) != 3e5 || fs2.moleFraction(0, 1) != fs.moleFraction(0, 1))
+        OPM_THROW(std::logic_error, "Assign from a different fluid state type: Wrong quantities");
+}
+
+// check the black-oil fluid state which only stores the dissolved mole fractions
+template <class Scalar, class Evaluation>
+void testBlackOilFluidState()
+{
+    typedef Opm::FluidSystems::BlackOil<Scalar, Evaluation> FluidSystem;
+    typedef Opm::BlackOilFluidState<Evaluation, FluidSystem> FluidState;
+
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+    enum { waterPhaseIdx = FluidSystem::waterPhaseIdx };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+    enum { waterCompIdx = FluidSystem::waterCompIdx };
+    enum { oilCompIdx = FluidSystem::oilCompIdx };
+    enum { gasCompIdx = FluidSystem::gasCompIdx };
+
+    FluidState fs;
+    checkFluidState<Evaluation>(fs);
+
+    static_assert(sizeof(FluidState) < sizeof(Opm::CompositionalFluidState<Evaluation, FluidSystem>),
+                  "The black-oil fluid state should be smaller than the generic one");
+
+    // the mole fractions which are expected: x[phaseIdx][compIdx]
+    Scalar xRef[numPhases][numComponents];
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            xRef[phaseIdx][compIdx] = 0.0;
+    xRef[waterPhaseIdx][waterCompIdx] = 1.0;
+    xRef[oilPhaseIdx][oilCompIdx] = 0.7;
+    xRef[oilPhaseIdx][gasCompIdx] = 0.3;
+    xRef[gasPhaseIdx][gasCompIdx] = 0.99;
+    xRef[gasPhaseIdx][oilCompIdx] = 0.01;
+
+    fs.setMoleFraction(oilPhaseIdx, gasCompIdx, Evaluation::createVariable(0.3, 0));
+    fs.setMoleFraction(gasPhaseIdx, gasCompIdx, 0.99);
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            // only the mole fractions of the oil phase depend on the variable
+            Scalar dxRef = 0.0;
+            if (phaseIdx == oilPhaseIdx && compIdx == gasCompIdx)
+                dxRef = 1.0;
+            else if (phaseIdx == oilPhaseIdx && compIdx == oilCompIdx)
+                dxRef = -1.0;
+
+            const Evaluation& x = fs.moleFraction(phaseIdx, compIdx);
+            if (std::abs(x.value - xRef[phaseIdx][compIdx]) > 1e-15
+                || std::abs(x.derivatives[0] - dxRef) > 1e-15)
+                OPM_THROW(std::logic_error,
+                          "Black-oil fluid state: Wrong mole fraction of component " << compIdx
+                          << " in phase " << phaseIdx);
+        }
+    }
+
+    // setting a structurally zero mole fraction to something else must fail
+    bool caught = false;
+    try { fs.setMoleFraction(waterPhaseIdx, gasCompIdx, 0.1); }
+    catch (const std::logic_error&) { caught = true; }
+    if (!caught)
+        OPM_THROW(std::logic_error,
+                  "Black-oil fluid state: Non-zero mole fraction of gas in water was accepted");
+
+    FluidState fs2;
+    fs2.assign(fs);
+    if (fs2.moleFraction(gasPhaseIdx, oilCompIdx) != fs.moleFraction(gasPhaseIdx, oilCompIdx)
+        || fs2.moleFraction(oilPhaseIdx, gasCompIdx) != fs.moleFraction(oilPhaseIdx, gasCompIdx))
+        OPM_THROW(std::logic_error, "Black-oil fluid state: assign() is broken");
+}
+
+// check the black-oil fluid system if the gas phase is disabled at compile time
+template <class Scalar>
+void testBlackOilWaterOilFluidSystem()
+{
+    typedef Opm::FluidSystems::BlackOilInstance<Scalar> ThreePhaseFluidSystem;
+    typedef Opm::FluidSystems::BlackOil<Scalar,
+                                        Scalar,
+                                        Opm::FluidSystems::BlackOilWaterOilTraits> FluidSystem;
+    typedef Opm::BlackOilFluidState<Scalar, FluidSystem> FluidState;
+
+    static_assert(FluidSystem::numPhases == 2 && FluidSystem::numComponents == 2,
+                  "The water-oil black-oil fluid system must only consider two phases");
+    static_assert(FluidSystem::waterPhaseIdx == 0 && FluidSystem::oilPhaseIdx == 1
+                  && FluidSystem::waterCompIdx == 0 && FluidSystem::oilCompIdx == 1,
+                  "The phases and components of the water-oil fluid system must be numbered consecutively");
+    static_assert(sizeof(FluidState) < sizeof(Opm::BlackOilFluidState<Scalar, Opm::FluidSystems::BlackOil<Scalar> >),
+                  "The water-oil black-oil fluid state should be smaller than the three-phase one");
+
+    FluidState fs;
+    checkFluidState<Scalar>(fs);
+
+    std::vector<Scalar> p, invBo, muo;
+    for (int i = 0; i <= 20; ++i) {
+        Scalar pBar = 1.0 + 25.0*i;
+        p.push_back(pBar*1e5);
+        invBo.push_back(1.0/(1.2 - 1e-4*pBar));
+        muo.push_back(1e-3*(1.0 + 5e-4*pBar));
+    }
+
+    auto oilPvt = std::make_shared<Opm::DeadOilPvt<Scalar> >();
+    auto waterPvt = std::make_shared<Opm::ConstantCompressibilityWaterPvt<Scalar> >();
+    oilPvt->setNumRegions(1);
+    waterPvt->setNumRegions(1);
+    oilPvt->setReferenceDensities(850.0, 1033.0, 0.854, /*regionIdx=*/0);
+    waterPvt->setReferenceDensities(850.0, 1033.0, 0.854, /*regionIdx=*/0);
+    oilPvt->setInverseOilFormationVolumeFactor(/*regionIdx=*/0, Opm::Tabulated1DFunction<Scalar>(p, invBo));
+    oilPvt->setOilViscosity(/*regionIdx=*/0, Opm::Tabulated1DFunction<Scalar>(p, muo));
+    waterPvt->setReferencePressure(/*regionIdx=*/0, 1e5);
+    waterPvt->setReferenceFormationVolumeFactor(/*regionIdx=*/0, 1.02);
+    waterPvt->setCompressibility(/*regionIdx=*/0, 4.5e-10);
+    waterPvt->setViscosity(/*regionIdx=*/0, 0.5e-3);
+    oilPvt->initEnd();
+    waterPvt->initEnd();
+
+    ThreePhaseFluidSystem threePhaseFluidSystem;
+    FluidSystem::initBegin(/*numPvtRegions=*/1);
+    threePhaseFluidSystem.initBegin(/*numPvtRegions=*/1);
+    threePhaseFluidSystem.setEnableDissolvedGas(false);
+    FluidSystem::setReferenceDensities(850.0, 1033.0, 0.854, /*regionIdx=*/0);
+    threePhaseFluidSystem.setReferenceDensities(850.0, 1033.0, 0.854, /*regionIdx=*/0);
+    FluidSystem::setOilPvt(oilPvt);
+    FluidSystem::setWaterPvt(waterPvt);
+    threePhaseFluidSystem.setOilPvt(oilPvt);
+    threePhaseFluidSystem.setWaterPvt(waterPvt);
+    FluidSystem::initEnd();
+    threePhaseFluidSystem.initEnd();
+
+    if (FluidSystem::enableDissolvedGas() || FluidSystem::enableVaporizedOil())
+        OPM_THROW(std::logic_error, "Water-oil black-oil fluid system: Miscibility must be disabled");
+
+    bool caught = false;
+    try { FluidSystem::setEnableDissolvedGas(true); }
+    catch (const std::logic_error&) { caught = true; }
+    if (!caught)
+        OPM_THROW(std::logic_error,
+                  "Water-oil black-oil fluid system: Dissolved gas could be enabled at runtime");
+
+    typename FluidSystem::ParameterCache paramCache;
+    fs.setTemperature(350.0);
+    for (int i = 0; i < 10; ++i) {
+        Scalar pw = (20.0 + 30.0*i)*1e5;
+        Scalar po = pw + 1e5;
+        fs.setPressure(FluidSystem::waterPhaseIdx, pw);
+        fs.setPressure(FluidSystem::oilPhaseIdx, po);
+
+        if (fs.moleFraction(FluidSystem::oilPhaseIdx, FluidSystem::oilCompIdx) != 1.0
+            || fs.moleFraction(FluidSystem::oilPhaseIdx, FluidSystem::waterCompIdx) != 0.0)
+            OPM_THROW(std::logic_error, "Water-oil black-oil fluid state: Wrong composition");
+
+        Scalar T = 350.0;
+        if (FluidSystem::density(fs, paramCache, FluidSystem::oilPhaseIdx)
+                != threePhaseFluidSystem.oilProperties(T, po, Scalar(0.0), /*regionIdx=*/0).density
+            || FluidSystem::viscosity(fs, paramCache, FluidSystem::oilPhaseIdx)
+                != threePhaseFluidSystem.oilProperties(T, po, Scalar(0.0), /*regionIdx=*/0).mu
+            || FluidSystem::density(fs, paramCache, FluidSystem::waterPhaseIdx)
+                != threePhaseFluidSystem.waterProperties(T, pw, /*regionIdx=*/0).density
+            || FluidSystem::referenceDensity(FluidSystem::oilPhaseIdx, /*regionIdx=*/0) != 850.0
+            || FluidSystem::molarMass(FluidSystem::waterCompIdx) != 18e-3)
+            OPM_THROW(std::logic_error,
+                      "Water-oil black-oil fluid system: Inconsistent with the three-phase one");
+    }
+
+    // without miscibility, the properties of the phases only depend on their pressure
+    // and temperature. dissolved gas makes the ones of oil depend on its composition
+    typedef Opm::BaseFluidSystem<Scalar, FluidSystem> Base;
+    const unsigned pT = Base::PressureDependency | Base::TemperatureDependency;
+    if (FluidSystem::densityDependencies(FluidSystem::oilPhaseIdx) != pT
+        || FluidSystem::viscosityDependencies(FluidSystem::waterPhaseIdx) != pT
+        || FluidSystem::fugacityCoefficientDependencies(FluidSystem::oilPhaseIdx,
+                                                        FluidSystem::waterCompIdx) != pT
+        || threePhaseFluidSystem.densityDependencies(ThreePhaseFluidSystem::oilPhaseIdx) != pT)
+        OPM_THROW(std::logic_error, "Water-oil black-oil fluid system: Wrong dependencies");
+
+    threePhaseFluidSystem.setEnableDissolvedGas(true);
+    if (threePhaseFluidSystem.viscosityDependencies(ThreePhaseFluidSystem::oilPhaseIdx) != Base::AllDependencies
+        || threePhaseFluidSystem.densityDependencies(ThreePhaseFluidSystem::gasPhaseIdx) != pT
+        || threePhaseFluidSystem.densityDependencies(ThreePhaseFluidSystem::waterPhaseIdx) != pT)
+        OPM_THROW(std::logic_error, "Black-oil fluid system: Wrong dependencies with dissolved gas");
+}
+
+// make sure that the elements of a fluid state array behave like normal fluid states
+template <class Scalar>
+void testFluidStateArray()
+{
+    typedef Opm::FluidSystems::H2ON2<Scalar, /*enableComplexRelations=*/false> FluidSystem;
+    typedef Opm::FluidStateArray<Scalar, FluidSystem> FluidStateArray;
+    typedef typename FluidStateArray::Proxy FluidStateProxy;
+    typedef Opm::CompositionalFluidState<Scalar, FluidSystem> RefFluidState;
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+
+    const size_t n = 5;
+    FluidStateArray fluidStates(n);
+    checkFluidState<Scalar>(fluidStates[0]);
+
+    for (size_t i = 0; i < n; ++i) {
+        FluidStateProxy fs = fluidStates[i];
+        RefFluidState refFs;
+
+        Scalar T = 300.0 + 10.0*i;
+        fs.setTemperature(T);
+        refFs.setTemperature(T);
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            Scalar p = 1e5*(1.0 + i + phaseIdx);
+            fs.setPressure(phaseIdx, p);
+            refFs.setPressure(phaseIdx, p);
+            fs.setSaturation(phaseIdx, 0.5);
+            refFs.setSaturation(phaseIdx, 0.5);
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+                Scalar x = (compIdx == phaseIdx) ? 0.99 : 0.01;
+                fs.setMoleFraction(phaseIdx, compIdx, x);
+                refFs.setMoleFraction(phaseIdx, compIdx, x);
+            }
+        }
+
+        ParameterCache paramCache;
+        paramCache.updateAll(fs);
+        FluidSystem::computeAll(fs, paramCache);
+
+        ParameterCache refParamCache;
+        refParamCache.updateAll(refFs);
+        FluidSystem::computeAll(refFs, refParamCache);
+
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            bool ok =
+                fs.density(phaseIdx) == refFs.density(phaseIdx)
+                && fs.viscosity(phaseIdx) == refFs.viscosity(phaseIdx)
+                && fs.enthalpy(phaseIdx) == refFs.enthalpy(phaseIdx)
+                && fs.averageMolarMass(phaseIdx) == refFs.averageMolarMass(phaseIdx)
+                && fluidStates.densityArray(phaseIdx)[i] == refFs.density(phaseIdx)
+                && fluidStates.pressureArray(phaseIdx)[i] == refFs.pressure(phaseIdx);
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                ok = ok
+                    && fs.massFraction(phaseIdx, compIdx) == refFs.massFraction(phaseIdx, compIdx)
+                    && fs.fugacity(phaseIdx, compIdx) == refFs.fugacity(phaseIdx, compIdx)
+                    && fluidStates.moleFractionArray(phaseIdx, compIdx)[i] == refFs.moleFraction(phaseIdx, compIdx);
+
+            if (!ok)
+                OPM_THROW(std::logic_error,
+                          "Fluid state array: Element " << i << " differs from the reference fluid state");
+        }
+    }
+
+    // assign() must copy all quantities
+    RefFluidState refFs;
+    refFs.assign(fluidStates[n - 1]);
+    fluidStates[0].assign(refFs);
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+        if (fluidStates[0].density(phaseIdx) != fluidStates[n - 1].density(phaseIdx)
+            || fluidStates[0].moleFraction(phaseIdx, 0) != fluidStates[n - 1].moleFraction(phaseIdx, 0))
+            OPM_THROW(std::logic_error, "Fluid state array: assign() is broken");
+}
+
 template <class Scalar, class Evaluation, class LhsEval = Evaluation>
 void testAllFluidSystems()
 {
@@ -203,10 +538,16 @@ void testAllFluidSystems()
     {   typedef Opm::FluidSystems::H2OAirMesitylene<Scalar> FluidSystem;
         checkFluidSystem<Scalar, FluidSystem, Evaluation, LhsEval>(); }
 
+    {   typedef Opm::FluidSystems::H2OAirMesitylene<Scalar, /*tabulateComponents=*/true> FluidSystem;
+        checkFluidSystem<Scalar, FluidSystem, Evaluation, LhsEval>(); }
+
     // H2O -- Air -- Xylene
     {   typedef Opm::FluidSystems::H2OAirXylene<Scalar> FluidSystem;
         checkFluidSystem<Scalar, FluidSystem, Evaluation, LhsEval>(); }
 
+    {   typedef Opm::FluidSystems::H2OAirXylene<Scalar, /*tabulateComponents=*/true> FluidSystem;
+        checkFluidSystem<Scalar, FluidSystem, Evaluation, LhsEval>(); }
+
     // 2p-immiscible
     {   typedef Opm::FluidSystems::TwoPhaseImmiscible<Scalar, Liquid, Liquid> FluidSystem;
         checkFluidSystem<Scalar, FluidSystem, Evaluation, LhsEval>(); }
@@ -225,6 +566,1519 @@ void testAllFluidSystems()
         checkFluidSystem<Scalar, FluidSystem, Evaluation, LhsEval>(); }
 }
 
+// compare the tabulated mutual solubilities of brine and CO2 to the correlations
+template <class Scalar, class Evaluation>
+void testBrineCO2MoleFractionTables()
+{
+    typedef Opm::FluidSystemsTest::CO2Tables CO2Tables;
+    typedef Opm::BinaryCoeff::Brine_CO2<Scalar, CO2Tables> BinaryCoeff;
+
+    const Scalar salinity = CO2Tables::brineSalinity;
+    const int n = 10;
+    Scalar refXlCO2[n][n], refYgH2O[n][n], refDerivXlCO2[n][n][2];
+
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1)
+            BinaryCoeff::tabulateMoleFractions(290.0, 390.0, 200,
+                                               1e5, 50e6, 500,
+                                               salinity);
+
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                const Evaluation& T = Evaluation::createVariable(291.23 + i*9.7, 0);
+                const Evaluation& p = Evaluation::createVariable(1.37e6 + j*4.8e6, 1);
+
+                Evaluation xlCO2, ygH2O;
+                BinaryCoeff::calculateMoleFractions(T, p, salinity, /*knownPhaseIdx=*/-1,
+                                                    xlCO2, ygH2O);
+                if (pass == 0) {
+                    refXlCO2[i][j] = xlCO2.value;
+                    refYgH2O[i][j] = ygH2O.value;
+                    refDerivXlCO2[i][j][0] = xlCO2.derivatives[0];
+                    refDerivXlCO2[i][j][1] = xlCO2.derivatives[1];
+                    continue;
+                }
+
+                if (std::abs(xlCO2.value - refXlCO2[i][j]) > 1e-3*refXlCO2[i][j]
+                    || std::abs(ygH2O.value - refYgH2O[i][j]) > 1e-3*refYgH2O[i][j]
+                    || std::abs(xlCO2.derivatives[0] - refDerivXlCO2[i][j][0])
+                       > 5e-2*std::max(std::abs(refDerivXlCO2[i][j][0]), 1e-3*refXlCO2[i][j])
+                    || std::abs(xlCO2.derivatives[1] - refDerivXlCO2[i][j][1])
+                       > 5e-2*std::abs(refDerivXlCO2[i][j][1]))
+                    OPM_THROW(std::logic_error,
+                              "Tabulated mole fractions of brine and CO2 deviate from the "
+                              "correlations at T=" << T.value << ", p=" << p.value);
+            }
+        }
+    }
+
+    // switch the tables off again
+    BinaryCoeff::tabulateMoleFractions(0.0, 0.0, 0, 0.0, 0.0, 0, salinity);
+}
+
+// compare the tabulated Henry and gas diffusion coefficients to the relations
+template <class Scalar, class Evaluation>
+void testBinaryCoeffTemperatureTables()
+{
+    typedef Opm::BinaryCoeff::H2O_N2 H2O_N2;
+    typedef Opm::BinaryCoeff::H2O_Air H2O_Air;
+    typedef Opm::BinaryCoeff::H2O_CO2 H2O_CO2;
+
+    const int n = 20;
+    const int numCoeffs = 5;
+    Evaluation reference[n][numCoeffs];
+
+    for (int pass = 0; pass < 2; ++pass) {
+        // the fluid systems tabulate the coefficients in their init() methods
+        Scalar tempMin = (pass == 0)?0.0:280.0;
+        Scalar tempMax = (pass == 0)?0.0:400.0;
+        H2O_N2::tabulate(tempMin, tempMax, 121);
+        H2O_Air::tabulate(tempMin, tempMax, 121);
+        H2O_CO2::tabulate<Scalar>(tempMin, tempMax, 121);
+
+        for (int i = 0; i < n; ++i) {
+            const Evaluation& T = Evaluation::createVariable(281.3 + i*5.9, 0);
+            const Evaluation& p = Evaluation::createVariable(1.5e5 + i*1e6, 1);
+
+            const Evaluation coeffs[numCoeffs] = {
+                H2O_N2::henry(T),
+                H2O_N2::gasDiffCoeff(T, p),
+                H2O_Air::gasDiffCoeff(T, p),
+                H2O_CO2::henry<Scalar>(T),
+                H2O_CO2::gasDiffCoeff<Scalar>(T, p)
+            };
+
+            for (int coeffIdx = 0; coeffIdx < numCoeffs; ++coeffIdx) {
+                const Evaluation& ref = reference[i][coeffIdx];
+                const Evaluation& val = coeffs[coeffIdx];
+                if (pass == 0) {
+                    reference[i][coeffIdx] = val;
+                    continue;
+                }
+
+                // the Henry coefficient of nitrogen exhibits a maximum within the
+                // range, so the temperature derivatives are compared relative to the
+                // value as well
+                Scalar derivScale[2] = { std::abs(ref.value)/T.value, 0.0 };
+                bool ok = std::abs(val.value - ref.value) <= 1e-6*std::abs(ref.value);
+                for (int varIdx = 0; varIdx < 2; ++varIdx)
+                    ok = ok && (std::abs(val.derivatives[varIdx] - ref.derivatives[varIdx])
+                                <= 1e-3*(std::abs(ref.derivatives[varIdx]) + derivScale[varIdx]));
+                if (!ok)
+                    OPM_THROW(std::logic_error,
+                              "Tabulated binary coefficient " << coeffIdx
+                              << " deviates from the relation at T=" << T.value
+                              << ": " << val.value << " vs. " << ref.value);
+            }
+        }
+    }
+
+    // switch the tables off again
+    H2O_N2::tabulate(0.0, 0.0, 0);
+    H2O_Air::tabulate(0.0, 0.0, 0);
+    H2O_CO2::tabulate<Scalar>(0.0, 0.0, 0);
+}
+
+// compare the isothermal tables of a fluid system to the temperature dependent
+// relations
+template <class Scalar, class Evaluation, class FluidSystem>
+void testIsothermalFluidSystem(Scalar temperature, Scalar pressMin, Scalar pressMax)
+{
+    typedef Opm::CompositionalFluidState<Evaluation, FluidSystem> FluidState;
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+    const int numQuantities = 2*numPhases + numPhases*numComponents;
+    const int n = 20;
+    Evaluation reference[n][numQuantities];
+
+    FluidState fs;
+    ParameterCache paramCache;
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        fs.setTemperature(Evaluation::createConstant(temperature));
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            fs.setMoleFraction(phaseIdx, compIdx, Evaluation::createConstant(0.02));
+        fs.setMoleFraction(phaseIdx, phaseIdx, Evaluation::createConstant(0.98));
+    }
+
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1)
+            FluidSystem::initIsothermal(temperature, pressMin, pressMax, 1000);
+
+        for (int i = 0; i < n; ++i) {
+            const Evaluation& p =
+                Evaluation::createVariable(pressMin + (i + 0.37)*(pressMax - pressMin)/n, 0);
+            for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+                fs.setPressure(phaseIdx, p);
+
+            Evaluation values[numQuantities];
+            int qIdx = 0;
+            for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                values[qIdx++] = FluidSystem::density(fs, paramCache, phaseIdx);
+                values[qIdx++] = FluidSystem::viscosity(fs, paramCache, phaseIdx);
+                for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                    values[qIdx++] = FluidSystem::fugacityCoefficient(fs, paramCache, phaseIdx, compIdx);
+            }
+
+            for (qIdx = 0; qIdx < numQuantities; ++qIdx) {
+                if (pass == 0) {
+                    reference[i][qIdx] = values[qIdx];
+                    continue;
+                }
+
+                const Evaluation& ref = reference[i][qIdx];
+                if (std::abs(values[qIdx].value - ref.value) > 1e-4*std::abs(ref.value)
+                    || std::abs(values[qIdx].derivatives[0] - ref.derivatives[0])
+                       > 5e-2*std::abs(ref.derivatives[0]) + 1e-6*std::abs(ref.value)/(pressMax - pressMin))
+                    OPM_THROW(std::logic_error,
+                              "Isothermal tables of fluid system '"
+                              << Opm::className<FluidSystem>() << "' deviate from the "
+                              << "temperature dependent relations for quantity " << qIdx
+                              << " at p=" << p.value);
+            }
+        }
+    }
+
+    FluidSystem::disableIsothermal();
+}
+
+// compare the phase properties of a fluid system which tabulates all of its
+// components to the ones of the fluid system which uses the raw components
+template <class Scalar, class RawFluidSystem, class TabulatedFluidSystem>
+void testTabulatedComponents()
+{
+    typedef Opm::CompositionalFluidState<Scalar, RawFluidSystem> RawFluidState;
+    typedef Opm::CompositionalFluidState<Scalar, TabulatedFluidSystem> TabulatedFluidState;
+
+    enum { numPhases = RawFluidSystem::numPhases };
+    enum { numComponents = RawFluidSystem::numComponents };
+
+    RawFluidSystem::init(/*tempMin=*/280.0, /*tempMax=*/360.0, /*nTemp=*/161,
+                         /*pressMin=*/1e3, /*pressMax=*/5e6, /*nPress=*/500);
+    TabulatedFluidSystem::init(/*tempMin=*/280.0, /*tempMax=*/360.0, /*nTemp=*/161,
+                               /*pressMin=*/1e3, /*pressMax=*/5e6, /*nPress=*/500);
+
+    RawFluidState rawFs;
+    TabulatedFluidState tabFs;
+    typename RawFluidSystem::ParameterCache rawParamCache;
+    typename TabulatedFluidSystem::ParameterCache tabParamCache;
+    for (int i = 0; i < 10; ++i) {
+        Scalar T = 283.7 + i*7.3;
+        Scalar p = 1.3e5 + i*4.1e5;
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            rawFs.setTemperature(T);
+            rawFs.setPressure(phaseIdx, p);
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                rawFs.setMoleFraction(phaseIdx, compIdx, compIdx == phaseIdx ? 0.9 : 0.05);
+        }
+        tabFs.assign(rawFs);
+
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            rawParamCache.updatePhase(rawFs, phaseIdx);
+            tabParamCache.updatePhase(tabFs, phaseIdx);
+
+            Scalar rawValues[3] = {
+                RawFluidSystem::density(rawFs, rawParamCache, phaseIdx),
+                RawFluidSystem::viscosity(rawFs, rawParamCache, phaseIdx),
+                RawFluidSystem::enthalpy(rawFs, rawParamCache, phaseIdx)
+            };
+            Scalar tabValues[3] = {
+                TabulatedFluidSystem::density(tabFs, tabParamCache, phaseIdx),
+                TabulatedFluidSystem::viscosity(tabFs, tabParamCache, phaseIdx),
+                TabulatedFluidSystem::enthalpy(tabFs, tabParamCache, phaseIdx)
+            };
+
+            for (int qIdx = 0; qIdx < 3; ++qIdx) {
+                if (std::abs(tabValues[qIdx] - rawValues[qIdx]) > 1e-3*std::abs(rawValues[qIdx]))
+                    OPM_THROW(std::logic_error,
+                              "The fluid system with tabulated components yields "
+                              << tabValues[qIdx] << " instead of " << rawValues[qIdx]
+                              << " for quantity " << qIdx << " of phase " << phaseIdx
+                              << " at T=" << T << ", p=" << p);
+            }
+        }
+    }
+}
+
+// make sure that the parameter cache of the water based fluid systems yields the
+// same values and derivatives as the water component
+template <class Scalar, class Evaluation>
+void testH2OParameterCache()
+{
+    typedef Opm::FluidSystems::H2OAirXylene<Scalar> FluidSystem;
+    typedef typename FluidSystem::H2O H2O;
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+
+    ParameterCache paramCache;
+    for (int i = 0; i < 3; ++i) {
+        // the first two iterations use the same conditions, i.e., the cached values
+        // are used by the second one
+        const Evaluation& T = Evaluation::createVariable(300.0 + (i/2)*25.0, 0);
+        const Evaluation& p = Evaluation::createVariable(2e5 + (i/2)*1e6, 1);
+
+        const Evaluation values[] = {
+            paramCache.liquidDensity(FluidSystem::waterPhaseIdx, T, p),
+            paramCache.liquidViscosity(FluidSystem::waterPhaseIdx, T, p),
+            paramCache.liquidEnthalpy(FluidSystem::waterPhaseIdx, T, p),
+            paramCache.gasEnthalpy(FluidSystem::gasPhaseIdx, T, p),
+            paramCache.vaporPressure(FluidSystem::waterPhaseIdx, T),
+            paramCache.saturatedGasViscosity(FluidSystem::gasPhaseIdx, T)
+        };
+        const Evaluation refValues[] = {
+            H2O::liquidDensity(T, p),
+            H2O::liquidViscosity(T, p),
+            H2O::liquidEnthalpy(T, p),
+            H2O::gasEnthalpy(T, p),
+            H2O::vaporPressure(T),
+            H2O::gasViscosity(T, H2O::vaporPressure(T))
+        };
+
+        for (int qIdx = 0; qIdx < 6; ++qIdx) {
+            const Evaluation& ref = refValues[qIdx];
+            for (int varIdx = -1; varIdx < Evaluation::size; ++varIdx) {
+                Scalar a = (varIdx < 0) ? values[qIdx].value : values[qIdx].derivatives[varIdx];
+                Scalar b = (varIdx < 0) ? ref.value : ref.derivatives[varIdx];
+                if (std::abs(a - b) > 1e-10*std::abs(b))
+                    OPM_THROW(std::logic_error,
+                              "The parameter cache yields a different value than the water "
+                              "component for quantity " << qIdx);
+            }
+        }
+
+        // scalar requests must be consistent with the ones for evaluations
+        Scalar rho = paramCache.liquidDensity(FluidSystem::waterPhaseIdx, T.value, p.value);
+        if (std::abs(rho - refValues[0].value) > 1e-10*std::abs(refValues[0].value))
+            OPM_THROW(std::logic_error,
+                      "The parameter cache yields a different value for scalars");
+    }
+}
+
+template <class Scalar, class Evaluation>
+void testBrineCO2ParameterCache()
+{
+    typedef Opm::FluidSystems::BrineCO2<Scalar, Opm::FluidSystemsTest::CO2Tables> FluidSystem;
+    typedef typename FluidSystem::Brine Brine;
+    typedef typename FluidSystem::CO2 CO2;
+    typedef typename FluidSystem::BinaryCoeffBrineCO2 BinaryCoeffBrineCO2;
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+    typedef Opm::CompositionalFluidState<Evaluation, FluidSystem> FluidState;
+
+    enum { liquidPhaseIdx = FluidSystem::liquidPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+    ParameterCache paramCache;
+    for (int i = 0; i < 3; ++i) {
+        // the first two iterations use the same conditions, i.e., the cached values
+        // are used by the second one
+        const Evaluation& T = Evaluation::createVariable(310.0 + (i/2)*15.0, 0);
+        const Evaluation& p = Evaluation::createVariable(5e6 + (i/2)*10e6, 1);
+
+        Evaluation xlCO2, xgH2O;
+        BinaryCoeffBrineCO2::calculateMoleFractions(T, p,
+                                                    Opm::FluidSystemsTest::CO2Tables::brineSalinity,
+                                                    /*knownPhaseIdx=*/-1,
+                                                    xlCO2, xgH2O);
+
+        const Evaluation values[] = {
+            paramCache.brineLiquidDensity(liquidPhaseIdx, T, p),
+            paramCache.brineLiquidViscosity(liquidPhaseIdx, T, p),
+            paramCache.co2GasDensity(gasPhaseIdx, T, p),
+            paramCache.co2GasViscosity(gasPhaseIdx, T, p),
+            paramCache.co2GasEnthalpy(liquidPhaseIdx, T, p),
+            paramCache.brineGasEnthalpy(gasPhaseIdx, T, p),
+            paramCache.equilibriumGasH2OMoleFraction(liquidPhaseIdx, T, p),
+            paramCache.equilibriumLiquidCO2MoleFraction(liquidPhaseIdx, T, p)
+        };
+        const Evaluation refValues[] = {
+            Brine::liquidDensity(T, p),
+            Brine::liquidViscosity(T, p),
+            CO2::gasDensity(T, p),
+            CO2::gasViscosity(T, p),
+            CO2::gasEnthalpy(T, p),
+            Brine::gasEnthalpy(T, p),
+            xgH2O,
+            xlCO2
+        };
+
+        for (int qIdx = 0; qIdx < 8; ++qIdx) {
+            const Evaluation& ref = refValues[qIdx];
+            for (int varIdx = -1; varIdx < Evaluation::size; ++varIdx) {
+                Scalar a = (varIdx < 0) ? values[qIdx].value : values[qIdx].derivatives[varIdx];
+                Scalar b = (varIdx < 0) ? ref.value : ref.derivatives[varIdx];
+                if (std::abs(a - b) > 1e-10*std::abs(b))
+                    OPM_THROW(std::logic_error,
+                              "The parameter cache yields a different value than the "
+                              "components for quantity " << qIdx);
+            }
+        }
+
+        // a cache which was used for other conditions must yield the same phase
+        // properties as a fresh one
+        FluidState fluidState;
+        fluidState.setTemperature(T);
+        for (int phaseIdx = 0; phaseIdx < FluidSystem::numPhases; ++phaseIdx) {
+            fluidState.setPressure(phaseIdx, p);
+            fluidState.setMoleFraction(phaseIdx, FluidSystem::BrineIdx, (phaseIdx == liquidPhaseIdx) ? 0.98 : 0.01);
+            fluidState.setMoleFraction(phaseIdx, FluidSystem::CO2Idx, (phaseIdx == liquidPhaseIdx) ? 0.02 : 0.99);
+        }
+
+        ParameterCache freshParamCache;
+        for (int phaseIdx = 0; phaseIdx < FluidSystem::numPhases; ++phaseIdx) {
+            const Evaluation props[] = {
+                FluidSystem::density(fluidState, paramCache, phaseIdx),
+                FluidSystem::viscosity(fluidState, paramCache, phaseIdx),
+                FluidSystem::enthalpy(fluidState, paramCache, phaseIdx),
+                FluidSystem::fugacityCoefficient(fluidState, paramCache, liquidPhaseIdx, phaseIdx)
+            };
+            const Evaluation refProps[] = {
+                FluidSystem::density(fluidState, freshParamCache, phaseIdx),
+                FluidSystem::viscosity(fluidState, freshParamCache, phaseIdx),
+                FluidSystem::enthalpy(fluidState, freshParamCache, phaseIdx),
+                FluidSystem::fugacityCoefficient(fluidState, freshParamCache, liquidPhaseIdx, phaseIdx)
+            };
+
+            for (int qIdx = 0; qIdx < 4; ++qIdx) {
+                for (int varIdx = -1; varIdx < Evaluation::size; ++varIdx) {
+                    Scalar a = (varIdx < 0) ? props[qIdx].value : props[qIdx].derivatives[varIdx];
+                    Scalar b = (varIdx < 0) ? refProps[qIdx].value : refProps[qIdx].derivatives[varIdx];
+                    if (std::abs(a - b) > 1e-10*std::abs(b))
+                        OPM_THROW(std::logic_error,
+                                  "A reused parameter cache yields a different phase property "
+                                  << qIdx << " for phase " << phaseIdx);
+                }
+            }
+        }
+
+        // scalar requests must be consistent with the ones for evaluations
+        Scalar rho = paramCache.brineLiquidDensity(liquidPhaseIdx, T.value, p.value);
+        if (std::abs(rho - refValues[0].value) > 1e-10*std::abs(refValues[0].value))
+            OPM_THROW(std::logic_error,
+                      "The parameter cache yields a different value for scalars");
+    }
+}
+
+// make sure that computeAll() yields the same quantities as the individual methods
+template <class Scalar, class FluidSystem>
+void testComputeAll(Scalar temperature, Scalar pressure)
+{
+    typedef Opm::CompositionalFluidState<Scalar, FluidSystem> FluidState;
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+
+    const int n = 3;
+    FluidState fluidStates[n];
+    ParameterCache paramCaches[n];
+    for (int i = 0; i < n; ++i) {
+        fluidStates[i].setTemperature(temperature + 5.0*i);
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            fluidStates[i].setPressure(phaseIdx, pressure*(1.0 + 0.1*i));
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                fluidStates[i].setMoleFraction(phaseIdx, compIdx, (compIdx == phaseIdx) ? 0.99 : 0.01);
+        }
+        paramCaches[i].updateAll(fluidStates[i]);
+    }
+
+    FluidSystem::computeAllBatch(fluidStates, paramCaches, n);
+
+    for (int i = 0; i < n; ++i) {
+        const FluidState& fs = fluidStates[i];
+        const ParameterCache& paramCache = paramCaches[i];
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            bool ok =
+                fs.density(phaseIdx) == FluidSystem::density(fs, paramCache, phaseIdx)
+                && fs.viscosity(phaseIdx) == FluidSystem::viscosity(fs, paramCache, phaseIdx)
+                && fs.enthalpy(phaseIdx) == FluidSystem::enthalpy(fs, paramCache, phaseIdx);
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                ok = ok && (fs.fugacityCoefficient(phaseIdx, compIdx)
+                            == FluidSystem::fugacityCoefficient(fs, paramCache, phaseIdx, compIdx));
+
+            if (!ok)
+                OPM_THROW(std::logic_error,
+                          "computeAll() of fluid system '" << Opm::className<FluidSystem>()
+                          << "' is inconsistent with the individual methods");
+        }
+    }
+}
+
+// make sure that the lazy fluid state yields the same quantities as the fluid system
+// and that it recomputes them after the state has been modified
+template <class Scalar, class FluidSystem>
+void testLazyFluidState(Scalar temperature, Scalar pressure)
+{
+    typedef Opm::CompositionalFluidState<Scalar, FluidSystem> RefFluidState;
+    typedef Opm::LazyFluidState<Scalar, FluidSystem> LazyFluidState;
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+
+    RefFluidState refFs;
+    LazyFluidState lazyFs;
+    refFs.setTemperature(temperature);
+    lazyFs.setTemperature(temperature);
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        refFs.setPressure(phaseIdx, pressure);
+        lazyFs.setPressure(phaseIdx, pressure);
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            Scalar x = (compIdx == phaseIdx) ? 0.99 : 0.01;
+            refFs.setMoleFraction(phaseIdx, compIdx, x);
+            lazyFs.setMoleFraction(phaseIdx, compIdx, x);
+        }
+    }
+
+    for (int stepIdx = 0; stepIdx < 3; ++stepIdx) {
+        if (stepIdx == 1) {
+            refFs.setPressure(/*phaseIdx=*/0, 1.5*pressure);
+            lazyFs.setPressure(/*phaseIdx=*/0, 1.5*pressure);
+        }
+        else if (stepIdx == 2) {
+            refFs.setTemperature(temperature + 10.0);
+            lazyFs.setTemperature(temperature + 10.0);
+        }
+
+        ParameterCache paramCache;
+        paramCache.updateAll(refFs);
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            // access the quantities twice to check the cached values as well
+            for (int i = 0; i < 2; ++i) {
+                if (lazyFs.density(phaseIdx) != FluidSystem::density(refFs, paramCache, phaseIdx)
+                    || lazyFs.viscosity(phaseIdx) != FluidSystem::viscosity(refFs, paramCache, phaseIdx)
+                    || lazyFs.enthalpy(phaseIdx) != FluidSystem::enthalpy(refFs, paramCache, phaseIdx))
+                    OPM_THROW(std::logic_error,
+                              "The lazy fluid state is inconsistent with fluid system '"
+                              << Opm::className<FluidSystem>() << "'");
+            }
+        }
+    }
+}
+
+// linear relative permeabilities and capillary pressures which provide the interface of
+// EclMaterialLawManager that is used by BlackOilPropertyPipeline
+template <class Scalar>
+struct LinearSaturationFunctions
+{
+    enum { RelativePermeabilities = 1, CapillaryPressures = 2, AllSaturationFunctions = 3 };
+
+    void saturationFunctionsBatch(unsigned quantities,
+                                  unsigned beginElemIdx,
+                                  unsigned endElemIdx,
+                                  const Scalar* Sw,
+                                  const Scalar* Sg,
+                                  Scalar* krw,
+                                  Scalar* kro,
+                                  Scalar* krg,
+                                  Scalar* pcow,
+                                  Scalar* pcgo) const
+    {
+        for (unsigned elemIdx = beginElemIdx; elemIdx < endElemIdx; ++elemIdx) {
+            if (quantities & RelativePermeabilities) {
+                krw[elemIdx] = Sw[elemIdx];
+                kro[elemIdx] = 1 - Sw[elemIdx] - Sg[elemIdx];
+                krg[elemIdx] = Sg[elemIdx];
+            }
+            if (quantities & CapillaryPressures) {
+                pcow[elemIdx] = 1e5*(1 - Sw[elemIdx]);
+                pcgo[elemIdx] = 2e4*Sg[elemIdx];
+            }
+        }
+    }
+
+    // the same saturation functions with the conventions of the material laws, i.e.,
+    // the capillary pressure of the water phase is -pcow and the one of oil is zero
+    void saturationFunctionsWithDerivatives(int /*elemIdx*/,
+                                            const Scalar* S,
+                                            Scalar* kr,
+                                            Scalar (*dKr_dS)[3],
+                                            Scalar* pc,
+                                            Scalar (*dPc_dS)[3]) const
+    {
+        enum { waterPhaseIdx = 0, oilPhaseIdx = 1, gasPhaseIdx = 2 };
+        for (int phaseIdx = 0; phaseIdx < 3; ++phaseIdx) {
+            kr[phaseIdx] = S[phaseIdx];
+            for (int satIdx = 0; satIdx < 3; ++satIdx) {
+                dKr_dS[phaseIdx][satIdx] = (phaseIdx == satIdx) ? 1.0 : 0.0;
+                dPc_dS[phaseIdx][satIdx] = 0.0;
+            }
+        }
+        pc[waterPhaseIdx] = -1e5*(1 - S[waterPhaseIdx]);
+        pc[oilPhaseIdx] = 0.0;
+        pc[gasPhaseIdx] = 2e4*S[gasPhaseIdx];
+        dPc_dS[waterPhaseIdx][waterPhaseIdx] = 1e5;
+        dPc_dS[gasPhaseIdx][gasPhaseIdx] = 2e4;
+    }
+};
+
+// initialize a black-oil fluid system with dead oil, dry gas and constant
+// compressibility water. the reference density of oil is increased by 10 kg/m^3 for
+// each PVT region.
+template <class Scalar, class Evaluation, class FluidSystem>
+void initTestBlackOilFluidSystem(FluidSystem& fluidSystem,
+                                 int numRegions,
+                                 Scalar rhoRefOil0 = 850.0)
+{
+    std::vector<Scalar> p, invBo, muo, mug;
+    std::vector<std::pair<Scalar, Scalar> > Bg;
+    for (int i = 0; i <= 20; ++i) {
+        Scalar pBar = 1.0 + 25.0*i;
+        p.push_back(pBar*1e5);
+        invBo.push_back(1.0/(1.2 - 1e-4*pBar));
+        muo.push_back(1e-3*(1.0 + 5e-4*pBar));
+        Bg.push_back(std::make_pair(pBar*1e5, 1.0/pBar));
+        mug.push_back(1.2e-5 + 2e-8*pBar);
+    }
+
+    auto oilPvt = std::make_shared<Opm::DeadOilPvt<Scalar, Evaluation> >();
+    auto gasPvt = std::make_shared<Opm::DryGasPvt<Scalar, Evaluation> >();
+    auto waterPvt = std::make_shared<Opm::ConstantCompressibilityWaterPvt<Scalar, Evaluation> >();
+    oilPvt->setNumRegions(numRegions);
+    gasPvt->setNumRegions(numRegions);
+    waterPvt->setNumRegions(numRegions);
+
+    fluidSystem.initBegin(numRegions);
+    fluidSystem.setEnableDissolvedGas(false);
+    for (int regionIdx = 0; regionIdx < numRegions; ++regionIdx) {
+        Scalar rhoRefOil = rhoRefOil0 + 10.0*regionIdx;
+        fluidSystem.setReferenceDensities(rhoRefOil, 1033.0, 0.854, regionIdx);
+        oilPvt->setReferenceDensities(rhoRefOil, 1033.0, 0.854, regionIdx);
+        gasPvt->setReferenceDensities(rhoRefOil, 1033.0, 0.854, regionIdx);
+        waterPvt->setReferenceDensities(rhoRefOil, 1033.0, 0.854, regionIdx);
+
+        oilPvt->setInverseOilFormationVolumeFactor(regionIdx, Opm::Tabulated1DFunction<Scalar>(p, invBo));
+        oilPvt->setOilViscosity(regionIdx, Opm::Tabulated1DFunction<Scalar>(p, muo));
+        gasPvt->setGasFormationVolumeFactor(regionIdx, Bg);
+        gasPvt->setGasViscosity(regionIdx, Opm::Tabulated1DFunction<Scalar>(p, mug));
+        waterPvt->setReferencePressure(regionIdx, 1e5);
+        waterPvt->setReferenceFormationVolumeFactor(regionIdx, 1.02 + 0.01*regionIdx);
+        waterPvt->setCompressibility(regionIdx, 4.5e-10);
+        waterPvt->setViscosity(regionIdx, 0.5e-3);
+    }
+    oilPvt->initEnd();
+    gasPvt->initEnd();
+    waterPvt->initEnd();
+    fluidSystem.setOilPvt(oilPvt);
+    fluidSystem.setGasPvt(gasPvt);
+    fluidSystem.setWaterPvt(waterPvt);
+    fluidSystem.initEnd();
+}
+
+// make sure that the tiled evaluation of the black-oil properties yields the same
+// results as evaluating them for each cell individually
+template <class Scalar>
+void testBlackOilPropertyPipeline()
+{
+    typedef Opm::FluidSystems::BlackOilInstance<Scalar> FluidSystem;
+    typedef LinearSaturationFunctions<Scalar> SaturationFunctions;
+    typedef Opm::BlackOilPropertyPipeline<Scalar, FluidSystem, SaturationFunctions> Pipeline;
+
+    enum { numPhases = FluidSystem::numPhases };
+    enum { waterPhaseIdx = FluidSystem::waterPhaseIdx };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+    int numRegions = 2;
+    FluidSystem fluidSystem;
+    initTestBlackOilFluidSystem<Scalar, Scalar>(fluidSystem, numRegions);
+
+    unsigned n = 1000;
+    std::vector<Scalar> T(n, 350.0), po(n), Sw(n), Sg(n), XoG(n, 0.0), XgO(n, 0.0);
+    std::vector<int> regionIdx(n);
+    for (unsigned i = 0; i < n; ++i) {
+        po[i] = (10.0 + 0.37*i)*1e5;
+        Sw[i] = 0.1 + 0.5*((i*7) % 13)/13.0;
+        Sg[i] = 0.3*((i*3) % 11)/11.0;
+        regionIdx[i] = i % numRegions;
+    }
+
+    std::vector<Opm::BlackOilPhaseProperties<Scalar> > props[numPhases];
+    std::vector<Scalar> kr[numPhases], mobility[numPhases];
+    std::vector<Scalar> pcow(n), pcgo(n);
+    typename Pipeline::Inputs inputs = { T.data(), po.data(), Sw.data(), Sg.data(), XoG.data(), XgO.data(), regionIdx.data(),
+                                         /*phasePresence=*/nullptr };
+    typename Pipeline::Outputs outputs;
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        props[phaseIdx].resize(n);
+        kr[phaseIdx].resize(n);
+        mobility[phaseIdx].resize(n);
+        outputs.phaseProperties[phaseIdx] = props[phaseIdx].data();
+        outputs.relativePermeability[phaseIdx] = kr[phaseIdx].data();
+        outputs.mobility[phaseIdx] = mobility[phaseIdx].data();
+    }
+    outputs.pcow = pcow.data();
+    outputs.pcgo = pcgo.data();
+
+    SaturationFunctions saturationFunctions;
+    Pipeline pipeline(fluidSystem, saturationFunctions);
+    pipeline.setTileSize(96);
+    pipeline.run(n, inputs, outputs);
+
+    for (unsigned i = 0; i < n; ++i) {
+        Scalar krRef[numPhases];
+        krRef[waterPhaseIdx] = Sw[i];
+        krRef[oilPhaseIdx] = 1 - Sw[i] - Sg[i];
+        krRef[gasPhaseIdx] = Sg[i];
+
+        Opm::BlackOilPhaseProperties<Scalar> propsRef[numPhases];
+        propsRef[oilPhaseIdx] = fluidSystem.oilProperties(T[i], po[i], XoG[i], regionIdx[i]);
+        propsRef[waterPhaseIdx] = fluidSystem.waterProperties(T[i], po[i] - pcow[i], regionIdx[i]);
+        propsRef[gasPhaseIdx] = fluidSystem.gasProperties(T[i], po[i] + pcgo[i], XgO[i], regionIdx[i]);
+
+        if (pcow[i] != 1e5*(1 - Sw[i]) || pcgo[i] != 2e4*Sg[i])
+            OPM_THROW(std::logic_error,
+                      "BlackOilPropertyPipeline: Wrong capillary pressures for cell " << i);
+
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            const auto& prop = props[phaseIdx][i];
+            const auto& propRef = propsRef[phaseIdx];
+            if (kr[phaseIdx][i] != krRef[phaseIdx]
+                || prop.invB != propRef.invB
+                || prop.mu != propRef.mu
+                || prop.invBMu != propRef.invBMu
+                || prop.density != propRef.density
+                || mobility[phaseIdx][i] != krRef[phaseIdx]/propRef.mu)
+                OPM_THROW(std::logic_error,
+                          "BlackOilPropertyPipeline: Wrong quantities of phase " << phaseIdx
+                          << " for cell " << i);
+        }
+    }
+
+    // the PVT properties of absent phases are replaced by placeholders, e.g., in
+    // aquifer cells which only contain water
+    std::vector<unsigned char> phasePresence(n);
+    for (unsigned i = 0; i < n; ++i)
+        phasePresence[i] = static_cast<unsigned char>((i % 3 == 0) ? (1 << waterPhaseIdx) : 0x7);
+    std::vector<Opm::BlackOilPhaseProperties<Scalar> > fullProps[numPhases];
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+        fullProps[phaseIdx] = props[phaseIdx];
+
+    inputs.phasePresence = phasePresence.data();
+    pipeline.run(n, inputs, outputs);
+
+    const auto& absentProps = Opm::BlackOilPhaseProperties<Scalar>::absentPhase();
+    for (unsigned i = 0; i < n; ++i) {
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            bool isPresent = phasePresence[i] & (1 << phaseIdx);
+            const auto& prop = props[phaseIdx][i];
+            const auto& propRef = isPresent ? fullProps[phaseIdx][i] : absentProps;
+            Scalar mobilityRef = isPresent ? kr[phaseIdx][i]/propRef.mu : 0.0;
+            if (prop.invB != propRef.invB
+                || prop.mu != propRef.mu
+                || prop.invBMu != propRef.invBMu
+                || prop.density != propRef.density
+                || mobility[phaseIdx][i] != mobilityRef)
+                OPM_THROW(std::logic_error,
+                          "BlackOilPropertyPipeline: Wrong quantities of phase " << phaseIdx
+                          << " for cell " << i << " if some phases are absent");
+        }
+    }
+
+    // the kernels of the cell classes must yield the same results as checking the
+    // phase presence of each cell. afterwards, some cells change their phase state and
+    // only these are reclassified.
+    Opm::BlackOilCellClassifier classifier;
+    classifier.resize(n);
+    if (classifier.update(phasePresence.data()) != n)
+        OPM_THROW(std::logic_error, "BlackOilCellClassifier: Not all cells were classified");
+
+    for (int step = 0; step < 2; ++step) {
+        inputs.phasePresence = phasePresence.data();
+        pipeline.run(n, inputs, outputs);
+        std::vector<Opm::BlackOilPhaseProperties<Scalar> > checkedProps[numPhases];
+        std::vector<Scalar> checkedMobility[numPhases];
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            checkedProps[phaseIdx] = props[phaseIdx];
+            checkedMobility[phaseIdx] = mobility[phaseIdx];
+        }
+
+        inputs.phasePresence = nullptr;
+        pipeline.run(n, classifier, inputs, outputs);
+        for (unsigned i = 0; i < n; ++i) {
+            if (classifier.cellClassOf(i) != phasePresence[i])
+                OPM_THROW(std::logic_error, "BlackOilCellClassifier: Wrong class of cell " << i);
+
+            for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                const auto& prop = props[phaseIdx][i];
+                const auto& propRef = checkedProps[phaseIdx][i];
+                if (prop.invB != propRef.invB
+                    || prop.mu != propRef.mu
+                    || prop.density != propRef.density
+                    || mobility[phaseIdx][i] != checkedMobility[phaseIdx][i])
+                    OPM_THROW(std::logic_error,
+                              "BlackOilPropertyPipeline: Wrong quantities of phase " << phaseIdx
+                              << " for cell " << i << " of class " << classifier.cellClassOf(i));
+            }
+        }
+
+        for (unsigned classIdx = 0; classIdx < Opm::BlackOilCellClassifier::numClasses; ++classIdx) {
+            const auto& cells = classifier.cellsOfClass(classIdx);
+            if (!std::is_sorted(cells.begin(), cells.end()))
+                OPM_THROW(std::logic_error,
+                          "BlackOilCellClassifier: The cells of class " << classIdx << " are not sorted");
+        }
+
+        // gas appears in some of the water cells and disappears from some of the cells
+        // which contain all phases
+        unsigned numChanged = 0;
+        for (unsigned i = 0; i < n; i += 50) {
+            phasePresence[i] = static_cast<unsigned char>(phasePresence[i] ^ (1 << gasPhaseIdx));
+            ++numChanged;
+        }
+        if (classifier.update(phasePresence.data()) != numChanged)
+            OPM_THROW(std::logic_error, "BlackOilCellClassifier: Wrong number of reclassified cells");
+    }
+}
+
+// make sure that the fused evaluation of the mobilities yields the same values and
+// derivatives as evaluating all quantities with the derivatives of all variables
+template <class Scalar>
+void testBlackOilPipelineMobilities()
+{
+    typedef Opm::FluidSystems::BlackOilInstance<Scalar> FluidSystem;
+    typedef LinearSaturationFunctions<Scalar> SaturationFunctions;
+    typedef Opm::BlackOilPropertyPipeline<Scalar, FluidSystem, SaturationFunctions> Pipeline;
+    typedef typename Pipeline::MobilityEvaluation Evaluation;
+
+    enum { numPhases = FluidSystem::numPhases };
+    enum { waterPhaseIdx = FluidSystem::waterPhaseIdx };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+    int numRegions = 2;
+    FluidSystem fluidSystem;
+    initTestBlackOilFluidSystem<Scalar, Scalar>(fluidSystem, numRegions);
+
+    unsigned n = 500;
+    std::vector<Scalar> T(n, 350.0), po(n), Sw(n), Sg(n), XoG(n, 0.0), XgO(n, 0.0);
+    std::vector<int> regionIdx(n);
+    std::vector<unsigned char> phasePresence(n);
+    for (unsigned i = 0; i < n; ++i) {
+        po[i] = (10.0 + 0.73*i)*1e5;
+        Sw[i] = 0.1 + 0.5*((i*7) % 13)/13.0;
+        Sg[i] = 0.3*((i*3) % 11)/11.0;
+        regionIdx[i] = i % numRegions;
+        phasePresence[i] = static_cast<unsigned char>((i % 5 == 0) ? (1 << waterPhaseIdx) : 0x7);
+    }
+
+    std::vector<Evaluation> mobility[numPhases], invBMobility[numPhases];
+    typename Pipeline::Inputs inputs = { T.data(), po.data(), Sw.data(), Sg.data(), XoG.data(), XgO.data(), regionIdx.data(),
+                                         phasePresence.data() };
+    typename Pipeline::MobilityOutputs outputs;
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        mobility[phaseIdx].resize(n);
+        invBMobility[phaseIdx].resize(n);
+        outputs.mobility[phaseIdx] = mobility[phaseIdx].data();
+        outputs.invBMobility[phaseIdx] = invBMobility[phaseIdx].data();
+    }
+
+    SaturationFunctions saturationFunctions;
+    Pipeline pipeline(fluidSystem, saturationFunctions);
+    pipeline.setTileSize(64);
+    pipeline.runMobilities(n, inputs, outputs);
+
+    for (unsigned i = 0; i < n; ++i) {
+        const Evaluation& TEval = Evaluation::createConstant(T[i]);
+        const Evaluation& SwEval = Evaluation::createVariable(Sw[i], Pipeline::waterSaturationVarIdx);
+        const Evaluation& SgEval = Evaluation::createVariable(Sg[i], Pipeline::gasSaturationVarIdx);
+        const Evaluation& poEval = Evaluation::createVariable(po[i], Pipeline::oilPressureVarIdx);
+        const Evaluation& XoGEval = Evaluation::createVariable(XoG[i], Pipeline::dissolutionVarIdx);
+        const Evaluation& XgOEval = Evaluation::createVariable(XgO[i], Pipeline::dissolutionVarIdx);
+
+        Evaluation krRef[numPhases];
+        krRef[waterPhaseIdx] = SwEval;
+        krRef[oilPhaseIdx] = 1 - SwEval - SgEval;
+        krRef[gasPhaseIdx] = SgEval;
+
+        Opm::BlackOilPhaseProperties<Evaluation> propsRef[numPhases];
+        propsRef[oilPhaseIdx] = fluidSystem.oilProperties(TEval, poEval, XoGEval, regionIdx[i]);
+        propsRef[waterPhaseIdx] =
+            fluidSystem.waterProperties(TEval, Evaluation(poEval - 1e5*(1 - SwEval)), regionIdx[i]);
+        propsRef[gasPhaseIdx] =
+            fluidSystem.gasProperties(TEval, Evaluation(poEval + 2e4*SgEval), XgOEval, regionIdx[i]);
+
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            bool isPresent = phasePresence[i] & (1 << phaseIdx);
+            Evaluation mobilityRef = 0.0;
+            Evaluation invBMobilityRef = 0.0;
+            if (isPresent) {
+                mobilityRef = krRef[phaseIdx]/propsRef[phaseIdx].mu;
+                invBMobilityRef = krRef[phaseIdx]*propsRef[phaseIdx].invBMu;
+            }
+
+            const Evaluation* values[2] = { &mobility[phaseIdx][i], &invBMobility[phaseIdx][i] };
+            const Evaluation* refs[2] = { &mobilityRef, &invBMobilityRef };
+            for (int quantityIdx = 0; quantityIdx < 2; ++quantityIdx) {
+                const Evaluation& val = *values[quantityIdx];
+                const Evaluation& ref = *refs[quantityIdx];
+                bool ok = std::abs(val.value - ref.value) <= 1e-12*std::abs(ref.value);
+                for (int varIdx = 0; varIdx < Pipeline::numMobilityVars; ++varIdx)
+                    ok = ok && (std::abs(val.derivatives[varIdx] - ref.derivatives[varIdx])
+                                <= 1e-12*std::abs(ref.derivatives[varIdx]) + 1e-30);
+                if (!ok)
+                    OPM_THROW(std::logic_error,
+                              "BlackOilPropertyPipeline: Wrong mobility " << quantityIdx
+                              << " of phase " << phaseIdx << " for cell " << i);
+            }
+        }
+    }
+}
+
+// the quantities of a phase which are required by BlackOilPropertyCache
+template <class Evaluation>
+struct BlackOilPvtFluidState
+{
+    typedef Evaluation Scalar;
+
+    const Evaluation& pressure(int /*phaseIdx*/) const
+    { return p; }
+
+    const Evaluation& temperature(int /*phaseIdx*/) const
+    { return T; }
+
+    const Evaluation& massFraction(int /*phaseIdx*/, int /*compIdx*/) const
+    { return X; }
+
+    Evaluation p;
+    Evaluation T;
+    Evaluation X;
+};
+
+// make sure that the Taylor expansions of the black-oil property cache are exact
+// within a table segment and that the PVT tables are evaluated outside of the
+// tolerances
+template <class Scalar, class Evaluation>
+void testBlackOilPropertyCache()
+{
+    typedef Opm::FluidSystems::BlackOilInstance<Scalar, Evaluation> FluidSystem;
+    typedef Opm::BlackOilPropertyCache<Scalar, FluidSystem, Evaluation> PropertyCache;
+    typedef BlackOilPvtFluidState<Evaluation> FluidState;
+
+    enum { numPhases = FluidSystem::numPhases };
+
+    int numRegions = 2;
+    FluidSystem fluidSystem;
+    initTestBlackOilFluidSystem<Scalar, Evaluation>(fluidSystem, numRegions);
+
+    PropertyCache cache;
+    cache.resize(2);
+    cache.setTolerances(/*pressure=*/1e5, /*massFraction=*/0.0);
+
+    typename FluidSystem::ParameterCache paramCache;
+    paramCache.setRegionIndex(1);
+
+    // the sampling points of the tables are 25 bar apart, starting at 1 bar. the
+    // water phase is not tabulated, so it is only used to check the decisions about
+    // reusing the expansion points
+    FluidState fs;
+    fs.T = 350.0;
+    fs.X = 0.0;
+    Scalar pBar[] = { 110.0, 110.0, 110.7, 109.2, 112.0, 111.5 };
+    bool reuse[] = { false, true, true, true, false, true };
+    for (unsigned i = 0; i < sizeof(pBar)/sizeof(pBar[0]); ++i) {
+        fs.p = Evaluation::createVariable(pBar[i]*1e5, 0);
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (cache.canReuse(fs, paramCache, phaseIdx, /*cellIdx=*/1) != reuse[i])
+                OPM_THROW(std::logic_error,
+                          "BlackOilPropertyCache: Wrong decision about reusing the expansion point");
+
+            const Evaluation& rho = cache.density(fluidSystem, fs, paramCache, phaseIdx, /*cellIdx=*/1);
+            const Evaluation& mu = cache.viscosity(fluidSystem, fs, paramCache, phaseIdx, /*cellIdx=*/1);
+            if (phaseIdx == FluidSystem::waterPhaseIdx)
+                continue;
+
+            const Evaluation& rhoRef = fluidSystem.density(fs, paramCache, phaseIdx);
+            const Evaluation& muRef = fluidSystem.viscosity(fs, paramCache, phaseIdx);
+            // the densities are tabulated, but the viscosities are the quotients of
+            // two tabulated quantities
+            if (std::abs(rho.value/rhoRef.value - 1) > 1e-10
+                || std::abs(rho.derivatives[0]/rhoRef.derivatives[0] - 1) > 1e-8
+                || std::abs(mu.value/muRef.value - 1) > 1e-4
+                || std::abs(mu.derivatives[0] - muRef.derivatives[0]) > 5e-2*std::abs(muRef.derivatives[0]) + 1e-20)
+                OPM_THROW(std::logic_error,
+                          "BlackOilPropertyCache: Wrong density or viscosity of phase " << phaseIdx
+                          << " at " << pBar[i] << " bar");
+        }
+    }
+
+    // the expansion point of a different PVT region or an invalidated one must not
+    // be used
+    fs.p = 111.5e5;
+    paramCache.setRegionIndex(0);
+    if (cache.canReuse(fs, paramCache, /*phaseIdx=*/0, /*cellIdx=*/1))
+        OPM_THROW(std::logic_error, "BlackOilPropertyCache: The PVT region was ignored");
+    paramCache.setRegionIndex(1);
+    cache.invalidate(1);
+    if (cache.canReuse(fs, paramCache, /*phaseIdx=*/0, /*cellIdx=*/1))
+        OPM_THROW(std::logic_error, "BlackOilPropertyCache: invalidate() is broken");
+}
+
+// make sure that the quantities stored by the parameter cache of the black-oil fluid
+// system are consistent with the fluid state which is passed to the fluid system
+template <class Scalar, class Evaluation>
+void testBlackOilParameterCache()
+{
+    typedef Opm::FluidSystems::BlackOilInstance<Scalar, Evaluation> FluidSystem;
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+    typedef BlackOilPvtFluidState<Evaluation> FluidState;
+
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+
+    FluidSystem fluidSystem;
+    FluidSystem otherFluidSystem;
+    initTestBlackOilFluidSystem<Scalar, Evaluation>(fluidSystem, /*numRegions=*/2);
+    initTestBlackOilFluidSystem<Scalar, Evaluation>(otherFluidSystem, /*numRegions=*/1, /*rhoRefOil0=*/900.0);
+
+    if (ParameterCache(/*regionIdx=*/1).regionIndex() != 1)
+        OPM_THROW(std::logic_error, "BlackOil parameter cache: The PVT region is ignored");
+
+    FluidState fs;
+    fs.T = 350.0;
+    fs.X = 0.0;
+
+    ParameterCache paramCache(/*regionIdx=*/1);
+    Scalar pBar[] = { 110.0, 110.0, 163.0 };
+    for (unsigned i = 0; i < sizeof(pBar)/sizeof(pBar[0]); ++i) {
+        // the second iteration uses the same pressure with different derivatives
+        fs.p = Evaluation::createVariable(pBar[i]*1e5, 0);
+        fs.p.derivatives[0] = 1.0 + i;
+
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            // the first call fills the cache, the second one must use it
+            for (int callIdx = 0; callIdx < 2; ++callIdx) {
+                ParameterCache refParamCache(/*regionIdx=*/1);
+                bool ok =
+                    fluidSystem.density(fs, paramCache, phaseIdx)
+                    == fluidSystem.density(fs, refParamCache, phaseIdx)
+                    && fluidSystem.viscosity(fs, paramCache, phaseIdx)
+                    == fluidSystem.viscosity(fs, refParamCache, phaseIdx);
+                for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                    ok = ok
+                        && fluidSystem.fugacityCoefficient(fs, paramCache, phaseIdx, compIdx)
+                        == fluidSystem.fugacityCoefficient(fs, refParamCache, phaseIdx, compIdx);
+                if (!ok)
+                    OPM_THROW(std::logic_error,
+                              "BlackOil parameter cache: Wrong quantities for phase " << phaseIdx
+                              << " at " << pBar[i] << " bar");
+            }
+
+            // scalar requests use the values of the cached evaluations
+            typedef BlackOilPvtFluidState<Scalar> ScalarFluidState;
+            ScalarFluidState scalarFs;
+            scalarFs.T = fs.T.value;
+            scalarFs.p = fs.p.value;
+            scalarFs.X = fs.X.value;
+            ParameterCache refParamCache(/*regionIdx=*/1);
+            if (fluidSystem.density(scalarFs, paramCache, phaseIdx)
+                != fluidSystem.density(scalarFs, refParamCache, phaseIdx))
+                OPM_THROW(std::logic_error,
+                          "BlackOil parameter cache: Wrong scalar density of phase " << phaseIdx);
+        }
+    }
+
+    // the cached quantities must neither be used for another PVT region nor for another
+    // fluid system object. the reference densities of the oil phase differ for the PVT
+    // regions.
+    const Evaluation& rhoo1 = fluidSystem.density(fs, paramCache, FluidSystem::oilPhaseIdx);
+    paramCache.setRegionIndex(0);
+    const Evaluation& rhoo0 = fluidSystem.density(fs, paramCache, FluidSystem::oilPhaseIdx);
+    const Evaluation& rhooOther = otherFluidSystem.density(fs, paramCache, FluidSystem::oilPhaseIdx);
+    if (rhoo0 == rhoo1
+        || rhooOther == rhoo0
+        || rhoo0 != fluidSystem.oilProperties(fs.T, fs.p, fs.X, /*regionIdx=*/0).density
+        || rhooOther != otherFluidSystem.oilProperties(fs.T, fs.p, fs.X, /*regionIdx=*/0).density)
+        OPM_THROW(std::logic_error,
+                  "BlackOil parameter cache: The quantities of another PVT region or "
+                  "another fluid system were used");
+}
+
+// make sure that only the PVT regions of the local cells need to be set up
+template <class Scalar>
+void testCompactPvtRegions()
+{
+    typedef Opm::FluidSystems::BlackOilInstance<Scalar> FluidSystem;
+
+    // the deck has seven PVT regions, but the local cells only use two of them
+    std::vector<int> pvtnum = { 5, 2, 2, 5, 5, 2 };
+    Opm::CompactRegionIndices regions;
+    regions.setRegionIndices(pvtnum, /*numRegions=*/7);
+    if (regions.numRegions() != 7
+        || regions.numUsedRegions() != 2
+        || regions.regionIndex(0) != 2
+        || regions.regionIndex(1) != 5
+        || regions.compactIndex(5) != 1
+        || regions.isUsed(3))
+        OPM_THROW(std::logic_error, "CompactRegionIndices: Wrong used regions");
+
+    std::vector<int> cellRegionIdx = pvtnum;
+    regions.compact(cellRegionIdx);
+    for (size_t cellIdx = 0; cellIdx < pvtnum.size(); ++cellIdx)
+        if (regions.regionIndex(cellRegionIdx[cellIdx]) != pvtnum[cellIdx])
+            OPM_THROW(std::logic_error, "CompactRegionIndices: Wrong compact index of cell " << cellIdx);
+
+    // converting the index of a region which is not used must fail
+    bool caught = false;
+    try {
+        std::vector<int> unusedRegionIdx(1, 3);
+        regions.compact(unusedRegionIdx);
+    }
+    catch (const std::runtime_error&) { caught = true; }
+    if (!caught)
+        OPM_THROW(std::logic_error, "CompactRegionIndices: An unused region was accepted");
+
+    // the fluid system only needs to know about the used regions
+    FluidSystem fluidSystem;
+    initTestBlackOilFluidSystem<Scalar, Scalar>(fluidSystem, regions.numUsedRegions());
+    for (size_t cellIdx = 0; cellIdx < pvtnum.size(); ++cellIdx) {
+        int compactIdx = cellRegionIdx[cellIdx];
+        Scalar rho = fluidSystem.referenceDensity(FluidSystem::oilPhaseIdx, compactIdx);
+        if (rho != 850.0 + 10.0*compactIdx)
+            OPM_THROW(std::logic_error, "CompactRegionIndices: Wrong PVT region of cell " << cellIdx);
+    }
+}
+
+// the saturation pressures of live oil and wet gas must invert the gas dissolution and
+// the oil vaporization factors. if these are not strictly increasing, the saturation
+// pressure is determined using the Newton method.
+template <class Scalar, class Evaluation>
+void testSaturationPressureInversion()
+{
+    typedef std::vector<std::pair<Scalar, Scalar> > SamplingPoints;
+
+    Scalar T = 300.0;
+    Scalar rhoRefOil = 800.0;
+    Scalar rhoRefGas = 1.0;
+    Scalar pMaxBar = 300.0;
+    Scalar pPeakBar = 250.0;
+
+    for (int monotone = 1; monotone >= 0; --monotone) {
+        SamplingPoints Rs, Bo, muo, Rv, Bg, mug;
+        for (int i = 0; i < 20; ++i) {
+            Scalar pBar = 1.0 + (pMaxBar - 1.0)*i/19;
+            Scalar p = pBar*1e5;
+
+            // without the monotonicity, the gas dissolution and the oil vaporization
+            // factors decrease above the peak pressure
+            Scalar factor = pBar;
+            if (!monotone && pBar > pPeakBar)
+                factor = pPeakBar - 0.5*(pBar - pPeakBar);
+
+            Rs.push_back(std::make_pair(p, 0.6*factor));
+            Bo.push_back(std::make_pair(p, 1.0 + 0.002*pBar));
+            muo.push_back(std::make_pair(p, 1e-3*(1.5 - 0.002*pBar)));
+            Rv.push_back(std::make_pair(p, 2e-6*factor));
+            Bg.push_back(std::make_pair(p, 1.0/pBar));
+            mug.push_back(std::make_pair(p, 1.2e-5 + 2e-8*pBar));
+        }
+
+        Opm::LiveOilPvt<Scalar, Evaluation> liveOilPvt;
+        liveOilPvt.setNumRegions(1);
+        liveOilPvt.setReferenceDensities(rhoRefOil, 1000.0, rhoRefGas, 0);
+        liveOilPvt.setSaturatedOilGasDissolutionFactor(0, Rs);
+        liveOilPvt.setSaturatedOilFormationVolumeFactor(0, Bo);
+        liveOilPvt.setSaturatedOilViscosity(0, muo);
+        liveOilPvt.initEnd();
+
+        Opm::WetGasPvt<Scalar, Evaluation> wetGasPvt;
+        wetGasPvt.setNumRegions(1);
+        wetGasPvt.setReferenceDensities(rhoRefOil, 1000.0, rhoRefGas, 0);
+        wetGasPvt.setSaturatedGasOilVaporizationFactor(0, Rv);
+        wetGasPvt.setSaturatedGasFormationVolumeFactor(0, Bg);
+        wetGasPvt.setSaturatedGasViscosity(0, mug);
+        wetGasPvt.initEnd();
+
+        if (liveOilPvt.hasSaturationPressureTable(0) != bool(monotone))
+            OPM_THROW(std::logic_error, "LiveOilPvt: Wrong choice of the saturation pressure method");
+        if (wetGasPvt.hasSaturationPressureTable(0) != bool(monotone))
+            OPM_THROW(std::logic_error, "WetGasPvt: Wrong choice of the saturation pressure method");
+
+        const Opm::OilPvtInterface<Scalar, Evaluation>& oilPvt = liveOilPvt;
+        const Opm::GasPvtInterface<Scalar, Evaluation>& gasPvt = wetGasPvt;
+
+        // only use the part of the curves below the peak for which the inverse is unique
+        for (int i = 0; i < 50; ++i) {
+            Scalar factor = 5.0 + (pPeakBar*0.9 - 5.0)*i/49;
+
+            Scalar RsValue = 0.6*factor;
+            Scalar XoG = RsValue*rhoRefGas/(rhoRefOil + RsValue*rhoRefGas);
+            Scalar poSat = oilPvt.oilSaturationPressure(0, T, XoG);
+            Scalar RsSat = oilPvt.gasDissolutionFactor(0, T, poSat);
+            if (std::abs(RsSat - RsValue) > 1e-8*RsValue)
+                OPM_THROW(std::logic_error,
+                          "LiveOilPvt: Rs(pSat(Rs)) = " << RsSat << " != " << RsValue);
+
+            Scalar RvValue = 2e-6*factor;
+            Scalar XgO = RvValue*rhoRefOil/(rhoRefGas + RvValue*rhoRefOil);
+            Scalar pgSat = gasPvt.gasSaturationPressure(0, T, XgO);
+            Scalar RvSat = gasPvt.oilVaporizationFactor(0, T, pgSat);
+            if (std::abs(RvSat - RvValue) > 1e-8*RvValue)
+                OPM_THROW(std::logic_error,
+                          "WetGasPvt: Rv(pSat(Rv)) = " << RvSat << " != " << RvValue);
+
+            // the derivatives of the round trip must be the ones of the conversion from
+            // the mass fraction to the dissolution factor
+            if (!monotone)
+                continue;
+
+            const Evaluation& XoGEval = Evaluation::createVariable(XoG, 0);
+            const Evaluation& RsEval =
+                oilPvt.gasDissolutionFactor(0, Evaluation(T), oilPvt.oilSaturationPressure(0, Evaluation(T), XoGEval));
+            Scalar dRs_dXoG = rhoRefOil/rhoRefGas/((1 - XoG)*(1 - XoG));
+            if (std::abs(RsEval.derivatives[0] - dRs_dXoG) > 1e-6*dRs_dXoG)
+                OPM_THROW(std::logic_error, "LiveOilPvt: Wrong derivative of the saturation pressure");
+
+            const Evaluation& XgOEval = Evaluation::createVariable(XgO, 0);
+            const Evaluation& RvEval =
+                gasPvt.oilVaporizationFactor(0, Evaluation(T), gasPvt.gasSaturationPressure(0, Evaluation(T), XgOEval));
+            Scalar dRv_dXgO = rhoRefGas/rhoRefOil/((1 - XgO)*(1 - XgO));
+            if (std::abs(RvEval.derivatives[0] - dRv_dXgO) > 1e-6*dRv_dXgO)
+                OPM_THROW(std::logic_error, "WetGasPvt: Wrong derivative of the saturation pressure");
+        }
+    }
+}
+
+// the batched methods of the oil PVT multiplexer must yield the same results as the
+// evaluation of each cell if the cells of several PVT regions are interleaved
+template <class Scalar, class Evaluation>
+void testOilPvtBatch()
+{
+    typedef std::vector<std::pair<Scalar, Scalar> > SamplingPoints;
+
+    int numRegions = 3;
+    auto liveOilPvt = std::make_shared<Opm::LiveOilPvt<Scalar, Evaluation> >();
+    liveOilPvt->setNumRegions(numRegions);
+    for (int regionIdx = 0; regionIdx < numRegions; ++regionIdx) {
+        Scalar alpha = 1.0 + 0.25*regionIdx;
+
+        SamplingPoints Rs, Bo, muo;
+        for (int i = 0; i < 20; ++i) {
+            Scalar pBar = 1.0 + 299.0*i/19;
+            Scalar p = pBar*1e5;
+            Rs.push_back(std::make_pair(p, 0.6*alpha*pBar));
+            Bo.push_back(std::make_pair(p, 1.0 + 0.002*alpha*pBar));
+            muo.push_back(std::make_pair(p, 1e-3*(1.5 - 0.002*pBar)/alpha));
+        }
+
+        liveOilPvt->setReferenceDensities(800.0 + 10*regionIdx, 1000.0, 1.0, regionIdx);
+        liveOilPvt->setSaturatedOilGasDissolutionFactor(regionIdx, Rs);
+        liveOilPvt->setSaturatedOilFormationVolumeFactor(regionIdx, Bo);
+        liveOilPvt->setSaturatedOilViscosity(regionIdx, muo);
+    }
+    liveOilPvt->initEnd();
+
+    Opm::OilPvtMultiplexer<Scalar, Evaluation> oilPvt;
+    oilPvt.setPvt(liveOilPvt);
+    if (oilPvt.approach() != Opm::LiveOilPvtApproach)
+        OPM_THROW(std::logic_error, "OilPvtMultiplexer: Wrong approach for live oil");
+
+    // interleave the regions of the cells
+    int numCells = 50;
+    std::vector<int> cellRegionIdx(numCells);
+    for (int cellIdx = 0; cellIdx < numCells; ++cellIdx)
+        cellRegionIdx[cellIdx] = (cellIdx*7 + cellIdx/5) % numRegions;
+
+    Opm::PvtRegionOrdering ordering;
+    ordering.setRegionIndices(cellRegionIdx);
+    if (ordering.numRegions() != numRegions
+        || ordering.numCells() != static_cast<size_t>(numCells))
+        OPM_THROW(std::logic_error, "PvtRegionOrdering: Wrong number of regions or cells");
+
+    std::vector<int> numVisits(numCells, 0);
+    for (int regionIdx = 0; regionIdx < numRegions; ++regionIdx) {
+        const unsigned* cells = ordering.regionCells(regionIdx);
+        for (size_t i = 0; i < ordering.numCells(regionIdx); ++i) {
+            if (cellRegionIdx[cells[i]] != regionIdx || (i > 0 && cells[i] <= cells[i - 1]))
+                OPM_THROW(std::logic_error, "PvtRegionOrdering: Cell " << cells[i]
+                          << " is misplaced in region " << regionIdx);
+            ++ numVisits[cells[i]];
+        }
+    }
+    if (std::count(numVisits.begin(), numVisits.end(), 1) != numCells)
+        OPM_THROW(std::logic_error, "PvtRegionOrdering: Cells are missing or duplicated");
+
+    std::vector<Evaluation> T(numCells), p(numCells), XoG(numCells);
+    for (int cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        T[cellIdx] = Evaluation(300.0 + cellIdx);
+        p[cellIdx] = Evaluation::createVariable(20e5 + cellIdx*5e5, 0);
+
+        // use some undersaturated and some saturated cells
+        const Evaluation& XoGSat =
+            oilPvt.saturatedOilGasMassFraction(cellRegionIdx[cellIdx], T[cellIdx], p[cellIdx]);
+        XoG[cellIdx] = XoGSat*(0.5 + 0.5*(cellIdx % 2));
+        XoG[cellIdx].derivatives[1] = 1.0;
+    }
+
+    std::vector<Opm::BlackOilPhaseProperties<Evaluation> > props(numCells);
+    std::vector<Evaluation> mu(numCells), Bo(numCells), rho(numCells);
+    oilPvt.propertiesBatch(ordering, T.data(), p.data(), XoG.data(), props.data());
+    oilPvt.viscosityBatch(ordering, T.data(), p.data(), XoG.data(), mu.data());
+    oilPvt.formationVolumeFactorBatch(ordering, T.data(), p.data(), XoG.data(), Bo.data());
+    oilPvt.densityBatch(ordering, T.data(), p.data(), XoG.data(), rho.data());
+
+    // the batches are dispatched statically. compare them with the virtual methods of
+    // the PVT interface
+    const Opm::OilPvtInterface<Scalar, Evaluation>& oilPvtIface = *liveOilPvt;
+    for (int cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        int regionIdx = cellRegionIdx[cellIdx];
+        const auto& refProps = oilPvtIface.properties(regionIdx, T[cellIdx], p[cellIdx], XoG[cellIdx]);
+        const Evaluation& refMu = oilPvtIface.viscosity(regionIdx, T[cellIdx], p[cellIdx], XoG[cellIdx]);
+        const Evaluation& refBo = oilPvtIface.formationVolumeFactor(regionIdx, T[cellIdx], p[cellIdx], XoG[cellIdx]);
+        const Evaluation& refRho = oilPvtIface.density(regionIdx, T[cellIdx], p[cellIdx], XoG[cellIdx]);
+
+        const Evaluation* values[] = { &props[cellIdx].invB, &props[cellIdx].mu,
+                                       &props[cellIdx].invBMu, &props[cellIdx].density,
+                                       &mu[cellIdx], &Bo[cellIdx], &rho[cellIdx] };
+        const Evaluation* refValues[] = { &refProps.invB, &refProps.mu,
+                                          &refProps.invBMu, &refProps.density,
+                                          &refMu, &refBo, &refRho };
+        for (int qIdx = 0; qIdx < 7; ++qIdx) {
+            const Evaluation& value = *values[qIdx];
+            const Evaluation& refValue = *refValues[qIdx];
+            for (int varIdx = -1; varIdx < Evaluation::size; ++varIdx) {
+                Scalar x = (varIdx < 0) ? value.value : value.derivatives[varIdx];
+                Scalar y = (varIdx < 0) ? refValue.value : refValue.derivatives[varIdx];
+                if (std::abs(x - y) > 1e-12*std::max<Scalar>(1.0, std::abs(y)))
+                    OPM_THROW(std::logic_error, "OilPvtMultiplexer: The batched quantity " << qIdx
+                              << " of cell " << cellIdx << " deviates from the cell-wise one: "
+                              << x << " != " << y);
+            }
+        }
+    }
+}
+
+// set up the PVT objects from raw arrays and from the arrays read back from a file
+template <class Scalar, class Evaluation>
+void testPvtTableArrays()
+{
+    typedef Opm::PvtTableArrays<Scalar> Arrays;
+    Scalar T = 300.0;
+
+    // PVTO: three gas dissolution factors. the first only has the saturated row, so it
+    // is extended using the rows of the second one
+    Arrays pvto;
+    pvto.setNumRegions(1);
+    auto& o = pvto.region(0);
+    o.outer = { 10.0, 50.0, 100.0 };
+    o.rowOffsets = { 0, 1, 4, 6 };
+    o.inner = { 50e5, 100e5, 200e5, 300e5, 200e5, 400e5 };
+    o.formationVolumeFactor = { 1.05, 1.15, 1.14, 1.13, 1.30, 1.28 };
+    o.viscosity = { 2e-3, 1.5e-3, 1.6e-3, 1.7e-3, 1e-3, 1.1e-3 };
+
+    // PVTG: two gas pressures with decreasing oil vaporization factors
+    Arrays pvtg;
+    pvtg.setNumRegions(1);
+    auto& g = pvtg.region(0);
+    g.outer = { 100e5, 300e5 };
+    g.rowOffsets = { 0, 2, 4 };
+    g.inner = { 1e-4, 0.0, 3e-4, 0.0 };
+    g.formationVolumeFactor = { 0.010, 0.0099, 0.004, 0.0039 };
+    g.viscosity = { 1.5e-5, 1.4e-5, 2.5e-5, 2.4e-5 };
+
+    // PVDO and PVDG
+    Arrays pvdo, pvdg;
+    pvdo.setNumRegions(1);
+    pvdo.region(0).inner = { 1e5, 100e5, 300e5 };
+    pvdo.region(0).formationVolumeFactor = { 1.2, 1.18, 1.15 };
+    pvdo.region(0).viscosity = { 1e-3, 1.05e-3, 1.1e-3 };
+    pvdg.setNumRegions(1);
+    pvdg.region(0).inner = { 1e5, 100e5, 300e5 };
+    pvdg.region(0).formationVolumeFactor = { 1.0, 0.01, 0.004 };
+    pvdg.region(0).viscosity = { 1.2e-5, 1.6e-5, 2.5e-5 };
+
+    const char* fileName = "test_fluidsystems_pvt.tables";
+    Arrays* arrays[] = { &pvto, &pvtg, &pvdo, &pvdg };
+    Arrays loaded[4];
+    for (int i = 0; i < 4; ++i) {
+        arrays[i]->save(fileName, "test_fluidsystems");
+        if (loaded[i].load(fileName, "other key")
+            || !loaded[i].load(fileName, "test_fluidsystems")
+            || loaded[i].numRegions() != 1
+            || loaded[i].region(0).inner != arrays[i]->region(0).inner
+            || loaded[i].region(0).rowOffsets != arrays[i]->region(0).rowOffsets)
+            OPM_THROW(std::logic_error, "PvtTableArrays: The tables could not be read back");
+    }
+    std::remove(fileName);
+
+    for (int i = 0; i < 2; ++i) {
+        const Arrays* tables = (i == 0) ? arrays[0] : &loaded[0];
+        Opm::LiveOilPvt<Scalar, Evaluation> liveOilPvt;
+        liveOilPvt.setNumRegions(1);
+        liveOilPvt.setReferenceDensities(800.0, 1000.0, 1.0, 0);
+        tables->setPvtoTables(liveOilPvt);
+        liveOilPvt.initEnd();
+
+        // the saturated states and the extended undersaturated table
+        for (int outerIdx = 0; outerIdx < 3; ++outerIdx) {
+            int rowIdx = o.rowOffsets[outerIdx];
+            Scalar Bo = liveOilPvt.formationVolumeFactorFromRs(0, T, o.inner[rowIdx], o.outer[outerIdx]);
+            if (std::abs(Bo - o.formationVolumeFactor[rowIdx]) > 1e-10)
+                OPM_THROW(std::logic_error, "LiveOilPvt: Wrong saturated formation volume factor");
+        }
+        Scalar Bo = liveOilPvt.formationVolumeFactorFromRs(0, T, Scalar(50e5*2), o.outer[0]);
+        if (std::abs(Bo - 1.05*1.14/1.15) > 1e-10)
+            OPM_THROW(std::logic_error, "LiveOilPvt: Wrong extension of an undersaturated table");
+
+        // the fugacity coefficients only depend on the reference densities of the PVT
+        // object, not on the ones of the default fluid system
+        typedef Opm::FluidSystems::BlackOil<Scalar, Evaluation> FluidSystem;
+        Scalar MG = Opm::Constants<Scalar>::R*FluidSystem::surfaceTemperature*1.0/FluidSystem::surfacePressure;
+        Scalar MO = 175e-3;
+        Scalar pFug = o.outer[1];
+        const Opm::OilPvtInterface<Scalar, Evaluation>& liveOilPvtIface = liveOilPvt;
+        Scalar RsSat = liveOilPvtIface.gasDissolutionFactor(0, T, pFug);
+        Scalar XoGSat = RsSat*1.0/(800.0 + RsSat*1.0);
+        Scalar xoGSat = XoGSat*(MO/(1 + XoGSat*(MO/MG - 1)))/MG;
+        Scalar phi_oG = liveOilPvtIface.fugacityCoefficient(0, T, pFug, FluidSystem::gasCompIdx);
+        if (std::abs(phi_oG - 1.0/xoGSat) > 1e-10*std::abs(phi_oG))
+            OPM_THROW(std::logic_error, "LiveOilPvt: Wrong fugacity coefficient of the gas component");
+
+        tables = (i == 0) ? arrays[1] : &loaded[1];
+        Opm::WetGasPvt<Scalar, Evaluation> wetGasPvt;
+        wetGasPvt.setNumRegions(1);
+        wetGasPvt.setReferenceDensities(800.0, 1000.0, 1.0, 0);
+        tables->setPvtgTables(wetGasPvt);
+        wetGasPvt.initEnd();
+        for (int outerIdx = 0; outerIdx < 2; ++outerIdx) {
+            int rowIdx = g.rowOffsets[outerIdx];
+            const Opm::GasPvtInterface<Scalar, Evaluation>& gasPvt = wetGasPvt;
+            Scalar Rv = gasPvt.oilVaporizationFactor(0, T, g.outer[outerIdx]);
+            Scalar Bg = wetGasPvt.saturatedFormationVolumeFactor(0, T, g.outer[outerIdx]);
+            if (std::abs(Rv - g.inner[rowIdx]) > 1e-14
+                || std::abs(Bg - g.formationVolumeFactor[rowIdx]) > 1e-10)
+                OPM_THROW(std::logic_error, "WetGasPvt: Wrong saturated state");
+        }
+
+        const Opm::GasPvtInterface<Scalar, Evaluation>& wetGasPvtIface = wetGasPvt;
+        pFug = g.outer[1];
+        Scalar RvSat = wetGasPvtIface.oilVaporizationFactor(0, T, pFug);
+        Scalar XgOSat = RvSat*800.0/(1.0 + RvSat*800.0);
+        Scalar xgOSat = XgOSat*(MO/(1 + (1 - XgOSat)*(MO/MG - 1)))/MO;
+        Scalar phi_gO = wetGasPvtIface.fugacityCoefficient(0, T, pFug, FluidSystem::oilCompIdx);
+        if (std::abs(phi_gO - 20e3/pFug/xgOSat) > 1e-10*std::abs(phi_gO))
+            OPM_THROW(std::logic_error, "WetGasPvt: Wrong fugacity coefficient of the oil component");
+
+        tables = (i == 0) ? arrays[2] : &loaded[2];
+        Opm::DeadOilPvt<Scalar, Evaluation> deadOilPvt;
+        deadOilPvt.setNumRegions(1);
+        deadOilPvt.setReferenceDensities(800.0, 1000.0, 1.0, 0);
+        tables->setPvdoTables(deadOilPvt);
+        deadOilPvt.initEnd();
+
+        tables = (i == 0) ? arrays[3] : &loaded[3];
+        Opm::DryGasPvt<Scalar, Evaluation> dryGasPvt;
+        dryGasPvt.setNumRegions(1);
+        dryGasPvt.setReferenceDensities(800.0, 1000.0, 1.0, 0);
+        tables->setPvdgTables(dryGasPvt);
+        dryGasPvt.initEnd();
+        const Opm::OilPvtInterface<Scalar, Evaluation>& oilPvt = deadOilPvt;
+        const Opm::GasPvtInterface<Scalar, Evaluation>& gasPvt = dryGasPvt;
+        for (int rowIdx = 0; rowIdx < 3; ++rowIdx) {
+            Scalar p = pvdo.region(0).inner[rowIdx];
+            Scalar Bo = oilPvt.formationVolumeFactor(0, T, p, Scalar(0.0));
+            Scalar muo = oilPvt.viscosity(0, T, p, Scalar(0.0));
+            Scalar Bg = gasPvt.formationVolumeFactor(0, T, p, Scalar(0.0));
+            if (std::abs(Bo - pvdo.region(0).formationVolumeFactor[rowIdx]) > 1e-10
+                || std::abs(muo - pvdo.region(0).viscosity[rowIdx]) > 1e-12
+                || std::abs(Bg - pvdg.region(0).formationVolumeFactor[rowIdx]) > 1e-10)
+                OPM_THROW(std::logic_error, "DeadOilPvt/DryGasPvt: Wrong tabulated values");
+        }
+    }
+}
+
+// resample the undersaturated PVT tables onto uniform grids
+template <class Scalar, class Evaluation>
+void testUniformPvtResampling()
+{
+    Scalar T = 300.0;
+
+    const Scalar Rs[] = { 10.0, 50.0, 100.0 };
+    const int rowOffsets[] = { 0, 3, 6, 8 };
+    const Scalar po[] = { 50e5, 150e5, 250e5, 100e5, 200e5, 300e5, 200e5, 400e5 };
+    const Scalar Bo[] = { 1.05, 1.04, 1.035, 1.15, 1.14, 1.13, 1.30, 1.28 };
+    const Scalar muo[] = { 2e-3, 2.1e-3, 2.3e-3, 1.5e-3, 1.6e-3, 1.7e-3, 1e-3, 1.1e-3 };
+
+    Opm::LiveOilPvt<Scalar, Evaluation> origOilPvt, resampledOilPvt;
+    Opm::LiveOilPvt<Scalar, Evaluation>* oilPvts[] = { &origOilPvt, &resampledOilPvt };
+    for (auto* oilPvt : oilPvts) {
+        oilPvt->setNumRegions(1);
+        oilPvt->setReferenceDensities(800.0, 1000.0, 1.0, 0);
+        if (oilPvt == &resampledOilPvt)
+            oilPvt->setUniformTableResolution(40, 60);
+        oilPvt->setPvtoArrays(0, 3, Rs, rowOffsets, po, Bo, muo);
+        oilPvt->initEnd();
+    }
+
+    Scalar maxError = resampledOilPvt.maxResamplingError();
+    if (origOilPvt.maxResamplingError() != 0.0 || !(maxError > 0.0) || maxError > 1e-2)
+        OPM_THROW(std::logic_error, "LiveOilPvt: Wrong resampling error " << maxError);
+
+    // the original sampling points are reproduced within the error bound. the bound
+    // is relative to the largest value, i.e., to the one of 1/(B_o mu_o)
+    for (int outerIdx = 0; outerIdx < 3; ++outerIdx) {
+        for (int rowIdx = rowOffsets[outerIdx]; rowIdx < rowOffsets[outerIdx + 1]; ++rowIdx) {
+            const auto& props = resampledOilPvt.propertiesFromRs(0, T, po[rowIdx], Rs[outerIdx]);
+            if (std::abs(props.invB - 1/Bo[rowIdx]) > maxError*1e3
+                || std::abs(props.invBMu - 1/(Bo[rowIdx]*muo[rowIdx])) > maxError*1e3)
+                OPM_THROW(std::logic_error, "LiveOilPvt: Wrong resampled table");
+        }
+    }
+
+    // outside of the uniform grid, the original tables are used
+    Evaluation p = 500e5;
+    Evaluation RsEval = Opm::MathToolbox<Evaluation>::createVariable(80.0, 0);
+    const auto& mu1 = origOilPvt.viscosityFromRs(0, Evaluation(T), p, RsEval);
+    const auto& mu2 = resampledOilPvt.viscosityFromRs(0, Evaluation(T), p, RsEval);
+    if (mu1 != mu2)
+        OPM_THROW(std::logic_error, "LiveOilPvt: The original tables are not used for extrapolation");
+
+    // within the grid, the derivatives are the ones of a bilinear interpolation, i.e.,
+    // they are close to the ones of the original tables except at their kinks
+    p = 220e5;
+    const auto& B1 = origOilPvt.formationVolumeFactorFromRs(0, Evaluation(T), p, RsEval);
+    const auto& B2 = resampledOilPvt.formationVolumeFactorFromRs(0, Evaluation(T), p, RsEval);
+    if (std::abs(B1.value - B2.value) > 1e-3
+        || std::abs(B1.derivatives[0] - B2.derivatives[0]) > 1e-2*std::abs(B1.derivatives[0]))
+        OPM_THROW(std::logic_error, "LiveOilPvt: Wrong resampled formation volume factor");
+
+    // if the resampled tables are disabled, the original ones are used everywhere
+    resampledOilPvt.setEnableResampledTables(false);
+    const auto& B3 = resampledOilPvt.formationVolumeFactorFromRs(0, Evaluation(T), p, RsEval);
+    resampledOilPvt.setEnableResampledTables(true);
+    if (B3 != B1 || resampledOilPvt.formationVolumeFactorFromRs(0, Evaluation(T), p, RsEval) != B2)
+        OPM_THROW(std::logic_error, "LiveOilPvt: The resampled tables are not disabled");
+
+    // the same for wet gas. the columns of the pressures have different lengths
+    const Scalar pg[] = { 100e5, 300e5 };
+    const int gasRowOffsets[] = { 0, 3, 5 };
+    const Scalar Rv[] = { 1e-4, 0.5e-4, 0.0, 3e-4, 0.0 };
+    const Scalar Bg[] = { 0.010, 0.00995, 0.0099, 0.004, 0.0039 };
+    const Scalar mug[] = { 1.5e-5, 1.45e-5, 1.4e-5, 2.5e-5, 2.4e-5 };
+
+    Opm::WetGasPvt<Scalar, Evaluation> origGasPvt, resampledGasPvt;
+    Opm::WetGasPvt<Scalar, Evaluation>* gasPvts[] = { &origGasPvt, &resampledGasPvt };
+    for (auto* gasPvt : gasPvts) {
+        gasPvt->setNumRegions(1);
+        gasPvt->setReferenceDensities(800.0, 1000.0, 1.0, 0);
+        if (gasPvt == &resampledGasPvt)
+            gasPvt->setUniformTableResolution(7, 9);
+        gasPvt->setPvtgArrays(0, 2, pg, gasRowOffsets, Rv, Bg, mug);
+        gasPvt->initEnd();
+    }
+
+    maxError = resampledGasPvt.maxResamplingError();
+    if (!(maxError > 0.0) || maxError > 1e-2)
+        OPM_THROW(std::logic_error, "WetGasPvt: Wrong resampling error " << maxError);
+    for (int outerIdx = 0; outerIdx < 2; ++outerIdx) {
+        for (int rowIdx = gasRowOffsets[outerIdx]; rowIdx < gasRowOffsets[outerIdx + 1]; ++rowIdx) {
+            Scalar Bg1 = origGasPvt.formationVolumeFactorFromRv(0, T, pg[outerIdx], Rv[rowIdx]);
+            Scalar Bg2 = resampledGasPvt.formationVolumeFactorFromRv(0, T, pg[outerIdx], Rv[rowIdx]);
+            if (std::abs(1/Bg1 - 1/Bg2) > maxError*300)
+                OPM_THROW(std::logic_error, "WetGasPvt: Wrong resampled table");
+        }
+    }
+}
+
 class TestAdTag;
 
 int main(int argc, char **argv)
@@ -237,6 +2091,20 @@ int main(int argc, char **argv)
     // ensure that all fluid states are API-compliant
     testAllFluidStates<Scalar>();
     testAllFluidStates<Evaluation>();
+    testSameTypeAssign<Scalar>();
+    testSameTypeAssign<Evaluation>();
+    testBlackOilFluidState<Scalar, Evaluation>();
+    testBlackOilWaterOilFluidSystem<Scalar>();
+    testFluidStateArray<Scalar>();
+    testBlackOilPropertyPipeline<Scalar>();
+    testBlackOilPipelineMobilities<Scalar>();
+    testBlackOilPropertyCache<Scalar, Evaluation>();
+    testBlackOilParameterCache<Scalar, Evaluation>();
+    testCompactPvtRegions<Scalar>();
+    testPvtTableArrays<Scalar, Evaluation>();
+    testSaturationPressureInversion<Scalar, Evaluation>();
+    testOilPvtBatch<Scalar, Evaluation>();
+    testUniformPvtResampling<Scalar, Evaluation>();
 
     // ensure that all fluid systems are API-compliant: Each fluid system must be usable
     // for both, scalars and function evaluations. The fluid systems for function
@@ -245,5 +2113,30 @@ int main(int argc, char **argv)
     testAllFluidSystems<Scalar, Evaluation>();
     testAllFluidSystems<Scalar, Evaluation, Scalar>();
 
+    testH2OParameterCache<Scalar, Evaluation>();
+    testBrineCO2MoleFractionTables<Scalar, Evaluation>();
+    testBinaryCoeffTemperatureTables<Scalar, Evaluation>();
+    testTabulatedComponents<Scalar,
+                            Opm::FluidSystems::H2OAirMesitylene<Scalar>,
+                            Opm::FluidSystems::H2OAirMesitylene<Scalar, /*tabulateComponents=*/true> >();
+    testTabulatedComponents<Scalar,
+                            Opm::FluidSystems::H2OAirXylene<Scalar>,
+                            Opm::FluidSystems::H2OAirXylene<Scalar, /*tabulateComponents=*/true> >();
+
+    {   typedef Opm::FluidSystems::BrineCO2<Scalar, Opm::FluidSystemsTest::CO2Tables> FluidSystem;
+        FluidSystem::init(/*tempMin=*/300.0, /*tempMax=*/340.0, /*nTemp=*/41,
+                          /*pressMin=*/1e6, /*pressMax=*/30e6, /*nPress=*/300);
+        testIsothermalFluidSystem<Scalar, Evaluation, FluidSystem>(320.0, 1e6, 30e6);
+        testComputeAll<Scalar, FluidSystem>(310.0, 10e6);
+        testLazyFluidState<Scalar, FluidSystem>(310.0, 10e6);
+        testBrineCO2ParameterCache<Scalar, Evaluation>(); }
+
+    {   typedef Opm::FluidSystems::H2ON2<Scalar, /*enableComplexRelations=*/true> FluidSystem;
+        FluidSystem::init(/*tempMin=*/300.0, /*tempMax=*/340.0, /*nTemp=*/41,
+                          /*pressMin=*/1e5, /*pressMax=*/20e6, /*nPress=*/200);
+        testIsothermalFluidSystem<Scalar, Evaluation, FluidSystem>(320.0, 1e5, 20e6);
+        testComputeAll<Scalar, FluidSystem>(310.0, 1e6);
+        testLazyFluidState<Scalar, FluidSystem>(310.0, 1e6); }
+
     return 0;
 }
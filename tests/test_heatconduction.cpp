@@ -0,0 +1,101 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief This is the unit test for the heat conduction laws.
+ */
+#include "config.h"
+
+#include <opm/material/heatconduction/Somerton.hpp>
+#include <opm/material/fluidsystems/Spe5FluidSystem.hpp>
+#include <opm/material/fluidstates/CompositionalFluidState.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+typedef double Scalar;
+
+// the batched Somerton law must yield the same heat conductivities as the cell-wise one
+template <class FluidSystem>
+bool testSomertonBatch()
+{
+    enum { numPhases = FluidSystem::numPhases };
+
+    typedef Opm::Somerton<FluidSystem, Scalar> HeatConductionLaw;
+    typedef typename HeatConductionLaw::Params Params;
+    typedef Opm::CompositionalFluidState<Scalar, FluidSystem> FluidState;
+
+    // the saturations cover the range of the regularized square root, the boundaries
+    // and some values which need to be clamped
+    const Scalar sampleSaturations[] = {
+        -0.1, 0.0, 1e-4, 2.5e-3, 0.0099, 0.01, 0.0101, 0.05, 0.3, 0.5, 0.77, 0.999, 1.0, 1.2
+    };
+    const size_t numSamples = sizeof(sampleSaturations)/sizeof(sampleSaturations[0]);
+
+    // the cells use different parameters and combinations of the sample saturations
+    size_t n = 3*numSamples;
+    std::vector<Params> params(n);
+    std::vector<const Params*> paramPtrs(n);
+    std::vector<std::vector<Scalar> > saturations(numPhases, std::vector<Scalar>(n));
+    std::vector<const Scalar*> saturationPtrs(numPhases);
+    for (size_t i = 0; i < n; ++i) {
+        params[i].setVacuumLambda(0.5 + 0.1*(i % 5));
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            params[i].setFullySaturatedLambda(phaseIdx, 1.0 + 0.7*phaseIdx + 0.05*(i % 7));
+            saturations[phaseIdx][i] = sampleSaturations[(i + 5*phaseIdx) % numSamples];
+        }
+        paramPtrs[i] = &params[i];
+    }
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+        saturationPtrs[phaseIdx] = saturations[phaseIdx].data();
+
+    std::vector<Scalar> lambda(n);
+    HeatConductionLaw::heatConductivityBatch(paramPtrs.data(), saturationPtrs.data(), lambda.data(), n);
+
+    for (size_t i = 0; i < n; ++i) {
+        FluidState fluidState;
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            fluidState.setSaturation(phaseIdx, saturations[phaseIdx][i]);
+
+        Scalar lambdaRef = HeatConductionLaw::heatConductivity(params[i], fluidState);
+        if (std::abs(lambda[i] - lambdaRef) > 1e-14*std::max<Scalar>(1.0, std::abs(lambdaRef))) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": the batched heat conductivity of cell "
+                      << i << " is " << lambda[i] << " instead of " << lambdaRef << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    // the SPE-5 fluid system exhibits two liquid phases and a gas phase
+    typedef Opm::FluidSystems::Spe5<Scalar> FluidSystem;
+
+    if (!testSomertonBatch<FluidSystem>())
+        return 1;
+
+    return 0;
+}
@@ -112,6 +112,31 @@ void checkImmiscibleFlash(const FluidState &fsRef,
 
     // compare the "flashed" fluid state with the reference one
     checkSame<Scalar>(fsRef, fsFlash);
+
+    // for two phases, the flash is a scalar root finding problem which must not
+    // require more iterations than the Newton method
+    FluidState fsTry;
+    fsTry.setTemperature(fsRef.temperature(/*phaseIdx=*/0));
+    ImmiscibleFlash::guessInitial(fsTry, paramCache, globalMolarities);
+    const auto& status =
+        ImmiscibleFlash::template trySolve<MaterialLaw>(fsTry, paramCache, matParams, globalMolarities);
+    if (!status.converged() || status.iterations > 20)
+        std::cout << "flash did not converge within 20 iterations: " << status.iterations << "\n";
+    checkSame<Scalar>(fsRef, fsTry);
+
+    // the flashed fluid state must be recognized as a solution if it is used as the
+    // initial guess for the same total molarities, but not for different ones
+    FluidState fsWarm;
+    fsWarm.setTemperature(fsRef.temperature(/*phaseIdx=*/0));
+    ImmiscibleFlash::guessFromPrevious(fsWarm, paramCache, fsFlash);
+    if (!ImmiscibleFlash::template isConverged<MaterialLaw>(fsWarm, paramCache, matParams, globalMolarities))
+        std::cout << "warm started flash: solution not recognized as converged\n";
+
+    ComponentVector perturbedMolarities(globalMolarities);
+    perturbedMolarities *= 1.01;
+    ImmiscibleFlash::guessFromPrevious(fsWarm, paramCache, fsFlash);
+    if (ImmiscibleFlash::template isConverged<MaterialLaw>(fsWarm, paramCache, matParams, perturbedMolarities))
+        std::cout << "warm started flash: perturbed state recognized as converged\n";
 }
 
 
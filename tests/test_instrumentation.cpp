@@ -0,0 +1,108 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief This is the unit test for the optional instrumentation of the library.
+ */
+#include "config.h"
+
+#define OPM_MATERIAL_INSTRUMENTATION 1
+
+#include <opm/material/common/Instrumentation.hpp>
+#include <opm/material/common/Tabulated1DFunction.hpp>
+#include <opm/material/common/UniformTabulated2DFunction.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+typedef double Scalar;
+
+static unsigned long long numCalls(const std::string& name)
+{
+    const std::vector<Opm::Instrumentation::Entry>& entries = Opm::Instrumentation::collect();
+    for (const auto& e : entries)
+        if (e.name == name)
+            return e.numCalls;
+    return 0;
+}
+
+int main()
+{
+    if (!Opm::Instrumentation::enabled()) {
+        std::cerr << "Instrumentation is not enabled\n";
+        return 1;
+    }
+
+    std::vector<Scalar> x = { 0.0, 1.0, 2.0, 3.0 };
+    std::vector<Scalar> y = { 0.0, 1.0, 4.0, 9.0 };
+    Opm::Tabulated1DFunction<Scalar> table1d(x, y);
+
+    Opm::UniformTabulated2DFunction<Scalar> table2d(0.0, 1.0, 5, 0.0, 1.0, 5);
+    for (unsigned i = 0; i < 5; ++i)
+        for (unsigned j = 0; j < 5; ++j)
+            table2d.setSamplePoint(i, j, i + j);
+
+    const int n = 1000;
+    Scalar sum = 0.0;
+    for (int i = 0; i < n; ++i)
+        sum += table1d.eval(3.0*i/n);
+    for (int i = 0; i < 2*n; ++i)
+        sum += table2d.eval(Scalar(i)/(2*n), 0.5);
+
+    if (numCalls("Tabulated1DFunction::eval") != static_cast<unsigned long long>(n)) {
+        std::cerr << "Wrong number of calls of Tabulated1DFunction::eval: "
+                  << numCalls("Tabulated1DFunction::eval") << "\n";
+        return 1;
+    }
+    if (numCalls("UniformTabulated2DFunction::eval") != static_cast<unsigned long long>(2*n)) {
+        std::cerr << "Wrong number of calls of UniformTabulated2DFunction::eval: "
+                  << numCalls("UniformTabulated2DFunction::eval") << "\n";
+        return 1;
+    }
+
+    Opm::Instrumentation::report(std::cout);
+
+    Opm::Instrumentation::reset();
+    if (numCalls("Tabulated1DFunction::eval") != 0) {
+        std::cerr << "The counters have not been reset\n";
+        return 1;
+    }
+
+    // the lookups which are within the range of a table and those which need to be
+    // extrapolated are counted separately
+    for (int i = 0; i < 10; ++i)
+        sum += table1d.eval(-1.0 - i, /*extrapolate=*/true);
+    for (int i = 0; i < 5; ++i)
+        sum += table1d.eval(0.5*i, /*extrapolate=*/true);
+    if (numCalls("Tabulated1DFunction::eval extrapolated") != 10
+        || numCalls("Tabulated1DFunction::eval in range") != 5)
+    {
+        std::cerr << "Wrong lookup statistics of Tabulated1DFunction::eval: "
+                  << numCalls("Tabulated1DFunction::eval in range") << " in range, "
+                  << numCalls("Tabulated1DFunction::eval extrapolated") << " extrapolated\n";
+        return 1;
+    }
+
+    // make sure that the computation is not optimized away
+    return (sum > 0.0) ? 0 : 1;
+}
@@ -31,7 +31,10 @@
 #include <algorithm>
 #include <cassert>
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
+#include <opm/material/common/BatchMeans.hpp>
 #include <opm/material/common/Unused.hpp>
 
 #include <opm/material/localad/Evaluation.hpp>
@@ -60,6 +63,16 @@ void testOperators()
     const Eval xEval = Eval::createVariable(x, 0);
     const Eval yEval = Eval::createVariable(y, 1);
 
+    // evaluations can be created at compile time and copied using memcpy
+    static_assert(std::is_trivially_copyable<Eval>::value,
+                  "Evaluations must be trivially copyable");
+    constexpr Eval OPM_UNUSED constEval = Eval::createConstant(1.234);
+    constexpr Eval OPM_UNUSED varEval = Eval::createVariable(4.567, 2);
+    static_assert(constEval.value == 1.234 && varEval.value == 4.567,
+                  "Evaluations must be constexpr constructible");
+    if (varEval.derivatives[2] != 1.0 || varEval.derivatives[0] != 0.0 || constEval.derivatives[1] != 0.0)
+        throw std::logic_error("oops: createVariable()/createConstant()");
+
     // test the non-inplace operators
     {
         Eval a = xEval + yEval;
@@ -220,6 +233,20 @@ void testOperators()
         if (1.0 != a)
             throw std::logic_error("oops: operator!=");
     }
+
+    {
+        typedef Opm::MathToolbox<Eval> Toolbox;
+
+        Eval a = Eval::createVariable(2.0, 0);
+        if (&Toolbox::template toLhs<Eval>(a) != &a)
+            throw std::logic_error("oops: toLhs() copies evaluations which do not need to be converted");
+        if (Toolbox::template toLhs<Scalar>(a) != 2.0)
+            throw std::logic_error("oops: toLhs()");
+
+        const Eval& b = Toolbox::template toLhs<Eval>(a*a);
+        if (b.value != 4.0 || b.derivatives[0] != 4.0)
+            throw std::logic_error("oops: toLhs() for temporaries");
+    }
 }
 
 template <class Scalar, class VariablesDescriptor, class AdFn, class ClassicFn>
@@ -399,6 +426,43 @@ void testPowExp(Scalar expMin = -100, Scalar expMax = 100)
     }
 }
 
+// the integer exponent variant of pow() uses multiplications only, so it must agree
+// with the generic one up to rounding
+template <class Scalar, class VariablesDescriptor>
+void testPowIntExp()
+{
+    typedef Opm::LocalAd::Evaluation<Scalar, VariablesDescriptor, VariablesDescriptor::size> Eval;
+
+    for (int exp = -9; exp <= 9; ++exp) {
+        for (Scalar base = -2.5; base <= 2.5; base += 0.1) {
+            if (std::abs(base) < 1e-3)
+                continue;
+
+            const auto& baseEval = Eval::createVariable(base, 0);
+            const Eval& zEval1 = pow(baseEval, exp);
+
+            Scalar z = std::pow(base, Scalar(exp));
+            Scalar zPrime = exp*std::pow(base, Scalar(exp - 1));
+
+            if (std::abs(zEval1.value - z) > 1e-13*std::abs(z))
+                throw std::logic_error("oops: value of pow(Eval, int)");
+
+            if (std::abs(zEval1.derivatives[0] - zPrime) > 1e-13*std::abs(zPrime))
+                throw std::logic_error("oops: derivative of pow(Eval, int)");
+
+            if (std::abs(Opm::MathToolbox<Scalar>::pow(base, exp) - z) > 1e-13*std::abs(z))
+                throw std::logic_error("oops: MathToolbox::pow(Scalar, int)");
+
+            // value-only evaluations must reproduce the value of the evaluation exactly
+            if (Opm::MathToolbox<Scalar>::pow(base, exp) != zEval1.value)
+                throw std::logic_error("oops: pow(Scalar, int) != value of pow(Eval, int)");
+
+            if ((baseEval/Scalar(exp)).value != base/exp)
+                throw std::logic_error("oops: Eval/Scalar != Scalar/Scalar");
+        }
+    }
+}
+
 template <class Scalar, class VariablesDescriptor>
 void testAtan2()
 {
@@ -445,6 +509,226 @@ void testAtan2()
     }
 }
 
+// make sure that the kernels which operate on the derivative vectors produce the same
+// results as straight-forward loops. (this is not trivial because SIMD versions of the
+// kernels may be used which process the derivatives in packs.)
+template <class Scalar, int numVars>
+void testDerivativeKernels()
+{
+    typedef Opm::LocalAd::DerivativeKernels<Scalar, numVars> Kernels;
+
+    std::array<Scalar, numVars> a, b, c, ref;
+    for (int i = 0; i < numVars; ++i) {
+        b[i] = 1.0 + i;
+        c[i] = 0.5 - 2*i;
+    }
+    const Scalar alpha = 1.25;
+    const Scalar beta = -3.5;
+
+    a = b;
+    Kernels::add(a.data(), c.data());
+    for (int i = 0; i < numVars; ++i)
+        if (a[i] != b[i] + c[i])
+            throw std::logic_error("oops: DerivativeKernels::add");
+
+    a = b;
+    Kernels::sub(a.data(), c.data());
+    for (int i = 0; i < numVars; ++i)
+        if (a[i] != b[i] - c[i])
+            throw std::logic_error("oops: DerivativeKernels::sub");
+
+    a = b;
+    Kernels::scale(a.data(), alpha);
+    for (int i = 0; i < numVars; ++i)
+        if (a[i] != alpha*b[i])
+            throw std::logic_error("oops: DerivativeKernels::scale");
+
+    Kernels::scaledCopy(a.data(), beta, c.data());
+    for (int i = 0; i < numVars; ++i)
+        if (a[i] != beta*c[i])
+            throw std::logic_error("oops: DerivativeKernels::scaledCopy");
+
+    // the destination is allowed to alias the source
+    a = b;
+    for (int i = 0; i < numVars; ++i)
+        ref[i] = alpha*b[i] + beta*c[i];
+    Kernels::linearCombination(a.data(), alpha, a.data(), beta, c.data());
+    for (int i = 0; i < numVars; ++i)
+        if (std::abs(a[i] - ref[i]) > 1e-14*std::abs(ref[i]))
+            throw std::logic_error("oops: DerivativeKernels::linearCombination");
+}
+
+// evaluations which store their derivatives as float must compute the same values as
+// the double precision ones, while their derivatives must agree up to the precision of
+// float
+template <class VariablesDescriptor>
+void testMixedPrecision()
+{
+    typedef Opm::LocalAd::Evaluation<double, VariablesDescriptor, VariablesDescriptor::size> Eval;
+    typedef Opm::LocalAd::Evaluation<double, VariablesDescriptor, VariablesDescriptor::size, float> MixedEval;
+    typedef Opm::MathToolbox<MixedEval> MixedToolbox;
+
+    static_assert(sizeof(MixedEval) < sizeof(Eval),
+                  "The derivatives of mixed precision evaluations must require less memory");
+
+    const Eval x = Eval::createVariable(1.25, VariablesDescriptor::temperatureIdx);
+    const Eval y = Eval::createVariable(-0.75, VariablesDescriptor::pressureIdx);
+    const MixedEval xm = MixedEval::createVariable(1.25, VariablesDescriptor::temperatureIdx);
+    const MixedEval ym = MixedEval::createVariable(-0.75, VariablesDescriptor::pressureIdx);
+
+    const Eval results[] = {
+        x*y + 3.0,
+        x/y - 2.0*x,
+        1.0/(x - y),
+        Opm::LocalAd::exp(x)*Opm::LocalAd::abs(y),
+        Opm::LocalAd::pow(x, 2.5) + Opm::LocalAd::pow(y, 3),
+        Opm::LocalAd::max(x, y)*Opm::LocalAd::min(x, y)
+    };
+
+    const MixedEval mixedResults[] = {
+        xm*ym + 3.0,
+        xm/ym - 2.0*xm,
+        1.0/(xm - ym),
+        MixedToolbox::exp(xm)*MixedToolbox::abs(ym),
+        MixedToolbox::pow(xm, 2.5) + MixedToolbox::pow(ym, 3),
+        MixedToolbox::max(xm, ym)*MixedToolbox::min(xm, ym)
+    };
+
+    for (unsigned i = 0; i < sizeof(results)/sizeof(results[0]); ++i) {
+        const Eval& r = results[i];
+        const MixedEval& rm = mixedResults[i];
+
+        if (std::abs(r.value - rm.value) > 1e-14*std::abs(r.value))
+            throw std::logic_error("oops: value of mixed precision evaluation");
+
+        for (int varIdx = 0; varIdx < VariablesDescriptor::size; ++varIdx)
+            if (std::abs(r.derivatives[varIdx] - rm.derivatives[varIdx])
+                > 1e-6*std::max(1.0, std::abs(r.derivatives[varIdx])))
+                throw std::logic_error("oops: derivative of mixed precision evaluation");
+
+        // conversions in both directions
+        const Eval& converted = Opm::MathToolbox<MixedEval>::template toLhs<Eval>(rm);
+        const MixedEval& convertedBack = Opm::MathToolbox<Eval>::template toLhs<MixedEval>(converted);
+        if (converted.value != rm.value || convertedBack != rm)
+            throw std::logic_error("oops: conversion of mixed precision evaluation");
+    }
+
+    if (&Opm::MathToolbox<MixedEval>::template toLhs<MixedEval>(xm) != &xm)
+        throw std::logic_error("oops: toLhs() of mixed precision evaluation must not copy");
+}
+
+#if OPM_MATERIAL_HAVE_SIMD_PACK
+// make sure that evaluations which use SIMD packs as scalars produce the same results
+// as evaluating each lane with plain scalars. min(), max() and abs() are the interesting
+// cases here because they need to select different arguments for different lanes.
+template <class VariablesDescriptor>
+void testSimdPack()
+{
+    typedef std::experimental::native_simd<double> Pack;
+    typedef Opm::LocalAd::Evaluation<Pack, VariablesDescriptor, VariablesDescriptor::size> PackEval;
+    typedef Opm::LocalAd::Evaluation<double, VariablesDescriptor, VariablesDescriptor::size> Eval;
+
+    Pack xValue([](int laneIdx) { return -1.0 + 0.75*laneIdx; });
+    const PackEval x = PackEval::createVariable(xValue, VariablesDescriptor::temperatureIdx);
+    const PackEval y = PackEval::createVariable(Pack(0.5), VariablesDescriptor::pressureIdx);
+
+    const PackEval packResults[] = {
+        Opm::LocalAd::min(x, y),
+        Opm::LocalAd::max(x, y),
+        Opm::LocalAd::min(0.25, x),
+        Opm::LocalAd::abs(x),
+        Opm::LocalAd::exp(x),
+        Opm::LocalAd::pow(y, 1.5)
+    };
+
+    for (unsigned laneIdx = 0; laneIdx < Pack::size(); ++laneIdx) {
+        const Eval xs = Eval::createVariable(xValue[laneIdx], VariablesDescriptor::temperatureIdx);
+        const Eval ys = Eval::createVariable(0.5, VariablesDescriptor::pressureIdx);
+
+        const Eval scalarResults[] = {
+            Opm::LocalAd::min(xs, ys),
+            Opm::LocalAd::max(xs, ys),
+            Opm::LocalAd::min(0.25, xs),
+            Opm::LocalAd::abs(xs),
+            Opm::LocalAd::exp(xs),
+            Opm::LocalAd::pow(ys, 1.5)
+        };
+
+        for (unsigned i = 0; i < sizeof(scalarResults)/sizeof(scalarResults[0]); ++i) {
+            const PackEval& p = packResults[i];
+            const Eval& s = scalarResults[i];
+            if (std::abs(p.value[laneIdx] - s.value) > 1e-14*std::abs(s.value))
+                throw std::logic_error("oops: value of SIMD pack evaluation");
+            for (int varIdx = 0; varIdx < VariablesDescriptor::size; ++varIdx)
+                if (std::abs(p.derivatives[varIdx][laneIdx] - s.derivatives[varIdx])
+                    > 1e-14*std::abs(s.derivatives[varIdx]))
+                    throw std::logic_error("oops: derivative of SIMD pack evaluation");
+        }
+    }
+}
+#endif
+
+// the batched means must yield the same values and derivatives as applying the scalar
+// means to each face. the faces include pairs with mixed signs and zeros, for which the
+// zero-guards apply, and their number is not a multiple of the block size.
+typedef Opm::LocalAd::Evaluation<double, TestVariables, TestVariables::size> BatchMeanEval;
+
+// the batched means must yield the same values and derivatives as applying the scalar
+// means to each face. the faces include pairs with mixed signs and zeros, for which the
+// zero-guards apply, and their number is not a multiple of the block size.
+void testBatchMean(BatchMeanEval (*meanFn)(BatchMeanEval, BatchMeanEval),
+                   void (*batchMeanFn)(const BatchMeanEval*, const BatchMeanEval*, BatchMeanEval*, size_t),
+                   void (*scalarBatchMeanFn)(const double*, const double*, double*, size_t))
+{
+    typedef TestVariables VariablesDescriptor;
+    typedef BatchMeanEval Eval;
+
+    const unsigned n = 150;
+    std::vector<Eval> x(n), y(n), result(n);
+    std::vector<double> xValue(n), yValue(n), resultValue(n);
+    for (unsigned i = 0; i < n; ++i) {
+        xValue[i] = (i % 7 == 0) ? 0.0 : 0.1 + 0.01*i;
+        yValue[i] = (i % 5 == 0) ? -0.5 : 2.0 - 0.01*i;
+        x[i] = Eval::createVariable(xValue[i], VariablesDescriptor::temperatureIdx);
+        x[i].derivatives[VariablesDescriptor::saturationIdx] = 0.5;
+        y[i] = Eval::createVariable(yValue[i], VariablesDescriptor::pressureIdx);
+    }
+
+    batchMeanFn(x.data(), y.data(), result.data(), n);
+    scalarBatchMeanFn(xValue.data(), yValue.data(), resultValue.data(), n);
+    for (unsigned i = 0; i < n; ++i) {
+        const Eval& ref = meanFn(x[i], y[i]);
+        if (std::abs(result[i].value - ref.value) > 1e-14*std::abs(ref.value)
+            || std::abs(resultValue[i] - ref.value) > 1e-14*std::abs(ref.value))
+            throw std::logic_error("oops: value of batched mean");
+        for (int varIdx = 0; varIdx < VariablesDescriptor::size; ++varIdx)
+            if (std::abs(result[i].derivatives[varIdx] - ref.derivatives[varIdx])
+                > 1e-14*std::max(1.0, std::abs(ref.derivatives[varIdx])))
+                throw std::logic_error("oops: derivative of batched mean");
+    }
+
+    // the result may be stored in one of the input arrays
+    batchMeanFn(x.data(), y.data(), x.data(), n);
+    for (unsigned i = 0; i < n; ++i)
+        if (x[i] != result[i])
+            throw std::logic_error("oops: in-place batched mean");
+}
+
+void testBatchMeans()
+{
+    typedef BatchMeanEval Eval;
+
+    testBatchMean(Opm::arithmeticMean<Eval>,
+                  Opm::arithmeticMeans<Eval>,
+                  Opm::arithmeticMeans<double>);
+    testBatchMean(Opm::geometricMean<Eval>,
+                  Opm::geometricMeans<Eval>,
+                  Opm::geometricMeans<double>);
+    testBatchMean(Opm::harmonicMean<Eval>,
+                  Opm::harmonicMeans<Eval>,
+                  Opm::harmonicMeans<double>);
+}
+
 double myScalarMin(double a, double b)
 { return std::min(a, b); }
 
@@ -462,9 +746,30 @@ int main()
     // w.r.t. Pressure but they have been requested...
     //const auto& result2 = Opm::LocalAd::sqrt(TemperatureEval::createVariable<Pressure>(4.0));
 
+    std::cout << "testing the derivative kernels\n";
+    testDerivativeKernels<Scalar, 1>();
+    testDerivativeKernels<Scalar, 3>();
+    testDerivativeKernels<Scalar, 4>();
+    testDerivativeKernels<Scalar, 7>();
+    testDerivativeKernels<Scalar, 8>();
+    testDerivativeKernels<float, 5>();
+    testDerivativeKernels<float, 8>();
+    testDerivativeKernels<float, 13>();
+
     std::cout << "testing operators and constructors\n";
     testOperators<Scalar, VarsDescriptor>();
 
+    std::cout << "testing mixed precision evaluations\n";
+    testMixedPrecision<VarsDescriptor>();
+
+#if OPM_MATERIAL_HAVE_SIMD_PACK
+    std::cout << "testing SIMD packs as scalars\n";
+    testSimdPack<VarsDescriptor>();
+#endif
+
+    std::cout << "testing batched means\n";
+    testBatchMeans();
+
     std::cout << "testing min()\n";
     test2DFunction1<Scalar, VarsDescriptor>(Opm::LocalAd::min<Scalar, VarsDescriptor, VarsDescriptor::size>,
                                             myScalarMin,
@@ -490,6 +795,7 @@ int main()
     std::cout << "testing pow()\n";
     testPowBase<Scalar, VarsDescriptor>();
     testPowExp<Scalar, VarsDescriptor>();
+    testPowIntExp<Scalar, VarsDescriptor>();
 
     std::cout << "testing abs()\n";
     test1DFunction<Scalar, VarsDescriptor>(Opm::LocalAd::abs<Scalar, VarsDescriptor, VarsDescriptor::size>,
@@ -0,0 +1,123 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Test for the expression template mode of the localized automatic
+ *        differentiation (AD) framework.
+ */
+#include "config.h"
+
+#define OPM_LOCAL_AD_EXPRESSION_TEMPLATES 1
+
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+
+#include <iostream>
+#include <cmath>
+
+struct TestVariables
+{
+    static const int size = 3;
+};
+
+typedef double Scalar;
+typedef Opm::LocalAd::Evaluation<Scalar, TestVariables, TestVariables::size> Eval;
+
+bool isClose(Scalar a, Scalar b)
+{ return std::abs(a - b) <= 1e-12*std::max(1.0, std::abs(b)); }
+
+bool check(const Eval& result,
+           Scalar value,
+           const Scalar* derivatives,
+           const char* expr)
+{
+    bool ok = isClose(result.value, value);
+    for (int varIdx = 0; varIdx < Eval::size; ++varIdx)
+        ok = ok && isClose(result.derivatives[varIdx], derivatives[varIdx]);
+
+    if (!ok) {
+        std::cerr << "expression '" << expr << "' is evaluated incorrectly: ";
+        result.print(std::cerr);
+        std::cerr << "\n";
+    }
+
+    return ok;
+}
+
+int main()
+{
+    Scalar x = 1.3, y = -0.7, z = 2.1;
+    const Eval a = Eval::createVariable(x, 0);
+    const Eval b = Eval::createVariable(y, 1);
+    const Eval c = Eval::createVariable(z, 2);
+
+    bool ok = true;
+
+    {
+        Eval r = a*b + c/a - 2.0*b;
+        Scalar d[3] = { y - z/(x*x), x - 2.0, 1/x };
+        ok = check(r, x*y + z/x - 2.0*y, d, "a*b + c/a - 2*b") && ok;
+    }
+
+    {
+        Eval r = -(a - c)*(b + 1.0)/3.0;
+        Scalar d[3] = { -(y + 1)/3, -(x - z)/3, (y + 1)/3 };
+        ok = check(r, -(x - z)*(y + 1)/3, d, "-(a - c)*(b + 1)/3") && ok;
+    }
+
+    {
+        Eval r = Opm::LocalAd::exp(a*b) + Opm::LocalAd::pow(c - b, 1.5);
+        Scalar e = std::exp(x*y);
+        Scalar p = 1.5*std::pow(z - y, 0.5);
+        Scalar d[3] = { y*e, x*e - p, p };
+        ok = check(r, e + std::pow(z - y, 1.5), d, "exp(a*b) + pow(c - b, 1.5)") && ok;
+    }
+
+    {
+        Eval r = Opm::LocalAd::max(a*b, c - 3.0);
+        Scalar d[3] = { 0.0, 0.0, 1.0 };
+        ok = check(r, z - 3.0, d, "max(a*b, c - 3)") && ok;
+    }
+
+    {
+        // the expression refers to the object which it is assigned to
+        Eval r = a;
+        r = r*b + r;
+        Scalar d[3] = { y + 1, x, 0.0 };
+        ok = check(r, x*y + x, d, "r = r*b + r") && ok;
+
+        r = a;
+        r *= b + c;
+        Scalar d2[3] = { y + z, x, x };
+        ok = check(r, x*(y + z), d2, "r *= b + c") && ok;
+
+        r /= r - a;
+        Scalar u = x*(y + z), v = x*(y + z) - x;
+        Scalar d3[3] = { (y + z)/v - u*(y + z - 1)/(v*v), x/v - u*x/(v*v), x/v - u*x/(v*v) };
+        ok = check(r, u/v, d3, "r /= r - a") && ok;
+    }
+
+    if (!(a*b < c) || !(c > a*b) || a + b == c)
+        ok = false;
+
+    return ok?0:1;
+}
@@ -43,6 +43,10 @@
 #include <opm/material/fluidmatrixinteractions/EffToAbsLaw.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
 
+#include <limits>
+#include <sstream>
+#include <vector>
+
 template <class Scalar, class FluidState>
 void checkSame(const FluidState &fsRef, const FluidState &fsFlash)
 {
@@ -112,6 +116,195 @@ void checkNcpFlash(const FluidState &fsRef,
 
     // compare the "flashed" fluid state with the reference one
     checkSame<Scalar>(fsRef, fsFlash);
+
+    // the flashed fluid state must be recognized as a solution if it is used as the
+    // initial guess for the same total molarities, but not for different ones
+    FluidState fsWarm;
+    fsWarm.setTemperature(fsRef.temperature(/*phaseIdx=*/0));
+    NcpFlash::guessFromPrevious(fsWarm, paramCache, fsFlash);
+    if (!NcpFlash::template isConverged<MaterialLaw>(fsWarm, paramCache, matParams, globalMolarities))
+        std::cout << "warm started flash: solution not recognized as converged\n";
+
+    ComponentVector perturbedMolarities(globalMolarities);
+    perturbedMolarities *= 1.01;
+    NcpFlash::guessFromPrevious(fsWarm, paramCache, fsFlash);
+    if (NcpFlash::template isConverged<MaterialLaw>(fsWarm, paramCache, matParams, perturbedMolarities))
+        std::cout << "warm started flash: perturbed state recognized as converged\n";
+
+    // single-phase states must be found by the stability test based flash, states
+    // with more than one phase must be rejected by it
+    int numPresentPhases = 0;
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+        if (fsRef.saturation(phaseIdx) > 0.0)
+            ++numPresentPhases;
+
+    FluidState fsSingle;
+    fsSingle.setTemperature(fsRef.temperature(/*phaseIdx=*/0));
+    bool singlePhaseFound =
+        NcpFlash::template solveSinglePhase<MaterialLaw>(fsSingle, paramCache, matParams, globalMolarities);
+    if (singlePhaseFound != (numPresentPhases == 1))
+        std::cout << "single-phase flash: wrong stability of the fluid state detected\n";
+    else if (singlePhaseFound)
+        checkSame<Scalar>(fsRef, fsSingle);
+
+    // do the same using the batched flash for a few copies of the fluid state
+    const int n = 3;
+    std::vector<FluidState> fsBatch(n);
+    std::vector<typename FluidSystem::ParameterCache> paramCaches(n);
+    std::vector<const typename MaterialLaw::Params*> matParamsPtrs(n, &matParams);
+    std::vector<ComponentVector> batchMolarities(n, globalMolarities);
+    for (int i = 0; i < n; ++i) {
+        fsBatch[i].setTemperature(fsRef.temperature(/*phaseIdx=*/0));
+        NcpFlash::guessInitial(fsBatch[i], paramCaches[i], globalMolarities);
+    }
+    NcpFlash::template solveBatch<MaterialLaw>(fsBatch.data(),
+                                               paramCaches.data(),
+                                               matParamsPtrs.data(),
+                                               batchMolarities.data(),
+                                               n);
+    for (int i = 0; i < n; ++i)
+        checkSame<Scalar>(fsRef, fsBatch[i]);
+
+    // the exception-free variants must report the outcome for each fluid state
+    // individually. the last fluid state of the batch cannot be flashed.
+    typedef typename NcpFlash::SolverStatus SolverStatus;
+    FluidState fsTry;
+    fsTry.setTemperature(fsRef.temperature(/*phaseIdx=*/0));
+    NcpFlash::guessInitial(fsTry, paramCache, globalMolarities);
+    const SolverStatus& status =
+        NcpFlash::template trySolve<MaterialLaw>(fsTry, paramCache, matParams, globalMolarities);
+    if (!status.converged() || status.iterations < 1 || !(status.residual < 1e-9))
+        std::cout << "exception-free flash: wrong status\n";
+    else
+        checkSame<Scalar>(fsRef, fsTry);
+
+    // the line search must converge to the same solution
+    NcpFlash::setGlobalization(NcpFlash::LineSearch);
+    NcpFlash::guessInitial(fsTry, paramCache, globalMolarities);
+    const SolverStatus& lineSearchStatus =
+        NcpFlash::template trySolve<MaterialLaw>(fsTry, paramCache, matParams, globalMolarities);
+    NcpFlash::setGlobalization(NcpFlash::ClampedUpdate);
+    if (!lineSearchStatus.converged())
+        std::cout << "flash with line search: not converged\n";
+    else
+        checkSame<Scalar>(fsRef, fsTry);
+
+    // a relaxed tolerance must not require more iterations than the exact flash and
+    // the achieved accuracy must be reported. an exhausted iteration budget must be
+    // reported as well.
+    typedef typename NcpFlash::SolverTolerance SolverTolerance;
+    const SolverTolerance& relaxed = SolverTolerance::adaptive(/*outerResidual=*/1e-2,
+                                                               /*relativeTolerance=*/0.1);
+    NcpFlash::guessInitial(fsTry, paramCache, globalMolarities);
+    const SolverStatus& relaxedStatus =
+        NcpFlash::template trySolve<MaterialLaw>(fsTry, paramCache, matParams, globalMolarities, relaxed);
+    if (!relaxedStatus.converged()
+        || relaxedStatus.iterations > status.iterations
+        || !(relaxedStatus.residual < relaxed.tolerance))
+        std::cout << "flash with relaxed tolerance: wrong status\n";
+
+    NcpFlash::guessInitial(fsTry, paramCache, globalMolarities);
+    const SolverStatus& budgetStatus =
+        NcpFlash::template trySolve<MaterialLaw>(fsTry, paramCache, matParams, globalMolarities,
+                                                 SolverTolerance(/*tolerance=*/0.0, /*maxIterations=*/1));
+    if (budgetStatus.iterations != 1
+        || (budgetStatus.converged() != (budgetStatus.residual < 1e-9)))
+        std::cout << "flash with iteration budget: wrong status\n";
+
+    // a corpus which records all calls must allow to repeat the flash, also after it
+    // was written to a file
+    Opm::ConstraintSolverCorpus corpus(/*minIterations=*/0);
+    NcpFlash::setCorpus(&corpus);
+    NcpFlash::guessInitial(fsTry, paramCache, globalMolarities);
+    const SolverStatus& capturedStatus =
+        NcpFlash::template trySolve<MaterialLaw>(fsTry, paramCache, matParams, globalMolarities);
+    NcpFlash::setCorpus(nullptr);
+
+    std::stringstream corpusFile;
+    corpus.write(corpusFile);
+    Opm::ConstraintSolverCorpus replayCorpus;
+    replayCorpus.read(corpusFile);
+    if (replayCorpus.size() != 1)
+        std::cout << "flash corpus: wrong number of records\n";
+    else {
+        FluidState fsReplay;
+        const SolverStatus& replayStatus =
+            NcpFlash::template replay<MaterialLaw>(fsReplay, replayCorpus.records()[0], matParams);
+        if (!replayStatus.converged() || replayStatus.iterations != capturedStatus.iterations)
+            std::cout << "flash corpus: replay does not reproduce the recorded flash\n";
+        else
+            checkSame<Scalar>(fsRef, fsReplay);
+    }
+
+    std::vector<SolverStatus> statuses(n);
+    for (int i = 0; i < n; ++i)
+        NcpFlash::guessInitial(fsBatch[i], paramCaches[i], globalMolarities);
+    batchMolarities[n - 1] = std::numeric_limits<Scalar>::quiet_NaN();
+    size_t numFailed =
+        NcpFlash::template trySolveBatch<MaterialLaw>(fsBatch.data(),
+                                                      paramCaches.data(),
+                                                      matParamsPtrs.data(),
+                                                      batchMolarities.data(),
+                                                      statuses.data(),
+                                                      n);
+    if (numFailed != 1 || statuses[n - 1].converged())
+        std::cout << "exception-free batched flash: failure not reported\n";
+    for (int i = 0; i < n - 1; ++i) {
+        if (!statuses[i].converged())
+            std::cout << "exception-free batched flash: wrong status of fluid state " << i << "\n";
+        else
+            checkSame<Scalar>(fsRef, fsBatch[i]);
+    }
+
+    // the same for the parallel flash
+    for (int i = 0; i < n; ++i)
+        NcpFlash::guessInitial(fsBatch[i], paramCaches[i], globalMolarities);
+    const typename NcpFlash::SolverStatistics& statistics =
+        NcpFlash::template trySolveParallel<MaterialLaw>(fsBatch.data(),
+                                                         paramCaches.data(),
+                                                         matParamsPtrs.data(),
+                                                         batchMolarities.data(),
+                                                         statuses.data(),
+                                                         n);
+    if (statistics.numFailed() != 1
+        || statistics.numConverged != static_cast<size_t>(n - 1)
+        || statuses[n - 1].converged())
+        std::cout << "parallel flash: failure not reported\n";
+    for (int i = 0; i < n - 1; ++i) {
+        if (!statuses[i].converged() || statuses[i].iterations > statistics.maxIterations)
+            std::cout << "parallel flash: wrong status of fluid state " << i << "\n";
+        else
+            checkSame<Scalar>(fsRef, fsBatch[i]);
+    }
+
+    // an attached telemetry object must record each call of trySolve(). the
+    // converged states must end up in the bins of small residuals.
+    Opm::ConstraintSolverTelemetry telemetry;
+    NcpFlash::setTelemetry(&telemetry);
+    NcpFlash::guessInitial(fsTry, paramCache, globalMolarities);
+    NcpFlash::template solve<MaterialLaw>(fsTry, paramCache, matParams, globalMolarities);
+    for (int i = 0; i < n; ++i)
+        NcpFlash::guessInitial(fsBatch[i], paramCaches[i], globalMolarities);
+    NcpFlash::template trySolveParallel<MaterialLaw>(fsBatch.data(),
+                                                     paramCaches.data(),
+                                                     matParamsPtrs.data(),
+                                                     batchMolarities.data(),
+                                                     statuses.data(),
+                                                     n);
+    NcpFlash::setTelemetry(nullptr);
+    NcpFlash::template trySolve<MaterialLaw>(fsTry, paramCache, matParams, globalMolarities);
+
+    unsigned long long numSmallResiduals = 0;
+    for (int binIdx = 0; binIdx < Opm::ConstraintSolverTelemetry::residualBin(1e-9); ++binIdx)
+        numSmallResiduals += telemetry.residualCount(binIdx);
+    if (telemetry.numConverged() != static_cast<unsigned long long>(n)
+        || telemetry.numSolves() > static_cast<unsigned long long>(n + 1)
+        || numSmallResiduals < static_cast<unsigned long long>(n)
+        || telemetry.totalIterations() < static_cast<unsigned long long>(n))
+    {
+        std::cout << "flash telemetry: wrong histograms\n";
+        telemetry.print(std::cout);
+    }
 }
 
 
@@ -137,6 +330,11 @@ void completeReferenceFluidState(FluidState &fs,
                    fs.pressure(refPhaseIdx)
                    + (pC[otherPhaseIdx] - pC[refPhaseIdx]));
 
+    // the batched variant must yield the same result
+    const int n = 3;
+    std::vector<FluidState> fsBatch(n, fs);
+    std::vector<typename FluidSystem::ParameterCache> paramCaches(n);
+
     // make the fluid state consistent with local thermodynamic
     // equilibrium
     typename FluidSystem::ParameterCache paramCache;
@@ -145,6 +343,15 @@ void completeReferenceFluidState(FluidState &fs,
                                      refPhaseIdx,
                                      /*setViscosity=*/false,
                                      /*setEnthalpy=*/false);
+
+    ComputeFromReferencePhase::solveBatch(fsBatch.data(),
+                                          paramCaches.data(),
+                                          n,
+                                          refPhaseIdx,
+                                          /*setViscosity=*/false,
+                                          /*setEnthalpy=*/false);
+    for (int i = 0; i < n; ++i)
+        checkSame<Scalar>(fs, fsBatch[i]);
 }
 
 
@@ -22,16 +22,25 @@
  * \file
  *
  * \brief This is test for the SPE5 fluid system (which uses the
- *        Peng-Robinson EOS) and the NCP flash solver.
+ *        Peng-Robinson EOS), the NCP flash solver and the Rachford-Rice flash
+ *        solver.
  */
 #include "config.h"
 
+#include <opm/material/constraintsolvers/CompositionFromFugacities.hpp>
 #include <opm/material/constraintsolvers/ComputeFromReferencePhase.hpp>
 #include <opm/material/constraintsolvers/NcpFlash.hpp>
+#include <opm/material/constraintsolvers/PengRobinsonDeviceFlash.hpp>
+#include <opm/material/constraintsolvers/RachfordRiceFlash.hpp>
 #include <opm/material/fluidstates/CompositionalFluidState.hpp>
 #include <opm/material/fluidsystems/Spe5FluidSystem.hpp>
 #include <opm/material/fluidmatrixinteractions/LinearMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
+#include <opm/material/components/H2O.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+
+#include <vector>
 
 template <class FluidSystem, class FluidState>
 void createSurfaceGasFluidSystem(FluidState &gasFluidState)
@@ -249,6 +258,470 @@ Scalar bringOilToSurface(FluidState &surfaceFluidState, Scalar alpha, const Flui
     return alpha;
 }
 
+template <class Scalar, class FluidSystem, class FluidState>
+void checkMolarVolumeBatch(const FluidState &fluidState)
+{
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+    typedef Opm::PengRobinson<Scalar> PengRobinson;
+
+    // vary the pressure over a range which covers one and three intersections of
+    // the EOS with the pressure
+    const int n = 100;
+    std::vector<FluidState> fluidStates(n, fluidState);
+    std::vector<ParameterCache> paramCaches(n);
+    std::vector<const ParameterCache*> paramCachePtrs(n);
+    for (int i = 0; i < n; ++i) {
+        Scalar p = 1e5 + (500e5 - 1e5)*i/(n - 1);
+        for (int phaseIdx = 0; phaseIdx < FluidSystem::numPhases; ++phaseIdx)
+            fluidStates[i].setPressure(phaseIdx, p);
+        paramCaches[i].updateAll(fluidStates[i]);
+        paramCachePtrs[i] = &paramCaches[i];
+    }
+
+    std::vector<Scalar> Vm(n);
+    for (int phaseIdx = 0; phaseIdx < FluidSystem::numPhases; ++phaseIdx) {
+        if (phaseIdx != oilPhaseIdx && phaseIdx != gasPhaseIdx)
+            continue;
+
+        bool isGasPhase = (phaseIdx == gasPhaseIdx);
+        PengRobinson::computeMolarVolumeBatch(Vm.data(), fluidStates.data(), paramCachePtrs.data(),
+                                              phaseIdx, isGasPhase, n);
+        for (int i = 0; i < n; ++i) {
+            Scalar VmRef = PengRobinson::computeMolarVolume(fluidStates[i], paramCaches[i],
+                                                            phaseIdx, isGasPhase);
+            if (std::abs(Vm[i] - VmRef) > 1e-10*std::abs(VmRef))
+                std::cout << "batched molar volume of phase " << phaseIdx
+                          << " differs at p=" << fluidStates[i].pressure(phaseIdx) << ": "
+                          << Vm[i] << " vs " << VmRef << "\n";
+        }
+    }
+}
+
+template <class Scalar, class FluidSystem, class FluidState>
+void checkParameterCacheReuse(const FluidState &fluidState)
+{
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+    FluidState fs(fluidState);
+    typename FluidSystem::ParameterCache paramCache;
+    paramCache.updateAll(fs);
+    Scalar rhoOil = FluidSystem::density(fs, paramCache, oilPhaseIdx);
+
+    // changing the saturations must not cause any EOS work
+    paramCache.resetStatistics();
+    fs.setSaturation(oilPhaseIdx, 0.3);
+    fs.setSaturation(gasPhaseIdx, 0.7);
+    paramCache.updateAll(fs);
+    if (paramCache.numSkippedMolarVolumeUpdates() != FluidSystem::numPhases)
+        std::cout << "parameter cache recomputed the molar volume after a saturation change\n";
+    if (FluidSystem::density(fs, paramCache, oilPhaseIdx) != rhoOil)
+        std::cout << "density changed after a saturation change\n";
+
+    // changing the pressure only requires the molar volume to be recomputed
+    paramCache.resetStatistics();
+    fs.setPressure(oilPhaseIdx, 1.1*fs.pressure(oilPhaseIdx));
+    paramCache.updateAll(fs);
+    if (paramCache.numSkippedMolarVolumeUpdates() != FluidSystem::numPhases - 1
+        || paramCache.numSkippedCompositionUpdates() != FluidSystem::numPhases)
+        std::cout << "parameter cache did more work than necessary after a pressure change\n";
+
+    typename FluidSystem::ParameterCache refParamCache;
+    refParamCache.updateAll(fs);
+    if (std::abs(FluidSystem::density(fs, paramCache, oilPhaseIdx)
+                 - FluidSystem::density(fs, refParamCache, oilPhaseIdx)) > 1e-10*rhoOil)
+        std::cout << "cached density differs from the one of a fresh parameter cache\n";
+}
+
+template <class Scalar, class FluidSystem, class FluidState>
+void checkFugacityCoefficients(const FluidState &fluidState)
+{
+    enum { numComponents = FluidSystem::numComponents };
+
+    typename FluidSystem::ParameterCache paramCache;
+    paramCache.updateAll(fluidState);
+
+    // the single-pass method must yield exactly the same results as the
+    // per-component one
+    for (int phaseIdx = 0; phaseIdx < FluidSystem::numPhases; ++phaseIdx) {
+        Scalar phi[numComponents];
+        FluidSystem::fugacityCoefficients(fluidState, paramCache, phaseIdx, phi);
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            Scalar phiRef = FluidSystem::fugacityCoefficient(fluidState, paramCache, phaseIdx, compIdx);
+            if (phi[compIdx] != phiRef)
+                std::cout << "fugacity coefficient of component " << compIdx
+                          << " in phase " << phaseIdx << " differs: "
+                          << phi[compIdx] << " vs " << phiRef << "\n";
+        }
+    }
+}
+
+// the accelerated successive substitution of CompositionFromFugacities must converge to
+// the same oil composition as the plain successive substitution
+template <class Scalar, class FluidSystem, class FluidState>
+void checkCompositionFromFugacities(const FluidState &referenceFluidState)
+{
+    enum { numComponents = FluidSystem::numComponents };
+
+    typedef Opm::CompositionFromFugacities<Scalar, FluidSystem> CompositionFromFugacities;
+    typedef typename CompositionFromFugacities::ComponentVector ComponentVector;
+
+    const int phaseIdx = FluidSystem::oilPhaseIdx;
+    FluidState fluidState(referenceFluidState);
+    typename FluidSystem::ParameterCache paramCache;
+    paramCache.updatePhase(fluidState, phaseIdx);
+
+    // the target fugacities of the reference composition
+    ComponentVector targetFug;
+    Scalar p = fluidState.pressure(phaseIdx);
+    for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+        targetFug[compIdx] =
+            fluidState.moleFraction(phaseIdx, compIdx)
+            *FluidSystem::fugacityCoefficient(fluidState, paramCache, phaseIdx, compIdx)
+            *p;
+
+    // plain successive substitution x <- f/(phi(x/sum(x)) p), starting at a
+    // uniform composition
+    Scalar x[numComponents];
+    for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+        x[compIdx] = 1.0/numComponents;
+        fluidState.setMoleFraction(phaseIdx, compIdx, x[compIdx]);
+    }
+    int numPlainSteps = 0;
+    for (Scalar deltaNorm = 1.0; deltaNorm > 1e-13; ++numPlainSteps) {
+        if (numPlainSteps >= 1000)
+            OPM_THROW(std::logic_error, "The plain successive substitution did not converge");
+
+        Scalar sumx = 0.0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            sumx += x[compIdx];
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            fluidState.setMoleFraction(phaseIdx, compIdx, x[compIdx]/sumx);
+        paramCache.updateComposition(fluidState, phaseIdx);
+
+        Scalar phi[numComponents];
+        FluidSystem::fugacityCoefficients(fluidState, paramCache, phaseIdx, phi);
+        deltaNorm = 0.0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            Scalar xNew = targetFug[compIdx]/(phi[compIdx]*p);
+            deltaNorm = std::max(deltaNorm, std::abs(xNew - x[compIdx]));
+            x[compIdx] = xNew;
+        }
+    }
+
+    // the accelerated substitution, starting at the same composition. for target
+    // fugacities of a normalized composition, it does not need Newton's method.
+    for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+        fluidState.setMoleFraction(phaseIdx, compIdx, 1.0/numComponents);
+    paramCache.updatePhase(fluidState, phaseIdx);
+    typename CompositionFromFugacities::IterationCounts counts;
+    CompositionFromFugacities::solve(fluidState, paramCache, phaseIdx, targetFug, &counts);
+    if (counts.newton != 0 || counts.substitution >= numPlainSteps)
+        OPM_THROW(std::logic_error,
+                  "The accelerated substitution took " << counts.substitution << " steps and " << counts.newton
+                  << " Newton iterations, the plain one " << numPlainSteps << " steps");
+
+    for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+        Scalar xAccel = fluidState.moleFraction(phaseIdx, compIdx);
+        Scalar xRef = referenceFluidState.moleFraction(phaseIdx, compIdx);
+        if (std::abs(xAccel - x[compIdx]) > 1e-8 || std::abs(xAccel - xRef) > 1e-8)
+            OPM_THROW(std::logic_error,
+                      "The accelerated substitution yields the mole fraction " << xAccel
+                      << " of component " << compIdx
+                      << " instead of " << x[compIdx] << " (reference: " << xRef << ")");
+    }
+}
+
+// the pure component parameters for the vapor pressure of water
+struct WaterVaporPressureParams
+{
+    typedef Opm::H2O<double> Component;
+};
+
+template <class Scalar>
+void checkVaporPressureTable()
+{
+    typedef Opm::PengRobinson<Scalar> PengRobinson;
+    typedef WaterVaporPressureParams::Component Component;
+    typedef Opm::LocalAd::Evaluation<Scalar, WaterVaporPressureParams, 1> Evaluation;
+
+    WaterVaporPressureParams params;
+    Scalar Tc = Component::criticalTemperature();
+    for (int i = 0; i < 50; ++i) {
+        Scalar T = 0.2*Tc + (0.999*Tc - 0.2*Tc)*i/49;
+
+        Scalar pVapRef = PengRobinson::computeVaporPressure(params, T);
+        Scalar pVap = PengRobinson::tabulatedVaporPressure(params, T);
+        if (std::abs(pVap - pVapRef) > 5e-4*pVapRef)
+            std::cout << "tabulated vapor pressure at T=" << T << " differs: "
+                      << pVap << " vs " << pVapRef << "\n";
+
+        const Evaluation& TEval = Evaluation::createVariable(T, 0);
+        const Evaluation& pVapEval = PengRobinson::tabulatedVaporPressure(params, TEval);
+        Scalar eps = 1e-4*T;
+        Scalar dpVapRef =
+            (PengRobinson::computeVaporPressure(params, T + eps)
+             - PengRobinson::computeVaporPressure(params, T - eps))/(2*eps);
+        // below the range of the table, the derivatives are only extrapolated
+        if (pVapEval.value != pVap
+            || (T >= 0.3*Tc && std::abs(pVapEval.derivatives[0] - dpVapRef) > 2e-2*std::abs(dpVapRef)))
+            std::cout << "derivative of the tabulated vapor pressure at T=" << T << " differs: "
+                      << pVapEval.derivatives[0] << " vs " << dpVapRef << "\n";
+    }
+}
+
+template <class Scalar, class FluidSystem>
+void checkRachfordRiceFlash()
+{
+    typedef Opm::RachfordRiceFlash<Scalar, FluidSystem> Flash;
+    typedef typename Flash::SolverStatus SolverStatus;
+    typedef typename Flash::ComponentVector ComponentVector;
+    typedef Opm::CompositionalFluidState<Scalar, FluidSystem> FluidState;
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+
+    // the vectorized Rachford-Rice solver must find the roots of the scalar
+    // Rachford-Rice function
+    const int numProblems = 100;
+    std::vector<Scalar> K(numComponents*numProblems), z(numComponents*numProblems);
+    std::vector<Scalar> V(numProblems);
+    for (int i = 0; i < numProblems; ++i) {
+        Scalar sumZ = 0.0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            K[compIdx*numProblems + i] = std::exp(4.0*std::sin(1.3*i + 2.1*compIdx));
+            z[compIdx*numProblems + i] = 1.0 + std::cos(0.7*i*compIdx);
+            sumZ += z[compIdx*numProblems + i];
+        }
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            z[compIdx*numProblems + i] /= sumZ;
+    }
+    Flash::solveRachfordRice(V.data(), K.data(), z.data(), numProblems);
+    for (int i = 0; i < numProblems; ++i) {
+        Scalar f = 0.0;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            Scalar a = K[compIdx*numProblems + i] - 1;
+            f += z[compIdx*numProblems + i]*a/(1 + V[i]*a);
+        }
+        if (V[i] < 0.0 || V[i] > 1.0
+            || (0.0 < V[i] && V[i] < 1.0 && std::abs(f) > 1e-10)
+            || (V[i] == 0.0 && f > 1e-10)
+            || (V[i] == 1.0 && f < -1e-10))
+            OPM_THROW(std::logic_error,
+                      "Wrong root of the Rachford-Rice equation for problem " << i
+                      << ": V = " << V[i] << ", f(V) = " << f);
+    }
+
+    // the SPE-5 reservoir oil at a pressure below its bubble point pressure
+    ComponentVector zOil(0.0);
+    zOil[FluidSystem::C1Idx] = 0.50;
+    zOil[FluidSystem::C3Idx] = 0.03;
+    zOil[FluidSystem::C6Idx] = 0.07;
+    zOil[FluidSystem::C10Idx] = 0.20;
+    zOil[FluidSystem::C15Idx] = 0.15;
+    zOil[FluidSystem::C20Idx] = 0.05;
+
+    const int numStates = 20;
+    std::vector<FluidState> fluidStates(numStates);
+    std::vector<ParameterCache> paramCaches(numStates);
+    std::vector<ComponentVector> globalMoleFractions(numStates, zOil);
+    std::vector<SolverStatus> statuses(numStates);
+    for (int i = 0; i < numStates; ++i) {
+        fluidStates[i].setTemperature(273.15 + 20);
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            fluidStates[i].setPressure(phaseIdx, 20e5 + 10e5*i);
+    }
+    size_t numFailed = Flash::trySolveBatch(fluidStates.data(), paramCaches.data(),
+                                            globalMoleFractions.data(),
+                                            oilPhaseIdx, gasPhaseIdx,
+                                            statuses.data(), numStates);
+    if (numFailed > 0)
+        OPM_THROW(std::logic_error, numFailed << " batched Rachford-Rice flashes failed");
+
+    bool twoPhaseStateFound = false;
+    for (int i = 0; i < numStates; ++i) {
+        const FluidState& fs = fluidStates[i];
+
+        // the batched flash must yield the same result as the single one
+        FluidState refFs;
+        ParameterCache paramCache;
+        refFs.setTemperature(fs.temperature(oilPhaseIdx));
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            refFs.setPressure(phaseIdx, fs.pressure(phaseIdx));
+        Flash::solve(refFs, paramCache, zOil, oilPhaseIdx, gasPhaseIdx);
+        if (std::abs(refFs.saturation(gasPhaseIdx) - fs.saturation(gasPhaseIdx)) > 1e-8)
+            OPM_THROW(std::logic_error,
+                      "Batched and single Rachford-Rice flash disagree at p = "
+                      << fs.pressure(oilPhaseIdx) << ": "
+                      << fs.saturation(gasPhaseIdx) << " != " << refFs.saturation(gasPhaseIdx));
+
+        // the fugacities of the phases must be equal
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            if (zOil[compIdx] == 0.0)
+                continue;
+            Scalar fOil = fs.fugacity(oilPhaseIdx, compIdx);
+            Scalar fGas = fs.fugacity(gasPhaseIdx, compIdx);
+            if (std::abs(fOil - fGas) > 1e-8*fOil)
+                OPM_THROW(std::logic_error,
+                          "Fugacities of component " << compIdx << " differ after the "
+                          "Rachford-Rice flash: " << fOil << " != " << fGas);
+        }
+
+        Scalar Sg = fs.saturation(gasPhaseIdx);
+        if (!(0.0 < Sg && Sg < 1.0))
+            continue;
+        twoPhaseStateFound = true;
+
+        // both phases are present, so their compositions must be normalized and the
+        // amounts of the components must add up to the overall composition
+        Scalar sumX = 0.0, sumY = 0.0;
+        Scalar totalMoles = 0.0;
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            if (phaseIdx == oilPhaseIdx || phaseIdx == gasPhaseIdx)
+                totalMoles += fs.saturation(phaseIdx)*fs.molarDensity(phaseIdx);
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            sumX += fs.moleFraction(oilPhaseIdx, compIdx);
+            sumY += fs.moleFraction(gasPhaseIdx, compIdx);
+
+            Scalar moles =
+                fs.saturation(oilPhaseIdx)*fs.molarity(oilPhaseIdx, compIdx)
+                + fs.saturation(gasPhaseIdx)*fs.molarity(gasPhaseIdx, compIdx);
+            if (std::abs(moles/totalMoles - zOil[compIdx]) > 1e-8)
+                OPM_THROW(std::logic_error,
+                          "Rachford-Rice flash does not conserve component " << compIdx);
+        }
+        if (std::abs(sumX - 1) > 1e-10 || std::abs(sumY - 1) > 1e-10)
+            OPM_THROW(std::logic_error,
+                      "Compositions of the Rachford-Rice flash are not normalized");
+    }
+    if (!twoPhaseStateFound)
+        OPM_THROW(std::logic_error,
+                  "The Rachford-Rice flash did not find a two-phase state");
+
+    // a light gas stays a single gas phase. the composition of the oil phase is the
+    // one of the stationary point of its tangent plane distance
+    ComponentVector zGas(0.0);
+    zGas[FluidSystem::C1Idx] = 0.95;
+    zGas[FluidSystem::C3Idx] = 0.05;
+    FluidState fs;
+    ParameterCache paramCache;
+    fs.setTemperature(273.15 + 20);
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+        fs.setPressure(phaseIdx, 50e5);
+    Flash::solve(fs, paramCache, zGas, oilPhaseIdx, gasPhaseIdx);
+
+    Scalar sumX = 0.0;
+    for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+        sumX += fs.moleFraction(oilPhaseIdx, compIdx);
+    if (fs.saturation(gasPhaseIdx) != 1.0 || sumX > 1.0)
+        OPM_THROW(std::logic_error,
+                  "Rachford-Rice flash of a light gas: S_g = " << fs.saturation(gasPhaseIdx)
+                  << ", sum x_o = " << sumX);
+}
+
+template <class Scalar, class FluidSystem>
+void checkDeviceFlash()
+{
+    typedef Opm::RachfordRiceFlash<Scalar, FluidSystem> RefFlash;
+    typedef typename RefFlash::ComponentVector ComponentVector;
+    typedef Opm::PengRobinsonDeviceFlash<Scalar, FluidSystem::numComponents> Flash;
+    typedef typename Flash::Data Data;
+    typedef typename Flash::Batch Batch;
+    typedef Opm::CompositionalFluidState<Scalar, FluidSystem> FluidState;
+    typedef typename FluidSystem::ParameterCache ParameterCache;
+
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+
+    const Data data = Opm::PengRobinsonMixtureKernels<Scalar, numComponents>::template
+        createData<FluidSystem>(/*useSpe5Relations=*/true);
+
+    ComponentVector zOil(0.0);
+    zOil[FluidSystem::C1Idx] = 0.50;
+    zOil[FluidSystem::C3Idx] = 0.03;
+    zOil[FluidSystem::C6Idx] = 0.07;
+    zOil[FluidSystem::C10Idx] = 0.20;
+    zOil[FluidSystem::C15Idx] = 0.15;
+    zOil[FluidSystem::C20Idx] = 0.05;
+
+    const int n = 20;
+    std::vector<Scalar> T(n), p(n), z(numComponents*n), K(numComponents*n);
+    std::vector<Scalar> x(numComponents*n), y(numComponents*n), V(n);
+    std::vector<int> iterations(n);
+    std::vector<unsigned char> converged(n);
+    for (int i = 0; i < n; ++i) {
+        T[i] = 273.15 + 20;
+        p[i] = 20e5 + 10e5*i;
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            z[compIdx*n + i] = zOil[compIdx];
+    }
+
+    Batch batch;
+    batch.n = n;
+    batch.temperature = T.data();
+    batch.pressure = p.data();
+    batch.z = z.data();
+    batch.K = K.data();
+    batch.x = x.data();
+    batch.y = y.data();
+    batch.vaporFraction = V.data();
+    batch.iterations = iterations.data();
+    batch.converged = converged.data();
+    size_t numFailed = Flash::solveBatch(data, batch);
+    if (numFailed > 0)
+        OPM_THROW(std::logic_error, numFailed << " flashes of the device kernel failed");
+
+    bool twoPhaseStateFound = false;
+    for (int i = 0; i < n; ++i) {
+        FluidState fs;
+        ParameterCache paramCache;
+        fs.setTemperature(T[i]);
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            fs.setPressure(phaseIdx, p[i]);
+        RefFlash::solve(fs, paramCache, zOil, oilPhaseIdx, gasPhaseIdx);
+
+        Scalar Sg = fs.saturation(gasPhaseIdx);
+        if (!(0.0 < Sg && Sg < 1.0)) {
+            if (0.0 < V[i] && V[i] < 1.0)
+                OPM_THROW(std::logic_error,
+                          "The device kernel finds two phases at p = " << p[i]);
+            continue;
+        }
+        twoPhaseStateFound = true;
+
+        // the compositions of both phases must be the ones of the Rachford-Rice flash
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+            Scalar xRef = fs.moleFraction(oilPhaseIdx, compIdx);
+            Scalar yRef = fs.moleFraction(gasPhaseIdx, compIdx);
+            if (std::abs(x[compIdx*n + i] - xRef) > 1e-8
+                || std::abs(y[compIdx*n + i] - yRef) > 1e-8)
+                OPM_THROW(std::logic_error,
+                          "The device kernel and the Rachford-Rice flash disagree at p = "
+                          << p[i] << " for component " << compIdx);
+        }
+    }
+    if (!twoPhaseStateFound)
+        OPM_THROW(std::logic_error,
+                  "The device kernel was not checked for a two-phase state");
+
+    // restarting from the converged K-values must not need more than one iteration
+    if (Flash::solveBatch(data, batch, /*useInitialK=*/true) > 0)
+        OPM_THROW(std::logic_error, "Restarted flashes of the device kernel failed");
+    for (int i = 0; i < n; ++i)
+        if (iterations[i] > 1)
+            OPM_THROW(std::logic_error,
+                      "Restarted flash of the device kernel needs " << iterations[i]
+                      << " iterations");
+}
+
 template <class RawTable>
 void printResult(const RawTable& rawTable,
                  const std::string &fieldName,
@@ -383,6 +856,14 @@ int main(int argc, char** argv)
                 /*setViscosity=*/false,
                 /*setEnthalpy=*/false);
 
+    checkMolarVolumeBatch<Scalar, FluidSystem>(fluidState);
+    checkParameterCacheReuse<Scalar, FluidSystem>(fluidState);
+    checkFugacityCoefficients<Scalar, FluidSystem>(fluidState);
+    checkCompositionFromFugacities<Scalar, FluidSystem>(fluidState);
+    checkVaporPressureTable<Scalar>();
+    checkRachfordRiceFlash<Scalar, FluidSystem>();
+    checkDeviceFlash<Scalar, FluidSystem>();
+
     ////////////
     // Calculate the total molarities of the components
     ////////////
@@ -0,0 +1,129 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  Copyright (C) 2015 by Andreas Lauser
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*!
+ * \file
+ *
+ * \brief Test for the sparse evaluations of the localized automatic differentiation
+ *        (AD) framework.
+ *
+ * The results of sparse evaluations are compared to the ones of the dense evaluations
+ * which are computed by the same code.
+ */
+#include "config.h"
+
+#include <opm/material/localad/SparseEvaluation.hpp>
+#include <opm/material/localad/SparseMath.hpp>
+#include <opm/material/localad/Math.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <iostream>
+#include <cmath>
+
+struct TestVariables
+{
+    static const int size = 5;
+};
+
+typedef double Scalar;
+typedef Opm::LocalAd::Evaluation<Scalar, TestVariables, TestVariables::size> DenseEval;
+typedef Opm::LocalAd::SparseEvaluation<Scalar, TestVariables, TestVariables::size> SparseEval;
+
+// a function which alternates between depending on the first, the last and both
+// arguments
+template <class Evaluation>
+Evaluation testFunction(const Evaluation& x, const Evaluation& y, int variant)
+{
+    typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+    switch (variant) {
+    case 0:
+        return Toolbox::exp(2.0*x) - Toolbox::sqrt(x)/3.0 + Toolbox::pow(x, 1.7);
+    case 1:
+        return Toolbox::log(y*y + 1.0)*Toolbox::sin(y) - 1.0/Toolbox::cos(y);
+    case 2:
+        return Toolbox::max(x*y, y - x) + Toolbox::atan2(x, y) + Toolbox::pow(x, y);
+    default:
+        return Toolbox::min(x/y, 0.5) - Toolbox::abs(x - y) + Toolbox::atan(-y);
+    }
+}
+
+bool compare(const SparseEval& sparse, const DenseEval& dense, int variant)
+{
+    bool ok = std::abs(sparse.value - dense.value) <= 1e-14*std::max(1.0, std::abs(dense.value));
+    for (int varIdx = 0; varIdx < SparseEval::size; ++varIdx) {
+        Scalar d = dense.derivatives[varIdx];
+        ok = ok && std::abs(sparse.derivatives[varIdx] - d) <= 1e-14*std::max(1.0, std::abs(d));
+
+        // derivatives which are not part of the sparsity pattern must be zero
+        ok = ok && (sparse.isNonZero(varIdx) || sparse.derivatives[varIdx] == 0.0);
+    }
+
+    if (!ok) {
+        std::cerr << "sparse and dense evaluation of variant " << variant << " differ:\n";
+        sparse.print(std::cerr);
+        std::cerr << "\n";
+        dense.print(std::cerr);
+        std::cerr << "\n";
+    }
+
+    return ok;
+}
+
+int main()
+{
+    for (int i = 0; i < 100; ++i) {
+        Scalar x = 0.1 + 0.05*i;
+        Scalar y = 2.0 - 0.03*i;
+        int variant = i%4;
+
+        SparseEval sx = SparseEval::createVariable(x, 1);
+        SparseEval sy = SparseEval::createVariable(y, 3);
+        DenseEval dx = DenseEval::createVariable(x, 1);
+        DenseEval dy = DenseEval::createVariable(y, 3);
+
+        SparseEval sparse = testFunction(sx, sy, variant);
+        DenseEval dense = testFunction(dx, dy, variant);
+        if (!compare(sparse, dense, variant))
+            return 1;
+
+        // the result must not depend on variables which are not involved
+        if (sparse.nonZeroMask() & ~((1 << 1) | (1 << 3))) {
+            std::cerr << "the sparsity pattern of variant " << variant << " is too large\n";
+            return 1;
+        }
+
+        // the conversion to dense evaluations must be lossless
+        if (!compare(SparseEval(dense), sparse.toDense(), variant))
+            return 1;
+    }
+
+    // functions of a single variable only depend on it
+    SparseEval sx = SparseEval::createVariable(0.3, 1);
+    SparseEval sy = SparseEval::createVariable(1.2, 3);
+    if (testFunction(sx, sy, 0).nonZeroMask() != (1 << 1)
+        || testFunction(sx, sy, 1).nonZeroMask() != (1 << 3))
+    {
+        std::cerr << "single variable functions do not preserve the sparsity pattern\n";
+        return 1;
+    }
+
+    return 0;
+}
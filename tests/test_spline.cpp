@@ -120,6 +120,17 @@ void testCommon(const Spline &sp,
                       "Third derivative of spline seems to be inconsistent with cuve"
                       " (" << mFD << " - " << m << " = " << mFD - m << ")!");
     }
+
+    // make sure that the batched evaluation yields the same results as eval(). the
+    // positions are in reverse order and exceed the range of the spline.
+    std::vector<double> xBatch(np + 2), yBatch(np + 2);
+    for (int i = 0; i < np + 2; ++i)
+        xBatch[i] = sp.xMax() - (sp.xMax() - sp.xMin())*(i - 1)/np;
+    sp.evalBatch(xBatch.data(), yBatch.data(), xBatch.size(), /*extrapolate=*/true);
+    for (int i = 0; i < np + 2; ++i)
+        if (yBatch[i] != sp.eval(xBatch[i], /*extrapolate=*/true))
+            OPM_THROW(std::runtime_error,
+                      "Batched evaluation of spline is inconsistent with eval() at x=" << xBatch[i]);
 }
 
 template <class Spline>
@@ -291,6 +302,115 @@ void testAll()
 #if GCC_VERSION >= 40500
     { Opm::Spline<double> sp; sp.setContainerOfTuples(pointsInitList); testNatural(sp, x, y); };
 #endif
+
+    // re-fitting a spline for the same sampling positions reuses the decomposition
+    // of the linear system. the result must be the same as for a fresh spline.
+    { double y2[] = { 1, 2, 4, 8, 16 };
+      Opm::Spline<double> sp(5, x, y);
+      sp.setXYArrays(5, x, y2);
+      testNatural(sp, x, y2);
+      Opm::Spline<double> spRef(5, x, y2);
+      for (int i = 0; i <= 100; ++i) {
+          double xval = x[0] + (x[4] - x[0])*i/100;
+          if (std::abs(sp.eval(xval) - spRef.eval(xval)) > 1e-14)
+              OPM_THROW(std::runtime_error,
+                        "Re-fitted spline differs from a freshly created one at x=" << xval);
+      } };
+}
+
+// make sure that fitting a family of splines at once yields the same splines as
+// fitting them individually
+void testSplineBatch()
+{
+    typedef Opm::Spline<double> Spline;
+
+    const int numSplines = 4;
+    const int nSamples = 6;
+    double x[nSamples] = { 0, 1, 3, 3.5, 5, 8 };
+    double y[numSplines*nSamples];
+    for (int k = 0; k < numSplines; ++k)
+        for (int i = 0; i < nSamples; ++i)
+            y[k*nSamples + i] = std::sin(x[i] + k) + 0.1*k*x[i];
+
+    Spline::SplineType types[] = { Spline::Natural, Spline::Periodic, Spline::Monotonic };
+    for (int typeIdx = 0; typeIdx < 3; ++typeIdx) {
+        std::vector<Spline> splines(numSplines);
+        Spline::setXYArraysBatch(splines.data(), numSplines, nSamples, x, y, types[typeIdx]);
+
+        for (int k = 0; k < numSplines; ++k) {
+            Spline spRef;
+            spRef.setXYArrays(nSamples, x, y + k*nSamples, types[typeIdx]);
+
+            for (int i = 0; i <= 100; ++i) {
+                double xval = x[0] + (x[nSamples - 1] - x[0])*i/100;
+                if (std::abs(splines[k].eval(xval) - spRef.eval(xval)) > 1e-12
+                    || std::abs(splines[k].evalDerivative(xval) - spRef.evalDerivative(xval)) > 1e-12)
+                    OPM_THROW(std::runtime_error,
+                              "Spline " << k << " of type " << types[typeIdx]
+                              << " fitted by setXYArraysBatch() differs from the individually"
+                              << " fitted one at x=" << xval);
+            }
+        }
+    }
+}
+
+// make sure that the LU decomposition of tridiagonal matrices solves the linear
+// systems, both with and without the entries on the lower left and upper right
+void testTridiagonalFactorization()
+{
+    for (int n = 1; n < 8; ++n) {
+        for (int periodic = 0; periodic < 2; ++periodic) {
+            Opm::TridiagonalMatrix<double> M(n, 0.0);
+            std::vector<std::vector<double> > A(n, std::vector<double>(n, 0.0));
+            for (int i = 0; i < n; ++i) {
+                A[i][i] = 4.0 + 0.1*i;
+                if (i > 0)
+                    A[i][i - 1] = 1.0 - 0.05*i;
+                if (i < n - 1)
+                    A[i][i + 1] = 0.5 + 0.1*i;
+            }
+            if (periodic && n > 2) {
+                A[0][n - 1] = 0.7;
+                A[n - 1][0] = -0.3;
+            }
+            for (int i = 0; i < n; ++i)
+                for (int j = std::max(0, i - 1); j <= std::min(n - 1, i + 1); ++j)
+                    M.at(i, j) = A[i][j];
+            if (n > 2) {
+                M.at(0, n - 1) = A[0][n - 1];
+                M.at(n - 1, 0) = A[n - 1][0];
+            }
+
+            // two right hand sides for the solutions x_i = i + 1 and y_i = (-1)^i
+            std::vector<double> xRef(n), yRef(n), b(n), B(2*n);
+            for (int i = 0; i < n; ++i) {
+                xRef[i] = i + 1.0;
+                yRef[i] = (i%2 == 0)?1.0:-1.0;
+            }
+            for (int i = 0; i < n; ++i) {
+                b[i] = 0.0;
+                B[2*i + 1] = 0.0;
+                for (int j = 0; j < n; ++j) {
+                    b[i] += A[i][j]*xRef[j];
+                    B[2*i + 1] += A[i][j]*yRef[j];
+                }
+                B[2*i] = b[i];
+            }
+
+            Opm::TridiagonalFactorization<double> lu(M);
+            std::vector<double> x(n), X(2*n);
+            lu.solve(x, b);
+            lu.solveBatch(X.data(), B.data(), /*numRhs=*/2);
+            for (int i = 0; i < n; ++i) {
+                if (std::abs(x[i] - xRef[i]) > 1e-12
+                    || std::abs(X[2*i] - xRef[i]) > 1e-12
+                    || std::abs(X[2*i + 1] - yRef[i]) > 1e-12)
+                    OPM_THROW(std::runtime_error,
+                              "TridiagonalFactorization does not solve the system for n=" << n
+                              << " (periodic=" << periodic << ")");
+            }
+        }
+    }
 }
 
 void plot()
@@ -337,6 +457,8 @@ int main()
 {
     try {
         testAll();
+        testTridiagonalFactorization();
+        testSplineBatch();
 
         plot();
     }
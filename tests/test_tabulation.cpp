@@ -29,8 +29,15 @@
  */
 #include "config.h"
 
+#include <opm/material/components/Brine.hpp>
 #include <opm/material/components/H2O.hpp>
 #include <opm/material/components/TabulatedComponent.hpp>
+#include <opm/material/components/SimpleH2O.hpp>
+#include <opm/material/common/AsyncInitializer.hpp>
+#include <opm/material/common/HugePageAllocator.hpp>
+
+#include <stdexcept>
+#include <cstdio>
 
 bool success;
 
@@ -109,6 +116,330 @@ int main()
         //std::cerr << "\n";
     }
 
+    std::cout << "\nChecking phase properties\n";
+    for (int i = 0; i < m; i += 7) {
+        Scalar T = tempMin + (tempMax - tempMin)*Scalar(i)/m;
+        Scalar pv = IapwsH2O::vaporPressure(T);
+
+        // the regularized as well as the regular regimes of both phases
+        const Scalar pressures[] = { 0.5*IapwsH2O::triplePressure(), 0.5*pv, 0.99*pv, 1.01*pv, 2*pv + 1e6 };
+        for (Scalar p : pressures) {
+            const auto& gas = IapwsH2O::gasProperties(T, p);
+            isSame("gasProperties density", gas.density, IapwsH2O::gasDensity(T,p), 1e-10);
+            isSame("gasProperties enthalpy", gas.enthalpy, IapwsH2O::gasEnthalpy(T,p), 1e-10);
+            isSame("gasProperties heatCapacity", gas.heatCapacity, IapwsH2O::gasHeatCapacity(T,p), 1e-10);
+            isSame("gasProperties viscosity", gas.viscosity, IapwsH2O::gasViscosity(T,p), 1e-10);
+            isSame("gasProperties thermalConductivity", gas.thermalConductivity, IapwsH2O::gasThermalConductivity(T,p), 1e-10);
+
+            const auto& liquid = IapwsH2O::liquidProperties(T, p);
+            isSame("liquidProperties density", liquid.density, IapwsH2O::liquidDensity(T,p), 1e-10);
+            isSame("liquidProperties enthalpy", liquid.enthalpy, IapwsH2O::liquidEnthalpy(T,p), 1e-10);
+            isSame("liquidProperties heatCapacity", liquid.heatCapacity, IapwsH2O::liquidHeatCapacity(T,p), 1e-10);
+            isSame("liquidProperties viscosity", liquid.viscosity, IapwsH2O::liquidViscosity(T,p), 1e-10);
+            isSame("liquidProperties thermalConductivity", liquid.thermalConductivity, IapwsH2O::liquidThermalConductivity(T,p), 1e-10);
+        }
+    }
+
+    std::cout << "Checking brine properties\n";
+    typedef Opm::Brine<Scalar, IapwsH2O> IapwsBrine;
+    typedef Opm::Brine<Scalar, Opm::SimpleH2O<Scalar> > SimpleBrine;
+    typedef Opm::Brine<Scalar, TabulatedH2O> TabulatedWaterBrine;
+    for (int i = 0; i < m; i += 7) {
+        Scalar T = tempMin + (tempMax - tempMin)*Scalar(i)/m;
+        Scalar pv = IapwsH2O::vaporPressure(T);
+
+        const Scalar pressures[] = { 1.01*pv, 2*pv + 1e6 };
+        for (Scalar p : pressures) {
+            const auto& brine = IapwsBrine::liquidProperties(T, p);
+            isSame("brine liquidProperties density", brine.density, IapwsBrine::liquidDensity(T,p), 1e-10);
+            isSame("brine liquidProperties enthalpy", brine.enthalpy, IapwsBrine::liquidEnthalpy(T,p), 1e-10);
+            isSame("brine liquidProperties heatCapacity", brine.heatCapacity, IapwsBrine::liquidHeatCapacity(T,p), 1e-5);
+            isSame("brine liquidProperties viscosity", brine.viscosity, IapwsBrine::liquidViscosity(T,p), 1e-10);
+
+            const auto& simpleBrine = SimpleBrine::liquidProperties(T, p);
+            isSame("simple brine liquidProperties density", simpleBrine.density, SimpleBrine::liquidDensity(T,p), 1e-10);
+            isSame("simple brine liquidProperties enthalpy", simpleBrine.enthalpy, SimpleBrine::liquidEnthalpy(T,p), 1e-10);
+            isSame("simple brine liquidProperties heatCapacity", simpleBrine.heatCapacity, SimpleBrine::liquidHeatCapacity(T,p), 1e-5);
+
+            // the water tables do not depend on the salinity
+            if (p > pMax)
+                continue;
+            for (Scalar S : { 0.0, 0.05, 0.2 }) {
+                const auto& tabulated = TabulatedWaterBrine::liquidProperties(T, p, S);
+                const auto& raw = IapwsBrine::liquidProperties(T, p, S);
+                isSame("tabulated brine density", tabulated.density, raw.density, 1e-3);
+                isSame("tabulated brine enthalpy", tabulated.enthalpy, raw.enthalpy, 1e-3);
+                isSame("tabulated brine viscosity", tabulated.viscosity, raw.viscosity, 1e-10);
+            }
+        }
+    }
+
+    std::cout << "Checking lazy tabulation\n";
+    TabulatedH2O::init(tempMin, tempMax, nTemp,
+                       pMin, pMax, nPress,
+                       /*lazy=*/true);
+    for (int i = 0; i < m; i += 7) {
+        Scalar T = tempMin + (tempMax - tempMin)*Scalar(i)/m;
+        Scalar p = 0.95*IapwsH2O::vaporPressure(T);
+        isSame("lazy gasDensity", TabulatedH2O::gasDensity(T,p), IapwsH2O::gasDensity(T,p), 1e-3);
+
+        p = 1.05*IapwsH2O::vaporPressure(T);
+        isSame("lazy liquidDensity", TabulatedH2O::liquidDensity(T,p), IapwsH2O::liquidDensity(T,p), 1e-3);
+    }
+
+    std::cout << "Checking bicubic tabulation\n";
+    int nTempCoarse = nTemp/4;
+    int nPressCoarse = nPress/4;
+    TabulatedH2O::init(tempMin, tempMax, nTempCoarse,
+                       pMin, pMax, nPressCoarse,
+                       /*lazy=*/false, /*bicubic=*/true);
+    for (int i = 0; i < m; i += 7) {
+        Scalar T = tempMin + (tempMax - tempMin)*Scalar(i)/m;
+        Scalar p = 0.95*IapwsH2O::vaporPressure(T);
+        isSame("bicubic gasDensity", TabulatedH2O::gasDensity(T,p), IapwsH2O::gasDensity(T,p), 1e-3);
+        isSame("bicubic gasEnthalpy", TabulatedH2O::gasEnthalpy(T,p), IapwsH2O::gasEnthalpy(T,p), 1e-3);
+
+        p = 1.05*IapwsH2O::vaporPressure(T) + 1e6;
+        isSame("bicubic liquidDensity", TabulatedH2O::liquidDensity(T,p), IapwsH2O::liquidDensity(T,p), 1e-3);
+        isSame("bicubic liquidViscosity", TabulatedH2O::liquidViscosity(T,p), IapwsH2O::liquidViscosity(T,p), 1e-3);
+    }
+
+    std::cout << "Checking adaptive tabulation\n";
+    TabulatedH2O::initAdaptive(tempMin, tempMax,
+                               pMin, pMax, nPress,
+                               /*relTolerance=*/1e-3);
+    if (TabulatedH2O::numTemperatures() >= static_cast<unsigned>(nTemp)) {
+        std::cout << "error: adaptive tabulation uses " << TabulatedH2O::numTemperatures()
+                  << " temperatures, uniform one " << nTemp << "\n";
+        success = false;
+    }
+    for (int i = 0; i < m; i += 7) {
+        Scalar T = tempMin + (tempMax - tempMin)*Scalar(i)/m;
+        Scalar p = 0.95*IapwsH2O::vaporPressure(T);
+        isSame("adaptive gasDensity", TabulatedH2O::gasDensity(T,p), IapwsH2O::gasDensity(T,p), 1e-3);
+        isSame("adaptive gasEnthalpy", TabulatedH2O::gasEnthalpy(T,p), IapwsH2O::gasEnthalpy(T,p), 1e-3);
+
+        p = 1.05*IapwsH2O::vaporPressure(T);
+        isSame("adaptive liquidDensity", TabulatedH2O::liquidDensity(T,p), IapwsH2O::liquidDensity(T,p), 1e-3);
+        isSame("adaptive liquidViscosity", TabulatedH2O::liquidViscosity(T,p), IapwsH2O::liquidViscosity(T,p), 1e-3);
+    }
+
+    std::cout << "Checking property-selective tabulation\n";
+    for (int lazy = 0; lazy < 2; ++lazy) {
+        TabulatedH2O::init(tempMin, tempMax, nTemp,
+                           pMin, pMax, nPress,
+                           lazy != 0, /*bicubic=*/false,
+                           TabulatedH2O::liquidDensityFlag | TabulatedH2O::liquidViscosityFlag);
+        for (int i = 0; i < m; i += 7) {
+            Scalar T = tempMin + (tempMax - tempMin)*Scalar(i)/m;
+            Scalar p = 1.05*IapwsH2O::vaporPressure(T);
+            isSame("selective liquidDensity", TabulatedH2O::liquidDensity(T,p), IapwsH2O::liquidDensity(T,p), 1e-3);
+            isSame("selective liquidViscosity", TabulatedH2O::liquidViscosity(T,p), IapwsH2O::liquidViscosity(T,p), 1e-3);
+        }
+
+        try {
+            TabulatedH2O::gasDensity(Scalar(400.0), Scalar(1e5));
+            std::cout << "error: a property which was not tabulated could be queried\n";
+            success = false;
+        }
+        catch (const std::logic_error&) {}
+    }
+
+    // the remaining checks use the bilinear tables
+    TabulatedH2O::init(tempMin, tempMax, nTemp,
+                       pMin, pMax, nPress,
+                       /*lazy=*/true);
+
+    std::cout << "Checking table files\n";
+    const char* fileName = "test_tabulation_h2o.tables";
+    TabulatedH2O::saveTables(fileName);
+    if (TabulatedH2O::loadTables(fileName, tempMin, tempMax, nTemp, pMin, pMax, nPress + 1)) {
+        std::cout << "error: table file was accepted for a different resolution\n";
+        success = false;
+    }
+    for (int map = 0; map < 2; ++map) {
+        if (!TabulatedH2O::loadTables(fileName, tempMin, tempMax, nTemp, pMin, pMax, nPress, map != 0)) {
+            std::cout << "error: could not load table file\n";
+            success = false;
+            break;
+        }
+
+        for (int i = 0; i < m; i += 7) {
+            Scalar T = tempMin + (tempMax - tempMin)*Scalar(i)/m;
+            Scalar p = 0.95*IapwsH2O::vaporPressure(T);
+            isSame("loaded gasViscosity", TabulatedH2O::gasViscosity(T,p), IapwsH2O::gasViscosity(T,p), 1e-3);
+
+            p = 1.05*IapwsH2O::vaporPressure(T);
+            isSame("loaded liquidEnthalpy", TabulatedH2O::liquidEnthalpy(T,p), IapwsH2O::liquidEnthalpy(T,p), 1e-3);
+        }
+    }
+    std::remove(fileName);
+
+    std::cout << "Checking asynchronous initialization\n";
+    typedef Opm::SimpleH2O<Scalar> SimpleH2O;
+    typedef Opm::TabulatedComponent<Scalar, SimpleH2O> TabulatedSimpleH2O;
+    Opm::AsyncInitializer initializer;
+    initializer.add(TabulatedH2O::initAsync(tempMin, tempMax, nTemp, pMin, pMax, nPress));
+    initializer.add(TabulatedSimpleH2O::initAsync(tempMin, tempMax, nTemp, pMin, pMax, nPress));
+    initializer.wait();
+    for (int i = 0; i < m; i += 7) {
+        Scalar T = tempMin + (tempMax - tempMin)*Scalar(i)/m;
+        Scalar p = 1.05*IapwsH2O::vaporPressure(T);
+        isSame("async liquidDensity", TabulatedH2O::liquidDensity(T,p), IapwsH2O::liquidDensity(T,p), 1e-3);
+        isSame("async simple liquidEnthalpy",
+               TabulatedSimpleH2O::liquidEnthalpy(T,p), SimpleH2O::liquidEnthalpy(T,p), 1e-3);
+    }
+
+    // the exceptions of the tasks must be passed on by wait()
+    initializer.launch([]() { throw std::runtime_error("task failed"); });
+    initializer.launch([]() {});
+    try {
+        initializer.wait();
+        std::cout << "error: the exception of a task was not passed on\n";
+        success = false;
+    }
+    catch (const std::runtime_error&) {}
+    if (initializer.numTasks() != 0) {
+        std::cout << "error: the tasks were not removed by wait()\n";
+        success = false;
+    }
+
+    std::cout << "Checking table instances\n";
+    {
+        // two models with different temperature ranges, each with its own tables which
+        // are independent of the ones of the static interface
+        typedef TabulatedH2O::Instance TabulatedH2OInstance;
+        TabulatedH2OInstance coldTables;
+        TabulatedH2OInstance hotTables;
+        Scalar coldTempMax = 320.0;
+        Scalar hotTempMin = 450.0;
+        coldTables.init(tempMin, coldTempMax, nTemp/4, pMin, pMax, nPress);
+        hotTables.initAdaptive(hotTempMin, tempMax, pMin, pMax, nPress, /*relTolerance=*/1e-3);
+        TabulatedH2O::init(tempMin, tempMax, 10, pMin, pMax, 10);
+
+        if (&TabulatedH2O::defaultInstance() == &coldTables
+            || coldTables.numTemperatures() != static_cast<unsigned>(nTemp/4)
+            || TabulatedH2O::numTemperatures() != 10)
+        {
+            std::cout << "error: the tables of an instance are not independent\n";
+            success = false;
+        }
+
+        for (int i = 0; i < m; i += 7) {
+            Scalar alpha = Scalar(i)/m;
+            Scalar T = tempMin + (coldTempMax - tempMin)*alpha;
+            Scalar p = 1.05*IapwsH2O::vaporPressure(T);
+            isSame("cold instance liquidDensity",
+                   coldTables.liquidDensity(T,p), IapwsH2O::liquidDensity(T,p), 1e-4);
+            isSame("cold instance liquidViscosity",
+                   coldTables.liquidViscosity(T,p), IapwsH2O::liquidViscosity(T,p), 1e-3);
+
+            T = hotTempMin + (tempMax - hotTempMin)*alpha;
+            p = 0.95*IapwsH2O::vaporPressure(T);
+            isSame("hot instance gasDensity",
+                   hotTables.gasDensity(T,p), IapwsH2O::gasDensity(T,p), 1e-3);
+            isSame("hot instance vaporPressure",
+                   hotTables.vaporPressure(T), IapwsH2O::vaporPressure(T), 1e-3);
+        }
+
+        // outside of its range, an instance falls back to the raw component
+        Scalar T = 400.0;
+        Scalar p = 1.05*IapwsH2O::vaporPressure(T);
+        if (coldTables.liquidDensity(T, p) != IapwsH2O::liquidDensity(T, p)) {
+            std::cout << "error: an instance was used outside of its temperature range\n";
+            success = false;
+        }
+    }
+
+    std::cout << "Checking the lookup of all properties of a phase\n";
+    {
+        TabulatedH2O::init(tempMin, tempMax, nTemp, pMin, pMax, nPress);
+        for (int i = 0; i < m; i += 7) {
+            Scalar T = tempMin + (tempMax - tempMin)*Scalar(i)/m;
+            Scalar p = 1.05*IapwsH2O::vaporPressure(T);
+            const auto& liquid = TabulatedH2O::liquidProperties(T, p);
+            isSame("liquidProperties density", liquid.density, TabulatedH2O::liquidDensity(T, p), 1e-12);
+            isSame("liquidProperties enthalpy", liquid.enthalpy, TabulatedH2O::liquidEnthalpy(T, p), 1e-12);
+            isSame("liquidProperties viscosity", liquid.viscosity, TabulatedH2O::liquidViscosity(T, p), 1e-12);
+
+            p = 0.95*IapwsH2O::vaporPressure(T);
+            const auto& gas = TabulatedH2O::gasProperties(T, p);
+            isSame("gasProperties density", gas.density, TabulatedH2O::gasDensity(T, p), 1e-12);
+            isSame("gasProperties heatCapacity", gas.heatCapacity, TabulatedH2O::gasHeatCapacity(T, p), 1e-12);
+        }
+    }
+
+    std::cout << "Checking coarse tables\n";
+    {
+        TabulatedH2O::init(tempMin, tempMax, nTemp, pMin, pMax, nPress);
+        TabulatedH2O::coarseInstance().init(tempMin, tempMax, nTemp/8, pMin, pMax, nPress/8);
+
+        Scalar T = (tempMin + tempMax)/2;
+        Scalar p = 1.05*IapwsH2O::vaporPressure(T);
+        Scalar rhoFine = TabulatedH2O::liquidDensity(T, p);
+        TabulatedH2O::setUseCoarseTables(true);
+        Scalar rhoCoarse = TabulatedH2O::liquidDensity(T, p);
+        TabulatedH2O::setUseCoarseTables(false);
+        if (rhoCoarse == rhoFine
+            || TabulatedH2O::liquidDensity(T, p) != rhoFine
+            || TabulatedH2O::numTemperatures() != static_cast<unsigned>(nTemp))
+        {
+            std::cout << "error: the coarse tables are not used while they are selected\n";
+            success = false;
+        }
+        isSame("coarse liquidDensity", rhoCoarse, IapwsH2O::liquidDensity(T, p), 1e-2);
+    }
+
+    std::cout << "Checking tables outside of the range of the raw component\n";
+    {
+        // the IAPWS steam density is only implemented below 623.15K, so some of the
+        // entries of these tables cannot be calculated by the raw component
+        TabulatedH2O::Instance tables;
+        try {
+            tables.init(/*tempMin=*/550.0, /*tempMax=*/700.0, /*nTemp=*/50,
+                        /*pressMin=*/1e5, /*pressMax=*/20e6, /*nPress=*/50);
+        }
+        catch (const std::exception& e) {
+            std::cout << "error: tabulating the raw component threw: " << e.what() << "\n";
+            success = false;
+        }
+
+        for (int i = 0; i < m; i += 7) {
+            Scalar T = 550.0 + (600.0 - 550.0)*Scalar(i)/m;
+            Scalar p = 0.95*IapwsH2O::vaporPressure(T);
+            isSame("partially valid gasDensity",
+                   tables.gasDensity(T,p), IapwsH2O::gasDensity(T,p), 1e-3);
+        }
+    }
+
+    std::cout << "Checking tables on huge pages\n";
+    Opm::HugePagePolicy policies[] = { Opm::TransparentHugePages, Opm::ExplicitHugePages };
+    for (int policyIdx = 0; policyIdx < 2; ++policyIdx) {
+        Opm::HugePages::setPolicy(policies[policyIdx]);
+        TabulatedH2O::init(tempMin, tempMax, nTemp, pMin, pMax, nPress);
+        for (int i = 0; i < m; i += 7) {
+            Scalar T = tempMin + (tempMax - tempMin)*Scalar(i)/m;
+            Scalar p = 1.05*IapwsH2O::vaporPressure(T);
+            isSame("huge page liquidDensity", TabulatedH2O::liquidDensity(T,p), IapwsH2O::liquidDensity(T,p), 1e-3);
+        }
+
+#if defined __unix__ || defined __APPLE__
+        Opm::HugePageAllocator<Scalar> allocator;
+        size_t n = Opm::HugePages::minimumSize()/sizeof(Scalar) + 1;
+        Scalar* values = allocator.allocate(n);
+        if (reinterpret_cast<size_t>(values) % Opm::HugePages::pageSize != 0) {
+            std::cout << "error: a large array is not aligned to a huge page\n";
+            success = false;
+        }
+        values[n - 1] = 1.0;
+        allocator.deallocate(values, n);
+#endif
+    }
+    Opm::HugePages::setPolicy(Opm::NoHugePages);
+
+    // the tables which were allocated on huge pages must be released correctly
+    TabulatedH2O::init(tempMin, tempMax, nTemp, pMin, pMax, nPress, /*lazy=*/true);
+
     if (success)
         std::cout << "\nsuccess\n";
     return 0;